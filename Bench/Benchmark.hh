@@ -0,0 +1,73 @@
+/// \file Benchmark.hh Minimal parameterized microbenchmark registry and timing state for mpmbench
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef BENCHMARK_HH
+#define BENCHMARK_HH
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+using std::string;
+using std::vector;
+using std::map;
+
+/// Timing state and results passed to benchmark function
+class BenchState {
+public:
+    /// timer clock
+    typedef std::chrono::steady_clock clk_t;
+
+    /// Constructor, with parameter and number of iterations to run
+    BenchState(int64_t a, size_t n): arg(a), iterations(n) { }
+
+    /// pause timing (e.g. for per-iteration setup)
+    void pause() { if(running) { t += std::chrono::duration<double>(clk_t::now() - t0).count(); running = false; } }
+    /// resume timing
+    void resume() { if(!running) { t0 = clk_t::now(); running = true; } }
+    /// timed duration [s]
+    double seconds() const { return running? t + std::chrono::duration<double>(clk_t::now() - t0).count() : t; }
+
+    const int64_t arg;          ///< benchmark parameter
+    const size_t iterations;    ///< number of iterations to run
+    double items = 0;           ///< items processed over all iterations, for items/s
+    double bytes = 0;           ///< bytes processed over all iterations, for MB/s
+    map<string,double> counters;///< additional (last-run) reported values
+
+protected:
+    clk_t::time_point t0 = clk_t::now();    ///< timing start
+    double t = 0;                           ///< accumulated timed duration [s]
+    bool running = true;                    ///< whether timing is active
+};
+
+/// Registered benchmark
+struct Benchmark {
+    /// benchmark function: run S.iterations iterations, setting S.items and/or S.bytes
+    typedef std::function<void(BenchState&)> benchf_t;
+
+    string name;            ///< benchmark name
+    vector<int64_t> args;   ///< parameter values to run
+    benchf_t f;             ///< benchmark function
+
+    /// global registry
+    static vector<Benchmark>& registry() { static vector<Benchmark> v; return v; }
+
+    /// static registration helper
+    struct Registrar {
+        /// Constructor, registering benchmark
+        Registrar(const string& n, const vector<int64_t>& a, benchf_t f) { registry().push_back({n, a.size()? a : vector<int64_t>{0}, f}); }
+    };
+};
+
+/// register benchmark function over list of parameter values --- follow by { brace enclosed } body using BenchState& S
+#define REGISTER_BENCHMARK(NAME, ...) static void bench_##NAME(BenchState& S); \
+    static Benchmark::Registrar the_##NAME##_Bench(#NAME, {__VA_ARGS__}, bench_##NAME); \
+    static void bench_##NAME(BenchState& S)
+
+/// prevent compiler from optimizing away computed value
+template<typename T>
+inline void bench_keep(const T& x) { asm volatile("" : : "g"(&x) : "memory"); }
+
+#endif
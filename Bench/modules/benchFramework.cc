@@ -0,0 +1,123 @@
+/// \file benchFramework.cc Data flow stage throughput: ThreadBufferSink, Collator, OrderingQueue
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "Benchmark.hh"
+#include "ThreadBufferSink.hh"
+#include "Collator.hh"
+#include "OrderingQueue.hh"
+#include <stdexcept>
+#include <stdlib.h>
+
+/// time-ordered benchmark datapoint
+struct BenchItem {
+    /// ordering type
+    typedef double ordering_t;
+    /// ordering parameter
+    explicit operator ordering_t() const { return t; }
+
+    double t;       ///< time
+    double w[3];    ///< payload
+};
+
+/// count received items
+template<typename T>
+class BenchCounter: public DataSink<T> {
+public:
+    /// receive item
+    void push(T& o) override { ++n; bench_keep(o); }
+    size_t n = 0;   ///< number received
+};
+
+/// items per iteration
+static constexpr size_t nPerIter = 100000;
+
+// ThreadBufferSink cross-thread throughput, by ring size (0 for mutex FIFO)
+REGISTER_BENCHMARK(ThreadBufferSink, 0, 4096, 65536) {
+    BenchCounter<const BenchItem> C;
+    ThreadBufferSink<const BenchItem> TB(&C, S.arg);
+    TB.setOwnsNext(false);
+    TB.launch_mythread();
+
+    BenchItem o{0, {}};
+    for(size_t i = 0; i < S.iterations; ++i) {
+        for(size_t j = 0; j < nPerIter; ++j) {
+            o.t = j;
+            TB.push(o);
+        }
+    }
+    TB.signal(DATASTREAM_FLUSH);
+    TB.finish_mythread();
+
+    if(C.n != S.iterations*nPerIter) throw std::runtime_error("ThreadBufferSink lost items");
+    S.items = C.n;
+    S.bytes = C.n*sizeof(BenchItem);
+}
+
+/// collate interleaved streams from S.arg inputs
+static void benchCollator(BenchState& S, _Collator::engine_t e) {
+    Collator<BenchItem> C;
+    C.setEngine(e);
+    BenchCounter<const BenchItem> K;
+    C.getNext() = &K;
+    C.setOwnsNext(false);
+    const size_t nIn = S.arg;
+    for(size_t i = 0; i < nIn; ++i) C.add_input();
+
+    // pre-generated pseudorandom source sequence
+    S.pause();
+    srand48(nIn);
+    vector<double> tnext(nIn);
+    for(auto& t: tnext) t = drand48();
+    vector<std::pair<size_t, double>> seq(nPerIter);
+    for(auto& p: seq) {
+        p.first = lrand48() % nIn;
+        p.second = tnext[p.first];
+        tnext[p.first] += drand48();
+    }
+    S.resume();
+
+    double t0 = 0;
+    for(size_t i = 0; i < S.iterations; ++i) {
+        for(auto& p: seq) {
+            BenchItem o{t0 + p.second, {}};
+            C.push(p.first, o);
+        }
+        t0 += nPerIter;
+    }
+    C.signal(DATASTREAM_FLUSH);
+
+    if(K.n != S.iterations*nPerIter) throw std::runtime_error("Collator lost items");
+    S.items = K.n;
+}
+
+// Collator heap engine items/s, by number of inputs
+REGISTER_BENCHMARK(Collator_heap, 4, 16, 64) { benchCollator(S, _Collator::COLLATE_HEAP); }
+// Collator tournament engine items/s, by number of inputs
+REGISTER_BENCHMARK(Collator_tournament, 4, 16, 64) { benchCollator(S, _Collator::COLLATE_TOURNAMENT); }
+
+// OrderingQueue items/s re-ordering within window of 16, by bucket count (0 for heap)
+REGISTER_BENCHMARK(OrderingQueue, 0, 64, 1024) {
+    BenchCounter<BenchItem> K;
+    OrderingQueue<BenchItem> Q(&K, 16);
+    Q.setOwnsNext(false);
+    if(S.arg) Q.setBuckets(32./S.arg, S.arg);
+
+    S.pause();
+    srand48(1);
+    vector<BenchItem> v(nPerIter);
+    for(size_t j = 0; j < v.size(); ++j) v[j].t = j + 16*drand48();
+    S.resume();
+
+    double t0 = 0;
+    for(size_t i = 0; i < S.iterations; ++i) {
+        for(auto o: v) {
+            o.t += t0;
+            Q.push(o);
+        }
+        t0 += nPerIter;
+    }
+    Q.signal(DATASTREAM_FLUSH);
+
+    if(K.n != S.iterations*nPerIter) throw std::runtime_error("OrderingQueue lost items");
+    S.items = K.n;
+}
@@ -0,0 +1,85 @@
+/// \file benchIO.cc Serialization and file I/O throughput: BinaryIO round-trips, HDF5 table write and read
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "Benchmark.hh"
+#include "BinaryIO.hh"
+#include "HDF5_IO.hh"
+#include <stdexcept>
+#include <stdio.h>
+
+// BinaryIO vector<double> serialize and deserialize round-trip, by vector size
+REGISTER_BENCHMARK(BinaryIO_roundtrip, 1000, 100000, 1000000) {
+    vector<double> v(S.arg), v2;
+    for(size_t i = 0; i < v.size(); ++i) v[i] = 0.5*i;
+
+    for(size_t i = 0; i < S.iterations; ++i) {
+        BinarySerializer B;
+        B.send(v);
+        MemBReader R(B.buf().data(), B.buf().size());
+        R.receive(v2);
+    }
+    if(v2 != v) throw std::runtime_error("BinaryIO round-trip mismatch");
+    S.items = S.iterations*v.size();
+    S.bytes = S.items*sizeof(double);
+}
+
+/// HDF5 table benchmark row
+struct BenchRow {
+    int64_t evt;    ///< event number
+    double E;       ///< energy
+    double x[3];    ///< position
+    int32_t det;    ///< detector ID
+
+    /// table specification
+    static HDF5_Table_Spec HDF5_table_setup(const string& tname = "", int version = 0) {
+        return HDF5_TABLE_SPEC(BenchRow, tname.size()? tname : "BenchRow", "benchmark table", version,
+                               HDF5_FIELD(BenchRow, evt), HDF5_FIELD(BenchRow, E), HDF5_FIELD(BenchRow, x), HDF5_FIELD(BenchRow, det));
+    }
+};
+
+/// rows per table
+static constexpr size_t nRows = 100000;
+/// temporary table file
+static const string benchH5 = "/tmp/mpmbench_table.h5";
+
+/// write test table with given chunk size
+static void writeTable(size_t nchunk) {
+    HDF5_TableOutput<BenchRow> W("", 0, nchunk);
+    W.openOutput(benchH5);
+    BenchRow r{0, 0, {0, 0, 0}, 0};
+    for(size_t i = 0; i < nRows; ++i) {
+        r.evt = i/4;
+        r.E = 0.001*i;
+        r.x[0] = r.x[1] = r.x[2] = 0.1*(i % 100);
+        r.det = i % 16;
+        W.push(r);
+    }
+    W.signal(DATASTREAM_END);
+}
+
+// HDF5_Table_Writer rows/s and MB/s (compressed, chunked), by chunk size
+REGISTER_BENCHMARK(HDF5_Table_write, 1024, 16384) {
+    for(size_t i = 0; i < S.iterations; ++i) writeTable(S.arg);
+    remove(benchH5.c_str());
+    S.items = S.iterations*nRows;
+    S.bytes = S.items*sizeof(BenchRow);
+}
+
+// HDF5_Table_Cache rows/s and MB/s, by read chunk size
+REGISTER_BENCHMARK(HDF5_Table_read, 1024, 16384) {
+    S.pause();
+    writeTable(16384);
+    S.resume();
+
+    size_t n = 0;
+    for(size_t i = 0; i < S.iterations; ++i) {
+        HDF5_TableInput<BenchRow> R("", 0, S.arg);
+        R.openInput(benchH5);
+        BenchRow r;
+        while(R.next(r)) { ++n; bench_keep(r); }
+    }
+    remove(benchH5.c_str());
+    if(n != S.iterations*nRows) throw std::runtime_error("HDF5_Table_Cache read row count mismatch");
+    S.items = n;
+    S.bytes = n*sizeof(BenchRow);
+}
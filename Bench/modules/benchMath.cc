@@ -0,0 +1,46 @@
+/// \file benchMath.cc Numerical kernels: FFTW_Convolver convolution sizes, DynamicHistogram fills
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "Benchmark.hh"
+#include "FFTW_Convolver.hh"
+#include "DynamicHistogram.hh"
+#include <random>
+
+// Gaussian-smoothing convolution (cached plan and kernel) samples/s, by input size
+REGISTER_BENCHMARK(FFTW_Convolver, 256, 1000, 4096, 65536) {
+    GaussConvolverFactory<double> G(5);
+    vector<double> v0(S.arg);
+    std::mt19937 R(1);
+    std::uniform_real_distribution<double> U;
+    for(auto& x: v0) x = U(R);
+
+    // first call plans and calculates kernel
+    S.pause();
+    auto v = v0;
+    G.convolve(v);
+    S.resume();
+
+    for(size_t i = 0; i < S.iterations; ++i) {
+        v = v0;
+        G.convolve(v);
+    }
+    bench_keep(v);
+    S.items = S.iterations*v.size();
+    S.bytes = S.items*sizeof(double);
+}
+
+// SparseHistogram fills/s, by Gaussian width in bins
+REGISTER_BENCHMARK(DynamicHistogram_fill, 10, 1000, 100000) {
+    const size_t nfill = 100000;
+    vector<double> x(nfill);
+    std::mt19937 R(1);
+    std::normal_distribution<double> G(0, S.arg);
+    for(auto& y: x) y = G(R);
+
+    SparseHistogram H(0, 1);
+    for(size_t i = 0; i < S.iterations; ++i)
+        for(auto y: x) H.fill(y);
+    bench_keep(H.total);
+    S.items = S.iterations*nfill;
+    S.counters["bins"] = H.getData().size();
+}
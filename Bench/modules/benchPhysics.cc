@@ -0,0 +1,53 @@
+/// \file benchPhysics.cc Event generator throughput: NucDecaySystem batch decay generation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "Benchmark.hh"
+#include "NuclEvtGen.hh"
+#include "PathUtils.hh"
+#include <stdexcept>
+#include <stdio.h>
+
+/// write text file contents
+static void bench_write_text(const string& fname, const string& s) {
+    auto f = fopen(fname.c_str(), "w");
+    if(!f) throw std::runtime_error("Failed to write " + fname);
+    fputs(s.c_str(), f);
+    fclose(f);
+}
+
+/// Cs-137 decay generator from temporary data directory
+static NucDecaySystem& benchCs137() {
+    static NucDecayLibrary* L = nullptr;
+    if(!L) {
+        const string dir = "/tmp/mpmbench_NucDecay";
+        makePath(dir);
+        bench_write_text(dir + "/ElectronBindingEnergy.txt", "binding: Z = 56\tname = Ba\tK = 37441\tL = 5989\tL2 = 5624\tL3 = 5247\n");
+        bench_write_text(dir + "/Cs137.txt",
+                         "level: nm = 137.55.0\tE = 1176\thl = -1\n"
+                         "level: nm = 137.56.1\tE = 661.657\thl = 153\n"
+                         "level: nm = 137.56.0\tE = 0\thl = 0\n"
+                         "beta: from = 137.55.0\tto = 137.56.1\tI = 94.7\tforbidden = 1\n"
+                         "beta: from = 137.55.0\tto = 137.56.0\tI = 5.3\tforbidden = 2\n"
+                         "gamma: from = 137.56.1\tto = 137.56.0\tIgamma = 85.1\tCE_K = 0.0915\tCE_L = 0.0165@0.87:0.08:0.05\n");
+        L = new NucDecayLibrary(dir);
+    }
+    return L->getGenerator("Cs137");
+}
+
+// NucDecaySystem::genDecays decays/s, by thread count (0 for all hardware threads)
+REGISTER_BENCHMARK(NucDecaySystem, 1, 0) {
+    S.pause();
+    auto& G = benchCs137();
+    S.resume();
+
+    const size_t ndecay = 100000;
+    NucDecayBatch B;
+    size_t np = 0;
+    for(size_t i = 0; i < S.iterations; ++i) {
+        B.clear();
+        G.genDecays(B, ndecay, 1, i*ndecay, S.arg);
+        np += B.size();
+    }
+    S.items = S.iterations*ndecay;
+    S.counters["particles_per_decay"] = double(np)/S.items;
+}
@@ -0,0 +1,127 @@
+/// \file benchPipeline.cc End-to-end configured pipeline throughput: SyntheticDAQ -> OrderingQueue -> Parallel/Clusterer -> Collator -> HDF5
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "Benchmark.hh"
+#include "SyntheticDAQ.hh"
+#include "ConfigOrderQ.hh"
+#include "ConfigParallel.hh"
+#include "HDF5_CfgLoader.hh"
+#include <memory>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+/// SynthHit HDF5 table layout
+template<>
+inline HDF5_Table_Spec HDF5_table_setup<SynthHit>(const string& tname, int version) {
+    return HDF5_TABLE_SPEC(SynthHit, tname.size()? tname : "SynthHit", "synthetic DAQ hit", version,
+                           HDF5_FIELD(SynthHit, t), HDF5_FIELD(SynthHit, evt), HDF5_FIELD(SynthHit, t_wall),
+                           HDF5_FIELD(SynthHit, det), HDF5_FIELD(SynthHit, npay), HDF5_FIELD(SynthHit, payload));
+}
+
+/// HDF5 writer to configured `file`
+class SynthH5Out: public HDF5_CfgWriter<SynthHit> {
+public:
+    /// Constructor
+    explicit SynthH5Out(const Setting& S): HDF5_CfgWriter<SynthHit>(S) {
+        string f;
+        if(S.lookupValue("file", f)) openOutput(f);
+    }
+};
+
+/// synthetic pipeline stages, by configuration class name
+typedef SyntheticDAQ<SynthHit> SynthDAQ;
+typedef ConfigOrderQ<const SynthHit> SynthOrderQ;
+typedef ConfigParallel<const SynthHit> SynthParallel;
+typedef SynthWorkLink<const SynthHit> SynthWork;
+typedef SynthLatencyProbe<const SynthHit> SynthLatency;
+REGISTER_CONFIGURABLE(SynthDAQ)
+REGISTER_CONFIG(SynthOrderQ, DataSink<const SynthHit>)
+REGISTER_CONFIG(SynthParallel, DataSink<const SynthHit>)
+REGISTER_CONFIG(SynthWork, DataSink<const SynthHit>)
+REGISTER_CONFIG(SynthLatency, DataSink<const SynthHit>)
+REGISTER_CONFIG(SynthH5Out, DataSink<const SynthHit>)
+
+/// temporary pipeline output
+static const string pipelineH5 = "/tmp/mpmbench_pipeline.h5";
+
+/// representative DAQ chain configuration, with nthreads parallel chains
+static string pipelineCfg(int nthreads) {
+    return "class = \"SynthDAQ\"; n = 200000; rate = 1e6; multiplicity = 4; cluster_width = 100; disorder = 2000; payload = 8;\n"
+           "next = { class = \"SynthOrderQ\"; dt = 2100.; profile = true;\n"
+           "  next = { class = \"SynthParallel\"; nthreads = " + std::to_string(nthreads) + "; ringsize = 4096; cluster_dt = 200.; profile = true;\n"
+           "    parallel = { class = \"SynthWork\"; work = 16; };\n"
+           "    next = { class = \"SynthLatency\";\n"
+           "      next = { class = \"SynthH5Out\"; file = \"" + pipelineH5 + "\"; profile = true; }; }; }; };\n";
+}
+
+/// redirect stdout to /dev/null while in scope (stage configuration printouts)
+class BenchQuiet {
+public:
+    /// Constructor
+    BenchQuiet(): fd(dup(fileno(stdout))) {
+        fflush(stdout);
+        int n = open("/dev/null", O_WRONLY);
+        dup2(n, fileno(stdout));
+        close(n);
+    }
+    /// Destructor
+    ~BenchQuiet() {
+        fflush(stdout);
+        dup2(fd, fileno(stdout));
+        close(fd);
+    }
+protected:
+    int fd;     ///< saved stdout
+};
+
+// configured DAQ chain hits/s end-to-end (OrderingQueue, Parallel clustering with per-hit work, Collator, HDF5 output),
+// by number of parallel chains; latency percentiles from emission to post-collation, inclusive ns/hit at profiled stages
+REGISTER_BENCHMARK(Pipeline, 0, 1, 2, 4, 8, 16, 32, 64, 128) {
+    S.pause();
+    BenchQuiet Q;
+    Config C;
+    C.readString(pipelineCfg(S.arg));
+    LatencyHistogram L;
+    map<string, std::pair<double, double>> stages;
+    size_t n = 0, nDisordered = 0;
+
+    for(size_t i = 0; i < S.iterations; ++i) {
+        std::unique_ptr<Configurable> CC(constructCfgObj<Configurable>(C.getRoot(), ""));
+        auto D = dynamic_cast<SynthDAQ*>(CC.get());
+        if(!D) throw std::logic_error("Pipeline configuration top class is not SynthDAQ");
+        S.resume();
+        D->run();
+        S.pause();
+        n += D->nEmit;
+
+        // chain traversal through (collated) outputs
+        _DataSink* s = D->getNext();
+        for(int j = 0; s; ++j) {
+            auto P = dynamic_cast<ProfiledLink<const SynthHit>*>(s);
+            if(P) {
+                auto& st = stages[std::to_string(j) + "_" + P->zone];
+                st.first += P->prof.t_ns;
+                st.second += P->prof.nitems;
+            }
+            auto LP = dynamic_cast<SynthLatency*>(s);
+            if(LP) {
+                L += LP->L;
+                nDisordered += LP->nDisordered;
+            }
+            auto u = dynamic_cast<_SinkUser*>(s);
+            s = u? u->_getNext() : nullptr;
+        }
+    }
+    remove(pipelineH5.c_str());
+
+    if(L.n != n) throw std::runtime_error("Pipeline lost hits");
+    if(nDisordered) throw std::runtime_error("Pipeline output out of order");
+    S.items = n;
+    S.bytes = n*sizeof(SynthHit);
+    S.counters["latency_p50_us"] = 1e-3*L.quantile(0.5);
+    S.counters["latency_p99_us"] = 1e-3*L.quantile(0.99);
+    S.counters["latency_p999_us"] = 1e-3*L.quantile(0.999);
+    S.counters["latency_max_us"] = 1e-3*L.max;
+    for(auto& kv: stages) S.counters["stage" + kv.first + "_ns_per_hit"] = kv.second.second? kv.second.first/kv.second.second : 0;
+}
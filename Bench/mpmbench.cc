@@ -0,0 +1,180 @@
+/// \file mpmbench.cc Run registered microbenchmarks, with optional JSON results for regression tracking
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "Benchmark.hh"
+#include "CodeVersion.hh"
+#include "Profiler.hh"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// results for one benchmark parameter
+struct BenchResult {
+    string name;            ///< benchmark name
+    int64_t arg;            ///< parameter
+    size_t iterations;      ///< iterations per repetition
+    vector<double> t;       ///< per-iteration time for each repetition [s]
+    double items_per_s;     ///< items rate (median repetition)
+    double bytes_per_s;     ///< bytes rate (median repetition)
+    map<string,double> counters;    ///< reported counters
+
+    /// full name
+    string fullName() const { return name + "/" + std::to_string(arg); }
+    /// median per-iteration time
+    double median() const { auto v = t; std::sort(v.begin(), v.end()); return v[v.size()/2]; }
+    /// mean per-iteration time
+    double mean() const { double s = 0; for(auto x: t) s += x; return s/t.size(); }
+    /// standard deviation of per-iteration time
+    double stddev() const {
+        if(t.size() < 2) return 0;
+        double m = mean(), s = 0;
+        for(auto x: t) s += (x-m)*(x-m);
+        return sqrt(s/(t.size()-1));
+    }
+};
+
+/// run benchmark at parameter: calibrate iterations to min_time, then repeat
+BenchResult runBenchmark(const Benchmark& B, int64_t arg, double min_time, int reps) {
+    // calibration (also warm-up)
+    size_t n = 1;
+    while(true) {
+        BenchState S(arg, n);
+        B.f(S);
+        double t = S.seconds();
+        if(t >= min_time || n >= (1 << 30)) break;
+        double nx = t > 0? 1.4*n*min_time/t : 10.*n;
+        n = std::max(n + 1, std::min(size_t(nx), 10*n));
+    }
+
+    BenchResult R{B.name, arg, n, {}, 0, 0, {}};
+    vector<BenchState> v;
+    vector<std::pair<double,size_t>> ts;
+    for(int i = 0; i < reps; ++i) {
+        ProfileZone Z(R.fullName());
+        v.emplace_back(arg, n);
+        B.f(v.back());
+        ts.emplace_back(v.back().seconds(), i);
+        R.t.push_back(ts.back().first/n);
+    }
+    std::sort(ts.begin(), ts.end());
+    auto& m = ts[ts.size()/2];
+    auto& S = v[m.second];
+    R.items_per_s = S.items/m.first;
+    R.bytes_per_s = S.bytes/m.first;
+    R.counters = S.counters;
+    return R;
+}
+
+/// JSON-escaped quoted string
+static string json_str(const string& s) {
+    string r = "\"";
+    for(char c: s) {
+        if(c == '"' || c == '\\') r += '\\';
+        if((unsigned char)c < 0x20) {
+            char b[8];
+            snprintf(b, sizeof(b), "\\u%04x", c);
+            r += b;
+        } else r += c;
+    }
+    return r + "\"";
+}
+
+/// write results as JSON
+void writeJSON(std::ostream& o, const vector<BenchResult>& v, double min_time, int reps) {
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    o << "{\n  \"context\": {\n";
+    o << "    \"date\": " << json_str(date) << ",\n";
+    o << "    \"host\": " << json_str(CodeVersion::host) << ",\n";
+    o << "    \"repo_version\": " << json_str(CodeVersion::repo_version) << ",\n";
+    o << "    \"repo_tagname\": " << json_str(CodeVersion::repo_tagname) << ",\n";
+    o << "    \"compiler\": " << json_str(CodeVersion::compiler) << ",\n";
+    o << "    \"compile_time\": " << json_str(CodeVersion::compile_time) << ",\n";
+    o << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+    o << "    \"min_time\": " << min_time << ",\n";
+    o << "    \"repetitions\": " << reps << "\n  },\n";
+    o << "  \"benchmarks\": [";
+    for(size_t i = 0; i < v.size(); ++i) {
+        auto& R = v[i];
+        char b[512];
+        snprintf(b, sizeof(b), "%s\n    {\"name\": %s, \"arg\": %lld, \"iterations\": %zu, \"median_ns\": %.6g, \"mean_ns\": %.6g, \"stddev_ns\": %.6g, \"min_ns\": %.6g, \"items_per_second\": %.6g, \"bytes_per_second\": %.6g",
+                 i? "," : "", json_str(R.fullName()).c_str(), (long long)R.arg, R.iterations, 1e9*R.median(), 1e9*R.mean(), 1e9*R.stddev(),
+                 1e9*(*std::min_element(R.t.begin(), R.t.end())), R.items_per_s, R.bytes_per_s);
+        o << b;
+        for(auto& kv: R.counters) {
+            snprintf(b, sizeof(b), ", %s: %.6g", json_str(kv.first).c_str(), kv.second);
+            o << b;
+        }
+        o << "}";
+    }
+    o << "\n  ]\n}\n";
+}
+
+/// print usage
+void usage() {
+    printf("Usage: mpmbench [--list] [--filter <substring>] [--min_time <s>] [--reps <n>] [--json <file>] [--profile <file.xml>]\n");
+}
+
+/// Run selected benchmarks
+int main(int argc, char** argv) {
+    string filter, jsonfile, proffile;
+    double min_time = 0.2;
+    int reps = 5;
+    bool list = false;
+
+    for(int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        bool hasv = i + 1 < argc;
+        if(a == "--list") list = true;
+        else if(a == "--filter" && hasv) filter = argv[++i];
+        else if(a == "--min_time" && hasv) min_time = atof(argv[++i]);
+        else if(a == "--reps" && hasv) reps = std::max(1, atoi(argv[++i]));
+        else if(a == "--json" && hasv) jsonfile = argv[++i];
+        else if(a == "--profile" && hasv) proffile = argv[++i];
+        else { usage(); return a == "--help"? EXIT_SUCCESS : EXIT_FAILURE; }
+    }
+
+    auto BB = Benchmark::registry();
+    std::sort(BB.begin(), BB.end(), [](const Benchmark& a, const Benchmark& b) { return a.name < b.name; });
+
+    if(proffile.size()) Profiler::enable(true);
+    vector<BenchResult> v;
+    printf("%-40s %14s %12s %14s %12s\n", "benchmark", "ns/iter", "+-%", "items/s", "MB/s");
+    for(auto& B: BB) {
+        for(auto a: B.args) {
+            auto nm = B.name + "/" + std::to_string(a);
+            if(filter.size() && nm.find(filter) == string::npos) continue;
+            if(list) { printf("%s\n", nm.c_str()); continue; }
+            try { v.push_back(runBenchmark(B, a, min_time, reps)); }
+            catch(std::exception& e) {
+                printf("%-40s *** FAILED: %s\n", nm.c_str(), e.what());
+                continue;
+            }
+            auto& R = v.back();
+            printf("%-40s %14.1f %12.1f %14.4g %12.4g\n", nm.c_str(), 1e9*R.median(), 100*R.stddev()/R.mean(), R.items_per_s, 1e-6*R.bytes_per_s);
+            fflush(stdout);
+        }
+    }
+    if(proffile.size()) {
+        Profiler::enable(false);
+        std::ofstream o(proffile);
+        XMLStreamWriter W(o);
+        ProfileReport().writeXML(W);
+    }
+
+    if(jsonfile.size()) {
+        std::ofstream o(jsonfile);
+        if(!o) { printf("Unable to write '%s'\n", jsonfile.c_str()); return EXIT_FAILURE; }
+        writeJSON(o, v, min_time, reps);
+        printf("Results written to '%s'\n", jsonfile.c_str());
+    }
+    return EXIT_SUCCESS;
+}
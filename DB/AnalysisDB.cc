@@ -14,6 +14,14 @@
 #include <functional>
 
 AnalysisDB* AnalysisDB::myDB = nullptr;
+AnaResultUploader* AnalysisDB::myUploader = nullptr;
+
+void AnalysisDB::closeDB() {
+    if(myUploader) { delete myUploader; myUploader = nullptr; }
+    if(myDB) { delete myDB; myDB = nullptr; }
+}
+
+AnaResultUploader& AnalysisDB::Uploader() { return *(myUploader? myUploader : myUploader = new AnaResultUploader(DB())); }
 
 string ADBfile() {
     string dbvar = PROJ_ENV_PFX()+"_ANADB";
@@ -30,7 +38,13 @@ string ADBfile() {
     return dbfile;
 }
 
-AnalysisDB::AnalysisDB(): SQLite_Helper(ADBfile()) { }
+AnalysisDB::AnalysisDB(): SQLite_Helper(ADBfile()) {
+    // parallel jobs logging to one DB: WAL, and wait longer in busy handler before spinning in busyRetry
+    string profile = "concurrent-write";
+    optionalGlobalArg("AnaDBprofile", profile, "Analysis DB tuning profile (concurrent-write, read-mostly, bulk-load, or none)");
+    if(profile != "none") applyProfile(profile);
+    setBusyBackoff(2000);
+}
 
 sqlite3_int64 AnalysisDB::createAnaRun(const string& dataname) {
     auto t = time(nullptr);
@@ -51,6 +65,10 @@ sqlite3_int64 AnalysisDB::createAnaRun(const string& dataname) {
 }
 
 sqlite3_int64 AnalysisDB::getAnaVar(const string& name, const string& unit, const string& descrip) {
+    auto k = std::make_pair(name, descrip);
+    auto it = varIDs.find(k);
+    if(it != varIDs.end()) return it->second;
+
     auto stmt = loadStatement("INSERT OR IGNORE INTO analysis_vars(var_id,name,unit,descrip) VALUES (?1,?2,?3,?4)");
     sqlite3_bind_int64(stmt, 1, std::hash<string>{}(name));
     sqlite3_bind_text(stmt, 2, name.c_str(), -1, SQLITE_STATIC);
@@ -65,6 +83,8 @@ sqlite3_int64 AnalysisDB::getAnaVar(const string& name, const string& unit, cons
     busyRetry(stmt2);
     sqlite3_int64 var_id = sqlite3_column_int64(stmt2, 0);
     sqlite3_reset(stmt2);
+    // cache only once committed (not inside a transaction that may be rolled back)
+    if(!txdepth) varIDs.emplace(k, var_id);
     return var_id;
 }
 
@@ -91,6 +111,110 @@ void AnalysisDB::uploadAnaResult(sqlite3_int64 run_id, sqlite3_int64 var_id, con
     sqlite3_reset(stmt);
 }
 
+void AnalysisDB::uploadAnaResults(sqlite3_int64 run_id, const vector<AnaResult>& v) {
+    vector<std::pair<sqlite3_int64, const AnaResult*>> rv;
+    for(auto& r: v) rv.emplace_back(run_id, &r);
+    uploadAnaResults(rv);
+}
+
+void AnalysisDB::uploadAnaResults(const vector<std::pair<sqlite3_int64, const AnaResult*>>& v) {
+    typedef std::tuple<sqlite3_int64, sqlite3_int64, double, double> result_t;
+    typedef std::tuple<sqlite3_int64, sqlite3_int64, string> xresult_t;
+    vector<result_t> vr;
+    vector<xresult_t> vx;
+    map<std::pair<string,string>, sqlite3_int64> newIDs;   // looked up in this transaction
+
+    beginTransaction();
+    try {
+        for(auto& rr: v) {
+            auto& r = *rr.second;
+            auto k = std::make_pair(r.name, r.descrip);
+            auto it = newIDs.find(k);
+            if(it == newIDs.end()) it = newIDs.emplace(k, getAnaVar(r.name, r.unit, r.descrip)).first;
+            if(r.xval.size()) vx.emplace_back(rr.first, it->second, r.xval);
+            else vr.emplace_back(rr.first, it->second, r.val, r.err);
+        }
+        if(vr.size()) bulkExec("INSERT INTO analysis_results(run_id,var_id,val,err) VALUES (?1,?2,?3,?4)", vr);
+        if(vx.size()) bulkExec("INSERT INTO analysis_xresults(run_id,var_id,val) VALUES (?1,?2,?3)", vx);
+    } catch(...) {
+        abortTransaction();
+        throw;
+    }
+    endTransaction();
+    if(!txdepth) for(auto& kv: newIDs) varIDs.insert(kv);
+}
+
+////////////////////////
+////////////////////////
+
+AnaResultUploader::~AnaResultUploader() {
+    try { flush(); }
+    catch(std::exception& e) { fprintf(stderr, "AnalysisDB upload failed: %s\n", e.what()); }
+    finish_mythread();
+}
+
+void AnaResultUploader::queue(sqlite3_int64 run_id, const AnaResult& r) {
+    lock_guard<mutex> l(inputMut);
+    pending.emplace_back(run_id, r);
+    ++nQueued;
+    if(pending.size() >= nbatch) inputReady.notify_one();
+}
+
+void AnaResultUploader::queue(sqlite3_int64 run_id, const vector<AnaResult>& v) {
+    lock_guard<mutex> l(inputMut);
+    for(auto& r: v) pending.emplace_back(run_id, r);
+    nQueued += v.size();
+    if(pending.size() >= nbatch) inputReady.notify_one();
+}
+
+void AnaResultUploader::request_stop() {
+    {
+        lock_guard<mutex> l(inputMut);
+        stopping = true;
+    }
+    Threadworker::request_stop();
+}
+
+void AnaResultUploader::flush() {
+    unique_lock<mutex> l(inputMut);
+    auto n = nQueued;
+    flushRequested = true;
+    inputReady.notify_one();
+    committed.wait(l, [this, n] { return nCommitted >= n; });
+    if(error.size()) {
+        string e;
+        std::swap(e, error);
+        throw std::runtime_error(e);
+    }
+}
+
+void AnaResultUploader::threadjob() {
+    vector<std::pair<sqlite3_int64, AnaResult>> v;
+    while(true) {
+        {
+            unique_lock<mutex> l(inputMut);
+            inputReady.wait(l, [this] { return pending.size() >= nbatch || flushRequested || stopping; });
+            std::swap(v, pending);
+            flushRequested = false;
+            if(v.empty() && stopping) break;
+        }
+
+        string err;
+        try {
+            // one transaction for whole batch
+            vector<std::pair<sqlite3_int64, const AnaResult*>> rv;
+            for(auto& kv: v) rv.emplace_back(kv.first, &kv.second);
+            DB.uploadAnaResults(rv);
+        } catch(std::exception& e) { err = e.what(); }
+
+        lock_guard<mutex> l(inputMut);
+        nCommitted += v.size();
+        if(err.size()) error = err;
+        v.clear();
+        committed.notify_all();
+    }
+}
+
 void AnaResult::display() const {
     printf("%s [%s]:\t", name.c_str(), descrip.c_str());
     if(xval.size()) printf("%s [%s]\n", xval.c_str(), unit.c_str());
@@ -9,30 +9,44 @@
 #define ANALYSISDB_HH
 
 #include "SQLite_Helper.hh"
+#include "Threadworker.hh"
 #include <stdio.h>
+#include <memory>
+
+struct AnaResult;
+class AnaResultUploader;
 
 /// Calibration database interface
 class AnalysisDB: public SQLite_Helper {
 public:
     /// get singleton instance
     static AnalysisDB& DB() { return *(myDB? myDB : myDB = new AnalysisDB()); }
-    /// close and delete instance
-    static void closeDB() { if(myDB) { delete myDB; myDB = nullptr; } }
+    /// close and delete instance (after flushing queued uploads)
+    static void closeDB();
+    /// get singleton background uploader for DB() (launched on first use)
+    static AnaResultUploader& Uploader();
 
     /// create analysis run identifier
     sqlite3_int64 createAnaRun(const string& dataname);
-    /// get (or create) analysis variable identifier
+    /// get (or create) analysis variable identifier (cached after first lookup)
     sqlite3_int64 getAnaVar(const string& name, const string& unit, const string& descrip);
     /// upload analysis result
     void uploadAnaResult(sqlite3_int64 run_id, sqlite3_int64 var_id, double val, double err);
     /// upload text analysis result
     void uploadAnaResult(sqlite3_int64 run_id, sqlite3_int64 var_id, const string& val);
+    /// upload list of (numeric and text) results in one transaction, re-using prepared statements
+    void uploadAnaResults(sqlite3_int64 run_id, const vector<AnaResult>& v);
+    /// upload list of (run_id, result) in one transaction
+    void uploadAnaResults(const vector<std::pair<sqlite3_int64, const AnaResult*>>& v);
 
 protected:
     /// Constructor
     AnalysisDB();
 
     static AnalysisDB* myDB;    ///< singleton instance of DB connection
+    static AnaResultUploader* myUploader;   ///< singleton uploader
+
+    map<std::pair<string,string>, sqlite3_int64> varIDs; ///< cached variable identifiers by (name, descrip)
 };
 
 /// Struct for holding analysis results until upload
@@ -52,4 +66,37 @@ struct AnaResult {
     string xval;        ///< text value (supercedes val/err)
 };
 
+/// Background uploader accumulating results from many threads, committed in large transactions
+class AnaResultUploader: protected Threadworker {
+public:
+    /// Constructor, with DB (used only from upload thread after launch) and commit batch size
+    explicit AnaResultUploader(AnalysisDB& D, size_t nb = 4096): DB(D), nbatch(nb) { launch_mythread(); }
+    /// Destructor: commits outstanding results
+    ~AnaResultUploader();
+
+    /// queue result for upload (thread-safe)
+    void queue(sqlite3_int64 run_id, const AnaResult& r);
+    /// queue list of results for upload (thread-safe)
+    void queue(sqlite3_int64 run_id, const vector<AnaResult>& v);
+    /// block until all results queued so far are committed; rethrows upload thread errors
+    void flush();
+
+    size_t nQueued = 0;     ///< number of results queued
+    size_t nCommitted = 0;  ///< number of results committed (or failed)
+
+protected:
+    /// upload loop: commit whenever batch fills, flush is requested, or stopping
+    void threadjob() override;
+    /// mark stopping (under lock) before requesting stop
+    void request_stop() override;
+
+    AnalysisDB& DB;         ///< database
+    const size_t nbatch;    ///< upload batch size triggering commit
+    vector<std::pair<sqlite3_int64, AnaResult>> pending;   ///< results awaiting commit
+    bool flushRequested = false;    ///< whether flush() is waiting
+    bool stopping = false;  ///< whether stop was requested
+    string error;           ///< error message from upload thread
+    std::condition_variable committed;  ///< notified after each commit
+};
+
 #endif
@@ -7,19 +7,78 @@
 
 #include "ConfigDB_Helper.hh"
 
-Stringmap ConfigDB_Helper::getConfig(const string& family, const string& name) {
+ConfigDB_Cache::config_t ConfigDB_Cache::find(sqlite3_int64 cid) {
+    std::lock_guard<std::mutex> l(cacheMut);
+    auto it = byID.find(cid);
+    if(it == byID.end()) { ++nMiss; return nullptr; }
+    ++nHit;
+    return it->second;
+}
+
+bool ConfigDB_Cache::findID(const string& family, const string& name, sqlite3_int64& cid) {
+    std::lock_guard<std::mutex> l(cacheMut);
+    auto it = IDs.find({family, name});
+    if(it == IDs.end()) return false;
+    cid = it->second;
+    return true;
+}
+
+ConfigDB_Cache::config_t ConfigDB_Cache::insert(sqlite3_int64 cid, Stringmap&& m) {
+    config_t c = std::make_shared<const Stringmap>(std::move(m));
+    std::lock_guard<std::mutex> l(cacheMut);
+    return byID.emplace(cid, c).first->second;
+}
+
+void ConfigDB_Cache::insertID(const string& family, const string& name, sqlite3_int64 cid) {
+    std::lock_guard<std::mutex> l(cacheMut);
+    IDs.emplace(std::make_pair(family, name), cid);
+}
+
+void ConfigDB_Cache::clear() {
+    std::lock_guard<std::mutex> l(cacheMut);
+    byID.clear();
+    IDs.clear();
+}
+
+////////////////////////
+////////////////////////
+
+void ConfigDB_Helper::checkVersion() {
+    auto stmt = loadStatement("PRAGMA data_version");
+    busyRetry(stmt);
+    sqlite3_int64 v = sqlite3_column_int64(stmt, 0);
+    sqlite3_reset(stmt);
+    sqlite3_int64 n = sqlite3_total_changes(db);
+    if(v != data_version || n != n_changes) {
+        // first check also clears: (shared) cache may predate this connection's view
+        cache->clear();
+        data_version = v;
+        n_changes = n;
+    }
+}
+
+ConfigDB_Cache::config_t ConfigDB_Helper::getConfigShared(const string& family, const string& name) {
+    checkVersion();
+    sqlite3_int64 n = -1;
+    if(cache->findID(family, name, n)) return getConfigShared(n);
+
     auto stmt = loadStatement("SELECT rowid FROM config_values WHERE name = ?1 AND family = ?2");
     sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 2, family.c_str(), -1, SQLITE_STATIC);
 
     int rc = busyRetry(stmt);
-    sqlite3_int64 n = (rc == SQLITE_ROW)? sqlite3_column_int64(stmt, 0) : -1;
+    n = (rc == SQLITE_ROW)? sqlite3_column_int64(stmt, 0) : -1;
     sqlite3_reset(stmt);
 
-    return getConfig(n);
+    cache->insertID(family, name, n);
+    return getConfigShared(n);
 }
 
-Stringmap ConfigDB_Helper::getConfig(sqlite3_int64 cid) {
+ConfigDB_Cache::config_t ConfigDB_Helper::getConfigShared(sqlite3_int64 cid) {
+    checkVersion();
+    auto c = cache->find(cid);
+    if(c) return c;
+
     auto stmt = loadStatement("SELECT name,value FROM config_values WHERE csid = ?1");
     sqlite3_bind_int64(stmt, 1, cid);
 
@@ -31,23 +90,41 @@ Stringmap ConfigDB_Helper::getConfig(sqlite3_int64 cid) {
         m.insert(k,v);
     }
     sqlite3_reset(stmt);
-    return m;
+    return cache->insert(cid, std::move(m));
 }
 
-map<string, Stringmap> ConfigDB_Helper::getConfigs(const string& family) {
+vector<std::pair<sqlite3_int64, string>> ConfigDB_Helper::loadFamily(const string& family) {
+    checkVersion();
+
     auto stmt = loadStatement("SELECT rowid,name FROM config_set WHERE family = ?1");
     sqlite3_bind_text(stmt, 1, family.c_str(), -1, SQLITE_STATIC);
-
-    vector<sqlite3_int64> ids;
-    vector<string> nms;
+    vector<std::pair<sqlite3_int64, string>> ids;
     while(busyRetry(stmt)== SQLITE_ROW) {
-        ids.push_back(sqlite3_column_int64(stmt, 0));
-        nms.push_back(string());
-        get_string(stmt, 0, nms.back());
+        ids.emplace_back(sqlite3_column_int64(stmt, 0), "");
+        get_string(stmt, 1, ids.back().second);
     }
     sqlite3_reset(stmt);
 
+    // all family member values in one query
+    auto stmt2 = loadStatement("SELECT csid,name,value FROM config_values WHERE csid IN (SELECT rowid FROM config_set WHERE family = ?1)");
+    sqlite3_bind_text(stmt2, 1, family.c_str(), -1, SQLITE_STATIC);
+    map<sqlite3_int64, Stringmap> ms;
+    while(busyRetry(stmt2)== SQLITE_ROW) {
+        string k,v;
+        get_string(stmt2, 1, k);
+        get_string(stmt2, 2, v);
+        ms[sqlite3_column_int64(stmt2, 0)].insert(k,v);
+    }
+    sqlite3_reset(stmt2);
+
+    for(auto& kv: ids) cache->insert(kv.first, std::move(ms[kv.first]));
+    return ids;
+}
+
+size_t ConfigDB_Helper::preloadConfigs(const string& family) { return loadFamily(family).size(); }
+
+map<string, Stringmap> ConfigDB_Helper::getConfigs(const string& family) {
     map<string, Stringmap> f;
-    for(size_t i=0; i<ids.size(); i++) f.emplace(nms[i],getConfig(ids[i]));
+    for(auto& kv: loadFamily(family)) f.emplace(kv.second, *getConfigShared(kv.first));
     return f;
 }
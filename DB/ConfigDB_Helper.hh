@@ -9,20 +9,73 @@
 #define CONFIGDB_HELPER_HH
 
 #include "SQLite_Helper.hh"
-#include "Stringmap.hh"
+#include "FlatStringmap.hh"
+#include <memory>
+#include <mutex>
+
+/// Read-through cache of configurations, shareable between ConfigDB_Helper connections (e.g. SQLite_Pool readers)
+class ConfigDB_Cache {
+public:
+    /// immutable shared configuration
+    typedef std::shared_ptr<const Stringmap> config_t;
+
+    /// find cached configuration by ID; nullptr if not cached
+    config_t find(sqlite3_int64 cid);
+    /// find cached configuration ID by (family, name); false if not cached
+    bool findID(const string& family, const string& name, sqlite3_int64& cid);
+    /// cache configuration by ID
+    config_t insert(sqlite3_int64 cid, Stringmap&& m);
+    /// cache (family, name) ID lookup
+    void insertID(const string& family, const string& name, sqlite3_int64 cid);
+    /// discard all cached values
+    void clear();
+
+    size_t nHit = 0;    ///< lookups satisfied from cache
+    size_t nMiss = 0;   ///< lookups queried from DB
+
+protected:
+    std::mutex cacheMut;    ///< protects cache contents
+    map<sqlite3_int64, config_t> byID;  ///< configurations by ID
+    map<std::pair<string, string>, sqlite3_int64> IDs;  ///< IDs by (family, name)
+};
 
 /// Interface to SQLite3 "configuration database" schema
 class ConfigDB_Helper: public SQLite_Helper {
 public:
-    /// Constructor
-    explicit ConfigDB_Helper(const string& dbname): SQLite_Helper(dbname) { }
+    /// Constructor; optionally read-only (e.g. as per-thread SQLite_Pool<ConfigDB_Helper> reader)
+    explicit ConfigDB_Helper(const string& dbname, bool readonly = false):
+    SQLite_Helper(dbname, readonly, !readonly), cache(std::make_shared<ConfigDB_Cache>()) { }
 
     /// Get named configuration as Stringmap
-    Stringmap getConfig(const string& family, const string& name);
+    Stringmap getConfig(const string& family, const string& name) { return *getConfigShared(family, name); }
     /// Get configuration by ID number
-    Stringmap getConfig(sqlite3_int64 cid);
-    /// Get all configurations in family
+    Stringmap getConfig(sqlite3_int64 cid) { return *getConfigShared(cid); }
+    /// Get named configuration as FlatStringmap (interned keys, values parsed once)
+    FlatStringmap getConfigFlat(const string& family, const string& name) { return *getConfigShared(family, name); }
+    /// Get all configurations in family (loading every member into cache)
     map<string, Stringmap> getConfigs(const string& family);
+
+    /// Get (cached, shared) named configuration
+    ConfigDB_Cache::config_t getConfigShared(const string& family, const string& name);
+    /// Get (cached, shared) configuration by ID number
+    ConfigDB_Cache::config_t getConfigShared(sqlite3_int64 cid);
+    /// Load all configurations in family into cache with one query; return number loaded
+    size_t preloadConfigs(const string& family);
+
+    /// use cache shared with other connections to same DB
+    void shareCache(const ConfigDB_Helper& H) { cache = H.cache; }
+    /// get cache
+    ConfigDB_Cache& getCache() { return *cache; }
+
+protected:
+    /// clear cache if DB changed (by this or other connections) since last check
+    void checkVersion();
+    /// load configurations for family into cache; return (rowid, name) of each
+    vector<std::pair<sqlite3_int64, string>> loadFamily(const string& family);
+
+    std::shared_ptr<ConfigDB_Cache> cache;  ///< cached configurations
+    sqlite3_int64 data_version = -1;        ///< last seen PRAGMA data_version (changes by other connections)
+    sqlite3_int64 n_changes = -1;           ///< last seen total changes by this connection
 };
 
 #endif
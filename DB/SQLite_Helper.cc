@@ -9,6 +9,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>   // for strcasecmp
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdexcept>
@@ -48,12 +49,72 @@ SQLite_Helper::SQLite_Helper(const string& dbname, bool readonly, bool create) {
         throw e;
     }
 
-    sqlite3_busy_timeout(db, 100);
+    setBusyBackoff(busy_max_ms);
 }
 
 SQLite_Helper::SQLite_Helper(sqlite3* _db): db(_db) {
     if(!db) throw std::logic_error("SQLite_Helper initialized with nullptr DB");
-    sqlite3_busy_timeout(db, 100);
+    setBusyBackoff(busy_max_ms);
+}
+
+SQLite_Profile SQLite_Profile::named(const string& name) {
+    SQLite_Profile P;
+    if(name == "") return P;
+    if(name == "concurrent-write") {
+        // WAL: readers do not block writer (or vice-versa); NORMAL sync is durable at checkpoints
+        P.journal_mode = "WAL";
+        P.synchronous = 1;
+        P.mmap_size = 256 << 20;
+        P.cache_size = -16384;
+        P.temp_store = 2;
+    } else if(name == "read-mostly") {
+        P.journal_mode = "WAL";
+        P.synchronous = 1;
+        P.mmap_size = sqlite3_int64(1) << 30;
+        P.cache_size = -65536;
+        P.temp_store = 2;
+    } else if(name == "bulk-load") {
+        // no crash safety: rebuild on failure
+        P.journal_mode = "MEMORY";
+        P.synchronous = 0;
+        P.mmap_size = 256 << 20;
+        P.cache_size = -262144;
+        P.temp_store = 2;
+        P.page_size = 65536;
+    } else throw std::runtime_error("Unknown SQLite tuning profile '" + name + "'");
+    return P;
+}
+
+void SQLite_Helper::applyProfile(const SQLite_Profile& P) {
+    // page_size first: takes effect only before DB is populated, or before changing out of WAL mode
+    if(P.page_size > 0) exec("PRAGMA page_size = " + std::to_string(P.page_size), false);
+    if(P.journal_mode.size()) {
+        auto stmt = loadStatement("PRAGMA journal_mode = " + P.journal_mode);
+        busyRetry(stmt);
+        string m;
+        get_string(stmt, 0, m);
+        sqlite3_reset(stmt);
+        if(strcasecmp(m.c_str(), P.journal_mode.c_str()))
+            printf("SQLite journal_mode '%s' unavailable (remains '%s')\n", P.journal_mode.c_str(), m.c_str());
+    }
+    if(P.synchronous >= 0) exec("PRAGMA synchronous = " + std::to_string(P.synchronous), false);
+    if(P.mmap_size >= 0) exec("PRAGMA mmap_size = " + std::to_string(P.mmap_size), false);
+    if(P.cache_size) exec("PRAGMA cache_size = " + std::to_string(P.cache_size), false);
+    if(P.temp_store >= 0) exec("PRAGMA temp_store = " + std::to_string(P.temp_store), false);
+}
+
+void SQLite_Helper::setBusyBackoff(int max_ms) {
+    busy_max_ms = max_ms;
+    sqlite3_busy_handler(db, &SQLite_Helper::busyBackoff, this);
+}
+
+int SQLite_Helper::busyBackoff(void* self, int n) {
+    // 1, 2, 4, ... ms (capped at 128) with jitter; cumulative wait approximately 2^(n+1) ms
+    int dt = 1 << (n < 7? n : 7);
+    int waited = n < 7? (1 << n) - 1 : 127 + 128*(n - 7);
+    if(waited >= static_cast<SQLite_Helper*>(self)->busy_max_ms) return 0;
+    usleep(1000*dt + rand()%(500*dt));
+    return 1;
 }
 
 SQLite_Helper::~SQLite_Helper() {
@@ -85,10 +146,12 @@ sqlite3_stmt* SQLite_Helper::loadStatement(const string& qry) {
 
 int SQLite_Helper::busyRetry(sqlite3_stmt* stmt) {
     int rc;
+    int dt = 10000;
     while((rc = sqlite3_step(stmt)) == SQLITE_BUSY) {
         printf("Waiting for DB retry executing statement...\n");
         fflush(stdout);
-        usleep(500000+(rand()%500000));
+        usleep(dt + rand()%dt);
+        if(dt < 1000000) dt *= 2;
         sqlite3_reset(stmt);
     }
     return rc;
@@ -147,6 +210,28 @@ int SQLite_Helper::backupTo(sqlite3* dbOut, bool toOther) {
     return sqlite3_errcode(toOther? dbOut : db);
 }
 
+int SQLite_Helper::backupFile(const string& fname, bool toFile, int npages) {
+    sqlite3* dbf = nullptr;
+    int rc = sqlite3_open_v2(fname.c_str(), &dbf, toFile? SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE : SQLITE_OPEN_READONLY, nullptr);
+    if(rc != SQLITE_OK) {
+        std::runtime_error e("Failed to open DB file '" + fname + "', error " + sqlite3_errmsg(dbf));
+        sqlite3_close(dbf);
+        throw e;
+    }
+
+    sqlite3_backup* pBackup = sqlite3_backup_init(toFile? dbf : db, "main", toFile? db : dbf, "main");
+    if(pBackup) {
+        do {
+            rc = sqlite3_backup_step(pBackup, npages);
+            if(rc == SQLITE_BUSY || rc == SQLITE_LOCKED) sqlite3_sleep(10);
+        } while(rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+        (void)sqlite3_backup_finish(pBackup);
+    }
+    rc = sqlite3_errcode(toFile? dbf : db);
+    sqlite3_close(dbf);
+    return rc;
+}
+
 vector<char> SQLite_Helper::toBlob() {
     vector<char> v(db_size());
 
@@ -16,6 +16,22 @@ using std::map;
 using std::string;
 #include <vector>
 using std::vector;
+#include <tuple>
+#include <utility>
+#include <stdexcept>
+
+/// Open-time performance tuning PRAGMAs (unset values left at SQLite defaults)
+struct SQLite_Profile {
+    string journal_mode;        ///< journal mode, e.g. "WAL" (persistent in DB file; not for network filesystems)
+    int synchronous = -1;       ///< synchronous level: 0 OFF, 1 NORMAL, 2 FULL
+    sqlite3_int64 mmap_size = -1;   ///< memory-mapped I/O size [bytes]
+    int cache_size = 0;         ///< page cache size: > 0 in pages, < 0 in KiB
+    int temp_store = -1;        ///< temporary storage: 0 DEFAULT, 1 FILE, 2 MEMORY
+    int page_size = 0;          ///< page size [bytes]; only effective before DB file is populated (or in VACUUM)
+
+    /// named profile: "concurrent-write", "read-mostly", "bulk-load", or "" (defaults); throws on unknown name
+    static SQLite_Profile named(const string& name);
+};
 
 /// Convenience wrapper for SQLite3 database interface
 class SQLite_Helper {
@@ -27,16 +43,25 @@ public:
     /// Destructor
     virtual ~SQLite_Helper();
 
+    /// apply tuning profile PRAGMAs to open DB
+    void applyProfile(const SQLite_Profile& P);
+    /// apply named tuning profile
+    void applyProfile(const string& name) { applyProfile(SQLite_Profile::named(name)); }
+    /// install exponential-backoff busy handler, waiting up to max_ms total before returning SQLITE_BUSY
+    void setBusyBackoff(int max_ms);
+
     /// BEGIN TRANSACTION command
     int beginTransaction(bool exclusive=false) { return (txdepth++)? SQLITE_OK : exec(exclusive? "BEGIN EXCLUSIVE TRANSACTION" : "BEGIN TRANSACTION"); }
     /// END TRANSACTION command
     int endTransaction() { return (--txdepth)? SQLITE_OK : exec("END TRANSACTION"); }
+    /// ROLLBACK of (all nested levels of) current transaction
+    int abortTransaction() { if(!txdepth) return SQLITE_OK; txdepth = 0; return exec("ROLLBACK TRANSACTION", false); }
 
     /// set up query for use
     int setQuery(const char* qry, sqlite3_stmt*& stmt);
     /// load a cached statement
     sqlite3_stmt* loadStatement(const string& qry);
-    /// retry a query until DB is available
+    /// retry a query until DB is available (with exponential backoff between retries)
     int busyRetry(sqlite3_stmt* stmt);
     /// run a statement expecting no return values (using busyRetry); optionally, throw error if not SQLITE_OK
     int exec(const string& qry, bool checkOK = true);
@@ -48,6 +73,63 @@ public:
     /// bind a vector<double> as a blob to a statement parameter
     int bindVecBlob(sqlite3_stmt* stmt, int i, const vector<double>& v);
 
+    /// bind integer to statement parameter i (starting from 1)
+    static int bindValue(sqlite3_stmt* stmt, int i, int v) { return sqlite3_bind_int(stmt, i, v); }
+    /// bind 64-bit integer to statement parameter i
+    static int bindValue(sqlite3_stmt* stmt, int i, sqlite3_int64 v) { return sqlite3_bind_int64(stmt, i, v); }
+    /// bind floating-point value to statement parameter i
+    static int bindValue(sqlite3_stmt* stmt, int i, double v) { return sqlite3_bind_double(stmt, i, v); }
+    /// bind text (not copied: must remain valid until statement is stepped) to statement parameter i
+    static int bindValue(sqlite3_stmt* stmt, int i, const string& v) { return sqlite3_bind_text(stmt, i, v.c_str(), -1, SQLITE_STATIC); }
+    /// bind vector<double> blob (not copied) to statement parameter i
+    static int bindValue(sqlite3_stmt* stmt, int i, const vector<double>& v) { return sqlite3_bind_blob(stmt, i, v.data(), v.size()*sizeof(double), SQLITE_STATIC); }
+    /// bind tuple elements to statement parameters 1, 2, ...
+    template<typename... T>
+    static void bindRow(sqlite3_stmt* stmt, const std::tuple<T...>& r) { _bindRow(stmt, r, std::index_sequence_for<T...>{}); }
+
+    /// run cached statement qry once per row, bound by bind(stmt, row), in one transaction; throw on failure (after rolling back); return number of rows
+    template<typename Row, typename F>
+    size_t bulkExec(const string& qry, const vector<Row>& rows, F bind) {
+        auto stmt = loadStatement(qry);
+        beginTransaction();
+        for(auto& r: rows) {
+            bind(stmt, r);
+            int rc = busyRetry(stmt);
+            sqlite3_reset(stmt);
+            if(rc != SQLITE_DONE && rc != SQLITE_ROW) {
+                string err = sqlite3_errmsg(db);
+                sqlite3_clear_bindings(stmt);
+                abortTransaction();
+                throw std::runtime_error("Failed bulk exec '" + qry + "' => '" + err + "'");
+            }
+        }
+        sqlite3_clear_bindings(stmt);
+        endTransaction();
+        return rows.size();
+    }
+    /// run cached statement qry once per tuple row, in one transaction
+    template<typename... T>
+    size_t bulkExec(const string& qry, const vector<std::tuple<T...>>& rows) {
+        return bulkExec(qry, rows, [](sqlite3_stmt* s, const std::tuple<T...>& r) { bindRow(s, r); });
+    }
+
+    /// bulk-load rows by insq (e.g. "INSERT INTO tmp VALUES (?1,?2)") into TEMP table tname(cols), then run mergeq (e.g. "INSERT INTO t SELECT ... FROM tmp") and empty tname, all in one transaction
+    template<typename Row, typename F>
+    size_t bulkMerge(const string& tname, const string& cols, const string& insq, const vector<Row>& rows, F bind, const string& mergeq) {
+        beginTransaction();
+        try {
+            exec("CREATE TEMP TABLE IF NOT EXISTS " + tname + "(" + cols + ")");
+            bulkExec(insq, rows, bind);
+            exec(mergeq);
+            exec("DELETE FROM " + tname);
+        } catch(...) {
+            abortTransaction();
+            throw;
+        }
+        endTransaction();
+        return rows.size();
+    }
+
     /// get databse file page size (bytes)
     int page_size();
     /// get databse file number of pages
@@ -61,8 +143,21 @@ public:
 
     /// use online backup calls to clone DB from other (or vice-versa)
     int backupTo(sqlite3* dbOut, bool toOther = true);
+    /// incremental online backup (npages per step, other connections may proceed between steps) to (or from) DB file; return SQLite error code
+    int backupFile(const string& fname, bool toFile = true, int npages = 256);
 
 protected:
+    /// bind tuple elements
+    template<typename Tup, size_t... I>
+    static void _bindRow(sqlite3_stmt* stmt, const Tup& r, std::index_sequence<I...>) {
+        int dummy[] = {0, bindValue(stmt, int(I) + 1, std::get<I>(r))...};
+        (void)dummy;
+    }
+
+    /// sqlite3 busy handler callback: exponential backoff with jitter
+    static int busyBackoff(void* self, int n);
+
+    int busy_max_ms = 100;                  ///< total wait in busy handler before returning SQLITE_BUSY
     int txdepth = 0;                        ///< depth of transaction calls
     sqlite3* db = nullptr;                  ///< database connection
     map<string, sqlite3_stmt*> statements;  ///< prepared statements awaiting deletion
@@ -0,0 +1,95 @@
+/// \file SQLite_Pool.hh Thread-safe pool of per-thread read-only connections plus one serialized writer
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SQLITE_POOL_HH
+#define SQLITE_POOL_HH
+
+#include "SQLite_Helper.hh"
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/// Pool of SQLite_Helper-derived connections to one DB file, for sharing between threads.
+/// Each thread gets its own read-only connection (with its own statement cache);
+/// writes go through a single read-write connection, serialized by a mutex.
+/// H must be constructible as H(dbname, readonly). Use a WAL profile so readers do not block the writer.
+template<class H = SQLite_Helper>
+class SQLite_Pool {
+public:
+    /// Constructor, with DB file name and (optional) tuning profile applied to every connection
+    explicit SQLite_Pool(const string& dbname, const string& p = ""): dbfile(dbname), profile(p) { }
+    /// no copy
+    SQLite_Pool(const SQLite_Pool&) = delete;
+    /// no assignment
+    SQLite_Pool& operator=(const SQLite_Pool&) = delete;
+
+    /// calling thread's read-only connection (opened on first use)
+    H& reader() {
+        std::lock_guard<std::mutex> l(poolMut);
+        auto& r = readers[std::this_thread::get_id()];
+        if(!r) {
+            r.reset(new H(dbfile, true));
+            if(profile.size()) r->applyProfile(readProfile());
+        }
+        return *r;
+    }
+    /// close calling thread's read-only connection (e.g. before thread exit)
+    void releaseReader() {
+        std::lock_guard<std::mutex> l(poolMut);
+        readers.erase(std::this_thread::get_id());
+    }
+    /// number of open reader connections
+    size_t nReaders() {
+        std::lock_guard<std::mutex> l(poolMut);
+        return readers.size();
+    }
+
+    /// writer connection, locked for the lifetime of this handle
+    class WriteLock {
+    public:
+        /// Constructor, acquiring writer
+        explicit WriteLock(SQLite_Pool& P): l(P.writeMut), W(P.getWriter()) { }
+        /// access writer
+        H& operator*() const { return W; }
+        /// access writer
+        H* operator->() const { return &W; }
+    protected:
+        std::unique_lock<std::mutex> l;    ///< lock on writer
+        H& W;                               ///< writer connection
+    };
+    /// acquire exclusive use of writer connection
+    WriteLock writer() { return WriteLock(*this); }
+    /// run f(H&) with exclusive use of writer connection
+    template<typename F>
+    auto withWriter(F f) -> decltype(f(std::declval<H&>())) {
+        WriteLock W(*this);
+        return f(*W);
+    }
+
+    const string dbfile;    ///< DB file name
+    const string profile;   ///< tuning profile name
+
+protected:
+    /// writer connection, opened on first use (caller holds writeMut)
+    H& getWriter() {
+        if(!W) {
+            W.reset(new H(dbfile, false));
+            if(profile.size()) W->applyProfile(profile);
+        }
+        return *W;
+    }
+    /// profile for read-only connections: journal mode is a property of the DB file, set by writer
+    SQLite_Profile readProfile() const {
+        auto P = SQLite_Profile::named(profile);
+        P.journal_mode = "";
+        P.page_size = 0;
+        return P;
+    }
+
+    std::mutex poolMut;     ///< protects readers
+    map<std::thread::id, std::unique_ptr<H>> readers;   ///< read-only connections, per thread
+    std::mutex writeMut;    ///< serializes writer access
+    std::unique_ptr<H> W;   ///< writer connection
+};
+
+#endif
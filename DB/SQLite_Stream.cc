@@ -0,0 +1,98 @@
+/// \file SQLite_Stream.cc
+
+#include "SQLite_Stream.hh"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/// file descriptor closed on scope exit
+struct fd_guard {
+    int fd;     ///< file descriptor
+    ~fd_guard() { if(fd >= 0) close(fd); }
+};
+
+size_t SQLite_Stream::sendFile(BinaryWriter& W, const string& fname, size_t offset, size_t chunk) {
+    fd_guard F{open(fname.c_str(), O_RDONLY)};
+    if(F.fd < 0) throw std::runtime_error("Unable to read DB image '" + fname + "' (error " + std::to_string(errno) + ")");
+    struct stat st;
+    fstat(F.fd, &st);
+    size_t total = st.st_size;
+    if(offset > total) throw std::runtime_error("DB image resume offset beyond end of '" + fname + "'");
+
+    W.start_wtx();
+    W.send<uint64_t>(total);
+    W.send<uint64_t>(offset);
+    W.end_wtx();
+
+    vector<char> v;
+    size_t pos = offset;
+    while(pos < total) {
+        v.resize(std::min(chunk, total - pos));
+        auto r = pread(F.fd, v.data(), v.size(), pos);
+        if(r <= 0) {
+            if(r < 0 && errno == EINTR) continue;
+            throw std::runtime_error("Failed reading DB image '" + fname + "'");
+        }
+        v.resize(r);
+        W.start_wtx();
+        W.send(v);
+        W.end_wtx();
+        pos += r;
+    }
+    v.clear();
+    W.send(v);
+    return pos - offset;
+}
+
+size_t SQLite_Stream::receiveFile(BinaryReader& R, const string& fname) {
+    auto total = R.receive<uint64_t>();
+    auto pos = R.receive<uint64_t>();
+
+    fd_guard F{open(fname.c_str(), O_WRONLY | O_CREAT, 0644)};
+    if(F.fd < 0) throw std::runtime_error("Unable to write DB image '" + fname + "' (error " + std::to_string(errno) + ")");
+    struct stat st;
+    fstat(F.fd, &st);
+    if(pos > size_t(st.st_size)) throw std::runtime_error("DB image stream resumes beyond received portion of '" + fname + "'");
+
+    vector<char> v;
+    while(true) {
+        R.receive(v);
+        if(v.empty()) break;
+        if(pos + v.size() > total) throw std::runtime_error("DB image stream overruns declared size");
+        size_t n = 0;
+        while(n < v.size()) {
+            auto r = pwrite(F.fd, v.data() + n, v.size() - n, pos + n);
+            if(r < 0) {
+                if(errno == EINTR) continue;
+                throw std::runtime_error("Failed writing DB image '" + fname + "' (error " + std::to_string(errno) + ")");
+            }
+            n += r;
+        }
+        pos += n;
+    }
+    if(pos != total) throw std::runtime_error("DB image stream ended early");
+    if(ftruncate(F.fd, total)) throw std::runtime_error("Failed truncating DB image '" + fname + "'");
+    return total;
+}
+
+size_t SQLite_Stream::resumeOffset(const string& fname, size_t align) {
+    struct stat st;
+    if(stat(fname.c_str(), &st)) return 0;
+    size_t n = st.st_size;
+    return align? n - n % align : n;
+}
+
+size_t SQLite_Stream::sendDB(SQLite_Helper& H, BinaryWriter& W, const string& snapname, int npages, size_t chunk) {
+    unlink(snapname.c_str());
+    int rc = H.backupFile(snapname, true, npages);
+    if(rc != SQLITE_OK) throw std::runtime_error("Failed snapshot of DB to '" + snapname + "': " + sqlite3_errstr(rc));
+    return sendFile(W, snapname, 0, chunk);
+}
+
+size_t SQLite_Stream::receiveDB(SQLite_Helper& H, BinaryReader& R, const string& recvname, int npages) {
+    auto n = receiveFile(R, recvname);
+    int rc = H.backupFile(recvname, false, npages);
+    if(rc != SQLITE_OK) throw std::runtime_error("Failed restoring DB from '" + recvname + "': " + sqlite3_errstr(rc));
+    return n;
+}
@@ -0,0 +1,26 @@
+/// \file SQLite_Stream.hh Chunked, resumable transfer of SQLite databases through BinaryWriter/BinaryReader
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SQLITE_STREAM_HH
+#define SQLITE_STREAM_HH
+
+#include "SQLite_Helper.hh"
+#include "BinaryIO.hh"
+
+/// Stream format: uint64 total bytes, uint64 start offset; then vector<char> chunks (each its own write transaction), ending with empty chunk.
+/// Memory use is one chunk at each end, instead of the full DB image for toBlob()/fromBlob().
+namespace SQLite_Stream {
+    /// send (byte range from offset of) DB image file in chunks; return bytes sent
+    size_t sendFile(BinaryWriter& W, const string& fname, size_t offset = 0, size_t chunk = 1 << 20);
+    /// receive DB image file chunks, writing into fname starting from sender's offset; return total image size
+    size_t receiveFile(BinaryReader& R, const string& fname);
+    /// offset for resuming interrupted receiveFile() into fname (bytes already received, rounded down to align)
+    size_t resumeOffset(const string& fname, size_t align = 4096);
+
+    /// snapshot DB to file (incremental backup of npages per step), then send in chunks; return bytes sent
+    size_t sendDB(SQLite_Helper& H, BinaryWriter& W, const string& snapname, int npages = 256, size_t chunk = 1 << 20);
+    /// receive DB image into file, then restore into DB by incremental backup; return image size
+    size_t receiveDB(SQLite_Helper& H, BinaryReader& R, const string& recvname, int npages = 256);
+}
+
+#endif
@@ -31,6 +31,9 @@ public:
     string fref;    ///< reference input name
     string fcomp;   ///< comparison input name
     string outdir = "./delta/"; ///< output directory
+    bool hashfirst = false;     ///< skip full comparison of objects with identical content hashes (where supported)
+    int nthreads = 0;           ///< number of hashing/comparison threads (0 for hardware concurrency)
+    double numtol = 0;          ///< relative tolerance for numeric fields in text comparison (0 for exact byte comparison)
 
     /// type-specific comparison
     virtual bool _compare() { return false; }
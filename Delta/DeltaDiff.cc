@@ -1,10 +1,20 @@
 /// \file DeltaDiff.cc
 
 #include "DeltaDiff.hh"
+#include "MappedFile.hh"
+#include "PathUtils.hh"
+#include "WorkStealingPool.hh"
 #include <stdio.h>
 #include <array>
+#include <atomic>
+#include <cmath>
 
 bool DeltaDiff::_compare() {
+    if(!dirExists(fref) && !dirExists(fcomp) && fileExists(fref) && fileExists(fcomp)) return filecompare();
+    return diffcompare();
+}
+
+bool DeltaDiff::diffcompare() const {
     auto cmd = "diff '" + fref + "' '" + fcomp + "'";
     auto p = popen(cmd.c_str(), "r");
     if(!p) throw std::runtime_error("Failed popen for diff");
@@ -20,3 +30,81 @@ bool DeltaDiff::_compare() {
     printf("%s\n%s\nexited %i\n", cmd.c_str(), res.c_str(), rc);
     return !rc;
 }
+
+/// first differing position in [0,n) of a and b, comparing blocks in parallel; n if identical
+static size_t firstdiff(const char* a, const char* b, size_t n, size_t bsize, int nthreads) {
+    std::atomic<size_t> d(n);
+    const size_t nper = 256*bsize;  // bytes per task
+    WorkStealingPool P(nthreads);
+    for(size_t i0 = 0; i0 < n; i0 += nper) {
+        P.submit([=, &d] {
+            auto e = std::min(n, i0 + nper);
+            for(size_t i = i0; i < e; i += bsize) {
+                if(d.load(std::memory_order_relaxed) < i) return; // earlier difference already found
+                auto m = std::min(bsize, e - i);
+                if(!memcmp(a + i, b + i, m)) continue;
+                size_t j = i;
+                while(a[j] == b[j]) ++j;
+                auto c = d.load();
+                while(j < c && !d.compare_exchange_weak(c, j)) { }
+                return;
+            }
+        });
+    }
+    P.wait_idle();
+    return d;
+}
+
+/// whether word spans agree, exactly or as numbers within relative tolerance
+static bool wordsagree(charspan a, charspan b, double tol) {
+    if(a.n == b.n && !memcmp(a.p, b.p, a.n)) return true;
+    double x, y;
+    auto pa = a.p, pb = b.p;
+    if(!parse_field(pa, a.end(), x) || pa != a.end()) return false;
+    if(!parse_field(pb, b.end(), y) || pb != b.end()) return false;
+    return std::fabs(x - y) <= tol * std::max(std::fabs(x), std::fabs(y));
+}
+
+bool DeltaDiff::filecompare() const {
+    MappedFile A(fref), B(fcomp);
+
+    if(numtol > 0) {
+        LineSpanner LA(A.span()), LB(B.span());
+        charspan la, lb;
+        while(true) {
+            bool ea = !LA.next(la), eb = !LB.next(lb);
+            if(ea || eb) {
+                if(ea == eb) break;
+                printf("Files '%s' and '%s' differ in length at line %zu\n", fref.c_str(), fcomp.c_str(), std::max(LA.lno, LB.lno));
+                return false;
+            }
+            if(la.n == lb.n && !memcmp(la.p, lb.p, la.n)) continue;
+
+            auto pa = la.p, pb = lb.p;
+            charspan wa, wb;
+            while(true) {
+                bool ga = parse_field(pa, la.end(), wa), gb = parse_field(pb, lb.end(), wb);
+                if(!ga && !gb) break;
+                if(ga != gb || !wordsagree(wa, wb, numtol)) {
+                    printf("Files '%s' and '%s' differ at line %zu:\n< %s\n> %s\n", fref.c_str(), fcomp.c_str(), LA.lno, la.str().c_str(), lb.str().c_str());
+                    return false;
+                }
+            }
+        }
+        printf("Files '%s' and '%s' agree (numeric tolerance %g)\n", fref.c_str(), fcomp.c_str(), numtol);
+        return true;
+    }
+
+    auto n = std::min(A.size(), B.size());
+    auto d = firstdiff(A.data(), B.data(), n, blocksize, nthreads);
+    if(d < n) {
+        printf("Files '%s' and '%s' differ at byte %zu\n", fref.c_str(), fcomp.c_str(), d);
+        return false;
+    }
+    if(A.size() != B.size()) {
+        printf("Files '%s' and '%s' differ in size (%zu, %zu bytes)\n", fref.c_str(), fcomp.c_str(), A.size(), B.size());
+        return false;
+    }
+    printf("Files '%s' and '%s' are identical (%zu bytes)\n", fref.c_str(), fcomp.c_str(), n);
+    return true;
+}
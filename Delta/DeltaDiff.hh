@@ -3,9 +3,16 @@
 
 #include "DeltaBase.hh"
 
-/// gnu diff based delta
+/// gnu diff based delta (native comparison for pairs of files)
 class DeltaDiff: public DeltaBase {
 public:
     /// type-specific comparison
     bool _compare() override;
+
+    /// compare using external "diff"
+    bool diffcompare() const;
+    /// native comparison of files: parallel mmap'd block comparison, or numeric-tolerant lines if numtol > 0
+    bool filecompare() const;
+
+    size_t blocksize = 1 << 16; ///< block comparison size [bytes]
 };
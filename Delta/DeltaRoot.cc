@@ -2,6 +2,8 @@
 
 #include "DeltaRoot.hh"
 #include "PathUtils.hh"
+#include "Hash64.hh"
+#include "WorkStealingPool.hh"
 
 #include <TFile.h>
 #include <TTree.h>
@@ -9,13 +11,115 @@
 #include <TH1.h>
 #include <TAxis.h>
 #include <TPad.h>
+#include <TClass.h>
+
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+/// seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
 
 bool DeltaRoot::_compare() {
     TFile f1(fref.c_str(), "READ");
     if(f1.IsZombie()) throw std::runtime_error("Failed opening reference file '"+fref+"'");
     TFile f2(fcomp.c_str(), "READ");
     if(f2.IsZombie()) throw std::runtime_error("Failed opening reference file '"+fcomp+"'");
-    return tdcompare(&f1, &f2);
+    if(!hashfirst) return tdcompare(&f1, &f2);
+
+    auto t0 = std::chrono::steady_clock::now();
+    map<string, keyinfo_t> m1, m2;
+    collectKeys(&f1, "", m1);
+    collectKeys(&f2, "", m2);
+    auto t_walk = since(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    size_t nb = hashKeys(fref, m1) + hashKeys(fcomp, m2);
+    auto t_hash = since(t0);
+
+    // same class and compressed content: identical object
+    set<string> same;
+    for(auto& kv: m1) {
+        auto it = m2.find(kv.first);
+        if(it == m2.end()) continue;
+        auto& a = kv.second;
+        auto& b = it->second;
+        if(a.cls == b.cls && a.objlen == b.objlen && a.nbytes - a.keylen == b.nbytes - b.keylen && a.h == b.h) same.insert(kv.first);
+    }
+
+    t0 = std::chrono::steady_clock::now();
+    bool c = tdcompare(&f1, &f2, same);
+    auto t_cmp = since(t0);
+
+    printf("\nHash-first comparison: %zu / %zu objects identical by hash\n", same.size(), m1.size());
+    printf("\tkey walk %.3f s; hashing %.1f MB in %.3f s (%.1f MB/s); full comparisons %.3f s\n",
+           t_walk, nb*1e-6, t_hash, t_hash? nb*1e-6/t_hash : 0., t_cmp);
+    return c;
+}
+
+/// whether key is a sub-directory
+static bool isDirKey(TKey* k) {
+    auto c = TClass::GetClass(k->GetClassName());
+    return c && c->InheritsFrom(TDirectory::Class());
+}
+
+void DeltaRoot::collectKeys(TDirectory* d, const string& pfx, map<string, keyinfo_t>& m) {
+    if(!d) throw std::runtime_error("Collecting keys from null directory");
+    for(auto _k: *d->GetListOfKeys()) {
+        auto k = dynamic_cast<TKey*>(_k);
+        if(!k) throw std::logic_error("TKey expected");
+        string name = pfx + k->GetName();
+
+        if(isDirKey(k)) {
+            collectKeys(d->GetDirectory(k->GetName()), name + "/", m);
+            continue;
+        }
+
+        auto& ki = m[name];
+        if(ki.cls.size() && ki.cycle >= k->GetCycle()) continue;
+        ki.cls = k->GetClassName();
+        ki.seek = k->GetSeekKey();
+        ki.nbytes = k->GetNbytes();
+        ki.keylen = k->GetKeylen();
+        ki.objlen = k->GetObjlen();
+        ki.cycle = k->GetCycle();
+    }
+}
+
+size_t DeltaRoot::hashKeys(const string& fname, map<string, keyinfo_t>& m) const {
+    int fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0) throw std::runtime_error("Failed opening '" + fname + "' for hashing");
+
+    vector<keyinfo_t*> v;
+    size_t nb = 0;
+    for(auto& kv: m) {
+        v.push_back(&kv.second);
+        nb += kv.second.nbytes - kv.second.keylen;
+    }
+
+    // object bytes (after key header, which holds timestamps) read by pread, independent of ROOT I/O thread-safety
+    {
+        WorkStealingPool P(nthreads);
+        const size_t nper = 16;
+        for(size_t i = 0; i < v.size(); i += nper) {
+            P.submit([&v, i, fd] {
+                vector<char> b;
+                for(size_t j = i; j < std::min(v.size(), i + nper); ++j) {
+                    auto& k = *v[j];
+                    b.resize(k.nbytes - k.keylen);
+                    auto r = pread(fd, b.data(), b.size(), k.seek + k.keylen);
+                    k.h = r == ssize_t(b.size())? _fasthash64(b.data(), b.size()) : 0;
+                    if(r != ssize_t(b.size())) k.cls = "(unreadable)";
+                }
+            });
+        }
+        P.wait_idle();
+    }
+
+    close(fd);
+    return nb;
 }
 
 //-------------------------------------------
@@ -105,7 +209,48 @@ struct recaster {
     bool good;
 };
 
-bool DeltaRoot::tdcompare(TDirectory* d1, TDirectory* d2) const {
+bool DeltaRoot::objcompare(TKey* k, TKey* k2, const string& name) const {
+    printf("Comparing '%s'\n", name.c_str());
+    auto o1 = k->ReadObj();
+    auto o2 = k2->ReadObj();
+    bool same = true;
+
+    do {
+        auto hh = recaster<TH1>(o1, o2);
+        if(hh.good) {
+            printf("\tis a TH1\n");
+            if(!hcompare(*hh.a, *hh.b)) {
+                same = false;
+                makePath(outdir);
+                hh.a->Draw("Col Z");
+                gPad->Print((outdir + "/" + name + "_old.pdf").c_str());
+                hh.b->Draw("Col Z");
+                gPad->Print((outdir + "/" + name + "_new.pdf").c_str());
+            }
+            break;
+        }
+
+        auto tt = recaster<TTree>(o1, o2);
+        if(tt.good) {
+            printf("\tis a TTree\n");
+            break;
+        }
+
+        // might just be comparing the names...
+        if(!o1->Compare(o2)) printf("\tAutomatic comparison agrees\n");
+        else {
+            same = false;
+            printf("\tAutomatic comparison differs\n");
+        }
+
+    } while(false);
+
+    delete o1;
+    delete o2;
+    return same;
+}
+
+bool DeltaRoot::tdcompare(TDirectory* d1, TDirectory* d2, const set<string>& skip, const string& pfx) const {
     if(!d1 || !d2) throw std::runtime_error("Comparing null directories");
 
     bool same = true;
@@ -123,51 +268,16 @@ bool DeltaRoot::tdcompare(TDirectory* d1, TDirectory* d2) const {
             continue;
         }
 
-        if(k->IsFolder() && k2->IsFolder()) {
+        if(k->IsFolder() && k2->IsFolder() && isDirKey(k) && isDirKey(k2)) {
             printf("Desceding to directory '%s'\n", name);
             DeltaRoot DR;
             DR.outdir = outdir + '/' + name;
-            same |= DR.tdcompare(d1->GetDirectory(name), d2->GetDirectory(name));
+            same &= DR.tdcompare(d1->GetDirectory(name), d2->GetDirectory(name), skip, pfx + name + "/");
             continue;
         }
 
-        printf("Comparing '%s'\n", name);
-        auto o1 = k->ReadObj();
-        auto o2 = k2->ReadObj();
-
-        do {
-            auto hh = recaster<TH1>(o1, o2);
-            if(hh.good) {
-                printf("\tis a TH1\n");
-                if(!hcompare(*hh.a, *hh.b)) {
-                    same = false;
-                    makePath(outdir);
-                    hh.a->Draw("Col Z");
-                    gPad->Print((outdir + "/" + name + "_old.pdf").c_str());
-                    hh.b->Draw("Col Z");
-                    gPad->Print((outdir + "/" + name + "_new.pdf").c_str());
-                }
-                break;
-            }
-
-            auto tt = recaster<TTree>(o1, o2);
-            if(tt.good) {
-                printf("\tis a TTree\n");
-                break;
-            }
-
-            // might just be comparing the names...
-            if(!o1->Compare(o2)) printf("\tAutomatic comparison agrees\n");
-            else {
-                same = false;
-                printf("\tAutomatic comparison differs\n");
-            }
-
-        } while(false);
-
-
-        delete o1;
-        delete o2;
+        if(skip.count(pfx + name)) continue;
+        same &= objcompare(k, k2, name);
     }
 
     for(auto k: *d2->GetListOfKeys()) {
@@ -181,5 +291,3 @@ bool DeltaRoot::tdcompare(TDirectory* d1, TDirectory* d2) const {
 
     return same;
 }
-
-
@@ -3,6 +3,10 @@
 
 #include "DeltaBase.hh"
 #include <TFile.h>
+#include <map>
+using std::map;
+#include <set>
+using std::set;
 
 /// summarize ROOT file differences
 class DeltaRoot: public DeltaBase {
@@ -11,6 +15,24 @@ public:
     bool _compare() override;
 
 protected:
-    /// recursive TDirectory contents comparison
-    bool tdcompare(TDirectory* d1, TDirectory* d2) const;
+    /// directory entry record for hash-first comparison
+    struct keyinfo_t {
+        string cls;         ///< object class name
+        Long64_t seek = 0;  ///< key record position in file
+        int nbytes = 0;     ///< key record size (header + compressed object)
+        int keylen = 0;     ///< key header size
+        int objlen = 0;     ///< uncompressed object size
+        short cycle = 0;    ///< key cycle number
+        size_t h = 0;       ///< hash of compressed object bytes
+    };
+
+    /// collect non-directory keys (highest cycle of each name), recursively, by path
+    static void collectKeys(TDirectory* d, const string& pfx, map<string, keyinfo_t>& m);
+    /// hash object bytes of keys, read directly from file in parallel; return bytes hashed
+    size_t hashKeys(const string& fname, map<string, keyinfo_t>& m) const;
+
+    /// recursive TDirectory contents comparison, skipping identical paths
+    bool tdcompare(TDirectory* d1, TDirectory* d2, const set<string>& skip = {}, const string& pfx = "") const;
+    /// compare pair of objects
+    bool objcompare(TKey* k, TKey* k2, const string& name) const;
 };
@@ -36,6 +36,12 @@ vector<Stringmap> SMFile::retrieve(const string& s) const {
     return v;
 }
 
+vector<FlatStringmap> SMFile::retrieveFlat(const string& s) const {
+    vector<FlatStringmap> v;
+    for(auto it = lower_bound(s); it != upper_bound(s); ++it) v.emplace_back(it->second);
+    return v;
+}
+
 void SMFile::display() const {
     for(auto& kv: *this) {
         std::cout << "--- " << kv.first << " ---:\n";
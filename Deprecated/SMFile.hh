@@ -3,7 +3,7 @@
 #ifndef SMFile_HH
 #define SMFile_HH
 
-#include "Stringmap.hh"
+#include "FlatStringmap.hh"
 
 /// wrapper for multimap<string,Stringmap> with useful functions
 class SMFile: public multimap<string,Stringmap> {
@@ -13,6 +13,8 @@ public:
 
     /// retrieve values for key
     vector<Stringmap> retrieve(const string& s) const;
+    /// retrieve values for key, converted to FlatStringmap
+    vector<FlatStringmap> retrieveFlat(const string& s) const;
     /// retrieve first value for key
     Stringmap getFirst(const string& str, const Stringmap& dflt = Stringmap()) const;
     /// retrieve all sub-key values
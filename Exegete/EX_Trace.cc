@@ -0,0 +1,126 @@
+/// \file EX_Trace.cc
+
+#include "EX_Trace.hh"
+#include "TermColor.hh"
+#include <map>
+using std::map;
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+
+using namespace EX;
+
+/// registry of all thread rings (rings outlive their threads, for display)
+struct TraceRegistry {
+    std::mutex m;   ///< protects rings
+    vector<std::unique_ptr<TraceRing>> rings;   ///< registered rings
+    size_t capacity = 1 << 16;  ///< capacity for new rings
+};
+
+static TraceRegistry& theRegistry() {
+    static TraceRegistry R;
+    return R;
+}
+
+static size_t next_pow2(size_t n) {
+    size_t p = 1;
+    while(p < n) p <<= 1;
+    return p;
+}
+
+TraceRing::TraceRing(size_t n): thread_num(theRegistry().rings.size()), recs(next_pow2(n)), mask(recs.size() - 1) { }
+
+vector<TraceRecord> TraceRing::snapshot() const {
+    auto n = size();
+    auto n0 = n > recs.size()? n - recs.size() : 0;
+    vector<TraceRecord> v;
+    v.reserve(n - n0);
+    for(auto i = n0; i < n; ++i) v.push_back(recs[i & mask]);
+    return v;
+}
+
+TraceRing& EX::thisTraceRing() {
+    thread_local TraceRing* r = nullptr;
+    if(!r) {
+        auto& R = theRegistry();
+        std::lock_guard<std::mutex> l(R.m);
+        R.rings.emplace_back(new TraceRing(R.capacity));
+        r = R.rings.back().get();
+    }
+    return *r;
+}
+
+void EX::setTraceCapacity(size_t n) {
+    auto& R = theRegistry();
+    std::lock_guard<std::mutex> l(R.m);
+    R.capacity = n;
+}
+
+void EX::clearTrace() {
+    auto& R = theRegistry();
+    std::lock_guard<std::mutex> l(R.m);
+    for(auto& r: R.rings) r->clear();
+}
+
+/// call tree node reconstructed from records
+struct TraceNode {
+    size_t n = 0;   ///< number of entries
+    map<const TraceSite*, TraceNode> children;  ///< sub-scopes
+    map<const TraceSite*, std::pair<size_t, double>> notes; ///< note counts and last value
+    vector<const TraceSite*> order; ///< sub-scopes and notes in order of first appearance
+    TraceNode* parent = nullptr;    ///< enclosing scope
+};
+
+/// print node contents
+static void displayNode(const TraceNode& N, int depth) {
+    string pfx;
+    for(int i = 0; i < depth; ++i) pfx += (i % 2)? TERMFG_YELLOW "| " TERMSGR_RESET : TERMFG_RED "| " TERMSGR_RESET;
+    for(auto s: N.order) {
+        auto it = N.notes.find(s);
+        if(it != N.notes.end()) {
+            printf("%s" TERMFG_BLUE "[%s:%i", pfx.c_str(), strrchr(s->file, '/')? strrchr(s->file, '/') + 1 : s->file, s->line);
+            if(it->second.first > 1) printf(" #%zu", it->second.first);
+            printf("] " TERMFG_GREEN "%s", s->text.c_str());
+            if(!std::isnan(it->second.second)) printf(" %g", it->second.second);
+            printf(TERMSGR_RESET "\n");
+            continue;
+        }
+        auto& C = N.children.at(s);
+        printf("%s+-- " TERMFG_CYAN "%s" TERMSGR_RESET, pfx.c_str(), s->func);
+        if(s->text.size()) printf(TERMFG_BLUE " '%s'" TERMSGR_RESET, s->text.c_str());
+        if(C.n > 1) printf(" x%zu", C.n);
+        printf("\n");
+        displayNode(C, depth + 1);
+    }
+}
+
+void EX::displayTrace() {
+    auto& R = theRegistry();
+    std::lock_guard<std::mutex> l(R.m);
+    for(auto& r: R.rings) {
+        auto v = r->snapshot();
+        printf("\n---- Exegete trace, thread %i: %zu events", r->thread_num, r->size());
+        if(r->dropped()) printf(" (oldest %zu overwritten)", r->dropped());
+        printf(" ----\n");
+
+        TraceNode root;
+        TraceNode* cur = &root;
+        for(auto& e: v) {
+            if(e.kind == TraceRecord::ENTER) {
+                auto& c = cur->children[e.site];
+                if(!c.parent) cur->order.push_back(e.site);
+                c.parent = cur;
+                ++c.n;
+                cur = &c;
+            } else if(e.kind == TraceRecord::EXIT) {
+                if(cur->parent) cur = cur->parent; // else: entered before oldest retained record
+            } else {
+                auto& n = cur->notes[e.site];
+                if(!n.first++) cur->order.push_back(e.site);
+                n.second = e.kind == TraceRecord::VALUE? e.val : NAN;
+            }
+        }
+        displayNode(root, 0);
+    }
+}
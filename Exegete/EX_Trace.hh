@@ -0,0 +1,114 @@
+/// \file EX_Trace.hh Low-overhead thread-local Exegete recording, with call tree built at display time
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef EX_TRACE_HH
+#define EX_TRACE_HH
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+using std::string;
+#include <type_traits>
+#include <vector>
+using std::vector;
+
+namespace EX {
+
+    /// Static annotation site (one per annotated scope or note in source)
+    struct TraceSite {
+        /// Constructor
+        TraceSite(const char* f, const char* fn, int l, const string& t): file(f), func(fn), line(l), text(t) { }
+
+        const char* file;   ///< source file
+        const char* func;   ///< function name
+        int line;           ///< line number
+        const string text;  ///< description or note text (from first pass through site)
+    };
+
+    /// Compact record of annotation event
+    struct TraceRecord {
+        /// event type
+        enum kind_t: uint32_t {
+            ENTER,      ///< enter scope
+            EXIT,       ///< exit scope
+            NOTE,       ///< note
+            VALUE       ///< note with numeric value
+        };
+        const TraceSite* site;  ///< annotation site
+        kind_t kind;            ///< event type
+        double val;             ///< numeric value for VALUE
+    };
+
+    /// Per-thread ring buffer of trace records: single writer, no locks after creation
+    class TraceRing {
+    public:
+        /// Constructor, with capacity (power of 2)
+        explicit TraceRing(size_t n);
+
+        /// append record (overwriting oldest when full)
+        void push(const TraceSite* s, TraceRecord::kind_t k, double v = 0) {
+            auto i = nrec.load(std::memory_order_relaxed);
+            auto& r = recs[i & mask];
+            r.site = s;
+            r.kind = k;
+            r.val = v;
+            nrec.store(i + 1, std::memory_order_release);
+        }
+        /// copy of retained records, oldest first
+        vector<TraceRecord> snapshot() const;
+        /// total records written
+        size_t size() const { return nrec.load(std::memory_order_acquire); }
+        /// records lost to overwriting
+        size_t dropped() const { auto n = size(); return n > recs.size()? n - recs.size() : 0; }
+        /// discard all records
+        void clear() { nrec.store(0, std::memory_order_release); }
+
+        const int thread_num;           ///< sequential thread number, in order of first recording
+
+    protected:
+        vector<TraceRecord> recs;       ///< ring buffer
+        const size_t mask;              ///< index mask
+        std::atomic<size_t> nrec{0};    ///< total records written
+    };
+
+    /// calling thread's trace ring (created and registered on first use)
+    TraceRing& thisTraceRing();
+    /// ring capacity for newly-created thread rings (rounded up to power of 2)
+    void setTraceCapacity(size_t n);
+    /// print call tree, with scope and note counts, for each thread; best after recording threads are finished
+    void displayTrace();
+    /// discard all recorded events
+    void clearTrace();
+
+    /// numeric value for records, from arithmetic variables
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, double>::type trace_val(const T& v) { return double(v); }
+    /// non-numeric variables not recorded
+    template<typename T>
+    typename std::enable_if<!std::is_arithmetic<T>::value, double>::type trace_val(const T&) { return NAN; }
+
+    /// record note
+    inline void trace_note(const TraceSite& s) { thisTraceRing().push(&s, TraceRecord::NOTE); }
+    /// record note with value
+    template<typename T>
+    void trace_value(const TraceSite& s, const T& v) { thisTraceRing().push(&s, TraceRecord::VALUE, trace_val(v)); }
+
+    /// Record scope entrance and exit
+    class TraceGuard {
+    public:
+        /// Constructor
+        explicit TraceGuard(const TraceSite& s): S(s), R(thisTraceRing()) { R.push(&S, TraceRecord::ENTER); }
+        /// Destructor
+        ~TraceGuard() { R.push(&S, TraceRecord::EXIT); }
+        /// no copy
+        TraceGuard(const TraceGuard&) = delete;
+        /// no assignment
+        TraceGuard& operator=(const TraceGuard&) = delete;
+    protected:
+        const TraceSite& S; ///< scope site
+        TraceRing& R;       ///< thread ring
+    };
+}
+
+#endif
@@ -22,16 +22,15 @@
 #ifndef EXEGETE_HH
 #define EXEGETE_HH
 
-/// define this to enable Exegete functions; undefine to remove them
-#ifdef ENABLE_EXEGETE
+/// define ENABLE_EXEGETE to enable Exegete functions; undefine to remove them (at zero cost)
+/// define ENABLE_EXEGETE_TRACE for low-overhead, thread-safe recording to per-thread buffers, displayed by _EXEXIT()
+#if defined(ENABLE_EXEGETE) || defined(ENABLE_EXEGETE_TRACE)
 
 /// helper functions to glom items together into a token name
 #define TOKENCAT(x, y) x ## y
 /// extra layer of indirection needed for use in preprocession macros
 #define TOKENCAT2(x, y) TOKENCAT(x, y)
 
-#include "EX_Context.hh"
-#include "EX_VariableNote.hh"
 #include <type_traits>
 
 #ifdef __GNUC__NOPEDONT
@@ -40,6 +39,37 @@
 #define __myfunc__ __func__
 #endif
 
+#endif
+
+#ifdef ENABLE_EXEGETE_TRACE
+
+#include "EX_Trace.hh"
+
+/// static annotation site named nm (text evaluated on first pass only)
+#define _EXSITE(S, nm) static const EX::TraceSite nm(__FILE__, __myfunc__, __LINE__, S)
+/// scope recording, with unique site and guard names
+#define _EXSCOPE_N(S, nm) _EXSITE(S, TOKENCAT2(_EX_ts_, nm)); EX::TraceGuard TOKENCAT2(_EX_sg_, nm)(TOKENCAT2(_EX_ts_, nm))
+
+/// Start a new named scope with a descriptive string
+#define _EXSCOPE(S) _EXSCOPE_N(S, __COUNTER__)
+/// Simple text comment attached to current scope
+#define _EXPLAIN(S) do { _EXSITE(S, _EX_ts); EX::trace_note(_EX_ts); } while(0)
+/// Text comment showing the value of a (numeric) variable
+#define _EXPLAINVAR(S,v) do { _EXSITE(string(S) + " " #v, _EX_ts); EX::trace_value(_EX_ts, v); } while(0)
+/// Text comment on anonymous (numeric) value
+#define _EXPLAINVAL(S,v) do { _EXSITE(S, _EX_ts); EX::trace_value(_EX_ts, v); } while(0)
+/// Display recorded trace --- after annotated threads have finished
+#define _EXEXIT() EX::displayTrace()
+/// Do something only if Exegete is ENABLED
+#define _EXONLY(x) x
+/// Do something only if Exegete is DISABLED
+#define _EXNOPE(x) (void)0
+
+#elif defined(ENABLE_EXEGETE)
+
+#include "EX_Context.hh"
+#include "EX_VariableNote.hh"
+
 /// Start a new named scope with a descriptive string
 #define _EXSCOPE(S) EX::ScopeGuard TOKENCAT2(_EX_sg_, __LINE__)(EX::Scope::ID(__FILE__, __myfunc__, __LINE__), S)
 
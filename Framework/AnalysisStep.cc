@@ -10,6 +10,7 @@
 #include "GetEnv.hh"
 #include "StringManip.hh"
 #include "TermColor.hh"
+#include "XMLWriter.hh"
 #include <fstream>
 #include <stdio.h>
 
@@ -30,10 +31,12 @@ anatag(PROJ_ENV_PFX()+"-Analysis") { }
 bool AnalysisStep::make_xmlout() {
     if(!outfilename.size()) {
         printf(TERMFG_YELLOW "\nNo file specified for .xml output.\n\n" TERMFG_GREEN);
-        auto X = makeXML();
-        X->write(std::cout);
+        {
+            XMLStreamWriter W(std::cout);
+            writeXML(W);
+        }
+        std::cout.flush();
         printf(TERMSGR_RESET "\n\n");
-        delete X;
         return false;
     }
 
@@ -66,8 +69,10 @@ bool AnalysisStep::make_xmlout() {
     o << "<?xml version=\"1.0\"?>\n";
     o << "<" << anatag << ">\n";
     o << prevdat;
-    auto X = makeXML();
-    X->write(o,1);
+    {
+        XMLStreamWriter W(o, 1);
+        writeXML(W);
+    }
     o << "\n</" << anatag << ">\n";
 
     return true;
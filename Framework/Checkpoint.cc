@@ -0,0 +1,101 @@
+/// \file Checkpoint.cc
+
+#include "Checkpoint.hh"
+#include "DiskBIO.hh"
+#include "CompressedBIO.hh"
+#include <memory>
+#include <typeinfo>
+#include <stdio.h>
+
+/// checkpoint file format identifier
+static const string ckpt_magic = "MPMUtils stream checkpoint v1";
+
+void Checkpointable::checkpoint() {
+    auto C = StreamCheckpoint::active();
+    if(C) C->process(*this);
+}
+
+StreamCheckpoint::StreamCheckpoint(BinaryWriter& w): W(&w) {
+    if(active()) throw std::logic_error("Nested stream checkpoints");
+    active() = this;
+}
+
+StreamCheckpoint::StreamCheckpoint(BinaryReader& r): R(&r) {
+    if(active()) throw std::logic_error("Nested stream checkpoints");
+    active() = this;
+}
+
+StreamCheckpoint*& StreamCheckpoint::active() {
+    static StreamCheckpoint* C = nullptr;
+    return C;
+}
+
+void StreamCheckpoint::process(Checkpointable& C) {
+    std::lock_guard<std::mutex> l(M);
+    string tp = typeid(C).name();
+    if(W) {
+        W->send(tp);
+        C.saveState(*W);
+    } else {
+        auto tp0 = R->receive<string>();
+        if(tp0 != tp) throw std::runtime_error("Checkpoint stage " + std::to_string(nstages) + " type mismatch: saved '" + tp0 + "', restoring '" + tp + "'");
+        C.loadState(*R);
+    }
+    ++nstages;
+}
+
+bool StreamCheckpointFile::exists() const {
+    std::ifstream f(fname);
+    return fname.size() && f.good();
+}
+
+void StreamCheckpointFile::save(size_t npos, SignalSink& S, Checkpointable* src) const {
+    auto ftmp = fname + ".tmp";
+    ::remove(ftmp.c_str());
+    {
+        FDBinaryWriter FW(ftmp);
+        FW.start_wtx(); // single write and fsync at end
+        std::unique_ptr<CompressedBWriter> CW;
+        if(codec != CODEC_NONE) CW.reset(new CompressedBWriter(FW, codec));
+        BinaryWriter& W = CW? static_cast<BinaryWriter&>(*CW) : FW;
+
+        W.sendWireHeader();
+        W.send(ckpt_magic);
+        W.send(npos);
+        StreamCheckpoint C(W);
+        if(src) C.process(*src);
+        S.signal(DATASTREAM_CHECKPT);
+        W.send<size_t>(C.nstages);
+        if(CW) CW->close();
+        FW.end_wtx();
+    }
+    if(rename(ftmp.c_str(), fname.c_str())) throw std::runtime_error("Failed to move checkpoint into '" + fname + "'");
+}
+
+size_t StreamCheckpointFile::restore(SignalSink& S, Checkpointable* src) const {
+    std::ifstream f(fname, std::ios::binary);
+    if(!f.good()) throw std::runtime_error("Unable to open checkpoint '" + fname + "'");
+
+    // detect compressed checkpoint from block header
+    BlockHeader H;
+    H.magic[0] = 0;
+    f.read(H.magic, sizeof(H.magic));
+    f.clear();
+    f.seekg(0);
+    std::unique_ptr<BinaryReader> pR;
+    if(H.valid()) pR.reset(new CompressedBReader(f));
+    else pR.reset(new IOStreamBRead(f));
+    BinaryReader& R = *pR;
+
+    try { R.receiveWireHeader(); }
+    catch(std::runtime_error& e) { throw std::runtime_error("Invalid checkpoint file '" + fname + "': " + e.what()); }
+    if(R.receive<string>() != ckpt_magic) throw std::runtime_error("Invalid checkpoint file '" + fname + "'");
+    auto npos = R.receive<size_t>();
+    StreamCheckpoint C(R);
+    if(src) C.process(*src);
+    S.signal(DATASTREAM_CHECKPT);
+    if(R.receive<size_t>() != C.nstages || !f.good()) throw std::runtime_error("Checkpoint '" + fname + "' does not match analysis chain");
+    return npos;
+}
+
+void StreamCheckpointFile::remove() const { if(fname.size()) ::remove(fname.c_str()); }
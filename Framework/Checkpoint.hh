@@ -0,0 +1,127 @@
+/// \file Checkpoint.hh Save/restore of streaming analysis state on DATASTREAM_CHECKPT
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef CHECKPOINT_HH
+#define CHECKPOINT_HH
+
+#include "_DataSink.hh"
+#include "BinaryIO.hh"
+#include "BlockCompress.hh"
+#include <mutex>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+/// Checkpoint serialization of buffered item type: trivially-copyable non-pointer types; specialize for others
+template<typename T, typename = void>
+struct CheckpointItem {
+    /// whether type can be checkpointed
+    static constexpr bool enabled = IS_TRIVIALLY_COPYABLE(T) && !std::is_pointer<T>::value;
+    /// serialize item
+    static void save(BinaryWriter& W, const T& o) { _save(W, o, std::integral_constant<bool, enabled>()); }
+    /// deserialize item
+    static void load(BinaryReader& R, T& o) { _load(R, o, std::integral_constant<bool, enabled>()); }
+
+protected:
+    /// serialize supported type
+    static void _save(BinaryWriter& W, const T& o, std::true_type) { W.send(o); }
+    /// unsupported type
+    static void _save(BinaryWriter&, const T&, std::false_type) { throw std::runtime_error("Item type not checkpointable"); }
+    /// deserialize supported type
+    static void _load(BinaryReader& R, T& o, std::true_type) { R.receive(o); }
+    /// unsupported type
+    static void _load(BinaryReader&, T&, std::false_type) { throw std::runtime_error("Item type not checkpointable"); }
+};
+
+/// Checkpoint serialization for types with saveState(BinaryWriter&) const and loadState(BinaryReader&) members
+template<typename T>
+struct CheckpointItem<T, decltype(std::declval<const T&>().saveState(std::declval<BinaryWriter&>()),
+                                  std::declval<T&>().loadState(std::declval<BinaryReader&>()))> {
+    /// whether type can be checkpointed
+    static constexpr bool enabled = true;
+    /// serialize item
+    static void save(BinaryWriter& W, const T& o) { o.saveState(W); }
+    /// deserialize item
+    static void load(BinaryReader& R, T& o) { o.loadState(R); }
+};
+
+/// save item count and items range
+template<typename It>
+void ckpt_save_items(BinaryWriter& W, It i0, It i1) {
+    typedef typename std::remove_const<typename std::iterator_traits<It>::value_type>::type T;
+    W.send<size_t>(std::distance(i0, i1));
+    while(i0 != i1) CheckpointItem<T>::save(W, *i0++);
+}
+
+/// load items saved by ckpt_save_items, passing each (by rvalue) to f
+template<typename T, typename F>
+void ckpt_load_items(BinaryReader& R, F f) {
+    auto n = R.receive<size_t>();
+    while(n--) {
+        T o{};
+        CheckpointItem<T>::load(R, o);
+        f(std::move(o));
+    }
+}
+
+/// Base for stages saving/restoring internal state on DATASTREAM_CHECKPT
+class Checkpointable {
+public:
+    /// Polymorphic destructor
+    virtual ~Checkpointable() { }
+    /// serialize state
+    virtual void saveState(BinaryWriter&) { }
+    /// restore state (into freshly-constructed stage)
+    virtual void loadState(BinaryReader&) { }
+
+protected:
+    /// save or restore state in active StreamCheckpoint, if any; call on DATASTREAM_CHECKPT before signalling downstream
+    void checkpoint();
+};
+
+/// Process-wide active checkpoint save or restore, while DATASTREAM_CHECKPT is passed through chain
+class StreamCheckpoint {
+public:
+    /// Constructor, activating save to writer
+    explicit StreamCheckpoint(BinaryWriter& w);
+    /// Constructor, activating restore from reader
+    explicit StreamCheckpoint(BinaryReader& r);
+    /// Destructor, deactivating
+    ~StreamCheckpoint() { active() = nullptr; }
+
+    /// active checkpoint (nullptr if none)
+    static StreamCheckpoint*& active();
+    /// whether saving (or restoring)
+    bool saving() const { return W; }
+
+    /// save or restore stage record, with stage type check
+    void process(Checkpointable& C);
+
+    size_t nstages = 0; ///< number of stage records processed
+
+protected:
+    BinaryWriter* W = nullptr;  ///< writer, when saving
+    BinaryReader* R = nullptr;  ///< reader, when restoring
+    std::mutex M;               ///< lock for stages in multiple threads
+};
+
+/// Checkpoint file save/restore for data source driving a chain
+class StreamCheckpointFile {
+public:
+    /// Constructor
+    explicit StreamCheckpointFile(const string& f = ""): fname(f) { }
+
+    /// whether checkpoint file exists
+    bool exists() const;
+    /// save checkpoint at source position npos (and optional source state), passing DATASTREAM_CHECKPT through chain starting at S
+    void save(size_t npos, SignalSink& S, Checkpointable* src = nullptr) const;
+    /// restore chain starting at S (and optional source state) from checkpoint file; return saved source position
+    size_t restore(SignalSink& S, Checkpointable* src = nullptr) const;
+    /// remove checkpoint file (after successful completion)
+    void remove() const;
+
+    string fname;               ///< checkpoint file name
+    BlockCodec codec = CODEC_NONE;  ///< compression for saved checkpoints (restore detects automatically)
+};
+
+#endif
@@ -5,7 +5,34 @@
 #define CLUSTERED_HH
 
 #include "DataSink.hh"
+#include "Checkpoint.hh"
 #include <cmath> // for fabs()
+#include <stdint.h>
+
+/// Find cluster starts in ordered t[0..n): append each i > 0 with t[i] - t[i-1] > dx to b; return false if t is out of order
+/**
+    Branch-free loops over adjacent differences: a vectorizable order check,
+    then break indices compacted by unconditional store and conditional increment.
+    Clusters are the index ranges [0, b[0]), [b[0], b[1]), ..., [b.back(), n).
+*/
+template<typename ordering_t>
+bool cluster_breaks(const ordering_t* t, size_t n, ordering_t dx, vector<uint32_t>& b) {
+    if(n < 2) return true;
+    uint8_t bad = 0;
+    for(size_t i = 1; i < n; ++i) bad |= !(t[i-1] <= t[i]);
+    if(bad) return false;
+
+    const size_t k0 = b.size();
+    b.resize(k0 + n);
+    uint32_t* p = b.data() + k0;
+    size_t k = 0;
+    for(size_t i = 1; i < n; ++i) {
+        p[k] = i;
+        k += (t[i] - t[i-1]) > dx;
+    }
+    b.resize(k0 + k);
+    return true;
+}
 
 /// "Cluster" base class
 template<class _T, typename _ordering_t = typename _T::ordering_t>
@@ -41,7 +68,7 @@ public:
 
     /// print cluster information
     virtual void display(ordering_t x0 = 0) const {
-        printf("Cluster with %zu objects at t = %g (max spacing %g)\n", size(), x_median - x0, dx);
+        printf("Cluster with %zu objects at t = %g (max spacing %g)\n", size(), double(x_median - x0), double(dx));
         for(auto& o: *this) {
             printf("\t");
             dispObj(o);
@@ -54,6 +81,20 @@ public:
     /// Clear contents
     virtual void clear() { super_t::clear(); }
 
+    /// serialize for checkpoint; extend in subclasses with additional state
+    virtual void saveState(BinaryWriter& W) const {
+        W.send(dx);
+        W.send(x_median);
+        ckpt_save_items(W, begin(), end());
+    }
+    /// deserialize from checkpoint
+    virtual void loadState(BinaryReader& R) {
+        super_t::clear();
+        R.receive(dx);
+        R.receive(x_median);
+        ckpt_load_items<contents_t>(R, [this](contents_t&& o) { push_back(std::move(o)); });
+    }
+
     /// sort contents by ordering parameter
     void sort() { std::sort(begin(), end(), [this](const contents_t& a, const contents_t& b) { return ordering_t(a) < ordering_t(b); }); }
 
@@ -68,6 +109,10 @@ public:
         append(O);
         return true;
     }
+    /// append n objects already known to be in range of their predecessors; override if append() changes dx or skips items
+    virtual void appendRange(const contents_t* o, size_t n) {
+        while(n--) append(*o++);
+    }
 
 protected:
     /// append item to cluster. Override to add more fancy calculations.
@@ -79,7 +124,7 @@ protected:
 
 /// Cluster builder; input always const, output const-ness determined from C
 template<class C>
-class ClusterBuilder: public DataLink<const typename C::contents_t, C> {
+class ClusterBuilder: public DataLink<const typename C::contents_t, C>, public Checkpointable {
 public:
     typedef C cluster_t;
     typedef typename std::remove_const<cluster_t>::type cmut_t;
@@ -95,22 +140,55 @@ public:
             completeCluster();
             t_prev = -C::order_max;
         }
+        if(sig == DATASTREAM_CHECKPT) this->checkpoint();
         if(this->nextSink) this->nextSink->signal(sig);
     }
 
+    /// serialize cluster being built
+    void saveState(BinaryWriter& W) override {
+        W.send(t_prev);
+        ckpt_save_items(W, currentC.begin(), currentC.end());
+    }
+    /// restore cluster being built
+    void loadState(BinaryReader& R) override {
+        R.receive(t_prev);
+        currentC.clear();
+        currentC.dx = cluster_dx;
+        ckpt_load_items<typename C::contents_t>(R, [this](typename C::contents_t&& o) { currentC.tryAdd(o); });
+    }
+
     /// push currentC into window
     void completeCluster() {
         currentC.close();
-        if(checkCluster(currentC) && this->nextSink) this->nextSink->push(currentC);
+        if(checkCluster(currentC) && this->nextSink) {
+            if(inBatch) {
+                if(nbatch == cbatch.size()) cbatch.emplace_back();
+                recycleInto(cbatch[nbatch++]);
+            } else this->nextSink->push(currentC);
+        }
         currentC.clear();
     }
 
+    /// add batch of objects, passing completed clusters downstream as batch
+    void push_batch(sink_t* o, size_t n) override {
+        inBatch = true;
+        try {
+            if(batchBreaks) cluster_batch(o, n);
+            else while(n--) ClusterBuilder::push(*o++);
+        }
+        catch(...) { inBatch = false; nbatch = 0; throw; }
+        inBatch = false;
+        this->nextBatch(cbatch.data(), nbatch);
+        nbatch = 0;
+    }
+    using DataLink<const typename C::contents_t, C>::push_batch;
+
     /// add object to newest cluster (or start newer cluster), assuming responsibility for deletion
     void push(sink_t& o) override {
         ordering_t t(o);
         if(!(t_prev <= t)) {
             dispObj(currentC);
-            printf("t_prev = %g\n", t_prev);
+            printf("t_prev = %g\n", double(t_prev));
             dispObj(o);
             throw std::runtime_error("Out-of-order item received for clustering");
         }
@@ -123,12 +201,53 @@ public:
     }
 
     ordering_t cluster_dx{};            ///< time spread for cluster identification
+    bool batchBreaks = false;           ///< whether push_batch locates cluster breaks up front with cluster_breaks()
+
+    /// number of batched clusters stored in previously-allocated buffers
+    size_t n_recycled() const { return nRecycled; }
+    /// number of batched clusters requiring buffer (re)allocation
+    size_t n_allocs() const { return nAllocs; }
 
 protected:
+    /// cluster batch by index ranges between breaks located over extracted timestamps
+    void cluster_batch(sink_t* o, size_t n) {
+        tbuf.resize(n);
+        for(size_t i = 0; i < n; ++i) tbuf[i] = ordering_t(o[i]);
+        breaks.clear();
+        if(n < 2 || !cluster_breaks(tbuf.data(), n, cluster_dx, breaks)) {
+            // per-item for disordered data error reporting
+            while(n--) ClusterBuilder::push(*o++);
+            return;
+        }
+        breaks.push_back(n);
+        size_t i0 = 0;
+        for(auto i1: breaks) {
+            ClusterBuilder::push(o[i0]);
+            if(currentC.dx == cluster_dx) {
+                currentC.cmut_t::appendRange(o + i0 + 1, i1 - i0 - 1);
+                t_prev = tbuf[i1 - 1];
+            } else for(size_t i = i0 + 1; i < i1; ++i) ClusterBuilder::push(o[i]);
+            i0 = i1;
+        }
+    }
+
     /// inspect before passing along
     virtual bool checkCluster(cluster_t&) { return true; }
+    /// copy currentC into recycled cluster slot, re-using its capacity
+    void recycleInto(cmut_t& c) {
+        if(c.capacity() >= currentC.size()) ++nRecycled;
+        else ++nAllocs;
+        c = currentC;
+    }
 
     cmut_t currentC{};                  ///< cluster currently being built
+    vector<cmut_t> cbatch;              ///< completed cluster buffers, re-used across push_batch calls
+    size_t nbatch = 0;                  ///< number of completed clusters in cbatch for current batch
+    size_t nRecycled = 0;               ///< count of clusters copied into existing capacity
+    size_t nAllocs = 0;                 ///< count of clusters requiring allocation
+    bool inBatch = false;               ///< whether push_batch is accumulating into cbatch
+    vector<ordering_t> tbuf;            ///< batch timestamps
+    vector<uint32_t> breaks;            ///< batch cluster break indices
     ordering_t t_prev = -C::order_max;  ///< previous item arrival
 };
 
@@ -8,14 +8,15 @@
 #include "Clustered.hh"
 
 /// Wrap ClusterBuilder in OrderedWindow
+/// window RingBuffer storage retains released clusters' capacity for re-use by newer clusters
 template<class CB>
 class CBWindow: public PreSink<CB>,
-public OrderedWindow<typename CB::cluster_t> {
+public RingOrderedWindow<typename CB::cluster_t> {
 public:
     typedef CB clustbuilder_t;
     typedef typename clustbuilder_t::cluster_t cluster_t;
     typedef typename cluster_t::ordering_t ordering_t;
-    typedef OrderedWindow<cluster_t> window_t;
+    typedef RingOrderedWindow<cluster_t> window_t;
 
     /// Constuctor with pass-through args
     template<typename... Args>
@@ -23,17 +24,21 @@ public:
     PreSink<CB>(std::forward<Args>(a)...), window_t(dw) { }
 
     using PreSink<CB>::push;
+    using PreSink<CB>::push_batch;
     using PreSink<CB>::signal;
 
 protected:
-    using OrderedWindow<cluster_t>::push;
-    //using OrderedWindow<cluster_t>::signal;
+    using window_t::push;
+    using window_t::push_batch;
+    //using window_t::signal;
 
     /// examine and decide whether to include cluster
     virtual bool checkCluster(cluster_t& o) { return o.size(); }
 
     /// Receive pre-transformed input:
     void _push(cluster_t& C) override { window_t::push(C); }
+    /// Receive pre-transformed input batch
+    void _push_batch(cluster_t* C, size_t n) override { window_t::push_batch(C, n); }
     /// receive back signals
     void _signal(datastream_signal_t s) override { window_t::signal(s); }
 };
@@ -6,17 +6,23 @@
 
 #include "_Collator.hh"
 #include "DataSink.hh"
+#include "StageProfile.hh"
+#include "Checkpoint.hh"
+#include "MemoryBudget.hh"
 
 #include "deref_if_ptr.hh"
 #include "SFINAEFuncs.hh"
 
 #include <queue>
+#include <deque>
+using std::deque;
+#include <limits>
 #include <cassert>
 #include <unistd.h>
 
 /// Combine ordered items received from multiple "push" sources
 template<typename T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
-class Collator: virtual public _Collator, public SinkUser<const T> {
+class Collator: virtual public _Collator, public SinkUser<const T>, public Checkpointable {
 public:
     typedef _ordering_t ordering_t;
     typedef typename std::remove_const<T>::type Tmut_t;
@@ -24,16 +30,20 @@ public:
 
     /// Destructor: remember final flush.
     ~Collator() {
-        if(!PQ.empty()) {
-            printf("Warning: %zu items left in un-flushed collator queue\n", PQ.size());
+        if(q_size()) {
+            printf("Warning: %zu items left in un-flushed collator queue\n", q_size());
             while(!PQ.empty()) {
                 dispObj(PQ.top());
                 PQ.pop();
             }
+            for(auto& q: fifos) for(auto& o: q) dispObj(o);
         }
         for(auto i: vInputs) delete i;
     }
 
+    /// number of items buffered in collation queue
+    size_t q_size() const { return engine == COLLATE_HEAP? PQ.size() : nfifo; }
+
     /// convenience input handle for this orderer
     class MOInput: public DataSink<T> {
     public:
@@ -49,6 +59,13 @@ public:
         void push(T& o) override { M->push(n,o); }
         /// bulk push
         virtual void push(const vector<Tmut_t>& os) { M->push(n,os); }
+        /// DataSink batch push
+        void push_batch(T* o, size_t nb) override { M->push(n, o, nb); }
+        /// DataSink move push
+        void push_move(Tmut_t&& o) override { M->push(n, std::move(o)); }
+        /// DataSink move batch push
+        void push_move_batch(Tmut_t* o, size_t nb) override { M->push_move(n, o, nb); }
+        using DataSink<T>::push_batch;
         /// ignore signals
         void signal(datastream_signal_t) override { }
 
@@ -60,71 +77,106 @@ public:
     };
 
     /// output all available collated items
-    void process_ready() { while(!inputs_waiting && !PQ.empty()) pop(); }
+    void process_ready() {
+        while(!inputs_waiting && q_size()) pop();
+        mem.set_items<iT>(q_size());
+        this->nextBatch(outBatch);
+    }
     /// add item from enumerated input; output available collated
-    void push(size_t nI, const T& o) { _push(nI, o); process_ready(); }
+    void push(size_t nI, const T& o) { copies.copied(); _push(nI, o); process_ready(); }
+    /// move in item from enumerated input; output available collated
+    void push(size_t nI, Tmut_t&& o) { copies.moved(); _push(nI, std::move(o)); process_ready(); }
     /// bulk-add items
-    void push(size_t nI, const vector<Tmut_t>& os) { _push(nI, os); process_ready(); }
+    void push(size_t nI, const vector<Tmut_t>& os) { _push(nI, os.data(), os.size()); process_ready(); }
+    /// bulk-add contiguous items
+    void push(size_t nI, const T* o, size_t n) { copies.copied(n); _push(nI, o, n); process_ready(); }
+    /// bulk-move contiguous items
+    void push_move(size_t nI, Tmut_t* o, size_t n) { copies.moved(n); _push(nI, std::make_move_iterator(o), n); process_ready(); }
 
     /// handle signals, including flush
     void signal(datastream_signal_t sig) override {
+        lock_guard<mutex> lo(outMut);
         lock_guard<mutex> lk(inputMut);
         if(sig >= DATASTREAM_FLUSH) {
-            while(!PQ.empty()) {
-                pop();
-                sched_yield();
-            }
+            while(q_size()) pop();
+            mem.set(0);
+            this->nextBatch(outBatch);
         }
+        if(sig == DATASTREAM_CHECKPT) this->checkpoint();
         if(nextSink) nextSink->signal(sig);
     }
 
-    // --- multithreading support ---
-
-    /// thread-safe push to queue for use in threadjob()
-    void qpush(size_t nI, const T& o) {
-        int myWait = input_n[nI].first;
+    /// serialize queued items with input enumeration (call with inputMut locked)
+    void saveState(BinaryWriter& W) override {
+        vector<std::pair<size_t, Tmut_t>> v;
+        if(engine == COLLATE_HEAP) {
+            while(PQ.size()) {
+                v.emplace_back(PQ.top().first, std::move(const_cast<iT&>(PQ.top()).second));
+                PQ.pop();
+            }
+            for(auto& o: v) PQ.emplace(o.first, o.second);
+        } else for(size_t nI = 0; nI < fifos.size(); ++nI) for(auto& o: fifos[nI]) v.emplace_back(nI, o);
 
-        // time to clear buffer
-        while(myWait > 32 && !inputs_waiting) {
-            sched_yield();
-            myWait = input_n[nI].first;
+        W.send<size_t>(v.size());
+        for(auto& o: v) {
+            W.send(o.first);
+            CheckpointItem<Tmut_t>::save(W, o.second);
         }
-
-        {
-            lock_guard<mutex> l(inputMut);
-            _push(nI, o);
-            if(!inputs_waiting) inputReady.notify_one();
+    }
+    /// restore queued items (call with inputMut locked)
+    void loadState(BinaryReader& R) override {
+        auto n = R.receive<size_t>();
+        while(n--) {
+            auto nI = R.receive<size_t>();
+            Tmut_t o{};
+            CheckpointItem<Tmut_t>::load(R, o);
+            _push(nI, std::move(o));
         }
-        if(myWait > 32) usleep(1000*(myWait - 32));
-        sched_yield();
     }
 
+    // --- multithreading support ---
+
+    /// thread-safe push to queue for use in threadjob()
+    void qpush(size_t nI, const T& o) { copies.copied(); _qpush(nI, o); }
+    /// thread-safe move to queue for use in threadjob()
+    void qpush(size_t nI, Tmut_t&& o) { copies.moved(); _qpush(nI, std::move(o)); }
+
     /// thread-safe bulk-add items
-    void qpush(size_t nI, const vector<Tmut_t>& os) {
+    void qpush(size_t nI, const vector<Tmut_t>& os) { qpush(nI, os.data(), os.size()); }
+    /// thread-safe bulk-add contiguous items
+    void qpush(size_t nI, const T* o, size_t n) {
+        lock_guard<mutex> l(inputMut);
+        copies.copied(n);
+        _push(nI, o, n);
+        inputReady.notify_one();
+    }
+    /// thread-safe bulk-move contiguous items
+    void qpush_move(size_t nI, Tmut_t* o, size_t n) {
         lock_guard<mutex> l(inputMut);
-        _push(nI, os);
+        copies.moved(n);
+        _push(nI, std::make_move_iterator(o), n);
         inputReady.notify_one();
     }
 
     /// thread to pull from queue and push downstream
     void threadjob() override {
+        vector<Tmut_t> v;   // re-used output batch
         do {
-            vector<Tmut_t> v;
+            bool fl;
             {
                 unique_lock<mutex> lk(inputMut);  // acquire unique_lock on queue in this scope
-                inputReady.wait(lk, [this]{ return !inputs_waiting || runstat == STOP_REQUESTED; });  // unlock until notified
-                while(!inputs_waiting && !PQ.empty()) {
-                    auto& o = PQ.top();
-                    if(!--input_n[o.first].first) ++inputs_waiting;
-                    v.push_back(o.second);
-                    PQ.pop();
-                }
+                inputReady.wait(lk, [this]{ return !inputs_waiting || flushRequested || runstat == STOP_REQUESTED; });  // unlock until notified
+                fl = flushRequested;
+                while((fl || !inputs_waiting) && q_size()) _pop(&v);
+                mem.set_items<iT>(q_size());
             }
-            if(nextSink) {
-                for(auto& o: v) {
-                    nextSink->push(o);
-                    sched_yield();
-                }
+            lock_guard<mutex> lo(outMut);
+            this->nextBatch(v);
+            if(fl) {
+                if(nextSink) nextSink->signal(DATASTREAM_FLUSH);
+                lock_guard<mutex> lk(inputMut);
+                flushRequested = false;
+                flushDone.notify_all();
             }
 
         } while(runstat != STOP_REQUESTED);
@@ -132,6 +184,21 @@ public:
         signal(DATASTREAM_FLUSH);
     }
 
+    /// set STOP_REQUESTED and notify, locked against threadjob() wait
+    void request_stop() override {
+        lock_guard<mutex> lk(inputMut);
+        Threadworker::request_stop();
+    }
+
+    /// flush all queued items and signal DATASTREAM_FLUSH downstream, from the running collator thread; blocks until done
+    void flush_thread() override {
+        if(checkRunning() != RUNNING) { signal(DATASTREAM_FLUSH); return; }
+        unique_lock<mutex> lk(inputMut);
+        flushRequested = true;
+        inputReady.notify_all();
+        flushDone.wait(lk, [this]{ return !flushRequested; });
+    }
+
     /// convenience threaded input handle for this orderer
     class MOqInput: public MOInput {
     public:
@@ -144,6 +211,13 @@ public:
         void push(T& o) override { M->qpush(n,o); }
         /// bulk push
         void push(const vector<Tmut_t>& os) override { M->qpush(n,os); }
+        /// DataSink batch push
+        void push_batch(T* o, size_t nb) override { M->qpush(n, o, nb); }
+        /// DataSink move push
+        void push_move(Tmut_t&& o) override { M->qpush(n, std::move(o)); }
+        /// DataSink move batch push
+        void push_move_batch(Tmut_t* o, size_t nb) override { M->qpush_move(n, o, nb); }
+        using MOInput::push_batch;
     };
 
     /// connect SinkUser as input
@@ -153,21 +227,53 @@ public:
     }
 
     vector<MOInput*> vInputs;  ///< input adapters
+    default_stage_profile_t qprof;  ///< queue depth instrumentation; lock on inputMut
+    SinkCopyCounter copies;         ///< input copy/move counting
+    MemAccount mem{"Collator"};     ///< queued bytes, reported to MemoryBudget::global() and MemTag
 
 protected:
+    /// thread-safe (copy or move) push to queue
+    template<typename U>
+    void _qpush(size_t nI, U&& o) {
+        int myWait = input_n[nI].first;
+
+        // time to clear buffer
+        while(myWait > 32 && !inputs_waiting) {
+            sched_yield();
+            myWait = input_n[nI].first;
+        }
+
+        {
+            lock_guard<mutex> l(inputMut);
+            _push(nI, std::forward<U>(o));
+            if(!inputs_waiting) inputReady.notify_one();
+        }
+        if(myWait > 32) usleep(1000*(myWait - 32));
+        sched_yield();
+    }
 
-    /// push to queue, update nwaiting
-    void _push(size_t nI, const T& o) {
+    /// push (copy or move) to queue, update nwaiting
+    template<typename U>
+    void _push(size_t nI, U&& o) {
         if(!input_n.at(nI).first++) {
             --inputs_waiting;
             assert(inputs_waiting >= 0);
         }
-        PQ.emplace(nI,o);
+        if(engine == COLLATE_HEAP) PQ.emplace(nI, std::forward<U>(o));
+        else {
+            auto& q = get_fifo(nI);
+            q.push_back(std::forward<U>(o));
+            ++nfifo;
+            if(q.size() == 1) tree_update(nI);
+        }
+        qprof.depth(q_size());
+        mem.set_items<iT>(q_size());
     }
 
-    /// bulk-add items
-    void _push(size_t nI, const vector<Tmut_t>& os) {
-        int dn = os.size();
+    /// bulk-add items (copied, or moved with move_iterator)
+    template<typename It>
+    void _push(size_t nI, It o, size_t nb) {
+        int dn = nb;
         if(!dn) return;
         auto& n = input_n.at(nI).first;
         if(n <= 0 && n + dn > 0) {
@@ -175,15 +281,38 @@ protected:
             assert(inputs_waiting >= 0);
         }
         n += dn;
-        for(auto& o: os) PQ.emplace(nI,o);
+        if(engine == COLLATE_HEAP) while(nb--) PQ.emplace(nI, *o++);
+        else {
+            auto& q = get_fifo(nI);
+            bool wasEmpty = q.empty();
+            q.insert(q.end(), o, o + nb);
+            nfifo += nb;
+            if(wasEmpty) tree_update(nI);
+        }
+        qprof.depth(q_size());
+        mem.set_items<iT>(q_size());
     }
 
-    /// pop next element (and push to nextSink)
-    void pop() {
-        auto& o = PQ.top();
-        if(!--input_n[o.first].first) ++inputs_waiting;
-        if(nextSink) nextSink->push(const_cast<Tmut_t&>(o.second));
-        PQ.pop();
+    /// pop next element (into outBatch for nextSink)
+    void pop() { _pop(nextSink? &outBatch : nullptr); }
+
+    /// pop next element, appending to v if provided
+    void _pop(vector<Tmut_t>* v) {
+        if(engine == COLLATE_HEAP) {
+            auto& o = PQ.top();
+            if(!--input_n[o.first].first) ++inputs_waiting;
+            if(v) v->push_back(std::move(const_cast<iT&>(o).second));
+            PQ.pop();
+            return;
+        }
+
+        auto nI = tree[1];
+        auto& q = fifos[nI];
+        if(!--input_n[nI].first) ++inputs_waiting;
+        if(v) v->push_back(std::move(q.front()));
+        q.pop_front();
+        --nfifo;
+        tree_update(nI);
     }
 
     /// one item from enumerated source
@@ -196,7 +325,47 @@ protected:
         }
     };
 
-    std::priority_queue<iT> PQ; ///< ordered inputs; lock on inputMut
+    std::priority_queue<iT, tagged_vector<iT>> PQ{std::less<iT>(), tagged_vector<iT>(TaggedAllocator<iT>("Collator::PQ"))}; ///< ordered inputs; lock on inputMut
+    mutex outMut;               ///< lock on delivery downstream, for signals ordered after threadjob() output
+    bool flushRequested = false;            ///< flush_thread() request pending; lock on inputMut
+    std::condition_variable flushDone;      ///< flush_thread() completion notifier
+    vector<Tmut_t> outBatch;    ///< popped outputs pending batch push to nextSink
+
+    // --- tournament engine ---
+
+    static constexpr size_t no_input = std::numeric_limits<size_t>::max();
+    vector<deque<Tmut_t>> fifos;    ///< per-input ordered queues
+    size_t nfifo = 0;               ///< total items in fifos
+    vector<size_t> tree;            ///< winner tree: node i holds input with earliest fifo head among its leaves
+
+    /// get input FIFO, expanding tree as needed
+    deque<Tmut_t>& get_fifo(size_t nI) {
+        if(nI >= fifos.size()) {
+            fifos.resize(nI + 1);
+            size_t nleaf = 1;
+            while(nleaf < fifos.size()) nleaf <<= 1;
+            if(2*nleaf != tree.size()) {
+                tree.assign(2*nleaf, size_t(no_input));
+                for(size_t i = 0; i < fifos.size(); ++i) tree[nleaf + i] = fifos[i].empty()? no_input : i;
+                for(size_t i = nleaf - 1; i > 0; --i) tree[i] = tree_match(tree[2*i], tree[2*i+1]);
+            }
+        }
+        return fifos[nI];
+    }
+
+    /// tournament tree comparison: input with earlier (or only) head item
+    size_t tree_match(size_t a, size_t b) const {
+        if(a == no_input) return b;
+        if(b == no_input) return a;
+        return ordering_t(deref_if_ptr(fifos[b].front())) < ordering_t(deref_if_ptr(fifos[a].front()))? b : a;
+    }
+
+    /// replay tournament path from changed input head
+    void tree_update(size_t nI) {
+        size_t i = tree.size()/2 + nI;
+        tree[i] = fifos[nI].empty()? no_input : nI;
+        for(i /= 2; i > 0; i /= 2) tree[i] = tree_match(tree[2*i], tree[2*i+1]);
+    }
 };
 
 #endif
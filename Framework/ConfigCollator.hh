@@ -5,20 +5,44 @@
 #define CONFIGCOLLATOR_HH
 
 #include "_ConfigCollator.hh"
-#include "Collator.hh"
+#include "FiberCollator.hh"
 
 /// Configturation-buildable Collator object
 template<class T>
-class ConfigCollator: public _ConfigCollator, public Collator<T> {
+class ConfigCollator: public _ConfigCollator, public FiberCollator<T> {
 public:
     /// Constructor
     explicit ConfigCollator(const Setting& S): _ConfigCollator(S) {
         if(S.exists("next")) createOutput(S["next"]);
     }
+    /// Destructor: stop persistent-mode threads while typed collator is intact
+    ~ConfigCollator() { finish_persistent(); }
+
+    /// XML output info
+    void _makeXML(XMLTag& X) override {
+        _ConfigCollator::_makeXML(X);
+        this->qprof.addXML(X);
+        this->copies.addXML(X);
+        this->mem.addXML(X);
+    }
+};
+
+/// ConfigCollator construction for AnaIndex; types without ordering_t (e.g. plain samples) fall back to untyped base
+template<typename T, typename = void>
+struct ConfigCollatorMaker {
+    /// construct untyped _ConfigCollator
+    static _ConfigCollator* make(const Setting& S, const _AnaIndex& I) { return I._AnaIndex::makeConfigCollator(S); }
+};
+
+/// ConfigCollator construction for types with ordering_t
+template<typename T>
+struct ConfigCollatorMaker<T, decltype(void(std::declval<typename std::remove_pointer<T>::type::ordering_t>()))> {
+    /// construct ConfigCollator<T>
+    static _ConfigCollator* make(const Setting& S, const _AnaIndex&) { return new ConfigCollator<T>(S); }
 };
 
 /// Registration in AnaIndex
 template<typename T>
-_ConfigCollator* AnaIndex<T>::makeConfigCollator(const Setting& S) const { return new ConfigCollator<T>(S); }
+_ConfigCollator* AnaIndex<T>::makeConfigCollator(const Setting& S) const { return ConfigCollatorMaker<T>::make(S, *this); }
 
 #endif
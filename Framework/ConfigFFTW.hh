@@ -0,0 +1,24 @@
+/// \file ConfigFFTW.hh Process-wide FFTW options from configuration
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef CONFIGFFTW_HH
+#define CONFIGFFTW_HH
+
+#include "FFTW_Batch.hh"
+#include "GlobalArgs.hh"
+#include "libconfig_readerr.hh"
+
+/// configure FFTW batch-plan threads ("threads") and persistent wisdom directory ("wisdom_dir") for precision T; call before planning
+template<typename T = double>
+void configureFFTW(const Setting& S) {
+    S.lookupValue("threads", fftw_batch_threads());
+    optionalGlobalArg("fftw_threads", fftw_batch_threads(), "FFTW planner threads for batched transforms");
+    if(fftw_batch_threads() < 1) fftw_batch_threads() = 1;
+
+    string d;
+    S.lookupValue("wisdom_dir", d);
+    optionalGlobalArg("fftw_wisdom", d, "FFTW persistent wisdom directory");
+    if(d.size()) FFTWWisdom<T>::enable(d);
+}
+
+#endif
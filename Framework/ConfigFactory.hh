@@ -9,6 +9,8 @@
 
 /// Compile-time registration of BASE object constructed from const Setting&
 #define REGISTER_CONFIG(NAME, BASE) static const ObjectFactory<BASE, NAME, const Setting&> the_##NAME##_CfgFactory(#NAME);
+/// Registration as above, allocating objects through ThreadCachePool (requires ThreadCacheAlloc.hh)
+#define REGISTER_CONFIG_CACHED(NAME, BASE) static const ObjectFactory<BASE, ThreadCached<NAME>, const Setting&> the_##NAME##_CfgFactory(#NAME);
 
 /// Construct configured object looked up from setting; return nullptr if unavailable
 template<typename BASE, typename... Args>
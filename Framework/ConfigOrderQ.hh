@@ -7,23 +7,68 @@
 #include "OrderingQueue.hh"
 #include "ConfigFactory.hh"
 #include "XMLTag.hh"
+#include "AdaptiveInterval.hh"
 
 /// Re-ordering filter
 template<class T>
 class ConfigOrderQ: public OrderingQueue<T>, public XMLProvider  {
 public:
+    /// parent class
+    typedef OrderingQueue<T> super_t;
+    using typename super_t::sink_t;
+    using typename super_t::mutsink_t;
+    using super_t::push;
+    using super_t::push_batch;
+
     /// Constructor
     explicit ConfigOrderQ(const Setting& S): XMLProvider("OrderingQueue") {
         this->createOutput(S["next"]);
         this->dt = 1e9;
         S.lookupValue("dt", this->dt);
+        double bw = 0;
+        int nb = 1024;
+        S.lookupValue("nbuckets", nb);
+        if(S.lookupValue("bucket_width", bw)) this->setBuckets(bw, nb);
+
+        adaptDt.x = this->dt;
+        S.lookupValue("target_depth", adaptDt.target);
+        S.lookupValue("dt_min", adaptDt.xmin);
+        S.lookupValue("dt_max", adaptDt.xmax);
+    }
+
+    /// add new item to sorted queue, with auto-flush
+    void push(sink_t& o) override { super_t::push(o); adapt(this->order(o)); }
+    /// move new item into sorted queue, with auto-flush
+    void push_move(mutsink_t&& o) override { auto t = this->order(o); super_t::push_move(std::move(o)); adapt(t); }
+    /// add batch of items to sorted queue, with single flush after last
+    void push_batch(sink_t* o, size_t n) override { super_t::push_batch(o, n); if(n) adapt(this->order(o[n-1]), n); }
+    /// move batch of items into sorted queue, with single flush after last
+    void push_move_batch(mutsink_t* o, size_t n) override {
+        if(!n) return;
+        auto t = this->order(o[n-1]);
+        super_t::push_move_batch(o, n);
+        adapt(t, n);
     }
 
 protected:
     /// XML output
     void _makeXML(XMLTag& X) override {
         X.addAttr("dt", this->dt);
+        if(this->bucketWidth()) X.addAttr("bucket_width", this->bucketWidth());
+        this->qprof.addXML(X);
+        this->copies.addXML(X);
+        this->mem.addXML(X);
+        if(adaptDt.enabled()) adaptDt.addXML(X, "adaptive_dt");
     }
+
+    /// tune dt to hold queue depth near target_depth, for n items arriving up to position t
+    void adapt(typename super_t::ordering_t t, size_t n = 1) {
+        if(!adaptDt.enabled()) return;
+        adaptDt.feedback(this->size());
+        this->dt = adaptDt.observe(t, n);
+    }
+
+    AdaptiveInterval adaptDt;   ///< dt tuning to target_depth queued items
 };
 
 #endif
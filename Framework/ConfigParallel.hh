@@ -7,7 +7,28 @@
 #include "ConfigCollator.hh"
 #include "ThreadBufferSink.hh"
 #include "ClusteredWindow.hh"
+#include "Hash64.hh"
+#include "AdaptiveInterval.hh"
 #include <thread>
+#include <utility>
+
+/// Key for sharded parallel processing: fasthash64(o.shard_key()) if available; specialize for other types
+template<typename T, typename = void>
+struct ShardKey {
+    /// whether type supports sharding
+    static constexpr bool enabled = false;
+    /// shard selection hash
+    static size_t hash(const T&) { return 0; }
+};
+
+/// Key for sharded parallel processing from o.shard_key()
+template<typename T>
+struct ShardKey<T, decltype(void(std::declval<const T&>().shard_key()))> {
+    /// whether type supports sharding
+    static constexpr bool enabled = true;
+    /// shard selection hash
+    static size_t hash(const T& o) { return fasthash64(o.shard_key()); }
+};
 
 /// Type-independent re-casting base
 class _ConfigParallel: public Configurable, public ThreadManager, public XMLProvider, public _SubSinkUser {
@@ -23,6 +44,11 @@ public:
 
 protected:
     int nparallel = 0;                  ///< number of parallel threads to run
+    int ringsize = 0;                   ///< lock-free input ring capacity for each chain (0 for mutex FIFO)
+    int poolthreads = 0;                ///< run() chains as tasks on work-stealing pool of this many threads (-1 for all cores; 0 for thread-per-chain)
+    bool pinthreads = false;            ///< pin pool threads to (NUMA-ordered) CPUs
+    bool sharded = false;               ///< route items to chains by ShardKey hash, instead of whole clusters round-robin
+    ThreadPlacement chainPlacement;     ///< CPU placement for parallel chain threads
     vector<_SinkUser*> vends;           ///< ends of parallel chains
     _ConfigCollator* myColl = nullptr;  ///< output collator
     Threadworker* keep_me = nullptr;    ///< keep one example chain for XML output
@@ -34,16 +60,31 @@ protected:
     void makeCollator();
 
     /// XML metadata output
-    void _makeXML(XMLTag& X) override { X.addAttr("nparallel", nparallel); }
+    void _makeXML(XMLTag& X) override {
+        X.addAttr("nparallel", nparallel);
+        if(ringsize > 0) X.addAttr("ringsize", ringsize);
+        if(poolthreads) X.addAttr("poolthreads", poolthreads);
+        if(sharded) X.addAttr("sharded", "true");
+        if(chainPlacement.mode) X.addAttr("affinity", chainPlacement.describe());
+    }
 };
 
 /// Configurable parallelize-and-collate process
 template<typename T, class CLUST = Clusterer<T>>
 class ConfigParallel: virtual public _ConfigParallel, public PreSink<CLUST> {
 public:
+    /// mutable item type
+    typedef typename std::remove_const<T>::type Tmut_t;
+
     /// Constructor
     explicit ConfigParallel(const Setting& S): _ConfigParallel(S), PreSink<CLUST>(1000) {
         S.lookupValue("cluster_dt", this->PreTransform.cluster_dx);
+        adaptDt.x = this->PreTransform.cluster_dx;
+        adaptDt.model = AdaptiveInterval::GAP;
+        S.lookupValue("target_batch", adaptDt.target);
+        S.lookupValue("cluster_dt_min", adaptDt.xmin);
+        S.lookupValue("cluster_dt_max", adaptDt.xmax);
+        if(sharded && !ShardKey<Tmut_t>::enabled) throw std::runtime_error("ConfigParallel sharding requires item shard_key()");
 
         if(S.exists("next")) { // collated mode
 
@@ -61,8 +102,9 @@ public:
 
             int nth = nparallel;
             do {
-                vout.push_back(new ThreadBufferSink<T>(constructCfgObj<DataSink<T>>(Cfg["parallel"], "")));
+                vout.push_back(new ThreadBufferSink<T>(constructCfgObj<DataSink<T>>(Cfg["parallel"], ""), std::max(ringsize, 0)));
                 vout.back()->worker_id = --nth;
+                vout.back()->placement = chainPlacement;
             } while(nth > 0);
 
             if(!nth) for(auto c: vout) c->launch_mythread();
@@ -81,27 +123,75 @@ public:
 
     /// add new parallel stream
     void addParallel() {
-        vout.push_back(new ThreadBufferSink<T>(constructCfgObj<DataSink<T>>(Cfg["parallel"], "")));
+        vout.push_back(new ThreadBufferSink<T>(constructCfgObj<DataSink<T>>(Cfg["parallel"], ""), std::max(ringsize, 0)));
         vout.back()->worker_id = vout.size()-1;
+        vout.back()->placement = chainPlacement;
         vends.push_back(_find_lastSink(vout.back()));
         vends.back()->setOwnsNext(false);
     }
 
-    /// pass clustered inputs round-robin to parallel chains
+    /// input item type
+    typedef typename PreSink<CLUST>::input_t input_t;
+    using PreSink<CLUST>::push_batch;
+
+    /// receive input item, with adaptive cluster_dt rate monitoring
+    void push(input_t& o) override { adapt(o, 1); PreSink<CLUST>::push(o); }
+    /// receive input batch, with adaptive cluster_dt rate monitoring
+    void push_batch(input_t* o, size_t n) override { if(n) adapt(o[n-1], n); PreSink<CLUST>::push_batch(o, n); }
+    /// receive moved input item, with adaptive cluster_dt rate monitoring
+    void push_move(Tmut_t&& o) override { adapt(o, 1); PreSink<CLUST>::push_move(std::move(o)); }
+    /// receive moved input batch, with adaptive cluster_dt rate monitoring
+    void push_move_batch(Tmut_t* o, size_t n) override { if(n) adapt(o[n-1], n); PreSink<CLUST>::push_move_batch(o, n); }
+
+    /// pass clustered inputs round-robin to parallel chains, or items by shard key
     void _push(typename CLUST::cluster_t& C) override {
         if(!vout.size()) return;
-        auto o = vout[(outn++) % vout.size()];
-        for(auto& p: C) o->push(p);
+        if(adaptDt.enabled()) adaptDt.feedback(C.size());
+        if(!sharded) {
+            vout[(outn++) % vout.size()]->push_batch(C.data(), C.size());
+            return;
+        }
+        shards.resize(vout.size());
+        for(auto& o: C) shards[ShardKey<Tmut_t>::hash(o) % vout.size()].push_back(std::move(o));
+        for(size_t i = 0; i < vout.size(); ++i) {
+            if(!shards[i].size()) continue;
+            vout[i]->push_move_batch(shards[i].data(), shards[i].size());
+            shards[i].clear();
+        }
     }
 
     /// handle signals through pre-transform
     void _signal(datastream_signal_t s) override {
+        // quiesce all chains before any checkpoints, for consistent state at collator
+        if(s == DATASTREAM_CHECKPT) for(auto o: vout) o->drain_wait();
         for(auto& o: vout) o->signal(s);
         if(myColl) myColl->signal(s);
     }
 
 protected:
+    /// update cluster_dt for n items arriving up to o
+    void adapt(const Tmut_t& o, size_t n) {
+        if(adaptDt.enabled()) this->PreTransform.cluster_dx = adaptDt.observe(double(typename CLUST::ordering_t(o)), n);
+    }
+
+    /// XML metadata output, including chain input queue instrumentation
+    void _makeXML(XMLTag& X) override {
+        _ConfigParallel::_makeXML(X);
+        for(auto o: vout) o->qprof.addXML(X, "chain_profile");
+        string mp;
+        for(auto o: vout) mp += (mp.size()? "," : "") + to_str(o->mem.peak());
+        if(vout.size()) X.addAttr("chain_mem_peak", mp);
+        if(chainPlacement.mode) {
+            string s;
+            for(auto o: vout) s += (s.size()? ";" : "") + cpulist_str(o->boundCPUs());
+            X.addAttr("chain_cpus", s);
+        }
+        if(adaptDt.enabled()) adaptDt.addXML(X, "adaptive_cluster_dt");
+    }
+
     size_t outn = 0;                    ///< round-robin output index
+    AdaptiveInterval adaptDt;           ///< cluster_dt tuning to target_batch cluster size
+    vector<vector<Tmut_t>> shards;      ///< sharded-mode per-chain item batches
     vector<ThreadBufferSink<T>*> vout;  ///< outputs to parallel chains
 };
 
@@ -0,0 +1,27 @@
+/// \file ConfigThreader.cc
+
+#include "ConfigThreader.hh"
+
+void configurePlacement(ThreadPlacement& P, const Setting& S, const string& key) {
+    if(!S.exists(key)) return;
+    auto& A = S[key];
+
+    if(A.isArray() || A.isList()) {
+        P.mode = ThreadPlacement::PLACE_CPUS;
+        P.cpus.clear();
+        for(int i = 0; i < A.getLength(); ++i) P.cpus.push_back(A[i]);
+        if(!P.cpus.size()) P.mode = ThreadPlacement::PLACE_NONE;
+        return;
+    }
+
+    string s = A;
+    if(s == "none") P.mode = ThreadPlacement::PLACE_NONE;
+    else if(s == "parent") P.mode = ThreadPlacement::PLACE_PARENT;
+    else if(s == "numa") {
+        P.mode = ThreadPlacement::PLACE_NUMA;
+        P.node = -1;
+    } else if(s.substr(0,5) == "numa:") {
+        P.mode = ThreadPlacement::PLACE_NUMA;
+        P.node = atoi(s.c_str() + 5);
+    } else throw std::runtime_error("Unknown thread placement '" + s + "'");
+}
@@ -8,12 +8,15 @@
 #include "Threadworker.hh"
 #include "XMLTag.hh"
 
+/// configure thread placement from Setting S[key]: "none", "numa" (round-robin), "numa:<node>", "parent", or [CPU list]
+void configurePlacement(ThreadPlacement& P, const Setting& S, const string& key = "affinity");
+
 /// combine Configurable with Threadworker
 class ConfigThreader: public Configurable, public Threadworker, virtual public XMLProvider {
 public:
     /// Constructor
     explicit ConfigThreader(const Setting& S, int i = 0):
-    XMLProvider("ConfigThreader"), Configurable(S), Threadworker(i) { }
+    XMLProvider("ConfigThreader"), Configurable(S), Threadworker(i) { configurePlacement(placement, S); }
     /// run in thread
     void threadjob() override { run(); }
 };
@@ -33,4 +36,53 @@ public:
     bool ownsWrapped = true;
 };
 
+/// wrapper running Configurable once per segment in a persistent thread, kept alive between segments
+class PersistentConfigThread: public ConfigThreadWrapper {
+public:
+    /// Constructor
+    explicit PersistentConfigThread(Configurable* _C = nullptr, int i = 0): ConfigThreadWrapper(_C, i) { }
+    /// Destructor
+    ~PersistentConfigThread() { if(checkRunning()) finish_mythread(); }
+
+    /// start next run of C in (launched) thread
+    void start_segment() {
+        lock_guard<mutex> lk(inputMut);
+        ++nRequested;
+        inputReady.notify_all();
+    }
+    /// wait for completion of requested runs
+    void wait_segment() {
+        unique_lock<mutex> lk(inputMut);
+        segmentDone.wait(lk, [this]{ return nDone == nRequested; });
+    }
+    /// set STOP_REQUESTED and notify, after any requested runs complete
+    void request_stop() override {
+        lock_guard<mutex> lk(inputMut);
+        ConfigThreadWrapper::request_stop();
+        inputReady.notify_all();
+    }
+    /// number of completed runs
+    size_t segments() const { return nDone; }
+
+protected:
+    /// run C for each requested segment, until stopped
+    void threadjob() override {
+        while(true) {
+            {
+                unique_lock<mutex> lk(inputMut);
+                inputReady.wait(lk, [this]{ return nDone < nRequested || runstat == STOP_REQUESTED; });
+                if(nDone == nRequested) break;
+            }
+            if(C) C->run();
+            lock_guard<mutex> lk(inputMut);
+            ++nDone;
+            segmentDone.notify_all();
+        }
+    }
+
+    size_t nRequested = 0;                  ///< number of runs requested; lock on inputMut
+    size_t nDone = 0;                       ///< number of runs completed; lock on inputMut
+    std::condition_variable segmentDone;    ///< run completion notifier
+};
+
 #endif
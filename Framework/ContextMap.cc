@@ -2,20 +2,35 @@
 
 #include "ContextMap.hh"
 
+/// per-thread context stack, deleting contexts at thread exit
+struct ContextStack: public std::vector<ContextMap*> {
+    /// Destructor
+    ~ContextStack() { while(ContextMap::popContext()) { } }
+};
+
 std::vector<ContextMap*>& ContextMap::getContextStack() {
-    static std::vector<ContextMap*> v;
+    static thread_local ContextStack v;
     return v;
 }
 
-ContextMap& ContextMap::getContext() {
-    auto& v = getContextStack();
-    if(!v.size()) v.push_back(new ContextMap);
-    return *v.back();
+ContextMap& ContextMap::getRootContext() {
+    static ContextMap M;
+    return M;
+}
+
+size_t ContextMap::newSlot() {
+    static std::atomic<size_t> n{0};
+    return n++;
+}
+
+std::atomic<uint64_t>& ContextMap::generation() {
+    static std::atomic<uint64_t> g{0};
+    return g;
 }
 
 ContextMap& ContextMap::pushContext() {
     auto& v = getContextStack();
-    v.push_back(new ContextMap(v.size()? v.back() : nullptr));
+    v.push_back(new ContextMap(&getContext()));
     return *v.back();
 }
 
@@ -31,16 +46,24 @@ bool ContextMap::popContext() {
 
 ContextMap& ContextMap::operator=(const ContextMap& M) {
     if(&M == this) return *this;
-    for(auto& kv: M.dat) {
-        if(kv.second.second) dat[kv.first] = {kv.second.second->clone(kv.second.first), kv.second.second->clowner()};
-        else dat.emplace(kv);
+    if(dat.size() < M.dat.size()) dat.resize(M.dat.size());
+    for(size_t i = 0; i < M.dat.size(); ++i) {
+        auto& d = M.dat[i];
+        if(!d.isset) continue;
+        disown(i);
+        if(d.owner) dat[i] = {d.owner->clone(d.p), d.owner->clowner(), true};
+        else dat[i] = d;
     }
+    ++generation();
     return *this;
 }
 
-void ContextMap::disown(tp_t x) {
-    auto it = dat.find(x);
-    if(it == dat.end()) return;
-    if(it->second.second) it->second.second->deletep(it->second.first);
-    dat.erase(it);
+void ContextMap::disown(size_t i) {
+    if(i >= dat.size() || !dat[i].isset) return;
+    if(dat[i].owner) {
+        dat[i].owner->deletep(dat[i].p);
+        delete dat[i].owner;
+    }
+    dat[i] = {};
+    ++generation();
 }
@@ -5,12 +5,15 @@
 #define CONTEXTMAP_HH
 
 #include <utility>
-#include <map>
 #include <vector>
 #include <stdexcept>
-#include <typeinfo>
+#include <atomic>
+#include <stdint.h>
 
-/// Utility for (context-scoped) cascading variables lookup
+/// Utility for (context-scoped) cascading variables lookup.
+/// Each thread has its own context stack, above a shared process-wide root context;
+/// values are stored by per-type slot index, with parent-chain lookups cached until any context is modified.
+/// Modifying the root context while other threads read it is not thread-safe.
 class ContextMap {
 public:
     /// Default constructor
@@ -20,16 +23,28 @@ public:
     /// Copy Assignment
     ContextMap& operator=(const ContextMap& o);
     /// Destructor
-    ~ContextMap() { for(auto& kv: dat) if(kv.second.second) kv.second.second->deletep(kv.second.first); }
+    ~ContextMap() {
+        for(auto& d: dat) {
+            if(!d.owner) continue;
+            d.owner->deletep(d.p);
+            delete d.owner;
+        }
+        ++generation();
+    }
 
-    /// get active context (create if none previously exist)
-    static ContextMap& getContext();
-    /// push new active context
+    /// get active context for this thread (shared root context if none pushed)
+    static ContextMap& getContext() {
+        auto& v = getContextStack();
+        return v.size()? *v.back() : getRootContext();
+    }
+    /// push new active context for this thread
     static ContextMap& pushContext();
-    /// delete active context (invalidates references); return whether any were deleted
+    /// delete this thread's active context (invalidates references); return whether any were deleted
     static bool popContext();
-    /// active context stack
+    /// this thread's active context stack
     static std::vector<ContextMap*>& getContextStack();
+    /// shared process-wide base context
+    static ContextMap& getRootContext();
 
     /// clear value
     template<typename U, typename T = void>
@@ -37,7 +52,7 @@ public:
 
     /// clear value
     template<typename U, typename T = void>
-    void _unset() { disown(tp_id<U,T>()); }
+    void _unset() { disown(slot_id<U,T>()); }
 
     /// set labeled object
     template<typename U, typename T = void>
@@ -47,7 +62,7 @@ public:
     template<typename U, typename T = void>
     void _setPtr(U* x) {
         _unset<U,T>();
-        dat[tp_id<U,T>()] = {x, nullptr};
+        slot(slot_id<U,T>()) = {x, nullptr, true};
     }
 
     /// set labeled object with copy
@@ -58,7 +73,7 @@ public:
     template<typename U, typename T = void>
     void _setCopy(const U& x) {
         _unset<U,T>();
-        dat[tp_id<U,T>()] = {new U(x), new owner_t<U>};
+        slot(slot_id<U,T>()) = {new U(x), new owner_t<U>, true};
     }
 
     /// get (possibly-nullptr) U* labeled by T
@@ -67,11 +82,7 @@ public:
 
     /// get (possibly-nullptr) U* labeled by T
     template<typename U, typename T = void>
-    U* _get() {
-        auto it = dat.find(tp_id<U,T>());
-        if(it != dat.end()) return static_cast<U*>(it->second.first);
-        return parent? parent->_get<U,T>() : nullptr;
-    }
+    U* _get() { return static_cast<U*>(getSlot(slot_id<U,T>())); }
 
     /// get reference labeled by T; throw if nonexistent
     template<typename U, typename T = void>
@@ -108,15 +119,22 @@ public:
 
 protected:
 
-    /// type hashes pair
-    typedef std::pair<size_t, size_t> tp_t;
-    /// create type pair identifier
-    template<typename T, typename U>
-    static constexpr tp_t tp_id() { return {typeid(T).hash_code(), typeid(U).hash_code()}; }
+    /// allocate new type slot index
+    static size_t newSlot();
+    /// per-type slot index, assigned on first use
+    template<typename U, typename T>
+    static size_t slot_id() {
+        static const size_t i = newSlot();
+        return i;
+    }
+    /// modification counter for all contexts, invalidating cached lookups
+    static std::atomic<uint64_t>& generation();
 
     /// Base pointer ownership wrapper
     class _owner_t {
     public:
+        /// polymorphic destructor
+        virtual ~_owner_t() { }
         /// delete pointer
         virtual void deletep(void* p) const = 0;
         /// clone pointer
@@ -137,11 +155,40 @@ protected:
         _owner_t* clowner() const override { return new owner_t; }
     };
 
-    std::map<tp_t, std::pair<void*, _owner_t*>> dat; ///< data map
-    ContextMap* parent = nullptr;                    ///< parent reference
+    /// stored value in slot
+    struct slot_t {
+        void* p = nullptr;          ///< value
+        _owner_t* owner = nullptr;  ///< deleter for owned value; nullptr if not owned
+        bool isset = false;         ///< whether value is set (possibly to nullptr)
+    };
+    /// cached value resolved through parent chain
+    struct cached_t {
+        void* p = nullptr;  ///< resolved value
+        uint64_t gen = 0;   ///< generation + 1 at resolution; 0 if unresolved
+    };
+
+    std::vector<slot_t> dat;                ///< data by slot index
+    mutable std::vector<cached_t> resolved; ///< parent-chain lookups by slot index
+    ContextMap* parent = nullptr;           ///< parent reference
 
+    /// access slot i for assignment
+    slot_t& slot(size_t i) {
+        if(i >= dat.size()) dat.resize(i + 1);
+        ++generation();
+        return dat[i];
+    }
+    /// get (possibly-nullptr) value in slot i, or inherited from parent chain
+    void* getSlot(size_t i) {
+        if(i < dat.size() && dat[i].isset) return dat[i].p;
+        if(!parent) return nullptr;
+        auto g = generation().load(std::memory_order_relaxed) + 1;
+        if(i < resolved.size() && resolved[i].gen == g) return resolved[i].p;
+        if(i >= resolved.size()) resolved.resize(i + 1);
+        resolved[i] = {parent->getSlot(i), g};
+        return resolved[i].p;
+    }
     /// remove previous contents
-    void disown(tp_t x);
+    void disown(size_t i);
 };
 
 /// Context-settable singleton helper: adds singleton get/set/lookup to class
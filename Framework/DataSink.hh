@@ -8,6 +8,7 @@
 #include "AnaIndex.hh"
 #include "ConfigFactory.hh"
 #include "XMLTag.hh"
+#include "Profiler.hh"
 
 /// Virtual base class for accepting a stream of objects
 template<typename T>
@@ -20,12 +21,35 @@ public:
 
     /// take instance of object
     virtual void push(sink_t&) = 0;
+    /// take contiguous batch of n objects; override for batch-aware processing
+    virtual void push_batch(sink_t* o, size_t n) { while(n--) push(*o++); }
+    /// take object by ownership transfer (may be left moved-from); override for move-aware processing
+    virtual void push_move(mutsink_t&& o) { push(o); }
+    /// take batch of objects by ownership transfer (may be left moved-from); override for move-aware processing
+    virtual void push_move_batch(mutsink_t* o, size_t n) { push_batch(o, n); }
+    /// take one complete group (e.g. event) of n objects; override for group-aware processing
+    virtual void push_group(sink_t* o, size_t n) { push_batch(o, n); }
+    /// take vector of objects as batch
+    void push_batch(vector<mutsink_t>& v) { push_batch(v.data(), v.size()); }
 };
 
-/// Registration in AnaIndex
+class StageProfile;
+class NoStageProfile;
+/// Pass-through profiling link (ProfiledLink.hh)
+template<typename T, class P = StageProfile>
+class ProfiledLink;
+
+/// Registration in AnaIndex; wrapped in ProfiledLink if configured with `profile = true`, or when Profiler enabled
 template<typename T>
 _DataSink* AnaIndex<T>::makeDataSink(const Setting& S, const string& dfltclass) const {
-    return constructCfgObj<DataSink<T>>(S, dfltclass);
+    auto s = constructCfgObj<DataSink<T>>(S, dfltclass);
+    bool prof = false;
+    S.lookupValue("profile", prof);
+    string zname = dfltclass;
+    S.lookupValue("class", zname);
+    if(prof) return new ProfiledLink<T>(s, zname);
+    if(Profiler::isEnabled()) return new ProfiledLink<T, NoStageProfile>(s, zname);
+    return s;
 }
 
 /// Base class outputting to a sink
@@ -77,6 +101,16 @@ public:
     virtual void su_signal(datastream_signal_t s) { if(nextSink) nextSink->signal(s); }
 
 protected:
+    /// pass batch of output to nextSink
+    void nextBatch(output_t* o, size_t n) { if(nextSink && n) nextSink->push_batch(o, n); }
+    /// pass (and clear) vector batch of output to nextSink, transferring ownership
+    void nextBatch(vector<typename std::remove_const<output_t>::type>& v) {
+        if(nextSink && v.size()) nextSink->push_move_batch(v.data(), v.size());
+        v.clear();
+    }
+    /// pass output to nextSink, transferring ownership
+    void nextMove(typename std::remove_const<output_t>::type&& o) { if(nextSink) nextSink->push_move(std::move(o)); }
+
     bool ownsNext = true;           ///< responsible for deleting output?
     dsink_t* nextSink = nullptr;    ///< recipient of output
 };
@@ -114,6 +148,8 @@ protected:
     public:
         explicit _xfer(PreSink& _out): out(_out) { }
         void push(mid_t& o) override { out._push(o); }
+        void push_batch(mid_t* o, size_t n) override { out._push_batch(o, n); }
+        using DataSink<mid_t>::push_batch;
         void signal(datastream_signal_t s) override { out._signal(s); }
     protected:
         PreSink& out;
@@ -130,16 +166,26 @@ public:
 
     /// pass input to pre-filter
     void push(input_t& o) override { PreTransform.push(o); }
+    /// pass input batch to pre-filter
+    void push_batch(input_t* o, size_t n) override { PreTransform.push_batch(o, n); }
+    /// pass moved input to pre-filter
+    void push_move(typename DataSink<input_t>::mutsink_t&& o) override { PreTransform.push_move(std::move(o)); }
+    /// pass moved input batch to pre-filter
+    void push_move_batch(typename DataSink<input_t>::mutsink_t* o, size_t n) override { PreTransform.push_move_batch(o, n); }
+    using DataSink<input_t>::push_batch;
     /// pass through signals
     void signal(datastream_signal_t s) override { PreTransform.signal(s); }
 
 protected:
     /// Override to handle pre-transformed input:
     virtual void _push(mid_t&) = 0;
+    /// Override to handle batches of pre-transformed input
+    virtual void _push_batch(mid_t* o, size_t n) { while(n--) _push(*o++); }
     /// Override to handle signals through pre-transform
     virtual void _signal(datastream_signal_t) = 0;
 };
 
 #include "ConfigCollator.hh"
+#include "ProfiledLink.hh"
 
 #endif
@@ -5,14 +5,17 @@
 #define DATASINKTEE_HH
 
 #include "ConfigFactory.hh"
+#include "ThreadBufferSink.hh"
 #include "XMLTag.hh"
 
 /// Tee input to multiple configured sinks
+/// optional parallel mode runs each branch in own thread, behind bounded input queue
 template<typename T>
 class DataSinkTee: public DataSink<T>, virtual public XMLProvider {
 public:
     typedef T sink_t;
     typedef DataSink<T> dsink_t;
+    typedef ThreadBufferSink<T> branch_t;
 
     /// Constructor, from config file
     explicit DataSinkTee(const Setting& S): XMLProvider("DataSinkTee") {
@@ -21,18 +24,62 @@ public:
         if(nxt.isList()) for(auto& cfg: nxt) sinks.push_back(constructCfgObj<dsink_t>(cfg, ""));
         else sinks.push_back(constructCfgObj<dsink_t>(nxt, ""));
         for(auto s: sinks) tryAdd(s);
+
+        S.lookupValue("parallel", parallel);
+        if(!parallel) return;
+
+        int qsize = 1024;
+        S.lookupValue("queuesize", qsize);
+        if(qsize <= 0) throw std::runtime_error("DataSinkTee parallel queuesize must be positive");
+        string bp = "block";
+        S.lookupValue("backpressure", bp);
+        if(bp == "block") overflow = branch_t::OVERFLOW_BLOCK;
+        else if(bp == "drop_oldest") overflow = branch_t::OVERFLOW_DROP_OLDEST;
+        else if(bp == "sample") overflow = branch_t::OVERFLOW_SAMPLE;
+        else throw std::runtime_error("DataSinkTee unknown backpressure policy '" + bp + "'");
+
+        for(auto& s: sinks) {
+            // lock-free ring when oldest items need not be dropped
+            auto b = new branch_t(s, overflow == branch_t::OVERFLOW_DROP_OLDEST? 0 : qsize);
+            b->setOverflow(overflow, qsize);
+            b->worker_id = branches.size();
+            branches.push_back(b);
+            s = b;
+        }
+        for(auto b: branches) b->launch_mythread();
     }
 
     /// Destructor
-    ~DataSinkTee() { for(auto s: sinks) delete s; }
+    ~DataSinkTee() {
+        for(auto b: branches) if(b->checkRunning()) b->finish_mythread();
+        for(auto s: sinks) delete s;
+    }
 
     /// take instance of object
     void push(sink_t& x) override { for(auto s: sinks) s->push(x); }
-    /// accept data flow signal
-    void signal(datastream_signal_t sig) override { for(auto s: sinks) s->signal(sig); }
+    /// accept data flow signal; in parallel mode, wait for all branches to drain preceding data
+    void signal(datastream_signal_t sig) override {
+        for(auto b: branches) b->drain_wait();
+        for(auto s: sinks) s->signal(sig);
+    }
 
 protected:
-    vector<dsink_t*> sinks; ///< output sinks
+    /// XML output of parallel mode configuration and drop counts
+    void _makeXML(XMLTag& X) override {
+        if(!parallel) return;
+        X.addAttr("parallel", "true");
+        X.addAttr("backpressure", overflow == branch_t::OVERFLOW_BLOCK? "block" :
+                                  overflow == branch_t::OVERFLOW_DROP_OLDEST? "drop_oldest" : "sample");
+        size_t nd = 0;
+        for(auto b: branches) nd += b->n_dropped();
+        X.addAttr("n_dropped", nd);
+        for(auto b: branches) b->qprof.addXML(X, "branch_profile");
+    }
+
+    vector<dsink_t*> sinks;     ///< output sinks (parallel branch input buffers in parallel mode)
+    vector<branch_t*> branches; ///< parallel mode per-branch threaded buffers
+    bool parallel = false;      ///< whether to run branches in parallel threads
+    typename branch_t::overflow_t overflow = branch_t::OVERFLOW_BLOCK;  ///< parallel branch full-queue policy
 };
 
 #endif
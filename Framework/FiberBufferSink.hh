@@ -0,0 +1,144 @@
+/// \file FiberBufferSink.hh Buffered input to sink running in its own fiber
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef FIBERBUFFERSINK_HH
+#define FIBERBUFFERSINK_HH
+
+#include "DataSink.hh"
+#include "StageProfile.hh"
+#include <boost/fiber/buffered_channel.hpp>
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/mutex.hpp>
+
+/// Buffered input to sink running in its own fiber (fiber-scheduled analog of ThreadBufferSink)
+/// batches are passed through bounded fiber channel; pushing to a full channel suspends only the calling fiber
+template<typename T>
+class FiberBufferSink: public DataLink<T,T> {
+public:
+    typedef typename std::remove_const<T>::type Tmut_t;
+    using DataLink<T,T>::nextSink;
+
+    /// Constructor, with channel capacity (in batches) and batch size
+    explicit FiberBufferSink(DataSink<T>* s = nullptr, size_t nchan = 16, size_t nbatch = 256):
+    batchSize(std::max(nbatch, size_t(1))), chan(chan_capacity(nchan)) { nextSink = s; }
+    /// Destructor
+    ~FiberBufferSink() { finish(); }
+
+    /// start reader fiber (scheduled in calling thread)
+    void launch() {
+        if(F.joinable()) throw std::logic_error("Double launch attempted");
+        F = boost::fibers::fiber([this] { fiberjob(); });
+    }
+    /// pass remaining input downstream and wait for reader fiber completion
+    void finish() {
+        if(!F.joinable()) return;
+        post();
+        chan.close();
+        F.join();
+    }
+    /// whether reader fiber is running
+    bool launched() const { return F.joinable(); }
+
+    /// receive item to queue
+    void push(T& o) override {
+        copies.copied();
+        pending.push_back(o);
+        if(pending.size() >= batchSize) post();
+    }
+    /// receive item to queue by ownership transfer
+    void push_move(Tmut_t&& o) override {
+        copies.moved();
+        pending.push_back(std::move(o));
+        if(pending.size() >= batchSize) post();
+    }
+    /// receive batch of items to queue
+    void push_batch(T* o, size_t n) override {
+        copies.copied(n);
+        pending.insert(pending.end(), o, o + n);
+        if(pending.size() >= batchSize) post();
+    }
+    /// receive batch of items to queue by ownership transfer
+    void push_move_batch(Tmut_t* o, size_t n) override {
+        copies.moved(n);
+        pending.insert(pending.end(), std::make_move_iterator(o), std::make_move_iterator(o + n));
+        if(pending.size() >= batchSize) post();
+    }
+    using DataLink<T,T>::push_batch;
+
+    /// pass signal downstream in order after queued input; wait (suspending calling fiber) until handled
+    void signal(datastream_signal_t sig) override {
+        if(!F.joinable()) {
+            this->nextBatch(pending);
+            if(nextSink) nextSink->signal(sig);
+            return;
+        }
+        msg_t m;
+        std::swap(m.v, pending);
+        m.sig = sig;
+        qprof.count_signal();
+        size_t nsig;
+        {
+            std::unique_lock<boost::fibers::mutex> lk(sigMut);
+            nsig = ++nPosted;
+        }
+        chan.push(std::move(m));
+        std::unique_lock<boost::fibers::mutex> lk(sigMut);
+        sigDone.wait(lk, [this, nsig] { return nHandled >= nsig; });
+    }
+
+    const size_t batchSize;         ///< number of items per batch passed through channel
+    default_stage_profile_t qprof;  ///< input batch instrumentation
+    SinkCopyCounter copies;         ///< input copy/move counting
+
+protected:
+    /// channel message: batch, with optional signal after
+    struct msg_t {
+        vector<Tmut_t> v;                           ///< data batch
+        datastream_signal_t sig = DATASTREAM_NOOP;  ///< signal to pass after batch
+    };
+
+    /// channel capacity rounded up to power of 2 (holds one less)
+    static size_t chan_capacity(size_t n) {
+        size_t c = 2;
+        while(c < n + 1) c <<= 1;
+        return c;
+    }
+
+    /// send pending batch to reader fiber (directly downstream if not launched)
+    void post() {
+        if(!pending.size()) return;
+        if(!F.joinable()) { this->nextBatch(pending); return; }
+        qprof.depth(pending.size());
+        msg_t m;
+        std::swap(m.v, pending);
+        pending.reserve(batchSize);
+        chan.push(std::move(m));
+    }
+
+    /// reader fiber: pass batches and signals downstream until channel closed
+    void fiberjob() {
+        msg_t m;
+        while(chan.pop(m) == boost::fibers::channel_op_status::success) {
+            auto t0 = qprof.start();
+            auto n = m.v.size();
+            this->nextBatch(m.v);
+            qprof.stop(t0, n);
+            if(m.sig == DATASTREAM_NOOP) continue;
+            if(nextSink) nextSink->signal(m.sig);
+            std::unique_lock<boost::fibers::mutex> lk(sigMut);
+            ++nHandled;
+            sigDone.notify_all();
+        }
+    }
+
+    vector<Tmut_t> pending;                     ///< input accumulating into next batch
+    boost::fibers::buffered_channel<msg_t> chan;///< batches to reader fiber
+    boost::fibers::fiber F;                     ///< reader fiber
+    boost::fibers::mutex sigMut;                ///< lock on signal counters
+    boost::fibers::condition_variable sigDone;  ///< signal completion notifier
+    size_t nPosted = 0;                         ///< number of signals sent
+    size_t nHandled = 0;                        ///< number of signals passed downstream
+};
+
+#endif
@@ -0,0 +1,121 @@
+/// \file FiberCollator.hh Collate items pushed from many lightweight fiber tasks in one thread
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef FIBERCOLLATOR_HH
+#define FIBERCOLLATOR_HH
+
+#include "Collator.hh"
+#include "DataSource.hh"
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+#include <boost/fiber/mutex.hpp>
+
+// (DataSource.hh may be mid-inclusion via DataSink.hh -> ConfigCollator.hh)
+template<class C>
+class DataSource;
+
+/// Collator with inputs pushed from fibers, e.g. thousands of per-file readers without one OS thread each
+/// an input running maxAhead items ahead of a waiting input suspends its fiber, instead of buffering without bound
+template<typename T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
+class FiberCollator: public Collator<T, _ordering_t> {
+public:
+    /// parent class
+    typedef Collator<T, _ordering_t> super_t;
+    using typename super_t::Tmut_t;
+    using typename super_t::MOInput;
+    using super_t::vInputs;
+
+    /// input handle suspending pushing fiber when too far ahead of other inputs
+    class MOfInput: public MOInput {
+    public:
+        using MOInput::n;
+
+        /// constructor
+        explicit MOfInput(FiberCollator& _M, _SinkUser* s = nullptr): MOInput(_M, s), FC(_M) { }
+        /// DataSink push
+        void push(T& o) override { { auto l = FC.lock(); MOInput::push(o); } FC.throttle(n); }
+        /// bulk push
+        void push(const vector<Tmut_t>& os) override { { auto l = FC.lock(); MOInput::push(os); } FC.throttle(n); }
+        /// DataSink batch push
+        void push_batch(T* o, size_t nb) override { { auto l = FC.lock(); MOInput::push_batch(o, nb); } FC.throttle(n); }
+        /// DataSink move push
+        void push_move(Tmut_t&& o) override { { auto l = FC.lock(); MOInput::push_move(std::move(o)); } FC.throttle(n); }
+        /// DataSink move batch push
+        void push_move_batch(Tmut_t* o, size_t nb) override { { auto l = FC.lock(); MOInput::push_move_batch(o, nb); } FC.throttle(n); }
+        using MOInput::push_batch;
+
+    protected:
+        FiberCollator& FC;  ///< collator with throttle
+    };
+
+    /// connect SinkUser as input pushed from fiber task; return input enumeration
+    size_t connect_fiber_input(_SinkUser& s, int nreq = 0) override {
+        auto i = new MOfInput(*this, &s);
+        vInputs.push_back(i);
+        this->change_required(i->n, nreq);
+        return i->n;
+    }
+    /// add task feeding input nI, to run as fiber in run_fibers()
+    void add_fiber_task(size_t nI, const std::function<void()>& f) override { tasks.emplace_back(nI, f); }
+
+    /// add (not owned) DataSource read in chunks by fiber into new input; return input enumeration
+    size_t addSource(DataSource<Tmut_t>& S) {
+        auto i = new MOfInput(*this);
+        vInputs.push_back(i);
+        add_fiber_task(i->n, [this, i, &S] {
+            vector<Tmut_t> v;
+            Tmut_t o;
+            while(true) {
+                while(v.size() < chunkSize && S.next(o)) v.push_back(std::move(o));
+                if(!v.size()) break;
+                i->push_move_batch(v.data(), v.size());
+                v.clear();
+            }
+        });
+        return i->n;
+    }
+
+    /// run fiber tasks in calling thread until all complete; then flush
+    void run_fibers() override {
+        vector<boost::fibers::fiber> fs;
+        fs.reserve(tasks.size());
+        for(auto& t: tasks) {
+            auto nI = t.first;
+            auto& f = t.second;
+            fs.emplace_back(std::allocator_arg, boost::fibers::fixedsize_stack(stackSize), [this, nI, &f] {
+                f();
+                auto l = lock();
+                this->set_required(nI, -1); // completed input no longer waited for
+                this->process_ready();
+            });
+        }
+        for(auto& f: fs) f.join();
+        tasks.clear();
+        this->signal(DATASTREAM_FLUSH);
+    }
+
+    /// number of fiber suspensions for inputs running ahead
+    size_t n_yields() const { return nYields; }
+
+    size_t maxAhead = 4096;         ///< items queued from one input before yielding while others are waiting
+    size_t chunkSize = 256;         ///< addSource read chunk size
+    size_t stackSize = 256*1024;    ///< fiber stack size
+
+protected:
+    /// lock collation against re-entry from another fiber, while one is suspended pushing downstream
+    std::unique_lock<boost::fibers::mutex> lock() { return std::unique_lock<boost::fibers::mutex>(fMut); }
+    /// suspend calling fiber while input nI is far ahead of waiting inputs
+    void throttle(size_t nI) {
+        while(this->inputs_waiting && this->input_n[nI].first > int(maxAhead)) {
+            ++nYields;
+            boost::this_fiber::yield();
+        }
+    }
+
+    vector<std::pair<size_t, std::function<void()>>> tasks; ///< fiber tasks and their inputs
+    boost::fibers::mutex fMut;      ///< collation lock between fibers
+    size_t nYields = 0;             ///< fiber suspension count
+};
+
+#endif
@@ -1,10 +1,21 @@
 /// \file JobQueue.cc
 
 #include "JobQueue.hh"
+#include "Profiler.hh"
 #include <algorithm>
 
 JobQueue::Job JobQueue::jthread::haltThread;
 
+JobQueue::~JobQueue() {
+    if(!halt) shutdown();
+    auto q = dqs.load();
+    while(q) {
+        auto qq = q->next;
+        delete q;
+        q = qq;
+    }
+}
+
 JobQueue::jthread::jthread(JobQueue& jq): JQ(jq) {
     pthread_create(&t, NULL, &jqworkthread, this);
 }
@@ -48,7 +59,10 @@ void JobQueue::jthread::doWork() {
         // run the job
         auto qn = J->qn;
         if(JQ.verbose > 1) { printf("Worker %p running job %p from queue %i\n", (void*)this, (void*)J, qn); fflush(stdout); }
-        J->run();
+        {
+            ProfileZone Z("JobQueue::Job");
+            J->run();
+        }
         if(JQ.verbose > 1) { printf("Worker %p completed job %p from queue %i\n", (void*)this, (void*)J, qn); fflush(stdout); }
 
         // decrement queue worker count
@@ -71,13 +85,20 @@ void JobQueue::jthread::doWork() {
 }
 
 void JobQueue::launch(size_t nw) {
-    if(cThrd) return; // already running
+    if(cThrd || dThrds.size()) return; // already running
     halt = false;
     nworkers = nw;
-    pthread_create(&cThrd, NULL, &jqcontrolthread, this);
+    if(direct) {
+        dThrds.resize(nw);
+        for(auto& t: dThrds) pthread_create(&t, NULL, &jqdirectthread, this);
+    } else pthread_create(&cThrd, NULL, &jqcontrolthread, this);
 }
 
 void JobQueue::setQueue(int qn, size_t max_workers, size_t backlog) {
+    if(direct) {
+        getDQ(qn, max_workers, backlog)->max_workers = max_workers; // backlog fixed once created
+        return;
+    }
     std::unique_lock<std::mutex> lk(jqsLock);
     auto& q = jqs[qn];
     q.max_workers = max_workers;
@@ -86,6 +107,11 @@ void JobQueue::setQueue(int qn, size_t max_workers, size_t backlog) {
 
 void JobQueue::add(Job* J) {
     if(!J) return;
+    if(direct) {
+        _dadd(J);
+        wakeDirect();
+        return;
+    }
     std::unique_lock<std::mutex> lk(jqsLock);
     auto& q = jqs[J->qn];
     if(verbose > 4) printf("Adding job to queue %i (backlog %zu)\n", J->qn, q.js.size());
@@ -95,13 +121,34 @@ void JobQueue::add(Job* J) {
     v_jnew.notify_all();
 }
 
+void JobQueue::add(const vector<Job*>& vJ) {
+    if(!direct) {
+        for(auto J: vJ) add(J);
+        return;
+    }
+    for(auto J: vJ) if(J) _dadd(J);
+    wakeDirect(true);
+}
+
 void JobQueue::flush() {
     if(verbose) { printf("Flushing "); display(); }
+    if(direct) {
+        std::unique_lock<std::mutex> lk(jqsLock);
+        while(dpending.load()) v_jdone.wait_for(lk, waitPolicy.park_time());
+        return;
+    }
     std::unique_lock<std::mutex> lk(idleLock);
     wready.wait(lk, [&]{return !nwaiting && j_idle.size() == nworkers;});
 }
 
 void JobQueue::display() {
+    if(direct) {
+        printf("JobQueue (direct dispatch) with %zu pending jobs, %zu workers:\n", dpending.load(), nworkers);
+        for(auto q = dqs.load(); q; q = q->next)
+            printf("\tQueue %i: running %zu/%zu workers, backlog %zu/%zu.\n",
+                   q->qn, q->n_workers.load(), q->max_workers.load(), q->js.n_buffered(), q->js.capacity());
+        return;
+    }
     std::unique_lock<std::mutex> lk(jqsLock);
     printf("JobQueue with %zu pending jobs, %zu/%zu idle workers:\n",
            nwaiting, j_idle.size(), nworkers);
@@ -116,6 +163,17 @@ void JobQueue::shutdown() {
     if(halt) return;
 
     flush();
+    if(direct) {
+        if(verbose) printf("Shutting down direct-dispatch worker threads.\n");
+        {
+            std::lock_guard<std::mutex> lk(parkLock);
+            halt = true;
+            parkReady.notify_all();
+        }
+        for(auto t: dThrds) pthread_join(t, nullptr);
+        dThrds.clear();
+        return;
+    }
     if(verbose) printf("Shutting shown controller thread.\n");
     halt = true;
     v_jnew.notify_all();
@@ -184,3 +242,100 @@ void JobQueue::runController() {
     for(auto j: vjall) delete j;
     j_idle.clear();
 }
+
+//////////////////////////
+// direct dispatch mode //
+//////////////////////////
+
+JobQueue::dqueue* JobQueue::getDQ(int qn, size_t max_workers, size_t backlog) {
+    dqueue* q0 = dqs.load(std::memory_order_acquire);
+    dqueue* qnew = nullptr;
+    while(true) {
+        for(auto q = q0; q; q = q->next) {
+            if(q->qn != qn) continue;
+            delete qnew;
+            return q;
+        }
+        if(!qnew) qnew = new dqueue(qn, max_workers, backlog);
+        qnew->next = q0;
+        if(dqs.compare_exchange_weak(q0, qnew, std::memory_order_acq_rel)) return qnew;
+    }
+}
+
+void JobQueue::_dadd(Job* J) {
+    auto q = getDQ(J->qn);
+    if(verbose > 4) printf("Adding job to direct queue %i (backlog %zu)\n", J->qn, q->js.n_buffered());
+    ++dpending;
+    unsigned int nwait = 0;
+    while(!q->js.try_push(J)) {
+        // help run jobs while full (so jobs adding more jobs cannot deadlock workers)
+        if(runPending()) { nwait = 0; continue; }
+        if(waitPolicy.idle(++nwait)) usleep(int(1e6*waitPolicy.park_s));
+    }
+}
+
+bool JobQueue::runPending() {
+    dqueue* qbest = nullptr;
+    size_t nbest = 0;
+    for(auto q = dqs.load(std::memory_order_acquire); q; q = q->next) {
+        if(q->n_workers.load() >= q->max_workers.load()) continue;
+        auto n = q->js.n_buffered();
+        if(n > nbest) { qbest = q; nbest = n; }
+    }
+    if(!qbest) return false;
+
+    // claim worker slot on queue
+    if(++qbest->n_workers > qbest->max_workers.load()) {
+        --qbest->n_workers;
+        return false;
+    }
+
+    size_t nrun = 0;
+    Job* J = nullptr;
+    while(nrun < batch && qbest->js.try_pop(J)) {
+        if(verbose > 1) { printf("Direct worker running job %p from queue %i\n", (void*)J, qbest->qn); fflush(stdout); }
+        {
+            ProfileZone Z("JobQueue::Job");
+            J->run();
+        }
+        ++nrun;
+        if(!--dpending) {
+            std::lock_guard<std::mutex> lk(jqsLock);
+            v_jdone.notify_all();
+        }
+    }
+    --qbest->n_workers;
+    return nrun;
+}
+
+void JobQueue::wakeDirect(bool all) {
+    std::atomic_thread_fence(std::memory_order_seq_cst); // publish jobs before checking parked
+    if(nparked.load()) {
+        std::lock_guard<std::mutex> lk(parkLock);
+        if(all) parkReady.notify_all();
+        else parkReady.notify_one();
+    }
+}
+
+void* JobQueue::jqdirectthread(void* vJQ) {
+    reinterpret_cast<JobQueue*>(vJQ)->runDirect();
+    return nullptr;
+}
+
+void JobQueue::runDirect() {
+    if(verbose) printf("Starting direct-dispatch worker thread.\n");
+    unsigned int nidle = 0;
+    while(!halt) {
+        if(runPending()) { nidle = 0; continue; }
+        if(!waitPolicy.idle(++nidle)) continue;
+
+        std::unique_lock<std::mutex> lk(parkLock);
+        ++nparked;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ready = halt;
+        for(auto q = dqs.load(); q && !ready; q = q->next) ready = !q->js.empty() && q->n_workers.load() < q->max_workers.load();
+        if(!ready) parkReady.wait_for(lk, waitPolicy.park_time());
+        --nparked;
+    }
+    if(verbose) printf("Stopping direct-dispatch worker thread.\n");
+}
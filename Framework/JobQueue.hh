@@ -15,12 +15,18 @@ using std::map;
 #include <stdio.h>
 #include <boost/core/noncopyable.hpp>
 #include <cassert>
+#include <atomic>
+#include "LocklessCircleBuffer.hh"
 
 /// Parallel-processing pipeline management
+/// default mode: controller thread dispatches jobs to workers;
+/// direct mode: workers pull jobs from lock-free per-queue buffers, without controller
 class JobQueue: private boost::noncopyable {
 public:
+    /// Constructor, optionally in direct-dispatch mode
+    explicit JobQueue(bool directmode = false): direct(directmode) { }
     /// Destructor
-    virtual ~JobQueue() { assert(!halt); }
+    virtual ~JobQueue();
 
     /// Base class defining a job to run
     class Job {
@@ -38,6 +44,8 @@ public:
     void setQueue(int qn, size_t max_workers, size_t backlog = 10000);
     /// add a job, waiting as needed until queue is down to 'backlog' entries
     void add(Job* J);
+    /// add batch of jobs
+    void add(const vector<Job*>& vJ);
     /// launch controller thread to start job processing on specified number of workers
     void launch(size_t nw);
     /// wait until all queues are empty
@@ -48,6 +56,9 @@ public:
     void display();
 
     int verbose = 0;    ///< debugging verbosity
+    size_t batch = 16;  ///< direct mode: maximum jobs run by worker per queue slot claimed
+
+    const bool direct;  ///< whether in direct-dispatch mode
 
 protected:
 
@@ -104,7 +115,38 @@ protected:
     std::condition_variable v_jnew;     ///< wait for new available job
     std::condition_variable v_jdone;    ///< wait for new available job
 
-    bool halt = true;                   ///< signal for threads to halt
+    std::atomic<bool> halt{true};       ///< signal for threads to halt
+
+    /// direct-mode lock-free queue for a particular kind of job
+    struct dqueue {
+        /// Constructor
+        dqueue(int n, size_t mw, size_t bl): qn(n), max_workers(mw), js(bl) { }
+        int qn;                                 ///< queue category identifier
+        std::atomic<size_t> max_workers;        ///< max. parallel jobs
+        std::atomic<size_t> n_workers{0};       ///< current number of running jobs
+        MPMCRing<Job*> js;                      ///< bounded (backlog) FIFO of jobs
+        dqueue* next = nullptr;                 ///< next in list of queues
+    };
+    std::atomic<dqueue*> dqs{nullptr};  ///< direct-mode queues list (insert-only until destruction)
+    /// find or create direct-mode queue
+    dqueue* getDQ(int qn, size_t max_workers = 1000, size_t backlog = 10000);
+    /// direct-mode add with waiting for space, without notifying workers
+    void _dadd(Job* J);
+    /// claim and run up to 'batch' jobs from fullest available queue; return whether any were run
+    bool runPending();
+    /// wake parked direct-mode worker(s) if any
+    void wakeDirect(bool all = false);
+    /// direct-mode worker thread
+    static void* jqdirectthread(void* vJQ);
+    /// direct-mode worker operation
+    void runDirect();
+
+    vector<pthread_t> dThrds;           ///< direct-mode worker threads
+    std::atomic<size_t> dpending{0};    ///< direct-mode queued plus running jobs
+    std::atomic<int> nparked{0};        ///< number of parked direct-mode workers
+    std::mutex parkLock;                ///< direct-mode worker parking lock
+    std::condition_variable parkReady;  ///< direct-mode worker wake-up notifier
+    SpinParkPolicy waitPolicy;          ///< direct-mode idle worker and full-queue waiting policy
 };
 
 #endif
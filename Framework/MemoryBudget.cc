@@ -0,0 +1,54 @@
+/// \file MemoryBudget.cc
+
+#include "MemoryBudget.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include <chrono>
+#include <thread>
+
+MemoryBudget& MemoryBudget::global() {
+    static MemoryBudget B;
+    return B;
+}
+
+void MemoryBudget::configure(const Setting& S) {
+    double mb = highWater/double(1 << 20);
+    S.lookupValue("mem_budget_MB", mb);
+    optionalGlobalArg("membudget", mb, "buffered data high-water mark [MB] for producer backpressure");
+    highWater = mb*(1 << 20);
+}
+
+bool MemoryBudget::_throttle() {
+    typedef std::chrono::steady_clock clk_t;
+    auto t0 = clk_t::now();
+    auto tprog = t0;
+    auto last = inFlight();
+    ++nThrottled;
+
+    while(inFlight() > lowFraction*highWater) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        auto n = inFlight();
+        auto t = clk_t::now();
+        if(n < last) {
+            last = n;
+            tprog = t;
+        } else if(std::chrono::duration<double>(t - tprog).count() > stall_s) {
+            if(!nStalled++) printf("Warning: buffered data (%lli bytes) above memory budget is not draining; continuing.\n", n);
+            break;
+        }
+    }
+
+    t_wait_us += std::chrono::duration_cast<std::chrono::microseconds>(clk_t::now() - t0).count();
+    return true;
+}
+
+void MemoryBudget::addXML(XMLTag& X, const string& tagname) const {
+    auto M = X.addChild(new XMLTag(tagname));
+    if(highWater) M->addAttr("high_water", highWater);
+    M->addAttr("peak", peakInFlight());
+    if(nThrottled) {
+        M->addAttr("throttled", nThrottled.load());
+        M->addAttr("t_wait_s", 1e-6*t_wait_us.load());
+    }
+    if(nStalled) M->addAttr("stalled", nStalled.load());
+}
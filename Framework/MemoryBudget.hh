@@ -0,0 +1,103 @@
+/// \file MemoryBudget.hh Chain-wide accounting of buffered item memory, with producer backpressure
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef MEMORYBUDGET_HH
+#define MEMORYBUDGET_HH
+
+#include "MemTag.hh"
+#include <atomic>
+#include <cstdlib> // for std::llabs
+
+namespace libconfig { class Setting; }
+
+/// Process-wide total of bytes buffered in chain stages; producers throttle() above high-water mark
+class MemoryBudget {
+public:
+    /// global instance
+    static MemoryBudget& global();
+
+    /// configure high-water mark from Setting "mem_budget_MB" or --membudget [MB]
+    void configure(const libconfig::Setting& S);
+
+    /// account change in buffered bytes
+    void add(long long db) {
+        auto n = inflight.fetch_add(db, std::memory_order_relaxed) + db;
+        auto p = peak.load(std::memory_order_relaxed);
+        while(n > p && !peak.compare_exchange_weak(p, n, std::memory_order_relaxed)) { }
+    }
+    /// current buffered bytes
+    long long inFlight() const { return inflight.load(std::memory_order_relaxed); }
+    /// peak buffered bytes
+    long long peakInFlight() const { return peak.load(std::memory_order_relaxed); }
+    /// whether limit is set and exceeded
+    bool over() const { return highWater > 0 && inFlight() > highWater; }
+
+    /// (producer) if over() high-water mark, block until below low-water mark, or no progress in stall_s; return whether blocked
+    bool throttle() { return over() && _throttle(); }
+
+    /// add summary to XML output as child tag
+    void addXML(XMLTag& X, const string& tagname = "memory_budget") const;
+
+    long long highWater = 0;    ///< producer blocking threshold [bytes] (0 for unlimited)
+    double lowFraction = 0.8;   ///< resume below this fraction of highWater
+    double stall_s = 1.;        ///< give up waiting after no drain progress for this long (e.g. single-threaded chain)
+
+protected:
+    /// blocking wait for throttle()
+    bool _throttle();
+
+    std::atomic<long long> inflight{0}; ///< currently buffered bytes
+    std::atomic<long long> peak{0};     ///< peak buffered bytes
+    std::atomic<size_t> nThrottled{0};  ///< number of producer throttle waits
+    std::atomic<size_t> nStalled{0};    ///< number of waits abandoned without progress
+    std::atomic<long long> t_wait_us{0};///< total throttled wait time [us]
+};
+
+/// One stage's buffered bytes, reported to MemoryBudget and/or subsystem MemTag in grain-sized steps (thread-safe)
+class MemAccount {
+public:
+    /// Constructor
+    explicit MemAccount(MemoryBudget& b = MemoryBudget::global()): B(&b) { }
+    /// Constructor, also accounting to named subsystem MemTag; b = nullptr for tag-only accounting, outside the backpressure budget
+    explicit MemAccount(const string& t, MemoryBudget* b = &MemoryBudget::global()): B(b), tag(&MemTag::get(t)) { }
+    /// Destructor, releasing remaining reported bytes
+    ~MemAccount() { report(-(bytes.load() - pend.load())); }
+
+    /// update stage's current buffered bytes
+    void set(long long b) {
+        auto d = b - bytes.exchange(b, std::memory_order_relaxed);
+        if(!d) return;
+        if(d > 0) {
+            auto p = pk.load(std::memory_order_relaxed);
+            while(b > p && !pk.compare_exchange_weak(p, b, std::memory_order_relaxed)) { }
+        }
+        if(std::llabs(pend.fetch_add(d, std::memory_order_relaxed) + d) >= grain) report(pend.exchange(0, std::memory_order_relaxed));
+    }
+    /// update for n buffered items of type T
+    template<typename T>
+    void set_items(size_t n) { set(n*sizeof(T)); }
+
+    /// current buffered bytes
+    long long current() const { return bytes.load(std::memory_order_relaxed); }
+    /// peak buffered bytes
+    long long peak() const { return pk.load(std::memory_order_relaxed); }
+    /// add peak to XML attributes
+    void addXML(XMLTag& X, const string& attrname = "mem_peak") const { X.addAttr(attrname, peak()); }
+
+    long long grain = 1 << 16;  ///< minimum change reported to budget and tag [bytes]
+
+protected:
+    /// report change to budget and tag
+    void report(long long d) {
+        if(B) B->add(d);
+        if(tag) tag->add(d);
+    }
+
+    MemoryBudget* B;                    ///< budget reported to (if not nullptr)
+    MemTag* tag = nullptr;              ///< subsystem tag reported to (if not nullptr)
+    std::atomic<long long> bytes{0};    ///< current buffered bytes
+    std::atomic<long long> pend{0};     ///< change not yet reported to budget and tag
+    std::atomic<long long> pk{0};       ///< peak buffered bytes
+};
+
+#endif
@@ -14,11 +14,13 @@ using std::string;
 using std::vector;
 #include <algorithm>
 #include <stdexcept>
+#include <stdint.h>
 
 /*
  * _ObjectFactory: base polymorphic pointer for storing factories
  * _ArgsFactory: base for any factory with particular arguments structure
  * _ArgsBaseFactory: _ArgsFactory for a particular base class
+ * FlatIDTable: open-addressing lookup table by (hashed) identifier
  * FactoriesIndex: static cass storing factories; able to construct object given <factory index>,args...
  * BaseFactory<B>: static class to access construction of base types B
  *
@@ -33,6 +35,66 @@ struct _args_t { };
 template<typename... T>
 constexpr size_t typehash() { return typeid(_args_t<T...>).hash_code(); }
 
+/// Open-addressing hash table from nonzero identifiers (e.g. FactoriesIndex::hash class IDs) to non-null pointers;
+/// built once (at registration), then O(1) lookup without string comparisons. Iterates in insertion order.
+template<typename P>
+class FlatIDTable {
+public:
+    /// entry type
+    typedef std::pair<size_t, P> value_type;
+
+    /// insert p for id, unless id already present; return whether inserted
+    bool emplace(size_t id, P p) {
+        if(find(id)) return false;
+        if(2*(items.size() + 1) > slots.size()) rehash(std::max<size_t>(16, 2*slots.size()));
+        items.emplace_back(id, p);
+        place(items.size() - 1);
+        return true;
+    }
+    /// look up entry for id; nullptr if absent
+    P find(size_t id) const {
+        if(!slots.size()) return nullptr;
+        for(size_t i = slot0(id); ; i = (i + 1) & mask()) {
+            auto j = slots[i];
+            if(!j) return nullptr;
+            if(items[j-1].first == id) return items[j-1].second;
+        }
+    }
+    /// look up entry for id; throw std::out_of_range if absent
+    P at(size_t id) const {
+        auto p = find(id);
+        if(!p) throw std::out_of_range("Unknown identifier " + std::to_string(id));
+        return p;
+    }
+
+    /// number of entries
+    size_t size() const { return items.size(); }
+    /// start of entries
+    typename vector<value_type>::const_iterator begin() const { return items.begin(); }
+    /// end of entries
+    typename vector<value_type>::const_iterator end() const { return items.end(); }
+
+protected:
+    vector<value_type> items;   ///< entries in insertion order
+    vector<uint32_t> slots;     ///< items index + 1 by hash slot; 0 for empty
+
+    /// slot index mask
+    size_t mask() const { return slots.size() - 1; }
+    /// initial probe slot for id
+    size_t slot0(size_t id) const { return (id ^ (id >> 29)) & mask(); }
+    /// place item j in first free slot
+    void place(size_t j) {
+        size_t i = slot0(items[j].first);
+        while(slots[i]) i = (i + 1) & mask();
+        slots[i] = j + 1;
+    }
+    /// rebuild with n (power of 2) slots
+    void rehash(size_t n) {
+        slots.assign(n, 0);
+        for(size_t j = 0; j < items.size(); ++j) place(j);
+    }
+};
+
 /// Inheritance base for factories; Singleton derived-class instances provide class metadata.
 class _ObjectFactory {
 public:
@@ -64,44 +126,65 @@ public:
     virtual base* construct(Args&&... a) const  = 0;
 };
 
+/// factories lookup table, by class name hash
+typedef FlatIDTable<_ObjectFactory*> factory_table_t;
+
 /// (static class) collection of factories, indexed by string name and unique identifier
 class FactoriesIndex {
 public:
     /// access map of factories by index = typehash<base, args> -> namehash : factory
-    static map<size_t, map<size_t, _ObjectFactory&>>& index();
+    static map<size_t, factory_table_t>& index();
 
-    /// index for particular construction
+    /// index for particular construction (located once per construction signature)
     template<typename... BArgs>
-    static map<size_t, _ObjectFactory&>& indexFor() { return index()[typehash<BArgs...>()]; }
+    static factory_table_t& indexFor() {
+        static factory_table_t& I = index()[typehash<BArgs...>()];
+        return I;
+    }
 
     /// sorted names for particular construction
     template<typename... BArgs>
     static vector<string> namesFor() {
         vector<string> v;
-        for(auto& kv: indexFor<BArgs...>()) v.push_back(kv.second.classname);
+        for(auto& kv: indexFor<BArgs...>()) v.push_back(kv.second->classname);
         std::sort(v.begin(), v.end());
         return v;
     }
 
-    /// hash string
-    static size_t hash(const string& s) { return std::hash<string>{}(s); }
+    /// class name hash (64-bit FNV-1a) of n characters, compile-time evaluable; never 0 (reserved for "no class")
+    static constexpr size_t hash(const char* s, size_t n) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for(size_t i = 0; i < n; ++i) h = (h ^ (unsigned char)s[i]) * 0x100000001b3ULL;
+        return h? h : 1;
+    }
+    /// class name hash of null-terminated string, compile-time evaluable
+    static constexpr size_t hash(const char* s) {
+        size_t n = 0;
+        while(s[n]) ++n;
+        return hash(s, n);
+    }
+    /// class name hash of string
+    static size_t hash(const string& s) { return hash(s.data(), s.size()); }
 
     /// show debugging list of registered classes
     static void display() {
         for(auto& kv: index()) {
             printf("--- %zu ---\n", kv.first);
-            for(auto& kv2: kv.second) printf("%zu:\t'%s'\n", kv2.first, kv2.second.classname.c_str());
+            for(auto& kv2: kv.second) printf("%zu:\t'%s'\n", kv2.first, kv2.second->classname.c_str());
         }
     }
 };
 
+/// compile-time class identifier for registered class NAME, equal to FactoriesIndex::hash("NAME")
+#define CLASS_ID(NAME) (std::integral_constant<size_t, FactoriesIndex::hash(#NAME)>::value)
+
 /// Concrete factory for a particular object type constructed with arguments
 template<class B, class C, typename... Args>
 class ObjectFactory: public _ArgsBaseFactory<B, Args...> {
 public:
     /// Constructor, registering to list
     explicit ObjectFactory(const string& cname): _ArgsBaseFactory<B, Args...>(cname) {
-        FactoriesIndex::indexFor<B, Args...>().emplace(FactoriesIndex::hash(cname), *this);
+        FactoriesIndex::indexFor<B, Args...>().emplace(FactoriesIndex::hash(cname), this);
     }
     /// Produce an object from arguments
     B* construct(Args&&... a) const override { return new C(std::forward<Args>(a)...); }
@@ -130,14 +213,14 @@ public:
     /// construct indexed class with arguments --- fails on unregistered index
     template<typename... Args>
     static base* construct(size_t i, Args&&... a) {
-        return dynamic_cast<_ArgsBaseFactory<B, Args...>&>(indexFor<B, Args...>().at(i)).construct(std::forward<Args>(a)...);
+        return dynamic_cast<_ArgsBaseFactory<B, Args...>&>(*indexFor<B, Args...>().at(i)).construct(std::forward<Args>(a)...);
     }
 
     /// show available options for construction
     template<typename... Args>
     static void displayConstructionOpts() {
         vector<string> vnames;
-        for(auto& kv: indexFor<B, Args...>()) vnames.push_back(kv.second.classname);
+        for(auto& kv: indexFor<B, Args...>()) vnames.push_back(kv.second->classname);
         std::sort(vnames.begin(), vnames.end());
         for(auto& n: vnames) printf("\t* %s\n", n.c_str());
     }
@@ -152,9 +235,8 @@ public:
     /// construct named-class object with arguments; return nullptr if unavailable
     template<typename... Args>
     static base* try_construct(const string& classname, Args&&... a) {
-        auto& mi = indexFor<B, Args...>();
-        auto it = mi.find(hash(classname));
-        return it == mi.end()?  nullptr : dynamic_cast<_ArgsBaseFactory<B, Args...>&>(it->second).construct(std::forward<Args>(a)...);
+        auto f = indexFor<B, Args...>().find(hash(classname));
+        return f? dynamic_cast<_ArgsBaseFactory<B, Args...>&>(*f).construct(std::forward<Args>(a)...) : nullptr;
     }
 
     /// construct named-class object with arguments; throw with error message if unavailable
@@ -172,5 +254,7 @@ public:
 
 /// Compile-time registration of dynamically-constructable objects, default constructors
 #define REGISTER_FACTORYOBJECT(NAME,BASE) static const ObjectFactory<BASE,NAME> the_##BASE##_##NAME##_Factory(#NAME);
+/// Registration as above, allocating objects through ThreadCachePool (requires ThreadCacheAlloc.hh)
+#define REGISTER_FACTORYOBJECT_CACHED(NAME,BASE) static const ObjectFactory<BASE,ThreadCached<NAME>> the_##BASE##_##NAME##_Factory(#NAME);
 
 #endif
@@ -6,6 +6,9 @@
 
 #include "DataSink.hh"
 #include "SFINAEFuncs.hh" // for dispObj
+#include "RingBuffer.hh"
+#include "StageProfile.hh"
+#include "Checkpoint.hh"
 
 #include <cmath>        // for std::fabs
 #include <type_traits>  // for std::remove_pointer
@@ -30,15 +33,17 @@ public:
 
 /// Flow-through analysis on a ``window'' of ordered objects
 /// input is always const T; inspection functions depend on const-ness of T
-template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
-class OrderedWindow: protected deque<typename std::remove_const<T>::type>, public DataSink<const T> {
+/// storage container may be deque (default) or contiguous RingBuffer (see RingOrderedWindow)
+template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t,
+         class _container_t = deque<typename std::remove_const<T>::type>>
+class OrderedWindow: protected _container_t, public DataSink<const T>, public Checkpointable {
 public:
     /// internal mutable type
     typedef typename std::remove_const<T>::type Tmut_t;
     /// ordering type
     typedef _ordering_t ordering_t;
     /// internal queue type
-    typedef deque<Tmut_t> deque_t;
+    typedef _container_t deque_t;
     /// iterator type
     typedef typename deque_t::iterator iterator;
     /// iterator range
@@ -71,6 +76,7 @@ public:
 
     /// clear remaining objects through window (at end of run, etc.)
     void signal(datastream_signal_t sig) override {
+        if(sig == DATASTREAM_CHECKPT) this->checkpoint();
         if(sig < DATASTREAM_FLUSH) return;
         if(size()) {
             window_Hi = order(back());
@@ -78,6 +84,23 @@ public:
         }
         while(size()) nextmid();
     }
+    /// serialize window contents and position; extend in subclasses to include analysis state
+    void saveState(BinaryWriter& W) override {
+        W.send(window_Lo);
+        W.send(window_Hi);
+        W.send(nProcessed);
+        W.send(imid);
+        ckpt_save_items(W, begin(), end());
+    }
+    /// restore window contents and position (without re-processing items)
+    void loadState(BinaryReader& R) override {
+        R.receive(window_Lo);
+        R.receive(window_Hi);
+        R.receive(nProcessed);
+        R.receive(imid);
+        ckpt_load_items<Tmut_t>(R, [this](Tmut_t&& o) { deque_t::push_back(std::move(o)); });
+    }
+
     /// Flush as if inserting new highest at x
     void flushHi(ordering_t x) {
         window_Hi = x;
@@ -180,7 +203,24 @@ public:
     size_t abs_count(ordering_t dx0, ordering_t dx1) const { return abs_range(dx0,dx1).size(); }
 
     /// add next newer object; process older as they pass through window.
-    void push(const T& o) override {
+    void push(const T& o) override { copies.copied(); _push(o); }
+    /// move in next newer object; process older as they pass through window.
+    void push_move(Tmut_t&& o) override { copies.moved(); _push(std::move(o)); }
+
+    /// add batch of newer objects, without per-item virtual dispatch
+    void push_batch(const T* o, size_t n) override { copies.copied(n); while(n--) _push(*o++); }
+    /// move in batch of newer objects, without per-item virtual dispatch
+    void push_move_batch(Tmut_t* o, size_t n) override { copies.moved(n); while(n--) _push(std::move(*o++)); }
+    using DataSink<const T>::push_batch;
+
+    ordering_t window_Lo = {};  ///< newest discarded (start of available range)
+    ordering_t window_Hi = {};  ///< newest added/flushed (end of available range)
+    SinkCopyCounter copies;     ///< input copy/move counting
+
+protected:
+    /// add (copy or move) next newer object
+    template<typename U>
+    void _push(U&& o) {
         if(verbose >= 4) { printf("Adding new "); display(o); }
 
         auto x = order(o);
@@ -192,18 +232,13 @@ public:
         } else {
             if(!hwidth) while(size()) nextmid();
             else flushHi(x);
-            deque_t::push_back(o);
+            deque_t::push_back(std::forward<U>(o));
             processNew(back());
         }
 
         ++nProcessed;
     }
 
-    ordering_t window_Lo = {};  ///< newest discarded (start of available range)
-    ordering_t window_Hi = {};  ///< newest added/flushed (end of available range)
-
-protected:
-
     ordering_t hwidth;  ///< half-length of analysis window kept around "mid" object
 
     using deque_t::begin;
@@ -248,4 +283,8 @@ protected:
     }
 };
 
+/// OrderedWindow with contiguous ring-buffer storage
+template<class T, typename ordering_t = typename std::remove_pointer<T>::type::ordering_t>
+using RingOrderedWindow = OrderedWindow<T, ordering_t, RingBuffer<typename std::remove_const<T>::type>>;
+
 #endif
@@ -6,6 +6,10 @@
 
 #include "DataSink.hh"
 #include "SFINAEFuncs.hh" // for dispObj
+#include "BucketQueue.hh"
+#include "StageProfile.hh"
+#include "Checkpoint.hh"
+#include "MemoryBudget.hh"
 
 #include <vector>
 using std::vector;
@@ -19,8 +23,9 @@ using std::priority_queue;
 #include <type_traits>  // for std::remove_pointer
 
 /// Sort slightly-out-of-order items into proper order
+/// default binary heap queue; optional setBuckets(w) for O(1) bucketed "calendar" queue when dt is small and known
 template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
-class OrderingQueue: public DataLink<const T, T> {
+class OrderingQueue: public DataLink<const T, T>, public Checkpointable {
 public:
     /// input type
     using typename DataSink<const T>::sink_t;
@@ -32,6 +37,8 @@ public:
     using typename DataSink<sink_t>::mutsink_t;
     /// queue type
     typedef priority_queue<mutsink_t, vector<mutsink_t>, reverse_ordering_deref<mutsink_t, ordering_t>> PQ_t;
+    /// bucketed queue type
+    typedef BucketQueue<mutsink_t, ordering_t> BQ_t;
 
     static constexpr ordering_t order_max = std::numeric_limits<ordering_t>::max();
 
@@ -39,52 +46,100 @@ public:
     explicit OrderingQueue(DataSink<T>* S = nullptr, ordering_t _dt = order_max): dt(_dt) { this->nextSink = S; }
     /// Destructor --- please leave cleared!
     ~OrderingQueue() {
-        if(!PQ.empty()) {
-            fprintf(stderr, "\n*** WARNING:  OrderingQueue destructed with %zu elements remaining:\n", PQ.size());
-            while(!PQ.empty()) {
-                dispObj(PQ.top());
-                PQ.pop();
+        if(size()) {
+            fprintf(stderr, "\n*** WARNING:  OrderingQueue destructed with %zu elements remaining:\n", size());
+            while(size()) {
+                dispObj(q_top());
+                q_pop();
             }
             std::raise(SIGINT);
         }
     }
 
     /// number of items in queue
-    size_t size() const { return PQ.size(); }
+    size_t size() const { return useBuckets? BQ.size() : PQ.size(); }
+
+    /// switch to bucketed queue with bucket width w (~dt or smaller), or back to heap queue for w = 0; only when empty
+    void setBuckets(ordering_t w, size_t nb = 1024) {
+        if(size()) throw std::logic_error("OrderingQueue engine changed with items in queue");
+        useBuckets = w > 0;
+        if(useBuckets) BQ.setup(w, nb);
+    }
+    /// get bucket width (0 for heap queue)
+    ordering_t bucketWidth() const { return useBuckets? BQ.bucket_width() : 0; }
 
     /// get ordering parameter of object
     template<typename U>
-    static inline ordering_t order(U o) { return ordering_t(deref_if_ptr(o)); }
+    static inline ordering_t order(const U& o) { return ordering_t(deref_if_ptr(o)); }
 
     /// clear remaining objects through window
     void signal(datastream_signal_t sig) override {
         if(sig >= DATASTREAM_FLUSH) {
-            while(!PQ.empty()) {
-                auto o = PQ.top();
+            while(size()) {
+                auto& o = q_top();
                 processOrdered(o);
-                PQ.pop();
+                q_pop();
             }
             t0 = -order_max;
         }
+        flushOutput();
+        if(sig == DATASTREAM_CHECKPT) this->checkpoint();
         if(this->nextSink) this->nextSink->signal(sig);
     }
 
-    /// flush events up to specified point
+    /// serialize queue contents
+    void saveState(BinaryWriter& W) override {
+        W.send(t0);
+        vector<mutsink_t> v;
+        while(size()) { v.push_back(std::move(q_top())); q_pop(); }
+        for(auto& o: v) { if(useBuckets) BQ.push(o); else PQ.push(o); }
+        ckpt_save_items(W, v.begin(), v.end());
+    }
+    /// restore queue contents
+    void loadState(BinaryReader& R) override {
+        R.receive(t0);
+        ckpt_load_items<mutsink_t>(R, [this](mutsink_t&& o) { if(useBuckets) BQ.push(std::move(o)); else PQ.push(std::move(o)); });
+    }
+
+    /// flush events up to specified point (flush boundary never moves backward)
     void flushTo(ordering_t t) {
-        t0 = t;
-        while(!PQ.empty()) {
-            auto o = PQ.top();
+        if(t > t0) t0 = t;
+        while(size()) {
+            auto& o = q_top();
             if(order(o) >= t0) break;
-            PQ.pop();
             processOrdered(o);
+            q_pop();
         }
+        flushOutput();
     }
 
     /// add new item to sorted queue, with auto-flush
-    void push(sink_t& o) override { push(o, true); }
+    void push(sink_t& o) override { copies.copied(); push(o, true); }
+    /// move new item into sorted queue, with auto-flush
+    void push_move(mutsink_t&& o) override { copies.moved(); _push(std::move(o), true); }
+
+    /// add batch of items to sorted queue, with single flush after last
+    void push_batch(sink_t* o, size_t n) override { copies.copied(n); _push_batch(o, n); }
+    /// move batch of items into sorted queue, with single flush after last
+    void push_move_batch(mutsink_t* o, size_t n) override { copies.moved(n); _push_batch(std::make_move_iterator(o), n); }
+    using DataLink<const T, T>::push_batch;
 
     /// add new item to sorted queue; optionally flush
-    void push(sink_t& o, bool doFlush) {
+    void push(sink_t& o, bool doFlush) { _push(o, doFlush); }
+
+    ordering_t t0 = -order_max; ///< flush boundary
+    ordering_t dt;              ///< flush ordered queue more than this far before highest item
+    int warn_ndis = 1;          ///< frequency to print disordered-event warning
+    int ndis = 1;               ///< number disordered since last warning
+    bool skip_disordered = true;///< skip over disordered events
+    default_stage_profile_t qprof;  ///< queue depth instrumentation
+    SinkCopyCounter copies;         ///< input copy/move counting
+    MemAccount mem{"OrderingQueue"};    ///< queued bytes, reported to MemoryBudget::global() and MemTag
+
+protected:
+    /// add (copy or move) new item to sorted queue; optionally flush
+    template<typename U>
+    void _push(U&& o, bool doFlush) {
 
         ordering_t t = order(o);
 
@@ -92,8 +147,9 @@ public:
             printf("Passing through un-orderable object!\n");
             dispObj(o);
             if(skip_disordered) return;
-            output_t oo = o;
+            output_t oo = std::forward<U>(o);
             processOrdered(oo);
+            if(doFlush) flushOutput();
             return;
         }
 
@@ -107,27 +163,55 @@ public:
             }
 
             if(skip_disordered) return;
-            output_t oo = o;
+            output_t oo = std::forward<U>(o);
             processOrdered(oo);
+            if(doFlush) flushOutput();
             return;
         }
 
-        PQ.push(o);
-
-        if(doFlush) flushTo(t-dt);
+        if(useBuckets) {
+            // flush first (equivalent, since t >= t-dt) to keep bucket range small
+            if(doFlush) flushTo(t-dt);
+            BQ.push(std::forward<U>(o));
+        } else {
+            PQ.push(std::forward<U>(o));
+            if(doFlush) flushTo(t-dt);
+        }
+        qprof.depth(size());
+        mem.set_items<mutsink_t>(size());
     }
 
-    ordering_t t0 = -order_max; ///< flush boundary
-    ordering_t dt;              ///< flush ordered queue more than this far before highest item
-    int warn_ndis = 1;          ///< frequency to print disordered-event warning
-    int ndis = 1;               ///< number disordered since last warning
-    bool skip_disordered = true;///< skip over disordered events
+    /// add batch (copied, or moved with move_iterator), with single flush after last
+    template<typename It>
+    void _push_batch(It o, size_t n) {
+        if(!n) return;
+        ordering_t tmax = -order_max;
+        while(n--) {
+            ordering_t t = order(static_cast<const mutsink_t&>(*o));
+            if(std::isfinite(t) && t > tmax) tmax = t;
+            _push(*o++, false);
+        }
+        if(tmax != -order_max) flushTo(tmax-dt);
+        else flushOutput();
+    }
 
-protected:
-    PQ_t PQ;
+    PQ_t PQ;                    ///< heap-ordered queue
+    BQ_t BQ;                    ///< bucketed queue
+    bool useBuckets = false;    ///< whether to use bucketed queue
+    vector<mutsink_t> outBatch; ///< ordered output accumulated for batch push
+
+    /// pass down chain (moved into batch, sent on flushOutput); o is discarded after
+    virtual void processOrdered(output_t& o) { if(this->nextSink) outBatch.push_back(std::move(o)); }
+    /// send accumulated ordered output batch downstream
+    void flushOutput() {
+        mem.set_items<mutsink_t>(size());
+        this->nextBatch(outBatch);
+    }
 
-    /// pass down chain
-    virtual void processOrdered(output_t& o) { if(this->nextSink) this->nextSink->push(o); }
+    /// earliest item in queue
+    mutsink_t& q_top() { return useBuckets? BQ.top() : const_cast<mutsink_t&>(PQ.top()); }
+    /// remove earliest item from queue
+    void q_pop() { if(useBuckets) BQ.pop(); else PQ.pop(); }
 };
 
 #endif
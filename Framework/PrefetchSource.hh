@@ -0,0 +1,148 @@
+/// \file PrefetchSource.hh Asynchronous read-ahead adaptor for DataSource
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef PREFETCHSOURCE_HH
+#define PREFETCHSOURCE_HH
+
+#include "DataSource.hh"
+#include "Threadworker.hh"
+#include <deque>
+#include <algorithm>
+
+/// Serve DataSource contents from memory, read ahead in N-buffered chunks by background thread
+template<class C>
+class PrefetchSource: public DataSource<C>, protected Threadworker {
+public:
+    /// retrieved value type
+    typedef typename DataSource<C>::val_t val_t;
+
+    /// Constructor, wrapping (not owned) source, with chunk size and number of read-ahead chunks
+    explicit PrefetchSource(DataSource<C>& s, size_t nchunk = 1024, size_t nbuf = 2):
+    chunkSize(std::max(nchunk, size_t(1))), nBuffers(std::max(nbuf, size_t(1))), S(s) { }
+    /// Destructor
+    ~PrefetchSource() { stop(); }
+
+    /// Fill supplied item with next object; return whether item has been updated
+    bool next(val_t& o) override {
+        if(i >= cur.size() && !nextChunk(true)) return false;
+        o = std::move(cur[i++]);
+        return true;
+    }
+
+    /// Skip ahead n items: from buffered data, then directly in underlying source
+    bool skip(size_t n) override {
+        n = skipBuffered(n);
+        if(!n) return true;
+        stop(); // hold read-ahead at current position
+        n = skipBuffered(n);
+        if(!n) return true;
+        if(srcDone) return false;
+        lock_guard<mutex> l(srcMut);
+        if(!S.skip(n)) { srcDone = true; return false; }
+        return true;
+    }
+
+    /// Reset to start
+    void reset() override {
+        stop();
+        for(auto& c: full) spare.push_back(std::move(c));
+        full.clear();
+        cur.clear();
+        i = 0;
+        srcDone = false;
+        S.reset();
+    }
+
+    /// Estimate remaining data size (no loop)
+    size_t entries() override {
+        size_t e;
+        {
+            lock_guard<mutex> l(srcMut);
+            e = S.entries();
+        }
+        if(e == DataSource<C>::max_entries) return e;
+        lock_guard<mutex> l(inputMut);
+        e += cur.size() - i;
+        for(auto& c: full) e += c.size();
+        return e;
+    }
+
+    const size_t chunkSize;     ///< number of items per read-ahead chunk
+    const size_t nBuffers;      ///< maximum number of filled chunks waiting
+
+protected:
+    /// swap in next filled chunk, optionally starting or waiting for read-ahead; return whether available
+    bool nextChunk(bool wait) {
+        if(wait && !checkRunning() && !srcDone) launch_mythread();
+        unique_lock<mutex> lk(inputMut);
+        if(wait) inputReady.wait(lk, [this] { return full.size() || srcDone; });
+        if(!full.size()) return false;
+        spare.push_back(std::move(cur));
+        cur = std::move(full.front());
+        full.pop_front();
+        i = 0;
+        inputReady.notify_all();
+        return true;
+    }
+
+    /// skip up to n items in already-buffered data; return number remaining
+    size_t skipBuffered(size_t n) {
+        while(n) {
+            if(i >= cur.size() && !nextChunk(false)) break;
+            auto k = std::min(n, cur.size() - i);
+            i += k;
+            n -= k;
+        }
+        return n;
+    }
+
+    /// halt read-ahead thread, keeping filled buffers
+    void stop() {
+        if(!checkRunning()) return;
+        {
+            lock_guard<mutex> l(inputMut);
+            request_stop();
+        }
+        finish_mythread();
+    }
+
+    /// read-ahead thread: fill chunks until buffers full, end of source, or stop
+    void threadjob() override {
+        while(true) {
+            vector<val_t> c;
+            {
+                unique_lock<mutex> lk(inputMut);
+                inputReady.wait(lk, [this] { return full.size() < nBuffers || runstat == STOP_REQUESTED; });
+                if(runstat == STOP_REQUESTED) break;
+                if(spare.size()) {
+                    c = std::move(spare.back());
+                    spare.pop_back();
+                }
+            }
+
+            c.clear();
+            bool done = false;
+            {
+                lock_guard<mutex> l(srcMut);
+                val_t o;
+                while(c.size() < chunkSize && !(done = !S.next(o))) c.push_back(std::move(o));
+            }
+
+            lock_guard<mutex> lk(inputMut);
+            if(c.size()) full.push_back(std::move(c));
+            if(done) srcDone = true;
+            inputReady.notify_all();
+            if(done) break;
+        }
+    }
+
+    DataSource<C>& S;               ///< underlying source
+    mutex srcMut;                   ///< lock on underlying source access
+    vector<val_t> cur;              ///< chunk being served
+    size_t i = 0;                   ///< position in cur
+    std::deque<vector<val_t>> full; ///< filled chunks, in order
+    vector<vector<val_t>> spare;    ///< recycled chunk storage
+    bool srcDone = false;           ///< whether underlying source is exhausted
+};
+
+#endif
@@ -34,6 +34,12 @@ public:
         super_t::push(o);
         if(nextSink) nextSink->push(o);
     }
+    /// intercept and pass input batch
+    void push_batch(T* o, size_t n) override {
+        super_t::push_batch(o, n);
+        if(nextSink) nextSink->push_batch(o, n);
+    }
+    using super_t::push_batch;
 
     /// show signals
     void signal(datastream_signal_t sig) override {
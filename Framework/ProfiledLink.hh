@@ -0,0 +1,88 @@
+/// \file ProfiledLink.hh Pass-through DataSink chain link recording downstream throughput and latency
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef PROFILEDLINK_HH
+#define PROFILEDLINK_HH
+
+#include "DataSink.hh"
+#include "StageProfile.hh"
+#include "Profiler.hh"
+
+/// Pass-through link timing push/signal calls into the next sink (inclusive of everything further downstream)
+/// configure by `profile = true` in any DataSink Setting, or explicitly by class "ProfiledLink";
+/// also opens a named Profiler zone around downstream calls (inserted automatically for each stage when Profiler enabled)
+template<typename T, class P>
+class ProfiledLink: public DataLink<T,T>, public XMLProvider {
+public:
+    using DataLink<T,T>::nextSink;
+
+    /// Constructor, wrapping next sink, with Profiler zone name
+    explicit ProfiledLink(DataSink<T>* n = nullptr, const string& zname = "ProfiledLink"):
+    XMLProvider("ProfiledLink"), zone(Profiler::intern(zname)) { if(n) this->setNext(n); }
+    /// Constructor from configuration
+    explicit ProfiledLink(const Setting& S): ProfiledLink() {
+        string zname;
+        if(S.lookupValue("zone", zname)) zone = Profiler::intern(zname);
+        if(S.exists("next")) this->createOutput(S["next"]);
+    }
+
+    /// timed pass-through
+    void push(T& o) override {
+        if(!nextSink) return;
+        ProfileZone Z(zone);
+        auto t0 = prof.start();
+        nextSink->push(o);
+        prof.stop(t0);
+    }
+    /// timed batch pass-through
+    void push_batch(T* o, size_t n) override {
+        if(!nextSink || !n) return;
+        ProfileZone Z(zone);
+        auto t0 = prof.start();
+        nextSink->push_batch(o, n);
+        prof.stop(t0, n);
+    }
+    /// timed move pass-through
+    void push_move(typename DataSink<T>::mutsink_t&& o) override {
+        if(!nextSink) return;
+        ProfileZone Z(zone);
+        auto t0 = prof.start();
+        nextSink->push_move(std::move(o));
+        prof.stop(t0);
+    }
+    /// timed move batch pass-through
+    void push_move_batch(typename DataSink<T>::mutsink_t* o, size_t n) override {
+        if(!nextSink || !n) return;
+        ProfileZone Z(zone);
+        auto t0 = prof.start();
+        nextSink->push_move_batch(o, n);
+        prof.stop(t0, n);
+    }
+    /// timed group pass-through
+    void push_group(T* o, size_t n) override {
+        if(!nextSink || !n) return;
+        ProfileZone Z(zone);
+        auto t0 = prof.start();
+        nextSink->push_group(o, n);
+        prof.stop(t0, n);
+    }
+    using DataLink<T,T>::push_batch;
+
+    /// counted signal pass-through
+    void signal(datastream_signal_t s) override {
+        prof.count_signal();
+        ProfileZone Z(zone);
+        DataLink<T,T>::signal(s);
+    }
+
+    P prof;             ///< profiling data
+    const char* zone;   ///< Profiler zone name
+
+protected:
+    /// XML output
+    void _makeXML(XMLTag& X) override { prof.addXML(X); }
+    /// streamed XML output
+    void _writeXML(XMLWriter& W) override { W.attrs(xattrs); prof.writeXML(W); }
+};
+
+#endif
@@ -8,9 +8,13 @@
 #include "AnaGlobals.hh"
 #include "Exegete.hh"
 #include "TermColor.hh"
+#include "Profiler.hh"
+#include "MemTag.hh"
+#include "HugePages.hh"
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <fstream>
 
 int RunCfgCmd::main(int argc, char** argv, const char* execname) {
     _EXPLAIN("Executing analysis code");
@@ -28,6 +32,16 @@ int RunCfgCmd::main(int argc, char** argv, const char* execname) {
     }
 
     loadGlobalArgs(argc - 2, argv + 2);
+    int profile = 0;
+    optionalGlobalArg("profile", profile, "enable timing profiler zones in XML output (1), also recording trace events (2)");
+    string tracefile;
+    if(profile > 1) optionalGlobalArg("profile_trace", tracefile, "Chrome trace JSON output file for profiler events");
+    if(profile) Profiler::enable(true, profile > 1);
+    double memreport = -1;
+    optionalGlobalArg("memreport", memreport, "memory usage report in XML output: sampling period [s], or 0 for summary only");
+    string hugepages;
+    if(optionalGlobalArg("hugepages", hugepages, "large buffers page backing: [component=](none|thp|hugetlb)[:(node|local)], comma-separated"))
+        HugePagePolicy::configure(hugepages);
     pre_run();
 
     try {
@@ -47,10 +61,20 @@ int RunCfgCmd::main(int argc, char** argv, const char* execname) {
             S.lookupValue("class", AS.codename);
         }
 
+        std::unique_ptr<MemReport> MR;
+        if(memreport >= 0) MR.reset(new MemReport(memreport));
+
         printf(TERMSGR_BOLD TERMFG_YELLOW "\n-- Begin analysis --" TERMSGR_RESET "\n\n");
         A->run();
 
         AS.tryAdd(A);
+        ProfileReport PR;
+        if(profile) AS.tryAdd(&PR);
+        if(MR) AS.tryAdd(MR.get());
+        if(tracefile.size()) {
+            std::ofstream o(tracefile);
+            Profiler::writeChromeTrace(o);
+        }
         AS.make_xmlout();
 
         post_run();
@@ -0,0 +1,348 @@
+/// \file SharedOrderedWindow.hh One ordered-items window buffer shared by multiple window analyses
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SHAREDORDEREDWINDOW_HH
+#define SHAREDORDEREDWINDOW_HH
+
+#include "OrderedWindow.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
+#include <memory>
+#include <vector>
+using std::vector;
+
+template<class T, typename _ordering_t>
+class SharedOrderedWindow;
+
+/// Window analysis registered with SharedOrderedWindow: OrderedWindow cursors, range queries, and hooks over the shared buffer
+/**
+    Each handler has its own half-width, mid position, and processNew/processMid/processOld callbacks,
+    called exactly as an independent OrderedWindow of the same width would on the same stream.
+    Ranges (and end()) are limited to items the handler has received.
+*/
+template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
+class WindowHandler {
+public:
+    /// internal mutable type
+    typedef typename std::remove_const<T>::type Tmut_t;
+    /// ordering type
+    typedef _ordering_t ordering_t;
+    /// shared window type
+    typedef SharedOrderedWindow<T, ordering_t> window_t;
+    /// internal queue type
+    typedef deque<Tmut_t> deque_t;
+    /// iterator type
+    typedef typename deque_t::iterator iterator;
+    /// iterator range
+    typedef ItRange<iterator> itrange_t;
+    /// const_iterator type
+    typedef typename deque_t::const_iterator const_iterator;
+    /// const_iterator range
+    typedef ItRange<const_iterator> const_itrange_t;
+
+    friend window_t;
+
+    /// get ordering parameter for object
+    template<typename U>
+    static ordering_t order(const U& o) { return window_t::order(o); }
+
+    /// Constructor, with window half-width
+    explicit WindowHandler(ordering_t dw): hwidth(dw) { }
+    /// Polymorphic destructor
+    virtual ~WindowHandler() { }
+
+    /// get window half-width
+    ordering_t windowHalfwidth() const { return hwidth; }
+    /// number of objects in this handler's window
+    size_t size() const { return iend - ilo; }
+    /// get current middle element
+    const T& getMid() const { return at(imid); }
+    /// get ordering position of middle object
+    ordering_t xMid() const { if(!size()) return {}; return order(at(imid)); }
+
+    /// print window information
+    virtual void display() const { printf("Shared window handler of width %g containing %zu events (mid at %zu).\n", hwidth, size(), imid - ilo); }
+
+    /// get iterator to first item in window with order >= x
+    iterator abs_position(ordering_t x) { return std::lower_bound(begin(), end(), x, [](const T& a, ordering_t t) { return order(a) < t; }); }
+    /// get const_iterator to first item in window with order >= x
+    const_iterator abs_position(ordering_t x) const { return std::lower_bound(begin(), end(), x, [](const T& a, ordering_t t) { return order(a) < t; }); }
+    /// check if item is in available range
+    bool in_range(ordering_t x) const { return window_Lo < x && x < window_Hi; }
+    /// get iterator to first item in window with order >= xMid + dx
+    iterator rel_position(ordering_t dx) { return abs_position(xMid()+dx); }
+    /// get const_iterator to first item in window with order >= xMid + dx
+    const_iterator rel_position(ordering_t dx) const { return abs_position(xMid()+dx); }
+
+    /// get window position range for range offset from mid --- no bounds check
+    itrange_t _rel_range(ordering_t dx0, ordering_t dx1) { return {rel_position(dx0), rel_position(dx1)}; }
+    /// get (const) window position range for range offset from mid --- no bounds check
+    const_itrange_t _rel_range(ordering_t dx0, ordering_t dx1) const { return {rel_position(dx0), rel_position(dx1)}; }
+    /// get window position range for range offset from mid
+    itrange_t rel_range(ordering_t dx0, ordering_t dx1) { check_rel(dx0, dx1); return _rel_range(dx0,dx1); }
+    /// get (const) window position range for range offset from mid
+    const_itrange_t rel_range(ordering_t dx0, ordering_t dx1) const { check_rel(dx0, dx1); return _rel_range(dx0,dx1); }
+    /// count items in relative range
+    size_t rel_count(ordering_t dx0, ordering_t dx1) const { return rel_range(dx0,dx1).size(); }
+
+    /// get window position range for absolute range (no bounds checking)
+    itrange_t _abs_range(ordering_t x0, ordering_t x1) { return {abs_position(x0), abs_position(x1)}; }
+    /// get (const) window position range for absolute range (no bounds checking)
+    const_itrange_t _abs_range(ordering_t x0, ordering_t x1) const { return {abs_position(x0), abs_position(x1)}; }
+    /// count items in absolute range
+    size_t abs_count(ordering_t x0, ordering_t x1) const { return _abs_range(x0,x1).size(); }
+
+    /// serialize analysis state (window position is saved by SharedOrderedWindow)
+    virtual void saveState(BinaryWriter&) { }
+    /// restore analysis state
+    virtual void loadState(BinaryReader&) { }
+
+    int verbose = 0;            ///< verbose level
+    int nProcessed = 0;         ///< number of objects processed through window
+    ordering_t window_Lo = {};  ///< newest discarded (start of available range)
+    ordering_t window_Hi = {};  ///< newest added/flushed (end of available range)
+
+protected:
+    // Subclass me to do the interesting stuff!
+
+    /// processing hook for each object as it first enters window
+    virtual void processNew(T&) { }
+    /// processing hook for each object as it passes through middle of window
+    virtual void processMid(T&) { }
+    /// processing hook for objects leaving the window
+    virtual void processOld(T&) { }
+
+    /// window start
+    iterator begin() { return W->buf.begin() + (ilo - W->i0); }
+    /// window end
+    iterator end() { return W->buf.begin() + (iend - W->i0); }
+    /// window start
+    const_iterator begin() const { return W->buf.begin() + (ilo - W->i0); }
+    /// window end
+    const_iterator end() const { return W->buf.begin() + (iend - W->i0); }
+
+    /// item at stream position i
+    T& at(size_t i) { return W->buf[i - W->i0]; }
+    /// item at stream position i
+    const T& at(size_t i) const { return W->buf[i - W->i0]; }
+
+    ordering_t hwidth;          ///< half-length of analysis window kept around "mid" object
+    window_t* W = nullptr;      ///< shared window
+    size_t ilo = 0;             ///< stream position of oldest object in window
+    size_t imid = 0;            ///< stream position of "middle" object; valid if size() > 0
+    size_t iend = 0;            ///< stream position after newest object received
+
+    /// bounds check for relative range
+    void check_rel(ordering_t dx0, ordering_t dx1) const {
+        if(!size()) throw std::runtime_error("rel_range undefined on empty window");
+        if(!(dx0 <= dx1)) throw std::runtime_error("Invalid reverse-order rel_range requested");
+        if(std::fabs(dx0) > hwidth || std::fabs(dx1) > hwidth) throw std::runtime_error("rel_range larger than window requested");
+    }
+
+    /// receive next object from shared buffer, first flushing as if inserting it
+    void receive() {
+        const ordering_t x = order(at(iend));
+        if(!hwidth) while(size()) nextmid();
+        else {
+            window_Hi = x;
+            if(!size()) window_Lo = x - 2*hwidth;
+            while(size() && order(at(imid)) + hwidth <= x) nextmid();
+        }
+        ++iend;
+        processNew(at(iend - 1));
+        ++nProcessed;
+    }
+    /// clear remaining objects through window
+    void flush() {
+        if(size()) {
+            window_Hi = order(at(iend - 1));
+            window_Lo = window_Hi - 2*hwidth;
+        }
+        while(size()) nextmid();
+    }
+    /// analyze current "mid" object with processMid() and increment to next; flush if no next available
+    void nextmid() {
+        processMid(at(imid));
+        window_Lo = order(at(imid)) - hwidth;
+        ++imid;
+        if(imid < iend) while(ilo < imid && order(at(ilo)) <= window_Lo) disposeLo();
+        else while(size()) disposeLo();
+    }
+    /// remove oldest object from window
+    void disposeLo() { processOld(at(ilo++)); }
+};
+
+/// Ordered-items window with one buffer backing multiple registered WindowHandler analyses
+/**
+    Items are kept until they have left every handler's window (the widest sets buffer size),
+    replacing one identical OrderedWindow copy per analysis behind a DataSinkTee.
+    Optionally, batches are processed by each handler in parallel (handlers must not modify shared items).
+*/
+template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
+class SharedOrderedWindow: public DataSink<const T>, public Checkpointable {
+public:
+    /// internal mutable type
+    typedef typename std::remove_const<T>::type Tmut_t;
+    /// ordering type
+    typedef _ordering_t ordering_t;
+    /// handler type
+    typedef WindowHandler<T, ordering_t> handler_t;
+
+    friend handler_t;
+
+    /// get ordering parameter for object
+    template<typename U>
+    static ordering_t order(const U& o) { return ordering_t(o); }
+    /// get ordering parameter for object
+    template<typename U>
+    static ordering_t order(const U* o) { return ordering_t(*o); }
+
+    /// Destructor: must be cleared before reaching here!
+    virtual ~SharedOrderedWindow() {
+        if(buf.size()) {
+            printf("Warning: unflushed shared window of %zu objects.\n", buf.size());
+            if(enforceClear) abort();
+        }
+    }
+
+    /// register handler (not owned), receiving objects from next push
+    void addHandler(handler_t* h) {
+        if(!h || h->W) throw std::logic_error("Invalid or already-registered window handler");
+        h->W = this;
+        h->ilo = h->imid = h->iend = i0 + buf.size();
+        H.push_back(h);
+    }
+    /// registered handlers
+    const vector<handler_t*>& getHandlers() const { return H; }
+    /// number of objects in shared buffer
+    size_t size() const { return buf.size(); }
+    /// maximum number of objects held in shared buffer
+    size_t maxSize() const { return nmax; }
+
+    /// clear remaining objects through windows (at end of run, etc.)
+    void signal(datastream_signal_t sig) override {
+        if(sig == DATASTREAM_CHECKPT) this->checkpoint();
+        if(sig < DATASTREAM_FLUSH) return;
+        run_handlers([](handler_t& h) { h.flush(); });
+        trim();
+    }
+
+    /// serialize shared buffer, handler positions, and handler states (in registration order)
+    void saveState(BinaryWriter& W) override {
+        W.send(i0);
+        ckpt_save_items(W, buf.begin(), buf.end());
+        for(auto h: H) {
+            W.send(h->window_Lo);
+            W.send(h->window_Hi);
+            W.send(h->nProcessed);
+            W.send(h->ilo);
+            W.send(h->imid);
+            W.send(h->iend);
+            h->saveState(W);
+        }
+    }
+    /// restore shared buffer and handler positions and states (into same handlers configuration)
+    void loadState(BinaryReader& R) override {
+        R.receive(i0);
+        buf.clear();
+        ckpt_load_items<Tmut_t>(R, [this](Tmut_t&& o) { buf.push_back(std::move(o)); });
+        for(auto h: H) {
+            R.receive(h->window_Lo);
+            R.receive(h->window_Hi);
+            R.receive(h->nProcessed);
+            R.receive(h->ilo);
+            R.receive(h->imid);
+            R.receive(h->iend);
+            h->loadState(R);
+        }
+    }
+
+    /// add next newer object; process older as they pass through windows.
+    void push(const T& o) override { copies.copied(); _push(o); }
+    /// move in next newer object; process older as they pass through windows.
+    void push_move(Tmut_t&& o) override { copies.moved(); _push(std::move(o)); }
+    /// add batch of newer objects
+    void push_batch(const T* o, size_t n) override { copies.copied(n); _push_batch(o, n); }
+    /// move in batch of newer objects
+    void push_move_batch(Tmut_t* o, size_t n) override { copies.moved(n); _push_batch(std::make_move_iterator(o), n); }
+    using DataSink<const T>::push_batch;
+
+    int nthreads = 1;           ///< threads running handlers on each batch (0 for hardware; 1 for serial)
+    bool enforceClear = true;   ///< fail if window not clear on destruction
+    SinkCopyCounter copies;     ///< input copy/move counting
+
+protected:
+    /// handle acceptance of out-of-order items
+    virtual void processDisordered(const T& o) {
+        printf("Out-of-order shared window entry: ");
+        dispObj(o);
+        throw std::runtime_error("Disordered window event");
+    }
+
+    /// whether x is out of order for any handler's window
+    bool disordered(ordering_t x) const {
+        for(auto h: H) if(h->hwidth && h->size() && x < h->window_Lo) return true;
+        return false;
+    }
+
+    /// add (copy or move) next newer object
+    template<typename U>
+    void _push(U&& o) {
+        auto x = order(o);
+        if(!(x==x)) {
+            printf("*** NaN warning at shared window item %zu! Skipping!\n ***", i0 + buf.size());
+            dispObj(o);
+            return;
+        }
+        if(disordered(x)) { processDisordered(o); return; }
+        buf.push_back(std::forward<U>(o));
+        for(auto h: H) h->receive();
+        trim();
+    }
+
+    /// add batch, each handler processing whole batch (in parallel if nthreads != 1); disorder checked against window positions at batch start
+    template<typename It>
+    void _push_batch(It o, size_t n) {
+        if(nthreads == 1 || H.size() < 2) { while(n--) _push(*o++); return; }
+        const size_t n0 = i0 + buf.size();
+        while(n--) {
+            const T& c = *o;
+            auto x = order(c);
+            if(!(x==x)) printf("*** NaN warning at shared window item %zu! Skipping!\n ***", i0 + buf.size());
+            else if(disordered(x)) processDisordered(c);
+            else buf.push_back(*o);
+            ++o;
+        }
+        const size_t n1 = i0 + buf.size();
+        run_handlers([n0, n1](handler_t& h) { for(size_t i = n0; i < n1; ++i) h.receive(); });
+        trim();
+    }
+
+    /// apply f to each handler, in parallel if nthreads != 1
+    template<typename F>
+    void run_handlers(F f) {
+        if(nthreads == 1 || H.size() < 2) { for(auto h: H) f(*h); return; }
+        if(!P) P.reset(new WorkStealingPool(std::max(nthreads, 0)));
+        for(auto h: H) P->submit([&f, h] { f(*h); });
+        P->wait_idle();
+    }
+
+    /// drop objects that have left all handlers' windows
+    void trim() {
+        nmax = std::max(nmax, buf.size());
+        size_t i1 = i0 + buf.size();
+        for(auto h: H) i1 = std::min(i1, h->ilo);
+        while(i0 < i1) {
+            buf.pop_front();
+            ++i0;
+        }
+    }
+
+    deque<Tmut_t> buf;              ///< shared window objects
+    size_t i0 = 0;                  ///< stream position of buf.front()
+    size_t nmax = 0;                ///< maximum buffer size
+    vector<handler_t*> H;           ///< registered handlers
+    std::unique_ptr<WorkStealingPool> P;    ///< thread pool for parallel handlers
+};
+
+#endif
@@ -0,0 +1,140 @@
+/// \file StageProfile.hh Opt-in analysis chain stage throughput, latency, and queue depth instrumentation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef STAGEPROFILE_HH
+#define STAGEPROFILE_HH
+
+#include "XMLWriter.hh"
+#include <chrono>
+#include <array>
+
+/// No-op profiling policy: compiles away to nothing
+class NoStageProfile {
+public:
+    /// whether profiling is active
+    static constexpr bool enabled = false;
+    /// timer start marker
+    typedef int tick_t;
+
+    /// mark start of timed call
+    tick_t start() const { return 0; }
+    /// mark end of timed call processing n items
+    void stop(tick_t, size_t = 1) { }
+    /// count received signal
+    void count_signal() { }
+    /// record queue depth sample
+    void depth(size_t) { }
+    /// add results to XML output
+    void addXML(XMLTag&, const string& = "profile") const { }
+    /// stream results to XML output
+    void writeXML(XMLWriter&, const string& = "profile") const { }
+};
+
+/// Profiling policy counting items and histogramming call latency
+class StageProfile {
+public:
+    /// whether profiling is active
+    static constexpr bool enabled = true;
+    /// timer clock
+    typedef std::chrono::steady_clock clk_t;
+    /// timer start marker
+    typedef clk_t::time_point tick_t;
+    /// number of log2(ns) latency histogram bins
+    static constexpr size_t nbins = 40;
+
+    /// mark start of timed call
+    tick_t start() const { return clk_t::now(); }
+    /// mark end of timed call processing n items
+    void stop(tick_t t0, size_t n = 1) {
+        auto dt = std::chrono::duration_cast<std::chrono::nanoseconds>(clk_t::now() - t0).count();
+        ++ncalls;
+        nitems += n;
+        t_ns += dt;
+        size_t b = 0;
+        while(dt > 1 && b + 1 < nbins) { dt >>= 1; ++b; }
+        ++hLatency[b];
+    }
+    /// count received signal
+    void count_signal() { ++nsignals; }
+    /// record queue depth sample
+    void depth(size_t d) {
+        ++ndepth;
+        sum_depth += d;
+        if(d > max_depth) max_depth = d;
+    }
+
+    /// add results to XML output as child tag
+    void addXML(XMLTag& X, const string& tagname = "profile") const {
+        XMLTagBuilder B(X);
+        writeXML(B, tagname);
+    }
+    /// stream results to XML output as child tag (attributes in sorted order, matching XMLTag output)
+    void writeXML(XMLWriter& W, const string& tagname = "profile") const {
+        W.open(tagname);
+        W.attr("calls", ncalls);
+        W.attr("items", nitems);
+        if(ncalls) {
+            string h;
+            char b[24];
+            size_t bmax = nbins;
+            while(bmax && !hLatency[bmax-1]) --bmax;
+            for(size_t i = 0; i < bmax; ++i) {
+                if(i) h += ',';
+                h.append(b, XMLWriter::format(b, (unsigned long long)hLatency[i]));
+            }
+            W.attr("latency_log2ns", h);
+        }
+        if(ndepth) {
+            W.attr("max_depth", max_depth);
+            W.attr("mean_depth", double(sum_depth)/ndepth);
+        }
+        if(ncalls) W.attr("ns_per_item", nitems? double(t_ns)/nitems : 0.);
+        if(nsignals) W.attr("signals", nsignals);
+        if(ncalls) W.attr("t_total_s", 1e-9*t_ns);
+        W.close();
+    }
+
+    size_t ncalls = 0;      ///< number of timed calls
+    size_t nitems = 0;      ///< number of items processed in timed calls
+    size_t nsignals = 0;    ///< number of signals received
+    long long t_ns = 0;     ///< cumulative timed call duration [ns]
+    std::array<size_t, nbins> hLatency{}; ///< histogram of call latency by log2(ns)
+    size_t ndepth = 0;      ///< number of queue depth samples
+    size_t sum_depth = 0;   ///< sum of queue depth samples
+    size_t max_depth = 0;   ///< maximum sampled queue depth
+};
+
+/// Debugging count of items received by copy or by move (ownership transfer); enable by compiling WITH_COPY_COUNT
+class SinkCopyCounter {
+public:
+#ifdef WITH_COPY_COUNT
+    /// count copied items
+    void copied(size_t n = 1) { nCopied += n; }
+    /// count moved items
+    void moved(size_t n = 1) { nMoved += n; }
+    /// add results to XML output
+    void addXML(XMLTag& X) const {
+        X.addAttr("n_copied", nCopied);
+        X.addAttr("n_moved", nMoved);
+    }
+
+    size_t nCopied = 0; ///< number of items received by copy
+    size_t nMoved = 0;  ///< number of items received by move
+#else
+    /// count copied items
+    void copied(size_t = 1) { }
+    /// count moved items
+    void moved(size_t = 1) { }
+    /// add results to XML output
+    void addXML(XMLTag&) const { }
+#endif
+};
+
+/// built-in queue depth instrumentation for buffering stages; enable by compiling WITH_STAGE_PROFILE
+#ifdef WITH_STAGE_PROFILE
+typedef StageProfile default_stage_profile_t;
+#else
+typedef NoStageProfile default_stage_profile_t;
+#endif
+
+#endif
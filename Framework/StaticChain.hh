@@ -0,0 +1,133 @@
+/// \file StaticChain.hh Compile-time fused chain of analysis stages, without virtual dispatch between stages
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef STATICCHAIN_HH
+#define STATICCHAIN_HH
+
+#include "DataSink.hh"
+#include <tuple>
+#include <type_traits>
+
+/// Base for stages composed in StaticChain: pass-through by default.
+/// Subclasses define (hide) template push and signal, passing output to `next` --- a direct, inlinable call.
+template<typename T, typename U = T>
+class StaticStage {
+public:
+    /// input type
+    typedef T sink_t;
+    /// output type
+    typedef U output_t;
+
+    /// process input, passing output to next.push(...)
+    template<class N>
+    void push(sink_t& o, N& next) { next.push(o); }
+    /// process data flow signal, passing through to next.signal(...)
+    template<class N>
+    void signal(datastream_signal_t s, N& next) { next.signal(s); }
+};
+
+/// Stage wrapper constructing from configuration if supported, otherwise default constructor
+template<class S>
+class _CfgStage: public S {
+public:
+    /// Default constructor
+    _CfgStage() = default;
+    /// Constructor for configurable stages
+    template<class X = S, typename std::enable_if<std::is_constructible<X, const Setting&>::value, int>::type = 0>
+    explicit _CfgStage(const Setting& cfg): S(cfg) { }
+    /// Constructor for non-configurable stages
+    template<class X = S, typename std::enable_if<!std::is_constructible<X, const Setting&>::value, int>::type = 0>
+    explicit _CfgStage(const Setting&): S() { }
+};
+
+/// "next" handle passed to I^th stage of chain C: calls stage I, or output at end
+template<class C, size_t I, bool = (I < C::nstages)>
+class _StaticNext {
+public:
+    /// Constructor
+    explicit _StaticNext(C& c): Ch(c) { }
+    /// pass to stage I
+    template<typename X>
+    void push(X& o) { _StaticNext<C, I+1> n(Ch); std::get<I>(Ch.stages).push(o, n); }
+    /// signal stage I
+    void signal(datastream_signal_t s) { _StaticNext<C, I+1> n(Ch); std::get<I>(Ch.stages).signal(s, n); }
+protected:
+    C& Ch; ///< chain
+};
+
+/// "next" handle past last stage: output to dynamic nextSink
+template<class C, size_t I>
+class _StaticNext<C, I, false> {
+public:
+    /// Constructor
+    explicit _StaticNext(C& c): Ch(c) { }
+    /// pass to output
+    template<typename X>
+    void push(X& o) { Ch.output(o); }
+    /// signal output
+    void signal(datastream_signal_t s) { if(Ch.nextSink) Ch.nextSink->signal(s); }
+protected:
+    C& Ch; ///< chain
+};
+
+/// Fused chain of StaticStage-like stages, as a DataLink from first stage input to last stage output
+template<class... Stages>
+class StaticChain: public DataLink<typename std::tuple_element<0, std::tuple<Stages...>>::type::sink_t,
+    typename std::tuple_element<sizeof...(Stages)-1, std::tuple<Stages...>>::type::output_t>, public XMLProvider {
+public:
+    /// number of stages
+    static constexpr size_t nstages = sizeof...(Stages);
+    /// input type
+    typedef typename std::tuple_element<0, std::tuple<Stages...>>::type::sink_t sink_t;
+    /// output type
+    typedef typename std::tuple_element<nstages-1, std::tuple<Stages...>>::type::output_t output_t;
+    /// parent link type
+    typedef DataLink<sink_t, output_t> link_t;
+    using link_t::nextSink;
+
+    /// Default constructor
+    StaticChain(): XMLProvider("StaticChain") { }
+    /// Constructor from configuration: stages constructed from S (if supported); output from S["next"]
+    explicit StaticChain(const Setting& S): XMLProvider("StaticChain"), stages(_cfgarg<Stages>(S)...) {
+        if(S.exists("next")) this->createOutput(S["next"]);
+    }
+
+    /// push through stages
+    void push(sink_t& o) override { _StaticNext<StaticChain, 0> n(*this); n.push(o); }
+    /// push batch through stages, with single batch output to nextSink
+    void push_batch(sink_t* o, size_t n) override {
+        inBatch = true;
+        try {
+            _StaticNext<StaticChain, 0> nx(*this);
+            while(n--) nx.push(*o++);
+        } catch(...) { inBatch = false; outBatch.clear(); throw; }
+        inBatch = false;
+        this->nextBatch(outBatch);
+    }
+    using link_t::push_batch;
+    /// signal through stages
+    void signal(datastream_signal_t s) override { _StaticNext<StaticChain, 0> n(*this); n.signal(s); }
+
+    /// get I^th stage
+    template<size_t I>
+    typename std::tuple_element<I, std::tuple<Stages...>>::type& stage() { return std::get<I>(stages); }
+
+    std::tuple<_CfgStage<Stages>...> stages;    ///< chain stages
+
+    /// output from last stage
+    void output(output_t& o) {
+        if(!nextSink) return;
+        if(inBatch) outBatch.push_back(o);
+        else nextSink->push(o);
+    }
+
+protected:
+    /// configuration argument for each stage
+    template<class>
+    static const Setting& _cfgarg(const Setting& S) { return S; }
+
+    vector<typename std::remove_const<output_t>::type> outBatch;   ///< output accumulated during push_batch
+    bool inBatch = false;   ///< whether push_batch is accumulating outBatch
+};
+
+#endif
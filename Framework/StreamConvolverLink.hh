@@ -0,0 +1,72 @@
+/// \file StreamConvolverLink.hh Analysis chain link applying FIR convolution to streamed waveform samples
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef STREAMCONVOLVERLINK_HH
+#define STREAMCONVOLVERLINK_HH
+
+#include "DataSink.hh"
+#include "FFTW_StreamConvolver.hh"
+
+/// Pass-through link convolving sample stream (overlap-save, fixed memory); samples are delayed by up to one FFT block
+/// END and REINIT drain remaining outputs (zero-padded stream end) before passing on; FLUSH passes through without breaking stream continuity
+template<typename T = double>
+class StreamConvolverLink: public DataLink<T,T>, public XMLProvider {
+public:
+    using DataLink<T,T>::nextSink;
+
+    /// Constructor, with kernel, output delay, and FFT block size (0 for automatic)
+    explicit StreamConvolverLink(const vector<T>& h, size_t delay = 0, size_t nfft = 0):
+    XMLProvider("StreamConvolverLink"), C(h, delay, nfft) { }
+
+    /// Constructor from configuration, for Gaussian smoothing by "radius" samples out to "nsigma"
+    explicit StreamConvolverLink(const Setting& S): StreamConvolverLink(gaussKernel(S), gaussKernel(S).size()/2, nfft(S)) {
+        if(S.exists("next")) this->createOutput(S["next"]);
+    }
+
+    /// convolve one sample
+    void push(T& x) override { push_batch(&x, 1); }
+    /// convolve batch of samples
+    void push_batch(T* x, size_t n) override {
+        C.push(x, n, vout);
+        this->nextBatch(vout);
+    }
+    /// pass through data flow signal, draining convolver at end of stream
+    void signal(datastream_signal_t s) override {
+        if(s == DATASTREAM_INIT) C.reset();
+        if(s == DATASTREAM_END || s == DATASTREAM_REINIT) {
+            C.finish(vout);
+            this->nextBatch(vout);
+        }
+        DataLink<T,T>::signal(s);
+    }
+
+    StreamConvolver<T> C;   ///< convolver
+
+protected:
+    /// configured Gaussian kernel
+    static vector<T> gaussKernel(const Setting& S) {
+        double r = 1;
+        double nsigma = 5;
+        S.lookupValue("radius", r);
+        S.lookupValue("nsigma", nsigma);
+        if(!(r > 0)) throw std::runtime_error("StreamConvolverLink requires radius > 0");
+        return StreamConvolver<T>::gaussKernel(r, nsigma);
+    }
+    /// configured FFT block size
+    static size_t nfft(const Setting& S) {
+        int n = 0;
+        S.lookupValue("nfft", n);
+        return std::max(n, 0);
+    }
+
+    /// XML metadata output
+    void _makeXML(XMLTag& X) override {
+        X.addAttr("kernel", C.L);
+        X.addAttr("delay", C.delay);
+        X.addAttr("nfft", C.N);
+    }
+
+    vector<T> vout;     ///< output buffer
+};
+
+#endif
@@ -0,0 +1,369 @@
+/// \file SyntheticDAQ.hh Configurable synthetic time-ordered hit stream source and end-to-end latency probe, for pipeline benchmarking
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SYNTHETICDAQ_HH
+#define SYNTHETICDAQ_HH
+
+#include "DataSource.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "XMLTag.hh"
+#include <array>
+#include <chrono>
+#include <queue>
+#include <random>
+#include <thread>
+#include <stdint.h>
+#include <stdio.h>
+
+/// wall-clock timestamp [ns] for end-to-end latency measurement
+inline int64_t synth_wallclock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Synthetic detector hit, with capacity for NPAY payload words
+template<size_t NPAY>
+struct SynthHit_t {
+    /// ordering type
+    typedef double ordering_t;
+    /// ordering parameter
+    explicit operator ordering_t() const { return t; }
+    /// key for ConfigParallel sharded mode
+    int32_t shard_key() const { return det; }
+    /// payload capacity
+    static constexpr size_t max_payload = NPAY;
+
+    double t;               ///< hit time [ns]
+    int64_t evt;            ///< generating cluster number
+    int64_t t_wall;         ///< wall-clock emission timestamp [ns], from synth_wallclock_ns()
+    int32_t det;            ///< detector channel
+    int32_t npay;           ///< number of filled payload words
+    float payload[NPAY];    ///< payload data
+
+    /// print to stdout
+    void display() const { printf("SynthHit %lld ch %i at t = %.1f (%i words)\n", (long long)evt, det, t, npay); }
+};
+
+/// default synthetic hit type
+typedef SynthHit_t<8> SynthHit;
+
+/// Log-binned latency histogram (8 bins per octave, ~9% resolution) with percentile estimates
+class LatencyHistogram {
+public:
+    /// sub-bins per octave
+    static constexpr int nsub = 8;
+    /// number of bins (covering up to 2^63 ns)
+    static constexpr size_t nbins = nsub*62;
+
+    /// add latency sample [ns]
+    void fill(int64_t dt) {
+        if(dt < 0) dt = 0;
+        ++n;
+        sum += dt;
+        if(dt > max) max = dt;
+        ++h[bin(dt)];
+    }
+    /// merge another histogram
+    void operator+=(const LatencyHistogram& L) {
+        for(size_t i = 0; i < nbins; ++i) h[i] += L.h[i];
+        n += L.n;
+        sum += L.sum;
+        if(L.max > max) max = L.max;
+    }
+
+    /// estimate quantile q in [0,1] latency [ns], interpolating within bin
+    double quantile(double q) const {
+        if(!n) return 0;
+        double c = q*n, s = 0;
+        for(size_t i = 0; i < nbins; ++i) {
+            if(!h[i] || s + h[i] < c) { s += h[i]; continue; }
+            double x = lo(i) + (c - s)/h[i]*width(i);
+            return x < max? x : max;
+        }
+        return max;
+    }
+    /// mean latency [ns]
+    double mean() const { return n? sum/n : 0.; }
+
+    /// add summary to XML output as child tag
+    void addXML(XMLTag& X, const string& tagname = "latency") const {
+        auto L = new XMLTag(tagname);
+        L->addAttr("n", n);
+        if(n) {
+            L->addAttr("mean_ns", mean());
+            L->addAttr("p50_ns", quantile(0.5));
+            L->addAttr("p90_ns", quantile(0.9));
+            L->addAttr("p99_ns", quantile(0.99));
+            L->addAttr("p999_ns", quantile(0.999));
+            L->addAttr("max_ns", max);
+        }
+        X.addChild(L);
+    }
+
+    size_t n = 0;       ///< number of samples
+    double sum = 0;     ///< sum of samples [ns]
+    int64_t max = 0;    ///< maximum sample [ns]
+    std::array<size_t, nbins> h{};  ///< histogram counts
+
+protected:
+    /// bin for dt >= 0: exact below 8ns, then 8 bins per octave
+    static size_t bin(int64_t dt) {
+        if(dt < nsub) return dt;
+        int e = 63 - __builtin_clzll(dt);
+        return (e - 2)*nsub + ((dt >> (e - 3)) & (nsub - 1));
+    }
+    /// bin lower edge
+    static double lo(size_t b) { return b < nsub? b : double(nsub + b % nsub)*double(1ULL << (b/nsub - 1)); }
+    /// bin width
+    static double width(size_t b) { return b < nsub? 1 : double(1ULL << (b/nsub - 1)); }
+};
+
+/// Configurable synthetic DAQ hit stream: Poisson-timed clusters of hits, emitted with bounded disorder,
+/// pushed in batches into configured `next` chain; each hit is stamped with wall-clock emission time for latency probes.
+/// T ~ SynthHit_t<N> (fields t, evt, t_wall, det, npay, payload[]). Configuration:
+/// n (hits to generate), rate (clusters per second of simulated time [ns]), multiplicity (mean hits per cluster),
+/// cluster_width (hit time spread in cluster [ns]), disorder (maximum emission delay [ns]), payload (words), ndet (channels),
+/// batch (hits per push), realtime (pace emission to simulated time), seed
+template<class T>
+class SyntheticDAQ: public Configurable, public DataSource<T>, virtual public XMLProvider, public SinkUser<const T> {
+public:
+    using SinkUser<const T>::nextSink;
+    /// generated item type
+    typedef typename DataSource<T>::val_t val_t;
+
+    /// Constructor
+    explicit SyntheticDAQ(const Setting& S, bool doMakeNext = true): XMLProvider("SyntheticDAQ"), Configurable(S) {
+        S.lookupValue("n", nHits);
+        optionalGlobalArg("synthN", nHits, "number of synthetic DAQ hits to generate");
+        S.lookupValue("rate", rate);
+        optionalGlobalArg("synthRate", rate, "synthetic DAQ cluster rate [Hz]");
+        S.lookupValue("multiplicity", multiplicity);
+        S.lookupValue("cluster_width", cluster_width);
+        S.lookupValue("disorder", disorder);
+        S.lookupValue("payload", npay);
+        S.lookupValue("ndet", ndet);
+        S.lookupValue("batch", batch);
+        S.lookupValue("realtime", realtime);
+        S.lookupValue("seed", seed);
+        if(npay < 0 || size_t(npay) > T::max_payload) throw std::runtime_error("SyntheticDAQ payload exceeds hit capacity");
+        if(rate <= 0 || multiplicity < 1 || ndet < 1 || batch < 1) throw std::runtime_error("Invalid SyntheticDAQ configuration");
+        reset();
+
+        if(doMakeNext && S.exists("next")) this->createOutput(S["next"]);
+    }
+
+    /// Fill supplied item with next hit in emission order; return false after n hits
+    bool next(val_t& o) override {
+        if(nEmit >= size_t(nHits)) return false;
+        while(!Q.size() || Q.top().te > tCluster) genCluster();
+        o = Q.top().h;
+        Q.pop();
+        ++nEmit;
+        return true;
+    }
+    /// Reset to start of (identical) sequence
+    void reset() override {
+        rng.seed(seed);
+        Q = PQ_t();
+        tCluster = 0;
+        nCluster = 0;
+        nEmit = 0;
+    }
+    /// Remaining hits
+    size_t entries() override { return nHits - nEmit; }
+
+    /// Generate all hits into next chain (from start of sequence on repeated runs), timing throughput
+    void run() override {
+        if(!nextSink) throw std::runtime_error("SyntheticDAQ 'next' output not configured.");
+        if(nEmit) reset();
+        vector<val_t> v(batch);
+        nextSink->signal(DATASTREAM_INIT);
+        auto t0 = std::chrono::steady_clock::now();
+        int64_t w0 = synth_wallclock_ns();
+        size_t k = 0;
+        do {
+            k = 0;
+            while(k < v.size() && next(v[k])) ++k;
+            if(!k) break;
+            if(realtime) {
+                auto dt = int64_t(v[k-1].t) - (synth_wallclock_ns() - w0);
+                if(dt > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(dt));
+            }
+            auto tw = synth_wallclock_ns();
+            for(size_t i = 0; i < k; ++i) v[i].t_wall = tw;
+            nextSink->push_move_batch(v.data(), k);
+        } while(k == v.size());
+        nextSink->signal(DATASTREAM_FLUSH);
+        tRun = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        nextSink->signal(DATASTREAM_END);
+
+        printf("SyntheticDAQ: %zu hits in %.3f s: %.4g hits/s, %.4g MB/s\n", nEmit, tRun, nEmit/tRun, 1e-6*nEmit*sizeof(val_t)/tRun);
+    }
+
+    int nHits = 1000000;        ///< total hits to generate
+    double rate = 1e6;          ///< cluster rate [Hz], with time in [ns]
+    double multiplicity = 4;    ///< mean hits per cluster (1 + Poisson)
+    double cluster_width = 100; ///< hit time spread within cluster [ns]
+    double disorder = 0;        ///< maximum hit emission delay after hit time [ns]
+    int npay = T::max_payload;  ///< filled payload words per hit
+    int ndet = 64;              ///< number of detector channels
+    int batch = 1024;           ///< hits per batch push
+    bool realtime = false;      ///< pace emission to simulated time (else generate at full speed)
+    int seed = 1;               ///< random number generator seed
+
+    size_t nEmit = 0;           ///< hits emitted
+    double tRun = 0;            ///< run() duration [s], up to completed flush
+
+protected:
+    /// hit awaiting emission
+    struct pending_t {
+        double te;  ///< emission time [ns]
+        val_t h;    ///< hit
+        /// reverse order for min-heap
+        bool operator<(const pending_t& p) const { return te > p.te; }
+    };
+    /// emission queue type
+    typedef std::priority_queue<pending_t> PQ_t;
+
+    /// generate next cluster at tCluster, and advance tCluster to following cluster start
+    void genCluster() {
+        size_t m = 1 + std::poisson_distribution<int>(multiplicity - 1)(rng);
+        std::uniform_real_distribution<double> U;
+        pending_t p;
+        auto& h = p.h;
+        h.evt = nCluster++;
+        h.t_wall = 0;
+        h.npay = npay;
+        for(size_t i = 0; i < m; ++i) {
+            h.t = tCluster + cluster_width*U(rng);
+            h.det = std::uniform_int_distribution<int>(0, ndet - 1)(rng);
+            for(int j = 0; j < npay; ++j) h.payload[j] = U(rng);
+            for(size_t j = npay; j < T::max_payload; ++j) h.payload[j] = 0;
+            p.te = h.t + disorder*U(rng);
+            Q.push(p);
+        }
+        // all later hits are emitted after next cluster start
+        tCluster += std::exponential_distribution<double>(1e-9*rate)(rng);
+    }
+
+    /// XML output
+    void _makeXML(XMLTag& X) override {
+        X.addAttr("nHits", nEmit);
+        X.addAttr("nClusters", nCluster);
+        X.addAttr("rate", rate);
+        X.addAttr("multiplicity", multiplicity);
+        X.addAttr("cluster_width", cluster_width);
+        if(disorder) X.addAttr("disorder", disorder);
+        X.addAttr("payload", npay);
+        X.addAttr("batch", batch);
+        if(realtime) X.addAttr("realtime", "true");
+        if(tRun) {
+            X.addAttr("t_run_s", tRun);
+            X.addAttr("hits_per_s", nEmit/tRun);
+        }
+    }
+
+    std::mt19937_64 rng;        ///< random number generator
+    PQ_t Q;                     ///< hits awaiting emission
+    double tCluster = 0;        ///< start time of next cluster to generate [ns]
+    size_t nCluster = 0;        ///< clusters generated
+};
+
+/// Pass-through link histogramming end-to-end latency since SyntheticDAQ emission, and counting out-of-order arrivals
+template<class T>
+class SynthLatencyProbe: public DataLink<T,T>, public XMLProvider {
+public:
+    using DataLink<T,T>::nextSink;
+    /// ordering type
+    typedef typename std::remove_const<T>::type::ordering_t ordering_t;
+
+    /// Constructor
+    SynthLatencyProbe(): XMLProvider("SynthLatencyProbe") { }
+    /// Constructor from configuration
+    explicit SynthLatencyProbe(const Setting& S): SynthLatencyProbe() { if(S.exists("next")) this->createOutput(S["next"]); }
+
+    /// record and pass along
+    void push(T& o) override {
+        record(o, synth_wallclock_ns());
+        if(nextSink) nextSink->push(o);
+    }
+    /// record batch and pass along
+    void push_batch(T* o, size_t n) override {
+        auto tw = synth_wallclock_ns();
+        for(size_t i = 0; i < n; ++i) record(o[i], tw);
+        if(nextSink) nextSink->push_batch(o, n);
+    }
+    using DataLink<T,T>::push_batch;
+
+    LatencyHistogram L;     ///< latency histogram
+    size_t nDisordered = 0; ///< number of items arriving earlier-ordered than previous
+    int64_t tLast = 0;      ///< wall-clock time of last arrival [ns]
+
+protected:
+    /// record item arrival at wall-clock time tw
+    void record(const T& o, int64_t tw) {
+        L.fill(tw - o.t_wall);
+        auto x = ordering_t(o);
+        if(L.n > 1 && x < xPrev) ++nDisordered;
+        xPrev = x;
+        tLast = tw;
+    }
+
+    /// XML output
+    void _makeXML(XMLTag& X) override {
+        L.addXML(X);
+        X.addAttr("n_disordered", nDisordered);
+    }
+
+    ordering_t xPrev = {};  ///< previous item ordering
+};
+
+/// Per-hit synthetic "calibration" work stage: `work` multiply-adds on each payload word
+template<class T>
+class SynthWorkLink: public DataLink<T,T>, public XMLProvider {
+public:
+    using DataLink<T,T>::nextSink;
+    /// mutable item type
+    typedef typename std::remove_const<T>::type Tmut_t;
+
+    /// Constructor
+    explicit SynthWorkLink(int w = 1): XMLProvider("SynthWorkLink"), work(w) { }
+    /// Constructor from configuration
+    explicit SynthWorkLink(const Setting& S): SynthWorkLink() {
+        S.lookupValue("work", work);
+        if(S.exists("next")) this->createOutput(S["next"]);
+    }
+
+    /// process and pass along
+    void push(T& o) override {
+        Tmut_t h = o;
+        calib(h);
+        if(nextSink) nextSink->push_move(std::move(h));
+    }
+    /// process batch and pass along
+    void push_batch(T* o, size_t n) override {
+        v.assign(o, o + n);
+        for(auto& h: v) calib(h);
+        this->nextBatch(v);
+    }
+    using DataLink<T,T>::push_batch;
+
+    int work;   ///< multiply-add passes per payload word
+
+protected:
+    /// apply work to item
+    void calib(Tmut_t& h) const {
+        for(int i = 0; i < h.npay; ++i) {
+            auto x = h.payload[i];
+            for(int j = 0; j < work; ++j) x = 0.999f*x + 0.5f;
+            h.payload[i] = x;
+        }
+    }
+
+    /// XML output
+    void _makeXML(XMLTag& X) override { X.addAttr("work", work); }
+
+    vector<Tmut_t> v;   ///< processed batch
+};
+
+#endif
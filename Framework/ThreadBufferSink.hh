@@ -6,6 +6,10 @@
 
 #include "DataSink.hh"
 #include "Threadworker.hh"
+#include "LocklessCircleBuffer.hh"
+#include "StageProfile.hh"
+#include "Checkpoint.hh"
+#include "MemoryBudget.hh"
 #include <unistd.h>
 
 /// Typeless base
@@ -15,25 +19,77 @@ virtual public _DataSink, virtual public _SinkUser {
 };
 
 /// Buffered input to sink running in independent thread
+/// mutex-protected unbounded FIFO by default; optional bounded lock-free ring with setRing(n)
+/// optional FIFO bound with setOverflow(...) policy for full queue
 template<typename T>
-class ThreadBufferSink: public DataLink<T,T>, public Threadworker {
+class ThreadBufferSink: public DataLink<T,T>, public Threadworker, public Checkpointable {
 public:
     typedef typename std::remove_const<T>::type Tmut_t;
     using DataLink<T,T>::nextSink;
 
-    /// Constructor
-    ThreadBufferSink(DataSink<T>* s = nullptr) { nextSink = s; }
+    /// Constructor, optionally in lock-free ring mode with specified capacity
+    explicit ThreadBufferSink(DataSink<T>* s = nullptr, size_t nring = 0) { nextSink = s; setRing(nring); }
 
-    /// receive item to queue
-    void push(T& o) override {
-        lock_guard<mutex> l(inputMut);
-        datq.push_back(o);
+    /// set lock-free ring buffer capacity (0 for mutex-locked FIFO); call before launching thread
+    void setRing(size_t n) {
+        if(checkRunning()) throw std::logic_error("ThreadBufferSink mode change while running");
+        ring.allocate(n);
+    }
+    /// lock-free ring capacity (0 if in mutex FIFO mode)
+    size_t ringCapacity() const { return ring.capacity(); }
+
+    /// policy for input to full queue
+    enum overflow_t {
+        OVERFLOW_BLOCK,         ///< wait for space (default)
+        OVERFLOW_DROP_OLDEST,   ///< discard oldest queued item (mutex FIFO mode only)
+        OVERFLOW_SAMPLE         ///< discard new input, passing on a sample of the stream
+    };
+    /// set full-queue policy and mutex FIFO bound (0 for unbounded); call before launching thread
+    void setOverflow(overflow_t o, size_t qmax = 0) {
+        if(checkRunning()) throw std::logic_error("ThreadBufferSink mode change while running");
+        if(o == OVERFLOW_DROP_OLDEST && ring.capacity()) throw std::logic_error("ThreadBufferSink ring mode cannot drop oldest");
+        overflow = o;
+        maxQueue = qmax;
+    }
+    /// full-queue policy
+    overflow_t getOverflow() const { return overflow; }
+    /// number of items discarded by overflow policy
+    size_t n_dropped() const { return ndropped; }
+
+    /// block until running thread has passed all queued items downstream
+    void drain_wait() {
+        if(checkRunning() != RUNNING) return;
+        if(ring.capacity()) {
+            unsigned int nwait = 0;
+            while(!ring.empty() || busy.load()) {
+                ring_notify();
+                if(waitPolicy.idle(++nwait)) usleep(int(1e6*waitPolicy.park_s));
+            }
+            return;
+        }
+        unique_lock<mutex> lk(inputMut);
         inputReady.notify_one();
-        sched_yield();
+        spaceReady.wait(lk, [this] { return (datq.size() == dq0 && !busy) || runstat != RUNNING; });
     }
 
+    /// receive item to queue
+    void push(T& o) override { copies.copied(); _push(o); }
+    /// receive item to queue by ownership transfer
+    void push_move(Tmut_t&& o) override { copies.moved(); _push(std::move(o)); }
+
+    /// receive batch of items to queue
+    void push_batch(T* o, size_t n) override { copies.copied(n); _push_batch(o, n); }
+    /// receive batch of items to queue by ownership transfer
+    void push_move_batch(Tmut_t* o, size_t n) override { copies.moved(n); _push_batch(std::make_move_iterator(o), n); }
+    using DataLink<T,T>::push_batch;
+
+    /// re-allocate ring from placed reader thread, for NUMA-local first touch
+    void thread_init() override { if(ring.capacity() && ring.empty()) ring.allocate(ring.capacity()); }
+
     /// thread to pull from queue and push downstream
     void threadjob() override {
+        if(ring.capacity()) { ring_threadjob(); return; }
+
         vector<Tmut_t> datq2;
 
         while(true) {
@@ -42,18 +98,19 @@ public:
             { // get input items ready to pass on
                 unique_lock<mutex> lk(inputMut);    // acquire unique_lock on queue in this scope
                 if(runstat == STOP_REQUESTED) break;
-                inputReady.wait(lk);                // unlock; wait; re-lock when notified
-                std::swap(datq, datq2);
+                // unlock; wait; re-lock when notified
+                inputReady.wait(lk, [this] { return datq.size() > dq0 || runstat == PAUSE_REQUESTED || runstat == STOP_REQUESTED; });
+                take_queue(datq2);
+                busy = true;
+                spaceReady.notify_all();
             }
 
             // push(...) while continuing to receive without blocking
-            if(nextSink) {
-                for(auto& o: datq2) {
-                    nextSink->push(o);
-                    sched_yield();
-                }
-            }
-            datq2.clear();
+            this->nextBatch(datq2);
+
+            lock_guard<mutex> lk(inputMut);
+            busy = false;
+            spaceReady.notify_all();
         }
     }
 
@@ -63,15 +120,171 @@ public:
         if(_is_launched) pause();
         if(sig >= DATASTREAM_FLUSH) {
             lock_guard<mutex> l(inputMut);
-            if(nextSink) for(auto& o: datq) nextSink->push(o);
-            datq.clear();
+            vector<Tmut_t> v;
+            take_queue(v);
+            this->nextBatch(v);
+            // reader thread paused: safe to drain ring from here
+            while(ring.pop_batch(datq, maxBatch)) this->nextBatch(datq);
+            mem.set(0);
         }
+        if(sig == DATASTREAM_CHECKPT) this->checkpoint(); // with reader thread paused
         if(nextSink) nextSink->signal(sig);
         if(_is_launched) unpause();
     }
 
+    /// serialize queued items (with reader thread paused)
+    void saveState(BinaryWriter& W) override {
+        lock_guard<mutex> l(inputMut);
+        vector<Tmut_t> v;
+        take_queue(v);
+        ring.pop_batch(v);
+        ckpt_save_items(W, v.begin(), v.end());
+        for(auto& o: v) _requeue(std::move(o));
+    }
+    /// restore queued items
+    void loadState(BinaryReader& R) override {
+        lock_guard<mutex> l(inputMut);
+        ckpt_load_items<Tmut_t>(R, [this](Tmut_t&& o) { _requeue(std::move(o)); });
+    }
+
+    SpinParkPolicy waitPolicy;  ///< ring-mode waiting policy (for both reader and full-buffer writer)
+    size_t maxBatch = 1024;     ///< ring-mode maximum batch size passed downstream
+    default_stage_profile_t qprof;  ///< input queue depth instrumentation
+    SinkCopyCounter copies;         ///< input copy/move counting
+    MemAccount mem{"ThreadBufferSink"}; ///< buffered bytes, reported to MemoryBudget::global() and MemTag
+
 protected:
-    vector<Tmut_t> datq;    ///< input FIFO
+    vector<Tmut_t> datq;                ///< input FIFO
+    size_t dq0 = 0;                     ///< number of dropped items at start of datq
+    SPSCRing<Tmut_t> ring;              ///< lock-free input ring, if allocated
+    std::atomic<bool> parked{false};    ///< whether ring reader thread is (about to be) parked
+    std::atomic<bool> busy{false};      ///< whether reader thread is passing a batch downstream
+    std::condition_variable spaceReady; ///< notifier for queue space freed or batch completed
+    overflow_t overflow = OVERFLOW_BLOCK;   ///< full-queue policy
+    size_t maxQueue = 0;                ///< mutex FIFO mode maximum queued items (0 for unbounded)
+    size_t ndropped = 0;                ///< number of items discarded by overflow policy
+
+    /// move queue contents (skipping dropped items) to v; call with inputMut locked
+    void take_queue(vector<Tmut_t>& v) {
+        v.clear();
+        std::swap(datq, v);
+        if(dq0) v.erase(v.begin(), v.begin() + dq0);
+        dq0 = 0;
+        mem.set(0);
+    }
+
+    /// return item to queue ahead of new input, when reader thread paused or idle
+    void _requeue(Tmut_t&& o) {
+        if(!ring.capacity()) datq.push_back(std::move(o));
+        else if(!ring.try_push(std::move(o))) throw std::runtime_error("ThreadBufferSink ring too small for checkpoint restore");
+    }
+
+    /// apply overflow policy before adding one item to mutex FIFO; return whether to add item
+    bool make_room(unique_lock<mutex>& lk) {
+        if(!maxQueue) return true;
+        while(datq.size() - dq0 >= maxQueue) {
+            if(overflow == OVERFLOW_SAMPLE) { ++ndropped; return false; }
+            if(overflow == OVERFLOW_DROP_OLDEST) {
+                ++ndropped;
+                if(++dq0 >= maxQueue) { datq.erase(datq.begin(), datq.begin() + dq0); dq0 = 0; }
+                return true;
+            }
+            if(runstat != RUNNING) return true; // no reader to wait for
+            inputReady.notify_one();
+            spaceReady.wait(lk);
+        }
+        return true;
+    }
+
+    /// copy or move item to queue
+    template<typename U>
+    void _push(U&& o) {
+        if(ring.capacity()) {
+            ring_push(std::forward<U>(o));
+            ring_notify();
+            qprof.depth(ring.n_buffered());
+            mem.set_items<Tmut_t>(ring.n_buffered());
+            return;
+        }
+        unique_lock<mutex> l(inputMut);
+        if(!make_room(l)) return;
+        datq.push_back(std::forward<U>(o));
+        qprof.depth(datq.size() - dq0);
+        mem.set_items<Tmut_t>(datq.size() - dq0);
+        inputReady.notify_one();
+        sched_yield();
+    }
+
+    /// copy (or move, with move_iterator) batch to queue
+    template<typename It>
+    void _push_batch(It o, size_t n) {
+        if(ring.capacity()) {
+            while(n--) ring_push(*o++);
+            ring_notify();
+            qprof.depth(ring.n_buffered());
+            mem.set_items<Tmut_t>(ring.n_buffered());
+            return;
+        }
+        unique_lock<mutex> l(inputMut);
+        if(maxQueue) { while(n--) { if(make_room(l)) datq.push_back(*o); ++o; } }
+        else datq.insert(datq.end(), o, o+n);
+        qprof.depth(datq.size() - dq0);
+        mem.set_items<Tmut_t>(datq.size() - dq0);
+        inputReady.notify_one();
+    }
+
+    /// add item to ring, waiting for space if full
+    template<typename U>
+    void ring_push(U&& o) {
+        unsigned int nwait = 0;
+        while(!ring.try_push(std::forward<U>(o))) {
+            if(overflow == OVERFLOW_SAMPLE) { ++ndropped; return; }
+            if(runstat == IDLE) { // no reader thread: process here
+                while(ring.pop_batch(datq, maxBatch)) this->nextBatch(datq);
+                continue;
+            }
+            if(waitPolicy.idle(++nwait)) usleep(int(1e6*waitPolicy.park_s));
+        }
+    }
+
+    /// wake parked reader thread
+    void ring_notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // publish before checking parked
+        if(parked.load()) {
+            lock_guard<mutex> l(inputMut);
+            inputReady.notify_one();
+        }
+    }
+
+    /// ring-mode reader thread: batch dequeue, spin-then-park when idle
+    void ring_threadjob() {
+        vector<Tmut_t> datq2;
+        unsigned int nidle = 0;
+
+        while(true) {
+            check_pause();
+
+            busy = true;
+            if(ring.pop_batch(datq2, maxBatch)) {
+                mem.set_items<Tmut_t>(ring.n_buffered());
+                nidle = 0;
+                this->nextBatch(datq2);
+                busy = false;
+                continue;
+            }
+            busy = false;
+            if(!waitPolicy.idle(++nidle)) continue;
+
+            unique_lock<mutex> lk(inputMut);
+            if(runstat == STOP_REQUESTED) break;
+            if(runstat == PAUSE_REQUESTED) continue;
+            parked = true;
+            if(ring.empty()) inputReady.wait_for(lk, waitPolicy.park_time());
+            parked = false;
+        }
+
+        while(ring.pop_batch(datq2, maxBatch)) this->nextBatch(datq2);
+    }
 };
 
 #endif
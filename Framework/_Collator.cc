@@ -21,6 +21,11 @@ void _Collator::change_required(size_t nI, int i) {
     n -= i;
 }
 
+void _Collator::setEngine(engine_t e) {
+    for(auto& n: input_n) if(n.first + n.second) throw std::logic_error("Collator engine changed with items in queue");
+    engine = e;
+}
+
 void _Collator::reset() {
     signal(DATASTREAM_FLUSH);
     inputs_waiting = 0;
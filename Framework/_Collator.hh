@@ -11,10 +11,21 @@
 #include <vector>
 using std::vector;
 #include <utility> // for std::pair
+#include <functional>
 
 /// Type-independent re-casting base
 class _Collator: public Threadworker, virtual public _SinkUser, public SignalSink {
 public:
+    /// collation queue implementation
+    enum engine_t {
+        COLLATE_HEAP        = 0,    ///< single priority queue of all buffered items
+        COLLATE_TOURNAMENT  = 1     ///< per-input FIFOs merged by tournament tree
+    };
+    /// select collation queue implementation (before pushing any items)
+    void setEngine(engine_t e);
+    /// get collation queue implementation
+    engine_t getEngine() const { return engine; }
+
     /// add enumerated input slot (return enumeration number)
     size_t add_input(int nreq = 0);
     /// connect SinkUser as input
@@ -22,6 +33,19 @@ public:
         throw std::logic_error("Type-specific subclass required to connect inputs");
     }
 
+    /// connect SinkUser as input pushed from fiber task; return input enumeration
+    virtual size_t connect_fiber_input(_SinkUser&, int /* nreq */ = 0) {
+        throw std::logic_error("FiberCollator subclass required to connect fiber inputs");
+    }
+    /// add task feeding input nI, to run as fiber in run_fibers()
+    virtual void add_fiber_task(size_t /* nI */, const std::function<void()>&) {
+        throw std::logic_error("FiberCollator subclass required for fiber tasks");
+    }
+    /// run fiber tasks in calling thread until all complete; then flush
+    virtual void run_fibers() { throw std::logic_error("FiberCollator subclass required for fiber tasks"); }
+    /// flush all queued items and signal DATASTREAM_FLUSH downstream, from the running collator thread; blocks until done
+    virtual void flush_thread() { throw std::logic_error("Type-specific subclass required for thread flush"); }
+
     /// change minimum number required from input
     void change_required(size_t nI, int i);
     /// get requirement threshold for input
@@ -42,6 +66,7 @@ public:
     void signal(datastream_signal_t) override { }
 
 protected:
+    engine_t engine = COLLATE_HEAP; ///< collation queue implementation
     int inputs_waiting = 0; ///< number of inputs with input_n.first <= 0
 
     /// counter for (required number, waiting threshold) of datapoints from each input
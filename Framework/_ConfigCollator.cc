@@ -4,7 +4,9 @@
 
 void _ConfigCollator::run() {
     if(!Cfg.exists("prev")) throw std::runtime_error("Collator requires prev: input chain");
-    if(nthreads <= 0) run_singlethread();
+    if(fibers) run_fibermode();
+    else if(nthreads <= 0) run_singlethread();
+    else if(persistent) run_persistent();
     else run_multithread();
 }
 
@@ -23,6 +25,8 @@ void _ConfigCollator::run_multithread() {
         auto C = constructCfgObj<Configurable>(Cfg["prev"], "");
         if(!chains.size()) { C0 = C; tryAdd(C0); }
         chains.push_back(new ConfigThreadWrapper(C, i));
+        chains.back()->ownsWrapped = false;
+        chains.back()->placement = chainPlacement;
         connect_input(*_find_lastSink(C));
     }
 
@@ -41,3 +45,65 @@ void _ConfigCollator::run_multithread() {
     }
     sigNext(DATASTREAM_END);
 }
+
+void _ConfigCollator::run_persistent() {
+    if(!pchains.size()) {
+        if(Cfg.exists("next") && !_getNext()) createOutput(Cfg["next"]);
+        for(int i = 0; i < nthreads; ++i) {
+            auto C = constructCfgObj<Configurable>(Cfg["prev"], "");
+            if(!pchains.size()) { C0 = C; tryAdd(C0); }
+            pchains.push_back(new PersistentConfigThread(C, i));
+            pchains.back()->ownsWrapped = C != C0;
+            pchains.back()->placement = chainPlacement;
+            connect_input(*_find_lastSink(C));
+        }
+        this->launch_mythread();
+        for(auto c: pchains) c->launch_mythread();
+        printf("Launched %zu persistent collation threads.\n", pchains.size());
+    } else {
+        // reset input chains and downstream for new segment
+        for(auto c: pchains) {
+            auto u = dynamic_cast<_SinkUser*>(c->C);
+            if(u) u->sigNext(DATASTREAM_REINIT);
+        }
+        sigNext(DATASTREAM_REINIT);
+    }
+
+    sigNext(DATASTREAM_START);
+    for(auto c: pchains) c->start_segment();
+    for(auto c: pchains) c->wait_segment();
+    flush_thread();
+    ++nSegments;
+}
+
+void _ConfigCollator::finish_persistent() {
+    if(!pchains.size()) return;
+    for(auto c: pchains) c->finish_mythread();
+    this->finish_mythread();
+    for(auto c: pchains) delete c;
+    pchains.clear();
+    printf("Persistent collation threads complete after %zu segments.\n", nSegments);
+    sigNext(DATASTREAM_END);
+}
+
+void _ConfigCollator::run_fibermode() {
+    if(Cfg.exists("next")) createOutput(Cfg["next"]);
+
+    auto& P = Cfg["prev"];
+    int n = P.isList()? P.getLength() : std::max(nthreads, 1);
+    vector<Configurable*> chains;
+    for(int i = 0; i < n; ++i) {
+        auto C = constructCfgObj<Configurable>(P.isList()? P[i] : P, "");
+        if(!chains.size()) { C0 = C; tryAdd(C0); }
+        chains.push_back(C);
+        add_fiber_task(connect_fiber_input(*_find_lastSink(C)), [C] { C->run(); });
+    }
+
+    sigNext(DATASTREAM_START);
+    printf("Running %i collated input fibers...\n", n);
+    run_fibers();
+    printf("Collation fibers all complete.\n");
+
+    for(auto C: chains) if(C != C0) delete C;
+    sigNext(DATASTREAM_END);
+}
@@ -17,16 +17,38 @@ public:
     Configurable(S), XMLProvider("Collator"), nthreads(std::thread::hardware_concurrency()) {
         S.lookupValue("nthreads", nthreads);
         optionalGlobalArg("nParallel", nthreads, "number of parallel collated processes (0 for single-threaded)");
+        string eng = "heap";
+        S.lookupValue("engine", eng);
+        optionalGlobalArg("collateEngine", eng, "collation queue engine, 'heap' or 'tournament'");
+        S.lookupValue("fibers", fibers);
+        S.lookupValue("persistent", persistent);
+        if(wasArgGiven("collateFibers", "run collated input chains as fibers in one thread")) fibers = true;
+        if(eng == "tournament") setEngine(COLLATE_TOURNAMENT);
+        else if(eng != "heap") throw std::runtime_error("Unknown collator engine '" + eng + "'");
+        configurePlacement(placement, S, "collator_affinity");
+        configurePlacement(chainPlacement, S);
     }
 
-    /// Destructor
+    /// Destructor (type-specific subclass must finish_persistent() first)
     ~_ConfigCollator() { delete C0; }
 
     int nthreads;               ///< number of separate input threads (0 for single-threaded)
     Configurable* C0 = nullptr; ///< representative input chain head
+    bool fibers = false;        ///< run input chains as fibers in one thread (one per prev list entry, or nthreads copies)
+    ThreadPlacement chainPlacement; ///< CPU placement for input chain threads
+    bool persistent = false;    ///< keep input threads and chains alive between run() segments
+    size_t nSegments = 0;       ///< number of persistent-mode segments run
 
     /// XML output info
-    void _makeXML(XMLTag& X) override { X.addAttr("nparallel", nthreads); }
+    void _makeXML(XMLTag& X) override {
+        X.addAttr("nparallel", nthreads);
+        X.addAttr("engine", engine == COLLATE_TOURNAMENT? "tournament" : "heap");
+        if(fibers) X.addAttr("fibers", "true");
+        if(persistent) X.addAttr("segments", nSegments);
+        if(chainPlacement.mode) X.addAttr("affinity", chainPlacement.describe());
+        if(placement.mode) X.addAttr("collator_affinity", placement.describe());
+        if(boundCPUs().size()) X.addAttr("collator_cpus", cpulist_str(boundCPUs()));
+    }
 
     /// Run as top-level object
     void run() override;
@@ -34,6 +56,15 @@ public:
     void run_singlethread();
     /// multi-threaded collating mode (only works in type-specific subclass!)
     void run_multithread();
+    /// fiber-scheduled collating mode, in calling thread (only works in type-specific subclass!)
+    void run_fibermode();
+    /// multi-threaded collating mode for one segment, re-using threads and chains from previous segments
+    void run_persistent();
+    /// stop persistent-mode threads, delete their chains, and signal DATASTREAM_END
+    void finish_persistent();
+
+protected:
+    vector<PersistentConfigThread*> pchains;    ///< persistent-mode input chain threads
 };
 
 #endif
@@ -1,11 +1,19 @@
 /// \file _ConfigParallel.cc
 
 #include "ConfigParallel.hh"
+#include "WorkStealingPool.hh"
 
 _ConfigParallel::_ConfigParallel(const Setting& S):
 Configurable(S), XMLProvider("Parallel"), nparallel(std::thread::hardware_concurrency()) {
     Cfg.lookupValue("nthreads", nparallel);
     optionalGlobalArg("nParallel", nparallel, "number of parallel chains");
+    Cfg.lookupValue("ringsize", ringsize);
+    optionalGlobalArg("ringsize", ringsize, "lock-free input ring capacity per parallel chain (0 for mutex FIFO)");
+    Cfg.lookupValue("poolthreads", poolthreads);
+    optionalGlobalArg("poolThreads", poolthreads, "work-stealing pool size for parallel chains (-1 for all cores)");
+    Cfg.lookupValue("pinthreads", pinthreads);
+    Cfg.lookupValue("shard", sharded);
+    configurePlacement(chainPlacement, Cfg);
 }
 
 void _ConfigParallel::makeCollator() {
@@ -27,6 +35,7 @@ void _ConfigParallel::run() {
         int nth = nparallel;
         do {
             auto CT = new ConfigThreadWrapper(constructCfgObj<Configurable>(Cfg["parallel"], ""), --nth);
+            CT->placement = chainPlacement;
             add_thread(CT);
             if(Cfg.exists("next")) vends.push_back(_find_lastSink(CT->C));
             if(!keep_me) {
@@ -46,7 +55,12 @@ void _ConfigParallel::run() {
         purge_pending();
     } else {
         if(myColl) myColl->launch_mythread();
-        run_here();
+        if(poolthreads) {
+            WorkStealingPool P(std::max(poolthreads, 0), pinthreads);
+            pool = &P;
+            run_here();
+            pool = nullptr;
+        } else run_here();
         if(myColl) myColl->finish_mythread();
     }
 }
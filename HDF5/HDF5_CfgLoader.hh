@@ -8,10 +8,15 @@
 #include "ConfigFactory.hh"
 #include "AnalysisStep.hh"
 #include "ProgressBar.hh"
+#include "PrefetchSource.hh"
+#include "Checkpoint.hh"
+#include "MemoryBudget.hh"
+#include "MPIBinaryIO.hh"
 
 /// Scan generic data from HDF5 file
 template<typename T>
-class HDF5_CfgLoader: public Configurable, public HDF5_TableInput<T>, virtual public XMLProvider, public SinkUser<const T> {
+class HDF5_CfgLoader: public Configurable, public HDF5_TableInput<T>, virtual public XMLProvider, public SinkUser<const T>,
+public Checkpointable {
 public:
     using SinkUser<const T>::nextSink;
     using HDF5_TableInput<T>::nLoad;
@@ -24,6 +29,21 @@ public:
         S.lookupValue("nLoad", nLoad);
         optionalGlobalArg("nload", nLoad, "entry loading limit");
         S.lookupValue("eventwise", eventwise);
+        S.lookupValue("eventgroups", eventgroups);
+        S.lookupValue("prefetch", prefetch);
+        S.lookupValue("checkpoint", ckpt.fname);
+        optionalGlobalArg("checkpoint", ckpt.fname, "checkpoint file for restartable run");
+        S.lookupValue("checkpoint_every", ckpt_every);
+        optionalGlobalArg("checkpoint_every", ckpt_every, "rows between checkpoints");
+        string ckz;
+        S.lookupValue("checkpoint_compress", ckz);
+        optionalGlobalArg("checkpoint_compress", ckz, "checkpoint compression codec (none, zlib, zstd, lz4)");
+        if(ckz.size()) ckpt.codec = codec_named(ckz);
+        optionalGlobalArg("h5prefetch", prefetch, "number of HDF5 input chunks to read ahead in background thread");
+        S.lookupValue("align_chunks", this->alignDisk);
+        S.lookupValue("mmap", this->useMmap);
+        configureCache(S, this->cache);
+        MemoryBudget::global().configure(S);
 
         if(farg.size()){
             auto& fn = requiredGlobalArg(farg);
@@ -43,30 +63,118 @@ public:
 
         nextSink->signal(DATASTREAM_INIT);
 
+        // resume from previous checkpoint
+        size_t nread = 0;
+        if(ckpt.fname.size() && ckpt.exists()) {
+            nread = ckpt.restore(*nextSink, this);
+            printf("Resuming from checkpoint '%s' at row %zu\n", ckpt.fname.c_str(), nread);
+        }
+
         auto fRows = this->getNRows();
         if(nLoad >= 0 && hsize_t(nLoad) < fRows) fRows = nLoad;
         {
+            // optional background read-ahead (requires thread-safe HDF5 build if also writing HDF5 in this process)
+            PrefetchSource<T> PF(*this, this->nchunk, std::max(prefetch, 1));
+            DataSource<T>& src = prefetch > 0? static_cast<DataSource<T>&>(PF) : *this;
+            if(nread && !src.skip(nread)) throw std::runtime_error("Checkpoint position beyond end of input");
+
+            // synchronous reads push blocks directly from read cache; prefetched rows one at a time
             T P;
-            ProgressBar PB(fRows);
-            while(this->next(P) && !++PB) {
-                if(eventwise) {
-                    auto idP = getIdentifier(P);
-                    if(idP != id_current_evt) {
-                        nextSink->signal(DATASTREAM_FLUSH);
-                        id_current_evt = idP;
-                    }
-                }
-                nextSink->push(P);
+            const T* p = &P;
+            size_t n = 0, nrows = 0;
+            auto& MB = MemoryBudget::global();
+            ProgressTask PT(fRows); // aggregated with any parallel loaders in ProgressMeter::global()
+            while(nrows < fRows && (n = prefetch > 0? size_t(PF.next(P)) : this->next_block(p, fRows - nrows))) {
+                pushRows(p, n);
+                PT.increment(n);
+                if((nrows + n)/throttle_every != nrows/throttle_every) MB.throttle(); // backpressure from buffered downstream stages
+                nrows += n;
+                // checkpoint at last row pushed downstream (excluding partial event group held back)
+                if(ckpt_every > 0 && ckpt.fname.size() && (nread + n)/ckpt_every != nread/ckpt_every) ckpt.save(nread + n - group.size(), *nextSink, this);
+                nread += n;
             }
         }
+        if(group.size()) nextSink->push_group(group.data(), group.size());
+        group.clear();
 
         nextSink->signal(DATASTREAM_FLUSH);
         nextSink->signal(DATASTREAM_END);
+        ckpt.remove();
+
+        cstats = this->getCacheStats();
+        if(cstats.mdc_hit_rate >= 0) printf("HDF5 metadata cache hit rate %.3f (%zu bytes)\n", cstats.mdc_hit_rate, cstats.mdc_size);
+        if(cstats.page_access[1]) printf("HDF5 page buffer raw data hits %u / %u\n", cstats.page_hits[1], cstats.page_access[1]);
+    }
+
+    /// load HDF5 access cache settings from config and global args
+    static void configureCache(const Setting& S, HDF5_Cache_Settings& C) {
+        double cMB = C.chunk_bytes/double(1 << 20), pMB = C.page_bytes/double(1 << 20), mMB = C.mdc_bytes/double(1 << 20);
+        int slots = C.chunk_slots;
+        S.lookupValue("chunk_cache_MB", cMB);
+        optionalGlobalArg("h5cache_MB", cMB, "HDF5 raw data chunk cache size per dataset [MiB]");
+        S.lookupValue("chunk_cache_slots", slots);
+        optionalGlobalArg("h5cache_slots", slots, "HDF5 chunk cache hash slots (prime)");
+        S.lookupValue("chunk_cache_w0", C.w0);
+        optionalGlobalArg("h5cache_w0", C.w0, "HDF5 chunk cache preemption weight for fully-read chunks [0,1]");
+        S.lookupValue("page_buffer_MB", pMB);
+        optionalGlobalArg("h5pagebuf_MB", pMB, "HDF5 page buffer size [MiB]");
+        S.lookupValue("mdc_MB", mMB);
+        optionalGlobalArg("h5mdc_MB", mMB, "HDF5 initial metadata cache size [MiB]");
+        C.chunk_bytes = std::max(cMB, 0.)*(1 << 20);
+        C.chunk_slots = std::max(slots, 0);
+        C.page_bytes = std::max(pMB, 0.)*(1 << 20);
+        C.mdc_bytes = std::max(mMB, 0.)*(1 << 20);
+    }
+
+    /// push block of rows, flushing between events if eventwise, or as event groups if eventgroups
+    void pushRows(const T* p, size_t n) {
+        if(eventgroups) { pushGroups(p, n); return; }
+        if(!eventwise) { nextSink->push_batch(p, n); return; }
+        size_t i0 = 0;
+        for(size_t i = 0; i < n; ++i) {
+            auto idP = getIdentifier(p[i]);
+            if(idP == id_current_evt) continue;
+            if(i > i0) nextSink->push_batch(p + i0, i - i0);
+            nextSink->signal(DATASTREAM_FLUSH);
+            id_current_evt = idP;
+            i0 = i;
+        }
+        if(n > i0) nextSink->push_batch(p + i0, n - i0);
     }
 
+    /// push complete event groups directly from block; copy only group continuing into next block
+    void pushGroups(const T* p, size_t n) {
+        size_t i0 = 0;
+        for(size_t i = 0; i < n; ++i) {
+            auto idP = getIdentifier(p[i]);
+            if(idP == id_current_evt) continue;
+            if(group.size()) {
+                group.insert(group.end(), p + i0, p + i);
+                nextSink->push_group(group.data(), group.size());
+                group.clear();
+            } else if(i > i0) nextSink->push_group(p + i0, i - i0);
+            id_current_evt = idP;
+            i0 = i;
+        }
+        group.insert(group.end(), p + i0, p + n);
+    }
+
+    /// save reader event state for checkpoint
+    void saveState(BinaryWriter& W) override { W.send(id_current_evt); }
+    /// restore reader event state from checkpoint
+    void loadState(BinaryReader& R) override { R.receive(id_current_evt); }
+
     bool eventwise = false; ///< whether to flush on event number changes
+    bool eventgroups = false;   ///< whether to push each event's rows as one group (without flushes)
+    int prefetch = 0;       ///< number of chunks to read ahead in background thread (0 for synchronous reads)
+    StreamCheckpointFile ckpt;  ///< optional checkpoint file for restarts
+    int ckpt_every = 0;     ///< rows between checkpoints (0 for none)
+    size_t throttle_every = 1024;   ///< rows between memory budget checks
+    HDF5_Cache_Stats cstats;        ///< input cache statistics at end of run
 
 protected:
+    vector<T> group;        ///< event group rows held across block boundary
+
     /// configure nextSink
     void makeNext(const Setting& S) {
         if(S.exists("next")) this->createOutput(S["next"]);
@@ -83,6 +191,26 @@ protected:
         X.addAttr("nRows", this->getNRows());
         if(nLoad >= 0) X.addAttr("nLoad", nLoad);
         if(eventwise) X.addAttr("eventwise", "true");
+        if(eventgroups) X.addAttr("eventgroups", "true");
+        if(prefetch > 0) X.addAttr("prefetch", prefetch);
+        X.addAttr("nchunk", this->getNChunk());
+        if(this->isMapped()) X.addAttr("mmap", "true");
+        if(ckpt_every > 0) X.addAttr("checkpoint_every", ckpt_every);
+        if(ckpt_every > 0 && ckpt.codec != CODEC_NONE) X.addAttr("checkpoint_codec", int(ckpt.codec));
+        if(this->cache.chunk_bytes) X.addAttr("chunk_cache_MB", this->cache.chunk_bytes/double(1 << 20));
+        if(this->cache.chunk_slots) X.addAttr("chunk_cache_slots", this->cache.chunk_slots);
+        if(this->cache.w0 >= 0) X.addAttr("chunk_cache_w0", this->cache.w0);
+        if(this->cache.page_bytes) X.addAttr("page_buffer_MB", this->cache.page_bytes/double(1 << 20));
+        if(cstats.mdc_hit_rate >= 0) X.addAttr("mdc_hit_rate", cstats.mdc_hit_rate);
+        if(cstats.page_access[0] + cstats.page_access[1]) {
+            auto P = X.addChild(new XMLTag("pagebuf"));
+            P->oneline = true;
+            P->addAttr("meta_access", cstats.page_access[0]);
+            P->addAttr("meta_hits", cstats.page_hits[0]);
+            P->addAttr("raw_access", cstats.page_access[1]);
+            P->addAttr("raw_hits", cstats.page_hits[1]);
+        }
+        MemoryBudget::global().addXML(X);
     }
 };
 
@@ -91,7 +219,21 @@ template<typename T>
 class HDF5_CfgWriter: public HDF5_TableOutput<T>, virtual public XMLProvider {
 public:
     /// Constructor
-    explicit HDF5_CfgWriter(const Setting&, const string& farg = ""): XMLProvider("HDF5_CfgWriter") {
+    explicit HDF5_CfgWriter(const Setting& S, const string& farg = ""): XMLProvider("HDF5_CfgWriter") {
+        bool a = false;
+        S.lookupValue("async", a);
+        this->setAsync(a);
+        S.lookupValue("index", this->writeIndex);
+        bool par = false;
+        S.lookupValue("parallel", par);
+        if(par) {
+#ifdef HDF5_PARALLEL
+            if(MPIBinaryIO::workerComm == MPI_COMM_NULL) throw std::logic_error("Parallel HDF5 output requires MPI worker rank");
+            this->setComm(MPIBinaryIO::workerComm);
+#else
+            throw std::logic_error("Parallel HDF5 support disabled!");
+#endif
+        }
         if(!farg.size()) return;
         const auto& fn = requiredGlobalArg(farg, "output .h5 file");
         this->openOutput(fn);
@@ -104,6 +246,8 @@ protected:
     /// build XML output data
     void _makeXML(XMLTag& X) override {
         X.addAttr("nWritten", this->getNWrite());
+        if(this->getAsync()) X.addAttr("tWait_s", this->getWaitTime());
+        if(this->isParallel()) X.addAttr("parallel", "true");
     }
 };
 
@@ -0,0 +1,167 @@
+/// \file HDF5_ColumnIO.cc
+
+#include "HDF5_ColumnIO.hh"
+#include <cstring>
+#include <stdexcept>
+
+HDF5_Column_Filter HDF5_Column_Filter::bitshuffle() {
+    HDF5_Column_Filter F;
+    F.shuffle = false;
+    F.deflate = 0;
+    F.plugin = 32008;
+    F.cd = {0, 2}; // automatic block size; LZ4 compression
+    return F;
+}
+
+HDF5_Column_Filter HDF5_Column_Filter::none() {
+    HDF5_Column_Filter F;
+    F.shuffle = false;
+    F.deflate = 0;
+    return F;
+}
+
+size_t HDF5_Column_Base::fieldIndex(const string& fname) const {
+    for(size_t i = 0; i < Tspec.n_fields; ++i) if(fname == Tspec.field_names[i]) return i;
+    throw std::runtime_error("Table '" + Tspec.table_name + "' has no field '" + fname + "'");
+}
+
+/// close datasets (caller holds HDF5_mutex())
+static void closeDatasets(vector<hid_t>& v) {
+    for(auto d: v) if(d > 0) H5Dclose(d);
+    v.clear();
+}
+
+void HDF5_Column_Base::closeColumns() {
+    if(!dsets.size()) return;
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+    closeDatasets(dsets);
+    nColRows = 0;
+}
+
+void HDF5_Column_Base::createColumns(hid_t f, hsize_t nchunk, const map<string, HDF5_Column_Filter>& filters) {
+    closeColumns();
+    if(!f) throw std::runtime_error("No HDF5 output file specified");
+    printf("Setting up '%s' columns...\n", Tspec.table_name.c_str());
+
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+    auto g = H5Gcreate2(f, Tspec.table_name.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    if(g < 0) throw std::runtime_error("Error creating HDF5 group '" + Tspec.table_name + "'");
+
+    HDF5_Column_Filter F0;
+    auto it = filters.find("");
+    if(it != filters.end()) F0 = it->second;
+    hsize_t d0 = 0, dmax = H5S_UNLIMITED, ch = std::max(nchunk, hsize_t(1));
+
+    for(size_t i = 0; i < Tspec.n_fields; ++i) {
+        auto itf = filters.find(Tspec.field_names[i]);
+        const auto& F = itf == filters.end()? F0 : itf->second;
+
+        auto pl = H5Pcreate(H5P_DATASET_CREATE);
+        H5Pset_chunk(pl, 1, &ch);
+        if(F.shuffle) H5Pset_shuffle(pl);
+        if(F.plugin) {
+            if(H5Zfilter_avail(F.plugin) > 0) H5Pset_filter(pl, F.plugin, H5Z_FLAG_OPTIONAL, F.cd.size(), F.cd.data());
+            else printf("Warning: HDF5 filter %i unavailable; '%s' column not filtered.\n", int(F.plugin), Tspec.field_names[i]);
+        }
+        if(F.deflate > 0) H5Pset_deflate(pl, F.deflate);
+
+        auto sp = H5Screate_simple(1, &d0, &dmax);
+        auto d = H5Dcreate2(g, Tspec.field_names[i], Tspec.field_types[i], sp, H5P_DEFAULT, pl, H5P_DEFAULT);
+        H5Sclose(sp);
+        H5Pclose(pl);
+        if(d < 0) {
+            closeDatasets(dsets);
+            H5Gclose(g);
+            throw std::runtime_error("Error creating HDF5 column '" + Tspec.table_name + "/" + Tspec.field_names[i] + "'");
+        }
+        dsets.push_back(d);
+    }
+    H5Gclose(g);
+    nColRows = 0;
+}
+
+hsize_t HDF5_Column_Base::openColumns(hid_t f, const vector<bool>& sel) {
+    closeColumns();
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+    if(H5Lexists(f, Tspec.table_name.c_str(), H5P_DEFAULT) <= 0) {
+        printf("Warning: columns '%s' not present in file.\n", Tspec.table_name.c_str());
+        return 0;
+    }
+    auto g = H5Gopen2(f, Tspec.table_name.c_str(), H5P_DEFAULT);
+    if(g < 0) throw std::runtime_error("Error opening HDF5 group '" + Tspec.table_name + "'");
+
+    dsets.assign(Tspec.n_fields, 0);
+    bool first = true;
+    for(size_t i = 0; i < Tspec.n_fields; ++i) {
+        if(sel.size() && !sel[i]) continue;
+        auto d = H5Dopen2(g, Tspec.field_names[i], H5P_DEFAULT);
+        if(d < 0) {
+            closeDatasets(dsets);
+            H5Gclose(g);
+            throw std::runtime_error("Missing HDF5 column '" + Tspec.table_name + "/" + Tspec.field_names[i] + "'");
+        }
+        dsets[i] = d;
+
+        hsize_t n = 0;
+        auto sp = H5Dget_space(d);
+        H5Sget_simple_extent_dims(sp, &n, nullptr);
+        H5Sclose(sp);
+        if(first || n < nColRows) nColRows = n;
+        first = false;
+    }
+    H5Gclose(g);
+    return nColRows;
+}
+
+/// copy n fs-byte elements between strided locations
+static void strided_copy(char* d, size_t ds, const char* s, size_t ss, size_t n, size_t fs) {
+    switch(fs) { // fixed-size copies for common field sizes
+        case 4: for(size_t j = 0; j < n; ++j) std::memcpy(d + j*ds, s + j*ss, 4); return;
+        case 8: for(size_t j = 0; j < n; ++j) std::memcpy(d + j*ds, s + j*ss, 8); return;
+        default: for(size_t j = 0; j < n; ++j) std::memcpy(d + j*ds, s + j*ss, fs);
+    }
+}
+
+void HDF5_Column_Base::writeRows(const void* rows, hsize_t n) {
+    if(!n) return;
+    auto r = static_cast<const char*>(rows);
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+    hsize_t n1 = nColRows + n;
+    for(size_t i = 0; i < dsets.size(); ++i) {
+        auto fs = Tspec.field_sizes[i];
+        colbuf.resize(n*fs);
+        strided_copy(colbuf.data(), fs, r + Tspec.offsets[i], Tspec.struct_size, n, fs);
+
+        if(H5Dset_extent(dsets[i], &n1) < 0) throw std::runtime_error("Failed to extend HDF5 column '" + string(Tspec.field_names[i]) + "'");
+        auto fsp = H5Dget_space(dsets[i]);
+        H5Sselect_hyperslab(fsp, H5S_SELECT_SET, &nColRows, nullptr, &n, nullptr);
+        auto msp = H5Screate_simple(1, &n, nullptr);
+        herr_t err = H5Dwrite(dsets[i], Tspec.field_types[i], msp, fsp, H5P_DEFAULT, colbuf.data());
+        H5Sclose(msp);
+        H5Sclose(fsp);
+        if(err < 0) throw std::runtime_error("Failed to write HDF5 column '" + string(Tspec.field_names[i]) + "'");
+    }
+    nColRows = n1;
+}
+
+void HDF5_Column_Base::readRows(void* rows, hsize_t n0, hsize_t n) {
+    if(!n) return;
+    if(n0 + n > nColRows) throw std::range_error("Read past end of HDF5 columns");
+    auto r = static_cast<char*>(rows);
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+    for(size_t i = 0; i < dsets.size(); ++i) {
+        if(!dsets[i]) continue;
+        auto fs = Tspec.field_sizes[i];
+        colbuf.resize(n*fs);
+
+        auto fsp = H5Dget_space(dsets[i]);
+        H5Sselect_hyperslab(fsp, H5S_SELECT_SET, &n0, nullptr, &n, nullptr);
+        auto msp = H5Screate_simple(1, &n, nullptr);
+        herr_t err = H5Dread(dsets[i], Tspec.field_types[i], msp, fsp, H5P_DEFAULT, colbuf.data());
+        H5Sclose(msp);
+        H5Sclose(fsp);
+        if(err < 0) throw std::runtime_error("Failed to read HDF5 column '" + string(Tspec.field_names[i]) + "'");
+
+        strided_copy(r + Tspec.offsets[i], Tspec.struct_size, colbuf.data(), fs, n, fs);
+    }
+}
@@ -0,0 +1,214 @@
+/// \file HDF5_ColumnIO.hh Columnar (one chunked dataset per field) HDF5 table storage, for partial-column reads
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef HDF5_COLUMNIO_HH
+#define HDF5_COLUMNIO_HH
+
+#include "HDF5_IO.hh"
+#include <map>
+#include <vector>
+using std::map;
+using std::vector;
+
+/// per-column HDF5 compression filter settings
+struct HDF5_Column_Filter {
+    bool shuffle = true;        ///< byte shuffle before compression
+    int deflate = 6;            ///< gzip deflate level (0 for none)
+    H5Z_filter_t plugin = 0;    ///< additional registered filter ID (0 for none)
+    vector<unsigned int> cd;    ///< plugin filter parameters
+    /// bitshuffle + LZ4 filter (HDF5 plugin 32008), in place of shuffle+deflate
+    static HDF5_Column_Filter bitshuffle();
+    /// no filtering
+    static HDF5_Column_Filter none();
+};
+
+/// Type-independent columnar table layout: group named Tspec.table_name, holding one 1-D dataset per field
+class HDF5_Column_Base {
+public:
+    /// Constructor
+    explicit HDF5_Column_Base(const HDF5_Table_Spec& ts): Tspec(ts) { }
+    /// Destructor
+    virtual ~HDF5_Column_Base() { closeColumns(); }
+    /// no copy
+    HDF5_Column_Base(const HDF5_Column_Base&) = delete;
+    /// no assignment
+    HDF5_Column_Base& operator=(const HDF5_Column_Base&) = delete;
+
+    /// field index for name (throws if absent)
+    size_t fieldIndex(const string& fname) const;
+
+    HDF5_Table_Spec Tspec;      ///< struct and table description
+
+protected:
+    /// create group and (extensible, chunked, filtered) column datasets in file
+    void createColumns(hid_t f, hsize_t nchunk, const map<string, HDF5_Column_Filter>& filters);
+    /// open selected (or, if empty, all) existing column datasets; return number of rows
+    hsize_t openColumns(hid_t f, const vector<bool>& sel);
+    /// close open datasets
+    void closeColumns();
+    /// append n struct rows to open columns
+    void writeRows(const void* rows, hsize_t n);
+    /// read n rows starting at n0 of open columns into struct rows (other fields untouched)
+    void readRows(void* rows, hsize_t n0, hsize_t n);
+
+    vector<hid_t> dsets;        ///< open dataset per field (0 if not selected)
+    hsize_t nColRows = 0;       ///< rows in columns
+    vector<char> colbuf;        ///< single-column gather/scatter buffer
+};
+
+/// Columnar HDF5 table writer
+template<typename T>
+class HDF5_Column_Writer: public HDF5_Column_Base, virtual public DataSink<const T> {
+public:
+    /// Constructor, from table specification
+    explicit HDF5_Column_Writer(const HDF5_Table_Spec& ts = HDF5_table_setup<T>(), hsize_t nc = 1024): HDF5_Column_Base(ts), nchunk(nc) { }
+    /// Destructor
+    ~HDF5_Column_Writer() { HDF5_Column_Writer::signal(DATASTREAM_END); }
+
+    /// set filter for named column ("" for default)
+    void setFilter(const string& col, const HDF5_Column_Filter& F) { if(col.size()) fieldIndex(col); filters[col] = F; }
+    /// (re)set output file, creating columns
+    void setFile(hid_t f) {
+        signal(DATASTREAM_FLUSH);
+        closeColumns();
+        if(f) createColumns(f, nchunk, filters);
+    }
+    /// write table row
+    void push(const T& val) override {
+        cached.push_back(val);
+        if(cached.size() >= nchunk) signal(DATASTREAM_FLUSH);
+        nwrite++;
+    }
+    /// get number of rows written
+    hsize_t getNWrite() const { return nwrite; }
+    /// accept data flow signal
+    void signal(datastream_signal_t sig) override {
+        if(sig < DATASTREAM_FLUSH) return;
+        if(dsets.size() && cached.size()) writeRows(cached.data(), cached.size());
+        cached.clear();
+        if(sig >= DATASTREAM_END) closeColumns();
+    }
+
+protected:
+    vector<T> cached;                           ///< cached output rows
+    hsize_t nchunk;                             ///< rows per write (and dataset chunk size)
+    hsize_t nwrite = 0;                         ///< number of rows written
+    map<string, HDF5_Column_Filter> filters;    ///< per-column filter settings
+};
+
+/// Columnar HDF5 table reader, loading only selected fields (others value-initialized)
+template<typename T>
+class HDF5_Column_Reader: public HDF5_Column_Base, virtual public DataSource<T> {
+public:
+    /// Constructor, from table specification
+    explicit HDF5_Column_Reader(const HDF5_Table_Spec& ts = HDF5_table_setup<T>(), hsize_t nc = 1024): HDF5_Column_Base(ts), nchunk(nc) { }
+
+    /// select columns to read (empty for all); applies at next setFile
+    void selectColumns(const vector<string>& cols) {
+        sel.assign(cols.size()? Tspec.n_fields : 0, false);
+        for(auto& c: cols) sel[fieldIndex(c)] = true;
+    }
+    /// (re)set input file
+    void setFile(hid_t f) {
+        _infile_id = f;
+        closeColumns();
+        cached.clear();
+        cache_idx = nread = 0;
+        nRows = f? openColumns(f, sel) : 0;
+    }
+    /// get next table row; return whether successful or failed (end-of-file)
+    bool next(T& val) override {
+        if(!fill()) return false;
+        val = cached[cache_idx++];
+        return true;
+    }
+    /// view next (up to nmax) rows directly in read cache, valid until next read; return number of rows (0 at end-of-file)
+    size_t next_block(const T*& p, size_t nmax = std::numeric_limits<size_t>::max()) {
+        if(!fill()) return 0;
+        auto n = std::min(cached.size() - cache_idx, nmax);
+        p = cached.data() + cache_idx;
+        cache_idx += n;
+        return n;
+    }
+    /// skip ahead number of entries
+    bool skip(size_t n) override {
+        auto r = cached.size() - cache_idx;
+        if(n <= r) { cache_idx += n; return true; }
+        n -= r;
+        cache_idx = 0;
+        cached.clear();
+        if(nread + n > nRows) { nread = nRows; return false; }
+        nread += n;
+        return true;
+    }
+    /// Re-start at beginning of stream
+    void reset() override { setFile(_infile_id); }
+    /// Remaining entries
+    size_t entries() override { return nRows - nread + (cached.size() - cache_idx); }
+    /// get total rows in table
+    hsize_t getNRows() const { return nRows; }
+
+protected:
+    /// refill cache if needed; return false at end of input
+    bool fill() {
+        if(cache_idx < cached.size()) return true;
+        if(nread >= nRows) return false;
+        auto n = std::min(nchunk, nRows - nread);
+        cached.assign(n, T{});
+        cache_idx = 0;
+        readRows(cached.data(), nread, n);
+        nread += n;
+        return true;
+    }
+
+    hid_t _infile_id = 0;   ///< file being read
+    vector<bool> sel;       ///< selected columns (empty for all)
+    vector<T> cached;       ///< cached rows
+    size_t cache_idx = 0;   ///< position in cache
+    hsize_t nchunk;         ///< rows per read
+    hsize_t nread = 0;      ///< rows read from file
+    hsize_t nRows = 0;      ///< rows in file
+};
+
+/// HDF5_InputFile with columnar table
+template<class T>
+class HDF5_ColumnInput: public HDF5_InputFile, public HDF5_Column_Reader<T> {
+public:
+    /// Constructor
+    HDF5_ColumnInput(const string& tname = "", int v = 0, int nch = 1024):
+    HDF5_Column_Reader<T>(HDF5_table_setup<T>(tname, v), nch) { }
+
+    /// Open named input file
+    void openInput(const string& filename) override {
+        this->closeColumns();
+        HDF5_InputFile::openInput(filename);
+        this->setFile(infile_id);
+    }
+};
+
+/// HDF5_OutputFile with columnar table
+template<class T>
+class HDF5_ColumnOutput: public HDF5_OutputFile, public HDF5_Column_Writer<T> {
+public:
+    /// Constructor
+    HDF5_ColumnOutput(const string& tname = "", int v = 0, int nch = 1024):
+    HDF5_Column_Writer<T>(HDF5_table_setup<T>(tname, v), nch) { }
+
+    /// Open named output file
+    void openOutput(const string& filename) override {
+        HDF5_OutputFile::openOutput(filename);
+        this->setFile(outfile_id);
+    }
+    /// Finalize/close file output
+    void writeFile() override {
+        this->setFile(0);
+        HDF5_OutputFile::writeFile();
+    }
+    /// Handle datastream signals
+    void signal(datastream_signal_t sig) override {
+        HDF5_Column_Writer<T>::signal(sig);
+        if(sig == DATASTREAM_END) writeFile();
+    }
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "HDF5_IO.hh"
 #include "PathUtils.hh" // for makePath
 #include <climits>
+#include <algorithm>
 
 void HDF5_InputFile::openInput(const string& filename) {
     if(infile_id) {
@@ -14,10 +15,63 @@ void HDF5_InputFile::openInput(const string& filename) {
     infile_name = filename;
     if(!filename.size()) return;
     printf("Opening HDF5 input file '%s'\n",filename.c_str());
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+
+    // access cache properties
+    auto fapl = H5Pcreate(H5P_FILE_ACCESS);
+    if(cache.chunk_bytes || cache.chunk_slots || cache.w0 >= 0) {
+        int mdc_nelmts;
+        size_t nslots, nbytes;
+        double w0;
+        H5Pget_cache(fapl, &mdc_nelmts, &nslots, &nbytes, &w0);
+        if(cache.chunk_bytes) nbytes = cache.chunk_bytes;
+        if(cache.chunk_slots) nslots = cache.chunk_slots;
+        if(cache.w0 >= 0) w0 = std::min(cache.w0, 1.);
+        H5Pset_cache(fapl, mdc_nelmts, nslots, nbytes, w0);
+    }
+    if(cache.mdc_bytes) {
+        H5AC_cache_config_t C;
+        C.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+        H5Pget_mdc_config(fapl, &C);
+        C.set_initial_size = true;
+        C.initial_size = cache.mdc_bytes;
+        C.max_size = std::max(C.max_size, cache.mdc_bytes);
+        C.min_size = std::min(C.min_size, cache.mdc_bytes);
+        H5Pset_mdc_config(fapl, &C);
+    }
+#if H5_VERSION_GE(1,10,1)
+    if(cache.page_bytes) H5Pset_page_buffer_size(fapl, cache.page_bytes, 0, 0);
+#endif
+
     infile_id = H5Fopen(filename.c_str(), // file name
                         H5F_ACC_RDONLY,   // access_mode : read only
-                        H5P_DEFAULT       // access_ID defaults
+                        fapl              // access_ID with cache settings
     );
+#if H5_VERSION_GE(1,10,1)
+    if(infile_id < 0 && cache.page_bytes) {
+        // page buffering fails on files not written with paged file space strategy
+        printf("Page buffering unavailable for '%s'; re-opening without.\n", filename.c_str());
+        H5Pset_page_buffer_size(fapl, 0, 0, 0);
+        infile_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, fapl);
+    }
+#endif
+    H5Pclose(fapl);
+}
+
+HDF5_Cache_Stats HDF5_InputFile::getCacheStats() const {
+    HDF5_Cache_Stats S;
+    if(!infile_id) return S;
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+    if(H5Fget_mdc_hit_rate(infile_id, &S.mdc_hit_rate) < 0) S.mdc_hit_rate = -1;
+    size_t maxsz, minclean, cursz;
+    int nent;
+    if(H5Fget_mdc_size(infile_id, &maxsz, &minclean, &cursz, &nent) >= 0) S.mdc_size = cursz;
+#if H5_VERSION_GE(1,10,1)
+    unsigned evict[2], bypass[2];
+    if(H5Fget_page_buffering_stats(infile_id, S.page_access, S.page_hits, S.page_misses, evict, bypass) < 0)
+        S = HDF5_Cache_Stats{S.mdc_hit_rate, S.mdc_size, {0, 0}, {0, 0}, {0, 0}};
+#endif
+    return S;
 }
 
 void HDF5_OutputFile::openOutput(const string& filename) {
@@ -25,11 +79,20 @@ void HDF5_OutputFile::openOutput(const string& filename) {
     makePath(filename, true);
     printf("Opening HDF5 output file '%s'.\n", filename.c_str());
     outfile_name = filename;
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+    hid_t fapl = H5P_DEFAULT;
+#ifdef HDF5_PARALLEL
+    if(comm != MPI_COMM_NULL) {
+        fapl = H5Pcreate(H5P_FILE_ACCESS);
+        H5Pset_fapl_mpio(fapl, comm, MPI_INFO_NULL);
+    }
+#endif
     outfile_id = H5Fcreate(outfile_name.c_str(), // file name
                            H5F_ACC_TRUNC, // access_mode : overwrite old file with new data
                            H5P_DEFAULT,   // create_ID defaults
-                           H5P_DEFAULT    // access_ID defaults
+                           fapl           // access_ID (MPI-IO for parallel)
     );
+    if(fapl != H5P_DEFAULT) H5Pclose(fapl);
 }
 
 void HDF5_OutputFile::writeFile() {
@@ -38,6 +101,7 @@ void HDF5_OutputFile::writeFile() {
         return;
     }
     printf("Writing data to HDF5 file '%s' and closing...\n", outfile_name.c_str());
+    std::lock_guard<std::mutex> l(HDF5_mutex());
     H5Fclose(outfile_id);
     outfile_id = 0;
 }
@@ -93,12 +157,14 @@ HDF5_OutputFile::~HDF5_OutputFile() {
 
 void HDF5_OutputFile::writeAttribute(const string& table, const string& attrname, double value) {
     if(!outfile_id) throw std::logic_error("Cannot write attribute " + table + ":" + attrname + " without file");
+    std::lock_guard<std::mutex> l(HDF5_mutex());
     herr_t err = H5LTset_attribute_double(outfile_id, table.c_str(), attrname.c_str(), &value, 1);
     if(err < 0) throw std::runtime_error("H5LTset_attribute_double error setting attribute " + table + ":" + attrname);
 }
 
 void HDF5_OutputFile::writeAttribute(const string& table, const string& attrname, const string& value) {
     if(!outfile_id) throw std::logic_error("Cannot write attribute " + table + ":" + attrname + " without file");
+    std::lock_guard<std::mutex> l(HDF5_mutex());
     herr_t err = H5LTset_attribute_string(outfile_id, table.c_str(), attrname.c_str(), value.c_str());
     if(err < 0) throw std::runtime_error("H5LTset_attribute_string error " + table + ":" + attrname);
 }
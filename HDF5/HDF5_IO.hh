@@ -6,6 +6,24 @@
 
 #include "HDF5_Table_Cache.hh"
 
+/// HDF5 input file access cache settings (0 or negative for library defaults)
+struct HDF5_Cache_Settings {
+    size_t chunk_bytes = 0;     ///< raw data chunk cache size per dataset [bytes] (library default 1 MiB)
+    size_t chunk_slots = 0;     ///< chunk cache hash table slots (prime, ~100x chunks fitting in cache)
+    double w0 = -1;             ///< chunk preemption policy weight for fully-read chunks, in [0,1]
+    size_t page_bytes = 0;      ///< page buffer size [bytes] (files written with paged file space strategy)
+    size_t mdc_bytes = 0;       ///< initial metadata cache size [bytes]
+};
+
+/// HDF5 input file cache statistics (negative or zero when unavailable)
+struct HDF5_Cache_Stats {
+    double mdc_hit_rate = -1;   ///< metadata cache hit rate
+    size_t mdc_size = 0;        ///< metadata cache current size [bytes]
+    unsigned page_access[2] = {0, 0};   ///< page buffer [metadata, raw] accesses
+    unsigned page_hits[2] = {0, 0};     ///< page buffer [metadata, raw] hits
+    unsigned page_misses[2] = {0, 0};   ///< page buffer [metadata, raw] misses
+};
+
 /// base class for HDF5 file input
 class HDF5_InputFile {
 public:
@@ -22,7 +40,10 @@ public:
     double getAttributeD(const string& table, const string& attrname, double dflt);
     /// read string-valued attribute
     string getAttribute(const string& table, const string& attrname, const string& dflt);
+    /// get cache statistics for open input file
+    HDF5_Cache_Stats getCacheStats() const;
 
+    HDF5_Cache_Settings cache;  ///< access cache settings for openInput
     hid_t infile_id = 0;    ///< input HDF5 file ID
     string infile_name = "";///< input HDF5 file name
 };
@@ -63,6 +84,10 @@ public:
     virtual void writeFile();
     /// Whether output file is open
     bool outIsOpen() const { return outfile_id; }
+#ifdef HDF5_PARALLEL
+    /// open subsequent files collectively over communicator with MPI-IO (MPI_COMM_NULL for serial)
+    void setComm(MPI_Comm c) { comm = c; }
+#endif
 
     /// write double-valued attribute
     void writeAttribute(const string& table, const string& attrname, double value);
@@ -71,6 +96,9 @@ public:
 
     string outfile_name;        ///< output filename
     hid_t outfile_id = 0;       ///< output HDF5 file ID
+#ifdef HDF5_PARALLEL
+    MPI_Comm comm = MPI_COMM_NULL;  ///< communicator for parallel file access
+#endif
 };
 
 /// HDF5_OutputFile with specific table
@@ -81,6 +109,11 @@ public:
     HDF5_TableOutput(const string& tname = "", int v = 0, int nch = 1024):
     HDF5_Table_Writer<T>(HDF5_table_setup<T>(tname, v),nch) { }
 
+#ifdef HDF5_PARALLEL
+    /// file access and table appends collective over communicator
+    void setComm(MPI_Comm c) { HDF5_OutputFile::setComm(c); HDF5_Table_Writer<T>::setComm(c); }
+#endif
+
     /// write attributes to this table's name
     template<typename U>
     void writeAttribute(const string& attrname, const U& value) {
@@ -95,6 +128,7 @@ public:
     }
     /// Finalize/close file output
     void writeFile() override {
+        this->waitWrite();
         HDF5_Table_Writer<T>::_outfile_id = 0;
         HDF5_OutputFile::writeFile();
     }
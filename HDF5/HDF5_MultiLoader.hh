@@ -0,0 +1,250 @@
+/// \file HDF5_MultiLoader.hh Configurable parallel multi-file HDF5 table reader, merged through Collator
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef HDF5_MULTILOADER_HH
+#define HDF5_MULTILOADER_HH
+
+#include "HDF5_IO.hh"
+#include "Collator.hh"
+#include "GlobalArgs.hh"
+#include "ConfigFactory.hh"
+#include "AnalysisStep.hh"
+#include "ProgressBar.hh"
+#include "PathUtils.hh"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+/// Collator ordering of HDF5 table rows by getIdentifier()
+template<typename T>
+struct HDF5_EvtOrder {
+    /// Constructor from row
+    HDF5_EvtOrder(const T& o): id(HDF5_Table_Cache<T>::getIdentifier(o)) { }
+    /// comparison
+    bool operator<(const HDF5_EvtOrder& b) const { return id < b.id; }
+    int64_t id; ///< row identifier
+};
+
+/// Read table from many HDF5 files on parallel threads, merging (individually ordered) files through Collator
+template<typename T, typename ordering_t = HDF5_EvtOrder<T>>
+class HDF5_MultiLoader: public Configurable, virtual public XMLProvider, public SinkUser<const T> {
+public:
+    using SinkUser<const T>::nextSink;
+
+    /// Constructor, with table name and version
+    explicit HDF5_MultiLoader(const Setting& S, bool doMakeNext = true, const string& tname = "", int v = 0):
+    XMLProvider("HDF5_MultiLoader"), Configurable(S), tableName(tname), tableVersion(v) {
+        if(S.exists("files")) for(int i = 0; i < S["files"].getLength(); ++i) files.push_back((const char*)S["files"][i]);
+        string g;
+        S.lookupValue("glob", g);
+        optionalGlobalArg("h5glob", g, "wildcard pattern for input .h5 files");
+        if(g.size()) for(auto& f: globFiles(g)) files.push_back(f);
+
+        S.lookupValue("nthreads", nthreads);
+        optionalGlobalArg("h5threads", nthreads, "number of parallel HDF5 file reader threads");
+        S.lookupValue("nLoad", nLoad);
+        S.lookupValue("eventwise", eventwise);
+        S.lookupValue("nchunk", nchunk);
+        S.lookupValue("readahead", readahead);
+        S.lookupValue("align_chunks", alignChunks);
+        S.lookupValue("mmap", useMmap);
+        string eng = "tournament";
+        S.lookupValue("engine", eng);
+        C.setEngine(eng == "heap"? _Collator::COLLATE_HEAP : _Collator::COLLATE_TOURNAMENT);
+
+        if(doMakeNext) makeNext(S);
+    }
+
+    /// Merge all input files to nextSink
+    void run() override {
+        if(!nextSink) throw std::runtime_error("HDF5 multi-file loader 'next' output not configured.");
+        if(!files.size()) throw std::runtime_error("HDF5 multi-file loader run without input files.");
+
+        auto AS = AnalysisStep::instance();
+        size_t totRows = 0;
+        for(auto& f: files) {
+            inputs.emplace_back(new input_t(tableName, tableVersion, nchunk));
+            auto& I = *inputs.back();
+            I.useMmap = useMmap;
+            I.openInput(f);
+            if(nLoad >= 0) I.nLoad = nLoad;
+            if(alignChunks) I.alignChunks();
+            I.nInput = C.add_input();
+            totRows += I.entries();
+            if(AS) AS->infiles.push_back(f);
+        }
+
+        // collator output to nextSink, optionally flushing between events
+        EvtFlush EF(nextSink);
+        C.setNext(eventwise? static_cast<DataSink<const T>*>(&EF) : nextSink);
+        C.setOwnsNext(false);
+
+        auto t0 = std::chrono::steady_clock::now();
+        nextSink->signal(DATASTREAM_INIT);
+        C.launch_mythread();
+        {
+            ProgressTask PT(totRows);
+            std::mutex PTM;
+            vector<std::thread> readers;
+            int nt = std::max(1, std::min(nthreads, int(files.size())));
+            for(int i = 0; i < nt; ++i) readers.emplace_back([this, &PT, &PTM] { readLoop(PT, PTM); });
+            for(auto& t: readers) t.join();
+        }
+        C.finish_mythread();
+        nextSink->signal(DATASTREAM_FLUSH);
+        nextSink->signal(DATASTREAM_END);
+        C.getNext() = nullptr;
+        dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    vector<string> files;   ///< input file names
+    int nthreads = 4;       ///< number of reader threads
+    int nLoad = -1;         ///< per-file entry loading limit (-1 for all)
+    bool eventwise = false; ///< whether to flush on event number changes
+    int nchunk = 1024;      ///< rows per HDF5 read
+    int readahead = 4;      ///< maximum chunks buffered per file while waiting for merge
+    bool alignChunks = false;   ///< whether to round nchunk up to files' on-disk chunk sizes
+    bool useMmap = false;       ///< whether to memory-map eligible (uncompressed, contiguous) input tables
+
+protected:
+    /// one input file
+    struct input_t: public HDF5_TableInput<T> {
+        /// Constructor
+        input_t(const string& tname, int v, int nch): HDF5_TableInput<T>(tname, v, nch) { }
+        size_t nInput = 0;          ///< Collator input number
+        size_t nRead = 0;           ///< rows read
+        double tRead = 0;           ///< time spent reading [s]
+        bool busy = false;          ///< whether being read by a thread
+        bool done = false;          ///< whether all rows read
+    };
+
+    /// Collator with end-of-input marking and queue-depth read scheduling
+    class MergeCollator: public Collator<T, ordering_t> {
+    public:
+        /// choose (and mark busy) unfinished input with fewest queued rows below hiwater; nullptr if none
+        input_t* pick(vector<std::unique_ptr<input_t>>& v, int hiwater) {
+            lock_guard<mutex> l(this->inputMut);
+            input_t* I = nullptr;
+            for(auto& i: v) {
+                if(i->busy || i->done) continue;
+                auto q = this->input_n[i->nInput].first;
+                if(q < hiwater && (!I || q < this->input_n[I->nInput].first)) I = i.get();
+            }
+            if(I) I->busy = true;
+            return I;
+        }
+        /// release input after read; stop waiting on it if finished
+        void release(input_t& I, bool done) {
+            lock_guard<mutex> l(this->inputMut);
+            I.busy = false;
+            I.done = done;
+            if(done) {
+                this->change_required(I.nInput, -1);
+                this->inputReady.notify_one();
+            }
+        }
+        /// whether all inputs are finished
+        bool allDone(const vector<std::unique_ptr<input_t>>& v) {
+            lock_guard<mutex> l(this->inputMut);
+            for(auto& i: v) if(!i->done) return false;
+            return true;
+        }
+    };
+
+    /// flush downstream on event identifier changes in collated stream
+    class EvtFlush: public DataSink<const T> {
+    public:
+        /// Constructor
+        explicit EvtFlush(DataSink<const T>* n): next(n) { }
+        /// push with flush between events
+        void push(const T& o) override {
+            auto i = HDF5_Table_Cache<T>::getIdentifier(o);
+            if(i != id) {
+                next->signal(DATASTREAM_FLUSH);
+                id = i;
+            }
+            next->push(o);
+        }
+        /// forward signals
+        void signal(datastream_signal_t s) override { next->signal(s); }
+    protected:
+        DataSink<const T>* next;    ///< downstream sink
+        int64_t id = -1;            ///< current event identifier
+    };
+
+    /// reader thread: read chunks from the input holding up the merge, until all files are finished
+    void readLoop(ProgressTask& PT, std::mutex& PTM) {
+        while(true) {
+            auto I = C.pick(inputs, readahead*nchunk);
+            if(!I) {
+                if(C.allDone(inputs)) return;
+                usleep(100);
+                continue;
+            }
+
+            // push one read chunk of rows directly from the file's read cache
+            size_t n = 0, m = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            do {
+                const T* p = nullptr;
+                m = I->next_block(p, I->getNChunk() - n); // HDF5 reads serialized on HDF5_mutex()
+                if(m) C.qpush(I->nInput, p, m);
+                n += m;
+            } while(m && n < I->getNChunk());
+            I->tRead += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            I->nRead += n;
+            C.release(*I, !m);
+
+            lock_guard<mutex> l(PTM);
+            PT.increment(n);
+        }
+    }
+
+    /// configure nextSink
+    void makeNext(const Setting& S) {
+        if(S.exists("next")) this->createOutput(S["next"]);
+        else {
+            string nxt;
+            if(optionalGlobalArg("h5next", nxt, "HDF5 reader next output class"))
+                nextSink = BaseFactory<DataSink<const T>>::construct(nxt);
+            tryAdd(nextSink);
+        }
+    }
+
+    /// build XML output data
+    void _makeXML(XMLTag& X) override {
+        size_t nRead = 0;
+        for(auto& I: inputs) nRead += I->nRead;
+        X.addAttr("nFiles", files.size());
+        X.addAttr("nthreads", nthreads);
+        X.addAttr("nchunk", nchunk);
+        X.addAttr("nRead", nRead);
+        if(nLoad >= 0) X.addAttr("nLoad", nLoad);
+        if(eventwise) X.addAttr("eventwise", "true");
+        if(dt > 0) {
+            X.addAttr("t_s", dt);
+            X.addAttr("rows_per_s", nRead/dt);
+            X.addAttr("MB_per_s", 1e-6*nRead*sizeof(T)/dt);
+        }
+        for(auto& I: inputs) {
+            auto F = X.addChild(new XMLTag("file"));
+            F->oneline = true;
+            F->addAttr("name", I->infile_name);
+            F->addAttr("nRows", I->getNRows());
+            F->addAttr("nRead", I->nRead);
+            F->addAttr("tRead_s", I->tRead);
+            if(I->isMapped()) F->addAttr("mmap", "true");
+        }
+        this->C.qprof.addXML(X);
+        this->C.mem.addXML(X);
+    }
+
+    string tableName;       ///< table name
+    int tableVersion;       ///< table version
+    vector<std::unique_ptr<input_t>> inputs;    ///< opened input files
+    MergeCollator C;        ///< merge of input files
+    double dt = 0;          ///< run wall time [s]
+};
+
+#endif
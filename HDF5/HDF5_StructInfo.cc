@@ -3,6 +3,12 @@
 
 #include "HDF5_StructInfo.hh"
 #include <stdexcept>
+#include <cstddef>
+#include <algorithm>
+#include <map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 hsize_t const array_dim_2 = 2;
 hsize_t const array_dim_3 = 3;
@@ -10,6 +16,83 @@ hid_t const float2_tid = H5Tarray_create(H5T_NATIVE_FLOAT, 1, &array_dim_2);
 hid_t const float3_tid = H5Tarray_create(H5T_NATIVE_FLOAT, 1, &array_dim_3);
 hid_t const double3_tid = H5Tarray_create(H5T_NATIVE_DOUBLE, 1, &array_dim_3);
 
+std::mutex& HDF5_mutex() {
+    static std::mutex m;
+    return m;
+}
+
+HDF5_IOThread& HDF5_IOThread::instance() {
+    static HDF5_IOThread IOT;
+    return IOT;
+}
+
+HDF5_IOThread::HDF5_IOThread(): T([this] { run(); }) { }
+
+HDF5_IOThread::~HDF5_IOThread() {
+    {
+        std::lock_guard<std::mutex> l(M);
+        halt = true;
+    }
+    C.notify_all();
+    T.join();
+}
+
+void HDF5_IOThread::submit(std::function<void()> f) {
+    {
+        std::lock_guard<std::mutex> l(M);
+        Q.push_back(std::move(f));
+    }
+    C.notify_one();
+}
+
+void HDF5_IOThread::run() {
+    std::unique_lock<std::mutex> l(M);
+    while(true) {
+        C.wait(l, [this] { return halt || !Q.empty(); });
+        if(Q.empty()) return;
+        auto f = std::move(Q.front());
+        Q.pop_front();
+        l.unlock();
+        {
+            std::lock_guard<std::mutex> lh(HDF5_mutex());
+            f();
+        }
+        l.lock();
+    }
+}
+
+hid_t HDF5_native_int(size_t s, bool is_signed) {
+    switch(s) {
+        case 1: return is_signed? H5T_NATIVE_INT8 : H5T_NATIVE_UINT8;
+        case 2: return is_signed? H5T_NATIVE_INT16 : H5T_NATIVE_UINT16;
+        case 4: return is_signed? H5T_NATIVE_INT32 : H5T_NATIVE_UINT32;
+        case 8: return is_signed? H5T_NATIVE_INT64 : H5T_NATIVE_UINT64;
+        default: throw std::logic_error("No native HDF5 integer of size " + std::to_string(s));
+    }
+}
+
+hid_t HDF5_array_type(hid_t base, size_t n) {
+    static std::mutex m;
+    static std::map<std::pair<hid_t, size_t>, hid_t> types;
+    std::lock_guard<std::mutex> l(m);
+    auto& t = types[{base, n}];
+    if(!t) {
+        hsize_t d = n;
+        t = H5Tarray_create(base, 1, &d);
+        if(t < 0) throw std::runtime_error("Failed to create HDF5 array type");
+    }
+    return t;
+}
+
+HDF5_Field_Arrays::HDF5_Field_Arrays(const HDF5_Field_Info* F, size_t n) {
+    for(size_t i = 0; i < n; ++i) {
+        offsets.push_back(F[i].offset);
+        sizes.push_back(F[i].size);
+        types.push_back(F[i].type());
+        names.push_back(F[i].name);
+    }
+}
+
 void makeTable(const HDF5_Table_Spec& T, hid_t outfile_id, int nchunk, int compress) {
     if(!outfile_id) throw std::runtime_error("No HDF5 output file specified");
     printf("Setting up '%s' table...\n", T.table_name.c_str());
@@ -19,3 +102,154 @@ void makeTable(const HDF5_Table_Spec& T, hid_t outfile_id, int nchunk, int compr
                                 nchunk, nullptr, compress, nullptr);
     if(err<0) throw std::runtime_error("Error instantiating HDF5 table");
 }
+
+hid_t makeMemType(const HDF5_Table_Spec& T) {
+    auto mt = H5Tcreate(H5T_COMPOUND, T.struct_size);
+    for(hsize_t i = 0; i < T.n_fields; ++i) H5Tinsert(mt, T.field_names[i], T.offsets[i], T.field_types[i]);
+    return mt;
+}
+
+const void* HDF5_TableMap::map(hid_t f, const HDF5_Table_Spec& T, hsize_t nrows, size_t align) {
+    unmap();
+    if(!f || !nrows) return nullptr;
+
+    // contiguous storage, with file row type identical to in-memory struct
+    auto d = H5Dopen2(f, T.table_name.c_str(), H5P_DEFAULT);
+    if(d < 0) return nullptr;
+    bool ok = false;
+    auto pl = H5Dget_create_plist(d);
+    if(pl >= 0) {
+        ok = H5Pget_layout(pl) == H5D_CONTIGUOUS && !H5Pget_nfilters(pl) && H5Pget_external_count(pl) <= 0;
+        H5Pclose(pl);
+    }
+    haddr_t off = ok? H5Dget_offset(d) : HADDR_UNDEF;
+    ok = ok && off != HADDR_UNDEF && off % align == 0 && H5Dget_storage_size(d) >= nrows * T.struct_size;
+    if(ok) {
+        auto ft = H5Dget_type(d);
+        auto mt = makeMemType(T);
+        ok = H5Tequal(ft, mt) > 0;
+        H5Tclose(mt);
+        H5Tclose(ft);
+    }
+    H5Dclose(d);
+    if(!ok) return nullptr;
+
+    // map page-aligned range covering rows
+    auto nm = H5Fget_name(f, nullptr, 0);
+    if(nm <= 0) return nullptr;
+    string fname(nm + 1, '\0');
+    H5Fget_name(f, &fname[0], fname.size());
+    fname.resize(nm);
+    auto fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0) return nullptr;
+    size_t pg = sysconf(_SC_PAGESIZE);
+    size_t o0 = off - off % pg;
+    len = off - o0 + nrows * T.struct_size;
+    base = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, o0);
+    close(fd);
+    if(base == MAP_FAILED) {
+        base = nullptr;
+        len = 0;
+        return nullptr;
+    }
+    madvise(base, len, MADV_SEQUENTIAL);
+    return static_cast<const char*>(base) + (off - o0);
+}
+
+void HDF5_TableMap::unmap() {
+    if(base) munmap(base, len);
+    base = nullptr;
+    len = 0;
+}
+
+/// HDF5 table layout for HDF5_ID_Range
+static HDF5_Table_Spec idRangeSpec(const string& table) {
+    static const size_t offsets[] = { offsetof(HDF5_ID_Range, id), offsetof(HDF5_ID_Range, row), offsetof(HDF5_ID_Range, n) };
+    static const size_t sizes[] = { sizeof(HDF5_ID_Range::id), sizeof(HDF5_ID_Range::row), sizeof(HDF5_ID_Range::n) };
+    static const char* names[] = { "id", "row", "n" };
+    static const hid_t types[] = { H5T_NATIVE_INT64, H5T_NATIVE_HSIZE, H5T_NATIVE_HSIZE };
+
+    HDF5_Table_Spec T;
+    T.n_fields = 3;
+    T.struct_size = sizeof(HDF5_ID_Range);
+    T.offsets = offsets;
+    T.field_sizes = sizes;
+    T.field_types = types;
+    T.field_names = names;
+    T.table_name = HDF5_index_name(table);
+    T.table_descrip = "Row ranges by identifier for " + table;
+    return T;
+}
+
+void writeIDIndex(hid_t f, const string& table, const vector<HDF5_ID_Range>& v) {
+    auto T = idRangeSpec(table);
+    makeTable(T, f, 4096, 9);
+    if(!v.size()) return;
+    herr_t err = H5TBappend_records(f, T.table_name.c_str(), v.size(), T.struct_size, T.offsets, T.field_sizes, v.data());
+    if(err < 0) throw std::runtime_error("Failed to write HDF5 index table '" + T.table_name + "'");
+}
+
+bool readIDIndex(hid_t f, const string& table, vector<HDF5_ID_Range>& v) {
+    v.clear();
+    auto T = idRangeSpec(table);
+    if(!f || H5Lexists(f, T.table_name.c_str(), H5P_DEFAULT) <= 0) return false;
+    hsize_t nf = 0, nr = 0;
+    if(H5TBget_table_info(f, T.table_name.c_str(), &nf, &nr) < 0) return false;
+    v.resize(nr);
+    if(nr && H5TBread_records(f, T.table_name.c_str(), 0, nr, T.struct_size, T.offsets, T.field_sizes, v.data()) < 0) {
+        v.clear();
+        return false;
+    }
+    return true;
+}
+
+#ifdef HDF5_PARALLEL
+hsize_t appendRecordsParallel(const HDF5_Table_Spec& T, hid_t f, MPI_Comm c, hsize_t n, const void* data) {
+    // this rank's offset in combined rows
+    int rank = 0, nranks = 1;
+    MPI_Comm_rank(c, &rank);
+    MPI_Comm_size(c, &nranks);
+    unsigned long long nr = n;
+    vector<unsigned long long> ns(nranks);
+    MPI_Allgather(&nr, 1, MPI_UNSIGNED_LONG_LONG, ns.data(), 1, MPI_UNSIGNED_LONG_LONG, c);
+    hsize_t off = 0, ntot = 0;
+    for(int i = 0; i < nranks; ++i) {
+        if(i < rank) off += ns[i];
+        ntot += ns[i];
+    }
+    if(!ntot) return 0;
+
+    auto d = H5Dopen2(f, T.table_name.c_str(), H5P_DEFAULT);
+    if(d < 0) throw std::runtime_error("Failed to open HDF5 table '" + T.table_name + "'");
+    hsize_t n0 = 0;
+    auto fsp = H5Dget_space(d);
+    H5Sget_simple_extent_dims(fsp, &n0, nullptr);
+    H5Sclose(fsp);
+    hsize_t n1 = n0 + ntot;
+    herr_t err = H5Dset_extent(d, &n1);
+
+    auto mt = makeMemType(T);
+
+    fsp = H5Dget_space(d);
+    hsize_t nm = std::max(n, hsize_t(1));
+    auto msp = H5Screate_simple(1, &nm, nullptr);
+    if(n) {
+        hsize_t o = n0 + off;
+        H5Sselect_hyperslab(fsp, H5S_SELECT_SET, &o, nullptr, &n, nullptr);
+    } else {
+        H5Sselect_none(fsp);
+        H5Sselect_none(msp);
+    }
+    auto xf = H5Pcreate(H5P_DATASET_XFER);
+    H5Pset_dxpl_mpio(xf, H5FD_MPIO_COLLECTIVE);
+    if(err >= 0) err = H5Dwrite(d, mt, msp, fsp, xf, data);
+
+    H5Pclose(xf);
+    H5Sclose(msp);
+    H5Sclose(fsp);
+    H5Tclose(mt);
+    H5Dclose(d);
+    if(err < 0) throw std::runtime_error("Failed collective append to HDF5 table '" + T.table_name + "'");
+    return ntot;
+}
+#endif
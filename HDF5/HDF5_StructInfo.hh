@@ -7,7 +7,21 @@
 #include "hdf5.h"
 #include "hdf5_hl.h"
 #include <string>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
 using std::string;
+using std::vector;
+
+#if defined(WITH_MPI) && defined(H5_HAVE_PARALLEL)
+/// MPI-IO parallel HDF5 output available
+#define HDF5_PARALLEL
+#endif
 
 /// info for setting up HDF5 tables
 struct HDF5_Table_Spec {
@@ -25,10 +39,184 @@ struct HDF5_Table_Spec {
 /// set up specified table
 void makeTable(const HDF5_Table_Spec& T, hid_t outfile_id, int nchunk, int compress);
 
+#ifdef HDF5_PARALLEL
+/// collectively append each rank's n rows (in rank order) to table; return total rows appended (caller holds HDF5_mutex())
+hsize_t appendRecordsParallel(const HDF5_Table_Spec& T, hid_t f, MPI_Comm c, hsize_t n, const void* data);
+#endif
+
+/// in-memory compound type for table rows (caller closes)
+hid_t makeMemType(const HDF5_Table_Spec& T);
+
+/// Read-only memory map of table rows, for uncompressed contiguous tables stored exactly in in-memory layout
+class HDF5_TableMap {
+public:
+    /// Constructor
+    HDF5_TableMap() { }
+    /// Destructor
+    ~HDF5_TableMap() { unmap(); }
+    /// no copy
+    HDF5_TableMap(const HDF5_TableMap&) = delete;
+    /// no assignment
+    HDF5_TableMap& operator=(const HDF5_TableMap&) = delete;
+
+    /// map nrows of table in file; return first row, or nullptr if not mappable (caller holds HDF5_mutex())
+    const void* map(hid_t f, const HDF5_Table_Spec& T, hsize_t nrows, size_t align);
+    /// release mapping
+    void unmap();
+    /// whether mapped
+    bool isMapped() const { return base; }
+
+protected:
+    void* base = nullptr;   ///< mapped region start
+    size_t len = 0;         ///< mapped region length
+};
+
+/// sidecar index entry: rows range for one identifier, in table sorted by identifier
+struct HDF5_ID_Range {
+    int64_t id;     ///< row identifier
+    hsize_t row;    ///< first row with identifier
+    hsize_t n;      ///< number of rows with identifier
+};
+/// name of sidecar index table for named table
+inline string HDF5_index_name(const string& table) { return table + "_index"; }
+/// write sidecar index table for named table (caller holds HDF5_mutex())
+void writeIDIndex(hid_t f, const string& table, const vector<HDF5_ID_Range>& v);
+/// read sidecar index table for named table, if present; return whether found (caller holds HDF5_mutex())
+bool readIDIndex(hid_t f, const string& table, vector<HDF5_ID_Range>& v);
+
 /// templatized form for table setup lookup. Non-specialized version should cause compiler barf.
 template<typename T>
 inline HDF5_Table_Spec HDF5_table_setup(const string& tname = "", int version = 0) { return T::HDF5_table_setup(tname, version); }
 
+/// process-wide lock on HDF5 library calls (library is not assumed thread-safe)
+std::mutex& HDF5_mutex();
+
+/// Process-wide single thread running queued HDF5 operations in order, under HDF5_mutex()
+class HDF5_IOThread {
+public:
+    /// get (and start on first use) global instance
+    static HDF5_IOThread& instance();
+    /// Destructor: complete queued operations, then stop thread
+    ~HDF5_IOThread();
+    /// queue operation for I/O thread
+    void submit(std::function<void()> f);
+
+protected:
+    /// Constructor, launching thread
+    HDF5_IOThread();
+    /// I/O thread loop
+    void run();
+
+    std::mutex M;                           ///< queue lock
+    std::condition_variable C;              ///< queue change notification
+    std::deque<std::function<void()>> Q;    ///< queued operations
+    bool halt = false;                      ///< thread stop request
+    std::thread T;                          ///< I/O thread
+};
+
+/// native HDF5 integer type for size [bytes] and signedness
+hid_t HDF5_native_int(size_t s, bool is_signed);
+/// (cached) HDF5 1-D array type of n base-type elements
+hid_t HDF5_array_type(hid_t base, size_t n);
+
+/// native HDF5 type exactly matching in-memory C++ type T (undefined for unsupported types)
+template<typename T, typename = void>
+struct HDF5_native_type;
+/// integer types, by size and signedness
+template<typename T>
+struct HDF5_native_type<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+    /// get HDF5 type
+    static hid_t get() { return HDF5_native_int(sizeof(T), std::is_signed<T>::value); }
+};
+/// enumerations, as underlying integer type
+template<typename T>
+struct HDF5_native_type<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+    /// get HDF5 type
+    static hid_t get() { return HDF5_native_type<typename std::underlying_type<T>::type>::get(); }
+};
+/// float
+template<>
+struct HDF5_native_type<float> {
+    /// get HDF5 type
+    static hid_t get() { return H5T_NATIVE_FLOAT; }
+};
+/// double
+template<>
+struct HDF5_native_type<double> {
+    /// get HDF5 type
+    static hid_t get() { return H5T_NATIVE_DOUBLE; }
+};
+/// long double
+template<>
+struct HDF5_native_type<long double> {
+    /// get HDF5 type
+    static hid_t get() { return H5T_NATIVE_LDOUBLE; }
+};
+/// fixed-size arrays
+template<typename T, size_t N>
+struct HDF5_native_type<T[N]> {
+    /// get HDF5 type
+    static hid_t get() { return HDF5_array_type(HDF5_native_type<T>::get(), N); }
+};
+
+/// one struct field, for generated HDF5_Table_Spec
+struct HDF5_Field_Info {
+    const char* name;   ///< field name
+    size_t offset;      ///< offset in struct
+    size_t size;        ///< size [bytes]
+    hid_t (*type)();    ///< native HDF5 type lookup
+};
+
+/// whether fields lie inside an s-byte struct without overlapping
+constexpr bool HDF5_fields_valid(const HDF5_Field_Info* F, size_t n, size_t s) {
+    for(size_t i = 0; i < n; ++i) {
+        if(F[i].offset + F[i].size > s) return false;
+        for(size_t j = 0; j < i; ++j)
+            if(F[i].offset < F[j].offset + F[j].size && F[j].offset < F[i].offset + F[i].size) return false;
+    }
+    return true;
+}
+
+/// persistent field arrays referenced by generated HDF5_Table_Spec
+struct HDF5_Field_Arrays {
+    /// Constructor, from field list
+    HDF5_Field_Arrays(const HDF5_Field_Info* F, size_t n);
+    vector<size_t> offsets;     ///< field offsets
+    vector<size_t> sizes;       ///< field sizes
+    vector<hid_t> types;        ///< field native types
+    vector<const char*> names;  ///< field names
+};
+
+/// HDF5_Table_Spec for struct S from field list (see HDF5_TABLE_SPEC)
+template<typename S, size_t N>
+HDF5_Table_Spec HDF5_reflect_spec(const HDF5_Field_Info (&F)[N], const string& tname, const string& descrip, int version) {
+    static HDF5_Field_Arrays A(F, N);
+    HDF5_Table_Spec T;
+    T.version = version;
+    T.n_fields = N;
+    T.struct_size = sizeof(S);
+    T.offsets = A.offsets.data();
+    T.field_sizes = A.sizes.data();
+    T.field_types = A.types.data();
+    T.field_names = A.names.data();
+    T.table_name = tname;
+    T.table_descrip = descrip;
+    return T;
+}
+
+/// field descriptor of member f in struct S, for HDF5_TABLE_SPEC
+#define HDF5_FIELD(S, f) HDF5_Field_Info{ #f, offsetof(S, f), sizeof(S::f), &HDF5_native_type<decltype(S::f)>::get }
+
+/// HDF5_Table_Spec for struct S from list of HDF5_FIELD(S, member), with native types matching in-memory layout
+/// (no H5TB conversion); usable as body of S::HDF5_table_setup:
+///   return HDF5_TABLE_SPEC(S, tname, "description", version, HDF5_FIELD(S, evt), HDF5_FIELD(S, E));
+#define HDF5_TABLE_SPEC(S, tname, descrip, version, ...) [&]() { \
+    static_assert(std::is_standard_layout<S>::value, "HDF5 table struct must be standard layout"); \
+    static constexpr HDF5_Field_Info _hdf5_F[] = { __VA_ARGS__ }; \
+    static_assert(HDF5_fields_valid(_hdf5_F, sizeof(_hdf5_F)/sizeof(_hdf5_F[0]), sizeof(S)), \
+                  "HDF5 table fields overlap or exceed struct"); \
+    return HDF5_reflect_spec<S>(_hdf5_F, tname, descrip, version); }()
+
 /// float[2] array type
 extern hid_t const float2_tid;
 /// float[3] array type
@@ -6,6 +6,11 @@
 
 #include "HDF5_StructInfo.hh"
 #include "DataSource.hh"
+#include "MemoryBudget.hh"
+#include "HugePages.hh"
+#include <algorithm>
+#include <chrono>
+#include <exception>
 using std::multimap;
 
 /// Cacheing HDF5 table reader
@@ -13,10 +18,12 @@ template<typename T>
 class HDF5_Table_Cache: virtual public DataSource<T> {
 public:
     /// Constructor, from name of table and struct offsets/sizes
-    HDF5_Table_Cache(const HDF5_Table_Spec& ts = HDF5_table_setup<T>(), hsize_t nc = 1024): Tspec(ts), nchunk(nc)  { }
+    HDF5_Table_Cache(const HDF5_Table_Spec& ts = HDF5_table_setup<T>(), hsize_t nc = 1024): Tspec(ts), nchunk(nc), nchunk_min(nc)  { }
 
     /// get next table row; return whether successful or failed (end-of-file)
     bool next(T& val) override;
+    /// view next (up to nmax) rows directly in read cache, valid until next read; return number of rows (0 at end-of-file)
+    size_t next_block(const T*& p, size_t nmax = std::numeric_limits<size_t>::max());
     /// skip ahead number of entries
     bool skip(size_t n) override;
     /// Re-start at beginning of stream
@@ -30,6 +37,10 @@ public:
     hsize_t getNRead() const { return nread; }
     /// get number of rows available
     hsize_t getNRows() const { return nRows; }
+    /// get rows per read
+    hsize_t getNChunk() const { return nchunk; }
+    /// set rows per read to multiple of table's on-disk chunk size (at least constructor value); return disk chunk size (0 if unchunked)
+    hsize_t alignChunks();
     /// get identifying number for value type
     static int64_t getIdentifier(const T& i) { return i.evt; }
     /// set identifying number for value type
@@ -37,23 +48,50 @@ public:
 
     /// load next "event" of entries with same identifer into vector; return event identifier loaded
     int64_t loadEvent(vector<T>& v);
+    /// position at first row with identifier >= id (by sidecar index if available, else scanning forward); return whether id present
+    bool seek(int64_t id);
+    /// skip over next n events (identifier groups); return false at end of input
+    bool skipEvents(size_t n);
+    /// whether sidecar identifier index was loaded for file
+    bool hasIndex() const { return idIndex.size(); }
+    /// get sidecar identifier index
+    const vector<HDF5_ID_Range>& getIndex() const { return idIndex; }
     /// load all data into map by event number
     void loadAll(multimap<int64_t, T>& dat);
 
     HDF5_Table_Spec Tspec;      ///< configuration for table to read
     int nLoad = -1;             ///< entries loading limit; set >= 0 to apply
+    bool alignDisk = false;     ///< whether to alignChunks() on setFile()
+    bool useMmap = false;       ///< whether to memory-map (uncompressed, contiguous, memory-layout) tables on setFile()
+    /// whether rows are read directly from memory-mapped file
+    bool isMapped() const { return mrows; }
 
 protected:
     hid_t _infile_id = 0;       ///< file to read from
     T next_read;                ///< next item read in for event list reads
     int64_t id_current_evt = -1;  ///< event identifier of next_read
 
-    vector<T> cached;           ///< cached read data
+    hugepage_vector<T> cached{HugePageAllocator<T>("HDF5_Table_Cache")};    ///< cached read data
     size_t cache_idx = 0;       ///< index in cached data
     hsize_t nread = 0;          ///< number of rows read
     hsize_t nRows = 0;          ///< number of rows in table
     hsize_t nfields = 0;        ///< number of fields in table
     hsize_t nchunk;             ///< cacheing chunk size
+    hsize_t nchunk_min;         ///< minimum cacheing chunk size
+    hsize_t dchunk = 0;         ///< on-disk chunk size, if aligning reads
+    vector<HDF5_ID_Range> idIndex;  ///< sidecar identifier index, if present
+    HDF5_TableMap tmap;         ///< memory-mapped table, if useMmap
+    const T* mrows = nullptr;   ///< mapped rows, if mapped
+    MemAccount cacheMem{"HDF5_Table_Cache", nullptr};   ///< cached rows allocation, reported to MemTag
+
+    /// row limit for reading
+    hsize_t rowLimit() const { return nLoad >= 0 && hsize_t(nLoad) < nRows? nLoad : nRows; }
+
+    /// position next read at row r
+    void seekRow(hsize_t r);
+
+    /// ensure cached data is available, reading next chunk if needed; return false at end of input
+    bool fill();
 };
 
 /// Cacheing HDF5 table writer
@@ -74,19 +112,77 @@ public:
     /// (re)set output file
     void setFile(hid_t f);
     /// create table in output file
-    void initTable() { makeTable(Tspec, _outfile_id, nchunk, compress); }
+    void initTable() { std::lock_guard<std::mutex> l(HDF5_mutex()); makeTable(Tspec, _outfile_id, nchunk, compress); }
     /// accept data flow signal
     void signal(datastream_signal_t sig) override;
 
+    /// enable/disable double-buffered writes on HDF5_IOThread
+    void setAsync(bool a) { if(!a) waitWrite(); async = a; }
+    /// whether writes are asynchronous
+    bool getAsync() const { return async; }
+    /// wait for completion of background write
+    void waitWrite();
+    /// time spent waiting on background writes [s]
+    double getWaitTime() const { return tWait; }
+#ifdef HDF5_PARALLEL
+    /// append collectively with all ranks of communicator (MPI_COMM_NULL for independent writes): rows are
+    /// buffered until DATASTREAM_FLUSH/END, which all ranks must signal together (no async writes or sidecar index)
+    void setComm(MPI_Comm c) { signal(DATASTREAM_FLUSH); waitWrite(); comm = c; }
+    /// whether appends are collective
+    bool isParallel() const { return comm != MPI_COMM_NULL; }
+#else
+    /// whether appends are collective
+    bool isParallel() const { return false; }
+#endif
+
     HDF5_Table_Spec Tspec;      ///< configuration for table to read
+    bool writeIndex = false;    ///< whether to write sidecar identifier index on file close
 
 protected:
+    /// append rows to table in file (caller holds HDF5_mutex())
+    void append(hid_t f, const vector<T>& v);
+    /// background write of writing buffer, on I/O thread
+    void writeBuffer(hid_t f);
+    /// add rows to identifier index (types with evt identifier)
+    template<typename U = T>
+    auto indexRows(const vector<U>& v, int) -> decltype(void(v[0].evt)) {
+        for(auto& r: v) {
+            auto i = HDF5_Table_Cache<U>::getIdentifier(r);
+            if(idIndex.size() && idIndex.back().id == i) idIndex.back().n++;
+            else {
+                if(idIndex.size() && i < idIndex.back().id) idSorted = false;
+                idIndex.push_back({i, idxRow, 1});
+            }
+            ++idxRow;
+        }
+    }
+    /// rows of types without identifier are not indexed
+    void indexRows(const vector<T>&, long) { idSorted = false; }
+    /// write identifier index for current file, if enabled; reset
+    void finishIndex();
+
     hid_t _outfile_id = 0;      ///< file to write to
     hsize_t nwrite = 0;         ///< number of rows written
 
     vector<T> cached;           ///< cached output data
     hsize_t nchunk;             ///< cacheing chunk size
     int compress;               ///< output compression level
+
+    bool async = false;         ///< whether to write in background
+    vector<T> writing;          ///< buffer being written in background
+    bool pending = false;       ///< whether writing buffer is in use
+    std::exception_ptr wErr;    ///< background write failure
+    std::mutex wMut;                ///< lock on pending, wErr
+    std::condition_variable wDone;  ///< background write completion
+    double tWait = 0;           ///< time spent waiting on background writes [s]
+
+    vector<HDF5_ID_Range> idIndex;  ///< identifier index for current file
+    hsize_t idxRow = 0;         ///< rows indexed in current file
+    bool idSorted = true;       ///< whether identifiers are ascending (indexable)
+    MemAccount cacheMem{"HDF5_Table_Writer", nullptr};  ///< cached and writing buffers allocation, reported to MemTag
+#ifdef HDF5_PARALLEL
+    MPI_Comm comm = MPI_COMM_NULL;  ///< communicator for collective appends
+#endif
 };
 
 /// Combined HDF5 reader/writer for transferring select events subset
@@ -112,33 +208,111 @@ public:
 template<typename T>
 void HDF5_Table_Writer<T>::push(const vector<T>& vals) {
     cached.insert(cached.end(), vals.begin(), vals.end());
-    if(cached.size() >= nchunk) signal(DATASTREAM_FLUSH);
+    if(cached.size() >= nchunk && !isParallel()) signal(DATASTREAM_FLUSH);
     nwrite += vals.size();
 }
 
 template<typename T>
 void HDF5_Table_Writer<T>::push(const T& val) {
     cached.push_back(val);
-    if(cached.size() >= nchunk) signal(DATASTREAM_FLUSH);
+    if(cached.size() >= nchunk && !isParallel()) signal(DATASTREAM_FLUSH);
     nwrite++;
 }
 
 template<typename T>
 void HDF5_Table_Writer<T>::setFile(hid_t f) {
     signal(DATASTREAM_FLUSH);
+    waitWrite();
+    finishIndex();
     _outfile_id = f;
 }
 
+template<typename T>
+void HDF5_Table_Writer<T>::finishIndex() {
+    if(writeIndex && _outfile_id && idxRow) {
+        if(idSorted) {
+            std::lock_guard<std::mutex> l(HDF5_mutex());
+            writeIDIndex(_outfile_id, Tspec.table_name, idIndex);
+        } else printf("Warning: '%s' identifiers not ascending; index not written.\n", Tspec.table_name.c_str());
+    }
+    idIndex.clear();
+    idxRow = 0;
+    idSorted = true;
+}
+
+template<typename T>
+void HDF5_Table_Writer<T>::append(hid_t f, const vector<T>& v) {
+    herr_t err = H5TBappend_records(f,  Tspec.table_name.c_str(), v.size(),
+                                    sizeof(T),  Tspec.offsets, Tspec.field_sizes, v.data());
+    if(err < 0) throw std::runtime_error("Failed to append records to HDF5 table '" + Tspec.table_name + "'");
+}
+
+template<typename T>
+void HDF5_Table_Writer<T>::writeBuffer(hid_t f) {
+    std::exception_ptr e;
+    try { append(f, writing); }
+    catch(...) { e = std::current_exception(); }
+    writing.clear();
+
+    std::lock_guard<std::mutex> l(wMut);
+    pending = false;
+    if(e) wErr = e;
+    wDone.notify_all();
+}
+
+template<typename T>
+void HDF5_Table_Writer<T>::waitWrite() {
+    std::unique_lock<std::mutex> l(wMut);
+    if(pending) {
+        auto t0 = std::chrono::steady_clock::now();
+        wDone.wait(l, [this] { return !pending; });
+        tWait += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+    if(wErr) {
+        auto e = wErr;
+        wErr = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
 template<typename T>
 void HDF5_Table_Writer<T>::signal(datastream_signal_t sig) {
     if(sig < DATASTREAM_FLUSH) return;
+#ifdef HDF5_PARALLEL
+    if(isParallel()) {
+        if(_outfile_id) {
+            std::lock_guard<std::mutex> l(HDF5_mutex());
+            appendRecordsParallel(Tspec, _outfile_id, comm, cached.size(), cached.data());
+        }
+        cached.clear();
+        return;
+    }
+#endif
+    if(writeIndex && _outfile_id) indexRows(cached, 0);
+    cacheMem.set_items<T>(cached.capacity() + writing.capacity());
+    if(async) {
+        // backpressure: hand off only once previous buffer is written
+        waitWrite();
+        if(_outfile_id && cached.size()) {
+            std::swap(cached, writing);
+            pending = true;
+            HDF5_IOThread::instance().submit([this, f = _outfile_id] { writeBuffer(f); });
+        }
+        cached.clear();
+        if(sig >= DATASTREAM_END) {
+            waitWrite();
+            finishIndex();
+        }
+        return;
+    }
     if(_outfile_id && cached.size()) {
-        herr_t err = H5TBappend_records(_outfile_id,  Tspec.table_name.c_str(), cached.size(),
-                                        sizeof(T),  Tspec.offsets, Tspec.field_sizes, cached.data());
-        if(err < 0) throw std::runtime_error("Failed to append records to HDF5 table '" + Tspec.table_name + "'");
+        std::lock_guard<std::mutex> l(HDF5_mutex());
+        append(_outfile_id, cached);
     }
     cached.clear();
+    if(sig >= DATASTREAM_END) finishIndex();
 }
+
 ///////////////////////////////////////////////
 ///////////////////////////////////////////////
 ///////////////////////////////////////////////
@@ -147,46 +321,106 @@ template<typename T>
 void HDF5_Table_Cache<T>::setFile(hid_t f) {
     _infile_id = f;
     cached.clear();
+    idIndex.clear();
+    tmap.unmap();
+    mrows = nullptr;
     cache_idx = nread = nRows = 0;
     if(f) {
+        std::lock_guard<std::mutex> l(HDF5_mutex());
         if(H5Lexists(_infile_id,  Tspec.table_name.c_str(), H5P_DEFAULT)) {
             herr_t err = H5TBget_table_info(_infile_id,  Tspec.table_name.c_str(), &nfields, &nRows);
             if(err < 0) throw std::exception();
+            if(readIDIndex(_infile_id, Tspec.table_name, idIndex) && idIndex.size()
+               && idIndex.back().row + idIndex.back().n > nRows) {
+                printf("Warning: ignoring inconsistent '%s' index.\n", Tspec.table_name.c_str());
+                idIndex.clear();
+            }
+            if(useMmap && sizeof(T) == Tspec.struct_size) {
+                mrows = static_cast<const T*>(tmap.map(_infile_id, Tspec, nRows, alignof(T)));
+                if(!mrows) printf("Table '%s' not memory-mappable; using buffered reads.\n", Tspec.table_name.c_str());
+            }
         } else {
             printf("Warning: table '%s' not present in file.\n", Tspec.table_name.c_str());
             _infile_id = 0;
         }
     }
     id_current_evt = -1;
+    dchunk = 0;
+    if(_infile_id && alignDisk) alignChunks();
 }
 
 template<typename T>
-bool HDF5_Table_Cache<T>::next(T& val) {
-    if(!_infile_id) return false;
-
-    if(cache_idx >= cached.size()) { // cache exhausted, needs new data
-        if(nread == nRows || nread == hsize_t(nLoad)) {  // input exhausted.
-            nread = 0;          // Next `next()` call will return to start of file.
-            cache_idx = 0;
-            cached.clear();
-            return false;
-        }
+hsize_t HDF5_Table_Cache<T>::alignChunks() {
+    dchunk = 0;
+    if(!_infile_id) return 0;
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+    auto d = H5Dopen2(_infile_id, Tspec.table_name.c_str(), H5P_DEFAULT);
+    if(d < 0) return 0;
+    auto pl = H5Dget_create_plist(d);
+    if(pl >= 0) {
+        if(H5Pget_layout(pl) == H5D_CHUNKED && H5Pget_chunk(pl, 1, &dchunk) < 0) dchunk = 0;
+        H5Pclose(pl);
+    }
+    H5Dclose(d);
+    if(dchunk) nchunk = ((std::max(nchunk_min, hsize_t(1)) + dchunk - 1)/dchunk) * dchunk;
+    return dchunk;
+}
 
-        hsize_t nToRead = std::min(nchunk, hsize_t(entries()));
-        if(!nToRead) return false;
+template<typename T>
+bool HDF5_Table_Cache<T>::fill() {
+    if(!_infile_id) return false;
+    if(cache_idx < cached.size()) return true;
 
-        cached.resize(nToRead);
+    if(nread == nRows || nread == hsize_t(nLoad)) {  // input exhausted.
+        nread = 0;          // Next `next()` call will return to start of file.
         cache_idx = 0;
-        herr_t err = H5TBread_records(_infile_id, Tspec.table_name.c_str(), nread, nToRead,
-                                      sizeof(T),  Tspec.offsets, Tspec.field_sizes, cached.data());
-        if(err < 0) throw std::runtime_error("Unexpected failure reading HDF5 file");
-        nread += nToRead;
+        cached.clear();
+        return false;
     }
 
-    val = cached.at(cache_idx++);
+    hsize_t nToRead = std::min(nchunk, hsize_t(entries()));
+    if(dchunk) nToRead = std::min(nToRead, nchunk - nread % dchunk); // end on disk chunk boundary
+    if(!nToRead) return false;
+
+    cached.resize(nToRead);
+    cacheMem.set_items<T>(cached.capacity());
+    cache_idx = 0;
+    std::lock_guard<std::mutex> l(HDF5_mutex());
+    herr_t err = H5TBread_records(_infile_id, Tspec.table_name.c_str(), nread, nToRead,
+                                  sizeof(T),  Tspec.offsets, Tspec.field_sizes, cached.data());
+    if(err < 0) throw std::runtime_error("Unexpected failure reading HDF5 file");
+    nread += nToRead;
     return true;
 }
 
+template<typename T>
+bool HDF5_Table_Cache<T>::next(T& val) {
+    if(mrows) {
+        if(nread >= rowLimit()) { nread = 0; return false; }
+        val = mrows[nread++];
+        return true;
+    }
+    if(!fill()) return false;
+    val = cached[cache_idx++];
+    return true;
+}
+
+template<typename T>
+size_t HDF5_Table_Cache<T>::next_block(const T*& p, size_t nmax) {
+    if(mrows) { // zero-copy view of mapped rows
+        if(nread >= rowLimit()) { nread = 0; return 0; }
+        auto n = std::min(size_t(std::min(rowLimit() - nread, nchunk)), nmax);
+        p = mrows + nread;
+        nread += n;
+        return n;
+    }
+    if(!fill()) return 0;
+    auto n = std::min(cached.size() - cache_idx, nmax);
+    p = cached.data() + cache_idx;
+    cache_idx += n;
+    return n;
+}
+
 template<typename T>
 bool HDF5_Table_Cache<T>::skip(size_t n) {
     if(!n) return true;
@@ -239,6 +473,72 @@ int64_t HDF5_Table_Cache<T>::loadEvent(vector<T>& v) {
     return id_current_evt;
 }
 
+template<typename T>
+void HDF5_Table_Cache<T>::seekRow(hsize_t r) {
+    auto c0 = nread - cached.size();
+    if(r >= c0 && r < nread) cache_idx = r - c0; // already in cache
+    else {
+        cached.clear();
+        cache_idx = 0;
+        nread = std::min(r, nRows);
+    }
+    id_current_evt = -1;
+}
+
+template<typename T>
+bool HDF5_Table_Cache<T>::seek(int64_t id) {
+    if(idIndex.size()) {
+        auto it = std::lower_bound(idIndex.begin(), idIndex.end(), id,
+                                   [](const HDF5_ID_Range& a, int64_t i) { return a.id < i; });
+        seekRow(it == idIndex.end()? nRows : it->row);
+        return it != idIndex.end() && it->id == id;
+    }
+
+    id_current_evt = -1;
+    T v;
+    while(next(v)) {
+        auto i = getIdentifier(v);
+        if(i >= id) {
+            --cache_idx; // leave row to be read next
+            return i == id;
+        }
+    }
+    return false;
+}
+
+template<typename T>
+bool HDF5_Table_Cache<T>::skipEvents(size_t n) {
+    if(!n) return true;
+    if(idIndex.size()) {
+        // index entry for next row
+        T v;
+        if(!next(v)) return false;
+        auto i = getIdentifier(v);
+        auto it = std::lower_bound(idIndex.begin(), idIndex.end(), i,
+                                   [](const HDF5_ID_Range& a, int64_t j) { return a.id < j; });
+        if(size_t(idIndex.end() - it) <= n) {
+            seekRow(nRows);
+            return false;
+        }
+        seekRow(it[n].row);
+        return true;
+    }
+
+    id_current_evt = -1;
+    T v;
+    if(!next(v)) return false;
+    auto i = getIdentifier(v);
+    while(true) {
+        if(!next(v)) return false;
+        auto j = getIdentifier(v);
+        if(j != i && !--n) {
+            --cache_idx;
+            return true;
+        }
+        i = j;
+    }
+}
+
 template<typename T>
 void HDF5_Table_Cache<T>::loadAll(multimap<int64_t, T>& dat) {
     T val;
@@ -251,6 +551,16 @@ void HDF5_Table_Cache<T>::loadAll(multimap<int64_t, T>& dat) {
 
 template<typename T>
 bool HDF5_Table_Transfer<T>::transferID(int64_t id, int64_t newID) {
+    if(tableIn.hasIndex()) {
+        if(tableIn.seek(id)) {
+            while(tableIn.next(row) && tableIn.getIdentifier(row) == id) {
+                if(newID >= 0) tableIn.setIdentifier(row, newID);
+                tableOut.push(row);
+            }
+        }
+        return id < tableIn.getIndex().back().id;
+    }
+
     int64_t current_id;
     if(!tableIn.getNRead() && !tableIn.next(row)) return false;
     while((current_id = tableIn.getIdentifier(row)) <= id) {
@@ -5,10 +5,24 @@
 
 void BinaryWriter::end_wtx() {
     if(!wtxdepth) throw -1;
-    if(--wtxdepth) return;
+    if(wtxdepth-- == zcdepth) zcdepth = 0;
+    if(wtxdepth) return;
+
+    if(wrefs.size()) {
+        // gather buffered small fields between referenced blocks
+        vector<wblock_t> v;
+        size_t i0 = 0;
+        for(auto& r: wrefs) {
+            if(r.pos > i0) v.push_back({wbuff.data() + i0, r.pos - i0});
+            v.push_back(r.b);
+            i0 = r.pos;
+        }
+        if(wbuff.size() > i0) v.push_back({wbuff.data() + i0, wbuff.size() - i0});
+        _sendv(v.data(), v.size());
+        wrefs.clear();
+    } else if(wbuff.size()) _send(wbuff.data(), wbuff.size());
+    else return;
 
-    if(!wbuff.size()) return;
-    _send(wbuff.data(), wbuff.size());
     wbuff.clear();
     flush();
 }
@@ -19,16 +33,67 @@ void BinaryWriter::append_write(const char* d, size_t n) {
     std::memcpy(wbuff.data()+n0, d, n);
 }
 
+void BinaryWriter::append_ref(const char* d, size_t n) {
+    if(zcdepth && n >= zcopy_min) wrefs.push_back({wbuff.size(), {d, n}});
+    else append_write(d, n);
+}
+
 template<>
 void BinaryWriter::send<string>(const string& s) {
     start_wtx();
-    send<int>(s.size());
-    append_write(s.data(), s.size());
+    send<uint64_t>(s.size());
+    append_ref(s.data(), s.size());
     end_wtx();
 }
 
 template<>
 void BinaryReader::receive<string>(string& s) {
-    s = string(receive<int>(), ' ');
+    s = string(receive<uint64_t>(), ' ');
     _receive((void*)s.data(), s.size());
 }
+
+void RingBIO::grow(size_t n) {
+    size_t c = std::max(ring.size(), size_t(64));
+    while(c < n) c *= 2;
+    vector<char> r(c);
+    auto n1 = std::min(rlen, ring.size() - rhead);
+    if(n1) std::memcpy(r.data(), ring.data() + rhead, n1);
+    if(rlen > n1) std::memcpy(r.data() + n1, ring.data(), rlen - n1);
+    ring.swap(r);
+    rhead = 0;
+}
+
+void RingBIO::_send(void* vptr, size_t s) {
+    if(!s) return;
+    if(rlen + s > ring.size()) grow(rlen + s);
+    auto v = static_cast<const char*>(vptr);
+    auto w = (rhead + rlen) & (ring.size() - 1);
+    auto n1 = std::min(s, ring.size() - w);
+    std::memcpy(ring.data() + w, v, n1);
+    if(s > n1) std::memcpy(ring.data(), v + n1, s - n1);
+    rlen += s;
+}
+
+void RingBIO::_receive(void* vptr, size_t s) {
+    if(!s) return;
+    if(rlen < s) throw std::domain_error("Insufficient buffered data!");
+    auto v = static_cast<char*>(vptr);
+    auto n1 = std::min(s, ring.size() - rhead);
+    std::memcpy(v, ring.data() + rhead, n1);
+    if(s > n1) std::memcpy(v + n1, ring.data(), s - n1);
+    rhead = (rhead + s) & (ring.size() - 1);
+    if(!(rlen -= s)) rhead = 0;
+}
+
+const char* RingBIO::rview(size_t n) {
+    if(rlen < n) throw std::domain_error("Insufficient buffered data!");
+    if(!n) return ring.data() + rhead;
+    if(rhead + n > ring.size()) { // unwrap contents to make contiguous
+        std::rotate(ring.begin(), ring.begin() + rhead, ring.end());
+        rhead = 0;
+    }
+    auto p = ring.data() + rhead;
+    rhead = (rhead + n) & (ring.size() - 1);
+    if(!(rlen -= n)) rhead = 0;
+    return p;
+}
@@ -5,6 +5,7 @@
 #define BINARYIO_HH
 
 #include <type_traits>
+#include <algorithm> // for std::copy
 
 #include <string>
 using std::string;
@@ -12,6 +13,9 @@ using std::string;
 using std::vector;
 #include <map>
 using std::map;
+#include <array>
+using std::array;
+#include <cstdint>
 #include <cstring> // for std::memcpy
 #include <deque>
 using std::deque;
@@ -24,6 +28,17 @@ using std::deque;
 #define IS_TRIVIALLY_COPYABLE(T) std::is_trivially_copyable<T>::value
 #endif
 
+/// whether vector<T> contents can be transferred as one contiguous block
+#define IS_BULK_COPYABLE(T) (IS_TRIVIALLY_COPYABLE(T) && !std::is_same<T,bool>::value)
+
+/// serialization format version, for BinaryWriter::sendWireHeader()
+#define BINARYIO_WIRE_VERSION 2
+
+template<class T>
+class VarVec;
+template<class T>
+class VarMat;
+
 /// Base binary class receiving input with serializer functions
 class BinaryWriter {
 public:
@@ -35,15 +50,19 @@ public:
     // optional: use to group writes together into a single transfer
     /// start buffered write transaction
     void start_wtx() { wtxdepth++; }
+    /// start zero-copy write transaction: contiguous blocks >= zcopy_min are sent by reference, so must remain unmodified until the outermost end_wtx()
+    void start_zwtx() { if(!zcdepth) zcdepth = wtxdepth + 1; wtxdepth++; }
     /// end buffered write transaction
     void end_wtx();
 
+    size_t zcopy_min = 1 << 15; ///< minimum block size [bytes] for by-reference send in zero-copy transactions
+
     /// Dereference pointers by default
     template<typename T>
     void send(const T* p) { send(*p); }
 
     /// data block send
-    void send(const void* vptr, int size) {
+    void send(const void* vptr, size_t size) {
          start_wtx();
          append_write((char*)vptr, size);
          end_wtx();
@@ -64,12 +83,42 @@ public:
         end_wtx();
     }
 
-    /// vector data send
+    /// vector data send, with 64-bit length prefix [bytes]; contiguous block for trivially-copyable contents
     template<typename T>
     void send(const vector<T>& v) {
         start_wtx();
-        send<int>(v.size()*sizeof(T));
-        for(auto& x: v) send(x);
+        send<uint64_t>(v.size()*sizeof(T));
+        _send_elements(v.data(), v.size());
+        end_wtx();
+    }
+
+    /// fixed-size array data send, block for trivially-copyable contents
+    template<typename T, size_t N, typename std::enable_if<!IS_TRIVIALLY_COPYABLE(T)>::type* = nullptr>
+    void send(const array<T,N>& a) {
+        start_wtx();
+        for(auto& x: a) send(x);
+        end_wtx();
+    }
+
+    /// VarVec data send
+    template<typename T>
+    void send(const VarVec<T>& v) { send(v.getData()); }
+
+    /// VarMat data send
+    template<typename T>
+    void send(const VarMat<T>& m) {
+        start_wtx();
+        send<uint64_t>(m.nRows());
+        send<uint64_t>(m.nCols());
+        send(m.getData());
+        end_wtx();
+    }
+
+    /// send format identifier and BINARYIO_WIRE_VERSION, to check with BinaryReader::receiveWireHeader()
+    void sendWireHeader() {
+        start_wtx();
+        append_write("MPMB", 4);
+        send<uint32_t>(BINARYIO_WIRE_VERSION);
         end_wtx();
     }
 
@@ -87,30 +136,55 @@ public:
 
 protected:
 
+    /// contiguous data block for gathered send
+    struct wblock_t {
+        const char* p;  ///< block start
+        size_t n;       ///< block size [bytes]
+    };
+
     /// blocking data send
-    virtual void _send(void* vptr, int size) = 0;
+    virtual void _send(void* vptr, size_t size) = 0;
+    /// blocking gathered send of nb data blocks, in order; override for native scatter/gather transfer
+    virtual void _sendv(const wblock_t* b, size_t nb) { while(nb--) { _send((void*)b->p, b->n); ++b; } }
     /// flush output
     virtual void flush() { }
 
+    /// send n array elements, as single block
+    template<typename T, typename std::enable_if<IS_BULK_COPYABLE(T)>::type* = nullptr>
+    void _send_elements(const T* p, size_t n) { if(n) append_ref(reinterpret_cast<const char*>(p), n*sizeof(T)); }
+    /// send n array elements individually
+    template<typename T, typename std::enable_if<!IS_BULK_COPYABLE(T)>::type* = nullptr>
+    void _send_elements(const T* p, size_t n) { while(n--) send(*(p++)); }
+
     /// append data block to write buffer
     void append_write(const char* dat, size_t n);
+    /// append data block by reference in zero-copy transaction if large enough; otherwise, copy to write buffer
+    void append_ref(const char* dat, size_t n);
+
+    /// by-reference block in zero-copy transaction
+    struct wref_t {
+        size_t pos;     ///< insertion position in wbuff
+        wblock_t b;     ///< referenced data
+    };
 
     int dataDest = 0;       ///< destination identifier for data send
     size_t wtxdepth = 0;    ///< write transaction depth counter
+    size_t zcdepth = 0;     ///< transaction depth at which zero-copy mode started; 0 for none
     vector<char> wbuff;     ///< deferred write buffer
+    vector<wref_t> wrefs;   ///< by-reference blocks interleaved with wbuff
 };
 
 /// Binary writer with exposed buffer for serialization
 class BinarySerializer: public BinaryWriter {
 public:
-    /// Constructor; starts at wtxDepth 1 to delay buffer clear
-    BinarySerializer() { start_wtx(); }
+    /// Constructor; starts at wtxDepth 1 to delay buffer clear; no by-reference blocks, to keep buf() complete
+    BinarySerializer() { start_wtx(); zcopy_min = SIZE_MAX; }
     /// direct buffer access
     vector<char>& buf() { return wbuff; }
 
 protected:
     /// _send does nothing!
-    void _send(void*, int) override { }
+    void _send(void*, size_t) override { }
 };
 
 
@@ -136,11 +210,38 @@ public:
     template<typename... T>
     void receive(std::tuple<T...>& t) { for(auto& c: t) receive(c); }
 
-    /// vector data receive
+    /// vector data receive, single block for trivially-copyable contents
     template<typename T>
     void receive(vector<T>& v) {
-        v.resize(receive<int>()/sizeof(T));
-        for(auto& x: v) receive(x);
+        v.resize(receive<uint64_t>()/sizeof(T));
+        _receive_elements(v.data(), v.size());
+    }
+
+    /// fixed-size array data receive, block for trivially-copyable contents
+    template<typename T, size_t N, typename std::enable_if<!IS_TRIVIALLY_COPYABLE(T)>::type* = nullptr>
+    void receive(array<T,N>& a) { for(auto& x: a) receive(x); }
+
+    /// VarVec data receive
+    template<typename T>
+    void receive(VarVec<T>& v) { receive(v.getData()); }
+
+    /// VarMat data receive
+    template<typename T>
+    void receive(VarMat<T>& m) {
+        auto nr = receive<uint64_t>();
+        auto nc = receive<uint64_t>();
+        m = VarMat<T>(nr, nc);
+        receive(m.getData());
+        if(m.getData().size() != nr*nc) throw std::runtime_error("Mismatched VarMat data size");
+    }
+
+    /// check stream format identifier from BinaryWriter::sendWireHeader(); throw std::runtime_error on mismatch
+    void receiveWireHeader() {
+        char m[4];
+        _receive(m, sizeof(m));
+        if(memcmp(m, "MPMB", 4)) throw std::runtime_error("Unrecognized binary stream format");
+        auto v = receive<uint32_t>();
+        if(v != BINARYIO_WIRE_VERSION) throw std::runtime_error("Unsupported binary stream version " + std::to_string(v));
     }
 
     /// map data receive
@@ -157,7 +258,14 @@ public:
 protected:
 
     /// blocking data receive
-    virtual void _receive(void* vptr, int size) = 0;
+    virtual void _receive(void* vptr, size_t size) = 0;
+
+    /// receive n array elements, as single block
+    template<typename T, typename std::enable_if<IS_BULK_COPYABLE(T)>::type* = nullptr>
+    void _receive_elements(T* p, size_t n) { if(n) _receive(p, n*sizeof(T)); }
+    /// receive n array elements individually
+    template<typename T, typename std::enable_if<!IS_BULK_COPYABLE(T)>::type* = nullptr>
+    void _receive_elements(T* p, size_t n) { while(n--) receive(*(p++)); }
 
     int dataSrc = 0;        ///< source identifier for data receive
     vector<char> rbuff;     ///< read buffer
@@ -190,8 +298,8 @@ public:
 
 protected:
     /// blocking data receive
-    void _receive(void* vptr, int size) override {
-        if((const char*)pR + size > eR) throw -1;
+    void _receive(void* vptr, size_t size) override {
+        if(size_t((const char*)eR - (const char*)pR) < size) throw -1;
         std::memcpy(vptr,pR,size);
         (const char*&)pR += size;
     }
@@ -209,8 +317,8 @@ public:
 
 protected:
     /// blocking data send
-    void _send(void* vptr, int size) override {
-        if((char*)pW + size > eW) throw -1;
+    void _send(void* vptr, size_t size) override {
+        if(size_t((char*)eW - (char*)pW) < size) throw -1;
         std::memcpy(pW,vptr,size);
         (char*&)pW += size;
     }
@@ -227,13 +335,34 @@ class MemBIO: public MemBReader, public MemBWriter { };
 class DequeBIO: virtual public BinaryIO, protected deque<char> {
 protected:
     /// blocking data send
-    void _send(void* vptr, int s) override { auto v = (char*)vptr; while(s--) push_back(*(v++)); }
+    void _send(void* vptr, size_t s) override { auto v = (char*)vptr; insert(end(), v, v + s); }
     /// blocking data receive
-    void _receive(void* vptr, int s) override {
-        if((int)size() < s) throw std::domain_error("Insufficient buffered data!");
-        auto v = (char*)vptr;
-        while(s--) { *(v++) = front(); pop_front(); }
+    void _receive(void* vptr, size_t s) override {
+        if(size() < s) throw std::domain_error("Insufficient buffered data!");
+        std::copy(begin(), begin() + s, (char*)vptr);
+        erase(begin(), begin() + s);
     }
 };
 
+/// I/O through contiguous growable byte ring buffer; virtual to allow mix-in with BinaryIO inheritance
+class RingBIO: virtual public BinaryIO {
+public:
+    /// number of buffered bytes available to read
+    size_t available() const { return rlen; }
+    /// read next n bytes in place, without copying; valid until next send
+    const char* rview(size_t n);
+
+protected:
+    /// blocking data send
+    void _send(void* vptr, size_t s) override;
+    /// blocking data receive
+    void _receive(void* vptr, size_t s) override;
+    /// grow capacity to hold at least n bytes, moving contents to start
+    void grow(size_t n);
+
+    vector<char> ring;  ///< ring buffer storage, power-of-2 size
+    size_t rhead = 0;   ///< read position in ring
+    size_t rlen = 0;    ///< number of bytes in ring
+};
+
 #endif
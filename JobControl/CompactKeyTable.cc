@@ -0,0 +1,221 @@
+/// \file CompactKeyTable.cc
+
+#include "CompactKeyTable.hh"
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// arena value alignment [bytes]
+static const size_t ckt_align = 16;
+
+/// file header
+struct ckt_header_t {
+    char magic[8];      ///< format identifier
+    uint64_t nE;        ///< number of entries
+    uint64_t nA;        ///< arena size [bytes]
+    uint64_t reserved;  ///< unused (keeps entries and arena aligned)
+};
+
+/// file format identifier
+static const char ckt_magic[8] = {'M','P','M','C','K','T','0','1'};
+
+/// compare entry to key, for binary search
+static bool ckt_less(const CKTLookup::entry_t& e, CKTLookup::key_t k) { return e.key < k; }
+
+const CKTLookup::entry_t* CKTLookup::find(ckey k) const {
+    if(!nE) return nullptr;
+    // branchless binary search for last entry with key <= k
+    auto e = E;
+    for(size_t n = nE; n > 1; ) {
+        auto h = n/2;
+        e = e[h].key <= k.h? e + h : e;
+        n -= h;
+    }
+    return e->key == k.h? e : nullptr;
+}
+
+size_t CKTLookup::validate(const entry_t* e, size_t n, size_t na) {
+    size_t nused = 0;
+    for(size_t i = 0; i < n; ++i) {
+        if(i && e[i].key <= e[i-1].key) throw std::runtime_error("CompactKeyTable index not sorted");
+        if(e[i].off % ckt_align || e[i].off > na || e[i].n > na - e[i].off) throw std::runtime_error("CompactKeyTable entry outside arena");
+        if(!e[i].esize || e[i].n % e[i].esize) throw std::runtime_error("CompactKeyTable entry size mismatch");
+        nused += e[i].n;
+    }
+    return nused;
+}
+
+void CKTLookup::display() const {
+    printf("CompactKeyTable with %zu entries (%zu arena bytes)\n", nE, nA);
+    for(size_t i = 0; i < nE; ++i) {
+        auto& e = E[i];
+        printf("\t* %016llx: type %u, %llu x %u bytes", (unsigned long long)e.key, e.type, (unsigned long long)(e.n/e.esize), e.esize);
+        if(e.n == sizeof(double) && e.type == typeTag<double>()) printf(" -> %g", *reinterpret_cast<const double*>(A + e.off));
+        printf("\n");
+    }
+}
+
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+char* CompactKeyTable::_Set(key_t k, uint32_t type, uint32_t esize, size_t n) {
+    auto it = std::lower_bound(idx.begin(), idx.end(), k, ckt_less);
+    bool found = it != idx.end() && it->key == k;
+    if(found && it->n == n) { // overwrite in place
+        it->type = type;
+        it->esize = esize;
+        return arena.data() + it->off;
+    }
+
+    if(found) {
+        garbage += it->n;
+        it->n = 0;
+    }
+    if(garbage > (1 << 16) && 2*garbage > arena.size()) {
+        auto i = it - idx.begin();
+        compact();
+        it = idx.begin() + i;
+    }
+
+    auto off = (arena.size() + ckt_align - 1) & ~(ckt_align - 1);
+    arena.resize(off + n);
+    if(!found) it = idx.insert(it, entry_t{k, type, esize, off, n});
+    else *it = entry_t{k, type, esize, off, n};
+    sync();
+    return arena.data() + off;
+}
+
+bool CompactKeyTable::Unset(ckey k) {
+    auto it = std::lower_bound(idx.begin(), idx.end(), k.h, ckt_less);
+    if(it == idx.end() || it->key != k.h) return false;
+    garbage += it->n;
+    idx.erase(it);
+    sync();
+    return true;
+}
+
+void CompactKeyTable::compact() {
+    vector<char> a;
+    size_t ntot = 0;
+    for(auto& e: idx) ntot += (e.n + ckt_align - 1) & ~(ckt_align - 1);
+    a.reserve(ntot);
+    for(auto& e: idx) {
+        auto off = (a.size() + ckt_align - 1) & ~(ckt_align - 1);
+        a.resize(off + e.n);
+        std::memcpy(a.data() + off, arena.data() + e.off, e.n);
+        e.off = off;
+    }
+    arena.swap(a);
+    garbage = 0;
+    sync();
+}
+
+void CompactKeyTable::setContents(vector<entry_t>&& i, vector<char>&& a) {
+    auto nused = validate(i.data(), i.size(), a.size());
+    idx = std::move(i);
+    arena = std::move(a);
+    garbage = arena.size() - nused;
+    sync();
+}
+
+/// element-wise sum of n bytes of T
+template<typename T>
+static void ckt_add(char* d, const char* s, size_t n) {
+    auto pd = reinterpret_cast<T*>(d);
+    auto ps = reinterpret_cast<const T*>(s);
+    for(size_t i = 0; i < n/sizeof(T); ++i) pd[i] += ps[i];
+}
+
+CompactKeyTable& CompactKeyTable::operator+=(const CKTLookup& o) {
+    for(size_t i = 0; i < o.size(); ++i) {
+        auto& e = o.entries()[i];
+        auto src = o.arenaPtr() + e.off;
+        auto it = std::lower_bound(idx.begin(), idx.end(), e.key, ckt_less);
+        if(it == idx.end() || it->key != e.key) {
+            auto d = _Set(e.key, e.type, e.esize, e.n);
+            std::memcpy(d, src, e.n);
+            continue;
+        }
+        if(it->type != e.type || it->esize != e.esize || it->n != e.n) throw std::domain_error("Incompatible accumulation types!");
+
+        auto d = arena.data() + it->off;
+        auto w = e.type;
+        /* */if(w == typeTag<  int8_t>()) ckt_add<int8_t>(d, src, e.n);
+        else if(w == typeTag< int16_t>()) ckt_add<int16_t>(d, src, e.n);
+        else if(w == typeTag< int32_t>()) ckt_add<int32_t>(d, src, e.n);
+        else if(w == typeTag< int64_t>()) ckt_add<int64_t>(d, src, e.n);
+        else if(w == typeTag< uint8_t>()) ckt_add<uint8_t>(d, src, e.n);
+        else if(w == typeTag<uint16_t>()) ckt_add<uint16_t>(d, src, e.n);
+        else if(w == typeTag<uint32_t>()) ckt_add<uint32_t>(d, src, e.n);
+        else if(w == typeTag<uint64_t>()) ckt_add<uint64_t>(d, src, e.n);
+        else if(w == typeTag<   float>()) ckt_add<float>(d, src, e.n);
+        else if(w == typeTag<  double>()) ckt_add<double>(d, src, e.n);
+        else if(w == typeTag<long double>()) ckt_add<long double>(d, src, e.n);
+        else throw std::domain_error("Non-accumulable type!");
+    }
+    return *this;
+}
+
+void CompactKeyTable::writeFile(const string& fname) const {
+    ckt_header_t h;
+    std::memcpy(h.magic, ckt_magic, sizeof(h.magic));
+    h.nE = idx.size();
+    h.nA = arena.size();
+    h.reserved = 0;
+
+    // write to temporary, then move into place
+    auto ftmp = fname + "_tmp";
+    auto f = fopen(ftmp.c_str(), "wb");
+    if(!f) throw std::runtime_error("Failed to open '" + ftmp + "' for writing");
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = ok && (idx.empty() || fwrite(idx.data(), sizeof(entry_t), idx.size(), f) == idx.size());
+    ok = ok && (arena.empty() || fwrite(arena.data(), 1, arena.size(), f) == arena.size());
+    ok = !fclose(f) && ok;
+    if(!ok || rename(ftmp.c_str(), fname.c_str())) {
+        remove(ftmp.c_str());
+        throw std::runtime_error("Failed to write '" + fname + "'");
+    }
+}
+
+void CompactKeyTable::readFile(const string& fname) {
+    MappedKeyTable M(fname);
+    *this = CompactKeyTable(M);
+}
+
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+MappedKeyTable::MappedKeyTable(const string& fname) {
+    auto fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0) throw std::runtime_error("Failed to open '" + fname + "'");
+    struct stat st;
+    if(fstat(fd, &st) || size_t(st.st_size) < sizeof(ckt_header_t)) {
+        close(fd);
+        throw std::runtime_error("Invalid CompactKeyTable file '" + fname + "'");
+    }
+    msize = st.st_size;
+    m = mmap(nullptr, msize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(m == MAP_FAILED) {
+        m = nullptr;
+        throw std::runtime_error("Failed to map '" + fname + "'");
+    }
+
+    auto h = static_cast<const ckt_header_t*>(m);
+    auto p = static_cast<const char*>(m) + sizeof(ckt_header_t);
+    if(std::memcmp(h->magic, ckt_magic, sizeof(ckt_magic)) || h->nE > (msize - sizeof(ckt_header_t))/sizeof(entry_t)
+       || h->nA != msize - sizeof(ckt_header_t) - h->nE*sizeof(entry_t)) {
+        munmap(m, msize);
+        throw std::runtime_error("Invalid CompactKeyTable file '" + fname + "'");
+    }
+    E = reinterpret_cast<const entry_t*>(p);
+    nE = h->nE;
+    A = p + nE*sizeof(entry_t);
+    nA = h->nA;
+    try { validate(E, nE, nA); }
+    catch(...) { munmap(m, msize); throw; }
+}
+
+MappedKeyTable::~MappedKeyTable() { if(m) munmap(m, msize); }
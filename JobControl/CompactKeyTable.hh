@@ -0,0 +1,230 @@
+/// \file CompactKeyTable.hh Hashed-key : typed-value table in one contiguous arena, without ROOT; mmap-able file form
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef COMPACTKEYTABLE_HH
+#define COMPACTKEYTABLE_HH
+
+#include "BinaryIO.hh"
+#include "Hash64.hh"
+
+/// Read-only lookup over sorted entry index and value arena (owned by derived class)
+class CKTLookup {
+public:
+    /// hashed key
+    typedef uint64_t key_t;
+
+    /// key, from pre-computed hash or from string
+    struct ckey {
+        /// from hash
+        ckey(key_t k): h(k) { }
+        /// from string (SipHash)
+        ckey(const string& s): h(hash64(s)) { }
+        /// from C string
+        ckey(const char* s): h(hash64(string(s))) { }
+        key_t h;    ///< hashed value
+    };
+
+    /// index entry for one value array
+    struct entry_t {
+        key_t key;      ///< hashed key
+        uint32_t type;  ///< element type tag
+        uint32_t esize; ///< element size [bytes]
+        uint64_t off;   ///< offset in arena
+        uint64_t n;     ///< data size [bytes]
+    };
+
+    /// element type tag: size, with flags for arithmetic, signed, integral (as KeyData::typeID)
+    template<typename T>
+    static constexpr uint32_t typeTag() {
+        return std::min(sizeof(T), size_t(999)) + (std::is_arithmetic<T>::value?
+            1000 + (std::is_signed<T>::value? 2000 : 0) + (std::is_integral<T>::value? 4000 : 0) : 0);
+    }
+
+    /// typed, contiguous read-only view of value array
+    template<typename T>
+    struct view_t {
+        const T* p = nullptr;   ///< first element
+        size_t n = 0;           ///< number of elements
+
+        /// whether key was found
+        explicit operator bool() const { return p; }
+        /// number of elements
+        size_t size() const { return n; }
+        /// element access
+        const T& operator[](size_t i) const { return p[i]; }
+        /// start of data
+        const T* begin() const { return p; }
+        /// end of data
+        const T* end() const { return p + n; }
+    };
+
+    /// number of entries
+    size_t size() const { return nE; }
+    /// index entries, sorted by key
+    const entry_t* entries() const { return E; }
+    /// value arena
+    const char* arenaPtr() const { return A; }
+    /// value arena size [bytes]
+    size_t arenaSize() const { return nA; }
+    /// find entry for key, or nullptr
+    const entry_t* find(ckey k) const;
+    /// check whether key is present
+    bool has(ckey k) const { return find(k); }
+
+    /// typed view of array value (empty if key absent; throws on type mismatch)
+    template<typename T>
+    view_t<T> view(ckey k) const {
+        view_t<T> v;
+        auto e = find(k);
+        if(!e) return v;
+        checkType<T>(*e);
+        v.p = reinterpret_cast<const T*>(A + e->off);
+        v.n = e->n / sizeof(T);
+        return v;
+    }
+    /// get scalar value; return whether found
+    template<typename T>
+    bool Get(ckey k, T& x) const {
+        auto e = find(k);
+        if(!e) return false;
+        checkType<T>(*e);
+        if(e->n != sizeof(T)) throw std::domain_error("CompactKeyTable value is not scalar");
+        std::memcpy(&x, A + e->off, sizeof(T));
+        return true;
+    }
+    /// get scalar value (required to exist)
+    template<typename T>
+    T Get(ckey k) const {
+        T x{};
+        if(!Get(k, x)) throw std::runtime_error("CompactKeyTable missing requested key");
+        return x;
+    }
+    /// get scalar value with default
+    template<typename T>
+    T GetDefault(ckey k, T dflt) const { Get(k, dflt); return dflt; }
+    /// get string value (empty if absent)
+    string GetString(ckey k) const { auto v = view<char>(k); return string(v.begin(), v.end()); }
+    /// get string value; return whether found
+    bool Get(ckey k, string& s) const { auto v = view<char>(k); if(v) s.assign(v.begin(), v.end()); return bool(v); }
+    /// get vector value; return whether found
+    template<typename T>
+    bool Get(ckey k, vector<T>& x) const { auto v = view<T>(k); if(v) x.assign(v.begin(), v.end()); return bool(v); }
+
+    /// debugging dump to stdout
+    void display() const;
+
+protected:
+    /// throw on element type mismatch
+    template<typename T>
+    static void checkType(const entry_t& e) {
+        if(e.type != typeTag<T>() || e.esize != sizeof(T)) throw std::domain_error("CompactKeyTable value type mismatch");
+    }
+    /// check sorted, aligned, in-bounds entries; return referenced arena bytes
+    static size_t validate(const entry_t* e, size_t n, size_t na);
+
+    const entry_t* E = nullptr; ///< sorted entries
+    size_t nE = 0;              ///< number of entries
+    const char* A = nullptr;    ///< value arena
+    size_t nA = 0;              ///< arena size [bytes]
+};
+
+/// Modifiable hashed-key table: sorted index plus contiguous (16-byte aligned values) arena
+class CompactKeyTable: public CKTLookup {
+public:
+    /// Default constructor
+    CompactKeyTable() { }
+    /// Copy constructor
+    CompactKeyTable(const CompactKeyTable& o): CKTLookup(), idx(o.idx), arena(o.arena), garbage(o.garbage) { sync(); }
+    /// Copy assignment
+    CompactKeyTable& operator=(const CompactKeyTable& o) { idx = o.idx; arena = o.arena; garbage = o.garbage; sync(); return *this; }
+    /// Copy from other lookup (e.g. MappedKeyTable)
+    explicit CompactKeyTable(const CKTLookup& o): CKTLookup() { setContents(vector<entry_t>(o.entries(), o.entries() + o.size()), vector<char>(o.arenaPtr(), o.arenaPtr() + o.arenaSize())); }
+
+    /// set array value from n elements at p
+    template<typename T>
+    void SetArray(ckey k, const T* p, size_t n) {
+        static_assert(IS_TRIVIALLY_COPYABLE(T), "CompactKeyTable values must be trivially copyable");
+        auto d = _Set(k.h, typeTag<T>(), sizeof(T), n*sizeof(T));
+        if(n) std::memcpy(d, p, n*sizeof(T));
+    }
+    /// set scalar value
+    template<typename T>
+    void Set(ckey k, const T& x) { SetArray(k, &x, 1); }
+    /// set vector value
+    template<typename T>
+    void Set(ckey k, const vector<T>& v) { SetArray(k, v.data(), v.size()); }
+    /// set string value
+    void Set(ckey k, const string& s) { SetArray(k, s.data(), s.size()); }
+    /// set string value from C string
+    void Set(ckey k, const char* s) { Set(k, string(s)); }
+    /// remove value; return whether present
+    bool Unset(ckey k);
+    /// clear all contents
+    void clear() { idx.clear(); arena.clear(); garbage = 0; sync(); }
+
+    /// modifiable typed array pointer (nullptr if absent; throws on type mismatch); valid until next Set
+    template<typename T>
+    T* GetArrayPtr(ckey k) { auto v = view<T>(k); return const_cast<T*>(v.p); }
+
+    /// element-wise sum of matching arithmetic entries; entries only in o are copied
+    CompactKeyTable& operator+=(const CKTLookup& o);
+
+    /// arena bytes no longer referenced by any entry
+    size_t garbageBytes() const { return garbage; }
+    /// repack arena, discarding unreferenced space
+    void compact();
+
+    /// replace contents (validating index against arena)
+    void setContents(vector<entry_t>&& i, vector<char>&& a);
+    /// index entries
+    const vector<entry_t>& index() const { return idx; }
+    /// arena contents
+    const vector<char>& arenaData() const { return arena; }
+
+    /// write mmap-able file
+    void writeFile(const string& fname) const;
+    /// read file contents
+    void readFile(const string& fname);
+
+protected:
+    /// allocate (or re-use same-size) n-byte storage for key; return pointer to fill
+    char* _Set(key_t k, uint32_t type, uint32_t esize, size_t n);
+    /// update lookup pointers after storage changes
+    void sync() { E = idx.data(); nE = idx.size(); A = arena.data(); nA = arena.size(); }
+
+    vector<entry_t> idx;    ///< entries sorted by key
+    vector<char> arena;     ///< value storage
+    size_t garbage = 0;     ///< unreferenced arena bytes
+};
+
+/// Read-only CompactKeyTable file mapped into memory
+class MappedKeyTable: public CKTLookup {
+public:
+    /// Constructor, mapping file
+    explicit MappedKeyTable(const string& fname);
+    /// Destructor, unmapping file
+    ~MappedKeyTable();
+    /// no copy
+    MappedKeyTable(const MappedKeyTable&) = delete;
+    /// no assignment
+    MappedKeyTable& operator=(const MappedKeyTable&) = delete;
+
+protected:
+    void* m = nullptr;  ///< mapped region
+    size_t msize = 0;   ///< mapped size
+};
+
+/// Send CompactKeyTable
+template<>
+inline void BinaryWriter::send(const CompactKeyTable& kt) { send(kt.index()); send(kt.arenaData()); }
+/// Receive CompactKeyTable
+template<>
+inline void BinaryReader::receive(CompactKeyTable& kt) {
+    vector<CKTLookup::entry_t> i;
+    vector<char> a;
+    receive(i);
+    receive(a);
+    kt.setContents(std::move(i), std::move(a));
+}
+
+#endif
@@ -0,0 +1,51 @@
+/// \file CompressedBIO.hh Block-compressed (optionally multi-threaded) BinaryWriter/BinaryReader streams
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef COMPRESSEDBIO_HH
+#define COMPRESSEDBIO_HH
+
+#include "BinaryIO.hh"
+#include "BlockCompress.hh"
+#include <istream>
+
+/// Binary writer compressing into another BinaryWriter; stream completed by close() or on destruction
+class CompressedBWriter: virtual public BinaryWriter {
+public:
+    /// Constructor, with codec, level (-1 for default), block size, and compression threads (0 for all CPUs)
+    explicit CompressedBWriter(BinaryWriter& o, BlockCodec c = CODEC_ZLIB, int lvl = -1, size_t bsize = 1 << 20, unsigned int nthreads = 0):
+    Z([&o](const char* d, size_t n) { o.send(d, n); }, c, lvl, bsize, nthreads) { }
+
+    /// complete compressed stream
+    void close() { Z.close(); }
+    /// compressor
+    const BlockCompressWriter& compressor() const { return Z; }
+
+protected:
+    /// blocking data send
+    void _send(void* vptr, size_t size) override { Z.write(vptr, size); }
+
+    BlockCompressWriter Z;  ///< compressor
+};
+
+/// Binary reader decompressing block stream
+class CompressedBReader: virtual public BinaryReader {
+public:
+    /// Constructor, from compressed data source
+    explicit CompressedBReader(const BlockDecompressReader::source_t& s, unsigned int nthreads = 0): Z(s, nthreads) { }
+    /// Constructor, from istream
+    explicit CompressedBReader(std::istream& i, unsigned int nthreads = 0):
+    Z([&i](char* d, size_t n) { if(!i.read(d, n)) throw std::runtime_error("Compressed input read failed"); }, nthreads) { }
+
+    /// whether at end of compressed stream
+    bool atEnd() { return Z.atEnd(); }
+
+protected:
+    /// blocking data receive
+    void _receive(void* vptr, size_t size) override {
+        if(Z.read(vptr, size) != size) throw std::runtime_error("Compressed stream ended before requested read");
+    }
+
+    BlockDecompressReader Z;    ///< decompressor
+};
+
+#endif
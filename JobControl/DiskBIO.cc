@@ -2,8 +2,14 @@
 
 #include "DiskBIO.hh"
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <fcntl.h>
-#include <cstdlib> // for system(...)
+#include <errno.h>
+#include <string.h> // for strerror
+#include <sys/uio.h>
+#include <climits> // for IOV_MAX
+#include <cstdlib> // for system(...), posix_memalign
+#include <new> // for std::bad_alloc
 
 int runSysCmd(const string& cmd) {
     int ret = std::system(cmd.c_str());
@@ -15,23 +21,319 @@ int runSysCmd(const string& cmd) {
     return ret;
 }
 
-void FDBinaryWriter::_send(void* vptr, int size) {
-    if(!vptr || fOut < 0 || size == -1) throw std::logic_error("invalid object write");
-    if(size != write(fOut, vptr, size)) throw std::runtime_error("Can't write file");
+/// allocate page-aligned I/O buffer
+static iobuf_t aligned_iobuf(size_t n) {
+    void* p = nullptr;
+    if(posix_memalign(&p, 4096, n)) throw std::bad_alloc();
+    return iobuf_t(static_cast<char*>(p), free);
 }
 
-void FDBinaryReader::openIn(const string& s) {
+/// O_DIRECT alignment requirement [bytes]
+static constexpr size_t DIRECT_ALIGN = 4096;
+
+void FDBinaryWriter::setBufferSize(size_t n) {
+    if(fOut >= 0) writeOut();
+    obsize = n;
+    obuf.reset();
+    wfree.clear();
+    if(isDirect && (!obsize || obsize % DIRECT_ALIGN)) endDirect();
+}
+
+void FDBinaryWriter::setWriteBehind(unsigned int n) {
+    if(fOut >= 0) writeOut();
+    stopOut();
+    nBehind = n;
+}
+
+void FDBinaryWriter::endDirect() {
+    if(!isDirect) return;
+    isDirect = false;
+    if(fOut >= 0) fcntl(fOut, F_SETFL, fcntl(fOut, F_GETFL) & ~O_DIRECT);
+}
+
+void FDBinaryWriter::queueOut() {
+    if(!wthread.joinable()) {
+        wstop = false;
+        wthread = std::thread(&FDBinaryWriter::writeBehind, this);
+    }
+    std::unique_lock<std::mutex> l(wmutex);
+    wcv.wait(l, [this] { return wfull.size() < nBehind || werr.size(); });
+    if(werr.size()) throw std::runtime_error(werr);
+    wfull.push_back(std::move(obuf));
+    if(wfree.size()) {
+        obuf = std::move(wfree.back());
+        wfree.pop_back();
+    }
+    l.unlock();
+    wcv.notify_all();
+    if(!obuf) obuf = aligned_iobuf(obsize);
+    obn = 0;
+}
+
+void FDBinaryWriter::writeBehind() {
+    std::unique_lock<std::mutex> l(wmutex);
+    while(true) {
+        wcv.wait(l, [this] { return wfull.size() || wstop; });
+        if(!wfull.size()) return;
+        auto b = std::move(wfull.front());
+        wfull.pop_front();
+        wbusy = true;
+        l.unlock();
+
+        string e;
+        size_t n = 0;
+        while(n < obsize) {
+            auto m = write(fOut, b.get() + n, obsize - n);
+            if(m <= 0) { e = string("Can't write file: ") + strerror(errno); break; }
+            n += m;
+        }
+
+        l.lock();
+        wbusy = false;
+        wfree.push_back(std::move(b));
+        if(e.size() && !werr.size()) werr = e;
+        wcv.notify_all();
+    }
+}
+
+void FDBinaryWriter::drainOut() {
+    if(!wthread.joinable()) return;
+    std::unique_lock<std::mutex> l(wmutex);
+    wcv.wait(l, [this] { return !wbusy && !wfull.size(); });
+    if(werr.size()) {
+        auto e = werr;
+        werr.clear();
+        throw std::runtime_error(e);
+    }
+}
+
+void FDBinaryWriter::stopOut() {
+    if(!wthread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> l(wmutex);
+        wstop = true;
+    }
+    wcv.notify_all();
+    wthread.join();
+    wfull.clear();
+    werr.clear();
+}
+
+void FDBinaryWriter::writeOut(const wblock_t* b, size_t nb) {
+    if(fOut < 0) throw std::logic_error("invalid object write");
+    drainOut();
+    if(isDirect && (nb || obn % DIRECT_ALIGN)) endDirect();
+    vector<iovec> v;
+    if(obn) v.push_back({obuf.get(), obn});
+    for(size_t i = 0; i < nb; ++i) if(b[i].n) v.push_back({(void*)b[i].p, b[i].n});
+    auto iv = v.data();
+    nb = v.size();
+    while(nb) {
+        auto n = writev(fOut, iv, int(std::min(nb, size_t(IOV_MAX))));
+        if(n <= 0) throw std::runtime_error("Can't write file");
+        // advance past completed blocks; resume partially-written block
+        while(nb && size_t(n) >= iv->iov_len) { n -= iv->iov_len; ++iv; --nb; }
+        if(n) {
+            iv->iov_base = (char*)iv->iov_base + n;
+            iv->iov_len -= n;
+        }
+    }
+    obn = 0;
+}
+
+void FDBinaryWriter::_send(void* vptr, size_t size) {
+    if(!vptr) throw std::logic_error("invalid object write");
+    wblock_t b = {static_cast<const char*>(vptr), size};
+    _sendv(&b, 1);
+}
+
+void FDBinaryWriter::_sendv(const wblock_t* b, size_t nb) {
+    if(!obsize) { writeOut(b, nb); return; }
+    if(!obuf) obuf = aligned_iobuf(obsize);
+    // whole buffers passed on from source, or copied through aligned/queued buffers
+    const bool copyall = isDirect || nBehind;
+
+    for(; nb; --nb, ++b) {
+        auto p = b->p;
+        auto n = b->n;
+        while(obn + n >= obsize) {
+            // top off buffer; write it out with whole buffer-sized blocks directly from source
+            auto m = obsize - obn;
+            std::memcpy(obuf.get() + obn, p, m);
+            obn = obsize;
+            p += m;
+            n -= m;
+            if(copyall) {
+                if(nBehind) queueOut();
+                else writeOut();
+                continue;
+            }
+            wblock_t d = {p, n - n % obsize};
+            writeOut(&d, 1);
+            p += d.n;
+            n -= d.n;
+        }
+        std::memcpy(obuf.get() + obn, p, n);
+        obn += n;
+    }
+}
+
+void FDBinaryWriter::sync() {
+    if(fOut < 0) return;
+    writeOut();
+    if(fsync(fOut)) throw std::runtime_error("failed to fsync output file");
+    tsync = std::chrono::steady_clock::now();
+}
+
+void FDBinaryWriter::flush() {
+    if(durability == SYNC_EACH) sync();
+    else if(durability == SYNC_PERIODIC &&
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - tsync).count() >= sync_interval) sync();
+}
+
+void FDBinaryReader::_receive(void* vptr, size_t size) {
+    if(fIn < 0) throw std::runtime_error("No input file open!");
+    auto p = static_cast<char*>(vptr);
+    while(size) {
+        if(!ibn) {
+            if(!ibsize || (!nAhead && size >= ibsize)) {
+                // large (or unbuffered) reads directly to destination
+                auto n = read(fIn, p, size);
+                if(n <= 0) throw std::runtime_error("Requested read failed!");
+                p += n;
+                size -= n;
+                continue;
+            }
+            if(!fill()) throw std::runtime_error("Requested read failed!");
+        }
+        auto m = std::min(size, ibn);
+        std::memcpy(p, ip, m);
+        ip += m;
+        ibn -= m;
+        p += m;
+        size -= m;
+    }
+}
+
+bool FDBinaryReader::fill() {
+    if(!rthread.joinable()) {
+        if(!ibuf) ibuf = aligned_iobuf(ibsize);
+        auto n = read(fIn, ibuf.get(), ibsize);
+        if(n <= 0) return false;
+        ip = ibuf.get();
+        ibn = n;
+        return true;
+    }
+
+    std::unique_lock<std::mutex> l(rmutex);
+    if(rhold) {
+        rbufs[rb].filled = false;
+        rb = (rb + 1) % rbufs.size();
+        rhold = false;
+        rcv.notify_all();
+    }
+    rcv.wait(l, [this] { return rbufs[rb].filled; });
+    if(rerr.size()) throw std::runtime_error(rerr);
+    if(!rbufs[rb].n) return false;
+    rhold = true;
+    ip = rbufs[rb].p.get();
+    ibn = rbufs[rb].n;
+    return true;
+}
+
+void FDBinaryReader::readAhead() {
+    size_t k = 0;
+    std::unique_lock<std::mutex> l(rmutex);
+    while(true) {
+        rcv.wait(l, [this, k] { return rstop || !rbufs[k].filled; });
+        if(rstop) return;
+        auto& b = rbufs[k];
+        l.unlock();
+
+        if(!b.p) b.p = aligned_iobuf(ibsize);
+        string e;
+        size_t n = 0;
+        while(n < ibsize) {
+            auto m = read(fIn, b.p.get() + n, ibsize - n);
+            if(m < 0) e = string("Read-ahead failed: ") + strerror(errno);
+            if(m <= 0) break;
+            n += m;
+        }
+
+        l.lock();
+        b.n = n;
+        b.filled = true;
+        if(e.size()) rerr = e;
+        rcv.notify_all();
+        if(!n) return;
+        k = (k + 1) % rbufs.size();
+    }
+}
+
+void FDBinaryReader::startAhead() {
+    if(fIn < 0 || !nAhead || !ibsize || rthread.joinable()) return;
+    struct stat st;
+    if(fstat(fIn, &st) || !S_ISREG(st.st_mode)) return;
+    rbufs = vector<rbuf_t>(nAhead);
+    rb = 0;
+    rhold = rstop = false;
+    rerr.clear();
+    rthread = std::thread(&FDBinaryReader::readAhead, this);
+}
+
+void FDBinaryReader::setBufferSize(size_t n, unsigned int nahead) {
+    if(ibn || rthread.joinable()) throw std::logic_error("FDBinaryReader buffer change with data buffered");
+    ibsize = n;
+    ibuf.reset();
+    nAhead = nahead;
+    startAhead();
+}
+
+void FDBinaryReader::closeIn() {
+    if(rthread.joinable()) {
+        {
+            std::lock_guard<std::mutex> l(rmutex);
+            rstop = true;
+        }
+        rcv.notify_all();
+        rthread.join();
+        rbufs.clear();
+    }
+    ip = nullptr;
+    ibn = 0;
     if(fIn >= 0) close(fIn);
+    fIn = -1;
+}
+
+void FDBinaryReader::openIn(const string& s) {
+    closeIn();
     fIn = s.size()? open(s.c_str(), O_RDONLY) : -1;
+    startAhead();
 }
 
 void FDBinaryWriter::openOut(const string& s) {
-    if(fOut >= 0) close(fOut);
-    fOut = s.size()? open(s.c_str(), O_WRONLY | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR) : -1;
-    if(s.size() && fOut < 0) throw std::runtime_error("Failure opening output file!");
+    closeOut();
+    if(!s.size()) return;
+    int flags = O_WRONLY | O_CREAT | O_APPEND;
+    isDirect = directIO && obsize && !(obsize % DIRECT_ALIGN);
+    if(isDirect) {
+        fOut = open(s.c_str(), flags | O_DIRECT, S_IRUSR | S_IWUSR);
+        // unsupported by filesystem, or appending to unaligned file size
+        struct stat st;
+        if(fOut < 0) isDirect = false;
+        else if(fstat(fOut, &st) || st.st_size % DIRECT_ALIGN) endDirect();
+    }
+    if(fOut < 0) fOut = open(s.c_str(), flags, S_IRUSR | S_IWUSR);
+    if(fOut < 0) throw std::runtime_error("Failure opening output file!");
 }
 
 void FDBinaryWriter::closeOut() {
-    if(fOut >= 0 && close(fOut)) throw std::runtime_error("Failure closing output file!");
+    if(fOut < 0) return;
+    if(durability == SYNC_NONE) writeOut();
+    else sync();
+    stopOut();
+    isDirect = false;
+    auto f = fOut;
     fOut = -1;
+    if(close(f)) throw std::runtime_error("Failure closing output file!");
 }
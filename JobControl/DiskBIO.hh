@@ -7,6 +7,12 @@
 #include <iostream>
 #include <fstream>
 #include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <cstdlib> // for free
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 /// Binary write to iostream objects
 class IOStreamBWrite: virtual public BinaryWriter {
@@ -18,7 +24,7 @@ protected:
     std::ostream& fOut;   ///< output stream
 
     /// blocking data send
-    void _send(void* vptr, int size) override { fOut.write((char*)vptr, size); }
+    void _send(void* vptr, size_t size) override { fOut.write((char*)vptr, size); }
 };
 
 /// Binary read from iostream objects
@@ -30,42 +36,94 @@ public:
 protected:
     std::istream& fIn;  ///< input stream
     /// blocking data receive
-    void _receive(void* vptr, int size) override { fIn.read((char*)vptr, size); }
+    void _receive(void* vptr, size_t size) override { fIn.read((char*)vptr, size); }
 };
 
 
-/// Binary write via Unix file descriptors
+/// page-aligned I/O buffer
+typedef std::unique_ptr<char, void(*)(void*)> iobuf_t;
+
+/// Binary write via Unix file descriptors, with user-space block buffering, optional background write-behind, and configurable durability
 class FDBinaryWriter: virtual public BinaryWriter {
 public:
+    /// when to fsync written data to storage
+    enum durability_t {
+        SYNC_NONE,      ///< never (leave to OS)
+        SYNC_CLOSE,     ///< on closeOut()
+        SYNC_PERIODIC,  ///< at transaction end when at least sync_interval since last sync; and on close
+        SYNC_EACH       ///< at every transaction end
+    };
+
     /// Constructor
-    explicit FDBinaryWriter(int fdOut = -1): fOut(fdOut) { }
+    explicit FDBinaryWriter(int fdOut = -1, durability_t d = SYNC_CLOSE): durability(d), fOut(fdOut) { }
     /// Constructor with filenames
-    explicit FDBinaryWriter(const string& nOut) { openOut(nOut); }
+    explicit FDBinaryWriter(const string& nOut, durability_t d = SYNC_CLOSE): durability(d) { openOut(nOut); }
     /// Destructor
-    ~FDBinaryWriter() { FDBinaryWriter::flush(); closeOut(); }
+    ~FDBinaryWriter() { closeOut(); }
 
-    /// open output file
+    /// open output file (with O_DIRECT if directIO and supported)
     void openOut(const string& s);
-    /// close input file
+    /// close output file, writing buffered data and syncing per durability
     void closeOut();
     /// check if output open
     bool outIsOpen() const { return fOut != -1; }
+    /// write out buffered data and fsync
+    void sync();
+    /// set user-space write buffer size [bytes] (0 for unbuffered)
+    void setBufferSize(size_t n);
+    /// set number of filled buffers queued for background thread writing (0 for writing in caller)
+    void setWriteBehind(unsigned int n);
+
+    durability_t durability;    ///< fsync policy
+    double sync_interval = 10;  ///< minimum time [s] between SYNC_PERIODIC syncs
+    /// open with O_DIRECT, bypassing page cache for large one-shot dumps; reverts to cached writes at first partial-buffer flush (sync, close)
+    bool directIO = false;
 
 protected:
     /// blocking data send
-    void _send(void* vptr, int size) override;
-    /// flush output
-    void flush() override { if(fOut >= 0 && fsync(fOut)) throw std::runtime_error("failed to fsync output file"); }
-
-    int fOut = -1;   ///< output file descriptor
+    void _send(void* vptr, size_t size) override;
+    /// blocking gathered send, via writev
+    void _sendv(const wblock_t* b, size_t nb) override;
+    /// transaction-end flush, syncing per durability
+    void flush() override;
+
+    /// write out buffered data followed by gathered blocks
+    void writeOut(const wblock_t* b = nullptr, size_t nb = 0);
+    /// pass full buffer to write-behind thread, replacing with free buffer
+    void queueOut();
+    /// wait for write-behind queue to empty; rethrow write errors
+    void drainOut();
+    /// stop write-behind thread
+    void stopOut();
+    /// write-behind thread loop
+    void writeBehind();
+    /// turn off O_DIRECT for remaining writes
+    void endDirect();
+
+    int fOut = -1;                  ///< output file descriptor
+    size_t obsize = 1 << 20;        ///< write buffer size [bytes]
+    iobuf_t obuf{nullptr, free};    ///< write buffer being filled
+    size_t obn = 0;                 ///< bytes in write buffer
+    bool isDirect = false;          ///< whether fOut currently has O_DIRECT
+    std::chrono::steady_clock::time_point tsync = std::chrono::steady_clock::now();  ///< time of last sync
+
+    unsigned int nBehind = 0;       ///< maximum queued buffers for write-behind
+    deque<iobuf_t> wfull;           ///< full buffers queued for writing
+    vector<iobuf_t> wfree;          ///< written buffers for re-use
+    bool wbusy = false;             ///< whether write-behind thread is writing a buffer
+    bool wstop = false;             ///< write-behind thread stop request
+    string werr;                    ///< write-behind error
+    std::thread wthread;            ///< write-behind thread
+    std::mutex wmutex;              ///< write-behind queue lock
+    std::condition_variable wcv;    ///< write-behind queue change notification
 };
 
 
-/// Binary read via Unix file descriptors
+/// Binary read via Unix file descriptors, with user-space block buffering and optional background read-ahead
 class FDBinaryReader: virtual public BinaryReader {
 public:
     /// Constructor
-    explicit FDBinaryReader(int fdIn = -1): fIn(fdIn) { }
+    explicit FDBinaryReader(int fdIn = -1): fIn(fdIn) { startAhead(); }
     /// Constructor with filenames
     explicit FDBinaryReader(const string& nIn) { openIn(nIn); }
     /// Destructor
@@ -74,18 +132,44 @@ public:
     /// open input file
     void openIn(const string& s);
     /// close input file
-    void closeIn() { if(fIn >= 0) close(fIn); fIn = -1; }
+    void closeIn();
     /// check if input open
     bool inIsOpen() const { return fIn != -1; }
+    /// set user-space read buffer size [bytes] (0 for unbuffered), and number of buffers read ahead by background thread (regular files only); not allowed with data buffered or read ahead
+    void setBufferSize(size_t n, unsigned int nahead = 0);
 
 protected:
     /// blocking data receive
-    void _receive(void* vptr, int size) override {
-        if(fIn < 0) throw std::runtime_error("No input file open!");
-        if(size != read(fIn, vptr, size)) throw std::runtime_error("Requested read failed!");
-    }
-
-    int fIn = -1;    ///< input file descriptor
+    void _receive(void* vptr, size_t size) override;
+
+    /// load next buffer of data; return false at end of input
+    bool fill();
+    /// start read-ahead thread, if configured and the input is a regular file
+    void startAhead();
+    /// read-ahead thread loop
+    void readAhead();
+
+    int fIn = -1;                   ///< input file descriptor
+    size_t ibsize = 1 << 20;        ///< read buffer size [bytes]
+    iobuf_t ibuf{nullptr, free};    ///< synchronous read buffer
+    const char* ip = nullptr;       ///< current buffer read position
+    size_t ibn = 0;                 ///< bytes remaining in current buffer
+
+    unsigned int nAhead = 0;        ///< number of read-ahead buffers
+    /// read-ahead buffer
+    struct rbuf_t {
+        iobuf_t p{nullptr, free};   ///< data
+        size_t n = 0;               ///< bytes read; 0 at end of input
+        bool filled = false;        ///< whether loaded by read-ahead thread (ready for consumer)
+    };
+    vector<rbuf_t> rbufs;           ///< read-ahead buffers ring
+    size_t rb = 0;                  ///< current read-ahead buffer
+    bool rhold = false;             ///< whether consumer holds rbufs[rb]
+    bool rstop = false;             ///< read-ahead thread stop request
+    string rerr;                    ///< read-ahead error
+    std::thread rthread;            ///< read-ahead thread
+    std::mutex rmutex;              ///< read-ahead buffers lock
+    std::condition_variable rcv;    ///< read-ahead buffer change notification
 };
 
 /// Utility to run command-line command, returning exit code
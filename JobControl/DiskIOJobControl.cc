@@ -2,64 +2,231 @@
 // -- Michael P. Mendenhall, LLNL 2019
 
 #include "DiskIOJobControl.hh"
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
 
-/*
-void DiskIOJobControl::init(int argc, char **argv) {
-    rank = 0;
-    for(int i=1; i<argc-1; i++) if(argv[i][0]=='-' && argv[i][1]=='N') rank = atoi(argv[i+1]);
-    if(verbose > 2) printf("Initializing DiskIOJobControl[%i] for '%s'\n", rank, argv[0]);
+DirWatch::DirWatch(const string& d): dir(d) { setNotify(true); }
+
+void DirWatch::setNotify(bool b) {
+    if(fd >= 0) close(fd);
+    fd = -1;
+#ifdef __linux__
+    if(!b) return;
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd >= 0 && inotify_add_watch(fd, dir.c_str(), IN_MOVED_TO | IN_CLOSE_WRITE) < 0) {
+        close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+void DirWatch::wait() {
+    ++nWaits;
+    if(fd >= 0) {
+        pollfd p{fd, POLLIN, 0};
+        if(poll(&p, 1, int(1000*dt) + 1) > 0) {
+            char buf[4096];
+            while(read(fd, buf, sizeof(buf)) > 0) { }
+            ++nEvents;
+            reset();
+            return;
+        }
+    } else usleep(useconds_t(1e6*dt));
+    dt = std::min(2*dt, dtMax);
+}
+
+////////////////////////////////
+////////////////////////////////
+
+void DiskIOChannel::_receive(void* vptr, size_t size) {
+    if(ibuf.size() - ipos < size) throw std::runtime_error("DiskIO message shorter than requested data");
+    std::memcpy(vptr, ibuf.data() + ipos, size);
+    ipos += size;
+}
+
+string DiskIOChannel::fileName(const string& kind, int k, size_t seq) const {
+    return data_bpath + "/" + kind + "_" + std::to_string(k) + "_" + std::to_string(seq) + ".dat";
 }
 
-DiskIOJobControl::~DiskIOJobControl() {
-    if(!rank) runSysCmd("rm -f " + data_bpath + "/CommBuffer_0_to_*.dat");
+void DiskIOChannel::packRecord(vector<char>& b, int wid) {
+    int32_t w = wid;
+    uint64_t n = obuf.size();
+    b.insert(b.end(), (char*)&w, (char*)&w + sizeof(w));
+    b.insert(b.end(), (char*)&n, (char*)&n + sizeof(n));
+    b.insert(b.end(), obuf.begin(), obuf.end());
+    obuf.clear();
 }
 
-void DiskIOJobControl::clearOut() {
-    std::stringstream fn;
-    fn << "rm -f " << data_bpath << "/CommBuffer_" << rank << "_to_" << dataDest << ".dat";
-    if(verbose > 4) printf("clearOut %s\n", fn.str().c_str());
-    runSysCmd(fn.str());
+void DiskIOChannel::commitFile(const string& fname, const vector<char>& b) {
+    auto i = fname.rfind('/');
+    auto tmpname = fname.substr(0, i + 1) + "." + fname.substr(i + 1) + ".tmp";
+    unlink(tmpname.c_str());
+    {
+        FDBinaryWriter W(tmpname, durability);
+        W.send(b.data(), b.size());
+    }
+    if(rename(tmpname.c_str(), fname.c_str())) throw std::runtime_error("Failure committing '" + fname + "'");
+    ++nCommits;
 }
 
-void DiskIOJobControl::clearIn() {
-    srcpos[dataSrc] = 0;
-    std::stringstream fn;
-    fn << "rm -f " << data_bpath << "/CommBuffer_" << dataSrc << "_to_" << rank << ".dat";
-    if(verbose > 4) printf("clearIn %s\n", fn.str().c_str());
-    runSysCmd(fn.str());
+bool DiskIOChannel::loadFile(const string& fname, deque<record_t>& rs) {
+    int f = open(fname.c_str(), O_RDONLY);
+    if(f < 0) {
+        if(errno == ENOENT) return false;
+        throw std::runtime_error("Failure opening '" + fname + "'");
+    }
+    struct stat s;
+    if(fstat(f, &s)) { close(f); throw std::runtime_error("Failure reading '" + fname + "'"); }
+    vector<char> b(s.st_size);
+    size_t n = 0;
+    while(n < b.size()) {
+        auto r = read(f, b.data() + n, b.size() - n);
+        if(r <= 0) { close(f); throw std::runtime_error("Failure reading '" + fname + "'"); }
+        n += r;
+    }
+    close(f);
+    unlink(fname.c_str());
+    ++nLoads;
+
+    const size_t hsize = sizeof(int32_t) + sizeof(uint64_t);
+    for(size_t p = 0; p < b.size();) {
+        if(b.size() - p < hsize) throw std::runtime_error("Truncated record in '" + fname + "'");
+        int32_t w;
+        uint64_t l;
+        std::memcpy(&w, b.data() + p, sizeof(w));
+        std::memcpy(&l, b.data() + p + sizeof(w), sizeof(l));
+        p += hsize;
+        if(b.size() - p < l) throw std::runtime_error("Truncated record in '" + fname + "'");
+        rs.push_back({w, vector<char>(b.begin() + p, b.begin() + p + l)});
+        p += l;
+    }
+    return true;
 }
 
-void DiskIOJobControl::_send(void* vptr, int size) {
-    std::stringstream fn;
-    fn << data_bpath << "/CommBuffer_" << rank << "_to_" << dataDest << ".dat";
-    FDBinaryWriter b(fn.str());
-    b.send(vptr, size);
+////////////////////////////////
+////////////////////////////////
+
+DiskIOJobControl::DiskIOJobControl(const string& d, int nw, int b):
+DiskIOChannel(d), nWorkers(std::max(nw, 1)), batch(std::max(b, 1)),
+pending(nWorkers + 1), npending(nWorkers + 1), seqOut(nWorkers + 1), seqIn(nWorkers + 1) {
+    ntasks = nWorkers * batch;
+    for(int i = 0; i < ntasks; ++i) available.insert(i);
 }
 
-void DiskIOJobControl::_receive(void* vptr, int size) {
-    auto& p = srcpos[dataSrc];
+void DiskIOJobControl::dispatchJob(JobSpec& JS) {
+    MultiJobControl::dispatchJob(JS);
+    auto k = wproc(JS.wid);
+    packRecord(pending[k], JS.wid);
+    if(++npending[k] >= batch) commit(k);
+}
 
-    std::stringstream fn;
-    fn << data_bpath << "/CommBuffer_" << dataSrc << "_to_" << rank << ".dat";
-    std::ifstream fin;
+void DiskIOJobControl::commit(int k) {
+    if(!npending[k]) return;
+    commitFile(fileName("jobs", k, seqOut[k]++), pending[k]);
+    pending[k].clear();
+    npending[k] = 0;
+}
 
-    do { // wait for file available
-        fin.open(fn.str(), std::ios_base::binary);
-        if(fin.good() && fin.is_open()) break;
-        fin.close();
-        usleep(100000);
-    } while(true);
+void DiskIOJobControl::pollResults() {
+    std::set<int> ks;
+    for(auto& kv: jobs) ks.insert(wproc(kv.first));
+    deque<record_t> rs;
+    for(auto k: ks) while(loadFile(fileName("done", k, seqIn[k]), rs)) ++seqIn[k];
+    if(rs.size()) watch.reset();
+    for(auto& r: rs) results[r.wid] = std::move(r.d);
+}
 
-    do { // wait for data available
-        fin.seekg(0, std::ios_base::end);
-        auto fsize = fin.tellg();
-        if(fsize >= int(p+size)) break;
-        usleep(100000);
-    } while(true);
+bool DiskIOJobControl::_isRunning(int wid) {
+    auto it = results.find(wid);
+    if(it == results.end() && !polled) {
+        pollResults();
+        polled = true;
+        it = results.find(wid);
+    }
+    if(it == results.end()) return true;
+    ibuf = std::move(it->second);
+    ipos = 0;
+    results.erase(it);
+    available.insert(wid);
+    return false;
+}
+
+int DiskIOJobControl::_allocWorker() {
+    while(available.empty()) {
+        checkJobs();
+        if(!available.empty()) break;
+        _waitEvent();
+    }
+    int wid = *available.begin();
+    available.erase(available.begin());
+    return wid;
+}
+
+int DiskIOJobControl::_idleWorker(int wid) {
+    for(auto it = available.begin(); it != available.end(); ++it) {
+        if(wproc(*it) == wproc(wid)) continue;
+        int w = *it;
+        available.erase(it);
+        return w;
+    }
+    return -1;
+}
+
+void DiskIOJobControl::_waitEvent() {
+    for(int k = 1; k <= nWorkers; ++k) commit(k);
+    watch.wait();
+    polled = false;
+}
+
+void DiskIOJobControl::stopWorkers() {
+    waitComplete();
+    waitSuperseded();
+    for(int k = 1; k <= nWorkers; ++k) {
+        JobSpec JS;
+        JS.wid = (k - 1)*batch;
+        send(JS);
+        packRecord(pending[k], JS.wid);
+        ++npending[k];
+        commit(k);
+    }
+}
+
+////////////////////////////////
+////////////////////////////////
+
+void DiskIOJobWorker::_receive(void* vptr, size_t size) {
+    if(ipos == ibuf.size()) nextRecord();
+    DiskIOChannel::_receive(vptr, size);
+}
+
+void DiskIOJobWorker::nextRecord() {
+    if(curWid >= 0) {
+        packRecord(rbatch, curWid);
+        ++nresults;
+        curWid = -1;
+    }
+    while(inbox.empty()) {
+        commitResults();
+        if(loadFile(fileName("jobs", wnum, seqIn), inbox)) {
+            ++seqIn;
+            watch.reset();
+        } else watch.wait();
+    }
+    curWid = inbox.front().wid;
+    ibuf = std::move(inbox.front().d);
+    ipos = 0;
+    inbox.pop_front();
+}
 
-    fin.seekg(p);
-    fin.read((char*)vptr, size);
-    p += size;
-    fin.close();
+void DiskIOJobWorker::commitResults() {
+    if(!nresults) return;
+    commitFile(fileName("done", wnum, seqOut++), rbatch);
+    rbatch.clear();
+    nresults = 0;
 }
-*/
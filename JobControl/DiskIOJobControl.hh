@@ -1,58 +1,164 @@
 /// \file DiskIOJobControl.hh MultiJobControl using files on disk for communication
 
+/*
+Controller and worker processes exchange batched messages through a shared directory:
+    jobs_<k>_<seq>.dat  controller to worker process k: JobSpec and startJob data for one or more job slots
+    done_<k>_<seq>.dat  worker process k to controller: endJob data for each completed job in a batch
+Each file is a sequence of records [int32 worker ID][uint64 size][size bytes of data],
+written to a hidden temporary name then atomically rename()d into place, so a visible file is always complete.
+The receiver reads the next expected sequence number only (no directory scans), and deletes it after loading.
+New files are awaited via inotify where available, with adaptive exponential backoff between re-checks
+(also covering network filesystems, where remote writes do not generate local notifications).
+Jobs must send all start-of-job data in startJob, and the worker's full reply ends with the job.
+Use a fresh (empty) exchange directory for each run.
+*/
+
 #ifndef DISKIOJOBCONTROL_HH
 #define DISKIOJOBCONTROL_HH
 
 #include "MultiJobControl.hh"
 #include "DiskBIO.hh"
+#include <set>
 
-/*
-/// Distribute and collect jobs via filesystem
-class DiskIOJobControl: public MultiJobControl {
+/// Wait for new files in a directory: inotify events where supported, with adaptive backoff timeout
+class DirWatch {
 public:
+    /// Constructor
+    explicit DirWatch(const string& d);
     /// Destructor
-    ~DiskIOJobControl();
-    /// initialize
-    void init(int argc, char** argv);
+    ~DirWatch() { setNotify(false); }
+    /// no copying
+    DirWatch(const DirWatch&) = delete;
+    /// no assignment
+    DirWatch& operator=(const DirWatch&) = delete;
 
-    /// blocking data send
-    void _send(void* vptr, int size) override;
-    /// blocking data receive
-    void _receive(void* vptr, int size) override;
+    /// block until directory change notification or backoff timeout; lengthens timeout if nothing happened
+    void wait();
+    /// reset to shortest timeout, after finding new data
+    void reset() { dt = dtMin; }
+    /// enable or disable inotify events (polling only when disabled or unsupported)
+    void setNotify(bool b);
+    /// whether change notifications are active
+    bool hasNotify() const { return fd >= 0; }
 
-    /// clear output buffer to current destination
-    void clearOut() override;
-    /// clear input buffer from current source
-    void clearIn() override;
+    double dtMin = 1e-4;    ///< shortest wait timeout [s]
+    double dtMax = 0.1;     ///< longest wait timeout [s]
+    size_t nWaits = 0;      ///< number of wait() calls
+    size_t nEvents = 0;     ///< number of waits ended by notification
 
-    string data_bpath = "./";   ///< base path to data exchange directory
+protected:
+    string dir;             ///< watched directory
+    int fd = -1;            ///< inotify file descriptor
+    double dt = dtMin;      ///< current wait timeout [s]
+};
+
+/// Batched, rename-committed message files channel base for DiskIOJobControl and DiskIOJobWorker
+class DiskIOChannel: virtual public BinaryIO {
+public:
+    /// Constructor, with exchange directory
+    explicit DiskIOChannel(const string& d): data_bpath(d), watch(d) { }
+
+    const string data_bpath;    ///< base path to data exchange directory
+    FDBinaryWriter::durability_t durability = FDBinaryWriter::SYNC_NONE;   ///< fsync policy for committed files
+    DirWatch watch;             ///< new file notification
+    size_t nCommits = 0;        ///< number of files written
+    size_t nLoads = 0;          ///< number of files read
 
 protected:
-    map<int, size_t> srcpos;    ///< input buffer position from given source rank
+    /// one job's message data
+    struct record_t {
+        int wid;                ///< worker ID
+        vector<char> d;         ///< message contents
+    };
+
+    /// buffer data send
+    void _send(void* vptr, size_t size) override { obuf.insert(obuf.end(), (char*)vptr, (char*)vptr + size); }
+    /// read from current message
+    void _receive(void* vptr, size_t size) override;
+
+    /// exchange file name of given kind for worker process k, sequence number seq
+    string fileName(const string& kind, int k, size_t seq) const;
+    /// append output buffer to batch as record for worker ID wid; clear output buffer
+    void packRecord(vector<char>& b, int wid);
+    /// write batch contents to file, committed by atomic rename
+    void commitFile(const string& fname, const vector<char>& b);
+    /// load and delete file if present, appending its records; return whether found
+    bool loadFile(const string& fname, deque<record_t>& rs);
+
+    vector<char> obuf;          ///< outgoing message
+    vector<char> ibuf;          ///< incoming message
+    size_t ipos = 0;            ///< read position in ibuf
 };
 
-/// Distribute and collect jobs via filesystem
-class DiskIOJobControl: public MultiJobWorker {
+/// Distribute and collect jobs via filesystem, to DiskIOJobWorker processes 1...nWorkers each with `batch` job slots
+class DiskIOJobControl: public DiskIOChannel, public MultiJobControl {
 public:
-    /// initialize
-    void init(int argc, char** argv);
+    /// Constructor
+    DiskIOJobControl(const string& d, int nw, int b = 1);
+
+    /// wait for jobs (and superseded duplicates, up to drainTimeout) to complete, then send stop job to all worker processes
+    void stopWorkers();
+
+    const int nWorkers;         ///< number of worker processes
+    const int batch;            ///< number of job slots per worker process, sent together in one file
+
+protected:
+    /// clear output buffer
+    void clearOut() override { obuf.clear(); }
+    /// clear input buffer
+    void clearIn() override { ibuf.clear(); ipos = 0; }
 
-    /// blocking data send
-    void _send(void* vptr, int size) override;
-    /// blocking data receive
-    void _receive(void* vptr, int size) override;
+    /// Check if a job is running or completed
+    bool _isRunning(int wid) override;
+    /// Allocate an available job slot, blocking if necessary
+    int _allocWorker() override;
+    /// Take an available job slot on a different worker process from wid, without blocking
+    int _idleWorker(int wid) override;
+    /// Return unused allocated job slot
+    void _freeWorker(int wid) override { available.insert(wid); }
+    /// commit pending batches; wait for file events
+    void _waitEvent() override;
+    /// Queue job to batch for worker process, committing full batches
+    void dispatchJob(JobSpec& JS) override;
 
-    /// clear output buffer to current destination
-    void clearOut() override;
-    /// clear input buffer from current source
-    void clearIn() override;
+    /// worker process for job slot
+    int wproc(int wid) const { return wid/batch + 1; }
+    /// commit pending jobs batch to worker process k
+    void commit(int k);
+    /// load available result files for processes with running jobs
+    void pollResults();
 
+    vector<vector<char>> pending;   ///< uncommitted jobs batch for each worker process
+    vector<int> npending;           ///< number of jobs in each pending batch
+    vector<size_t> seqOut;          ///< next jobs file number for each worker process
+    vector<size_t> seqIn;           ///< next results file number for each worker process
+    map<int, vector<char>> results; ///< received results by worker ID, awaiting endJob
+    std::set<int> available;        ///< available job slots
+    bool polled = false;            ///< whether results have been polled since last wait
+};
+
+/// Worker process k for DiskIOJobControl
+class DiskIOJobWorker: public DiskIOChannel, public MultiJobWorker {
+public:
+    /// Constructor
+    DiskIOJobWorker(const string& d, int k): DiskIOChannel(d), wnum(k) { }
 
-    string data_bpath = "./";   ///< base path to data exchange directory
+    const int wnum;             ///< worker process number
 
 protected:
-    map<int, size_t> srcpos;    ///< input buffer position from given source rank
+    /// read from current job message, moving to next job when exhausted
+    void _receive(void* vptr, size_t size) override;
+    /// close out current job's reply; load next job, committing replies and waiting for jobs file as needed
+    void nextRecord();
+    /// commit batched replies
+    void commitResults();
+
+    deque<record_t> inbox;      ///< received jobs not yet started
+    vector<char> rbatch;        ///< uncommitted replies
+    size_t nresults = 0;        ///< number of replies in rbatch
+    size_t seqIn = 0;           ///< next jobs file number
+    size_t seqOut = 0;          ///< next results file number
+    int curWid = -1;            ///< current job's worker ID
 };
-*/
 
 #endif
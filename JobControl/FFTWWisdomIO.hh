@@ -0,0 +1,39 @@
+/// \file FFTWWisdomIO.hh Transfer of FFTW planner wisdom over BinaryIO channels; MPI broadcast from rank 0
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef FFTWWISDOMIO_HH
+#define FFTWWISDOMIO_HH
+
+#include "FFTW_Wisdom.hh"
+#include "MPIJobControl.hh"
+
+/// send accumulated wisdom for precision T
+template<typename T = double>
+void sendFFTWWisdom(BinaryWriter& B) { B.send(FFTWWisdom<T>::exportString()); }
+
+/// receive and import wisdom sent by sendFFTWWisdom; false if invalid
+template<typename T = double>
+bool receiveFFTWWisdom(BinaryReader& B) { return FFTWWisdom<T>::importString(B.receive<string>()); }
+
+/// collective call on all ranks (before job distribution): pass rank 0 wisdom down binomial tree of point-to-point channels; no-op without MPI
+template<typename T = double>
+void broadcastFFTWWisdom() {
+#ifdef WITH_MPI
+    const int n = MPIBinaryIO::mpisize;
+    const int r = MPIBinaryIO::mpirank;
+    int m = 1;
+    if(r) {
+        // parent is rank with highest bit cleared
+        while(2*m <= r) m *= 2;
+        MPIPeerIO P(r - m);
+        receiveFFTWWisdom<T>(P);
+        m *= 2;
+    }
+    for(; r + m < n; m *= 2) {
+        MPIPeerIO P(r + m);
+        sendFFTWWisdom<T>(P);
+    }
+#endif
+}
+
+#endif
@@ -2,43 +2,88 @@
 // -- Michael P. Mendenhall, LLNL 2019
 
 #include "KTAccumJob.hh"
+#include <memory>
+
+void KTAccumJobComm::initCombos() {
+    if(combos.size()) return;
+    for(auto& kv: kt) {
+        if(kv.first.substr(0,7) != "Combine") continue;
+        combos.push_back(kv.second->Get<string>());
+        auto cd = kt.FindKey(combos.back());
+        if(!cd) throw std::runtime_error("Missing key for combining '" + combos.back() + "'");
+
+        objs.push_back(nullptr);
+        auto tp = cd->What();
+        if(tp == kMESS_OBJECT) {
+            objs.back() = cd->GetROOT<TH1>();
+            if(objs.back()) objs.back()->Reset();
+        } else cd->clearV();
+    }
+    nReturned = combos.size();
+}
+
+void KTAccumJobComm::accumulate(size_t i, KeyData* kd) {
+    auto cd = kt.FindKey(combos[i]);
+    auto tp = cd->What();
+    if(tp != kd->What()) throw std::logic_error("Mismatched types for combining '" + combos[i] + "'");
+
+    if(tp == kMESS_OBJECT) {
+        auto h = kd->GetROOT<TH1>();
+        assert(h && objs[i]);
+        objs[i]->Add(h);
+        delete h;
+    } else *cd += *kd;
+    delete kd;
+}
 
 void KTAccumJobComm::endJob(BinaryIO& B) {
-    if(!combos.size()) {
-        for(auto& kv: kt) {
-            if(kv.first.substr(0,7) != "Combine") continue;
-            combos.push_back(kv.second->Get<string>());
-            auto cd = kt.FindKey(combos.back());
-            if(!cd) throw std::runtime_error("Missing key for combining '" + combos.back() + "'");
-
-            objs.push_back(nullptr);
-            auto tp = cd->What();
-            if(tp == kMESS_OBJECT) {
-                objs.back() = cd->GetROOT<TH1>();
-                if(objs.back()) objs.back()->Reset();
-            } else cd->clearV();
+    if(treeReduce && !reducing) return; // results held on workers until gather()
+    initCombos();
+
+    if(reducing) { // tree root returns everything; others, nothing
+        KeyTable K;
+        ObjectPassing::receiveOrPass(B, K);
+        for(size_t i=0; i<combos.size(); i++) {
+            auto it = K.find(combos[i]);
+            if(it == K.end() || !it->second) continue;
+            accumulate(i, it->second);
+            it->second = nullptr;
         }
+        return;
     }
 
+    auto OP = dynamic_cast<ObjectPassing*>(&B);
     for(size_t i=0; i<combos.size(); i++) {
-        auto cd = kt.FindKey(combos[i]);
-        auto kd = B.receive<KeyData*>();
+        KeyData* kd = nullptr;
+        if(OP) OP->receiveObject(kd);
+        else kd = B.receive<KeyData*>();
         if(!kd) throw std::logic_error("Failed to receive combining data  '" + combos[i] + "'");
+        accumulate(i, kd);
+    }
+}
 
-        auto tp = cd->What();
-        if(tp != kd->What()) throw std::logic_error("Mismatched types for combining '" + combos[i] + "'");
-
-        if(tp == kMESS_OBJECT) {
-            auto h = kd->GetROOT<TH1>();
-            assert(h && objs[i]);
-            objs[i]->Add(h);
-            delete h;
-        } else *cd += *kd;
+void KTAccumJobComm::discardJob(BinaryIO& B) {
+    auto OP = dynamic_cast<ObjectPassing*>(&B);
+    for(size_t i=0; i<nReturned; i++) {
+        KeyData* kd = nullptr;
+        if(OP) OP->receiveObject(kd);
+        else kd = B.receive<KeyData*>();
         delete kd;
     }
 }
 
 void KTAccumJobComm::gather() {
+    if(treeReduce) {
+        initCombos();
+        JobSpec JS;
+        JS.uid = rUID;
+        JS.wclass = CLASS_ID(KTReduceJob);
+        JS.C = this;
+        reducing = true;
+        MultiJobControl::JC->broadcastJob(JS);
+        reducing = false;
+    }
+
     for(size_t i=0; i<combos.size(); i++) {
         if(kt.FindKey(combos[i])->What() == kMESS_OBJECT) kt.Set(combos[i], *objs[i]);
         delete objs[i];
@@ -48,9 +93,16 @@ void KTAccumJobComm::gather() {
 }
 
 void KTAccumJobComm::launchAccumulate(int uid) {
+    rUID = uid;
+    if(treeReduce) kt.Set("TreeReduce", 1);
+    else kt.Unset("TreeReduce");
     vector<JobSpec> vJS;
     int nsamp = MultiJobControl::JC->nChunk();
     kt.Get("NSamples", nsamp);
+    if(guidedMin) {
+        MultiJobControl::JC->submitGuided(*this, nsamp, workerType(), uid, guidedMin);
+        return;
+    }
     splitJobs(vJS, MultiJobControl::JC->nChunk(), nsamp, workerType(), uid);
     for(auto& j: vJS) MultiJobControl::JC->submitJob(j);
 }
@@ -59,21 +111,92 @@ void KTAccumJobComm::launchAccumulate(int uid) {
 
 REGISTER_FACTORYOBJECT(KTAccumJob, JobWorker)
 
+/// merge kd into kt[k], taking ownership of kd
+static void mergeKeyData(KeyTable& kt, const string& k, KeyData* kd) {
+    auto cd = kt.FindKey(k);
+    if(!cd) { kt._Set(k, kd); return; }
+    if(cd->What() != kd->What()) throw std::logic_error("Mismatched types for combining '" + k + "'");
+
+    if(cd->What() == kMESS_OBJECT) {
+        auto h0 = cd->GetROOT<TH1>();
+        auto h1 = kd->GetROOT<TH1>();
+        assert(h0 && h1);
+        h0->Add(h1);
+        kt.Set(k, *h0);
+        delete h0;
+        delete h1;
+    } else *cd += *kd;
+    delete kd;
+}
+
+map<int, KeyTable> KTAccumJob::partials;
+
 void KTAccumJob::run(const JobSpec& J, BinaryIO& B) {
     JS = J;
-    B.receive(kt);
+    ObjectPassing::receiveOrPass(B, kt);
     runAccum();
     MultiJobWorker::JW->signalDone();
-    returnCombined(B);
+    if(kt.GetDefault("TreeReduce", 0)) mergeCombined();
+    else returnCombined(B);
+}
+
+void KTAccumJob::mergeCombined() {
+    auto& P = partials[JS.uid];
+    for(auto& kv: kt) {
+        if(kv.first.substr(0,7) != "Combine") continue;
+        auto c = kv.second->Get<string>();
+        auto kd = kt.FindKey(c);
+        if(!kd) throw std::runtime_error(("Missing return value for combine '"+c+"'").c_str());
+        mergeKeyData(P, c, new KeyData(*kd));
+    }
 }
 
 void KTAccumJob::returnCombined(BinaryIO& B) {
+    auto OP = dynamic_cast<ObjectPassing*>(&B);
+    if(!OP) B.start_zwtx(); // results sent directly from kt
     for(auto& kv: kt) {
         if(kv.first.substr(0,7) != "Combine") continue;
         auto c = kv.second->Get<string>();
         auto kd = kt.FindKey(c);
         if(!kd) throw std::runtime_error(("Missing return value for combine '"+c+"'").c_str());
-        B.send(*kd);
+        if(OP) { // hand over ownership to in-process controller
+            OP->sendObject(kd);
+            kt[c] = nullptr;
+        } else B.send(*kd);
     }
+    if(!OP) B.end_wtx();
 }
 
+
+///////////////////////////////////////////////
+
+REGISTER_FACTORYOBJECT(KTReduceJob, JobWorker)
+
+void KTReduceJob::run(const JobSpec& J, BinaryIO& B) {
+    auto& P = KTAccumJob::partials[J.uid];
+    int i = J.N0;       // this worker's index
+    int n = J.N1;       // number of workers
+
+    // merge children's (already-reduced) results
+    for(int c = 2*i+1; c <= 2*i+2 && c < n; ++c) {
+        std::unique_ptr<BinaryIO> ch(MultiJobWorker::JW->peerChannel(c));
+        if(!ch) throw std::logic_error("Tree reduction requires worker peer channels");
+        KeyTable K;
+        ch->receive(K);
+        for(auto& kv: K) {
+            if(kv.second) mergeKeyData(P, kv.first, kv.second);
+            kv.second = nullptr;
+        }
+    }
+    // pass up tree
+    if(i) {
+        std::unique_ptr<BinaryIO> ch(MultiJobWorker::JW->peerChannel((i-1)/2));
+        if(!ch) throw std::logic_error("Tree reduction requires worker peer channels");
+        ch->send(P);
+    }
+
+    MultiJobWorker::JW->signalDone();
+    if(i) ObjectPassing::sendOrPass(B, KeyTable());
+    else ObjectPassing::sendOrPass(B, std::move(P));
+    KTAccumJob::partials.erase(J.uid);
+}
@@ -15,12 +15,16 @@ public:
 
     KeyTable kt;    ///< associated KeyTable
 
-    /// start-of-job communication (send instruction details)
-    void startJob(BinaryIO& B) override { B.send(kt); }
+    /// start-of-job communication (send instruction details; copy passed to in-process workers)
+    void startJob(BinaryIO& B) override { if(!reducing) ObjectPassing::sendOrPass(B, kt); }
     /// end-of-job communication (get returnCombined() results)
     void endJob(BinaryIO& B) override;
+    /// duplicate runs allowed for directly-returned accumulation jobs
+    bool speculative() const override { return !treeReduce && !reducing; }
+    /// receive and drop superseded duplicate results
+    void discardJob(BinaryIO& B) override;
 
-    /// collect accumulated objects back into kt
+    /// collect accumulated objects back into kt (after jobs complete); tree-reduces worker results if treeReduce
     void gather();
 
     /// get correct worker class ID
@@ -29,9 +33,20 @@ public:
     /// launch accumulation jobs
     void launchAccumulate(int uid = 0);
 
+    size_t guidedMin = 0;   ///< if nonzero, launch as guided-scheduled chunks of at least this many samples
+    bool treeReduce = false;///< hold results on workers, combined pairwise by KTReduceJob in gather(), instead of returning every job
+
 protected:
+    /// set up combos, objs on first use
+    void initCombos();
+    /// accumulate (and delete) received data for combos[i]
+    void accumulate(size_t i, KeyData* kd);
+
     vector<string> combos;  ///< accumulation object names
     vector<TH1*> objs;      ///< accumulation TH1's
+    size_t nReturned = 0;   ///< number of combining objects returned by each job (retained past gather(), for discardJob)
+    int rUID = 0;           ///< uid of launched accumulation jobs
+    bool reducing = false;  ///< whether receiving gather() tree-reduction results
 };
 
 /// Base job working with KTAccumJobComm
@@ -45,9 +60,21 @@ protected:
     virtual void runAccum() { printf("KTAccumJob does nothing for "); JS.display(); }
     /// Return 'combine' entries from a KeyTable
     void returnCombined(BinaryIO& B);
+    /// Merge 'combine' entries into partials[JS.uid]
+    void mergeCombined();
 
     JobSpec JS;     ///< current job info
     KeyTable kt;    ///< received KeyTable data
+
+public:
+    static map<int, KeyTable> partials; ///< worker-side merged 'combine' results by job uid, for tree reduction
+};
+
+/// Binary-tree reduction of KTAccumJob::partials across workers (broadcast by KTAccumJobComm::gather)
+class KTReduceJob: public JobWorker {
+public:
+    /// receive and merge children's results; pass to parent, or controller from root
+    void run(const JobSpec& J, BinaryIO& B) override;
 };
 
 
@@ -92,16 +92,16 @@ bool KeyTable::_Set(const string& s, KeyData* v) {
 template<>
 void BinaryWriter::send<KeyData>(const KeyData& M) {
     start_wtx();
-    auto ds = M.wSize()-2*sizeof(UInt_t);
-    send<UInt_t>(ds);
+    uint64_t ds = M.wSize()-2*sizeof(UInt_t);
+    send<uint64_t>(ds);
     send<UInt_t>(M.What());
-    append_write(M.data(), ds);
+    append_ref(M.data(), ds);
     end_wtx();
 }
 
 template<>
 KeyData* BinaryReader::receive<KeyData*>() {
-    UInt_t s = receive<UInt_t>();
+    auto s = receive<uint64_t>();
     UInt_t w = receive<UInt_t>();
     auto d = new KeyData(w, s);
     _receive((void*)d->data(), s);
@@ -110,7 +110,7 @@ KeyData* BinaryReader::receive<KeyData*>() {
 
 template<>
 void BinaryReader::receive(KeyData& d) {
-    UInt_t s = receive<UInt_t>();
+    auto s = receive<uint64_t>();
     Int_t w = receive<UInt_t>();
     d = KeyData(w,s);
     _receive((void*)d.data(), s);
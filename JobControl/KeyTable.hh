@@ -7,6 +7,7 @@
 #include "BinaryIO.hh"
 #include <TMessage.h>
 #include <TObject.h>
+#include <climits>
 
 #if BOOST_VERSION < 106900
 #include <boost/functional/hash.hpp>
@@ -25,7 +26,7 @@ public:
     /// Polymorphic contents type information
     enum contents_t {
         kMESS_BINARY = 20000,       ///< generic binary blob
-        kMESS_ARRAY  = 30000        ///< array type [][][UInt_t data size in bytes][data...]
+        kMESS_ARRAY  = 30000        ///< array type [][][uint64_t data size in bytes][data...]
     };
 
     /// identifiers for data types --- compose with kMESS_BINARY / kMESS_ARRAY
@@ -117,9 +118,11 @@ public:
 
     /// Vector size for specified type
     template<typename T>
-    UInt_t vSize() const {
+    size_t vSize() const {
         if(What() < kMESS_ARRAY) throw std::runtime_error("Incorrect data type for array");
-        return (*(int*)data())/sizeof(T);
+        uint64_t n;
+        std::memcpy(&n, data(), sizeof(n));
+        return n/sizeof(T);
     }
     /// Written data size [bytes]
     size_t wSize() const { assert((int)wsize <= BufferSize()); return wsize; }
@@ -128,13 +131,13 @@ public:
     template<typename T>
     T* GetArrayPtr() {
         assert(What() >= kMESS_ARRAY);
-        return (T*)(data()+sizeof(int));
+        return (T*)(data()+sizeof(uint64_t));
     }
     /// Retrieve pointer to start of non-ROOT data block
     template<typename T>
     const T* GetArrayPtr() const {
         assert(What() >= kMESS_ARRAY);
-        return (const T*)(data()+sizeof(int));
+        return (const T*)(data()+sizeof(uint64_t));
     }
 
     /// contents sum operation, automatic for built-in arithmetic types and arrays thereof
@@ -152,7 +155,7 @@ public:
             if(n != kd.vSize<T>()) throw std::domain_error("Incompatible array sizes!");
             auto p0 = GetArrayPtr<T>();
             auto p1 = kd.GetArrayPtr<T>();
-            for(UInt_t i=0; i<n; i++) *(p0++) += *(p1++);
+            for(size_t i=0; i<n; i++) p0[i] += p1[i];
         }
     }
 
@@ -161,7 +164,7 @@ public:
     void clearV(const T c = {}) {
         auto n = vSize<T>();
         auto p0 = GetArrayPtr<T>();
-        for(UInt_t i=0; i<n; i++) *(p0++) = c;
+        std::fill(p0, p0 + n, c);
     }
 
     /// debugging display
@@ -194,9 +197,16 @@ protected:
     void setData(const T&x) { whut(); send(x); std::memset(fBufCur, 0, fBufMax-fBufCur); SetReadMode(); }
 
     /// append data to current write point
-    void _send(void* vptr, int size) override { WriteBuf(vptr, size); wsize = fBufCur - Buffer(); }
+    void _send(void* vptr, size_t size) override {
+        if(size > size_t(INT_MAX)) throw std::length_error("KeyData contents exceed TBuffer size limit");
+        WriteBuf(vptr, size);
+        wsize = fBufCur - Buffer();
+    }
     /// pull data from current readpoint
-    void _receive(void* vptr, int size) override { ReadBuf(vptr, size); }
+    void _receive(void* vptr, size_t size) override {
+        if(size > size_t(INT_MAX)) throw std::length_error("KeyData contents exceed TBuffer size limit");
+        ReadBuf(vptr, size);
+    }
     /// last _send data write size; includes first 2 bytes.
     size_t wsize = 2*sizeof(UInt_t);
 };
@@ -220,8 +230,12 @@ public:
     KeyTable() { }
     /// Copy constructor
     KeyTable(const KeyTable& other): map<string, KeyData*>() { *this = other; }
+    /// Move constructor
+    KeyTable(KeyTable&& other): map<string, KeyData*>() { swap(other); }
     /// Assignment operator
     KeyTable& operator=(const KeyTable& k);
+    /// Move assignment, taking ownership of contents
+    KeyTable& operator=(KeyTable&& k) { if(this != &k) { Clear(); swap(k); } return *this; }
     /// Destructor
     ~KeyTable() { Clear(); }
 
@@ -7,6 +7,8 @@
 
 #include "MPIBinaryIO.hh"
 #include <iostream> // for std::cout
+#include <algorithm> // for std::min
+#include <unistd.h> // for getpid
 using std::cout;
 
 void MPIBinaryIO::display() {
@@ -21,36 +23,199 @@ int MPIBinaryIO::mpisize = 0;
 int MPIBinaryIO::mpirank = 0;
 int MPIBinaryIO::coresPerNode = 0;
 set<int> MPIBinaryIO::availableRanks;
+vector<int> MPIBinaryIO::topRanks;
+vector<string> MPIBinaryIO::rankHosts;
+bool MPIBinaryIO::useShm = true;
+size_t MPIBinaryIO::shmRingSize = 1 << 24;
 
 #ifdef WITH_MPI
 
 char* MPIBinaryIO::hostname = new char[MPI_MAX_PROCESSOR_NAME];
+MPI_Comm MPIBinaryIO::workerComm = MPI_COMM_NULL;
 
-void MPIBinaryIO::_send(void* vptr, int size) {
-    if(!size) return;
-    MPI_Send(vptr, size, MPI_UNSIGNED_CHAR, dataDest, 2, MPI_COMM_WORLD);
+/// maximum bytes per MPI message (int count limit)
+static const size_t mpi_max_msg = size_t(1) << 30;
+
+/// pooled buffers for non-blocking sends
+struct MPISendPool {
+    vector<MPI_Request> reqs;   ///< in-flight requests
+    vector<vector<char>> bufs;  ///< data for each request
+    vector<vector<char>> spare; ///< completed buffers for re-use
+    size_t maxPending = 64;     ///< maximum in-flight requests
+
+    /// collect completed sends; optionally, wait for at least one
+    void reap(bool wait) {
+        if(reqs.empty()) return;
+        vector<int> idx(reqs.size());
+        int n = 0;
+        if(wait) MPI_Waitsome(int(reqs.size()), reqs.data(), &n, idx.data(), MPI_STATUSES_IGNORE);
+        else MPI_Testsome(int(reqs.size()), reqs.data(), &n, idx.data(), MPI_STATUSES_IGNORE);
+        if(n == MPI_UNDEFINED || !n) return;
+
+        size_t j = 0;
+        for(size_t i = 0; i < reqs.size(); ++i) {
+            if(reqs[i] == MPI_REQUEST_NULL) {
+                if(spare.size() < maxPending && bufs[i].capacity() <= (1 << 20)) spare.push_back(std::move(bufs[i]));
+                continue;
+            }
+            if(i != j) {
+                reqs[j] = reqs[i];
+                bufs[j] = std::move(bufs[i]);
+            }
+            ++j;
+        }
+        reqs.resize(j);
+        bufs.resize(j);
+    }
+
+    /// get (empty) buffer for next send, waiting for a free slot
+    vector<char>& next() {
+        reap(false);
+        while(reqs.size() >= maxPending) reap(true);
+        bufs.emplace_back();
+        if(spare.size()) {
+            bufs.back().swap(spare.back());
+            spare.pop_back();
+        }
+        bufs.back().clear();
+        reqs.push_back(MPI_REQUEST_NULL);
+        return bufs.back();
+    }
+
+    /// start sending last next() buffer
+    void isend(int dest) { MPI_Isend(bufs.back().data(), int(bufs.back().size()), MPI_UNSIGNED_CHAR, dest, 2, MPI_COMM_WORLD, &reqs.back()); }
+};
+
+/// per-run tag for shared-memory ring names
+static string shmTag;
+
+/// shared-memory ring name for data from rank src to dst
+static string shmName(int src, int dst) { return "/mpmshm_" + shmTag + "_" + std::to_string(src) + "_" + std::to_string(dst); }
+
+MPIBinaryIO::MPIBinaryIO() { }
+
+MPIBinaryIO::~MPIBinaryIO() { waitSends(); }
+
+ShmRing* MPIBinaryIO::shmOut() {
+    if(!useShm || dataDest == mpirank || size_t(dataDest) >= rankHosts.size() || rankHosts[dataDest] != hostname) return nullptr;
+    auto& R = shmOutRings[dataDest];
+    if(!R) R.reset(new ShmRing(shmName(mpirank, dataDest), shmRingSize));
+    return R.get();
 }
 
-void MPIBinaryIO::_receive(void* vptr, int size) {
-    if(!size) return;
-
-    if(rpt == rbuff.size()) { // need new data
-        MPI_Status status;
-        MPI_Probe(dataSrc, 2, MPI_COMM_WORLD, &status);
-        int msize = 0;
-        MPI_Get_count(&status, MPI_UNSIGNED_CHAR, &msize);
-        rbuff.resize(msize);
-        MPI_Recv(rbuff.data(), msize, MPI_UNSIGNED_CHAR, dataSrc, 2, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        rpt = 0;
+ShmRing* MPIBinaryIO::shmIn() {
+    if(!useShm || dataSrc == mpirank || size_t(dataSrc) >= rankHosts.size() || rankHosts[dataSrc] != hostname) return nullptr;
+    auto& R = shmInRings[dataSrc];
+    if(!R) R.reset(new ShmRing(shmName(dataSrc, mpirank), shmRingSize, true));
+    return R.get();
+}
+
+void MPIBinaryIO::setAsync(bool a, size_t maxPending) {
+    if(!a) {
+        waitSends();
+        sendPool.reset();
+        return;
     }
+    if(!sendPool) sendPool.reset(new MPISendPool());
+    sendPool->maxPending = std::max(maxPending, size_t(1));
+}
 
-    if(rpt + size > rbuff.size()) throw std::runtime_error("unexpected MPI data boundary!");
+void MPIBinaryIO::waitSends() { if(sendPool) while(sendPool->reqs.size()) sendPool->reap(true); }
 
-    std::memcpy(vptr, rbuff.data()+rpt, size);
-    rpt += size;
+void MPIBinaryIO::_send(void* vptr, size_t size) {
+    if(auto R = shmOut()) { R->write(vptr, size); return; }
+
+    auto p = static_cast<char*>(vptr);
+    while(size) { // split blocks over int count limit into multiple messages
+        auto n = std::min(size, mpi_max_msg);
+        if(sendPool) {
+            auto& b = sendPool->next();
+            b.assign(p, p + n);
+            sendPool->isend(dataDest);
+        } else MPI_Send(p, int(n), MPI_UNSIGNED_CHAR, dataDest, 2, MPI_COMM_WORLD);
+        p += n;
+        size -= n;
+    }
 }
 
-void MPIBinaryIO::uninit() { MPI_Finalize(); }
+void MPIBinaryIO::_sendv(const wblock_t* b, size_t nb) {
+    if(auto R = shmOut()) { // copy each block directly into ring
+        for(size_t i = 0; i < nb; ++i) R->write(b[i].p, b[i].n);
+        return;
+    }
+
+    if(sendPool) { // pack into one owned buffer per message
+        size_t ntot = 0;
+        for(size_t i = 0; i < nb; ++i) ntot += b[i].n;
+        if(ntot > mpi_max_msg) { BinaryWriter::_sendv(b, nb); return; }
+        auto& v = sendPool->next();
+        v.resize(ntot);
+        auto p = v.data();
+        for(size_t i = 0; i < nb; ++i) { std::memcpy(p, b[i].p, b[i].n); p += b[i].n; }
+        sendPool->isend(dataDest);
+        return;
+    }
+
+    vector<int> len;
+    vector<MPI_Aint> disp;
+    size_t off = 0; // already-sent bytes of current block
+    while(nb) {
+        // gather up to mpi_max_msg bytes of (partial) blocks into one message
+        len.clear();
+        disp.clear();
+        size_t m = 0;
+        while(nb && m < mpi_max_msg) {
+            auto n = std::min(b->n - off, mpi_max_msg - m);
+            if(n) {
+                MPI_Aint a;
+                MPI_Get_address((void*)(b->p + off), &a);
+                disp.push_back(a);
+                len.push_back(int(n));
+                m += n;
+            }
+            off += n;
+            if(off == b->n) { ++b; --nb; off = 0; }
+        }
+        if(!m) break;
+
+        MPI_Datatype T;
+        MPI_Type_create_hindexed(int(len.size()), len.data(), disp.data(), MPI_UNSIGNED_CHAR, &T);
+        MPI_Type_commit(&T);
+        MPI_Send(MPI_BOTTOM, 1, T, dataDest, 2, MPI_COMM_WORLD);
+        MPI_Type_free(&T);
+    }
+}
+
+void MPIBinaryIO::_receive(void* vptr, size_t size) {
+    if(auto R = shmIn()) { R->read(vptr, size); return; }
+
+    auto p = static_cast<char*>(vptr);
+    while(size) {
+        if(rpt == rbuff.size()) { // need new data
+            MPI_Status status;
+            MPI_Probe(dataSrc, 2, MPI_COMM_WORLD, &status);
+            int msize = 0;
+            MPI_Get_count(&status, MPI_UNSIGNED_CHAR, &msize);
+            if(msize <= 0) throw std::runtime_error("unexpected MPI data boundary!");
+            rbuff.resize(msize);
+            MPI_Recv(rbuff.data(), msize, MPI_UNSIGNED_CHAR, dataSrc, 2, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            rpt = 0;
+        }
+
+        auto n = std::min(size, rbuff.size() - rpt);
+        std::memcpy(p, rbuff.data()+rpt, n);
+        rpt += n;
+        p += n;
+        size -= n;
+    }
+}
+
+void MPIBinaryIO::uninit() {
+    // remove any never-attached rings addressed to this rank
+    for(int r = 0; r < int(rankHosts.size()); ++r) if(r != mpirank && rankHosts[r] == hostname) ShmRing::unlink(shmName(r, mpirank));
+    if(workerComm != MPI_COMM_NULL) MPI_Comm_free(&workerComm);
+    MPI_Finalize();
+}
 
 void MPIBinaryIO::init(int argc, char **argv) {
     int status = MPI_Init(&argc, &argv);
@@ -67,6 +232,23 @@ void MPIBinaryIO::init(int argc, char **argv) {
     auto scpn = getenv("SLURM_CPUS_ON_NODE");
     coresPerNode = scpn? atol(scpn) : 1;
 
+    // host of each rank, for same-host shared-memory channels; run tag from top-level pid
+    vector<char> hs(size_t(mpisize) * MPI_MAX_PROCESSOR_NAME);
+    MPI_Allgather(hostname, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, hs.data(), MPI_MAX_PROCESSOR_NAME, MPI_CHAR, MPI_COMM_WORLD);
+    rankHosts.resize(mpisize);
+    for(int i = 0; i < mpisize; ++i) rankHosts[i] = string(hs.data() + size_t(i) * MPI_MAX_PROCESSOR_NAME);
+    long tag = getpid();
+    MPI_Bcast(&tag, 1, MPI_LONG, 0, MPI_COMM_WORLD);
+    shmTag = std::to_string(tag);
+
+    // workers' communicator, e.g. for collective parallel-HDF5 output
+    MPI_Comm_split(MPI_COMM_WORLD, mpirank? 0 : MPI_UNDEFINED, mpirank, &workerComm);
+
+    // ranks receiving jobs from top-level controller, as known to all ranks
+    topRanks.clear();
+    if(mpisize <= coresPerNode) for(int i = 1; i < mpisize; i++) topRanks.push_back(i);
+    else for(int i = 0; i < mpisize/coresPerNode; i++) topRanks.push_back(i? i*coresPerNode : 1);
+
     if(mpisize <= coresPerNode) { // local single-level distribution
 
         if(!mpirank) for(int i = 1; i < mpisize; i++) availableRanks.insert(i);
@@ -92,12 +274,29 @@ void MPIBinaryIO::init(int argc, char **argv) {
 
 #else
 
+/// unused placeholder
+struct MPISendPool { };
+
 const char* _hname = "not_an_MPI_host";
 char* MPIBinaryIO::hostname = (char*)_hname;
 
-void MPIBinaryIO::_send(void*, int) { throw std::logic_error("Not compiled with MPI!"); }
+void MPIBinaryIO::_send(void*, size_t) { throw std::logic_error("Not compiled with MPI!"); }
+
+void MPIBinaryIO::_sendv(const wblock_t*, size_t) { throw std::logic_error("Not compiled with MPI!"); }
+
+void MPIBinaryIO::_receive(void*, size_t) { throw std::logic_error("Not compiled with MPI!"); }
+
+MPIBinaryIO::MPIBinaryIO() { }
+
+MPIBinaryIO::~MPIBinaryIO() { }
+
+ShmRing* MPIBinaryIO::shmOut() { return nullptr; }
+
+ShmRing* MPIBinaryIO::shmIn() { return nullptr; }
+
+void MPIBinaryIO::setAsync(bool, size_t) { }
 
-void MPIBinaryIO::_receive(void*, int) { throw std::logic_error("Not compiled with MPI!"); }
+void MPIBinaryIO::waitSends() { }
 
 void MPIBinaryIO::init(int, char **) { }
 
@@ -3,13 +3,29 @@
 #ifndef MPIBINARYIO_HH
 #define MPIBINARYIO_HH
 
-#include "BinaryIO.hh"
+#include "ShmBinaryIO.hh"
+#include <memory>
 #include <set>
 using std::set;
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
+
+struct MPISendPool;
 
 /// Binary I/O over MPI, with static MPI instance info
 class MPIBinaryIO: virtual public BinaryIO {
 public:
+    /// Constructor
+    MPIBinaryIO();
+    /// Destructor, completing non-blocking sends
+    ~MPIBinaryIO();
+
+    /// enable/disable non-blocking sends: data copied to pooled buffers and sent with MPI_Isend, up to maxPending in flight
+    void setAsync(bool a, size_t maxPending = 64);
+    /// block until all non-blocking sends complete
+    void waitSends();
+
     /// initialize with MPI information
     static void init(int argc, char **argv);
     /// close out MPI
@@ -22,12 +38,30 @@ public:
     static char* hostname;                          ///< hostname for this machine
     static int coresPerNode;                        ///< number of cores on this MPI node
     static set<int> availableRanks;                 ///< communication ranks available
+    static vector<int> topRanks;                    ///< ranks receiving jobs from top-level (rank 0) controller
+    static vector<string> rankHosts;                ///< host name of each rank
+    static bool useShm;                             ///< whether to route same-host data through shared-memory rings
+    static size_t shmRingSize;                      ///< capacity of each shared-memory ring
+#ifdef WITH_MPI
+    static MPI_Comm workerComm;                     ///< communicator over worker ranks (all but rank 0; MPI_COMM_NULL on rank 0)
+#endif
 
 protected:
     /// blocking data send
-    void _send(void* vptr, int size) override;
+    void _send(void* vptr, size_t size) override;
+    /// blocking gathered send, as MPI_Type_create_hindexed messages
+    void _sendv(const wblock_t* b, size_t nb) override;
     /// blocking data receive
-    void _receive(void* vptr, int size) override;
+    void _receive(void* vptr, size_t size) override;
+
+    /// shared-memory ring to dataDest, or nullptr if not on this host
+    ShmRing* shmOut();
+    /// shared-memory ring from dataSrc, or nullptr if not on this host
+    ShmRing* shmIn();
+
+    std::unique_ptr<MPISendPool> sendPool;  ///< non-blocking send buffers, if async
+    map<int, std::unique_ptr<ShmRing>> shmOutRings; ///< outgoing same-host rings, by destination rank
+    map<int, std::unique_ptr<ShmRing>> shmInRings;  ///< incoming same-host rings, by source rank
 };
 
 #endif
@@ -7,6 +7,8 @@
 #include <iostream> // for std::cout
 
 MPIJobControl::~MPIJobControl() {
+    waitSuperseded();
+
     // Send ending message to close worker process
     JobSpec JS0;
     for(auto r: availableRanks) {
@@ -17,21 +19,61 @@ MPIJobControl::~MPIJobControl() {
     if(verbose > 1) printf(availableRanks.size()? "Controller [%i] closing.\n" : "Worker [%i] closing.\n", mpirank);
 }
 
-bool MPIJobControl::_isRunning(int wid) {
-    // check for tag '1' message
-    int flag = 0;
-    int i = MPI_Iprobe(wid, 1, MPI_COMM_WORLD, &flag, MPI_STATUS_IGNORE);
-    if(!flag) return true;
+void MPIJobControl::dispatchJob(JobSpec& JS) {
+    MultiJobControl::dispatchJob(JS);
+    // pre-post receive for tag '1' done signal
+    doneReq.push_back(MPI_REQUEST_NULL);
+    doneWid.push_back(JS.wid);
+    MPI_Irecv(&doneBuf[JS.wid], 1, MPI_INT, JS.wid, 1, MPI_COMM_WORLD, &doneReq.back());
+}
 
-    MPI_Recv(&i, 1, MPI_INT, wid, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+void MPIJobControl::pollDone(bool wait) {
+    if(doneReq.empty()) return;
+    vector<int> idx(doneReq.size());
+    int n = 0;
+    if(wait) MPI_Waitsome(int(doneReq.size()), doneReq.data(), &n, idx.data(), MPI_STATUSES_IGNORE);
+    else MPI_Testsome(int(doneReq.size()), doneReq.data(), &n, idx.data(), MPI_STATUSES_IGNORE);
+    if(n == MPI_UNDEFINED || !n) return;
+
+    size_t j = 0;
+    for(size_t i = 0; i < doneReq.size(); ++i) {
+        if(doneReq[i] == MPI_REQUEST_NULL) {
+            finished.insert(doneWid[i]);
+            doneBuf.erase(doneWid[i]);
+            continue;
+        }
+        doneReq[j] = doneReq[i];
+        doneWid[j++] = doneWid[i];
+    }
+    doneReq.resize(j);
+    doneWid.resize(j);
+}
+
+bool MPIJobControl::_isRunning(int wid) {
+    pollDone(false);
+    if(!finished.erase(wid)) return true;
     availableRanks.insert(wid);
     return false;
 }
 
+void MPIJobControl::broadcastJob(JobSpec& JS) {
+    waitComplete();
+    broadcasting = true;
+    for(size_t i = 0; i < topRanks.size(); ++i) { // fixed rank assignment for peer numbering
+        availableRanks.erase(topRanks[i]);
+        JS.wid = topRanks[i];
+        JS.N0 = i;
+        JS.N1 = topRanks.size();
+        dispatchJob(JS);
+    }
+    waitComplete();
+    broadcasting = false;
+}
+
 int MPIJobControl::_allocWorker() {
     while(!availableRanks.size()) {
         if((int)checkJobs().size() < ntasks) break;
-        usleep(10000);
+        _waitEvent();
     }
 
     int wid = *availableRanks.begin();
@@ -39,6 +81,13 @@ int MPIJobControl::_allocWorker() {
     return wid;
 }
 
+int MPIJobControl::_idleWorker(int) {
+    if(availableRanks.empty()) return -1;
+    int wid = *availableRanks.begin();
+    availableRanks.erase(wid);
+    return wid;
+}
+
 ///////////////////////
 ///////////////////////
 
@@ -48,4 +97,6 @@ void MPIJobWorker::signalDone() {
     MPI_Send(&i, 1, MPI_INT, dataDest, 1, MPI_COMM_WORLD);
 }
 
+BinaryIO* MPIJobWorker::peerChannel(int i) { return new MPIPeerIO(topRanks.at(i)); }
+
 #endif
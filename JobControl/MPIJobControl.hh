@@ -8,14 +8,17 @@
 #include "MultiJobControl.hh"
 
 #ifdef WITH_MPI
+#include <mpi.h>
 
-/// Distribute and collect jobs over MPI
+/// Distribute and collect jobs over MPI, with non-blocking sends and completion-driven polling
 class MPIJobControl: public MPIBinaryIO, public MultiJobControl {
 public:
     /// Constructor
-    MPIJobControl() { ntasks = mpisize - 1; }
+    MPIJobControl() { ntasks = mpisize - 1; setAsync(true); }
     /// Destructor (signals to close remote jobs)
     ~MPIJobControl();
+    /// Run copy of JS on every topRanks worker, with N0 = index in topRanks
+    void broadcastJob(JobSpec& JS) override;
 
 protected:
 
@@ -23,6 +26,22 @@ protected:
     bool _isRunning(int) override;
     /// Allocate an available thread, blocking if necessary
     int _allocWorker() override;
+    /// Wait for any job-done signal (polling, if stragglers may be re-dispatched)
+    void _waitEvent() override { if(doneReq.size() && !speculating()) pollDone(true); else MultiJobControl::_waitEvent(); }
+    /// Take an available rank, without blocking
+    int _idleWorker(int) override;
+    /// Return unused allocated rank
+    void _freeWorker(int wid) override { availableRanks.insert(wid); }
+    /// Start job, posting receive for its done signal
+    void dispatchJob(JobSpec& JS) override;
+
+    /// test (or wait for) outstanding done-signal receives, marking finished workers
+    void pollDone(bool wait);
+
+    vector<MPI_Request> doneReq;    ///< outstanding done-signal receives
+    vector<int> doneWid;            ///< worker for each doneReq
+    map<int,int> doneBuf;           ///< done-signal receive buffers by worker
+    set<int> finished;              ///< workers signaled done, pending isRunning() close-out
 };
 
 /// Distribute and collect jobs over MPI
@@ -30,6 +49,15 @@ class MPIJobWorker: public MPIBinaryIO, public MultiJobWorker {
 public:
     /// signal that job is done; ready for close-out comms
     void signalDone() override;
+    /// new channel to worker number i (rank topRanks[i])
+    BinaryIO* peerChannel(int i) override;
+};
+
+/// Point-to-point MPI channel between workers
+class MPIPeerIO: public MPIBinaryIO {
+public:
+    /// Constructor, to/from rank r
+    explicit MPIPeerIO(int r) { dataSrc = dataDest = r; }
 };
 
 #else
@@ -3,8 +3,14 @@
 
 #include "MultiJobControl.hh"
 #include "DiskBIO.hh"
+#include "Hash64.hh"
+#include "Profiler.hh"
+#include "PathUtils.hh"
+#include <cstdio> // for rename
+#include <errno.h>
+#include <unistd.h>
 
-string workerName(size_t wclass) { return FactoriesIndex::indexFor<JobWorker>().at(wclass).classname; }
+string workerName(size_t wclass) { return FactoriesIndex::indexFor<JobWorker>().at(wclass)->classname; }
 
 void JobSpec::display() const {
     printf("JobSpec [Job %i: %zu -- %zu] for class '%s' on worker [%i]\n", uid, N0, N1, workerName(wclass).c_str(), wid);
@@ -27,6 +33,15 @@ void JobComm::splitJobs(vector<JobSpec>& vJS, size_t nSplit, size_t nItms, size_
 REGISTER_FACTORYOBJECT(JobWorker, JobWorker)
 
 string JobWorker::stateDir = "";
+size_t JobWorker::stateBudget = size_t(1) << 30;
+
+std::shared_ptr<void> ObjectPassing::queue_t::pop(const std::type_info& t) {
+    if(empty()) throw std::logic_error("No passed object available");
+    if(front().second != std::type_index(t)) throw std::logic_error("Mismatched passed object type");
+    auto p = std::move(front().first);
+    pop_front();
+    return p;
+}
 
 void JobWorker::run(const JobSpec& JS, BinaryIO&) {
     printf("JobWorker does nothing for ");
@@ -41,44 +56,150 @@ string JobWorker::sdataFile(const string& h) const {
     return fn.str();
 }
 
+JobWorker::~JobWorker() {
+    // subclasses overriding writeState or sdataFile should waitWrites() in their destructor
+    if(!wThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> l(wM);
+        wStop = true;
+    }
+    wC.notify_all();
+    wThread.join();
+}
+
+void JobWorker::touchState(const string& h) {
+    auto& e = stateData.at(h);
+    stateLRU.splice(stateLRU.begin(), stateLRU, e.lru);
+}
+
+void JobWorker::insertState(const string& h, std::shared_ptr<const KeyData> d) {
+    auto it = stateData.find(h);
+    if(it != stateData.end()) {
+        stateBytes -= it->second.d->wSize();
+        it->second.d = d;
+        touchState(h);
+    } else {
+        stateLRU.push_front(h);
+        stateData[h] = {d, stateLRU.begin()};
+    }
+    stateBytes += d->wSize();
+    evictStates();
+}
+
+void JobWorker::evictStates() {
+    while(stateBytes > stateBudget && stateLRU.size() > 1) {
+        auto it = stateData.find(stateLRU.back());
+        stateBytes -= it->second.d->wSize();
+        stateData.erase(it);
+        stateLRU.pop_back();
+        ++nEvicted;
+    }
+    stateMem.set(stateBytes);
+}
+
 bool JobWorker::checkState(const string& h) {
-    lastReq[h] = nReq++;
-    if(stateData.count(h)) return true;
+    if(stateData.count(h)) {
+        ++nHits;
+        touchState(h);
+        return true;
+    }
+    ++nMisses;
     if(!stateDir.size()) return false;
 
+    { // recover from pending write-behind
+        std::lock_guard<std::mutex> l(wM);
+        auto it = wPending.find(h);
+        if(it != wPending.end()) {
+            auto d = it->second;
+            insertState(h, d);
+            ++nLoads;
+            return true;
+        }
+    }
+
     auto f = sdataFile(h);
     FDBinaryReader b(f);
     if(!b.inIsOpen()) return false;
     //if(verbose > 3) printf("Loading persisted data from '%s'\n", f.c_str());
-    b.receive(stateData[h]);
+    auto d = std::make_shared<KeyData>();
+    try {
+        b.receiveWireHeader();
+        b.receive(*d);
+    } catch(std::runtime_error&) { return false; } // stale format or incomplete write; regenerate
+    insertState(h, d);
+    ++nLoads;
     return true;
 }
 
 void JobWorker::clearState(const string& h) {
-    stateData.erase(h);
-    lastReq.erase(h);
-    if(stateDir.size()) runSysCmd("rm -f " + sdataFile(h));
+    auto it = stateData.find(h);
+    if(it != stateData.end()) {
+        stateBytes -= it->second.d->wSize();
+        stateLRU.erase(it->second.lru);
+        stateData.erase(it);
+        stateMem.set(stateBytes);
+    }
+    if(!stateDir.size()) return;
+    waitWrites(); // avoid re-creation by write-behind
+    if(unlink(sdataFile(h).c_str()) && errno != ENOENT)
+        throw std::runtime_error("Failed to remove '" + sdataFile(h) + "'");
 }
 
 void JobWorker::persistState(const string& h) {
+    if(!stateDir.size()) return;
     auto it = stateData.find(h);
-    if(stateDir.size() && it != stateData.end()) {
-        auto f = sdataFile(h);
-        runSysCmd("mkdir -p " + stateDir);
-        //if(verbose > 3) printf("Persisting state data to '%s'\n", f.c_str());
-        {
-            FDBinaryWriter b(f+"_tmp");
-            b.send(it->second);
-        }
-        runSysCmd("mv " + f+"_tmp" + " " + f);
+    if(it == stateData.end()) return;
+
+    std::lock_guard<std::mutex> l(wM);
+    if(!wThread.joinable()) wThread = std::thread(&JobWorker::writeBehind, this);
+    if(!wPending.count(h)) wQueue.push_back(h);
+    wPending[h] = it->second.d;
+    wC.notify_one();
+}
+
+void JobWorker::writeBehind() {
+    std::unique_lock<std::mutex> l(wM);
+    while(true) {
+        wC.wait(l, [this] { return wStop || wQueue.size(); });
+        if(wQueue.empty()) return; // wStop, and all written
+
+        auto h = wQueue.front();
+        wQueue.pop_front();
+        auto d = wPending.at(h);
+        l.unlock();
+        try { writeState(h, *d); }
+        catch(std::exception& e) { printf("*** State data write-behind failed: %s\n", e.what()); }
+        l.lock();
+        if(wPending.at(h) == d) wPending.erase(h);  // else, re-queued with newer data
+        ++nWrites;
+        wC.notify_all();
     }
+}
 
-    // purge excessive storage
-    if(stateData.size() > 1000) {
-        vector<string> vold;
-        for(auto& kv: stateData) if(lastReq[kv.first] < nReq-500) vold.push_back(kv.first);
-        for(auto hh: vold) if(hh != h) stateData.erase(h);
+void JobWorker::waitWrites() {
+    std::unique_lock<std::mutex> l(wM);
+    wC.wait(l, [this] { return wPending.empty(); });
+}
+
+void JobWorker::writeState(const string& h, const KeyData& d) const {
+    auto f = sdataFile(h);
+    makePath(stateDir);
+    {
+        // regenerable cache: no fsync; checkState() rejects incomplete files
+        unlink((f+"_tmp").c_str()); // output opens in append mode
+        FDBinaryWriter b(f+"_tmp", FDBinaryWriter::SYNC_NONE);
+        b.start_wtx();
+        b.sendWireHeader();
+        b.send(d);
+        b.end_wtx();
     }
+    if(rename((f+"_tmp").c_str(), f.c_str())) throw std::runtime_error("Failed to move state data into '" + f + "'");
+}
+
+void JobWorker::displayStateStats() const {
+    std::lock_guard<std::mutex> l(wM);
+    printf("State cache: %zu entries, %.1f/%.1f MB; %zu hits, %zu misses (%zu loaded), %zu evicted, %zu written\n",
+           stateData.size(), stateBytes*1e-6, stateBudget*1e-6, nHits, nMisses, nLoads, nEvicted, nWrites);
 }
 
 
@@ -87,13 +208,179 @@ void JobWorker::persistState(const string& h) {
 
 MultiJobControl* MultiJobControl::JC = nullptr;
 
+/// BinaryIO recording data sent by startJob
+class StartRecorder: public BinaryIO {
+public:
+    vector<char> rec;   ///< sent data
+protected:
+    /// record sent data
+    void _send(void* vptr, size_t size) override { rec.insert(rec.end(), (char*)vptr, (char*)vptr + size); }
+    /// no receiving
+    void _receive(void*, size_t) override { throw std::logic_error("Cached jobs' startJob cannot receive"); }
+};
+
+/// endJob channel relaying and recording data received from controller channel
+class MultiJobControl::ReplyRecorder: public BinaryIO {
+public:
+    /// Constructor, relaying through C
+    explicit ReplyRecorder(MultiJobControl& c): C(c) { }
+
+    vector<char> rec;   ///< received data
+    bool sent = false;  ///< whether endJob sent data (results not cacheable)
+
+protected:
+    /// relay and record received data
+    void _receive(void* vptr, size_t size) override {
+        C._receive(vptr, size);
+        rec.insert(rec.end(), (char*)vptr, (char*)vptr + size);
+    }
+    /// relay sent data
+    void _send(void* vptr, size_t size) override {
+        sent = true;
+        C._send(vptr, size);
+    }
+
+    MultiJobControl& C; ///< controller channel
+};
+
 int MultiJobControl::submitJob(JobSpec& JS) {
-    dataSrc = dataDest = JS.wid = _allocWorker();
-    if(verbose > 4) { printf("Submitting "); JS.display(); }
+    ProfileZone Z("MultiJobControl::submitJob");
+    if(cachedResult(JS)) return JS.wid = -1;
+    JS.wid = _allocWorker();
+    dispatchJob(JS);
+    return JS.wid;
+}
+
+void MultiJobControl::dispatchJob(JobSpec& JS) {
+    dataSrc = dataDest = JS.wid;
+    if(verbose > 4) { printf(redispatching? "Re-dispatching " : "Submitting "); JS.display(); }
+    auto s = redispatching? redispatching : ++nDispatched;
+    if(progress && !redispatching) progress->addTotal(JS.N1 - JS.N0);
     send(JS);
-    if(JS.C) JS.C->startJob(*this);
+    auto k = sendStart(JS);
+    if(k) jobKeys[s] = k;
     jobs[JS.wid] = JS;
-    return JS.wid;
+    tStart[JS.wid] = std::chrono::steady_clock::now();
+    jobSerial[JS.wid] = s;
+    jobCopies[s].insert(JS.wid);
+}
+
+string MultiJobControl::cacheFile(size_t key) const {
+    char h[32];
+    snprintf(h, sizeof(h), "%016zx", key);
+    return cacheDir + "/JobResult_" + h + ".dat";
+}
+
+bool MultiJobControl::cachedResult(JobSpec& JS) {
+    startKey = 0;
+    startData.clear();
+    if(!cacheDir.size() || !JS.C || broadcasting || dynamic_cast<ObjectPassing*>(this)) return false;
+
+    // key on job identity and start-of-job contents
+    StartRecorder S;
+    S.send(workerName(JS.wclass));
+    S.send<int32_t>(JS.uid);
+    S.send<uint64_t>(JS.N0);
+    S.send<uint64_t>(JS.N1);
+    auto n0 = S.rec.size();
+    JS.C->startJob(S);
+    size_t k = _hash64(S.rec.data(), S.rec.size());
+    if(!k) k = 1;
+
+    vector<char> d;
+    {
+        FDBinaryReader b(cacheFile(k));
+        if(b.inIsOpen()) {
+            try {
+                b.receiveWireHeader();
+                b.receive(d);
+            } catch(std::runtime_error&) { d.clear(); } // stale format or incomplete write; re-run
+        }
+    }
+    if(!d.size()) {
+        startData.assign(S.rec.begin() + n0, S.rec.end());
+        startKey = k;
+        return false;
+    }
+
+    if(verbose > 4) { printf("Cached results for "); JS.display(); }
+    RingBIO R;
+    R.send(d.data(), d.size());
+    JS.C->endJob(R);
+    if(progress) {
+        progress->addTotal(JS.N1 - JS.N0);
+        progress->increment(JS.N1 - JS.N0);
+    }
+    ++nCacheHits;
+    return true;
+}
+
+size_t MultiJobControl::sendStart(JobSpec& JS) {
+    auto k = startKey;
+    startKey = 0;
+    if(k) {
+        send(startData.data(), startData.size());
+        startData.clear();
+    } else if(JS.C) JS.C->startJob(*this);
+    return k;
+}
+
+void MultiJobControl::receiveEnd(JobComm* C, size_t key) {
+    if(!key) { C->endJob(*this); return; }
+
+    ReplyRecorder R(*this);
+    C->endJob(R);
+    if(R.sent || !R.rec.size()) return;
+
+    auto f = cacheFile(key);
+    auto ftmp = f + "_tmp" + std::to_string(getpid());
+    try {
+        makePath(cacheDir);
+        {
+            // regenerable cache: no fsync; cachedResult() rejects incomplete files
+            unlink(ftmp.c_str()); // output opens in append mode
+            FDBinaryWriter b(ftmp, FDBinaryWriter::SYNC_NONE);
+            b.start_wtx();
+            b.sendWireHeader();
+            b.send(R.rec);
+            b.end_wtx();
+        }
+        if(rename(ftmp.c_str(), f.c_str())) throw std::runtime_error("Failed to move job results into '" + f + "'");
+        ++nCacheStores;
+    } catch(std::exception& e) { printf("*** Job results cache write failed: %s\n", e.what()); }
+}
+
+size_t MultiJobControl::guidedChunk(int wid, size_t nLeft, size_t minChunk) const {
+    // worker's share relative to mean measured throughput; unmeasured workers get average share
+    double share = 1;
+    auto it = wrate.find(wid);
+    if(it != wrate.end() && it->second > 0) {
+        double rsum = 0;
+        for(auto& kv: wrate) rsum += kv.second;
+        share = it->second * wrate.size() / rsum;
+    }
+    auto n = size_t(share * nLeft / (2 * std::max(ntasks, 1)));
+    return std::min(nLeft, std::max(n, std::max(minChunk, size_t(1))));
+}
+
+void MultiJobControl::submitGuided(JobComm& C, size_t nItms, size_t wclass, int uid, size_t minChunk) {
+    ProfileZone Z("MultiJobControl::submitGuided");
+    size_t N0 = 0;
+    int wid = -1;
+    while(N0 < nItms) {
+        JobSpec JS;
+        JS.uid = uid;
+        JS.wclass = wclass;
+        JS.C = &C;
+        if(wid < 0) wid = _allocWorker(); // blocks until a worker frees up, updating throughput estimates
+        JS.wid = wid;
+        JS.N0 = N0;
+        JS.N1 = N0 = N0 + guidedChunk(JS.wid, nItms - N0, minChunk);
+        if(cachedResult(JS)) continue; // worker stays allocated for next chunk
+        dispatchJob(JS);
+        wid = -1;
+    }
+    if(wid >= 0) _freeWorker(wid);
 }
 
 bool MultiJobControl::isRunning(int wid) {
@@ -102,9 +389,35 @@ bool MultiJobControl::isRunning(int wid) {
     if(_isRunning(wid)) return true;
 
     auto C = it->second.C;
+    auto nItms = it->second.N1 - it->second.N0;
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart[wid]).count();
+    if(nItms && dt > 0) { // running average throughput
+        auto r = nItms/dt;
+        auto& w = wrate[wid];
+        w = w? 0.5*(w + r) : r;
+    }
+    auto s = jobSerial.at(wid);
     jobs.erase(it);
+    tStart.erase(wid);
+    jobSerial.erase(wid);
     dataSrc = dataDest = wid;
-    if(C) C->endJob(*this);
+
+    if(superseded.erase(wid)) {
+        if(C) C->discardJob(*this);
+        ++nDiscarded;
+    } else {
+        // first finished copy: supersede any others
+        if(progress) progress->increment(nItms);
+        for(auto w: jobCopies.at(s)) if(w != wid) superseded.insert(w);
+        jobCopies.erase(s);
+        size_t k = 0;
+        auto ik = jobKeys.find(s);
+        if(ik != jobKeys.end()) {
+            k = ik->second;
+            jobKeys.erase(ik);
+        }
+        if(C) receiveEnd(C, k);
+    }
     clearOut();
     clearIn();
     return false;
@@ -117,25 +430,96 @@ vector<int> MultiJobControl::checkJobs() {
     return wids;
 }
 
+bool MultiJobControl::mayCopy(const std::set<int>& ws) const {
+    if(ws.size() >= size_t(std::max(maxCopies, 1))) return false;
+    auto C = jobs.at(*ws.begin()).C;
+    return C && C->speculative();
+}
+
+bool MultiJobControl::speculating() const {
+    if(broadcasting || (stragglerTimeout <= 0 && stragglerFactor <= 0)) return false;
+    for(auto& kv: jobCopies) if(mayCopy(kv.second)) return true;
+    return false;
+}
+
+void MultiJobControl::redispatchStragglers() {
+    if(!speculating()) return;
+
+    auto t = std::chrono::steady_clock::now();
+    double rmean = 0;
+    for(auto& kv: wrate) rmean += kv.second/wrate.size();
+
+    for(auto& kv: jobCopies) {
+        auto& ws = kv.second;
+        if(!mayCopy(ws)) continue;
+
+        // time since latest copy started
+        double dt = 1e300;
+        for(auto w: ws) dt = std::min(dt, std::chrono::duration<double>(t - tStart.at(w)).count());
+        auto JS = jobs.at(*ws.begin());
+        if(!((stragglerTimeout > 0 && dt > stragglerTimeout) ||
+             (stragglerFactor > 0 && rmean > 0 && dt > stragglerFactor*(JS.N1 - JS.N0)/rmean))) continue;
+
+        auto wid = _idleWorker(*ws.begin());
+        if(wid < 0) return;
+        if(verbose > 1) printf("Job %zu on [%i] running %.3g s; duplicating to [%i].\n", kv.first, *ws.begin(), dt, wid);
+        JS.wid = wid;
+        redispatching = kv.first;
+        dispatchJob(JS);
+        redispatching = 0;
+        ++nRedispatched;
+    }
+}
+
 void MultiJobControl::waitComplete() {
     vector<int> js;
-    while((js = checkJobs()).size()) {
+    while(true) {
+        js = checkJobs();
+        js.erase(std::remove_if(js.begin(), js.end(), [this](int i) { return superseded.count(i); }), js.end());
+        if(!js.size()) break;
         if(verbose > 4) {
             printf("Waiting for job%s ", js.size() > 1? "s" : "");
             for(auto i: js) printf("%i ",i);
             printf("to complete.\n");
         }
-        usleep(verbose > 4? 1000000 : 10000);
+        redispatchStragglers();
+        _waitEvent();
     }
 }
 
+void MultiJobControl::waitSuperseded() {
+    auto t0 = std::chrono::steady_clock::now();
+    while(superseded.size()) {
+        checkJobs();
+        if(!superseded.size()) break;
+        if(drainTimeout >= 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() > drainTimeout) {
+            if(verbose) printf("Abandoning %zu superseded job run%s.\n", superseded.size(), superseded.size() > 1? "s" : "");
+            break;
+        }
+        _waitEvent();
+    }
+}
+
+void MultiJobControl::broadcastJob(JobSpec& JS) {
+    waitComplete();
+    broadcasting = true;
+    for(int i = 0; i < ntasks; ++i) {
+        JS.N0 = i;
+        JS.N1 = ntasks;
+        submitJob(JS);
+    }
+    waitComplete();
+    broadcasting = false;
+}
+
 void MultiJobControl::waitFor(const vector<int>& v) {
     vector<int> wids = v;
     while(wids.size()) {
-        wids.erase(std::remove_if(wids.begin(), wids.end(), [&](int i){return !isRunning(i);}), wids.end());
+        wids.erase(std::remove_if(wids.begin(), wids.end(), [&](int i){return !isRunning(i) || superseded.count(i);}), wids.end());
         if(!wids.size()) break;
         //checkJobs();
-        usleep(verbose > 4? 1000000 : 10000);
+        redispatchStragglers();
+        _waitEvent();
     }
 }
 
@@ -143,17 +527,18 @@ void MultiJobControl::waitFor(const vector<int>& v) {
 ////////////////////////////////
 ////////////////////////////////
 
-MultiJobWorker* MultiJobWorker::JW = nullptr;
+thread_local MultiJobWorker* MultiJobWorker::JW = nullptr;
 
 void MultiJobWorker::runJob(JobSpec& JS) {
-    auto it = workers.find(JS.wclass);
-    auto W = it == workers.end()? nullptr : it->second;
+    auto W = workers.find(JS.wclass);
     if(!W) {
         if(verbose > 3) printf("Instantiating worker class '%s'.\n", workerName(JS.wclass).c_str());
-        workers[JS.wclass] = W = BaseFactory<JobWorker>::construct(JS.wclass);
+        W = BaseFactory<JobWorker>::construct(JS.wclass);
         if(!W) throw std::runtime_error("Unable to construct requested worker class!");
+        workers.emplace(JS.wclass, W);
     } else if(verbose > 4) printf("Already have worker class '%s'.\n", workerName(JS.wclass).c_str());
 
+    ProfileZone Z(Profiler::isEnabled()? "JobWorker:" + workerName(JS.wclass) : "");
     W->run(JS, *this);
 }
 
@@ -176,11 +561,11 @@ void MultiJobWorker::runWorkerJobs() {
 
 ///////////////////////////////////////
 
-int LocalJobControl::submitJob(JobSpec& JS) {
-    JS.wid = _allocWorker();
+void LocalJobControl::dispatchJob(JobSpec& JS) {
     if(MultiJobControl::verbose > 4) { printf("Running local "); JS.display(); }
-    if(JS.C) JS.C->startJob(*this);
+    if(progress) progress->addTotal(JS.N1 - JS.N0);
+    auto k = sendStart(JS);
     runJob(JS);
-    if(JS.C) JS.C->endJob(*this);
-    return JS.wid;
+    if(JS.C) receiveEnd(JS.C, k);
+    if(progress) progress->increment(JS.N1 - JS.N0);
 }
@@ -17,6 +17,13 @@ WN: W->Run(JS, WN as comm channel); might await/receive config info from remote
 WN: calls signalDone() when W is complete
 CN: polls isRunning(...) until a job has completed; runs JS->C->endJob(CN) to receive output
 
+Straggler re-dispatch: with stragglerTimeout or stragglerFactor set, jobs running too long are duplicated onto idle workers
+(for JobComms declaring speculative()); the first copy to finish is received by endJob, and later copies by discardJob.
+
+Results cache: with cacheDir set, each submitJob (or submitGuided chunk) is keyed by a hash of its worker class, uid, range, and serialized startJob data;
+jobs with a stored result run endJob on the recorded reply instead of being dispatched, and new results are recorded.
+Caching requires send-only startJob and receive-only endJob, and is skipped for ObjectPassing channels and broadcastJob.
+
 */
 
 #ifndef MULTIJOBCONTROL_HH
@@ -24,7 +31,18 @@ CN: polls isRunning(...) until a job has completed; runs JS->C->endJob(CN) to re
 
 #include "ObjectFactory.hh"
 #include "KeyTable.hh"
+#include "ProgressBar.hh"
+#include "MemoryBudget.hh"
 #include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <typeindex>
 
 class JobComm;
 
@@ -49,6 +67,10 @@ public:
     virtual void startJob(BinaryIO&) = 0;
     /// end-of-job communication (retrieve results)
     virtual void endJob(BinaryIO&) = 0;
+    /// whether duplicate runs of jobs may be started (repeatable startJob, and discardJob implemented)
+    virtual bool speculative() const { return false; }
+    /// receive and drop results of a superseded duplicate run (same protocol as endJob)
+    virtual void discardJob(BinaryIO&) { throw std::logic_error("JobComm cannot discard duplicate results"); }
 
     /// Helper function to create subdivided jobs list, referencing this communicator
     void splitJobs(vector<JobSpec>& vJS, size_t nSplit, size_t nItms, size_t wclass, int uid=0);
@@ -56,11 +78,62 @@ public:
 
 
 
+/// Optional in-process channel interface, passing typed objects by move instead of serializing
+class ObjectPassing {
+public:
+    /// Destructor
+    virtual ~ObjectPassing() { }
+
+    /// pass object (moved or copied) to receiver
+    template<class T>
+    void sendObject(T&& o) {
+        typedef typename std::decay<T>::type U;
+        _sendObject(std::make_shared<U>(std::forward<T>(o)), typeid(U));
+    }
+    /// receive object, of same type as sent
+    template<class T>
+    void receiveObject(T& o) { o = std::move(*std::static_pointer_cast<T>(_receiveObject(typeid(T)))); }
+
+    /// send by object passing if B supports it, otherwise serialize
+    template<class T>
+    static void sendOrPass(BinaryIO& B, T&& o) {
+        auto OP = dynamic_cast<ObjectPassing*>(&B);
+        if(OP) OP->sendObject(std::forward<T>(o));
+        else B.send(o);
+    }
+    /// receive by object passing if B supports it, otherwise deserialize
+    template<class T>
+    static void receiveOrPass(BinaryIO& B, T& o) {
+        auto OP = dynamic_cast<ObjectPassing*>(&B);
+        if(OP) OP->receiveObject(o);
+        else B.receive(o);
+    }
+
+    /// first-in, first-out queue of passed objects
+    class queue_t: protected deque<std::pair<std::shared_ptr<void>, std::type_index>> {
+    public:
+        /// add object
+        void push(std::shared_ptr<void> p, const std::type_info& t) { emplace_back(std::move(p), std::type_index(t)); }
+        /// remove next object, checking type
+        std::shared_ptr<void> pop(const std::type_info& t);
+        /// whether queue is empty
+        using deque::empty;
+    };
+
+protected:
+    /// transfer type-erased object
+    virtual void _sendObject(std::shared_ptr<void> p, const std::type_info& t) = 0;
+    /// receive type-erased object of specified type
+    virtual std::shared_ptr<void> _receiveObject(const std::type_info& t) = 0;
+};
+
+
+
 /// Base class for a worker job (with state storage utilities); subclass and REGISTER_FACTORYOBJECT(myClass, JobWorker) in your code
 class JobWorker {
 public:
-    /// polymorphic destructor
-    virtual ~JobWorker() { }
+    /// polymorphic destructor; completes write-behind
+    virtual ~JobWorker();
 
     /// run specified job, talking to JobComm::startJob and endJob through B
     virtual void run(const JobSpec& J, BinaryIO& B);
@@ -73,7 +146,7 @@ public:
     /// push state data for identifier hash
     template<class T>
     void pushState(const string& h, const T& d) {
-        stateData.emplace(h,d);
+        insertState(h, std::make_shared<const KeyData>(d));
         persistState(h);
     }
 
@@ -81,20 +154,55 @@ public:
     template<class T>
     void getState(const string& h, T& d) {
         if(!checkState(h)) throw std::range_error("State data unavailable");
-        stateData.at(h).Get(d);
+        stateData.at(h).d->Get(d);
     }
 
+    /// block until pending write-behind completes
+    void waitWrites();
+    /// print state cache statistics to stdout
+    void displayStateStats() const;
+
     static string stateDir;         ///< non-empty to specify directory for state data storage
+    static size_t stateBudget;      ///< per-worker memory budget [bytes] for resident state data
+
+    size_t nHits = 0;               ///< state requests found in memory
+    size_t nMisses = 0;             ///< state requests not in memory
+    size_t nLoads = 0;              ///< misses loaded from stateDir
+    size_t nEvicted = 0;            ///< entries evicted from memory
+    size_t nWrites = 0;             ///< entries written to stateDir
 
 protected:
     /// name for state data file
     virtual string sdataFile(const string& h) const;
-    /// persistently save state data for hash
+    /// persistently save state data for hash (queued for write-behind)
     virtual void persistState(const string& h);
-
-    map<string, KeyData> stateData; ///< memory-resident saved state information by hash
-    map<string, size_t> lastReq;    ///< when each piece of stored data was last requested
-    size_t nReq = 0;                ///< number of times stored data has been requested
+    /// write state data file (write-behind thread)
+    virtual void writeState(const string& h, const KeyData& d) const;
+    /// add (replace) resident state data as most-recently-used; evict to stateBudget
+    void insertState(const string& h, std::shared_ptr<const KeyData> d);
+    /// mark resident entry as most-recently-used
+    void touchState(const string& h);
+    /// evict least-recently-used entries (except most recent) down to stateBudget
+    void evictStates();
+    /// write-behind thread loop
+    void writeBehind();
+
+    /// memory-resident state data entry
+    struct state_t {
+        std::shared_ptr<const KeyData> d;   ///< data, shared with pending write-behind
+        std::list<string>::iterator lru;    ///< position in stateLRU
+    };
+    map<string, state_t> stateData;         ///< memory-resident saved state information by hash
+    std::list<string> stateLRU;             ///< resident hashes, most recently used first
+    size_t stateBytes = 0;                  ///< resident state data size [bytes]
+    MemAccount stateMem{"JobWorker::state", nullptr};  ///< stateBytes, reported to MemTag
+
+    mutable std::mutex wM;                  ///< lock on write-behind queue, nWrites
+    std::condition_variable wC;             ///< write-behind queue notification
+    std::deque<string> wQueue;              ///< hashes queued for write-behind
+    map<string, std::shared_ptr<const KeyData>> wPending;  ///< data queued or being written, by hash
+    std::thread wThread;                    ///< write-behind thread
+    bool wStop = false;                     ///< write-behind shutdown request
 };
 
 
@@ -103,18 +211,36 @@ protected:
 /// Controller node distributing jobs to matching MultiJobWorker; subclass with features for a particular channel.
 class MultiJobControl: virtual public BinaryIO {
 public:
-    /// Submission of job for processing; updates and returns JS.wid with assigned worker number. Possibly blocking depending on jobs back-end.
+    /// Submission of job for processing; updates and returns JS.wid with assigned worker number (-1 if taken from results cache). Possibly blocking depending on jobs back-end.
     virtual int submitJob(JobSpec& JS);
+    /// Guided self-scheduling of [0, nItms) for C: shrinking chunks (>= minChunk) sized by per-worker throughput, assigned as workers free up; returns after all submitted
+    void submitGuided(JobComm& C, size_t nItms, size_t wclass, int uid = 0, size_t minChunk = 1);
+    /// Run copy of JS on every worker simultaneously (after current jobs complete), with N0 = worker index and N1 = number of workers; blocking until all complete
+    virtual void broadcastJob(JobSpec& JS);
     /// Blocking wait for listed jobs to have finished
     void waitFor(const vector<int>& v);
     /// Blocking wait for all jobs to complete
     void waitComplete();
+    /// Blocking wait (up to drainTimeout) for superseded duplicate runs to finish, freeing their workers
+    void waitSuperseded();
 
     /// recommended number of parallel tasks
     virtual size_t nChunk() const { return ntasks; }
 
     static MultiJobControl* JC; ///< singleton instance for job control type
     int verbose = 0;            ///< debugging verbosity level
+    ProgressMeter* progress = nullptr;  ///< optional meter counting job range items (N1 - N0) submitted and completed
+
+    double stragglerTimeout = 0;    ///< if > 0, duplicate speculative() jobs running longer than this [s]
+    double stragglerFactor = 0;     ///< if > 0, duplicate speculative() jobs running this many times longer than expected from mean throughput
+    int maxCopies = 2;              ///< maximum simultaneous runs of a job
+    double drainTimeout = -1;       ///< maximum wait [s] in waitSuperseded (< 0 for unlimited)
+    string cacheDir;                ///< non-empty to enable content-addressed job results cache in this directory
+
+    size_t nRedispatched = 0;       ///< number of duplicate job runs started
+    size_t nDiscarded = 0;          ///< number of superseded duplicate results discarded
+    size_t nCacheHits = 0;          ///< number of jobs taken from results cache
+    size_t nCacheStores = 0;        ///< number of job results added to cache
 
 protected:
 
@@ -124,13 +250,53 @@ protected:
     virtual bool _isRunning(int) = 0;
     /// Allocate an available worker; possibly blocking if necessary
     virtual int _allocWorker() = 0;
+    /// Wait for (possible) job completion events before re-polling; should time out if speculating()
+    virtual void _waitEvent() { usleep(verbose > 4? 1000000 : 10000); }
+    /// Take an idle worker (not sharing resources with worker wid), without blocking; -1 if none available or unsupported
+    virtual int _idleWorker(int) { return -1; }
+    /// Return allocated worker without running a job on it (e.g. after results cache hit)
+    virtual void _freeWorker(int) { }
+    /// Start job on allocated worker JS.wid
+    virtual void dispatchJob(JobSpec& JS);
+    /// guided chunk size for worker wid out of nLeft remaining
+    size_t guidedChunk(int wid, size_t nLeft, size_t minChunk) const;
 
     /// Check if a job is running; perform end-of-job actions if completed.
     bool isRunning(int wid);
     /// Check status for all running jobs, performing post-return jobs as needed; return number of still-running jobs
     vector<int> checkJobs();
 
+    /// whether copies of job running on workers ws may be started
+    bool mayCopy(const std::set<int>& ws) const;
+    /// whether any running job may yet be duplicated
+    bool speculating() const;
+    /// duplicate straggling jobs onto idle workers
+    void redispatchStragglers();
+
+    /// look up JS in results cache, running JS.C->endJob on cached results if found; otherwise, hold its serialized startJob data for dispatch
+    bool cachedResult(JobSpec& JS);
+    /// send JS.C start-of-job data (held by cachedResult, or from startJob); return results cache key (0 if uncached)
+    size_t sendStart(JobSpec& JS);
+    /// receive results by C->endJob, recording them in results cache if key is nonzero
+    void receiveEnd(JobComm* C, size_t key);
+    /// results cache file name
+    string cacheFile(size_t key) const;
+    /// endJob channel relaying and recording received data
+    class ReplyRecorder;
+
     map<int,JobSpec> jobs;          ///< active jobs by worker ID
+    map<int, std::chrono::steady_clock::time_point> tStart; ///< active job start times by worker ID
+    map<int,double> wrate;          ///< estimated throughput [items/s] by worker ID
+
+    size_t nDispatched = 0;         ///< serial number of last dispatched job
+    size_t redispatching = 0;       ///< serial number of job being duplicated by dispatchJob; 0 for new job
+    map<int, size_t> jobSerial;     ///< serial number of active job, by worker ID
+    map<size_t, std::set<int>> jobCopies;   ///< workers running each unfinished job, by serial number
+    map<size_t, size_t> jobKeys;    ///< results cache key of unfinished jobs, by serial number
+    std::set<int> superseded;       ///< workers running duplicates of finished jobs
+    vector<char> startData;         ///< serialized startJob data held by cachedResult
+    size_t startKey = 0;            ///< results cache key for startData; 0 if none held
+    bool broadcasting = false;      ///< whether running broadcastJob (uncached, not duplicated)
 };
 
 
@@ -144,8 +310,10 @@ public:
 
     /// signal that worker job is done, and ready for close-out comms
     virtual void signalDone() { }
+    /// new channel to worker number i (in broadcastJob numbering); nullptr if unsupported
+    virtual BinaryIO* peerChannel(int) { return nullptr; }
 
-    static MultiJobWorker* JW;          ///< singleton instance for job control type
+    static thread_local MultiJobWorker* JW; ///< per-thread singleton instance for job control type
     int verbose = 0;                    ///< debugging verbosity level
 
 protected:
@@ -154,7 +322,7 @@ protected:
     void runJob(JobSpec& JS);
 
     bool persistent = true;             ///< whether child processes are persistent or one-shot
-    map<size_t, JobWorker*> workers;    ///< workers by class
+    FlatIDTable<JobWorker*> workers;    ///< workers by class
 };
 
 
@@ -164,11 +332,10 @@ protected:
 //////////////////////////////////////
 
 /// Run a single job locally
-class LocalJobControl: public DequeBIO, public MultiJobControl, public MultiJobWorker {
-public:
-    /// Submit job and run to completion.
-    int submitJob(JobSpec& JS) override;
+class LocalJobControl: public RingBIO, public MultiJobControl, public MultiJobWorker {
 protected:
+    /// Run job to completion.
+    void dispatchJob(JobSpec& JS) override;
     /// Check if a job is running or completed
     bool _isRunning(int) override { return false; }
     /// Allocate an available thread, blocking if necessary
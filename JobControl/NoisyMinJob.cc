@@ -0,0 +1,68 @@
+/// \file NoisyMinJob.cc
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "NoisyMinJob.hh"
+#include <stdexcept>
+
+void NoisyMinJobComm::startJob(BinaryIO& B) {
+    auto n = pts->size()? pts->front().x.size() : 0;
+    vector<double> x;
+    x.reserve(n*pts->size());
+    for(auto& p: *pts) x.insert(x.end(), p.x.begin(), p.x.end());
+    B.send<uint64_t>(n);
+    B.send(x);
+}
+
+void NoisyMinJobComm::endJob(BinaryIO& B) {
+    auto N0 = B.receive<uint64_t>();
+    vector<double> f;
+    B.receive(f);
+    if(N0 + f.size() > pts->size()) throw std::logic_error("NoisyMinJob returned out-of-range results");
+    for(auto y: f) (*pts)[N0++].f = y;
+}
+
+void NoisyMinJobComm::discardJob(BinaryIO& B) {
+    B.receive<uint64_t>();
+    vector<double> f;
+    B.receive(f);
+}
+
+void NoisyMinJobComm::evaluate(vector<NoisyMin::evalpt>& v, size_t wclass, int uid) {
+    auto JC = MultiJobControl::JC;
+    if(!JC) throw std::logic_error("NoisyMinJobComm requires MultiJobControl::JC");
+    pts = &v;
+    if(guidedMin) JC->submitGuided(*this, v.size(), wclass, uid, guidedMin);
+    else {
+        vector<JobSpec> vJS;
+        splitJobs(vJS, std::min(JC->nChunk(), v.size()), v.size(), wclass, uid);
+        for(auto& j: vJS) JC->submitJob(j);
+    }
+    JC->waitComplete();
+    pts = nullptr;
+}
+
+void NoisyMinJobComm::addSamples(NoisyMin& NM, size_t k, size_t wclass, int uid) {
+    auto v = NM.proposeSamples(k);
+    evaluate(v, wclass, uid);
+    NM.addSamples(v);
+}
+
+///////////////////////////////////////////////
+
+void NoisyMinJob::run(const JobSpec& J, BinaryIO& B) {
+    auto n = B.receive<uint64_t>();
+    vector<double> xs;
+    B.receive(xs);
+    if(J.N1*n > xs.size()) throw std::logic_error("NoisyMinJob range exceeds received samples");
+
+    vector<double> f;
+    vector<double> x(n);
+    for(auto i = J.N0; i < J.N1; ++i) {
+        std::copy(xs.begin() + i*n, xs.begin() + (i+1)*n, x.begin());
+        f.push_back(eval(x));
+    }
+
+    MultiJobWorker::JW->signalDone();
+    B.send<uint64_t>(J.N0);
+    B.send(f);
+}
@@ -0,0 +1,44 @@
+/// \file NoisyMinJob.hh Distributed evaluation of NoisyMin sample batches through MultiJobControl
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef NOISYMINJOB_HH
+#define NOISYMINJOB_HH
+
+#include "MultiJobControl.hh"
+#include "NoisyMin.hh"
+
+/// Controller side: sends batch sample positions, collects evaluated values
+class NoisyMinJobComm: public JobComm {
+public:
+    /// start-of-job communication (send sample positions)
+    void startJob(BinaryIO& B) override;
+    /// end-of-job communication (receive evaluated values for job range)
+    void endJob(BinaryIO& B) override;
+    /// evaluations are repeatable: allow duplicate runs of straggling jobs
+    bool speculative() const override { return true; }
+    /// receive and drop superseded duplicate evaluations
+    void discardJob(BinaryIO& B) override;
+
+    /// evaluate v (as from NoisyMin::proposeSamples) on JobWorker wclass over MultiJobControl::JC; blocking until complete
+    void evaluate(vector<NoisyMin::evalpt>& v, size_t wclass, int uid = 0);
+    /// propose, distribute, and add k samples to NM; blocking until complete, ready for NM.fitMin()
+    void addSamples(NoisyMin& NM, size_t k, size_t wclass, int uid = 0);
+
+    size_t guidedMin = 0;   ///< if nonzero, launch as guided-scheduled chunks of at least this many samples
+
+protected:
+    vector<NoisyMin::evalpt>* pts = nullptr;    ///< points being evaluated
+};
+
+/// Worker side, evaluating job range of sample positions; subclass with eval() and REGISTER_FACTORYOBJECT(myClass, JobWorker)
+class NoisyMinJob: public JobWorker {
+public:
+    /// run job
+    void run(const JobSpec& J, BinaryIO& B) override;
+
+protected:
+    /// subclass me with (expensive) function evaluation at x!
+    virtual double eval(const vector<double>& x) = 0;
+};
+
+#endif
@@ -0,0 +1,102 @@
+/// \file ShmBinaryIO.cc
+
+#include "ShmBinaryIO.hh"
+#include <atomic>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/// ring header at start of segment, read and write positions on separate cache lines
+struct ShmRing::header_t {
+    alignas(64) std::atomic<uint64_t> head; ///< total bytes written
+    alignas(64) std::atomic<uint64_t> tail; ///< total bytes read
+    alignas(64) std::atomic<uint64_t> cap;  ///< ring capacity, set by first attacher
+};
+
+/// header region size, keeping ring data page-aligned
+static const size_t shm_header_size = 4096;
+
+/// wait for other side: spin, then yield, then sleep
+static void shm_backoff(int& k) {
+    if(++k < 64) return;
+    if(k < 1024) sched_yield();
+    else usleep(50);
+}
+
+ShmRing::ShmRing(const string& nm, size_t c, bool u): name(nm), unlinkOnClose(u) {
+    static_assert(sizeof(header_t) <= shm_header_size, "oversized ShmRing header");
+    cap = 4096;
+    while(cap < c) cap <<= 1;
+    mapsize = shm_header_size + cap;
+
+    auto fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if(fd < 0) throw std::runtime_error("Failed to open shared memory '" + name + "'");
+    if(ftruncate(fd, mapsize)) { // same size from either side; new segment is zero-filled
+        close(fd);
+        throw std::runtime_error("Failed to size shared memory '" + name + "'");
+    }
+    auto m = mmap(nullptr, mapsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(m == MAP_FAILED) throw std::runtime_error("Failed to map shared memory '" + name + "'");
+
+    H = static_cast<header_t*>(m);
+    data = static_cast<char*>(m) + shm_header_size;
+    uint64_t c0 = 0;
+    if(!H->cap.compare_exchange_strong(c0, cap) && c0 != cap) {
+        munmap(m, mapsize);
+        throw std::runtime_error("Mismatched shared memory ring size for '" + name + "'");
+    }
+}
+
+ShmRing::~ShmRing() {
+    munmap(H, mapsize);
+    if(unlinkOnClose) unlink(name);
+}
+
+void ShmRing::unlink(const string& nm) { shm_unlink(nm.c_str()); }
+
+size_t ShmRing::available() const { return H->head.load(std::memory_order_acquire) - H->tail.load(std::memory_order_relaxed); }
+
+size_t ShmRing::space() const { return cap - (H->head.load(std::memory_order_relaxed) - H->tail.load(std::memory_order_acquire)); }
+
+void ShmRing::write(const void* vp, size_t n) {
+    auto p = static_cast<const char*>(vp);
+    auto h = H->head.load(std::memory_order_relaxed);
+    int k = 0;
+    while(n) {
+        size_t f = cap - (h - H->tail.load(std::memory_order_acquire));
+        if(!f) { shm_backoff(k); continue; }
+        k = 0;
+        auto m = std::min({n, f, cap/4}); // publish in pieces so reader copies concurrently
+        auto o = h & (cap - 1);
+        auto m1 = std::min(m, cap - o);
+        std::memcpy(data + o, p, m1);
+        std::memcpy(data, p + m1, m - m1);
+        h += m;
+        p += m;
+        n -= m;
+        H->head.store(h, std::memory_order_release);
+    }
+}
+
+void ShmRing::read(void* vp, size_t n) {
+    auto p = static_cast<char*>(vp);
+    auto t = H->tail.load(std::memory_order_relaxed);
+    int k = 0;
+    while(n) {
+        size_t a = H->head.load(std::memory_order_acquire) - t;
+        if(!a) { shm_backoff(k); continue; }
+        k = 0;
+        auto m = std::min(n, a);
+        auto o = t & (cap - 1);
+        auto m1 = std::min(m, cap - o);
+        std::memcpy(p, data + o, m1);
+        std::memcpy(p + m1, data, m - m1);
+        t += m;
+        p += m;
+        n -= m;
+        H->tail.store(t, std::memory_order_release);
+    }
+}
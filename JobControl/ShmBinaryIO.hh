@@ -0,0 +1,65 @@
+/// \file ShmBinaryIO.hh Binary I/O over POSIX shared-memory byte rings, between processes on one node
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SHMBINARYIO_HH
+#define SHMBINARYIO_HH
+
+#include "BinaryIO.hh"
+
+/// Single-producer, single-consumer byte ring in a named POSIX shared memory segment
+class ShmRing {
+public:
+    /// Constructor, creating or attaching to named ring of capacity cap (rounded up to power of 2); optionally unlink name on destruction
+    explicit ShmRing(const string& nm, size_t cap = 1 << 24, bool unlinkOnClose = false);
+    /// Destructor
+    ~ShmRing();
+    /// no copy
+    ShmRing(const ShmRing&) = delete;
+    /// no assignment
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    /// blocking write of n bytes, in pieces as space frees up
+    void write(const void* p, size_t n);
+    /// blocking read of n bytes
+    void read(void* p, size_t n);
+    /// number of bytes available to read
+    size_t available() const;
+    /// number of bytes free for writing
+    size_t space() const;
+    /// ring capacity
+    size_t capacity() const { return cap; }
+
+    /// remove named segment (existing mappings remain valid)
+    static void unlink(const string& nm);
+
+    const string name;  ///< shared memory segment name
+
+protected:
+    struct header_t;            ///< shared read/write positions
+    header_t* H = nullptr;      ///< mapped header
+    char* data = nullptr;       ///< mapped ring data
+    size_t cap = 0;             ///< ring capacity, power of 2
+    size_t mapsize = 0;         ///< total mapped size
+    const bool unlinkOnClose;   ///< whether to unlink name on destruction
+};
+
+/// Binary I/O over a pair of ShmRing, one per direction
+class ShmBinaryIO: virtual public BinaryIO {
+public:
+    /// Constructor, with outgoing and incoming ring names (incoming ring is unlinked by receiver on destruction)
+    ShmBinaryIO(const string& outName, const string& inName, size_t cap = 1 << 24):
+    Out(outName, cap), In(inName, cap, true) { }
+
+protected:
+    /// blocking data send
+    void _send(void* vptr, size_t size) override { Out.write(vptr, size); }
+    /// blocking gathered send, copying each block directly into ring
+    void _sendv(const wblock_t* b, size_t nb) override { for(size_t i = 0; i < nb; ++i) Out.write(b[i].p, b[i].n); }
+    /// blocking data receive
+    void _receive(void* vptr, size_t size) override { In.read(vptr, size); }
+
+    ShmRing Out;    ///< outgoing data
+    ShmRing In;     ///< incoming data
+};
+
+#endif
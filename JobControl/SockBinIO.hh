@@ -1,6 +1,9 @@
 /// \file SockBinIO.hh BinaryIO serialization/deserialization over buffered socket connection
 // Michael P. Mendenhall, LLNL 2021
 
+#ifndef SOCKBINIO_HH
+#define SOCKBINIO_HH
+
 #include "BinaryIO.hh"
 #include "SockOutBuffer.hh"
 
@@ -9,13 +12,27 @@ class SockBinWrite: public BinaryWriter, public SockOutBuffer {
 public:
     /// Inherit constructors
     using SockOutBuffer::SockOutBuffer;
+    /// serialization send (SockOutBuffer::send for raw blocks)
+    using BinaryWriter::send;
 
 protected:
     /// push data to socket buffer; drops if buffer full
-    void _send(void* vptr, int size) override {
+    void _send(void* vptr, size_t size) override {
+        auto wp = sockfd? get_writepoint() : nullptr;
+        if(!wp) return;
+        *wp = std::make_shared<const vector<char>>((char*)vptr, (char*)(vptr) + size);
+        finish_write();
+    }
+    /// gather blocks directly into one socket buffer item; drops if buffer full
+    void _sendv(const wblock_t* b, size_t nb) override {
         auto wp = sockfd? get_writepoint() : nullptr;
         if(!wp) return;
-        wp->assign((char*)vptr, (char*)(vptr) + size);
+        size_t n = 0;
+        for(size_t i = 0; i < nb; ++i) n += b[i].n;
+        auto v = std::make_shared<vector<char>>(n);
+        auto p = v->data();
+        for(size_t i = 0; i < nb; ++i) { std::memcpy(p, b[i].p, b[i].n); p += b[i].n; }
+        *wp = std::move(v);
         finish_write();
     }
 };
@@ -28,5 +45,7 @@ public:
 
 protected:
     /// blocking data receive
-    void _receive(void* vptr, int size) override { sockread((char*)vptr, size); }
+    void _receive(void* vptr, size_t size) override { sockread((char*)vptr, size); }
 };
+
+#endif
@@ -2,86 +2,96 @@
 // -- Michael P. Mendenhall, LLNL 2019
 
 #include "ThreadsJobControl.hh"
-#include <thread>
 
-/*
-static vector<int> stillRunning;
+ThreadsJobWorker::ThreadsJobWorker(ThreadsJobControl& C): JC(C), T([this]() {
+    JW = this;
+    runWorkerJobs();
+}) { }
 
-void ThreadsJobControl::init(int argc, char **argv) {
-    exec_name = argv[0];
-    DiskIOJobControl::init(argc, argv);
-
-    ntasks = std::max(1, (int)std::thread::hardware_concurrency());
-    if(!rank && verbose) printf("ThreadsJobControl running on %i cores.\n", ntasks);
-    if(rank && verbose > 2) printf("ThreadsJobControl running on core %i.\n", rank);
-    stillRunning.resize(ntasks+1);
+void ThreadsJobWorker::_receive(void* vptr, size_t size) {
+    if(toW.available() < size) {
+        if(toW.available()) throw std::domain_error("Insufficient job data from controller!");
+        JC.waitJob(*this);
+    }
+    toW._receive(vptr, size);
 }
 
-bool ThreadsJobControl::_isRunning(int wid) {
-    auto it = cthreads.find(wid);
-    if(it == cthreads.end()) {
-        if(verbose > 4) printf("Worker ID %i not in threads list.\n", wid);
-        return false;
-    }
+////////////////////////////////
+////////////////////////////////
 
-    if(stillRunning[it->first]) {
-        if(verbose > 4) printf("Worker ID %i is still running.\n", wid);
-        return true;
+ThreadsJobControl::ThreadsJobControl(int n) {
+    ntasks = n > 0? n : std::max(1, int(std::thread::hardware_concurrency()));
+    for(int i = 0; i < ntasks; ++i) {
+        workers.emplace_back(new ThreadsJobWorker(*this));
+        available.insert(i);
     }
+    // wait for all threads to reach idle, before writing to their buffers
+    std::unique_lock<std::mutex> l(M);
+    ctlC.wait(l, [this]() { return nIdled == size_t(ntasks); });
+    nSeen = nIdled;
+}
 
-    if(verbose > 4) printf("Assuring worker thread %i is done.\n", wid);
-    void* ret = nullptr;
-    pthread_join(it->second, &ret);
-    cthreads.erase(it);
-    int iret = size_t(ret);
-    if(iret) {
-        printf("**** Worker %i exited on code '%i'!\n", wid, iret);
-        exit(iret);
+ThreadsJobControl::~ThreadsJobControl() {
+    waitComplete();
+    waitSuperseded();
+    for(auto& W: workers) {
+        JobSpec JS;
+        dataDest = JS.wid = &W - workers.data();
+        send(JS);
+        std::lock_guard<std::mutex> l(M);
+        W->busy = true;
+        W->cv.notify_one();
     }
-    if(verbose > 4) printf("\tWorker thread %i is indeed done.\n", wid);
-    return false;
+    for(auto& W: workers) W->T.join();
 }
 
-pthread_barrier_t runcmdInit;
+void ThreadsJobControl::waitJob(ThreadsJobWorker& W) {
+    std::unique_lock<std::mutex> l(M);
+    W.busy = false;
+    ++nIdled;
+    ctlC.notify_one();
+    W.cv.wait(l, [&W]() { return W.busy; });
+}
 
-struct runcmd_args {
-    string s;
-    int r;
-};
+void ThreadsJobControl::dispatchJob(JobSpec& JS) {
+    MultiJobControl::dispatchJob(JS);
+    auto& W = *workers.at(JS.wid);
+    std::lock_guard<std::mutex> l(M);
+    W.busy = true;
+    W.cv.notify_one();
+}
 
-void* runcmd(void* s) {
-    runcmd_args a = *(runcmd_args*)s;
-    stillRunning[a.r] = 1;
-    pthread_barrier_wait(&runcmdInit); // release lock on arguments
-    runSysCmd(a.s);
-    stillRunning[a.r] = 0;
-    return nullptr;
+bool ThreadsJobControl::_isRunning(int wid) {
+    {
+        std::lock_guard<std::mutex> l(M);
+        if(workers.at(wid)->busy) return true;
+    }
+    available.insert(wid);
+    return false;
 }
 
 int ThreadsJobControl::_allocWorker() {
-    while((int)checkJobs().size() == ntasks) usleep(10000); // wait for a slot
-
-    for(int i=1; i<=ntasks; i++) {
-        if(cthreads.count(i)) continue;
-
-        std::stringstream jcmd;
-        jcmd << exec_name << " -N " << i;
-
-        pthread_barrier_init(&runcmdInit, nullptr, 2);
-
-        pthread_t vthread;
-        runcmd_args a;
-        a.s = jcmd.str();
-        a.r = i;
-        pthread_create(&vthread, NULL, &runcmd, (void*)&a);
-
-        pthread_barrier_wait(&runcmdInit);
-        pthread_barrier_destroy(&runcmdInit);
-        cthreads[i] = vthread;
-
-        return i;
+    while(available.empty()) {
+        checkJobs();
+        if(!available.empty()) break;
+        _waitEvent();
     }
+    int wid = *available.begin();
+    available.erase(available.begin());
+    return wid;
+}
+
+int ThreadsJobControl::_idleWorker(int) {
+    if(available.empty()) return -1;
+    int wid = *available.begin();
+    available.erase(available.begin());
+    return wid;
+}
 
-    exit(1); // should have a slot available???
+void ThreadsJobControl::_waitEvent() {
+    std::unique_lock<std::mutex> l(M);
+    auto p = [this]() { return nIdled != nSeen; };
+    if(speculating()) ctlC.wait_for(l, std::chrono::milliseconds(10), p);
+    else ctlC.wait(l, p);
+    nSeen = nIdled;
 }
-*/
@@ -3,24 +3,88 @@
 #ifndef THREADSJOBCONTROL_HH
 #define THREADSJOBCONTROL_HH
 
-#include "DiskIOJobControl.hh"
+#include "MultiJobControl.hh"
+#include <set>
 
-/*
-/// Distribute jobs as separate processes
-class ThreadsJobControl: public DiskIOJobControl {
+/// RingBIO with public block transfer, for channel between controller and worker thread
+class ThreadJobBuffer: public RingBIO {
 public:
-    /// initialize
-    void init(int argc, char** argv) override;
+    using RingBIO::_send;
+    using RingBIO::_receive;
+};
+
+class ThreadsJobControl;
+
+/// Persistent worker thread for ThreadsJobControl; receives jobs from controller, blocking on empty input
+class ThreadsJobWorker: public ObjectPassing, public MultiJobWorker {
+public:
+    /// Constructor, launching thread
+    explicit ThreadsJobWorker(ThreadsJobControl& C);
+
+    friend class ThreadsJobControl;
+
+protected:
+    /// buffer data to controller
+    void _send(void* vptr, size_t size) override { toC._send(vptr, size); }
+    /// receive data from controller; waits for next job when input exhausted
+    void _receive(void* vptr, size_t size) override;
+    /// pass object to controller
+    void _sendObject(std::shared_ptr<void> p, const std::type_info& t) override { objC.push(std::move(p), t); }
+    /// receive object from controller
+    std::shared_ptr<void> _receiveObject(const std::type_info& t) override { return objW.pop(t); }
+
+    ThreadsJobControl& JC;          ///< controller
+    ThreadJobBuffer toW;            ///< serialized data from controller
+    ThreadJobBuffer toC;            ///< serialized data to controller
+    queue_t objW;                   ///< passed objects from controller
+    queue_t objC;                   ///< passed objects to controller
+    std::condition_variable cv;     ///< job start notification
+    bool busy = false;              ///< whether job buffers are in use by worker thread (protected by JC.M)
+    std::thread T;                  ///< worker thread
+};
+
+/// Run jobs on persistent worker threads, in-process; channel also supports ObjectPassing zero-serialization transfers
+class ThreadsJobControl: public ObjectPassing, public MultiJobControl {
+public:
+    /// Constructor, with number of threads (0 for hardware concurrency)
+    explicit ThreadsJobControl(int n = 0);
+    /// Destructor: completes current jobs, and stops threads
+    ~ThreadsJobControl();
+
+    friend class ThreadsJobWorker;
 
 protected:
+    /// buffer data to worker dataDest
+    void _send(void* vptr, size_t size) override { workers.at(dataDest)->toW._send(vptr, size); }
+    /// receive data from (idle) worker dataSrc
+    void _receive(void* vptr, size_t size) override { workers.at(dataSrc)->toC._receive(vptr, size); }
+    /// pass object to worker dataDest
+    void _sendObject(std::shared_ptr<void> p, const std::type_info& t) override { workers.at(dataDest)->objW.push(std::move(p), t); }
+    /// receive object from (idle) worker dataSrc
+    std::shared_ptr<void> _receiveObject(const std::type_info& t) override { return workers.at(dataSrc)->objC.pop(t); }
+
     /// Check if a job is running or completed
-    bool _isRunning(int) override;
+    bool _isRunning(int wid) override;
     /// Allocate an available thread, blocking if necessary
     int _allocWorker() override;
+    /// wait for a worker to finish a job (with timeout, if stragglers may be re-dispatched)
+    void _waitEvent() override;
+    /// Take an idle worker, without blocking
+    int _idleWorker(int) override;
+    /// Return unused allocated thread
+    void _freeWorker(int wid) override { available.insert(wid); }
+    /// Start job on worker thread
+    void dispatchJob(JobSpec& JS) override;
+
+    /// worker thread to idle state; wait for next job
+    void waitJob(ThreadsJobWorker& W);
 
-    string exec_name;               ///< executable name
-    map<int, pthread_t> cthreads;   ///< child threads
+    vector<std::unique_ptr<ThreadsJobWorker>> workers; ///< worker threads
+    std::set<int> available;        ///< idle worker IDs
+    std::mutex M;                   ///< lock on worker busy states, idle counter
+    std::condition_variable ctlC;   ///< worker idle notification
+    size_t nIdled = 0;              ///< number of worker transitions to idle
+    size_t nSeen = 0;               ///< nIdled at last controller wait
 };
-*/
 
 #endif
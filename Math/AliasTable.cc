@@ -0,0 +1,48 @@
+/// \file AliasTable.cc
+
+#include "AliasTable.hh"
+#include <stdexcept>
+
+void AliasTable::build(const vector<double>& w) {
+    n = w.size();
+    double s = 0;
+    for(auto x: w) {
+        if(!(x >= 0)) throw std::domain_error("AliasTable weights must be non-negative");
+        s += x;
+    }
+    if(!n || !(s > 0)) throw std::domain_error("AliasTable requires positive total weight");
+
+    p.resize(n);
+    vector<double> q(n);
+    vector<unsigned int> alias(n);
+    vector<unsigned int> small, large;
+    for(size_t i = 0; i < n; i++) {
+        p[i] = w[i]/s;
+        q[i] = p[i]*n;
+        alias[i] = i;
+        (q[i] < 1? small : large).push_back(i);
+    }
+
+    // Vose: fill each under-full cell from an over-full item
+    while(small.size() && large.size()) {
+        auto i = small.back(), j = large.back();
+        small.pop_back();
+        alias[i] = j;
+        q[j] -= 1 - q[i];
+        if(q[j] < 1) { large.pop_back(); small.push_back(j); }
+    }
+    // remaining cells full, up to rounding
+    for(auto i: small) q[i] = 1;
+    for(auto i: large) q[i] = 1;
+
+    cells.resize(n);
+    for(size_t i = 0; i < n; i++) {
+        auto& c = cells[i];
+        c.f[0] = q[i];
+        c.f[1] = 0;
+        c.s[0] = q[i] < 1? 1/(1 - q[i]) : 0;
+        c.s[1] = q[i] > 0? 1/q[i] : 0;
+        c.k[0] = alias[i];
+        c.k[1] = i;
+    }
+}
@@ -0,0 +1,64 @@
+/// \file AliasTable.hh Walker/Vose alias method for constant-time discrete random selection
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef ALIASTABLE_HH
+#define ALIASTABLE_HH
+
+#include <vector>
+using std::vector;
+#include <stddef.h>
+#include <algorithm>
+
+/// Constant-time selection of item i with probability proportional to w[i]
+/**
+ * Each of n equal cells holds an item (selected for the first fraction q of the cell) and its alias (selected otherwise).
+ * A single uniform u in [0,1) picks the cell and position within it; the position is rescaled to a
+ * fresh [0,1) uniform, which (mixing uniform sub-intervals) is independent of the selection, for passing along.
+ */
+class AliasTable {
+public:
+    /// Default constructor, empty
+    AliasTable() { }
+    /// Constructor from (non-negative, not all zero) weights
+    explicit AliasTable(const vector<double>& w) { build(w); }
+
+    /// (re)build from weights
+    void build(const vector<double>& w);
+
+    /// select item for uniform u in [0,1)
+    unsigned int select(double u) const {
+        u *= n;
+        const cell_t& c = cells[std::min((unsigned int)int(u), (unsigned int)n - 1)];
+        return c.k[u - c.k[1] < c.f[0]]; // indexed, rather than (poorly predicted) branch, choice
+    }
+    /// select item for uniform u in [0,1), replacing u by independent uniform remainder
+    unsigned int select_rescale(double& u) const {
+        u *= n;
+        const cell_t& c = cells[std::min((unsigned int)int(u), (unsigned int)n - 1)];
+        const double f = u - c.k[1];
+        const bool own = f < c.f[0];
+        u = (f - c.f[own])*c.s[own];
+        return c.k[own];
+    }
+    /// batched selection k[j] for uniforms u[j]
+    void select(const double* u, unsigned int* k, size_t m) const { for(size_t j = 0; j < m; ++j) k[j] = select(u[j]); }
+
+    /// number of items
+    size_t size() const { return n; }
+    /// probability of item i
+    double getProb(size_t i) const { return p.at(i); }
+
+protected:
+    /// table cell
+    struct cell_t {
+        double f[2];        ///< {fraction q of cell selecting own item, 0}
+        double s[2];        ///< remainder scale {1/(1-q) for alias, 1/q for own item}
+        unsigned int k[2];  ///< {alias item for remainder of cell, own item (= cell number)}
+    };
+
+    size_t n = 0;                   ///< number of items
+    vector<cell_t> cells;           ///< table cells
+    vector<double> p;               ///< normalized item probabilities
+};
+
+#endif
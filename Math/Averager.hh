@@ -4,8 +4,11 @@
 #ifndef AVERAGER_HH
 #define AVERAGER_HH
 
+#include "WorkStealingPool.hh"
+#include <algorithm>
 #include <cmath>
 #include <stdio.h>
+#include <vector>
 
 /// Weighted average with numerically-stable variance tracking
 template<typename value_t = double, typename weight_t = double>
@@ -45,6 +48,14 @@ struct Averager {
         swx += x;
     }
 
+    /// Add n items x[i] with weights w[i] (unity weights if w is null), by two-pass block sums merged through operator+=
+    void add(const value_t* x, const weight_t* w, size_t n) {
+        for(size_t i = 0; i < n; i += block) {
+            auto m = std::min(block, n - i);
+            *this += w? blockSum(x + i, w + i, m) : blockSum(x + i, m);
+        }
+    }
+
     /// add with unity weight
     Averager& operator+=(value_t x) { add(x); return *this; }
 
@@ -93,13 +104,84 @@ struct Averager {
     /// print info to stdout
     void display() const { printf("mu = %g, sigma = %g (w = %g)\n", average(), sigma(), weight()); }
 
+    static constexpr size_t block = 1024;   ///< items per batch-add block
+    static constexpr size_t lanes = 8;      ///< independent accumulators for vectorizable block sums
+
 protected:
     /// Constructor with contents
     Averager(weight_t _sw, value_t _swx, value_t _sw2s): sw(_sw), swx(_swx), sw2S(_sw2s) { }
 
+    /// weighted block statistics: sums w, w*x, then sw * sum w*(x - mu)^2 about block mean
+    static Averager blockSum(const value_t* x, const weight_t* w, size_t n) {
+        weight_t aw[lanes]{};
+        value_t awx[lanes]{};
+        size_t i = 0;
+        for(; i + lanes <= n; i += lanes) for(size_t j = 0; j < lanes; ++j) { aw[j] += w[i+j]; awx[j] += w[i+j]*x[i+j]; }
+        for(; i < n; ++i) { aw[0] += w[i]; awx[0] += w[i]*x[i]; }
+        Averager a(lanesum(aw), lanesum(awx), 0);
+        if(!a.sw) return Averager();
+
+        const value_t mu = a.average();
+        value_t ad[lanes]{};
+        for(i = 0; i + lanes <= n; i += lanes) for(size_t j = 0; j < lanes; ++j) { auto d = x[i+j] - mu; ad[j] += w[i+j]*d*d; }
+        for(; i < n; ++i) { auto d = x[i] - mu; ad[0] += w[i]*d*d; }
+        a.sw2S = a.sw * lanesum(ad);
+        return a;
+    }
+
+    /// unity-weight block statistics
+    static Averager blockSum(const value_t* x, size_t n) {
+        if(!n) return Averager();
+        value_t ax[lanes]{};
+        size_t i = 0;
+        for(; i + lanes <= n; i += lanes) for(size_t j = 0; j < lanes; ++j) ax[j] += x[i+j];
+        for(; i < n; ++i) ax[0] += x[i];
+        Averager a(n, lanesum(ax), 0);
+
+        const value_t mu = a.average();
+        value_t ad[lanes]{};
+        for(i = 0; i + lanes <= n; i += lanes) for(size_t j = 0; j < lanes; ++j) { auto d = x[i+j] - mu; ad[j] += d*d; }
+        for(; i < n; ++i) { auto d = x[i] - mu; ad[0] += d*d; }
+        a.sw2S = a.sw * lanesum(ad);
+        return a;
+    }
+
+    /// pairwise sum of lane accumulators
+    template<typename T>
+    static T lanesum(T* a) {
+        for(size_t k = lanes/2; k; k /= 2) for(size_t j = 0; j < k; ++j) a[j] += a[j+k];
+        return a[0];
+    }
+
     weight_t sw{};  ///< sum of weights
     value_t swx{};  ///< weighted sum w*x
     value_t sw2S{}; ///< weighted variance (sw)^2 sigma^2
 };
 
+template<typename value_t, typename weight_t>
+constexpr size_t Averager<value_t, weight_t>::block;
+template<typename value_t, typename weight_t>
+constexpr size_t Averager<value_t, weight_t>::lanes;
+
+/// Averager over n items x[i] with weights w[i] (unity if null), in chunks reduced on nthreads (0 for all cores); deterministic merge order
+template<typename value_t = double, typename weight_t = double>
+Averager<value_t, weight_t> parallel_average(const value_t* x, const weight_t* w, size_t n, int nthreads = 0, size_t chunk = 1 << 18) {
+    Averager<value_t, weight_t> a;
+    if(nthreads == 1 || n <= chunk) { a.add(x, w, n); return a; }
+
+    const size_t nc = (n + chunk - 1)/chunk;
+    std::vector<Averager<value_t, weight_t>> parts(nc);
+    WorkStealingPool P(std::max(nthreads, 0));
+    for(size_t c = 0; c < nc; ++c) {
+        P.submit([&parts, x, w, n, chunk, c]() {
+            auto i = c*chunk;
+            parts[c].add(x + i, w? w + i : nullptr, std::min(chunk, n - i));
+        });
+    }
+    P.wait_idle();
+
+    for(auto& p: parts) a += p;
+    return a;
+}
+
 #endif
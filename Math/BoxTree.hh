@@ -1,5 +1,8 @@
 /// \file BoxTree.hh Dividing edges for KD Tree
 
+#ifndef BOXTREE_HH
+#define BOXTREE_HH
+
 #include <vector>
 using std::vector;
 #include <map>
@@ -143,7 +146,7 @@ protected:
 /////////////////////////
 /////////////////////////
 
-/// Helper class to build KD tree from float* arrays
+/// Helper class to build KD tree from float* arrays (see FlatKDTree.hh for large, array-based, parallel builds)
 class KDBuilder {
 public:
     /// Constructor
@@ -197,3 +200,5 @@ void BoxTreeNode::iterator_t<ptr_t>::descend_low() {
         hiSide.push_back(false);
     }
 }
+
+#endif
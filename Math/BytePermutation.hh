@@ -0,0 +1,162 @@
+/// \file BytePermutation.hh Fixed-size permutations on up to 64 points, as padded byte vectors with shuffle composition
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef BYTEPERMUTATION_HH
+#define BYTEPERMUTATION_HH
+
+#include "PermutationGroup.hh"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define BYTEPERMUTATION_SHUFFLE ///< composition by vector byte shuffle where target has single-instruction variable shuffle
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/// byte vector types by size
+template<size_t P>
+struct _bytevec { };
+/// 16-byte vector
+template<>
+struct _bytevec<16> { typedef uint8_t type __attribute__((vector_size(16))); };
+/// 32-byte vector
+template<>
+struct _bytevec<32> { typedef uint8_t type __attribute__((vector_size(32))); };
+/// 64-byte vector
+template<>
+struct _bytevec<64> { typedef uint8_t type __attribute__((vector_size(64))); };
+#endif
+
+/// Permutation of N <= 64 points, stored as one 16-, 32- or 64-byte vector padded with fixed points.
+/// Drop-in for Permutation<N> in (semi)groups such as MultiplyG<BytePermutation<N>>, with the same composition order and element ordering;
+/// composition is a single byte shuffle where the compile target supports it (e.g. -mssse3, -mavx2, -mavx512vbmi), with scalar fallback.
+template<size_t N>
+class BytePermutation {
+public:
+    static_assert(N <= 64, "BytePermutation limited to 64 points");
+
+    /// padded storage size
+    static constexpr size_t P = N <= 16? 16 : N <= 32? 32 : 64;
+#ifdef BYTEPERMUTATION_SHUFFLE
+    /// whether compile target has native variable byte shuffle at size P
+    static constexpr bool native_shuffle =
+#if defined(__AVX512VBMI__) && defined(__AVX512VL__)
+        true;
+#elif defined(__AVX512VBMI__)
+        P != 32;
+#elif defined(__SSSE3__) || defined(__ARM_NEON)
+        P == 16;
+#else
+        false;
+#endif
+#endif
+    /// Default constructor for identity permutation
+    BytePermutation() { for(size_t i = 0; i < P; ++i) v[i] = i; }
+    /// Permutation from array, with optional index offset (for cut-and-paste from Fortran-style indices)
+    explicit BytePermutation(const array<int,N>& a, int i = 0): BytePermutation() {
+        for(size_t j = 0; j < N; ++j) v[j] = a[j] - i;
+        assert(validate());
+    }
+    /// Conversion from Permutation
+    template<typename idx_t>
+    explicit BytePermutation(const Permutation<N,idx_t>& p): BytePermutation() { for(size_t j = 0; j < N; ++j) v[j] = p[j]; }
+
+    /// conversion to Permutation
+    template<typename idx_t = default_permute_idx_t>
+    Permutation<N,idx_t> toPermutation() const {
+        array<idx_t,N> a;
+        for(size_t j = 0; j < N; ++j) a[j] = v[j];
+        return Permutation<N,idx_t>(a);
+    }
+
+    /// element access
+    uint8_t operator[](size_t i) const { return v[i]; }
+
+    /// equality comparison
+    bool operator==(const BytePermutation& p) const { return !memcmp(v, p.v, P); }
+    /// inequality comparison
+    bool operator!=(const BytePermutation& p) const { return !(*this == p); }
+    /// ordering comparison (lexicographic, as for Permutation)
+    bool operator<(const BytePermutation& p) const { return memcmp(v, p.v, N) < 0; }
+
+    /// composition, (p*q)[i] = q[p[i]] as for Permutation
+    BytePermutation operator*(const BytePermutation& q) const {
+        BytePermutation r(nullptr);
+#ifdef BYTEPERMUTATION_SHUFFLE
+        if(native_shuffle) {
+            typename _bytevec<P>::type a, b;    // (unaligned) vector loads
+            memcpy(&a, q.v, P);
+            memcpy(&b, v, P);
+            a = __builtin_shuffle(a, b);
+            memcpy(r.v, &a, P);
+            return r;
+        }
+#ifdef __AVX2__
+        if(P == 32) {
+            // in-lane shuffles of each 16-byte half, selected by index bit 4
+            auto a = _mm256_loadu_si256((const __m256i*)q.v);
+            auto b = _mm256_loadu_si256((const __m256i*)v);
+            auto lo = _mm256_shuffle_epi8(_mm256_permute2x128_si256(a, a, 0x00), b);
+            auto hi = _mm256_shuffle_epi8(_mm256_permute2x128_si256(a, a, 0x11), b);
+            _mm256_storeu_si256((__m256i*)r.v, _mm256_blendv_epi8(lo, hi, _mm256_slli_epi16(b, 3)));
+            return r;
+        }
+#endif
+#endif
+        for(size_t i = 0; i < P; ++i) r.v[i] = q.v[v[i]];
+        return r;
+    }
+    /// inplace multiplication
+    BytePermutation& operator*=(const BytePermutation& q) { return *this = (*this)*q; }
+    /// get inverse
+    BytePermutation inverse() const {
+        BytePermutation e;
+        for(size_t i = 0; i < N; ++i) e.v[v[i]] = i;
+        return e;
+    }
+    /// inplace division
+    BytePermutation& operator/=(const BytePermutation& q) { return *this *= q.inverse(); }
+    /// out-of-place division
+    BytePermutation operator/(const BytePermutation& q) const { auto p = *this; return p /= q; }
+
+    /// fast (non-cryptographic) hash, multiply-folding padded 64-bit words
+    size_t hash() const {
+        uint64_t w[P/8];
+        memcpy(w, v, P);
+        uint64_t h = 0;
+        for(size_t i = 0; i < P/8; ++i) h ^= (w[i] + i)*0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        return h ^ (h >> 32);
+    }
+
+    /// verify this is valid permutation
+    bool validate() const {
+        uint64_t m = 0;
+        for(size_t i = 0; i < N; ++i) {
+            if(v[i] >= N) return false;
+            m |= uint64_t(1) << v[i];
+        }
+        for(size_t i = N; i < P; ++i) if(v[i] != i) return false;
+        return m == (N == 64? ~uint64_t(0) : (uint64_t(1) << N) - 1);
+    }
+
+    /// unordered container hash functor
+    struct hasher {
+        /// hash permutation
+        size_t operator()(const BytePermutation& p) const { return p.hash(); }
+    };
+
+protected:
+    /// uninitialized constructor
+    explicit BytePermutation(std::nullptr_t) { }
+
+    uint8_t v[P];   ///< permuted indices, padded with fixed points
+};
+
+/// output representation for permutation
+template<size_t N>
+std::ostream& operator<<(std::ostream& o, const BytePermutation<N>& p) { return o << p.toPermutation(); }
+
+#endif
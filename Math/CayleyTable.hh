@@ -5,8 +5,17 @@
 #define CAYLEYTABLE_HH
 
 #include "FiniteGroup.hh"
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
 
 /// Construct <Enumerated Semigroup> Cayley Table isomorphism of input <Enumerated Semigroup> G for faster group operations
+/**
+    Products are stored in a dense order x order row-major table of the smallest unsigned type holding all indices
+    (uint8_t, uint16_t or uint32_t), so apply() is a single array load.
+    Rows are built on nthreads (0 for hardware) pool threads for larger groups; G.apply must be thread-safe.
+*/
 template<class ESG_t>
 class SGCayleyTable {
 public:
@@ -16,26 +25,27 @@ public:
     typedef enum_t elem_t;
 
     /// Constructor, from underlying <Enumerated Semigroup>
-    explicit SGCayleyTable(const ESG_t& G): iID(G.identity_idx()), order(G.getOrder()) {
-        elem_t i = 0;
-        for(auto& e1: G) {
-            elem_t j = 0;
-            for(auto& e2: G) {
-                auto k = G.idx(G.apply(e1,e2));
-                assert(k < (decltype(k))G.getOrder());
-                if(k == iID) inverses[i] = j;
-                CT[{i,j++}] = k;
-            }
-            ++i;
-        }
+    explicit SGCayleyTable(const ESG_t& G): iID(G.identity_idx()), order(G.getOrder()),
+    w(order <= 256? 1 : order <= 65536? 2 : 4), inverses(order, order) {
+        if(uint64_t(order) > uint64_t(UINT32_MAX) + 1) throw std::range_error("Cayley table order exceeds 32-bit indices");
+        if(w == 1) build(G, CT8);
+        else if(w == 2) build(G, CT16);
+        else build(G, CT32);
     }
 
     /// pre-calculated group operator
-    elem_t apply(elem_t a, elem_t b) const { auto it = CT.find({a,b}); assert(it != CT.end()); return it->second; }
+    elem_t apply(elem_t a, elem_t b) const {
+        assert(size_t(a) < order && size_t(b) < order);
+        const size_t n = size_t(a)*order + b;
+        return w == 1? CT8[n] : w == 2? CT16[n] : CT32[n];
+    }
     /// get group order
     size_t getOrder() const { return order; }
     /// lookup inverse
-    enum_t inverse(enum_t i) const { return inverses.at(i); }
+    enum_t inverse(enum_t i) const {
+        if(size_t(inverses.at(i)) == order) throw std::out_of_range("Cayley table element has no inverse");
+        return inverses[i];
+    }
 
     /// return (trivial!) element index
     static constexpr enum_t idx(elem_t i) { return i; }
@@ -50,23 +60,85 @@ public:
     /// element iteration end
     VRangeIt<elem_t> end() const { return VRangeIt<elem_t>(order,order); }
 
-    /// apply renumeration of elements
+    /// apply renumeration of elements (permutation of all element indices)
     void renumerate(const renumeration_t<elem_t>& m) {
-        decltype(CT) M;
-        for(auto& kv: CT) M.emplace(pair<elem_t,elem_t>(m.at(kv.first.first), m.at(kv.first.second)), m.at(kv.second));
-        CT = M;
+        vector<elem_t> p(order), q(order, order);   // renumeration and its inverse
+        for(size_t i = 0; i < order; ++i) {
+            p[i] = m.at(i);
+            if(size_t(p[i]) >= order || size_t(q[p[i]]) != order) throw std::invalid_argument("Cayley table renumeration is not a permutation");
+            q[p[i]] = i;
+        }
+        if(w == 1) permute(CT8, p, q);
+        else if(w == 2) permute(CT16, p, q);
+        else permute(CT32, p, q);
+
         auto it = m.find(iID);
         if(it != m.end()) iID = it->second;
-        inverses = renum_renum(inverses, m);
+        vector<enum_t> vinv(order, order);
+        for(size_t i = 0; i < order; ++i) if(size_t(inverses[q[i]]) != order) vinv[i] = p[inverses[q[i]]];
+        inverses.swap(vinv);
     }
 
+    static int nthreads;        ///< threads for table construction and renumeration (0 for hardware)
+
 protected:
-    enum_t iID;                             ///< identity element index
-    map<pair<elem_t, elem_t>, elem_t> CT;   ///< Cayley Table ab -> C
-    const size_t order;                     ///< number of elements
-    map<enum_t, enum_t> inverses;           ///< inverses map
+    /// run f(row0, row1) over all rows, in blocks on pool threads for larger tables
+    void forRows(const std::function<void(size_t, size_t)>& f) const {
+        const size_t nr = std::max(size_t(1), (size_t(1) << 14)/std::max(order, size_t(1)));   // rows per block
+        if(nthreads == 1 || order <= nr) { f(0, order); return; }
+        WorkStealingPool P(std::max(nthreads, 0));
+        for(size_t i = 0; i < order; i += nr) P.submit([&f, i, nr, this] { f(i, std::min(i + nr, order)); });
+        P.wait_idle();
+    }
+
+    /// fill products table from G
+    template<typename C>
+    void build(const ESG_t& G, vector<C>& T) {
+        typedef typename std::decay<decltype(*G.begin())>::type gelem_t;
+        vector<gelem_t> es;
+        es.reserve(order);
+        for(auto& e: G) es.push_back(e);
+        T.resize(order*order);
+
+        forRows([&](size_t i0, size_t i1) {
+            for(size_t i = i0; i < i1; ++i) {
+                auto r = T.data() + i*order;
+                for(size_t j = 0; j < order; ++j) {
+                    auto k = G.idx(G.apply(es[i], es[j]));
+                    assert(k < (decltype(k))order);
+                    if(k == iID) inverses[i] = j;
+                    r[j] = C(k);
+                }
+            }
+        });
+    }
+
+    /// gather products table to renumerated order: (p_a p_b) -> p_(ab), for renumeration p with inverse q
+    template<typename C>
+    void permute(vector<C>& T, const vector<elem_t>& p, const vector<elem_t>& q) const {
+        vector<C> TT(T.size());
+        forRows([&](size_t i0, size_t i1) {
+            for(size_t i = i0; i < i1; ++i) {
+                auto r = T.data() + size_t(q[i])*order;
+                auto rr = TT.data() + i*order;
+                for(size_t j = 0; j < order; ++j) rr[j] = C(p[r[q[j]]]);
+            }
+        });
+        T.swap(TT);
+    }
+
+    enum_t iID;                 ///< identity element index
+    const size_t order;         ///< number of elements
+    const int w;                ///< table entry width [bytes]
+    vector<uint8_t> CT8;        ///< Cayley Table [a*order + b] -> ab, for w = 1
+    vector<uint16_t> CT16;      ///< Cayley Table [a*order + b] -> ab, for w = 2
+    vector<uint32_t> CT32;      ///< Cayley Table [a*order + b] -> ab, for w = 4
+    vector<enum_t> inverses;    ///< inverse of each element (order if none)
 };
 
+template<class ESG_t>
+int SGCayleyTable<ESG_t>::nthreads = 0;
+
 /// Cayley Table for <Enumerated Group>
 template<class EG_t>
 class CayleyTable: public SGCayleyTable<EG_t> {
@@ -79,9 +151,9 @@ public:
     /// print table info to stdout
     void display() const {
         using std::cout;
-        for(auto& kv: this->inverses) {
-            cout << kv.first << " [" << kv.second << "]";
-            for(auto& kv2: this->inverses) cout << " " << this->apply(kv.first, kv2.first);
+        for(enum_t i = 0; i < this->order; ++i) {
+            cout << i << " [" << this->inverse(i) << "]";
+            for(enum_t j = 0; j < this->order; ++j) cout << " " << this->apply(i, j);
             cout << "\n";
         }
     }
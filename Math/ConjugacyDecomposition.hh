@@ -5,6 +5,7 @@
 
 #include "CayleyTable.hh"
 #include "EquivalenceClasses.hh"
+#include <atomic>
 
 /// Analysis of <Enumerated Semigroup> into element orders
 template<class G>
@@ -51,36 +52,50 @@ public:
     }
 };
 
-/// Analysis of <Enumerated Semigroup> into element orders and conjugacy classes
+/// Analysis of <Enumerated Group> into element orders and conjugacy classes
+/**
+    Each class is found whole when its first element is reached (in order of element order, then index, then
+    powers of new class representatives), as the conjugation orbit of that element: either {x e x^-1} over all x,
+    or the breadth-first closure of e under g e g^-1 for supplied generators g, costing ~ 2 |G| #generators products
+    in total instead of 2 |G| per class. Orbit elements are claimed in an atomic bitset over element indices,
+    so blocks of x (or of the orbit frontier) are conjugated on nthreads (0 for hardware) pool threads;
+    G.apply and G.idx must be thread-safe. Class numbering does not depend on the method or thread count.
+*/
 template<class G>
 class ConjugacyDecomposition: public OrdersDecomposition<G> {
 public:
-    /// Constructor from <Enumerated Semigroup>
-    ConjugacyDecomposition(const G& g = {}): OrdersDecomposition<G>(g) {
-        for(auto& x: g) vscramble.push_back(x);
-        std::random_shuffle(vscramble.begin(), vscramble.end());
+    /// element type
+    typedef typename G::elem_t elem_t;
+
+    /// Constructor from <Enumerated Group>, conjugating by all elements
+    ConjugacyDecomposition(const G& g = {}): ConjugacyDecomposition(g, vector<elem_t>{}) { }
+
+    /// Constructor from <Enumerated Group> and its generators
+    ConjugacyDecomposition(const G& g, const vector<elem_t>& gens): OrdersDecomposition<G>(g) {
+        orbit_ws W(g, g.getOrder());
+        for(auto& x: gens) {
+            W.gs.push_back(x);
+            W.gis.push_back(g.element(this->inverse_idx(g.idx(x))));
+        }
 
         for(auto& os: this->by_order) {
-            for(auto i: os.second) assign_CC(os.first, i, g);
+            for(auto i: os.second) assign_CC(os.first, i, W);
 
             if(g.getOrder() > 1000) {
                 std::cout << "Order " << os.first << ": ";
-                for(auto& cc: M[os.first].CCs) std::cout << "(" << cc.second.size() << ") ";
+                auto& CCs = M[os.first].CCs;
+                for(auto c: CCs) std::cout << "(" << CCs.classSize(c) << ") ";
                 std::cout << std::endl;
             }
-
-            repr_cosets.erase(os.first);
         }
-
-        vscramble.clear();
     }
 
     /// Display info
     void display(std::ostream& o = std::cout) const {
         o << "Group with " << this->cycles.size() << " elements in conjugacy classes:\n";
         for(auto& kv: M)
-            for(auto& ec: kv.second.CCs)
-                o << "\t" << ec.second.size() << " elements\t[order " << kv.first << "]\n";
+            for(auto c: kv.second.CCs)
+                o << "\t" << kv.second.CCs.classSize(c) << " elements\t[order " << kv.first << "]\n";
     }
 
     /// ``nicer'' re-enumeration scheme
@@ -88,8 +103,8 @@ public:
         renumeration_t<> m;
         size_t i = 0;
         for(auto& kv: M)
-            for(auto& ec: kv.second.CCs)
-                for(auto& e: ec.second)
+            for(auto c: kv.second.CCs)
+                for(auto e: kv.second.CCs.getClassNum(c))
                     m[e] = i++;
         return m;
     }
@@ -104,57 +119,98 @@ public:
     /// information on elements of a particular order
     struct oinfo {
         /// Conjugacy class decomposition for elements of this order
-        EquivalenceClasses<size_t> CCs;
+        DenseEquivalenceClasses<> CCs;
         /// powerup structure {order, conjclass} for each conjugacy class of this order
         vector<vector<pair<size_t,size_t>>> powerup;
     };
     map<size_t, oinfo> M;   ///< information by order
 
+    static int nthreads;    ///< threads for conjugation orbits (0 for hardware)
+
 protected:
-    vector<typename G::elem_t> vscramble;                       ///< scrambled search order
-    map<size_t,vector<vector<typename G::enum_t>>> repr_cosets; ///< representative cosets for each class --- cleared after construction
+    /// workspace for conjugation orbits during construction
+    struct orbit_ws {
+        /// Constructor, for group of order n
+        orbit_ws(const G& gg, size_t n): g(gg), claimed((n + 63)/64) { }
+
+        const G& g;                             ///< group
+        vector<elem_t> gs;                      ///< conjugating generators (empty for all elements)
+        vector<elem_t> gis;                     ///< generator inverses
+        vector<std::atomic<uint64_t>> claimed;  ///< bitset of classified element indices
+        std::unique_ptr<WorkStealingPool> P;    ///< pool threads, started on first parallel use
+
+        /// claim element index; return whether newly claimed
+        bool claim(size_t i) {
+            const uint64_t b = uint64_t(1) << (i & 63);
+            auto& c = claimed[i >> 6];
+            return !(c.load(std::memory_order_relaxed) & b) && !(c.fetch_or(b, std::memory_order_relaxed) & b);
+        }
+
+        /// run f(0...n-1), serially or on pool
+        void run(size_t n, const std::function<void(size_t)>& f) {
+            if(nthreads == 1 || n < 2) { for(size_t b = 0; b < n; ++b) f(b); return; }
+            if(!P) P.reset(new WorkStealingPool(std::max(nthreads, 0)));
+            for(size_t b = 0; b < n; ++b) P->submit([&f, b] { f(b); });
+            P->wait_idle();
+        }
+    };
+
+    static constexpr size_t chunk = 1024;   ///< elements per orbit calculation block
+
+    /// claim and return conjugation orbit (conjugacy class) of unclassified element index i
+    vector<size_t> orbit(size_t i, orbit_ws& W) const {
+        const G& g = W.g;
+        vector<size_t> cls(1, i);
+        W.claim(i);
+        vector<vector<size_t>> vv;  // newly-claimed elements by block
+
+        if(W.gs.empty()) {
+            // x e x^-1 over all x
+            const auto e = g.element(i);
+            const size_t n = g.getOrder();
+            vv.resize((n + chunk - 1)/chunk);
+            W.run(vv.size(), [&](size_t b) {
+                auto& v = vv[b];
+                for(size_t x = b*chunk; x < std::min(n, (b + 1)*chunk); ++x) {
+                    size_t j = g.idx(g.apply(g.apply(g.element(x), e), g.element(this->inverse_idx(x))));
+                    if(W.claim(j)) v.push_back(j);
+                }
+            });
+            for(auto& v: vv) cls.insert(cls.end(), v.begin(), v.end());
+            return cls;
+        }
+
+        // breadth-first closure under generator conjugation
+        for(size_t f0 = 0; f0 < cls.size();) {
+            const size_t f1 = cls.size();
+            vv.assign((f1 - f0 + chunk - 1)/chunk, {});
+            W.run(vv.size(), [&](size_t b) {
+                auto& v = vv[b];
+                for(size_t k = f0 + b*chunk; k < std::min(f1, f0 + (b + 1)*chunk); ++k) {
+                    const auto f = g.element(cls[k]);
+                    for(size_t m = 0; m < W.gs.size(); ++m) {
+                        size_t j = g.idx(g.apply(g.apply(W.gs[m], f), W.gis[m]));
+                        if(W.claim(j)) v.push_back(j);
+                    }
+                }
+            });
+            for(auto& v: vv) cls.insert(cls.end(), v.begin(), v.end());
+            f0 = f1;
+        }
+        return cls;
+    }
 
     /// determine conj. class number to which element idx=i of order o belongs
-    size_t assign_CC(size_t o, size_t i, const G& g) {
+    size_t assign_CC(size_t o, size_t i, orbit_ws& W) {
         auto& oi = M[o]; // already-identified conjugacy info for this order
 
         // already categorized?
         auto p = oi.CCs(i);
         if(p.first) return p.second;
 
-        // check if element fits into any existing conjugacy class
-        auto e = g.element(i);
-        if(oi.CCs.size()) {
-            size_t j = 0;
-            for(auto& x: vscramble) {
-                auto ixe = g.idx(g.apply(x, e));
-                for(auto& CC: oi.CCs) {
-                    if(ixe != repr_cosets[o][CC.first][j]) continue;
-
-                    auto& pu = oi.powerup[CC.first];
-                    if(pu.size()) {
-                        // bulk assign all powers of this element if powerup structure already determined
-                        size_t k = 0;
-                        for(auto ii: this->cycles[i]) {
-                            auto oc = pu[k++];
-                            M[oc.first].CCs.addTo(ii, oc.second);
-                        }
-                    } else oi.CCs.addTo(i, CC.first); // only add this element
-
-                    return CC.first;
-                }
-                j++;
-            }
-        }
-
-        // start new conjugacy class
+        // start new conjugacy class from whole orbit
         auto n = oi.CCs.add(i,i);
-
-        // build representative coset for class
-        auto& vcs = repr_cosets[o];
-        vcs.emplace_back();
-        auto& cs = vcs.back();
-        for(auto& x: vscramble) cs.push_back(g.idx(g.apply(e, x)));
+        for(auto j: orbit(i, W)) oi.CCs.addTo(j, n);
 
         // build powerup structure
         assert(n == oi.powerup.size());
@@ -163,7 +219,7 @@ protected:
         for(auto ii: this->cycles[i]) {
             if(ii == i) continue;
             auto oo = this->cycles[ii].size();
-            pu.emplace_back(oo, assign_CC(oo,ii,g));
+            pu.emplace_back(oo, assign_CC(oo, ii, W));
         }
         oi.powerup[n] = pu;
 
@@ -171,6 +227,12 @@ protected:
     }
 };
 
+template<class G>
+int ConjugacyDecomposition<G>::nthreads = 0;
+
+template<class G>
+constexpr size_t ConjugacyDecomposition<G>::chunk;
+
 /// Bundle of calculations resulting in conjugacy-enumerated elements
 template<class G>
 class GeneratorsConjugacy {
@@ -186,7 +248,7 @@ public:
     typedef typename cayley_t::enum_t enum_t;
 
     /// Constructor
-    explicit GeneratorsConjugacy(const vector<typename G::elem_t>& gs, const G& GG = {}): Rs(gs,GG) {
+    explicit GeneratorsConjugacy(const vector<typename G::elem_t>& gs, const G& GG = {}): Rs(gs,GG), CD(CT, cayley_generators(gs)) {
         renumerate(CD.make_renumeration());
     }
 
@@ -200,6 +262,14 @@ public:
     genspan_t Rs;       ///< generators span
     cayley_t CT{Rs};    ///< Cayley Table
     conjugacy_t CD{CT}; ///< Conjugacy relations
+
+protected:
+    /// generators as Cayley Table elements
+    vector<enum_t> cayley_generators(const vector<typename G::elem_t>& gs) const {
+        vector<enum_t> v;
+        for(auto& x: gs) v.push_back(Rs.idx(x));
+        return v;
+    }
 };
 
 #endif
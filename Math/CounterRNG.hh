@@ -0,0 +1,58 @@
+/// \file CounterRNG.hh Counter-based (stateless hash) random number streams, for reproducible bulk and multi-threaded draws
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef COUNTERRNG_HH
+#define COUNTERRNG_HH
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// Random stream for (seed, stream number): draw c is a hash of (stream key, c), so any draw of any stream is directly addressable
+/**
+ * Streams are independent of how work is divided among threads or blocks, making results reproducible for any thread count;
+ * bulk fills are branch-free loops over counters, which the compiler vectorizes.
+ * The hash is the splitmix64 finalizer applied to a Weyl sequence per stream.
+ */
+class CounterRNG {
+public:
+    /// Constructor, for seed and stream number, starting at counter c0
+    explicit CounterRNG(uint64_t seed = 0, uint64_t stream = 0, uint64_t c0 = 0): key(streamKey(seed, stream)), ctr(c0) { }
+
+    /// splitmix64 finalizer
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    /// key for stream of seed
+    static uint64_t streamKey(uint64_t seed, uint64_t stream) { return mix(mix(seed) ^ mix(stream + weyl)); }
+    /// raw 64-bit draw c from stream key k
+    static uint64_t draw(uint64_t k, uint64_t c) { return mix(k + c*weyl); }
+    /// uniform [0,1) from 64-bit draw
+    static double to_uniform(uint64_t x) { return (x >> 11) * (1./9007199254740992.); }
+
+    /// next 64-bit draw
+    uint64_t next() { return draw(key, ctr++); }
+    /// next uniform [0,1)
+    double operator()() { return to_uniform(next()); }
+    /// fill u[n] with next n uniforms [0,1)
+    void fill(double* u, size_t n) {
+        for(size_t i = 0; i < n; i++) u[i] = to_uniform(draw(key, ctr + i));
+        ctr += n;
+    }
+
+    /// get stream key
+    uint64_t getKey() const { return key; }
+    /// get counter for next draw
+    uint64_t getCounter() const { return ctr; }
+    /// set counter for next draw
+    void setCounter(uint64_t c) { ctr = c; }
+
+    static constexpr uint64_t weyl = 0x9e3779b97f4a7c15ULL;    ///< Weyl sequence increment (golden ratio)
+
+protected:
+    uint64_t key;   ///< stream key
+    uint64_t ctr;   ///< counter for next draw
+};
+
+#endif
@@ -8,6 +8,8 @@
 #include <cassert>
 #include <utility>
 using std::pair;
+#include <stdexcept>
+#include <stdint.h>
 
 /////////////////////////
 // <Equivalence Relation> interface:
@@ -64,7 +66,7 @@ public:
         if(it0 == egm.end()) return false;
         auto it1 = egm.find(e1);
         if(it1 == egm.end()) return false;
-        return it0->first == it1->first;
+        return it0->second == it1->second;
     }
 
     /// add equivalency a ~ b; return class number for both
@@ -156,4 +158,219 @@ protected:
     }
 };
 
+/// Equivalence classes over dense element indices 0...N-1, by union-find (path compression, union by rank);
+/// near-O(1) classification and merging, with per-class member lists materialized on demand.
+/// Class identifiers are assigned in creation order; merged classes keep the lower identifier.
+/// Not thread-safe, including const lookups (path compression).
+template<typename Tidx = size_t>
+class DenseEquivalenceClasses {
+public:
+    /// Element identifier type
+    typedef size_t elem_t;
+    /// Equivalence class identifier type
+    typedef Tidx eqidx_t;
+    /// unassigned element/class marker
+    static constexpr size_t npos = size_t(-1);
+
+    /// iterator over (live) class identifiers
+    class const_iterator {
+    public:
+        /// Constructor
+        const_iterator(const DenseEquivalenceClasses& E, size_t c): EC(E), i(c) { skip(); }
+        /// dereference to class identifier
+        eqidx_t operator*() const { return i; }
+        /// increment
+        const_iterator& operator++() { ++i; skip(); return *this; }
+        /// comparison
+        bool operator!=(const const_iterator& r) const { return i != r.i; }
+    protected:
+        const DenseEquivalenceClasses& EC;  ///< classes being iterated
+        size_t i;                           ///< current class
+        /// skip merged-away classes
+        void skip() { while(i < EC.croot.size() && EC.croot[i] == npos) ++i; }
+    };
+
+    /// number of equivalence classes
+    size_t size() const { return nlive; }
+    /// start of class identifiers
+    const_iterator begin() const { return const_iterator(*this, 0); }
+    /// end of class identifiers
+    const_iterator end() const { return const_iterator(*this, croot.size()); }
+
+    /// return equivalence class identifier for element
+    eqidx_t classidx(elem_t e) const {
+        auto r = root(e);
+        if(r == npos) throw std::out_of_range("Unclassified element");
+        return rootcls[r];
+    }
+    /// check if element already categorized
+    bool has(elem_t e) const { return e < parent.size() && parent[e] != npos; }
+    /// equivalence class if element categorized
+    pair<bool,eqidx_t> operator()(elem_t e) const {
+        auto r = root(e);
+        if(r == npos) return {false, eqidx_t(-1)};
+        return {true, rootcls[r]};
+    }
+    /// check if equivalent
+    bool equiv(elem_t e0, elem_t e1) const {
+        if(e0 == e1) return true;
+        auto r0 = root(e0);
+        return r0 != npos && r0 == root(e1);
+    }
+
+    /// add equivalency a ~ b; return class number for both
+    eqidx_t add(elem_t a, elem_t b) {
+        auto ra = root(a);
+        auto rb = root(b);
+        if(ra == npos && rb == npos) {
+            auto c = newClass(a);
+            if(b != a) addTo(b, c);
+            return c;
+        }
+        if(ra == npos) { addTo(a, rootcls[rb]); return rootcls[rb]; }
+        if(rb == npos) { addTo(b, rootcls[ra]); return rootcls[ra]; }
+        return merge(rootcls[ra], rootcls[rb]);
+    }
+
+    /// classify element (potentially in new equivalence class) using supplied operation F(a,b): a==b
+    template<typename F>
+    eqidx_t classify(elem_t a, F equals) {
+        for(auto c: *this) {
+            if(equals(a, croot[c])) {
+                addTo(a, c);
+                return c;
+            }
+        }
+        return newClass(a);
+    }
+
+    /// add to pre-existing equivalence class
+    void addTo(elem_t e, eqidx_t c) {
+        if(has(e)) {
+            assert(classidx(e) == c);
+            return;
+        }
+        auto r = croot.at(c);
+        grow(e);
+        parent[e] = r;
+        if(!rnk[r]) rnk[r] = 1;
+        ++csize[c];
+        stale = true;
+    }
+
+    /// number of elements in numbered equivalence class
+    size_t classSize(eqidx_t n) const { return n < croot.size() && croot[n] != npos? csize[n] : 0; }
+    /// get numbered equivalence class members (sorted); empty if no such class
+    const vector<elem_t>& getClassNum(eqidx_t n) const {
+        static const vector<elem_t> vnull{};
+        if(n >= croot.size() || croot[n] == npos) return vnull;
+        if(stale) materialize();
+        return members[n];
+    }
+    /// get equivalence class of element e; empty if e unclassified
+    const vector<elem_t>& getClassFor(elem_t e) const {
+        static const vector<elem_t> vnull{};
+        auto r = root(e);
+        return r == npos? vnull : getClassNum(rootcls[r]);
+    }
+    /// representative element for class
+    elem_t representative(eqidx_t i) const {
+        auto r = croot.at(i);
+        if(r == npos) throw std::out_of_range("Merged equivalence class");
+        return r;
+    }
+
+    /// apply renumeration (permutation of element indices)
+    void renumerate(const renumeration_t<elem_t>& m) {
+        vector<elem_t> p(parent.size(), npos);
+        vector<uint8_t> rk(parent.size());
+        vector<eqidx_t> rc(parent.size());
+        for(elem_t e = 0; e < parent.size(); ++e) {
+            if(parent[e] == npos) continue;
+            auto ee = m.at(e);
+            if(ee >= p.size()) { p.resize(ee + 1, npos); rk.resize(ee + 1); rc.resize(ee + 1); }
+            p[ee] = m.at(parent[e]);
+            rk[ee] = rnk[e];
+            rc[ee] = rootcls[e];
+        }
+        for(auto& r: croot) if(r != npos) r = m.at(r);
+        parent.swap(p);
+        rnk.swap(rk);
+        rootcls.swap(rc);
+        stale = true;
+    }
+
+protected:
+    mutable vector<elem_t> parent;  ///< union-find parent of each element; npos if unclassified
+    vector<uint8_t> rnk;            ///< union-by-rank tree rank bound
+    vector<eqidx_t> rootcls;        ///< class identifier, for class root elements
+    vector<elem_t> croot;           ///< root element for each class identifier; npos if merged away
+    vector<size_t> csize;           ///< number of elements by class identifier
+    size_t nlive = 0;               ///< number of (un-merged) classes
+
+    mutable vector<vector<elem_t>> members; ///< lazily-materialized members by class
+    mutable bool stale = false;             ///< whether members needs rebuilding
+
+    /// expand element storage to include e
+    void grow(elem_t e) {
+        if(e < parent.size()) return;
+        parent.resize(e + 1, npos);
+        rnk.resize(e + 1);
+        rootcls.resize(e + 1);
+    }
+    /// find root of element, compressing path; npos if unclassified
+    elem_t root(elem_t e) const {
+        if(e >= parent.size() || parent[e] == npos) return npos;
+        auto r = e;
+        while(parent[r] != r) r = parent[r];
+        while(parent[e] != r) { auto p = parent[e]; parent[e] = r; e = p; }
+        return r;
+    }
+    /// start new class from unclassified element
+    eqidx_t newClass(elem_t e) {
+        assert(!has(e));
+        grow(e);
+        parent[e] = e;
+        rnk[e] = 0;
+        eqidx_t c = croot.size();
+        rootcls[e] = c;
+        croot.push_back(e);
+        csize.push_back(1);
+        ++nlive;
+        stale = true;
+        return c;
+    }
+    /// merge two equivalence classes
+    eqidx_t merge(eqidx_t n0, eqidx_t n1) {
+        if(n1 == n0) return n0;
+        if(n1 < n0) std::swap(n0, n1);
+        auto r0 = croot.at(n0);
+        auto r1 = croot.at(n1);
+        if(rnk[r0] < rnk[r1]) std::swap(r0, r1);
+        parent[r1] = r0;
+        if(rnk[r0] == rnk[r1]) ++rnk[r0];
+        rootcls[r0] = n0;
+        croot[n0] = r0;
+        croot[n1] = npos;
+        csize[n0] += csize[n1];
+        csize[n1] = 0;
+        --nlive;
+        stale = true;
+        return n0;
+    }
+    /// rebuild members lists
+    void materialize() const {
+        members.assign(croot.size(), {});
+        for(size_t c = 0; c < croot.size(); ++c) members[c].reserve(csize[c]);
+        for(elem_t e = 0; e < parent.size(); ++e) {
+            auto r = root(e);
+            if(r != npos) members[rootcls[r]].push_back(e);
+        }
+        stale = false;
+    }
+};
+
+template<typename Tidx>
+constexpr size_t DenseEquivalenceClasses<Tidx>::npos;
+
 #endif
@@ -1,6 +1,7 @@
 /// \file Eratosthenes.cc
 
 #include "Eratosthenes.hh"
+#include "WorkStealingPool.hh"
 #include <algorithm>
 #include <cassert>
 
@@ -10,8 +11,108 @@ PrimeSieve& theSieve() {
 }
 
 PrimeSieve::factors_t PrimeSieve::factor(uint_t i) {
-    std::lock_guard<std::mutex> LG(sieveLock);
-    return _factor(i);
+    auto& SS = theSegmentedSieve();
+    if(i <= UINT32_MAX) return SS.factor(i);
+
+    // trial division by segmented sieve primes, until cofactor is prime or in 32-bit range
+    factors_t f;
+    for(auto p: SS.getPrimes()) {
+        while(!(i % p)) { f.push_back(p); i /= p; }
+        if(i <= UINT32_MAX) {
+            auto v = SS.factor(i);
+            f.insert(f.end(), v.begin(), v.end());
+            return f;
+        }
+        if(uint_t(p)*p > i) { f.push_back(i); return f; }
+    }
+
+    // cofactor beyond sieve primes squared
+    factors_t v;
+    factorLarge(i, v);
+    std::sort(v.begin(), v.end());
+    f.insert(f.end(), v.begin(), v.end());
+    return f;
+}
+
+PrimeSieve::uint_t PrimeSieve::gcd(uint_t a, uint_t b) {
+    if(!a) return b;
+    if(!b) return a;
+    int k = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while(b) {
+        b >>= __builtin_ctzll(b);
+        if(a > b) std::swap(a, b);
+        b -= a;
+    }
+    return a << k;
+}
+
+/// a*b mod m
+static inline uint64_t mulmod64(uint64_t a, uint64_t b, uint64_t m) { return (__uint128_t(a)*b) % m; }
+
+/// a^e mod m
+static uint64_t powmod64(uint64_t a, uint64_t e, uint64_t m) {
+    uint64_t r = 1;
+    for(; e; e >>= 1) {
+        if(e & 1) r = mulmod64(r, a, m);
+        a = mulmod64(a, a, m);
+    }
+    return r;
+}
+
+bool PrimeSieve::isPrime64(uint_t n) {
+    if(n < 2) return false;
+    for(uint64_t p: {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) if(!(n % p)) return n == p;
+
+    // deterministic Miller-Rabin bases for all 64-bit n
+    auto d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+    for(uint64_t a: {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        auto x = powmod64(a, d, n);
+        if(x == 1 || x == n - 1) continue;
+        int r = 1;
+        for(; r < s; ++r) {
+            x = mulmod64(x, x, n);
+            if(x == n - 1) break;
+        }
+        if(r == s) return false;
+    }
+    return true;
+}
+
+void PrimeSieve::factorLarge(uint_t n, factors_t& f) {
+    if(n == 1) return;
+    if(isPrime64(n)) { f.push_back(n); return; }
+
+    // Pollard-Brent rho, for composite n without small factors
+    for(uint64_t c = 1; ; ++c) {
+        uint64_t x = 2, y = 2, d = 1, q = 1, ys = 2;
+        const size_t m = 128;
+        for(size_t r = 1; d == 1; r *= 2) {
+            x = y;
+            for(size_t k = 0; k < r; ++k) y = (mulmod64(y, y, n) + c) % n;
+            for(size_t k = 0; k < r && d == 1; k += m) {
+                ys = y;
+                for(size_t j = 0; j < m && j < r - k; ++j) {
+                    y = (mulmod64(y, y, n) + c) % n;
+                    q = mulmod64(q, x > y? x - y : y - x, n);
+                }
+                d = gcd(q, n);
+            }
+        }
+        if(d == n) {
+            do {
+                ys = (mulmod64(ys, ys, n) + c) % n;
+                d = gcd(x > ys? x - ys : ys - x, n);
+            } while(d == 1);
+        }
+        if(d != n) {
+            factorLarge(d, f);
+            factorLarge(n/d, f);
+            return;
+        }
+    }
 }
 
 void PrimeSieve::addXF(uint_t i, const factors_t& v) {
@@ -94,7 +195,7 @@ PrimeSieve::uint_t PrimeSieve::checkNext() {
 PrimeSieve::uint_t PrimeSieve::prod(const factors_t& f) {
     uint_t i = 1;
     for(auto& p: f) {
-        assert(!p || i < std::numeric_limits<uint_t>::max()/p);
+        assert(!p || i <= std::numeric_limits<uint_t>::max()/p);
         i *= p;
     }
     return i;
@@ -104,3 +205,95 @@ void PrimeSieve::display() const {
     printf("PrimeSieve with %zu + %zu factorizations using %zu primes\n",
             factors.size(), xf.size(), primes.size());
 }
+
+//////////////////////////////////////
+
+constexpr size_t SegmentedSieve::block;
+
+const SegmentedSieve& theSegmentedSieve() {
+    static const SegmentedSieve SS;
+    return SS;
+}
+
+SegmentedSieve::SegmentedSieve(uint32_t n, int nthreads): nmax(std::max(n, uint32_t(3))) {
+    // base primes covering sqrt of any 32-bit integer
+    const uint32_t nb = 1 << 16;
+    vector<uint8_t> c(nb);
+    for(uint32_t i = 2; i < nb; ++i) {
+        if(c[i]) continue;
+        base.push_back(i);
+        for(uint32_t j = i*i; j < nb; j += i) c[j] = 1;
+    }
+
+    odd_spf.resize((size_t(nmax) + 1)/2);
+    const size_t nblk = (odd_spf.size() + block - 1)/block;
+    vector<vector<uint32_t>> ps(nblk);
+    if(nthreads == 1 || nblk < 2) for(size_t b = 0; b < nblk; ++b) fillBlock(b, ps[b]);
+    else {
+        WorkStealingPool P(std::max(nthreads, 0));
+        for(size_t b = 0; b < nblk; ++b) P.submit([this, b, &ps] { fillBlock(b, ps[b]); });
+        P.wait_idle();
+    }
+
+    primes.push_back(2);
+    for(auto& v: ps) primes.insert(primes.end(), v.begin(), v.end());
+}
+
+void SegmentedSieve::fillBlock(size_t b, vector<uint32_t>& ps) {
+    const size_t i0 = b*block;
+    const size_t i1 = std::min(odd_spf.size(), i0 + block);
+    uint32_t* s = odd_spf.data();
+
+    // mark odd multiples of odd primes, smallest prime first
+    const uint64_t n0 = 2*i0 + 1;
+    const uint64_t n1 = 2*i1 + 1;
+    for(size_t k = 1; k < base.size(); ++k) {
+        const uint64_t p = base[k];
+        if(p*p >= n1) break;
+        uint64_t m = std::max(p*p, ((n0 + p - 1)/p)*p);
+        if(!(m & 1)) m += p;
+        for(size_t j = m/2; j < i1; j += p) if(!s[j]) s[j] = p;
+    }
+
+    // unmarked entries are prime
+    for(size_t j = i0; j < i1; ++j) {
+        if(s[j]) continue;
+        s[j] = 2*j + 1;
+        if(j && 2*j + 1 < nmax) ps.push_back(2*j + 1);
+    }
+}
+
+uint32_t SegmentedSieve::spf(uint32_t n) const {
+    if(n < 2) return n;
+    if(!(n & 1)) return 2;
+    if(n < nmax) return odd_spf[n/2];
+    for(auto p: base) {
+        if(uint64_t(p)*p > n) break;
+        if(!(n % p)) return p;
+    }
+    return n;
+}
+
+PrimeSieve::factors_t SegmentedSieve::factor(uint32_t n) const {
+    if(!n) return {0};
+    PrimeSieve::factors_t f;
+
+    // trial division beyond table range, continuing from last factor
+    size_t k = 0;
+    while(n >= nmax) {
+        while(k < base.size() && uint64_t(base[k])*base[k] <= n && n % base[k]) ++k;
+        if(k == base.size() || uint64_t(base[k])*base[k] > n) {
+            f.push_back(n);
+            return f;
+        }
+        f.push_back(base[k]);
+        n /= base[k];
+    }
+
+    while(n > 1) {
+        auto p = spf(n);
+        f.push_back(p);
+        n /= p;
+    }
+    return f;
+}
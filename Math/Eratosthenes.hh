@@ -28,6 +28,7 @@ using std::vector;
 #include <map>
 using std::map;
 #include <mutex>
+#include <stdint.h>
 
 /// Sieve of Eratosthenes primes/factoring utility
 class PrimeSieve {
@@ -43,7 +44,7 @@ public:
     /// factorization (sorted); empty vector for 1, {0} for 0
     typedef vector<uint_t> factors_t;
 
-    /// get factorization (thread-safe)
+    /// get factorization (thread-safe; lock-free from theSegmentedSieve() for 32-bit i)
     factors_t factor(uint_t i);
     /// get factorization (not thread-safe)
     factors_t _factor(uint_t i);
@@ -53,6 +54,12 @@ public:
 
     /// factors product
     static uint_t prod(const factors_t& f);
+    /// deterministic (Miller-Rabin) 64-bit primality test
+    static bool isPrime64(uint_t n);
+    /// append (unsorted) prime factors of n with no small factors, by Pollard-Brent rho
+    static void factorLarge(uint_t n, factors_t& f);
+    /// greatest common divisor (binary algorithm)
+    static uint_t gcd(uint_t a, uint_t b);
     /// get primes list
     const vector<uint_t>& getPrimes() const { return primes; }
     /// get prime division checks
@@ -80,4 +87,37 @@ protected:
 /// global singleton access
 PrimeSieve& theSieve();
 
+/// Segmented sieve: smallest-prime-factor table for n < nmax, filled in parallel cache-sized blocks; immutable (lock-free) once constructed
+class SegmentedSieve {
+public:
+    /// Constructor, for table size and fill threads (0 for hardware)
+    explicit SegmentedSieve(uint32_t n = 1 << 22, int nthreads = 0);
+
+    /// smallest prime factor (0 for 0, 1 for 1); trial division by primes < 2^16 beyond table
+    uint32_t spf(uint32_t n) const;
+    /// whether n is prime
+    bool isPrime(uint32_t n) const { return n > 1 && spf(n) == n; }
+    /// factorization (sorted); empty vector for 1, {0} for 0, as PrimeSieve
+    PrimeSieve::factors_t factor(uint32_t n) const;
+
+    /// primes < nmax
+    const vector<uint32_t>& getPrimes() const { return primes; }
+    /// table size
+    uint32_t size() const { return nmax; }
+
+    static constexpr size_t block = 1 << 15;    ///< table entries per fill block
+
+protected:
+    /// fill table block b, appending found primes to ps
+    void fillBlock(size_t b, vector<uint32_t>& ps);
+
+    const uint32_t nmax;        ///< table size
+    vector<uint32_t> base;      ///< primes < 2^16
+    vector<uint32_t> odd_spf;   ///< smallest prime factor of odd numbers, odd_spf[i] for n = 2i+1
+    vector<uint32_t> primes;    ///< primes < nmax
+};
+
+/// global segmented sieve singleton access
+const SegmentedSieve& theSegmentedSieve();
+
 #endif
@@ -0,0 +1,335 @@
+/// \file FFTW_Batch.hh Batched and multi-dimensional FFTW transforms and convolutions
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef FFTW_BATCH_HH
+#define FFTW_BATCH_HH
+
+#include "FFTW_Convolver.hh"
+#include <stdexcept>
+#include <utility>
+
+/// default planner threads for batch plans (initially $FFTW_NTHREADS, or 1); applies to subsequently-made plans
+int& fftw_batch_threads();
+
+/// Layout of a batch of same-shape, row-major multi-dimensional arrays
+struct FFTWBatchLayout {
+    /// Constructor, with array dimensions (slowest-varying first), batch size, interleaving
+    explicit FFTWBatchLayout(const vector<int>& d = {1}, int n = 1, bool il = false):
+    dims(d), howmany(n), interleaved(il) {
+        if(dims.empty() || howmany < 1) throw std::logic_error("Invalid FFTW batch layout");
+        for(auto i: dims) if(i < 1) throw std::logic_error("Invalid FFTW batch array dimension");
+    }
+
+    vector<int> dims;   ///< dimensions of each array, slowest-varying first
+    int howmany;        ///< number of arrays in batch
+    bool interleaved;   ///< arrays element-interleaved (stride howmany, distance 1), rather than contiguous (stride 1, distance size())
+
+    /// number of elements in each array
+    size_t size() const { size_t n = 1; for(auto i: dims) n *= i; return n; }
+    /// number of elements in batch
+    size_t total() const { return size() * howmany; }
+    /// element stride within each array
+    int stride() const { return interleaved? howmany : 1; }
+    /// distance between starts of successive arrays
+    int dist() const { return interleaved? 1 : size(); }
+    /// position of element i of array b
+    size_t index(size_t b, size_t i) const { return interleaved? i*howmany + b : b*size() + i; }
+    /// same batch arrangement with different array dimensions
+    FFTWBatchLayout reshaped(const vector<int>& d) const { return FFTWBatchLayout(d, howmany, interleaved); }
+
+    /// comparison for map keys
+    bool operator<(const FFTWBatchLayout& r) const {
+        return std::tie(dims, howmany, interleaved) < std::tie(r.dims, r.howmany, r.interleaved);
+    }
+};
+
+//-----------------
+//----- Plans -----
+//-----------------
+
+/// Batched multi-dimensional transform plan base, between x-space layout LX and k-space layout LK
+template<typename T>
+class BatchPlan: public TransformPlan<T> {
+public:
+    /// Constructor, with logical (normalization) size and planner threads (0 for fftw_batch_threads())
+    BatchPlan(const FFTWBatchLayout& x, const FFTWBatchLayout& k, size_t nl, int nt):
+    TransformPlan<T>(x.total(), nl, k.total()), LX(x), LK(k),
+    nthreads(nt > 0? nt : fftw_batch_threads()), xdims(x.dims), kdims(k.dims) { }
+
+    const FFTWBatchLayout LX;   ///< x-space layout
+    const FFTWBatchLayout LK;   ///< k-space layout
+    const int nthreads;         ///< planner threads
+
+protected:
+    /// plan identity shape descriptor: rank, dimensions, batch size, interleaving, threads
+    vector<int> shape() const {
+        vector<int> s{int(xdims.size())};
+        s.insert(s.end(), xdims.begin(), xdims.end());
+        s.push_back(LX.howmany);
+        s.push_back(LX.interleaved);
+        s.push_back(nthreads);
+        return s;
+    }
+    /// transform rank
+    int rank() const { return xdims.size(); }
+
+    vector<int> xdims;  ///< x-space dimensions (non-const for FFTW calls)
+    vector<int> kdims;  ///< k-space dimensions (non-const for FFTW calls)
+};
+
+/// Batched multi-dimensional real-to-complex plan (periodic boundaries)
+template<typename T = double>
+class BatchR2CPlan: public BatchPlan<T> {
+public:
+    typedef typename fftwx<T>::real_t xspace_t;
+    typedef typename fftwx<T>::fcplx_t kspace_t;
+    typedef fftw_real_vec<T> xvec_t;
+    typedef fftw_cplx_vec<T> kvec_t;
+
+    /// Constructor
+    explicit BatchR2CPlan(const FFTWBatchLayout& L, int nt = 0):
+    BatchPlan<T>(L, L.reshaped(k_dims(L.dims)), L.size(), nt) { }
+
+    /// k-space dimensions for x-space dimensions d
+    static vector<int> k_dims(vector<int> d) { d.back() = d.back()/2 + 1; return d; }
+
+    /// make plan
+    void makePlan(bool fwd, xspace_t* v_x, kspace_t* v_k) {
+        auto& X = this->LX;
+        auto& K = this->LK;
+        auto n = this->xdims.data();
+        auto xe = this->xdims.data();
+        auto ke = this->kdims.data();
+        if(fwd) this->sharedPlan(this->R2C, 0, this->shape(), v_x, v_k, [&] {
+            return this->plan_many_dft_r2c(this->nthreads, this->rank(), n, X.howmany,
+                                           v_x, xe, X.stride(), X.dist(), v_k, ke, K.stride(), K.dist(), this->planner_flags()); });
+        else this->sharedPlan(this->C2R, 0, this->shape(), v_k, v_x, [&] {
+            return this->plan_many_dft_c2r(this->nthreads, this->rank(), n, X.howmany,
+                                           v_k, ke, K.stride(), K.dist(), v_x, xe, X.stride(), X.dist(), this->planner_flags()); });
+    }
+};
+
+/// Batched multi-dimensional DCT-I plan (mirror-symmetric boundaries in every dimension)
+template<typename T = double>
+class BatchDCT_I_Plan: public BatchPlan<T> {
+public:
+    typedef typename fftwx<T>::real_t xspace_t;
+    typedef typename fftwx<T>::real_t kspace_t;
+    typedef fftw_real_vec<T> xvec_t;
+    typedef fftw_real_vec<T> kvec_t;
+
+    /// Constructor
+    explicit BatchDCT_I_Plan(const FFTWBatchLayout& L, int nt = 0): BatchPlan<T>(L, L, n_log(L.dims), nt) { }
+
+    /// logical size for dimensions d
+    static size_t n_log(const vector<int>& d) {
+        size_t n = 1;
+        for(auto i: d) {
+            if(i < 2) throw std::logic_error("DCT-I requires dimensions >= 2");
+            n *= 2*(i-1);
+        }
+        return n;
+    }
+
+    /// make plan (forward and reverse are both REDFT00)
+    void makePlan(bool fwd, T* v_x, T* v_k) {
+        auto& L = this->LX;
+        auto n = this->xdims.data();
+        vector<fftw_r2r_kind> rk(this->rank(), FFTW_REDFT00);
+        auto i = fwd? v_x : v_k;
+        auto o = fwd? v_k : v_x;
+        this->sharedPlan(this->R2R, FFTW_REDFT00, this->shape(), i, o, [&] {
+            return this->plan_many_r2r(this->nthreads, this->rank(), n, L.howmany,
+                                       i, n, L.stride(), L.dist(), o, n, L.stride(), L.dist(), rk.data(), this->planner_flags()); });
+    }
+};
+
+//-----------------------------
+//----- Convolution plans -----
+//-----------------------------
+
+/// Convolution of every array in a batch with a common kernel, through batch plan BP (BatchR2CPlan or BatchDCT_I_Plan)
+template<class BP>
+class BatchConvolvePlan: public BP {
+public:
+    typedef typename BP::xspace_t xspace_t;
+    typedef typename BP::kspace_t kspace_t;
+    typedef typename BP::xvec_t xvec_t;
+    typedef typename BP::kvec_t kvec_t;
+
+    /// Constructor, for batch layout and planner threads (0 for fftw_batch_threads())
+    explicit BatchConvolvePlan(const FFTWBatchLayout& L, int nt = 0):
+    BP(L, nt), v_x(this->M), v_k(this->K), revPlan(L, this->nthreads), kernPlan(FFTWBatchLayout(L.dims), 1),
+    k_x(kernPlan.M), kkern(kernPlan.K) {
+        this->makePlan(true, (xspace_t*)v_x.data(), (kspace_t*)v_k.data());
+        revPlan.makePlan(false, (xspace_t*)v_x.data(), (kspace_t*)v_k.data());
+        kernPlan.makePlan(true, (xspace_t*)k_x.data(), (kspace_t*)kkern.data());
+    }
+
+    xvec_t v_x;     ///< x-space batch
+    kvec_t v_k;     ///< k-space batch
+    BP revPlan;     ///< reverse transform v_k * kernel -> v_x
+    BP kernPlan;    ///< single-array kernel transform k_x -> kkern
+
+    /// calculate (pre-normalized) k-space kernel from real-space kernel for one array
+    template<typename V>
+    void setKernel(const V& k) {
+        if(k.size() != kernPlan.M) throw std::logic_error("Mismatched batch convolution kernel size");
+        std::copy(k.begin(), k.end(), k_x.begin());
+        kernPlan.execute();
+        divide(kkern, kernPlan.Nlog);
+    }
+    /// current k-space kernel
+    const kvec_t& getKkern() const { return kkern; }
+
+    /// multiply every k-space array by k-space kernel k
+    void kmul(const kvec_t& k) {
+        const auto& L = this->LK;
+        if(k.size() != L.size()) throw std::logic_error("Mismatched k-space kernel size");
+        auto it = v_k.begin();
+        if(L.interleaved) { for(auto x: k) for(int b = 0; b < L.howmany; ++b) *(it++) *= x; }
+        else for(int b = 0; b < L.howmany; ++b) for(auto x: k) *(it++) *= x;
+    }
+
+    /// convolve loaded batch with pre-calculated k-space kernel
+    void kconvolve(const kvec_t& kk) {
+        this->execute();
+        kmul(kk);
+        revPlan.execute();
+    }
+    /// convolve loaded batch with kernel from setKernel
+    void kconvolve() { kconvolve(kkern); }
+
+    /// load whole batch, in layout LX
+    template<typename V>
+    void load(const V& v) {
+        if(v.size() != this->M) throw std::logic_error("Mismatched batch convolution input");
+        std::copy(v.begin(), v.end(), v_x.begin());
+    }
+    /// load one (row-major) array into batch position b
+    template<typename V>
+    void load(size_t b, const V& v) {
+        const auto& L = this->LX;
+        if(b >= size_t(L.howmany) || v.size() != L.size()) throw std::logic_error("Mismatched batch convolution input");
+        size_t i = 0;
+        for(auto x: v) v_x[L.index(b, i++)] = x;
+    }
+
+    /// fetch whole batch, in layout LX
+    template<typename V>
+    void fetch(V& v) const { v.assign(v_x.begin(), v_x.end()); }
+    /// fetch array b of batch
+    template<typename V>
+    void fetch(size_t b, V& v) const {
+        const auto& L = this->LX;
+        v.resize(L.size());
+        for(size_t i = 0; i < v.size(); ++i) v[i] = v_x[L.index(b, i)];
+    }
+
+    /// convolve whole batch v (layout LX) in place, using kernel from setKernel
+    template<typename V>
+    void convolve(V& v) {
+        load(v);
+        kconvolve();
+        fetch(v);
+    }
+
+protected:
+    xvec_t k_x;     ///< kernel x-space workspace
+    kvec_t kkern;   ///< k-space kernel
+};
+
+template<typename T = double>
+using BatchConvolveR2C = BatchConvolvePlan<BatchR2CPlan<T>>;
+
+template<typename T = double>
+using BatchConvolve_DCT_I = BatchConvolvePlan<BatchDCT_I_Plan<T>>;
+
+//------------------------------
+//----- Convolver factories -----
+//------------------------------
+
+/// Convolver "factory" for batches, caching k-space kernels per array shape and convolvers per layout (per thread)
+template<class _C>
+class BatchConvolverFactory {
+public:
+    typedef _C Convolver_t;
+
+    /// Polymorphic Destructor
+    virtual ~BatchConvolverFactory() { }
+
+    /// Convolve batch v, in layout L, in place
+    template<typename Vec_t>
+    void convolve(Vec_t& v, const FFTWBatchLayout& L) {
+        if(v.size() != L.total()) throw std::logic_error("Mismatched batch convolution input");
+        auto& C = getConvolver(L, nthreads);
+        C.load(v);
+        C.kconvolve(prepareKernel(C));
+        C.fetch(v);
+    }
+
+    /// Convolve each contiguous length-m row of v in place
+    template<typename Vec_t>
+    void convolveRows(Vec_t& v, size_t m) {
+        if(!m || v.size() % m) throw std::logic_error("Batch convolution input not a whole number of rows");
+        convolve(v, FFTWBatchLayout({int(m)}, v.size()/m));
+    }
+
+    /// Generate convolver for layout and planner threads
+    static Convolver_t& getConvolver(const FFTWBatchLayout& L, int nt) {
+        static thread_local map<std::pair<FFTWBatchLayout, int>, Convolver_t*> cs;
+        auto k = std::make_pair(L, nt);
+        auto it = cs.find(k);
+        if(it != cs.end()) return *it->second;
+        return *(cs[k] = new Convolver_t(L, nt));
+    }
+
+    int nthreads = 0;   ///< FFTW planner threads for batch transforms (0 for fftw_batch_threads())
+
+protected:
+    /// calculate real-space convolution kernel (row-major) for array dimensions
+    virtual vector<typename Convolver_t::xspace_t> calcKernel(const vector<int>& dims) = 0;
+
+    /// calculate/cache k-space kernel for convolver's array shape
+    const typename Convolver_t::kvec_t& prepareKernel(Convolver_t& C) {
+        auto it = kdata.find(C.LX.dims);
+        if(it != kdata.end()) return it->second;
+        C.setKernel(calcKernel(C.LX.dims));
+        return kdata[C.LX.dims] = C.getKkern();
+    }
+
+    map<vector<int>, typename Convolver_t::kvec_t> kdata;   ///< cached k-space kernels for each array shape
+};
+
+/// Isotropic Gaussian convolutions of batched multi-dimensional arrays, symmetrizing boundary conditions
+template<typename T = double>
+class GaussBatchConvolverFactory: public BatchConvolverFactory<BatchConvolve_DCT_I<T>> {
+public:
+    /// Constructor
+    explicit GaussBatchConvolverFactory(double _r): r(_r) { }
+    const double r;     ///< convolution radius in samples
+
+protected:
+    /// calculate separable convolution kernel for given dimensions
+    vector<T> calcKernel(const vector<int>& dims) override {
+        vector<T> v{1};
+        for(auto i: dims) {
+            // normalized 1D half-kernel, as in GaussConvolverFactory
+            vector<T> g(i);
+            double nrm = 0;
+            for(int n = 0; n < i; ++n) {
+                g[n] = exp(-n*n/(2*r*r));
+                nrm += (n? 2 : 1)*g[n];
+            }
+            divide(g, nrm);
+
+            vector<T> vv;
+            vv.reserve(v.size() * i);
+            for(auto x: v) for(auto y: g) vv.push_back(x*y);
+            std::swap(v, vv);
+        }
+        return v;
+    }
+};
+
+#endif
@@ -1,4 +1,16 @@
 /// \file FFTW_Convolver.cc
 
 #include "FFTW_Convolver.hh"
+#include "FFTW_Batch.hh"
+#include <algorithm>
+#include <cstdlib>
+
 std::mutex fftw_planner_mutex;
+
+int& fftw_batch_threads() {
+    static int n = [] {
+        auto s = getenv("FFTW_NTHREADS");
+        return s? std::max(1, atoi(s)) : 1;
+    }();
+    return n;
+}
@@ -91,10 +91,12 @@ DST-IV [RODFT11] N = 4*n, odd around j=-0.5 and even around j=n-0.5
 #define FFTW_CONVOLVER_H
 
 #include "fftwx.hh"
+#include "FFTW_Wisdom.hh"
 #include "VectorUtils.hh"
 
 #include <cmath>
 #include <map>
+#include <tuple>
 using std::map;
 
 //-----------------
@@ -108,6 +110,8 @@ template<typename T>
 class TransformPlan: public fftwx<T> {
 public:
     typedef typename fftwx<T>::plan_t plan_t;
+    typedef typename fftwx<T>::real_t real_t;
+    typedef typename fftwx<T>::fcplx_t fcplx_t;
 
     /// Constructor
     TransformPlan(size_t m, size_t nl, size_t k):
@@ -116,18 +120,61 @@ public:
     /// Polymorphic Destructor
     virtual ~TransformPlan() { }
 
-    /// execute plan
-    void execute() { fftwx<T>::execute(p); }
+    /// execute plan on arrays it was made for
+    void execute() {
+        switch(kind) {
+            case C2C: fftwx<T>::execute_dft(p, (fcplx_t*)pin, (fcplx_t*)pout); break;
+            case R2C: fftwx<T>::execute_dft_r2c(p, (real_t*)pin, (fcplx_t*)pout); break;
+            case C2R: fftwx<T>::execute_dft_c2r(p, (fcplx_t*)pin, (real_t*)pout); break;
+            case R2R: fftwx<T>::execute_r2r(p, (real_t*)pin, (real_t*)pout); break;
+        }
+    }
 
-    plan_t p;           ///< plan
+    plan_t p;           ///< plan (shared between all same-shape plans in process)
 
     const size_t M;     ///< input array size
     const size_t Nlog;  ///< logical (normalization) size
     const size_t K;     ///< output array size
 
 protected:
+    /// transform kinds, for new-array execution
+    enum kind_t { C2C, R2C, C2R, R2R };
+
     /// convenience function for planner flags
     virtual int planner_flags() const { return FFTW_PATIENT | FFTW_DESTROY_INPUT; }
+
+    /// plan identity: kind, subtype, shape, flags, input and output alignment
+    typedef std::tuple<int, int, vector<int>, int, int, int> plan_key_t;
+    /// process-wide plans cache
+    static map<plan_key_t, plan_t>& sharedPlans() { static map<plan_key_t, plan_t> m; return m; }
+    /// lock for sharedPlans
+    static std::mutex& sharedPlansMut() { static std::mutex m; return m; }
+
+    /// use process-wide plan for kind k, subtype (sign or r2r kind) s, size n with arrays i -> o; created by mk() on first use
+    template<typename F>
+    void sharedPlan(kind_t k, int s, size_t n, void* i, void* o, F mk) { sharedPlan(k, s, vector<int>{int(n)}, i, o, mk); }
+
+    /// use process-wide plan identified by shape descriptor (1D: {n})
+    template<typename F>
+    void sharedPlan(kind_t k, int s, const vector<int>& shape, void* i, void* o, F mk) {
+        // new-array execution requires matching alignment, so alignment is part of the plan's identity
+        plan_key_t key(k, s, shape, planner_flags(), fftwx<T>::alignment_of(i), fftwx<T>::alignment_of(o));
+        kind = k;
+        pin = i;
+        pout = o;
+
+        std::lock_guard<std::mutex> l(sharedPlansMut());
+        auto& plans = sharedPlans();
+        auto it = plans.find(key);
+        if(it != plans.end()) { p = it->second; return; }
+        FFTWWisdom<T>::autoload();
+        plans.emplace(key, p = mk());
+        FFTWWisdom<T>::notePlan();
+    }
+
+    kind_t kind = C2C;      ///< transform kind
+    void* pin = nullptr;    ///< input array
+    void* pout = nullptr;   ///< output array
 };
 
 /// 1D (complex-to-complex) Discrete Fourier Transform plan
@@ -144,8 +191,10 @@ protected:
 
     /// make plan
     void makePlan(bool fwd, xspace_t* v_x, kspace_t* v_k) {
-        if(fwd) this->p = this->plan_dft_1d(this->M, v_x, v_k, FFTW_FORWARD, this->planner_flags());
-        else    this->p = this->plan_dft_1d(this->M, v_k, v_x, FFTW_BACKWARD, this->planner_flags());
+        if(fwd) this->sharedPlan(this->C2C, FFTW_FORWARD, this->M, v_x, v_k,
+                                 [&] { return this->plan_dft_1d(this->M, v_x, v_k, FFTW_FORWARD, this->planner_flags()); });
+        else    this->sharedPlan(this->C2C, FFTW_BACKWARD, this->M, v_k, v_x,
+                                 [&] { return this->plan_dft_1d(this->M, v_k, v_x, FFTW_BACKWARD, this->planner_flags()); });
     }
 };
 
@@ -163,8 +212,8 @@ public:
 
     /// make plan
     void makePlan(bool fwd, xspace_t* v_x, kspace_t* v_k) {
-        if(fwd) this->p = this->plan_dft_r2c_1d(this->M, v_x, v_k, this->planner_flags());
-        else    this->p = this->plan_dft_c2r_1d(this->M, v_k, v_x, this->planner_flags());
+        if(fwd) this->sharedPlan(this->R2C, 0, this->M, v_x, v_k, [&] { return this->plan_dft_r2c_1d(this->M, v_x, v_k, this->planner_flags()); });
+        else    this->sharedPlan(this->C2R, 0, this->M, v_k, v_x, [&] { return this->plan_dft_c2r_1d(this->M, v_k, v_x, this->planner_flags()); });
     }
 };
 
@@ -179,6 +228,12 @@ public:
 
     /// Constructor
     R2RPlan(size_t m, size_t nl): TransformPlan<T>(m, nl, m) { }
+
+protected:
+    /// make (shared) r2r plan of size n and FFTW kind rk
+    void makeR2R(size_t n, T* i, T* o, fftw_r2r_kind rk) {
+        this->sharedPlan(this->R2R, rk, n, i, o, [&] { return this->plan_r2r_1d(n, i, o, rk, this->planner_flags()); });
+    }
 };
 
 //-----------------
@@ -194,8 +249,8 @@ public:
 
     /// make plan
     void makePlan(bool fwd, T* v_x, T* v_k) {
-        if(fwd) this->p = this->plan_r2r_1d(this->M, v_x, v_k, FFTW_REDFT00, this->planner_flags());
-        else    this->p = this->plan_r2r_1d(this->K, v_k, v_x, FFTW_REDFT00, this->planner_flags());
+        if(fwd) this->makeR2R(this->M, v_x, v_k, FFTW_REDFT00);
+        else    this->makeR2R(this->K, v_k, v_x, FFTW_REDFT00);
     }
 };
 
@@ -208,8 +263,8 @@ public:
 
     /// make plan
     void makePlan(bool fwd, T* v_x, T* v_k) {
-        if(fwd) this->p = this->plan_r2r_1d(this->M, v_x, v_k, FFTW_REDFT10, this->planner_flags());
-        else    this->p = this->plan_r2r_1d(this->K, v_k, v_x, FFTW_REDFT01, this->planner_flags());
+        if(fwd) this->makeR2R(this->M, v_x, v_k, FFTW_REDFT10);
+        else    this->makeR2R(this->K, v_k, v_x, FFTW_REDFT01);
     }
 };
 
@@ -222,8 +277,8 @@ public:
 
     /// make plan
     void makePlan(bool fwd, T* v_x, T* v_k) {
-        if(fwd) this->p = this->plan_r2r_1d(this->M, v_x, v_k, FFTW_REDFT01, this->planner_flags());
-        else    this->p = this->plan_r2r_1d(this->K, v_k, v_x, FFTW_REDFT10, this->planner_flags());
+        if(fwd) this->makeR2R(this->M, v_x, v_k, FFTW_REDFT01);
+        else    this->makeR2R(this->K, v_k, v_x, FFTW_REDFT10);
     }
 };
 
@@ -237,8 +292,8 @@ public:
 
     /// make plan
     void makePlan(bool fwd, T* v_x, T* v_k) {
-        if(fwd) this->p = this->plan_r2r_1d(this->M, v_x, v_k, FFTW_REDFT11, this->planner_flags());
-        else    this->p = this->plan_r2r_1d(this->K, v_k, v_x, FFTW_REDFT11, this->planner_flags());
+        if(fwd) this->makeR2R(this->M, v_x, v_k, FFTW_REDFT11);
+        else    this->makeR2R(this->K, v_k, v_x, FFTW_REDFT11);
     }
 };
 
@@ -251,8 +306,8 @@ public:
 
     /// make plan
     void makePlan(bool fwd, T* v_x, T* v_k) {
-        if(fwd) this->p = this->plan_r2r_1d(this->M, v_x, v_k, FFTW_RODFT00, this->planner_flags());
-        else    this->p = this->plan_r2r_1d(this->K, v_k, v_x, FFTW_RODFT00, this->planner_flags());
+        if(fwd) this->makeR2R(this->M, v_x, v_k, FFTW_RODFT00);
+        else    this->makeR2R(this->K, v_k, v_x, FFTW_RODFT00);
     }
 };
 
@@ -265,8 +320,8 @@ public:
 
     /// make plan
     void makePlan(bool fwd, T* v_x, T* v_k) {
-        if(fwd) this->p = this->plan_r2r_1d(this->M, v_x, v_k, FFTW_RODFT10, this->planner_flags());
-        else    this->p = this->plan_r2r_1d(this->K, v_k, v_x, FFTW_RODFT01, this->planner_flags());
+        if(fwd) this->makeR2R(this->M, v_x, v_k, FFTW_RODFT10);
+        else    this->makeR2R(this->K, v_k, v_x, FFTW_RODFT01);
     }
 };
 
@@ -279,8 +334,8 @@ public:
 
     /// make plan
     void makePlan(bool fwd, T* v_x, T* v_k) {
-        if(fwd) this->p = this->plan_r2r_1d(this->M, v_x, v_k, FFTW_RODFT01, this->planner_flags());
-        else    this->p = this->plan_r2r_1d(this->K, v_k, v_x, FFTW_RODFT10, this->planner_flags());
+        if(fwd) this->makeR2R(this->M, v_x, v_k, FFTW_RODFT01);
+        else    this->makeR2R(this->K, v_k, v_x, FFTW_RODFT10);
     }
 };
 
@@ -293,8 +348,8 @@ public:
 
     /// make plan
     void makePlan(bool fwd, T* v_x, T* v_k) {
-        if(fwd) this->p = this->plan_r2r_1d(this->M, v_x, v_k, FFTW_RODFT11, this->planner_flags());
-        else    this->p = this->plan_r2r_1d(this->K, v_k, v_x, FFTW_RODFT11, this->planner_flags());
+        if(fwd) this->makeR2R(this->M, v_x, v_k, FFTW_RODFT11);
+        else    this->makeR2R(this->K, v_k, v_x, FFTW_RODFT11);
     }
 };
 
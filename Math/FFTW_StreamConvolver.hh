@@ -0,0 +1,118 @@
+/// \file FFTW_StreamConvolver.hh Overlap-save FIR convolution of unbounded sample streams
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef FFTW_STREAMCONVOLVER_HH
+#define FFTW_STREAMCONVOLVER_HH
+
+#include "FFTW_Convolver.hh"
+#include <algorithm>
+#include <stdexcept>
+
+/// Overlap-save convolution of a sample stream with fixed kernel, in fixed memory
+/// output[i] = sum_j h[j] input[i + delay - j], one output per input (zero input outside stream)
+template<typename T = double>
+class StreamConvolver {
+public:
+    /// Constructor, with kernel h, output delay (e.g. kernel center for symmetric smoothing), FFT block size (0 for automatic)
+    explicit StreamConvolver(const vector<T>& h, size_t _delay = 0, size_t nfft = 0):
+    L(h.size()), N(blockSize(L, nfft)), delay(_delay), W(N), kk(W.K), buf(N) {
+        if(!L) throw std::logic_error("Empty stream convolution kernel");
+
+        // pre-normalized k-space kernel
+        std::fill(W.v_x.begin(), W.v_x.end(), 0);
+        std::copy(h.begin(), h.end(), W.v_x.begin());
+        W.execute();
+        std::copy(W.v_k.begin(), W.v_k.end(), kk.begin());
+        divide(kk, W.Nlog);
+
+        reset();
+    }
+
+    /// normalized, symmetric Gaussian kernel of radius r samples out to nsigma (use with delay = (size - 1)/2)
+    static vector<T> gaussKernel(double r, double nsigma = 5) {
+        int c = std::max(1., ceil(nsigma*r));
+        vector<T> h(2*c + 1);
+        double nrm = 0;
+        for(int i = -c; i <= c; ++i) nrm += (h[i + c] = exp(-i*i/(2*r*r)));
+        divide(h, nrm);
+        return h;
+    }
+
+    /// FFT block size for kernel length l (nfft = 0 for automatic)
+    static size_t blockSize(size_t l, size_t nfft = 0) {
+        if(nfft) {
+            if(nfft < 2*l) throw std::logic_error("Stream convolution block size must be at least twice kernel length");
+            return nfft;
+        }
+        size_t n = 64;
+        while(n < 4*l) n *= 2;
+        return n;
+    }
+
+    /// restart stream
+    void reset() {
+        std::fill(buf.begin(), buf.end(), 0);
+        nfill = L - 1;
+        toSkip = delay;
+        nin = nout = 0;
+    }
+
+    /// push n input samples; append completed outputs to out
+    void push(const T* x, size_t n, vector<T>& out) {
+        nin += n;
+        while(n) {
+            auto m = std::min(n, N - nfill);
+            std::copy(x, x + m, buf.begin() + nfill);
+            nfill += m;
+            x += m;
+            n -= m;
+            if(nfill == N) process(out);
+        }
+    }
+
+    /// append remaining outputs for end of stream to out, and restart
+    void finish(vector<T>& out) {
+        while(nout < nin) {
+            std::fill(buf.begin() + nfill, buf.end(), 0);
+            nfill = N;
+            process(out, nin - nout);
+        }
+        reset();
+    }
+
+    const size_t L;         ///< kernel length
+    const size_t N;         ///< FFT block size
+    const size_t delay;     ///< output delay
+
+    /// number of new samples consumed per block
+    size_t step() const { return N - (L - 1); }
+
+protected:
+    /// transform full input block; append up to nmax valid outputs; keep overlap history
+    void process(vector<T>& out, size_t nmax = size_t(-1)) {
+        std::copy(buf.begin(), buf.end(), W.v_x.begin());
+        W.execute();
+        auto it = W.v_k.begin();
+        for(auto& x: kk) *(it++) *= x;
+        W.p_rev.execute();
+
+        auto i0 = L - 1 + std::min(toSkip, step());
+        toSkip -= i0 - (L - 1);
+        auto n = std::min(N - i0, nmax);
+        out.insert(out.end(), W.v_x.begin() + i0, W.v_x.begin() + i0 + n);
+        nout += n;
+
+        std::copy(buf.end() - (L - 1), buf.end(), buf.begin());
+        nfill = L - 1;
+    }
+
+    IFFTWorkspace<R2CPlan<T>> W;    ///< transform workspace (FFTW-aligned)
+    typename R2CPlan<T>::kvec_t kk; ///< k-space kernel
+    fftw_real_vec<T> buf;           ///< input block: L - 1 history + step() new samples
+    size_t nfill;                   ///< filled samples in buf
+    size_t toSkip;                  ///< remaining delayed outputs to discard
+    size_t nin;                     ///< samples input since reset
+    size_t nout;                    ///< samples output since reset
+};
+
+#endif
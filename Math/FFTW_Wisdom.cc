@@ -0,0 +1,55 @@
+/// \file FFTW_Wisdom.cc
+
+#include "FFTW_Wisdom.hh"
+#include "PathUtils.hh"
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+string fftw_wisdom_key() {
+    char h[256] = "localhost";
+    gethostname(h, sizeof(h) - 1);
+    string host = h;
+    host = host.substr(0, host.find('.'));
+
+    // CPU identification: model name and feature flags
+    string cpu;
+    std::ifstream f("/proc/cpuinfo");
+    string l;
+    while(std::getline(f, l)) {
+        if(!l.compare(0, 10, "model name") || !l.compare(0, 5, "flags")) cpu += l;
+        if(cpu.size() && l.empty()) break; // first processor only
+    }
+    uint64_t x = 14695981039346656037ULL; // FNV-1a, stable between builds
+    for(auto c: cpu) x = (x ^ (unsigned char)c) * 1099511628211ULL;
+    std::stringstream ss;
+    ss << host << "_" << std::hex << x;
+    return ss.str();
+}
+
+string fftw_wisdom_dir() {
+    auto d = getenv("FFTW_WISDOM_DIR");
+    return d? d : "";
+}
+
+bool fftw_wisdom_read(const string& fname, string& s) {
+    std::ifstream f(fname);
+    if(!f) return false;
+    std::stringstream ss;
+    ss << f.rdbuf();
+    s = ss.str();
+    return true;
+}
+
+bool fftw_wisdom_write(const string& fname, const string& s) {
+    if(s.empty()) return false;
+    makePath(fname, true);
+    auto tmp = fname + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream f(tmp);
+        if(!(f << s)) return false;
+    }
+    return !rename(tmp.c_str(), fname.c_str());
+}
@@ -0,0 +1,73 @@
+/// \file FFTW_Wisdom.hh Persistent FFTW planner wisdom, keyed by host and CPU
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef FFTW_WISDOM_HH
+#define FFTW_WISDOM_HH
+
+#include "fftwx.hh"
+#include <atomic>
+#include <cstdlib>
+#include <string>
+using std::string;
+
+/// host and CPU model identifier for wisdom file names
+string fftw_wisdom_key();
+/// wisdom directory from $FFTW_WISDOM_DIR; "" if unset
+string fftw_wisdom_dir();
+/// read file contents to string; false if unreadable
+bool fftw_wisdom_read(const string& fname, string& s);
+/// write string to file, replacing atomically; false on failure
+bool fftw_wisdom_write(const string& fname, const string& s);
+
+/// Wisdom import/export and automatic persistence for FFTW precision T
+template<typename T>
+class FFTWWisdom {
+public:
+    /// accumulated wisdom as string
+    static string exportString() {
+        auto w = fftwx<T>::export_wisdom_to_string();
+        string s = w? w : "";
+        free(w);
+        return s;
+    }
+    /// import (merge) wisdom from string; false if invalid
+    static bool importString(const string& s) { return s.size() && fftwx<T>::import_wisdom_from_string(s.c_str()); }
+
+    /// wisdom file in directory (default: persistence directory) for this host, CPU, and precision
+    static string defaultFile(const string& d = "") {
+        return (d.size()? d : dir()) + "/" + fftw_wisdom_key() + "." + fftwx<T>::prefix() + ".wisdom";
+    }
+    /// import wisdom from file; false if missing or invalid
+    static bool load(const string& fname) {
+        string s;
+        return fftw_wisdom_read(fname, s) && importString(s);
+    }
+    /// export accumulated wisdom to file, merging with (concurrently-updated) existing file contents
+    static bool save(const string& fname) {
+        load(fname);
+        return fftw_wisdom_write(fname, exportString());
+    }
+
+    /// enable automatic persistence to directory (call before first plan; default from $FFTW_WISDOM_DIR)
+    static void enable(const string& d) { dir() = d; }
+    /// once per process: import default wisdom file, and save at exit if any new plans were made
+    static void autoload() {
+        static std::once_flag f;
+        std::call_once(f, [] {
+            if(dir().empty()) dir() = fftw_wisdom_dir();
+            if(dir().empty()) return;
+            load(defaultFile());
+            atexit([] { if(nPlanned()) save(defaultFile()); });
+        });
+    }
+    /// note newly-computed plan
+    static void notePlan() { ++nPlanned(); }
+
+protected:
+    /// persistence directory
+    static string& dir() { static string d; return d; }
+    /// number of plans computed in this process
+    static std::atomic<size_t>& nPlanned() { static std::atomic<size_t> n{0}; return n; }
+};
+
+#endif
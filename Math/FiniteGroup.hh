@@ -61,6 +61,10 @@
 
 #include "RangeIt.hh"
 #include "Renumerate.hh"
+#include "WorkStealingPool.hh"
+#include <functional>
+#include <iterator>
+#include <memory>
 #include <utility>
 using std::pair;
 #include <iostream>
@@ -131,6 +135,68 @@ map<typename G::elem_t, vector<int>> spanM(const V& gs, const G& GG = {}) {
     return M;
 }
 
+/// Finite (sub)-semigroup generated by elements of <Semigroup> G, as sorted list of elements
+/**
+    Breadth-first closure: each round multiplies the newly-found frontier by all generators in blocks of ``chunk'' elements,
+    each block sorted and deduplicated against elements already found, then blocks and found elements are merged.
+    Blocks (and pairwise merges) run on nthreads (0 for hardware) pool threads if nthreads != 1.
+*/
+template<class G, class V = vector<typename G::elem_t>>
+vector<typename G::elem_t> spanV(const V& gs, const G& GG = {}, int nthreads = 1, size_t chunk = 4096) {
+    typedef typename G::elem_t elem_t;
+
+    vector<elem_t> vg;  // generators
+    for(auto& e: gs) vg.push_back(e);
+    vector<elem_t> all = vg; // all found elements, sorted
+    std::sort(all.begin(), all.end());
+    all.erase(std::unique(all.begin(), all.end()), all.end());
+    vector<elem_t> F = all; // "newly found" frontier, sorted
+
+    std::unique_ptr<WorkStealingPool> P;
+    // run f(0...n-1), serially or on pool
+    auto run = [&](size_t n, const std::function<void(size_t)>& f) {
+        if(nthreads == 1 || n < 2) { for(size_t b = 0; b < n; ++b) f(b); return; }
+        if(!P) P.reset(new WorkStealingPool(std::max(nthreads, 0)));
+        for(size_t b = 0; b < n; ++b) P->submit([&f, b] { f(b); });
+        P->wait_idle();
+    };
+
+    while(F.size()) {
+        // unique, previously-unknown products for each frontier block
+        const size_t nb = (F.size() + chunk - 1)/chunk;
+        vector<vector<elem_t>> vv(nb);
+        run(nb, [&](size_t b) {
+            auto& v = vv[b];
+            const auto i1 = std::min(F.size(), (b + 1)*chunk);
+            v.reserve((i1 - b*chunk)*vg.size());
+            for(size_t i = b*chunk; i < i1; ++i) for(auto& g: vg) v.push_back(GG.apply(g, F[i]));
+            std::sort(v.begin(), v.end());
+            v.erase(std::unique(v.begin(), v.end()), v.end());
+            v.erase(std::remove_if(v.begin(), v.end(), [&all](const elem_t& e) { return std::binary_search(all.begin(), all.end(), e); }), v.end());
+        });
+
+        // pairwise merge of blocks
+        for(size_t s = 1; s < nb; s *= 2) {
+            run((nb + s - 1)/(2*s), [&](size_t k) {
+                auto& a = vv[2*s*k];
+                auto& b = vv[2*s*k + s];
+                vector<elem_t> c;
+                c.reserve(a.size() + b.size());
+                std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(c));
+                a.swap(c);
+                vector<elem_t>().swap(b);
+            });
+        }
+
+        F.swap(vv[0]);
+        vector<elem_t> a;
+        a.reserve(all.size() + F.size());
+        std::merge(all.begin(), all.end(), F.begin(), F.end(), std::back_inserter(a));
+        all.swap(a);
+    }
+    return all;
+}
+
 /// Construct <Enumerated Semigroup> from iterable list of finite-order generators in <Semigroup> G
 template<class SG_t>
 class GeneratorsSemigroup: public SG_t {
@@ -167,12 +233,9 @@ public:
 
     /// Span of generators in G
     template<class V>
-    static vector<elem_t> span(const V& gs, const SG_t& G = {}) {
-        auto M = spanM<SG_t>(gs, G);
-        vector<elem_t> v;
-        for(auto& kv: M) v.push_back(kv.first);
-        return v;
-    }
+    static vector<elem_t> span(const V& gs, const SG_t& G = {}) { return spanV<SG_t>(gs, G, span_nthreads); }
+
+    static int span_nthreads;       ///< threads for generators span (0 for hardware)
 
     /// apply renumeration
     GeneratorsSemigroup& renumerate(const renumeration_t<enum_t>& m) {
@@ -197,6 +260,9 @@ protected:
 
 };
 
+template<class SG_t>
+int GeneratorsSemigroup<SG_t>::span_nthreads = 0;
+
 /// Cartesian direct product group (G1,G2)
 template<class G1, class G2>
 class ProductGroup {
@@ -0,0 +1,230 @@
+/// \file FlatKDTree.cc
+
+#include "FlatKDTree.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+
+FlatKDTree::FlatKDTree(int N): N_DIM(N) {
+    if(N < 1 || N > 127) throw std::logic_error("Invalid FlatKDTree dimensions");
+}
+
+void FlatKDTree::build(const vector<float*>& ps) {
+    vector<vector<float>> xa(N_DIM, vector<float>(ps.size()));
+    for(size_t i = 0; i < ps.size(); ++i) for(int a = 0; a < N_DIM; ++a) xa[a][i] = ps[i][a];
+    vector<const float*> x;
+    for(auto& v: xa) x.push_back(v.data());
+    build(x, ps.size());
+}
+
+void FlatKDTree::build(const vector<const float*>& x, size_t npts) {
+    if(int(x.size()) != N_DIM) throw std::logic_error("Mismatched FlatKDTree input dimensions");
+    if(npts >= UINT32_MAX) throw std::runtime_error("Too many points for FlatKDTree");
+
+    // depth along largest (high side) branch of median-rank splits
+    D = 0;
+    for(size_t n = npts; n >= min_divide_points && n >= 3; n -= n/2) ++D;
+    if(D > 30) throw std::runtime_error("FlatKDTree too deep; increase min_divide_points");
+    axes.assign((size_t(2) << D) - 1, -2);
+    splits.assign(axes.size(), 0);
+
+    X.assign(N_DIM, vector<float>());
+    xmin.assign(N_DIM, 0);
+    xmax.assign(N_DIM, 0);
+    for(int a = 0; a < N_DIM; ++a) {
+        X[a].assign(x[a], x[a] + npts);
+        if(!npts) continue;
+        auto r = std::minmax_element(X[a].begin(), X[a].end());
+        xmin[a] = *r.first;
+        xmax[a] = *r.second;
+    }
+    perm.resize(npts);
+    std::iota(perm.begin(), perm.end(), 0);
+
+    std::unique_ptr<WorkStealingPool> P;
+    if(nthreads != 1 && npts >= 2*par_min) P.reset(new WorkStealingPool(std::max(nthreads, 0)));
+    buildNode(0, 0, npts, P.get());
+    if(P) P->wait_idle();
+}
+
+void FlatKDTree::buildNode(uint32_t i, size_t i0, size_t i1, WorkStealingPool* P) {
+    axes[i] = -1;
+    const auto n = i1 - i0;
+    if(n < min_divide_points || n < 3) return;
+    const size_t nc = n/2;  // low side points
+
+    // choose axis with median furthest from mid-range, relative to range (as KDBuilder::buildKD)
+    vector<float> s(n);
+    double rmax = 0;
+    int amin = 0;
+    for(int a = 0; a < N_DIM; ++a) {
+        std::copy(X[a].begin() + i0, X[a].begin() + i1, s.begin());
+        auto r = std::minmax_element(s.begin(), s.end());
+        float x0 = *r.first;
+        float x2 = *r.second;
+        std::nth_element(s.begin(), s.begin() + nc, s.end());
+        float x1 = s[nc];
+        double rr = fabs(x1 - 0.5*(x0 + x2))/(x2 - x0);
+        if(rr > rmax) { rmax = rr; amin = a; }
+    }
+
+    // rank partition along chosen axis, on contiguous (value, index) pairs
+    const float* xa = X[amin].data() + i0;
+    vector<std::pair<float, uint32_t>> q(n);
+    for(size_t k = 0; k < n; ++k) q[k] = {xa[k], k};
+    std::nth_element(q.begin(), q.begin() + nc, q.end(),
+                     [](const std::pair<float, uint32_t>& u, const std::pair<float, uint32_t>& v) { return u.first < v.first; });
+    float xlo = q[0].first;
+    for(size_t k = 1; k < nc; ++k) xlo = std::max(xlo, q[k].first);
+    axes[i] = amin;
+    splits[i] = 0.5*(xlo + q[nc].first);
+
+    // reorder points (gather per axis)
+    for(int a = 0; a < N_DIM; ++a) {
+        auto xx = X[a].data() + i0;
+        for(size_t k = 0; k < n; ++k) s[k] = xx[q[k].second];
+        std::copy(s.begin(), s.end(), xx);
+    }
+    auto pp = perm.data() + i0;
+    vector<uint32_t> p(n);
+    for(size_t k = 0; k < n; ++k) p[k] = pp[q[k].second];
+    std::copy(p.begin(), p.end(), pp);
+
+    // free scratch before recursing
+    vector<float>().swap(s);
+    vector<std::pair<float, uint32_t>>().swap(q);
+    vector<uint32_t>().swap(p);
+
+    const auto ic = i0 + nc;
+    if(P && nc >= par_min) P->submit([this, i, i0, ic, P] { buildNode(lo(i), i0, ic, P); });
+    else buildNode(lo(i), i0, ic, P);
+    buildNode(hi(i), ic, i1, P);
+}
+
+size_t FlatKDTree::nLeaves() const { return std::count(axes.begin(), axes.end(), -1); }
+
+void FlatKDTree::range(uint32_t i, size_t& i0, size_t& i1) const {
+    i0 = 0;
+    i1 = nPts();
+    // bits below leading 1 of i+1 are the path from the top node (0 = low, 1 = high)
+    const uint32_t p = i + 1;
+    int d = 0;
+    while(p >> (d + 1)) ++d;
+    for(int b = d - 1; b >= 0; --b) {
+        auto c = i0 + (i1 - i0)/2;
+        if((p >> b) & 1) i0 = c;
+        else i1 = c;
+    }
+}
+
+uint32_t FlatKDTree::locate(const float* x) const {
+    uint32_t i = 0;
+    while(axes[i] >= 0) i = 2*i + 1 + (x[axes[i]] >= splits[i]);
+    return i;
+}
+
+void FlatKDTree::locate(const float* xs, size_t n, uint32_t* leaf, int nt) const {
+    if(nt == 1 || n <= batch_chunk) {
+        for(size_t j = 0; j < n; ++j) leaf[j] = locate(xs + j*N_DIM);
+        return;
+    }
+
+    WorkStealingPool P(std::max(nt, 0));
+    for(size_t j0 = 0; j0 < n; j0 += batch_chunk) {
+        auto j1 = std::min(n, j0 + batch_chunk);
+        P.submit([this, xs, leaf, j0, j1] { for(size_t j = j0; j < j1; ++j) leaf[j] = locate(xs + j*N_DIM); });
+    }
+    P.wait_idle();
+}
+
+size_t FlatKDTree::rangeCount(uint32_t i, size_t i0, size_t i1, vector<float>& blo, vector<float>& bhi, const float* qlo, const float* qhi) const {
+    bool inside = true;
+    for(int a = 0; a < N_DIM; ++a) {
+        if(qhi[a] <= blo[a] || qlo[a] >= bhi[a]) return 0;
+        inside &= qlo[a] <= blo[a] && bhi[a] <= qhi[a];
+    }
+    if(inside) return i1 - i0;
+
+    if(axes[i] < 0) {
+        // leaf scan: flag points axis by axis
+        const auto n = i1 - i0;
+        vector<uint8_t> in(n, 1);
+        for(int a = 0; a < N_DIM; ++a) {
+            const float* __restrict__ xa = X[a].data() + i0;
+            const float l = qlo[a];
+            const float h = qhi[a];
+            for(size_t k = 0; k < n; ++k) in[k] &= (l <= xa[k]) & (xa[k] < h);
+        }
+        return std::accumulate(in.begin(), in.end(), size_t(0));
+    }
+
+    // low side holds points <= split; high side points >= split
+    const int a = axes[i];
+    const float s = splits[i];
+    const auto ic = i0 + (i1 - i0)/2;
+    size_t c = 0;
+
+    auto h0 = bhi[a];
+    bhi[a] = std::min(h0, std::nextafter(s, INFINITY));
+    c += rangeCount(lo(i), i0, ic, blo, bhi, qlo, qhi);
+    bhi[a] = h0;
+
+    auto l0 = blo[a];
+    blo[a] = std::max(l0, s);
+    c += rangeCount(hi(i), ic, i1, blo, bhi, qlo, qhi);
+    blo[a] = l0;
+
+    return c;
+}
+
+size_t FlatKDTree::rangeCount(const float* lo, const float* hi) const {
+    if(!nPts()) return 0;
+    vector<float> blo(N_DIM, -INFINITY);
+    vector<float> bhi(N_DIM, INFINITY);
+    return rangeCount(0, 0, nPts(), blo, bhi, lo, hi);
+}
+
+void FlatKDTree::rangeCount(const float* lo, const float* hi, size_t n, size_t* c, int nt) const {
+    if(nt == 1 || n <= batch_chunk) {
+        for(size_t j = 0; j < n; ++j) c[j] = rangeCount(lo + j*N_DIM, hi + j*N_DIM);
+        return;
+    }
+
+    WorkStealingPool P(std::max(nt, 0));
+    for(size_t j0 = 0; j0 < n; j0 += batch_chunk) {
+        auto j1 = std::min(n, j0 + batch_chunk);
+        P.submit([this, lo, hi, c, j0, j1] { for(size_t j = j0; j < j1; ++j) c[j] = rangeCount(lo + j*N_DIM, hi + j*N_DIM); });
+    }
+    P.wait_idle();
+}
+
+BoxTreeNode* FlatKDTree::boundData(double xr, BoxTreeNode* T) const {
+    if(!T) T = new BoxTreeNode();
+    for(int a = 0; a < N_DIM; ++a) {
+        auto dr = xmax[a] - xmin[a];
+        T = T->bound(a, xmin[a] - xr*dr, xmax[a] + xr*dr);
+    }
+    return T;
+}
+
+BoxTreeNode* FlatKDTree::toBoxTree(uint32_t i, size_t i0, size_t i1, map<const BoxTreeNode*,double>& leafcounts, BoxTreeNode* T) const {
+    if(axes[i] < 0) {
+        leafcounts[T] = i1 - i0;
+        return T;
+    }
+    T = T->splitNode(axes[i], splits[i]);
+    auto ic = i0 + (i1 - i0)/2;
+    toBoxTree(lo(i), i0, ic, leafcounts, T->getLo());
+    toBoxTree(hi(i), ic, i1, leafcounts, T->getHi());
+    return T;
+}
+
+BoxTreeNode* FlatKDTree::toBoxTree(map<const BoxTreeNode*,double>& leafcounts, BoxTreeNode* T) const {
+    if(!T) T = new BoxTreeNode();
+    if(!T->isLeaf()) throw std::logic_error("FlatKDTree expands only into leaf BoxTreeNode");
+    if(axes.empty()) return T;
+    return toBoxTree(0, 0, nPts(), leafcounts, T);
+}
@@ -0,0 +1,95 @@
+/// \file FlatKDTree.hh Array-based adaptive-binning kd-tree (KDBuilder splitting rules), with parallel build and batched queries
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef FLATKDTREE_HH
+#define FLATKDTREE_HH
+
+#include "BoxTree.hh"
+#include <stdint.h>
+
+class WorkStealingPool;
+
+/// Adaptive-binning kd-tree with KDBuilder splitting rules (rank-median split on axis of most asymmetric median),
+/// stored as flat arrays in implicit heap order: children of node i are 2i+1 (low) and 2i+2 (high),
+/// and node point ranges are implied by the median-rank splits. Points are stored dimension-major (SoA) in tree order,
+/// so each node's points are contiguous along every axis. Points equal to a split value may lie on either side;
+/// locate() assigns them to the high side, while rangeCount() uses the stored coordinates.
+class FlatKDTree {
+public:
+    /// Constructor, for number of dimensions
+    explicit FlatKDTree(int N);
+
+    const int N_DIM;                        ///< number of dimensions
+    unsigned int min_divide_points = 20;    ///< minimum number of points to continue subdividing
+    int nthreads = 1;                       ///< build threads (0 for hardware)
+    size_t par_min = 1 << 16;               ///< minimum node points to split build into parallel tasks
+    size_t batch_chunk = 4096;              ///< queries per pool task in batched queries
+
+    /// build from dimension-major coordinate arrays x[a][0...npts-1]
+    void build(const vector<const float*>& x, size_t npts);
+    /// build from point-major coordinates ps[i][a], as for KDBuilder::initData
+    void build(const vector<float*>& ps);
+
+    /// number of points
+    size_t nPts() const { return perm.size(); }
+    /// number of node slots (including unused slots under shallower leaves)
+    size_t nNodes() const { return axes.size(); }
+    /// number of leaf nodes
+    size_t nLeaves() const;
+    /// tree depth (leaves at depth() or depth() - 1)
+    int depth() const { return D; }
+
+    /// whether node slot is in use
+    bool exists(uint32_t i) const { return i < axes.size() && axes[i] > -2; }
+    /// whether node is leaf
+    bool isLeaf(uint32_t i) const { return axes[i] < 0; }
+    /// split axis of inner node
+    int getAxis(uint32_t i) const { return axes[i]; }
+    /// split position of inner node (low side <= split <= high side)
+    float getSplit(uint32_t i) const { return splits[i]; }
+    /// low-side child
+    static uint32_t lo(uint32_t i) { return 2*i + 1; }
+    /// high-side child
+    static uint32_t hi(uint32_t i) { return 2*i + 2; }
+    /// tree-ordered point range [i0, i1) in node
+    void range(uint32_t i, size_t& i0, size_t& i1) const;
+    /// number of points in node
+    size_t count(uint32_t i) const { size_t i0, i1; range(i, i0, i1); return i1 - i0; }
+
+    /// tree-ordered coordinates along axis
+    const vector<float>& coords(int a) const { return X[a]; }
+    /// original point index for each tree-ordered point
+    const vector<uint32_t>& order() const { return perm; }
+
+    /// leaf node containing point x[N_DIM]
+    uint32_t locate(const float* x) const;
+    /// batched leaf nodes for n point-major points xs[n*N_DIM], optionally on nthreads (0 for hardware) pool threads
+    void locate(const float* xs, size_t n, uint32_t* leaf, int nthreads = 1) const;
+    /// number of points in half-open box lo <= x < hi
+    size_t rangeCount(const float* lo, const float* hi) const;
+    /// batched point counts c[n] in n boxes lo[n*N_DIM] <= x < hi[n*N_DIM], optionally on nthreads pool threads
+    void rangeCount(const float* lo, const float* hi, size_t n, size_t* c, int nthreads = 1) const;
+
+    /// set up bounding cuts from dataset range, as KDBuilder::boundData
+    BoxTreeNode* boundData(double xr = 0, BoxTreeNode* T = nullptr) const;
+    /// expand into BoxTreeNode splits of leaf T (new if nullptr), as from KDBuilder::buildKD; return top divided node, and counts by leaf
+    BoxTreeNode* toBoxTree(map<const BoxTreeNode*,double>& leafcounts, BoxTreeNode* T = nullptr) const;
+
+protected:
+    /// build node i over tree-ordered points [i0, i1), splitting into pool tasks if available
+    void buildNode(uint32_t i, size_t i0, size_t i1, WorkStealingPool* P);
+    /// count points of node i (range [i0, i1), bounding box blo <= x < bhi) in box qlo <= x < qhi
+    size_t rangeCount(uint32_t i, size_t i0, size_t i1, vector<float>& blo, vector<float>& bhi, const float* qlo, const float* qhi) const;
+    /// expand node i into BoxTreeNode T
+    BoxTreeNode* toBoxTree(uint32_t i, size_t i0, size_t i1, map<const BoxTreeNode*,double>& leafcounts, BoxTreeNode* T) const;
+
+    int D = 0;                  ///< tree depth
+    vector<int8_t> axes;        ///< split axis for each node; -1 for leaf, -2 for unused slot
+    vector<float> splits;       ///< split position for each node
+    vector<vector<float>> X;    ///< tree-ordered coordinates, by axis
+    vector<uint32_t> perm;      ///< original point index for each tree-ordered point
+    vector<float> xmin;         ///< data minimum on each axis
+    vector<float> xmax;         ///< data maximum on each axis
+};
+
+#endif
@@ -0,0 +1,130 @@
+/// \file GaussSumFit.cc
+
+#include "GaussSumFit.hh"
+#include <cmath>
+#include <stdexcept>
+
+bool cholesky_decomp(vector<double>& A, size_t n) {
+    for(size_t j = 0; j < n; ++j) {
+        double s = A[j*n + j];
+        for(size_t k = 0; k < j; ++k) s -= A[j*n + k]*A[j*n + k];
+        if(!(s > 0)) return false;
+        A[j*n + j] = sqrt(s);
+        for(size_t i = j + 1; i < n; ++i) {
+            double t = A[i*n + j];
+            for(size_t k = 0; k < j; ++k) t -= A[i*n + k]*A[j*n + k];
+            A[i*n + j] = t/A[j*n + j];
+        }
+    }
+    return true;
+}
+
+void cholesky_solve(const vector<double>& L, size_t n, vector<double>& b) {
+    for(size_t i = 0; i < n; ++i) {
+        for(size_t k = 0; k < i; ++k) b[i] -= L[i*n + k]*b[k];
+        b[i] /= L[i*n + i];
+    }
+    for(size_t i = n; i-- > 0;) {
+        for(size_t k = i + 1; k < n; ++k) b[i] -= L[k*n + i]*b[k];
+        b[i] /= L[i*n + i];
+    }
+}
+
+double GaussSumFit::eval(double x, const vector<double>& p) {
+    double s = 0;
+    for(size_t k = 0; k + 2 < p.size(); k += 3) {
+        double u = (x - p[k+1])/p[k+2];
+        s += p[k]*exp(-0.5*u*u);
+    }
+    return s;
+}
+
+double GaussSumFit::calc(const vector<double>& p, bool deriv) {
+    const size_t np = p.size();
+    vector<double> g(np);
+    if(deriv) {
+        JTJ.assign(np*np, 0);
+        JTr.assign(np, 0);
+    }
+
+    double c2 = 0;
+    for(size_t i = 0; i < npts; ++i) {
+        if(!(pe[i] > 0)) continue;
+        const double w = 1./pe[i];
+        double f = 0;
+        for(size_t k = 0; k + 2 < np; k += 3) {
+            const double is = 1./p[k+2];
+            const double d = px[i] - p[k+1];
+            const double u = d*is;
+            const double G = exp(-0.5*u*u);
+            f += p[k]*G;
+            g[k] = G*w;
+            g[k+1] = p[k]*G*u*is*w;
+            g[k+2] = p[k]*G*u*u*is*w;
+        }
+        const double r = (py[i] - f)*w;
+        c2 += r*r;
+        if(!deriv) continue;
+        for(size_t a = 0; a < np; ++a) {
+            JTr[a] += g[a]*r;
+            for(size_t b = 0; b <= a; ++b) JTJ[a*np + b] += g[a]*g[b];
+        }
+    }
+    if(deriv) for(size_t a = 0; a < np; ++a) for(size_t b = 0; b < a; ++b) JTJ[b*np + a] = JTJ[a*np + b];
+    return c2;
+}
+
+int GaussSumFit::fit(const vector<double>& x, const vector<double>& y, const vector<double>& e, vector<double>& p) {
+    if(x.size() != y.size() || x.size() != e.size()) throw std::logic_error("Mismatched GaussSumFit data sizes");
+    if(!p.size() || p.size() % 3) throw std::logic_error("GaussSumFit requires (height, center, sigma) parameter triples");
+    px = x.data();
+    py = y.data();
+    pe = e.data();
+    npts = x.size();
+    const size_t np = p.size();
+
+    ndf = -int(np);
+    for(auto ee: e) ndf += ee > 0;
+
+    double lambda = 1e-3;
+    chi2 = calc(p, true);
+    int status = 1;
+    vector<double> A, d, p2;
+    for(niter = 0; niter < maxIter; ++niter) {
+        // (J^T J + lambda diag(J^T J)) d = J^T r
+        A = JTJ;
+        for(size_t a = 0; a < np; ++a) A[a*np + a] *= 1 + lambda;
+        d = JTr;
+        if(!cholesky_decomp(A, np)) { lambda *= 10; if(lambda > 1e12) break; continue; }
+        cholesky_solve(A, np, d);
+
+        p2 = p;
+        for(size_t a = 0; a < np; ++a) p2[a] += d[a];
+        for(size_t k = 2; k < np; k += 3) p2[k] = fabs(p2[k]);
+        double c2 = calc(p2, false);
+
+        if(c2 <= chi2) {
+            bool conv = chi2 - c2 <= tol*(chi2 + 1e-30);
+            p.swap(p2);
+            chi2 = calc(p, true);
+            lambda = std::max(lambda*0.1, 1e-12);
+            if(conv) { status = 0; break; }
+        } else {
+            lambda *= 10;
+            if(lambda > 1e12) { status = 0; break; } // no further improvement possible
+        }
+    }
+
+    // uncertainties from inverse of J^T J
+    dp.assign(np, 0);
+    A = JTJ;
+    if(cholesky_decomp(A, np)) {
+        for(size_t a = 0; a < np; ++a) {
+            vector<double> u(np);
+            u[a] = 1;
+            cholesky_solve(A, np, u);
+            dp[a] = sqrt(u[a]);
+        }
+    } else status = status? status : 2;
+    return status;
+}
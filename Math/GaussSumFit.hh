@@ -0,0 +1,46 @@
+/// \file GaussSumFit.hh Analytic-gradient Levenberg-Marquardt least-squares fit of Gaussian peak sums to binned data
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef GAUSSSUMFIT_HH
+#define GAUSSSUMFIT_HH
+
+#include <vector>
+using std::vector;
+#include <stdlib.h> // for size_t
+
+/// Levenberg-Marquardt chi^2 fit of sum of Gaussians (height, center, sigma per peak) to points (x, y +- e)
+/// thread-safe (no shared state); points with e <= 0 are skipped, as for ROOT's default chi^2 fit of empty bins
+class GaussSumFit {
+public:
+    /// evaluate Gaussian sum with parameters p
+    static double eval(double x, const vector<double>& p);
+
+    /// fit from initial parameters p; return 0 on convergence
+    int fit(const vector<double>& x, const vector<double>& y, const vector<double>& e, vector<double>& p);
+
+    int maxIter = 200;          ///< maximum iterations
+    double tol = 1e-9;          ///< relative chi^2 change convergence criterion
+
+    vector<double> dp;          ///< parameter uncertainties after fit
+    double chi2 = 0;            ///< chi^2 after fit
+    int ndf = 0;                ///< number of degrees of freedom
+    int niter = 0;              ///< iterations used
+
+protected:
+    /// chi^2 and (optionally) J^T J, J^T r for parameters p
+    double calc(const vector<double>& p, bool deriv);
+
+    const double* px = nullptr;     ///< x data
+    const double* py = nullptr;     ///< y data
+    const double* pe = nullptr;     ///< y uncertainty
+    size_t npts = 0;                ///< number of points
+    vector<double> JTJ;             ///< J^T J normal matrix, row-major
+    vector<double> JTr;             ///< J^T r gradient
+};
+
+/// in-place Cholesky decomposition of symmetric positive-definite n x n row-major matrix; false if not positive-definite
+bool cholesky_decomp(vector<double>& A, size_t n);
+/// solve L L^T x = b in place, from cholesky_decomp
+void cholesky_solve(const vector<double>& L, size_t n, vector<double>& b);
+
+#endif
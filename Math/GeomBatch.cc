@@ -0,0 +1,143 @@
+/// \file GeomBatch.cc
+
+#include "GeomBatch.hh"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && !defined(__AVX512F__)
+#define GEOMBATCH_DISPATCH ///< runtime-selected AVX2/AVX-512 kernels
+#endif
+
+/// kernel bodies, compiled into generic and instruction-set-targeted wrappers
+#define GEOMBATCH_INLINE static inline __attribute__((always_inline))
+
+GEOMBATCH_INLINE void _rotate(const double* M, const double* __restrict__ x, const double* __restrict__ y, const double* __restrict__ z,
+                              double* __restrict__ rx, double* __restrict__ ry, double* __restrict__ rz, size_t n) {
+    const double m00 = M[0], m01 = M[1], m02 = M[2], m10 = M[3], m11 = M[4], m12 = M[5], m20 = M[6], m21 = M[7], m22 = M[8];
+    for(size_t i = 0; i < n; ++i) {
+        const double a = x[i], b = y[i], c = z[i];
+        rx[i] = m00*a + m01*b + m02*c;
+        ry[i] = m10*a + m11*b + m12*c;
+        rz[i] = m20*a + m21*b + m22*c;
+    }
+}
+
+GEOMBATCH_INLINE void _rotate_inplace(const double* M, double* __restrict__ x, double* __restrict__ y, double* __restrict__ z, size_t n) {
+    const double m00 = M[0], m01 = M[1], m02 = M[2], m10 = M[3], m11 = M[4], m12 = M[5], m20 = M[6], m21 = M[7], m22 = M[8];
+    for(size_t i = 0; i < n; ++i) {
+        const double a = x[i], b = y[i], c = z[i];
+        x[i] = m00*a + m01*b + m02*c;
+        y[i] = m10*a + m11*b + m12*c;
+        z[i] = m20*a + m21*b + m22*c;
+    }
+}
+
+GEOMBATCH_INLINE void _line_coords(const double* c, const double* vn, const double* __restrict__ x, const double* __restrict__ y, const double* __restrict__ z,
+                                   double* __restrict__ zz, double* __restrict__ r2, size_t n) {
+    for(size_t i = 0; i < n; ++i) {
+        const double dx = x[i] - c[0], dy = y[i] - c[1], dz = z[i] - c[2];
+        const double u = dx*vn[0] + dy*vn[1] + dz*vn[2];
+        zz[i] = u;
+        r2[i] = std::fabs(dx*dx + dy*dy + dz*dz - u*u);
+    }
+}
+
+GEOMBATCH_INLINE void _segment_distance2(const double* a, const double* b, const double* __restrict__ x, const double* __restrict__ y, const double* __restrict__ z,
+                                         double* __restrict__ d2, size_t n) {
+    const double Dx = b[0] - a[0], Dy = b[1] - a[1], Dz = b[2] - a[2];
+    const double L2 = Dx*Dx + Dy*Dy + Dz*Dz;
+    const double iL2 = L2? 1/L2 : 0;
+    for(size_t i = 0; i < n; ++i) {
+        const double wx = x[i] - a[0], wy = y[i] - a[1], wz = z[i] - a[2];
+        const double t = std::min(std::max((wx*Dx + wy*Dy + wz*Dz)*iL2, 0.), 1.);
+        const double ex = wx - t*Dx, ey = wy - t*Dy, ez = wz - t*Dz;
+        d2[i] = ex*ex + ey*ey + ez*ez;
+    }
+}
+
+GEOMBATCH_INLINE void _closest_approach(const double* p1, const double* d1,
+                                        const double* __restrict__ px, const double* __restrict__ py, const double* __restrict__ pz,
+                                        const double* __restrict__ dx, const double* __restrict__ dy, const double* __restrict__ dz,
+                                        double* __restrict__ c1, double* __restrict__ c2, double* __restrict__ d2min, size_t n) {
+    for(size_t i = 0; i < n; ++i) {
+        const double ux = px[i] - p1[0], uy = py[i] - p1[1], uz = pz[i] - p1[2];
+        const double a01 = ux*d1[0] + uy*d1[1] + uz*d1[2];
+        const double a12 = d1[0]*dx[i] + d1[1]*dy[i] + d1[2]*dz[i];
+        const double a02 = ux*dx[i] + uy*dy[i] + uz*dz[i];
+        const double dd = 1 - a12*a12;
+        const bool par = !(dd > 0); // parallel lines special case
+        const double idd = par? 0 : 1/dd;
+        const double k1 = par? a01 : (a01 - a12*a02)*idd;
+        const double k2 = (a12*a01 - a02)*idd;
+        c1[i] = k1;
+        c2[i] = k2;
+        if(d2min) {
+            const double ex = k1*d1[0] - k2*dx[i] - ux, ey = k1*d1[1] - k2*dy[i] - uy, ez = k1*d1[2] - k2*dz[i] - uz;
+            d2min[i] = ex*ex + ey*ey + ez*ez;
+        }
+    }
+}
+
+#ifdef GEOMBATCH_DISPATCH
+/// generate instruction-set-targeted wrapper K_ISA for kernel K
+#define GEOMBATCH_TARGET(K, ISA, TGT, PARAMS, ARGS) __attribute__((target(TGT))) static void K##_##ISA PARAMS { _##K ARGS; }
+/// AVX2 wrapper
+#define GEOMBATCH_AVX2(K, PARAMS, ARGS) GEOMBATCH_TARGET(K, avx2, "avx2,fma", PARAMS, ARGS)
+/// AVX-512 wrapper
+#define GEOMBATCH_AVX512(K, PARAMS, ARGS) GEOMBATCH_TARGET(K, avx512, "avx512f,avx512vl,fma", PARAMS, ARGS)
+
+// streaming kernels (few operations per loaded point) measured no faster at 512-bit width: AVX2 only
+GEOMBATCH_AVX2(rotate, (const double* M, const double* x, const double* y, const double* z, double* rx, double* ry, double* rz, size_t n),
+               (M, x, y, z, rx, ry, rz, n))
+GEOMBATCH_AVX2(rotate_inplace, (const double* M, double* x, double* y, double* z, size_t n), (M, x, y, z, n))
+GEOMBATCH_AVX2(line_coords, (const double* c, const double* vn, const double* x, const double* y, const double* z, double* zz, double* r2, size_t n),
+               (c, vn, x, y, z, zz, r2, n))
+
+// division, clamping kernels: AVX2 and AVX-512
+#define GEOMBATCH_SEGMENT_PARAMS (const double* a, const double* b, const double* x, const double* y, const double* z, double* d2, size_t n)
+GEOMBATCH_AVX2(segment_distance2, GEOMBATCH_SEGMENT_PARAMS, (a, b, x, y, z, d2, n))
+GEOMBATCH_AVX512(segment_distance2, GEOMBATCH_SEGMENT_PARAMS, (a, b, x, y, z, d2, n))
+#define GEOMBATCH_CA_PARAMS (const double* p1, const double* d1, const double* px, const double* py, const double* pz, \
+                             const double* dx, const double* dy, const double* dz, double* c1, double* c2, double* d2min, size_t n)
+GEOMBATCH_AVX2(closest_approach, GEOMBATCH_CA_PARAMS, (p1, d1, px, py, pz, dx, dy, dz, c1, c2, d2min, n))
+GEOMBATCH_AVX512(closest_approach, GEOMBATCH_CA_PARAMS, (p1, d1, px, py, pz, dx, dy, dz, c1, c2, d2min, n))
+
+/// available instruction set: 0 = default, 1 = AVX2/FMA, 2 = AVX-512
+static int geombatch_isa() {
+    static const int isa = (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl"))? 2 :
+                           (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))? 1 : 0;
+    return isa;
+}
+
+/// dispatch kernel K to AVX2 if available
+#define GEOMBATCH_CALL_AVX2(K, ARGS) do { if(geombatch_isa() >= 1) K##_avx2 ARGS; else _##K ARGS; } while(0)
+/// dispatch kernel K to best of AVX-512, AVX2
+#define GEOMBATCH_CALL_AVX512(K, ARGS) do { \
+    switch(geombatch_isa()) { \
+        case 2: K##_avx512 ARGS; break; \
+        case 1: K##_avx2 ARGS; break; \
+        default: _##K ARGS; \
+    } } while(0)
+#else
+#define GEOMBATCH_CALL_AVX2(K, ARGS) _##K ARGS
+#define GEOMBATCH_CALL_AVX512(K, ARGS) _##K ARGS
+#endif
+
+void rotate_batch(const Quaternion<double>& Q, SoA3<> p, SoA3<double> r, size_t n) {
+    const auto M = Q.rotationMatrix();
+    if(r.x == p.x && r.y == p.y && r.z == p.z) GEOMBATCH_CALL_AVX2(rotate_inplace, (M.data(), r.x, r.y, r.z, n));
+    else GEOMBATCH_CALL_AVX2(rotate, (M.data(), p.x, p.y, p.z, r.x, r.y, r.z, n));
+}
+
+void line_coords_batch(const geomvec_t& c, const geomvec_t& vn, SoA3<> p, double* z, double* r2, size_t n) {
+    GEOMBATCH_CALL_AVX2(line_coords, (c.data(), vn.data(), p.x, p.y, p.z, z, r2, n));
+}
+
+void segment_distance2_batch(const geomvec_t& a, const geomvec_t& b, SoA3<> p, double* d2, size_t n) {
+    GEOMBATCH_CALL_AVX512(segment_distance2, (a.data(), b.data(), p.x, p.y, p.z, d2, n));
+}
+
+void closest_approach_batch(const geomvec_t& p1, const geomvec_t& d1, SoA3<> p2, SoA3<> d2,
+                            double* c1, double* c2, double* d2min, size_t n) {
+    GEOMBATCH_CALL_AVX512(closest_approach, (p1.data(), d1.data(), p2.x, p2.y, p2.z, d2.x, d2.y, d2.z, c1, c2, d2min, n));
+}
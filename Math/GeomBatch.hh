@@ -0,0 +1,35 @@
+/// \file GeomBatch.hh Structure-of-arrays batched geometry kernels: rotations, line projections, closest approaches, segment distances
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef GEOMBATCH_HH
+#define GEOMBATCH_HH
+
+#include "Quaternion.hh"
+#include <array>
+#include <stddef.h>
+
+/// 3-vector of doubles for batch kernel parameters
+typedef std::array<double,3> geomvec_t;
+
+/// Batch of n 3-vectors as structure-of-arrays x[n], y[n], z[n]
+template<typename T = const double>
+struct SoA3 {
+    T* x;   ///< x components
+    T* y;   ///< y components
+    T* z;   ///< z components
+};
+
+/// Rotate n points p by quaternion Q (as Q.rotate(), via its rotation matrix) into r; r may be identical to p (in-place), otherwise not overlapping
+void rotate_batch(const Quaternion<double>& Q, SoA3<> p, SoA3<double> r, size_t n);
+
+/// line_coords for n points: z[i] projection along unit vn from c, r2[i] distance^2 from line
+void line_coords_batch(const geomvec_t& c, const geomvec_t& vn, SoA3<> p, double* z, double* r2, size_t n);
+
+/// distance^2 d2[i] from n points to line segment a--b
+void segment_distance2_batch(const geomvec_t& a, const geomvec_t& b, SoA3<> p, double* d2, size_t n);
+
+/// closest_approach_points_normalized between line (p1, unit d1) and n lines (p2[i], unit d2[i]): c1[i], c2[i], and distance^2 d2min[i] (if not null)
+void closest_approach_batch(const geomvec_t& p1, const geomvec_t& d1, SoA3<> p2, SoA3<> d2,
+                            double* c1, double* c2, double* d2min, size_t n);
+
+#endif
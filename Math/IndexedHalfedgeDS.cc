@@ -0,0 +1,259 @@
+/// \file IndexedHalfedgeDS.cc
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "IndexedHalfedgeDS.hh"
+#include <map>
+#include <stdexcept>
+#include <stdio.h>
+#include <utility>
+
+constexpr IndexedHalfedgeDS::idx_t IndexedHalfedgeDS::none;
+
+IndexedHalfedgeDS::IndexedHalfedgeDS(size_t n) {
+    if(!n) return;
+    reserve(n, n, 2);
+
+    auto v0 = new_vertex();
+    auto e0 = new_fulledge(v0, v0);
+    e_next[e0] = e0;
+    e_next[e0^1] = e0^1;
+    new_face(e0);
+    new_face(e0^1);
+    f_outer = e_face[e0];
+
+    while(--n) split_edge(e0);
+    validate();
+}
+
+IndexedHalfedgeDS IndexedHalfedgeDS::fromPolygons(size_t nv, const vector<vector<idx_t>>& fs) {
+    IndexedHalfedgeDS H(0);
+    size_t nh = 0;
+    for(auto& f: fs) nh += f.size();
+    H.reserve(nv, nh/2, fs.size());
+    for(size_t i = 0; i < nv; ++i) H.new_vertex();
+
+    std::map<std::pair<idx_t,idx_t>, idx_t> unpaired; // (from, to) -> half-edge awaiting opposite
+    for(auto& f: fs) {
+        if(f.size() < 1) throw std::logic_error("Empty polygon");
+        vector<idx_t> es;
+        for(size_t j = 0; j < f.size(); ++j) {
+            auto u = f[j];
+            auto w = f[(j + 1) % f.size()];
+            if(u >= nv || w >= nv) throw std::logic_error("Polygon vertex out of range");
+            if(unpaired.count({u,w})) throw std::logic_error("Repeated directed edge (non-manifold or mis-oriented mesh)");
+            auto it = unpaired.find({w,u});
+            if(it != unpaired.end()) {
+                es.push_back(it->second^1);
+                unpaired.erase(it);
+            } else {
+                auto e = H.new_fulledge(u, w);
+                unpaired[{u,w}] = e;
+                es.push_back(e);
+            }
+        }
+        for(size_t j = 0; j < es.size(); ++j) H.e_next[es[j]] = es[(j + 1) % es.size()];
+        auto fi = H.new_face(es[0]);
+        for(auto e: es) H.e_face[e] = fi;
+    }
+    if(unpaired.size()) throw std::logic_error("Unpaired edges in open mesh");
+
+    H.validate();
+    return H;
+}
+
+void IndexedHalfedgeDS::reserve(size_t nv, size_t ne, size_t nf) {
+    v_out.reserve(nv);
+    e_to.reserve(2*ne);
+    e_next.reserve(2*ne);
+    e_face.reserve(2*ne);
+    f_edge.reserve(nf);
+}
+
+size_t IndexedHalfedgeDS::memory() const {
+    return sizeof(idx_t)*(v_out.capacity() + e_to.capacity() + e_next.capacity() + e_face.capacity() + f_edge.capacity());
+}
+
+size_t IndexedHalfedgeDS::faceSize(idx_t f) const {
+    size_t n = 0;
+    auto e = f_edge[f];
+    do { ++n; e = e_next[e]; } while(e != f_edge[f]);
+    return n;
+}
+
+size_t IndexedHalfedgeDS::valence(idx_t v) const {
+    size_t n = 0;
+    auto e = v_out[v];
+    if(e == none) return 0;
+    do { ++n; e = rotate(e); } while(e != v_out[v]);
+    return n;
+}
+
+IndexedHalfedgeDS::idx_t IndexedHalfedgeDS::new_vertex() {
+    v_out.push_back(none);
+    return v_out.size() - 1;
+}
+
+IndexedHalfedgeDS::idx_t IndexedHalfedgeDS::new_fulledge(idx_t v0, idx_t v1) {
+    if(e_to.size() + 2 > none) throw std::runtime_error("IndexedHalfedgeDS index space exhausted");
+    idx_t e = e_to.size();
+    e_to.push_back(v1);
+    e_to.push_back(v0);
+    e_next.resize(e + 2, none);
+    e_face.resize(e + 2, none);
+    if(v_out[v0] == none) v_out[v0] = e;
+    if(v_out[v1] == none) v_out[v1] = e^1;
+    return e;
+}
+
+IndexedHalfedgeDS::idx_t IndexedHalfedgeDS::new_face(idx_t e) {
+    idx_t f = f_edge.size();
+    f_edge.push_back(e);
+    e_face[e] = f;
+    return f;
+}
+
+IndexedHalfedgeDS::idx_t IndexedHalfedgeDS::prev(idx_t e) const {
+    auto p = e;
+    while(e_next[p] != e) p = e_next[p];
+    return p;
+}
+
+IndexedHalfedgeDS::idx_t IndexedHalfedgeDS::split_edge(idx_t e) {
+    const idx_t eo = e^1;
+    const idx_t v1 = e_to[e];
+    const idx_t n = e_next[e];
+    const idx_t p = prev(eo);
+
+    auto vm = new_vertex();
+    auto a = new_fulledge(vm, v1);
+    auto b = a^1;
+
+    // v0 -e-> vm -a-> v1 on e's face; v1 -b-> vm -eo-> v0 on eo's face
+    e_to[e] = vm;
+    e_next[e] = a;
+    e_next[a] = n;
+    e_face[a] = e_face[e];
+
+    e_next[p] = b;
+    e_next[b] = eo;
+    e_face[b] = e_face[eo];
+
+    v_out[vm] = a;
+    if(v_out[v1] == eo) v_out[v1] = b;
+    return vm;
+}
+
+void IndexedHalfedgeDS::split_all_edges() {
+    const size_t nh = nHalfedges();
+    reserve(nVertices() + nh/2, nh, nFaces());
+    for(size_t e = 0; e < nh; e += 2) split_edge(e);
+}
+
+IndexedHalfedgeDS::idx_t IndexedHalfedgeDS::split_face(idx_t e1, idx_t e2) {
+    const idx_t f = e_face[e1];
+    if(f != e_face[e2]) throw std::logic_error("Edges not on same face");
+
+    const idx_t p = prev(e1);
+    const idx_t n2 = e_next[e2];
+
+    auto e = new_fulledge(e_to[e2], from(e1));
+    auto eo = e^1;
+    auto fn = new_face(e);
+
+    e_face[eo] = f;
+    f_edge[f] = eo;
+    e_next[eo] = p == e2? eo : n2;
+    e_next[e2] = e;
+    e_next[e] = e1;
+    for(auto x = e1; x != e; x = e_next[x]) e_face[x] = fn;
+    if(p != e2) e_next[p] = eo;
+
+    return e;
+}
+
+void IndexedHalfedgeDS::split_corners(idx_t f, idx_t e) {
+    if(e == none) e = f_edge[f];
+    else if(e_face[e] != f) throw std::logic_error("Edge does not belong to face");
+
+    auto v0 = e_to[e];
+    e = e_next[e];
+
+    do {
+        auto e1 = e_next[e];
+        auto en = e_next[e1];
+        split_face(e, e1);
+        e = en;
+    } while(from(e) != v0);
+}
+
+void IndexedHalfedgeDS::refine_triangles() {
+    const size_t nv0 = nVertices();
+    const size_t ne0 = nHalfedges()/2;
+    const size_t nf0 = nFaces();
+    for(idx_t f = 0; f < nf0; ++f) if(faceSize(f) != 3) throw std::logic_error("refine_triangles requires all-triangle mesh");
+    reserve(nv0 + ne0, 2*ne0 + 3*nf0, 4*nf0);
+
+    split_all_edges();
+    for(idx_t f = 0; f < nf0; ++f) {
+        // start at edge into new midpoint vertex, so corners are cut around original vertices
+        auto e = f_edge[f];
+        while(e_to[e] < nv0) e = e_next[e];
+        split_corners(f, e);
+    }
+}
+
+void IndexedHalfedgeDS::validate() const {
+    const size_t nh = nHalfedges();
+    if(e_next.size() != nh || e_face.size() != nh || nh % 2) throw std::logic_error("Inconsistent half-edge arrays");
+
+    // edge pointing consistency
+    for(idx_t e = 0; e < nh; ++e) {
+        if(e_to[e] >= nVertices()) throw std::logic_error("Edge points to invalid vertex");
+        if(e_next[e] >= nh) throw std::logic_error("Invalid next edge");
+        if(from(e_next[e]) != e_to[e]) throw std::logic_error("Inconsistent edge pointing");
+        if(e_face[e] >= nFaces()) throw std::logic_error("Edge has invalid face");
+    }
+
+    // edge "next" cycle shares same face, covering all edges
+    size_t nv = 0;
+    for(idx_t f = 0; f < nFaces(); ++f) {
+        auto e = f_edge[f];
+        do {
+            if(e_face[e] != f) throw std::logic_error("Inconsistent faces assignment");
+            if(++nv > nh) throw std::logic_error("Unterminated face cycle");
+            e = e_next[e];
+        } while(e != f_edge[f]);
+    }
+    if(nv != nh) throw std::logic_error("Edges missing from face cycles");
+
+    // vertex out-edge circulation
+    nv = 0;
+    for(idx_t v = 0; v < nVertices(); ++v) {
+        auto e = v_out[v];
+        if(e == none) continue;
+        do {
+            if(from(e) != v) throw std::logic_error("'out' edge comes from different vertex");
+            if(++nv > nh) throw std::logic_error("Unterminated vertex circulation");
+            e = rotate(e);
+        } while(e != v_out[v]);
+    }
+    if(nv != nh) throw std::logic_error("Edges missing from vertex circulations");
+}
+
+void IndexedHalfedgeDS::display(bool verbose) const {
+    if(verbose) printf("\n--------------------------------------\n");
+    printf("Indexed half-edge data structure with %zu vertices, %zu half-edges, and %zu faces (%zu bytes)\n",
+           nVertices(), nHalfedges(), nFaces(), memory());
+    if(!verbose) return;
+
+    for(idx_t v = 0; v < nVertices(); ++v) printf("*   Vertex %u: out %u, valence %zu\n", v, v_out[v], valence(v));
+    for(idx_t f = 0; f < nFaces(); ++f) {
+        if(f == f_outer) printf("Outer ");
+        printf("  @ Face %u with edge %u\n", f, f_edge[f]);
+        auto e = f_edge[f];
+        do {
+            printf(" -  Edge %u: from %u to %u, opposite %u next %u (face %u)\n", e, from(e), e_to[e], e^1, e_next[e], e_face[e]);
+            e = e_next[e];
+        } while(e != f_edge[f]);
+    }
+}
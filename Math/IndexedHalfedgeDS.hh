@@ -0,0 +1,105 @@
+/// \file IndexedHalfedgeDS.hh Halfedge data structure in contiguous index-linked (SoA) arrays
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef INDEXEDHALFEDGEDS_HH
+#define INDEXEDHALFEDGEDS_HH
+
+#include <stdint.h>
+#include <stdlib.h> // for size_t
+#include <vector>
+using std::vector;
+
+/// Halfedge data structure with HalfedgeDS operations, stored as contiguous arrays linked by 32-bit indices:
+/// half-edges are allocated in opposite pairs (opposite(e) = e^1), vertices keep one outgoing half-edge (in/out edges by circulation),
+/// faces keep one edge. Storage can be bulk-reserved ahead of subdivision.
+class IndexedHalfedgeDS {
+public:
+    /// element handle
+    typedef uint32_t idx_t;
+    /// null handle
+    static constexpr idx_t none = UINT32_MAX;
+
+    /// Constructor, for one n-gon separating two faces (or none for n=0)
+    explicit IndexedHalfedgeDS(size_t n = 1);
+    /// Construct closed mesh from nv vertices and faces' counterclockwise vertex loops; throw std::logic_error if not closed manifold
+    static IndexedHalfedgeDS fromPolygons(size_t nv, const vector<vector<idx_t>>& fs);
+
+    /// reserve storage for nv vertices, ne full edges (half-edge pairs), nf faces
+    void reserve(size_t nv, size_t ne, size_t nf);
+
+    /// number of vertices
+    size_t nVertices() const { return v_out.size(); }
+    /// number of half-edges
+    size_t nHalfedges() const { return e_to.size(); }
+    /// number of faces
+    size_t nFaces() const { return f_edge.size(); }
+    /// allocated storage bytes
+    size_t memory() const;
+
+    /// vertex pointed to by half-edge
+    idx_t to(idx_t e) const { return e_to[e]; }
+    /// origin vertex of half-edge
+    idx_t from(idx_t e) const { return e_to[e^1]; }
+    /// next half-edge around face
+    idx_t next(idx_t e) const { return e_next[e]; }
+    /// opposite half-edge
+    static idx_t opposite(idx_t e) { return e^1; }
+    /// face of half-edge
+    idx_t face(idx_t e) const { return e_face[e]; }
+    /// one outgoing half-edge of vertex
+    idx_t out(idx_t v) const { return v_out[v]; }
+    /// next outgoing half-edge around common origin vertex
+    idx_t rotate(idx_t e) const { return e_next[e^1]; }
+    /// one half-edge of face
+    idx_t edge(idx_t f) const { return f_edge[f]; }
+    /// number of edges around face
+    size_t faceSize(idx_t f) const;
+    /// number of edges at vertex
+    size_t valence(idx_t v) const;
+
+    /// add new unconnected vertex
+    idx_t new_vertex();
+
+    /// split edge e, 2 new half-edges (a,b) are created; returns new vertex
+    ///
+    ///   -e->  -n->             -e-> -a->  -n->
+    /// v0    v1        ---->  v0    v    v1
+    ///   <-o-                   <-o- <-b-
+    idx_t split_edge(idx_t e);
+
+    /// split every edge
+    void split_all_edges();
+
+    /// split face containing e1 ... e2, returning new edge e from b = to(e2) to a = from(e1),
+    /// adjoining new face f' (old face edge set to opposite(e)); as HalfedgeDS::split_face
+    idx_t split_face(idx_t e1, idx_t e2);
+
+    /// split triangular corners off even-edged face, starting after edge e (default face edge)
+    void split_corners(idx_t f, idx_t e = none);
+
+    /// 1-to-4 refinement of all-triangle mesh (new vertices at edge midpoints), with bulk-reserved storage
+    void refine_triangles();
+
+    /// validate structure assumptions; throw std::logic_error if failed
+    void validate() const;
+    /// print debugging info to stdout
+    void display(bool verbose = false) const;
+
+    idx_t f_outer = none;   ///< ``outside perimeter'' face
+
+protected:
+    /// new edge from v0 to v1 (with opposite); next/face unassigned; returns v0 -> v1 half-edge
+    idx_t new_fulledge(idx_t v0, idx_t v1);
+    /// new face associated with edge
+    idx_t new_face(idx_t e);
+    /// predecessor of e around face
+    idx_t prev(idx_t e) const;
+
+    vector<idx_t> v_out;    ///< one outgoing half-edge for each vertex
+    vector<idx_t> e_to;     ///< vertex pointed to by each half-edge
+    vector<idx_t> e_next;   ///< next half-edge around face
+    vector<idx_t> e_face;   ///< face of each half-edge
+    vector<idx_t> f_edge;   ///< one half-edge of each face
+};
+
+#endif
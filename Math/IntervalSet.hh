@@ -4,11 +4,13 @@
 #ifndef INTERVALSET_HH
 #define INTERVALSET_HH
 
+#include "WorkStealingPool.hh"
 #include <set>
 using std::set;
 #include <stdlib.h> // for size_t
 #include <numeric>  // for std::accumulate
 #include <limits>
+#include <algorithm>
 
 /// An interval
 template<typename T = double>
@@ -125,4 +127,162 @@ public:
     }
 };
 
+/// Collection of disjoint intervals as sorted vector: O(1) appends for time-ordered input, linear-time union and intersection
+template<typename T = double>
+class FlatIntervalSet: protected vector<Interval<T>> {
+public:
+    /// interval specified by (start, end)
+    typedef Interval<T> interval_t;
+    /// parent type
+    typedef vector<interval_t> super;
+    // expose useful functions
+    using super::size;
+    using super::begin;
+    using super::rbegin;
+    using super::end;
+    using super::front;
+    using super::back;
+    using super::reserve;
+    using super::operator[];
+
+    /// add interval to set, merging with any overlapping intervals
+    void operator+=(interval_t i) {
+        if(i.second < i.first) std::swap(i.first, i.second); // assure end >= start
+        ++nIndividual;
+        tIndividual += i.second - i.first;
+
+        if(!size() || i.first > back().second) this->push_back(i); // ordered-input fast path
+        else if(i.first >= back().first) back().second = std::max(back().second, i.second);
+        else {
+            // first interval ending at or after start of i; first interval starting after end of i
+            auto it0 = std::lower_bound(begin(), end(), i.first, [](const interval_t& a, T t) { return a.second < t; });
+            auto it1 = std::upper_bound(it0, end(), i.second, [](T t, const interval_t& a) { return t < a.first; });
+            if(it0 == it1) this->insert(it0, i);
+            else {
+                *it0 = {std::min(i.first, it0->first), std::max(i.second, std::prev(it1)->second)};
+                this->erase(it0 + 1, it1);
+            }
+        }
+
+        // summarize old intervals
+        if(dtMax) summarize(i.first - dtMax);
+    }
+
+    /// bulk-add intervals (in any order)
+    void add(vector<interval_t> v) {
+        bool ordered = true;
+        for(size_t j = 0; j < v.size(); ++j) {
+            auto& i = v[j];
+            if(i.second < i.first) std::swap(i.first, i.second);
+            tIndividual += i.second - i.first;
+            ordered = ordered && (!j || v[j-1].first <= i.first);
+        }
+        nIndividual += v.size();
+        if(!ordered) std::sort(v.begin(), v.end());
+
+        FlatIntervalSet S;
+        S.reserve(v.size());
+        for(auto& i: v) S.append(i);
+        unite(S);
+        if(dtMax && size()) summarize(back().first - dtMax);
+    }
+
+    /// combine (OR) with other intervals
+    void operator+=(const FlatIntervalSet& rhs) {
+        unite(rhs);
+        nIndividual += rhs.nIndividual;
+        tIndividual += rhs.tIndividual;
+        nSummary += rhs.nSummary;
+        tSummary += rhs.tSummary;
+    }
+
+    /// intersection (AND) with other intervals
+    void operator&=(const FlatIntervalSet& rhs) {
+        super inew;
+        auto it0 = begin();
+        auto it1 = rhs.begin();
+        while(it0 != end() && it1 != rhs.end()) {
+            if(it0->second < it1->first) ++it0;
+            else if(it1->second < it0->first) ++it1;
+            else {
+                interval_t i(std::max(it0->first, it1->first), std::min(it0->second, it1->second));
+                if(i.first < i.second) inew.push_back(i);
+                if(it0->second < it1->second) ++it0;
+                else ++it1;
+            }
+        }
+        super::operator=(std::move(inew));
+        nIndividual += rhs.nIndividual;
+        tIndividual += rhs.tIndividual;
+    }
+
+    /// collapse all intervals starting before specified value into summary
+    void summarize(T t0) {
+        if(!size() || !(front().first < t0)) return;
+        auto it = std::lower_bound(begin(), end(), t0, [](const interval_t& a, T t) { return a.first < t; });
+        for(auto i = begin(); i != it; ++i) {
+            ++nSummary;
+            tSummary += i->second - i->first;
+        }
+        this->erase(begin(), it);
+    }
+
+    size_t nSummary = 0;    ///< number of summarized non-tracked intervals
+    T dtMax = 0;            ///< maximum length to store (0 to disable)
+    T tSummary = 0;         ///< content of summarized non-tracked intervals
+    T tIndividual = 0;      ///< span of individual intervals added before overlap
+    size_t nIndividual = 0; ///< number of individual intervals before merge
+
+    /// number of intervals
+    size_t n() const { return size() + nSummary; }
+
+    /// total of all intervals
+    T total() const {
+        return std::accumulate(begin(), end(), tSummary,
+                               [](T a, const interval_t& b) { return a + b.second - b.first; });
+    }
+
+protected:
+    /// append interval starting at or after all current starts, merging with last
+    void append(const interval_t& i) {
+        if(size() && i.first <= back().second) back().second = std::max(back().second, i.second);
+        else this->push_back(i);
+    }
+
+    /// linear-time union of intervals
+    void unite(const FlatIntervalSet& rhs) {
+        if(!rhs.size()) return;
+        if(!size() || rhs.front().first > back().second) { this->insert(end(), rhs.begin(), rhs.end()); return; }
+
+        FlatIntervalSet u;
+        u.reserve(size() + rhs.size());
+        auto it0 = begin();
+        auto it1 = rhs.begin();
+        while(it0 != end() || it1 != rhs.end()) {
+            if(it1 == rhs.end() || (it0 != end() && it0->first < it1->first)) u.append(*(it0++));
+            else u.append(*(it1++));
+        }
+        super::swap(u);
+    }
+};
+
+/// union of per-thread interval sets by pairwise tree reduction on nthreads (0 for all cores); v is consumed
+template<typename T>
+FlatIntervalSet<T> parallel_union(vector<FlatIntervalSet<T>>& v, int nthreads = 0) {
+    if(!v.size()) return {};
+    if(nthreads != 1 && v.size() > 2) {
+        WorkStealingPool P(std::max(nthreads, 0));
+        for(size_t stride = 1; stride < v.size(); stride *= 2) {
+            for(size_t i = 0; i + stride < v.size(); i += 2*stride) {
+                P.submit([&v, i, stride]() {
+                    v[i] += v[i + stride];
+                    v[i + stride] = {};
+                });
+            }
+            P.wait_idle();
+        }
+    } else for(size_t i = 1; i < v.size(); ++i) v[0] += v[i];
+    return std::move(v[0]);
+}
+
 #endif
@@ -1,8 +1,12 @@
 /// \file LaplacianSums.cc
 
 #include "LaplacianSums.hh"
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 double sum_laplacian(double c) {
     auto sc = sqrt(fabs(c));
@@ -34,3 +38,96 @@ double sum_inverse_quadratic(double a, double b, double c) {
     if(u > 0) return sum_factored_quadratic(-0.5*b, 0.5*sqrt(u))/a;
     return sum_factored_iquadratic(-0.5*b, 0.5*sqrt(-u))/a;
 }
+
+double dsum_laplacian(double c) {
+    auto sc = sqrt(fabs(c));
+    if(c < 0) {
+        auto x = M_PI*sc;
+        auto sx = sin(x);
+        return -(M_PI/(tan(x)*sc*sc) + M_PI*M_PI/(sx*sx*sc))/(2*sc);
+    }
+    auto x = M_PI*sc;
+    auto sx = sinh(x);
+    return -(M_PI/(tanh(x)*c) + M_PI*M_PI/(sx*sx*sc))/(2*sc);
+}
+
+//////////////////////////////////////
+// batched evaluation
+
+void sum_laplacian(const double* c, double* s, size_t n) {
+    // pi coth(pi sqrt c)/sqrt c = pi (1 + e)/((1 - e) sqrt c), e = exp(-2 pi sqrt c), without cancellation for 2 pi sqrt c >= 1
+    const double cmin = 1/(4*M_PI*M_PI);
+    for(size_t i = 0; i < n; ++i) {
+        auto sc = sqrt(c[i] >= cmin? c[i] : 1.);
+        auto e = exp(-2*M_PI*sc);
+        s[i] = M_PI*(1 + e)/((1 - e)*sc);
+    }
+    for(size_t i = 0; i < n; ++i) if(!(c[i] >= cmin)) s[i] = sum_laplacian(c[i]);
+}
+
+void sum_factored_quadratic(const double* u, const double* d, double* s, size_t n) {
+    for(size_t i = 0; i < n; ++i) s[i] = sum_factored_quadratic(u[i], d[i]);
+}
+
+void sum_inverse_quadratic(const double* a, const double* b, const double* c, double* s, size_t n) {
+    for(size_t i = 0; i < n; ++i) s[i] = sum_inverse_quadratic(a[i], b[i], c[i]);
+}
+
+//////////////////////////////////////
+// interpolation table
+
+double LaplacianSumTable::sum5(double c) {
+    const int K = 20;
+    double s = 1/(c*c*c*c*c);
+    for(int k = 1; k <= K; ++k) {
+        double x = k*k + c;
+        s += 2/(x*x*x*x*x);
+    }
+    return s + 2/(9*pow(K, 9)); // tail bound 2 \int_K^\infty dk/k^10
+}
+
+LaplacianSumTable::LaplacianSumTable(double _c0, double _c1, double _maxerr):
+c0(_c0), c1(_c1), ic0(1/_c0), maxerr(_maxerr) {
+    if(!(c0 > 0 && c1 > c0 && maxerr > 0)) throw std::logic_error("Invalid LaplacianSumTable range");
+
+    for(double b0 = c0; b0 < c1; b0 *= 2) {
+        band_t B;
+        B.c0 = b0;
+        auto w = std::min(2*b0, c1) - b0;
+        B.n = size_t(ceil(w/pow(384*0.5*maxerr/(24*sum5(b0)), 0.25))); // half of error budget reserved for rounding
+        if(B.n < 1) B.n = 1;
+        B.h = w/B.n;
+        B.ih = 1/B.h;
+        B.k0 = f.size();
+        for(size_t i = 0; i <= B.n; ++i) {
+            auto x = b0 + i*B.h;
+            f.push_back(sum_laplacian(x));
+            df.push_back(B.h*dsum_laplacian(x));
+        }
+        bands.push_back(B);
+    }
+}
+
+double LaplacianSumTable::operator()(double c) const {
+    if(!(c >= c0 && c <= c1)) return sum_laplacian(c);
+
+    // octave from binary exponent
+    uint64_t xb;
+    double x = c*ic0;
+    memcpy(&xb, &x, sizeof(x));
+    int e = int((xb >> 52) & 0x7ff) - 1023; // may be -1 if c*ic0 rounds below 1
+    auto& B = bands[std::min(size_t(std::max(e, 0)), bands.size() - 1)];
+    auto t = (c - B.c0)*B.ih;
+    size_t i = std::min(size_t(std::max(t, 0.)), B.n - 1);
+    auto u = t - i;
+    i += B.k0;
+
+    // cubic Hermite basis
+    auto u2 = u*u;
+    auto u3 = u2*u;
+    return (2*u3 - 3*u2 + 1)*f[i] + (u3 - 2*u2 + u)*df[i] + (3*u2 - 2*u3)*f[i+1] + (u3 - u2)*df[i+1];
+}
+
+void LaplacianSumTable::operator()(const double* c, double* s, size_t n) const {
+    for(size_t i = 0; i < n; ++i) s[i] = (*this)(c[i]);
+}
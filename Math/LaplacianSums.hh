@@ -1,12 +1,22 @@
 /// \file LaplacianSums.hh Infinite sums of 1/quadratic form
 // Michael P. Mendenhall, LLNL 2021
 
+#ifndef LAPLACIANSUMS_HH
+#define LAPLACIANSUMS_HH
+
+#include <stddef.h>
+#include <vector>
+using std::vector;
+
 /// \f$\sum_{k=-\infty}^{\infty} 1/(k^2 + c)\f$
 double sum_laplacian(double c);
 
 /// \f$\sum_{k=-\infty}^{\infty} 1/(a k^2 + c)\f$
 inline double sum_laplacian(double a, double c) { return sum_laplacian(c/a)/a; }
 
+/// \f$\frac{d}{dc} \sum_{k=-\infty}^{\infty} 1/(k^2 + c) = -\sum_{k=-\infty}^{\infty} 1/(k^2 + c)^2\f$
+double dsum_laplacian(double c);
+
 /// \f$\sum_{k=-\infty}^{\infty} 1/(k + u + d)(k + u - d)\f$
 double sum_factored_quadratic(double u, double d);
 
@@ -16,3 +26,58 @@ double sum_factored_iquadratic(double u, double d);
 /// \f$\sum_{k=-\infty}^{\infty} 1/(a k^2 + b k + c)\f$
 double sum_inverse_quadratic(double a, double b, double c);
 
+/// batched s[i] = sum_laplacian(c[i]); c > 0 entries evaluated in a branch-free exp loop (vectorizable given vector libm)
+void sum_laplacian(const double* c, double* s, size_t n);
+
+/// batched s[i] = sum_factored_quadratic(u[i], d[i])
+void sum_factored_quadratic(const double* u, const double* d, double* s, size_t n);
+
+/// batched s[i] = sum_inverse_quadratic(a[i], b[i], c[i])
+void sum_inverse_quadratic(const double* a, const double* b, const double* c, double* s, size_t n);
+
+/// Interpolation table for sum_laplacian(c) over 0 < c0 <= c <= c1, with guaranteed absolute error bound
+/**
+    Piecewise cubic Hermite on knots uniform within each octave [c0 2^j, c0 2^{j+1}),
+    spaced so the remainder bound h^4/384 max|f''''| is half the error budget (remainder for rounding), where |f''''(c)| = 24 \sum_k (k^2 + c)^{-5} is maximal at each octave start.
+    Arguments outside [c0, c1] fall back to the closed form.
+*/
+class LaplacianSumTable {
+public:
+    /// Constructor, for range and maximum absolute error
+    LaplacianSumTable(double c0, double c1, double maxerr = 1e-12);
+
+    /// interpolated sum_laplacian(c)
+    double operator()(double c) const;
+    /// interpolated sum_laplacian(a, c)
+    double operator()(double a, double c) const { return (*this)(c/a)/a; }
+    /// batched interpolation s[i] = sum_laplacian(c[i])
+    void operator()(const double* c, double* s, size_t n) const;
+
+    /// number of knots
+    size_t size() const { return f.size(); }
+    /// bound on absolute interpolation error
+    double errorBound() const { return maxerr; }
+
+    /// upper bound on \f$\sum_{k=-\infty}^{\infty} (k^2 + c)^{-5}\f$, c > 0
+    static double sum5(double c);
+
+protected:
+    /// uniform-knots octave
+    struct band_t {
+        double c0;  ///< start of octave
+        double ih;  ///< inverse knot spacing
+        double h;   ///< knot spacing
+        size_t k0;  ///< first knot index
+        size_t n;   ///< number of intervals
+    };
+
+    const double c0;    ///< table start
+    const double c1;    ///< table end
+    const double ic0;   ///< 1/c0
+    const double maxerr;///< error bound
+    vector<band_t> bands;   ///< octaves
+    vector<double> f;       ///< function values at knots
+    vector<double> df;      ///< h * derivatives at knots
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "LinalgHelpers.hh"
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_blas.h>
+#include <stdexcept>
 
 void LinMin::setNeq(size_t neq) {
     clear();
@@ -32,36 +33,62 @@ void LinMin::setNeq(size_t neq) {
 
 void LinMin::calcQR() {
     if(has_tau) return; // already done
+    QR = M;
     tau = gsl_vector_wrapper(M->size2);
-    gsl_linalg_QR_decomp(M,tau);
+    gsl_linalg_QR_decomp(QR,tau);
     has_tau = true;
+    has_Cov = has_PCA = false;
+    ++nFactor;
 }
 
 void LinMin::_solve() {
     calcQR();
     resize(x, M->size2);
     resize(r, M->size1);
-    gsl_linalg_QR_lssolve(M, tau, y, x, r);
+    gsl_linalg_QR_lssolve(QR, tau, y, x, r);
+}
+
+void LinMin::lssolve(const gsl_vector* vy, gsl_vector* vx, gsl_vector* vr) const {
+    if(!has_tau) throw std::logic_error("LinMin::lssolve requires factor()");
+    gsl_linalg_QR_lssolve(QR, tau, vy, vx, vr);
+}
+
+void LinMin::calcResid(const gsl_matrix* Y, const gsl_matrix* X, gsl_matrix* Rs) const {
+    gsl_matrix_memcpy(Rs, Y);
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, -1.0, M, X, 1.0, Rs);
+}
+
+void LinMin::solveMulti(const gsl_matrix* Y, gsl_matrix* X, gsl_matrix* Rs) const {
+    if(!has_tau) throw std::logic_error("LinMin::solveMulti requires factor()");
+    if(Y->size1 != Neq || X->size1 != Nvar || X->size2 != Y->size2 || (Rs && (Rs->size1 != Neq || Rs->size2 != Y->size2)))
+        throw std::logic_error("LinMin::solveMulti dimension mismatch");
+
+    // X = R^-1 (Q^T Y)[0:Nvar]
+    gsl_matrix_wrapper QTY(Neq, Y->size2, false);
+    gsl_matrix_memcpy(QTY, Y);
+    gsl_linalg_QR_QTmat(QR, tau, QTY);
+    gsl_matrix_const_view QTY0 = gsl_matrix_const_submatrix(QTY, 0, 0, Nvar, Y->size2);
+    gsl_matrix_memcpy(X, &QTY0.matrix);
+    gsl_matrix_const_view R0 = gsl_matrix_const_submatrix(QR, 0, 0, Nvar, Nvar);
+    gsl_blas_dtrsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, 1.0, &R0.matrix, X);
+
+    if(Rs) calcResid(Y, X, Rs);
 }
 
 const gsl_matrix_wrapper& LinMin::calcCov() {
     if(has_Cov) return Cov; // already calculated
     calcQR();
 
-    // unpack Q,R decomposition matrices
-    Q = gsl_matrix_wrapper(Neq, Neq);
-    R = gsl_matrix_wrapper(Neq, Nvar);
-    gsl_linalg_QR_unpack(M, tau, Q, R);
-
-    // copy to L
-    L = gsl_matrix_wrapper(Nvar, Nvar);
-    for(size_t i = 0; i < Nvar; i++)
-        for(size_t j = i; j < Nvar; j++)
-            L(j,i) = R(i,j);
+    // R^-1 by triangular solve against identity, from upper triangle of QR
+    gsl_matrix_wrapper Ri(Nvar, Nvar);
+    gsl_matrix_set_identity(Ri);
+    gsl_matrix_const_view R0 = gsl_matrix_const_submatrix(QR, 0, 0, Nvar, Nvar);
+    gsl_blas_dtrsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, 1.0, &R0.matrix, Ri);
 
-    // Cov = (M^T M)^-1 = (L L^T)^-1
-    Cov = L;
-    gsl_linalg_cholesky_invert(Cov);
+    // Cov = (R^T R)^-1 = R^-1 R^-T: symmetric rank-k update for lower triangle, then mirror
+    Cov = gsl_matrix_wrapper(Nvar, Nvar);
+    gsl_blas_dsyrk(CblasLower, CblasNoTrans, 1.0, Ri, 0.0, Cov);
+    fillSymmetric(CblasUpper, Cov);
 
     has_Cov = true;
     return Cov;
@@ -25,7 +25,7 @@
 #include "LinalgHelpers.hh"
 
 /// helper class for solving (overdetermined) system of linear equations Mx = y + r
-// Internally: decomposes M = Q (orthogonal) * R (right-triangular)
+// Internally: decomposes M = Q (orthogonal) * R (right-triangular), cached until M is changed
 class LinMin: protected EigSymmWorkspace {
 public:
     /// Constructor, for n variables with m equations
@@ -43,12 +43,18 @@ public:
     /// clear previous calculation inputs
     virtual void clear() { has_tau = has_Cov = has_PCA = false; if(M) gsl_matrix_set_zero(M); }
 
-    /// set element of M
-    void setM(size_t i, size_t j, double v) { gsl_matrix_set(M,i,j,v); }
+    /// set element of M (invalidating cached factorization)
+    void setM(size_t i, size_t j, double v) { gsl_matrix_set(M,i,j,v); has_tau = has_Cov = has_PCA = false; }
 
     /// calculate solution x, r
     template<typename YVec>
     void solve(const YVec& vy) { vector2gsl(vy,y); _solve(); }
+    /// precompute QR decomposition (and derived quantities), for repeated lssolve on multiple right-hand sides
+    virtual void factor() { calcQR(); }
+    /// thread-safe solve (after factor()) for RHS vy into caller-provided solution vx[Nvar] and residuals vr[Neq]
+    virtual void lssolve(const gsl_vector* vy, gsl_vector* vx, gsl_vector* vr) const;
+    /// thread-safe solve (after factor()) for RHS columns Y[Neq, n] into X[Nvar, n] and (optional) residuals Rs[Neq, n], by BLAS-3 operations
+    virtual void solveMulti(const gsl_matrix* Y, gsl_matrix* X, gsl_matrix* Rs = nullptr) const;
 
     /// get sum of squares of residuals ~ sigma^2 * nDF
     double ssresid() const;
@@ -71,17 +77,17 @@ protected:
 
     /// solve after loading 'y' vector
     virtual void _solve();
-    /// calculate QR decomposition of M (stored in M, tau)
+    /// calculate QR decomposition of M (stored in QR, tau), if not already cached
     void calcQR();
+    /// residuals Rs = Y - M X
+    void calcResid(const gsl_matrix* Y, const gsl_matrix* X, gsl_matrix* Rs) const;
 
     size_t Neq = 0;             ///< number of equations
 
-    gsl_matrix_wrapper M;       ///< coefficients (design) matrix -> QR decomp
+    gsl_matrix_wrapper M;       ///< coefficients (design) matrix
+    gsl_matrix_wrapper QR;      ///< QR decomposition of M
     gsl_vector_wrapper tau;     ///< from QR decomposition of M
-    gsl_matrix_wrapper Q;       ///< unpacked Q decomposition matrix
-    gsl_matrix_wrapper R;       ///< unpacked R decomposition
-    gsl_matrix_wrapper L;       ///< L = R^T square corner, Cholesky Decomp M^T M = L L^T
-    gsl_matrix_wrapper Cov;     ///< Cov = (M^T M)^-1 = (L L^T)^-1
+    gsl_matrix_wrapper Cov;     ///< Cov = (M^T M)^-1 = (R^T R)^-1
     gsl_matrix_wrapper PCA;     ///< normalized eigenvectors of Cov in columns (for random realizations)
     gsl_vector_wrapper lPCA;    ///< eigenvalues of Cov
     gsl_vector_wrapper x;       ///< solution vector
@@ -89,6 +95,7 @@ protected:
     gsl_vector_wrapper r;       ///< residuals vector
 
     bool has_tau = false;       ///< QR decomposition calculated?
+    size_t nFactor = 0;         ///< number of QR decompositions performed, for validating derived caches
     bool has_Cov = false;       ///< Covariance matrix calculated?
     bool has_PCA = false;       ///< PCA calculated?
 };
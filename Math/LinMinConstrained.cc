@@ -23,7 +23,7 @@
 #include <cassert>
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_blas.h>
-#include <iostream>
+#include <stdexcept>
 
 /*
 Minimize |r^2| over x: M[Neq,Nvar] x = y + r,
@@ -35,37 +35,29 @@ d|r^2|/dx = d/dx lambda G =>
 
 (1) M^T M x = M^T y + G^T lambda
 
-Decomposing M = Q[Neq,Neq] R[Neq,Nvar], where Q is orthogonal
-    and R is upper-right-triangular;
-    let S[Nvar,Nvar] be the truncated upper square of R, then
-then M^T M = R^T R = S^T S is square and symmetric.
+With C = (M^T M)^-1 = (R^T R)^-1 from the cached QR decomposition (LinMin::calcCov),
+and x0 = C M^T y the unconstrained least-squares solution,
 
-(2) S^T S x = M^T y + G^T lambda
-we can use Cholesky Decomposition inverse on S^T S
+(2) x = x0 + C G^T lambda
 
-Substitute x = (S^T S)^-1 (M^T y + G^T l) into (0) to solve for lambda(y,k):
+Substitute into (0) to solve for lambda(y,k):
 
-(3) (G (S^T S)^-1 G^T) lambda = k - (G (S^T S)^-1 M^T) y
+(3) (G C G^T) lambda = k - G x0
 (solve for lambda using Cholesky Decomposition)
 
-Substitute G^T lambda back into (2) to solve for x (using Cholesky Decomp. solver)
+G C and the Cholesky decomposition of G C G^T depend only on M, G, so are reused over right-hand sides y.
 */
 
-
 void LinMinConstrained::clear() {
     LinMin::clear();
-    clear_constraints();
-
-    assert(false);
-    //if(Q) gsl_matrix_free(Q);
-    //if(RT) gsl_matrix_free(RT);
-    //if(RTRi) gsl_matrix_free(RTRi);
-    //Q = RT = RTRi = nullptr;
+    conFactor = 0;
+    l = gsl_vector_wrapper();
 }
 
 void LinMinConstrained::setG(size_t i, size_t j, double v) {
     assert(G && i<Ncon && j<Nvar);
     gsl_matrix_set(G,i,j,v);
+    conFactor = 0;
 }
 
 void LinMinConstrained::setk(size_t i, double v) {
@@ -74,124 +66,90 @@ void LinMinConstrained::setk(size_t i, double v) {
 }
 
 void LinMinConstrained::clear_constraints() {
-    assert(false); // TODO
-    /*
-    if(G) gsl_matrix_free(G);
-    if(GRRM) gsl_matrix_free(GRRM);
-    if(GRRG_CD) gsl_matrix_free(GRRG_CD);
-    if(k) gsl_vector_free(k);
-    if(l) gsl_vector_free(l);
-    G = GRRM = GRRG_CD = nullptr;
-    k = l = nullptr;
-    */
+    G = gsl_matrix_wrapper();
+    k = gsl_vector_wrapper();
+    GC = gsl_matrix_wrapper();
+    GCG_CD = gsl_matrix_wrapper();
+    l = gsl_vector_wrapper();
+    conFactor = 0;
 }
 
 void LinMinConstrained::setNConstraints(size_t nc) {
+    clear_constraints();
     Ncon = nc;
-    if(!G || G->size1 != Ncon || G->size2 != Nvar) clear_constraints();
     if(!Ncon) return;
     G = gsl_matrix_wrapper(Ncon,Nvar);
     k = gsl_vector_wrapper(Ncon);
 }
 
-void LinMinConstrained::_solve() {
-    if(!G) { LinMin::_solve(); return; }
-    if(!(M && y && r)) throw;
+void LinMinConstrained::factor() {
+    calcQR();
+    if(!Ncon || conFactor == nFactor) return;
 
-    resize(x,M->size2);
+    const auto& C = calcCov();
 
-    if(!tau) { // need QR decomposision?
+    // GC = G C, C = (M^T M)^-1 symmetric
+    GC = gsl_matrix_wrapper(Ncon, Nvar);
+    if(gsl_blas_dsymm(CblasRight, CblasLower, 1.0, C, G, 0.0, GC))
+        throw std::runtime_error("LinMinConstrained G C product failed");
 
-        tau = gsl_vector_wrapper(M->size2);
-        if(gsl_linalg_QR_decomp(M,tau)) throw;
+    // Cholesky decomposition of G C G^T
+    GCG_CD = gsl_matrix_wrapper(Ncon, Ncon);
+    if(gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, GC, G, 0.0, GCG_CD))
+        throw std::runtime_error("LinMinConstrained G C G^T product failed");
+    if(gsl_linalg_cholesky_decomp(GCG_CD))
+        throw std::runtime_error("LinMinConstrained degenerate constraints");
 
-        // Extract Q, R
-        Q = gsl_matrix_wrapper(Neq,Neq);
-        gsl_matrix_wrapper R0(Neq,Nvar);
-        if(gsl_linalg_QR_unpack(M, tau, Q, R0)) throw;
+    conFactor = nFactor;
+}
 
-        // Truncate, transpose R to lower-triangular form assumed by gsl Cholesky
-        gsl_matrix_wrapper R1 = R0;
-        if(gsl_matrix_transpose(R1)) throw;
-        // RTRi = (R^T R)^-1
-        RTRi = R1; // renaming for inversion
-        gsl_linalg_cholesky_invert(RTRi);
+void LinMinConstrained::constrain(gsl_matrix* X, gsl_matrix* Lm) const {
+    if(conFactor != nFactor) throw std::logic_error("LinMinConstrained solve requires factor()");
 
-        clear_constraints(); // need new constraints solver
-    }
+    // U = k - G X0
+    for(size_t i = 0; i < Ncon; ++i)
+        for(size_t j = 0; j < X->size2; ++j)
+            gsl_matrix_set(Lm, i, j, k(i));
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, -1.0, G, X, 1.0, Lm);
 
-    if(!GRRM) { // need constraints solver?
-
-        //gsl_matrix_print(RTRi);
-
-        gsl_matrix_wrapper GRR(Ncon, Nvar);
-        // C = a BA + b C, symmetric A
-        if(gsl_blas_dsymm(CblasRight,   // AB vs. BA
-                          CblasLower,   // RTRi lower-triangle representation
-                          1.0,          // a
-                          RTRi,         // A
-                          G,            // B
-                          0.0,          // b
-                          GRR)          // C
-          ) throw;
-
-        GRRG_CD = gsl_matrix_wrapper(Ncon,Ncon);
-        if(gsl_blas_dgemm(CblasNoTrans, // op(A)
-                          CblasTrans,   // op(B)
-                          1.0,          // a
-                          GRR,         // A
-                          G,            // B
-                          0.0,          // b
-                          GRRG_CD)      // C
-          ) throw;
-        if(gsl_linalg_cholesky_decomp(GRRG_CD)) throw;      // older deprecated function call
-        //if(gsl_linalg_cholesky_decomp1(GRRG_CD)) throw;   // newer GSL call
-
-        GRRM = gsl_matrix_wrapper(Ncon,Neq);
-        if(gsl_blas_dgemm(CblasNoTrans, // op(A)
-                          CblasTrans,   // op(B)
-                          1.0,          // a
-                          GRR,          // A
-                          M,            // B
-                          0.0,          // b
-                          GRRM)         // C
-        ) throw;
-        gsl_matrix_free(GRR);
+    // (G C G^T) lambda = U, by triangular solves with Cholesky factor L L^T
+    gsl_blas_dtrsm(CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit, 1.0, GCG_CD, Lm);
+    gsl_blas_dtrsm(CblasLeft, CblasLower, CblasTrans, CblasNonUnit, 1.0, GCG_CD, Lm);
+
+    // X = X0 + C G^T lambda = X0 + (G C)^T lambda
+    gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, GC, Lm, 1.0, X);
+}
+
+void LinMinConstrained::solveMulti(const gsl_matrix* Y, gsl_matrix* X, gsl_matrix* Rs) const {
+    LinMin::solveMulti(Y, X, nullptr);
+    if(Ncon) {
+        gsl_matrix_wrapper Lm(Ncon, Y->size2, false);
+        constrain(X, Lm);
     }
+    if(Rs) calcResid(Y, X, Rs);
+}
 
-    // calculate u = k - (G (R^T R)^-1 M^T) y
-    gsl_vector_wrapper u = k;
-    // y = a op(A) x + b y
-    if(gsl_blas_dgemv(CblasNoTrans, // op(A)
-                      -1.0,         // a
-                      GRRM,         // A
-                      y,            // x
-                      1.0,          // b
-                      u)            // y
-      ) throw;
-
-    // solve (G RTR^-1 G^T) l = u for l
-    if(gsl_linalg_cholesky_solve(GRRG_CD, u, l)) throw;
-
-    // calculate v = M^T y + G^T l
-    gsl_vector_wrapper v(Neq);
-    // y = a op(A) x + b y
-    if(gsl_blas_dgemv(CblasTrans,   // op(A)
-                      1.0,          // a
-                      G,            // A
-                      l,            // x
-                      0,            // b
-                      v)            // y
-      ) throw;
-    if(gsl_blas_dgemv(CblasTrans,   // op(A)
-                      1.0,          // a
-                      M,            // A
-                      y,            // x
-                      1.0,          // b
-                      v)            // y
-      ) throw;
-
-    // solve for x
-    if(gsl_linalg_cholesky_solve(RT, v, x)) throw;
+void LinMinConstrained::lssolve(const gsl_vector* vy, gsl_vector* vx, gsl_vector* vr) const {
+    if(!Ncon) { LinMin::lssolve(vy, vx, vr); return; }
+    gsl_matrix_const_view Y = gsl_matrix_const_view_vector(vy, vy->size, 1);
+    gsl_matrix_view X = gsl_matrix_view_vector(vx, vx->size, 1);
+    gsl_matrix_view Rs = gsl_matrix_view_vector(vr, vr->size, 1);
+    solveMulti(&Y.matrix, &X.matrix, &Rs.matrix);
 }
 
+void LinMinConstrained::_solve() {
+    if(!Ncon) { LinMin::_solve(); return; }
+    if(!(M && y)) throw std::logic_error("LinMinConstrained::solve missing inputs");
+
+    factor();
+    resize(x, Nvar);
+    resize(r, Neq);
+    resize(l, Ncon);
+    gsl_matrix_const_view Y = gsl_matrix_const_view_vector(y, Neq, 1);
+    gsl_matrix_view X = gsl_matrix_view_vector(x, Nvar, 1);
+    gsl_matrix_view Rs = gsl_matrix_view_vector(r, Neq, 1);
+    gsl_matrix_view Lm = gsl_matrix_view_vector(l, Ncon, 1);
+    LinMin::solveMulti(&Y.matrix, &X.matrix, nullptr);
+    constrain(&X.matrix, &Lm.matrix);
+    calcResid(&Y.matrix, &X.matrix, &Rs.matrix);
+}
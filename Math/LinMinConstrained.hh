@@ -28,10 +28,12 @@
 class LinMinConstrained: public LinMin {
 public:
     /// Constructor, for m equations in n variables
-    explicit LinMinConstrained(size_t nvar, size_t neq = 0, size_t ncon = 0): LinMin(nvar, neq), Ncon(ncon) { }
+    explicit LinMinConstrained(size_t nvar, size_t neq = 0, size_t ncon = 0): LinMin(nvar, neq) { setNConstraints(ncon); }
 
     /// set number of constraints
     void setNConstraints(size_t nc);
+    /// get number of constraints
+    size_t nCon() const { return Ncon; }
     /// set constraints
     void setG(size_t i, size_t j, double v);
     /// set constraints RHS
@@ -42,25 +44,30 @@ public:
     /// clear constraints solution (permits re-evaluation with different constraints)
     void clear_constraints();
 
+    /// precompute QR decomposition and constraints solver, for repeated lssolve/solveMulti
+    void factor() override;
+    /// thread-safe constrained solve (after factor()) for RHS vy into vx[Nvar], vr[Neq]
+    void lssolve(const gsl_vector* vy, gsl_vector* vx, gsl_vector* vr) const override;
+    /// thread-safe constrained solve (after factor()) for RHS columns Y[Neq, n] into X[Nvar, n], optional residuals Rs[Neq, n]
+    void solveMulti(const gsl_matrix* Y, gsl_matrix* X, gsl_matrix* Rs = nullptr) const override;
+
     /// get Lagrange Multipliers vector
     void getL(vector<double>& vl) const { gsl2vector(l,vl); }
 
 protected:
     /// solve after loading 'y' vector
     void _solve() override;
+    /// apply constraints to unconstrained solutions X (columns), returning Lagrange multipliers in Lm
+    void constrain(gsl_matrix* X, gsl_matrix* Lm) const;
 
-    size_t Ncon;
-
-    // for each M
-    gsl_matrix_wrapper Q;       ///< Q from QR decomp
-    gsl_matrix_wrapper RT;      ///< R^T from QR decomp (use with blas Cholesky Decomposition functions for R^T R)
-    gsl_matrix_wrapper RTRi;    ///< (R^T R)^-1 = (M^T M)^-1 using Cholesky inverse
+    size_t Ncon = 0;            ///< number of constraints
+    size_t conFactor = 0;       ///< nFactor value for which constraint solver is valid (0 for none)
 
     // for each M,G
     gsl_matrix_wrapper G;       ///< Ncon*Nvar constraints matrix
     gsl_vector_wrapper k;       ///< RHS of constraints
-    gsl_matrix_wrapper GRRM;    ///< G (R^T R)^-1 M^T reusable intermediate
-    gsl_matrix_wrapper GRRG_CD; ///< Cholesky Decomposition for A*lambda = v solver
+    gsl_matrix_wrapper GC;      ///< G (M^T M)^-1 reusable intermediate
+    gsl_matrix_wrapper GCG_CD;  ///< Cholesky Decomposition of G (M^T M)^-1 G^T, for lambda solver
 
     // for each y,M,G
     gsl_vector_wrapper l;       ///< Lagrange Multipliers for constraints
@@ -0,0 +1,142 @@
+/// \file LinMinUpdate.cc
+
+#include "LinMinUpdate.hh"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+LinMinUpdate::LinMinUpdate(size_t nvar): EigSymmWorkspace(nvar), Nvar(nvar),
+Ra((Nvar+1)*(Nvar+1)), u(Nvar+1), cs(2*(Nvar+1)) { }
+
+void LinMinUpdate::clear() {
+    std::fill(Ra.begin(), Ra.end(), 0);
+    W = 0;
+    has_Cov = has_PCA = false;
+}
+
+void LinMinUpdate::addEq(const vector<double>& m, double y, double w) {
+    if(m.size() != Nvar) throw std::logic_error("Mismatched LinMinUpdate equation size");
+    const size_t n = Nvar + 1;
+    has_Cov = has_PCA = false;
+
+    if(decay != 1) {
+        auto s = sqrt(decay);
+        for(auto& r: Ra) r *= s;
+        W *= decay;
+    }
+    W += w;
+
+    // rotate weighted row into factor
+    auto sw = sqrt(w);
+    for(size_t j = 0; j < Nvar; ++j) u[j] = sw*m[j];
+    u[Nvar] = sw*y;
+    for(size_t i = 0; i < n; ++i) {
+        if(!u[i]) continue;
+        auto Ri = Ra.data() + i*n;
+        auto r = hypot(Ri[i], u[i]);
+        auto c = Ri[i]/r;
+        auto s = u[i]/r;
+        Ri[i] = r;
+        for(size_t j = i+1; j < n; ++j) {
+            auto t = c*Ri[j] + s*u[j];
+            u[j] = c*u[j] - s*Ri[j];
+            Ri[j] = t;
+        }
+    }
+}
+
+bool LinMinUpdate::removeEq(const vector<double>& m, double y, double w) {
+    if(m.size() != Nvar) throw std::logic_error("Mismatched LinMinUpdate equation size");
+    const size_t n = Nvar + 1;
+
+    // solve R^T p = row
+    auto sw = sqrt(w);
+    for(size_t j = 0; j < Nvar; ++j) u[j] = sw*m[j];
+    double pp = 0;
+    for(size_t j = 0; j < Nvar; ++j) {
+        for(size_t i = 0; i < j; ++i) u[j] -= Ra[i*n + j]*u[i];
+        if(!Ra[j*n + j]) return false;
+        u[j] /= Ra[j*n + j];
+        pp += u[j]*u[j];
+    }
+    if(!(pp < 1 - 1e-12)) return false;
+
+    // rotations annihilating p (LINPACK dchdd)
+    auto alpha = sqrt(1 - pp);
+    for(size_t i = Nvar; i-- > 0;) {
+        auto scale = alpha + fabs(u[i]);
+        auto a = alpha/scale;
+        auto b = u[i]/scale;
+        auto nrm = sqrt(a*a + b*b);
+        cs[2*i] = a/nrm;
+        cs[2*i+1] = b/nrm;
+        alpha = scale*nrm;
+    }
+
+    // residual sum of squares after downdating Q^T y column
+    double zeta = sw*y;
+    for(size_t i = 0; i < Nvar; ++i) {
+        auto z = (Ra[i*n + Nvar] - cs[2*i+1]*zeta)/cs[2*i];
+        zeta = cs[2*i]*zeta - cs[2*i+1]*z;
+    }
+    auto& rho = Ra[Nvar*n + Nvar];
+    auto rr = rho*rho - zeta*zeta;
+    if(rr < -1e-12*(rho*rho + w*y*y)) return false;
+
+    for(size_t j = 0; j < Nvar; ++j) {
+        double xx = 0;
+        for(size_t i = j+1; i-- > 0;) {
+            auto& Rij = Ra[i*n + j];
+            auto t = cs[2*i]*xx + cs[2*i+1]*Rij;
+            Rij = cs[2*i]*Rij - cs[2*i+1]*xx;
+            xx = t;
+        }
+    }
+    zeta = sw*y;
+    for(size_t i = 0; i < Nvar; ++i) {
+        auto& z = Ra[i*n + Nvar];
+        z = (z - cs[2*i+1]*zeta)/cs[2*i];
+        zeta = cs[2*i]*zeta - cs[2*i+1]*z;
+    }
+    rho = sqrt(std::max(rr, 0.));
+
+    W -= w;
+    has_Cov = has_PCA = false;
+    return true;
+}
+
+void LinMinUpdate::getx(vector<double>& vx) const {
+    const size_t n = Nvar + 1;
+    vx.resize(Nvar);
+    for(size_t i = Nvar; i-- > 0;) {
+        auto s = Ra[i*n + Nvar];
+        for(size_t j = i+1; j < Nvar; ++j) s -= Ra[i*n + j]*vx[j];
+        vx[i] = s/Ra[i*n + i];
+    }
+}
+
+const gsl_matrix_wrapper& LinMinUpdate::calcCov() {
+    if(has_Cov) return Cov;
+
+    // Cholesky form M^T M = L L^T, L = R^T
+    const size_t n = Nvar + 1;
+    Cov = gsl_matrix_wrapper(Nvar, Nvar);
+    for(size_t i = 0; i < Nvar; i++)
+        for(size_t j = i; j < Nvar; j++)
+            Cov(j,i) = Ra[i*n + j];
+    gsl_linalg_cholesky_invert(Cov);
+
+    has_Cov = true;
+    return Cov;
+}
+
+const gsl_matrix_wrapper& LinMinUpdate::calcPCA() {
+    if(has_PCA) return PCA;
+
+    lPCA = gsl_vector_wrapper(Nvar);
+    PCA = calcCov();
+    decompSymm(PCA, lPCA);
+
+    has_PCA = true;
+    return PCA;
+}
@@ -0,0 +1,62 @@
+/// \file LinMinUpdate.hh Least-squares linear solver by incremental (rank-1) QR updates
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef LINMINUPDATE_HH
+#define LINMINUPDATE_HH
+
+#include "LinalgHelpers.hh"
+
+/// Least-squares solver for M x = y + r, accumulating equations one at a time into triangular factor
+/**
+    Keeps only the (Nvar+1)x(Nvar+1) upper-triangular R of the QR decomposition of augmented [M | y],
+    updated by Givens rotations (O(Nvar^2) per equation, independent of number of equations).
+    Previous equations may be exponentially downweighted (decay) or removed (Cholesky downdate),
+    e.g. for sliding-window fits.
+*/
+class LinMinUpdate: protected EigSymmWorkspace {
+public:
+    /// Constructor, for n variables
+    explicit LinMinUpdate(size_t nvar);
+
+    /// get Nvar
+    size_t nVar() const { return Nvar; }
+    /// get summed equation weights
+    double nEq() const { return W; }
+    /// get (effective) number of degrees of freedom
+    double nDF() const { return W - Nvar; }
+    /// remove all equations
+    void clear();
+
+    /// add equation m.x = y with weight w (after multiplying previous weights by decay)
+    void addEq(const vector<double>& m, double y, double w = 1);
+    /// remove previously-added equation at its current weight w; return false (leaving factor unchanged) if numerically unstable
+    bool removeEq(const vector<double>& m, double y, double w = 1);
+
+    /// get solution x
+    void getx(vector<double>& vx) const;
+    /// get weighted sum of squares of residuals ~ sigma^2 * nDF
+    double ssresid() const { return Ra[Nvar*(Nvar+1) + Nvar] * Ra[Nvar*(Nvar+1) + Nvar]; }
+    /// calculate and return UNNORMALIZED covariance matrix (sum X^T X)^-1 (needs sigma^2 scaling)
+    const gsl_matrix_wrapper& calcCov();
+    /// calculate, return unit eigenvectors of covariance matrix in columns
+    const gsl_matrix_wrapper& calcPCA();
+    /// return eigenvalues for PCA vectors
+    const gsl_vector_wrapper& PCAlambda() { calcPCA(); return lPCA; }
+
+    double decay = 1;           ///< previous equations weight multiplier for each addEq
+
+protected:
+    size_t Nvar;                ///< number of variables
+    vector<double> Ra;          ///< row-major (Nvar+1)^2 upper-triangular factor of [M | y]; last column Q^T y, corner sqrt(ssresid)
+    vector<double> u;           ///< row/solution workspace
+    vector<double> cs;          ///< downdate rotations workspace
+    double W = 0;               ///< summed equation weights
+
+    gsl_matrix_wrapper Cov;     ///< Cov = (R^T R)^-1
+    gsl_matrix_wrapper PCA;     ///< normalized eigenvectors of Cov in columns
+    gsl_vector_wrapper lPCA;    ///< eigenvalues of Cov
+    bool has_Cov = false;       ///< Covariance matrix calculated?
+    bool has_PCA = false;       ///< PCA calculated?
+};
+
+#endif
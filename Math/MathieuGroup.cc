@@ -25,7 +25,7 @@ namespace MathieuGroup {
     }
 
     const M11_conj_t& M11_conj() {
-        static const M11_conj_t C(M11());
+        static const M11_conj_t C(M11(), {M11a,M11b});
         return C;
     }
 
@@ -23,7 +23,50 @@ inline pair<int,int> EuclidRelPrime(int p, int q) {
 /// precalculated NxN mod-N multiplication table
 const uint_fast8_t* modMulTable(size_t N);
 
+/// inverse of a mod n by iterative extended Euclid, or 0 if gcd(a,n) != 1
+constexpr uint64_t modInverse(uint64_t a, uint64_t n) {
+    int64_t t0 = 0, t1 = 1;
+    uint64_t r0 = n, r1 = a % n;
+    while(r1) {
+        auto q = r0 / r1;
+        auto t = t0 - int64_t(q)*t1;
+        t0 = t1; t1 = t;
+        auto r = r0 - q*r1;
+        r0 = r1; r1 = r;
+    }
+    if(r0 != 1) return 0;
+    return t0 < 0? uint64_t(t0 + int64_t(n)) : uint64_t(t0);
+}
+
+/// compile-time table of mod-N inverses (0 for non-invertible)
+template<size_t N>
+struct ModInverseTable {
+    /// Constructor, filling table
+    constexpr ModInverseTable(): v{} { for(size_t i = 1; i < N; ++i) v[i] = modInverse(i, N); }
+    uint8_t v[N];   ///< inverses
+};
+
+/// Montgomery-form constants for odd modulus N, 2^32 < N < 2^63
+template<uint64_t N>
+struct ModMontgomery {
+    /// -N^{-1} mod 2^64 by Newton iteration
+    static constexpr uint64_t ninv() { uint64_t x = N; for(int k = 0; k < 5; ++k) x *= 2 - N*x; return -x; }
+    /// 2^128 mod N
+    static constexpr uint64_t r2() { auto r = uint64_t((__uint128_t(1) << 64) % N); return uint64_t((__uint128_t(r)*r) % N); }
+
+    /// Montgomery reduction T/2^64 mod N, T < N 2^64
+    static uint64_t redc(__uint128_t T) {
+        uint64_t m = uint64_t(T)*ninv();
+        uint64_t t = (T + __uint128_t(m)*N) >> 64;
+        return t >= N? t - N : t;
+    }
+    /// a*b mod N for a,b < N, by two reductions (no division)
+    static uint64_t mul(uint64_t a, uint64_t b) { return redc(__uint128_t(redc(__uint128_t(a)*b))*r2()); }
+};
+
 /// Modular Integers; default up to N <= 255 fits in uchar
+/// Multiplication: N < 256 by lookup table; N <= 2^32 by 64-bit product and compile-time-constant remainder
+/// (compiled to multiply-shift reduction); odd N < 2^63 by Montgomery reduction; division by compile-time inverse table for N < 256.
 template<size_t N, typename int_t = uint_fast8_t>
 class ModularField {
 public:
@@ -58,13 +101,18 @@ public:
         if(N < 256) {
             static const unsigned char* t = modMulTable(N);
             i = t[i*N + Z.i];
-        } else i = (i*Z.i)%N;
+        } else i = mulmod(i, Z.i);
         return *this;
     }
     /// multiplication
     const ModularField operator*(ModularField Z) const { auto c = *this; return c *= Z; }
     /// contents inverse
-    ModularField inverse() { if(!i) throw std::range_error("1/0 is bad!"); return EuclidRelPrime(i, N).first; }
+    ModularField inverse() const {
+        if(!i) throw std::range_error("1/0 is bad!");
+        uint64_t j = N < 256? invtab.v[N < 256? size_t(i) : 0] : modInverse(i, N);
+        if(!j) throw std::range_error("Non-invertible modular integer");
+        return ModularField(j, true);
+    }
     /// invert this
     ModularField& invert() { return (*this = inverse()); }
     /// inplace division
@@ -75,7 +123,7 @@ public:
     /// inplace addition
     ModularField& operator+=(ModularField Z) {
         if(N > 128) { // avoid overflow of uchar
-            int k = int(i)+int(Z.i);
+            uint64_t k = uint64_t(i) + Z.i;
             if(k >= int(N)) k -= N;
             i = k;
         } else {
@@ -147,13 +195,26 @@ public:
         ModularField i; ///< internal index, N at range end
     };
 
+    /// modular product of reduced values a, b (N >= 256)
+    static uint64_t mulmod(uint64_t a, uint64_t b) {
+        if(N <= (uint64_t(1) << 32)) return (a*b) % N;
+        if(N % 2 && N < (uint64_t(1) << 63)) return ModMontgomery<N % 2 && N < (uint64_t(1) << 63)? N : 3>::mul(a, b);
+        return uint64_t((__uint128_t(a)*b) % N);
+    }
+
 protected:
     /// Special-purpose constructor without modular bounds
-    ModularField(int n, bool): i(n) { }
+    ModularField(uint64_t n, bool): i(n) { }
+
+    /// compile-time inverses table (dummy for N >= 256)
+    static constexpr ModInverseTable<(N < 256? N : 1)> invtab{};
 
     int_t i;  ///< internal representation in [0,N), or i=N for special iterator end
 };
 
+template<size_t N, typename int_t>
+constexpr ModInverseTable<(N < 256? N : 1)> ModularField<N,int_t>::invtab;
+
 /// output representation for modular number
 template<size_t N, typename int_t>
 std::ostream& operator<<(std::ostream& o, ModularField<N,int_t> Z) { o << int(Z); return o; }
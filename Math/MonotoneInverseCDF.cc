@@ -0,0 +1,92 @@
+/// \file MonotoneInverseCDF.cc
+
+#include "MonotoneInverseCDF.hh"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+void MonotoneInverseCDF::calcSlopes() {
+    const size_t n = ku.size();
+    vector<double> d(n - 1);
+    for(size_t i = 0; i + 1 < n; ++i) d[i] = (kx[i+1] - kx[i])/(ku[i+1] - ku[i]);
+
+    km.resize(n);
+    km[0] = d[0];
+    km[n-1] = d[n-2];
+    for(size_t i = 1; i + 1 < n; ++i) km[i] = d[i-1]*d[i] <= 0? 0 : 0.5*(d[i-1] + d[i]);
+
+    // Fritsch-Carlson monotonicity constraint
+    for(size_t i = 0; i + 1 < n; ++i) {
+        if(!d[i]) { km[i] = km[i+1] = 0; continue; }
+        double a = km[i]/d[i], b = km[i+1]/d[i];
+        double s = a*a + b*b;
+        if(s > 9) {
+            double t = 3/sqrt(s);
+            km[i] = t*a*d[i];
+            km[i+1] = t*b*d[i];
+        }
+    }
+}
+
+void MonotoneInverseCDF::calcGuide() {
+    nguide = ku.size();
+    guide.resize(nguide);
+    size_t i = 0;
+    for(size_t j = 0; j < nguide; ++j) {
+        double u = double(j)/nguide;
+        while(i + 2 < ku.size() && ku[i+1] <= u) ++i;
+        guide[j] = i;
+    }
+}
+
+void MonotoneInverseCDF::build(const quantile_t& Q, double tol, size_t ninit, size_t nmax) {
+    if(ninit < 2) ninit = 2;
+    ku.resize(ninit + 1);
+    kx.resize(ninit + 1);
+    for(size_t i = 0; i <= ninit; ++i) {
+        ku[i] = double(i)/ninit;
+        kx[i] = Q(ku[i]);
+    }
+    const double xtol = tol*fabs(kx.back() - kx.front());
+
+    vector<double> nu, nx;
+    while(true) {
+        calcSlopes();
+
+        // split intervals failing accuracy check at midpoint or quarter points
+        nu.clear();
+        nx.clear();
+        size_t nsplit = 0;
+        for(size_t i = 0; i + 1 < ku.size(); ++i) {
+            nu.push_back(ku[i]);
+            nx.push_back(kx[i]);
+            if(ku.size() + nsplit >= nmax) continue;
+            double h = ku[i+1] - ku[i];
+            double um = ku[i] + 0.5*h;
+            double xm = Q(um);
+            bool ok = fabs(interp(i, um) - xm) <= xtol;
+            for(double f: {0.25, 0.75}) if(ok) ok = fabs(interp(i, ku[i] + f*h) - Q(ku[i] + f*h)) <= xtol;
+            if(!ok && h > 1e-14) {
+                nu.push_back(um);
+                nx.push_back(xm);
+                ++nsplit;
+            }
+        }
+        nu.push_back(ku.back());
+        nx.push_back(kx.back());
+        ku.swap(nu);
+        kx.swap(nx);
+        if(!nsplit) break;
+    }
+    calcSlopes();
+    calcGuide();
+}
+
+void MonotoneInverseCDF::setKnots(const vector<double>& u, const vector<double>& x) {
+    if(u.size() != x.size() || u.size() < 2 || u.front() != 0 || u.back() != 1)
+        throw std::domain_error("Invalid MonotoneInverseCDF knots");
+    ku = u;
+    kx = x;
+    calcSlopes();
+    calcGuide();
+}
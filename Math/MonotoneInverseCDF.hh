@@ -0,0 +1,72 @@
+/// \file MonotoneInverseCDF.hh Adaptively-refined inverse CDF table with monotone cubic interpolation, for fast random variates
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef MONOTONEINVERSECDF_HH
+#define MONOTONEINVERSECDF_HH
+
+#include <functional>
+#include <vector>
+using std::vector;
+#include <stdlib.h>
+
+/// Tabulated inverse CDF x(u), u in [0,1]: monotone (Fritsch-Carlson) cubic Hermite interpolation between adaptively placed knots,
+/// with a uniform guide table for constant-time knot lookup
+class MonotoneInverseCDF {
+public:
+    /// quantile function u -> x to tabulate (monotone non-decreasing)
+    typedef std::function<double(double)> quantile_t;
+
+    /// build table from quantile function Q, refining until interval midpoint and quarter-point errors < tol*(Q(1) - Q(0))
+    void build(const quantile_t& Q, double tol = 1e-7, size_t ninit = 64, size_t nmax = 1<<20);
+
+    /// evaluate inverse CDF at u in [0,1]
+    double operator()(double u) const {
+        size_t i = guide[size_t(u*nguide) < nguide? size_t(u*nguide) : nguide - 1];
+        while(i + 2 < ku.size() && u >= ku[i+1]) ++i;
+        return interp(i, u);
+    }
+    /// batched evaluation x[n] at u[n]
+    void eval(const double* u, double* x, size_t n) const { for(size_t j = 0; j < n; ++j) x[j] = (*this)(u[j]); }
+
+    /// fill x[n] with random variates, using rng() uniform [0,1) generator
+    template<class RNG>
+    void sample(double* x, size_t n, RNG& rng) const {
+        const size_t nb = 256;
+        double u[nb];
+        for(size_t j0 = 0; j0 < n; j0 += nb) {
+            auto m = std::min(nb, n - j0);
+            for(size_t j = 0; j < m; ++j) u[j] = rng();
+            eval(u, x + j0, m);
+        }
+    }
+
+    /// number of knots
+    size_t size() const { return ku.size(); }
+    /// knot u positions
+    const vector<double>& getKnotsU() const { return ku; }
+    /// knot x values
+    const vector<double>& getKnotsX() const { return kx; }
+    /// set table from knots (u increasing from 0 to 1), e.g. to restore saved getKnotsU(), getKnotsX()
+    void setKnots(const vector<double>& u, const vector<double>& x);
+
+protected:
+    /// Hermite interpolation on interval i
+    double interp(size_t i, double u) const {
+        const double h = ku[i+1] - ku[i];
+        const double t = (u - ku[i])/h;
+        const double t2 = t*t, t3 = t2*t;
+        return (2*t3 - 3*t2 + 1)*kx[i] + (t3 - 2*t2 + t)*h*km[i] + (-2*t3 + 3*t2)*kx[i+1] + (t3 - t2)*h*km[i+1];
+    }
+    /// calculate monotone slopes at knots
+    void calcSlopes();
+    /// build guide table
+    void calcGuide();
+
+    vector<double> ku;          ///< knot u positions
+    vector<double> kx;          ///< knot x values
+    vector<double> km;          ///< knot slopes dx/du
+    vector<size_t> guide;       ///< guide[j]: interval containing u = j/nguide
+    size_t nguide = 0;          ///< guide table size
+};
+
+#endif
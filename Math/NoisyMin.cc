@@ -48,8 +48,10 @@ void NoisyMin::initMinStep() {
 NoisyMin::vec_t NoisyMin::nextSample(double nsigma) {
     if(Ntot > N) throw std::logic_error("Ntot out of range");
     if(Ntot < N) addPart(N-Ntot, Quadratic::nterms(N-Ntot));
+    return toSample(next(), nsigma);
+}
 
-    vec_t p0 = next();
+NoisyMin::vec_t NoisyMin::toSample(vec_t p0, double nsigma) const {
     for(auto& x: p0) x = 2*x-1;
     // TODO spherize subgroups
 
@@ -81,16 +83,75 @@ NoisyMin::vec_t NoisyMin::nextSample(double nsigma) {
     return x;
 }
 
+vector<NoisyMin::evalpt> NoisyMin::proposeSamples(size_t k, double nsigma) {
+    // successive quasirandom draws are already well spread over the search region
+    if(Ntot > N) throw std::logic_error("Ntot out of range");
+    if(Ntot < N) addPart(N-Ntot, Quadratic::nterms(N-Ntot));
+    vector<evalpt> v(k, evalpt(N));
+    size_t i = 0;
+    for(auto& p0: nextBatch(k)) {
+        auto& p = v[i++];
+        p.x = toSample(p0, nsigma);
+        Quadratic::evalTerms(p.x, p.t);
+    }
+    return v;
+}
+
+NoisyMin::vec_t NoisyMin::updateHessian() {
+    if(nFitted > fvals.size()) nFitted = 0;
+    if(!nFitted) LU.clear();
+    LU.decay = wdecay;
+    auto wold = pow(wdecay, nwindow);
+    for(; nFitted < fvals.size(); ++nFitted) {
+        auto& p = fvals[nFitted];
+        LU.addEq(p.t, p.f);
+        if(!nwindow || nFitted < nwindow) continue;
+        auto& p0 = fvals[nFitted - nwindow];
+        if(LU.removeEq(p0.t, p0.f, wold)) continue;
+
+        // unstable downdate: refit window from scratch
+        if(verbose) printf("NoisyMin refitting %zu-point window\n", nwindow);
+        LU.clear();
+        for(auto i = nFitted + 1 - nwindow; i <= nFitted; ++i) LU.addEq(fvals[i].t, fvals[i].f);
+    }
+    if(verbose) printf("\n**** NoisyMin incremental fit over %zu datapoints (weight %g)...\n", fvals.size(), LU.nEq());
+
+    vec_t y;
+    LU.getx(y);
+    return y;
+}
+
 Quadratic NoisyMin::fitHessian() {
     if(verbose) displaySearchRange();
 
-    // filter points to search region
-    vector<evalpt> vs;
-    for(auto& p: fvals) {
-        for(size_t i=0; i<N; i++) v1(i) = p.x[i] - x0[i];
-        gsl_blas_dtrmv(CblasLower, CblasTrans, CblasNonUnit, sE.EC.L, v1);
-        if(gsl_blas_dnrm2(v1) < 1.001) vs.push_back(p);
+    if(incremental) {
+        Quadratic Q(N);
+        Q.setCoeffs(updateHessian());
+        if(verbose) {
+            printf("Hessian fit:\n");
+            Q.display();
+        }
+        return Q;
+    }
+
+    // filter points to search region |L^T (x - x0)|^2 = (x - x0)^T A (x - x0) < 1
+    Quadratic QR(N);
+    size_t n = 0;
+    for(size_t i=0; i<N; i++) {
+        for(size_t j=0; j<=i; j++) {
+            double a = 0;   // (L L^T)_ij from lower triangle only
+            for(size_t m=0; m<=j; m++) a += sE.EC.L(i, m) * sE.EC.L(j, m);
+            QR.A[n++] = (i==j? 1 : 2)*a;
+        }
     }
+    vec_t dx(fvals.size()*N);
+    vec_t r2(fvals.size());
+    size_t k = 0;
+    for(auto& p: fvals) for(size_t i=0; i<N; i++) dx[k++] = p.x[i] - x0[i];
+    QR.xTAxBatch(dx.data(), fvals.size(), r2.data());
+    vector<evalpt> vs;
+    k = 0;
+    for(auto& p: fvals) if(r2[k++] < 1.001*1.001) vs.push_back(p);
     if(verbose) printf("\n**** NoisyMin fitting %zu/%zu datapoints...\n", vs.size(), fvals.size());
 
     // fit surface around minimum
@@ -115,12 +176,15 @@ Quadratic NoisyMin::fitHessian() {
 }
 
 vector<Quadratic> NoisyMin::LMvariants() {
-    auto P = LM.calcPCA();
-    auto l = LM.PCAlambda();
-    auto s2 = LM.nDF() > 0? LM.ssresid()/LM.nDF() : 0;
+    auto P = incremental? LU.calcPCA() : LM.calcPCA();
+    auto l = incremental? LU.PCAlambda() : LM.PCAlambda();
+    double s2 = 0;
+    if(incremental) s2 = LU.nDF() > 0? LU.ssresid()/LU.nDF() : 0;
+    else s2 = LM.nDF() > 0? LM.ssresid()/LM.nDF() : 0;
     if(verbose) printf("RMS deviation %g\n", sqrt(s2));
     vec_t y;
-    LM.getx(y);
+    if(incremental) LU.getx(y);
+    else LM.getx(y);
     vector<Quadratic> vQ;
     for(size_t i=0; i<NTERMS; i++) {
         auto yy = y;
@@ -418,7 +482,6 @@ std::istream& operator>> (std::istream &i, NoisyMin& NM) {
     }
 
     i >> NM.QRNGn;
-    NM.QRNG.Skip(NM.QRNGn);
 
     return i;
 }
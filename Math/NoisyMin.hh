@@ -6,6 +6,10 @@
 #include "PointSelector.hh"
 #include "Quadratic.hh"
 #include "LinMin.hh"
+#include "LinMinUpdate.hh"
+#include "WorkStealingPool.hh"
+#include <exception>
+#include <mutex>
 #include <string>
 using std::string;
 using std::vector;
@@ -16,6 +20,7 @@ using std::vector;
     - call initRange() to set sampling range bounds SR0 from dS, x0
     - repeat to desired convergence:
         - add points using addSample(f) on evaluated function
+          (or k at a time with addSamples(f, k), or proposeSamples(k) for external/distributed evaluation)
         - call fitMinSingular() for an update step
 */
 class NoisyMin: protected PointSelector {
@@ -53,6 +58,13 @@ public:
     /// add evaluated point from supplied function
     template<typename F>
     evalpt& addSample(F& f);
+    /// propose batch of k sampling points (with fitter terms) for evaluation outside the minimizer
+    vector<evalpt> proposeSamples(size_t k, double nsigma = 1);
+    /// add batch of externally-evaluated points (e.g. from proposeSamples)
+    void addSamples(const vector<evalpt>& v) { fvals.insert(fvals.end(), v.begin(), v.end()); }
+    /// propose and evaluate k points concurrently on nthreads (0 for hardware) pool threads; f must be thread-safe
+    template<typename F>
+    void addSamples(F& f, size_t k, int nthreads = 0);
     /// perform fit update step (non-singular solutions)
     void fitMin();
     /// perform fit update step (non-positive-definite Hessian)
@@ -85,11 +97,17 @@ public:
     gsl_matrix_wrapper SRm{N,N};    ///< minimum search range ellipse (start in PCA form; converted to Cholesky form)
 
     LinMin LM{NTERMS};              ///< fitter for quadratic surface x^T A x + b^T x + c around minimum
+    bool incremental = false;       ///< fit by rank-1 updates over all (downweighted/windowed) points, rather than refitting current search region
+    double wdecay = 1;              ///< incremental fit: previous points weight multiplier per added point
+    size_t nwindow = 0;             ///< incremental fit: if nonzero, fit only most recent nwindow points
+    LinMinUpdate LU{NTERMS};        ///< incremental fitter for quadratic surface
     double k0 = 0;                  ///< fit minimum value
     double dk2 = 0;                 ///< statistical uncertainty^2 on k0
 
     /// request next sampling point location
     vec_t nextSample(double nsigma = 1);
+    /// map PointSelector point p0 in [0,1)^N to sampling location in nsigma search region
+    vec_t toSample(vec_t p0, double nsigma) const;
     /// generate variations according to LM covariance
     vector<Quadratic> LMvariants();
     /// fit LM to points in current region; return convenience quadratic
@@ -98,6 +116,10 @@ public:
 protected:
     /// update search range assuming sE.E1.L, sE.E2.L in Cholesky form
     void updateRange();
+    /// fold new points into incremental fitter LU; return fit coefficients
+    vec_t updateHessian();
+
+    size_t nFitted = 0;         ///< number of fvals folded into LU
 
     QuadraticCholesky QC{N};    ///< quadratic decomposition helper
     EigSymmWorkspace EWS{N};    ///< NxN eigendecomposition workspace
@@ -109,8 +131,7 @@ protected:
     gsl_vector_wrapper v1{N};   ///< temporary calculation vector
     gsl_vector_wrapper v2{N};   ///< temporary calculation vector
 
-    ROOT::Math::QuasiRandomNiederreiter QRNG{(unsigned int)N};   ///< quasirandom distribution generator
-    size_t QRNGn = 0;           ///< number of points pulled from QRNG
+    size_t QRNGn = 0;           ///< (unused) retained for serialization format
 
     friend std::ostream& operator<< (std::ostream &o, const NoisyMin& NM);
     friend std::istream& operator>> (std::istream &i, NoisyMin& NM);
@@ -134,6 +155,23 @@ NoisyMin::evalpt& NoisyMin::addSample(F& f) {
     return p;
 }
 
+template<typename F>
+void NoisyMin::addSamples(F& f, size_t k, int nthreads) {
+    auto v = proposeSamples(k);
+    std::exception_ptr e;
+    std::mutex eMut;
+    {
+        WorkStealingPool P(std::max(nthreads, 0));
+        for(auto& p: v) P.submit([&f, &p, &e, &eMut] {
+            try { p.f = f(p.x); }
+            catch(...) { std::lock_guard<std::mutex> L(eMut); if(!e) e = std::current_exception(); }
+        });
+        P.wait_idle();
+    }
+    if(e) std::rethrow_exception(e);
+    addSamples(v);
+}
+
 /// serialize to output
 std::ostream& operator<<(std::ostream& o, const NoisyMin::evalpt& p);
 /// deserialize (requires correct dimension to already be set)
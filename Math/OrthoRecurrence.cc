@@ -0,0 +1,100 @@
+/// \file OrthoRecurrence.cc
+
+#include "OrthoRecurrence.hh"
+#include <algorithm>
+#include <stdexcept>
+
+constexpr size_t OrthoRecurrence::block;
+
+OrthoRecurrence::OrthoRecurrence(family_t f, size_t nmax): family(f) { reserve(nmax); }
+
+void OrthoRecurrence::reserve(size_t n) {
+    for(size_t m = A.size(); m < n; ++m) {
+        const double k = m;
+        switch(family) {
+            case LEGENDRE:      // (m+1) P_{m+1} = (2m+1) x P_m - m P_{m-1}
+                A.push_back((2*k + 1)/(k + 1)); B.push_back(0); C.push_back(k/(k + 1)); break;
+            case CHEBYSHEV_T:   // T_{m+1} = 2 x T_m - T_{m-1}; T_1 = x
+                A.push_back(m? 2 : 1); B.push_back(0); C.push_back(m? 1 : 0); break;
+            case CHEBYSHEV_U:   // U_{m+1} = 2 x U_m - U_{m-1}
+                A.push_back(2); B.push_back(0); C.push_back(m? 1 : 0); break;
+            case HERMITE:       // H_{m+1} = 2 x H_m - 2 m H_{m-1}
+                A.push_back(2); B.push_back(0); C.push_back(2*k); break;
+            case LAGUERRE:      // (m+1) L_{m+1} = (2m+1-x) L_m - m L_{m-1}
+                A.push_back(-1/(k + 1)); B.push_back((2*k + 1)/(k + 1)); C.push_back(k/(k + 1)); break;
+            default: throw std::logic_error("Unknown OrthoRecurrence family");
+        }
+    }
+}
+
+void OrthoRecurrence::checkOrder(size_t nc) const {
+    if(nc > A.size() + 1) throw std::logic_error("OrthoRecurrence order beyond cached coefficients");
+}
+
+double OrthoRecurrence::operator()(size_t n, double x) const {
+    checkOrder(n + 1);
+    double p0 = 0, p1 = 1;
+    for(size_t k = 0; k < n; ++k) {
+        auto p2 = (A[k]*x + B[k])*p1 - C[k]*p0;
+        p0 = p1;
+        p1 = p2;
+    }
+    return p1;
+}
+
+void OrthoRecurrence::evalAll(double x, double* p, size_t n) const {
+    checkOrder(n);
+    if(!n) return;
+    p[0] = 1;
+    if(n > 1) p[1] = A[0]*x + B[0];
+    for(size_t k = 1; k + 1 < n; ++k) p[k+1] = (A[k]*x + B[k])*p[k] - C[k]*p[k-1];
+}
+
+void OrthoRecurrence::basis(const double* x, size_t n, size_t nc, double* M) const {
+    checkOrder(nc);
+    for(size_t i = 0; i < n; ++i) evalAll(x[i], M + i*nc, nc);
+}
+
+double OrthoRecurrence::series(const double* c, size_t nc, double x) const {
+    checkOrder(nc);
+    // b_k = c_k + (A_k x + B_k) b_{k+1} - C_{k+1} b_{k+2}; sum = b_0
+    double b1 = 0, b2 = 0;
+    for(size_t k = nc; k-- > 0;) {
+        auto b0 = c[k] + (k + 1 < nc? (A[k]*x + B[k])*b1 - (k + 2 < nc? C[k+1]*b2 : 0) : 0);
+        b2 = b1;
+        b1 = b0;
+    }
+    return b1;
+}
+
+void OrthoRecurrence::series(const double* c, size_t nc, const double* x, double* y, size_t n) const {
+    checkOrder(nc);
+    if(!nc) { std::fill(y, y + n, 0.); return; }
+
+    double b1[block], b2[block];
+    for(size_t j0 = 0; j0 < n; j0 += block) {
+        const size_t m = std::min(block, n - j0);
+        const double* __restrict__ xx = x + j0;
+        double* __restrict__ yy = y + j0;
+
+        // top two terms
+        for(size_t j = 0; j < m; ++j) { b2[j] = 0; b1[j] = c[nc-1]; }
+        if(nc > 1) {
+            const double a = A[nc-2], b = B[nc-2], cc = c[nc-2];
+            for(size_t j = 0; j < m; ++j) {
+                b2[j] = b1[j];
+                b1[j] = cc + (a*xx[j] + b)*b2[j];
+            }
+        }
+        // remaining terms, contiguous loops over points
+        for(size_t k = nc > 2? nc - 2 : 0; k-- > 0;) {
+            const double a = A[k], b = B[k], d = C[k+1], ck = c[k];
+            for(size_t j = 0; j < m; ++j) {
+                auto b0 = ck + (a*xx[j] + b)*b1[j] - d*b2[j];
+                b2[j] = b1[j];
+                b1[j] = b0;
+            }
+        }
+        std::copy(b1, b1 + m, yy);
+    }
+}
@@ -0,0 +1,57 @@
+/// \file OrthoRecurrence.hh Numeric three-term-recurrence evaluation of orthogonal polynomials and series (Clenshaw), batched over points
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef ORTHORECURRENCE_HH
+#define ORTHORECURRENCE_HH
+
+#include <stddef.h>
+#include <vector>
+using std::vector;
+
+/// Orthogonal polynomial family by cached recurrence coefficients p_{n+1}(x) = (A_n x + B_n) p_n(x) - C_n p_{n-1}(x), p_0 = 1, C_0 = 0
+/// (numeric counterpart to symbolic LegendrePolynomials, Chebyshev_T, Chebyshev_U, HermitePolynomials, LaguerrePolynomials)
+class OrthoRecurrence {
+public:
+    /// polynomial families
+    enum family_t {
+        LEGENDRE,       ///< Legendre P_n
+        CHEBYSHEV_T,    ///< Chebyshev first kind T_n
+        CHEBYSHEV_U,    ///< Chebyshev second kind U_n
+        HERMITE,        ///< (physicists') Hermite H_n
+        LAGUERRE        ///< Laguerre L_n
+    };
+
+    /// Constructor, caching coefficients for series through order nmax
+    explicit OrthoRecurrence(family_t f, size_t nmax = 64);
+
+    /// polynomial family
+    const family_t family;
+    /// extend coefficient tables through order n (not thread-safe; evaluations require maxOrder() >= order)
+    void reserve(size_t n);
+    /// maximum order with cached coefficients
+    size_t maxOrder() const { return A.size(); }
+
+    /// evaluate p_n(x)
+    double operator()(size_t n, double x) const;
+    /// evaluate p_0(x) ... p_{n-1}(x) into p[n]
+    void evalAll(double x, double* p, size_t n) const;
+    /// basis matrix M[i*nc + k] = p_k(x[i]) for n points, k < nc (as for linear least-squares series fits)
+    void basis(const double* x, size_t n, size_t nc, double* M) const;
+
+    /// series \f$\sum_{k<nc} c_k p_k(x)\f$ by Clenshaw recurrence
+    double series(const double* c, size_t nc, double x) const;
+    /// series evaluated at n points x[n] into y[n], vectorized across blocks of points
+    void series(const double* c, size_t nc, const double* x, double* y, size_t n) const;
+
+    static constexpr size_t block = 256;    ///< points per evaluation block
+
+protected:
+    /// check cached order
+    void checkOrder(size_t nc) const;
+
+    vector<double> A;   ///< x coefficient A_n
+    vector<double> B;   ///< constant coefficient B_n
+    vector<double> C;   ///< previous-term coefficient C_n
+};
+
+#endif
@@ -67,18 +67,21 @@ public:
     /// out-of-place division
     constexpr Permutation operator/(const Permutation& P) const { auto p = *this; return p /= P; }
 
+    /// sub-permutation type for recursive enumeration (N > 1)
+    typedef Permutation<(N > 1? N-1 : 1), idx_t> nsub_t;
+
     /// enumeration index for permutation
     static _constexpr enum_t idx(const Permutation& e) {
         if(N<2) return 0;
 
-        array<idx_t, N-1> e0{};
+        array<idx_t, (N > 1? N-1 : 1)> e0{};
         size_t i = 0;
         size_t j = N;
         for(auto& c: e0) {
             c = e[i++];
             if(c == N-1) j = c = e[N-1];
         }
-        return Permutation<N-1, idx_t>(e0).idx() + (j < N? j+1 : 0)*factorial(N-1);
+        return nsub_t(e0).idx() + (j < N? j+1 : 0)*factorial(N-1);
     }
     /// index of permutation object
     constexpr enum_t idx() const { return idx(*this); }
@@ -91,7 +94,7 @@ public:
         auto nsub = factorial(N-1);
         auto j = i/nsub;
         if(j) p.swap(j-1, N-1);
-        return Permutation<N-1>::element(i%nsub) * p;
+        return nsub_t::element(i%nsub) * p;
     }
 
     /// calculate element cycles
@@ -160,7 +163,7 @@ protected:
     /// mutable element access
     _constexpr idx_t& operator[](size_t i) { return ((super&)*this)[i]; }
 
-    friend class Permutation<N-1>; // for applying sub-permutation
+    friend class Permutation<N-1, idx_t>; // for applying sub-permutation
 };
 /// Null permutation special case, in case not optimized out
 template<>
@@ -183,7 +186,7 @@ public:
     /// Number of elements
     static constexpr size_t order = factorial(N);
     /// Permutation representation
-    typedef Permutation<N> elem_t;
+    typedef Permutation<N, idx_t> elem_t;
 
     /// group order
     static constexpr size_t getOrder() { return order; }
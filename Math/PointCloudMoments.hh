@@ -0,0 +1,157 @@
+/// \file PointCloudMoments.hh Streaming, mergeable moments and principal components for small fixed-dimension weighted point clouds
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef POINTCLOUDMOMENTS_HH
+#define POINTCLOUDMOMENTS_HH
+
+#include "Matrix.hh"
+#include <array>
+using std::array;
+#include <vector>
+using std::vector;
+#include <cstddef> // for size_t
+#include <stdio.h>
+
+/// point with weight in point cloud
+template<size_t N, typename T = double, typename W = double>
+struct weightedpt: public array<T, N> {
+    /// dimensionality
+    static constexpr size_t NDIM = N;
+    /// coordinate component
+    typedef T component_t;
+    /// coordinate
+    typedef array<component_t, NDIM> coord_t;
+    /// point weight
+    typedef W weight_t;
+
+    /// Default zero constructor
+    weightedpt(): coord_t{{}}, w{} { }
+    /// Weights-only constructor
+    explicit weightedpt(weight_t ww): coord_t{{}}, w(ww) { }
+    /// Constructor with coordinate and weight
+    explicit weightedpt(const coord_t& x, weight_t ww = weight_t(1)): coord_t(x), w(ww) { }
+
+    int i = 0;  ///< origin index
+    weight_t w; ///< weight
+};
+
+/// Single-pass weighted mean and scatter accumulation, with PCA by fixed-size Jacobi eigendecomposition (same layout as WPtsPCA, without ROOT)
+/// add() and += update moments only; call calcPrincipalComponents() before using PCA, width2
+template<class _wpt>
+class WPtsMoments {
+public:
+    /// associated weighted-point type
+    typedef _wpt wpt_t;
+    /// weight units shortcut
+    typedef typename wpt_t::weight_t weight_t;
+    /// component shortcut
+    typedef typename wpt_t::component_t component_t;
+    /// coordinate shortcut
+    typedef typename wpt_t::coord_t coord_t;
+    /// shortcut to dimensionality
+    static constexpr int N = wpt_t::NDIM;
+
+    // data
+    coord_t mu{{}};                     ///< mean center
+    array<array<double,N>,N> Cov{{}};   ///< (unnormalized) weighted scatter matrix sum w (x - mu)(x - mu)^T
+    array<array<double,N>,N> PCA{{}};   ///< orthogonal principal components vectors in PCA[i], largest to smallest
+    array<double,N> width2{{}};         ///< spread along principal directions (eigenvalues of Cov), largest to smallest
+    size_t n = 0;                       ///< number of points
+    weight_t sw{};                      ///< sum of weights
+
+    /// Default constructor
+    WPtsMoments() { }
+    /// Constructor, calculated from points
+    explicit WPtsMoments(const vector<wpt_t>& v) {
+        for(auto& p: v) add(p);
+        calcPrincipalComponents();
+    }
+
+    /// add point with weight
+    void add(const coord_t& x, weight_t w = weight_t(1)) {
+        ++n;
+        if(!w) return;
+        auto sw0 = sw;
+        sw += w;
+        array<double,N> d;
+        for(int j = 0; j < N; ++j) {
+            d[j] = x[j] - mu[j];
+            mu[j] += d[j]*(w/sw);
+        }
+        const double c = double(w)*double(sw0)/double(sw);
+        for(int i = 0; i < N; ++i)
+            for(int j = 0; j <= i; ++j)
+                Cov[j][i] = (Cov[i][j] += c*d[i]*d[j]);
+    }
+    /// add weighted point
+    void add(const wpt_t& p) { add(p, p.w); }
+    /// add weighted point
+    WPtsMoments& operator+=(const wpt_t& p) { add(p); return *this; }
+
+    /// merge moments from another point cloud
+    WPtsMoments& operator+=(const WPtsMoments& P) {
+        if(!P.sw) { n += P.n; return *this; }
+        if(!sw) { auto n0 = n; *this = P; n += n0; return *this; }
+
+        auto sw1 = sw + P.sw;
+        const double c = double(sw)*double(P.sw)/double(sw1);
+        for(int i = 0; i < N; ++i)
+            for(int j = 0; j < N; ++j)
+                Cov[i][j] += P.Cov[i][j] + (mu[i] - P.mu[i])*(mu[j] - P.mu[j])*c;
+        for(int j = 0; j < N; ++j) mu[j] = (mu[j]*sw + P.mu[j]*P.sw)/sw1;
+        sw = sw1;
+        n += P.n;
+        return *this;
+    }
+    /// out-of-place sum
+    const WPtsMoments operator+(const WPtsMoments& P) const { auto PP = *this; PP += P; return PP; }
+
+    /// calculate PCA, width2 from Cov
+    void calcPrincipalComponents() {
+        Matrix<N,N,double> M;
+        for(int i = 0; i < N; ++i) for(int j = 0; j < N; ++j) M(i,j) = Cov[i][j];
+        const SymmEigen<N,double> E(M);
+        for(int i = 0; i < N; ++i) {
+            width2[i] = E.l[i] > 0? E.l[i] : 0.; // fix negative values rounding error near 0
+            for(int j = 0; j < N; ++j) PCA[i][j] = E.U(j,i);
+        }
+    }
+
+    /// mean square spread along principal components direction
+    inline double sigma2(int a) const { return sw? width2[a]/sw : 0.; }
+    /// rms spread along principal components direction
+    inline double sigma(int a) const { return sqrt(sigma2(a)); }
+    /// transverse width^2 from principal axis
+    inline double wT2() const { double s = 0; for(int i = 1; i<N; ++i) s += width2[i]; return s; }
+    /// transverse spread^2 from principal axis
+    inline double sigmaT2() const { return sw? wT2()/sw : 0.; }
+    /// transverse spread from principal axis
+    inline double sigmaT() const { return sqrt(sigmaT2()); }
+    /// coordinate along principal axis
+    inline coord_t principal_coord(double u) const {
+        auto x = mu;
+        for(int i = 0; i<N; ++i) x[i] += PCA[0][i] * u;
+        return x;
+    }
+
+    /// reverse direction
+    void flip() { for(int i = 0; i<N-1; ++i) for(int j = 0; j<N; ++j) PCA[i][j] *= -1; }
+
+    /// print summary to stdout
+    void display() const {
+        printf("Cloud of %zu points (total weight %g, average %g):\n", n, double(sw), n? sw/n : 0);
+        for(int i = 0; i < N; ++i) {
+            printf("\tmu = %g\tsigma = %g\t|", double(mu[i]), sigma(i));
+            for(int j = 0; j < N; ++j) printf("\t%g", Cov[i][j]);
+            printf("\t|");
+            for(int j = 0; j < N; ++j) printf("\t%g", PCA[i][j]);
+            printf("\n");
+        }
+    }
+};
+
+/// Shortcut type definition
+template <size_t N, typename T = double, typename W = double>
+using PointCloudMoments = WPtsMoments<weightedpt<N,T,W>>;
+
+#endif
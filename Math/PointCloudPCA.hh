@@ -4,43 +4,15 @@
 #ifndef POINTCLOUDPCA_HH
 #define POINTCLOUDPCA_HH
 
+#include "PointCloudMoments.hh"
 #include <stdexcept>
-#include <vector>
-using std::vector;
-#include <cstddef> // for size_t
-#include <stdio.h>
 #include <cmath>
-#include <array>
-using std::array;
 
 #include <TMatrixD.h>
 #include <TMatrixDSym.h>
 #include <TMatrixDSymEigen.h>
 
-/// point with weight in point cloud
-template<size_t N, typename T = double, typename W = double>
-struct weightedpt: public array<T, N> {
-    /// dimensionality
-    static constexpr size_t NDIM = N;
-    /// coordinate component
-    typedef T component_t;
-    /// coordinate
-    typedef array<component_t, NDIM> coord_t;
-    /// point weight
-    typedef W weight_t;
-
-    /// Default zero constructor
-    weightedpt(): coord_t{{}}, w{} { }
-    /// Weights-only constructor
-    explicit weightedpt(weight_t ww): coord_t{{}}, w(ww) { }
-    /// Constructor with coordinate and weight
-    explicit weightedpt(const coord_t& x, weight_t ww = weight_t(1)): coord_t(x), w(ww) { }
-
-    int i = 0;  ///< origin index
-    weight_t w; ///< weight
-};
-
-/// PCA calculation
+/// PCA calculation (by ROOT matrices; see PointCloudMoments.hh for fixed-size streaming version)
 template<class _wpt>
 class WPtsPCA {
 public:
@@ -0,0 +1,110 @@
+/// \file PointKDTree.cc
+
+#include "PointKDTree.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+#include <stdexcept>
+
+void PointKDTree::build(const vector<const float*>& x, size_t npts) {
+    clear();
+    if(leafsize < 1 || leafsize > MAX_LEAF) throw std::logic_error("Invalid PointKDTree leaf size");
+    if(npts >= INT32_MAX) throw std::runtime_error("Too many points for PointKDTree");
+    N_DIM = x.size();
+    if(!N_DIM || !npts) return;
+
+    perm.resize(npts);
+    std::iota(perm.begin(), perm.end(), 0);
+    coords.resize(npts * N_DIM);
+    nodes.reserve(4*npts/leafsize + 1);
+    buildNode(x, 0, npts);
+}
+
+void PointKDTree::buildNode(const vector<const float*>& x, uint32_t i0, uint32_t i1) {
+    auto nn = nodes.size();
+    nodes.push_back({-1, 0, i0, i1});
+
+    if(i1 - i0 <= leafsize) { // leaf: copy dimension-major coordinate block
+        auto m = i1 - i0;
+        auto c = coords.data() + size_t(i0) * N_DIM;
+        for(size_t a = 0; a < N_DIM; ++a)
+            for(uint32_t k = 0; k < m; ++k) c[a*m + k] = x[a][perm[i0 + k]];
+        return;
+    }
+
+    // median split on axis of largest spread (ties on either side are fine for search bounds)
+    int ax = 0;
+    float w = -1;
+    for(size_t a = 0; a < N_DIM; ++a) {
+        auto r = std::minmax_element(perm.begin() + i0, perm.begin() + i1,
+                                     [&](int i, int j) { return x[a][i] < x[a][j]; });
+        auto wa = x[a][*r.second] - x[a][*r.first];
+        if(wa > w) { w = wa; ax = a; }
+    }
+
+    auto im = i0 + (i1 - i0)/2;
+    std::nth_element(perm.begin() + i0, perm.begin() + im, perm.begin() + i1,
+                     [&](int i, int j) { return x[ax][i] < x[ax][j]; });
+    nodes[nn].axis = ax;
+    nodes[nn].split = x[ax][perm[im]];
+    buildNode(x, i0, im);
+    nodes[nn].a = nodes.size();
+    buildNode(x, im, i1);
+}
+
+void PointKDTree::search(uint32_t n, const float* x, float& best, int& ibest) const {
+    while(true) {
+        auto& N = nodes[n];
+        if(N.axis < 0) break;
+        auto d = x[N.axis] - N.split;
+        uint32_t near = d < 0? n + 1 : N.a;
+        uint32_t far = d < 0? N.a : n + 1;
+        search(near, x, best, ibest);
+        if(d*d >= best) return;
+        n = far;
+    }
+
+    // leaf scan: accumulate squared distances dimension by dimension
+    auto& N = nodes[n];
+    const uint32_t m = N.b - N.a;
+    const float* c = coords.data() + size_t(N.a) * N_DIM;
+    float d2[MAX_LEAF];
+    std::fill(d2, d2 + m, 0.f);
+    for(size_t a = 0; a < N_DIM; ++a) {
+        const float xa = x[a];
+        const float* __restrict__ ca = c + a*m;
+        for(uint32_t k = 0; k < m; ++k) {
+            float dx = ca[k] - xa;
+            d2[k] += dx*dx;
+        }
+    }
+    for(uint32_t k = 0; k < m; ++k) {
+        if(d2[k] < best) {
+            best = d2[k];
+            ibest = perm[N.a + k];
+        }
+    }
+}
+
+int PointKDTree::nearest(const float* x, float* d2) const {
+    float best = FLT_MAX;
+    int ibest = -1;
+    if(nodes.size()) search(0, x, best, ibest);
+    if(d2) *d2 = best;
+    return ibest;
+}
+
+void PointKDTree::nearest(const float* xs, size_t n, int* idx, int nthreads) const {
+    if(nthreads == 1 || n <= batch_chunk) {
+        for(size_t i = 0; i < n; ++i) idx[i] = nearest(xs + i*N_DIM);
+        return;
+    }
+
+    WorkStealingPool P(nthreads);
+    for(size_t i0 = 0; i0 < n; i0 += batch_chunk) {
+        auto i1 = std::min(n, i0 + batch_chunk);
+        P.submit([this, xs, idx, i0, i1] { for(size_t i = i0; i < i1; ++i) idx[i] = nearest(xs + i*N_DIM); });
+    }
+    P.wait_idle();
+}
@@ -0,0 +1,59 @@
+/// \file PointKDTree.hh Flat nearest-neighbor kd-tree over float points, with vectorized leaf scans and batched queries
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef POINTKDTREE_HH
+#define POINTKDTREE_HH
+
+#include <vector>
+using std::vector;
+#include <stdint.h>
+#include <stdlib.h>
+
+/// Flat (array-of-nodes) kd-tree for nearest-neighbor lookup;
+/// leaf buckets are stored contiguously, dimension-major, so distance evaluation over a bucket vectorizes
+class PointKDTree {
+public:
+    /// maximum points per leaf
+    static constexpr unsigned int MAX_LEAF = 64;
+
+    /// build from dimension-major coordinate arrays x[a][0...npts-1]
+    void build(const vector<const float*>& x, size_t npts);
+    /// clear tree
+    void clear() { nodes.clear(); coords.clear(); perm.clear(); N_DIM = 0; }
+
+    /// index of point nearest x[nDim()]; -1 if empty. Optionally return squared distance.
+    int nearest(const float* x, float* d2 = nullptr) const;
+    /// batched nearest-point indices idx[n] for n point-major points xs[n*nDim()], optionally on nthreads (0 for hardware) pool threads
+    void nearest(const float* xs, size_t n, int* idx, int nthreads = 1) const;
+
+    /// number of dimensions
+    size_t nDim() const { return N_DIM; }
+    /// number of points
+    size_t nPts() const { return perm.size(); }
+    /// number of tree nodes
+    size_t nNodes() const { return nodes.size(); }
+
+    unsigned int leafsize = 16;     ///< target points per leaf (<= MAX_LEAF)
+    size_t batch_chunk = 4096;      ///< queries per pool task in batched lookup
+
+protected:
+    /// tree node: leaf if axis < 0
+    struct node_t {
+        int axis;       ///< split axis; -1 for leaf
+        float split;    ///< split position (low side < split <= high side)
+        uint32_t a;     ///< leaf: first point; inner: high-side child (low side is next node)
+        uint32_t b;     ///< leaf: one past last point
+    };
+
+    /// recursively build node over perm[i0, i1)
+    void buildNode(const vector<const float*>& x, uint32_t i0, uint32_t i1);
+    /// recursive search for nearest point
+    void search(uint32_t n, const float* x, float& best, int& ibest) const;
+
+    size_t N_DIM = 0;       ///< number of dimensions
+    vector<node_t> nodes;   ///< depth-first node array
+    vector<float> coords;   ///< leaf coordinates, dimension-major within each leaf block
+    vector<int> perm;       ///< original point index for each tree-ordered point
+};
+
+#endif
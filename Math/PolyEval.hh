@@ -23,6 +23,7 @@
 #define POLYEVAL_HH
 
 #include "PowerSeriesEval.hh"
+#include "PolyProgram.hh"
 #include "Abstract.hh"
 
 /// Fast vectorized evaluation of polynomials at many points
@@ -77,6 +78,15 @@ public:
     template<class P>
     void evalPolynomial(const P& p, vector<T>& v) { v.clear(); addPolynomial(p,v); }
 
+    /// Evaluate compiled polynomial into vector, optionally on nthreads (0 for hardware) pool threads
+    void evalProgram(const PolyProgram<T>& p, vector<T>& v, int nthreads = 1) const {
+        vector<const T*> x(p.nVars());
+        for(auto& kv: Xd) if(size_t(kv.first) < x.size()) x[kv.first] = kv.second.Xs.data();
+        for(auto c: x) if(!c) throw std::logic_error("Missing coordinates for PolyProgram evaluation");
+        v.resize(npts);
+        p.eval(x, npts, v.data(), nthreads);
+    }
+
 
 protected:
     size_t npts = 0;                    ///< number of evaluation points
@@ -0,0 +1,205 @@
+/// \file PolyProgram.hh Polynomials compiled to flat multivariate-Horner programs, for fast blocked evaluation over many points
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef POLYPROGRAM_HH
+#define POLYPROGRAM_HH
+
+#include "WorkStealingPool.hh"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+using std::vector;
+
+/// Polynomial lowered once into multivariate Horner form, evaluated block-wise over dimension-major (SoA) point arrays
+/**
+    P = P_0 + x_v (P_1 + x_v (P_2 + ...)) recursively in the lowest-numbered remaining variable v,
+    flattened to a stack-machine program; each instruction is a contiguous loop over a block of points (compiler-vectorized).
+*/
+template<typename T = double>
+class PolyProgram {
+public:
+    /// Default constructor (zero polynomial)
+    PolyProgram() { }
+    /// Constructor, compiling polynomial
+    template<class P>
+    explicit PolyProgram(const P& p) { compile(p); }
+
+    /// compile from polynomial (map of semigroup monomials with standard-form get() to coefficients)
+    template<class P>
+    void compile(const P& p) {
+        vector<term_t> ts;
+        for(auto& kv: p) {
+            ts.emplace_back();
+            ts.back().c = kv.second;
+            for(auto& g: kv.first.get()) {
+                int e = g.second;
+                if(e < 0) throw std::logic_error("PolyProgram requires non-negative exponents");
+                if(e) ts.back().m.emplace_back(g.first, e);
+            }
+            std::sort(ts.back().m.begin(), ts.back().m.end());
+        }
+        compile(ts);
+    }
+
+    /// number of variables (highest variable index + 1)
+    size_t nVars() const { return NV; }
+    /// number of program instructions
+    size_t size() const { return prog.size(); }
+
+    /// evaluate at n points with coordinates x[variable][0...n), into y[n], optionally on nthreads (0 for hardware) pool threads
+    void eval(const vector<const T*>& x, size_t n, T* y, int nthreads = 1) const {
+        if(x.size() < NV) throw std::logic_error("Missing PolyProgram evaluation variables");
+        if(nthreads == 1 || n <= thread_chunk) {
+            evalRange(x.data(), 0, n, y);
+            return;
+        }
+        WorkStealingPool P(std::max(nthreads, 0));
+        for(size_t j0 = 0; j0 < n; j0 += thread_chunk) {
+            auto j1 = std::min(n, j0 + thread_chunk);
+            P.submit([this, &x, j0, j1, y] { evalRange(x.data(), j0, j1, y); });
+        }
+        P.wait_idle();
+    }
+
+    /// evaluate at single point x[nVars()]
+    template<typename coord>
+    T operator()(const coord& v) const {
+        vector<T> xs(NV);
+        vector<const T*> x(NV);
+        for(size_t i = 0; i < NV; ++i) { xs[i] = v[i]; x[i] = &xs[i]; }
+        T y;
+        evalRange(x.data(), 0, 1, &y);
+        return y;
+    }
+
+    static constexpr size_t block = 256;    ///< points per evaluation block
+    size_t thread_chunk = 1 << 16;          ///< points per pool task in threaded evaluation
+
+protected:
+    /// monomial term
+    struct term_t {
+        vector<std::pair<size_t, int>> m;   ///< sorted (variable, exponent > 0)
+        T c{};                              ///< coefficient
+    };
+
+    /// program instruction opcodes
+    enum opcode_t {
+        PUSHC,      ///< push constant c
+        MULX,       ///< top *= x_v
+        MULXADDC,   ///< top = top * x_v + c
+        ADD         ///< pop; top += popped
+    };
+
+    /// program instruction
+    struct instr_t {
+        opcode_t op;    ///< operation
+        size_t v;       ///< variable
+        T c;            ///< constant
+    };
+
+    /// compile terms list
+    void compile(const vector<term_t>& ts) {
+        prog.clear();
+        NV = 0;
+        for(auto& t: ts) if(t.m.size()) NV = std::max(NV, t.m.back().first + 1);
+        emit(ts);
+
+        // stack depth
+        size_t d = 0;
+        depth = 0;
+        for(auto& i: prog) {
+            if(i.op == PUSHC) depth = std::max(depth, ++d);
+            else if(i.op == ADD) --d;
+        }
+    }
+
+    /// emit program pushing value of terms sum
+    void emit(const vector<term_t>& ts) {
+        // lowest variable remaining; constant if none
+        size_t v = size_t(-1);
+        T c0{};
+        for(auto& t: ts) {
+            if(t.m.size()) v = std::min(v, t.m[0].first);
+            else c0 += t.c;
+        }
+        if(v == size_t(-1)) {
+            prog.push_back({PUSHC, 0, c0});
+            return;
+        }
+
+        // group by exponent of v, removing v
+        std::map<int, vector<term_t>> g;
+        for(auto& t: ts) {
+            int e = 0;
+            auto tt = t;
+            if(tt.m.size() && tt.m[0].first == v) {
+                e = tt.m[0].second;
+                tt.m.erase(tt.m.begin());
+            }
+            g[e].push_back(tt);
+        }
+
+        // Horner in v, from highest power
+        auto it = g.rbegin();
+        int e = it->first;
+        emit(it->second);
+        while(e > 0) {
+            --e;
+            auto jt = g.find(e);
+            if(jt == g.end()) { prog.push_back({MULX, v, T{}}); continue; }
+            bool isconst = true;
+            T c{};
+            for(auto& t: jt->second) {
+                if(t.m.size()) { isconst = false; break; }
+                c += t.c;
+            }
+            if(isconst) prog.push_back({MULXADDC, v, c});
+            else {
+                prog.push_back({MULX, v, T{}});
+                emit(jt->second);
+                prog.push_back({ADD, 0, T{}});
+            }
+        }
+    }
+
+    /// evaluate points [j0, j1) by blocks
+    void evalRange(const T* const* x, size_t j0, size_t j1, T* y) const {
+        vector<T> stk(std::max(depth, size_t(1))*block);
+        for(; j0 < j1; j0 += block) {
+            const size_t m = std::min(block, j1 - j0);
+            size_t sp = 0;  // stack size
+            for(auto& i: prog) {
+                if(i.op == PUSHC) {
+                    T* __restrict__ s = stk.data() + block*sp++;
+                    for(size_t k = 0; k < m; ++k) s[k] = i.c;
+                    continue;
+                }
+                if(i.op == ADD) {
+                    const T* __restrict__ s1 = stk.data() + block*--sp;
+                    T* __restrict__ s = stk.data() + block*(sp - 1);
+                    for(size_t k = 0; k < m; ++k) s[k] += s1[k];
+                    continue;
+                }
+                T* __restrict__ s = stk.data() + block*(sp - 1);
+                const T* __restrict__ xv = x[i.v] + j0;
+                if(i.op == MULX) for(size_t k = 0; k < m; ++k) s[k] *= xv[k];
+                else {
+                    const T c = i.c;
+                    for(size_t k = 0; k < m; ++k) s[k] = s[k]*xv[k] + c;
+                }
+            }
+            std::copy(stk.data(), stk.data() + m, y + j0);
+        }
+    }
+
+    vector<instr_t> prog;   ///< compiled program
+    size_t NV = 0;          ///< number of variables
+    size_t depth = 0;       ///< evaluation stack depth
+};
+
+template<typename T>
+constexpr size_t PolyProgram<T>::block;
+
+#endif
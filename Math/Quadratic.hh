@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <cmath>
 #include "LinalgHelpers.hh"
+#include "QuadraticBatch.hh"
 
 /// Coefficients for multivariate quadratic x^T A x + b.x + c
 class Quadratic {
@@ -86,6 +87,21 @@ public:
         return s;
     }
 
+    /// evaluate at npts points (rows of X, stride ldx >= N or 0 for N) into y
+    void evalBatch(const double* X, size_t npts, double* y, size_t ldx = 0) const {
+        quadratic_eval_batch(N, A.data(), b.data(), c, X, npts, y, ldx? ldx : N);
+    }
+    /// evaluate quadratic form component only at npts points into y
+    void xTAxBatch(const double* X, size_t npts, double* y, size_t ldx = 0) const {
+        quadratic_eval_batch(N, A.data(), (const double*)nullptr, 0., X, npts, y, ldx? ldx : N);
+    }
+    /// evaluate gradient at npts points into rows of G (stride ldg >= N or 0 for N)
+    void gradientBatch(const double* X, size_t npts, double* G, size_t ldx = 0, size_t ldg = 0) const {
+        quadratic_gradient_batch(N, A.data(), b.data(), X, npts, G, ldx? ldx : N, ldg? ldg : N);
+    }
+    /// fill full symmetric N x N row-major Hessian (independent of position)
+    void hessian(double* H, size_t ldh = 0) const { quadratic_hessian(N, A.data(), H, ldh? ldh : N); }
+
     /// display contents
     void display() const {
         int n = 0;
@@ -131,6 +147,10 @@ public:
         for(size_t i=0; i<N0; i++) t[n++] = v[i];
         t[n] = 1;
     }
+    /// evaluate terms for npts N-dimensional points into rows of T (stride ldt >= nterms(N) or 0 for nterms(N))
+    static void evalTermsBatch(size_t N0, const double* X, size_t npts, double* T, size_t ldx = 0, size_t ldt = 0) {
+        quadratic_terms_batch(N0, X, npts, T, ldx? ldx : N0, ldt? ldt : nterms(N0));
+    }
 };
 
 
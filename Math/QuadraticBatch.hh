@@ -0,0 +1,122 @@
+/// \file QuadraticBatch.hh Batched evaluation of packed lower-triangular quadratic forms over point arrays
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef QUADRATICBATCH_HH
+#define QUADRATICBATCH_HH
+
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+/*
+    Coefficients in Quadratic/QuadraticT layout: x^T A x + b.x + c,
+    A packed lower-triangular x*x, y*x, y*y, z*x, z*y, z*z, ...
+    Points are npts rows of N coordinates (row stride ldx >= N).
+
+    Kernels transpose blocks of QBATCH_BLOCK points into coordinate-major
+    workspace, so inner loops run across points in contiguous, vectorizable
+    strides; each block is a packed symmetric matrix-vector product.
+*/
+
+/// points per transposed block
+static constexpr size_t QBATCH_BLOCK = 64;
+
+/// copy points [k0, k0 + nb) into coordinate-major block xt[i*QBATCH_BLOCK + k], zero-padding to full block
+template<typename T>
+inline void quadratic_block_transpose(size_t N, const T* X, size_t ldx, size_t k0, size_t nb, T* xt) {
+    for(size_t k = 0; k < nb; ++k) {
+        const T* x = X + (k0 + k)*ldx;
+        for(size_t i = 0; i < N; ++i) xt[i*QBATCH_BLOCK + k] = x[i];
+    }
+    for(size_t i = 0; i < N; ++i) for(size_t k = nb; k < QBATCH_BLOCK; ++k) xt[i*QBATCH_BLOCK + k] = 0;
+}
+
+/// evaluate fit terms (Quadratic::evalTerms order) for npts points, into rows of T (stride ldt >= nterms)
+template<typename T>
+void quadratic_terms_batch(size_t N, const T* X, size_t npts, T* Tm, size_t ldx, size_t ldt) {
+    for(size_t k = 0; k < npts; ++k) {
+        const T* x = X + k*ldx;
+        T* t = Tm + k*ldt;
+        for(size_t i = 0; i < N; ++i) {
+            const T xi = x[i];
+            for(size_t j = 0; j <= i; ++j) *(t++) = xi*x[j];
+        }
+        for(size_t i = 0; i < N; ++i) *(t++) = x[i];
+        *t = 1;
+    }
+}
+
+/// evaluate x^T A x + b.x + c at npts points into y; b = nullptr for quadratic form only
+template<typename T>
+void quadratic_eval_batch(size_t N, const T* A, const T* b, T c, const T* X, size_t npts, T* y, size_t ldx) {
+    std::vector<T> xt(N*QBATCH_BLOCK);
+    for(size_t k0 = 0; k0 < npts; k0 += QBATCH_BLOCK) {
+        const size_t nb = std::min(QBATCH_BLOCK, npts - k0);
+        quadratic_block_transpose(N, X, ldx, k0, nb, xt.data());
+        T s[QBATCH_BLOCK];
+        T r[QBATCH_BLOCK];
+        for(size_t k = 0; k < QBATCH_BLOCK; ++k) s[k] = c;
+
+        const T* a = A;
+        for(size_t i = 0; i < N; ++i) {
+            // r = b_i + sum_{j <= i} A_ij x_j;  s += x_i r
+            const T bi = b? b[i] : T(0);
+            for(size_t k = 0; k < QBATCH_BLOCK; ++k) r[k] = bi;
+            for(size_t j = 0; j <= i; ++j) {
+                const T aij = *(a++);
+                const T* xj = xt.data() + j*QBATCH_BLOCK;
+                for(size_t k = 0; k < QBATCH_BLOCK; ++k) r[k] += aij*xj[k];
+            }
+            const T* xi = xt.data() + i*QBATCH_BLOCK;
+            for(size_t k = 0; k < QBATCH_BLOCK; ++k) s[k] += xi[k]*r[k];
+        }
+        std::copy(s, s + nb, y + k0);
+    }
+}
+
+/// evaluate gradients 2 A_sym x + b at npts points into rows of G (stride ldg >= N)
+template<typename T>
+void quadratic_gradient_batch(size_t N, const T* A, const T* b, const T* X, size_t npts, T* G, size_t ldx, size_t ldg) {
+    std::vector<T> xt(N*QBATCH_BLOCK);
+    std::vector<T> gt(N*QBATCH_BLOCK);
+    for(size_t k0 = 0; k0 < npts; k0 += QBATCH_BLOCK) {
+        const size_t nb = std::min(QBATCH_BLOCK, npts - k0);
+        quadratic_block_transpose(N, X, ldx, k0, nb, xt.data());
+        for(size_t i = 0; i < N; ++i) {
+            T* gi = gt.data() + i*QBATCH_BLOCK;
+            const T bi = b? b[i] : T(0);
+            for(size_t k = 0; k < QBATCH_BLOCK; ++k) gi[k] = bi;
+        }
+
+        const T* a = A;
+        for(size_t i = 0; i < N; ++i) {
+            const T* xi = xt.data() + i*QBATCH_BLOCK;
+            T* gi = gt.data() + i*QBATCH_BLOCK;
+            for(size_t j = 0; j < i; ++j) {
+                // off-diagonal A_ij x_i x_j term
+                const T aij = *(a++);
+                const T* xj = xt.data() + j*QBATCH_BLOCK;
+                T* gj = gt.data() + j*QBATCH_BLOCK;
+                for(size_t k = 0; k < QBATCH_BLOCK; ++k) { gi[k] += aij*xj[k]; gj[k] += aij*xi[k]; }
+            }
+            const T aii = 2*(*(a++));
+            for(size_t k = 0; k < QBATCH_BLOCK; ++k) gi[k] += aii*xi[k];
+        }
+
+        for(size_t k = 0; k < nb; ++k) {
+            T* g = G + (k0 + k)*ldg;
+            for(size_t i = 0; i < N; ++i) g[i] = gt[i*QBATCH_BLOCK + k];
+        }
+    }
+}
+
+/// fill full symmetric N x N row-major Hessian (same at every point) from packed A
+template<typename T>
+void quadratic_hessian(size_t N, const T* A, T* H, size_t ldh) {
+    for(size_t i = 0; i < N; ++i) {
+        for(size_t j = 0; j < i; ++j) H[i*ldh + j] = H[j*ldh + i] = *(A++);
+        H[i*ldh + i] = 2*(*(A++));
+    }
+}
+
+#endif
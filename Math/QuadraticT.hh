@@ -3,6 +3,7 @@
 #ifndef QUADRATICT_HH
 #define QUADRATICT_HH
 
+#include "QuadraticBatch.hh"
 #include <array>
 using std::array;
 
@@ -82,6 +83,21 @@ public:
         return s;
     }
 
+    /// evaluate at npts points (rows of X, stride ldx >= N or 0 for N) into y
+    void evalBatch(const T* X, size_t npts, T* y, size_t ldx = 0) const {
+        quadratic_eval_batch(N, A.data(), b.data(), c, X, npts, y, ldx? ldx : N);
+    }
+    /// evaluate quadratic form component only at npts points into y
+    void xTAxBatch(const T* X, size_t npts, T* y, size_t ldx = 0) const {
+        quadratic_eval_batch(N, A.data(), (const T*)nullptr, T(0), X, npts, y, ldx? ldx : N);
+    }
+    /// evaluate gradient at npts points into rows of G (stride ldg >= N or 0 for N)
+    void gradientBatch(const T* X, size_t npts, T* G, size_t ldx = 0, size_t ldg = 0) const {
+        quadratic_gradient_batch(N, A.data(), b.data(), X, npts, G, ldx? ldx : N, ldg? ldg : N);
+    }
+    /// fill full symmetric N x N row-major Hessian (independent of position)
+    void hessian(T* H, size_t ldh = 0) const { quadratic_hessian(N, A.data(), H, ldh? ldh : N); }
+
     /// display contents
     void display() const {
         int n = 0;
@@ -125,6 +141,10 @@ public:
         for(size_t i=0; i<N; i++) t[n++] = v[i];
         t[n] = 1;
     }
+    /// evaluate terms for npts points into rows of Tm (stride ldt >= NTERMS or 0 for NTERMS)
+    static void evalTermsBatch(const T* X, size_t npts, T* Tm, size_t ldx = 0, size_t ldt = 0) {
+        quadratic_terms_batch(N, X, npts, Tm, ldx? ldx : N, ldt? ldt : NTERMS);
+    }
 };
 
 #endif
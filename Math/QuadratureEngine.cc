@@ -0,0 +1,175 @@
+/// \file QuadratureEngine.cc
+
+#include "QuadratureEngine.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+/// lock on cached rules
+static std::mutex& rulesMut() { static std::mutex M; return M; }
+
+const QuadratureRule& QuadratureEngine::gaussLegendre(size_t n) {
+    if(!n) throw std::logic_error("Gauss-Legendre rule requires n > 0 points");
+
+    static std::map<size_t, QuadratureRule> rules;
+    std::lock_guard<std::mutex> L(rulesMut());
+    auto it = rules.find(n);
+    if(it != rules.end()) return it->second;
+
+    auto& R = rules[n];
+    R.x.resize(n);
+    R.w.resize(n);
+    // P_n(x) and derivative by recurrence
+    auto legendre = [n](double x, double& dp) {
+        double p0 = 1, p1 = x;
+        for(size_t j = 2; j <= n; ++j) {
+            double p2 = ((2*j - 1)*x*p1 - (j - 1)*p0)/j;
+            p0 = p1;
+            p1 = p2;
+        }
+        dp = n*(x*p1 - p0)/(x*x - 1);
+        return p1;
+    };
+    // roots by Newton iteration from asymptotic guesses, in symmetric pairs
+    for(size_t i = 0; i < (n + 1)/2; ++i) {
+        double x = cos(M_PI*(i + 0.75)/(n + 0.5));
+        double dp = 0;
+        for(int k = 0; k < 100; ++k) {
+            double dx = legendre(x, dp)/dp;
+            x -= dx;
+            if(fabs(dx) < 1e-16) break;
+        }
+        legendre(x, dp);
+        R.x[i] = -x;
+        R.x[n - 1 - i] = x;
+        R.w[i] = R.w[n - 1 - i] = 2/((1 - x*x)*dp*dp);
+    }
+    if(n % 2) R.x[n/2] = 0;
+    return R;
+}
+
+const QuadratureRule& QuadratureEngine::diskRule(size_t nr, size_t nt) {
+    if(!nt) throw std::logic_error("Disk rule requires nt > 0 angles");
+    const auto& G = gaussLegendre(nr);
+
+    static std::map<std::pair<size_t,size_t>, QuadratureRule> rules;
+    std::lock_guard<std::mutex> L(rulesMut());
+    auto it = rules.find({nr, nt});
+    if(it != rules.end()) return it->second;
+
+    auto& R = rules[{nr, nt}];
+    for(size_t i = 0; i < nr; ++i) {
+        // u = (2r)^2 uniform in area on [0,1]
+        double r = 0.5*sqrt(0.5*(G.x[i] + 1));
+        for(size_t j = 0; j < nt; ++j) {
+            double th = 2*M_PI*(j + 0.5*(i % 2))/nt;
+            R.x.push_back(r*cos(th));
+            R.y.push_back(r*sin(th));
+            R.w.push_back(0.5*G.w[i]/nt);
+        }
+    }
+    return R;
+}
+
+void QuadratureEngine::integrate(const integrand_t& f, double a, double b, double* I, vector<double>& xs, vector<double>& F) const {
+    const double c = 0.5*(a + b), h = 0.5*(b - a);
+    xs.resize(n);
+    F.resize(m*n);
+    for(size_t i = 0; i < n; ++i) xs[i] = c + h*GL.x[i];
+    f(xs.data(), n, F.data());
+    for(size_t j = 0; j < m; ++j) {
+        double s = 0;
+        const double* Fj = F.data() + j*n;
+        for(size_t i = 0; i < n; ++i) s += GL.w[i]*Fj[i];
+        I[j] = h*s;
+    }
+}
+
+void QuadratureEngine::integrate(const integrand_t& f, double a, double b, double* I) const {
+    vector<double> xs, F;
+    integrate(f, a, b, I, xs, F);
+}
+
+size_t QuadratureEngine::adaptive(const integrand_t& f, double a, double b, double* I,
+                                  double abstol, double reltol, int nthreads, size_t maxintervals) const {
+    /// interval with whole-interval estimate, halves estimates
+    struct segment_t {
+        double a, b;
+        vector<double> Iw, Il, Ir;
+    };
+
+    vector<segment_t> pending(1);
+    pending[0] = {a, b, vector<double>(m), vector<double>(m), vector<double>(m)};
+    integrate(f, a, b, pending[0].Iw.data());
+
+    vector<std::pair<double, vector<double>>> accepted;
+    vector<double> est(m), tol(m);
+    std::unique_ptr<WorkStealingPool> P;
+
+    while(pending.size()) {
+        // evaluate halves for all pending intervals
+        auto evalseg = [&](segment_t& s) {
+            vector<double> xs, F;
+            const double c = 0.5*(s.a + s.b);
+            integrate(f, s.a, c, s.Il.data(), xs, F);
+            integrate(f, c, s.b, s.Ir.data(), xs, F);
+        };
+        if(nthreads == 1 || pending.size() < 4) for(auto& s: pending) evalseg(s);
+        else {
+            if(!P) P.reset(new WorkStealingPool(std::max(nthreads, 0)));
+            for(auto& s: pending) P->submit([&evalseg, &s]() { evalseg(s); });
+            P->wait_idle();
+        }
+
+        // current total estimate, for relative tolerances
+        std::fill(est.begin(), est.end(), 0.);
+        for(auto& kv: accepted) for(size_t j = 0; j < m; ++j) est[j] += kv.second[j];
+        for(auto& s: pending) for(size_t j = 0; j < m; ++j) est[j] += s.Il[j] + s.Ir[j];
+        for(size_t j = 0; j < m; ++j) tol[j] = std::max(abstol, reltol*fabs(est[j]));
+
+        const bool force = accepted.size() + 2*pending.size() > maxintervals;
+        vector<segment_t> next;
+        for(auto& s: pending) {
+            const double frac = (s.b - s.a)/(b - a);
+            bool ok = true;
+            for(size_t j = 0; j < m && ok; ++j) ok = fabs(s.Il[j] + s.Ir[j] - s.Iw[j]) <= tol[j]*frac;
+            if(ok || force) {
+                for(size_t j = 0; j < m; ++j) s.Il[j] += s.Ir[j];
+                accepted.emplace_back(s.a, std::move(s.Il));
+            } else {
+                const double c = 0.5*(s.a + s.b);
+                next.push_back({s.a, c, std::move(s.Il), vector<double>(m), vector<double>(m)});
+                next.push_back({c, s.b, std::move(s.Ir), vector<double>(m), vector<double>(m)});
+            }
+        }
+        pending = std::move(next);
+    }
+
+    // deterministic summation order
+    std::sort(accepted.begin(), accepted.end(), [](const std::pair<double, vector<double>>& u, const std::pair<double, vector<double>>& v) { return u.first < v.first; });
+    std::fill(I, I + m, 0.);
+    for(auto& kv: accepted) for(size_t j = 0; j < m; ++j) I[j] += kv.second[j];
+    return accepted.size();
+}
+
+void QuadratureEngine::diskMean(const integrand2_t& f, double cx, double cy, double r, double* I, size_t nr, size_t nt) const {
+    const auto& D = diskRule(nr, nt);
+    const size_t nd = D.size();
+    vector<double> xs(nd), ys(nd), F(m*nd);
+    for(size_t i = 0; i < nd; ++i) {
+        xs[i] = cx + 2*r*D.x[i];
+        ys[i] = cy + 2*r*D.y[i];
+    }
+    f(xs.data(), ys.data(), nd, F.data());
+    for(size_t j = 0; j < m; ++j) {
+        double s = 0;
+        const double* Fj = F.data() + j*nd;
+        for(size_t i = 0; i < nd; ++i) s += D.w[i]*Fj[i];
+        I[j] = s;
+    }
+}
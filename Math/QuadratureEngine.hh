@@ -0,0 +1,65 @@
+/// \file QuadratureEngine.hh Cached-node Gauss-Legendre and disk quadrature for vector-valued integrands, with parallel adaptive subdivision
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef QUADRATUREENGINE_HH
+#define QUADRATUREENGINE_HH
+
+#include <functional>
+#include <stdlib.h> // for size_t
+#include <vector>
+using std::vector;
+
+/// Quadrature nodes x[i] (and y[i] for 2D rules), weights w[i]
+struct QuadratureRule {
+    vector<double> x;   ///< node x coordinates
+    vector<double> y;   ///< node y coordinates (2D rules)
+    vector<double> w;   ///< node weights
+    /// number of nodes
+    size_t size() const { return w.size(); }
+};
+
+/// Integration of m-component integrands at shared, cached quadrature nodes
+/**
+    Integrands evaluate all m components at a batch of n points into F[j*n + i] (component j, point i),
+    so one call at each node set serves many functions (e.g. shared-geometry detector response terms).
+    Rule tables are computed once per order and shared process-wide (thread-safe).
+*/
+class QuadratureEngine {
+public:
+    /// batch 1D integrand: (x[n], n, F[m*n])
+    typedef std::function<void(const double* x, size_t n, double* F)> integrand_t;
+    /// batch 2D integrand: (x[n], y[n], n, F[m*n])
+    typedef std::function<void(const double* x, const double* y, size_t n, double* F)> integrand2_t;
+
+    /// Constructor, for m components and n-point Gauss-Legendre rule
+    explicit QuadratureEngine(size_t _m = 1, size_t _n = 16): m(_m), n(_n), GL(gaussLegendre(_n)) { }
+
+    const size_t m; ///< number of integrand components
+    const size_t n; ///< Gauss-Legendre order
+
+    /// cached n-point Gauss-Legendre rule on [-1,1], exact to polynomial degree 2n-1
+    static const QuadratureRule& gaussLegendre(size_t n);
+    /// cached disk rule on unit-diameter disk (radius 0.5, weights sum to 1, as DiskQuadrature.hh):
+    /// nr-point Gauss-Legendre in r^2 times nt uniform angles
+    static const QuadratureRule& diskRule(size_t nr, size_t nt);
+
+    /// fixed-rule integral over [a,b] into I[m]
+    void integrate(const integrand_t& f, double a, double b, double* I) const;
+
+    /// adaptive integral over [a,b] into I[m], until each interval's max |component| error estimate
+    /// (n-point rule vs. sum over halves) is below max(abstol, reltol |I|) times its length fraction;
+    /// each round's intervals evaluated on nthreads (0 for all cores); returns number of intervals
+    size_t adaptive(const integrand_t& f, double a, double b, double* I,
+                    double abstol = 1e-10, double reltol = 1e-10, int nthreads = 0, size_t maxintervals = 1 << 16) const;
+
+    /// mean over disk centered (cx, cy) with radius r into I[m] (multiply by pi r^2 for integral)
+    void diskMean(const integrand2_t& f, double cx, double cy, double r, double* I, size_t nr = 8, size_t nt = 16) const;
+
+protected:
+    /// integral over [a,b] with supplied node buffers
+    void integrate(const integrand_t& f, double a, double b, double* I, vector<double>& xs, vector<double>& F) const;
+
+    const QuadratureRule& GL;   ///< cached Gauss-Legendre rule
+};
+
+#endif
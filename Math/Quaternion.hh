@@ -62,6 +62,27 @@ public:
     /// out-of-place multiplication
     const Quaternion operator*(const Quaternion& Q) const { auto c = *this; return c *= Q; }
 
+    /// rotate 3-vector v -> Q v Q^-1 (any nonzero Q)
+    std::array<R,3> rotate(const std::array<R,3>& v) const {
+        const auto& Q = *this;
+        // v + (2/|Q|^2) [(u.v) u - (u.u) v + w u x v], u = (Q1,Q2,Q3), w = Q0
+        auto s = R(2)/mag2();
+        auto uv = Q[1]*v[0] + Q[2]*v[1] + Q[3]*v[2];
+        auto uu = Q[1]*Q[1] + Q[2]*Q[2] + Q[3]*Q[3];
+        return { v[0] + s*(uv*Q[1] - uu*v[0] + Q[0]*(Q[2]*v[2] - Q[3]*v[1])),
+                 v[1] + s*(uv*Q[2] - uu*v[1] + Q[0]*(Q[3]*v[0] - Q[1]*v[2])),
+                 v[2] + s*(uv*Q[3] - uu*v[2] + Q[0]*(Q[1]*v[1] - Q[2]*v[0])) };
+    }
+    /// row-major 3x3 rotation matrix M[3*i + j] equivalent to rotate()
+    std::array<R,9> rotationMatrix() const {
+        const auto& Q = *this;
+        auto s = R(2)/mag2();
+        auto w = Q[0], x = Q[1], y = Q[2], z = Q[3];
+        return { 1 - s*(y*y + z*z), s*(x*y - w*z),     s*(x*z + w*y),
+                 s*(x*y + w*z),     1 - s*(x*x + z*z), s*(y*z - w*x),
+                 s*(x*z - w*y),     s*(y*z + w*x),     1 - s*(x*x + y*y) };
+    }
+
     /// inplace division
     Quaternion& operator/=(const Quaternion& Q) { return (*this) *= Q.inverse(); }
     /// out-of-place division
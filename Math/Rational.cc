@@ -43,7 +43,7 @@ Rational::Rational(const fmap_t& m, bool pos): positive(pos) {
 
 Rational::Rational(const PrimeSieve::factors_t& f): positive(true) {
     // convert (a,a,b,b,b,c) -> a^2 b^3 c^1
-    unsigned int i = 0;
+    PrimeSieve::uint_t i = 0;
     int n = 0;
     for(auto c: f) {
         assert(c);
@@ -156,6 +156,47 @@ bool Rational::operator<(const Rational& R) const {
     return R.positive? u.first < u.second : u.first > u.second;
 }
 
+/// whether 128-bit value fits in RationalSum::int_t
+inline bool fits_int_t(__int128_t x) { return x <= int_t_max && x >= -int_t_max; }
+
+void RationalSum::add(int_t n, int_t d) {
+    if(!d) throw std::domain_error("Divide-by-0 is bad!");
+    if(d < 0) { n = -n; d = -d; }
+    if(!n) return;
+
+    // common denominator: plain integer sum
+    if(d == den) {
+        __int128_t s = __int128_t(num) + n;
+        if(fits_int_t(s)) { num = s; return; }
+    }
+
+    // unreduced cross-multiplication, if it fits
+    __int128_t N = __int128_t(num)*d + __int128_t(n)*den;
+    __int128_t D = __int128_t(den)*d;
+    if(!fits_int_t(N) || !fits_int_t(D)) {
+        // reduce via common denominator factor
+        int_t g = PrimeSieve::gcd(den, d);
+        N = __int128_t(num)*(d/g) + __int128_t(n)*(den/g);
+        D = __int128_t(den/g)*d;
+        if(!fits_int_t(D) || !fits_int_t(N)) {
+            __uint128_t a = N < 0? -N : N, b = D;
+            while(b) { auto r = a % b; a = b; b = r; }
+            N /= __int128_t(a);
+            D /= __int128_t(a);
+            if(!fits_int_t(D) || !fits_int_t(N)) throw std::range_error("RationalSum overflow");
+        }
+    }
+    num = N;
+    den = D;
+}
+
+void RationalSum::normalize() {
+    if(!num) { den = 1; return; }
+    int_t g = PrimeSieve::gcd(std::abs(num), den);
+    num /= g;
+    den /= g;
+}
+
 std::ostream& operator<<(std::ostream& o, const Rational& r) {
     auto c = r.components();
     o << c.first;
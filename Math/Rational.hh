@@ -111,6 +111,41 @@ inline bool operator<(Rational::int_t i, Rational R) { return !(R == Rational(i)
 /// absolute value of rational number
 inline const Rational rabs(Rational r) { r.positive = true; return r; }
 
+/// Lazily-normalized Rational accumulator for long sums: numerator/denominator integers combined with 128-bit intermediates,
+/// gcd-reduced only when a result would overflow (or on output), instead of prime re-factoring after every Rational addition
+class RationalSum {
+public:
+    /// integer values
+    typedef Rational::int_t int_t;
+
+    /// Default constructor to 0
+    RationalSum() { }
+    /// Constructor from Rational (or auto from int)
+    RationalSum(const Rational& r) { *this += r; }
+
+    /// add n/d
+    void add(int_t n, int_t d = 1);
+    /// inplace addition
+    RationalSum& operator+=(const Rational& r) { auto c = r.components(); add(c.first, c.second); return *this; }
+    /// inplace subtraction
+    RationalSum& operator-=(const Rational& r) { auto c = r.components(); add(-c.first, c.second); return *this; }
+    /// inplace addition of accumulated sum
+    RationalSum& operator+=(const RationalSum& S) { add(S.num, S.den); return *this; }
+
+    /// reduce to lowest terms
+    void normalize();
+    /// reduced (signed) numerator, (positive) denominator
+    pair<int_t,int_t> components() const { auto S = *this; S.normalize(); return {S.num, S.den}; }
+    /// convert to Rational
+    explicit operator Rational() const { auto c = components(); return Rational(c.first, c.second); }
+    /// to double
+    explicit operator double() const { return double(num)/den; }
+
+protected:
+    int_t num = 0;  ///< numerator
+    int_t den = 1;  ///< denominator > 0
+};
+
 /// output representation for rational fraction
 std::ostream& operator<<(std::ostream& o, const Rational& r);
 
@@ -30,6 +30,14 @@ struct fftwx<double> {
     //static fcplx_t* alloc_complex(size_t i) { FFTWLOCK; return fftw_alloc_complex(i); }
     static void free(void* p) { FFTWLOCK; fftw_free(p); }
     static void execute(plan_t& p) { fftw_execute(p); }
+    static void execute_dft(plan_t p, fcplx_t* i, fcplx_t* o) { fftw_execute_dft(p, i, o); }
+    static void execute_dft_r2c(plan_t p, real_t* i, fcplx_t* o) { fftw_execute_dft_r2c(p, i, o); }
+    static void execute_dft_c2r(plan_t p, fcplx_t* i, real_t* o) { fftw_execute_dft_c2r(p, i, o); }
+    static void execute_r2r(plan_t p, real_t* i, real_t* o) { fftw_execute_r2r(p, i, o); }
+    static int alignment_of(void* p) { return fftw_alignment_of((real_t*)p); }
+    static char* export_wisdom_to_string() { FFTWLOCK; return fftw_export_wisdom_to_string(); }
+    static bool import_wisdom_from_string(const char* w) { FFTWLOCK; return fftw_import_wisdom_from_string(w); }
+    static const char* prefix() { return "fftw"; }
 
     template<typename... Args>
     static plan_t plan_dft_1d(Args&&... a) { FFTWLOCK; return fftw_plan_dft_1d(std::forward<Args>(a)...); }
@@ -39,6 +47,22 @@ struct fftwx<double> {
     static plan_t plan_dft_c2r_1d(Args&&... a) { FFTWLOCK; return fftw_plan_dft_c2r_1d(std::forward<Args>(a)...); }
     template<typename... Args>
     static plan_t plan_r2r_1d(Args&&... a) { FFTWLOCK; return fftw_plan_r2r_1d(std::forward<Args>(a)...); }
+
+    template<typename... Args>
+    static plan_t plan_many_dft(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftw_plan_many_dft(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_dft_r2c(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftw_plan_many_dft_r2c(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_dft_c2r(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftw_plan_many_dft_c2r(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_r2r(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftw_plan_many_r2r(std::forward<Args>(a)...); plan_threads(1); return p; }
+
+    /// set threads for subsequent plans (call holding FFTWLOCK)
+#ifdef WITH_FFTW_THREADS
+    static void plan_threads(int n) { static bool init = fftw_init_threads(); if(init) fftw_plan_with_nthreads(n); }
+#else
+    static void plan_threads(int) { }
+#endif
 };
 
 template<>
@@ -54,6 +78,14 @@ struct fftwx<float> {
     //static fcplx_t* alloc_complex(size_t i) { return fftwf_alloc_complex(i); }
     static void free(void* p) { FFTWLOCK; fftwf_free(p); }
     static void execute(plan_t& p) { fftwf_execute(p); }
+    static void execute_dft(plan_t p, fcplx_t* i, fcplx_t* o) { fftwf_execute_dft(p, i, o); }
+    static void execute_dft_r2c(plan_t p, real_t* i, fcplx_t* o) { fftwf_execute_dft_r2c(p, i, o); }
+    static void execute_dft_c2r(plan_t p, fcplx_t* i, real_t* o) { fftwf_execute_dft_c2r(p, i, o); }
+    static void execute_r2r(plan_t p, real_t* i, real_t* o) { fftwf_execute_r2r(p, i, o); }
+    static int alignment_of(void* p) { return fftwf_alignment_of((real_t*)p); }
+    static char* export_wisdom_to_string() { FFTWLOCK; return fftwf_export_wisdom_to_string(); }
+    static bool import_wisdom_from_string(const char* w) { FFTWLOCK; return fftwf_import_wisdom_from_string(w); }
+    static const char* prefix() { return "fftwf"; }
 
     template<typename... Args>
     static plan_t plan_dft_1d(Args&&... a) { FFTWLOCK; return fftwf_plan_dft_1d(std::forward<Args>(a)...); }
@@ -63,6 +95,22 @@ struct fftwx<float> {
     static plan_t plan_dft_c2r_1d(Args&&... a) { FFTWLOCK; return fftwf_plan_dft_c2r_1d(std::forward<Args>(a)...); }
     template<typename... Args>
     static plan_t plan_r2r_1d(Args&&... a) { FFTWLOCK; return fftwf_plan_r2r_1d(std::forward<Args>(a)...); }
+
+    template<typename... Args>
+    static plan_t plan_many_dft(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwf_plan_many_dft(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_dft_r2c(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwf_plan_many_dft_r2c(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_dft_c2r(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwf_plan_many_dft_c2r(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_r2r(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwf_plan_many_r2r(std::forward<Args>(a)...); plan_threads(1); return p; }
+
+    /// set threads for subsequent plans (call holding FFTWLOCK)
+#ifdef WITH_FFTW_THREADS
+    static void plan_threads(int n) { static bool init = fftwf_init_threads(); if(init) fftwf_plan_with_nthreads(n); }
+#else
+    static void plan_threads(int) { }
+#endif
 };
 
 template<>
@@ -78,6 +126,14 @@ struct fftwx<long double> {
     //static fcplx_t* alloc_complex(size_t i) { FFTWLOCK; return fftwl_alloc_complex(i); }
     static void free(void* p) { FFTWLOCK; fftwl_free(p); }
     static void execute(plan_t& p) { fftwl_execute(p); }
+    static void execute_dft(plan_t p, fcplx_t* i, fcplx_t* o) { fftwl_execute_dft(p, i, o); }
+    static void execute_dft_r2c(plan_t p, real_t* i, fcplx_t* o) { fftwl_execute_dft_r2c(p, i, o); }
+    static void execute_dft_c2r(plan_t p, fcplx_t* i, real_t* o) { fftwl_execute_dft_c2r(p, i, o); }
+    static void execute_r2r(plan_t p, real_t* i, real_t* o) { fftwl_execute_r2r(p, i, o); }
+    static int alignment_of(void* p) { return fftwl_alignment_of((real_t*)p); }
+    static char* export_wisdom_to_string() { FFTWLOCK; return fftwl_export_wisdom_to_string(); }
+    static bool import_wisdom_from_string(const char* w) { FFTWLOCK; return fftwl_import_wisdom_from_string(w); }
+    static const char* prefix() { return "fftwl"; }
 
     template<typename... Args>
     static plan_t plan_dft_1d(Args&&... a) { FFTWLOCK; return fftwl_plan_dft_1d(std::forward<Args>(a)...); }
@@ -88,6 +144,22 @@ struct fftwx<long double> {
     template<typename... Args>
     static plan_t plan_r2r_1d(Args&&... a) { FFTWLOCK; return fftwl_plan_r2r_1d(std::forward<Args>(a)...); }
 
+    template<typename... Args>
+    static plan_t plan_many_dft(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwl_plan_many_dft(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_dft_r2c(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwl_plan_many_dft_r2c(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_dft_c2r(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwl_plan_many_dft_c2r(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_r2r(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwl_plan_many_r2r(std::forward<Args>(a)...); plan_threads(1); return p; }
+
+    /// set threads for subsequent plans (call holding FFTWLOCK)
+#ifdef WITH_FFTW_THREADS
+    static void plan_threads(int n) { static bool init = fftwl_init_threads(); if(init) fftwl_plan_with_nthreads(n); }
+#else
+    static void plan_threads(int) { }
+#endif
+
     static std::mutex planner_mutex;
 };
 
@@ -104,6 +176,14 @@ struct fftwx<__float128> {
     static fcplx_t* alloc_complex(size_t i) { FFTWLOCK; return fftwq_alloc_complex(i); }
     static void free(void* p) { FFTWLOCK; fftwq_free(p); }
     static void execute(plan_t& p) { fftwq_execute(p); }
+    static void execute_dft(plan_t p, fcplx_t* i, fcplx_t* o) { fftwq_execute_dft(p, i, o); }
+    static void execute_dft_r2c(plan_t p, real_t* i, fcplx_t* o) { fftwq_execute_dft_r2c(p, i, o); }
+    static void execute_dft_c2r(plan_t p, fcplx_t* i, real_t* o) { fftwq_execute_dft_c2r(p, i, o); }
+    static void execute_r2r(plan_t p, real_t* i, real_t* o) { fftwq_execute_r2r(p, i, o); }
+    static int alignment_of(void* p) { return fftwq_alignment_of((real_t*)p); }
+    static char* export_wisdom_to_string() { FFTWLOCK; return fftwq_export_wisdom_to_string(); }
+    static bool import_wisdom_from_string(const char* w) { FFTWLOCK; return fftwq_import_wisdom_from_string(w); }
+    static const char* prefix() { return "fftwq"; }
 
     template<typename... Args>
     static plan_t plan_dft_1d(Args&&... a) { FFTWLOCK; return fftwq_plan_dft_1d(std::forward<Args>(a)...); }
@@ -113,12 +193,29 @@ struct fftwx<__float128> {
     static plan_t plan_dft_c2r_1d(Args&&... a) { FFTWLOCK; return fftwq_plan_dft_c2r_1d(std::forward<Args>(a)...); }
     template<typename... Args>
     static plan_t plan_r2r_1d(Args&&... a) { FFTWLOCK; return fftwq_plan_r2r_1d(std::forward<Args>(a)...); }
+
+    template<typename... Args>
+    static plan_t plan_many_dft(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwq_plan_many_dft(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_dft_r2c(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwq_plan_many_dft_r2c(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_dft_c2r(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwq_plan_many_dft_c2r(std::forward<Args>(a)...); plan_threads(1); return p; }
+    template<typename... Args>
+    static plan_t plan_many_r2r(int nt, Args&&... a) { FFTWLOCK; plan_threads(nt); auto p = fftwq_plan_many_r2r(std::forward<Args>(a)...); plan_threads(1); return p; }
+
+    /// set threads for subsequent plans (call holding FFTWLOCK)
+#ifdef WITH_FFTW_THREADS
+    static void plan_threads(int n) { static bool init = fftwq_init_threads(); if(init) fftwq_plan_with_nthreads(n); }
+#else
+    static void plan_threads(int) { }
+#endif
 };
 
 #endif
 
 
 #include <vector>
+#include "HugePages.hh"
 using std::vector;
 
 /// real allocator wrapper for using FFTW allocate functions with std::vector
@@ -143,12 +240,13 @@ struct fftwx_real_allocator {
     /// allocation, with bounds checks (required)
     value_type* allocate(std::size_t n) {
         if(n > std::numeric_limits<std::size_t>::max() / sizeof(value_type)) throw std::bad_alloc();
+        if(auto p = HugePagePolicy::get("FFTW").map(n*sizeof(value_type))) return static_cast<value_type*>(p);
         if(auto p = fftwx<T>::alloc_real(n)) return p;
         throw std::bad_alloc();
     }
 
     /// deallocation (required)
-    void deallocate(value_type* p, std::size_t) noexcept { fftwx<T>::free(p); }
+    void deallocate(value_type* p, std::size_t) noexcept { if(!HugePagePolicy::unmap(p)) fftwx<T>::free(p); }
 };
 
 /// complex allocator wrapper for using FFTW allocate functions with std::vector
@@ -177,12 +275,13 @@ struct fftwx_complex_allocator {
     /// allocation, with bounds checks (required)
     value_type* allocate(std::size_t n) {
         if(n > std::numeric_limits<std::size_t>::max() / sizeof(value_type)) throw std::bad_alloc();
+        if(auto p = HugePagePolicy::get("FFTW").map(n*sizeof(value_type))) return static_cast<value_type*>(p);
         if(auto p = fftwx<T>::alloc_complex(n)) return (value_type*)p;
         throw std::bad_alloc();
     }
 
     /// deallocation (required)
-    void deallocate(value_type* p, std::size_t) noexcept { fftwx<T>::free(p); }
+    void deallocate(value_type* p, std::size_t) noexcept { if(!HugePagePolicy::unmap(p)) fftwx<T>::free(p); }
 };
 
 /// FFTW-allocated real data
@@ -0,0 +1,264 @@
+/// \file BatchLUP.hh Batched fixed-N linear solves and inverses, in structure-of-arrays blocks across systems for SIMD lanes
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef BATCHLUP_HH
+#define BATCHLUP_HH
+
+#include "Matrix.hh"
+#include <type_traits>
+
+/// Many independent N x N systems A x = b, solved W at a time with lanes across systems
+/**
+ * Each block holds W systems transposed so element (i,j) of every system is contiguous (a[i][j][lane]);
+ * all arithmetic runs as straight-line loops over the lanes, which the compiler vectorizes.
+ * closed_form (default N <= 4) selects at compile time cofactor (adjugate) inverses, with no data-dependent pivoting;
+ * otherwise each lane is LUP-decomposed with partial pivoting, rows exchanged by per-lane selects.
+ * Systems with zero determinant (or zero pivot) are flagged, with all-zero results.
+ */
+template<size_t N, typename T, size_t W = (64/sizeof(T) > 1? 64/sizeof(T) : 1), bool closed_form = (N <= 4)>
+class LUPBatch {
+public:
+    static_assert(N, "Please avoid zero-dimensional matrices.");
+
+    /// matrix type
+    typedef Matrix<N,N,T> mat_t;
+    /// vector type
+    typedef Vec<N,T> vec_t;
+    /// number of lanes per block
+    static constexpr size_t lanes = W;
+
+    /// Block of W systems, structure-of-arrays across lanes
+    struct alignas(64) block_t {
+        T a[N][N][W];   ///< input matrices; destroyed (inverse for invert())
+        T x[N][W];      ///< right-hand sides in, solutions out
+        bool ok[W];     ///< whether each system was non-singular
+    };
+
+    /// solve each block system in place
+    static void solve(block_t& B) { _solve(B, std::integral_constant<bool, closed_form>()); }
+    /// replace each block matrix by its inverse
+    static void invert(block_t& B) { _invert(B, std::integral_constant<bool, closed_form>()); }
+
+    /// solve A[i] x[i] = b[i] for n systems (x may alias b); optionally flag ok[i]; return number of singular systems
+    static size_t solve(const mat_t* A, const vec_t* b, vec_t* x, size_t n, bool* ok = nullptr) {
+        block_t B;
+        size_t nsing = 0;
+        for(size_t i0 = 0; i0 < n; i0 += W) {
+            const size_t nl = std::min(W, n - i0);
+            load(B, A + i0, nl);
+            for(size_t r = 0; r < N; r++)
+                for(size_t l = 0; l < W; l++) B.x[r][l] = l < nl? b[i0 + l][r] : T{};
+            solve(B);
+            for(size_t l = 0; l < nl; l++) {
+                for(size_t r = 0; r < N; r++) x[i0 + l][r] = B.x[r][l];
+                if(ok) ok[i0 + l] = B.ok[l];
+                nsing += !B.ok[l];
+            }
+        }
+        return nsing;
+    }
+
+    /// inverses Ai[i] of n matrices A[i] (Ai may alias A); optionally flag ok[i]; return number of singular systems
+    static size_t invert(const mat_t* A, mat_t* Ai, size_t n, bool* ok = nullptr) {
+        block_t B;
+        size_t nsing = 0;
+        for(size_t i0 = 0; i0 < n; i0 += W) {
+            const size_t nl = std::min(W, n - i0);
+            load(B, A + i0, nl);
+            invert(B);
+            for(size_t l = 0; l < nl; l++) {
+                for(size_t r = 0; r < N; r++)
+                    for(size_t c = 0; c < N; c++) Ai[i0 + l](r,c) = B.a[r][c][l];
+                if(ok) ok[i0 + l] = B.ok[l];
+                nsing += !B.ok[l];
+            }
+        }
+        return nsing;
+    }
+
+protected:
+    /// transpose nl <= W matrices into block, padding unused lanes with identity
+    static void load(block_t& B, const mat_t* A, size_t nl) {
+        for(size_t r = 0; r < N; r++)
+            for(size_t c = 0; c < N; c++)
+                for(size_t l = 0; l < W; l++) B.a[r][c][l] = l < nl? A[l](r,c) : T(r == c);
+    }
+
+    /// closed-form inverse by cofactors, with determinant
+    static void adjugate(T (&a)[N][N][W], T (&ai)[N][N][W], T (&d)[W], std::integral_constant<size_t,1>) {
+        for(size_t l = 0; l < W; l++) {
+            d[l] = a[0][0][l];
+            ai[0][0][l] = 1;
+        }
+    }
+    /// closed-form inverse by cofactors, with determinant
+    static void adjugate(T (&a)[N][N][W], T (&ai)[N][N][W], T (&d)[W], std::integral_constant<size_t,2>) {
+        for(size_t l = 0; l < W; l++) {
+            d[l] = a[0][0][l]*a[1][1][l] - a[0][1][l]*a[1][0][l];
+            ai[0][0][l] = a[1][1][l];
+            ai[0][1][l] = -a[0][1][l];
+            ai[1][0][l] = -a[1][0][l];
+            ai[1][1][l] = a[0][0][l];
+        }
+    }
+    /// closed-form inverse by cofactors, with determinant
+    static void adjugate(T (&a)[N][N][W], T (&ai)[N][N][W], T (&d)[W], std::integral_constant<size_t,3>) {
+        for(size_t l = 0; l < W; l++) {
+            ai[0][0][l] = a[1][1][l]*a[2][2][l] - a[1][2][l]*a[2][1][l];
+            ai[1][0][l] = a[1][2][l]*a[2][0][l] - a[1][0][l]*a[2][2][l];
+            ai[2][0][l] = a[1][0][l]*a[2][1][l] - a[1][1][l]*a[2][0][l];
+            ai[0][1][l] = a[0][2][l]*a[2][1][l] - a[0][1][l]*a[2][2][l];
+            ai[1][1][l] = a[0][0][l]*a[2][2][l] - a[0][2][l]*a[2][0][l];
+            ai[2][1][l] = a[0][1][l]*a[2][0][l] - a[0][0][l]*a[2][1][l];
+            ai[0][2][l] = a[0][1][l]*a[1][2][l] - a[0][2][l]*a[1][1][l];
+            ai[1][2][l] = a[0][2][l]*a[1][0][l] - a[0][0][l]*a[1][2][l];
+            ai[2][2][l] = a[0][0][l]*a[1][1][l] - a[0][1][l]*a[1][0][l];
+            d[l] = a[0][0][l]*ai[0][0][l] + a[0][1][l]*ai[1][0][l] + a[0][2][l]*ai[2][0][l];
+        }
+    }
+    /// closed-form inverse by cofactors (from 2x2 minors of row pairs), with determinant
+    static void adjugate(T (&a)[N][N][W], T (&ai)[N][N][W], T (&d)[W], std::integral_constant<size_t,4>) {
+        for(size_t l = 0; l < W; l++) {
+            // minors of rows 0,1 and rows 2,3
+            const T s0 = a[0][0][l]*a[1][1][l] - a[1][0][l]*a[0][1][l];
+            const T s1 = a[0][0][l]*a[1][2][l] - a[1][0][l]*a[0][2][l];
+            const T s2 = a[0][0][l]*a[1][3][l] - a[1][0][l]*a[0][3][l];
+            const T s3 = a[0][1][l]*a[1][2][l] - a[1][1][l]*a[0][2][l];
+            const T s4 = a[0][1][l]*a[1][3][l] - a[1][1][l]*a[0][3][l];
+            const T s5 = a[0][2][l]*a[1][3][l] - a[1][2][l]*a[0][3][l];
+            const T c5 = a[2][2][l]*a[3][3][l] - a[3][2][l]*a[2][3][l];
+            const T c4 = a[2][1][l]*a[3][3][l] - a[3][1][l]*a[2][3][l];
+            const T c3 = a[2][1][l]*a[3][2][l] - a[3][1][l]*a[2][2][l];
+            const T c2 = a[2][0][l]*a[3][3][l] - a[3][0][l]*a[2][3][l];
+            const T c1 = a[2][0][l]*a[3][2][l] - a[3][0][l]*a[2][2][l];
+            const T c0 = a[2][0][l]*a[3][1][l] - a[3][0][l]*a[2][1][l];
+            d[l] = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+
+            ai[0][0][l] =  a[1][1][l]*c5 - a[1][2][l]*c4 + a[1][3][l]*c3;
+            ai[0][1][l] = -a[0][1][l]*c5 + a[0][2][l]*c4 - a[0][3][l]*c3;
+            ai[0][2][l] =  a[3][1][l]*s5 - a[3][2][l]*s4 + a[3][3][l]*s3;
+            ai[0][3][l] = -a[2][1][l]*s5 + a[2][2][l]*s4 - a[2][3][l]*s3;
+            ai[1][0][l] = -a[1][0][l]*c5 + a[1][2][l]*c2 - a[1][3][l]*c1;
+            ai[1][1][l] =  a[0][0][l]*c5 - a[0][2][l]*c2 + a[0][3][l]*c1;
+            ai[1][2][l] = -a[3][0][l]*s5 + a[3][2][l]*s2 - a[3][3][l]*s1;
+            ai[1][3][l] =  a[2][0][l]*s5 - a[2][2][l]*s2 + a[2][3][l]*s1;
+            ai[2][0][l] =  a[1][0][l]*c4 - a[1][1][l]*c2 + a[1][3][l]*c0;
+            ai[2][1][l] = -a[0][0][l]*c4 + a[0][1][l]*c2 - a[0][3][l]*c0;
+            ai[2][2][l] =  a[3][0][l]*s4 - a[3][1][l]*s2 + a[3][3][l]*s0;
+            ai[2][3][l] = -a[2][0][l]*s4 + a[2][1][l]*s2 - a[2][3][l]*s0;
+            ai[3][0][l] = -a[1][0][l]*c3 + a[1][1][l]*c1 - a[1][2][l]*c0;
+            ai[3][1][l] =  a[0][0][l]*c3 - a[0][1][l]*c1 + a[0][2][l]*c0;
+            ai[3][2][l] = -a[3][0][l]*s3 + a[3][1][l]*s1 - a[3][2][l]*s0;
+            ai[3][3][l] =  a[2][0][l]*s3 - a[2][1][l]*s1 + a[2][2][l]*s0;
+        }
+    }
+
+    /// closed-form inverse, scaled by 1/determinant
+    static void _invert(block_t& B, std::true_type) {
+        T ai[N][N][W], d[W];
+        adjugate(B.a, ai, d, std::integral_constant<size_t,N>());
+        for(size_t l = 0; l < W; l++) {
+            B.ok[l] = d[l] != T{};
+            d[l] = B.ok[l]? 1/d[l] : T{};
+        }
+        for(size_t r = 0; r < N; r++)
+            for(size_t c = 0; c < N; c++)
+                for(size_t l = 0; l < W; l++) B.a[r][c][l] = ai[r][c][l]*d[l];
+    }
+    /// closed-form solve, as inverse times right-hand side
+    static void _solve(block_t& B, std::true_type) {
+        _invert(B, std::true_type());
+        T x[N][W];
+        for(size_t r = 0; r < N; r++) {
+            for(size_t l = 0; l < W; l++) x[r][l] = B.a[r][0][l]*B.x[0][l];
+            for(size_t c = 1; c < N; c++)
+                for(size_t l = 0; l < W; l++) x[r][l] += B.a[r][c][l]*B.x[c][l];
+        }
+        for(size_t r = 0; r < N; r++)
+            for(size_t l = 0; l < W; l++) B.x[r][l] = x[r][l];
+    }
+
+    /// LUP decomposition of a, applying row operations to R right-hand side columns b, then back-substituting b <- A^-1 b
+    template<size_t R>
+    static void lup_solve(T (&a)[N][N][W], T (&b)[N][R][W], bool (&ok)[W]) {
+        for(size_t l = 0; l < W; l++) ok[l] = true;
+        for(size_t i = 0; i < N; i++) {
+            // per-lane maximum-magnitude pivot row
+            size_t piv[W];
+            T mx[W];
+            for(size_t l = 0; l < W; l++) { piv[l] = i; mx[l] = std::abs(a[i][i][l]); }
+            for(size_t k = i+1; k < N; k++) {
+                for(size_t l = 0; l < W; l++) {
+                    const T v = std::abs(a[k][i][l]);
+                    const bool m = mx[l] < v;
+                    mx[l] = m? v : mx[l];
+                    piv[l] = m? k : piv[l];
+                }
+            }
+
+            // per-lane row exchange by selects (eliminated columns c < i are not needed)
+            for(size_t k = i+1; k < N; k++) {
+                for(size_t c = i; c < N; c++) {
+                    for(size_t l = 0; l < W; l++) {
+                        const bool m = piv[l] == k;
+                        const T t = a[i][c][l];
+                        a[i][c][l] = m? a[k][c][l] : t;
+                        a[k][c][l] = m? t : a[k][c][l];
+                    }
+                }
+                for(size_t c = 0; c < R; c++) {
+                    for(size_t l = 0; l < W; l++) {
+                        const bool m = piv[l] == k;
+                        const T t = b[i][c][l];
+                        b[i][c][l] = m? b[k][c][l] : t;
+                        b[k][c][l] = m? t : b[k][c][l];
+                    }
+                }
+            }
+
+            // eliminate below pivot (singular lanes continue with unit pivot, flagged)
+            T dinv[W];
+            for(size_t l = 0; l < W; l++) {
+                const bool s = mx[l] == T{};
+                ok[l] = ok[l] && !s;
+                a[i][i][l] = s? T(1) : a[i][i][l];
+                dinv[l] = 1/a[i][i][l];
+            }
+            for(size_t k = i+1; k < N; k++) {
+                T f[W];
+                for(size_t l = 0; l < W; l++) f[l] = a[k][i][l]*dinv[l];
+                for(size_t c = i+1; c < N; c++)
+                    for(size_t l = 0; l < W; l++) a[k][c][l] -= f[l]*a[i][c][l];
+                for(size_t c = 0; c < R; c++)
+                    for(size_t l = 0; l < W; l++) b[k][c][l] -= f[l]*b[i][c][l];
+            }
+        }
+
+        // back-substitution
+        for(size_t i = N; i-- > 0;) {
+            for(size_t c = 0; c < R; c++) {
+                for(size_t k = i+1; k < N; k++)
+                    for(size_t l = 0; l < W; l++) b[i][c][l] -= a[i][k][l]*b[k][c][l];
+                for(size_t l = 0; l < W; l++) b[i][c][l] = ok[l]? b[i][c][l]/a[i][i][l] : T{};
+            }
+        }
+    }
+
+    /// pivoted LUP solve
+    static void _solve(block_t& B, std::false_type) {
+        lup_solve<1>(B.a, reinterpret_cast<T (&)[N][1][W]>(B.x), B.ok);
+    }
+    /// pivoted LUP inverse, solving for identity columns
+    static void _invert(block_t& B, std::false_type) {
+        T b[N][N][W];
+        for(size_t r = 0; r < N; r++)
+            for(size_t c = 0; c < N; c++)
+                for(size_t l = 0; l < W; l++) b[r][c][l] = T(r == c);
+        lup_solve<N>(B.a, b, B.ok);
+        for(size_t r = 0; r < N; r++)
+            for(size_t c = 0; c < N; c++)
+                for(size_t l = 0; l < W; l++) B.a[r][c][l] = b[r][c][l];
+    }
+};
+
+#endif
@@ -20,6 +20,10 @@
  */
 
 #include "BlockCMat.hh"
+#include "BulkArrayIO.hh"
+#include "FFTW_Batch.hh"
+#include "WorkStealingPool.hh"
+#include <thread>
 
 BlockCMat makeBlockCMatIdentity(size_t n, size_t mc) {
     BlockCMat foo(n,n,mc);
@@ -36,6 +40,28 @@ BlockCMat makeBlockCMatRandom(size_t n, size_t mc) {
     return foo;
 }
 
+void writeBulk(BulkArrayWriter& W, const BlockCMat& BC) {
+    const size_t M = BC.size()? BC[0].nRows() : 0;
+    vector<const double*> parts;
+    for(size_t i=0; i<BC.size(); i++) {
+        if(BC[i].nRows() != M) throw std::logic_error("BlockCMat bulk write requires equal-size blocks");
+        parts.push_back(BC[i].getRealData().data());
+    }
+    W.write_parts(parts, M, BC.nRows(), BC.nCols(), BULK_BLOCKCMAT);
+}
+
+BlockCMat readBulkBlockCMat(const BulkArrayView<double>& v) {
+    if(v.kind() != BULK_BLOCKCMAT) throw std::runtime_error("Bulk array record is not a BlockCMat");
+    const size_t M = v.dim(0);
+    BlockCMat foo(v.dim(1), v.dim(2));
+    for(size_t i=0; i<foo.size(); i++) {
+        CMatrix& C = foo[i];
+        C = CMatrix(M);
+        std::copy(v.data() + i*M, v.data() + (i+1)*M, C.getRealData().begin());
+    }
+    return foo;
+}
+
 //-----------------------------------
 
 // utility class for sorting enumerated singular values
@@ -47,19 +73,54 @@ public:
 };
 
 
-BlockCMat_SVD::BlockCMat_SVD(const BlockCMat& BC): M(BC.nRows()), N(BC.nCols()), Mc(BC[0].nRows()), Ms(std::min(M,N)), PsI(nullptr), PsI_epsilon(0) {
+BlockCMat_SVD::BlockCMat_SVD(const BlockCMat& BC, int nthreads): M(BC.nRows()), N(BC.nCols()), Mc(BC[0].nRows()), Ms(std::min(M,N)), PsI(nullptr), PsI_epsilon(0) {
     #ifdef WITH_LAPACKE
-    for(size_t i=0; i<Mc/2+1; i++) {
-        VarMat<lapack_complex_double> dblock(BC.nRows(),BC.nCols());
-        for(size_t r=0; r<M; r++) {
-            for(size_t c=0; c<N; c++) {
-                dblock(r,c) = BC(r,c).getKData()[i];
-            }
+    const size_t nk = Mc/2+1;   // number of independent Fourier modes
+
+    // k-space data for all blocks, kdata[mode*M*N + block]: blocks not already in k-space transformed in one batch
+    vector<lapack_complex_double> kdata(nk*M*N);
+    vector<size_t> rblocks;
+    for(size_t b=0; b<BC.size(); b++) {
+        if(BC[b].hasKData()) {
+            const auto& kd = BC[b].getKData();
+            for(size_t i=0; i<nk; i++) kdata[i*M*N + b] = kd[i];
+        } else rblocks.push_back(b);
+    }
+    if(rblocks.size()) {
+        BatchR2CPlan<double> P(FFTWBatchLayout({int(Mc)}, rblocks.size()), 1);
+        fftw_real_vec<double> v_x(P.M);
+        fftw_cplx_vec<double> v_k(P.K);
+        P.makePlan(true, v_x.data(), (fftw_complex*)v_k.data());
+        for(size_t j=0; j<rblocks.size(); j++) {
+            const auto& r = BC[rblocks[j]].getRealData();
+            std::copy(r.begin(), r.end(), v_x.begin() + j*Mc);
         }
-        block_SVDs.push_back(new LAPACKE_Matrix_SVD<double,lapack_complex_double>(dblock));
+        P.execute();
+        for(size_t j=0; j<rblocks.size(); j++)
+            for(size_t i=0; i<nk; i++) kdata[i*M*N + rblocks[j]] = v_k[j*nk + i];
+    }
+
+    // independent per-mode decompositions, with per-thread LAPACKE workspace
+    typedef LAPACKE_Matrix_SVD<double,lapack_complex_double> SVD_t;
+    block_SVDs.assign(nk, nullptr);
+    auto decompose = [&](size_t i, SVD_t::workspace_t& W) {
+        VarMat<lapack_complex_double> dblock(M,N);
+        std::copy(kdata.begin() + i*M*N, kdata.begin() + (i+1)*M*N, &dblock[0]);
+        block_SVDs[i] = new SVD_t(dblock, &W);
+    };
+    const unsigned int nt = nthreads? nthreads : std::thread::hardware_concurrency();
+    if(nt <= 1 || nk < 2) {
+        SVD_t::workspace_t W;
+        for(size_t i=0; i<nk; i++) decompose(i, W);
+    } else {
+        WorkStealingPool P(nt);
+        vector<SVD_t::workspace_t> Ws(P.size());
+        for(size_t i=0; i<nk; i++) P.submit([&decompose, &Ws, &P, i]() { decompose(i, Ws[P.current_worker()]); });
+        P.wait_idle();
     }
     sort_singular_values();
     #else
+    (void)nthreads;
     PsI = new BlockCMat(BC);
     PsI->invert();
     #endif
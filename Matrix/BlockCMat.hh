@@ -33,12 +33,16 @@ typedef VarMat<CMatrix> BlockCMat;
 
 BlockCMat makeBlockCMatIdentity(size_t n, size_t mc);
 BlockCMat makeBlockCMatRandom(size_t n, size_t mc);
+/// write real-space blocks as one bulk array record
+void writeBulk(BulkArrayWriter& W, const BlockCMat& BC);
+/// construct BlockCMat from bulk array record
+BlockCMat readBulkBlockCMat(const BulkArrayView<double>& v);
 
 /// singular-value decomposition of block circulant matrix
 class BlockCMat_SVD: public BinaryOutputObject {
 public:
-    /// constructor
-    explicit BlockCMat_SVD(const BlockCMat& BC);
+    /// constructor, decomposing independent Fourier modes on nthreads (0 for all cores)
+    explicit BlockCMat_SVD(const BlockCMat& BC, int nthreads = 0);
     /// destructor
     ~BlockCMat_SVD();
 
@@ -0,0 +1,137 @@
+/// \file BulkArrayIO.cc
+
+#include "BulkArrayIO.hh"
+#include <algorithm>
+#include <cstring>
+
+size_t bulk_elsize(uint8_t t) {
+    switch(t) {
+        case BULK_INT16: return sizeof(int16_t);
+        case BULK_FLOAT: return sizeof(float);
+        case BULK_DOUBLE: return sizeof(double);
+        case BULK_CDOUBLE: return sizeof(std::complex<double>);
+        default: throw std::runtime_error("Unknown bulk array element type " + std::to_string(t));
+    }
+}
+
+/// scalar width for byte-shuffling elements
+static size_t shuffle_width(uint8_t t) { return t == BULK_CDOUBLE? sizeof(double) : bulk_elsize(t); }
+
+/// transpose n bytes of w-byte words into byte planes (trailing partial word copied)
+static void byte_shuffle(const char* in, char* out, size_t n, size_t w) {
+    const size_t nw = n/w;
+    for(size_t b = 0; b < w; b++)
+        for(size_t i = 0; i < nw; i++) out[b*nw + i] = in[i*w + b];
+    std::copy(in + nw*w, in + n, out + nw*w);
+}
+
+/// invert byte_shuffle
+static void byte_unshuffle(const char* in, char* out, size_t n, size_t w) {
+    const size_t nw = n/w;
+    for(size_t b = 0; b < w; b++)
+        for(size_t i = 0; i < nw; i++) out[i*w + b] = in[b*nw + i];
+    std::copy(in + nw*w, in + n, out + nw*w);
+}
+
+/// record alignment
+static constexpr size_t BULK_ALIGN = 64;
+
+BulkArrayWriter::BulkArrayWriter(std::ostream& _o, bool c, BlockCodec cd, int lvl, unsigned int nt):
+compress(c), codec(cd), level(lvl), nthreads(nt), o(_o) {
+    auto p = o.tellp();
+    pos = p < 0? 0 : size_t(p);
+}
+
+void BulkArrayWriter::put(const void* d, size_t n) {
+    if(n) o.write(static_cast<const char*>(d), n);
+    pos += n;
+}
+
+void BulkArrayWriter::write(BulkArrayHeader H, const vector<const void*>& parts) {
+    // pad to record alignment
+    static const char zeros[BULK_ALIGN] = {};
+    put(zeros, (BULK_ALIGN - pos % BULK_ALIGN) % BULK_ALIGN);
+    const size_t psize = parts.size()? H.nbytes/parts.size() : 0;
+
+    if(!compress) {
+        H.nstored = H.nbytes;
+        put(&H, sizeof(H));
+        for(auto d: parts) put(d, psize);
+    } else {
+        const size_t bsize = 1 << 20;
+        const size_t w = shuffle_width(H.eltype);
+        H.compressed = 1;
+        H.shuffle = shuffle && w > 1? w : 0;
+        H.chunk = bsize;
+
+        vector<char> z;
+        {
+            BlockCompressWriter W([&z](const char* b, size_t m) { z.insert(z.end(), b, b + m); }, codec, level, bsize, nthreads);
+            if(!H.shuffle) for(auto d: parts) W.write(d, psize);
+            else {
+                // gather into bsize chunks (at fixed offsets in whole array), shuffled
+                vector<char> buf(bsize), sbuf(bsize);
+                size_t nb = 0;
+                for(auto d: parts) {
+                    auto p = static_cast<const char*>(d);
+                    for(size_t i = 0; i < psize; ) {
+                        const size_t n = std::min(bsize - nb, psize - i);
+                        std::copy(p + i, p + i + n, buf.begin() + nb);
+                        nb += n;
+                        i += n;
+                        if(nb == bsize) {
+                            byte_shuffle(buf.data(), sbuf.data(), nb, w);
+                            W.write(sbuf.data(), nb);
+                            nb = 0;
+                        }
+                    }
+                }
+                byte_shuffle(buf.data(), sbuf.data(), nb, w);
+                W.write(sbuf.data(), nb);
+            }
+            W.close();
+        }
+        H.nstored = z.size();
+        put(&H, sizeof(H));
+        put(z.data(), z.size());
+    }
+    if(!o) throw std::runtime_error("Bulk array record write failed");
+}
+
+//////////////////////////////////////////////////
+
+BulkArrayFile::BulkArrayFile(const string& fname, unsigned int nt): nthreads(nt), F(fname) {
+    size_t p = 0;
+    while(p + sizeof(BulkArrayHeader) <= F.size()) {
+        BulkArrayHeader H;
+        memcpy(&H, F.data() + p, sizeof(H));
+        if(!H.valid()) throw std::runtime_error("Invalid bulk array record header in '" + fname + "'");
+        if(H.version != 1) throw std::runtime_error("Unsupported bulk array record version in '" + fname + "'");
+        if(H.nbytes != H.size()*bulk_elsize(H.eltype) || (!H.compressed && H.nstored != H.nbytes))
+            throw std::runtime_error("Inconsistent bulk array record size in '" + fname + "'");
+        if(p + sizeof(H) + H.nstored > F.size()) throw std::runtime_error("Truncated bulk array record in '" + fname + "'");
+        offsets.push_back(p);
+        p += sizeof(H) + H.nstored;
+        p += (BULK_ALIGN - p % BULK_ALIGN) % BULK_ALIGN;
+    }
+    if(p < F.size()) throw std::runtime_error("Trailing data after bulk array records in '" + fname + "'");
+}
+
+const char* BulkArrayFile::data(size_t i, std::shared_ptr<vector<char>>& own) const {
+    const auto& H = header(i);
+    auto d = F.data() + offsets[i] + sizeof(H);
+    if(!H.compressed) return d;
+
+    own = std::make_shared<vector<char>>(block_decompress(d, H.nstored, nthreads));
+    if(own->size() != H.nbytes) throw std::runtime_error("Bulk array record decompressed size mismatch");
+    if(H.shuffle) {
+        if(!H.chunk) throw std::runtime_error("Invalid bulk array record shuffle chunk");
+        vector<char> buf(std::min(size_t(H.chunk), own->size()));
+        for(size_t j = 0; j < own->size(); j += H.chunk) {
+            const size_t n = std::min(size_t(H.chunk), own->size() - j);
+            std::copy(own->begin() + j, own->begin() + j + n, buf.begin());
+            byte_unshuffle(buf.data(), own->data() + j, n, H.shuffle);
+        }
+    }
+    return own->data();
+}
@@ -0,0 +1,203 @@
+/// \file BulkArrayIO.hh Bulk binary array records (header + contiguous data), optionally compressed, with memory-mapped zero-copy reads
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef BULKARRAYIO_HH
+#define BULKARRAYIO_HH
+
+#include "VarMat.hh"
+#include "BlockCompress.hh"
+#include "MappedFile.hh"
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+/// element type code in bulk array records
+enum bulk_eltype_t: uint8_t {
+    BULK_INT16      = 1,    ///< int16_t
+    BULK_FLOAT      = 2,    ///< float
+    BULK_DOUBLE     = 3,    ///< double
+    BULK_CDOUBLE    = 4     ///< complex<double>
+};
+
+/// object kind code in bulk array records
+enum bulk_kind_t: uint8_t {
+    BULK_ARRAY      = 0,    ///< plain array
+    BULK_VARVEC     = 1,    ///< VarVec: dims {n}
+    BULK_VARMAT     = 2,    ///< VarMat (column major): dims {rows, cols}
+    BULK_CMATRIX    = 3,    ///< CMatrix real-space data: dims {M}
+    BULK_BLOCKCMAT  = 4     ///< BlockCMat real-space blocks, column-major block order: dims {M, rows, cols}
+};
+
+/// element type code for raw types
+template<typename T>
+struct bulk_eltype { };
+template<>
+struct bulk_eltype<int16_t> { static constexpr bulk_eltype_t value = BULK_INT16; };
+template<>
+struct bulk_eltype<float> { static constexpr bulk_eltype_t value = BULK_FLOAT; };
+template<>
+struct bulk_eltype<double> { static constexpr bulk_eltype_t value = BULK_DOUBLE; };
+template<>
+struct bulk_eltype< std::complex<double> > { static constexpr bulk_eltype_t value = BULK_CDOUBLE; };
+
+/// Header preceding each (64-byte aligned) bulk array record; data (native byte order) follows immediately
+struct BulkArrayHeader {
+    char magic[4] = {'M', 'P', 'M', 'A'};   ///< record identifier
+    uint8_t version = 1;                    ///< format version
+    uint8_t eltype = 0;                     ///< element type, bulk_eltype_t
+    uint8_t kind = BULK_ARRAY;              ///< object kind, bulk_kind_t
+    uint8_t compressed = 0;                 ///< whether data is a BlockCompress stream
+    uint8_t shuffle = 0;                    ///< byte-shuffle width applied before compression (0 for none)
+    uint8_t reserved[3] = {0, 0, 0};        ///< unused
+    uint32_t chunk = 0;                     ///< byte-shuffle chunk size
+    uint64_t dims[3] = {0, 1, 1};           ///< array dimensions
+    uint64_t nbytes = 0;                    ///< uncompressed data size
+    uint64_t nstored = 0;                   ///< stored data size following header
+    uint64_t reserved2 = 0;                 ///< unused
+
+    /// check header identifier
+    bool valid() const { return magic[0] == 'M' && magic[1] == 'P' && magic[2] == 'M' && magic[3] == 'A'; }
+    /// number of elements
+    size_t size() const { return dims[0]*dims[1]*dims[2]; }
+};
+static_assert(sizeof(BulkArrayHeader) == 64, "BulkArrayHeader layout");
+
+/// byte size of bulk element type code
+size_t bulk_elsize(uint8_t t);
+
+/// Writer of bulk array records to output stream
+class BulkArrayWriter {
+public:
+    /// Constructor, optionally compressing with codec at level (-1 for default) on nthreads (0 for all cores)
+    explicit BulkArrayWriter(std::ostream& _o, bool compress = false, BlockCodec c = CODEC_ZLIB, int lvl = -1, unsigned int nt = 0);
+
+    /// write array of raw elements, with dimensions and kind
+    template<typename T>
+    void write(const T* d, uint64_t d0, uint64_t d1 = 1, uint64_t d2 = 1, bulk_kind_t k = BULK_ARRAY) {
+        BulkArrayHeader H;
+        H.eltype = bulk_eltype<T>::value;
+        H.kind = k;
+        H.dims[0] = d0;
+        H.dims[1] = d1;
+        H.dims[2] = d2;
+        H.nbytes = H.size()*sizeof(T);
+        write(H, vector<const void*>(1, d));
+    }
+    /// write VarVec
+    template<typename T>
+    void write(const VarVec<T>& v) { write(v.getData().data(), v.size(), 1, 1, BULK_VARVEC); }
+    /// write VarMat
+    template<typename T>
+    void write(const VarMat<T>& m) { write(m.getData().getData().data(), m.nRows(), m.nCols(), 1, BULK_VARMAT); }
+    /// write array gathered from equal-sized parts of raw elements, with dimensions and kind
+    template<typename T>
+    void write_parts(const vector<const T*>& parts, uint64_t d0, uint64_t d1 = 1, uint64_t d2 = 1, bulk_kind_t k = BULK_ARRAY) {
+        BulkArrayHeader H;
+        H.eltype = bulk_eltype<T>::value;
+        H.kind = k;
+        H.dims[0] = d0;
+        H.dims[1] = d1;
+        H.dims[2] = d2;
+        H.nbytes = H.size()*sizeof(T);
+        if(parts.size() && H.nbytes % parts.size()) throw std::logic_error("Bulk array parts size mismatch");
+        write(H, vector<const void*>(parts.begin(), parts.end()));
+    }
+
+    const bool compress;        ///< whether to compress data
+    const BlockCodec codec;     ///< compression codec
+    const int level;            ///< compression level
+    const unsigned int nthreads;///< compression threads
+    bool shuffle = true;        ///< byte-shuffle elements (by scalar width) before compression, grouping similar bytes
+
+protected:
+    /// write record with header (eltype, kind, dims, nbytes filled) and data from equal-sized parts
+    void write(BulkArrayHeader H, const vector<const void*>& parts);
+    /// write bytes, tracking position
+    void put(const void* d, size_t n);
+
+    std::ostream& o;            ///< output stream
+    size_t pos;                 ///< output position, for alignment
+};
+
+/// Read-only view of bulk array record data: zero-copy into mapped file for uncompressed records
+template<typename T>
+class BulkArrayView {
+public:
+    /// Default constructor, empty
+    BulkArrayView() { }
+    /// Constructor, with record header and data (own, if set, holds storage)
+    BulkArrayView(const BulkArrayHeader& _H, const T* _p, std::shared_ptr<vector<char>> _own = nullptr):
+    H(_H), p(_p), own(_own) { }
+
+    /// record header
+    const BulkArrayHeader& header() const { return H; }
+    /// object kind
+    bulk_kind_t kind() const { return bulk_kind_t(H.kind); }
+    /// data pointer
+    const T* data() const { return p; }
+    /// number of elements
+    size_t size() const { return H.size(); }
+    /// dimension i
+    size_t dim(size_t i) const { return H.dims[i]; }
+    /// number of rows (matrix records)
+    size_t nRows() const { return H.dims[0]; }
+    /// number of columns (matrix records)
+    size_t nCols() const { return H.dims[1]; }
+    /// element access
+    const T& operator[](size_t i) const { return p[i]; }
+    /// column-major element access (matrix records)
+    const T& operator()(size_t r, size_t c) const { return p[r + c*H.dims[0]]; }
+    /// whether data is a zero-copy view into file
+    bool is_view() const { return !own; }
+
+    /// copy to VarVec
+    VarVec<T> toVarVec() const { return VarVec<T>(p, p + size()); }
+    /// copy to VarMat
+    VarMat<T> toVarMat() const {
+        if(H.kind != BULK_VARMAT && H.kind != BULK_ARRAY) throw std::runtime_error("Bulk array record is not a matrix");
+        VarMat<T> m(H.dims[0], H.dims[1]*H.dims[2]);
+        std::copy(p, p + size(), m.getData().getData().begin());
+        return m;
+    }
+
+protected:
+    BulkArrayHeader H;                  ///< record header
+    const T* p = nullptr;               ///< data
+    std::shared_ptr<vector<char>> own;  ///< decompressed storage, if not mapped
+};
+
+/// Memory-mapped file of bulk array records; mapped views remain valid while file is open
+class BulkArrayFile {
+public:
+    /// Constructor, mapping file and indexing records; decompression on nthreads (0 for all cores)
+    explicit BulkArrayFile(const string& fname, unsigned int nt = 0);
+
+    /// number of records
+    size_t size() const { return offsets.size(); }
+    /// header for record i
+    const BulkArrayHeader& header(size_t i) const { return *reinterpret_cast<const BulkArrayHeader*>(F.data() + offsets.at(i)); }
+
+    /// view of record i, with optional kind check
+    template<typename T>
+    BulkArrayView<T> view(size_t i, int kind = -1) const {
+        const auto& H = header(i);
+        if(H.eltype != bulk_eltype<T>::value) throw std::runtime_error("Bulk array record element type mismatch");
+        if(kind >= 0 && H.kind != kind) throw std::runtime_error("Bulk array record kind mismatch");
+        std::shared_ptr<vector<char>> own;
+        auto d = data(i, own);
+        return BulkArrayView<T>(H, reinterpret_cast<const T*>(d), own);
+    }
+
+    const unsigned int nthreads;    ///< decompression threads
+
+protected:
+    /// record i data, in mapped file or decompressed into own
+    const char* data(size_t i, std::shared_ptr<vector<char>>& own) const;
+
+    MappedFile F;                   ///< mapped file
+    vector<size_t> offsets;         ///< record header positions
+};
+
+#endif
@@ -22,34 +22,60 @@
  */
 
 #include "CMatrix.hh"
-
+#include "BulkArrayIO.hh"
+#include "fftwx.hh"
 
 #include <stdlib.h>
 #include <iomanip>
 #include <algorithm>
+#include <memory>
+#include <mutex>
 
 using std::cout;
 
 // FFT handler ------______------______-------_______------______------
 
-map<size_t,cmatrix_fft*> cmatrix_fft::ffters;
-
-cmatrix_fft::cmatrix_fft(size_t m): M(m), realspace(M), kspace(M/2+1) {
-    FILE* fin = fopen("fftw_wisdom","r");
-    if(fin) {
-        fftw_import_wisdom_from_file(fin);
-        fclose(fin);
+/// per-thread FFTW-aligned transform buffers
+struct cmatrix_fft_buffers {
+    fftw_real_vec<double> realspace;    ///< real-space side of transform data
+    fftw_cplx_vec<double> kspace;       ///< k-space side of transform data
+    /// resize for transforms of size m
+    void fit(size_t m) {
+        if(realspace.size() < m) realspace.resize(m);
+        if(kspace.size() < m/2+1) kspace.resize(m/2+1);
+    }
+};
+
+/// this thread's transform buffers
+static cmatrix_fft_buffers& thread_fft_buffers() {
+    static thread_local cmatrix_fft_buffers B;
+    return B;
+}
+
+cmatrix_fft::cmatrix_fft(size_t m): M(m) {
+    // planning with aligned buffers; SIMD alignment preserved by buffers used for each execution
+    cmatrix_fft_buffers B;
+    B.fit(M);
+
+    {
+        FFTWLOCK;
+        FILE* fin = fopen("fftw_wisdom","r");
+        if(fin) {
+            fftw_import_wisdom_from_file(fin);
+            fclose(fin);
+        }
     }
 
-    forwardplan = fftw_plan_dft_r2c_1d(M,
-                                       realspace.data(),
-                                       (fftw_complex*)kspace.data(),
-                                       FFTW_EXHAUSTIVE);
-    reverseplan = fftw_plan_dft_c2r_1d(M,
-                                       (fftw_complex*)kspace.data(),
-                                       realspace.data(),
-                                       FFTW_EXHAUSTIVE);
+    forwardplan = fftwx<double>::plan_dft_r2c_1d(M,
+                                                 B.realspace.data(),
+                                                 (fftw_complex*)B.kspace.data(),
+                                                 FFTW_EXHAUSTIVE);
+    reverseplan = fftwx<double>::plan_dft_c2r_1d(M,
+                                                 (fftw_complex*)B.kspace.data(),
+                                                 B.realspace.data(),
+                                                 FFTW_EXHAUSTIVE);
 
+    FFTWLOCK;
     FILE* fout = fopen("fftw_wisdom","w");
     if(fout) {
         fftw_export_wisdom_to_file(fout);
@@ -57,25 +83,54 @@ cmatrix_fft::cmatrix_fft(size_t m): M(m), realspace(M), kspace(M/2+1) {
     }
 }
 
-cmatrix_fft& cmatrix_fft::get_ffter(size_t m) {
-    auto it = ffters.find(m);
-    if(it != ffters.end()) return *(it->second);
-    cmatrix_fft* f = new cmatrix_fft(m);
-    ffters.emplace(m,f);
+void cmatrix_fft::forward(const double* r, complex<double>* k) const {
+    auto& B = thread_fft_buffers();
+    B.fit(M);
+    std::copy(r, r+M, B.realspace.begin());
+    fftwx<double>::execute_dft_r2c(forwardplan, B.realspace.data(), (fftw_complex*)B.kspace.data());
+    std::copy(B.kspace.begin(), B.kspace.begin()+(M/2+1), k);
+}
+
+void cmatrix_fft::reverse(const complex<double>* k, double* r) const {
+    auto& B = thread_fft_buffers();
+    B.fit(M);
+    std::copy(k, k+(M/2+1), B.kspace.begin()); // c2r destroys input
+    fftwx<double>::execute_dft_c2r(reverseplan, (fftw_complex*)B.kspace.data(), B.realspace.data());
+    std::copy(B.realspace.begin(), B.realspace.begin()+M, r);
+}
+
+const cmatrix_fft& cmatrix_fft::get_ffter(size_t m) {
+    // per-thread last-used lookup, avoiding lock on repeated sizes
+    static thread_local const cmatrix_fft* last = nullptr;
+    if(last && last->M == m) return *last;
+
+    static std::mutex ffters_mutex;
+    static map<size_t, std::unique_ptr<const cmatrix_fft>> ffters; // never released: shared by all threads
+    std::lock_guard<std::mutex> lk(ffters_mutex);
+    auto& f = ffters[m];
+    if(!f) f.reset(new cmatrix_fft(m));
+    last = f.get();
     return *f;
 }
 
+/// lock for lazy updates to CMatrix at p (striped over shared mutexes)
+static std::mutex& lazy_mutex(const void* p) {
+    static std::mutex mutexes[64];
+    return mutexes[(reinterpret_cast<size_t>(p) >> 6) % 64];
+}
+
 // File IO ------______------______-------_______------______------
 
 void CMatrix::writeToFile(ostream& o) const {
     writeString("(CMatrix)",o);
     o.write((char*)&M,                  sizeof(M));
-    o.write((char*)&has_realspace,      sizeof(has_realspace));
-    o.write((char*)&has_kspace,         sizeof(has_kspace));
+    const bool hr = has_realspace, hk = has_kspace;
+    o.write((char*)&hr,                 sizeof(hr));
+    o.write((char*)&hk,                 sizeof(hk));
 
-    if(has_realspace)
+    if(hr)
         o.write((char*)&data[0],        sizeof(data[0])*M);
-    if(has_kspace)
+    if(hk)
         o.write((char*)&kdata[0],       sizeof(kdata[0])*(M/2+1));
     writeString("(/CMatrix)",o);
 }
@@ -85,14 +140,17 @@ CMatrix CMatrix::readFromFile(std::istream& s) {
     checkString("(CMatrix)",s);
     CMatrix foo;
     s.read((char*)&foo.M,               sizeof(foo.M));
-    s.read((char*)&foo.has_realspace,   sizeof(foo.has_realspace));
-    s.read((char*)&foo.has_kspace,      sizeof(foo.has_realspace));
+    bool hr = false, hk = false;
+    s.read((char*)&hr,                  sizeof(hr));
+    s.read((char*)&hk,                  sizeof(hk));
+    foo.has_realspace = hr;
+    foo.has_kspace = hk;
 
-    if(foo.has_realspace) {
+    if(hr) {
         foo.data.resize(foo.M);
         s.read((char*)&foo.data[0],     sizeof(foo.data[0])*foo.M);
     }
-    if(foo.has_kspace) {
+    if(hk) {
         foo.kdata.resize(foo.M/2+1);
         s.read((char*)&foo.kdata[0],    sizeof(foo.kdata[0])*(foo.M/2+1));
     }
@@ -100,6 +158,35 @@ CMatrix CMatrix::readFromFile(std::istream& s) {
     return foo;
 }
 
+void CMatrix::writeBulk(BulkArrayWriter& W) const {
+    W.write(getRealData().data(), M, 1, 1, BULK_CMATRIX);
+}
+
+CMatrix CMatrix::readBulk(const BulkArrayView<double>& v) {
+    if(v.kind() != BULK_CMATRIX) throw std::runtime_error("Bulk array record is not a CMatrix");
+    CMatrix foo(v.size());
+    std::copy(v.data(), v.data() + v.size(), foo.data.begin());
+    foo.has_kspace = false;
+    return foo;
+}
+
+// Copying ------______------______-------_______------______------
+
+CMatrix::CMatrix(const CMatrix& m): BinaryOutputObject(m) {
+    *this = m;
+}
+
+CMatrix& CMatrix::operator=(const CMatrix& m) {
+    if(&m == this) return *this;
+    std::lock_guard<std::mutex> lk(lazy_mutex(&m));
+    M = m.M;
+    data = m.data;
+    kdata = m.kdata;
+    has_realspace = m.has_realspace;
+    has_kspace = m.has_kspace;
+    return *this;
+}
+
 // Special Matrices ------______------______-------_______------______------
 
 CMatrix CMatrix::identity(size_t M) {
@@ -126,20 +213,19 @@ void CMatrix::zero() const {
 }
 
 void CMatrix::calculateKData() const {
+    std::lock_guard<std::mutex> lk(lazy_mutex(this));
+    if(has_kspace) return; // calculated by another thread
     assert(has_realspace);
-    cmatrix_fft& ffter = cmatrix_fft::get_ffter(M);
-    std::copy(data.begin(), data.end(), ffter.realspace.begin());
-    fftw_execute(ffter.forwardplan);
-    std::copy(ffter.kspace.begin(), ffter.kspace.end(), kdata.begin());
+    cmatrix_fft::get_ffter(M).forward(data.data(), kdata.data());
     has_kspace = true;
 }
 
 void CMatrix::calculateRealData() const {
+    std::lock_guard<std::mutex> lk(lazy_mutex(this));
+    if(has_realspace) return; // calculated by another thread
     assert(has_kspace);
-    cmatrix_fft& ffter = cmatrix_fft::get_ffter(M);
-    std::copy(kdata.begin(), kdata.end(), ffter.kspace.begin());
-    fftw_execute(ffter.reverseplan);
-    for(size_t n=0; n<M; n++) data[n] = ffter.realspace[n]/double(M);
+    cmatrix_fft::get_ffter(M).reverse(kdata.data(), data.data());
+    for(size_t n=0; n<M; n++) data[n] /= double(M);
     has_realspace = true;
 }
 
@@ -363,20 +449,22 @@ const CMatrix CMatrix::operator*(const CMatrix& m) const {
 
 const VarVec<double> CMatrix::operator*(const VarVec<double>& v) const {
     assert(M>0 && v.size()==M);
-    const vector< complex<double> >& kd = getKData(); // make sure to do this first, since we need ffter's storage space after
+    const vector< complex<double> >& kd = getKData();
+    const cmatrix_fft& ffter = cmatrix_fft::get_ffter(M);
 
-    cmatrix_fft& ffter = cmatrix_fft::get_ffter(M);
-    ffter.realspace[0] = v[0];
-    for(size_t i=1; i<M; i++) ffter.realspace[i] = v[M - i];
-    fftw_execute(ffter.forwardplan);
+    vector<double> rv(M);
+    rv[0] = v[0];
+    for(size_t i=1; i<M; i++) rv[i] = v[M - i];
+    vector< complex<double> > kv(M/2+1);
+    ffter.forward(rv.data(), kv.data());
 
-    for(size_t i=0; i<kd.size(); i++) ffter.kspace[i] *= kd[i];
-    fftw_execute(ffter.reverseplan);
+    for(size_t i=0; i<kd.size(); i++) kv[i] *= kd[i];
+    ffter.reverse(kv.data(), rv.data());
 
     VarVec<double> out(M);
     if(!M) return out;
-    out[0] = ffter.realspace[0];
-    for(size_t i=1; i<M; i++) out[i] = ffter.realspace[M-i];
+    out[0] = rv[0];
+    for(size_t i=1; i<M; i++) out[i] = rv[M-i];
     out /= double(M);
     return out;
 }
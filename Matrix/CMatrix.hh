@@ -27,6 +27,7 @@
 
 #include <iostream>
 #include <fftw3.h>
+#include <atomic>
 #include <map>
 #include <complex.h>
 #include "VarVec.hh"
@@ -36,7 +37,11 @@ using std::vector;
 using std::map;
 using std::complex;
 
-/// Stores fftw data for FFT'ing
+class BulkArrayWriter;
+template<typename T>
+class BulkArrayView;
+
+/// Shared, immutable FFTW plans for one transform size; thread-safe and reentrant
 class cmatrix_fft {
 public:
     /// constructor
@@ -45,15 +50,31 @@ public:
     const size_t M;             ///< number of elements
     fftw_plan forwardplan;      ///< FFTW data for forward Fourier Transforms of this size
     fftw_plan reverseplan;      ///< FFTW data for inverse Fourier Transforms of this size
-    vector<double> realspace;   ///< array for holding real-space side of transform data
-    vector<complex<double>> kspace; ///< array for holding kspace-side of transform data
 
-    /// get FFTer for dimension m
-    static cmatrix_fft& get_ffter(size_t m);
+    /// forward transform of M real-space values r into M/2+1 k-space values k
+    void forward(const double* r, complex<double>* k) const;
+    /// reverse (unnormalized) transform of M/2+1 k-space values k into M real-space values r
+    void reverse(const complex<double>* k, double* r) const;
 
-protected:
+    /// get (cached, shared) FFTer for dimension m
+    static const cmatrix_fft& get_ffter(size_t m);
+};
 
-    static map<size_t,cmatrix_fft*> ffters;  ///< loaded FFTers
+/// copyable atomic flag, for lazily-computed CMatrix representations
+class cmatrix_flag {
+public:
+    /// constructor
+    cmatrix_flag(bool x = false): b(x) { }
+    /// copy constructor
+    cmatrix_flag(const cmatrix_flag& f): b(f.b.load(std::memory_order_acquire)) { }
+    /// copy assignment
+    cmatrix_flag& operator=(const cmatrix_flag& f) { return (*this = bool(f)); }
+    /// assignment (publishing data written before)
+    cmatrix_flag& operator=(bool x) { b.store(x, std::memory_order_release); return *this; }
+    /// value (seeing data published with it)
+    operator bool() const { return b.load(std::memory_order_acquire); }
+protected:
+    std::atomic<bool> b;    ///< flag value
 };
 
 namespace VarVec_element_IO {
@@ -62,6 +83,9 @@ namespace VarVec_element_IO {
 
     template<>
     inline complex<double> readFromFile(std::istream& s) { complex<double> x; s.read((char*)&x, sizeof(x)); return x; }
+
+    template<>
+    struct is_raw< complex<double> >: std::true_type { };
 }
 
 /// Circulant matrices
@@ -75,11 +99,21 @@ namespace VarVec_element_IO {
  * the necessary permutation of component order is automatically applied for vector multiplication.
  * The FFTs are performed by the <a href="http://www.fftw.org">FFTW library</a>,
  * which pre-calculates plans to expedite FFT'ing specific length data arrays. The CMatrix class keeps a cache of
- * the FFTW data needed for each size of CMatrix instantiated. */
+ * the FFTW data needed for each size of CMatrix instantiated, shared between threads.
+ * Const operations on a shared CMatrix may run concurrently (lazy representation updates are locked);
+ * modifying a CMatrix requires exclusive access, as for standard containers. */
 class CMatrix: public BinaryOutputObject {
 public:
     /// Constructor
     CMatrix(size_t m = 0): M(m), data(M,0.), kdata(M/2+1,0.), has_realspace(true), has_kspace(true) { }
+    /// copy constructor (consistent with concurrent lazy updates to m)
+    CMatrix(const CMatrix& m);
+    /// move constructor
+    CMatrix(CMatrix&& m) = default;
+    /// copy assignment (consistent with concurrent lazy updates to m)
+    CMatrix& operator=(const CMatrix& m);
+    /// move assignment
+    CMatrix& operator=(CMatrix&& m) = default;
 
     /// generate an identity CMatrix
     static CMatrix identity(size_t m);
@@ -107,6 +141,8 @@ public:
     /// trace of circulant matrix
     double trace() const;
 
+    /// whether the Fourier representation is already calculated
+    bool hasKData() const { return has_kspace; }
     /// Return a pointer to the CMatrix's Fourier representation
     vector< complex<double> >& getKData();
     /// Return a pointer to the CMatrix's Fourier representation (read only)
@@ -153,6 +189,10 @@ public:
     void writeToFile(ostream& o) const;
     /// Read binary data from file
     static CMatrix readFromFile(std::istream& s);
+    /// Write real-space data as bulk array record
+    void writeBulk(BulkArrayWriter& W) const;
+    /// Construct from bulk array record
+    static CMatrix readBulk(const BulkArrayView<double>& v);
 
 private:
 
@@ -168,8 +208,8 @@ private:
 
     mutable vector<double> data;                ///< real-space data
     mutable vector< complex<double> > kdata;    ///< K-space data
-    mutable bool has_realspace;                 ///< whether the real-space representation of this matrix has been calculated
-    mutable bool has_kspace;                    ///< whether the k-space representation of this matrix has been calculated
+    mutable cmatrix_flag has_realspace;         ///< whether the real-space representation of this matrix has been calculated
+    mutable cmatrix_flag has_kspace;            ///< whether the k-space representation of this matrix has been calculated
 };
 
 /// display CMatrix
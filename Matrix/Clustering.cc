@@ -6,47 +6,289 @@
 // -- Michael P. Mendenhall, 2015
 
 #include "Clustering.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
 #include <limits>
+#include <random>
+#include <stdexcept>
+#include <stdint.h>
 #include <cassert>
 
+/// points per SIMD kernel block
+static constexpr size_t cluster_block = 256;
+
+/// points per parallel chunk: multiple of block size, at most ~256 chunks
+static size_t cluster_chunk(size_t n) {
+    return std::max<size_t>(1 << 14, (n/256 + cluster_block - 1)/cluster_block*cluster_block);
+}
+
+/// run f(chunk number, i0, i1) over chunks of [0,n) on nthreads (0 for all cores); return number of chunks
+template<typename F>
+static size_t forChunks(size_t n, int nthreads, F f) {
+    const size_t ch = cluster_chunk(n);
+    const size_t nc = (n + ch - 1)/ch;
+    if(nthreads == 1 || nc < 2) {
+        for(size_t c = 0; c < nc; ++c) f(c, c*ch, std::min(n, (c + 1)*ch));
+        return nc;
+    }
+    WorkStealingPool P(std::max(nthreads, 0));
+    for(size_t c = 0; c < nc; ++c) P.submit([&f, c, ch, n] { f(c, c*ch, std::min(n, (c + 1)*ch)); });
+    P.wait_idle();
+    return nc;
+}
+
+/// pack points into coordinate-major array
+static void packSoA(const vector< VarVec<double> >& points, size_t dim, vector<double>& soa) {
+    const size_t n = points.size();
+    soa.resize(n*dim);
+    for(size_t i = 0; i < n; ++i) {
+        if(points[i].size() != dim) throw std::logic_error("Clustering points of inconsistent dimension");
+        for(size_t d = 0; d < dim; ++d) soa[d*n + i] = points[i][d];
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && !defined(__AVX2__)
+#define CLUSTERING_DISPATCH ///< runtime-selected AVX2 kernels
+#endif
+
+/// kernel bodies, compiled into generic and instruction-set-targeted wrappers
+#define CLUSTERING_INLINE static inline __attribute__((always_inline))
+
+/// nearest of nc centers cm[c*dim + d] for nb points x[d*N + b]
+CLUSTERING_INLINE void _nearest_block(const double* x, size_t N, size_t nb, size_t dim, size_t nc, const double* cm,
+                                      double* __restrict__ best, uint64_t* __restrict__ bestc, double* __restrict__ dist) {
+    for(size_t b = 0; b < nb; ++b) best[b] = std::numeric_limits<double>::max();
+    for(size_t c = 0; c < nc; ++c) {
+        for(size_t b = 0; b < nb; ++b) dist[b] = 0;
+        for(size_t d = 0; d < dim; ++d) {
+            const double* __restrict__ xd = x + d*N;
+            const double u = cm[c*dim + d];
+            for(size_t b = 0; b < nb; ++b) {
+                const double t = xd[b] - u;
+                dist[b] += t*t;
+            }
+        }
+        for(size_t b = 0; b < nb; ++b) {
+            const bool closer = dist[b] < best[b];
+            best[b] = closer? dist[b] : best[b];
+            bestc[b] = closer? c : bestc[b];
+        }
+    }
+}
+
+/// Gaussian log likelihoods lp[j*cluster_block + b] for m clusters with means mu[j*k + a],
+/// Cholesky factors L[j*k*k + a*k + c] (inverse diagonal), normalization c0[j]; z[k*cluster_block] scratch
+CLUSTERING_INLINE void _gauss_logprob(const double* x, size_t N, size_t nb, size_t k, size_t m,
+                                      const double* mu, const double* L, const double* c0,
+                                      double* __restrict__ z, double* __restrict__ lp) {
+    for(size_t j = 0; j < m; ++j) {
+        double* __restrict__ q = lp + j*cluster_block;
+        const double* Lj = L + j*k*k;
+        for(size_t b = 0; b < nb; ++b) q[b] = 0;
+        // forward substitution z = L^-1 (x - mu), q = |z|^2
+        for(size_t a = 0; a < k; ++a) {
+            double* __restrict__ za = z + a*cluster_block;
+            const double* __restrict__ xa = x + a*N;
+            const double u = mu[j*k + a];
+            for(size_t b = 0; b < nb; ++b) za[b] = xa[b] - u;
+            for(size_t c = 0; c < a; ++c) {
+                const double l = Lj[a*k + c];
+                const double* __restrict__ zc = z + c*cluster_block;
+                for(size_t b = 0; b < nb; ++b) za[b] -= l*zc[b];
+            }
+            const double il = Lj[a*k + a];
+            for(size_t b = 0; b < nb; ++b) {
+                za[b] *= il;
+                q[b] += za[b]*za[b];
+            }
+        }
+        for(size_t b = 0; b < nb; ++b) q[b] = c0[j] - 0.5*q[b];
+    }
+}
+
+#ifdef CLUSTERING_DISPATCH
+#define CLUSTERING_NEAREST_PARAMS (const double* x, size_t N, size_t nb, size_t dim, size_t nc, const double* cm, double* best, uint64_t* bestc, double* dist)
+#define CLUSTERING_NEAREST_ARGS (x, N, nb, dim, nc, cm, best, bestc, dist)
+__attribute__((target("avx2,fma"))) static void _nearest_block_avx2 CLUSTERING_NEAREST_PARAMS { _nearest_block CLUSTERING_NEAREST_ARGS; }
+#define CLUSTERING_GAUSS_PARAMS (const double* x, size_t N, size_t nb, size_t k, size_t m, const double* mu, const double* L, const double* c0, double* z, double* lp)
+#define CLUSTERING_GAUSS_ARGS (x, N, nb, k, m, mu, L, c0, z, lp)
+__attribute__((target("avx2,fma"))) static void _gauss_logprob_avx2 CLUSTERING_GAUSS_PARAMS { _gauss_logprob CLUSTERING_GAUSS_ARGS; }
+
+/// whether AVX2/FMA available
+static bool clustering_avx2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return avx2;
+}
+static void nearest_block CLUSTERING_NEAREST_PARAMS {
+    if(clustering_avx2()) _nearest_block_avx2 CLUSTERING_NEAREST_ARGS;
+    else _nearest_block CLUSTERING_NEAREST_ARGS;
+}
+static void gauss_logprob CLUSTERING_GAUSS_PARAMS {
+    if(clustering_avx2()) _gauss_logprob_avx2 CLUSTERING_GAUSS_ARGS;
+    else _gauss_logprob CLUSTERING_GAUSS_ARGS;
+}
+#else
+#define nearest_block _nearest_block
+#define gauss_logprob _gauss_logprob
+#endif
+
+////////////////////
+////////////////////
+////////////////////
+
+void KMeansCalculator::packPoints() {
+    packSoA(points, points.size()? points[0].size() : 0, soa);
+}
+
+size_t KMeansCalculator::checkPacked() {
+    const size_t dim = points.size()? points[0].size() : 0;
+    if(soa.size() != points.size()*dim) packPoints();
+    return dim;
+}
+
 void KMeansCalculator::calcClassCounts() {
-    printf("\tClassification counts:");
     class_counts = VarVec<unsigned int>(nmeans);
-    for(auto c: classification) class_counts[c]++;
+    for(auto c: classification) if(c < nmeans) class_counts[c]++;
+    if(!verbose) return;
+    printf("\tClassification counts:");
     for(unsigned int j=0; j<nmeans; j++) printf("\t[%u] %u", j, class_counts[j]);
     printf("\n");
 }
 
 void KMeansCalculator::calcMeans() {
-    class_means = vector< VarVec<double> >(nmeans, VarVec<double>(points[0].size()));
-    for(unsigned int i=0; i<points.size(); i++) {
-        unsigned int c = classification[i];
-        if(c >= nmeans) continue;
-        class_means[c] += points[i];
+    const size_t dim = checkPacked();
+    const size_t N = points.size();
+    if(classification.size() != N) throw std::logic_error("calcMeans requires classified points");
+
+    // per-chunk coordinate sums and counts by class
+    const size_t sz = nmeans*(dim + 1);
+    vector<double> sums(((N + cluster_chunk(N) - 1)/cluster_chunk(N))*sz);
+    size_t nc = forChunks(N, nthreads, [&](size_t ic, size_t i0, size_t i1) {
+        double* S = sums.data() + ic*sz;
+        for(size_t i = i0; i < i1; ++i) {
+            const unsigned int c = classification[i];
+            if(c >= nmeans) continue;
+            S[c*(dim + 1)] += 1;
+            for(size_t d = 0; d < dim; ++d) S[c*(dim + 1) + 1 + d] += soa[d*N + i];
+        }
+    });
+    for(size_t ic = 1; ic < nc; ++ic) for(size_t s = 0; s < sz; ++s) sums[s] += sums[ic*sz + s];
+
+    class_means.resize(nmeans);
+    for(unsigned int c=0; c<nmeans; c++) {
+        const double* S = sums.data() + c*(dim + 1);
+        class_counts[c] = S[0];
+        if(!S[0] && class_means[c].size() == dim) continue; // keep previous mean for empty class
+        class_means[c] = VarVec<double>(dim);
+        for(size_t d = 0; d < dim; ++d) class_means[c][d] = S[0]? S[1 + d]/S[0] : 0;
     }
-    for(unsigned int c=0; c<nmeans; c++) class_means[c] /= class_counts[c];
 }
 
 unsigned int KMeansCalculator::classify() {
-    vector<double> mindist(points.size(), std::numeric_limits<double>::max());
-    auto oldclass = classification;
-    unsigned int nreclassified = 0;
-    for(unsigned int i=0; i<points.size(); i++) {
-        for(unsigned int c=0; c<nmeans; c++) {
-            double d = (points[i] - class_means[c]).mag2();
-            if(d < mindist[i]) { mindist[i] = d; classification[i] = c; }
+    const size_t dim = checkPacked();
+    const size_t N = points.size();
+    classification.resize(N, nmeans);
+
+    vector<double> cm(nmeans*dim);
+    for(unsigned int c=0; c<nmeans; c++) for(size_t d = 0; d < dim; ++d) cm[c*dim + d] = class_means[c][d];
+
+    vector<size_t> nre((N + cluster_chunk(N) - 1)/cluster_chunk(N));
+    size_t nc = forChunks(N, nthreads, [&](size_t ic, size_t i0, size_t i1) {
+        double best[cluster_block], dist[cluster_block];
+        uint64_t bestc[cluster_block];
+        for(size_t j0 = i0; j0 < i1; j0 += cluster_block) {
+            const size_t nb = std::min(cluster_block, i1 - j0);
+            for(size_t b = 0; b < nb; ++b) bestc[b] = classification[j0 + b];
+            nearest_block(soa.data() + j0, N, nb, dim, nmeans, cm.data(), best, bestc, dist);
+            for(size_t b = 0; b < nb; ++b) {
+                if(bestc[b] != classification[j0 + b]) nre[ic]++;
+                classification[j0 + b] = bestc[b];
+            }
         }
-        if(classification[i] != oldclass[i]) nreclassified++;
-    }
+    });
+
+    unsigned int nreclassified = 0;
+    for(size_t ic = 0; ic < nc; ++ic) nreclassified += nre[ic];
     calcClassCounts();
     return nreclassified;
 }
 
+void KMeansCalculator::seedPlusPlus(unsigned int seed, unsigned int ntrials) {
+    const size_t dim = checkPacked();
+    const size_t N = points.size();
+    if(N < nmeans) throw std::logic_error("Fewer points than requested means");
+    if(!ntrials) ntrials = 2 + (unsigned int)log(nmeans);
+
+    std::mt19937_64 R(seed);
+    class_means.assign(nmeans, VarVec<double>());
+    vector<double> d2(N, std::numeric_limits<double>::max());
+    const size_t ch = cluster_chunk(N);
+    const size_t nc = (N + ch - 1)/ch;
+    vector<double> csum(nc*ntrials);
+
+    // sums over chunks of min(d2, squared distance to each candidate); optionally update d2
+    auto potential = [&](const vector<size_t>& cands, bool update) {
+        vector<double> cm(cands.size()*dim);
+        for(size_t t = 0; t < cands.size(); ++t) for(size_t d = 0; d < dim; ++d) cm[t*dim + d] = soa[d*N + cands[t]];
+        forChunks(N, nthreads, [&](size_t ic, size_t i0, size_t i1) {
+            double best[cluster_block], dist[cluster_block];
+            uint64_t bestc[cluster_block];
+            for(size_t t = 0; t < cands.size(); ++t) {
+                double s = 0;
+                for(size_t j0 = i0; j0 < i1; j0 += cluster_block) {
+                    const size_t nb = std::min(cluster_block, i1 - j0);
+                    nearest_block(soa.data() + j0, N, nb, dim, 1, cm.data() + t*dim, best, bestc, dist);
+                    for(size_t b = 0; b < nb; ++b) {
+                        const double dd = std::min(d2[j0 + b], best[b]);
+                        if(update) d2[j0 + b] = dd;
+                        s += dd;
+                    }
+                }
+                csum[ic*ntrials + t] = s;
+            }
+        });
+        vector<double> tot(cands.size());
+        for(size_t ic = 0; ic < nc; ++ic) for(size_t t = 0; t < cands.size(); ++t) tot[t] += csum[ic*ntrials + t];
+        return tot;
+    };
+
+    vector<size_t> chosen(1, std::uniform_int_distribution<size_t>(0, N - 1)(R));
+    double tot = potential(chosen, true)[0];
+    class_means[0] = points[chosen[0]];
+
+    for(unsigned int c = 1; c < nmeans; ++c) {
+        // D^2-weighted draws of candidates, from chunk sums then within chunk
+        vector<size_t> cands(ntrials);
+        for(auto& i: cands) {
+            if(!(tot > 0)) { i = std::uniform_int_distribution<size_t>(0, N - 1)(R); continue; }
+            double r = std::uniform_real_distribution<double>(0, tot)(R);
+            size_t ic = 0;
+            while(ic + 1 < nc && r >= csum[ic*ntrials]) r -= csum[(ic++)*ntrials];
+            i = std::min(N, (ic + 1)*ch) - 1;
+            for(size_t j = ic*ch; j < std::min(N, (ic + 1)*ch); ++j) {
+                if(r < d2[j]) { i = j; break; }
+                r -= d2[j];
+            }
+        }
+
+        // keep candidate most reducing total potential
+        if(ntrials > 1) {
+            auto pt = potential(cands, false);
+            chosen[0] = cands[std::min_element(pt.begin(), pt.end()) - pt.begin()];
+        } else chosen[0] = cands[0];
+        tot = potential(chosen, true)[0];
+        class_means[c] = points[chosen[0]];
+    }
+
+    classification.assign(N, nmeans);
+    classify();
+}
+
 unsigned int KMeansCalculator::kMeans_step() {
-    printf("k-means step...");
+    if(verbose) printf("k-means step...");
     calcMeans();
     unsigned int nreclassified = classify();
-    printf(" %u reclassified.\n",nreclassified);
+    if(verbose) printf(" %u reclassified.\n",nreclassified);
     return nreclassified;
 }
 
@@ -63,80 +305,216 @@ vector<double> KMeansCalculator::calcVariance() const {
 
 void EMClusterer::init() {
     n = points.size();
-    f = VarMat<double>(m,n);
-    T = VarMat<double>(m,n);
+    classification.resize(n);
+    if(storeProbs) {
+        f = VarMat<double>(n,m);
+        T = VarMat<double>(m,n);
+    }
     mu.resize(m);
+    Sigma.resize(m);
     iSigma.resize(m);
     detSigma.resize(m);
+    packSoA(points, k, soa);
+    calcInverses();
+}
+
+void EMClusterer::calcInverses() {
+    if(mu.size() != m || Sigma.size() != m || tau.size() != m) throw std::logic_error("EMClusterer parameters not initialized");
+    iSigma.resize(m);
+    detSigma.resize(m);
+    logdetSigma.resize(m);
+    chol.resize(m*k*k);
+    lpnorm.resize(m);
+    mupack.resize(m*k);
+    for(size_t j=0; j<m; j++) {
+        if(mu[j].size() != k || Sigma[j].nRows() != k || Sigma[j].nCols() != k) throw std::logic_error("EMClusterer parameter dimension mismatch");
+        for(size_t a = 0; a < k; ++a) mupack[j*k + a] = mu[j][a];
+
+        // Cholesky decomposition Sigma = L L^T
+        double* L = chol.data() + j*k*k;
+        std::fill(L, L + k*k, 0.);
+        double ld = 0;
+        for(size_t a = 0; a < k; ++a) {
+            for(size_t c = 0; c <= a; ++c) {
+                double s = Sigma[j](a,c);
+                for(size_t e = 0; e < c; ++e) s -= L[a*k + e]*L[c*k + e];
+                if(c < a) L[a*k + c] = s*L[c*k + c];
+                else {
+                    if(!(s > 0)) throw std::runtime_error("EMClusterer covariance not positive-definite");
+                    ld += log(s);
+                    L[a*k + a] = 1/sqrt(s);
+                }
+            }
+        }
+        logdetSigma[j] = ld;
+        detSigma[j] = exp(ld);
+        lpnorm[j] = log(tau[j]) - 0.5*(ld + k*log(2*M_PI));
+        iSigma[j] = Sigma[j];
+        iSigma[j].invert();
+    }
 }
 
 double EMClusterer::logprob(const VarVec<double>& x, unsigned int j) const {
     assert(j<m);
     auto xm = x - mu[j];
-    return -xm.dot(iSigma[j]*xm)/2 - 0.5*(log(detSigma[j]) + k*log(2*M_PI));
+    return -xm.dot(iSigma[j]*xm)/2 - 0.5*(logdetSigma[j] + k*log(2*M_PI));
 }
 
 void EMClusterer::initFromKMeans(const KMeansCalculator& K) {
     points = K.points;
     n = points.size();
+    classification = K.classification;
     classification.resize(n);
     mu = K.class_means;
     tau = convertType<unsigned int, double>(K.class_counts)/n;
 
     iSigma.clear();
     Sigma.clear();
-    detSigma.clear();
     auto sig2 = K.calcVariance();
-    for(size_t j=0; j<m; j++) {
-        Sigma.push_back(VarMat<double>::identity(k, sig2[j], 0));
-        iSigma.push_back(VarMat<double>::identity(k, 1./sig2[j], 0));
-        detSigma.push_back(1./pow(sig2[j],k));
+    for(size_t j=0; j<m; j++) Sigma.push_back(VarMat<double>::identity(k, sig2[j], 0));
+
+    if(storeProbs) {
+        f = VarMat<double>(n,m);
+        T = VarMat<double>(m,n);
     }
+    if(K.soa.size() == n*k) soa = K.soa;
+    else packSoA(points, k, soa);
+    calcInverses();
+}
 
-    f = VarMat<double>(n,m);
-    T = VarMat<double>(m,n);
+void EMClusterer::blockLogProb(size_t i0, size_t nb, double* lp, double* z) const {
+    gauss_logprob(soa.data() + i0, n, nb, k, m, mupack.data(), chol.data(), lpnorm.data(), z, lp);
 }
 
 double EMClusterer::logL() const {
-    double ll = 0;
-    for(unsigned int i=0; i<n; i++) {
-        unsigned int j = classification[i];
-        ll += log(tau[j]) + logprob(points[i],j);
-    }
-    return ll;
+    vector<double> ll((n + cluster_chunk(n) - 1)/cluster_chunk(n));
+    size_t nc = forChunks(n, nthreads, [&](size_t ic, size_t i0, size_t i1) {
+        vector<double> lp(m*cluster_block), z(k*cluster_block);
+        for(size_t j0 = i0; j0 < i1; j0 += cluster_block) {
+            const size_t nb = std::min(cluster_block, i1 - j0);
+            blockLogProb(j0, nb, lp.data(), z.data());
+            for(size_t b = 0; b < nb; ++b) ll[ic] += lp[classification[j0 + b]*cluster_block + b];
+        }
+    });
+    double s = 0;
+    for(size_t ic = 0; ic < nc; ++ic) s += ll[ic];
+    return s;
 }
 
 void EMClusterer::E_step() {
-    for(size_t i=0; i<n; i++) {
-        double denom = 0;
-        for(size_t j=0; j<m; j++) {
-            f(i,j) = prob(points[i],j);
-            denom +=  tau[j]*f(i,j);
-        }
-        assert(denom);
-        double bestprob = -1;
-        for(size_t j=0; j<m; j++) {
-            T(j,i) =  tau[j]*f(i,j)/denom;
-            if(T(j,i) > bestprob) { bestprob = T(j,i); classification[i] = j; }
-        }
+    if(soa.size() != n*k) packSoA(points, k, soa);
+    if(storeProbs && (T.nRows() != m || T.nCols() != n)) {
+        f = VarMat<double>(n,m);
+        T = VarMat<double>(m,n);
     }
+    classification.resize(n);
+
+    // per-chunk statistics: weight, first moment, upper-triangle second moments about mu
+    const size_t nk2 = k*(k + 1)/2;
+    const size_t sz = m*(1 + k + nk2) + 1;
+    vector<double> cstats(((n + cluster_chunk(n) - 1)/cluster_chunk(n))*sz);
+
+    size_t nc = forChunks(n, nthreads, [&](size_t ic, size_t i0, size_t i1) {
+        vector<double> lp(m*cluster_block), z(k*cluster_block), u(k*cluster_block);
+        double mx[cluster_block], sw[cluster_block];
+        uint64_t jmx[cluster_block];
+        uint32_t nz[cluster_block];
+        double* S = cstats.data() + ic*sz;
+        for(size_t j0 = i0; j0 < i1; j0 += cluster_block) {
+            const size_t nb = std::min(cluster_block, i1 - j0);
+            blockLogProb(j0, nb, lp.data(), z.data());
+
+            // normalize to T by log-sum-exp, vectorized over block points
+            for(size_t b = 0; b < nb; ++b) { mx[b] = -std::numeric_limits<double>::infinity(); jmx[b] = 0; }
+            for(size_t j=0; j<m; j++) {
+                const double* q = lp.data() + j*cluster_block;
+                for(size_t b = 0; b < nb; ++b) {
+                    const bool gt = q[b] > mx[b];
+                    mx[b] = gt? q[b] : mx[b];
+                    jmx[b] = gt? j : jmx[b];
+                }
+            }
+            for(size_t b = 0; b < nb; ++b) {
+                assert(mx[b] > -std::numeric_limits<double>::infinity());
+                classification[j0 + b] = jmx[b];
+                sw[b] = 0;
+            }
+            if(storeProbs) for(size_t j=0; j<m; j++) for(size_t b = 0; b < nb; ++b) f(j0 + b, j) = tau[j]? exp(lp[j*cluster_block + b] - log(tau[j])) : 0;
+            for(size_t j=0; j<m; j++) {
+                double* q = lp.data() + j*cluster_block;
+                for(size_t b = 0; b < nb; ++b) {
+                    // responsibilities below ~1e-16 of largest are zeroed, skipping exp and far-cluster sums
+                    const double d = q[b] - mx[b];
+                    sw[b] += (q[b] = d > -36.8? exp(d) : 0);
+                }
+            }
+            for(size_t b = 0; b < nb; ++b) {
+                S[sz - 1] += mx[b] + log(sw[b]);
+                sw[b] = 1/sw[b];
+            }
+            for(size_t j=0; j<m; j++) for(size_t b = 0; b < nb; ++b) lp[j*cluster_block + b] *= sw[b];
+
+            // accumulate weighted moments over points with non-zero responsibility
+            for(size_t j=0; j<m; j++) {
+                double* t = lp.data() + j*cluster_block;
+                if(storeProbs) for(size_t b = 0; b < nb; ++b) T(j, j0 + b) = t[b];
+                size_t nnz = 0;
+                for(size_t b = 0; b < nb; ++b) if(t[b]) { t[nnz] = t[b]; nz[nnz++] = b; }
+                if(!nnz) continue;
+
+                double* Sj = S + j*(1 + k + nk2);
+                double w = 0;
+                for(size_t b = 0; b < nnz; ++b) w += t[b];
+                Sj[0] += w;
+                for(size_t a = 0; a < k; ++a) {
+                    const double* xa = soa.data() + a*n + j0;
+                    double* ua = u.data() + a*cluster_block;
+                    const double mua = mupack[j*k + a];
+                    double s1 = 0;
+                    for(size_t b = 0; b < nnz; ++b) {
+                        ua[b] = xa[nz[b]] - mua;
+                        s1 += t[b]*ua[b];
+                    }
+                    Sj[1 + a] += s1;
+                }
+                double* S2 = Sj + 1 + k;
+                for(size_t a = 0; a < k; ++a) {
+                    const double* ua = u.data() + a*cluster_block;
+                    for(size_t c = a; c < k; ++c) {
+                        const double* uc = u.data() + c*cluster_block;
+                        double s2 = 0;
+                        for(size_t b = 0; b < nnz; ++b) s2 += t[b]*ua[b]*uc[b];
+                        *(S2++) += s2;
+                    }
+                }
+            }
+        }
+    });
+
+    stats.assign(cstats.begin(), cstats.begin() + sz);
+    for(size_t ic = 1; ic < nc; ++ic) for(size_t s = 0; s < sz; ++s) stats[s] += cstats[ic*sz + s];
+    mixLogL = stats[sz - 1];
 }
 
 void EMClusterer::M_step() {
-    tau = T.getRowSum()/n;
+    const size_t nk2 = k*(k + 1)/2;
+    if(stats.size() != m*(1 + k + nk2) + 1) throw std::logic_error("M_step requires preceding E_step");
     for(size_t j=0; j<m; j++) {
-        mu[j].zero();
-        for(size_t i=0; i<n; i++) mu[j] += points[i]*T(j,i);
-        mu[j] /= n*tau[j];
-
-        Sigma[j].zero();
-        for(size_t i=0; i<n; i++) {
-            auto xu = points[i]-mu[j];
-            Sigma[j] += outer(xu,xu)*T(j,i);
-        }
-        Sigma[j] /= n*tau[j];
+        const double* Sj = stats.data() + j*(1 + k + nk2);
+        const double w = Sj[0];
+        tau[j] = w/n;
+        if(!w) continue; // keep parameters for empty cluster
 
-        iSigma[j] = Sigma[j]; iSigma[j].invert();
-        detSigma[j] = Sigma[j].det();
+        // mean shift from previous mean; covariance about new mean
+        VarVec<double> dmu(k);
+        for(size_t a = 0; a < k; ++a) dmu[a] = Sj[1 + a]/w;
+        const double* S2 = Sj + 1 + k;
+        for(size_t a = 0; a < k; ++a) {
+            for(size_t c = a; c < k; ++c) {
+                Sigma[j](a,c) = Sigma[j](c,a) = *(S2++)/w - dmu[a]*dmu[c];
+            }
+        }
+        mu[j] += dmu;
     }
+    calcInverses();
 }
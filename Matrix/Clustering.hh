@@ -11,6 +11,11 @@
 #include "VarMat.hh"
 
 /// Class for k-means segmentation
+/**
+    Points are packed into coordinate-major (SoA) storage for blocked distance kernels;
+    assignment and update passes run over fixed-size point chunks on nthreads,
+    with per-chunk partial sums merged in chunk order (results independent of thread count).
+*/
 class KMeansCalculator {
 public:
     /// Constructor
@@ -24,20 +29,39 @@ public:
     void calcMeans();
     /// count points in each class
     void calcClassCounts();
+    /// k-means++ initial means (D^2-weighted random choice from points), then classify;
+    /// "greedy" variant keeping best of ntrials candidates per mean (0 for 2 + log(nmeans); 1 for plain k-means++)
+    void seedPlusPlus(unsigned int seed = 0, unsigned int ntrials = 0);
 
     /// calculate variance (mean squared deviation) in each class
     vector<double> calcVariance() const;
 
+    /// (re-)pack points into SoA storage; automatic on size change, required after modifying points in place
+    void packPoints();
+
     const unsigned int nmeans;                          ///< number of means
+    int nthreads = 0;                                   ///< number of threads (0 for all cores)
+    bool verbose = true;                                ///< print progress and class counts
 
     vector< VarVec<double> > points;                    ///< points being classified
     vector<unsigned int> classification;                ///< k-means classification for each point
 
     VarVec<unsigned int> class_counts;                  ///< counts in each class
     vector< VarVec<double> > class_means;               ///< means for each class
+
+    vector<double> soa;                                 ///< packed coordinates soa[d*points.size() + i]
+
+protected:
+    /// pack points if needed; return dimension
+    size_t checkPacked();
 };
 
 /// Class for Expectation-maximization clustering
+/**
+    The E-step evaluates Gaussian log-likelihoods for blocks of SoA-packed points
+    (Cholesky-factored covariances), normalizes by log-sum-exp, and accumulates per-chunk
+    weighted moment sums about the current means, from which M_step updates parameters.
+*/
 class EMClusterer {
 public:
     /// Constructor
@@ -52,20 +76,22 @@ public:
     /// perform step
     void step() { if(!n) init(); E_step(); M_step(); }
 
-    /// log probability of point being in cluster j
+    /// log probability of point being in cluster j (excluding tau[j])
     double logprob(const VarVec<double>& x, unsigned int j) const;
     /// probability of point being in cluster j
     double prob(const VarVec<double>& x, unsigned int j) const  { return exp(logprob(x,j)); }
 
-    /// log likelihood of current solution
+    /// log likelihood of current solution, given classification
     double logL() const;
 
-    /// Array initialization
+    /// Array initialization; uses supplied mu, Sigma, tau
     void init();
     /// "Expectation" calculation step
     void E_step();
-    /// "Maximization" caclualtion step
+    /// "Maximization" caclualtion step, from statistics accumulated in E_step
     void M_step();
+    /// update iSigma, detSigma, and likelihood kernel factors from mu, Sigma, tau
+    void calcInverses();
 
     vector< VarVec<double> > points;    ///< points being classified
     vector<unsigned int> classification;///< points' most likely class
@@ -77,9 +103,24 @@ public:
     vector< VarMat<double> > Sigma;     ///< covariance matrix for each class
     vector< VarMat<double> > iSigma;    ///< covariance matrix inverse for each class
     vector<double> detSigma;            ///< covariance matrix determinant for each class
+    vector<double> logdetSigma;         ///< log covariance matrix determinant for each class
     VarVec<double> tau;                 ///< proportion in each cluster
-    VarMat<double> f;                   ///< probabilities for each point's assignment
-    VarMat<double> T;                   ///< conditional distribution
+    VarMat<double> f;                   ///< probabilities for each point's assignment f(i,j)
+    VarMat<double> T;                   ///< conditional distribution T(j,i)
+
+    int nthreads = 0;                   ///< number of threads (0 for all cores)
+    bool storeProbs = true;             ///< whether E_step fills f, T (n*m each; disable for large problems)
+    double mixLogL = 0;                 ///< mixture log likelihood sum_i log sum_j tau_j p_j(x_i), from last E_step
+    vector<double> soa;                 ///< packed coordinates soa[d*n + i]
+
+protected:
+    /// fill lp[j*blocksize + b] = log(tau_j p_j(x_{i0+b})) for nb points
+    void blockLogProb(size_t i0, size_t nb, double* lp, double* z) const;
+
+    vector<double> mupack;              ///< packed means mu[j][a] at j*k + a
+    vector<double> chol;                ///< per-cluster Cholesky factors L_j (row-major k*k, 1/L_aa on diagonal)
+    vector<double> lpnorm;              ///< per-cluster log(tau_j) - (log det Sigma_j + k log 2 pi)/2
+    vector<double> stats;               ///< per-cluster E_step sums of T, T*(x-mu), T*(x-mu)(x-mu)^T (upper triangle)
 };
 
 #endif
@@ -24,6 +24,8 @@
 #define COORDTRANSFORM_HH
 
 #include "Matrix.hh"
+#include <algorithm>
+#include <array>
 
 /// A templatized rotation+translation coordinate tranform
 /**
@@ -36,7 +38,8 @@
  * [T'] [T] R = [T' + T] R
  * R' [T] R = [R' T] R' R
  * [T'] R' [T] R = [T' + R' T] R' R
- * where, for orthogonal R, R^-1 = transpose(R) --- though this algebra also works for general matrices M
+ * where, for orthogonal R, R^-1 = transpose(R) --- though this algebra also works for general matrices M.
+ * Any chain of transforms thus fuses to a single affine [T] R, applied to point batches with one matrix product each.
  */
 template<unsigned int N, typename T>
 class CoordTransform {
@@ -54,18 +57,96 @@ public:
     CoordTransform<N,T>& operator+=(const Vec<N,T>& v) { dx += v; return *this; }
     /// Left-multiplied composition this = other * this
     CoordTransform<N,T>& operator*=(const CoordTransform<N,T>& other) { return ((*this *= other.R) += other.dx); }
+    /// Fused composition (this * rhs), applying rhs first
+    CoordTransform<N,T> operator*(const CoordTransform<N,T>& rhs) const { auto c = rhs; return c *= *this; }
 
     /// Apply to position
     Vec<N,T> operator*(const Vec<N,T>& rhs) const { return dx + (R*rhs); }
     /// Apply rotation to vector
     Vec<N,T> rotate(const Vec<N,T>& rhs) const { return R*rhs; }
 
+    /// get offset
+    const Vec<N,T>& getOffset() const { return dx; }
+    /// get rotation matrix
+    const Matrix<N,N,T>& getMatrix() const { return R; }
+
+    /// structure-of-arrays point batch: pointers to each coordinate's array
+    typedef std::array<const T*, N> soa_in_t;
+    /// structure-of-arrays output batch
+    typedef std::array<T*, N> soa_out_t;
+
+    /// Apply to n positions in SoA layout; out may be identical to in, otherwise not overlapping
+    void apply(const soa_in_t& in, const soa_out_t& out, size_t n) const { _apply<true>(in, out, n); }
+    /// Apply to n positions in SoA layout, in place
+    void apply(const soa_out_t& p, size_t n) const { _apply<true>(soa_in(p), p, n); }
+    /// Apply rotation to n vectors in SoA layout; out may be identical to in, otherwise not overlapping
+    void rotate(const soa_in_t& in, const soa_out_t& out, size_t n) const { _apply<false>(in, out, n); }
+    /// Apply rotation to n vectors in SoA layout, in place
+    void rotate(const soa_out_t& p, size_t n) const { _apply<false>(soa_in(p), p, n); }
+    /// Apply to n positions in AoS layout; out may be identical to in
+    void apply(const Vec<N,T>* in, Vec<N,T>* out, size_t n) const { _apply<true>(in, out, n); }
+    /// Apply rotation to n vectors in AoS layout; out may be identical to in
+    void rotate(const Vec<N,T>* in, Vec<N,T>* out, size_t n) const { _apply<false>(in, out, n); }
+
 private:
     /// Constructor from components
     CoordTransform(const Vec<N,T>& dx0, const Matrix<N,N,T> R0): dx(dx0), R(R0) { }
 
     Vec<N,T> dx;        ///< offset
     Matrix<N,N,T> R;    ///< rotation
+
+    /// const view of SoA output batch
+    static soa_in_t soa_in(const soa_out_t& p) { soa_in_t c; std::copy(p.begin(), p.end(), c.begin()); return c; }
+
+    /// batch application over n points, coordinate j of point k at in[j][k*stride] (stride 1 for SoA, N for AoS)
+    template<bool translate, size_t stride>
+    void _apply(const soa_in_t& in, const soa_out_t& out, size_t n) const {
+        T r[N][N], o[N];
+        for(size_t i = 0; i < N; i++) {
+            o[i] = translate? dx[i] : T{};
+            for(size_t j = 0; j < N; j++) r[i][j] = R(i,j);
+        }
+        for(size_t k = 0; k < n; k++) {
+            const size_t kk = k*stride;
+            T x[N];
+            for(size_t j = 0; j < N; j++) x[j] = in[j][kk];
+            for(size_t i = 0; i < N; i++) {
+                T y = o[i];
+                for(size_t j = 0; j < N; j++) y += r[i][j]*x[j];
+                out[i][kk] = y;
+            }
+        }
+    }
+
+    /// SoA batch application, by cache-resident blocks through local buffer (so compiler need not check aliasing)
+    template<bool translate>
+    void _apply(soa_in_t in, soa_out_t out, size_t n) const {
+        static constexpr size_t nblock = 256;
+        T buf[N][nblock];
+        soa_out_t pbuf;
+        for(size_t i = 0; i < N; i++) pbuf[i] = buf[i];
+        for(size_t k0 = 0; k0 < n; k0 += nblock) {
+            const size_t m = std::min(nblock, n - k0);
+            _apply<translate,1>(in, pbuf, m);
+            for(size_t i = 0; i < N; i++) {
+                std::copy(buf[i], buf[i] + m, out[i]);
+                in[i] += m;
+                out[i] += m;
+            }
+        }
+    }
+
+    /// AoS batch application
+    template<bool translate>
+    void _apply(const Vec<N,T>* in, Vec<N,T>* out, size_t n) const {
+        soa_in_t pin;
+        soa_out_t pout;
+        for(size_t j = 0; j < N; j++) {
+            pin[j] = n? &in[0][j] : nullptr;
+            pout[j] = n? &out[0][j] : nullptr;
+        }
+        _apply<translate,N>(pin, pout, n);
+    }
 };
 
 #endif
@@ -42,20 +42,20 @@ template<>
 varinit(Mat_Ops_Complex<lapack_complex_double>::f_gemm) = &cblas_zgemm;
 
 template<>
-varinit(LAPACKE_Matrix_SVD<double COMMA double>::f_gebrd) = &LAPACKE_dgebrd;
+varinit(LAPACKE_Matrix_SVD<double COMMA double>::f_gebrd) = &LAPACKE_dgebrd_work;
 template<>
-varinit(LAPACKE_Matrix_SVD<double COMMA double>::f_bdsqr) = &LAPACKE_dbdsqr;
+varinit(LAPACKE_Matrix_SVD<double COMMA double>::f_bdsqr) = &LAPACKE_dbdsqr_work;
 template<>
-varinit(LAPACKE_Matrix_SVD<double COMMA double>::f_orgbr) = &LAPACKE_dorgbr;
+varinit(LAPACKE_Matrix_SVD<double COMMA double>::f_orgbr) = &LAPACKE_dorgbr_work;
 template<>
 varinit(LAPACKE_Matrix_SVD<double COMMA double>::myOps) = new Mat_Ops_Real<double>();
 
 template<>
-varinit(LAPACKE_Matrix_SVD<double COMMA lapack_complex_double >::f_gebrd) = &LAPACKE_zgebrd;
+varinit(LAPACKE_Matrix_SVD<double COMMA lapack_complex_double >::f_gebrd) = &LAPACKE_zgebrd_work;
 template<>
-varinit(LAPACKE_Matrix_SVD<double COMMA lapack_complex_double >::f_bdsqr) = &LAPACKE_zbdsqr;
+varinit(LAPACKE_Matrix_SVD<double COMMA lapack_complex_double >::f_bdsqr) = &LAPACKE_zbdsqr_work;
 template<>
-varinit(LAPACKE_Matrix_SVD<double COMMA lapack_complex_double >::f_orgbr) = &LAPACKE_zungbr;
+varinit(LAPACKE_Matrix_SVD<double COMMA lapack_complex_double >::f_orgbr) = &LAPACKE_zungbr_work;
 template<>
 Mat_Ops<lapack_complex_double>* LAPACKE_Matrix_SVD<double, lapack_complex_double >::myOps = new Mat_Ops_Complex<lapack_complex_double>();
 
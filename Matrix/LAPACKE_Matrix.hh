@@ -155,47 +155,89 @@ public:
 
 
 
+/// Reusable scratch space for LAPACKE_Matrix_SVD, grown as needed (one per thread for concurrent decompositions)
+template<typename T, typename CT>
+struct LAPACKE_SVD_Workspace {
+    vector<T> e;        ///< secondary diagonal
+    vector<CT> tauQ;    ///< Q reflector factors
+    vector<CT> tauP;    ///< P reflector factors
+    vector<CT> work;    ///< ?gebrd and ?orgbr workspace
+    vector<T> rwork;    ///< ?bdsqr (real) workspace
+
+    /// size for min(m,n) = k
+    void fit(size_t k) {
+        k = std::max(k, (size_t)1);
+        if(e.size() < k) e.resize(k);
+        if(tauQ.size() < k) tauQ.resize(k);
+        if(tauP.size() < k) tauP.resize(k);
+        if(rwork.size() < 4*k) rwork.resize(4*k);
+    }
+    /// size work for optimal length returned by workspace query
+    void fitWork(const CT& q) {
+        const size_t n = std::max(std::abs(q), T(1));
+        if(work.size() < n) work.resize(n);
+    }
+};
+
 /// Templatized wrapper for SVD of matrix A = U S V^T
 template<typename T, typename CT>
 class LAPACKE_Matrix_SVD: public BinaryOutputObject {
 public:
-    /// Constructor
-    explicit LAPACKE_Matrix_SVD(VarMat<CT>& A): S(std::min(A.nRows(), A.nCols()),1), U(A.nRows(), S.nRows()), VT(S.nRows(), A.nCols()), PsI(nullptr), PsI_epsilon(0) {
+    /// scratch space type
+    typedef LAPACKE_SVD_Workspace<T,CT> workspace_t;
+
+    /// Constructor, optionally re-using scratch space W (else allocated for this decomposition)
+    explicit LAPACKE_Matrix_SVD(VarMat<CT>& A, workspace_t* W = nullptr): S(std::min(A.nRows(), A.nCols()),1), U(A.nRows(), S.nRows()), VT(S.nRows(), A.nCols()), PsI(nullptr), PsI_epsilon(0) {
 
         lapack_int info;
         const bool verbose = false;
 
+        workspace_t W0;
+        if(!W) W = &W0;
+        W->fit(S.nRows());
+
         char diag = (A.nRows() >= A.nCols() ? 'U':'L');    // upper or lower diagonal reduction, depending on A's dimensions
-        VarMat<T> e(std::max(S.nRows()-1, (size_t)1),1);   // holder for secondary diagonal
-        CT* tauQ = new CT[S.nRows()];
-        CT* tauP = new CT[S.nRows()];
+        T* e = W->e.data();         // holder for secondary diagonal
+        CT* tauQ = W->tauQ.data();
+        CT* tauP = W->tauP.data();
+        CT wq;                      // workspace size query result
 
         // overall reduce general A = (U*Q) * S * (P^H * V^T)
 
         // decomposes m*n A = Q B P^H,  Q and P unitary, B bidiagonal of min(m,n)*min(m,n)
         // over-writes A with B on diagonals, P above, and Q below.
+        info = (*f_gebrd)(LAPACK_COL_MAJOR, A.nRows(), A.nCols(), &A[0], A.nRows(), &S[0], e, tauQ, tauP, &wq, -1);
+        if(info) throw std::runtime_error("f_gebrd workspace query failed");
+        W->fitWork(wq);
         info = (*f_gebrd)(LAPACK_COL_MAJOR,     // LAPACK_COL_MAJOR or LAPACK_ROW_MAJOR data ordering,
                           A.nRows(),            // m: number of rows in A
                           A.nCols(),            // n: number of columns in A
                           &A[0],                // matrix A
                           A.nRows(),            // lda: leading dimension of A, >= max(1,m)
         &S[0],                // diagonal elements of B, dimension >= max(1, min(m, n))
-        &e[0],                // off-diagonal elements of B, dimension >= max(1, min(m, n) - 1)
+        e,                    // off-diagonal elements of B, dimension >= max(1, min(m, n) - 1)
         tauQ,                 // array with extra into on Q, dimension >= max(1, min(m, n))
-        tauP                  // array with extra info on P, dimension >= max(1, min(m, n))
+        tauP,                 // array with extra info on P, dimension >= max(1, min(m, n))
+        W->work.data(),       // workspace
+        W->work.size()        // workspace size
         );
         if(info) throw std::runtime_error("f_gebrd failed");
 
         if(verbose) {
             cout << "Bi-diagonalizing A:\n\n";
             cout << "Main diagonal:\n" << S << "\n";
-            cout << "Secondary diagonal:\n" << e << "\n";
+            cout << "Secondary diagonal:\n";
+            for(size_t i=0; i+1<S.nRows(); i++) cout << e[i] << " ";
+            cout << "\n";
         }
 
         // extract bi-diagonalizing matrices, truncated to useful dimension
         U = A;
         VT = A;
 
+        info = (*f_orgbr)(LAPACK_COL_MAJOR, 'Q', U.nRows(), S.nRows(), A.nCols(), &U[0], U.nRows(), tauQ, &wq, -1);
+        if(info) throw std::runtime_error("f_orgbr workspace query failed");
+        W->fitWork(wq);
         info = (*f_orgbr)(LAPACK_COL_MAJOR,     // LAPACK_COL_MAJOR or LAPACK_ROW_MAJOR data ordering,
                           'Q',                  // extract 'Q' or 'P' (P^T)
         U.nRows(),            // rows in extracted matrix
@@ -203,10 +245,15 @@ public:
                           A.nCols(),            // columns for Q, rows for P of original matrix reduced by ?gebrd
                           &U[0],                // (copy of) return matrix A of ?gebrd, will be over-written
                           U.nRows(),            // leading dimension of "A"
-                          tauQ                  // extra return array tauQ or tauP from ?gebrd
+                          tauQ,                 // extra return array tauQ or tauP from ?gebrd
+                          W->work.data(),       // workspace
+                          W->work.size()        // workspace size
         );
         if(info) throw std::runtime_error("f_orgbr failed");
 
+        info = (*f_orgbr)(LAPACK_COL_MAJOR, 'P', S.nRows(), VT.nCols(), A.nRows(), &VT[0], VT.nRows(), tauP, &wq, -1);
+        if(info) throw std::runtime_error("f_orgbr workspace query failed");
+        W->fitWork(wq);
         info = (*f_orgbr)(LAPACK_COL_MAJOR,     // LAPACK_COL_MAJOR or LAPACK_ROW_MAJOR data ordering,
                           'P',                  // extract 'Q' or 'P' (P^T)
         S.nRows(),            // rows in extracted matrix
@@ -214,7 +261,9 @@ public:
                           A.nRows(),            // columns for Q, rows for P of original matrix reduced by ?gebrd
                           &VT[0],               // (copy of) return matrix A of ?gebrd, will be over-written
                           VT.nRows(),           // leading dimension of "A"
-                          tauP                  // extra return array tauQ or tauP from ?gebrd
+                          tauP,                 // extra return array tauQ or tauP from ?gebrd
+                          W->work.data(),       // workspace
+                          W->work.size()        // workspace size
         );
         if(info) throw std::runtime_error("f_orgbr failed");
 
@@ -228,10 +277,6 @@ public:
             cout << "\nSingular Value Decomposition:\n\n";
         }
 
-        // no longer need these
-        delete[] tauQ;
-        delete[] tauP;
-
         // decompose B = U2 S V2^H, Q and P orthogonal singular vectors, S diagonal singular values
         // overwrites d = S; destroys e
         info = (*f_bdsqr)(LAPACK_COL_MAJOR,     // LAPACK_COL_MAJOR or LAPACK_ROW_MAJOR data ordering
@@ -241,13 +286,14 @@ public:
                           A.nRows(),            // nru: number of rows of U, left singular vectors to calculate
                           0,                    // ncc: number of columns in C used for QH*C; set 0 if no "C" supplied
                           &S[0],                // d: diagonal elements of B; must be size >= max(1,n)
-        &e[0],                // e: n-1 off-diagonal elements of B; must be size >= max(1,n)
+        e,                    // e: n-1 off-diagonal elements of B; must be size >= max(1,n)
         &VT[0],               // n * ncvt matrix for right singular vectors; unused if ncvt=0
         VT.nRows(),           // leading dimension of VT; >= max(1,n) for ncvt>0; >= 1 otherwise.
                           &U[0],                // nru * n unit matrix U; unused if nru=0
                           U.nRows(),            // leading dimension of U; >= max(1,nru)
         nullptr,                 // matrix for calculating Q^H*C; second dimension >= max(1,ncc); unused if ncc = 0
-                          1                     // leading dimension of C; >= max(1,n) if ncc>0; >=1 otherwise
+                          1,                    // leading dimension of C; >= max(1,n) if ncc>0; >=1 otherwise
+                          W->rwork.data()       // real workspace, size >= 4n
         );
         if(info) throw std::runtime_error("f_bdsqr failed");
 
@@ -334,12 +380,12 @@ protected:
     VarMat<CT>* PsI;    ///< pseudo-inverse
     T PsI_epsilon;      ///< threshold for singular vectors
 
-    /// appropriate data type version of xGEBRD bidiagonal reduction
-    static lapack_int (*f_gebrd)(int, lapack_int, lapack_int, CT*, lapack_int, T*, T*, CT*, CT*);
-    /// appropriate data type version of orgbr/ungbr, unpacks bidiagonal decomposition matrices
-    static lapack_int (*f_orgbr)(int, char, lapack_int, lapack_int, lapack_int, CT*, lapack_int, const CT*);
-    /// appropriate data type version of zBDSQR SVD from bidiagonal
-    static lapack_int (*f_bdsqr)(int, char, lapack_int, lapack_int, lapack_int, lapack_int, T*, T*, CT*, lapack_int, CT*, lapack_int, CT*, lapack_int);
+    /// appropriate data type version of xGEBRD bidiagonal reduction (caller-supplied workspace)
+    static lapack_int (*f_gebrd)(int, lapack_int, lapack_int, CT*, lapack_int, T*, T*, CT*, CT*, CT*, lapack_int);
+    /// appropriate data type version of orgbr/ungbr, unpacks bidiagonal decomposition matrices (caller-supplied workspace)
+    static lapack_int (*f_orgbr)(int, char, lapack_int, lapack_int, lapack_int, CT*, lapack_int, const CT*, CT*, lapack_int);
+    /// appropriate data type version of zBDSQR SVD from bidiagonal (caller-supplied workspace)
+    static lapack_int (*f_bdsqr)(int, char, lapack_int, lapack_int, lapack_int, lapack_int, T*, T*, CT*, lapack_int, CT*, lapack_int, CT*, lapack_int, T*);
 
     /// bundle of other appropriate matrix operations
     static Mat_Ops<CT>* myOps;
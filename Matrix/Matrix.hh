@@ -27,6 +27,8 @@
 #include <vector>
 using std::vector;
 #include <cassert>
+#include <cmath>
+#include <limits>
 #include "iffy_constexpr.hh"
 
 /// Handle min in a==b case without tripping -Wduplicated-branches warnings
@@ -75,22 +77,26 @@ public:
     ///unary minus
     const Matrix operator-() const;
 
+    /// construct from elements f(i) in rows order
+    template<typename F>
+    static Matrix generate(F&& f) { return Matrix(vec_generate<T,M*N>(f)); }
+
     /// inplace multiplication by a constant
     Matrix& operator*=(const T& c) { super::operator*=(c); return *this; }
     /// multiplication by a constant
-    const Matrix operator*(const T& c) const { auto foo = *this; return (foo *= c); }
+    const Matrix operator*(const T& c) const { return Matrix(super::operator*(c)); }
     /// inplace division by a constant
     Matrix& operator/=(const T& c) { super::operator/=(c); return *this; }
     /// division by a constant
-    const Matrix operator/(const T& c) const { auto foo = *this; return (foo /= c); }
+    const Matrix operator/(const T& c) const { return Matrix(super::operator/(c)); }
     /// inplace addition of a matrix
     Matrix& operator+=(const Matrix& rhs) { super::operator+=(rhs); return *this; }
     /// addition of a matrix
-    const Matrix operator+(const Matrix& rhs) const { auto foo = *this; return (foo += rhs); }
+    const Matrix operator+(const Matrix& rhs) const { return Matrix(super::operator+(rhs)); }
     /// inplace subtraction of a matrix
     Matrix& operator-=(const Matrix& rhs) { super::operator-=(rhs); return *this; }
     /// subtraction of a matrix
-    const Matrix operator-(const Matrix& rhs) const { auto foo = *this; return (foo -= rhs); }
+    const Matrix operator-(const Matrix& rhs) const { return Matrix(super::operator-(rhs)); }
 
     /// matrix multiplication
     template<size_t L>
@@ -201,17 +207,18 @@ _constexpr Matrix<M,N,T> Matrix<M,N,T>::identity() {
 
 template<size_t M, size_t N, typename T>
 Matrix<N,M,T> Matrix<M,N,T>::transposed() const {
-    Matrix<N,M,T> foo;
-    for(size_t r=0; r<M; r++)
-        for(size_t c=0; c<N; c++)
-            foo(c,r) = (*this)(r,c);
-    return foo;
+    return Matrix<N,M,T>::generate([this](size_t i) { return (*this)(i%M, i/M); });
+}
+
+template<size_t M, size_t N, typename T>
+const Matrix<M,N,T> Matrix<M,N,T>::operator-() const {
+    return Matrix(super::operator-());
 }
 
 template<size_t M, size_t N, typename T>
 Vec<N,T> Matrix<M,N,T>::row(size_t i) const {
     Vec<N,T> v;
-    for(size_t j=0; j<N; j++) v[i] = (*this)(i,j);
+    for(size_t j=0; j<N; j++) v[j] = (*this)(i,j);
     return v;
 }
 
@@ -225,32 +232,28 @@ Vec<M,T> Matrix<M,N,T>::col(size_t i) const {
 template<size_t M, size_t N, typename T>
 template<size_t L>
 const Matrix<M,L,T> Matrix<M,N,T>::operator*(const Matrix<N,L,T>& B) const {
-    Matrix<M,L,T> C;
-    for(size_t r=0; r<M; r++) {
-        for(size_t c=0; c<L; c++) {
-            C(r,c) = (*this)(r,0)*B(0,c);
-            for(size_t i=1; i<N; i++)
-                C(r,c) += (*this)(r,i)*B(i,c);
-        }
-    }
-    return C;
+    return Matrix<M,L,T>::generate([&](size_t i) {
+        const size_t r = i/L, c = i%L;
+        T s = (*this)(r,0)*B(0,c);
+        vec_foreach<N-1>([&](size_t k) { s += (*this)(r,k+1)*B(k+1,c); });
+        return s;
+    });
 }
 
 template<size_t M, size_t N, typename T>
 const Vec<M,T> Matrix<M,N,T>::lMultiply(const Vec<N,T>& v) const {
-    Vec<M,T> a{};
-    for(size_t r=0; r<M; r++) {
-        for(size_t c=0; c<N; c++) a[r] += (*this)(r,c)*v[c];
-    }
-    return a;
+    return Vec<M,T>::generate([&](size_t r) {
+        T s = (*this)(r,0)*v[0];
+        vec_foreach<N-1>([&](size_t c) { s += (*this)(r,c+1)*v[c+1]; });
+        return s;
+    });
 }
 
 template<size_t M, size_t N, typename T>
 const Vec<N,T> Matrix<M,N,T>::rMultiply(const Vec<M,T>& v) const {
-    Vec<N,T> a{};
-    for(size_t r=0; r<M; r++) {
-        for(size_t c=0; c<N; c++) a[c] += v[r]*(*this)(r,c);
-    }
+    // linear combination of rows
+    auto a = Vec<N,T>::generate([&](size_t c) { return v[0]*(*this)(0,c); });
+    for(size_t r=1; r<M; r++) vec_foreach<N>([&](size_t c) { a[c] += v[r]*(*this)(r,c); });
     return a;
 }
 
@@ -374,6 +377,64 @@ protected:
     T cMin{};           ///< smallest row-division value encountered
 };
 
+/// Symmetric matrix eigendecomposition A = U D U^T by cyclic Jacobi rotations (for small fixed N; one rotation for N = 2)
+template<size_t N, typename T>
+class SymmEigen {
+public:
+    static_assert(N, "Please avoid zero-dimensional matrices.");
+
+    /// Constructor, decomposing symmetric A
+    explicit SymmEigen(const Matrix<N,N,T>& A, int maxSweeps = 50): U(Matrix<N,N,T>::identity()) {
+        auto D = A;
+        for(nSweeps = 0; nSweeps < maxSweeps; ++nSweeps) {
+            T off{}, tot{};
+            for(size_t p = 0; p < N; ++p) {
+                tot += D(p,p)*D(p,p);
+                for(size_t q = p+1; q < N; ++q) off += D(p,q)*D(p,q);
+            }
+            if(!(off > std::numeric_limits<T>::epsilon()*std::numeric_limits<T>::epsilon()*(tot + 2*off))) break;
+
+            for(size_t p = 0; p < N; ++p) {
+                for(size_t q = p+1; q < N; ++q) {
+                    if(!D(p,q)) continue;
+                    T th = (D(q,q) - D(p,p))/(2*D(p,q));
+                    T t = (th < 0? -1 : 1)/(fabs(th) + sqrt(th*th + 1));
+                    T c = 1/sqrt(t*t + 1);
+                    T s = t*c;
+                    for(size_t k = 0; k < N; ++k) {
+                        T dp = D(k,p), dq = D(k,q);
+                        D(k,p) = c*dp - s*dq;
+                        D(k,q) = s*dp + c*dq;
+                    }
+                    for(size_t k = 0; k < N; ++k) {
+                        T dp = D(p,k), dq = D(q,k);
+                        D(p,k) = c*dp - s*dq;
+                        D(q,k) = s*dp + c*dq;
+                        T up = U(k,p), uq = U(k,q);
+                        U(k,p) = c*up - s*uq;
+                        U(k,q) = s*up + c*uq;
+                    }
+                    D(p,q) = D(q,p) = 0;
+                }
+            }
+        }
+
+        // sort largest to smallest
+        for(size_t i = 0; i < N; ++i) l[i] = D(i,i);
+        for(size_t i = 0; i < N; ++i) {
+            size_t m = i;
+            for(size_t j = i+1; j < N; ++j) if(l[m] < l[j]) m = j;
+            if(m == i) continue;
+            std::swap(l[i], l[m]);
+            for(size_t k = 0; k < N; ++k) std::swap(U(k,i), U(k,m));
+        }
+    }
+
+    Vec<N,T> l;         ///< eigenvalues, largest to smallest
+    Matrix<N,N,T> U;    ///< unit eigenvectors in columns, ordered as l
+    int nSweeps = 0;    ///< number of rotation sweeps used
+};
+
 /// Determinant
 template<size_t M, typename T>
 const T det(const Matrix<M,M,T>& X) {
@@ -0,0 +1,36 @@
+/// \file TLS_Sink.hh DataSink stage accumulating rows into streaming Total Least Squares line fit
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef TLS_SINK_HH
+#define TLS_SINK_HH
+
+#include "TLS_Solver.hh"
+#include "DataSink.hh"
+
+/// Streaming TLS fit to rows (indexable by [0, n)) pushed from upstream; solved at flush or end of data
+template<typename T = const VarVec<double>>
+class TLS_Sink: public DataSink<T> {
+public:
+    typedef T sink_t;
+
+    /// Constructor, for n dimensions and blocks of nb rows
+    explicit TLS_Sink(size_t n, size_t nb = 1024): TLS(n, nb), x(n) { }
+
+    /// take one row
+    void push(sink_t& o) override {
+        for(size_t j = 0; j < TLS.n; j++) x[j] = o[j];
+        TLS.addRow(x.data());
+    }
+
+    /// solve on flush or end of data
+    void signal(datastream_signal_t s) override {
+        if((s == DATASTREAM_FLUSH || s == DATASTREAM_END) && TLS.nRows()) TLS.solve();
+    }
+
+    TLS_StreamSolver TLS;   ///< accumulated fit
+
+protected:
+    vector<double> x;       ///< row conversion buffer
+};
+
+#endif
@@ -6,6 +6,11 @@
 // -- Michael P. Mendenhall, 2015
 
 #include "TLS_Solver.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
 
 void TLS_Solver::solve() {
     // mean value
@@ -25,3 +30,119 @@ double TLS_Solver::getSSR() const {
     return B.getSumSquares() - (B*v).mag2();
 }
 
+
+/// replace column-major m x n (m >= n) A by its n x n upper-triangular QR R-factor
+static void qr_R(vector<double>& A, size_t m, size_t n, VarMat<double>& R) {
+    vector<double> tau(n);
+    if(LAPACKE_dgeqrf(LAPACK_COL_MAJOR, m, n, A.data(), m, tau.data()))
+        throw std::runtime_error("TLS_StreamSolver QR failed");
+    R = VarMat<double>(n,n);
+    for(size_t c = 0; c < n; c++)
+        for(size_t r = 0; r <= c; r++)
+            R(r,c) = A[r + c*m];
+}
+
+TLS_StreamSolver::TLS_StreamSolver(size_t nn, size_t nb):
+n(nn), blocksize(std::max(nb, nn)), mu(n), v(n), R(n,n), block(blocksize*n) { }
+
+void TLS_StreamSolver::clear() {
+    N = nblock = 0;
+    mu = VarVec<double>(n);
+    R = VarMat<double>(n,n);
+}
+
+void TLS_StreamSolver::addRow(const double* x) {
+    for(size_t j = 0; j < n; j++) block[nblock + j*blocksize] = x[j];
+    if(++nblock == blocksize) flush();
+}
+
+void TLS_StreamSolver::flush() {
+    if(!nblock) return;
+
+    // center block on its own mean
+    VarVec<double> mub(n);
+    for(size_t j = 0; j < n; j++) {
+        double* c = block.data() + j*blocksize;
+        double s = 0;
+        for(size_t i = 0; i < nblock; i++) s += c[i];
+        mub[j] = s/nblock;
+        for(size_t i = 0; i < nblock; i++) c[i] -= mub[j];
+    }
+
+    // QR of (zero-padded to at least n rows) block
+    const size_t m = std::max(nblock, n);
+    vector<double> A(m*n);
+    for(size_t j = 0; j < n; j++) std::copy(block.begin() + j*blocksize, block.begin() + j*blocksize + nblock, A.begin() + j*m);
+    VarMat<double> Rb;
+    qr_R(A, m, n, Rb);
+
+    const size_t nb = nblock;
+    nblock = 0;
+    combine(Rb, mub, nb);
+}
+
+void TLS_StreamSolver::combine(const VarMat<double>& Rb, const VarVec<double>& mub, size_t nb) {
+    if(!nb) return;
+    if(!N) {
+        R = Rb;
+        mu = mub;
+        N = nb;
+        return;
+    }
+
+    // stacked [R; Rb; sqrt(N nb/(N + nb)) (mub - mu)]
+    const size_t m = 2*n + 1;
+    const double w = sqrt(double(N)*nb/(N + nb));
+    vector<double> A(m*n);
+    for(size_t c = 0; c < n; c++) {
+        for(size_t r = 0; r <= c; r++) {
+            A[r + c*m] = R(r,c);
+            A[n + r + c*m] = Rb(r,c);
+        }
+        A[2*n + c*m] = w*(mub[c] - mu[c]);
+    }
+    qr_R(A, m, n, R);
+
+    for(size_t j = 0; j < n; j++) mu[j] += (mub[j] - mu[j])*(double(nb)/(N + nb));
+    N += nb;
+}
+
+void TLS_StreamSolver::merge(const TLS_StreamSolver& S) {
+    if(S.n != n) throw std::logic_error("TLS_StreamSolver merge dimensions mismatch");
+    combine(S.R, S.mu, S.N);
+    for(size_t i = 0; i < S.nblock; i++) {
+        for(size_t j = 0; j < n; j++) block[nblock + j*blocksize] = S.block[i + j*S.blocksize];
+        if(++nblock == blocksize) flush();
+    }
+}
+
+void TLS_StreamSolver::addRows(const double* x, size_t nrows, int nthreads) {
+    const size_t nt = nthreads > 0? nthreads : std::thread::hardware_concurrency();
+    const size_t nchunk = std::min(4*nt, nrows/(16*blocksize));
+    if(nt <= 1 || nchunk <= 1) {
+        for(size_t i = 0; i < nrows; i++) addRow(x + i*n);
+        return;
+    }
+
+    // independent per-chunk accumulators, merged in order
+    vector<TLS_StreamSolver> S(nchunk, TLS_StreamSolver(n, blocksize));
+    WorkStealingPool P(nt);
+    for(size_t k = 0; k < nchunk; k++) P.submit([&S, x, nrows, nchunk, k, this]() {
+        const size_t i1 = (nrows*(k + 1))/nchunk;
+        for(size_t i = (nrows*k)/nchunk; i < i1; i++) S[k].addRow(x + i*n);
+        S[k].flush();
+    });
+    P.wait_idle();
+    flush();
+    for(auto& s: S) combine(s.R, s.mu, s.N);
+}
+
+void TLS_StreamSolver::solve() {
+    flush();
+    VarMat<double> RR = R;
+    LAPACKE_Matrix_SVD<double,double> SVD(RR);
+    v = SVD.getRightSVec(0);
+    // residuals from minor singular values, avoiding cancellation against total sum of squares
+    ssr = 0;
+    for(int i = 1; i < SVD.n_singular_values(); i++) ssr += pow(SVD.singular_values()[i], 2);
+}
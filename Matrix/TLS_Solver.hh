@@ -11,6 +11,8 @@
 #include "LAPACKE_Matrix.hh"
 #include "VarMat.hh"
 #include <stdlib.h> // for size_t
+#include <vector>
+using std::vector;
 
 /// Total Least Squares (TLS) solver for line through point cloud
 class TLS_Solver {
@@ -35,4 +37,51 @@ protected:
     LAPACKE_Matrix_SVD<double,double>* mySVD;
 };
 
+/// Streaming Total Least Squares line fit: O(n^2) memory for any number of rows
+/**
+ * Rows are gathered into blocks, each centered on its own mean and reduced to an n x n QR R-factor.
+ * R-factors are combined (TSQR) by QR of [R_a; R_b; sqrt(N_a N_b/N) (mu_b - mu_a)],
+ * the R-factor of all rows centered on their combined mean, without forming the (ill-conditioned) Gram matrix.
+ * Independent accumulators (e.g. per thread) combine through merge().
+ */
+class TLS_StreamSolver {
+public:
+    /// Constructor, for n dimensions and blocks of nb rows
+    explicit TLS_StreamSolver(size_t nn, size_t nb = 1024);
+
+    const size_t n;             ///< number of dimensions
+    const size_t blocksize;     ///< rows per block QR
+
+    /// add one row of n values
+    void addRow(const double* x);
+    /// add nrows rows (row-major, n values each), split over nthreads (0 for all cores)
+    void addRows(const double* x, size_t nrows, int nthreads = 0);
+    /// combine another accumulator's rows
+    void merge(const TLS_StreamSolver& S);
+    /// fold pending partial block into R-factor
+    void flush();
+    /// clear all data
+    void clear();
+
+    /// flush and solve for line through accumulated rows
+    void solve();
+    /// number of accumulated rows
+    size_t nRows() const { return N + nblock; }
+    /// sum of squares of residuals from solved line (after solve)
+    double getSSR() const { return ssr; }
+
+    VarVec<double> mu;          ///< mean center (after flush)
+    VarVec<double> v;           ///< direction vector (after solve)
+    VarMat<double> R;           ///< upper-triangular R-factor of centered rows (after flush)
+
+protected:
+    /// combine R-factor Rb of nb rows centered at mub
+    void combine(const VarMat<double>& Rb, const VarVec<double>& mub, size_t nb);
+
+    double ssr = 0;             ///< sum of squares of residuals from solved line
+    size_t N = 0;               ///< number of rows folded into R
+    size_t nblock = 0;          ///< number of rows in pending block
+    vector<double> block;       ///< pending rows block, column-major blocksize x n
+};
+
 #endif
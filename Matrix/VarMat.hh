@@ -25,12 +25,96 @@
 
 #include "VarVec.hh"
 #include "Matrix.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
+#include <complex>
+#include <thread>
+#include <type_traits>
+#ifdef WITH_LAPACKE
+#include <gsl/gsl_cblas.h>
+#endif
+
+/// BLAS dispatch for column-major VarMat products
+namespace VarMat_BLAS {
+    /// default: no BLAS implementation for element type
+    template<typename T>
+    struct ops { static constexpr bool enabled = false; };
+
+#ifdef WITH_LAPACKE
+    /// real-valued BLAS products
+    template<typename T>
+    struct real_ops {
+        static constexpr bool enabled = true;
+        /// C (m x n) = A (m x k) * B (k x n), column-major with lda = m, ldb = k, ldc = m
+        static void gemm(size_t m, size_t n, size_t k, const T* A, const T* B, T* C);
+        /// y = op(A) x for m x n A
+        static void gemv(bool trans, size_t m, size_t n, const T* A, const T* x, T* y);
+    };
+    template<>
+    inline void real_ops<double>::gemm(size_t m, size_t n, size_t k, const double* A, const double* B, double* C) {
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, n, k, 1., A, m, B, k, 0., C, m);
+    }
+    template<>
+    inline void real_ops<double>::gemv(bool trans, size_t m, size_t n, const double* A, const double* x, double* y) {
+        cblas_dgemv(CblasColMajor, trans? CblasTrans : CblasNoTrans, m, n, 1., A, m, x, 1, 0., y, 1);
+    }
+    template<>
+    inline void real_ops<float>::gemm(size_t m, size_t n, size_t k, const float* A, const float* B, float* C) {
+        cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, n, k, 1.f, A, m, B, k, 0.f, C, m);
+    }
+    template<>
+    inline void real_ops<float>::gemv(bool trans, size_t m, size_t n, const float* A, const float* x, float* y) {
+        cblas_sgemv(CblasColMajor, trans? CblasTrans : CblasNoTrans, m, n, 1.f, A, m, x, 1, 0.f, y, 1);
+    }
+    template<>
+    struct ops<double>: public real_ops<double> { };
+    template<>
+    struct ops<float>: public real_ops<float> { };
+
+    /// complex-valued BLAS products
+    template<typename T>
+    struct complex_ops {
+        static constexpr bool enabled = true;
+        /// function pointer type for ?gemm
+        typedef void (*gemm_t)(const enum CBLAS_ORDER, const enum CBLAS_TRANSPOSE, const enum CBLAS_TRANSPOSE,
+                               const int, const int, const int, const void*, const void*, const int,
+                               const void*, const int, const void*, void*, const int);
+        /// function pointer type for ?gemv
+        typedef void (*gemv_t)(const enum CBLAS_ORDER, const enum CBLAS_TRANSPOSE, const int, const int,
+                               const void*, const void*, const int, const void*, const int, const void*, void*, const int);
+        /// C (m x n) = A (m x k) * B (k x n), column-major with lda = m, ldb = k, ldc = m
+        static void gemm(size_t m, size_t n, size_t k, const T* A, const T* B, T* C) {
+            const T one(1), zero(0);
+            (*f_gemm())(CblasColMajor, CblasNoTrans, CblasNoTrans, m, n, k, &one, A, m, B, k, &zero, C, m);
+        }
+        /// y = op(A) x for m x n A (transpose without conjugation)
+        static void gemv(bool trans, size_t m, size_t n, const T* A, const T* x, T* y) {
+            const T one(1), zero(0);
+            (*f_gemv())(CblasColMajor, trans? CblasTrans : CblasNoTrans, m, n, &one, A, m, x, 1, &zero, y, 1);
+        }
+        /// appropriate precision ?gemm
+        static gemm_t f_gemm() { return sizeof(T) == sizeof(std::complex<double>)? &cblas_zgemm : &cblas_cgemm; }
+        /// appropriate precision ?gemv
+        static gemv_t f_gemv() { return sizeof(T) == sizeof(std::complex<double>)? &cblas_zgemv : &cblas_cgemv; }
+    };
+    template<>
+    struct ops< std::complex<double> >: public complex_ops< std::complex<double> > { };
+    template<>
+    struct ops< std::complex<float> >: public complex_ops< std::complex<float> > { };
+#endif
+
+    /// whether VarMat<T> products with VarVec<U> -> VarVec<V> dispatch to BLAS
+    template<typename T, typename U = T, typename V = T>
+    using use_blas = std::integral_constant<bool, ops<T>::enabled && std::is_same<T,U>::value && std::is_same<T,V>::value>;
+}
 
 /// A templatized, dynamically allocated matrix class.
 /**
- * Not particularly optimized or clever, but convenient for smallish matrices
- * or matrices of unusual special types (e.g. block circulant matrices, with CMatrix entries).
- * Data internally in *column major* order, for easier LAPACK compatibility
+ * Convenient for smallish matrices or matrices of unusual special types
+ * (e.g. block circulant matrices, with CMatrix entries).
+ * Data internally in *column major* order, for easier LAPACK compatibility;
+ * float/double/complex products dispatch to BLAS when built WITH_LAPACKE,
+ * otherwise use a cache-blocked, column-parallel loop.
  */
 template<typename T>
 class VarMat: public BinaryOutputObject {
@@ -42,6 +126,14 @@ public:
     explicit VarMat(Matrix<MM,NN,T> A): M(MM), N(NN), vv(A.getData()) {}
     /// destructor
     ~VarMat() {}
+    /// copy constructor
+    VarMat(const VarMat&) = default;
+    /// move constructor (leaving m empty)
+    VarMat(VarMat&& m): M(m.M), N(m.N), vv(std::move(m.vv)) { m.M = m.N = 0; }
+    /// copy assignment
+    VarMat& operator=(const VarMat&) = default;
+    /// move assignment (leaving m empty)
+    VarMat& operator=(VarMat&& m) { M = m.M; N = m.N; vv = std::move(m.vv); m.M = m.N = 0; return *this; }
 
     /// generate an "identity" matrix, using specified values on/off diagonal
     static VarMat<T> identity(size_t n) { return  VarMat<T>::identity(n,1,0); }
@@ -65,6 +157,8 @@ public:
     T& operator()(size_t m, size_t n) { assert(m<M && n<N); return vv[m+n*M]; }
     /// direct access to data vector
     const VarVec<T>& getData() const { return vv; }
+    /// mutable direct access to data vector (caller responsible for keeping size consistent)
+    VarVec<T>& getData() { return vv; }
     /// mutable vector element access
     T& operator[](size_t i) { return vv[i]; }
     /// const vector element access
@@ -120,7 +214,9 @@ public:
     VarMat<T>& zero() { vv.zero(); return *this; }
 
     /// VarMat multiplication
-    const VarMat<T> operator*(const VarMat<T>& B) const;
+    const VarMat<T> operator*(const VarMat<T>& B) const { return multiply(B); }
+    /// VarMat multiplication, with non-BLAS products split over nthreads (0 for all cores) when large
+    VarMat<T> multiply(const VarMat<T>& B, int nthreads = 0) const;
     /// left-multiply a vector
     template<typename U, typename V>
     const VarVec<V> lMultiply(const VarVec<U>& v) const;
@@ -143,6 +239,23 @@ private:
 
     /// step in inversion process
     void subinvert(size_t n);
+
+    /// BLAS matrix product
+    void _multiply(const VarMat<T>& B, VarMat<T>& C, int, std::true_type) const { VarMat_BLAS::ops<T>::gemm(M, B.N, N, &vv[0], &B.vv[0], &C.vv[0]); }
+    /// blocked loop matrix product
+    void _multiply(const VarMat<T>& B, VarMat<T>& C, int nthreads, std::false_type) const;
+    /// BLAS left-multiply
+    template<typename U, typename V>
+    void _lMultiply(const VarVec<U>& v, VarVec<V>& a, std::true_type) const;
+    /// column-accumulating left-multiply
+    template<typename U, typename V>
+    void _lMultiply(const VarVec<U>& v, VarVec<V>& a, std::false_type) const;
+    /// BLAS right-multiply
+    template<typename U, typename V>
+    void _rMultiply(const VarVec<U>& v, VarVec<V>& a, std::true_type) const;
+    /// column dot-product right-multiply
+    template<typename U, typename V>
+    void _rMultiply(const VarVec<U>& v, VarVec<V>& a, std::false_type) const;
 };
 
 template<typename T>
@@ -208,19 +321,50 @@ const VarMat<T> VarMat<T>::operator-(const VarMat<T>& rhs) const {
 }
 
 template<typename T>
-const VarMat<T> VarMat<T>::operator*(const VarMat<T>& B) const {
+VarMat<T> VarMat<T>::multiply(const VarMat<T>& B, int nthreads) const {
     if(B.nRows() != N)
         throw(DimensionMismatchError());
-    size_t L = B.nCols();
-    VarMat<T> C = VarMat<T>(M,L);
-    for(size_t r=0; r<M; r++) {
-        for(size_t c=0; c<L; c++) {
-            C(r,c) = (*this)(r,0)*B(0,c);
-            for(size_t i=1; i<N; i++)
-                C(r,c) += (*this)(r,i)*B(i,c);
+    VarMat<T> C = VarMat<T>(M,B.nCols());
+    if(!C.size()) return C;
+    if(!N) return C;
+    _multiply(B, C, nthreads, VarMat_BLAS::use_blas<T>());
+    return C;
+}
+
+template<typename T>
+void VarMat<T>::_multiply(const VarMat<T>& B, VarMat<T>& C, int nthreads, std::false_type) const {
+    const size_t L = B.nCols();
+    // inner-dimension panels of A kept cache-resident (~256kB) across output columns
+    const size_t kb = std::max<size_t>(1, (1 << 18)/(M*sizeof(T)));
+
+    // C(:,j) = sum_k A(:,k) B(k,j), over columns [j0, j1)
+    auto cols = [&](size_t j0, size_t j1) {
+        for(size_t k0 = 0; k0 < N; k0 += kb) {
+            const size_t k1 = std::min(N, k0 + kb);
+            for(size_t j = j0; j < j1; j++) {
+                T* c = &C.vv[j*M];
+                for(size_t k = k0; k < k1; k++) {
+                    const T& b = B(k,j);
+                    const T* a = &vv[k*M];
+                    if(!k) for(size_t i = 0; i < M; i++) c[i] = a[i]*b;
+                    else for(size_t i = 0; i < M; i++) c[i] += a[i]*b;
+                }
+            }
         }
+    };
+
+    // multiply-adds (non-arithmetic elements, e.g. CMatrix, weighted as expensive)
+    const double work = double(M)*N*L*(std::is_arithmetic<T>::value? 1 : 1024);
+    const unsigned int nt = nthreads? nthreads : std::thread::hardware_concurrency();
+    if(nt <= 1 || L < 2 || work < (1 << 22)) { cols(0, L); return; }
+
+    const size_t nchunk = std::min<size_t>(L, 4*nt);
+    WorkStealingPool P(nt);
+    for(size_t c = 0; c < nchunk; c++) {
+        const size_t j0 = (c*L)/nchunk, j1 = ((c+1)*L)/nchunk;
+        P.submit([&cols, j0, j1]() { cols(j0, j1); });
     }
-    return C;
+    P.wait_idle();
 }
 
 template<typename T>
@@ -229,27 +373,57 @@ const VarVec<V> VarMat<T>::lMultiply(const VarVec<U>& v) const {
     if(v.size() != N)
         throw(DimensionMismatchError());
     VarVec<V> a;
-    for(size_t r=0; r<M; r++) {
-        a.push_back((*this)(r,0)*v[0]);
-        for(size_t c=1; c<N; c++)
-            a.back() += (*this)(r,c)*v[c];
-    }
+    if(!M) return a;
+    if(!N) return VarVec<V>(M);
+    _lMultiply(v, a, VarMat_BLAS::use_blas<T,U,V>());
     return a;
 }
 
+template<typename T>
+template<typename U, typename V>
+void VarMat<T>::_lMultiply(const VarVec<U>& v, VarVec<V>& a, std::true_type) const {
+    a = VarVec<V>(M);
+    VarMat_BLAS::ops<T>::gemv(false, M, N, &vv[0], &v[0], &a[0]);
+}
+
+template<typename T>
+template<typename U, typename V>
+void VarMat<T>::_lMultiply(const VarVec<U>& v, VarVec<V>& a, std::false_type) const {
+    // accumulate along contiguous columns
+    for(size_t r=0; r<M; r++) a.push_back((*this)(r,0)*v[0]);
+    for(size_t c=1; c<N; c++) {
+        const T* col = &vv[c*M];
+        for(size_t r=0; r<M; r++) a[r] += col[r]*v[c];
+    }
+}
+
 template<typename T>
 template<typename U, typename V>
 const VarVec<V> VarMat<T>::rMultiply(const VarVec<U>& v) const {
     if(v.size() != M)
         throw(DimensionMismatchError());
     VarVec<V> a;
-    if(!size()) return a;
+    if(!N) return a;
+    if(!M) return VarVec<V>(N);
+    _rMultiply(v, a, VarMat_BLAS::use_blas<T,U,V>());
+    return a;
+}
+
+template<typename T>
+template<typename U, typename V>
+void VarMat<T>::_rMultiply(const VarVec<U>& v, VarVec<V>& a, std::true_type) const {
+    a = VarVec<V>(N);
+    VarMat_BLAS::ops<T>::gemv(true, M, N, &vv[0], &v[0], &a[0]);
+}
+
+template<typename T>
+template<typename U, typename V>
+void VarMat<T>::_rMultiply(const VarVec<U>& v, VarVec<V>& a, std::false_type) const {
     for(size_t c=0; c<N; c++) {
         a.push_back(v[0] * (*this)(0,c));
         for(size_t r=1; r<M; r++)
             a.back() += v[r] * (*this)(r,c);
     }
-    return a;
 }
 
 template<typename T>
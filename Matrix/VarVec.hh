@@ -27,6 +27,7 @@
 #include "Permutation.hh"
 #include "BinaryOutputObject.hh"
 #include <exception>
+#include <type_traits>
 
 /// Return a random number, uniformly distributed over interval [a,b]
 /** \param a lower bound of interval
@@ -56,6 +57,14 @@ public:
     VarVec(InputIterator first, InputIterator last): data(first,last) {}
     /// Destructor
     ~VarVec() {}
+    /// copy constructor
+    VarVec(const VarVec&) = default;
+    /// move constructor
+    VarVec(VarVec&&) = default;
+    /// copy assignment
+    VarVec& operator=(const VarVec&) = default;
+    /// move assignment
+    VarVec& operator=(VarVec&&) = default;
 
     /// mutable element access operator
     T& operator[](size_t i) { assert(i<data.size()); return data[i]; }
@@ -454,6 +463,33 @@ namespace VarVec_element_IO {
     inline double readFromFile(std::istream& s) { double x; s.read((char*)&x, sizeof(x)); return x; }
     template<>
     inline int16_t readFromFile(std::istream& s) { int16_t x; s.read((char*)&x, sizeof(x)); return x; }
+
+    /// whether elements are written as raw bytes, allowing single-call array IO
+    template<typename T>
+    struct is_raw: std::false_type { };
+    template<>
+    struct is_raw<float>: std::true_type { };
+    template<>
+    struct is_raw<double>: std::true_type { };
+    template<>
+    struct is_raw<int16_t>: std::true_type { };
+
+    /// write n raw elements in one call
+    template<typename T>
+    inline void writeArray(const T* d, size_t n, ostream& o, std::true_type) { if(n) o.write((const char*)d, n*sizeof(T)); }
+    /// write n elements one by one
+    template<typename T>
+    inline void writeArray(const T* d, size_t n, ostream& o, std::false_type) { while(n--) writeToFile<T>(*d++, o); }
+    /// read n raw elements in one call
+    template<typename T>
+    inline void readArray(vector<T>& v, size_t n, std::istream& s, std::true_type) {
+        v.resize(n);
+        if(n) s.read((char*)v.data(), n*sizeof(T));
+        if(!s) throw std::runtime_error("Truncated VarVec data");
+    }
+    /// read n elements one by one
+    template<typename T>
+    inline void readArray(vector<T>& v, size_t n, std::istream& s, std::false_type) { while(n--) v.push_back(readFromFile<T>(s)); }
 }
 
 template<typename T>
@@ -461,8 +497,7 @@ void VarVec<T>::writeToFile(ostream& o) const {
     writeString("(VarVec_"+std::to_string(sizeof(T))+")",o);
     size_t N = size();
     o.write((char*)&N,  sizeof(N));
-    for(size_t i=0; i<N; i++)
-        VarVec_element_IO::writeToFile<T>(data[i],o);
+    VarVec_element_IO::writeArray<T>(data.data(), N, o, VarVec_element_IO::is_raw<T>());
     writeString("(/VarVec_"+std::to_string(sizeof(T))+")",o);
 }
 
@@ -472,8 +507,7 @@ VarVec<T> VarVec<T>::readFromFile(std::istream& s) {
     VarVec<T> foo;
     size_t N;
     s.read((char*)&N,   sizeof(N));
-    for(size_t i=0; i<N; i++)
-        foo.push_back(VarVec_element_IO::readFromFile<T>(s));
+    VarVec_element_IO::readArray<T>(foo.data, N, s, VarVec_element_IO::is_raw<T>());
     checkString("(/VarVec_"+std::to_string(sizeof(T))+")",s);
     return foo;
 }
@@ -26,11 +26,39 @@
 #include <stdlib.h>
 #include <iostream>
 #include <array>
+#include <initializer_list>
+#include <utility>
 #include "GeomCalcUtils.hh"
 
 using std::ostream;
 using std::array;
 
+/// maximum length for fully-unrolled (straight-line) elementwise operations
+#define VEC_UNROLL_MAX 16
+
+/// compile-time unrolled elementwise operations helpers
+namespace vec_unroll {
+    /// call f(i) for each i in sequence, in order
+    template<typename F, size_t... I>
+    inline void apply(F&& f, std::index_sequence<I...>) { (void)std::initializer_list<int>{(f(I), 0)...}; }
+    /// array {f(0), f(1), ...}
+    template<typename A, typename F, size_t... I>
+    inline A generate(F&& f, std::index_sequence<I...>) { return A{{f(I)...}}; }
+}
+
+/// call f(i) for i = 0...N-1, unrolled to straight-line code for short vectors
+template<size_t N, typename F>
+inline typename std::enable_if<(N <= VEC_UNROLL_MAX)>::type vec_foreach(F&& f) { vec_unroll::apply(f, std::make_index_sequence<N>()); }
+/// call f(i) for i = 0...N-1, as loop for long vectors
+template<size_t N, typename F>
+inline typename std::enable_if<(N > VEC_UNROLL_MAX)>::type vec_foreach(F&& f) { for(size_t i=0; i<N; i++) f(i); }
+/// array<T,N> {f(0), ..., f(N-1)}, constructed directly for short vectors
+template<typename T, size_t N, typename F>
+inline typename std::enable_if<(N <= VEC_UNROLL_MAX), array<T,N>>::type vec_generate(F&& f) { return vec_unroll::generate<array<T,N>>(f, std::make_index_sequence<N>()); }
+/// array<T,N> {f(0), ..., f(N-1)}, filled by loop for long vectors
+template<typename T, size_t N, typename F>
+inline typename std::enable_if<(N > VEC_UNROLL_MAX), array<T,N>>::type vec_generate(F&& f) { array<T,N> a; for(size_t i=0; i<N; i++) a[i] = f(i); return a; }
+
 /// Fixed-length vector arithmetic class
 template<size_t N, typename T>
 class Vec: public array<T,N> {
@@ -55,9 +83,9 @@ public:
     /// magnitude \f$ \sqrt{v\cdot v} \f$
     T mag() const { return ::mag(*this); }
     /// sum of vector elements
-    T sum() const { T s = (*this)[0]; for(size_t i=1; i<N; i++) s += (*this)[i]; return s; }
+    T sum() const { T s = (*this)[0]; vec_foreach<N-1>([&](size_t i) { s += (*this)[i+1]; }); return s; }
     /// product of vector elements
-    T prod() const { T s = (*this)[0]; for(size_t i=1; i<N; i++) s *= (*this)[i]; return s; }
+    T prod() const { T s = (*this)[0]; vec_foreach<N-1>([&](size_t i) { s *= (*this)[i+1]; }); return s; }
 
     /// this vector, normalized to magnitude 1
     Vec normalized() const { return (*this)/mag(); }
@@ -66,40 +94,50 @@ public:
     /// project out component orthogonal to another vector
     Vec orthoProj(const Vec& v) const { return (*this)-paraProj(v); }
 
+    /// construct from elements f(i)
+    template<typename F>
+    static Vec generate(F&& f) { return Vec(vec_generate<T,N>(f)); }
+    /// elementwise f(x)
+    template<typename F>
+    Vec map(F&& f) const { return generate([&](size_t i) { return f((*this)[i]); }); }
+    /// elementwise f(x, y)
+    template<typename F>
+    Vec zip(const Vec& v, F&& f) const { return generate([&](size_t i) { return f((*this)[i], v[i]); }); }
+
     /// unary minus operator
-    const Vec operator-() const { auto v = *this; for(size_t i=0; i<N; i++) v[i] = -v[i]; return v; }
+    const Vec operator-() const { return map([](const auto& x) { return -x; }); }
 
     /// inplace addition
-    Vec& operator+=(const Vec& rhs) { for(size_t i=0; i<N; i++) (*this)[i] += rhs[i]; return *this; }
+    Vec& operator+=(const Vec& rhs) { return (*this = *this + rhs); }
     /// inplace addition of a constant
-    Vec& operator+=(const T& c) { for(auto& x: *this) x += c; return *this; }
+    Vec& operator+=(const T& c) { return (*this = map([&c](const auto& x) { return x + c; })); }
     /// inplace subtraction
-    Vec& operator-=(const Vec& rhs) { for(size_t i=0; i<N; i++) (*this)[i] -= rhs[i]; return *this; }
+    Vec& operator-=(const Vec& rhs) { return (*this = *this - rhs); }
     /// inplace subtraction of a constant
-    Vec& operator-=(const T& c) { for(auto& x: *this) x -= c; return *this; }
+    Vec& operator-=(const T& c) { return (*this = map([&c](const auto& x) { return x - c; })); }
 
     /// inplace multiplication
-    Vec& operator*=(const T& c) { for(auto& x: *this) x *= c; return *this; }
+    Vec& operator*=(const T& c) { return (*this = *this * c); }
     /// inplace elementwise multiplication
-    Vec& operator*=(const Vec& other) { for(size_t i=0; i<N; i++) (*this)[i] *= other[i]; return *this; }
+    Vec& operator*=(const Vec& other) { return (*this = *this * other); }
     /// inplace division
-    Vec& operator/=(const T& c) { for(auto& x: *this) x /= c; return *this; }
+    Vec& operator/=(const T& c) { return (*this = *this / c); }
     /// inplace elementwise division
-    Vec& operator/=(const Vec& other) { for(size_t i=0; i<N; i++) (*this)[i] /= other[i]; return *this; }
+    Vec& operator/=(const Vec& other) { return (*this = *this / other); }
 
     /// addition operator
-    const Vec operator+(const Vec& other) const { auto result = *this; return (result += other); }
+    const Vec operator+(const Vec& other) const { return zip(other, [](const auto& x, const auto& y) { return x + y; }); }
     /// subtraction operator
-    const Vec operator-(const Vec& other) const { auto result = *this; return (result -= other); }
+    const Vec operator-(const Vec& other) const { return zip(other, [](const auto& x, const auto& y) { return x - y; }); }
 
     /// multiplication operator
-    const Vec operator*(const T& c) const { auto result = *this; return (result *= c); }
+    const Vec operator*(const T& c) const { return map([&c](const auto& x) { return x * c; }); }
     /// elementwise multiplication operator
-    const Vec operator*(const Vec& other) const { auto result = *this; return (result *= other); }
+    const Vec operator*(const Vec& other) const { return zip(other, [](const auto& x, const auto& y) { return x * y; }); }
     /// division operator
-    const Vec operator/(const T& c) const { auto result = *this; return (result /= c); }
+    const Vec operator/(const T& c) const { return map([&c](const auto& x) { return x / c; }); }
     /// elementwise division operator
-    const Vec operator/(const Vec& other) const { auto result = *this; return (result /= other); }
+    const Vec operator/(const Vec& other) const { return zip(other, [](const auto& x, const auto& y) { return x / y; }); }
 
     /// type conversion
     template<typename W>
@@ -108,6 +146,7 @@ public:
         for(size_t i=0; i<N; i++) r[i] = W((*this)[i]);
         return r;
     }
+
 };
 
 /// string output representation for vectors
@@ -0,0 +1,212 @@
+/// \file BetaCorrectionTable.cc
+
+#include "BetaCorrectionTable.hh"
+#include "UnpolarizedBeta.hh"
+#include "PolarizedBetaAsym.hh"
+#include "MappedFile.hh"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <stdio.h>
+#include <tuple>
+#include <unistd.h>
+
+constexpr size_t BetaCorrectionTable::NC;
+
+BetaCorrectionTable::BetaCorrectionTable(const BetaSpectrumGenerator& _G, kind_t k, double tol): G(_G), kind(k) {
+    if(!(G.W0 > 1)) throw std::domain_error("Beta correction table requires positive endpoint");
+    const double p0 = sqrt((G.W0 - 1)*(G.W0 + 1));
+
+    // tabulated range, excluding endpoint regions where rounding in W-1 or W0-W limits function precision
+    const double dW = 100*DBL_EPSILON/tol;
+    pLo = sqrt(dW*(2 + dW));
+    pHi = sqrt((G.W0*(1 - dW) - 1)*(G.W0*(1 - dW) + 1));
+    kp.push_back(pLo);
+    if(!(pLo < pHi)) { pHi = pLo; return; }
+
+    // coarse grid: uniform, with geometrically narrowing intervals towards both endpoints
+    const size_t n0 = 32, ng = 20;
+    vector<double> p0s;
+    for(size_t j = 0; j <= ng; j++) p0s.push_back(p0*std::ldexp(1./n0, int(j) - int(ng)));
+    for(size_t i = 2; i < n0 - 1; i++) p0s.push_back(p0*i/n0);
+    for(size_t j = 0; j <= ng; j++) p0s.push_back(p0*(1 - std::ldexp(1./n0, -int(j))));
+    vector<double> p{pLo};
+    for(auto x: p0s) if(pLo < x && x < pHi) p.push_back(x);
+    p.push_back(pHi);
+
+    // absolute tolerance floor, for near-zero function values
+    double fmax = 0;
+    for(auto x: p) fmax = std::max(fmax, fabs(exact(sqrt(1 + x*x))));
+    if(!std::isfinite(fmax)) throw std::runtime_error("Non-finite beta correction function");
+
+    for(size_t i = 0; i + 1 < p.size(); i++) subdivide(p[i], p[i+1], 1e-3*tol*fmax, tol, 0);
+}
+
+double BetaCorrectionTable::exact(double W) const {
+    switch(kind) {
+        case SPECTRUM: return G.spectrumCorrectionFactor(W);
+        case NEUTRON_G: return Wilkinson_g_a2pi(W);
+        case NEUTRON_ASYM: return asymmetryCorrectionFactor((W - 1)*m_e);
+    }
+    throw std::logic_error("Unknown beta correction function");
+}
+
+/// Chebyshev series c[0...NC) evaluation at t in [-1,1], by Clenshaw recurrence
+template<size_t NC>
+static inline double cheb_eval(const double* c, double t) {
+    double b1 = 0, b2 = 0;
+    for(size_t j = NC - 1; j > 0; j--) {
+        const double b0 = 2*t*b1 - b2 + c[j];
+        b2 = b1;
+        b1 = b0;
+    }
+    return c[0] + t*b1 - b2;
+}
+
+void BetaCorrectionTable::fitInterval(double a, double b, double* c) const {
+    double f[NC];
+    for(size_t k = 0; k < NC; k++) {
+        const double x = 0.5*(a + b) + 0.5*(b - a)*cos(M_PI*(k + 0.5)/NC);
+        f[k] = x*exact(sqrt(1 + x*x));
+    }
+    for(size_t j = 0; j < NC; j++) {
+        double s = 0;
+        for(size_t k = 0; k < NC; k++) s += f[k]*cos(M_PI*j*(k + 0.5)/NC);
+        c[j] = (j? 2. : 1.)*s/NC;
+    }
+}
+
+void BetaCorrectionTable::subdivide(double a, double b, double atol, double tol, int depth) {
+    double c[NC];
+    fitInterval(a, b, c);
+
+    // check interpolant at extrema of T_NC, between nodes
+    bool ok = true;
+    for(size_t k = 1; k < NC && ok; k++) {
+        const double t = cos(M_PI*k/NC);
+        const double x = 0.5*(a + b) + 0.5*(b - a)*t;
+        const double s = x*exact(sqrt(1 + x*x));
+        ok = fabs(cheb_eval<NC>(c, t) - s) <= std::max(tol*fabs(s), atol*x);
+    }
+
+    if(ok || depth >= 30) {
+        kp.push_back(b);
+        cs.insert(cs.end(), c, c + NC);
+        return;
+    }
+    const double m = 0.5*(a + b);
+    subdivide(a, m, atol, tol, depth + 1);
+    subdivide(m, b, atol, tol, depth + 1);
+}
+
+double BetaCorrectionTable::operator()(double W) const {
+    const double p = sqrt((W - 1)*(W + 1));
+    if(!(pLo < p && p < pHi)) return exact(W);
+    const size_t i = std::upper_bound(kp.begin(), kp.end(), p) - kp.begin() - 1;
+    const double a = kp[i], b = kp[i+1];
+    return cheb_eval<NC>(cs.data() + NC*i, (2*p - a - b)/(b - a))/p;
+}
+
+/// shared tables cache key: function, (A, Z, endpoint) and shape parameters
+typedef std::tuple<int, double, double, double, unsigned int, double, double> bct_key_t;
+/// shared tables cache key for spectrum parameters
+static bct_key_t bct_key(const BetaSpectrumGenerator& G, BetaCorrectionTable::kind_t k) {
+    return bct_key_t(k, G.A, G.Z, G.EP, G.forbidden, G.M2_F, G.M2_GT);
+}
+/// shared tables cache
+static std::map<bct_key_t, std::shared_ptr<const BetaCorrectionTable>>& bct_cache() {
+    static std::map<bct_key_t, std::shared_ptr<const BetaCorrectionTable>> cache;
+    return cache;
+}
+/// shared tables cache lock
+static std::mutex bct_cacheMut;
+
+std::shared_ptr<const BetaCorrectionTable> BetaCorrectionTable::get(const BetaSpectrumGenerator& G, kind_t k) {
+    {
+        std::lock_guard<std::mutex> l(bct_cacheMut);
+        auto it = bct_cache().find(bct_key(G, k));
+        if(it != bct_cache().end()) return it->second;
+    }
+    // build outside lock; keep first inserted if built concurrently
+    return share(std::make_shared<const BetaCorrectionTable>(G, k));
+}
+
+std::shared_ptr<const BetaCorrectionTable> BetaCorrectionTable::neutron(kind_t k) {
+    return get(BetaSpectrumGenerator(1, 1, neutronBetaEp), k);
+}
+
+std::shared_ptr<const BetaCorrectionTable> BetaCorrectionTable::share(const std::shared_ptr<const BetaCorrectionTable>& T) {
+    if(!T) throw std::logic_error("Sharing null beta correction table");
+    std::lock_guard<std::mutex> l(bct_cacheMut);
+    return bct_cache().emplace(bct_key(T->G, T->kind), T).first->second;
+}
+
+void BetaCorrectionTable::write(BinaryWriter& W) const {
+    W.start_wtx();
+    W.send(G);
+    W.send<int32_t>(kind);
+    W.send(pLo);
+    W.send(pHi);
+    W.send(kp);
+    W.send(cs);
+    W.end_wtx();
+}
+
+std::shared_ptr<const BetaCorrectionTable> BetaCorrectionTable::read(BinaryReader& R) {
+    BetaSpectrumGenerator G(1, 1, 1);
+    R.receive(G);
+    auto k = R.receive<int32_t>();
+    if(k < SPECTRUM || k > NEUTRON_ASYM) throw std::runtime_error("Invalid beta correction table type");
+    std::shared_ptr<BetaCorrectionTable> T(new BetaCorrectionTable(G, kind_t(k), nullptr));
+    R.receive(T->pLo);
+    R.receive(T->pHi);
+    R.receive(T->kp);
+    R.receive(T->cs);
+    if(T->kp.empty() || T->cs.size() != NC*(T->kp.size() - 1)) throw std::runtime_error("Invalid beta correction table data");
+    return T;
+}
+
+/// correction tables cache file format identifier
+static const string bctcache_magic = "MPMUtils BetaCorrectionTable cache v1";
+
+bool BetaCorrectionTable::loadCache(const string& fname) {
+    MappedFile F;
+    try { F.open(fname); }
+    catch(std::runtime_error&) { return false; }
+
+    MemBReader R(F.data(), F.size());
+    try {
+        R.receiveWireHeader();
+        if(R.receive<string>() != bctcache_magic) return false;
+        vector<std::shared_ptr<const BetaCorrectionTable>> v(R.receive<uint64_t>());
+        for(auto& T: v) T = read(R);
+        for(auto& T: v) share(T);
+    } catch(...) { return false; } // truncated (MemBReader throws int -1) or invalid contents
+    return true;
+}
+
+void BetaCorrectionTable::saveCache(const string& fname) {
+    BinarySerializer W;
+    W.sendWireHeader();
+    W.send(bctcache_magic);
+    {
+        std::lock_guard<std::mutex> l(bct_cacheMut);
+        W.send<uint64_t>(bct_cache().size());
+        for(auto& kv: bct_cache()) kv.second->write(W);
+    }
+
+    // write to (per-process) temporary, then move into place
+    auto& b = W.buf();
+    auto ftmp = fname + "_tmp" + std::to_string(getpid());
+    auto f = fopen(ftmp.c_str(), "wb");
+    if(!f) throw std::runtime_error("Failed to open '" + ftmp + "' for writing");
+    bool ok = fwrite(b.data(), 1, b.size(), f) == b.size();
+    ok = !fclose(f) && ok;
+    if(!ok || rename(ftmp.c_str(), fname.c_str())) {
+        remove(ftmp.c_str());
+        throw std::runtime_error("Failed to write '" + fname + "'");
+    }
+}
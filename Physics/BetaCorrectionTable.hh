@@ -0,0 +1,86 @@
+/// \file BetaCorrectionTable.hh Interpolation tables for beta spectrum and asymmetry correction functions, shared by decay parameters
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef BETACORRECTIONTABLE_HH
+#define BETACORRECTIONTABLE_HH
+
+#include "BetaSpectrumGenerator.hh"
+#include "BinaryIO.hh"
+#include <memory>
+#include <string>
+using std::string;
+
+/// Tabulated correction function of electron energy, for fixed decay (A, Z, endpoint, shape) parameters
+/**
+ * Tabulated in electron momentum p = sqrt(W^2-1), as p*f(W) --- which removes the Fermi function 1/p Coulomb divergence
+ * at W = 1 --- on an adaptive grid (geometrically refined towards both endpoints),
+ * each interval bisected until its degree-7 Chebyshev interpolant matches the function to relative tolerance tol
+ * between the interpolation nodes.
+ * Energies within 100*DBL_EPSILON/tol of either endpoint (in W-1 or (W0-W)/W0), where rounding of the correction functions'
+ * W-based arguments leaves them noisy at the tolerance level, are evaluated directly.
+ * Evaluation needs no special functions; tables also replace per-call caching in the correction functions,
+ * so are safe to share between threads.
+ */
+class BetaCorrectionTable {
+public:
+    /// tabulated function
+    enum kind_t {
+        SPECTRUM = 0,       ///< BetaSpectrumGenerator::spectrumCorrectionFactor(W)
+        NEUTRON_G = 1,      ///< neutron decay outer radiative correction Wilkinson_g_a2pi(W)
+        NEUTRON_ASYM = 2    ///< neutron decay asymmetryCorrectionFactor(KE)
+    };
+
+    /// Constructor, tabulating function kind k for spectrum parameters G to relative tolerance tol
+    explicit BetaCorrectionTable(const BetaSpectrumGenerator& G, kind_t k = SPECTRUM, double tol = 1e-10);
+
+    /// shared table for function kind k of spectrum parameters G, built on first request
+    static std::shared_ptr<const BetaCorrectionTable> get(const BetaSpectrumGenerator& G, kind_t k = SPECTRUM);
+    /// shared table for free neutron decay
+    static std::shared_ptr<const BetaCorrectionTable> neutron(kind_t k);
+    /// add (e.g. deserialized) table to shared tables, returning the existing one for its parameters if present
+    static std::shared_ptr<const BetaCorrectionTable> share(const std::shared_ptr<const BetaCorrectionTable>& T);
+
+    /// serialize table
+    void write(BinaryWriter& W) const;
+    /// deserialize table written by write()
+    static std::shared_ptr<const BetaCorrectionTable> read(BinaryReader& R);
+    /// load and share tables from cache file written by saveCache; return whether successful
+    static bool loadCache(const string& fname);
+    /// write all shared tables to cache file (via temporary file, moved into place)
+    static void saveCache(const string& fname);
+
+    /// interpolated function at W = (KE + m_e)/m_e
+    double operator()(double W) const;
+    /// direct function evaluation
+    double exact(double W) const;
+
+    /// number of interpolation intervals
+    size_t nIntervals() const { return kp.size() - 1; }
+
+    const BetaSpectrumGenerator G;  ///< spectrum parameters
+    const kind_t kind;              ///< tabulated function
+
+protected:
+    /// Constructor for deserialization, without tabulating
+    BetaCorrectionTable(const BetaSpectrumGenerator& _G, kind_t k, std::nullptr_t): G(_G), kind(k) { }
+
+    /// evaluate p*f(W(p)) at Chebyshev nodes of [a,b], filling coefficients c
+    void fitInterval(double a, double b, double* c) const;
+    /// adaptively subdivide [a,b] to relative tolerance tol or absolute tolerance atol on f, appending knots and coefficients
+    void subdivide(double a, double b, double atol, double tol, int depth);
+
+    static constexpr size_t NC = 8; ///< Chebyshev coefficients per interval
+
+    vector<double> kp;              ///< interval knots in electron momentum [m_e c]
+    vector<double> cs;              ///< NC Chebyshev coefficients of p*f per interval
+    double pLo = 0;                 ///< lowest tabulated momentum
+    double pHi = 0;                 ///< highest tabulated momentum
+};
+
+/// tabulated Wilkinson_g_a2pi(W) for neutron decay, thread-safe
+inline double neutron_g_a2pi(double W) {
+    static const auto T = BetaCorrectionTable::neutron(BetaCorrectionTable::NEUTRON_G);
+    return (*T)(W);
+}
+
+#endif
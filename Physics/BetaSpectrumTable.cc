@@ -0,0 +1,171 @@
+/// \file BetaSpectrumTable.cc
+
+#include "BetaSpectrumTable.hh"
+#include "QuadratureEngine.hh"
+#include "UnpolarizedBeta.hh"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+BetaSpectrumTable::BetaSpectrumTable(const BetaSpectrumGenerator& _G, double tol): G(_G) {
+    if(!(G.EP > 0)) throw std::domain_error("Beta spectrum requires positive endpoint");
+    C = BetaCorrectionTable::get(G);
+
+    // coarse grid: uniform, with geometrically narrowing intervals towards both endpoints
+    const size_t n0 = 32, ng = 20;
+    vector<double> e0;
+    for(size_t j = 0; j <= ng; j++) e0.push_back(G.EP*std::ldexp(1./n0, int(j) - int(ng)));
+    for(size_t i = 2; i < n0 - 1; i++) e0.push_back(G.EP*i/n0);
+    for(size_t j = 0; j <= ng; j++) e0.push_back(G.EP*(1 - std::ldexp(1./n0, -int(j))));
+    e0.push_back(G.EP);
+
+    // coarse estimate of total, setting absolute tolerance
+    vector<double> I0(e0.size());
+    double I = 0;
+    for(size_t i = 0; i + 1 < e0.size(); i++) I += (I0[i] = integ(e0[i], e0[i+1]));
+    if(!(I > 0)) throw std::runtime_error("Zero beta spectrum");
+
+    kE.push_back(0);
+    kC.push_back(0);
+    subdivide(0, e0[0], integ(0, e0[0]), tol*I*(e0[0]/G.EP), 0);
+    for(size_t i = 0; i + 1 < e0.size(); i++) subdivide(e0[i], e0[i+1], I0[i], tol*I*(e0[i+1] - e0[i])/G.EP, 0);
+    total = kC.back();
+
+    // average energy, by quadrature over adaptive grid
+    for(size_t i = 0; i + 1 < kE.size(); i++) {
+        const auto& GL = QuadratureEngine::gaussLegendre(5);
+        const double c = 0.5*(kE[i] + kE[i+1]), h = 0.5*(kE[i+1] - kE[i]);
+        for(size_t j = 0; j < GL.size(); j++) {
+            const double x = c + h*GL.x[j];
+            avg += h*GL.w[j]*x*prob(x);
+        }
+    }
+    avg /= total;
+
+    // exact tails outside first and last grid intervals
+    uLo = kC[1]/total;
+    uHi = kC[kC.size() - 2]/total;
+    table.build([this](double u) { return quantile(u); }, tol);
+}
+
+double BetaSpectrumTable::prob(double KE) const {
+    const double W = (KE + m_e)/m_e;
+    if(KE <= 0 || W >= G.W0) return 0.;
+    return plainPhaseSpace(W, G.W0)*(*C)(W);
+}
+
+double BetaSpectrumTable::integ(double a, double b) const {
+    const auto& GL = QuadratureEngine::gaussLegendre(5);
+    const double c = 0.5*(a + b), h = 0.5*(b - a);
+    double s = 0;
+    for(size_t j = 0; j < GL.size(); j++) s += GL.w[j]*prob(c + h*GL.x[j]);
+    return h*s;
+}
+
+void BetaSpectrumTable::subdivide(double a, double b, double I, double atol, int depth) {
+    const double m = 0.5*(a + b);
+    const double I1 = integ(a, m), I2 = integ(m, b);
+    if(fabs(I1 + I2 - I) <= atol || depth >= 40) {
+        kE.push_back(b);
+        kC.push_back(kC.back() + I1 + I2);
+        return;
+    }
+    subdivide(a, m, I1, 0.5*atol, depth + 1);
+    subdivide(m, b, I2, 0.5*atol, depth + 1);
+}
+
+double BetaSpectrumTable::cdf(double KE) const {
+    if(KE <= 0) return 0;
+    if(KE >= G.EP) return 1;
+    size_t i = std::upper_bound(kE.begin(), kE.end(), KE) - kE.begin() - 1;
+    return (kC[i] + integ(kE[i], KE))/total;
+}
+
+double BetaSpectrumTable::quantile(double u) const {
+    if(u <= 0) return 0;
+    if(u >= 1) return G.EP;
+
+    // grid interval, and bracketed Newton solve within it
+    const double c = u*total;
+    size_t i = std::upper_bound(kC.begin(), kC.end(), c) - kC.begin() - 1;
+    if(i + 1 >= kC.size()) return G.EP;
+    double a = kE[i], b = kE[i+1];
+    double x = a + (b - a)*(c - kC[i])/(kC[i+1] - kC[i]);
+    for(int it = 0; it < 100 && b - a > 1e-15*G.EP; it++) {
+        const double f = kC[i] + integ(kE[i], x) - c;
+        if(fabs(f) <= 1e-15*total) return x;
+        if(f > 0) b = x;
+        else a = x;
+        const double p = prob(x);
+        const double xn = p > 0? x - f/p : a;
+        if(fabs(xn - x) <= 1e-14*G.EP) return xn;
+        x = a < xn && xn < b? xn : 0.5*(a + b);
+    }
+    return x;
+}
+
+/// shared tables cache key: (A, Z, endpoint) and shape parameters
+typedef std::tuple<double, double, double, unsigned int, double, double> bst_key_t;
+/// shared tables cache key for spectrum parameters
+static bst_key_t bst_key(const BetaSpectrumGenerator& G) { return bst_key_t(G.A, G.Z, G.EP, G.forbidden, G.M2_F, G.M2_GT); }
+/// shared tables cache
+static std::map<bst_key_t, std::shared_ptr<const BetaSpectrumTable>>& bst_cache() {
+    static std::map<bst_key_t, std::shared_ptr<const BetaSpectrumTable>> cache;
+    return cache;
+}
+/// shared tables cache lock
+static std::mutex bst_cacheMut;
+
+std::shared_ptr<const BetaSpectrumTable> BetaSpectrumTable::get(const BetaSpectrumGenerator& G) {
+    const auto k = bst_key(G);
+    {
+        std::lock_guard<std::mutex> l(bst_cacheMut);
+        auto it = bst_cache().find(k);
+        if(it != bst_cache().end()) return it->second;
+    }
+    // build outside lock; keep first inserted if built concurrently
+    return share(std::make_shared<const BetaSpectrumTable>(G));
+}
+
+std::shared_ptr<const BetaSpectrumTable> BetaSpectrumTable::share(const std::shared_ptr<const BetaSpectrumTable>& T) {
+    if(!T) throw std::logic_error("Sharing null beta spectrum table");
+    std::lock_guard<std::mutex> l(bst_cacheMut);
+    return bst_cache().emplace(bst_key(T->G), T).first->second;
+}
+
+void BetaSpectrumTable::write(BinaryWriter& W) const {
+    W.start_wtx();
+    W.send(G);
+    W.send(kE);
+    W.send(kC);
+    W.send(total);
+    W.send(avg);
+    W.send(uLo);
+    W.send(uHi);
+    W.send(table.getKnotsU());
+    W.send(table.getKnotsX());
+    C->write(W);
+    W.end_wtx();
+}
+
+std::shared_ptr<const BetaSpectrumTable> BetaSpectrumTable::read(BinaryReader& R) {
+    BetaSpectrumGenerator G(1, 1, 1);
+    R.receive(G);
+    std::shared_ptr<BetaSpectrumTable> T(new BetaSpectrumTable(G, nullptr));
+    R.receive(T->kE);
+    R.receive(T->kC);
+    R.receive(T->total);
+    R.receive(T->avg);
+    R.receive(T->uLo);
+    R.receive(T->uHi);
+    auto u = R.receive<vector<double>>();
+    auto x = R.receive<vector<double>>();
+    if(T->kE.size() != T->kC.size() || T->kE.size() < 2 || !(T->total > 0)) throw std::runtime_error("Invalid beta spectrum table data");
+    T->table.setKnots(u, x);
+    T->C = BetaCorrectionTable::share(BetaCorrectionTable::read(R));
+    if(T->C->kind != BetaCorrectionTable::SPECTRUM || bst_key(T->C->G) != bst_key(G)) throw std::runtime_error("Mismatched beta spectrum correction table");
+    return T;
+}
@@ -0,0 +1,74 @@
+/// \file BetaSpectrumTable.hh Precomputed beta spectrum CDF and inverse-CDF sampling tables, shared by spectrum parameters
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef BETASPECTRUMTABLE_HH
+#define BETASPECTRUMTABLE_HH
+
+#include "BetaCorrectionTable.hh"
+#include "MonotoneInverseCDF.hh"
+#include "BinaryIO.hh"
+#include <memory>
+
+/// Tabulated BetaSpectrumGenerator spectrum
+/**
+ * The spectrum is integrated on an adaptive grid (geometrically refined towards both endpoints), bisected until 5-point Gauss-Legendre estimates
+ * over each interval and its halves agree to tol; the CDF at any energy then needs one in-interval
+ * quadrature, and exact quantiles one safeguarded Newton solve.
+ * Sampling uses a constant-time MonotoneInverseCDF table, except in the first and last grid intervals,
+ * where the (square- and cube-root-like) quantile tails are solved exactly.
+ * The spectrum shape correction is evaluated from a shared BetaCorrectionTable, saved alongside the spectrum tables.
+ */
+class BetaSpectrumTable {
+public:
+    /// Constructor, tabulating spectrum of G to relative tolerance tol
+    explicit BetaSpectrumTable(const BetaSpectrumGenerator& G, double tol = 1e-6);
+
+    /// shared table for spectrum parameters of G, built on first request
+    static std::shared_ptr<const BetaSpectrumTable> get(const BetaSpectrumGenerator& G);
+    /// add (e.g. deserialized) table to shared tables, returning the existing one for its spectrum parameters if present
+    static std::shared_ptr<const BetaSpectrumTable> share(const std::shared_ptr<const BetaSpectrumTable>& T);
+
+    /// serialize table
+    void write(BinaryWriter& W) const;
+    /// deserialize table written by write()
+    static std::shared_ptr<const BetaSpectrumTable> read(BinaryReader& R);
+
+    /// normalized probability density at kinetic energy KE [1/MeV]
+    double pdf(double KE) const { return prob(KE)/total; }
+    /// cumulative probability below KE
+    double cdf(double KE) const;
+    /// exact quantile KE [MeV] for cumulative probability u
+    double quantile(double u) const;
+    /// constant-time random KE [MeV] for uniform u in [0,1]
+    double sample(double u) const { return u < uLo || u > uHi? quantile(u) : table(u); }
+
+    /// average kinetic energy [MeV]
+    double getAvg() const { return avg; }
+    /// endpoint kinetic energy [MeV]
+    double getEndpoint() const { return G.EP; }
+    /// number of adaptive grid knots
+    size_t nKnots() const { return kE.size(); }
+
+protected:
+    /// Constructor for deserialization, without tabulating
+    explicit BetaSpectrumTable(const BetaSpectrumGenerator& _G, std::nullptr_t): G(_G) { }
+
+    /// unnormalized spectrum at KE [MeV], using tabulated correction factor
+    double prob(double KE) const;
+    /// integral of (unnormalized) spectrum over [a,b], by 5-point Gauss-Legendre quadrature
+    double integ(double a, double b) const;
+    /// adaptively subdivide [a,b] with integral estimate I, appending knots and CDF
+    void subdivide(double a, double b, double I, double atol, int depth);
+
+    const BetaSpectrumGenerator G;  ///< spectrum calculator
+    std::shared_ptr<const BetaCorrectionTable> C;   ///< tabulated spectrum shape correction
+    vector<double> kE;              ///< knot energies [MeV]
+    vector<double> kC;              ///< (unnormalized) CDF at knots
+    double total = 0;               ///< spectrum integral
+    double avg = 0;                 ///< average energy
+    double uLo = 0;                 ///< upper CDF of lowest grid interval
+    double uHi = 1;                 ///< lower CDF of highest grid interval
+    MonotoneInverseCDF table;       ///< inverse CDF sampling table
+};
+
+#endif
@@ -1,39 +1,39 @@
 /// \file ElectronBindingEnergy.cc
 
 #include "ElectronBindingEnergy.hh"
+#include "PathUtils.hh"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
 #include <stdio.h>
+#include <type_traits>
 
 const string BindingEnergyTable::shellnames = "KLMNOPQRST";
 
-BindingEnergyTable::BindingEnergyTable(const Stringmap& m): Z(m.getDefault("Z",0)), nm(m.getDefault("name","")) {
+BindingEnergyTable::BindingEnergyTable(const FlatStringmap& m): Z(m.getDefault("Z",0)) {
+    strncpy(nm, m.getDefault("name","").c_str(), sizeof(nm)-1);
     for(unsigned int n=0; n<shellnames.size(); n++) {
-        vector<double> v;
-        for(unsigned int s=1; s<=9; s++) {
+        for(unsigned int s=1; s<=NSUB; s++) {
             double b = m.getDefault(c_to_str(shellnames[n])+(n+s==1?"":to_str(s)),0);
-            if(b) v.push_back(b/1000.0);
+            if(b) eBinding[n][nsub[n]++] = b/1000.0;
             else break;
         }
-        if(v.size()) eBinding.push_back(v);
+        if(nsub[n]) nshells++;
         else break;
     }
 }
 
-const vector<double>& BindingEnergyTable::getShellBinding(unsigned int n) const {
-    if(n>=eBinding.size()) return noBinding;
-    return eBinding[n];
-}
-
-double BindingEnergyTable::getSubshellBinding(unsigned int n, unsigned int m) const {
-    const vector<double>& v = getShellBinding(n);
-    if(m>=v.size()) return 0;
-    return v[m];
+vector<double> BindingEnergyTable::getShellBinding(unsigned int n) const {
+    if(n>=nshells) return {};
+    return vector<double>(eBinding[n], eBinding[n] + nsub[n]);
 }
 
 void BindingEnergyTable::display() const {
-    printf("----- %u %s Electron Binding -----\n",Z,nm.c_str());
-    for(unsigned int n=0; n<eBinding.size(); n++) {
+    printf("----- %u %s Electron Binding -----\n",Z,nm);
+    for(unsigned int n=0; n<nshells; n++) {
         printf("\t%c:",shellnames[n]);
-        for(unsigned int m=0; m<eBinding[n].size(); m++)
+        for(unsigned int m=0; m<nsub[n]; m++)
             printf("\t%.2f",eBinding[n][m]);
         printf("\n");
     }
@@ -41,25 +41,100 @@ void BindingEnergyTable::display() const {
 
 //----------------------------------------------
 
+/// binary cache file header
+struct bel_header_t {
+    char magic[4];      ///< file identifier
+    uint32_t version;   ///< format version
+    uint32_t tsize;     ///< sizeof(BindingEnergyTable)
+    uint32_t n;         ///< number of tables
+};
+static_assert(std::is_trivially_copyable<BindingEnergyTable>::value, "BindingEnergyTable binary cache requires trivially copyable layout");
+/// binary cache file identifier
+static const char bel_magic[4] = {'M', 'P', 'B', 'E'};
+
 BindingEnergyLibrary::BindingEnergyLibrary(const SMFile& Q) {
-    for(auto& b: Q.retrieve("binding"))
-        tables.emplace(b.getDefault("Z",0), new BindingEnergyTable(b));
+    for(auto& b: Q.retrieveFlat("binding")) tables.emplace_back(b);
+    // Z order, keeping first entry for each Z
+    std::stable_sort(tables.begin(), tables.end(), [](const BindingEnergyTable& a, const BindingEnergyTable& b) { return a.getZ() < b.getZ(); });
+    tables.erase(std::unique(tables.begin(), tables.end(), [](const BindingEnergyTable& a, const BindingEnergyTable& b) { return a.getZ() == b.getZ(); }), tables.end());
+    makeIndex();
+}
+
+std::shared_ptr<BindingEnergyLibrary> BindingEnergyLibrary::readCache(const string& fname) {
+    auto f = fopen(fname.c_str(), "rb");
+    if(!f) throw std::runtime_error("Failed to open '" + fname + "'");
+    std::shared_ptr<BindingEnergyLibrary> L(new BindingEnergyLibrary());
+    auto& T = L->tables;
+    bel_header_t h;
+    bool ok = fread(&h, sizeof(h), 1, f) == 1 && !memcmp(h.magic, bel_magic, sizeof(bel_magic))
+              && h.version == 1 && h.tsize == sizeof(BindingEnergyTable);
+    if(ok) {
+        T.resize(h.n);
+        ok = !h.n || fread(T.data(), sizeof(BindingEnergyTable), h.n, f) == h.n;
+    }
+    fclose(f);
+    for(size_t i = 1; ok && i < T.size(); i++) ok = T[i-1].getZ() < T[i].getZ();
+    if(!ok) throw std::runtime_error("Invalid binding energy cache file '" + fname + "'");
+    L->makeIndex();
+    return L;
+}
+
+void BindingEnergyLibrary::makeIndex() {
+    zIndex.assign(tables.size()? tables.back().getZ() + 1 : 0, -1);
+    for(size_t i = 0; i < tables.size(); i++) zIndex[tables[i].getZ()] = i;
 }
 
-BindingEnergyLibrary::~BindingEnergyLibrary() {
-    for(auto& kv: tables) delete kv.second;
+void BindingEnergyLibrary::writeCache(const string& fname) const {
+    bel_header_t h;
+    memcpy(h.magic, bel_magic, sizeof(h.magic));
+    h.version = 1;
+    h.tsize = sizeof(BindingEnergyTable);
+    h.n = tables.size();
+
+    // write to temporary, then move into place
+    auto ftmp = fname + "_tmp";
+    auto f = fopen(ftmp.c_str(), "wb");
+    if(!f) throw std::runtime_error("Failed to open '" + ftmp + "' for writing");
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = ok && (tables.empty() || fwrite(tables.data(), sizeof(BindingEnergyTable), tables.size(), f) == tables.size());
+    ok = !fclose(f) && ok;
+    if(!ok || rename(ftmp.c_str(), fname.c_str())) {
+        remove(ftmp.c_str());
+        throw std::runtime_error("Failed to write '" + fname + "'");
+    }
+}
+
+std::shared_ptr<const BindingEnergyLibrary> BindingEnergyLibrary::load(const string& fname) {
+    static map<string, std::shared_ptr<const BindingEnergyLibrary>> loaded;
+    static std::mutex loadMut;
+    std::lock_guard<std::mutex> l(loadMut);
+    auto it = loaded.find(fname);
+    if(it != loaded.end()) return it->second;
+
+    // binary cache, if no older than text source
+    std::shared_ptr<const BindingEnergyLibrary> L;
+    const string cfile = fname + ".bin";
+    const double tc = fileAge(cfile), tf = fileAge(fname);
+    if(tc >= 0 && (tc <= tf || tf < 0)) {
+        try { L = readCache(cfile); }
+        catch(std::runtime_error&) { }
+    }
+    if(!L) {
+        L = std::make_shared<const BindingEnergyLibrary>(SMFile(fname));
+        try { L->writeCache(cfile); }
+        catch(std::runtime_error&) { } // e.g. read-only data directory
+    }
+    return loaded.emplace(fname, L).first->second;
 }
 
 const BindingEnergyTable* BindingEnergyLibrary::getBindingTable(unsigned int Z, bool allownullptr) const {
-    map<unsigned int,BindingEnergyTable*>::const_iterator it =  tables.find(Z);
-    if(it==tables.end()) {
+    if(Z >= zIndex.size() || zIndex[Z] < 0) {
         if(allownullptr) return nullptr;
         throw std::runtime_error("Missing Element");
     }
-    return it->second;
+    return &tables[zIndex[Z]];
 }
 
 void BindingEnergyLibrary::display() const {
-    for(auto& kv: tables) kv.second->display();
+    for(auto& t: tables) t.display();
 }
-
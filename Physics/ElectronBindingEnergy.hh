@@ -5,45 +5,67 @@
 #define ELECTRONBINDINGENERGY_HH
 
 #include "SMFile.hh"
+#include <memory>
+#include <stdint.h>
 
-/// table of electron binding energies
+/// table of electron binding energies, in fixed-size flat arrays (trivially copyable)
 class BindingEnergyTable {
 public:
-    /// constructor from Stringmap
-    explicit BindingEnergyTable(const Stringmap& m);
+    /// constructor from key/value data
+    explicit BindingEnergyTable(const FlatStringmap& m);
+    /// default constructor for empty table
+    BindingEnergyTable() { }
     /// get subshell binding energies for given shell
-    const vector<double>& getShellBinding(unsigned int n) const;
-    /// get subshell binding energy
-    double getSubshellBinding(unsigned int n, unsigned int m) const;
+    vector<double> getShellBinding(unsigned int n) const;
+    /// get subshell binding energy [keV], 0 if unknown
+    double getSubshellBinding(unsigned int n, unsigned int m) const { return n < NSHELL && m < nsub[n]? eBinding[n][m] : 0; }
+    /// number of shells with binding information
+    unsigned int getNShells() const { return nshells; }
     /// display summary of binding energies
     void display() const;
     /// get Z
     unsigned int getZ() const { return Z; }
     /// get element name
-    string getName() const { return nm; }
+    string getName() const { return string(nm); }
 
     static const string shellnames;
+    static constexpr unsigned int NSHELL = 10;  ///< maximum number of shells
+    static constexpr unsigned int NSUB = 9;     ///< maximum number of subshells per shell
 
 protected:
-    unsigned int Z;                     ///< element number
-    string nm;                          ///< element name abbrev.
-    vector< vector<double> > eBinding;  ///< binding energy by shell and subshell
-    const vector<double> noBinding;     ///< empty vector for missing info
+    uint32_t Z = 0;                             ///< element number
+    uint32_t nshells = 0;                       ///< number of shells with binding information
+    char nm[8] = {};                            ///< element name abbrev.
+    uint8_t nsub[NSHELL] = {};                  ///< number of subshells by shell
+    double eBinding[NSHELL][NSUB] = {};         ///< binding energy [keV] by shell and subshell
 };
 
-/// catalog of many BindingEnergyTables
+/// catalog of many BindingEnergyTables, indexed by Z
 class BindingEnergyLibrary {
 public:
     /// constructor from SMFile containing element tables
     explicit BindingEnergyLibrary(const SMFile& Q);
-    /// destructor
-    ~BindingEnergyLibrary();
+
+    /// shared read-only library for element tables text file, loaded once; parsed from up-to-date binary cache fname + ".bin" if available, or (re-)written to it
+    static std::shared_ptr<const BindingEnergyLibrary> load(const string& fname);
+    /// write binary cache file
+    void writeCache(const string& fname) const;
+    /// read library from binary cache file written by writeCache
+    static std::shared_ptr<BindingEnergyLibrary> readCache(const string& fname);
+
     /// get BindingEnergyTable for specified element
     const BindingEnergyTable* getBindingTable(unsigned int Z, bool allownullptr = false) const;
     /// display contents
     void display() const;
+
 protected:
-    map<unsigned int,BindingEnergyTable*> tables; ///< binding energy tables by element
+    /// default constructor for empty library
+    BindingEnergyLibrary() { }
+    /// build Z index
+    void makeIndex();
+
+    vector<BindingEnergyTable> tables;  ///< binding energy tables in Z order
+    vector<int> zIndex;                 ///< index of table for each Z, -1 for missing
 };
 
 #endif
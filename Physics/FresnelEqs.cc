@@ -1,8 +1,79 @@
 /// \file FresnelEqs.cc
 
 #include "FresnelEqs.hh"
+#include <algorithm>
 #include <stdexcept>
 
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && !defined(__AVX2__)
+#define FRESNEL_DISPATCH ///< runtime-selected AVX2 kernels
+#endif
+
+/// kernel bodies, compiled into generic and instruction-set-targeted wrappers (vectorized with -fno-math-errno -fno-trapping-math)
+#define FRESNEL_INLINE static inline __attribute__((always_inline))
+
+FRESNEL_INLINE void _fresnel_R(const double* __restrict__ ci, size_t n, double r, double* __restrict__ Rs, double* __restrict__ Rp) {
+    for(size_t i = 0; i < n; ++i) {
+        const double c = ci[i];
+        const double t = 1 - r*r*(1 - c*c);
+        const bool tir = !(t > 0);
+        const double ct = sqrt(tir? 0. : t);
+        // TIR as q = 1 (selected on inputs, avoiding 0/0 at ci = 0)
+        const double a = (tir? 1. : r*c - ct)/(tir? 1. : r*c + ct), b = (tir? 1. : r*ct - c)/(tir? 1. : r*ct + c);
+        Rs[i] = a*a;
+        Rp[i] = b*b;
+    }
+}
+
+/// compose Rx/Tx R,T with appended surface R1,T1, as s_RxTx::operator+= (R*R1 == 1 only for R = R1 = 1, T = T1 = 0 => U = 0)
+FRESNEL_INLINE void _compose(double& R, double& T, double R1, double T1) {
+    const double RR = R*R1;
+    const double U = T/(RR == 1? 1. : 1 - RR);
+    R += T*R1*U;
+    T = T1*U;
+}
+
+/// apply layer with index mismatch r[i] and pre-attenuation A[i] at incident ci[i], updating ci[i] to transmitted; as s_Fresnel_Rx::set_ci_single and operator+=
+FRESNEL_INLINE void _fresnel_layer(const double* __restrict__ r, const double* __restrict__ A, double* __restrict__ ci,
+                                   double* __restrict__ Rs, double* __restrict__ Ts, double* __restrict__ Rp, double* __restrict__ Tp, size_t n) {
+    for(size_t i = 0; i < n; ++i) {
+        const double c = ci[i], rr = r[i], a = A[i], a2 = a*a;
+        const double t = 1 - rr*rr*(1 - c*c);
+        const bool tir = !(t > 0);
+        const double ct = sqrt(tir? 0. : t);
+        // TIR mirror as q = 1 (selected on inputs, avoiding 0/0 at ci = 0)
+        double qs = (tir? 1. : rr*c - ct)/(tir? 1. : rr*c + ct), qp = (tir? 1. : rr*ct - c)/(tir? 1. : rr*ct + c);
+        qs *= qs;
+        qp *= qp;
+        _compose(Rs[i], Ts[i], qs*a2, (1 - qs)*a);
+        _compose(Rp[i], Tp[i], qp*a2, (1 - qp)*a);
+        ci[i] = ct;
+    }
+}
+
+#ifdef FRESNEL_DISPATCH
+/// generate AVX2-targeted wrapper K_avx2 for kernel K
+#define FRESNEL_AVX2(K, PARAMS, ARGS) __attribute__((target("avx2,fma"))) static void K##_avx2 PARAMS { _##K ARGS; }
+
+FRESNEL_AVX2(fresnel_R, (const double* ci, size_t n, double r, double* Rs, double* Rp), (ci, n, r, Rs, Rp))
+FRESNEL_AVX2(fresnel_layer, (const double* r, const double* A, double* ci, double* Rs, double* Ts, double* Rp, double* Tp, size_t n),
+             (r, A, ci, Rs, Ts, Rp, Tp, n))
+
+/// whether AVX2/FMA available
+static bool fresnel_avx2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return avx2;
+}
+
+/// dispatch kernel K to AVX2 if available
+#define FRESNEL_CALL(K, ARGS) do { if(fresnel_avx2()) K##_avx2 ARGS; else _##K ARGS; } while(0)
+#else
+#define FRESNEL_CALL(K, ARGS) _##K ARGS
+#endif
+
+void Fresnel_R_batch(const double* ci, size_t n, double r, double* Rs, double* Rp) {
+    FRESNEL_CALL(fresnel_R, (ci, n, r, Rs, Rp));
+}
+
 void s_IndexChange::operator+=(const s_IndexChange& X) {
     if(X.ccrit > bcrit) { // new forward-critical-angle limitation
         ccrit = cth_tx(X.ccrit, 1./r);
@@ -124,7 +195,91 @@ void FresnelStack::set_cth0(double cth) {
     }
 }
 
+void FresnelStack::_calc_batch(const double* cth, const double* const* rl, size_t n, FresnelBatch& B) const {
+    B.resize(n);
+    const size_t nb = 256; // block size for per-layer r, A0 attenuation scratch
+    double rv[nb], Av[nb];
+    for(size_t i0 = 0; i0 < n; i0 += nb) {
+        const size_t m = std::min(nb, n - i0);
+        double* cx = B.ct.data() + i0;
+        double* Rs = B.Rs.data() + i0;
+        double* Ts = B.Ts.data() + i0;
+        double* Rp = B.Rp.data() + i0;
+        double* Tp = B.Tp.data() + i0;
+        // initial r = 1 surface of set_cth0 (exactly, rather than with its sqrt(1 - (1 - c^2)) rounding)
+        std::copy(cth + i0, cth + i0 + m, cx);
+        std::fill(Rs, Rs + m, 0.);
+        std::fill(Ts, Ts + m, 1.);
+        std::fill(Rp, Rp + m, 0.);
+        std::fill(Tp, Tp + m, 1.);
+
+        for(size_t l = 0; l < size(); ++l) {
+            auto& F = (*this)[l];
+            if(rl) std::copy(rl[l] + i0, rl[l] + i0 + m, rv);
+            else std::fill(rv, rv + m, F.r);
+            if(F.A0 < 1) for(size_t j = 0; j < m; ++j) Av[j] = cx[j] > 0? pow(F.A0, 1./cx[j]) : 0.;
+            else std::fill(Av, Av + m, 1.);
+            FRESNEL_CALL(fresnel_layer, (rv, Av, cx, Rs, Ts, Rp, Tp, m));
+        }
+    }
+}
+
 void FresnelStack::display() const {
     s_Fresnel_Rx::display();
     for(auto& F: *this) { printf("\t"); F.display(); }
 }
+
+//----------------------
+
+FresnelTable::FresnelTable(const FresnelStack& S, size_t n) {
+    if(n < 2) throw std::domain_error("FresnelTable requires at least 2 points");
+
+    // TIR onset where Snell's-law sin theta reaches 1 inside stack, from running product of index ratios
+    double P = 1, Pmax = 1;
+    for(auto& F: S) Pmax = std::max(Pmax, P *= F.r);
+    ccrit = Pmax > 1? cth_TIR(Pmax) : 0.;
+    const double umax = sqrt(1 - ccrit*ccrit);
+
+    vector<double> c;
+    for(size_t i = 0; i < n; ++i) {
+        const double u = umax*i/(n - 1);
+        c.push_back(sqrt(ccrit*ccrit + u*u));
+    }
+    if(ccrit) for(size_t i = 0; i < n; ++i) c.push_back(ccrit*i/(n - 1));
+
+    FresnelBatch B;
+    S.calc_batch(c.data(), c.size(), B);
+    for(size_t i = 0; i < c.size(); ++i) (i < n? Ttx : Ttir).push_back({B.ct[i], B.Rs[i], B.Ts[i], B.Rp[i], B.Tp[i]});
+    itx = umax? (n - 1)/umax : 0.;
+    itir = ccrit? (n - 1)/ccrit : 0.;
+}
+
+FresnelTable::entry FresnelTable::interpl(double ci) const {
+    const bool tir = ci < ccrit;
+    auto& T = tir? Ttir : Ttx;
+    const double x = std::min(std::max(tir? ci*itir : sqrt(std::max(ci*ci - ccrit*ccrit, 0.))*itx, 0.), double(T.size() - 1));
+    const size_t j = std::min(size_t(x), T.size() - 2);
+    const double f = x - j, g = 1 - f;
+    auto& a = T[j];
+    auto& b = T[j+1];
+    return {g*a.ct + f*b.ct, g*a.Rs + f*b.Rs, g*a.Ts + f*b.Ts, g*a.Rp + f*b.Rp, g*a.Tp + f*b.Tp};
+}
+
+double FresnelTable::eval(double ci, s_RxTx& X_s, s_RxTx& X_p) const {
+    auto e = interpl(ci);
+    X_s = {e.Rs, e.Ts};
+    X_p = {e.Rp, e.Tp};
+    return e.ct;
+}
+
+void FresnelTable::eval_batch(const double* ci, size_t n, FresnelBatch& B) const {
+    B.resize(n);
+    for(size_t i = 0; i < n; ++i) {
+        auto e = interpl(ci[i]);
+        B.ct[i] = e.ct;
+        B.Rs[i] = e.Rs;
+        B.Ts[i] = e.Ts;
+        B.Rp[i] = e.Rp;
+        B.Tp[i] = e.Tp;
+    }
+}
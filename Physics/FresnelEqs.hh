@@ -121,6 +121,23 @@ struct s_Fresnel_Rx: public s_IndexChange {
 //------------------------
 //------------------------
 
+/// S- and P-polarization Fresnel reflected power Rs[i], Rp[i] (1 for TIR) at n incident cos theta ci[i], moving from n1 to n2 (r = n1/n2)
+void Fresnel_R_batch(const double* ci, size_t n, double r, double* Rs, double* Rp);
+
+/// Structure-of-arrays FresnelStack results over many incident angles
+struct FresnelBatch {
+    /// resize all arrays
+    void resize(size_t n) { for(auto v: {&ct, &Rs, &Ts, &Rp, &Tp}) v->resize(n); }
+    /// number of entries
+    size_t size() const { return ct.size(); }
+
+    vector<double> ct;  ///< transmitted cos theta out of stack (0 for TIR)
+    vector<double> Rs;  ///< S polarization reflected power fraction
+    vector<double> Ts;  ///< S polarization transmitted power fraction
+    vector<double> Rp;  ///< P polarization reflected power fraction
+    vector<double> Tp;  ///< P polarization transmitted power fraction
+};
+
 /// Total from sequential index mismatches {r1, r2, ...}
 class FresnelStack: public vector<s_Fresnel_Rx>, public s_Fresnel_Rx {
 public:
@@ -129,9 +146,50 @@ public:
 
     /// calculate for incident cos theta
     void set_cth0(double cth);
+    /// calculate for n incident cos theta cth[i] into B, equivalent to set_cth0(cth[i])
+    void calc_batch(const double* cth, size_t n, FresnelBatch& B) const { _calc_batch(cth, nullptr, n, B); }
+    /// calculate with per-entry index mismatch rl[l][i] for each layer l (e.g. wavelength-dependent), in place of layer r
+    void calc_batch(const double* cth, const double* const* rl, size_t n, FresnelBatch& B) const { _calc_batch(cth, rl, n, B); }
 
     /// print info to stdout
     void display() const;
+
+protected:
+    /// batch calculation, with optional per-entry layer r
+    void _calc_batch(const double* cth, const double* const* rl, size_t n, FresnelBatch& B) const;
+};
+
+/// Linear interpolation table of fixed FresnelStack results versus incident cos theta, resolving the TIR edge
+class FresnelTable {
+public:
+    /// Constructor, tabulating n points each over TIR and transmitting incident angle ranges
+    explicit FresnelTable(const FresnelStack& S, size_t n = 1024);
+
+    /// interpolated results at incident cos theta ci in [0,1]: transmitted cos theta, S and P polarization Rx/Tx
+    double eval(double ci, s_RxTx& X_s, s_RxTx& X_p) const;
+    /// interpolated unpolarized reflected power fraction at incident cos theta ci
+    double R(double ci) const { s_RxTx X_s, X_p; eval(ci, X_s, X_p); return 0.5*(X_s.Rx + X_p.Rx); }
+    /// interpolated results for n incident cos theta ci[i] into B
+    void eval_batch(const double* ci, size_t n, FresnelBatch& B) const;
+
+    double ccrit = 0;   ///< incident cos theta for TIR onset in stack
+
+protected:
+    /// tabulated point
+    struct entry {
+        double ct;  ///< transmitted cos theta
+        double Rs;  ///< S polarization reflected power fraction
+        double Ts;  ///< S polarization transmitted power fraction
+        double Rp;  ///< P polarization reflected power fraction
+        double Tp;  ///< P polarization transmitted power fraction
+    };
+    /// interpolated entry at incident cos theta
+    entry interpl(double ci) const;
+
+    vector<entry> Ttir; ///< table uniform in ci over TIR range [0, ccrit]
+    vector<entry> Ttx;  ///< table uniform in u = sqrt(ci^2 - ccrit^2), smooth across TIR edge, over transmitting range
+    double itir = 0;    ///< TIR table inverse spacing
+    double itx = 0;     ///< transmitting table inverse spacing
 };
 
 #endif
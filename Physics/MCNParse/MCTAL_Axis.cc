@@ -46,7 +46,7 @@ void MCTAL_AxBins::load(const string& cs, lineReader& i) {
         resize(nbins - (bintype == BINTP_TOTAL? 1 : 0));
         for(auto& x: *this) {
             i.checkEnd();
-            i >> x;
+            i.scan(x);
         }
     }
 }
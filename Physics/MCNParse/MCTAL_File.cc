@@ -3,11 +3,15 @@
 #include "MCTAL_File.hh"
 #include <stdio.h>
 
-MCTAL_File::MCTAL_File(istream& i): lr(i), hdr(lr) {
+MCTAL_File::MCTAL_File(istream& i): lr(i), hdr(lr) { load(); }
+
+MCTAL_File::MCTAL_File(const string& fname): mf(fname), lr(mf), hdr(lr) { load(); }
+
+void MCTAL_File::load() {
     try {
         for(int n=0; n < hdr.ntal; ++n) emplace_back(&lr);
     } catch(std::runtime_error& e) {
-        printf("Error loading MCTAL file at line %i [%s]\n", lr.lno, lr.lstr.c_str());
+        printf("Error loading MCTAL file at line %i [%s]\n", lr.lno, lr.line().str().c_str());
         throw;
     }
 }
@@ -12,9 +12,15 @@ class MCTAL_File: public vector<MCTAL_Tally> {
 public:
     /// Constructor
     explicit MCTAL_File(istream& i);
+    /// Constructor, from (memory-mapped) file
+    explicit MCTAL_File(const string& fname);
     /// print summary to stdout
     void display() const;
 protected:
+    /// load tallies after header
+    void load();
+
+    MappedFile mf;      ///< mapped input file (when loading by name)
     lineReader lr;      ///< line-by-line reader
 public:
     MCTAL_Header hdr;   ///< file header
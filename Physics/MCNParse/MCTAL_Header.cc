@@ -8,7 +8,7 @@ MCTAL_Header::MCTAL_Header(lineReader& i) {
     try {
         i.next() >> kod >> ver >> prob_date >> prob_time >> knod >> nps >> rnr;
 
-        probid = i.next().lstr;
+        probid = i.next().line().str();
         check_expected(probid.at(0), " ");
 
         string s_tmp;
@@ -18,9 +18,12 @@ MCTAL_Header::MCTAL_Header(lineReader& i) {
 
         i.next();
         tallynums.resize(ntal);
-        for(int n=0; n < ntal; ++n) i >> tallynums[n];
+        for(int n=0; n < ntal; ++n) {
+            i.checkEnd();
+            i >> tallynums[n];
+        }
     } catch(std::runtime_error& e) {
-        printf("Problem parsing MCTAL header at line %i [%s]\n", i.lno, i.lstr.c_str());
+        printf("Problem parsing MCTAL header at line %i [%s]\n", i.lno, i.line().str().c_str());
         throw;
     }
 }
@@ -2,7 +2,7 @@
 // Michael P. Mendenhall, LLNL 2021
 
 #ifndef MCTAL_HEADER_HH
-#define MCTAL_HEADE
+#define MCTAL_HEADER_HH
 
 #include "MCTAL_Includes.hh"
 #include <cstdint>
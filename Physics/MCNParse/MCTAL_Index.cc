@@ -0,0 +1,103 @@
+/// \file MCTAL_Index.cc
+
+#include "MCTAL_Index.hh"
+#include "to_str.hh"
+#include <atomic>
+#include <exception>
+#include <stdio.h>
+#include <thread>
+
+/// check whether line starts a tally block, "tally <number> ..."
+static bool is_tally_line(charspan l) {
+    static const char t[] = "TALLY";
+    if(l.n < 6 || !is_field_space(l.p[5])) return false;
+    for(int j = 0; j < 5; ++j) if(::toupper(l.p[j]) != t[j]) return false;
+    return true;
+}
+
+MCTAL_Index::MCTAL_Index(const string& fname): mf(fname), lr(mf), hdr(lr) {
+    // quick scan for tally block starts; ends at next block or end of file (including any final KCODE)
+    LineSpanner S(mf.span());
+    charspan l;
+    const char* e = mf.data() + mf.size();
+    while(S.next(l)) {
+        if(!is_tally_line(l)) continue;
+        if(blocks.size()) blocks.back().n = l.p - blocks.back().p;
+        blocks.emplace_back(l.p, e);
+        const char* p = l.p + 5;
+        int n = 0;
+        if(!parse_field(p, l.end(), n)) throw std::runtime_error("Bad MCTAL tally line '" + l.str() + "'");
+        nums.push_back(n);
+    }
+    if(int(blocks.size()) != hdr.ntal)
+        throw std::runtime_error("MCTAL header lists " + to_str(hdr.ntal) + " tallies, but found " + to_str(blocks.size()));
+
+    tallies.resize(blocks.size());
+    parsed.reset(new std::once_flag[blocks.size()]);
+}
+
+size_t MCTAL_Index::find(int num) const {
+    auto it = std::find(nums.begin(), nums.end(), num);
+    if(it == nums.end()) throw std::runtime_error("Tally " + to_str(num) + " not in MCTAL file");
+    return it - nums.begin();
+}
+
+const MCTAL_Tally& MCTAL_Index::at(size_t i) {
+    auto b = blocks.at(i);
+    std::call_once(parsed[i], [&]() {
+        lineReader i_lr(b.p, b.n);
+        std::unique_ptr<MCTAL_Tally> t(new MCTAL_Tally);
+        try { t->load(i_lr); }
+        catch(std::runtime_error& e) {
+            printf("Error loading MCTAL tally %i at line %i [%s]\n", nums[i], i_lr.lno, i_lr.line().str().c_str());
+            throw;
+        }
+        tallies[i] = std::move(t);
+    });
+    return *tallies[i];
+}
+
+void MCTAL_Index::load(const vector<size_t>& ii, unsigned int nthreads) {
+    if(!nthreads) nthreads = std::thread::hardware_concurrency();
+    if(nthreads > ii.size()) nthreads = ii.size();
+    if(nthreads <= 1) {
+        for(auto i: ii) at(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr err;
+    std::mutex errMut;
+    vector<std::thread> v;
+    for(unsigned int t = 0; t < nthreads; ++t) v.emplace_back([&]() {
+        for(size_t j; (j = next++) < ii.size();) {
+            try { at(ii[j]); }
+            catch(...) {
+                std::lock_guard<std::mutex> l(errMut);
+                if(!err) err = std::current_exception();
+            }
+        }
+    });
+    for(auto& t: v) t.join();
+    if(err) std::rethrow_exception(err);
+}
+
+void MCTAL_Index::loadNums(const vector<int>& nn, unsigned int nthreads) {
+    vector<size_t> ii;
+    for(auto n: nn) ii.push_back(find(n));
+    load(ii, nthreads);
+}
+
+void MCTAL_Index::display() const {
+    printf("\n*******************************\n");
+    hdr.display();
+    printf("Indexed %zu tallies (%zu bytes):", size(), mf.size());
+    for(size_t i = 0; i < size(); ++i) printf(" %i%s", nums[i], tallies[i]? "*" : "");
+    printf("\n");
+    for(auto& t: tallies) {
+        if(!t) continue;
+        printf("\n---------------------------------------\n");
+        t->display();
+    }
+    printf("*******************************\n\n");
+}
@@ -0,0 +1,53 @@
+/// \file MCTAL_Index.hh Indexed, on-demand tally parsing for large MCNP "MCTAL" files
+// Michael P. Mendenhall, LLNL 2021
+
+#ifndef MCTAL_INDEX_HH
+#define MCTAL_INDEX_HH
+
+#include "MCTAL_Header.hh"
+#include "MCTAL_Tally.hh"
+#include <memory>
+#include <mutex>
+
+/// Memory-mapped MCTAL file, indexed by tally position; tallies parsed only when requested
+class MCTAL_Index {
+public:
+    /// Constructor, mapping file, reading header, and locating tally blocks
+    explicit MCTAL_Index(const string& fname);
+
+    /// number of tallies in file
+    size_t size() const { return blocks.size(); }
+    /// tally ID number at position
+    int tallyNum(size_t i) const { return nums.at(i); }
+    /// position of tally by ID number; throw std::runtime_error if absent
+    size_t find(int num) const;
+    /// unparsed text of tally at position
+    charspan block(size_t i) const { return blocks.at(i); }
+
+    /// tally at position, parsed on first access (thread-safe)
+    const MCTAL_Tally& at(size_t i);
+    /// tally by ID number, parsed on first access (thread-safe)
+    const MCTAL_Tally& tally(int num) { return at(find(num)); }
+    /// whether tally at position has been parsed
+    bool isLoaded(size_t i) const { return bool(tallies.at(i)); }
+    /// parse selected tally positions, using nthreads parallel threads (0 for hardware concurrency)
+    void load(const vector<size_t>& ii, unsigned int nthreads = 0);
+    /// parse tallies with selected ID numbers, in parallel
+    void loadNums(const vector<int>& nn, unsigned int nthreads = 0);
+
+    /// print summary of header and index to stdout
+    void display() const;
+
+protected:
+    MappedFile mf;      ///< mapped input file
+    lineReader lr;      ///< header line reader
+public:
+    MCTAL_Header hdr;   ///< file header
+protected:
+    vector<charspan> blocks;    ///< text of each tally, from "tally" line to next
+    vector<int> nums;           ///< tally ID numbers, in file order
+    vector<std::unique_ptr<MCTAL_Tally>> tallies;   ///< parsed tallies (nullptr until loaded)
+    std::unique_ptr<std::once_flag[]> parsed;       ///< per-tally parse-once flags
+};
+
+#endif
@@ -36,7 +36,7 @@ void MCTAL_Tally::load(lineReader& i) {
     }
 
     // The FC card lines, if any, each starting with 5 blanks}
-    while(i.lineSrc.peek() == ' ') i.next();
+    while(i.peekLine() == ' ') i.next();
 
     Fbins.load(i);
     Dbins.load("D", i);
@@ -50,10 +50,9 @@ void MCTAL_Tally::load(lineReader& i) {
     Ebins.load("E", i);
     Tbins.load("T", i);
 
-    i.next();
-    i.lstr = upper(i.lstr);
-    if(!(i.lstr == "VALS" || i.lstr == "VALS_PERT"))
-        throw std::runtime_error("Expected 'VALS [PERT]', got '" + i.lstr + "'");
+    auto vals = upper(i.next().line().str());
+    if(!(vals == "VALS" || vals == "VALS_PERT"))
+        throw std::runtime_error("Expected 'VALS [PERT]', got '" + vals + "'");
 
     int nentries = 1;
     for(auto a = AXIS_T; a < AXIS_END; ++a) {
@@ -69,13 +68,13 @@ void MCTAL_Tally::load(lineReader& i) {
     while(nentries--) {
         i.checkEnd();
         valerr_t v;
-        i >> v.val >> v.rel_err;
+        i.scan(v.val).scan(v.rel_err);
         push_back(v);
     }
 
     tfc.load(i);
 
-    if(toupper(i.lineSrc.peek()) == 'K') kcyc.load(i);
+    if(toupper(i.peekLine()) == 'K') kcyc.load(i);
 }
 
 string MCTAL_Tally::ptype_name(ptype_t p) {
@@ -1,6 +1,7 @@
 /// \file MCTAL_toROOT.cc
 
 #include "MCTAL_toROOT.hh"
+#include "to_str.hh"
 
 TH1D* tallyH1(const string& name, const string& title,
               const MCTAL_Tally& t, tallyax_id_t a, size_t i0) {
@@ -50,3 +51,17 @@ TH2D* tallyH2(const string& name, const string& title,
     return h;
 }
 
+
+vector<TH1*> talliesToROOT(MCTAL_Index& I, const vector<int>& nums, unsigned int nthreads) {
+    I.loadNums(nums, nthreads);
+
+    vector<TH1*> v;
+    for(auto n: nums) {
+        auto& t = I.tally(n);
+        auto name = "tally_" + to_str(n);
+        auto title = string("F") + to_str(t.tally) + " " + MCTAL_Tally::tally_name(t.tally) + " tally " + to_str(n);
+        if(t.axes.size() >= 2) v.push_back(tallyH2(name, title, t));
+        else v.push_back(tallyH1(name, title, t));
+    }
+    return v;
+}
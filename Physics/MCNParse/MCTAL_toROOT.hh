@@ -6,7 +6,7 @@
 
 #include <TH1D.h>
 #include <TH2D.h>
-#include "MCTAL_Tally.hh"
+#include "MCTAL_Index.hh"
 
 /// extract TH1D from tally
 TH1D* tallyH1(const string& name, const string& title,
@@ -17,4 +17,20 @@ TH2D* tallyH2(const string& name, const string& title,
               const MCTAL_Tally& t, tallyax_id_t a1 = AXIS_END,
               tallyax_id_t a2 = AXIS_END, size_t i0 = 0);
 
+/// extract TH1D from tally ID number in indexed file, parsing only that tally
+inline TH1D* tallyH1(const string& name, const string& title,
+                     MCTAL_Index& I, int num, tallyax_id_t a = AXIS_END, size_t i0 = 0) {
+    return tallyH1(name, title, I.tally(num), a, i0);
+}
+
+/// extract TH2D from tally ID number in indexed file, parsing only that tally
+inline TH2D* tallyH2(const string& name, const string& title,
+                     MCTAL_Index& I, int num, tallyax_id_t a1 = AXIS_END,
+                     tallyax_id_t a2 = AXIS_END, size_t i0 = 0) {
+    return tallyH2(name, title, I.tally(num), a1, a2, i0);
+}
+
+/// convert requested tally ID numbers (parsed in parallel) to "tally_<num>" TH1D or TH2D, by number of (at least 1) active axes
+vector<TH1*> talliesToROOT(MCTAL_Index& I, const vector<int>& nums, unsigned int nthreads = 0);
+
 #endif
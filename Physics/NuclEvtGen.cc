@@ -2,15 +2,32 @@
 
 #include "NuclEvtGen.hh"
 #include "NuclPhysConstants.hh"
+#include "WorkStealingPool.hh"
+#include "MappedFile.hh"
+#include "Hash64.hh"
 using namespace physconst;
 
 #include <cmath>
 #include <stdlib.h>
 #include <stdexcept>
+#include <thread>
+#include <algorithm>
+#include <unistd.h>
 
 #include <TRandom.h>
 
 unsigned int PSelector::select(double* x) const {
+    if(!aliasValid) {
+        alias = makeAlias();
+        aliasValid = true;
+    }
+    if(!alias.size()) return select_search(x);
+    if(!x) return alias.select(gRandom->Uniform(0,1));
+    assert(0. <= *x && *x <= 1.);
+    return alias.select_rescale(*x);
+}
+
+unsigned int PSelector::select_search(double* x) const {
     static double rnd_tmp;
     if(!x) { x=&rnd_tmp; rnd_tmp=gRandom->Uniform(0,cumprob.back()); }
     else { assert(0. <= *x && *x <= 1.); (*x) *= cumprob.back(); }
@@ -22,6 +39,15 @@ unsigned int PSelector::select(double* x) const {
 
 double PSelector::getProb(unsigned int n) const { return (cumprob.at(n+1)-cumprob[n])/cumprob.back(); }
 
+AliasTable PSelector::makeAlias() const {
+    AliasTable A;
+    if(!(cumprob.back() > 0)) return A;
+    vector<double> w(getN());
+    for(size_t i = 0; i < w.size(); i++) w[i] = cumprob[i+1] - cumprob[i];
+    A.build(w);
+    return A;
+}
+
 //-----------------------------------------
 
 string particleName(DecayType_t t) {
@@ -53,7 +79,48 @@ void randomDirection(double& x, double& y, double& z, double* rnd) {
 
 //-----------------------------------------
 
-NucLevel::NucLevel(const Stringmap& m): fluxIn(0), fluxOut(0) {
+void NucDecayBatch::clear() {
+    eid.clear(); d.clear(); E.clear();
+    px.clear(); py.clear(); pz.clear(); t.clear();
+}
+
+void NucDecayBatch::reserve(size_t n) {
+    eid.reserve(n); d.reserve(n); E.reserve(n);
+    px.reserve(n); py.reserve(n); pz.reserve(n); t.reserve(n);
+}
+
+void NucDecayBatch::append(const NucDecayBatch& B) {
+    eid.insert(eid.end(), B.eid.begin(), B.eid.end());
+    d.insert(d.end(), B.d.begin(), B.d.end());
+    E.insert(E.end(), B.E.begin(), B.E.end());
+    px.insert(px.end(), B.px.begin(), B.px.end());
+    py.insert(py.end(), B.py.begin(), B.py.end());
+    pz.insert(pz.end(), B.pz.begin(), B.pz.end());
+    t.insert(t.end(), B.t.begin(), B.t.end());
+}
+
+NucDecayEvent NucDecayBatch::get(size_t i) const {
+    NucDecayEvent evt;
+    evt.eid = eid.at(i);
+    evt.E = E[i];
+    evt.p[0] = px[i]; evt.p[1] = py[i]; evt.p[2] = pz[i];
+    evt.x[0] = evt.x[1] = evt.x[2] = 0;
+    evt.d = d[i];
+    evt.t = t[i];
+    return evt;
+}
+
+/// random direction for batch particle
+static void randomDirection(double* p, DecayUniforms& U) {
+    double rnd[2];
+    rnd[0] = U();
+    rnd[1] = U();
+    randomDirection(p[0], p[1], p[2], rnd);
+}
+
+//-----------------------------------------
+
+NucLevel::NucLevel(const FlatStringmap& m): fluxIn(0), fluxOut(0) {
     name = m.getDefault("nm","0.0.0");
     vector<string> v = split(name,".");
     if(v.size() != 3) throw std::runtime_error("invalid level specification");
@@ -79,10 +146,11 @@ DecayAtom::DecayAtom(BindingEnergyTable const* B): BET(B), Iauger(0), Ikxr(0), I
     else Eauger = 0;
 }
 
-void DecayAtom::load(const Stringmap& m) {
-    for(auto& kv: m) {
-        if(kv.first[0]=='a') Iauger += atof(kv.second.c_str())/100.0;
-        else if(kv.first[0]=='k') Ikxr += atof(kv.second.c_str())/100.0;
+void DecayAtom::load(const FlatStringmap& m) {
+    for(size_t i=0; i<m.size(); i++) {
+        auto& k = m.key(i);
+        if(k[0]=='a') Iauger += m.number(i)/100.0;
+        else if(k[0]=='k') Ikxr += m.number(i)/100.0;
     }
     Iauger = m.getDefault("Iauger",0) / 100.0;
 
@@ -91,7 +159,7 @@ void DecayAtom::load(const Stringmap& m) {
     if(!Iauger) IMissing = pAuger = 0;
 }
 
-void DecayAtom::genAuger(vector<NucDecayEvent>& v) {
+void DecayAtom::genAuger(NucDecayEvents& v) {
     if(gRandom->Uniform(0,1) > pAuger) return;
     NucDecayEvent evt;
     evt.d = D_ELECTRON;
@@ -100,6 +168,13 @@ void DecayAtom::genAuger(vector<NucDecayEvent>& v) {
     v.push_back(evt);
 }
 
+void DecayAtom::genAuger(NucDecayBatch& B, size_t i, DecayUniforms& U) const {
+    if(U() > pAuger) return;
+    double p[3];
+    randomDirection(p, U);
+    B.push(i, D_ELECTRON, Eauger, p);
+}
+
 void DecayAtom::display(bool) const {
     if(BET) printf("%s %u: pAuger = %.3f, Eauger = %.2f keV, initCapt = %.3f\n",
         BET->getName().c_str(), BET->getZ(), pAuger, 1e3*Eauger, IMissing);
@@ -114,7 +189,7 @@ void TransitionBase::display(bool) const {
 
 //-----------------------------------------
 
-ConversionGamma::ConversionGamma(NucLevel& f, NucLevel& t, const Stringmap& m): TransitionBase(f,t) {
+ConversionGamma::ConversionGamma(NucLevel& f, NucLevel& t, const FlatStringmap& m): TransitionBase(f,t) {
     Egamma = from.E - to.E;
     Igamma = m.getDefault("Igamma",0.0)/100.0;
 
@@ -138,9 +213,12 @@ ConversionGamma::ConversionGamma(NucLevel& f, NucLevel& t, const Stringmap& m):
     shells.addProb(1.);
     shells.scale(Igamma);
     Itotal = shells.getCumProb();
+
+    aShells = shells.makeAlias();
+    for(auto& ss: subshells) aSubshells.push_back(ss.makeAlias());
 }
 
-void ConversionGamma::run(vector<NucDecayEvent>& v, double* rnd) {
+void ConversionGamma::run(NucDecayEvents& v, double* rnd) {
     shell = (int)shells.select(rnd);
     if(shell < (int)subshells.size()) subshell = (int)subshells[shell].select(rnd);
     else shell = subshell = -1;
@@ -155,6 +233,21 @@ void ConversionGamma::run(vector<NucDecayEvent>& v, double* rnd) {
     v.push_back(evt);
 }
 
+unsigned int ConversionGamma::run(NucDecayBatch& B, size_t i, DecayUniforms& U) const {
+    int sh = aShells.size()? (int)aShells.select(U()) : (int)subshells.size();
+    double E = Egamma;
+    DecayType_t d = D_GAMMA;
+    if(sh < (int)subshells.size()) {
+        int ssh = (int)aSubshells[sh].select(U());
+        d = D_ELECTRON;
+        if(toAtom->BET) E -= 1e-3 * toAtom->BET->getSubshellBinding(sh,ssh);
+    }
+    double p[3];
+    randomDirection(p, U);
+    B.push(i, d, E, p);
+    return sh == 0;
+}
+
 void ConversionGamma::display(bool verbose) const {
     double ceff = 100.*getConversionEffic();
     printf("Gamma %.4f MeV (%.3g%%)", Egamma, (100.-ceff)*Itotal);
@@ -222,7 +315,7 @@ void ConversionGamma::scale(double s) {
 
 //-----------------------------------------
 
-AlphaDecayTrans::AlphaDecayTrans(NucLevel& f, NucLevel& t, const Stringmap& m): TransitionBase(f,t) {
+AlphaDecayTrans::AlphaDecayTrans(NucLevel& f, NucLevel& t, const FlatStringmap& m): TransitionBase(f,t) {
     Itotal = m.getDefault("I", 0)/100.;
 
     // relativistic calculation of alpha kinetic energy including nucleus recoil
@@ -238,7 +331,7 @@ void AlphaDecayTrans::display(bool verbose) const {
     TransitionBase::display(verbose);
 }
 
-void AlphaDecayTrans::run(vector<NucDecayEvent>& v, double* rnd) {
+void AlphaDecayTrans::run(NucDecayEvents& v, double* rnd) {
     NucDecayEvent evt;
     evt.d = D_ALPHA;
     evt.randp(rnd);
@@ -246,37 +339,47 @@ void AlphaDecayTrans::run(vector<NucDecayEvent>& v, double* rnd) {
     v.push_back(evt);
 }
 
+unsigned int AlphaDecayTrans::run(NucDecayBatch& B, size_t i, DecayUniforms& U) const {
+    double p[3];
+    randomDirection(p, U);
+    B.push(i, D_ALPHA, Ealpha, p);
+    return 0;
+}
+
 //-----------------------------------------
 
 BetaDecayTrans::BetaDecayTrans(NucLevel& f, NucLevel& t, unsigned int forbidden):
-TransitionBase(f,t), positron(f.Z > t.Z), BSG(to.A,int(to.Z)*(positron? -1 : 1), from.E-to.E - (positron? 2*m_e : 0)),
-betaTF1((f.name+"-"+t.name+"_Beta").c_str(), this, &BetaDecayTrans::evalBeta, 0, 1, 0) {
+TransitionBase(f,t), positron(f.Z > t.Z), BSG(to.A,int(to.Z)*(positron? -1 : 1), from.E-to.E - (positron? 2*m_e : 0)) {
     BSG.forbidden = forbidden;
-    betaTF1.SetNpx(1000);
-    betaTF1.SetRange(0, BSG.EP);
     if(from.jpi == to.jpi) { BSG.M2_F = 1; BSG.M2_GT = 0; }
     else { BSG.M2_GT = 1; BSG.M2_F = 0; } // TODO not strictly true; need more general mechanism to fix
 
-    betaQuantiles = new TF1_Quantiles(betaTF1);
+    initSpectrum();
 }
 
 void BetaDecayTrans::display(bool verbose) const {
-    printf("Beta%s(%.4f MeV, %.4f MeV) ", positron?"+":"-", BSG.EP, betaQuantiles->getAvg());
+    printf("Beta%s(%.4f MeV, %.4f MeV) ", positron?"+":"-", BSG.EP, spectrum->getAvg());
     TransitionBase::display(verbose);
 }
 
-void BetaDecayTrans::run(vector<NucDecayEvent>& v, double* rnd) {
+void BetaDecayTrans::run(NucDecayEvents& v, double* rnd) {
     NucDecayEvent evt;
     evt.d = positron?D_POSITRON:D_ELECTRON;
     evt.randp(rnd);
-    if(rnd) evt.E = betaQuantiles->eval(rnd[2]);
-    else evt.E = betaTF1.GetRandom();
+    evt.E = spectrum->sample(rnd? rnd[2] : gRandom->Uniform(0,1));
     v.push_back(evt);
 }
 
+unsigned int BetaDecayTrans::run(NucDecayBatch& B, size_t i, DecayUniforms& U) const {
+    double p[3];
+    randomDirection(p, U);
+    B.push(i, positron? D_POSITRON : D_ELECTRON, spectrum->sample(U()), p);
+    return 0;
+}
+
 //-----------------------------------------
 
-void ECapture::run(vector<NucDecayEvent>&, double*) {
+void ECapture::run(NucDecayEvents&, double*) {
     isKCapt = gRandom->Uniform(0,1) < toAtom->IMissing;
 }
 
@@ -287,7 +390,7 @@ NucDecaySystem::NucDecaySystem(const SMFile& Q, const BindingEnergyLibrary& B, d
     fancyname = Q.getDefault("fileinfo","fancyname","");
 
     // load levels data
-    for(auto& l: Q.retrieve("level")) {
+    for(auto& l: Q.retrieveFlat("level")) {
         levels.push_back(NucLevel(l));
         transIn.push_back(vector<TransitionBase*>());
         transOut.push_back(vector<TransitionBase*>());
@@ -302,7 +405,7 @@ NucDecaySystem::NucDecaySystem(const SMFile& Q, const BindingEnergyLibrary& B, d
     }
 
     // set up internal conversions
-    for(auto& g: Q.retrieve("gamma"))
+    for(auto& g: Q.retrieveFlat("gamma"))
         addTransition(new ConversionGamma(levels[levIndex(g.getDefault("from",""))],
                                           levels[levIndex(g.getDefault("to",""))],g));
 
@@ -315,19 +418,19 @@ NucDecaySystem::NucDecaySystem(const SMFile& Q, const BindingEnergyLibrary& B, d
 
     // set up Augers
     for(auto& tr: transitions) tr->toAtom->ICEK += tr->getPVacant(0)*tr->Itotal;
-    for(auto& a: Q.retrieve("AugerK")) {
+    for(auto& a: Q.retrieveFlat("AugerK")) {
         int Z = a.getDefault("Z",0);
         if(!Z) throw std::runtime_error("Bad Auger Z");
         getAtom(Z)->load(a);
     }
 
     // set up alpha decays
-    for(auto& al: Q.retrieve("alpha"))
+    for(auto& al: Q.retrieveFlat("alpha"))
         addTransition(new AlphaDecayTrans(levels[levIndex(al.getDefault("from",""))],
                                           levels[levIndex(al.getDefault("to",""))], al));
 
     // set up beta decays
-    for(auto& bt: Q.retrieve("beta")) {
+    for(auto& bt: Q.retrieveFlat("beta")) {
         auto BD = new BetaDecayTrans(levels[levIndex(bt.getDefault("from",""))],
                                      levels[levIndex(bt.getDefault("to",""))],
                                      bt.getDefault("forbidden",0));
@@ -335,12 +438,13 @@ NucDecaySystem::NucDecaySystem(const SMFile& Q, const BindingEnergyLibrary& B, d
         if(bt.count("M2_F") || bt.count("M2_GT")) {
             BD->BSG.M2_F = bt.getDefault("M2_F",0);
             BD->BSG.M2_GT = bt.getDefault("M2_GT",0);
+            BD->initSpectrum();
         }
         addTransition(BD);
     }
 
     // set up electron captures
-    for(auto& ec: Q.retrieve("ecapt")) {
+    for(auto& ec: Q.retrieveFlat("ecapt")) {
         NucLevel& Lorig = levels[levIndex(ec.getDefault("from",""))];
         string to = ec.getDefault("to","AUTO");
         if(to == "AUTO") {
@@ -411,6 +515,10 @@ void NucDecaySystem::setCutoff(double t) {
             for(auto tr: transIn[n]) pStart += tr->Itotal;
         lStart.addProb(pStart);
     }
+
+    aStart = lStart.makeAlias();
+    aLevelDecays.clear();
+    for(auto& ld: levelDecays) aLevelDecays.push_back(ld.makeAlias());
 }
 
 void NucDecaySystem::display(bool verbose) const {
@@ -449,7 +557,7 @@ unsigned int NucDecaySystem::levIndex(const std::string& s) const {
     return n->second;
 }
 
-void NucDecaySystem::genDecayChain(vector<NucDecayEvent>& v, double* rnd, unsigned int n, double t0) {
+void NucDecaySystem::genDecayChain(NucDecayEvents& v, double* rnd, unsigned int n, double t0) {
     bool init = n >= levels.size();
     if(init) n = lStart.select(rnd);
     if(!levels[n].fluxOut || (!init && levels[n].hl > tcut)) return;
@@ -469,6 +577,79 @@ void NucDecaySystem::genDecayChain(vector<NucDecayEvent>& v, double* rnd, unsign
     genDecayChain(v, rnd, T->to.n, t0);
 }
 
+void NucDecaySystem::genDecayChain(vector<NucDecayEvent>& v, double* rnd, unsigned int n, double t0) {
+    scratch.reset();
+    NucDecayEvents ev(&scratch);
+    genDecayChain(ev, rnd, n, t0);
+    v.insert(v.end(), ev.begin(), ev.end());
+}
+
+void NucDecaySystem::genDecayChain(NucDecayBatch& B, size_t i, DecayUniforms& U) const {
+    unsigned int n = aStart.select(U());
+    bool init = true;
+    double t0 = 0;
+    while(levels[n].fluxOut && (init || levels[n].hl <= tcut) && aLevelDecays[n].size()) {
+        size_t n_prev_evt = B.size();
+
+        const TransitionBase* T = transOut[n][aLevelDecays[n].select(U())];
+        unsigned int nAugerK = T->run(B, i, U);
+        while(nAugerK--) T->toAtom->genAuger(B, i, U);
+
+        // determine and apply time delay for this decay stage
+        if(!init) t0 += -(levels[n].hl/log(2))*log(1.-U());
+        for(size_t j = n_prev_evt; j < B.size(); j++) B.t[j] += t0;
+
+        n = T->to.n;
+        init = false;
+    }
+}
+
+void NucDecaySystem::genDecays(NucDecayBatch& B, size_t n, uint64_t seed, size_t i0, unsigned int nthreads) const {
+    const size_t nchunk = 4096;     // decays per work unit
+    const size_t nu = 16;           // bulk-drawn uniforms per decay (covers typical chains)
+
+    // generate decays [c0, c0 + m) into C
+    auto genChunk = [&](NucDecayBatch& C, size_t c0, size_t m) {
+        vector<uint64_t> keys(m);
+        vector<double> u(m*nu);
+        for(size_t j = 0; j < m; j++) keys[j] = CounterRNG::streamKey(seed, c0 + j);
+        for(size_t k = 0; k < nu; k++)
+            for(size_t j = 0; j < m; j++) u[j*nu + k] = CounterRNG::to_uniform(CounterRNG::draw(keys[j], k));
+        for(size_t j = 0; j < m; j++) {
+            DecayUniforms U(&u[j*nu], nu, keys[j]);
+            genDecayChain(C, c0 + j, U);
+        }
+    };
+
+    const size_t nchunks = (n + nchunk - 1)/nchunk;
+    if(!nthreads) nthreads = std::thread::hardware_concurrency();
+    if(nthreads <= 1 || nchunks <= 1) {
+        for(size_t c = 0; c < nchunks; c++) genChunk(B, i0 + c*nchunk, std::min(nchunk, n - c*nchunk));
+        return;
+    }
+
+    vector<NucDecayBatch> chunks(nchunks);
+    {
+        WorkStealingPool P(std::min(size_t(nthreads), nchunks));
+        for(size_t c = 0; c < nchunks; c++)
+            P.submit([&, c]() { genChunk(chunks[c], i0 + c*nchunk, std::min(nchunk, n - c*nchunk)); });
+        P.wait_idle();
+    }
+    size_t np = B.size();
+    for(auto& C: chunks) np += C.size();
+    B.reserve(np);
+    for(auto& C: chunks) B.append(C);
+}
+
+vector<std::shared_ptr<const BetaSpectrumTable>> NucDecaySystem::getSpectra() const {
+    vector<std::shared_ptr<const BetaSpectrumTable>> v;
+    for(auto T: transitions) {
+        auto BD = dynamic_cast<const BetaDecayTrans*>(T);
+        if(BD && std::find(v.begin(), v.end(), BD->getSpectrum()) == v.end()) v.push_back(BD->getSpectrum());
+    }
+    return v;
+}
+
 unsigned int NucDecaySystem::getNDF(unsigned int n) const {
     static map<unsigned int, unsigned int> ndf_cache;
     auto it = ndf_cache.find(n);
@@ -521,7 +702,7 @@ void NucDecaySystem::normalizeFluxInOut() {
 //-----------------------------------------
 
 NucDecayLibrary::NucDecayLibrary(const std::string& datp, double t):
-datpath(datp), tcut(t), BEL(SMFile(datpath+"/ElectronBindingEnergy.txt")) { }
+datpath(datp), tcut(t), BEL(BindingEnergyLibrary::load(datpath+"/ElectronBindingEnergy.txt")) { }
 
 NucDecayLibrary::~NucDecayLibrary() {
     for(auto& kv: NDs) delete kv.second;
@@ -532,7 +713,88 @@ NucDecaySystem& NucDecayLibrary::getGenerator(const std::string& gennm) {
     if(it != NDs.end()) return *(it->second);
     string fname = datpath+"/"+gennm+".txt";
     //if(!fileExists(fname)) throw std::runtime_error("Missing decay data " + fname);
-    return *(NDs.emplace(gennm, new NucDecaySystem(SMFile(fname),BEL,tcut)).first->second);
+    if(!useCache) return *(NDs.emplace(gennm, new NucDecaySystem(SMFile(fname),*BEL,tcut)).first->second);
+
+    // preparsed data and spectrum tables from cache, if matching source file contents
+    uint64_t h;
+    {
+        MappedFile F(fname);
+        h = _hash64(F.data(), F.size());
+    }
+    SMFile Q;
+    const bool cached = readCache(fname, h, Q);
+    if(!cached) Q = SMFile(fname);
+    auto S = new NucDecaySystem(Q,*BEL,tcut);
+    NDs.emplace(gennm, S);
+    if(!cached) {
+        try { writeCache(fname, h, Q, *S); }
+        catch(std::runtime_error&) { } // e.g. read-only data directory
+    }
+    return *S;
+}
+
+/// decay data cache file format identifier
+static const string ndcache_magic = "MPMUtils NucDecaySystem cache v2";
+
+bool NucDecayLibrary::readCache(const string& fname, uint64_t h, SMFile& Q) const {
+    MappedFile F;
+    try { F.open(fname + ".bin"); }
+    catch(std::runtime_error&) { return false; }
+
+    MemBReader R(F.data(), F.size());
+    try {
+        R.receiveWireHeader();
+        if(R.receive<string>() != ndcache_magic || R.receive<uint64_t>() != h) return false;
+        SMFile QQ;
+        auto n = R.receive<uint64_t>();
+        while(n--) {
+            auto k = R.receive<string>();
+            Stringmap m;
+            auto nm = R.receive<uint64_t>();
+            while(nm--) {
+                auto mk = R.receive<string>();
+                m.emplace(mk, R.receive<string>());
+            }
+            QQ.emplace(k, m);
+        }
+        vector<std::shared_ptr<const BetaSpectrumTable>> v(R.receive<uint64_t>());
+        for(auto& T: v) T = BetaSpectrumTable::read(R);
+        for(auto& T: v) BetaSpectrumTable::share(T);
+        Q = QQ;
+    } catch(...) { return false; } // truncated (MemBReader throws int -1) or invalid contents
+    return true;
+}
+
+void NucDecayLibrary::writeCache(const string& fname, uint64_t h, const SMFile& Q, const NucDecaySystem& S) const {
+    BinarySerializer W;
+    W.sendWireHeader();
+    W.send(ndcache_magic);
+    W.send<uint64_t>(h);
+    W.send<uint64_t>(Q.size());
+    for(auto& kv: Q) {
+        W.send(kv.first);
+        W.send<uint64_t>(kv.second.size());
+        for(auto& kv2: kv.second) {
+            W.send(kv2.first);
+            W.send(kv2.second);
+        }
+    }
+    auto v = S.getSpectra();
+    W.send<uint64_t>(v.size());
+    for(auto& T: v) T->write(W);
+
+    // write to (per-process) temporary, then move into place
+    auto& b = W.buf();
+    auto fout = fname + ".bin";
+    auto ftmp = fout + "_tmp" + to_str(getpid());
+    auto f = fopen(ftmp.c_str(), "wb");
+    if(!f) throw std::runtime_error("Failed to open '" + ftmp + "' for writing");
+    bool ok = fwrite(b.data(), 1, b.size(), f) == b.size();
+    ok = !fclose(f) && ok;
+    if(!ok || rename(ftmp.c_str(), fout.c_str())) {
+        remove(ftmp.c_str());
+        throw std::runtime_error("Failed to write '" + fout + "'");
+    }
 }
 
 bool NucDecayLibrary::hasGenerator(const std::string& gennm) {
@@ -568,7 +830,8 @@ GammaForest::GammaForest(const std::string& fname, double E2MeV) {
            gammaE.size(), gammaProb.getCumProb());
 }
 
-void GammaForest::genDecays(vector<NucDecayEvent>& v, double n) {
+template<class V>
+void GammaForest::_genDecays(V& v, double n) {
     while(n >= 1. || gRandom->Uniform(0,1) < n) {
         NucDecayEvent evt;
         evt.d = D_GAMMA;
@@ -578,3 +841,7 @@ void GammaForest::genDecays(vector<NucDecayEvent>& v, double n) {
         --n;
     }
 }
+
+void GammaForest::genDecays(NucDecayEvents& v, double n) { _genDecays(v, n); }
+
+void GammaForest::genDecays(vector<NucDecayEvent>& v, double n) { _genDecays(v, n); }
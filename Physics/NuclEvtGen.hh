@@ -5,9 +5,11 @@
 #define NUCLEVTGEN_HH
 
 #include "ElectronBindingEnergy.hh"
-#include "BetaSpectrumGenerator.hh"
-#include "TF1_Quantiles.hh"
+#include "BetaSpectrumTable.hh"
 #include "FloatErr.hh"
+#include "MonotonicArena.hh"
+#include "AliasTable.hh"
+#include "CounterRNG.hh"
 
 #include <set>
 using std::set;
@@ -20,9 +22,12 @@ public:
     /// constructor
     PSelector() { cumprob.push_back(0); }
     /// add a probability
-    void addProb(double p) { cumprob.push_back(p+cumprob.back()); }
+    void addProb(double p) { cumprob.push_back(p+cumprob.back()); aliasValid = false; }
     /// select partition for given input (random if not specified); re-scale input to partition range to pass along to sub-selections
+    /// constant-time, by alias table built on first use (not thread-safe until built)
     unsigned int select(double* x = nullptr) const;
+    /// select as above, by binary search of cumulative probabilities (partitioning input in item order)
+    unsigned int select_search(double* x = nullptr) const;
     /// get cumulative probability
     double getCumProb() const { return cumprob.back(); }
     /// get number of items
@@ -30,10 +35,14 @@ public:
     /// get probability of numbered item
     double getProb(unsigned int n) const;
     /// scale all probabilities
-    void scale(double s) { for(auto& p: cumprob) p *= s; }
+    void scale(double s) { for(auto& p: cumprob) p *= s; aliasValid = false; }
+    /// constant-time alias table for same probabilities (empty if no positive probabilities)
+    AliasTable makeAlias() const;
 
 protected:
-    vector<double> cumprob; ///< cumulative probabilites
+    vector<double> cumprob;         ///< cumulative probabilites
+    mutable AliasTable alias;       ///< alias table for select(), built on demand
+    mutable bool aliasValid = false;///< whether alias is up-to-date
 };
 
 /// generate an isotropic random direction, from optional random in [0,1]^2
@@ -43,7 +52,7 @@ void randomDirection(double& x, double& y, double& z, double* rnd = nullptr);
 class NucLevel {
 public:
     /// constructor
-    explicit NucLevel(const Stringmap& m);
+    explicit NucLevel(const FlatStringmap& m);
     /// print info
     void display(bool verbose = false) const;
     /// scale probabilities
@@ -94,15 +103,62 @@ struct NucDecayEvent {
     double w = 1;               ///< weighting for event
 };
 
+/// list of decay particles, optionally allocated from per-event MonotonicArena
+typedef arena_vector<NucDecayEvent> NucDecayEvents;
+
+/// Structure-of-arrays buffer of decay particles, for batch generation
+struct NucDecayBatch {
+    /// number of particles
+    size_t size() const { return eid.size(); }
+    /// clear contents (keeping allocated capacity)
+    void clear();
+    /// reserve space for n particles
+    void reserve(size_t n);
+    /// append particle
+    void push(size_t i, DecayType_t dtype, double e, const double* pp) {
+        eid.push_back(i); d.push_back(dtype); E.push_back(e);
+        px.push_back(pp[0]); py.push_back(pp[1]); pz.push_back(pp[2]);
+        t.push_back(0);
+    }
+    /// append contents of another batch
+    void append(const NucDecayBatch& B);
+    /// particle i as NucDecayEvent
+    NucDecayEvent get(size_t i) const;
+
+    vector<size_t> eid;         ///< decay number producing each particle
+    vector<DecayType_t> d;      ///< particle type
+    vector<double> E;           ///< particle energy [MeV]
+    vector<double> px;          ///< momentum direction x
+    vector<double> py;          ///< momentum direction y
+    vector<double> pz;          ///< momentum direction z
+    vector<double> t;           ///< time of event [s]
+};
+
+/// Uniform random numbers for one decay in batch generation: bulk pre-drawn block, continued from the decay's own CounterRNG stream
+class DecayUniforms {
+public:
+    /// Constructor, with n bulk-drawn uniforms u (stream draws 0...n-1) and stream key
+    DecayUniforms(const double* _u, size_t _n, uint64_t k): u(_u), n(_n), key(k) { }
+    /// next uniform [0,1)
+    double operator()() { return i < n? u[i++] : CounterRNG::to_uniform(CounterRNG::draw(key, i++)); }
+protected:
+    const double* u;    ///< bulk-drawn uniforms
+    const size_t n;     ///< number of bulk-drawn uniforms
+    const uint64_t key; ///< stream key
+    size_t i = 0;       ///< next draw number
+};
+
 /// Atom/electron information
 class DecayAtom {
 public:
     /// constructor
     explicit DecayAtom(BindingEnergyTable const* B);
-    /// load Auger data from Stringmap
-    void load(const Stringmap& m);
+    /// load Auger data
+    void load(const FlatStringmap& m);
     /// generate Auger K probabilistically
-    void genAuger(vector<NucDecayEvent>& v);
+    void genAuger(NucDecayEvents& v);
+    /// generate Auger K probabilistically for decay i in batch
+    void genAuger(NucDecayBatch& B, size_t i, DecayUniforms& U) const;
     /// display info
     void display(bool verbose = false) const;
 
@@ -126,7 +182,9 @@ public:
     virtual void display(bool verbose = false) const;
 
     /// select transition outcome
-    virtual void run(vector<NucDecayEvent>&, double* = nullptr) { }
+    virtual void run(NucDecayEvents&, double* = nullptr) { }
+    /// thread-safe transition outcome for decay i in batch; return number of K-shell vacancies
+    virtual unsigned int run(NucDecayBatch&, size_t, DecayUniforms&) const { return 0; }
 
     /// return number of continuous degrees of freedom needed to specify transition
     virtual unsigned int getNDF() const { return 2; }
@@ -150,9 +208,11 @@ public:
 class ConversionGamma: public TransitionBase {
 public:
     /// constructor
-    ConversionGamma(NucLevel& f, NucLevel& t, const Stringmap& m);
+    ConversionGamma(NucLevel& f, NucLevel& t, const FlatStringmap& m);
     /// select transition outcome
-    void run(vector<NucDecayEvent>& v, double* rnd = nullptr) override;
+    void run(NucDecayEvents& v, double* rnd = nullptr) override;
+    /// thread-safe transition outcome for decay i in batch; return number of K-shell vacancies
+    unsigned int run(NucDecayBatch& B, size_t i, DecayUniforms& U) const override;
     /// display transition line info
     void display(bool verbose = false) const override;
     /// get total conversion efficiency
@@ -177,6 +237,8 @@ protected:
     PSelector shells;           ///< conversion electron shells
     vector<float> shellUncert;  ///< uncertainty on shell selection probability
     vector<PSelector> subshells;///< subshell choices for each shell
+    AliasTable aShells;         ///< alias table for shells
+    vector<AliasTable> aSubshells;  ///< alias tables for subshells
 };
 
 /// electron capture transitions
@@ -188,7 +250,9 @@ public:
             throw std::runtime_error("Invalid ECapture transition");
     }
     /// select transition outcome
-    void run(vector<NucDecayEvent>&, double* rnd = nullptr) override;
+    void run(NucDecayEvents&, double* rnd = nullptr) override;
+    /// thread-safe transition outcome for decay i in batch; return number of K-shell vacancies
+    unsigned int run(NucDecayBatch&, size_t, DecayUniforms& U) const override { return U() < toAtom->IMissing; }
     /// display transition line info
     void display(bool verbose = false) const override { printf("Ecapture "); TransitionBase::display(verbose); }
     /// get probability of removing an electron from a given shell
@@ -206,9 +270,11 @@ public:
 class AlphaDecayTrans: public TransitionBase {
 public:
     /// constructor
-    AlphaDecayTrans(NucLevel& f, NucLevel& t, const Stringmap& m);
+    AlphaDecayTrans(NucLevel& f, NucLevel& t, const FlatStringmap& m);
     /// select transition outcome
-    void run(vector<NucDecayEvent>&, double* rnd = nullptr) override;
+    void run(NucDecayEvents&, double* rnd = nullptr) override;
+    /// thread-safe transition outcome for decay i in batch; return number of K-shell vacancies
+    unsigned int run(NucDecayBatch& B, size_t i, DecayUniforms& U) const override;
     /// display transition line info
     void display(bool verbose = false) const override;
     /// return number of continuous degrees of freedom needed to specify transition
@@ -222,11 +288,15 @@ class BetaDecayTrans: public TransitionBase {
 public:
     /// constructor
     BetaDecayTrans(NucLevel& f, NucLevel& t, unsigned int forbidden = 0);
-    /// destructor
-    ~BetaDecayTrans() {  delete betaQuantiles; }
+    /// (re)build spectrum sampling table, after changing BSG parameters
+    void initSpectrum() { spectrum = BetaSpectrumTable::get(BSG); }
+    /// get spectrum sampling table
+    const std::shared_ptr<const BetaSpectrumTable>& getSpectrum() const { return spectrum; }
 
     /// select transition outcome
-    void run(vector<NucDecayEvent>& v, double* rnd = nullptr) override;
+    void run(NucDecayEvents& v, double* rnd = nullptr) override;
+    /// thread-safe transition outcome for decay i in batch; return number of K-shell vacancies
+    unsigned int run(NucDecayBatch& B, size_t i, DecayUniforms& U) const override;
     /// display transition line info
     void display(bool verbose = false) const override;
 
@@ -237,11 +307,7 @@ public:
     BetaSpectrumGenerator BSG;          ///< spectrum shape generator
 
 protected:
-    /// evaluate beta spectrum probability as function of KE [MeV]
-    double evalBeta(double* x, double*) { return BSG.decayProb(*x); }
-
-    TF1 betaTF1;                        ///< TF1 for beta spectrum shape
-    TF1_Quantiles* betaQuantiles;       ///< inverse CDF of beta spectrum shape for random point selection
+    std::shared_ptr<const BetaSpectrumTable> spectrum;  ///< spectrum inverse CDF sampling table, shared by identical spectra
 };
 
 /// Decay system
@@ -264,13 +330,22 @@ public:
     /// display list of atoms
     void displayAtoms(bool verbose = false) const;
     /// generate a chain of decay events starting from level n, starting time offset t0
+    void genDecayChain(NucDecayEvents& v, double* rnd = nullptr,
+                       unsigned int n = std::numeric_limits<unsigned int>::max(), double t0 = 0);
+    /// generate a chain of decay events, appended to heap-allocated vector (through internal scratch arena)
     void genDecayChain(vector<NucDecayEvent>& v, double* rnd = nullptr,
                        unsigned int n = std::numeric_limits<unsigned int>::max(), double t0 = 0);
+    /// thread-safe generation of decay chain number i (from starting level), appended to batch
+    void genDecayChain(NucDecayBatch& B, size_t i, DecayUniforms& U) const;
+    /// generate decays i0...i0+n-1 from seed, appended to batch; reproducible independent of nthreads (0 for all cores)
+    void genDecays(NucDecayBatch& B, size_t n, uint64_t seed, size_t i0 = 0, unsigned int nthreads = 0) const;
     /// rescale all probabilities
     void scale(double s);
 
     /// return number of degrees of freedom needed to specify decay from given level
     unsigned int getNDF(unsigned int n = std::numeric_limits<unsigned int>::max()) const;
+    /// beta spectrum tables used by transitions
+    vector<std::shared_ptr<const BetaSpectrumTable>> getSpectra() const;
 
     /// LaTeX name for generator
     string fancyname;
@@ -295,10 +370,13 @@ protected:
     map<string,unsigned int> levelIndex;        ///< energy levels by name
     PSelector lStart;                           ///< selector for starting level (for breaking up long decays)
     vector<PSelector> levelDecays;              ///< probabilities for transitions from each level
+    AliasTable aStart;                          ///< alias table for starting level
+    vector<AliasTable> aLevelDecays;            ///< alias tables for transitions from each level
     map<unsigned int, DecayAtom*> atoms;        ///< atom information
     vector<TransitionBase*> transitions;        ///< transitions, enumerated
     vector< vector<TransitionBase*> > transIn;  ///< transitions into each level
     vector< vector<TransitionBase*> > transOut; ///< transitions out of each level
+    MonotonicArena scratch{1 << 12};            ///< per-call scratch for heap-vector genDecayChain
 };
 
 /// manager for loading decay event generators
@@ -315,9 +393,15 @@ public:
 
     string datpath;                     ///< path to data folder
     double tcut;                        ///< event generator default cutoff time
-    BindingEnergyLibrary  BEL;          ///< electron binding energy info
+    std::shared_ptr<const BindingEnergyLibrary> BEL;   ///< electron binding energy info
+    bool useCache = true;               ///< load and save preparsed binary cache <data file>.bin beside each decay data file
 
 protected:
+    /// load decay data Q from cache file for source file hash h, also sharing its beta spectra; return whether successful
+    bool readCache(const string& fname, uint64_t h, SMFile& Q) const;
+    /// write cache file for decay data Q and generator S from source with hash h
+    void writeCache(const string& fname, uint64_t h, const SMFile& Q, const NucDecaySystem& S) const;
+
     map<string,NucDecaySystem*> NDs;    ///< loaded decay systems
     set<string> cantdothis;             ///< list of decay systems that can't be loaded
 };
@@ -330,8 +414,14 @@ public:
     /// get total cross section
     double getCrossSection() const { return gammaProb.getCumProb(); }
     /// generate cluster of gamma decays
+    void genDecays(NucDecayEvents& v, double n = 1.0);
+    /// generate cluster of gamma decays into heap-allocated vector
     void genDecays(vector<NucDecayEvent>& v, double n = 1.0);
 protected:
+    /// generate cluster of gamma decays, into either vector type
+    template<class V>
+    void _genDecays(V& v, double n);
+
     vector<double> gammaE;      ///< gamma energies [MeV]
     PSelector gammaProb;        ///< gamma probabilities selector
 };
@@ -29,6 +29,75 @@ void Lorentz_boost::unboost(double& v0, double& v3) const {
     v3 =  beta*g*vv0 + g*v3;
 }
 
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && !defined(__AVX2__)
+#define RELKIN_DISPATCH ///< runtime-selected AVX2 kernels
+#endif
+
+/// kernel bodies, compiled into generic and instruction-set-targeted wrappers
+#define RELKIN_INLINE static inline __attribute__((always_inline))
+
+// v0' = v0 + (gm1*v0 - bg*v1) form keeps precision for gamma ~ 1
+
+RELKIN_INLINE void _boost_fixed(double gm1, double bg, double* __restrict__ v0, double* __restrict__ v1, size_t n) {
+    for(size_t i = 0; i < n; ++i) {
+        const double a = v0[i], b = v1[i];
+        v0[i] = a + (gm1*a - bg*b);
+        v1[i] = b + (gm1*b - bg*a);
+    }
+}
+
+RELKIN_INLINE void _boost_each(const double* __restrict__ gm1, const double* __restrict__ bg, double s,
+                               double* __restrict__ v0, double* __restrict__ v1, size_t n) {
+    for(size_t i = 0; i < n; ++i) {
+        const double a = v0[i], b = v1[i], g = gm1[i], c = s*bg[i];
+        v0[i] = a + (g*a - c*b);
+        v1[i] = b + (g*b - c*a);
+    }
+}
+
+#ifdef RELKIN_DISPATCH
+__attribute__((target("avx2,fma"))) static void boost_fixed_avx2(double gm1, double bg, double* v0, double* v1, size_t n) {
+    _boost_fixed(gm1, bg, v0, v1, n);
+}
+__attribute__((target("avx2,fma"))) static void boost_each_avx2(const double* gm1, const double* bg, double s, double* v0, double* v1, size_t n) {
+    _boost_each(gm1, bg, s, v0, v1, n);
+}
+/// whether AVX2/FMA is available
+static bool relkin_avx2() {
+    static const bool a = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return a;
+}
+/// dispatch kernel K to AVX2 if available
+#define RELKIN_CALL(K, ARGS) do { if(relkin_avx2()) K##_avx2 ARGS; else _##K ARGS; } while(0)
+#else
+#define RELKIN_CALL(K, ARGS) _##K ARGS
+#endif
+
+void Lorentz_boost::boost(double* v0, double* v1, size_t n) const {
+    RELKIN_CALL(boost_fixed, (gammaM1, beta*gamma(), v0, v1, n));
+}
+
+void Lorentz_boost::unboost(double* v0, double* v1, size_t n) const {
+    RELKIN_CALL(boost_fixed, (gammaM1, -beta*gamma(), v0, v1, n));
+}
+
+void Lorentz_boost_batch::setBeta(const double* beta, size_t n) {
+    gammaM1.resize(n);
+    bg.resize(n);
+    for(size_t i = 0; i < n; ++i) {
+        gammaM1[i] = beta_to_gammaM1(beta[i]);
+        bg[i] = beta[i]*(gammaM1[i] + 1);
+    }
+}
+
+void Lorentz_boost_batch::boost(double* v0, double* v1, size_t n, size_t i0) const {
+    RELKIN_CALL(boost_each, (gammaM1.data() + i0, bg.data() + i0, 1., v0, v1, n));
+}
+
+void Lorentz_boost_batch::unboost(double* v0, double* v1, size_t n, size_t i0) const {
+    RELKIN_CALL(boost_each, (gammaM1.data() + i0, bg.data() + i0, -1., v0, v1, n));
+}
+
 void Lorentz_boost::operator*=(const Lorentz_boost& b) {
     double gm1 = (gammaM1*b.gammaM1 + gammaM1 + b.gammaM1)*(1 + beta * b.beta) + beta * b.beta;
     beta = (beta + b.beta) * b.gamma() * gamma() / (gm1 + 1);
@@ -5,6 +5,8 @@
 #define RELKIN_HH
 
 #include <cmath>
+#include <stddef.h>
+#include <vector>
 
 // gamma = 1/sqrt(1 - beta^2)
 // E = KE + m = gamma * m; KE = (gamma - 1)*m
@@ -102,6 +104,11 @@ public:
     /// boost 4-vector (v0, v1, ?, ?) in (-1,0,0) direction
     void unboost(double& v0, double& v1) const;
 
+    /// boost n 4-vectors (v0[i], v1[i], ?, ?) in (1,0,0) direction; v0, v1 not overlapping
+    void boost(double* v0, double* v1, size_t n) const;
+    /// boost n 4-vectors (v0[i], v1[i], ?, ?) in (-1,0,0) direction; v0, v1 not overlapping
+    void unboost(double* v0, double* v1, size_t n) const;
+
     /// boosted momentum component given p_|| and total p^2
     double boost_p(double m, double px, double p2) const { double E = sqrt(p2+m*m); boost(E, px); return px; }
     /// boosted momentum component given p_|| and total p^2
@@ -122,6 +129,29 @@ protected:
     Lorentz_boost(double gm1, double b): gammaM1(gm1), beta(b) { }
 };
 
+/// Structure-of-arrays batch of (different) boosts, stored as precomputed gamma - 1, beta*gamma matrix coefficients
+class Lorentz_boost_batch {
+public:
+    /// number of boosts
+    size_t size() const { return gammaM1.size(); }
+    /// clear contents
+    void clear() { gammaM1.clear(); bg.clear(); }
+    /// add boost
+    void push_back(const Lorentz_boost& L) { gammaM1.push_back(L.gammaM1); bg.push_back(L.beta*L.gamma()); }
+    /// set from n velocities beta[i]
+    void setBeta(const double* beta, size_t n);
+    /// get boost i
+    Lorentz_boost operator[](size_t i) const { auto L = Lorentz_boost::from_gammaM1(gammaM1[i]); return bg[i] < 0? L.inverse() : L; }
+
+    /// apply boost i0 + i to 4-vector (v0[i], v1[i], ?, ?) in (1,0,0) direction, for i in [0,n); v0, v1 not overlapping
+    void boost(double* v0, double* v1, size_t n, size_t i0 = 0) const;
+    /// apply inverse of boost i0 + i to 4-vector (v0[i], v1[i], ?, ?), for i in [0,n); v0, v1 not overlapping
+    void unboost(double* v0, double* v1, size_t n, size_t i0 = 0) const;
+
+    std::vector<double> gammaM1;    ///< boost factors gamma - 1
+    std::vector<double> bg;         ///< (signed) beta*gamma
+};
+
 /// display test calculation
 void testRelKin();
 
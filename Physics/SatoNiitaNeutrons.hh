@@ -18,6 +18,15 @@ public:
     /// Set solar modulation potential ss, cutoff rigidity rc, atmospheric depth d, water fraction w
     void setParameters(double ss, double rc, double d, double w);
 
+    /// solar modulation potential
+    double getSolarModulation() const { return s_mod; }
+    /// cutoff rigidity
+    double getCutoffRigidity() const { return r_c; }
+    /// atmospheric depth
+    double getDepth() const { return depth; }
+    /// water fraction in ground
+    double getWaterFraction() const { return waterFrac; }
+
     /// approximate conversion from altitude to atmospheric depth
     static double altitudeToDepth(double a) { return pow(10,-0.066044*a/km)*1033.7*g/cm2; }
 
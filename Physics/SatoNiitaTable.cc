@@ -0,0 +1,75 @@
+/// \file SatoNiitaTable.cc
+
+#include "SatoNiitaTable.hh"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+SatoNiitaTable::SatoNiitaTable(const SatoNiitaNeutrons& S, double Emin, double Emax, size_t n) {
+    if(!(0 < Emin && Emin < Emax) || n < 2) throw std::domain_error("Invalid SatoNiitaTable energy range");
+
+    SatoNiitaNeutrons SN(S); // (spectrum calculation updates intermediate terms)
+    l0 = log(Emin);
+    dl = (log(Emax) - l0)/(n - 1);
+    C.push_back(0);
+    for(size_t i = 0; i < n; ++i) {
+        SN.calcGroundSpectrum(exp(l0 + i*dl));
+        g.push_back(std::max(SN.phi_G, 0.));
+        if(i) C.push_back(C.back() + 0.5*dl*(g[i-1] + g[i]));
+    }
+    if(!(C.back() > 0)) throw std::runtime_error("Zero SatoNiitaNeutrons spectrum");
+
+    table.build([this](double p) { return lnQuantile(p); });
+}
+
+double SatoNiitaTable::spectrum(double E) const {
+    const double x = (log(E) - l0)/dl;
+    if(!(x >= 0 && x <= g.size() - 1)) return 0;
+    const size_t i = std::min(size_t(x), g.size() - 2);
+    const double t = x - i;
+    return ((1 - t)*g[i] + t*g[i+1])/E;
+}
+
+double SatoNiitaTable::cdf(double E) const {
+    const double x = (log(E) - l0)/dl;
+    if(!(x > 0)) return 0;
+    if(x >= g.size() - 1) return 1;
+    const size_t i = size_t(x);
+    const double t = x - i;
+    return (C[i] + dl*t*(g[i] + 0.5*t*(g[i+1] - g[i])))/C.back();
+}
+
+double SatoNiitaTable::lnQuantile(double p) const {
+    if(p <= 0) return l0;
+    if(p >= 1) return l0 + dl*(g.size() - 1);
+
+    // grid interval, and solve quadratic for position in linearly-varying flux
+    const double c = p*C.back();
+    const size_t i = std::min(size_t(std::upper_bound(C.begin(), C.end(), c) - C.begin()) - 1, C.size() - 2);
+    const double a = (c - C[i])/dl, b = g[i+1] - g[i];
+    const double d = g[i]*g[i] + 2*b*a;
+    const double t = a > 0? 2*a/(g[i] + sqrt(std::max(d, 0.))) : 0;
+    return l0 + dl*(i + std::min(t, 1.));
+}
+
+/// shared tables cache key: spectrum configuration and energy range
+typedef std::tuple<double, double, double, double, double, double, double, double, double> snt_key_t;
+
+std::shared_ptr<const SatoNiitaTable> SatoNiitaTable::get(const SatoNiitaNeutrons& S, double Emin, double Emax) {
+    static std::map<snt_key_t, std::shared_ptr<const SatoNiitaTable>> cache;
+    static std::mutex cacheMut;
+
+    const snt_key_t k(S.getSolarModulation(), S.getCutoffRigidity(), S.getDepth(), S.getWaterFraction(),
+                      S.scale_T, S.scale_S, S.E_T, Emin, Emax);
+    {
+        std::lock_guard<std::mutex> l(cacheMut);
+        auto it = cache.find(k);
+        if(it != cache.end()) return it->second;
+    }
+    // build outside lock; keep first inserted if built concurrently
+    auto T = std::make_shared<const SatoNiitaTable>(S, Emin, Emax);
+    std::lock_guard<std::mutex> l(cacheMut);
+    return cache.emplace(k, T).first->second;
+}
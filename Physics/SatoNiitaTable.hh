@@ -0,0 +1,52 @@
+/// \file SatoNiitaTable.hh Precomputed SatoNiitaNeutrons ground-level spectrum tables, with constant-time energy sampling
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SATONIITATABLE_HH
+#define SATONIITATABLE_HH
+
+#include "SatoNiitaNeutrons.hh"
+#include "MonotoneInverseCDF.hh"
+#include <memory>
+
+/// Tabulated SatoNiitaNeutrons ground-level spectrum for one parameters configuration
+/**
+ * The lethargy spectrum E dPhi/dE is tabulated at log-spaced energies and linearly interpolated in ln E,
+ * so its CDF is piecewise quadratic with exact quantiles. Sampling uses a constant-time MonotoneInverseCDF table of ln E.
+ */
+class SatoNiitaTable {
+public:
+    /// Constructor, tabulating ground spectrum of S at n log-spaced energies over [Emin, Emax]
+    explicit SatoNiitaTable(const SatoNiitaNeutrons& S, double Emin = 1e-9*MeV, double Emax = 1e5*MeV, size_t n = 4096);
+
+    /// shared table for configuration of S (setParameters, scale and thermal energy settings), built on first request
+    static std::shared_ptr<const SatoNiitaTable> get(const SatoNiitaNeutrons& S, double Emin = 1e-9*MeV, double Emax = 1e5*MeV);
+
+    /// interpolated ground-level spectrum dPhi/dE [/s/cm^2/MeV] at energy E
+    double spectrum(double E) const;
+    /// total flux [/s/cm^2] between Emin and Emax
+    double getFlux() const { return C.back(); }
+    /// fraction of flux below energy E
+    double cdf(double E) const;
+    /// exact energy quantile for cumulative fraction p
+    double quantile(double p) const { return exp(lnQuantile(p)); }
+    /// constant-time random energy for uniform u in [0,1]
+    double sample(double u) const { return exp(table(u)); }
+    /// fill E[n] with random energies, using rng() uniform [0,1) generator
+    template<class RNG>
+    void sample(double* E, size_t n, RNG& rng) const {
+        table.sample(E, n, rng);
+        for(size_t i = 0; i < n; ++i) E[i] = exp(E[i]);
+    }
+
+protected:
+    /// exact ln E quantile of interpolated spectrum
+    double lnQuantile(double p) const;
+
+    double l0;                  ///< ln Emin
+    double dl;                  ///< ln E grid spacing
+    vector<double> g;           ///< E dPhi/dE [/s/cm^2] at grid points
+    vector<double> C;           ///< cumulative flux [/s/cm^2] at grid points
+    MonotoneInverseCDF table;   ///< inverse CDF sampling table for ln E
+};
+
+#endif
@@ -170,22 +170,17 @@ double WilkinsonL0(double Z, double W, double R) {
         {4,-11.223}, {5,-14.854}, {6, 32.086}
     };
 
-    static map<double,vector<coeff1> > aiZ;
-    static map<double,double> aminus1Z;
-
     if(W <= 1) return 0;
 
-    if(!aiZ.count(Z)) {
-        vector<coeff1> aiZi;
-        for(unsigned int i=0; i<6; i++) aiZi.emplace_back(i, sumCoeffs(ai[i], alpha*Z));
-        aiZ.emplace(Z, aiZi);
-        aminus1Z.emplace(Z, sumCoeffs(aminus1,alpha*Z));
-    }
+    // Z-dependent coefficients, recomputed per call (no unsynchronized static cache)
+    vector<coeff1> aiZ;
+    for(unsigned int i=0; i<6; i++) aiZ.emplace_back(i, sumCoeffs(ai[i], alpha*Z));
+    const double aminus1Z = sumCoeffs(aminus1,alpha*Z);
 
     double gm = WilkinsonGamma(Z);
     double L0 = (1. + 13.*(alpha*Z)*(alpha*Z)/60. - W*R*alpha*Z*(41.-26.*gm)/(15.*(2.*gm-1.))
      - alpha*Z*R*gm*(17.-2.*gm)/(30.*W*(2.*gm-1.))
-     + aminus1Z[Z]*R/W + sumCoeffs(aiZ[Z], W*R)
+     + aminus1Z*R/W + sumCoeffs(aiZ, W*R)
      + 0.41*(R-0.0164) * pow(alpha*Z, 4.5));
 
     if(!std::isfinite(L0)) throw std::logic_error("Invalid L0 calculation");
@@ -6,7 +6,16 @@
 // -- Michael P. Mendenhall, 2015
 
 #include "UnpolarizedNeutronDecay.hh"
+#include "BetaCorrectionTable.hh"
+#include "CounterRNG.hh"
+#include "WorkStealingPool.hh"
 #include <stdio.h>
+#include <thread>
+
+void NeutronDecayBatch::resize(size_t n) {
+    for(auto v: {&E_2, &p_2, &E_1, &K, &evt_w, &evt_w0, &w_rad, &w_rwm}) v->resize(n);
+    for(int i=0; i<3; i++) for(auto v: {n_2, n_1, n_gamma, p_f}) v[i].resize(n);
+}
 
 void NeutronDecayKinematics::calc_proton() {
     p_1 = E_1; // massless neutrino approximation
@@ -18,6 +27,59 @@ void NeutronDecayKinematics::calc_proton() {
     mag_p_f = sqrt(mag_p_f);
 }
 
+void NeutronDecayKinematics::calc_proton(NeutronDecayBatch& B, size_t i0, size_t n) {
+    for(int k=0; k<3; k++) {
+        const double* n1 = &B.n_1[k][i0];
+        const double* n2 = &B.n_2[k][i0];
+        const double* ng = &B.n_gamma[k][i0];
+        const double* p1 = &B.E_1[i0]; // massless neutrino approximation
+        const double* p2 = &B.p_2[i0];
+        const double* K = &B.K[i0];
+        double* pf = &B.p_f[k][i0];
+        for(size_t j = 0; j < n; j++) pf[j] = -n1[j]*p1[j] - n2[j]*p2[j] - ng[j]*K[j];
+    }
+}
+
+void NeutronDecayKinematics::boost_to_lab(NeutronDecayBatch& B, const Lorentz_boost& L, size_t i0, size_t n) const {
+    const size_t nb = 256;  // block size for momentum component temporaries
+    double px[nb], py[nb], pz[nb], E[nb];
+
+    // particle with energy Es[], momentum magnitude ps[] (may be same as Es for massless), direction nv[]
+    auto boost_particle = [&](double* Es, double* ps, vector<double>* nv, size_t j0, size_t nj) {
+        double* nx = &nv[0][j0];
+        double* ny = &nv[1][j0];
+        double* nz = &nv[2][j0];
+        for(size_t j = 0; j < nj; j++) {
+            px[j] = ps[j]*nx[j];
+            py[j] = ps[j]*ny[j];
+            pz[j] = ps[j]*nz[j];
+        }
+        L.unboost(Es, pz, nj);
+        for(size_t j = 0; j < nj; j++) {
+            const double p = sqrt(px[j]*px[j] + py[j]*py[j] + pz[j]*pz[j]);
+            ps[j] = p;
+            if(!p) continue;
+            nx[j] = px[j]/p;
+            ny[j] = py[j]/p;
+            nz[j] = pz[j]/p;
+        }
+    };
+
+    const double m_f = m - Delta;
+    for(size_t j0 = i0; j0 < i0 + n; j0 += nb) {
+        const size_t nj = std::min(nb, i0 + n - j0);
+        boost_particle(&B.E_2[j0], &B.p_2[j0], B.n_2, j0, nj);
+        boost_particle(&B.E_1[j0], &B.E_1[j0], B.n_1, j0, nj);
+        boost_particle(&B.K[j0], &B.K[j0], B.n_gamma, j0, nj);
+
+        const double* pfx = &B.p_f[0][j0];
+        const double* pfy = &B.p_f[1][j0];
+        double* pfz = &B.p_f[2][j0];
+        for(size_t j = 0; j < nj; j++) E[j] = sqrt(pfx[j]*pfx[j] + pfy[j]*pfy[j] + pfz[j]*pfz[j] + m_f*m_f);
+        L.unboost(E, pfz, nj);
+    }
+}
+
 void NeutronDecayKinematics::n_from_angles(double c, double phi, double n[3]) {
     const double s = sqrt(1-c*c);
     n[0] = s*cos(phi);
@@ -34,13 +96,56 @@ double NeutronDecayKinematics::proton_ctheta() const {
 double NeutronDecayKinematics::Gluck93_radcxn_wt() const {
     double c = proton_ctheta();
     double x = (E_2-m_2)/(Delta-m_2);
-    return 1 + Wilkinson_g_a2pi(E_2/m_2) + 0.01*Gluck93_r_enu(x,c);
+    return 1 + neutron_g_a2pi(E_2/m_2) + 0.01*Gluck93_r_enu(x,c);
 }
 
 double NeutronDecayKinematics::B59_rwm_cxn_wt() const {
     return B59_rwm_cxn(E_2, cos_theta_e_nu());
 }
 
+void NeutronDecayKinematics::calc_cxn_wts(NeutronDecayBatch& B, size_t i0, size_t n) const {
+    for(size_t i = i0; i < i0 + n; i++) {
+        const double n1[3] = {B.n_1[0][i], B.n_1[1][i], B.n_1[2][i]};
+        const double n2[3] = {B.n_2[0][i], B.n_2[1][i], B.n_2[2][i]};
+        double pep[3];
+        for(int k=0; k<3; k++) pep[k] = n2[k]*B.p_2[i] + B.p_f[k][i];
+        const double c = -dot3(pep, n2)/sqrt(dot3(pep,pep));
+        const double x = (B.E_2[i]-m_2)/(Delta-m_2);
+        B.w_rad[i] = 1 + neutron_g_a2pi(B.E_2[i]/m_2) + 0.01*Gluck93_r_enu(x,c);
+        B.w_rwm[i] = B59_rwm_cxn(B.E_2[i], dot3(n1, n2));
+    }
+}
+
+void NeutronDecayKinematics::gen_evts(NeutronDecayBatch& B, size_t n, uint64_t seed, size_t i0, unsigned int nthreads) const {
+    const size_t nchunk = 4096;     // events per work unit
+    const size_t nr = n_random();
+    const size_t b0 = B.size();
+    B.resize(b0 + n);
+
+    // generate events [c0, c0 + m) into B, each event from its own random stream
+    auto genChunk = [&](size_t c0, size_t nc) {
+        vector<double> u(nc*nr);
+        for(size_t j = 0; j < nc; j++) {
+            const uint64_t k = CounterRNG::streamKey(seed, i0 + c0 + j);
+            for(size_t r = 0; r < nr; r++) u[j*nr + r] = CounterRNG::to_uniform(CounterRNG::draw(k, r));
+        }
+        gen_evts_weighted(u.data(), nc, B, b0 + c0);
+        calc_cxn_wts(B, b0 + c0, nc);
+        if(n_lab.beta) boost_to_lab(B, n_lab, b0 + c0, nc);
+    };
+
+    const size_t nchunks = (n + nchunk - 1)/nchunk;
+    if(!nthreads) nthreads = std::thread::hardware_concurrency();
+    if(nthreads <= 1 || nchunks <= 1) {
+        for(size_t c = 0; c < nchunks; c++) genChunk(c*nchunk, std::min(nchunk, n - c*nchunk));
+        return;
+    }
+
+    WorkStealingPool P(std::min(size_t(nthreads), nchunks));
+    for(size_t c = 0; c < nchunks; c++) P.submit([&, c]() { genChunk(c*nchunk, std::min(nchunk, n - c*nchunk)); });
+    P.wait_idle();
+}
+
 ////////////////////////////////////
 ////////////////////////////////////
 
@@ -77,19 +182,21 @@ double eval_cubic_interpl(double y, const double* d) {
     -0.5*d[3]*(1-y)*y*y );
 }
 
+double N3BodyUncorrelated::calc_E_2(double u0) const {
+    if(use_KEe > 0) return use_KEe + m_2;
+    // electron energy cubic interpolated from inverse CDF lookup table
+    double jf = u0*(NPTS-1);
+    size_t j = size_t(jf);
+    jf -= j;
+    return m_2 + eval_cubic_interpl(jf, invcdf + j + 1);
+}
+
 void N3BodyUncorrelated::gen_evt_weighted() {
     assert(myR);
     myR->next(); // random seed
     evt_w = 1;
 
-    if(use_KEe > 0) E_2 = use_KEe + m_2;
-    else {
-        // electron energy cubic interpolated from inverse CDF lookup table
-        double jf = myR->u[0]*(NPTS-1);
-        size_t j = size_t(jf);
-        jf -= j;
-        E_2 = m_2 + eval_cubic_interpl(jf, invcdf + j + 1);
-    }
+    E_2 = calc_E_2(myR->u[0]);
 
     // electron momentum magnitude, velocity
     p_2 = sqrt(E_2*E_2 - m_2*m_2);
@@ -120,16 +227,47 @@ void N3BodyUncorrelated::gen_evt_weighted() {
     mag_p_f = sqrt(mag_p_f);
 }
 
+void N3BodyUncorrelated::gen_evts_weighted(const double* u, size_t n, NeutronDecayBatch& B, size_t i0) const {
+    const size_t nr = n_random();
+    double* E_2s = &B.E_2[i0];
+    double* p_2s = &B.p_2[i0];
+    double* E_1s = &B.E_1[i0];
+
+    // electron, neutrino energies
+    for(size_t j = 0; j < n; j++) {
+        E_2s[j] = calc_E_2(u[j*nr]);
+        p_2s[j] = sqrt(E_2s[j]*E_2s[j] - m_2*m_2);
+        E_1s[j] = Delta - E_2s[j];
+        B.K[i0+j] = 0;
+        B.evt_w[i0+j] = B.evt_w0[i0+j] = 1;
+    }
+
+    // electron, neutrino directions
+    for(size_t j = 0; j < n; j++) {
+        const double* uj = u + j*nr;
+        const size_t i = i0 + j;
+        double c2min = -1;
+        if(pt2_max && p_2s[j] > pt2_max) c2min = sqrt(1.-pt2_max*pt2_max/(p_2s[j]*p_2s[j]));
+        double v[3];
+        n_from_angles(c2min + (1-c2min)*uj[1], 2*M_PI*uj[2], v);
+        for(int k=0; k<3; k++) B.n_2[k][i] = v[k];
+        n_from_angles(2*uj[3] - 1, 2*M_PI*uj[4], v);
+        for(int k=0; k<3; k++) { B.n_1[k][i] = v[k]; B.n_gamma[k][i] = 0; }
+    }
+
+    calc_proton(B, i0, n);
+}
+
 ////////////////////////////////////
 ////////////////////////////////////
 
 
-double Gluck_beta_MC::z_VS() const {
+double Gluck_beta_MC::z_VS(double b, double NN, double w) const {
     // (3.10)
-    if(!omega) return 0;
-    double L = SpenceL(2*beta/(1+beta));
-    return alpha/M_PI * (3./2.*log(m_p/m_2) + 2*(N/beta-1)*log(2*omega/m_2)
-                         +2*N/beta*(1-N) + 2/beta*L - 3./8.);
+    if(!w) return 0;
+    double L = SpenceL(2*b/(1+b));
+    return alpha/M_PI * (3./2.*log(m_p/m_2) + 2*(NN/b-1)*log(2*w/m_2)
+                         +2*NN/b*(1-NN) + 2/b*L - 3./8.);
 }
 
 double Gluck_beta_MC::z_H() const {
@@ -139,31 +277,36 @@ double Gluck_beta_MC::z_H() const {
 
 }
 
-void Gluck_beta_MC::vec_rel_n_2(double c, double phi, double* v) const {
+void Gluck_beta_MC::vec_rel_n_2(const double* n2, const double* np2, const double* npp2, double c, double phi, double* v) {
     // (5.11)
     const double s = sqrt(1-c*c);
     // (5.9)
+    const double cp = cos(phi), sp = sin(phi);
     double n_perp[3];
-    for(int i=0; i<3; i++) n_perp[i] = np_2[i]*cos(phi) + npp_2[i]*sin(phi);
+    for(int i=0; i<3; i++) n_perp[i] = np2[i]*cp + npp2[i]*sp;
     // (5.8)
-    for(int i=0; i<3; i++) v[i] = n_2[i]*c + n_perp[i]*s;
+    for(int i=0; i<3; i++) v[i] = n2[i]*c + n_perp[i]*s;
 }
 
-double Gluck_beta_MC::calc_soft() {
-    // neutrino direction is relative to electron, so we can use c_1 below
-    vec_rel_n_2(c_1, phi_1, n_1);
-
+double Gluck_beta_MC::soft_W(double E2, double b, double NN, double E01, double c1, double& M0, double& Mt, double& MVS) const {
     // (2.12) uncorrected phase space matrix element
-    M_0 = 16 * G2_V * zeta * m*m * E0_1 * E_2 * (1 + a * beta * c_1);
+    M0 = 16 * G2_V * zeta * m*m * E01 * E2 * (1 + a * b * c1);
 
     // (3.2)
-    Mtilde = -alpha/M_PI * 16 * G2_V * (1-beta*beta)/beta * N * m*m * E0_1 * E_2 * zeta;
+    Mt = -alpha/M_PI * 16 * G2_V * (1-b*b)/b * NN * m*m * E01 * E2 * zeta;
 
-    // (3.9)
-    M_VS = z_VS() * M_0 + Mtilde;
+    // (3.9), with (3.8) soft brem cutoff
+    MVS = z_VS(b, NN, C_S * E01) * M0 + Mt;
 
     // weight function
-    double W_0VS = beta * E0_1 * E_2 * (M_0 + M_VS);
+    return b * E01 * E2 * (M0 + MVS);
+}
+
+double Gluck_beta_MC::calc_soft() {
+    // neutrino direction is relative to electron, so we can use c_1 below
+    vec_rel_n_2(c_1, phi_1, n_1);
+
+    double W_0VS = soft_W(E_2, beta, N, E0_1, c_1, M_0, Mtilde, M_VS);
     evt_w0 =  beta * E0_1 * E_2 * M_0 * evt_w;
     if(W_0VS > Wmax_0VS) Wmax_0VS = W_0VS;
     sum_W_0VS += W_0VS;
@@ -193,35 +336,40 @@ double Gluck_beta_MC::calc_hard_brem() {
     // or do it relative to electron for consistency... shouldn't matter
     //vec_rel_n_2(c_1, phi_1, n_1);
 
+    double w = hard_w(E_2, beta, N, n_2, E_1, n_1, K, c_gamma, n_gamma, M_BR);
+    if(w > w_max) w_max = w;
+    sum_w += w;
+    n_H++;
+
+    return w;
+}
+
+double Gluck_beta_MC::hard_w(double E2, double b, double NN, const double* n2, double E1, const double* n1,
+                             double k, double cg, const double* ng, double& MBR) const {
     // (5.13) calculate momentum dot products
-    const double p_1_dot_k = E_1 * K * dot3(n_1, n_gamma);
-    const double p_2_dot_k = beta * E_2 * K * c_gamma;
-    const double p_1_dot_p_2 = beta * E_1 * E_2 * dot3(n_1, n_2);
+    const double p_1_dot_k = E1 * k * dot3(n1, ng);
+    const double p_2_dot_k = b * E2 * k * cg;
+    const double p_1_dot_p_2 = b * E1 * E2 * dot3(n1, n2);
     // (4.8) four-vector momenta dot
-    const double p4_2_dot_k4 = E_2*K - p_2_dot_k;
+    const double p4_2_dot_k4 = E2*k - p_2_dot_k;
 
     // (5.3) approximate distribution function
-    const double g = beta*E_2/(2*N*p4_2_dot_k4);
+    const double g = b*E2/(2*NN*p4_2_dot_k4);
 
     // (4.7)
-    const double Psq = 1./K/K + m_2*m_2/p4_2_dot_k4/p4_2_dot_k4 - 2*E_2/K/p4_2_dot_k4;
+    const double Psq = 1./k/k + m_2*m_2/p4_2_dot_k4/p4_2_dot_k4 - 2*E2/k/p4_2_dot_k4;
     // (4.5)
-    const double H_0 = E_1*(-(E_2+K)*Psq + K/p4_2_dot_k4);
+    const double H_0 = E1*(-(E2+k)*Psq + k/p4_2_dot_k4);
     // (4.6)
     const double H_1 = ( p_1_dot_p_2 * ( -Psq + 1./p4_2_dot_k4 )
-                        + p_1_dot_k * ((E_2+K)/K -m_2*m_2/p4_2_dot_k4) / p4_2_dot_k4);
+                        + p_1_dot_k * ((E2+k)/k -m_2*m_2/p4_2_dot_k4) / p4_2_dot_k4);
     // (4.3)
     const double esq = 4*M_PI*alpha;
     // (4.4)
-    M_BR = 16*G2_V*zeta*m*m*esq*(H_0 + a*H_1);
+    MBR = 16*G2_V*zeta*m*m*esq*(H_0 + a*H_1);
 
     // (5.14)
-    double w = (K * beta * E_1 * E_2 * M_BR)/(pow(2,13)*pow(M_PI,8)*m*m*g);
-    if(w > w_max) w_max = w;
-    sum_w += w;
-    n_H++;
-
-    return w;
+    return (k * b * E1 * E2 * MBR)/(pow(2,13)*pow(M_PI,8)*m*m*g);
 }
 
 double Gluck_beta_MC::recalc_Sirlin_g_a2pi(double E_e) {
@@ -272,14 +420,16 @@ void Gluck_beta_MC::propose_kinematics() {
     calc_n_2();
 }
 
-void Gluck_beta_MC::calc_n_2() {
+void Gluck_beta_MC::calc_n_2() { calc_n_2(c_2, phi_2, n_2, np_2, npp_2); }
+
+void Gluck_beta_MC::calc_n_2(double c, double phi, double* n2, double* np2, double* npp2) {
     // (5.11)
-    const double s_2 = sqrt(1-c_2*c_2);
+    const double s_2 = sqrt(1-c*c);
     // (5.12)
-    n_2[0] = s_2*cos(phi_2); n_2[1] = s_2*sin(phi_2); n_2[2] = c_2;
+    n2[0] = s_2*cos(phi); n2[1] = s_2*sin(phi); n2[2] = c;
     // (5.10)
-    np_2[0] = -sin(phi_2);      np_2[1] = cos(phi_2);           np_2[2] = 0;
-    npp_2[0] = -c_2*cos(phi_2); npp_2[1] = -c_2*sin(phi_2);     npp_2[2] = s_2;
+    np2[0] = -sin(phi);      np2[1] = cos(phi);           np2[2] = 0;
+    npp2[0] = -c*cos(phi);   npp2[1] = -c*sin(phi);       npp2[2] = s_2;
 }
 
 void Gluck_beta_MC::gen_evt_weighted() {
@@ -302,6 +452,73 @@ void Gluck_beta_MC::gen_evt_weighted() {
     calc_proton();
 }
 
+void Gluck_beta_MC::gen_evts_weighted(const double* u, size_t n, NeutronDecayBatch& B, size_t i0) const {
+    const size_t nr = n_random();
+    double* E_2s = &B.E_2[i0];
+    double* p_2s = &B.p_2[i0];
+    double* E_1s = &B.E_1[i0];
+
+    // (5.4) electron energy, (2.10) neutrino energy before photon emission
+    for(size_t j = 0; j < n; j++) {
+        E_2s[j] = use_KEe > 0? use_KEe + m_2 : m_2 + (Delta-m_2)*u[j*nr];
+        p_2s[j] = sqrt(E_2s[j]*E_2s[j] - m_2*m_2);
+        E_1s[j] = Delta - E_2s[j];
+    }
+
+    double M0, Mt, MVS, MBR; // amplitudes (unused)
+    for(size_t j = 0; j < n; j++) {
+        const double* uj = u + j*nr;
+        const size_t i = i0 + j;
+        const double E2 = E_2s[j];
+        const double E01 = E_1s[j];
+
+        // hard or soft event selection, re-using rescaled u[4] for electron azimuth
+        const bool hard = !(P_H.q < uj[4]);
+        const double u4 = hard? uj[4]/P_H.q : (uj[4]-P_H.q)/(1-P_H.q);
+
+        // electron direction, optionally pre-restricted cos theta range, and relative coordinates
+        double c2min = -1;
+        if(pt2_max && p_2s[j] > pt2_max) c2min = sqrt(1.-pt2_max*pt2_max/(p_2s[j]*p_2s[j]));
+        double n2[3], np2[3], npp2[3];
+        calc_n_2(c2min + (1-c2min)*uj[2], 2*M_PI*u4, n2, np2, npp2);
+
+        // (2.10), (3.3)
+        double b = sqrt(1-m_2*m_2/(E2*E2));
+        if(!(b==b)) b = 0;
+        const double NN = 0.5*log((1+b)/(1-b));
+
+        // (5.7) isotropic neutrino direction
+        const double c1 = 2*uj[1] - 1;
+        const double phi1 = 2*M_PI*uj[3];
+        double n1[3], ng[3] = {0, 0, 0};
+        double k = 0;
+        if(hard) {
+            // (5.5), (4.9), (5.6), (5.7) hard photon energy and direction; neutrino in fixed coordinates
+            k = C_S*E01 * pow(C_S,-uj[5]);
+            E_1s[j] = Delta - E2 - k;
+            const double cg = (1-(1+b)*exp(-2*NN*uj[6]))/b;
+            vec_rel_n_2(n2, np2, npp2, cg, 2*M_PI*uj[7], ng);
+            n_from_angles(c1, phi1, n1);
+            B.evt_w[i] = hard_w(E2, b, NN, n2, E_1s[j], n1, k, cg, ng, MBR)/w_avg * P_H.p_wt();
+            B.evt_w0[i] = 0;
+        } else {
+            // neutrino direction relative to electron
+            vec_rel_n_2(n2, np2, npp2, c1, phi1, n1);
+            B.evt_w[i] = soft_W(E2, b, NN, E01, c1, M0, Mt, MVS)/Wavg_0VS * P_H.np_wt();
+            B.evt_w0[i] = b * E01 * E2 * M0 / Wavg_0VS;
+        }
+
+        B.K[i] = k;
+        for(int d=0; d<3; d++) {
+            B.n_2[d][i] = n2[d];
+            B.n_1[d][i] = n1[d];
+            B.n_gamma[d][i] = ng[d];
+        }
+    }
+
+    calc_proton(B, i0, n);
+}
+
 void Gluck_beta_MC::calc_rho() {
 
     printf("Calculating correction rates:\n");
@@ -450,7 +667,7 @@ double GM78_radiative_cxn(double E, double cos_thn) {
 
     //double r0 = (1 + 3*lambda*lambda + beta*cos_thn*(1 - lambda*lambda));
 
-    double r0 = (1 + 3*lambda*lambda)*(1.+Wilkinson_g_a2pi(E/m_e));
+    double r0 = (1 + 3*lambda*lambda)*(1.+neutron_g_a2pi(E/m_e));
     return (1 + phth1 + 3*lambda*lambda*(1+phth1)
             + beta*cos_thn*(1 + phth2 - lambda*lambda*(1 + phth2)) )/r0;
 }
@@ -498,7 +715,7 @@ double Gluck93_Distribution::calc_Wenu_0Ca(double E_2, double c) {
 
     double x = (E_2-m_2)/(E_2m-m_2);    // (2.6)
     double r_enu = Gluck93_r_enu(x,c);  // from parametrized fit to Table V
-    double r_e = 100*Wilkinson_g_a2pi(E_2/m_2);
+    double r_e = 100*neutron_g_a2pi(E_2/m_2);
     // (4.2)
     return Wenu_0Ca = W_0C * dEfc_dc * (1 + 0.01*r_e + 0.01*r_enu);
 }
@@ -9,9 +9,12 @@
 #define UNPOLARIZEDNEUTRONDECAY_HH
 
 #include "UnpolarizedBeta.hh"
+#include "RelKin.hh"
 #include <cstddef>
 #include <cassert>
 #include <stdint.h>
+#include <vector>
+using std::vector;
 
 /// virtual class for providing random number vectors for decay kinematics
 class NKine_Rndm_Src {
@@ -30,6 +33,27 @@ public:
     double* u;          ///< kinematics array starting at u0[3]
 };
 
+/// Structure-of-arrays block of weighted neutron decay events, from batch generation
+struct NeutronDecayBatch {
+    /// number of events
+    size_t size() const { return E_2.size(); }
+    /// resize to n events
+    void resize(size_t n);
+
+    vector<double> E_2;         ///< electron total energy [MeV]
+    vector<double> p_2;         ///< electron momentum magnitude [MeV/c]
+    vector<double> n_2[3];      ///< electron unit direction
+    vector<double> E_1;         ///< antineutrino energy (minus photon) [MeV]
+    vector<double> n_1[3];      ///< neutrino momentum unit direction
+    vector<double> K;           ///< hard photon energy [MeV]
+    vector<double> n_gamma[3];  ///< gamma unit direction (0 if no hard photon)
+    vector<double> p_f[3];      ///< recoil nucleon momentum [MeV/c]
+    vector<double> evt_w;       ///< event weight for kinematics
+    vector<double> evt_w0;      ///< event weight without radiative corrections
+    vector<double> w_rad;       ///< Gluck93_radcxn_wt() radiative correction weight
+    vector<double> w_rwm;       ///< B59_rwm_cxn_wt() recoil and weak magnetism weight
+};
+
 /// Base class for neutron decay kinematics generators
 class NeutronDecayKinematics {
 public:
@@ -54,6 +78,17 @@ public:
     /// set fixed electron kinetic energy
     virtual void set_KEe(double k) { use_KEe = k; }
 
+    /// Generate weighted events into B[i0, i0+n) from event-major random vectors u[n*n_random()], without modifying generator state
+    virtual void gen_evts_weighted(const double* u, size_t n, NeutronDecayBatch& B, size_t i0 = 0) const = 0;
+    /// fill correction weights w_rad, w_rwm for events B[i0, i0+n)
+    void calc_cxn_wts(NeutronDecayBatch& B, size_t i0, size_t n) const;
+    /// append n weighted events with correction weights, for events i0... of reproducible counter-based random stream seed, on nthreads (0 for all cores); transformed to lab frame by n_lab
+    void gen_evts(NeutronDecayBatch& B, size_t n, uint64_t seed, size_t i0 = 0, unsigned int nthreads = 0) const;
+    /// transform decay products of events B[i0, i0+n) from neutron rest frame to lab frame, where neutron has boost L along +z
+    void boost_to_lab(NeutronDecayBatch& B, const Lorentz_boost& L, size_t i0, size_t n) const;
+
+    Lorentz_boost n_lab;    ///< neutron lab-frame motion along +z for gen_evts (after rest-frame correction weights)
+
     double E_2;         ///< electron total energy [MeV]
     double p_2;         ///< electron momentum magnitude [MeV/c]
     double n_2[3];      ///< electron unit direction
@@ -86,6 +121,8 @@ protected:
 
     /// calculate proton kinematics from electron, neutrino, gamma
     void calc_proton();
+    /// calculate proton kinematics for events B[i0, i0+n) from electron, neutrino, gamma
+    static void calc_proton(NeutronDecayBatch& B, size_t i0, size_t n);
     /// unit vector from z cosine and x,y azimuth
     static void n_from_angles(double c, double phi, double n[3]);
     /// 3-vector dot product
@@ -99,6 +136,8 @@ public:
     N3BodyUncorrelated(NKine_Rndm_Src* R);
     /// Generate weighted event
     virtual void gen_evt_weighted() override;
+    /// Generate weighted events into B[i0, i0+n) from event-major random vectors u[n*n_random()]
+    virtual void gen_evts_weighted(const double* u, size_t n, NeutronDecayBatch& B, size_t i0 = 0) const override;
 
     double c_1, c_2;            ///< phase-space cosines
     double phi_1, phi_2;        ///< phase-space azimuths
@@ -109,6 +148,9 @@ public:
 protected:
     static const size_t NPTS = 16384;   ///< lookup table dimensions
     double invcdf[NPTS+4];              ///< inverse CDF lookup table with interpolation guard entries
+
+    /// electron total energy for random u
+    double calc_E_2(double u0) const;
 };
 
 /// Math for re-assigning "natural" weighted splitting p, (1-p) to re-weighted q, (1-q)
@@ -132,6 +174,8 @@ public:
 
     /// Generate weighted event
     virtual void gen_evt_weighted() override;
+    /// Generate weighted events into B[i0, i0+n) from event-major random vectors u[n*n_random()]; does not accumulate MC efficiency statistics
+    virtual void gen_evts_weighted(const double* u, size_t n, NeutronDecayBatch& B, size_t i0 = 0) const override;
 
     /// Show "efficiency" of MC (5.22)
     void showEffic();
@@ -195,8 +239,12 @@ protected:
     void propose_kinematics();
     /// calculate electron vector and relative coordinates
     void calc_n_2();
+    /// calculate electron unit vector n2 and perpendicular coordinate vectors np2, npp2 from cosine, azimuth
+    static void calc_n_2(double c, double phi, double* n2, double* np2, double* npp2);
     /// calculate unit vector specified relative to n_2
-    void vec_rel_n_2(double c, double phi, double* v) const;
+    void vec_rel_n_2(double c, double phi, double* v) const { vec_rel_n_2(n_2, np_2, npp_2, c, phi, v); }
+    /// calculate unit vector specified relative to n2, with perpendicular coordinate vectors np2, npp2
+    static void vec_rel_n_2(const double* n2, const double* np2, const double* npp2, double c, double phi, double* v);
     /// calculate beta and N(beta)
     void calc_beta_N();
 
@@ -204,9 +252,15 @@ protected:
     double calc_soft();
     /// corrected spectrum probability for hard photon production
     double calc_hard_brem();
+    /// soft weight W_0VS (and amplitudes M0, Mt, MVS) for electron energy E2, beta b, N(beta) NN, neutrino energy E01 at cosine c1 to electron
+    double soft_W(double E2, double b, double NN, double E01, double c1, double& M0, double& Mt, double& MVS) const;
+    /// hard weight w (and amplitude MBR) for electron E2, beta b, N(beta) NN along n2; neutrino E1 along n1; photon K at cosine cg along ng
+    double hard_w(double E2, double b, double NN, const double* n2, double E1, const double* n1, double k, double cg, const double* ng, double& MBR) const;
 
     /// virtual and soft brem correction (3.10)
-    double z_VS() const;
+    double z_VS() const { return z_VS(beta, N, omega); }
+    /// virtual and soft brem correction (3.10) for beta b, N(beta) NN, cutoff w
+    double z_VS(double b, double NN, double w) const;
     /// hard brem correction (4.14)
     double z_H() const;
     /// calculate rho_0VS, rho_H non-gamma-emitting rate
@@ -0,0 +1,130 @@
+/// \file BatchFitter.cc
+
+#include "BatchFitter.hh"
+#include "WorkStealingPool.hh"
+#include "to_str.hh"
+#include <Math/MinimizerOptions.h>
+#include <TROOT.h>
+#include <atomic>
+#include <mutex>
+#include <cmath>
+#include <random>
+
+void BatchFitter::setPrototype(const TF1* f) {
+    delete proto;
+    proto = f? static_cast<TF1*>(f->Clone((string(f->GetName()) + "_proto").c_str())) : nullptr;
+}
+
+void BatchFitter::fitRange(const job_t& J, double x0, double x1, vector<double>& p, result_t& R, TF1* F) const {
+    R.x0 = x0;
+    R.x1 = x1;
+
+    if(F) {
+        F->SetRange(x0, x1);
+        for(size_t i = 0; i < p.size(); ++i) F->SetParameter(i, p[i]);
+        R.status = J.h->Fit(F, "QRN0");
+        p.resize(F->GetNpar());
+        R.dp.resize(p.size());
+        for(size_t i = 0; i < p.size(); ++i) {
+            p[i] = F->GetParameter(i);
+            R.dp[i] = F->GetParError(i);
+        }
+        R.chi2 = F->GetChisquare();
+        R.ndf = F->GetNDF();
+        return;
+    }
+
+    // extract bins in range for analytic fit
+    vector<double> x, y, e;
+    auto A = J.h->GetXaxis();
+    for(int b = A->FindBin(x0); b <= A->FindBin(x1) && b <= J.h->GetNbinsX(); ++b) {
+        if(b < 1) continue;
+        auto c = A->GetBinCenter(b);
+        if(c < x0 || c > x1) continue;
+        x.push_back(c);
+        y.push_back(J.h->GetBinContent(b));
+        e.push_back(J.h->GetBinError(b));
+    }
+    GaussSumFit G;
+    R.status = G.fit(x, y, e, p);
+    R.dp = G.dp;
+    R.chi2 = G.chi2;
+    R.ndf = G.ndf;
+}
+
+BatchFitter::result_t BatchFitter::fitOne(const job_t& J, size_t seed, TF1* F) const {
+    if(!J.h) throw std::logic_error("BatchFitter job missing histogram");
+    if(!F && (J.p0.size() < 3 || J.p0.size() % 3)) throw std::logic_error("Gaussian-sum fit requires (height, center, sigma) guesses");
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> N;
+    result_t best;
+
+    for(int k = 0; k < std::max(1, nstarts); ++k) {
+        vector<double> p = J.p0;
+        if(k && p.size() >= 3) { // jittered restart of Gaussian centers and widths
+            for(size_t i = 0; i + 2 < p.size(); i += 3) {
+                p[i+1] += jitter*p[i+2]*N(rng);
+                p[i+2] *= exp(jitter*N(rng));
+            }
+        }
+
+        double x0 = J.x0, x1 = J.x1;
+        if(!(x0 < x1) && p.size() >= 3) {
+            x0 = p[1] - nSigma*p[2];
+            x1 = p[1] + nSigma*p[2];
+            for(size_t i = 3; i + 2 < p.size(); i += 3) {
+                x0 = std::min(x0, p[i+1] - nSigma*p[i+2]);
+                x1 = std::max(x1, p[i+1] + nSigma*p[i+2]);
+            }
+        }
+
+        result_t R;
+        fitRange(J, x0, x1, p, R, F);
+        // iterate fit-defined range about first peak
+        for(int n = 0; iterSigma > 0 && p.size() >= 3 && n < nIterRange; ++n) {
+            double r0 = p[1] - iterSigma*fabs(p[2]);
+            double r1 = p[1] + iterSigma*fabs(p[2]);
+            double maxtol = rtol*fabs(r1 - r0);
+            if(fabs(r0 - R.x0) < maxtol && fabs(r1 - R.x1) < maxtol) break;
+            fitRange(J, r0, r1, p, R, F);
+        }
+
+        R.p = p;
+        if(!k || (R.status == 0 && (best.status != 0 || R.chi2 < best.chi2))) best = R;
+    }
+    return best;
+}
+
+vector<BatchFitter::result_t> BatchFitter::fit(const vector<job_t>& jobs) const {
+    vector<result_t> res(jobs.size());
+    if(proto) {
+        ROOT::EnableThreadSafety();
+        ROOT::Math::MinimizerOptions::SetDefaultMinimizer("Minuit2"); // thread-safe minimizer
+    }
+
+    WorkStealingPool P(nthreads);
+    vector<TF1*> fs(P.size());
+    if(proto) for(size_t i = 0; i < fs.size(); ++i)
+        fs[i] = static_cast<TF1*>(proto->Clone((string(proto->GetName()) + "_thread" + to_str(i)).c_str()));
+
+    std::atomic<size_t> nerr{0};
+    string err;
+    std::mutex errMut;
+    for(size_t i = 0; i < jobs.size(); ++i) {
+        P.submit([&, i] {
+            try {
+                auto w = P.current_worker();
+                res[i] = fitOne(jobs[i], i, fs.at(w));
+            } catch(std::exception& e) {
+                std::lock_guard<std::mutex> l(errMut);
+                ++nerr;
+                err = e.what();
+            }
+        });
+    }
+    P.wait_idle();
+    for(auto f: fs) delete f;
+    if(nerr) throw std::runtime_error("BatchFitter: " + to_str(nerr.load()) + " failed fits (" + err + ")");
+    return res;
+}
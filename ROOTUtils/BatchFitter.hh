@@ -0,0 +1,68 @@
+/// \file BatchFitter.hh Parallel multi-start fitting of many histograms, via per-thread TF1 clones or analytic Gaussian sums
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef BATCHFITTER_HH
+#define BATCHFITTER_HH
+
+#include "GaussSumFit.hh"
+#include <TF1.h>
+#include <TH1.h>
+
+/// Parallel fitting of many histograms, with results returned in input order
+/*
+ * Default (no prototype TF1): analytic-gradient Levenberg-Marquardt fit of Gaussian sums,
+ * parameters (height, center, sigma) per peak as in MultiGaus;
+ * fit range defaults to nSigma around the initial peaks.
+ * With setPrototype(f): each fit thread uses its own clone of f, fit with ROOT (Minuit2) TH1::Fit.
+ * Optional iterative fit-defined range, as IterRangeGaus, about the first Gaussian (parameters 1, 2).
+ */
+class BatchFitter {
+public:
+    /// one histogram fit request
+    struct job_t {
+        TH1* h = nullptr;       ///< histogram to fit (only read)
+        vector<double> p0;      ///< initial parameter guess
+        double x0 = 0;          ///< fit range start (x0 >= x1 for automatic range)
+        double x1 = 0;          ///< fit range end
+    };
+
+    /// one histogram fit result
+    struct result_t {
+        vector<double> p;       ///< fit parameters
+        vector<double> dp;      ///< parameter uncertainties
+        double chi2 = 0;        ///< fit chi^2
+        int ndf = 0;            ///< fit degrees of freedom
+        int status = -1;        ///< 0 on successful fit
+        double x0 = 0;          ///< final fit range start
+        double x1 = 0;          ///< final fit range end
+    };
+
+    /// Constructor
+    explicit BatchFitter(int n = 0): nthreads(n) { }
+    /// Destructor
+    ~BatchFitter() { delete proto; }
+
+    /// set prototype TF1 for ROOT fitting (cloned for each thread); nullptr for analytic Gaussian sums
+    void setPrototype(const TF1* f);
+
+    /// fit all jobs in parallel; results in job order
+    vector<result_t> fit(const vector<job_t>& jobs) const;
+    /// fit one job (with supplied TF1 if given)
+    result_t fitOne(const job_t& J, size_t seed, TF1* F = nullptr) const;
+
+    int nthreads;               ///< fit threads (0 for hardware concurrency)
+    int nstarts = 1;            ///< multi-start: fits from jittered initial guesses, keeping lowest chi^2
+    double jitter = 0.1;        ///< relative multi-start jitter of centers (in sigma) and sigmas
+    double nSigma = 1.5;        ///< automatic fit range about initial peaks, in sigma
+    double iterSigma = 0;       ///< if > 0, iterate range to +- iterSigma about fit peak 0 (IterRangeGaus)
+    int nIterRange = 20;        ///< maximum range iterations
+    double rtol = 1e-4;         ///< range convergence tolerance, relative to width
+
+protected:
+    /// single fit over fixed range, from parameters p
+    void fitRange(const job_t& J, double x0, double x1, vector<double>& p, result_t& R, TF1* F) const;
+
+    TF1* proto = nullptr;       ///< prototype TF1 for ROOT fits
+};
+
+#endif
@@ -12,8 +12,8 @@
 /// Covariance matrix paired to histogram for correlated-bin fills
 class BurstFill: public MultiFill, public Clusterer<OrderedData<int>> {
 public:
-    /// Constructor, corresponding to histogram
-    BurstFill(const string& _name, TH1& H): MultiFill(_name, H), ClusterBuilder(500e3), OQ(this, 1e9) { }
+    /// Constructor, corresponding to histogram; optionally with sparse covariance
+    BurstFill(const string& _name, TH1& H, bool sparse = false): MultiFill(_name, H, sparse), ClusterBuilder(500e3), OQ(this, 1e9) { }
     /// Constructor, loaded from file
     BurstFill(const string& _name, TDirectory& d, TH1& H): MultiFill(_name, d, H), ClusterBuilder(500e3), OQ(this, 1e9) { }
 
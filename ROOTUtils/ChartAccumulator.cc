@@ -0,0 +1,69 @@
+/// \file ChartAccumulator.cc
+
+#include "ChartAccumulator.hh"
+#include <cmath>
+#include <unordered_map>
+
+std::atomic<uint64_t> ChartAccumulator::nextUID{1};
+
+ChartAccumulator::slot_t& ChartAccumulator::mySlot() {
+    static thread_local std::unordered_map<uint64_t, slot_t*> tl;
+    auto& s = tl[uid];
+    if(s) return *s;
+    std::lock_guard<std::mutex> l(accMut);
+    slots.emplace_back(new slot_t);
+    s = slots.back().get();
+    return *s;
+}
+
+void ChartAccumulator::add(double x, double y, double w) {
+    auto& s = mySlot();
+    int64_t k = int64_t(std::floor(x/dx));
+    auto k0 = s.k.load(std::memory_order_relaxed);
+    if(k != k0) {
+        std::lock_guard<std::mutex> l(accMut);
+        if(k < k0 && k0 != INT64_MAX) { // late point for already-retired window
+            pending[k].add(x - k*dx, y, w);
+            return;
+        }
+        retire(s);
+        s.k = k;
+        emitReady();
+    }
+    s.M.add(x - k*dx, y, w);
+}
+
+void ChartAccumulator::retire(slot_t& s) {
+    auto k = s.k.load();
+    if(s.M.w && k != INT64_MIN && k != INT64_MAX) pending[k].add(s.M);
+    s.M = ChartMoments();
+}
+
+void ChartAccumulator::release() {
+    auto& s = mySlot();
+    std::lock_guard<std::mutex> l(accMut);
+    retire(s);
+    s.k = INT64_MAX;
+    emitReady();
+}
+
+void ChartAccumulator::flush() {
+    std::lock_guard<std::mutex> l(accMut);
+    for(auto& s: slots) {
+        retire(*s);
+        s->k = INT64_MAX;
+    }
+    emitReady(true);
+}
+
+void ChartAccumulator::emitReady(bool all) {
+    int64_t kmin = INT64_MAX;
+    if(!all) {
+        if(slots.size() < nproducers) return;
+        for(auto& s: slots) kmin = std::min(kmin, s->k.load());
+    }
+    while(pending.size() && pending.begin()->first < kmin) {
+        emit(pending.begin()->first, pending.begin()->second);
+        pending.erase(pending.begin());
+    }
+}
@@ -0,0 +1,83 @@
+/// \file ChartAccumulator.hh Concurrent fixed-grid window accumulation for TStripchart/TRatechart
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef CHARTACCUMULATOR_HH
+#define CHARTACCUMULATOR_HH
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+using std::vector;
+using std::map;
+
+/// weighted moments of (x,y) points in one window, relative to window origin x0
+struct ChartMoments {
+    double w = 0;       ///< sum of weights
+    double x = 0;       ///< sum w*(x - x0)
+    double xx = 0;      ///< sum w*(x - x0)^2
+    double y = 0;       ///< sum w*y
+    double yy = 0;      ///< sum w*y^2
+
+    /// add point
+    void add(double dx, double yy0, double ww) { w += ww; x += ww*dx; xx += ww*dx*dx; y += ww*yy0; yy += ww*yy0*yy0; }
+    /// add other moments (same origin)
+    void add(const ChartMoments& M) { w += M.w; x += M.x; xx += M.xx; y += M.y; yy += M.yy; }
+    /// shift origin by dx0 (new origin = old origin - dx0)
+    void shift(double dx0) { xx += 2*dx0*x + dx0*dx0*w; x += dx0*w; }
+    /// (mean, variance) of x, given origin
+    void xstats(double x0, double& m, double& v) const { m = x/w; v = std::max(0., xx/w - m*m); m += x0; }
+    /// (mean, variance) of y
+    void ystats(double& m, double& v) const { m = y/w; v = std::max(0., yy/w - m*m); }
+};
+
+/// Concurrent accumulation into fixed x-grid windows [k*dx, (k+1)*dx): each thread accumulates its current window locally;
+/// completed windows are merged, and emitted in window order once every active thread has passed them
+class ChartAccumulator {
+public:
+    /// completed-window callback (window index, moments relative to k*dx); called under accumulator lock
+    typedef std::function<void(int64_t, const ChartMoments&)> emit_t;
+
+    /// Constructor, with window width, emit callback, and number of filling threads to wait for before emitting
+    ChartAccumulator(double d, const emit_t& e, size_t np = 0): dx(d), nproducers(np), emit(e), uid(nextUID++) { }
+
+    /// add point from calling thread (points expected approximately ordered per thread)
+    void add(double x, double y, double w);
+    /// calling thread finished: merge its current window and stop waiting for it
+    void release();
+    /// merge and emit all windows (no concurrent adds)
+    void flush();
+
+    /// lock for emitted-data readers
+    std::mutex& getMutex() { return accMut; }
+
+    const double dx;            ///< window width
+    const size_t nproducers;    ///< expected filling threads (late-starting threads may otherwise split windows)
+
+protected:
+    /// per-thread accumulation state
+    struct slot_t {
+        std::atomic<int64_t> k{INT64_MIN};  ///< current window (INT64_MAX when released)
+        ChartMoments M;         ///< current window moments
+    };
+
+    /// calling thread's slot
+    slot_t& mySlot();
+    /// move slot's window to pending (caller holds accMut)
+    void retire(slot_t& s);
+    /// emit pending windows below all active threads' current windows (caller holds accMut)
+    void emitReady(bool all = false);
+
+    emit_t emit;                        ///< window output callback
+    const uint64_t uid;                 ///< unique identifier for thread-local lookup
+    std::mutex accMut;                  ///< protects pending, slots list, emission
+    vector<std::unique_ptr<slot_t>> slots;  ///< all thread slots
+    map<int64_t, ChartMoments> pending; ///< completed windows awaiting emission
+    static std::atomic<uint64_t> nextUID;   ///< next unique identifier
+};
+
+#endif
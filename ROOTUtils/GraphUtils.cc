@@ -1,6 +1,7 @@
 /// \file GraphUtils.cc
 #include "GraphUtils.hh"
 #include "to_str.hh"
+#include "WorkStealingPool.hh"
 #include <math.h>
 #include <TROOT.h>
 #include <TMath.h>
@@ -8,6 +9,72 @@
 #include <cmath>
 #include <cassert>
 
+/// whether histogram stores plain contents (and sumw2) arrays, suitable for direct-array transforms
+static bool isPlainHist(const TH1& h) {
+    return !h.GetBuffer() && h.GetBinErrorOption() == TH1::kNormal
+        && !h.InheritsFrom("TProfile") && !h.InheritsFrom("TProfile2D") && !h.InheritsFrom("TProfile3D");
+}
+
+/// apply f(contents array) for plain double or float storage; return false (not applied) for other types
+template<typename F>
+static bool withBinArray(TH1& h, F f) {
+    if(!isPlainHist(h)) return false;
+    if(auto a = dynamic_cast<TArrayD*>(&h)) { f(a->GetArray()); return true; }
+    if(auto a = dynamic_cast<TArrayF*>(&h)) { f(a->GetArray()); return true; }
+    return false;
+}
+/// const version
+template<typename F>
+static bool withBinArray(const TH1& h, F f) {
+    if(!isPlainHist(h)) return false;
+    if(auto a = dynamic_cast<const TArrayD*>(&h)) { f(a->GetArray()); return true; }
+    if(auto a = dynamic_cast<const TArrayF*>(&h)) { f(a->GetArray()); return true; }
+    return false;
+}
+
+/// sum-of-squared-weights array, created if needed matching default sqrt(|content|) errors
+template<typename T>
+static double* sumw2Array(TH1& h, const T* c) {
+    if(!h.GetSumw2N()) {
+        h.Sumw2();
+        auto w2 = h.GetSumw2()->GetArray();
+        for(int i = 0; i < h.GetNcells(); ++i) w2[i] = std::fabs(c[i]);
+    }
+    return h.GetSumw2()->GetArray();
+}
+
+/// bin errors squared from plain histogram: sumw2, or |content|
+template<typename T>
+static void binErr2(const TH1& h, const T* c, vector<double>& e2) {
+    e2.resize(h.GetNcells());
+    if(h.GetSumw2N()) std::copy(h.GetSumw2()->GetArray(), h.GetSumw2()->GetArray() + e2.size(), e2.begin());
+    else for(size_t i = 0; i < e2.size(); ++i) e2[i] = std::fabs(c[i]);
+}
+
+/// multiply each cell content by s[x bin], and errors by the same factor
+static bool scaleByXbin(TH1& h, const vector<double>& s) {
+    return withBinArray(h, [&h, &s](auto c) {
+        auto w2 = sumw2Array(h, c);
+        const int nc = h.GetNcells(), nx = s.size();
+        for(int i0 = 0; i0 < nc; i0 += nx) {
+            auto cc = c + i0;
+            auto ww = w2 + i0;
+            for(int j = 0; j < nx; ++j) {
+                cc[j] *= s[j];
+                ww[j] *= s[j]*s[j];
+            }
+        }
+        h.ResetStats();
+    });
+}
+
+void applyParallel(size_t n, const std::function<void(size_t)>& f, int nthreads) {
+    ROOT::EnableThreadSafety();
+    WorkStealingPool P(nthreads);
+    for(size_t i = 0; i < n; ++i) P.submit([&f, i] { f(i); });
+    P.wait_idle();
+}
+
 vector<double> logbinedges(unsigned int nbins, double bmin, double bmax) {
     vector<Double_t> binEdges(nbins+1);
     for(unsigned int i=0; i<=nbins; i++)
@@ -29,6 +96,15 @@ void fill_interp(TH1& h, double x, double w) {
 
 void normalize_to_bin_width(TH1* f, double xscale, const string& ytitle) {
     if(!f) return;
+    TAxis* Ax = f->GetXaxis();
+    vector<double> s(Ax->GetNbins() + 2);
+    for(size_t bx = 0; bx < s.size(); ++bx) s[bx] = 1./Ax->GetBinWidth(bx);
+    if(scaleByXbin(*f, s)) {
+        f->Scale(xscale);
+        if(ytitle.size()) f->GetYaxis()->SetTitle(ytitle.c_str());
+        return;
+    }
+
     Int_t bx,by,bz;
     for(int i=0; i<f->GetNcells(); ++i) {
         f->GetBinXYZ(i,bx,by,bz);
@@ -42,6 +118,10 @@ void normalize_to_bin_width(TH1* f, double xscale, const string& ytitle) {
 }
 
 void addConst(TH1& h, double c) {
+    if(withBinArray(h, [&h, c](auto a) {
+        for(int i = 0; i < h.GetNcells(); ++i) a[i] += c;
+        h.ResetStats();
+    })) return;
     for(int i=0; i<h.GetNcells(); ++i) h.SetBinContent(i, h.GetBinContent(i) + c);
 }
 
@@ -84,6 +164,11 @@ void addProjection(TH2& h, const TH1& hP, double s, bool xaxis) {
 
 void scale_times_bin_center(TH1* f) {
     if(!f) return;
+    TAxis* Ax = f->GetXaxis();
+    vector<double> s(Ax->GetNbins() + 2);
+    for(size_t bx = 0; bx < s.size(); ++bx) s[bx] = sqrt(Ax->GetBinLowEdge(bx)*Ax->GetBinUpEdge(bx));
+    if(scaleByXbin(*f, s)) return;
+
     Int_t bx,by,bz;
     for(int i=0; i<f->GetNcells(); i++) {
         f->GetBinXYZ(i,bx,by,bz);
@@ -97,6 +182,25 @@ void scale_times_bin_center(TH1* f) {
 
 TGraphErrors* histoDeriv(const TH1& h, unsigned int dxi, double s) {
     int nb = h.GetNbinsX();
+    auto Ax = h.GetXaxis();
+    vector<double> x, y, ex, ey, e2;
+    if(withBinArray(h, [&](auto c) {
+        binErr2(h, c, e2);
+        const int nc = h.GetNcells();
+        for(int i=1+dxi/2; i<=nb; i+=dxi) {
+            int i1 = i + dxi;
+            double x0 = Ax->GetBinCenter(i);
+            double x1 = Ax->GetBinCenter(i1);
+            double dx = x1-x0;
+            double c1 = i1 < nc? c[i1] : 0;
+            double v1 = i1 < nc? e2[i1] : 0;
+            x.push_back(0.5*(x0+x1));
+            y.push_back(s*(c1 - c[i])/dx);
+            ey.push_back(sqrt(e2[i] + v1)*s/dx);
+        }
+        ex.resize(x.size());
+    })) return new TGraphErrors(x.size(), x.data(), y.data(), ex.data(), ey.data());
+
     TGraphErrors* g = new TGraphErrors();
     int n = 0;
     for(int i=1+dxi/2; i<=nb; i+=dxi) {
@@ -112,6 +216,21 @@ TGraphErrors* histoDeriv(const TH1& h, unsigned int dxi, double s) {
 }
 
 TGraphErrors* TH1toTGraph(const TH1& h, bool invert) {
+    const int nb = h.GetNbinsX();
+    vector<double> x(nb), y(nb), ey(nb), z(nb), e2;
+    auto Ax = h.GetXaxis();
+    if(withBinArray(h, [&](auto c) {
+        binErr2(h, c, e2);
+        for(int i=0; i<nb; i++) {
+            x[i] = Ax->GetBinCenter(i+1);
+            y[i] = c[i+1];
+            ey[i] = sqrt(e2[i+1]);
+        }
+    })) {
+        if(invert) return new TGraphErrors(nb, y.data(), x.data(), ey.data(), z.data());
+        return new TGraphErrors(nb, x.data(), y.data(), z.data(), ey.data());
+    }
+
     TGraphErrors* g = new TGraphErrors(h.GetNbinsX());
     for(int i=0; i<h.GetNbinsX(); i++) {
         if(invert) {
@@ -180,6 +299,32 @@ TH1* cumulativeHist(const TH1& h, bool normalize, bool reverse) {
     TH1* c = (TH1*)h.Clone((h.GetName()+string("_cum")).c_str());
     int n = h.GetNbinsX();
     float ecum2 = 0;
+
+    vector<double> e2;
+    if(withBinArray(*c, [&](auto a) {
+        binErr2(*c, a, e2); // clone has same contents and errors as h
+        auto w2 = sumw2Array(*c, a);
+        if(reverse) {
+            for(int i=n; i>=0; i--) {
+                a[i] += a[i+1];
+                ecum2 += e2[i];
+                double e = sqrt(ecum2);
+                w2[i] = e*e;
+            }
+        } else {
+            for(int i=1; i<=n+1; i++) {
+                a[i] += a[i-1];
+                ecum2 += e2[i];
+                double e = sqrt(ecum2);
+                w2[i] = e*e;
+            }
+        }
+        c->ResetStats();
+    })) {
+        if(normalize) c->Scale(1.0/c->GetBinContent(reverse?1:n));
+        return c;
+    }
+
     if(reverse) {
         //c->SetBinContent(n+1,0);
         //c->SetBinError(n+1,0);
@@ -202,15 +347,7 @@ TH1* cumulativeHist(const TH1& h, bool normalize, bool reverse) {
     return c;
 }
 
-TGraph invertGraph(const TGraph& g) {
-    TGraph gi(g.GetN());
-    double x,y;
-    for(int i=0; i<g.GetN(); i++) {
-        g.GetPoint(i,x,y);
-        gi.SetPoint(i,y,x);
-    }
-    return gi;
-}
+TGraph invertGraph(const TGraph& g) { return TGraph(g.GetN(), g.GetY(), g.GetX()); }
 
 TGraph* combine_graphs(const vector<TGraph*>& gs) {
     unsigned int npts = 0;
@@ -333,37 +470,31 @@ TGraph* matchHistoShapes(const TH1F& h1, const TH1F& h2) {
 }
 
 void scale(TGraphErrors& tg, float s, bool xaxis) {
-    double x,y;
-    for(int i=0; i<tg.GetN(); i++) {
-        tg.GetPoint(i,x,y);
-        if(xaxis) {
-            tg.SetPoint(i, x*s, y);
-            tg.SetPointError(i, tg.GetErrorX(i)*s, tg.GetErrorY(i));
-    } else {
-            tg.SetPoint(i, x, s*y);
-            tg.SetPointError(i, tg.GetErrorX(i), s*tg.GetErrorY(i));
-        }
-    }
+    const int n = tg.GetN();
+    double* v = xaxis? tg.GetX() : tg.GetY();
+    double* e = xaxis? tg.GetEX() : tg.GetEY();
+    for(int i = 0; i < n; ++i) v[i] *= s;
+    for(int i = 0; i < n; ++i) e[i] *= s;
 }
 
 void shift(TGraph& g, double dx, double dy) {
-    double x,y;
-    for(int i=0; i<g.GetN(); i++) {
-        g.GetPoint(i,x,y);
-        g.SetPoint(i, x+dx, y+dy);
-    }
+    const int n = g.GetN();
+    double* x = g.GetX();
+    double* y = g.GetY();
+    for(int i = 0; i < n; ++i) x[i] += dx;
+    for(int i = 0; i < n; ++i) y[i] += dy;
 }
 
 TGraph* derivative(TGraph& g) {
     g.Sort();
     TGraph* d = new TGraph(g.GetN()-1);
-    double x1,y1,x2,y2;
-    g.GetPoint(0,x1,y1);
+    const double* x = g.GetX();
+    const double* y = g.GetY();
+    double* dx = d->GetX();
+    double* dy = d->GetY();
     for(int i=0; i<g.GetN()-1; i++) {
-        g.GetPoint(i+1,x2,y2);
-        d->SetPoint(i,0.5*(x1+x2),(y2-y1)/(x2-x1));
-        x1 = x2;
-        y1 = y2;
+        dx[i] = 0.5*(x[i]+x[i+1]);
+        dy[i] = (y[i+1]-y[i])/(x[i+1]-x[i]);
     }
     return d;
 }
@@ -616,3 +747,17 @@ TGraph derivative_logspaced(const TGraph& g, double x0, double x1, double ysc, s
     }
     return dg;
 }
+
+vector<TGraphErrors*> TH1toTGraph(const vector<const TH1*>& hs, bool invert, int nthreads) {
+    vector<TGraphErrors*> gs(hs.size());
+    applyParallel(hs.size(), [&](size_t i) { if(hs[i]) gs[i] = TH1toTGraph(*hs[i], invert); }, nthreads);
+    return gs;
+}
+
+void normalize_to_bin_width(const vector<TH1*>& hs, double xscale, int nthreads) {
+    applyParallel(hs.size(), [&](size_t i) { normalize_to_bin_width(hs[i], xscale); }, nthreads);
+}
+
+void scale(const vector<TGraphErrors*>& gs, float s, bool xaxis, int nthreads) {
+    applyParallel(gs.size(), [&](size_t i) { if(gs[i]) scale(*gs[i], s, xaxis); }, nthreads);
+}
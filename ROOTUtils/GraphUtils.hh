@@ -18,6 +18,15 @@
 using std::vector;
 #include <string>
 using std::string;
+#include <functional>
+
+/// run f(i) for i in [0,n) in parallel over nthreads (0 for hardware concurrency), for independent per-object transforms
+void applyParallel(size_t n, const std::function<void(size_t)>& f, int nthreads = 0);
+/// apply f to each (non-null) object in parallel
+template<class T>
+void applyParallel(const vector<T*>& v, const std::function<void(T&)>& f, int nthreads = 0) {
+    applyParallel(v.size(), [&v, &f](size_t i) { if(v[i]) f(*v[i]); }, nthreads);
+}
 
 /// bin edges for log histograms
 vector<double> logbinedges(unsigned int nbins, double bmin, double bmax);
@@ -46,6 +55,8 @@ void fill_interp(TH1& h, double x, double w = 1.0);
 
 /// convert a histogram to a TGraph, optionally swapping x/y
 TGraphErrors* TH1toTGraph(const TH1& h, bool invert = false);
+/// convert many histograms to TGraphs in parallel
+vector<TGraphErrors*> TH1toTGraph(const vector<const TH1*>& hs, bool invert = false, int nthreads = 0);
 
 /// convert a TProfile to a TGraph
 TGraphErrors* TProf2TGraph(const TProfile& P, unsigned int minpts = 0);
@@ -58,6 +69,8 @@ double hcount_from_end(const TH1& h, double c);
 
 /// Divide out histogram bin width, for differential spectrum (with optional extra scale factor)
 void normalize_to_bin_width(TH1* f, double xscale = 1., const string& ytitle = "");
+/// Divide out bin width for many histograms in parallel
+void normalize_to_bin_width(const vector<TH1*>& hs, double xscale = 1., int nthreads = 0);
 /// Divide out 2D histogram bin area (with optional extra scale factor)
 void normalize_to_bin_area(TH2* h, double xscale = 1.);
 
@@ -81,6 +94,8 @@ TGraph* matchHistoShapes(const TH1F& h1, const TH1F& h2);
 
 /// scale a TGraphErrors, on y (default) or x axis
 void scale(TGraphErrors& tg, float s, bool xaxis=false);
+/// scale many TGraphErrors in parallel
+void scale(const vector<TGraphErrors*>& gs, float s, bool xaxis = false, int nthreads = 0);
 
 /// shift all TGraph points
 void shift(TGraph& g, double dx, double dy);
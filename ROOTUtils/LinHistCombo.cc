@@ -25,6 +25,9 @@
 
 #include "LinHistCombo.hh"
 #include "StringManip.hh"
+#include "WorkStealingPool.hh"
+#include <cmath>
+#include <stdexcept>
 
 unsigned int LinHistCombo::nFitters = 0;
 
@@ -80,3 +83,71 @@ void LinHistCombo::forceNonNegative() {
     for(unsigned int i=0; i<terms.size(); i++)
         myFit->SetParLimits(i,0,100);
 }
+
+void LinHistCombo::prepareBatch(const TH1& proto, double xmin, double xmax, const vector<double>& w) {
+    if(!terms.size()) throw std::logic_error("LinHistCombo batch fit without terms");
+    batchBins.clear();
+    batchSqrtW.clear();
+    auto A = proto.GetXaxis();
+    for(int b = std::max(1, A->FindBin(xmin)); b <= std::min(A->GetNbins(), A->FindBin(xmax)); ++b) {
+        auto c = A->GetBinCenter(b);
+        if(c < xmin || c > xmax) continue;
+        double ww = w.size()? w.at(batchBins.size()) : 1.;
+        if(!(ww > 0)) continue;
+        batchBins.push_back(b);
+        batchSqrtW.push_back(sqrt(ww));
+    }
+    if(batchBins.size() < terms.size()) throw std::runtime_error("LinHistCombo batch fit underdetermined");
+
+    delete batchLM;
+    batchLM = new LinMin(terms.size(), batchBins.size());
+    vector<double> p(terms.size());
+    for(size_t i = 0; i < batchBins.size(); ++i) {
+        double x = A->GetBinCenter(batchBins[i]);
+        for(size_t j = 0; j < terms.size(); ++j) {
+            std::fill(p.begin(), p.end(), 0.);
+            p[j] = 1;
+            batchLM->setM(i, j, batchSqrtW[i]*Evaluate(&x, p.data()));
+        }
+    }
+    batchLM->factor();
+
+    auto& C = batchLM->calcCov();
+    batchCovDiag.resize(terms.size());
+    for(size_t j = 0; j < terms.size(); ++j) batchCovDiag[j] = C(j,j);
+}
+
+vector<vector<double>> LinHistCombo::FitBatch(const vector<const TH1*>& targets, int nthreads, vector<vector<double>>* errs) const {
+    if(!batchLM) throw std::logic_error("LinHistCombo::FitBatch requires prepareBatch");
+    const size_t nv = terms.size(), ne = batchBins.size();
+    vector<vector<double>> res(targets.size());
+    if(errs) errs->assign(targets.size(), vector<double>());
+
+    // solve blocks of targets per task as multi-RHS matrix solves, each with own workspace
+    const size_t nblock = 16;
+    WorkStealingPool P(nthreads);
+    for(size_t i0 = 0; i0 < targets.size(); i0 += nblock) {
+        P.submit([&, i0] {
+            const size_t nb = std::min(targets.size(), i0 + nblock) - i0;
+            gsl_matrix_wrapper Y(ne, nb), X(nv, nb), R(ne, nb);
+            for(size_t b = 0; b < nb; ++b)
+                for(size_t k = 0; k < ne; ++k) Y(k,b) = batchSqrtW[k]*targets[i0 + b]->GetBinContent(batchBins[k]);
+            batchLM->solveMulti(Y, X, errs? static_cast<gsl_matrix*>(R) : nullptr);
+            for(size_t b = 0; b < nb; ++b) {
+                const size_t i = i0 + b;
+                res[i].resize(nv);
+                for(size_t j = 0; j < nv; ++j) res[i][j] = X(j,b);
+                if(!errs) continue;
+                // errors scaled by residual variance estimate (as for unit-weight fit), or by fixed weights if supplied
+                double ssr = 0;
+                for(size_t k = 0; k < ne; ++k) ssr += R(k,b)*R(k,b);
+                double s2 = ne > nv? ssr/(ne - nv) : 0;
+                auto& e = (*errs)[i];
+                e.resize(nv);
+                for(size_t j = 0; j < nv; ++j) e[j] = sqrt(batchCovDiag[j]*s2);
+            }
+        });
+    }
+    P.wait_idle();
+    return res;
+}
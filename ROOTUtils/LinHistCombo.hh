@@ -30,6 +30,7 @@
 #include <string>
 #include <TH1.h>
 #include <TF1.h>
+#include "LinMin.hh"
 
 using std::string;
 using std::vector;
@@ -40,7 +41,7 @@ public:
     /// constructor
     LinHistCombo(): interpolate(true), myFit(nullptr) {}
     /// destructor
-    ~LinHistCombo() { delete myFit; }
+    ~LinHistCombo() { delete myFit; delete batchLM; }
     /// add a fit term
     void addTerm(TH1* h) { terms.push_back(h); }
     /// get fitter
@@ -50,6 +51,11 @@ public:
     /// require coefficients to be non-negative
     void forceNonNegative();
 
+    /// factor (once) least-squares design matrix of terms over target-binning prototype bins in [xmin,xmax], with optional fixed per-bin weights
+    void prepareBatch(const TH1& proto, double xmin, double xmax, const vector<double>& w = {});
+    /// solve cached least-squares problem for many targets (binned as prototype) in parallel; return coefficients, optionally errors, per target
+    vector<vector<double>> FitBatch(const vector<const TH1*>& targets, int nthreads = 0, vector<vector<double>>* errs = nullptr) const;
+
     vector<double> coeffs;      ///< fit coefficients
     vector<double> dcoeffs;     ///< fit coefficient errors
     bool interpolate;           ///< whether to interpolate between bins
@@ -62,6 +68,11 @@ public:
 protected:
     TF1* myFit;                         ///< fit function
     vector<TH1*> terms;                 ///< fit terms
+
+    LinMin* batchLM = nullptr;          ///< factored batch design matrix
+    vector<int> batchBins;              ///< target bins for batch fits
+    vector<double> batchSqrtW;          ///< sqrt weights for batch bins
+    vector<double> batchCovDiag;        ///< unnormalized covariance diagonal for batch coefficients
     static unsigned int nFitters;       ///< naming counter
 };
 
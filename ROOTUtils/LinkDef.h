@@ -6,6 +6,9 @@
 #pragma link C++ class TCumulative+;
 #pragma link C++ class TCumulativeMap<Int_t, Double_t>+;
 #pragma link C++ class TCumulativeMap<string, Double_t>+;
-#pragma link C++ class TDynamicHistogram+;
+#pragma link C++ class TCumulativeFlatMap<Int_t, Double_t>+;
+#pragma link C++ class TCumulativeFlatMap<string, Double_t>+;
+// custom Streamer (same format), folding transient dense storage
+#pragma link C++ class TDynamicHistogram-;
 
 #endif
@@ -2,15 +2,111 @@
 
 #include "MultiFill.hh"
 #include <TAxis.h>
+#include <TMatrixDSparse.h>
 #include <numeric> // for std::iota
 
-MultiFill::MultiFill(const string& _name, TH1& H):
-CumulativeData(_name), h(&H), M(new TMatrixD(H.GetNcells(), H.GetNcells())) { }
+MultiFill::MultiFill(const string& _name, TH1& H, bool sp):
+CumulativeData(_name), h(&H), sparse(sp) { if(!sp) M = newDense(H.GetNcells()); }
+
+TMatrixD* MultiFill::newDense(int n) {
+    Mdata.assign(size_t(n)*n, 0.);
+    auto m = new TMatrixD();
+    m->Use(n, n, Mdata.data());
+    return m;
+}
 
 MultiFill::MultiFill(const string& _name, TDirectory& d, TH1& H):
-CumulativeData(_name), h(&H),
-M(dynamic_cast<TMatrixD*>(d.Get((name + "_Cov").c_str()))) {
-    if(!M) throw std::runtime_error("Missing MultiFill covariance '"+name+"_Cov'");
+CumulativeData(_name), h(&H) {
+    auto o = d.Get((name + "_Cov").c_str());
+    M = dynamic_cast<TMatrixD*>(o);
+    if(M) return;
+
+    auto SM = dynamic_cast<TMatrixDSparse*>(o);
+    if(!SM) {
+        delete o;
+        throw std::runtime_error("Missing MultiFill covariance '"+name+"_Cov'");
+    }
+    sparse = true;
+    auto r = SM->GetRowIndexArray();
+    auto c = SM->GetColIndexArray();
+    auto x = SM->GetMatrixArray();
+    S.reserve(SM->NonZeros());
+    for(Int_t i = 0; i < SM->GetNrows(); ++i)
+        for(Int_t k = r[i]; k < r[i+1]; ++k) S[key(i, c[k])] += x[k];
+    delete SM;
+}
+
+double MultiFill::cov(int i, int j) const {
+    if(!sparse) return (*M)(i,j);
+    auto it = S.find(key(i,j));
+    return it == S.end()? 0 : it->second;
+}
+
+size_t MultiFill::nNonZero() const {
+    if(sparse) return S.size();
+    size_t n = 0;
+    for(Int_t i = 0; i < M->GetNrows(); ++i)
+        for(Int_t j = i; j < M->GetNcols(); ++j) n += (*M)(i,j) != 0;
+    return n;
+}
+
+void MultiFill::Scale(double s) {
+    if(!sparse) { *M *= s*s; return; }
+    for(auto& kv: S) kv.second *= s*s;
+}
+
+void MultiFill::Add(const CumulativeData& CD, double s) {
+    auto& MF = dynamic_cast<const MultiFill&>(CD);
+    checkInit();
+    const double ss = s*s;
+
+    if(MF.sparse) {
+        for(auto& kv: MF.S) {
+            if(sparse) { S[kv.first] += ss * kv.second; continue; }
+            int i = kv.first >> 32, j = uint32_t(kv.first);
+            (*M)(i,j) += ss * kv.second;
+            if(i != j) (*M)(j,i) += ss * kv.second;
+        }
+        return;
+    }
+
+    if(!MF.M) throw std::runtime_error("Uninitialized MultiFill covariance addition");
+    if(sparse) {
+        for(Int_t i = 0; i < MF.M->GetNrows(); ++i) {
+            for(Int_t j = i; j < MF.M->GetNcols(); ++j) {
+                auto x = (*MF.M)(i,j);
+                if(x) S[key(i,j)] += ss * x;
+            }
+        }
+        return;
+    }
+
+    if(MF.M->GetNoElements() != M->GetNoElements()) throw std::runtime_error("Mismatched MultiFill covariance dimensions");
+    double* __restrict__ a = M->GetMatrixArray();
+    const double* __restrict__ b = MF.M->GetMatrixArray();
+    const Int_t n = M->GetNoElements();
+    for(Int_t i = 0; i < n; ++i) a[i] += ss * b[i];
+}
+
+void MultiFill::Write() {
+    checkInit();
+    if(!sparse) { M->Write((name+"_Cov").c_str()); return; }
+
+    // sorted (row, col) CSR upper triangle
+    vector<pair<uint64_t, double>> v(S.begin(), S.end());
+    std::sort(v.begin(), v.end());
+    vector<Int_t> r, c;
+    vector<Double_t> x;
+    for(auto& kv: v) {
+        if(!kv.second) continue;
+        r.push_back(kv.first >> 32);
+        c.push_back(uint32_t(kv.first));
+        x.push_back(kv.second);
+    }
+    auto nc = h->GetNcells();
+    TMatrixDSparse SM(nc, nc);
+    if(x.size()) SM.SetMatrixArray(x.size(), r.data(), c.data(), x.data());
+    SM.Write((name+"_Cov").c_str());
 }
 
 double MultiFill::binSum(int b0, int b1, double& err, bool width) const {
@@ -25,38 +121,38 @@ void MultiFill::normalize_to_bin_width(double xscale, const string& ytitle) {
     checkInit();
     if(xscale != 1.) Scaleh(xscale);
 
-    Int_t bx1,bx2,by,bz;
+    Int_t bx,by,bz;
     TAxis* A = h->GetXaxis();
 
+    vector<double> sw(h->GetNcells());
     for(int i=0; i<h->GetNcells(); ++i) {
-        h->GetBinXYZ(i, bx1, by, bz);
-        double s1 = (bx1 > 0 && bx1 <= A->GetNbins())? 1./A->GetBinWidth(bx1) : 1;
-        h->SetBinContent(i, h->GetBinContent(i)*s1);
-        h->SetBinError(i, h->GetBinError(i)*s1);
-
-        for(int j=0; j<h->GetNcells(); ++j) {
-            h->GetBinXYZ(j,bx2,by,bz);
-            double s2 = (bx2 > 0 && bx2 <= A->GetNbins())? 1./A->GetBinWidth(bx2) : 1;
-            (*M)(i,j) *= s1*s2;
-        }
+        h->GetBinXYZ(i, bx, by, bz);
+        sw[i] = (bx > 0 && bx <= A->GetNbins())? 1./A->GetBinWidth(bx) : 1;
+        h->SetBinContent(i, h->GetBinContent(i)*sw[i]);
+        h->SetBinError(i, h->GetBinError(i)*sw[i]);
     }
 
+    if(sparse) for(auto& kv: S) kv.second *= sw[kv.first >> 32] * sw[uint32_t(kv.first)];
+    else for(int i=0; i<h->GetNcells(); ++i) for(int j=0; j<h->GetNcells(); ++j) (*M)(i,j) *= sw[i]*sw[j];
+
     if(ytitle.size()) h->GetYaxis()->SetTitle(ytitle.c_str());
 }
 
 void MultiFill::diagErrors() {
     checkInit();
-    for(int i=0; i<h->GetNcells(); ++i) h->SetBinError(i, sqrt((*M)(i,i)));
+    for(int i=0; i<h->GetNcells(); ++i) h->SetBinError(i, sqrt(cov(i,i)));
 }
 
 void MultiFill::diagCov() {
     if(!h) throw std::logic_error("Undefined input histogram");
-    if(!M) M = new TMatrixD(h->GetNcells(), h->GetNcells());
+    if(sparse) S.clear();
+    else if(!M) M = newDense(h->GetNcells());
     else (*M) *= 0;
 
     for(int i=0; i<h->GetNcells(); ++i) {
         auto e = h->GetBinError(i);
-        (*M)(i,i) = e*e;
+        if(sparse) { if(e) S[key(i,i)] = e*e; }
+        else (*M)(i,i) = e*e;
     }
 }
 
@@ -85,9 +181,17 @@ TH2F* MultiFill::covHist() const {
 
     hh->GetZaxis()->SetTitle("Covariance");
 
-    for(int i=0; i<nc; ++i) {
-        for(int j=0; j<nc; ++j) {
-            hh->SetBinContent(hh->GetBin(i + !is1D, j + !is1D), (*M)(i,j));
+    if(sparse) {
+        for(auto& kv: S) {
+            int i = kv.first >> 32, j = uint32_t(kv.first);
+            hh->SetBinContent(hh->GetBin(i + !is1D, j + !is1D), kv.second);
+            hh->SetBinContent(hh->GetBin(j + !is1D, i + !is1D), kv.second);
+        }
+    } else {
+        for(int i=0; i<nc; ++i) {
+            for(int j=0; j<nc; ++j) {
+                hh->SetBinContent(hh->GetBin(i + !is1D, j + !is1D), (*M)(i,j));
+            }
         }
     }
 
@@ -6,6 +6,7 @@
 
 #include "CumulativeData.hh"
 #include "NoCopy.hh"
+#include "HugePages.hh"
 
 #include <TDirectory.h>
 #include <TH1.h>
@@ -15,23 +16,41 @@
 #include <stdexcept>
 #include <cmath>
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
 using std::vector;
+using std::pair;
 
 /// Covariance matrix paired to histogram for correlated-bin fills
+/// dense: NxN TMatrixD M; sparse: hashed upper-triangle S, stored as TMatrixDSparse (CSR)
 class MultiFill: public CumulativeData, protected NoCopy {
 public:
     /// Default constructor -- set M, h externally
     MultiFill() { }
-    /// Constructor, corresponding to histogram
-    MultiFill(const string& _name, TH1& H);
-    /// Constructor, loaded from file
+    /// Constructor, corresponding to histogram; optionally with sparse covariance
+    MultiFill(const string& _name, TH1& H, bool sparse = false);
+    /// Constructor, loaded from file (sparse if stored sparse)
     MultiFill(const string& _name, TDirectory& d, TH1& H);
     /// Destructor
     ~MultiFill() { delete M; }
 
+    /// upper-triangle sparse covariance, by key(i,j) for i <= j
+    typedef std::unordered_map<uint64_t, double> sparsecov_t;
+    /// (bin, multiplicity) list
+    typedef vector<pair<int,int>> binlist_t;
+
     /// (unity weights) fill by bin numbers
     template<class V>
     void fillBins(const V& vb) {
+        if(sparse) {
+            uniqueBins(vb, bl);
+            for(size_t i = 0; i < bl.size(); ++i) {
+                h->AddBinContent(bl[i].first, bl[i].second);
+                for(size_t j = i; j < bl.size(); ++j) S[key(bl[i].first, bl[j].first)] += bl[i].second * bl[j].second;
+            }
+            return;
+        }
         for(auto b1: vb) {
             h->AddBinContent(b1);
             for(auto b2: vb) ++(*M)(b1, b2);
@@ -52,6 +71,23 @@ public:
         checkInit();
         err = 0;
         double s = 0;
+        if(sparse) {
+            binlist_t u;
+            uniqueBins(v, u);
+            vector<double> w(u.size());
+            for(size_t i = 0; i < u.size(); ++i) {
+                w[i] = u[i].second * (width? h->GetBinWidth(u[i].first) : 1.);
+                s += w[i] * h->GetBinContent(u[i].first);
+            }
+            for(size_t i = 0; i < u.size(); ++i) {
+                for(size_t j = i; j < u.size(); ++j) {
+                    auto it = S.find(key(u[i].first, u[j].first));
+                    if(it != S.end()) err += (i == j? 1 : 2) * w[i] * w[j] * it->second;
+                }
+            }
+            err = sqrt(err);
+            return s;
+        }
         for(auto& b1: v) {
             double w1 = width? h->GetBinWidth(b1) : 1.;
             s += w1 * h->GetBinContent(b1);
@@ -67,16 +103,23 @@ public:
     /// bin range sum over [b0,b1)
     double binSum(int b0, int b1, double& err, bool width=false) const;
 
+    /// covariance element (either storage)
+    double cov(int i, int j) const;
+    /// whether using sparse covariance storage
+    bool isSparse() const { return sparse; }
+    /// number of stored (upper-triangle) non-zero covariance elements
+    size_t nNonZero() const;
+
     /// scaling of M only --- assumes h is managed externally
-    void Scale(double s) override { *M *= s*s; }
+    void Scale(double s) override;
     /// scaling, including h
     void Scaleh(double s) { Scale(s); h->Scale(s); }
-    /// addition of M only --- assumes h is managed externally
-    void Add(const CumulativeData& CD, double s = 1.) override { *M += *dynamic_cast<const MultiFill&>(CD).M * (s * s); }
+    /// addition of M only --- assumes h is managed externally; in-place (no temporary matrix), vectorizable loop
+    void Add(const CumulativeData& CD, double s = 1.) override;
     /// addition including h
     void Addh(const CumulativeData& CD, double s = 1.) { Add(CD,s); h->Add(dynamic_cast<const MultiFill&>(CD).h, s); }
-    /// Store state (M only)
-    void Write() override { checkInit(); M->Write((name+"_Cov").c_str()); }
+    /// Store state (M only; CSR TMatrixDSparse upper triangle if sparse)
+    void Write() override;
     /// divide bins by width (optional additional scaling)
     void normalize_to_bin_width(double xscale = 1., const string& ytitle = "");
     /// Overwrite histogram errorbars from covariance diagonal
@@ -87,11 +130,36 @@ public:
     TH2F* covHist() const;
 
     TH1* h = nullptr;       ///< the histogram (assumed to be managed externally)
-    TMatrixD* M = nullptr;  ///< covariance matrix (owned by this)
+    TMatrixD* M = nullptr;  ///< dense covariance matrix (owned by this; nullptr if sparse; on Mdata unless loaded from file)
+    sparsecov_t S;          ///< sparse upper-triangle covariance
 
 protected:
     /// initialization/usability check
-    virtual void checkInit() const { if(!h || !M) throw std::logic_error("MultiFill uninitialized"); };
+    virtual void checkInit() const { if(!h || (!sparse && !M)) throw std::logic_error("MultiFill uninitialized"); };
+    /// zeroed n x n dense matrix, on Mdata storage
+    TMatrixD* newDense(int n);
+
+    hugepage_vector<double> Mdata{HugePageAllocator<double>("MultiFill")};  ///< dense covariance storage for M, by "MultiFill" HugePagePolicy
+
+    /// sparse storage key for (i,j) element
+    static uint64_t key(int i, int j) {
+        if(j < i) std::swap(i, j);
+        return (uint64_t(uint32_t(i)) << 32) | uint32_t(j);
+    }
+    /// sorted unique bins with multiplicities
+    template<class V>
+    static void uniqueBins(const V& vb, binlist_t& u) {
+        vector<int> b(vb.begin(), vb.end());
+        std::sort(b.begin(), b.end());
+        u.clear();
+        for(auto i: b) {
+            if(u.size() && u.back().first == i) ++u.back().second;
+            else u.emplace_back(i, 1);
+        }
+    }
+
+    bool sparse = false;    ///< whether using sparse covariance storage S
+    binlist_t bl;           ///< per-event unique bins buffer
 };
 
 #endif
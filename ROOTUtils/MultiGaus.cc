@@ -24,6 +24,7 @@
  */
 
 #include "MultiGaus.hh"
+#include <algorithm>
 
 MultiGaus::~MultiGaus() { delete myTF1; }
 
@@ -131,6 +132,22 @@ double MultiGaus::operator() (double* x, double* par) {
     return s;
 }
 
+void MultiGaus::eval(const double* x, double* y, size_t n, const double* par) const {
+    std::fill(y, y + n, 0.);
+    auto addPeak = [x, y, n](double h, double c, double s2) {
+        const double k = -1./(2*s2);
+        for(size_t j = 0; j < n; ++j) {
+            const double d = x[j] - c;
+            y[j] += h*exp(k*d*d);
+        }
+    };
+    for(unsigned int i=0; i<npks; i++) addPeak(par[3*i], par[3*i+1], par[3*i+2]*par[3*i+2]);
+    for(auto const& pk: corrPeaks) {
+        unsigned int i = pk.mainPeak;
+        addPeak(par[3*i]*pk.relHeight, par[3*i+1]*pk.relCenter, par[3*i+2]*par[3*i+2]*pk.relWidth);
+    }
+}
+
 int iterGaus(TH1* h0, TF1* gf, unsigned int nit, float mu, float sigma, float nsigma, float asym) {
     int err = h0->Fit(gf,"Q","",mu-(nsigma-asym)*sigma,mu+(nsigma+asym)*sigma);
     if(!err && !nit)
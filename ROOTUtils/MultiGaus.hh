@@ -79,6 +79,8 @@ public:
 
     /// gaussian evaluation function
     double operator() (double* x, double* par);
+    /// batched evaluation y[n] at x[n] with parameters par (without fit-range point rejection); vectorizable over points
+    void eval(const double* x, double* y, size_t n, const double* par) const;
 
     float nSigma;               ///< number of sigma peak width to fit
 
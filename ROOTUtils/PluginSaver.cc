@@ -2,7 +2,14 @@
 // -- Michael P. Mendenhall, 2019
 
 #include "PluginSaver.hh"
+#include "GlobalArgs.hh"
+#include "WorkStealingPool.hh"
 #include "to_str.hh"
+#include <TROOT.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
 
 PluginSaver::PluginSaver(OutputManager* pnt, const Setting& S, const string& nm, const string& inflName):
 SegmentSaver(pnt, nm, inflName) {
@@ -26,6 +33,11 @@ void PluginSaver::buildPlugin(const string& pname, int& copynum, const Setting&
     string rn0 = _rename;
     cfg.lookupValue("rename",_rename);
     o->rename(_rename);
+    if(cfg.exists("depends")) {
+        auto& d = cfg["depends"];
+        if(d.isArray() || d.isList()) for(auto& dd: d) o->dependsOn.push_back((const char*)dd);
+        else o->dependsOn.push_back((const char*)d);
+    }
     byName[_rename] = o;
     myPlugins.push_back(o);
     if(rn0 == _rename) ++copynum;
@@ -43,6 +55,8 @@ void PluginSaver::init() {
 
 void PluginSaver::Configure(const Setting& S, bool skipUnknown) {
     if(myPlugins.size()) throw std::runtime_error("Multiple calls to PluginSaver::Configure");
+    S.lookupValue("nthreads", nThreads);
+    optionalGlobalArg("plugin_threads", nThreads, "number of threads for parallel plugin analysis");
 
     // configure plugins
     if(S.exists("plugins")) {
@@ -56,8 +70,74 @@ void PluginSaver::Configure(const Setting& S, bool skipUnknown) {
         }
     }
 
-    std::sort(myPlugins.begin(), myPlugins.end(),
+    std::stable_sort(myPlugins.begin(), myPlugins.end(),
               [](SegmentSaver* a, SegmentSaver* b) { return a->order < b->order; });
+    sortDependencies();
+}
+
+void PluginSaver::sortDependencies() {
+    // dependencies by name
+    map<SegmentSaver*, vector<SegmentSaver*>> deps;
+    for(auto P: myPlugins) {
+        for(auto& d: P->dependsOn) {
+            auto D = getPlugin(d);
+            if(!D) throw std::runtime_error("Plugin '" + P->path + "' depends on missing plugin '" + d + "'");
+            if(D != P) deps[P].push_back(D);
+        }
+    }
+
+    // stable topological order: repeatedly take first plugin with all dependencies placed
+    vector<SegmentSaver*> sorted;
+    set<SegmentSaver*> placed;
+    while(sorted.size() < myPlugins.size()) {
+        auto it = std::find_if(myPlugins.begin(), myPlugins.end(), [&](SegmentSaver* P) {
+            if(placed.count(P)) return false;
+            for(auto D: deps[P]) if(!placed.count(D)) return false;
+            return true;
+        });
+        if(it == myPlugins.end()) throw std::runtime_error("Circular plugin dependencies");
+        sorted.push_back(*it);
+        placed.insert(*it);
+    }
+    myPlugins = sorted;
+
+    map<SegmentSaver*, size_t> idx;
+    for(size_t i = 0; i < myPlugins.size(); ++i) idx[myPlugins[i]] = i;
+    dependents.assign(myPlugins.size(), {});
+    nDepends.assign(myPlugins.size(), 0);
+    for(auto& kv: deps) {
+        set<SegmentSaver*> u(kv.second.begin(), kv.second.end());
+        for(auto D: u) dependents[idx[D]].push_back(idx[kv.first]);
+        nDepends[idx[kv.first]] = u.size();
+    }
+}
+
+void PluginSaver::runPlugins(const std::function<void(SegmentSaver&)>& f) {
+    if(nThreads <= 1 || myPlugins.size() < 2) {
+        for(auto P: myPlugins) f(*P);
+        return;
+    }
+
+    ROOT::EnableThreadSafety();
+    vector<std::atomic<size_t>> nwait(myPlugins.size());
+    for(size_t i = 0; i < myPlugins.size(); ++i) nwait[i] = nDepends[i];
+    std::exception_ptr err;
+    std::mutex errMut;
+
+    WorkStealingPool WP(nThreads);
+    std::function<void(size_t)> run = [&](size_t i) {
+        try { f(*myPlugins[i]); }
+        catch(...) {
+            // dependents of failed plugin are not run
+            std::lock_guard<std::mutex> l(errMut);
+            if(!err) err = std::current_exception();
+            return;
+        }
+        for(auto j: dependents[i]) if(!--nwait[j]) WP.submit([&run, j] { run(j); });
+    };
+    for(size_t i = 0; i < myPlugins.size(); ++i) if(!nDepends[i]) WP.submit([&run, i] { run(i); });
+    WP.wait_idle();
+    if(err) std::rethrow_exception(err);
 }
 
 map<string,float> PluginSaver::compareKolmogorov(const SegmentSaver& S) const {
@@ -107,7 +187,7 @@ void PluginSaver::normalize() {
 }
 
 void PluginSaver::addSegment(const SegmentSaver& S, double sc) {
-    SegmentSaver::addSegment(S);
+    SegmentSaver::addSegment(S, sc);
     auto& PS = dynamic_cast<const PluginSaver&>(S);
     for(auto P: myPlugins) {
         auto Si = PS.getPlugin(P->path);
@@ -128,12 +208,12 @@ void PluginSaver::checkpoint(const SegmentSaver& Sprev) {
 void PluginSaver::makePlots() {
     defaultCanvas.cd();
     SegmentSaver::makePlots();
-    for(auto P: myPlugins) {
+    runPlugins([](SegmentSaver& P) {
         auto t0 = steady_clock::now();
-        P->defaultCanvas.cd();
-        P->makePlots();
-        P->tPlot += std::chrono::duration<double>(steady_clock::now()-t0).count();
-    }
+        P.defaultCanvas.cd();
+        P.makePlots();
+        P.tPlot += std::chrono::duration<double>(steady_clock::now()-t0).count();
+    });
 }
 
 void PluginSaver::startData() {
@@ -163,25 +243,25 @@ void PluginSaver::compare(const vector<SegmentSaver*>& v) {
     vector<PluginSaver*> vP;
     for(auto SS: v) vP.push_back(dynamic_cast<PluginSaver*>(SS));
 
-    for(auto P: myPlugins) {
+    runPlugins([&vP](SegmentSaver& P) {
         vector<SegmentSaver*> vPi;
         for(auto PS: vP) {
             if(!PS) vPi.push_back(nullptr);
-            else vPi.push_back(PS->getPlugin(P->path));
+            else vPi.push_back(PS->getPlugin(P.path));
         }
-        P->defaultCanvas.cd();
-        P->compare(vPi);
-    }
+        P.defaultCanvas.cd();
+        P.compare(vPi);
+    });
 }
 
 void PluginSaver::calculateResults() {
     SegmentSaver::calculateResults();
-    for(auto P: myPlugins) {
+    runPlugins([](SegmentSaver& P) {
         auto t0 = steady_clock::now();
-        printf("\n## PLUGIN %s CalculateResults ##\n\n", P->path.c_str());
-        P->calculateResults();
-        P->tCalc += std::chrono::duration<double>(steady_clock::now()-t0).count();
-    }
+        printf("\n## PLUGIN %s CalculateResults ##\n\n", P.path.c_str());
+        P.calculateResults();
+        P.tCalc += std::chrono::duration<double>(steady_clock::now()-t0).count();
+    });
 }
 
 double PluginSaver::displayTimeUse() const {
@@ -7,6 +7,7 @@
 #include "SegmentSaver.hh"
 #include "ObjectFactory.hh"
 #include <chrono>
+#include <functional>
 using std::chrono::steady_clock;
 #include "libconfig_readerr.hh"
 
@@ -53,6 +54,11 @@ public:
     /// statistical test of histogram similarity
     map<string,float> compareKolmogorov(const SegmentSaver& S) const override;
 
+    /// run step on each plugin in dependency order; in parallel over nThreads if > 1
+    void runPlugins(const std::function<void(SegmentSaver&)>& f);
+
+    int nThreads = 1;   ///< number of threads for plugin calculateResults, makePlots, compare
+
     /// display plugin run time profiling; return total accounted-for time
     double displayTimeUse() const;
 
@@ -67,10 +73,14 @@ protected:
 
     /// load and configure plugin by class name
     void buildPlugin(const string& pname, int& copynum, const Setting& cfg, bool skipUnknown);
+    /// resolve plugin dependencies; stable reordering of myPlugins to satisfy them
+    void sortDependencies();
 
     decltype(steady_clock::now()) ana_t0;   ///< analysis start time
     map<string, SegmentSaver*> byName;      ///< available named plugins list
     vector<SegmentSaver*> myPlugins;        ///< plugins in run order
+    vector<vector<size_t>> dependents;      ///< indices of plugins depending on each plugin
+    vector<size_t> nDepends;                ///< number of dependencies for each plugin
 };
 
 /// Base class for constructing configuration-based plugins, with parent-class recast
@@ -79,7 +89,7 @@ class ConfigPluginBuilder: public _ArgsBaseFactory<SegmentSaver, SegmentSaver&,
 public:
     /// Constructor, registering to list
     explicit ConfigPluginBuilder(const string& cname): _ArgsBaseFactory<SegmentSaver, SegmentSaver&, const Setting&>(cname) {
-        FactoriesIndex::indexFor<SegmentSaver, SegmentSaver&, const Setting&>().emplace(FactoriesIndex::hash(cname), *this);
+        FactoriesIndex::indexFor<SegmentSaver, SegmentSaver&, const Setting&>().emplace(FactoriesIndex::hash(cname), this);
     }
 
     /// Re-casting plugin construction
@@ -14,6 +14,10 @@ void KDTreeSet::finalize() {
         T->SetData(i++, v.data());
     }
     T->Build();
+
+    vector<const float*> vx;
+    for(auto& v: *this) vx.push_back(v.data());
+    K.build(vx, nPts());
 }
 
 void KDTreeSet::remove_points(const vector<size_t>& vidx) {
@@ -51,6 +55,18 @@ void PointCloudHistogram::Fill(const float* x, float v) {
     at(idx) += v;
 }
 
+void PointCloudHistogram::Fill(const float* xs, size_t n, float v, int nthreads) {
+    if(!myTree->T) throw std::logic_error("Binning KDTree undefined");
+    vector<int> idx(n);
+    myTree->K.nearest(xs, n, idx.data(), nthreads);
+    size_t nfail = 0;
+    for(auto i: idx) {
+        if(i < 0) ++nfail;
+        else (*this)[i] += v;
+    }
+    if(nfail) printf("Failed to locate %zu of %zu points\n", nfail, n);
+}
+
 void PointCloudHistogram::project(const float* v, TGraph& g) const {
     size_t b = 0;
     for(auto x: *this) {
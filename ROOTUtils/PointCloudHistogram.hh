@@ -1,6 +1,7 @@
 /// \file PointCloudHistogram.hh Multi-dimensional histogram binned around point cloud locations
 // Michael P. Mendenhall
 
+#include "PointKDTree.hh"
 #include <TKDTree.h>
 #include <TH1.h>
 #include <TGraph.h>
@@ -19,6 +20,7 @@ public:
     ~KDTreeSet() { clearTree(); }
 
     TKDTree<int,float>* T = nullptr;    ///< kd-tree of data points
+    PointKDTree K;                      ///< flat kd-tree for (batched) nearest-neighbor lookup
 
     /// get number of dimensions
     size_t nDim() const { return size(); }
@@ -40,7 +42,7 @@ public:
     /// build kd-tree
     void finalize();
     /// clear kd tree
-    void clearTree() { delete T; T = nullptr; }
+    void clearTree() { delete T; T = nullptr; K.clear(); }
 };
 
 
@@ -56,6 +58,8 @@ public:
 
     /// add value to nearest point
     void Fill(const float* x, float v = 1.0);
+    /// add value to nearest point for each of n point-major points xs[n*nDim], with batched lookup on nthreads (0 for hardware)
+    void Fill(const float* xs, size_t n, float v = 1.0, int nthreads = 0);
 
     /// project onto given vector, filling results into supplied TGraph
     void project(const float* v, TGraph& g) const;
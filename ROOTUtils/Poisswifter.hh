@@ -4,6 +4,7 @@
 #ifndef POISSWIFTER_HH
 #define POISSWIFTER_HH
 
+#include "DataSink.hh"
 #include <TRandom.h>
 #include <vector>
 using std::vector;
@@ -17,6 +18,26 @@ public:
     /// convert Poisson expectation values to counts
     void toCounts(vector<double>& v);
 
+    /// streaming conversion of one bin's expectation to counts, O(1) state carried between calls
+    double next(double l) {
+        if(l > xover) return R.Poisson(l);
+        if(!(l > 0)) return 0;
+        // unit-rate Poisson process along cumulative low-expectation: exponential gaps carried across bins
+        if(gap < 0) gap = R.Exp(1.);
+        double n = 0;
+        while(gap < l) {
+            ++n;
+            l -= gap;
+            gap = R.Exp(1.);
+        }
+        gap -= l;
+        return n;
+    }
+    /// streaming conversion of n expectation values to counts, in place
+    void toCounts(double* v, size_t n) { while(n--) { *v = next(*v); ++v; } }
+    /// restart streaming state
+    void resetStream() { gap = -1; }
+
     /// test generator speed for optimizing calculation strategy
     void speedTest();
 
@@ -26,6 +47,32 @@ protected:
     TRandom& R;
     vector<double> cprob;
     vector<int> ibins;
+    double gap = -1;    ///< streaming: remaining cumulative expectation to next low-rate count (< 0 to draw)
+};
+
+/// Analysis chain link converting streamed Poisson expectation values to counts, in fixed memory
+class PoisswifterLink: public DataLink<double, double> {
+public:
+    /// Constructor
+    explicit PoisswifterLink(TRandom& _R): P(_R) { }
+
+    /// convert and pass along one value
+    void push(double& l) override {
+        l = P.next(l);
+        if(nextSink) nextSink->push(l);
+    }
+    /// convert and pass along batch
+    void push_batch(double* v, size_t n) override {
+        P.toCounts(v, n);
+        nextBatch(v, n);
+    }
+    /// pass through data flow signal, restarting stream on INIT
+    void signal(datastream_signal_t s) override {
+        if(s == DATASTREAM_INIT) P.resetStream();
+        DataLink<double, double>::signal(s);
+    }
+
+    Poisswifter P;  ///< generator
 };
 
 #endif
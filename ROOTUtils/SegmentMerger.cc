@@ -0,0 +1,80 @@
+/// \file SegmentMerger.cc
+
+#include "SegmentMerger.hh"
+#include "WorkStealingPool.hh"
+#include <TROOT.h>
+#include <chrono>
+
+/// seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+SegmentSaver* SegmentMerger::merge(const vector<string>& fnames, const vector<double>& sc) {
+    if(sc.size() && sc.size() != fnames.size()) throw std::logic_error("Mismatched number of merge scale factors");
+    ROOT::EnableThreadSafety();
+    TH1::AddDirectory(kFALSE);
+
+    auto t0 = std::chrono::steady_clock::now();
+    tLoad = tAdd = 0;
+    nMerged = 0;
+    ready.clear();
+    string err;
+
+    {
+        WorkStealingPool P(nthreads);
+        for(size_t i = 0; i < fnames.size(); ++i) {
+            P.submit([this, i, &fnames, &sc, &err] {
+                try {
+                    auto t1 = std::chrono::steady_clock::now();
+                    SegmentSaver* S = load(fnames[i]);
+                    if(!S) throw std::runtime_error("Failed loading '" + fnames[i] + "'");
+                    if(sc.size() && sc[i] != 1.) S->scaleData(sc[i]);
+                    auto dtl = since(t1);
+
+                    // absorb available partial sums; leave for partner when none available
+                    double dta = 0;
+                    while(true) {
+                        SegmentSaver* S2 = nullptr;
+                        {
+                            std::lock_guard<std::mutex> l(mergeMut);
+                            if(ready.empty()) {
+                                ready.push_back(S);
+                                tLoad += dtl;
+                                tAdd += dta;
+                                ++nMerged;
+                                break;
+                            }
+                            S2 = ready.back();
+                            ready.pop_back();
+                        }
+                        auto t2 = std::chrono::steady_clock::now();
+                        S->addSegment(*S2);
+                        delete S2;
+                        dta += since(t2);
+                    }
+                } catch(std::exception& e) {
+                    std::lock_guard<std::mutex> l(mergeMut);
+                    err = e.what();
+                }
+            });
+        }
+        P.wait_idle();
+    }
+    tWall = since(t0);
+
+    if(err.size()) {
+        for(auto S: ready) delete S;
+        ready.clear();
+        throw std::runtime_error("SegmentMerger: " + err);
+    }
+    if(ready.size() > 1) throw std::logic_error("SegmentMerger left unmerged partial sums");
+    auto S = ready.size()? ready[0] : nullptr;
+    ready.clear();
+    return S;
+}
+
+void SegmentMerger::display() const {
+    printf("Merged %zu files in %.2f s wall time: %.2f s loading, %.2f s summing (thread time)\n",
+           nMerged, tWall, tLoad, tAdd);
+}
@@ -0,0 +1,37 @@
+/// \file SegmentMerger.hh Parallel load-and-sum of many SegmentSaver output files
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SEGMENTMERGER_HH
+#define SEGMENTMERGER_HH
+
+#include "SegmentSaver.hh"
+#include <functional>
+
+/// Load SegmentSaver (or PluginSaver) outputs on a thread pool, reducing partial sums pairwise across threads
+class SegmentMerger {
+public:
+    /// construct SegmentSaver loaded from named file (reading only its registered objects)
+    typedef std::function<SegmentSaver*(const string&)> loader_t;
+
+    /// Constructor
+    explicit SegmentMerger(const loader_t& l, int n = 0): load(l), nthreads(n) { }
+
+    /// load and sum files (optionally, each scaled by sc[i]); caller owns returned sum (nullptr for no files)
+    SegmentSaver* merge(const vector<string>& fnames, const vector<double>& sc = {});
+
+    /// display timing summary
+    void display() const;
+
+    loader_t load;          ///< file loader
+    int nthreads;           ///< number of pool threads (0 for hardware concurrency)
+    double tLoad = 0;       ///< total thread-time loading files [s]
+    double tAdd = 0;        ///< total thread-time summing [s]
+    double tWall = 0;       ///< wall time for last merge [s]
+    size_t nMerged = 0;     ///< number of files merged
+
+protected:
+    std::mutex mergeMut;    ///< protects ready and timers
+    vector<SegmentSaver*> ready;    ///< partial sums awaiting a partner
+};
+
+#endif
@@ -5,9 +5,11 @@
 #include <stdexcept>
 #include <TString.h>
 #include <TObjString.h>
+#include <TKey.h>
+#include <TClass.h>
 
-SegmentSaver::SegmentSaver(OutputManager* pnt, const string& nm, const string& inflname):
-OutputManager(nm, pnt) {
+SegmentSaver::SegmentSaver(OutputManager* pnt, const string& nm, const string& inflname, bool lazy):
+OutputManager(nm, pnt), lazyRestore(lazy) {
     // open file to load existing data
     fIn = (inflname.size())?(new TFile(inflname.c_str(),"READ")) : nullptr;
     if(fIn) {
@@ -42,6 +44,7 @@ const string& SegmentSaver::getMeta(const string& k) {
 }
 
 TDirectory* SegmentSaver::writeItems(TDirectory* d) {
+    restoreAll();
     TObjString* s = nullptr;
     for(auto& kv: xmeta) registerWithName(s, "meta/"+kv.first, kv.second.data());
 
@@ -54,13 +57,48 @@ TDirectory* SegmentSaver::writeItems(TDirectory* d) {
 bool SegmentSaver::isNormalized() { return normalization->GetNrows(); }
 
 void SegmentSaver::rename(const string& nm) {
+    restoreAll(); // before input directory changes
     path = nm;
     if(!fIn) {
         auto PSS = dynamic_cast<SegmentSaver*>(parent);
         if(PSS && PSS->dirIn) dirIn = PSS->dirIn->GetDirectory(path.c_str());
+        keyIndex.clear();
+        keysIndexed = false;
     }
 }
 
+/// recursively collect non-directory keys
+static void indexKeys(TDirectory* d, const string& pfx, map<string, TKey*>& m) {
+    for(auto _k: *d->GetListOfKeys()) {
+        auto k = dynamic_cast<TKey*>(_k);
+        if(!k) throw std::logic_error("TKey expected");
+        string name = pfx + k->GetName();
+        auto c = TClass::GetClass(k->GetClassName());
+        if(c && c->InheritsFrom(TDirectory::Class())) {
+            auto dd = d->GetDirectory(k->GetName());
+            if(dd) indexKeys(dd, name + "/", m);
+        } else m.emplace(name, k); // first (highest) cycle
+    }
+}
+
+const map<string, TKey*>& SegmentSaver::getKeyIndex() const {
+    if(!keysIndexed && dirIn) indexKeys(dirIn, "", keyIndex);
+    keysIndexed = true;
+    return keyIndex;
+}
+
+void SegmentSaver::restoreItem(const string& oname) const {
+    auto it = pending.find(oname);
+    if(it == pending.end()) return;
+    auto f = std::move(it->second);
+    pending.erase(it);
+    f();
+}
+
+void SegmentSaver::restoreAll() const {
+    while(pending.size()) restoreItem(pending.begin()->first);
+}
+
 TObject* SegmentSaver::_tryLoad(const string& oname) {
     if(!dirIn) return nullptr;
     TObject* o = nullptr;
@@ -89,12 +127,15 @@ TCumulative* SegmentSaver::_registerCumulative(const string& onm, const TCumulat
 }
 
 TH1* SegmentSaver::getSavedHist(const string& hname) {
+    restoreItem(hname);
     auto it = saveHists.find(hname);
+    if(it == saveHists.end() && lazyRestore && getKeyIndex().count(hname)) return loadSaved<TH1>(hname);
     if(it == saveHists.end()) throw std::runtime_error("Missing histogram '"+hname+"'");
     return it->second;
 }
 
 const TH1* SegmentSaver::getSavedHist(const string& hname) const {
+    restoreItem(hname);
     auto it = saveHists.find(hname);
     if(it == saveHists.end()) throw std::runtime_error("Missing histogram '"+hname+"'");
     return it->second;
@@ -113,6 +154,7 @@ const CumulativeData* SegmentSaver::getCumulative(const string& cname) const {
 }
 
 void SegmentSaver::zeroSavedHists() {
+    restoreAll();
     for(auto& kv: saveHists) kv.second->Reset();
     for(auto& kv: cumDat) kv.second->Scale(0);
     for(auto& kv: tCumDat) kv.second->Clear();
@@ -120,6 +162,7 @@ void SegmentSaver::zeroSavedHists() {
 
 void SegmentSaver::scaleData(double s) {
     if(s == 1.) return;
+    restoreAll();
     for(auto& kv: saveHists) {
         if(doNotScale.count(kv.second)) continue;
         if(kv.second->ClassName() != TString("TProfile") && kv.second->ClassName() != TString("TProfile2D")) {
@@ -132,6 +175,8 @@ void SegmentSaver::scaleData(double s) {
 }
 
 bool SegmentSaver::isEquivalent(const SegmentSaver& S, bool throwit) const {
+    restoreAll();
+    S.restoreAll();
     for(auto& kv: saveHists) {
         if(!S.saveHists.count(kv.first)) {
             if(throwit) throw std::runtime_error("Mismatched histogram '"+kv.first+"' in '"+path+"'");
@@ -149,6 +194,8 @@ bool SegmentSaver::isEquivalent(const SegmentSaver& S, bool throwit) const {
 
 map<string,float> SegmentSaver::compareKolmogorov(const SegmentSaver& S) const {
     map<string,float> m;
+    restoreAll();
+    S.restoreAll();
     for(auto& kv: saveHists) {
         if(kv.second->GetEntries() < 100) continue;
         auto it = S.saveHists.find(kv.first);
@@ -9,14 +9,38 @@
 #include <TVectorT.h>
 #include <TFile.h>
 #include <stdexcept>
+#include <functional>
 #include <set>
 using std::set;
 
+class TKey;
+class SegmentSaver;
+
+/// Handle to object registered with SegmentSaver, restored from file on first access in lazy mode
+template<class T>
+class SavedRef {
+public:
+    /// get object, restoring if needed
+    T* get() const;
+    /// pointer-like access
+    T* operator->() const { return get(); }
+    /// dereference
+    T& operator*() const { return *get(); }
+    /// convert to pointer
+    operator T*() const { return get(); }
+
+protected:
+    friend class SegmentSaver;
+    T* o = nullptr;                     ///< restored/constructed object
+    const SegmentSaver* S = nullptr;    ///< registering SegmentSaver
+    string name;                        ///< registered name
+};
+
 /// class for saving, retrieving, and summing data from file
 class SegmentSaver: public OutputManager {
 public:
-    /// constructor, optionally with input filename
-    explicit SegmentSaver(OutputManager* pnt, const string& nm = "SegmentSaver", const string& inflName = "");
+    /// constructor, optionally with input filename; lazy to defer reading SavedRef-registered (and on-demand) objects until first access
+    explicit SegmentSaver(OutputManager* pnt, const string& nm = "SegmentSaver", const string& inflName = "", bool lazy = false);
     /// destructor
     virtual ~SegmentSaver();
 
@@ -56,6 +80,29 @@ public:
         saveHists.emplace(hname, h);
     }
 
+    /// construct, or (lazy) restore on first access, saved TH1-derived class
+    template<class T, typename... Args>
+    void registerSaved(SavedRef<T>& r, const string& hname, Args&&... a) {
+        initRef(r, hname);
+        if(deferLoad(hname)) pending.emplace(hname, [this, &r, hname] { r.o = loadSaved<T>(hname); });
+        else registerSaved(r.o, hname, std::forward<Args>(a)...);
+    }
+
+    /// clone from template, or (lazy) restore on first access, saved TH1-derived class
+    template<class T, class U>
+    void registerSavedClone(SavedRef<T>& r, const string& hname, const U& hTemplate) {
+        initRef(r, hname);
+        if(deferLoad(hname)) pending.emplace(hname, [this, &r, hname] { r.o = loadSaved<U>(hname); resetZaxis(r.o); });
+        else registerSavedClone(r.o, hname, hTemplate);
+    }
+
+    /// restore all deferred lazy-mode objects
+    void restoreAll() const;
+    /// restore one deferred lazy-mode object, if pending
+    void restoreItem(const string& oname) const;
+    /// index of all (non-directory) keys in input directory, by path relative to dirIn; built on first call
+    const map<string, TKey*>& getKeyIndex() const;
+
     /// clone or restore from file a cumulative object
     TCumulative* _registerCumulative(const string& onm, const TCumulative& cTemplate);
     /// register cumulative with useful type return
@@ -86,7 +133,7 @@ public:
         return o? o : addWithName(oTemplate.Clone(onm.c_str()), onm);
     }
 
-    /// get core histogram by name
+    /// get core histogram by name; in lazy mode, also restores unregistered histograms from file on demand
     TH1* getSavedHist(const string& hname);
     /// get saved histogram by name, const version
     const TH1* getSavedHist(const string& hname) const;
@@ -95,7 +142,7 @@ public:
     /// get cumulative data by name, const
     const TCumulative* getTCumulative(const string& cname) const;
     /// get full histograms listing
-    const map<string,TH1*>& getHists() const { return saveHists; }
+    const map<string,TH1*>& getHists() const { restoreAll(); return saveHists; }
     /// zero out all saved histograms
     virtual void zeroSavedHists();
     /// scale all saved histograms by a factor
@@ -111,6 +158,7 @@ public:
     virtual map<string,float> compareKolmogorov(const SegmentSaver& S) const;
 
     bool ignoreMissingHistos = true;    ///< whether to quietly ignore missing histograms in input file
+    const bool lazyRestore;             ///< whether to defer reading objects from file until first access
     TFile* fIn = nullptr;               ///< input file to read in histograms from
     TDirectory* dirIn = nullptr;        ///< particular sub-directory for reading histograms
     TVectorD* normalization = nullptr;  ///< normalization information; meaning defined in subclasses
@@ -120,6 +168,7 @@ public:
     double tCalc = 0;           ///< performance profiling: time for calculateResults
     double tPlot = 0;           ///< performance profiling: time for makePlots
     double order = 0;           ///< run sort ordering number
+    vector<string> dependsOn;   ///< as plugin: sibling plugins whose calculateResults, makePlots, compare must run first
 
 
     // ----- Subclass me! ----- //
@@ -158,13 +207,41 @@ protected:
         return oo;
     }
 
+    /// set up SavedRef for registration, checking for duplicates
+    template<class T>
+    void initRef(SavedRef<T>& r, const string& hname) {
+        if(saveHists.count(hname) || pending.count(hname)) throw std::logic_error("Duplicate name '"+hname+"'");
+        if(r.o) throw std::logic_error("Registration of '" + path + "/" + hname + "' would overwrite non-null pointer");
+        r.S = this;
+        r.name = hname;
+    }
+    /// whether to defer loading of named object (lazy mode, and present in file)
+    bool deferLoad(const string& oname) const { return lazyRestore && getKeyIndex().count(oname); }
+    /// load (indexed) saved histogram from file on first access
+    template<class T>
+    T* loadSaved(const string& hname) {
+        auto h = tryLoad<T>(hname);
+        if(!h) throw std::runtime_error("Failed to restore indexed object '" + hname + "'");
+        saveHists.emplace(hname, h);
+        return h;
+    }
+
     map<string,TH1*> saveHists;         ///< saved cumulative histograms
+    mutable map<string, std::function<void()>> pending; ///< lazy-mode deferred restorations
+    mutable map<string, TKey*> keyIndex;    ///< input keys index, by relative path
+    mutable bool keysIndexed = false;   ///< whether keyIndex has been built
     set<void*> doNotScale;              ///< items not to rescale
     map<string, CumulativeData*> cumDat;    ///< non-TObject cumulative types
     map<string, TCumulative*> tCumDat;      ///< non-TH1-derived cumulative datatypes
     map<string, string> xmeta;          ///< extra metadata
 };
 
+template<class T>
+T* SavedRef<T>::get() const {
+    if(!o && S) S->restoreItem(name);
+    return o;
+}
+
 /// utility function to remove color axis data, to force re-draw with current dimensions
 void resetZaxis(TH1* o);
 
@@ -1,6 +1,9 @@
 /// \file SplineFit.cc
 #include "SplineFit.hh"
 #include "StringManip.hh"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 
 int SplineFit::nameCounter = 0;
 
@@ -9,6 +12,10 @@ void SplineFit::setX(const double* x, size_t n) {
         delete myFitter;
         myFitter = nullptr;
     }
+    kx.assign(x, x + n);
+    if(!std::is_sorted(kx.begin(), kx.end())) throw std::runtime_error("SplineFit knots must be in ascending order");
+    cachex.clear();
+    cacheseg.clear();
     vector<double> y(n);
     mySpline = TGraphErrors(n,x,y.data());
 }
@@ -43,8 +50,41 @@ void SplineFit::updateSpline() {
     }
 }
 
-double SplineFit::eval(double* x, double* p) {
-    const size_t n = mySpline.GetN();
-    for(size_t i=0; i<n; i++) mySpline.GetY()[i] = p[i];
-    return mySpline.Eval(*x);
+SplineFit::segment_t SplineFit::segment(double x) const {
+    const size_t n = kx.size();
+    if(n < 2) return {0, 0};
+    size_t lo = std::upper_bound(kx.begin(), kx.end(), x) - kx.begin();
+    lo = lo? std::min(lo - 1, n - 2) : 0; // extrapolate from end segments
+    double dx = kx[lo+1] - kx[lo];
+    return {lo, dx? (x - kx[lo])/dx : 0.};
+}
+
+double SplineFit::interp(double x, const double* p) const {
+    if(!kx.size()) return 0;
+    if(kx.size() == 1) return p[0];
+    auto s = segment(x);
+    return p[s.i] + s.t*(p[s.i+1] - p[s.i]);
+}
+
+void SplineFit::eval(const double* x, double* y, size_t n, const double* p) const {
+    if(kx.size() < 2) {
+        for(size_t j = 0; j < n; ++j) y[j] = kx.size()? p[0] : 0;
+        return;
+    }
+    if(cachex.size() != n || memcmp(cachex.data(), x, n*sizeof(double))) {
+        cachex.assign(x, x + n);
+        cacheseg.resize(n);
+        for(size_t j = 0; j < n; ++j) cacheseg[j] = segment(x[j]);
+    }
+    const segment_t* __restrict__ S = cacheseg.data();
+    for(size_t j = 0; j < n; ++j) y[j] = p[S[j].i] + S[j].t*(p[S[j].i+1] - p[S[j].i]);
+}
+
+void SplineFit::evalBins(const TH1& h, vector<double>& y, const double* p) const {
+    const int nb = h.GetNbinsX();
+    vector<double> x(nb);
+    auto A = h.GetXaxis();
+    for(int b = 0; b < nb; ++b) x[b] = A->GetBinCenter(b+1);
+    y.resize(nb);
+    eval(x.data(), y.data(), nb, p);
 }
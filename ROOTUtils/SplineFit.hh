@@ -32,13 +32,30 @@ public:
 
 
     /// fitter evaluation
-    double eval(double* x, double* p);
+    double eval(double* x, double* p) { return interp(*x, p); }
+    /// interpolation (as TGraph::Eval, with linear extrapolation) at x for knot values p, without copying into mySpline
+    double interp(double x, const double* p) const;
+    /// batched evaluation y[n] at points x[n] for knot values p; segment lookup cached for repeated x (e.g. bin centers)
+    void eval(const double* x, double* y, size_t n, const double* p) const;
+    /// batched evaluation at histogram bin centers 1...nbins
+    void evalBins(const TH1& h, vector<double>& y, const double* p) const;
 
     TGraphErrors mySpline;      ///< fitted spline TGraph with fit errors
 
 protected:
+    /// interpolation segment: y = p[i] + t*(p[i+1] - p[i])
+    struct segment_t {
+        size_t i;               ///< lower knot
+        double t;               ///< fractional position
+    };
+    /// locate interpolation segment for x
+    segment_t segment(double x) const;
+
     static int nameCounter;     ///< counter for unique naming
-    TF1* myFitter = nullptr;       ///< fitter for spline
+    TF1* myFitter = nullptr;    ///< fitter for spline
+    vector<double> kx;          ///< sorted knot positions
+    mutable vector<double> cachex;      ///< x positions for cached segments
+    mutable vector<segment_t> cacheseg; ///< cached segments for cachex
 };
 
 #endif
@@ -0,0 +1,201 @@
+/// \file TCumulativeFlatMap.hh TCumulative sorted-vector ("flat") map<key, value>, with linear-time and k-way merges
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef TCUMULATIVEFLATMAP_HH
+#define TCUMULATIVEFLATMAP_HH
+
+#include "TCumulative.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+using std::vector;
+
+/// TCumulative sorted-vector map<key, value>: Insert() appends, sorted and combined on demand; Add() is a linear merge
+template<typename K_, typename V_>
+class TCumulativeFlatMap: public TCumulative {
+public:
+    typedef K_ key_type;        ///< key type
+    typedef V_ mapped_type;     ///< value type
+
+    /// Constructor
+    TCumulativeFlatMap(const TString& nme = "", const TString& ttl = ""): TCumulative(nme,ttl) { }
+    /// Constructor, copying contents of (ordered) map-like container
+    template<class M>
+    TCumulativeFlatMap(const M& m, const TString& nme, const TString& ttl = ""): TCumulative(nme,ttl) {
+        keys.reserve(m.size());
+        vals.reserve(m.size());
+        for(auto& kv: m) Insert(kv.first, kv.second);
+        normalize();
+    }
+
+    /// Scale contents by factor
+    void Scale(Double_t s) override { for(auto& v: vals) v *= s; }
+    /// Add another object of the same type, by linear sorted merge
+    void Add(const CumulativeData& CD, Double_t s = 1.) override {
+        auto& M = dynamic_cast<const TCumulativeFlatMap&>(CD);
+        M.normalize();
+        normalize();
+        vector<K_> k;
+        vector<V_> v;
+        k.reserve(keys.size() + M.keys.size());
+        v.reserve(keys.size() + M.keys.size());
+        size_t i = 0, j = 0;
+        while(i < keys.size() || j < M.keys.size()) {
+            if(j == M.keys.size() || (i < keys.size() && keys[i] < M.keys[j])) { k.push_back(keys[i]); v.push_back(vals[i++]); }
+            else if(i == keys.size() || M.keys[j] < keys[i]) { k.push_back(M.keys[j]); v.push_back(M.vals[j++]*s); }
+            else { k.push_back(keys[i]); v.push_back(vals[i++] + M.vals[j++]*s); }
+        }
+        keys.swap(k);
+        vals.swap(v);
+        nsorted = keys.size();
+    }
+    /// Add many objects (optionally, each scaled by s[i]) by k-way merge; key ranges split over nthreads (0 for hardware) if != 1
+    void AddMany(const vector<const TCumulativeFlatMap*>& v, const vector<double>& s = {}, int nthreads = 1);
+
+    /// clear data contents
+    void Clear(const char* = nullptr) override { keys.clear(); vals.clear(); nsorted = 0; }
+    /// Insert/add contents (appended; sorted and combined at next access)
+    void Insert(const K_& k, const V_& v) { keys.push_back(k); vals.push_back(v); }
+
+    /// sort and combine appended inserts
+    void normalize() const;
+    /// number of distinct keys
+    size_t size() const { normalize(); return keys.size(); }
+    /// sorted keys
+    const vector<K_>& Keys() const { normalize(); return keys; }
+    /// values, corresponding to Keys()
+    const vector<V_>& Values() const { normalize(); return vals; }
+    /// get value for key (default if absent)
+    V_ Get(const K_& k) const {
+        normalize();
+        auto it = std::lower_bound(keys.begin(), keys.end(), k);
+        return it != keys.end() && !(k < *it)? vals[it - keys.begin()] : V_{};
+    }
+
+    /// Get sum total of all contents
+    V_ GetTotal() const { V_ sm = {}; for(auto& v: vals) sm += v; return sm; }
+
+protected:
+    mutable vector<K_> keys;    ///< keys, sorted and unique up to nsorted
+    mutable vector<V_> vals;    ///< values corresponding to keys
+    mutable size_t nsorted = 0; ///< number of sorted, combined entries; followed by appended inserts
+
+    /// k-way merge of (normalized) v[i] key ranges [b[i], e[i]) with scale s[i], appended onto k, x
+    static void kmerge(const vector<const TCumulativeFlatMap*>& v, const vector<double>& s,
+                       const vector<size_t>& b, const vector<size_t>& e, vector<K_>& k, vector<V_>& x);
+
+    ClassDefOverride(TCumulativeFlatMap, 1)
+};
+
+template<typename K_, typename V_>
+void TCumulativeFlatMap<K_,V_>::normalize() const {
+    if(nsorted == keys.size()) return;
+
+    // sort and combine appended entries
+    vector<size_t> idx(keys.size() - nsorted);
+    for(size_t i = 0; i < idx.size(); ++i) idx[i] = nsorted + i;
+    std::stable_sort(idx.begin(), idx.end(), [this](size_t a, size_t b) { return keys[a] < keys[b]; });
+    vector<K_> k;
+    vector<V_> v;
+    k.reserve(keys.size());
+    v.reserve(keys.size());
+    size_t i = 0, j = 0;
+    while(i < nsorted || j < idx.size()) {
+        const bool fromHead = j == idx.size() || (i < nsorted && !(keys[idx[j]] < keys[i]));
+        const size_t n = fromHead? i++ : idx[j++];
+        if(k.size() && !(k.back() < keys[n])) v.back() += vals[n];
+        else { k.push_back(keys[n]); v.push_back(vals[n]); }
+    }
+    keys.swap(k);
+    vals.swap(v);
+    nsorted = keys.size();
+}
+
+template<typename K_, typename V_>
+void TCumulativeFlatMap<K_,V_>::kmerge(const vector<const TCumulativeFlatMap*>& v, const vector<double>& s,
+                                      const vector<size_t>& b, const vector<size_t>& e, vector<K_>& k, vector<V_>& x) {
+    typedef std::pair<const K_*, size_t> cursor_t;   // current key, source
+    auto cmp = [](const cursor_t& a, const cursor_t& c) { return *c.first < *a.first; };
+    std::priority_queue<cursor_t, vector<cursor_t>, decltype(cmp)> Q(cmp);
+    vector<size_t> pos = b;
+    for(size_t i = 0; i < v.size(); ++i) if(pos[i] < e[i]) Q.emplace(&v[i]->keys[pos[i]], i);
+
+    while(!Q.empty()) {
+        auto c = Q.top();
+        Q.pop();
+        auto i = c.second;
+        const V_ y = v[i]->vals[pos[i]] * s[i];
+        if(k.size() && !(k.back() < *c.first)) x.back() += y;
+        else { k.push_back(*c.first); x.push_back(y); }
+        if(++pos[i] < e[i]) Q.emplace(&v[i]->keys[pos[i]], i);
+    }
+}
+
+template<typename K_, typename V_>
+void TCumulativeFlatMap<K_,V_>::AddMany(const vector<const TCumulativeFlatMap*>& v, const vector<double>& s, int nthreads) {
+    if(s.size() && s.size() != v.size()) throw std::logic_error("Mismatched TCumulativeFlatMap scale factors");
+    vector<const TCumulativeFlatMap*> vv(1, this);
+    vector<double> ss(1, 1.);
+    size_t ntot = 0;
+    for(size_t i = 0; i < v.size(); ++i) {
+        if(!v[i]) continue;
+        v[i]->normalize();
+        vv.push_back(v[i]);
+        ss.push_back(s.size()? s[i] : 1.);
+    }
+    normalize();
+    for(auto m: vv) ntot += m->keys.size();
+
+    // split points from keys of largest input
+    const TCumulativeFlatMap* L = vv[0];
+    for(auto m: vv) if(m->keys.size() > L->keys.size()) L = m;
+    size_t np = nthreads == 1? 1 : std::max(nthreads > 0? size_t(nthreads) : size_t(std::thread::hardware_concurrency()), size_t(1));
+    np = std::max(std::min(np, L->keys.size()/1024), size_t(1));
+
+    vector<vector<size_t>> bounds(np + 1, vector<size_t>(vv.size()));
+    for(size_t p = 1; p < np; ++p) {
+        const K_& kp = L->keys[p * L->keys.size() / np];
+        for(size_t i = 0; i < vv.size(); ++i) bounds[p][i] = std::lower_bound(vv[i]->keys.begin(), vv[i]->keys.end(), kp) - vv[i]->keys.begin();
+    }
+    for(size_t i = 0; i < vv.size(); ++i) bounds[np][i] = vv[i]->keys.size();
+
+    vector<vector<K_>> pk(np);
+    vector<vector<V_>> px(np);
+    auto job = [&](size_t p) {
+        pk[p].reserve(ntot/np);
+        px[p].reserve(ntot/np);
+        kmerge(vv, ss, bounds[p], bounds[p+1], pk[p], px[p]);
+    };
+    if(np == 1) job(0);
+    else {
+        WorkStealingPool P(np);
+        for(size_t p = 0; p < np; ++p) P.submit([&job, p] { job(p); });
+        P.wait_idle();
+    }
+
+    if(np == 1) {
+        keys.swap(pk[0]);
+        vals.swap(px[0]);
+    } else {
+        size_t n = 0;
+        for(auto& c: pk) n += c.size();
+        vector<K_> k;
+        vector<V_> x;
+        k.reserve(n);
+        x.reserve(n);
+        for(size_t p = 0; p < np; ++p) {
+            k.insert(k.end(), pk[p].begin(), pk[p].end());
+            x.insert(x.end(), px[p].begin(), px[p].end());
+        }
+        keys.swap(k);
+        vals.swap(x);
+    }
+    nsorted = keys.size();
+}
+
+#endif
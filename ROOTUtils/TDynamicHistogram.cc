@@ -6,15 +6,98 @@
 // -- Michael P. Mendenhall, 2016
 
 #include "TDynamicHistogram.hh"
+#include <TBuffer.h>
 #include <cmath>
 
-void TDynamicHistogram::Fill(Double_t x, Double_t w) {
-    BinData& b = fDat[FindBin(x)];
-    b.sw += w;
-    b.sww += w*w;
+void TDynamicHistogram::Streamer(TBuffer& R) {
+    // unchanged automatic streamer format, with dense storage folded into fDat before writing
+    if(R.IsReading()) {
+        fDense.clear();
+        R.ReadClassBuffer(TDynamicHistogram::Class(), this);
+    } else {
+        Consolidate();
+        R.WriteClassBuffer(TDynamicHistogram::Class(), this);
+    }
+}
+
+void TDynamicHistogram::Fill(const Double_t* x, const Double_t* w, size_t n) {
+    if(w) for(size_t i = 0; i < n; ++i) FillBin(FindBin(x[i]), w[i]);
+    else for(size_t i = 0; i < n; ++i) FillBin(FindBin(x[i]));
+}
+
+void TDynamicHistogram::FillSparse(Int_t b, Double_t w) {
+    BinData& d = fDat[b];
+    d.sw += w;
+    d.sww += w*w;
+    if(!(++fNSparse & 1023)) CheckDensity();
+}
+
+void TDynamicHistogram::CheckDensity() {
+    if(fDat.size() < 64) return;
+
+    // find largest run of occupied bins (current dense range counted as occupied) separated by gaps < 1/fDenseFrac
+    const Long64_t gmax = std::max(Long64_t(1), Long64_t(1./fDenseFrac));
+    const Long64_t d0 = fDenseMin, d1 = fDenseMin + fDense.size();
+    Long64_t lo = 0, hi = 0, rlo = 0, rhi = 0;
+    size_t nocc = 0, rocc = 0;
+    auto extend = [&](Long64_t b0, Long64_t b1) {
+        if(!rocc || b0 - rhi >= gmax) {
+            if(rocc > nocc) { nocc = rocc; lo = rlo; hi = rhi; }
+            rlo = b0;
+            rocc = 0;
+        }
+        rhi = b1;
+        rocc += b1 - b0;
+    };
+    bool denseDone = !fDense.size();
+    for(auto const& kv: fDat) {
+        if(!denseDone && kv.first >= d0) { extend(d0, d1); denseDone = true; }
+        extend(kv.first, kv.first + 1);
+    }
+    if(!denseDone) extend(d0, d1);
+    if(rocc > nocc) { nocc = rocc; lo = rlo; hi = rhi; }
+
+    if(fDense.size() && lo == d0 && hi == d1) return; // no change
+    if(nocc < 64 || hi - lo > fDenseMax || nocc < fDenseFrac*(hi - lo)) return;
+
+    vector<BinData> v(hi - lo);
+    for(size_t i = 0; i < fDense.size(); ++i) {
+        Long64_t b = d0 + i;
+        if(b >= lo && b < hi) v[b - lo] = fDense[i];
+        else if(fDense[i].sw || fDense[i].sww) fDat[b] = fDense[i]; // previous dense range outside new run
+    }
+    for(auto it = fDat.lower_bound(lo); it != fDat.end() && it->first < hi; ) {
+        auto& d = v[it->first - lo];
+        d.sw += it->second.sw;
+        d.sww += it->second.sww;
+        it = fDat.erase(it);
+    }
+    fDense.swap(v);
+    fDenseMin = lo;
+}
+
+void TDynamicHistogram::Consolidate() const {
+    if(!fDense.size()) return;
+    auto& D = const_cast<map<Int_t, BinData>&>(fDat);
+    auto it = D.begin();
+    for(size_t i = 0; i < fDense.size(); ++i) {
+        auto& d = fDense[i];
+        if(!d.sw && !d.sww) continue;
+        Int_t b = fDenseMin + i;
+        while(it != D.end() && it->first < b) ++it;
+        if(it == D.end() || it->first != b) it = D.emplace_hint(it, b, BinData());
+        it->second.sw += d.sw;
+        it->second.sww += d.sww;
+        ++it;
+    }
+    fDense.clear();
 }
 
 void TDynamicHistogram::Scale(Double_t s) {
+    for(auto& d: fDense) {
+        d.sw *= s;
+        d.sww *= s*s;
+    }
     for(auto& kv: fDat) {
         kv.second.sw *= s;
         kv.second.sww *= s*s;
@@ -22,22 +105,29 @@ void TDynamicHistogram::Scale(Double_t s) {
 }
 
 void TDynamicHistogram::Add(const TDynamicHistogram& h, Double_t s, Bool_t rebin) {
+    Consolidate();
     auto const& d = h.GetData();
     if(rebin) {
         for(auto const& kv: d) {
-            Int_t b = h.BinCenter(kv.first);
+            Int_t b = FindBin(h.BinCenter(kv.first));
             fDat[b].sw += s*kv.second.sw;
             fDat[b].sww += s*s*kv.second.sww;
         }
     } else {
+        // linear merge of sorted bins, instead of a lookup per bin
+        auto it = fDat.begin();
         for(auto const& kv: d) {
-            fDat[kv.first].sw += s*kv.second.sw;
-            fDat[kv.first].sww += s*s*kv.second.sww;
+            while(it != fDat.end() && it->first < kv.first) ++it;
+            if(it == fDat.end() || it->first != kv.first) it = fDat.emplace_hint(it, kv.first, BinData());
+            it->second.sw += s*kv.second.sw;
+            it->second.sww += s*s*kv.second.sww;
+            ++it;
         }
     }
 }
 
 void TDynamicHistogram::normalize_to_bin_width(Double_t sc) {
+    Consolidate();
     for(auto& kv: fDat) {
         Double_t bw = BinLoEdge(kv.first+1)-BinLoEdge(kv.first);
         kv.second.sw *= sc/bw;
@@ -46,6 +136,7 @@ void TDynamicHistogram::normalize_to_bin_width(Double_t sc) {
 }
 
 TGraphErrors* TDynamicHistogram::MakeGraph() const {
+    Consolidate();
     TGraphErrors* g = new TGraphErrors(fDat.size());
     g->SetTitle(fTitle);
     Int_t n = 0;
@@ -13,8 +13,12 @@
 
 #include <map>
 using std::map;
+#include <vector>
+using std::vector;
 
 /// Histogram with dynamic (sparse) binning
+/// switches automatically to (transient) contiguous array storage over dense bin ranges;
+/// persistent (streamed) form is always the sparse map
 class TDynamicHistogram: public TCumulative {
 public:
     /// Constructor
@@ -30,13 +34,29 @@ public:
     };
 
     /// fill new data point
-    void Fill(Double_t x, Double_t w=1.);
+    void Fill(Double_t x, Double_t w=1.) { FillBin(FindBin(x), w); }
+    /// batched fill of n points, with optional weights (unity if nullptr)
+    void Fill(const Double_t* x, const Double_t* w, size_t n);
+    /// fill bin number
+    void FillBin(Int_t b, Double_t w=1.) {
+        size_t i = size_t(Long64_t(b) - fDenseMin);
+        if(i < fDense.size()) {
+            fDense[i].sw += w;
+            fDense[i].sww += w*w;
+        } else FillSparse(b, w);
+    }
     /// scale all bin contents
     void Scale(Double_t s) override;
     /// add another histogram, assuming same binning convention or re-calculating bins
     void Add(const TDynamicHistogram& h, Double_t s = 1., Bool_t rebin = false);
-    /// get data
-    const map<Int_t, BinData>& GetData() const { return fDat; }
+    /// get data (folding any dense-range storage back into map)
+    const map<Int_t, BinData>& GetData() const { Consolidate(); return fDat; }
+    /// fold dense-range storage back into sparse map
+    void Consolidate() const;
+    /// set dense-storage switch density (occupied fraction of bin range) and maximum dense range
+    void SetDenseThreshold(Double_t frac, Int_t maxbins = 1<<22) { fDenseFrac = frac; fDenseMax = maxbins; }
+    /// whether currently using dense-range storage
+    bool IsDense() const { return fDense.size(); }
     /// select bin number
     virtual Int_t FindBin(Double_t x) const { return Int_t(fN*(x-fX0)/(fX1-fX0)); }
     /// position of bin lower edge
@@ -52,12 +72,22 @@ public:
     void Add(const CumulativeData& CD, Double_t s = 1.) override { Add(dynamic_cast<const TDynamicHistogram&>(CD), s); }
 
 protected:
+    /// fill outside dense range, periodically checking whether to switch storage
+    void FillSparse(Int_t b, Double_t w);
+    /// switch to dense storage if occupied fraction passes threshold
+    void CheckDensity();
 
     map<Int_t, BinData> fDat;   ///< histogram data
     Double_t fN;                ///< number of bins in prototype interval
     Double_t fX0;               ///< beginning of prototype interval
     Double_t fX1;               ///< end of prototype interval
 
+    mutable vector<BinData> fDense;     //!< contiguous storage for bins [fDenseMin, fDenseMin + fDense.size())
+    mutable Long64_t fDenseMin = 0;     //!< first dense-storage bin
+    UInt_t fNSparse = 0;                //!< sparse fills since last density check
+    Double_t fDenseFrac = 0.25;         //!< occupied fraction for switch to dense storage
+    Int_t fDenseMax = 1<<22;            //!< maximum dense storage range
+
     ClassDefOverride(TDynamicHistogram,2);
 };
 
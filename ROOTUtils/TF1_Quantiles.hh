@@ -2,6 +2,7 @@
 
 #include <TArrayD.h>
 #include <TF1.h>
+#include "MonotoneInverseCDF.hh"
 
 /// Quantiles (inverse CDF) distribution from a TF1
 /// based on ROOT's TF1::GetQuantiles(...) function
@@ -11,6 +12,13 @@ public:
     explicit TF1_Quantiles(TF1& f);
     /// return quantile for 0 <= p <= 1
     double eval(double p) const;
+    /// precompute inverse-CDF table (monotone cubic, adaptively refined to tol relative to range) for fastEval and sample
+    void buildTable(double tol = 1e-7) { table.build([this](double p) { return eval(p); }, tol); }
+    /// quantile from precomputed table if available, else eval(p)
+    double fastEval(double p) const { return table.size()? table(p) : eval(p); }
+    /// fill x[n] with random variates using rng() uniform [0,1) generator (requires buildTable)
+    template<class RNG>
+    void sample(double* x, size_t n, RNG& rng) const { table.sample(x, n, rng); }
     /// get average value
     Double_t getAvg() const { return avg; }
 
@@ -25,4 +33,5 @@ protected:
     TArrayD alpha;
     TArrayD beta;
     TArrayD gamma;
+    MonotoneInverseCDF table;   ///< precomputed inverse CDF table
 };
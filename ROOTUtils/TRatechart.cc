@@ -6,6 +6,8 @@
 // -- Michael P. Mendenhall, 2016
 
 #include "TRatechart.hh"
+#include <cmath>
+#include <stdexcept>
 
 void TRatechart::AddPoint(Double_t x, Double_t w)  {
     if(fPts.size() && !(fabs(x - fPts[0][0]) <= fDxMax)) SummarizeWindow();
@@ -45,6 +47,56 @@ void TRatechart::SummarizeWindow()  {
     P.fXX /= fSw;
 
     fDat.push_back(P);
+    fHasGroup = false;
+    Limit();
     fSw = 0;
     fPts.clear();
 }
+
+void TRatechart::Combine(SummaryPt& a, const SummaryPt& b) {
+    auto W = a.fW + b.fW;
+    if(!W) return;
+    auto X = (a.fW*a.fX + b.fW*b.fX)/W;
+    a.fXX = (a.fW*(a.fXX + (a.fX-X)*(a.fX-X)) + b.fW*(b.fXX + (b.fX-X)*(b.fX-X)))/W;
+    a.fX = X;
+    a.fW = W;
+}
+
+void TRatechart::Limit() {
+    if(!fMaxPts || fDat.size() <= fMaxPts) return;
+    if(fDecimate) {
+        while(fDat.size() > fMaxPts) {
+            size_t n = 0;
+            for(size_t i = 0; i < fDat.size(); i += 2) {
+                fDat[n] = fDat[i];
+                if(i+1 < fDat.size()) Combine(fDat[n], fDat[i+1]);
+                ++n;
+            }
+            fDat.resize(n);
+            fDxMax *= 2;
+            fHasGroup = false;
+        }
+    } else fDat.erase(fDat.begin(), fDat.begin() + (fDat.size() - fMaxPts + fMaxPts/8)); // amortized drop of oldest
+}
+
+void TRatechart::Archive(const SummaryPt& P, Long64_t g) {
+    if(fHasGroup && g == fLastGroup && fDat.size()) Combine(fDat.back(), P);
+    else {
+        fDat.push_back(P);
+        fLastGroup = g;
+        fHasGroup = true;
+        Limit();
+    }
+}
+
+void TRatechart::SetConcurrent(bool c, size_t nthreads) {
+    Flush();
+    if(!c) { fAcc.reset(); return; }
+    if(!(fDxMax > 0)) throw std::logic_error("Concurrent chart accumulation requires window width > 0");
+    fAcc.reset(new ChartAccumulator(fDxMax, [this](int64_t k, const ChartMoments& M) {
+        SummaryPt P;
+        P.fW = M.w;
+        M.xstats(k*fAcc->dx, P.fX, P.fXX);
+        Archive(P, Long64_t(std::floor(k*fAcc->dx/fDxMax + 1e-9)));
+    }, nthreads));
+}
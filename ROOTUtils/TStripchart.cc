@@ -6,6 +6,8 @@
 // -- Michael P. Mendenhall, 2016
 
 #include "TStripchart.hh"
+#include <cmath>
+#include <stdexcept>
 
 void TStripchart::AddPoint(Double_t x, Double_t y, Double_t w) {
     if(fPts.size() && !(fabs(x - fPts[0][0]) <= fDxMax)) SummarizeWindow();
@@ -34,6 +36,8 @@ void TStripchart::SummarizeWindow() {
     P.fYY /= fSw;
 
     fDat.push_back(P);
+    fHasGroup = false;
+    Limit();
     fSw = 0;
     fPts.clear();
 }
@@ -66,3 +70,55 @@ TGraphErrors* TStripchart::MakeRateGraph(bool per_dt) const {
     }
     return g;
 }
+
+void TStripchart::Combine(SummaryPt& a, const SummaryPt& b) {
+    auto W = a.fW + b.fW;
+    if(!W) return;
+    auto X = (a.fW*a.fX + b.fW*b.fX)/W;
+    a.fXX = (a.fW*(a.fXX + (a.fX-X)*(a.fX-X)) + b.fW*(b.fXX + (b.fX-X)*(b.fX-X)))/W;
+    a.fX = X;
+    auto Y = (a.fW*a.fY + b.fW*b.fY)/W;
+    a.fYY = (a.fW*(a.fYY + (a.fY-Y)*(a.fY-Y)) + b.fW*(b.fYY + (b.fY-Y)*(b.fY-Y)))/W;
+    a.fY = Y;
+    a.fW = W;
+}
+
+void TStripchart::Limit() {
+    if(!fMaxPts || fDat.size() <= fMaxPts) return;
+    if(fDecimate) {
+        while(fDat.size() > fMaxPts) {
+            size_t n = 0;
+            for(size_t i = 0; i < fDat.size(); i += 2) {
+                fDat[n] = fDat[i];
+                if(i+1 < fDat.size()) Combine(fDat[n], fDat[i+1]);
+                ++n;
+            }
+            fDat.resize(n);
+            fDxMax *= 2;
+            fHasGroup = false;
+        }
+    } else fDat.erase(fDat.begin(), fDat.begin() + (fDat.size() - fMaxPts + fMaxPts/8)); // amortized drop of oldest
+}
+
+void TStripchart::Archive(const SummaryPt& P, Long64_t g) {
+    if(fHasGroup && g == fLastGroup && fDat.size()) Combine(fDat.back(), P);
+    else {
+        fDat.push_back(P);
+        fLastGroup = g;
+        fHasGroup = true;
+        Limit();
+    }
+}
+
+void TStripchart::SetConcurrent(bool c, size_t nthreads) {
+    Flush();
+    if(!c) { fAcc.reset(); return; }
+    if(!(fDxMax > 0)) throw std::logic_error("Concurrent chart accumulation requires window width > 0");
+    fAcc.reset(new ChartAccumulator(fDxMax, [this](int64_t k, const ChartMoments& M) {
+        SummaryPt P;
+        P.fW = M.w;
+        M.xstats(k*fAcc->dx, P.fX, P.fXX);
+        M.ystats(P.fY, P.fYY);
+        Archive(P, Long64_t(std::floor(k*fAcc->dx/fDxMax + 1e-9)));
+    }, nthreads));
+}
@@ -10,6 +10,7 @@
 
 #include <TNamed.h>
 #include <TGraphErrors.h>
+#include "ChartAccumulator.hh"
 
 #include <vector>
 #include <array>
@@ -50,6 +51,22 @@ public:
     /// Summarize window contents to datapoint
     void SummarizeWindow();
 
+    /// enable (or disable) concurrent accumulation on fixed x grid of width fDxMax, for AddPointConcurrent from nthreads threads
+    void SetConcurrent(bool c = true, size_t nthreads = 0);
+    /// thread-safe add data point (concurrent mode); windows archived once all filling threads pass them
+    void AddPointConcurrent(Double_t x, Double_t y, Double_t w = 1.0) { fAcc->add(x, y, w); }
+    /// calling thread has finished AddPointConcurrent
+    void ReleaseThread() { fAcc->release(); }
+    /// archive all concurrent windows (no concurrent adds)
+    void Flush() { if(fAcc) fAcc->flush(); }
+    /// lock for reading archive while concurrent filling continues
+    std::mutex* GetMutex() { return fAcc? &fAcc->getMutex() : nullptr; }
+
+    /// limit archive to n points (0 for unlimited): dropping oldest points, or decimating (merge pairs, doubling fDxMax)
+    void SetMaxPoints(size_t n, bool decimate = false) { fMaxPts = n; fDecimate = decimate; Limit(); }
+    /// combine summary points
+    static void Combine(SummaryPt& a, const SummaryPt& b);
+
 protected:
 
     vector< array<Double_t,3> > fPts;   ///< points in active window waiting to be summarized
@@ -57,6 +74,17 @@ protected:
     Double_t fDxMax;                    ///< change in x to trigger archiving of point data
     vector<SummaryPt> fDat;             ///< archived summary data
 
+    /// append summary point, merging with previous if same (decimated) concurrent grid window
+    void Archive(const SummaryPt& P, Long64_t g);
+    /// apply archive size limit
+    void Limit();
+
+    std::unique_ptr<ChartAccumulator> fAcc; //!< concurrent accumulator
+    size_t fMaxPts = 0;                 //!< maximum archive size (0 for unlimited)
+    bool fDecimate = false;             //!< archive limit by decimation (else drop oldest)
+    Long64_t fLastGroup = 0;            //!< concurrent grid group of last archived point
+    bool fHasGroup = false;             //!< whether fLastGroup is valid
+
     ClassDef(TStripchart,1);
 };
 
@@ -0,0 +1,82 @@
+/// \file ThreadShadowHist.cc
+
+#include "ThreadShadowHist.hh"
+#include "WorkStealingPool.hh"
+#include "to_str.hh"
+#include <TROOT.h>
+#include <unordered_map>
+
+std::atomic<uint64_t> ThreadShadowHist::nextUID{1};
+
+ThreadShadowHist::ThreadShadowHist(TObjCollector& C, TH1* h): OC(C), master(C.addObject(h)), uid(nextUID++) {
+    ROOT::EnableThreadSafety();
+}
+
+ThreadShadowHist::shadow_t& ThreadShadowHist::myShadow() {
+    // per-thread lookup by unique ID (never re-used, so entries from deleted objects are harmless)
+    static thread_local std::unordered_map<uint64_t, shadow_t*> tl;
+    auto& s = tl[uid];
+    if(s) return *s;
+
+    std::lock_guard<std::mutex> l(shMut);
+    shadows.emplace_back(new shadow_t);
+    s = shadows.back().get();
+    s->h = static_cast<TH1*>(master->Clone((string(master->GetName()) + "_thread" + to_str(shadows.size())).c_str()));
+    s->h->SetDirectory(nullptr);
+    s->h->Reset();
+    OC.addDeletable(s->h);
+    return *s;
+}
+
+TH1& ThreadShadowHist::local() {
+    auto& s = myShadow();
+    if(!s.active.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> l(shMut);
+        s.active = true;
+        s.done = false;
+    }
+    return *s.h;
+}
+
+size_t ThreadShadowHist::nShadows() {
+    std::lock_guard<std::mutex> l(shMut);
+    return shadows.size();
+}
+
+void ThreadShadowHist::signal(datastream_signal_t s) {
+    if(s != DATASTREAM_END) return;
+    auto& S = myShadow();
+    {
+        std::lock_guard<std::mutex> l(shMut);
+        S.done = true;
+        for(auto& sh: shadows) if(sh->active && !sh->done) return;
+    }
+    merge(merge_threads);
+}
+
+void ThreadShadowHist::merge(int nthreads) {
+    std::lock_guard<std::mutex> l(shMut);
+    vector<TH1*> v;
+    vector<shadow_t*> vs;
+    for(auto& s: shadows) {
+        if(!s->active) continue;
+        vs.push_back(s.get());
+        v.push_back(s->h);
+    }
+
+    // pairwise reduction tree: v[i] += v[i + d]
+    if(v.size() > 2) {
+        WorkStealingPool P(nthreads);
+        for(size_t d = 1; d < v.size(); d *= 2) {
+            for(size_t i = 0; i + d < v.size(); i += 2*d) P.submit([&v, i, d] { v[i]->Add(v[i + d]); });
+            P.wait_idle();
+        }
+    } else if(v.size() == 2) v[0]->Add(v[1]);
+    if(v.size()) master->Add(v[0]);
+
+    for(auto s: vs) {
+        s->h->Reset();
+        s->done = false;
+        s->active = false;
+    }
+}
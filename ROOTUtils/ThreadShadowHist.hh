@@ -0,0 +1,62 @@
+/// \file ThreadShadowHist.hh Per-thread shadow copies of a TObjCollector histogram, lock-free filling with merge on DATASTREAM_END
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef THREADSHADOWHIST_HH
+#define THREADSHADOWHIST_HH
+
+#include "TObjCollector.hh"
+#include "_DataSink.hh"
+#include <TH1.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/// Per-thread shadow copies of a master histogram, registered through TObjCollector
+/*
+ * Each filling thread calls local() for its own (lazily cloned) copy, filled without locks.
+ * signal(DATASTREAM_END) from a thread marks its copy finished; when all copies filled since the last merge are finished,
+ * they are summed by a pairwise reduction tree into the master histogram, and reset for re-use.
+ * A thread must not fill again between its own END and the merge (e.g. parallel chains ending together).
+ */
+class ThreadShadowHist: public SignalSink {
+public:
+    /// Constructor, registering master histogram h (and later copies) to collector C, which must outlive this
+    ThreadShadowHist(TObjCollector& C, TH1* h);
+
+    /// calling thread's shadow copy, created on first use
+    TH1& local();
+    /// fill calling thread's copy
+    void Fill(double x, double w = 1.) { local().Fill(x, w); }
+
+    /// END from calling thread marks its copy finished; merge when all finished
+    void signal(datastream_signal_t s) override;
+    /// merge all copies into master (caller must ensure no concurrent fills); nthreads for reduction tree (0 for hardware)
+    void merge(int nthreads = 0);
+
+    /// master (merged) histogram
+    TH1& getMaster() { return *master; }
+    /// number of thread copies
+    size_t nShadows();
+
+    int merge_threads = 0;      ///< threads for automatic merge on END
+
+protected:
+    /// one thread's copy
+    struct shadow_t {
+        TH1* h;                 ///< thread copy (owned by collector)
+        std::atomic<bool> active{false};    ///< whether filled since last merge
+        bool done = false;      ///< whether owning thread has signalled END
+    };
+
+    /// calling thread's shadow entry
+    shadow_t& myShadow();
+
+    TObjCollector& OC;          ///< collector owning histograms
+    TH1* master;                ///< merged histogram
+    const uint64_t uid;         ///< unique identifier for thread-local lookup
+    std::mutex shMut;           ///< protects shadows list
+    vector<std::unique_ptr<shadow_t>> shadows;  ///< thread copies
+    static std::atomic<uint64_t> nextUID;   ///< next unique identifier
+};
+
+#endif
@@ -0,0 +1,38 @@
+/// \file ConfigSockOptions.cc
+
+#include "ConfigSockOptions.hh"
+
+void configureSockOptions(SockOptions& O, const Setting& S, const string& key) {
+    if(!S.exists(key)) return;
+    auto& G = S[key];
+
+    G.lookupValue("sndbuf", O.sndbuf);
+    G.lookupValue("rcvbuf", O.rcvbuf);
+    G.lookupValue("keepidle_s", O.keepidle_s);
+    G.lookupValue("keepintvl_s", O.keepintvl_s);
+    G.lookupValue("keepcnt", O.keepcnt);
+    G.lookupValue("busy_poll_us", O.busy_poll_us);
+
+    bool b;
+    if(G.lookupValue("nodelay", b)) O.nodelay = b;
+    if(G.lookupValue("cork", b)) O.cork = b;
+    if(G.lookupValue("keepalive", b)) O.keepalive = b;
+}
+
+void addSockOptionsXML(XMLTag& X, int fd) {
+    if(fd <= 0) return;
+    auto O = SockOptions::effective(fd);
+    auto T = X.addChild(new XMLTag("sockopts"));
+    T->oneline = true;
+    T->addAttr("sndbuf", O.sndbuf);
+    T->addAttr("rcvbuf", O.rcvbuf);
+    T->addAttr("nodelay", O.nodelay);
+    if(O.cork >= 0) T->addAttr("cork", O.cork);
+    T->addAttr("keepalive", O.keepalive);
+    if(O.keepalive > 0) {
+        T->addAttr("keepidle_s", O.keepidle_s);
+        T->addAttr("keepintvl_s", O.keepintvl_s);
+        T->addAttr("keepcnt", O.keepcnt);
+    }
+    if(O.busy_poll_us > 0) T->addAttr("busy_poll_us", O.busy_poll_us);
+}
@@ -0,0 +1,16 @@
+/// \file ConfigSockOptions.hh libconfig configuration and XML reporting of SockOptions
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef CONFIGSOCKOPTIONS_HH
+#define CONFIGSOCKOPTIONS_HH
+
+#include "SockConnection.hh"
+#include "ConfigFactory.hh"
+#include "XMLTag.hh"
+
+/// configure socket options from Setting group S[key]: {sndbuf, rcvbuf, keepidle_s, keepintvl_s, keepcnt, busy_poll_us} integers; {nodelay, cork, keepalive} booleans
+void configureSockOptions(SockOptions& O, const Setting& S, const string& key = "sockopts");
+/// add XML child tag with effective socket options for file descriptor
+void addSockOptionsXML(XMLTag& X, int fd);
+
+#endif
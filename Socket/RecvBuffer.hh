@@ -0,0 +1,57 @@
+/// \file RecvBuffer.hh Aligned, capacity-retaining buffer for received data blocks
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef RECVBUFFER_HH
+#define RECVBUFFER_HH
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+/// Aligned receive buffer: resizing re-uses capacity, without initializing or preserving contents
+class RecvBuffer {
+public:
+    /// storage alignment [bytes]
+    static constexpr size_t align = 64;
+
+    /// set size for n bytes (to be overwritten), reallocating if capacity exceeded; return data write point
+    char* resize(size_t n) {
+        if(n > cap) {
+            auto c = std::max(n, 2*cap);
+            c = (c + align - 1)/align * align;
+            void* p = nullptr;
+            if(posix_memalign(&p, align, c)) throw std::bad_alloc();
+            buf.reset(static_cast<char*>(p));
+            cap = c;
+        }
+        sz = n;
+        return buf.get();
+    }
+    /// empty contents, retaining capacity
+    void clear() { sz = 0; }
+    /// release storage
+    void release() { buf.reset(); sz = cap = 0; }
+
+    /// data
+    char* data() { return buf.get(); }
+    /// data, read-only
+    const char* data() const { return buf.get(); }
+    /// data viewed as (suitably aligned) array of T
+    template<typename T>
+    const T* as() const {
+        static_assert(alignof(T) <= align, "RecvBuffer alignment insufficient for type");
+        return reinterpret_cast<const T*>(buf.get());
+    }
+    /// size [bytes]
+    size_t size() const { return sz; }
+    /// allocated capacity [bytes]
+    size_t capacity() const { return cap; }
+
+protected:
+    std::unique_ptr<char, void(*)(void*)> buf{nullptr, free};   ///< aligned storage
+    size_t sz = 0;      ///< data size [bytes]
+    size_t cap = 0;     ///< allocated capacity [bytes]
+};
+
+#endif
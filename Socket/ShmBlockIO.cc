@@ -0,0 +1,53 @@
+/// \file ShmBlockIO.cc
+
+#include "ShmBlockIO.hh"
+#include <chrono>
+#include <stdint.h>
+#include <unistd.h> // for usleep(...)
+
+bool ShmBlockWriter::send(const char* d, size_t n, double wait_s) {
+    int32_t bsize = n;
+    if(n + sizeof(bsize) > R.capacity() || size_t(bsize) != n) throw std::runtime_error("Oversized block for shared memory ring '" + R.name + "'");
+
+    // whole frame known to fit (only this writer consumes free space), so writes below do not wait
+    if(R.space() < n + sizeof(bsize)) {
+        auto t1 = std::chrono::steady_clock::now() + std::chrono::duration<double>(wait_s);
+        while(R.space() < n + sizeof(bsize)) {
+            if(!(wait_s > 0) || std::chrono::steady_clock::now() > t1) {
+                ++n_dropped;
+                return false;
+            }
+            usleep(50);
+        }
+    }
+    R.write(&bsize, sizeof(bsize));
+    R.write(d, n);
+    ++n_sent;
+    bytes_sent += n;
+    return true;
+}
+
+void ShmBlockWriter::end() {
+    int32_t z = 0;
+    if(ended || R.space() < sizeof(z)) return;
+    R.write(&z, sizeof(z));
+    ended = true;
+}
+
+bool ShmBlockReader::readBlock(vector<char>& v) {
+    int32_t bsize = 0;
+    while(R.available() < sizeof(bsize)) {
+        if(runstat == STOP_REQUESTED) return false;
+        usleep(50);
+    }
+    R.read(&bsize, sizeof(bsize));
+    if(bsize <= 0) return false;
+    v.resize(bsize);
+    R.read(v.data(), bsize); // rest of frame follows immediately
+    ++n_received;
+    return true;
+}
+
+void ShmBlockReader::threadjob() {
+    while(readBlock(block) && process_v(block)) { }
+}
@@ -0,0 +1,53 @@
+/// \file ShmBlockIO.hh Block transport (BlockHandler framing: int32_t bsize, data[bsize]) over shared-memory ShmRing, for same-host consumers
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SHMBLOCKIO_HH
+#define SHMBLOCKIO_HH
+
+#include "ShmBinaryIO.hh"
+#include "Threadworker.hh"
+
+/// Writer of framed blocks into named ShmRing; never blocks longer than requested, dropping blocks that do not fit
+class ShmBlockWriter {
+public:
+    /// Constructor, creating or attaching to named ring
+    explicit ShmBlockWriter(const string& nm, size_t cap = 1 << 24): R(nm, cap) { }
+    /// Destructor: sends end-of-stream marker if space
+    ~ShmBlockWriter() { end(); }
+
+    /// write framed block, waiting up to wait_s [s] for space; false (and counted) if dropped
+    bool send(const char* d, size_t n, double wait_s = 0);
+    /// send end-of-stream marker (zero-size block), if space
+    void end();
+
+    size_t n_sent = 0;      ///< blocks written
+    size_t bytes_sent = 0;  ///< data bytes written
+    size_t n_dropped = 0;   ///< blocks dropped for insufficient space
+    ShmRing R;              ///< output ring
+
+protected:
+    bool ended = false;     ///< whether end marker was sent
+};
+
+/// Receiver of framed blocks from named ShmRing, like BlockHandler's process_v; ring unlinked on destruction
+class ShmBlockReader: public Threadworker {
+public:
+    /// Constructor, creating or attaching to named ring
+    explicit ShmBlockReader(const string& nm, size_t cap = 1 << 24): R(nm, cap, true) { }
+
+    /// receive blocks until end-of-stream marker, process_v returning false, or stop requested
+    void threadjob() override;
+    /// blocking receive of next block into v, polling for stop request; false at end of stream
+    bool readBlock(vector<char>& v);
+
+    size_t n_received = 0;  ///< blocks received
+
+protected:
+    /// Process received block; return false to end communication
+    virtual bool process_v(const vector<char>& v) { return v.size(); }
+
+    ShmRing R;              ///< input ring
+    vector<char> block;     ///< received block
+};
+
+#endif
@@ -12,6 +12,9 @@
 #include <errno.h>  // for errno
 #include <poll.h>   // for poll(...)
 #include <signal.h> // for SIGPIPE
+#include <sys/socket.h> // for setsockopt(...)
+#include <netinet/in.h> // for IPPROTO_TCP
+#include <netinet/tcp.h> // for TCP_NODELAY, ...
 
 #ifdef __APPLE__
 #define OR_POLLRDHUP
@@ -19,8 +22,8 @@
 #define OR_POLLRDHUP | POLLRDHUP
 #endif
 
-void SockFD::open_sockfd() {
-    sockfd = socket(AF_INET, SOCK_STREAM, 0);
+void SockFD::open_sockfd(int domain) {
+    sockfd = socket(domain, SOCK_STREAM, 0);
     if(sockfd < 0) {
         sockfd = 0;
         throw sockFDerror(*this, "Cannot open any socket");
@@ -64,13 +67,14 @@ size_t SockFD::sockread(char* buff, size_t nbytes, bool fail_ok) {
             if(fail_ok) return nread;
             throw sockFDerror(*this, "poll() returned " + to_str(ret));
         }
-        if(!(pfd.revents & POLLIN) || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL OR_POLLRDHUP))) {
+        // hang-up with POLLIN still has buffered data to read; end-of-stream shows as zero-length read
+        if(!(pfd.revents & POLLIN) || (pfd.revents & (POLLERR | POLLNVAL))) {
             if(fail_ok) return nread;
-            if(!(pfd.revents & POLLIN)) throw sockFDerror(*this, "poll() results lack POLLIN");
             if(pfd.revents & POLLERR) throw sockFDerror(*this, "poll() returned POLERR");
-            if(pfd.revents & POLLHUP) throw sockFDerror(*this, "poll() returned POLHUP");
             if(pfd.revents & POLLNVAL) throw sockFDerror(*this, "poll() returned POLLNVAL");
-            throw sockFDerror(*this, "poll() returned POLLRDHUP");
+            if(pfd.revents & POLLHUP) throw sockFDerror(*this, "poll() returned POLHUP");
+            if(pfd.revents & (0 OR_POLLRDHUP)) throw sockFDerror(*this, "poll() returned POLLRDHUP");
+            throw sockFDerror(*this, "poll() results lack POLLIN");
         }
 
         auto len = read(sockfd, buff+nread, nbytes-nread);
@@ -78,6 +82,10 @@ size_t SockFD::sockread(char* buff, size_t nbytes, bool fail_ok) {
             if(fail_ok) return nread;
             throw sockFDerror(*this, "Failed socket read, error " + to_str(len));
         }
+        if(!len) {
+            if(fail_ok) return nread;
+            throw sockFDerror(*this, "connection closed by peer");
+        }
         nread += len;
         if(nread != nbytes) usleep(1000);
     }
@@ -96,7 +104,77 @@ int SockFD::awaitConnection() {
 
 //----------------------------------
 
+/// set integer option, warning on failure
+static void setsockopt_int(int fd, int level, int opt, int v, const char* name) {
+    if(setsockopt(fd, level, opt, &v, sizeof(v)))
+        fprintf(stderr, "Warning: socket %i option %s = %i rejected (error %i)\n", fd, name, v, errno);
+}
+
+/// get integer option; -1 if unavailable
+static int getsockopt_int(int fd, int level, int opt) {
+    int v = -1;
+    socklen_t l = sizeof(v);
+    if(getsockopt(fd, level, opt, &v, &l)) return -1;
+    return v;
+}
+
+void SockOptions::apply(int fd, bool tcp) const {
+    if(sndbuf > 0) setsockopt_int(fd, SOL_SOCKET, SO_SNDBUF, sndbuf, "SO_SNDBUF");
+    if(rcvbuf > 0) setsockopt_int(fd, SOL_SOCKET, SO_RCVBUF, rcvbuf, "SO_RCVBUF");
+#ifdef SO_BUSY_POLL
+    if(busy_poll_us > 0) setsockopt_int(fd, SOL_SOCKET, SO_BUSY_POLL, busy_poll_us, "SO_BUSY_POLL");
+#endif
+    if(!tcp) return;
+
+    if(nodelay >= 0) setsockopt_int(fd, IPPROTO_TCP, TCP_NODELAY, nodelay, "TCP_NODELAY");
+    if(keepalive >= 0) setsockopt_int(fd, SOL_SOCKET, SO_KEEPALIVE, keepalive, "SO_KEEPALIVE");
+#ifdef TCP_KEEPIDLE
+    if(keepidle_s > 0) setsockopt_int(fd, IPPROTO_TCP, TCP_KEEPIDLE, keepidle_s, "TCP_KEEPIDLE");
+#endif
+#ifdef TCP_KEEPINTVL
+    if(keepintvl_s > 0) setsockopt_int(fd, IPPROTO_TCP, TCP_KEEPINTVL, keepintvl_s, "TCP_KEEPINTVL");
+#endif
+#ifdef TCP_KEEPCNT
+    if(keepcnt > 0) setsockopt_int(fd, IPPROTO_TCP, TCP_KEEPCNT, keepcnt, "TCP_KEEPCNT");
+#endif
+}
+
+SockOptions SockOptions::effective(int fd) {
+    SockOptions O;
+    O.sndbuf = getsockopt_int(fd, SOL_SOCKET, SO_SNDBUF);
+    O.rcvbuf = getsockopt_int(fd, SOL_SOCKET, SO_RCVBUF);
+    O.nodelay = getsockopt_int(fd, IPPROTO_TCP, TCP_NODELAY);
+#ifdef TCP_CORK
+    O.cork = getsockopt_int(fd, IPPROTO_TCP, TCP_CORK);
+#endif
+    O.keepalive = getsockopt_int(fd, SOL_SOCKET, SO_KEEPALIVE);
+#ifdef TCP_KEEPIDLE
+    O.keepidle_s = getsockopt_int(fd, IPPROTO_TCP, TCP_KEEPIDLE);
+#endif
+#ifdef TCP_KEEPINTVL
+    O.keepintvl_s = getsockopt_int(fd, IPPROTO_TCP, TCP_KEEPINTVL);
+#endif
+#ifdef TCP_KEEPCNT
+    O.keepcnt = getsockopt_int(fd, IPPROTO_TCP, TCP_KEEPCNT);
+#endif
+#ifdef SO_BUSY_POLL
+    O.busy_poll_us = getsockopt_int(fd, SOL_SOCKET, SO_BUSY_POLL);
+#endif
+    return O;
+}
+
+//----------------------------------
+
 void SockConnection::configure_host() {
+    if(isUnix()) {
+        auto p = host.substr(5);
+        bzero((char*) &unix_addr, sizeof(unix_addr));
+        if(p.empty() || p.size() >= sizeof(unix_addr.sun_path)) throw sockerror(*this, "Invalid unix socket path '" + p + "'");
+        unix_addr.sun_family = AF_UNIX;
+        strncpy(unix_addr.sun_path, p.c_str(), sizeof(unix_addr.sun_path) - 1);
+        return;
+    }
+
     bzero((char*) &serv_addr, sizeof(serv_addr));
     serv_addr.sin_family = AF_INET;
     serv_addr.sin_port = htons(port); // host to network byte order
@@ -109,10 +187,27 @@ void SockConnection::configure_host() {
     } else serv_addr.sin_addr.s_addr = htonl(INADDR_ANY); // default for this machine
 }
 
+const struct sockaddr* SockConnection::addr(socklen_t& l) const {
+    if(isUnix()) {
+        l = sizeof(unix_addr);
+        return (const struct sockaddr*) &unix_addr;
+    }
+    l = sizeof(serv_addr);
+    return (const struct sockaddr*) &serv_addr;
+}
+
 void SockConnection::create_socket() {
-    open_sockfd();
+    open_sockfd(isUnix()? AF_UNIX : AF_INET);
     configure_host();
-    int rc = bind(sockfd, (struct sockaddr *) &serv_addr, sizeof(serv_addr));
+    if(isUnix()) ::unlink(unix_addr.sun_path); // remove stale socket file left by previous server
+    else {
+        int one = 1; // allow re-binding port while closed connections linger in TIME_WAIT
+        setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+    sockopts.apply(sockfd, !isUnix()); // before listen(), so buffer sizes (and TCP window scaling) carry to accepted connections
+    socklen_t l;
+    auto a = addr(l);
+    int rc = bind(sockfd, a, l);
     if(rc < 0) {
         close_socket();
         throw sockerror(*this, "Cannot bind to socket (error "+to_str(rc)+")");
@@ -120,9 +215,12 @@ void SockConnection::create_socket() {
 }
 
 void SockConnection::connect_to_socket() {
-    open_sockfd();
+    open_sockfd(isUnix()? AF_UNIX : AF_INET);
     configure_host();
-    int rc = connect(sockfd, (struct sockaddr *)&serv_addr, sizeof(serv_addr));
+    sockopts.apply(sockfd, !isUnix()); // before connect(), for TCP window scaling with large buffers
+    socklen_t l;
+    auto a = addr(l);
+    int rc = connect(sockfd, a, l);
     if(rc < 0) {
         close_socket();
         throw sockerror(*this, "Cannot connect to socket (error "+to_str(rc)+")");
@@ -4,11 +4,35 @@
 #define SOCKCONNECTION_HH
 
 #include <netdb.h>  // for sockaddr_in, hostent
+#include <sys/un.h> // for sockaddr_un
 #include <unistd.h> // for write(...), close(...), usleep(n)
 #include <stdexcept>
+#include <memory>
+#include <vector>
 
 #include "to_str.hh"
 
+/// immutable, reference-counted data block, shared between output queues of many connections
+typedef std::shared_ptr<const std::vector<char>> sockblock_t;
+
+/// TCP socket options; defaults leave system settings unchanged
+struct SockOptions {
+    int sndbuf = 0;         ///< SO_SNDBUF send buffer size [bytes]; 0 for default
+    int rcvbuf = 0;         ///< SO_RCVBUF receive buffer size [bytes]; 0 for default
+    int nodelay = -1;       ///< TCP_NODELAY (no Nagle coalescing; for latency-sensitive control traffic): 1 on, 0 off, -1 default
+    int cork = -1;          ///< TCP_CORK (Linux) held around each SockOutBuffer batch of writes: 1 on, 0 off, -1 default
+    int keepalive = -1;     ///< SO_KEEPALIVE: 1 on, 0 off, -1 default
+    int keepidle_s = 0;     ///< TCP_KEEPIDLE connection idle time before keepalive probes [s]; 0 for default
+    int keepintvl_s = 0;    ///< TCP_KEEPINTVL interval between keepalive probes [s]; 0 for default
+    int keepcnt = 0;        ///< TCP_KEEPCNT unanswered probes before dropping connection; 0 for default
+    int busy_poll_us = 0;   ///< SO_BUSY_POLL (Linux) receive busy-polling time [us]; 0 for default
+
+    /// apply non-default options to socket (TCP-level options only if tcp); warns on options rejected by system
+    void apply(int fd, bool tcp = true) const;
+    /// read back effective values from socket (system may adjust requests, e.g. Linux doubles buffer sizes)
+    static SockOptions effective(int fd);
+};
+
 /// read/write from a socket file descriptor
 class SockFD {
 public:
@@ -40,11 +64,11 @@ public:
     };
 
 protected:
-    /// open socket file descriptor
-    void open_sockfd();
+    /// open socket file descriptor, in address family domain
+    void open_sockfd(int domain = AF_INET);
 };
 
-/// Socket connection wrapper
+/// Socket connection wrapper: TCP to host:port, or unix-domain socket for host "unix:<path>"
 class SockConnection: public SockFD {
 public:
 
@@ -59,9 +83,12 @@ public:
     void connect_to_socket(const string& _host, int _port) { host = _host; port = _port; connect_to_socket(); }
     /// bind to socket to accept connections; throw on failure
     virtual void create_socket();
+    /// whether host specifies a unix-domain socket path, "unix:<path>"
+    bool isUnix() const { return !host.compare(0, 5, "unix:"); }
 
     string host;    ///< hostname
     int port = 0;   ///< socket port
+    SockOptions sockopts;   ///< options applied by create_socket() and connect_to_socket()
 
     /// error reporting for socket operations
     class sockerror: public sockFDerror {
@@ -75,7 +102,11 @@ protected:
     /// get host info for server
     void configure_host();
 
+    /// configured server address, and its length
+    const struct sockaddr* addr(socklen_t& l) const;
+
     struct sockaddr_in serv_addr;       ///< server address data
+    struct sockaddr_un unix_addr;       ///< unix-domain socket address
     struct hostent* server = nullptr;   ///< server
 };
 
@@ -1,16 +1,59 @@
 /// \file SockDataSink.hh DataSink<> transmitting over socket
 // Michael P. Mendenhall, LLNL 2021
 
+#ifndef SOCKDATASINK_HH
+#define SOCKDATASINK_HH
+
 #include "SockBinIO.hh"
+#include "ConfigSockOptions.hh"
+#include "BlockCompress.hh"
 #include "DataSink.hh"
+#include "DataSource.hh"
 #include "ConfigThreader.hh"
 #include "GlobalArgs.hh"
 #include "XMLTag.hh"
+#include <chrono>
+
+// Frame stream: sendWireHeader(), uint32_t sizeof(T), uint8_t BlockCodec;
+// then frames of datastream_signal_t, uint32_t number of items, vector<char> payload.
+// Payload is items' bytes (bulk-copyable T) or BinaryWriter serialization,
+// compressed by compress_block() (with BlockHeader) unless codec is CODEC_NONE.
+
+/// batch payload, as one block for bulk-copyable T
+template<typename T, typename std::enable_if<IS_BULK_COPYABLE(T)>::type* = nullptr>
+std::pair<const char*, size_t> sockframe_payload(const vector<T>& v, BinarySerializer&) {
+    return {reinterpret_cast<const char*>(v.data()), v.size()*sizeof(T)};
+}
+/// batch payload, serialized item by item
+template<typename T, typename std::enable_if<!IS_BULK_COPYABLE(T)>::type* = nullptr>
+std::pair<const char*, size_t> sockframe_payload(const vector<T>& v, BinarySerializer& S) {
+    S.buf().clear();
+    for(auto& x: v) S.send(x);
+    return {S.buf().data(), S.buf().size()};
+}
 
-/// DataSink<> transmission link over socket connection
+/// unpack n items from payload, as one copy for bulk-copyable T
+template<typename T, typename std::enable_if<IS_BULK_COPYABLE(T)>::type* = nullptr>
+void sockframe_unpack(const vector<char>& p, size_t n, vector<T>& v) {
+    if(p.size() != n*sizeof(T)) throw std::runtime_error("Mismatched socket frame payload size");
+    v.resize(n);
+    if(n) std::memcpy(v.data(), p.data(), p.size());
+}
+/// unpack n items from serialized payload
+template<typename T, typename std::enable_if<!IS_BULK_COPYABLE(T)>::type* = nullptr>
+void sockframe_unpack(const vector<char>& p, size_t n, vector<T>& v) {
+    MemBReader R(p.data(), p.size());
+    v.resize(n);
+    for(auto& x: v) R.receive(x);
+}
+
+/// DataSink<> transmission link over socket connection, in (optionally compressed) batched frames
 template<typename T>
 class SockDataSink: public Configurable, public DataSink<T>, public SockBinWrite, public XMLProvider {
 public:
+    /// item type
+    typedef typename std::remove_const<T>::type val_t;
+
     /// Constructor
     explicit SockDataSink(const Setting& S):
     Configurable(S), SockBinWrite("localhost", 50000), XMLProvider("SockDataSink") {
@@ -18,27 +61,193 @@ public:
         optionalGlobalArg("outhost", host, "data output host");
         S.lookupValue("port", port);
         optionalGlobalArg("outport", port, "data output port");
+
+        S.lookupValue("nvbuff", nvbuff);
+        S.lookupValue("batch_bytes", batch_bytes);
+        S.lookupValue("latency_ms", latency_ms);
+        string c = "none";
+        S.lookupValue("compress", c);
+        optionalGlobalArg("outcompress", c, "data output frame compression (none, lz4, zlib, zstd)");
+        codec = codec_named(c);
+        S.lookupValue("level", level);
+        configureSockOptions(sockopts, S);
+
+        nmax = std::max(1, batch_bytes/int(sizeof(val_t)));
+        if(nvbuff > 0) nmax = std::min(nmax, size_t(nvbuff));
     }
 
-    /// handle datastream marker signals: always sends data
+    /// handle datastream marker signals: always sends a frame
     void signal(datastream_signal_t s) override {
-        if(s == DATASTREAM_INIT) connect_to_socket();
-        start_wtx();
-        send(vbuff);
-        send(s);
-        end_wtx();
-        vbuff.clear();
+        if(s == DATASTREAM_INIT) {
+            connect_to_socket();
+            start_wtx();
+            sendWireHeader();
+            send<uint32_t>(sizeof(val_t));
+            send<uint8_t>(codec);
+            end_wtx();
+        }
+        sendFrame(s);
         if(s == DATASTREAM_END) finish_mythread();
     }
 
+    /// accumulate item, sending frame at size limit or latency deadline
     void push(T& o) override {
+        if(vbuff.empty()) t0 = std::chrono::steady_clock::now();
         vbuff.push_back(o);
-        if(int(vbuff.size()) >= nvbuff) signal(DATASTREAM_NOOP);
+        checkSend();
+    }
+    /// accumulate batch of items
+    void push_batch(T* o, size_t n) override {
+        while(n) {
+            if(vbuff.empty()) t0 = std::chrono::steady_clock::now();
+            auto m = std::min(n, nmax - std::min(nmax, vbuff.size()));
+            if(!m) m = 1;
+            vbuff.insert(vbuff.end(), o, o + m);
+            o += m;
+            n -= m;
+            checkSend();
+        }
+    }
+
+protected:
+    /// send frame if full, or (checked every 64 items) past latency deadline
+    void checkSend() {
+        auto n = vbuff.size();
+        if(n >= nmax || (latency_ms > 0 && !(n % 64) &&
+           std::chrono::steady_clock::now() - t0 > std::chrono::duration<double, std::milli>(latency_ms))) sendFrame(DATASTREAM_NOOP);
+    }
+
+    /// send buffered items and signal as one frame
+    void sendFrame(datastream_signal_t s) {
+        auto p = sockframe_payload(vbuff, ser);
+        start_zwtx();
+        send(s);
+        send<uint32_t>(vbuff.size());
+        if(codec == CODEC_NONE) {
+            send<uint64_t>(p.second);
+            append_ref(p.first, p.second);
+            nwire += p.second;
+        } else {
+            cbuff.clear();
+            compress_block(p.first, p.second, cbuff, codec, level);
+            send(cbuff);
+            nwire += cbuff.size();
+        }
+        end_wtx();
+        nraw += p.second;
+        nitems += vbuff.size();
+        ++nframes;
+        vbuff.clear();
+    }
+
+    /// build XML output data
+    void _makeXML(XMLTag& X) override {
+        X.addAttr("host", host);
+        X.addAttr("port", port);
+        X.addAttr("codec", int(codec));
+        X.addAttr("nframes", nframes);
+        X.addAttr("nitems", nitems);
+        X.addAttr("bytes", nraw);
+        X.addAttr("wire_bytes", nwire);
+        X.addAttr("dropped", n_write_fails);
+        addSockOptionsXML(X, sockfd);
     }
 
+    int nvbuff = 0;             ///< maximum number of items per frame (0 for batch_bytes limit only)
+    int batch_bytes = 1 << 16;  ///< frame size target [bytes]
+    double latency_ms = 10;     ///< maximum delay of buffered items (checked on push) [ms]; 0 for none
+    BlockCodec codec = CODEC_NONE;  ///< frame compression
+    int level = -1;             ///< compression level (-1 for codec default)
+    size_t nmax = 1;            ///< items per frame
+    vector<val_t> vbuff;        ///< collect multiple items to buffer
+    std::chrono::steady_clock::time_point t0;   ///< time of first buffered item
+    BinarySerializer ser;       ///< payload serializer for non-bulk-copyable items
+    vector<char> cbuff;         ///< compressed frame
+    size_t nframes = 0;         ///< frames sent
+    size_t nitems = 0;          ///< items sent
+    size_t nraw = 0;            ///< uncompressed payload bytes
+    size_t nwire = 0;           ///< payload bytes after compression
+};
+
+/// Reader for SockDataSink frame stream
+template<typename T>
+class SockFrameReader: public SockBinRead {
+public:
+    /// item type
+    typedef typename std::remove_const<T>::type val_t;
+
+    /// Constructor, with connected socket
+    explicit SockFrameReader(int sfd = 0): SockBinRead(sfd) { }
+
+    /// receive stream header; throws std::runtime_error on format, item size, or codec mismatch
+    void readHeader() {
+        receiveWireHeader();
+        if(receive<uint32_t>() != sizeof(val_t)) throw std::runtime_error("Mismatched socket frame item size");
+        codec = BlockCodec(receive<uint8_t>());
+        if(!codec_available(codec)) throw std::runtime_error("Unavailable socket frame codec " + to_str(int(codec)));
+    }
+
+    /// receive next frame items and signal
+    void readFrame(vector<val_t>& v, datastream_signal_t& s) {
+        receive(s);
+        auto n = receive<uint32_t>();
+        if(codec == CODEC_NONE) {
+            receive(f);
+            sockframe_unpack(f, n, v);
+        } else {
+            receive(f);
+            BlockHeader H;
+            if(f.size() < sizeof(H)) throw std::runtime_error("Truncated socket frame");
+            std::memcpy(&H, f.data(), sizeof(H));
+            if(!H.valid() || H.csize != f.size() - sizeof(H)) throw std::runtime_error("Corrupted socket frame header");
+            raw.resize(H.usize);
+            decompress_block(H, f.data() + sizeof(H), raw.data());
+            sockframe_unpack(raw, n, v);
+        }
+        ++nframes;
+        nitems += n;
+    }
+
+    BlockCodec codec = CODEC_NONE;  ///< stream codec
+    size_t nframes = 0;             ///< frames received
+    size_t nitems = 0;              ///< items received
+
 protected:
-    int nvbuff = 128;   ///< number of items to group into packet
-    vector<typename std::remove_const<T>::type> vbuff;  ///< collect multiple items to buffer
+    vector<char> f;     ///< received frame
+    vector<char> raw;   ///< decompressed payload
+};
+
+/// DataSource<> of items received from SockDataSink (signals other than DATASTREAM_END are skipped)
+template<typename T>
+class SockFrameSource: public DataSource<T> {
+public:
+    /// item type
+    typedef typename DataSource<T>::val_t val_t;
+
+    /// Constructor, with connected socket
+    explicit SockFrameSource(int sfd): R(sfd) { R.readHeader(); }
+
+    /// get next item; false at end of stream
+    bool next(val_t& o) override {
+        while(i >= v.size()) {
+            if(ended) return false;
+            datastream_signal_t s;
+            R.readFrame(v, s);
+            i = 0;
+            ended = s == DATASTREAM_END;
+        }
+        o = std::move(v[i++]);
+        return true;
+    }
+    /// items remaining in current frame
+    size_t entries() override { return v.size() - i; }
+
+    SockFrameReader<T> R;   ///< frame reader
+
+protected:
+    vector<val_t> v;        ///< current frame items
+    size_t i = 0;           ///< position in frame
+    bool ended = false;     ///< whether end of stream received
 };
 
 /// Base class configurable multithreaded socket server
@@ -51,6 +260,7 @@ public:
         optionalGlobalArg("inhost", host, "data source host");
         S.lookupValue("port", port);
         optionalGlobalArg("inport", port, "data source port");
+        configureSockOptions(sockopts, S);
     }
 
     /// Destructor
@@ -87,17 +297,17 @@ public:
     void run() override {
         if(!this->nextSink) throw std::runtime_error("missing next output");
         create_socket();
-        SockBinRead SBR(awaitConnection());
+        SockFrameReader<T> R(awaitConnection());
+        R.readHeader();
 
         vector<typename std::remove_const<T>::type> v;
         datastream_signal_t s = DATASTREAM_NOOP;
         while(s != DATASTREAM_END) {
-            SBR.receive(v);
-            SBR.receive(s);
-            for(auto& i: v) this->nextSink->push(i);
+            R.readFrame(v, s);
+            if(v.size()) this->nextSink->push_batch(v.data(), v.size());
             if(s != DATASTREAM_NOOP) this->nextSink->signal(s);
         }
     }
 };
 
-
+#endif
@@ -0,0 +1,160 @@
+/// \file SockDataSource.hh Receive SockDataSink streams from one or more senders, merged through Collator into DataSink<> chain
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SOCKDATASOURCE_HH
+#define SOCKDATASOURCE_HH
+
+#include "SockDataSink.hh"
+#include "Collator.hh"
+#include "LocklessCircleBuffer.hh"
+#include <memory>
+#include <thread>
+#include <stdio.h>
+
+/// Receive SockDataSink frame streams on nsenders connections, merging (individually ordered) streams through Collator to nextSink
+/// each connection is decoded on its own reader thread into a frame ring buffer, drained into its Collator input by the buffer thread;
+/// sender signals other than DATASTREAM_END are not forwarded (merged output receives INIT, FLUSH, END from run())
+template<typename T, typename ordering_t = typename std::remove_pointer<T>::type::ordering_t>
+class SockDataSource: public Configurable, public SockConnection, virtual public XMLProvider, public SinkUser<const T> {
+public:
+    using SinkUser<const T>::nextSink;
+    /// item type
+    typedef typename std::remove_const<T>::type val_t;
+
+    /// Constructor
+    explicit SockDataSource(const Setting& S, bool doMakeNext = true):
+    XMLProvider("SockDataSource"), Configurable(S), SockConnection("localhost", 50000) {
+        S.lookupValue("host", host);
+        optionalGlobalArg("inhost", host, "data source host");
+        S.lookupValue("port", port);
+        optionalGlobalArg("inport", port, "data source port");
+        S.lookupValue("nsenders", nsenders);
+        optionalGlobalArg("insenders", nsenders, "number of data source connections to merge");
+        S.lookupValue("nframes", nframes);
+        S.lookupValue("timeout_ms", read_timeout_ms);
+        configureSockOptions(sockopts, S);
+
+        if(doMakeNext && S.exists("next")) this->createOutput(S["next"]);
+    }
+
+    /// Accept nsenders connections, merging their streams to nextSink until all have ended
+    void run() override {
+        if(!nextSink) throw std::runtime_error("Socket data source 'next' output not configured.");
+        if(nsenders < 1) throw std::runtime_error("Socket data source run without senders.");
+
+        C.setNext(nextSink);
+        C.setOwnsNext(false);
+        nextSink->signal(DATASTREAM_INIT);
+
+        create_socket();
+        vector<std::thread> readers;
+        for(int i = 0; i < nsenders; ++i) {
+            // start reading each sender immediately; merge waits until all are connected
+            auto fd = awaitConnection();
+            sockopts.apply(fd, !isUnix());
+            inputs.emplace_back(new input_t(C, fd, nframes));
+            auto& I = *inputs.back();
+            I.R.read_timeout_ms = read_timeout_ms;
+            I.launch_mythread();
+            readers.emplace_back([&I] { I.readLoop(); });
+            printf("Receiving data stream %i/%i on socket %i\n", i + 1, nsenders, I.R.sockfd);
+        }
+        close_socket();
+
+        C.launch_mythread();
+        for(auto& t: readers) t.join();
+        C.finish_mythread();
+        nextSink->signal(DATASTREAM_FLUSH);
+        nextSink->signal(DATASTREAM_END);
+        C.getNext() = nullptr;
+    }
+
+    int nsenders = 1;       ///< number of sender connections to merge
+    int nframes = 64;       ///< ring buffer capacity for decoded frames, per sender
+
+protected:
+    /// decoded frame
+    struct frame_t {
+        vector<val_t> v;    ///< frame items
+        datastream_signal_t s = DATASTREAM_NOOP;    ///< frame signal
+    };
+
+    /// Collator with locked input addition and end-of-input marking
+    class MergeCollator: public Collator<T, ordering_t> {
+    public:
+        /// add input (thread-safe while other inputs are pushing)
+        size_t addInput() {
+            lock_guard<mutex> l(this->inputMut);
+            return this->add_input();
+        }
+        /// stop waiting on finished input
+        void release(size_t nI) {
+            lock_guard<mutex> l(this->inputMut);
+            this->change_required(nI, -1);
+            this->inputReady.notify_one();
+        }
+    };
+
+    /// one sender connection: frames read into ring buffer, pushed to Collator input from buffer thread
+    class input_t: public LocklessCircleBuffer<frame_t> {
+    public:
+        /// Constructor, with connected socket
+        input_t(MergeCollator& c, int fd, size_t n): LocklessCircleBuffer<frame_t>(n), R(fd), C(c), nI(c.addInput()) { }
+
+        /// reader thread: decode frames until end of stream; then drain buffer and release Collator input
+        void readLoop() {
+            try {
+                R.readHeader();
+                datastream_signal_t s = DATASTREAM_NOOP;
+                while(s != DATASTREAM_END) {
+                    frame_t* f = nullptr;
+                    while(!(f = this->get_writepoint(1.))) { }
+                    R.readFrame(f->v, s);
+                    f->s = s;
+                    this->finish_write();
+                }
+            } catch(std::exception& e) {
+                fprintf(stderr, "Data stream on socket %i ended: %s\n", R.sockfd, e.what());
+                ended_ok = false;
+            }
+            this->finish_mythread();
+            C.release(nI);
+        }
+
+        SockFrameReader<T> R;   ///< frame stream reader
+        size_t nitems = 0;      ///< items pushed to Collator
+        bool ended_ok = true;   ///< whether stream ended with DATASTREAM_END
+
+    protected:
+        /// push frame items to Collator input
+        void process_item() override {
+            auto& v = this->current.v;
+            if(v.size()) C.qpush_move(nI, v.data(), v.size());
+            nitems += v.size();
+        }
+
+        MergeCollator& C;       ///< merging Collator
+        const size_t nI;        ///< Collator input number
+    };
+
+    /// build XML output data
+    void _makeXML(XMLTag& X) override {
+        X.addAttr("port", port);
+        X.addAttr("nsenders", nsenders);
+        for(auto& I: inputs) {
+            auto F = X.addChild(new XMLTag("sender"));
+            F->addAttr("codec", int(I->R.codec));
+            F->addAttr("nframes", I->R.nframes);
+            F->addAttr("nitems", I->nitems);
+            if(!I->ended_ok) F->addAttr("ended", "error");
+            addSockOptionsXML(*F, I->R.sockfd);
+        }
+        C.qprof.addXML(X);
+        C.mem.addXML(X);
+    }
+
+    MergeCollator C;        ///< merge of sender streams
+    vector<std::unique_ptr<input_t>> inputs;    ///< sender connections
+};
+
+#endif
@@ -3,17 +3,66 @@
 
 #include "SockDistributor.hh"
 #include <cassert>
+#include <errno.h>  // for errno
+#include <poll.h>   // for poll(...)
 
-void SockDistribServer::sendData(const char* d, size_t n) {
+void SockDistribHandler::threadjob() {
+    SOB.launch_mythread();
+    struct pollfd pfd;
+    pfd.fd = sockfd;
+    pfd.events = POLLIN;
+    while(runstat != STOP_REQUESTED && !SOB.isDisconnected()) {
+        auto ret = poll(&pfd, 1, 100);
+        if(ret < 0 && errno != EINTR) break;
+        if(ret <= 0) continue;
+        char buff[256];
+        if(read(sockfd, buff, sizeof(buff)) <= 0) break; // closed by client
+    }
+    SOB.disconnect();
+    SOB.finish_mythread();
+}
+
+void SockDistribServer::sendBlock(const sockblock_t& b) {
     lock_guard<mutex> cl(inputMut);
-    //printf("Sending %zu bytes data to %zu connections\n", n, myConns.size());
+    //printf("Sending %zu bytes data to %zu connections\n", b->size(), mythreads.size());
 
     for(auto c: mythreads) {
         auto cc = dynamic_cast<SockDistribHandler*>(c);
         if(!cc) throw std::logic_error("incorrect handler type");
-        auto v = cc->SOB.get_writepoint();
-        if(!v) continue;
-        v->assign(d,d+n);
-        cc->SOB.finish_write();
+        auto& S = cc->SOB;
+        if(S.isDisconnected()) continue;
+        if(S.send(b, slowPolicy == SLOW_BLOCK? block_timeout_s : 0)) continue;
+        if(slowPolicy == SLOW_DISCONNECT) {
+            printf("Disconnecting slow client on socket fd %i\n", S.sockfd);
+            S.disconnect();
+        }
     }
+    for(auto& w: shmOut) w->send(b->data(), b->size(), slowPolicy == SLOW_BLOCK? block_timeout_s : 0);
+}
+
+void SockDistribServer::addShmOutput(const string& nm, size_t cap) {
+    lock_guard<mutex> cl(inputMut);
+    shmOut.emplace_back(new ShmBlockWriter(nm, cap));
+}
+
+vector<SockDistribServer::client_stats_t> SockDistribServer::clientStats() {
+    lock_guard<mutex> cl(inputMut);
+    vector<client_stats_t> v;
+    for(auto c: mythreads) {
+        auto cc = dynamic_cast<SockDistribHandler*>(c);
+        if(!cc) continue;
+        auto& S = cc->SOB;
+        v.push_back({cc->sockfd, S.n_buffered(), S.max_lag, S.n_sent, S.bytes_sent, S.n_write_fails, S.n_zerocopy, S.isDisconnected()});
+    }
+    return v;
+}
+
+void SockDistribServer::displayClients() {
+    for(auto& s: clientStats())
+        printf("\tclient %i: %zu queued (max %zu); sent %zu blocks (%zu zero-copy), %zu bytes; dropped %zu%s\n",
+               s.sockfd, s.queued, s.max_lag, s.n_sent, s.n_zerocopy, s.bytes_sent, s.n_dropped, s.disconnected? " [disconnected]" : "");
+    lock_guard<mutex> cl(inputMut);
+    for(auto& w: shmOut)
+        printf("\tshared memory '%s': %zu bytes queued; sent %zu blocks, %zu bytes; dropped %zu\n",
+               w->R.name.c_str(), w->R.capacity() - w->R.space(), w->n_sent, w->bytes_sent, w->n_dropped);
 }
@@ -6,6 +6,7 @@
 
 #include "SockIOServer.hh"
 #include "SockOutBuffer.hh"
+#include "ShmBlockIO.hh"
 
 /// Output distribution handler; uses SockOutBuffer to send data
 class SockDistribHandler: public ConnHandler {
@@ -14,8 +15,8 @@ public:
     explicit SockDistribHandler(int sfd, SockIOServer* s = nullptr):
     ConnHandler(sfd,s), SOB(sfd) {  }
 
-    /// handle responses from client (do nothing; wait for output to break)
-    void threadjob() override { SOB.launch_mythread(); SOB.finish_mythread(); }
+    /// run output buffer until client disconnects (discarding client input) or stop is requested
+    void threadjob() override;
 
     SockOutBuffer SOB;  ///< output buffer (in yet another thread)
 };
@@ -26,11 +27,42 @@ public:
     /// Constructor
     SockDistribServer() { }
 
-    /// send data to connected clients
-    void sendData(const char* d, size_t n);
+    /// handling of clients with full output queues
+    enum slow_policy_t {
+        SLOW_DROP,          ///< drop block for that client
+        SLOW_DISCONNECT,    ///< disconnect that client
+        SLOW_BLOCK          ///< block sender (up to block_timeout_s, then drop)
+    } slowPolicy = SLOW_DROP;  ///< slow-consumer policy
+    double block_timeout_s = 10;    ///< maximum SLOW_BLOCK wait per client [s]
+    size_t zerocopy_min = 0;        ///< minimum block size for MSG_ZEROCOPY client sends (0 to disable)
+
+    /// send data to connected clients, as one block shared by all client queues
+    void sendData(const char* d, size_t n) { sendBlock(std::make_shared<const vector<char>>(d, d + n)); }
+    /// send shared block to connected clients
+    void sendBlock(const sockblock_t& b);
     /// send vector as binary blob
     template<typename T>
     void sendvector(const vector<T>& v) { sendData((char*)v.data(), v.size()*sizeof(T)); }
+    /// also distribute blocks into named shared-memory ring, for same-host ShmBlockReader consumers
+    void addShmOutput(const string& nm, size_t cap = 1 << 24);
+
+    /// per-client delivery and lag metrics
+    struct client_stats_t {
+        int sockfd;             ///< client socket
+        size_t queued;          ///< blocks queued (current lag)
+        size_t max_lag;         ///< maximum blocks queued
+        size_t n_sent;          ///< blocks sent
+        size_t bytes_sent;      ///< bytes sent
+        size_t n_dropped;       ///< blocks dropped for full queue
+        size_t n_zerocopy;      ///< blocks sent by MSG_ZEROCOPY
+        bool disconnected;      ///< whether disconnected
+    };
+    /// get per-client metrics
+    vector<client_stats_t> clientStats();
+    /// print per-client metrics
+    void displayClients();
+
+    vector<std::unique_ptr<ShmBlockWriter>> shmOut;    ///< shared-memory outputs; lock inputMut
 
     // set: host, port
     // call: launch_mythread();
@@ -39,7 +71,12 @@ public:
 
 protected:
     /// create correct handler type
-    ConnHandler* makeHandler(int sfd) override { return new SockDistribHandler(sfd,this); }
+    ConnHandler* makeHandler(int sfd) override {
+        auto h = new SockDistribHandler(sfd,this);
+        h->SOB.zerocopy_min = zerocopy_min;
+        h->SOB.sockopts = sockopts;
+        return h;
+    }
 };
 
 /// Client requesting and receiving block data from server
@@ -50,7 +87,7 @@ public:
     BlockHandler(0,nullptr) { host = _host; port = _port; if(host.size() && port) connect_to_socket(); }
 
     // subclass me: Process data after buffer read; return false to end communication
-    // bool process(const vector<char>& v) overide;
+    // bool process_v(const char* buf, size_t bsize) override;
 };
 
 
@@ -60,8 +97,11 @@ class SockDistribClientT: public SockDistribClient {
 public:
     using SockDistribClient::SockDistribClient;
 protected:
-    /// Process received data as array of T
-    bool process_v(const vector<char>& v) override { return process((T*)v.data(), v.size()/sizeof(T)); }
+    /// Process received data, in place, as array of T
+    bool process_v(const char* buf, size_t bsize) override {
+        static_assert(alignof(T) <= RecvBuffer::align, "RecvBuffer alignment insufficient for type");
+        return process(reinterpret_cast<const T*>(buf), bsize/sizeof(T));
+    }
     /// Process received data as array of T --- Subclass me!
     virtual bool process(const T*, size_t n) { return n; }
 };
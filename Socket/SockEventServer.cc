@@ -0,0 +1,298 @@
+/// \file SockEventServer.cc
+
+#include "SockEventServer.hh"
+#include <algorithm>
+#include <cstring>
+#include <errno.h>  // for errno
+#include <stdio.h>  // for printf(...)
+#include <thread>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#endif
+
+SockEventConn::~SockEventConn() { if(sockfd > 0) close(sockfd); }
+
+bool SockEventConn::queue_send(const sockblock_t& b) {
+    std::lock_guard<std::mutex> l(omut);
+    if(closed || !server) return false;
+    if(oq.size() >= max_queued) {
+        ++n_dropped;
+        return false;
+    }
+    oq.push_back(b);
+    if(!dirty) {
+        dirty = true;
+        server->wake(this);
+    }
+    return true;
+}
+
+bool SockEventConn::flush() {
+    std::lock_guard<std::mutex> l(omut);
+    dirty = false;
+    if(closed) return true;
+    while(oq.size()) {
+        auto& b = *oq.front();
+        if(ooff < b.size()) {
+#ifdef MSG_NOSIGNAL
+            auto r = send(sockfd, b.data() + ooff, b.size() - ooff, MSG_NOSIGNAL);
+#else
+            auto r = write(sockfd, b.data() + ooff, b.size() - ooff);
+#endif
+            if(r < 0) {
+                if(errno == EAGAIN) return true; // (== EWOULDBLOCK on Linux) resume on EPOLLOUT
+                if(errno == EINTR) continue;
+                return false;
+            }
+            ooff += r;
+            if(ooff < b.size()) continue;
+        }
+        oq.pop_front();
+        ooff = 0;
+    }
+    return true;
+}
+
+////////////////////
+////////////////////
+////////////////////
+
+bool SockEventBlockConn::on_recv(const char* d, size_t n) {
+    while(n) {
+        if(nhdr < sizeof(bsize)) {
+            auto k = std::min(n, sizeof(bsize) - nhdr);
+            std::memcpy(reinterpret_cast<char*>(&bsize) + nhdr, d, k);
+            nhdr += k;
+            d += k;
+            n -= k;
+            if(nhdr < sizeof(bsize)) return true;
+            if(bsize <= 0) return false; // end of communication
+            block.clear();
+            block.reserve(bsize);
+        }
+
+        auto k = std::min(n, size_t(bsize) - block.size());
+        block.insert(block.end(), d, d + k);
+        d += k;
+        n -= k;
+        if(block.size() == size_t(bsize)) {
+            nhdr = 0;
+            if(!process_v(block)) return false;
+            block.clear();
+        }
+    }
+    return true;
+}
+
+////////////////////
+////////////////////
+////////////////////
+
+SockEventServer::~SockEventServer() { if(checkRunning() == RUNNING) finish_mythread(); }
+
+size_t SockEventServer::nConnections() {
+    std::lock_guard<std::mutex> l(connMut);
+    return conns.size();
+}
+
+size_t SockEventDistribServer::sendBlock(const sockblock_t& b) {
+    std::lock_guard<std::mutex> l(connMut);
+    size_t nq = 0;
+    for(auto& kv: conns) nq += kv.second->queue_send(b);
+    return nq;
+}
+
+bool SockEventServer::markClosed(SockEventConn& c) {
+    std::lock_guard<std::mutex> l(c.omut);
+    if(c.closed) return false;
+    c.closed = true;
+    return true;
+}
+
+#ifdef __linux__
+
+/// epoll tag for listening socket
+static char listen_tag;
+/// epoll tag for wake-up eventfd
+static char wake_tag;
+
+void SockEventServer::wake(SockEventConn* c) {
+    auto& L = *loops[c->loop];
+    {
+        std::lock_guard<std::mutex> l(L.m);
+        L.pending.push_back(c);
+    }
+    uint64_t one = 1;
+    if(write(L.wfd, &one, sizeof(one)) < 0) { } // already signalled if counter saturated
+}
+
+void SockEventServer::request_stop() {
+    stopping = true;
+    Threadworker::request_stop();
+    std::lock_guard<std::mutex> l(connMut);
+    uint64_t one = 1;
+    for(auto& L: loops) if(write(L->wfd, &one, sizeof(one)) < 0) { }
+}
+
+void SockEventServer::threadjob() {
+    create_socket();
+    fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL) | O_NONBLOCK);
+    if(listen(sockfd, backlog)) {
+        close_socket();
+        throw sockerror(*this, "Cannot listen on socket (error " + to_str(errno) + ")");
+    }
+
+    {
+        std::lock_guard<std::mutex> l(connMut);
+        for(int i = 0; i < std::max(1, nIOThreads); ++i) {
+            loops.emplace_back(new ioloop_t);
+            auto& L = *loops.back();
+            L.efd = epoll_create1(EPOLL_CLOEXEC);
+            L.wfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if(L.efd < 0 || L.wfd < 0) throw std::runtime_error("Failed to create epoll I/O loop");
+            epoll_event e;
+            e.events = EPOLLIN;
+            e.data.ptr = &wake_tag;
+            epoll_ctl(L.efd, EPOLL_CTL_ADD, L.wfd, &e);
+        }
+        epoll_event e;
+        e.events = EPOLLIN;
+        e.data.ptr = &listen_tag;
+        epoll_ctl(loops[0]->efd, EPOLL_CTL_ADD, sockfd, &e);
+    }
+    printf("Listening for connections on port %i (socket fd %i, %zu I/O threads)\n", port, sockfd, loops.size());
+    listening = true;
+
+    vector<std::thread> io;
+    for(size_t i = 1; i < loops.size(); ++i) io.emplace_back([this, i] { ioLoop(i); });
+    ioLoop(0);
+    for(auto& t: io) t.join();
+    listening = false;
+
+    std::lock_guard<std::mutex> l(connMut);
+    conns.clear();
+    for(auto& L: loops) {
+        close(L->efd);
+        close(L->wfd);
+    }
+    loops.clear();
+    close_socket();
+    stopping = false;
+}
+
+void SockEventServer::ioLoop(size_t i) {
+    auto& L = *loops[i];
+    const int nev = 64;
+    epoll_event ev[nev];
+    vector<SockEventConn*> closing;
+    vector<SockEventConn*> flushing;
+
+    while(!stopping) {
+        int n = epoll_wait(L.efd, ev, nev, 1000);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            fprintf(stderr, "ERROR %i in epoll_wait; stopping I/O thread %zu\n", errno, i);
+            break;
+        }
+
+        for(int j = 0; j < n; ++j) {
+            auto p = ev[j].data.ptr;
+            if(p == &listen_tag) { acceptAll(); continue; }
+
+            if(p == &wake_tag) {
+                uint64_t u;
+                if(read(L.wfd, &u, sizeof(u)) < 0) { }
+                {
+                    std::lock_guard<std::mutex> l(L.m);
+                    std::swap(flushing, L.pending);
+                }
+                for(auto c: flushing) if(!c->flush() && markClosed(*c)) closing.push_back(c);
+                flushing.clear();
+                continue;
+            }
+
+            auto c = static_cast<SockEventConn*>(p);
+            auto evs = ev[j].events;
+            bool ok = !(evs & EPOLLERR);
+            if(ok && (evs & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) ok = readAll(*c);
+            if(ok && (evs & EPOLLOUT)) ok = c->flush();
+            if(!ok && markClosed(*c)) closing.push_back(c);
+        }
+
+        for(auto c: closing) dropConn(c);
+        closing.clear();
+    }
+}
+
+bool SockEventServer::readAll(SockEventConn& c) {
+    char buff[1 << 16];
+    while(true) {
+        auto r = read(c.sockfd, buff, sizeof(buff));
+        if(r > 0) {
+            if(!c.on_recv(buff, r)) return false;
+            continue;
+        }
+        if(!r) return false; // closed by peer
+        if(errno == EAGAIN) return true; // (== EWOULDBLOCK on Linux)
+        if(errno != EINTR) return false;
+    }
+}
+
+void SockEventServer::acceptAll() {
+    while(true) {
+        auto fd = accept4(sockfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) {
+            if(errno == EINTR) continue;
+            if(errno != EAGAIN) fprintf(stderr, "ERROR %i accepting socket connection!\n", errno);
+            return;
+        }
+        printf("Accepting new connection %i ...\n", fd);
+        sockopts.apply(fd, !isUnix());
+
+        auto c = makeConn(fd);
+        c->server = this;
+        c->loop = nextLoop++ % loops.size();
+        {
+            std::lock_guard<std::mutex> l(connMut);
+            conns[fd].reset(c);
+        }
+
+        epoll_event e;
+        e.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        e.data.ptr = c;
+        if(epoll_ctl(loops[c->loop]->efd, EPOLL_CTL_ADD, fd, &e)) {
+            fprintf(stderr, "ERROR %i adding connection %i to I/O loop\n", errno, fd);
+            markClosed(*c);
+            std::lock_guard<std::mutex> l(connMut);
+            conns.erase(fd);
+        }
+    }
+}
+
+void SockEventServer::dropConn(SockEventConn* c) {
+    auto& L = *loops[c->loop];
+    epoll_ctl(L.efd, EPOLL_CTL_DEL, c->sockfd, nullptr);
+    {
+        std::lock_guard<std::mutex> l(L.m);
+        L.pending.erase(std::remove(L.pending.begin(), L.pending.end(), c), L.pending.end());
+    }
+    on_close(*c);
+    printf("Removing handler for sockfd %i\n", c->sockfd);
+    std::lock_guard<std::mutex> l(connMut);
+    conns.erase(c->sockfd);
+}
+
+#else
+
+void SockEventServer::wake(SockEventConn*) { }
+void SockEventServer::request_stop() { Threadworker::request_stop(); }
+void SockEventServer::threadjob() { throw std::runtime_error("SockEventServer requires Linux epoll"); }
+void SockEventServer::ioLoop(size_t) { }
+bool SockEventServer::readAll(SockEventConn&) { return false; }
+void SockEventServer::acceptAll() { }
+void SockEventServer::dropConn(SockEventConn*) { }
+
+#endif
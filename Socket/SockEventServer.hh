@@ -0,0 +1,158 @@
+/// \file SockEventServer.hh Event-driven (epoll) socket server, serving many connections from a small I/O thread pool
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SOCKEVENTSERVER_HH
+#define SOCKEVENTSERVER_HH
+
+#include "Threadworker.hh"
+#include "SockConnection.hh"
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+using std::vector;
+using std::map;
+
+class SockEventServer;
+
+/// One non-blocking connection serviced by a SockEventServer I/O thread
+class SockEventConn {
+public:
+    /// Constructor, with (accepted) file descriptor
+    explicit SockEventConn(int fd): sockfd(fd) { }
+    /// Destructor: closes socket
+    virtual ~SockEventConn();
+    /// no copy
+    SockEventConn(const SockEventConn&) = delete;
+    /// no assignment
+    SockEventConn& operator=(const SockEventConn&) = delete;
+
+    /// queue shared block for sending (thread-safe); false if dropped for full queue or closed connection
+    bool queue_send(const sockblock_t& b);
+    /// queue copy of data for sending
+    bool queue_send(const char* d, size_t n) { return queue_send(std::make_shared<const vector<char>>(d, d + n)); }
+    /// number of blocks dropped for full queue
+    size_t getDropped() const { return n_dropped; }
+
+    const int sockfd;           ///< connection socket file descriptor
+    size_t max_queued = 1024;   ///< maximum number of queued output blocks
+
+protected:
+    friend class SockEventServer;
+
+    /// process received bytes (default: discard); return false to end communication
+    virtual bool on_recv(const char* /*d*/, size_t /*n*/) { return true; }
+
+    /// non-blocking write of queued output; return false on connection error
+    bool flush();
+
+    std::mutex omut;            ///< protects output queue
+    std::deque<sockblock_t> oq; ///< queued output blocks
+    size_t ooff = 0;            ///< bytes of oq.front() already sent
+    size_t n_dropped = 0;       ///< blocks dropped for full queue
+    bool closed = false;        ///< whether connection has been closed
+    bool dirty = false;         ///< whether listed for flushing by I/O thread
+    int loop = 0;               ///< servicing I/O thread
+    SockEventServer* server = nullptr;  ///< servicing server
+};
+
+/// Non-blocking state machine for BlockHandler protocol: int32_t bsize, data[bsize]
+class SockEventBlockConn: public SockEventConn {
+public:
+    /// inherit constructor
+    using SockEventConn::SockEventConn;
+
+protected:
+    /// accumulate header and block data, calling process_v on each complete block
+    bool on_recv(const char* d, size_t n) override;
+    /// Process complete data block; return false to end communication
+    virtual bool process_v(const vector<char>& v) { return v.size(); }
+
+    int32_t bsize = 0;          ///< current block size
+    size_t nhdr = 0;            ///< header bytes received
+    vector<char> block;         ///< block being received
+};
+
+/// Socket server handling all connections on a fixed pool of epoll I/O threads (Linux only)
+class SockEventServer: public SockConnection, public Threadworker {
+public:
+    /// Constructor
+    explicit SockEventServer(int nio = 2): nIOThreads(nio) { }
+    /// Destructor
+    ~SockEventServer();
+
+    /// listen on host and port, servicing connections until stop requested
+    void threadjob() override;
+    /// stop requested: wake I/O threads
+    void request_stop() override;
+
+    /// number of open connections
+    size_t nConnections();
+
+    int nIOThreads;             ///< number of I/O threads (including launching worker thread)
+    int backlog = 64;           ///< listen() connection backlog
+    std::atomic<bool> listening{false}; ///< whether accepting connections
+
+protected:
+    /// create handler for newly accepted (non-blocking) connection socket
+    virtual SockEventConn* makeConn(int fd) { return new SockEventBlockConn(fd); }
+    /// callback (in connection's I/O thread) before removing closed connection
+    virtual void on_close(SockEventConn& /*c*/) { }
+
+    std::mutex connMut;         ///< protects conns and loops
+    map<int, std::unique_ptr<SockEventConn>> conns; ///< open connections, by socket fd
+
+private:
+    friend class SockEventConn;
+
+    /// one epoll I/O thread's state
+    struct ioloop_t {
+        int efd = -1;           ///< epoll descriptor
+        int wfd = -1;           ///< eventfd for wake-ups
+        std::mutex m;           ///< protects pending
+        vector<SockEventConn*> pending; ///< connections awaiting flush
+    };
+
+    /// service events for I/O thread i
+    void ioLoop(size_t i);
+    /// accept all waiting connections, distributing round-robin over I/O threads
+    void acceptAll();
+    /// read all available input; return false to close connection
+    static bool readAll(SockEventConn& c);
+    /// mark connection closed; return false if already closed
+    static bool markClosed(SockEventConn& c);
+    /// remove (marked closed) connection, in its I/O thread
+    void dropConn(SockEventConn* c);
+    /// schedule connection output flush by its I/O thread (caller holds c.omut)
+    void wake(SockEventConn* c);
+
+    vector<std::unique_ptr<ioloop_t>> loops;    ///< I/O thread states
+    size_t nextLoop = 0;        ///< next I/O thread for accepted connection
+    std::atomic<bool> stopping{false};  ///< stop request flag checked by I/O threads
+};
+
+/// Event-driven server distributing block data to listening clients (e.g. SockDistribClient)
+class SockEventDistribServer: public SockEventServer {
+public:
+    /// inherit constructor
+    using SockEventServer::SockEventServer;
+
+    /// send data to connected clients, as one block shared by all client queues; return number queued
+    size_t sendData(const char* d, size_t n) { return sendBlock(std::make_shared<const vector<char>>(d, d + n)); }
+    /// send shared block to connected clients, dropping for clients with full queues; return number queued
+    size_t sendBlock(const sockblock_t& b);
+    /// send vector as binary blob
+    template<typename T>
+    size_t sendvector(const vector<T>& v) { return sendData((const char*)v.data(), v.size()*sizeof(T)); }
+
+    // set: host, port
+    // call: launch_mythread();
+    // call: sendData(...)
+    // call: finish_mythread();
+
+protected:
+    /// distribution connections ignore client input
+    SockEventConn* makeConn(int fd) override { return new SockEventConn(fd); }
+};
+
+#endif
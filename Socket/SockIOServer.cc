@@ -22,6 +22,7 @@ void SockIOServer::threadjob() {
             fprintf(stderr, "ERROR %i accepting socket connection!\n", newsockfd);
             continue;
         }
+        sockopts.apply(newsockfd, !isUnix());
         handle_connection(newsockfd);
     }
 
@@ -85,29 +86,28 @@ void BlockHandler::threadjob() {
 
 bool BlockHandler::process(int32_t bsize) {
     if(!bsize || !theblock) return false;
-    bool b = process_v(theblock->data);
+    bool b = process_v(theblock->data.data(), theblock->data.size());
     return_block();
     return b;
 }
 
-bool BlockHandler::process_v(const vector<char>& v) {
+bool BlockHandler::process_v(const char* buf, size_t bsize) {
     static size_t received = 0;
     static int nprocessed = 0;
     nprocessed++;
-    received += v.size();
+    received += bsize;
     if(nprocessed<100 || !(nprocessed % (nprocessed/100))) {
-        printf("%i[%zu]> '", sockfd, v.size());
-        if(v.size() < 1024) for(auto c: v) printf("%c",c);
+        printf("%i[%zu]> '", sockfd, bsize);
+        if(bsize < 1024) for(size_t i = 0; i < bsize; ++i) printf("%c", buf[i]);
         else printf("%.1f MB", received/(1024*1024.));
         printf("'\n");
     }
-    return (bool)v.size();
+    return (bool)bsize;
 }
 
 char* BlockHandler::alloc_block(int32_t bsize) {
     request_block(bsize);
     if(!theblock) return nullptr;
     theblock->H = this;
-    theblock->data.resize(bsize);
-    return theblock->data.data();
+    return theblock->data.resize(bsize);
 }
@@ -5,6 +5,8 @@
 
 #include "Threadworker.hh"
 #include "SockConnection.hh"
+#include "RecvBuffer.hh"
+#include "AllocPool.hh"
 
 class ConnHandler;
 
@@ -44,28 +46,40 @@ public:
     /// Constructor
     explicit BlockHandler(int sfd, SockIOServer* s = nullptr): ConnHandler(sfd, s) { }
     /// Destructor
-    ~BlockHandler() { delete theblock; }
+    ~BlockHandler() { release_block(theblock); }
     /// Receive block size and whole of expected data
     void threadjob() override;
 
     /// received data block with recipient identifier
     struct dblock {
         BlockHandler* H;    ///< pointer back to this handler
-        vector<char> data;  ///< data location
+        RecvBuffer data;    ///< aligned data buffer, retaining capacity on re-use
+        /// reset for re-use
+        void clear() { data.clear(); }
     };
+    /// pool of re-usable blocks
+    typedef LockedAllocPool<dblock> blockpool_t;
+
+    blockpool_t* blockPool = nullptr;   ///< optional (shared) pool for blocks handed off by return_block()
 
 protected:
     /// Allocate block buffer space (default: allocate in theblock->data)
     virtual char* alloc_block(int32_t bsize);
     /// Set theblock to write point, or null if unavailable
-    virtual void request_block(int32_t /*bsize*/) { if(!theblock) theblock = new dblock; }
-    /// Return completed block to whence it came --- set to nullptr if not for re-use!
+    virtual void request_block(int32_t /*bsize*/) { if(!theblock) theblock = blockPool? blockPool->get() : new dblock; }
+    /// Return completed block to whence it came --- set to nullptr if not for re-use (and later release_block)!
     virtual void return_block() { }
+    /// thread-safe return of handed-off block to blockPool (or deletion)
+    void release_block(dblock* b) {
+        if(!b) return;
+        if(blockPool) blockPool->put(b);
+        else delete b;
+    }
 
     /// Process data after buffer read (default: calls process_v on theblock->data); return false to end communication
     virtual bool process(int32_t bsize);
-    /// Process data after buffer read; return false to end communication
-    virtual bool process_v(const vector<char>&);
+    /// Process bsize bytes in (RecvBuffer::align aligned) buffer after read; return false to end communication
+    virtual bool process_v(const char* buf, size_t bsize);
 
     dblock* theblock = nullptr; ///< default buffer space
 };
@@ -3,16 +3,195 @@
 #include "SockOutBuffer.hh"
 #include <stdio.h>  // for printf(...)
 #include <errno.h>  // for errno
+#include <limits.h> // for IOV_MAX
+#include <poll.h>   // for poll(...)
+#include <sys/socket.h> // for shutdown(...), send(...), recvmsg(...)
+#include <netinet/in.h>  // for IPPROTO_TCP
+#include <netinet/tcp.h> // for TCP_CORK
+#ifdef __linux__
+#include <linux/errqueue.h> // for zero-copy completion notifications
+#endif
+
+bool SockOutBuffer::send(const sockblock_t& b, double wait_s) {
+    if(disconnected) return false;
+    auto v = wait_s > 0? get_writepoint(wait_s) : get_writepoint();
+    if(!v) return false;
+    *v = b;
+    finish_write();
+    max_lag = std::max(max_lag, this->n_buffered());
+    return true;
+}
+
+void SockOutBuffer::disconnect() {
+    if(disconnected.exchange(true)) return;
+    auto fd = sockfd;
+    if(fd) shutdown(fd, SHUT_RDWR); // fails any blocked write in process_item()
+}
+
+void SockOutBuffer::writeFailed(const string& what) {
+    fprintf(stderr, "(%i) %s\n\tclosing socket descriptor %i\n", sockfd, what.c_str(), sockfd);
+    disconnected = true;
+    zcPending.clear();
+    close_socket();
+}
 
 void SockOutBuffer::process_item() {
-    if(sockfd) {
-        int32_t bsize = current.size();
+    if(sockfd && !disconnected && current) {
+        int32_t bsize = current->size();
         try {
-            sockwrite(current.data(), bsize);
+            sockwrite(current->data(), bsize);
+            ++n_sent;
+            bytes_sent += bsize;
         } catch(std::runtime_error& e) {
             fprintf(stderr, "%s\n\tclosing socket descriptor %i\n", e.what(), sockfd);
+            disconnected = true;
             close_socket();
         }
     }
-    current.clear();
+    current.reset();
+}
+
+void SockOutBuffer::process_batch(size_t n) {
+    // blocks stay referenced in their slots until written, instead of moving through current
+#ifdef TCP_CORK
+    // hold partial segments until whole batch is written
+    bool cork = sockopts.cork > 0 && n > 1 && sockfd && !disconnected;
+    int on = 1;
+    if(cork) setsockopt(sockfd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+#endif
+    size_t i0 = 0;
+    for(size_t i = 0; i <= n; ++i) {
+        if(!sockfd || disconnected) break;
+        bool zc = i < n && useZerocopy(rslot(i));
+        if(i < n && !zc) continue;
+        if(i > i0 && !writeBlocks(i0, i)) break;
+        if(zc && !sendZerocopy(rslot(i))) break;
+        i0 = i + 1;
+    }
+#ifdef TCP_CORK
+    on = 0;
+    if(cork && sockfd) setsockopt(sockfd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+#endif
+    for(size_t i = 0; i < n; ++i) rslot(i).reset();
+    this->release(n);
+    spaceReady.notify();
+    if(zcPending.size()) reapZerocopy();
+}
+
+bool SockOutBuffer::writeBlocks(size_t i0, size_t i1) {
+    iov.clear();
+    for(size_t i = i0; i < i1; ++i) {
+        auto& b = rslot(i);
+        if(b && b->size()) iov.push_back({const_cast<char*>(b->data()), b->size()});
+    }
+
+    size_t k = 0;
+    int nretries = 3;
+    while(k < iov.size()) {
+        auto r = writev(sockfd, iov.data() + k, std::min(iov.size() - k, size_t(IOV_MAX)));
+        if(r <= 0) {
+            if(r < 0 && errno == EINTR) continue;
+            if(nretries--) {
+                usleep(1000);
+                continue;
+            }
+            writeFailed("Failed writev() to socket, error " + to_str(errno));
+            return false;
+        }
+        ++n_writev;
+        bytes_sent += r;
+        for(size_t m = r; m; ) { // advance past written bytes
+            if(m >= iov[k].iov_len) m -= iov[k++].iov_len;
+            else {
+                iov[k].iov_base = static_cast<char*>(iov[k].iov_base) + m;
+                iov[k].iov_len -= m;
+                m = 0;
+            }
+        }
+    }
+    n_sent += i1 - i0;
+    return true;
+}
+
+#if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+
+bool SockOutBuffer::useZerocopy(const sockblock_t& b) {
+    if(!zerocopy_min || !b || b->size() < zerocopy_min) return false;
+    if(!zcState) {
+        int one = 1;
+        zcState = setsockopt(sockfd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one))? -1 : 1;
+        if(zcState < 0) printf("MSG_ZEROCOPY unavailable on socket %i; using copying writes.\n", sockfd);
+    }
+    return zcState > 0;
+}
+
+bool SockOutBuffer::sendZerocopy(const sockblock_t& b) {
+    size_t off = 0;
+    int nretries = 3;
+    while(off < b->size()) {
+        auto r = ::send(sockfd, b->data() + off, b->size() - off, MSG_ZEROCOPY);
+        if(r < 0 && errno == ENOBUFS) { // pinned-page limit: wait for completions
+            reapZerocopy(100);
+            continue;
+        }
+        if(r <= 0) {
+            if(r < 0 && errno == EINTR) continue;
+            if(nretries--) {
+                usleep(1000);
+                continue;
+            }
+            writeFailed("Failed MSG_ZEROCOPY send to socket, error " + to_str(errno));
+            return false;
+        }
+        zcPending.emplace_back(zcSeq++, b);
+        off += r;
+    }
+    ++n_zerocopy;
+    ++n_sent;
+    bytes_sent += b->size();
+    return true;
+}
+
+void SockOutBuffer::reapZerocopy(int timeout_ms) {
+    while(zcPending.size() && sockfd) {
+        char cbuf[128];
+        msghdr msg = {};
+        msg.msg_control = cbuf;
+        msg.msg_controllen = sizeof(cbuf);
+        if(recvmsg(sockfd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if(errno == EINTR) continue;
+            if(errno != EAGAIN) return; // (== EWOULDBLOCK on Linux)
+            if(timeout_ms <= 0) return;
+            struct pollfd pfd;
+            pfd.fd = sockfd;
+            pfd.events = 0; // POLLERR signals pending error queue
+            if(poll(&pfd, 1, timeout_ms) <= 0) return;
+            continue;
+        }
+
+        for(auto cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if(!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                 (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) continue;
+            auto e = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cm));
+            if(e->ee_errno || e->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+            // completed sends [ee_info, ee_data]
+            uint32_t lo = e->ee_info, hi = e->ee_data;
+            if(e->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) n_zc_copied += hi - lo + 1;
+            while(zcPending.size() && zcPending.front().first - lo <= hi - lo) zcPending.pop_front();
+        }
+    }
+}
+
+#else
+
+bool SockOutBuffer::useZerocopy(const sockblock_t&) { return false; }
+bool SockOutBuffer::sendZerocopy(const sockblock_t&) { return false; }
+void SockOutBuffer::reapZerocopy(int) { zcPending.clear(); }
+
+#endif
+
+void SockOutBuffer::threadjob() {
+    LocklessCircleBuffer<sockblock_t>::threadjob();
+    for(int i = 0; i < 10 && zcPending.size(); ++i) reapZerocopy(100);
+    if(zcPending.size()) printf("Warning: %zu zero-copy sends on socket %i not confirmed complete.\n", zcPending.size(), sockfd);
 }
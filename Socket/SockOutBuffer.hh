@@ -5,10 +5,12 @@
 
 #include "SockConnection.hh"
 #include "LocklessCircleBuffer.hh"
+#include <deque>
+#include <sys/uio.h>    // for iovec
 using std::vector;
 
-/// Buffered data block output to socket connection
-class SockOutBuffer: public SockConnection, public LocklessCircleBuffer<vector<char>> {
+/// Buffered data block output to socket connection; queued blocks are shared, immutable sockblock_t
+class SockOutBuffer: public SockConnection, public LocklessCircleBuffer<sockblock_t> {
 public:
     /// inherit constructors
     using SockConnection::SockConnection;
@@ -23,13 +25,51 @@ public:
     /// avoid hiding alternate version
     using SockConnection::connect_to_socket;
 
+    /// queue shared block for sending, waiting up to wait_s [s] for space; false if queue full or disconnected
+    bool send(const sockblock_t& b, double wait_s = 0);
+    /// force disconnect (from any thread): pending and future blocks are discarded
+    void disconnect();
+    /// whether connection has been closed or disconnected
+    bool isDisconnected() const { return disconnected; }
+
     // set SocketConnection::host, port
-    // use SockIOData* LocklessCircleBuffer::get_writepoint() and finish_write()
+    // use send(...), or LocklessCircleBuffer::get_writepoint() and finish_write(),
     // to push new data onto sending queue
 
+    std::atomic<size_t> n_sent{0};      ///< number of blocks sent
+    std::atomic<size_t> bytes_sent{0};  ///< number of bytes sent
+    size_t max_lag = 0;                 ///< maximum queued (unsent) blocks seen by send(...)
+    size_t zerocopy_min = 0;            ///< minimum block size [bytes] sent by MSG_ZEROCOPY (0 to disable; Linux only)
+    size_t n_writev = 0;                ///< number of gathered writev() calls
+    size_t n_zerocopy = 0;              ///< number of blocks sent by MSG_ZEROCOPY
+    size_t n_zc_copied = 0;             ///< MSG_ZEROCOPY sends the kernel completed by copying anyway
+
+    /// send buffered data until stop requested, then await outstanding zero-copy completions
+    void threadjob() override;
+
 protected:
     /// send data block
     void process_item() override;
+    /// send batch of queued blocks: small blocks gathered into writev(), large optionally by MSG_ZEROCOPY
+    void process_batch(size_t n) override;
+
+    /// writev() gather of queued blocks [i0, i1); false on failure
+    bool writeBlocks(size_t i0, size_t i1);
+    /// send block with MSG_ZEROCOPY, holding reference until kernel completion; false on failure
+    bool sendZerocopy(const sockblock_t& b);
+    /// whether block should be sent by MSG_ZEROCOPY (enabling on socket at first use)
+    bool useZerocopy(const sockblock_t& b);
+    /// release blocks for completed zero-copy sends, optionally waiting (up to timeout_ms) for completions
+    void reapZerocopy(int timeout_ms = 0);
+    /// report write failure and close socket
+    void writeFailed(const string& what);
+
+    vector<iovec> iov;                  ///< writev() gather list
+    std::deque<std::pair<uint32_t, sockblock_t>> zcPending; ///< blocks held until zero-copy completion, by send sequence number
+    uint32_t zcSeq = 0;                 ///< next zero-copy send sequence number
+    int zcState = 0;                    ///< MSG_ZEROCOPY socket status: 0 untried, 1 enabled, -1 unavailable
+
+    std::atomic<bool> disconnected{false};  ///< set on write failure or disconnect()
 };
 
 #endif
@@ -12,7 +12,7 @@ int main(int argc, char** argv) {
     CodeVersion::display_code_version();
 
     if(argc < 3) {
-        printf("Arguments: Delta <file 1> <file 2> [-out <dir>] [-as <type>]\n");
+        printf("Arguments: Delta <file 1> <file 2> [-out <dir>] [-as <type>] [-fast] [-nthreads <n>] [-numtol <x>]\n");
         return EXIT_FAILURE;
     }
 
@@ -22,6 +22,9 @@ int main(int argc, char** argv) {
     optionalGlobalArg("out", DB.outdir, "comparisons output directory");
     string astype = "automatic";
     optionalGlobalArg("as", astype, "comparison type");
+    DB.hashfirst = wasArgGiven("fast", "hash-first comparison, skipping identical objects");
+    optionalGlobalArg("nthreads", DB.nthreads, "number of hashing/comparison threads");
+    optionalGlobalArg("numtol", DB.numtol, "relative tolerance for numbers in text comparison");
 
     if(astype == "automatic") DB.inferType();
     else if(astype == "root") DB.comptype = DeltaBase::COMPARE_ROOT;
@@ -0,0 +1,64 @@
+/// \file testAliasTable.cc Validate alias-table selection frequencies over counter-based random streams
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "AliasTable.hh"
+#include "CounterRNG.hh"
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <stdio.h>
+
+REGISTER_EXECLET(testAliasTable) {
+    // reproducible, directly addressable streams
+    CounterRNG R(12345, 7), R2(12345, 7, 1000);
+    vector<double> u(2000);
+    R.fill(u.data(), u.size());
+    for(size_t i = 1000; i < 2000; i++) if(u[i] != R2()) throw std::runtime_error("CounterRNG stream not addressable");
+    double su = 0;
+    for(auto x: u) {
+        if(!(0 <= x && x < 1)) throw std::runtime_error("CounterRNG uniform out of range");
+        su += x;
+    }
+    printf("CounterRNG mean %.4f\n", su/u.size());
+
+    // weights with zero and dominant entries
+    const vector<double> w = {3, 0, 1, 0.5, 10, 2.5, 0, 1e-3};
+    AliasTable A(w);
+    double wsum = 0;
+    for(auto x: w) wsum += x;
+
+    const size_t n = 4000000, nb = 4096;
+    vector<double> cnt(w.size()), rmean(w.size());
+    vector<unsigned int> k(nb);
+    u.resize(nb);
+    CounterRNG G(1);
+    double t = 0;
+    for(size_t i = 0; i < n; i += nb) {
+        auto t0 = std::chrono::steady_clock::now();
+        G.fill(u.data(), nb);
+        A.select(u.data(), k.data(), nb);
+        t += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        for(auto j: k) cnt[j]++;
+    }
+
+    // rescaled remainders should be uniform for each selection
+    for(size_t i = 0; i < n/8; i++) {
+        double x = G();
+        auto j = A.select_rescale(x);
+        if(!(0 <= x && x <= 1)) throw std::runtime_error("AliasTable remainder out of range");
+        rmean[j] += x;
+    }
+
+    double chi2 = 0, rdev = 0;
+    for(size_t j = 0; j < w.size(); j++) {
+        const double e = n*w[j]/wsum;
+        if(!w[j] && cnt[j]) throw std::runtime_error("AliasTable selected zero-weight item");
+        if(e) chi2 += (cnt[j] - e)*(cnt[j] - e)/e;
+        const double m = n/8*w[j]/wsum;
+        if(m > 1000) rdev = std::max(rdev, fabs(rmean[j]/m - 0.5)*sqrt(12*m));
+    }
+    printf("AliasTable %zu items: %.2f ns per draw and selection; chi^2 = %.1f (5 dof), max remainder mean deviation %.1f sigma\n",
+           w.size(), t*1e9/n, chi2, rdev);
+    if(!(chi2 < 25) || !(rdev < 5)) throw std::runtime_error("AliasTable selection frequencies mismatch");
+}
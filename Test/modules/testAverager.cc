@@ -3,6 +3,10 @@
 
 #include "ConfigFactory.hh"
 #include "Averager.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdlib.h>
+#include <vector>
 
 /// old-style averager with sum w*x, sum w*x*x
 template<typename value_t = double, typename weight_t = double>
@@ -66,4 +70,42 @@ REGISTER_EXECLET(testAverager) {
     A += B;
     _A += _B;
     A.display(); _A.display();
+
+    printf("--------\n");
+    // batched, parallel adds vs. per-item add on large-offset data
+    const size_t n = 10000000;
+    std::vector<double> x(n), w(n);
+    long double lsw = 0, lswx = 0;
+    for(size_t i = 0; i < n; ++i) {
+        x[i] = 1e8 + (rand() % 1000)*1e-3;
+        w[i] = 0.5 + (rand() % 100)*1e-2;
+        lsw += w[i];
+        lswx += w[i]*x[i];
+    }
+    long double lmu = lswx/lsw, lv = 0;
+    for(size_t i = 0; i < n; ++i) lv += w[i]*(x[i] - lmu)*(x[i] - lmu);
+    lv /= lsw;
+
+    auto t0 = std::chrono::steady_clock::now();
+    Averager<> S;
+    for(size_t i = 0; i < n; ++i) S.add(x[i], w[i]);
+    auto t1 = std::chrono::steady_clock::now();
+    Averager<> V;
+    V.add(x.data(), w.data(), n);
+    auto t2 = std::chrono::steady_clock::now();
+    auto P = parallel_average(x.data(), w.data(), n);
+    auto t3 = std::chrono::steady_clock::now();
+
+    printf("exact mean - 1e8 = %.8Lg, variance %.10Lg\n", lmu - 1e8, lv);
+    printf("per-item: %.8g, %.10g (%.3f s)\n", S.average() - 1e8, S.variance(), std::chrono::duration<double>(t1 - t0).count());
+    printf("batched:  %.8g, %.10g (%.3f s)\n", V.average() - 1e8, V.variance(), std::chrono::duration<double>(t2 - t1).count());
+    printf("parallel: %.8g, %.10g (%.3f s)\n", P.average() - 1e8, P.variance(), std::chrono::duration<double>(t3 - t2).count());
+    for(auto a: {&V, &P}) {
+        if(fabs(a->variance() - lv) > 1e-6*lv || fabs(a->average() - lmu) > 1e-12*lmu)
+            throw std::runtime_error("Averager batch mismatch");
+    }
+
+    Averager<> U;
+    U.add(x.data(), nullptr, n);
+    printf("unweighted batched: "); U.display();
 }
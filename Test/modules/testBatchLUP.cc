@@ -0,0 +1,75 @@
+/// \file testBatchLUP.cc Validate and benchmark batched small-matrix solves against per-system LUPDecomp
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "BatchLUP.hh"
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+
+/// elapsed seconds since t0
+double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// compare batched solves and inverses of n random systems (some singular) with LUPDecomp
+template<size_t N, typename T, bool CF>
+void btest(const char* tname, size_t n, double tol) {
+    typedef LUPBatch<N, T, (64/sizeof(T)), CF> B_t;
+    std::mt19937 R(12345);
+    std::uniform_real_distribution<T> U(-1, 1);
+    vector<typename B_t::mat_t> A(n);
+    vector<typename B_t::vec_t> b(n), x(n), x0(n);
+    for(size_t i = 0; i < n; i++) {
+        for(size_t j = 0; j < N*N; j++) A[i][j] = U(R);
+        for(size_t j = 0; j < N; j++) b[i][j] = U(R);
+        if(i % 97 == 5) for(size_t j = 0; j < N; j++) A[i](N-1, j) = 0; // singular
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    vector<bool> ok0(n);
+    for(size_t i = 0; i < n; i++) {
+        LUPDecomp<N,T> LU(A[i]);
+        ok0[i] = !LU.isSingular();
+        if(ok0[i]) x0[i] = LU.solve(b[i]);
+    }
+    const double t_ref = since(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    vector<char> ok(n);
+    B_t::solve(A.data(), b.data(), x.data(), n, reinterpret_cast<bool*>(ok.data()));
+    const double t_batch = since(t0);
+
+    // solution residuals |A x - b| for systems LUPDecomp found regular
+    double emax = 0;
+    size_t nsing = 0;
+    for(size_t i = 0; i < n; i++) {
+        if(!ok0[i] || !ok[i]) { nsing += !ok[i]; continue; }
+        emax = std::max(emax, double((A[i]*x[i] - b[i]).mag()/(1 + x0[i].mag())));
+    }
+
+    vector<typename B_t::mat_t> Ai(n);
+    B_t::invert(A.data(), Ai.data(), n);
+    double einv = 0;
+    for(size_t i = 0; i < n; i++) {
+        if(!ok[i]) continue;
+        auto D = A[i]*Ai[i] - B_t::mat_t::identity();
+        for(size_t j = 0; j < N*N; j++) einv = std::max(einv, double(std::abs(D[j])/(1 + Ai[i].mag())));
+    }
+
+    printf("%s %zu x %zu%s: %zu systems, LUPDecomp %.1f ns, batched %.1f ns per system; %zu singular, residual %g, inverse error %g\n",
+           tname, N, N, CF? " closed-form" : " pivoted", n, 1e9*t_ref/n, 1e9*t_batch/n, nsing, emax, einv);
+    if(!(emax < tol && einv < tol)) throw std::runtime_error("Batched solve mismatch");
+    if(nsing < n/97) throw std::runtime_error("Batched solve missed singular systems");
+}
+
+REGISTER_EXECLET(testBatchLUP) {
+    const size_t n = 1000000;
+    btest<3, double, true>("double", n, 1e-6);
+    btest<3, double, false>("double", n, 1e-9);
+    btest<4, double, true>("double", n, 1e-6);
+    btest<4, double, false>("double", n, 1e-9);
+    btest<4, float, true>("float", n, 1e-1);
+    btest<6, double, false>("double", n/4, 1e-9);
+    btest<2, double, true>("double", n, 1e-6);
+    btest<1, double, true>("double", n, 1e-12);
+}
@@ -0,0 +1,89 @@
+/// \file testBetaCorrectionTable.cc Validate tabulated beta decay correction functions against direct evaluation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "BetaCorrectionTable.hh"
+#include "CounterRNG.hh"
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <stdio.h>
+#include <thread>
+#include <unistd.h>
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// compare table to direct evaluation at n random energies; return max relative error
+static double check_table(const BetaCorrectionTable& T, size_t n) {
+    CounterRNG R(2);
+    vector<double> u(2*n), W(n), y0(n), y1(n);
+    R.fill(u.data(), u.size());
+    const double W0 = T.G.W0;
+
+    // timing for uniformly distributed energies
+    for(size_t i = 0; i < n; i++) W[i] = 1 + (W0 - 1)*u[i];
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < n; i++) y0[i] = T.exact(W[i]);
+    const double te = since(t0);
+    t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < n; i++) y1[i] = T(W[i]);
+    const double tt = since(t0);
+    double ymax = 0;
+    for(size_t i = 0; i < n; i++) ymax = std::max(ymax, fabs(y0[i]));
+    double dy = 0;
+    for(size_t i = 0; i < n; i++) dy = std::max(dy, fabs(y1[i] - y0[i])/std::max(fabs(y0[i]), 1e-3*ymax));
+
+    // plus log-uniform approach to endpoints
+    for(size_t i = 0; i < n; i++) {
+        const double x = pow(1e-12, u[2*i]);
+        const double w = u[2*i+1] < 0.5? 1 + (W0 - 1)*x : W0 - (W0 - 1)*x;
+        dy = std::max(dy, fabs(T(w) - T.exact(w))/std::max(fabs(T.exact(w)), 1e-3*ymax));
+    }
+
+    printf("\t%zu intervals; direct %.1f ns, table %.1f ns per evaluation; max relative error %.2g\n", T.nIntervals(), te*1e9/n, tt*1e9/n, dy);
+    return dy;
+}
+
+REGISTER_EXECLET(testBetaCorrectionTable) {
+    // beta- and beta+ spectrum corrections; low and high endpoints
+    for(auto p: {std::make_pair(1., 1.), std::make_pair(207., -82.), std::make_pair(137., 56.), std::make_pair(22., -10.)}) {
+        BetaSpectrumGenerator G(p.first, p.second, p.first == 1? 0.782 : p.first == 22? 0.546 : 0.514);
+        if(p.first == 137) G.forbidden = 1;
+        auto t0 = std::chrono::steady_clock::now();
+        auto T = BetaCorrectionTable::get(G);
+        printf("A = %g, Z = %g, EP = %g MeV spectrum correction (%.1f ms):\n", G.A, G.Z, G.EP, since(t0)*1e3);
+        if(BetaCorrectionTable::get(G) != T) throw std::runtime_error("Beta correction table not shared");
+        if(!(check_table(*T, 100000) < 1e-9)) throw std::runtime_error("Beta correction table mismatch");
+    }
+
+    // neutron radiative and asymmetry corrections
+    for(auto k: {BetaCorrectionTable::NEUTRON_G, BetaCorrectionTable::NEUTRON_ASYM}) {
+        auto T = BetaCorrectionTable::neutron(k);
+        printf("Neutron %s correction:\n", k == BetaCorrectionTable::NEUTRON_G? "radiative" : "asymmetry");
+        if(!(check_table(*T, 100000) < 1e-9)) throw std::runtime_error("Neutron correction table mismatch");
+    }
+
+    // concurrent first requests share one table
+    BetaSpectrumGenerator G(64, 29, 0.579);
+    vector<std::shared_ptr<const BetaCorrectionTable>> vT(4);
+    vector<std::thread> vt;
+    for(auto& T: vT) vt.emplace_back([&G, &T] { T = BetaCorrectionTable::get(G); });
+    for(auto& t: vt) t.join();
+    for(auto& T: vT) if(T != vT[0]) throw std::runtime_error("Concurrently built tables not shared");
+
+    // serialization round trip
+    BinarySerializer W;
+    vT[0]->write(W);
+    MemBReader R(W.buf().data(), W.buf().size());
+    auto T1 = BetaCorrectionTable::read(R);
+    for(double x: {1.01, 1.5, 2.}) if((*T1)(x) != (*vT[0])(x)) throw std::runtime_error("Deserialized table differs");
+
+    // cache file round trip
+    const string fname = "/tmp/testBetaCorrectionTable_" + std::to_string(getpid()) + ".bin";
+    BetaCorrectionTable::saveCache(fname);
+    if(!BetaCorrectionTable::loadCache(fname)) throw std::runtime_error("Failed to load correction table cache");
+    if(BetaCorrectionTable::get(G) != vT[0]) throw std::runtime_error("Loaded cache replaced shared table");
+    remove(fname.c_str());
+    if(BetaCorrectionTable::loadCache(fname)) throw std::runtime_error("Missing cache file loaded");
+}
@@ -0,0 +1,61 @@
+/// \file testBetaSpectrumTable.cc Validate tabulated beta spectrum quantiles and sampling against direct spectrum evaluation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "BetaSpectrumTable.hh"
+#include "CounterRNG.hh"
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <stdio.h>
+
+/// elapsed seconds since t0
+double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+REGISTER_EXECLET(testBetaSpectrumTable) {
+    // beta- and beta+ spectra; low and high endpoints
+    for(auto p: {std::make_pair(1., 1.), std::make_pair(207., -82.), std::make_pair(137., 56.), std::make_pair(22., -10.)}) {
+        BetaSpectrumGenerator G(p.first, p.second, p.first == 1? 0.782 : p.first == 22? 0.546 : 0.514);
+        auto t0 = std::chrono::steady_clock::now();
+        auto T = BetaSpectrumTable::get(G);
+        const double tb = since(t0);
+        if(BetaSpectrumTable::get(G) != T) throw std::runtime_error("Beta spectrum table not shared");
+
+        // quantile inverts CDF, including tails
+        double dq = 0;
+        for(double u: {1e-12, 1e-6, 1e-3, 0.1, 0.5, 0.9, 0.999, 1 - 1e-6, 1 - 1e-12}) dq = std::max(dq, fabs(T->cdf(T->quantile(u)) - u));
+
+        // table sampling versus exact quantile, to within a few times table tolerance
+        CounterRNG R(1);
+        const size_t n = 1000000;
+        vector<double> u(n), x(n);
+        R.fill(u.data(), n);
+        t0 = std::chrono::steady_clock::now();
+        double s = 0;
+        for(size_t i = 0; i < n; i++) s += (x[i] = T->sample(u[i]));
+        const double ts = since(t0);
+        double dx = 0;
+        for(size_t i = 0; i < n; i += 97) dx = std::max(dx, fabs(x[i] - T->quantile(u[i])));
+
+        // rejection sampling from direct spectrum evaluation, for comparison
+        double pmax = 0;
+        for(int i = 1; i < 1000; i++) pmax = std::max(pmax, G.decayProb(G.EP*i/1000.));
+        pmax *= 1.1;
+        const size_t nr = n/20;
+        t0 = std::chrono::steady_clock::now();
+        double sr = 0;
+        for(size_t i = 0; i < nr; i++) {
+            double e;
+            do e = G.EP*R(); while(e < 1e-9*G.EP || R()*pmax > G.decayProb(e)); // (W = 1 rounding below 1e-9 EP)
+            sr += e;
+        }
+        const double tr = since(t0);
+
+        printf("A = %g, Z = %g, EP = %g MeV: %zu knots (%.2f s), <KE> = %.5f (sampled %.5f, rejection %.5f) MeV\n",
+               G.A, G.Z, G.EP, T->nKnots(), tb, T->getAvg(), s/n, sr/nr);
+        printf("\ttable %.1f ns, rejection %.1f ns per sample; max CDF(quantile) error %.2g, max table error %.2g MeV\n",
+               ts*1e9/n, tr*1e9/nr, dq, dx);
+        if(!(dq < 1e-9) || !(dx < 4e-6*G.EP) || !(fabs(s/n - T->getAvg()) < 1e-3*G.EP))
+            throw std::runtime_error("Beta spectrum table mismatch");
+    }
+}
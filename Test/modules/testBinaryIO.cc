@@ -0,0 +1,156 @@
+/// \file testBinaryIO.cc BinaryIO container round-trip, bulk serialization, zero-copy transaction, file durability and buffering modes throughput
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "BinaryIO.hh"
+#include "VarMat.hh"
+#include "DiskBIO.hh"
+#include <chrono>
+#include <stdio.h>
+
+/// POD test struct
+struct podtest {
+    int i;
+    double x;
+    /// comparison
+    bool operator==(const podtest& p) const { return i == p.i && x == p.x; }
+};
+
+/// serialize, then deserialize into b; return whether equal
+template<typename T>
+bool roundtrip(const T& a, T& b) {
+    BinarySerializer S;
+    S.send(a);
+    MemBReader R(S.buf().data(), S.buf().size());
+    R.receive(b);
+    return a == b;
+}
+
+REGISTER_EXECLET(testBinaryIO) {
+    int n = 10000000;
+    Cfg.lookupValue("n", n);
+
+    vector<double> vd(n);
+    for(int i = 0; i < n; ++i) vd[i] = 0.5*i;
+    vector<podtest> vp(1000);
+    for(size_t i = 0; i < vp.size(); ++i) vp[i] = {int(i), 1./(i+1)};
+    vector<string> vs = {"one", "", "three"};
+    array<string,2> as = {{"a", "bc"}};
+    array<double,3> ad = {{1, 2, 3}};
+    map<int, vector<double>> mv = {{1, {1., 2.}}, {3, {}}};
+    VarVec<double> VV(5, 2.5);
+    VarMat<double> VM(3, 4, 1.5);
+    VM(2,3) = 7;
+
+    vector<double> vd2;
+    vector<podtest> vp2;
+    vector<string> vs2;
+    array<string,2> as2;
+    array<double,3> ad2;
+    map<int, vector<double>> mv2;
+    VarVec<double> VV2;
+    VarMat<double> VM2;
+    bool ok = roundtrip(vp, vp2) && roundtrip(vs, vs2) && roundtrip(as, as2) && roundtrip(ad, ad2) && roundtrip(mv, mv2);
+    BinarySerializer S;
+    S.send(VV);
+    S.send(VM);
+    MemBReader R(S.buf().data(), S.buf().size());
+    R.receive(VV2);
+    R.receive(VM2);
+    ok = ok && VV2.getData() == VV.getData() && VM2.nRows() == 3 && VM2.nCols() == 4 && VM2(2,3) == 7 && VM2.getData().getData() == VM.getData().getData();
+
+    auto t0 = std::chrono::steady_clock::now();
+    ok = ok && roundtrip(vd, vd2);
+    auto t1 = std::chrono::steady_clock::now();
+    printf("vector<double> round-trip: %.0f MB/s\n", n*sizeof(double)/1e6/std::chrono::duration<double>(t1 - t0).count());
+
+    // copied versus zero-copy transaction into memory buffer
+    vector<char> mbuf(n*sizeof(double) + 1024);
+    for(bool zc: {false, true}) {
+        MemBWriter W(mbuf.data(), mbuf.size());
+        auto t2 = std::chrono::steady_clock::now();
+        if(zc) W.start_zwtx();
+        else W.start_wtx();
+        W.send<int>(1);
+        W.send(vd);
+        W.send<int>(2);
+        W.end_wtx();
+        auto t3 = std::chrono::steady_clock::now();
+        printf("vector<double> %s transaction: %.0f MB/s\n", zc? "zero-copy" : "buffered", n*sizeof(double)/1e6/std::chrono::duration<double>(t3 - t2).count());
+        MemBReader MR(mbuf.data(), mbuf.size());
+        ok = ok && MR.receive<int>() == 1;
+        MR.receive(vd2);
+        ok = ok && vd2 == vd && MR.receive<int>() == 2;
+    }
+
+    // gathered file write
+    string fname = "/tmp/testBinaryIO.dat";
+    {
+        FDBinaryWriter FW(fname);
+        FW.start_zwtx();
+        FW.send(vs);
+        FW.send(vp);
+        FW.send<int>(3);
+        FW.send(vd);
+        FW.end_wtx();
+    }
+    {
+        FDBinaryReader FR(fname);
+        FR.receive(vs2);
+        FR.receive(vp2);
+        ok = ok && vs2 == vs && vp2 == vp && FR.receive<int>() == 3;
+        FR.receive(vd2);
+        ok = ok && vd2 == vd;
+    }
+    remove(fname.c_str());
+
+    // many small transactions, per durability policy
+    int ntx = 1000;
+    Cfg.lookupValue("ntx", ntx);
+    for(auto d: {FDBinaryWriter::SYNC_EACH, FDBinaryWriter::SYNC_CLOSE, FDBinaryWriter::SYNC_NONE}) {
+        auto t2 = std::chrono::steady_clock::now();
+        {
+            FDBinaryWriter FW(fname, d);
+            for(int i = 0; i < ntx; ++i) FW.send(vp);
+        }
+        auto t3 = std::chrono::steady_clock::now();
+        printf("FDBinaryWriter durability %i: %.1f us per transaction\n", int(d), 1e6*std::chrono::duration<double>(t3 - t2).count()/ntx);
+        FDBinaryReader FR(fname);
+        for(int i = 0; i < ntx; ++i) {
+            FR.receive(vp2);
+            ok = ok && vp2 == vp;
+        }
+        remove(fname.c_str());
+    }
+
+    // small fields and large dump through reader buffering / read-ahead, writer write-behind / O_DIRECT
+    int nfield = 1000000;
+    Cfg.lookupValue("nfield", nfield);
+    for(int mode = 0; mode < 4; ++mode) {
+        const char* mname[] = {"unbuffered", "buffered", "read-ahead/write-behind", "O_DIRECT"};
+        auto t2 = std::chrono::steady_clock::now();
+        {
+            FDBinaryWriter FW(-1, FDBinaryWriter::SYNC_NONE);
+            if(!mode) FW.setBufferSize(0);
+            if(mode == 2) FW.setWriteBehind(4);
+            FW.directIO = mode == 3;
+            FW.openOut(fname);
+            if(mode < 3) for(int i = 0; i < nfield; ++i) FW.send<int>(i);
+            FW.send(vd);
+        }
+        auto t3 = std::chrono::steady_clock::now();
+        {
+            FDBinaryReader FR(fname);
+            if(!mode) FR.setBufferSize(0);
+            if(mode >= 2) FR.setBufferSize(1 << 20, 4);
+            if(mode < 3) for(int i = 0; i < nfield && ok; ++i) ok = FR.receive<int>() == i;
+            FR.receive(vd2);
+            ok = ok && vd2 == vd;
+        }
+        auto t4 = std::chrono::steady_clock::now();
+        printf("FDBinary %s: write %.3f s, read %.3f s\n", mname[mode], std::chrono::duration<double>(t3 - t2).count(), std::chrono::duration<double>(t4 - t3).count());
+        remove(fname.c_str());
+    }
+
+    if(!ok) printf("*** ERROR: round-trip mismatch!\n");
+}
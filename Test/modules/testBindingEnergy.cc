@@ -0,0 +1,65 @@
+/// \file testBindingEnergy.cc Validate flat BindingEnergyLibrary tables and binary cache against text parsing
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ElectronBindingEnergy.hh"
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <stdio.h>
+
+REGISTER_EXECLET(testBindingEnergy) {
+    // synthetic element tables, with varying shell and subshell counts
+    const string fname = "/tmp/testBindingEnergy.txt";
+    auto f = fopen(fname.c_str(), "w");
+    if(!f) throw std::runtime_error("Failed to write " + fname);
+    for(unsigned int Z = 100; Z >= 3; Z--) {
+        fprintf(f, "binding: Z = %u\tname = E%u", Z, Z);
+        for(unsigned int n = 0; n < 1 + Z/12; n++)
+            for(unsigned int s = 1; s <= (n? 1 + (Z + n) % 7 : 1); s++)
+                fprintf(f, "\t%c%s = %.17g", BindingEnergyTable::shellnames[n], n+s==1? "" : to_str(s).c_str(), 13.6*Z*Z/((n+1)*(n+1)) + s);
+        fprintf(f, "\n");
+    }
+    fclose(f);
+    remove((fname + ".bin").c_str());
+
+    auto t0 = std::chrono::steady_clock::now();
+    const SMFile Q(fname);
+    const BindingEnergyLibrary L(Q);
+    const double tp = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    auto S = BindingEnergyLibrary::load(fname); // writes cache
+    if(BindingEnergyLibrary::load(fname) != S) throw std::runtime_error("BindingEnergyLibrary not shared");
+    t0 = std::chrono::steady_clock::now();
+    auto C = BindingEnergyLibrary::readCache(fname + ".bin");
+    const double tc = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    // compare lookups
+    for(unsigned int Z = 0; Z <= 110; Z++) {
+        auto a = L.getBindingTable(Z, true), b = C->getBindingTable(Z, true);
+        if(!a || !b) {
+            if(a || b || (Z >= 3 && Z <= 100)) throw std::runtime_error("BindingEnergyLibrary element mismatch");
+            continue;
+        }
+        if(a->getZ() != Z || b->getZ() != Z || a->getName() != "E" + to_str(Z) || b->getName() != a->getName() || a->getNShells() != 1 + Z/12)
+            throw std::runtime_error("BindingEnergyLibrary table mismatch");
+        for(unsigned int n = 0; n <= BindingEnergyTable::NSHELL; n++) {
+            if(a->getShellBinding(n) != b->getShellBinding(n)) throw std::runtime_error("BindingEnergyLibrary shell mismatch");
+            for(unsigned int s = 0; s <= BindingEnergyTable::NSUB; s++) {
+                const double x = n < a->getNShells() && s < (n? 1 + (Z + n) % 7 : 1)? (13.6*Z*Z/((n+1)*(n+1)) + s + 1)/1000. : 0;
+                if(a->getSubshellBinding(n, s) != b->getSubshellBinding(n, s) || fabs(a->getSubshellBinding(n, s) - x) > 1e-9*x)
+                    throw std::runtime_error("BindingEnergyLibrary subshell mismatch");
+            }
+        }
+    }
+
+    // per-lookup cost
+    t0 = std::chrono::steady_clock::now();
+    double s = 0;
+    const size_t m = 10000000;
+    for(size_t i = 0; i < m; i++) s += C->getBindingTable(3 + i % 98)->getSubshellBinding(i % 3, i % 2);
+    const double tl = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("BindingEnergyLibrary: text parse %.2f ms, binary cache %.3f ms; %.2f ns per lookup (sum %g)\n", tp*1e3, tc*1e3, tl*1e9/m, s);
+
+    remove(fname.c_str());
+    remove((fname + ".bin").c_str());
+}
@@ -0,0 +1,41 @@
+/// \file testBlockCompress.cc Round-trip and throughput of block-compressed streams
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "BlockCompress.hh"
+#include <chrono>
+#include <random>
+#include <stdio.h>
+
+REGISTER_EXECLET(testBlockCompress) {
+    int nMB = 32;
+    int nthreads = 0;
+    Cfg.lookupValue("nMB", nMB);
+    Cfg.lookupValue("nthreads", nthreads);
+
+    // compressible test data: text-formatted random numbers
+    vector<char> d(size_t(nMB) << 20);
+    std::mt19937 R(1);
+    std::uniform_real_distribution<double> U(0, 100);
+    for(size_t i = 0; i < d.size(); ) {
+        char b[32];
+        int n = snprintf(b, sizeof(b), "%.6g ", U(R));
+        for(int k = 0; k < n && i < d.size(); ++k) d[i++] = b[k];
+    }
+
+    printf("codec threads\tratio\tcompress [MB/s]\tdecompress [MB/s]\n");
+    for(auto c: {CODEC_NONE, CODEC_ZLIB, CODEC_ZSTD, CODEC_LZ4}) {
+        if(!codec_available(c)) continue;
+        for(unsigned int nt: {1U, unsigned(nthreads)}) {
+            auto t0 = std::chrono::steady_clock::now();
+            auto z = block_compress(d.data(), d.size(), c, -1, 1 << 20, nt);
+            auto t1 = std::chrono::steady_clock::now();
+            auto u = block_decompress(z.data(), z.size(), nt);
+            auto t2 = std::chrono::steady_clock::now();
+            if(u != d) printf("*** ERROR: codec %i round-trip mismatch!\n", c);
+            printf("%i %u\t%.3f\t%.1f\t%.1f\n", c, nt, double(z.size())/d.size(),
+                   d.size()/1e6/std::chrono::duration<double>(t1 - t0).count(),
+                   d.size()/1e6/std::chrono::duration<double>(t2 - t1).count());
+        }
+    }
+}
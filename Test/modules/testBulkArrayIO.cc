@@ -0,0 +1,102 @@
+/// \file testBulkArrayIO.cc Round-trip and throughput of bulk array records versus element-wise BinaryOutputObject IO
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "BulkArrayIO.hh"
+#include "BlockCMat.hh"
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+
+/// elapsed seconds since t0
+double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+REGISTER_EXECLET(testBulkArrayIO) {
+    int nMB = 64;
+    Cfg.lookupValue("nMB", nMB);
+    const size_t nr = 1024, nc = (size_t(nMB) << 20)/(nr*sizeof(double));
+
+    // smooth-ish response-like data (compressible by byte shuffle)
+    std::mt19937 R(1);
+    std::normal_distribution<double> G;
+    VarMat<double> A(nr, nc);
+    for(size_t i = 0; i < A.size(); i++) A[i] = exp(-double(i % nr)/nr) + 1e-3*G(R);
+    VarVec<float> vf(1001);
+    for(size_t i = 0; i < vf.size(); i++) vf[i] = G(R);
+    VarMat< std::complex<double> > Z(7, 5);
+    for(size_t i = 0; i < Z.size(); i++) Z[i] = {G(R), G(R)};
+    const CMatrix C = CMatrix::random(64);
+    const BlockCMat BC = makeBlockCMatRandom(3, 32);
+
+    // element-wise reference (pre-bulk VarVec format loop)
+    string fname = "/tmp/testBulkArrayIO.dat";
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        std::ofstream o(fname, std::ios::binary);
+        for(size_t i = 0; i < A.size(); i++) VarVec_element_IO::writeToFile<double>(A[i], o);
+    }
+    const double t_ew = since(t0);
+    t0 = std::chrono::steady_clock::now();
+    {
+        std::ifstream s(fname, std::ios::binary);
+        VarVec<double> v;
+        for(size_t i = 0; i < A.size(); i++) v.push_back(VarVec_element_IO::readFromFile<double>(s));
+        if(v.getData() != A.getData().getData()) throw std::runtime_error("Element-wise IO mismatch");
+    }
+    const double t_er = since(t0);
+    printf("%zu x %zu VarMat<double> element-wise: write %.0f MB/s, read %.0f MB/s\n", nr, nc, nMB/t_ew, nMB/t_er);
+
+    // BinaryOutputObject format, now single-call for raw elements
+    t0 = std::chrono::steady_clock::now();
+    {
+        std::ofstream o(fname, std::ios::binary);
+        A.writeToFile(o);
+    }
+    const double t_bw = since(t0);
+    t0 = std::chrono::steady_clock::now();
+    {
+        std::ifstream s(fname, std::ios::binary);
+        if(VarMat<double>::readFromFile(s).getData().getData() != A.getData().getData()) throw std::runtime_error("VarMat writeToFile round-trip mismatch");
+    }
+    const double t_br = since(t0);
+    printf("\twriteToFile/readFromFile: write %.0f MB/s, read %.0f MB/s\n", nMB/t_bw, nMB/t_br);
+
+    for(bool z: {false, true}) {
+        t0 = std::chrono::steady_clock::now();
+        {
+            std::ofstream o(fname, std::ios::binary);
+            BulkArrayWriter W(o, z);
+            W.write(vf);
+            W.write(A);
+            W.write(Z);
+            C.writeBulk(W);
+            writeBulk(W, BC);
+        }
+        const double t_w = since(t0);
+
+        t0 = std::chrono::steady_clock::now();
+        BulkArrayFile F(fname);
+        auto vA = F.view<double>(1, BULK_VARMAT);
+        const double t_r = since(t0);
+        if(F.size() != 5) throw std::runtime_error("Bulk array record count mismatch");
+        if(vA.is_view() == z) throw std::runtime_error("Bulk array mapping mode mismatch");
+        double s = 0;
+        for(size_t i = 0; i < vA.size(); i++) s += vA[i];
+        printf("\tbulk records%s: write %.0f MB/s, %s %.0f MB/s, %.4f stored/raw (checksum %g)\n",
+               z? ", compressed" : "", nMB/t_w, z? "decompress" : "map", nMB/t_r,
+               double(F.header(1).nstored)/F.header(1).nbytes, s);
+
+        bool ok = vA.toVarMat().getData().getData() == A.getData().getData() && vA(3, 2) == A(3, 2);
+        ok = ok && F.view<float>(0, BULK_VARVEC).toVarVec().getData() == vf.getData();
+        ok = ok && F.view< std::complex<double> >(2).toVarMat().getData().getData() == Z.getData().getData();
+        const CMatrix C2 = CMatrix::readBulk(F.view<double>(3));
+        ok = ok && C2.getRealData() == C.getRealData();
+        const BlockCMat BC2 = readBulkBlockCMat(F.view<double>(4));
+        ok = ok && BC2.nRows() == BC.nRows() && BC2.nCols() == BC.nCols();
+        for(size_t i = 0; ok && i < BC.size(); i++) ok = BC2[i].getRealData() == BC[i].getRealData();
+        if(!ok) throw std::runtime_error("Bulk array round-trip mismatch");
+    }
+    remove(fname.c_str());
+}
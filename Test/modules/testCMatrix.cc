@@ -0,0 +1,88 @@
+/// \file testCMatrix.cc Validate circulant matrix algebra, including concurrent use of shared FFT plans
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "BlockCMat.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+#include <thread>
+
+/// explicit circulant matrix-vector product, data[i] at row r, column (i+r)%M
+VarVec<double> refmul(const CMatrix& C, const VarVec<double>& v) {
+    const size_t M = C.nRows();
+    VarVec<double> out(M);
+    for(size_t r=0; r<M; r++)
+        for(size_t i=0; i<M; i++)
+            out[r] += C[(i + M - r)%M]*v[i];
+    return out;
+}
+
+/// maximum difference between real-space data
+double maxdiff(const CMatrix& a, const CMatrix& b) {
+    double d = 0;
+    for(size_t i=0; i<a.nRows(); i++) d = std::max(d, fabs(a[i] - b[i]));
+    return d;
+}
+
+REGISTER_EXECLET(testCMatrix) {
+    srand(12345);
+
+    // products against explicit circulant matrices
+    for(size_t M: {1, 2, 7, 16}) {
+        const CMatrix A = CMatrix::random(M), B = CMatrix::random(M);
+        VarVec<double> v(M);
+        for(size_t i=0; i<M; i++) v[i] = rand()/double(RAND_MAX);
+        double d = (A*v - refmul(A,v)).mag2();
+        d += ((A*B)*v - refmul(A, refmul(B,v))).mag2();
+        printf("CMatrix %zu: product error %g\n", M, sqrt(d));
+        if(!(sqrt(d) < 1e-12)) throw std::runtime_error("CMatrix product mismatch");
+    }
+
+    // concurrent const use of shared matrices, with lazy k-space evaluation
+    const size_t M = 16, nt = 4;
+    const CMatrix A = CMatrix::random(M);
+    const CMatrix B = CMatrix::random(M);
+    const CMatrix AB = CMatrix(A)*CMatrix(B);
+    const CMatrix A2 = CMatrix::random(M); // evaluated only concurrently
+    vector<double> errs(nt);
+    vector<std::thread> threads;
+    for(size_t t=0; t<nt; t++) threads.emplace_back([&, t]() {
+        for(int k=0; k<200; k++) {
+            errs[t] = std::max(errs[t], maxdiff(A*B, AB));
+            errs[t] = std::max(errs[t], fabs((A2*A).trace() - (A*A2).trace()));
+        }
+    });
+    for(auto& t: threads) t.join();
+    for(auto e: errs) {
+        printf("\tconcurrent CMatrix products error %g\n", e);
+        if(!(e < 1e-12)) throw std::runtime_error("Concurrent CMatrix product mismatch");
+    }
+
+    // block circulant product, threaded vs. serial
+    const BlockCMat X = makeBlockCMatRandom(16, M), Y = makeBlockCMatRandom(16, M);
+    auto Z1 = X.multiply(Y, 1), Zn = X.multiply(Y, nt);
+    double d = 0;
+    for(size_t i=0; i<Z1.size(); i++) d = std::max(d, maxdiff(Z1[i], Zn[i]));
+    printf("BlockCMat threaded product difference %g\n", d);
+    if(!(d < 1e-12)) throw std::runtime_error("Threaded BlockCMat product mismatch");
+
+#ifdef WITH_LAPACKE
+    // per-mode SVD, serial and threaded; pseudo-inverse of invertible matrix
+    const size_t nb = 12, Mb = 256;
+    BlockCMat BC = makeBlockCMatRandom(nb, Mb);
+    for(size_t i=0; i<nb; i++) BC(i,i) += CMatrix::identity(Mb)*nb;
+    for(size_t i=0; i<nb; i+=2) BC(i,0).getKData(); // mix of real- and k-space blocks
+    for(int nt: {1, 4}) {
+        auto t0 = std::chrono::steady_clock::now();
+        BlockCMat_SVD SVD(BC, nt);
+        const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        auto I = BC * SVD.calc_pseudo_inverse();
+        auto I0 = makeBlockCMatIdentity(nb, Mb);
+        double e = 0;
+        for(size_t i=0; i<I.size(); i++) e = std::max(e, maxdiff(I[i], I0[i]));
+        printf("BlockCMat_SVD %zu x %zu blocks of %zu (nthreads = %i): %.3f s, pseudo-inverse error %g\n", nb, nb, Mb, nt, t, e);
+        if(!(e < 1e-9)) throw std::runtime_error("BlockCMat pseudo-inverse mismatch");
+    }
+#endif
+}
@@ -0,0 +1,72 @@
+/// \file testCayleyTable.cc Dense Cayley table construction, renumeration, and product throughput
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "CayleyTable.hh"
+#include "PermutationGroup.hh"
+#include "CyclicGroup.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+#include <type_traits>
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// check table against group products, renumeration, and time random products
+template<class G>
+void checkCayley(const char* name, const G& g = {}) {
+    auto t0 = std::chrono::steady_clock::now();
+    CayleyTable<G> CT(g);
+    const double tb = since(t0);
+    const size_t n = CT.getOrder();
+    printf("%s (order %zu): table built in %.1f ms\n", name, n, tb*1e3);
+
+    vector<typename std::decay<decltype(*g.begin())>::type> es;
+    for(auto& e: g) es.push_back(e);
+    for(size_t i = 0; i < n; ++i) {
+        for(size_t j = 0; j < n; ++j) if(CT.apply(i, j) != g.idx(g.apply(es[i], es[j]))) throw std::runtime_error("Cayley table product mismatch");
+        if(CT.apply(i, CT.inverse(i)) != CT.identity_idx()) throw std::runtime_error("Cayley table inverse mismatch");
+    }
+
+    // renumerate by reversal (moving identity): products must be conjugated by the permutation
+    typedef typename CayleyTable<G>::enum_t enum_t;
+    renumeration_t<enum_t> m;
+    for(size_t i = 0; i < n; ++i) m[i] = n - 1 - i;
+    auto CT2 = CT;
+    CT2.renumerate(m);
+    if(CT2.identity_idx() != m.at(CT.identity_idx())) throw std::runtime_error("Renumerated identity mismatch");
+    for(size_t i = 0; i < n; ++i) {
+        for(size_t j = 0; j < n; ++j) if(CT2.apply(m[i], m[j]) != m[CT.apply(i, j)]) throw std::runtime_error("Renumerated product mismatch");
+        if(CT2.inverse(m[i]) != m[CT.inverse(i)]) throw std::runtime_error("Renumerated inverse mismatch");
+    }
+
+    // chained products throughput
+    const size_t nprod = 20000000;
+    enum_t a = CT.identity_idx(), b = n/2;
+    size_t s = 0;
+    t0 = std::chrono::steady_clock::now();
+    for(size_t k = 0; k < nprod; ++k) {
+        a = CT.apply(a, b);
+        b = CT.apply(b, k % n);
+        s += a;
+    }
+    const double tp = since(t0);
+    printf("\t%.3g products/s (checksum %zu)\n", 2*nprod/tp, s);
+}
+
+/// symmetric group S_N enumerated from transposition and N-cycle generators
+template<size_t N>
+GeneratorsSemigroup<SymmetricGroup<N>> SN() {
+    typedef Permutation<N> P;
+    typename P::super t, c;
+    for(size_t i = 0; i < N; ++i) { t[i] = i; c[i] = (i + 1) % N; }
+    std::swap(t[0], t[1]);
+    return GeneratorsSemigroup<SymmetricGroup<N>>(vector<P>{P(t), P(c)});
+}
+
+REGISTER_EXECLET(testCayleyTable) {
+    checkCayley<CyclicGroup<6>>("C_6");
+    checkCayley("S_5", SN<5>());
+    checkCayley("S_6", SN<6>());
+}
@@ -0,0 +1,103 @@
+/// \file testClusterBuilder.cc Compare batched (vectorized breaks) and per-item ClusterBuilder clustering
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "Clustered.hh"
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+
+/// ordered test item
+template<typename X>
+struct CBItem {
+    /// ordering type
+    typedef X ordering_t;
+    /// ordering parameter
+    explicit operator ordering_t() const { return t; }
+    X t;        ///< timestamp
+    float E;    ///< some data
+};
+
+/// collect cluster summaries
+template<class C>
+class CBCollector: public DataSink<C> {
+public:
+    /// receive cluster
+    void push(C& c) override { n.push_back(c.size()); x.push_back(typename C::ordering_t(c)); }
+    vector<size_t> n;                       ///< cluster sizes
+    vector<typename C::ordering_t> x;       ///< cluster medians
+};
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// cluster v per-item and in batches; compare
+template<typename X>
+void checkClustering(const char* name, const vector<CBItem<X>>& v, X dx) {
+    typedef Cluster<const CBItem<X>> C_t;
+    const size_t nBatch = 4096;
+    CBCollector<C_t> R[3];
+    double dt[3];
+    for(int b = 0; b < 3; ++b) {
+        dt[b] = 1e9;
+        for(int rep = 0; rep < 5; ++rep) {
+            R[b] = {};
+            ClusterBuilder<C_t> CB(dx);
+            CB.setOwnsNext(false);
+            CB.getNext() = &R[b];
+            CB.batchBreaks = b == 2;
+            auto t0 = std::chrono::steady_clock::now();
+            if(b) for(size_t i = 0; i < v.size(); i += nBatch) CB.push_batch(v.data() + i, std::min(nBatch, v.size() - i));
+            else for(auto& o: v) CB.push(o);
+            CB.signal(DATASTREAM_FLUSH);
+            dt[b] = std::min(dt[b], since(t0));
+        }
+    }
+    printf("%s: %zu clusters; per-item %.2f, batched %.2f, batched with breaks %.2f ns/item (best of 5)\n",
+           name, R[0].n.size(), 1e9*dt[0]/v.size(), 1e9*dt[1]/v.size(), 1e9*dt[2]/v.size());
+    for(int b = 1; b < 3; ++b) if(R[0].n != R[b].n || R[0].x != R[b].x) throw std::runtime_error("Batched clustering mismatch");
+
+    // breaks kernel alone on buffered timestamps
+    vector<X> t(v.size());
+    for(size_t i = 0; i < v.size(); ++i) t[i] = v[i].t;
+    vector<uint32_t> b;
+    auto t0 = std::chrono::steady_clock::now();
+    size_t nc = 0;
+    for(size_t i = 0; i < t.size(); i += nBatch) {
+        b.clear();
+        cluster_breaks(t.data() + i, std::min(nBatch, t.size() - i), dx, b);
+        nc += b.size() + 1;
+    }
+    printf("\tcluster_breaks on timestamps: %.2f ns/item\n", 1e9*since(t0)/v.size());
+    if(nc < R[0].n.size()) throw std::runtime_error("cluster_breaks missed breaks");
+
+    // disordered batch still rejected
+    auto w = v;
+    std::swap(w[w.size()/2].t, w[w.size()/2 + 1].t);
+    ClusterBuilder<C_t> CB(dx);
+    CB.batchBreaks = true;
+    bool caught = false;
+    try { CB.push_batch(w.data(), w.size()); }
+    catch(std::runtime_error&) { caught = true; }
+    if(!caught) throw std::runtime_error("Disordered batch accepted");
+}
+
+REGISTER_EXECLET(testClusterBuilder) {
+    const size_t n = 4000000;
+    std::mt19937 rng(3);
+    std::exponential_distribution<double> gap(1.0);
+    std::uniform_real_distribution<double> u;
+
+    // bursts of short gaps separated by long gaps
+    vector<CBItem<double>> vd(n);
+    vector<CBItem<int64_t>> vi(n);
+    double t = 0;
+    for(size_t i = 0; i < n; ++i) {
+        t += u(rng) < 0.25? 20*gap(rng) : 0.1*gap(rng);
+        vd[i] = {t, float(u(rng))};
+        vi[i] = {int64_t(t*1000), vd[i].E};
+    }
+    checkClustering<double>("double", vd, 1.);
+    checkClustering<int64_t>("int64_t", vi, 1000);
+}
@@ -0,0 +1,103 @@
+/// \file testClustering.cc Validate and benchmark k-means and EM clustering
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "Clustering.hh"
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+
+/// elapsed seconds since t0
+double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+REGISTER_EXECLET(testClustering) {
+    const size_t n = 400000;
+    const unsigned int nc = 32, dim = 3;
+    std::mt19937 R(12345);
+    std::uniform_real_distribution<double> U(-10, 10);
+    std::normal_distribution<double> G;
+
+    // true centers, separated on a jittered grid
+    vector< VarVec<double> > centers;
+    for(unsigned int c = 0; c < nc; ++c) {
+        VarVec<double> v(dim);
+        for(unsigned int d = 0; d < dim; ++d) v[d] = 6.*((c >> (2*d)) & 3) + 0.5*U(R)/10;
+        centers.push_back(v);
+    }
+
+    KMeansCalculator K(nc);
+    K.verbose = false;
+    for(size_t i = 0; i < n; ++i) {
+        auto v = centers[i % nc];
+        for(unsigned int d = 0; d < dim; ++d) v[d] += (0.3 + 0.1*((i % nc) % 3))*G(R);
+        K.points.push_back(v);
+    }
+
+    // blocked classification vs. per-point reference loop
+    K.seedPlusPlus(7);
+    auto t0 = std::chrono::steady_clock::now();
+    vector<unsigned int> ref(n);
+    for(size_t i = 0; i < n; ++i) {
+        double mindist = std::numeric_limits<double>::max();
+        for(unsigned int c = 0; c < nc; ++c) {
+            double d = (K.points[i] - K.class_means[c]).mag2();
+            if(d < mindist) { mindist = d; ref[i] = c; }
+        }
+    }
+    double t_ref = since(t0);
+    for(int nt: {1, 0}) {
+        K.nthreads = nt;
+        K.classification.assign(n, nc);
+        t0 = std::chrono::steady_clock::now();
+        K.classify();
+        printf("classify %zu points, %u means: reference %.3f s, blocked (nthreads = %i) %.3f s\n", n, nc, t_ref, nt, since(t0));
+        if(K.classification != ref) throw std::runtime_error("Blocked k-means classification mismatch");
+    }
+
+    // converge k-means from k-means++ seeding
+    t0 = std::chrono::steady_clock::now();
+    unsigned int nsteps = 0;
+    while(K.kMeans_step() && ++nsteps < 50) { }
+    printf("k-means converged after %u reclassifying steps, %.3f s\n", nsteps, since(t0));
+    double dmax = 0;
+    for(auto& c: centers) {
+        double dmin = std::numeric_limits<double>::max();
+        for(auto& m: K.class_means) dmin = std::min(dmin, (c - m).mag2());
+        dmax = std::max(dmax, dmin);
+    }
+    printf("\tmaximum true center distance to nearest mean %g\n", sqrt(dmax));
+    if(!(dmax < 0.01)) throw std::runtime_error("k-means failed to recover centers");
+
+    // EM refinement: mixture likelihood must not decrease
+    EMClusterer EM(nc, dim);
+    EM.storeProbs = false;
+    EM.initFromKMeans(K);
+    t0 = std::chrono::steady_clock::now();
+    double ll0 = -std::numeric_limits<double>::infinity();
+    for(int s = 0; s < 6; ++s) {
+        EM.step();
+        printf("\tEM step %i: log L = %.6f\n", s, EM.mixLogL);
+        if(EM.mixLogL < ll0 - 1e-9*fabs(ll0)) throw std::runtime_error("EM likelihood decreased");
+        ll0 = EM.mixLogL;
+    }
+    printf("6 EM steps in %.3f s\n", since(t0));
+
+    // kernel log-likelihood vs. per-point matrix evaluation
+    double llref = 0;
+    for(size_t i = 0; i < n; ++i) llref += log(EM.tau[EM.classification[i]]) + EM.logprob(EM.points[i], EM.classification[i]);
+    const double ll = EM.logL();
+    printf("classified log L %.6f, reference %.6f\n", ll, llref);
+    if(!(fabs(ll - llref) < 1e-9*fabs(llref))) throw std::runtime_error("EM log likelihood mismatch");
+
+    // recovered cluster widths
+    double emax = 0;
+    for(unsigned int j = 0; j < nc; ++j) {
+        unsigned int c0 = 0;
+        for(unsigned int c = 1; c < nc; ++c) if((centers[c] - EM.mu[j]).mag2() < (centers[c0] - EM.mu[j]).mag2()) c0 = c;
+        const double s = 0.3 + 0.1*(c0 % 3);
+        for(unsigned int d = 0; d < dim; ++d) emax = std::max(emax, fabs(EM.Sigma[j](d,d)/(s*s) - 1));
+    }
+    printf("\tmaximum relative covariance error %g\n", emax);
+    if(!(emax < 0.05)) throw std::runtime_error("EM failed to recover cluster widths");
+}
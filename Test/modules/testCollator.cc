@@ -0,0 +1,74 @@
+/// \file testCollator.cc Compare Collator engines for correctness and speed
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ConfigCollator.hh"
+#include <chrono>
+#include <stdlib.h>
+
+/// simple time-ordered datapoint
+struct CollatorTestItem {
+    /// ordering type
+    typedef double ordering_t;
+    /// ordering parameter
+    explicit operator ordering_t() const { return t; }
+
+    double t;       ///< time
+    size_t src;     ///< source stream
+    double w[6];    ///< payload
+};
+
+/// count output and check order
+class CollatorTestSink: public DataSink<const CollatorTestItem> {
+public:
+    /// check received item
+    void push(const CollatorTestItem& o) override {
+        if(o.t < t_prev) ++ndisordered;
+        t_prev = o.t;
+        ++n;
+    }
+
+    size_t n = 0;           ///< number received
+    size_t ndisordered = 0; ///< number received out-of-order
+    double t_prev = 0;      ///< previous received time
+};
+
+/// time collating nIn interleaved streams; return ns per item
+double timeCollator(size_t nIn, _Collator::engine_t e, size_t nItems) {
+    Collator<CollatorTestItem> C;
+    C.setEngine(e);
+    CollatorTestSink S;
+    C.getNext() = &S;
+    C.setOwnsNext(false);
+    for(size_t i = 0; i < nIn; ++i) C.add_input();
+
+    vector<double> tnext(nIn);
+    for(auto& t: tnext) t = drand48();
+    srand48(nIn);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < nItems; ++i) {
+        auto j = lrand48() % nIn;
+        CollatorTestItem o{tnext[j], j, {}};
+        tnext[j] += drand48();
+        C.push(j, o);
+    }
+    C.signal(DATASTREAM_FLUSH);
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if(S.n != nItems || S.ndisordered) printf("*** ERROR: %zu/%zu items received, %zu disordered!\n", S.n, nItems, S.ndisordered);
+    return 1e9*dt/nItems;
+}
+
+REGISTER_EXECLET(testCollator) {
+    int nItems = 1000000;
+    Cfg.lookupValue("nItems", nItems);
+
+    printf("Collator engine timing (ns/item) for %i items:\n", nItems);
+    printf("inputs\theap\ttournament\n");
+    for(size_t nIn: {4, 16, 64}) {
+        auto th = timeCollator(nIn, _Collator::COLLATE_HEAP, nItems);
+        auto tt = timeCollator(nIn, _Collator::COLLATE_TOURNAMENT, nItems);
+        printf("%zu\t%.1f\t%.1f\n", nIn, th, tt);
+    }
+}
@@ -0,0 +1,74 @@
+/// \file testCompactKeyTable.cc CompactKeyTable typed access, serialization, mmap file round-trip, and lookup speed
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "CompactKeyTable.hh"
+#include <chrono>
+#include <stdio.h>
+
+REGISTER_EXECLET(testCompactKeyTable) {
+    int nkeys = 1000;
+    int nlookup = 10000000;
+    Cfg.lookupValue("nkeys", nkeys);
+    Cfg.lookupValue("nlookup", nlookup);
+
+    CompactKeyTable KT;
+    KT.Set("name", "testCompactKeyTable");
+    KT.Set("N", int64_t(12345));
+    KT.Set("x", 2.5);
+    vector<double> v(10000);
+    for(size_t i = 0; i < v.size(); ++i) v[i] = i;
+    KT.Set("hist", v);
+    for(int i = 0; i < nkeys; ++i) KT.Set("k" + std::to_string(i), double(i));
+
+    bool ok = KT.GetString("name") == "testCompactKeyTable" && KT.Get<int64_t>("N") == 12345 && KT.GetDefault("missing", 7.) == 7.;
+    auto h = KT.view<double>("hist");
+    ok = ok && h.size() == v.size() && h[9999] == 9999;
+    try { KT.Get<int32_t>("N"); ok = false; }
+    catch(std::domain_error&) { }
+
+    // resize, unset, compact
+    KT.Set("hist", vector<double>(20000, 1.));
+    KT.Unset("x");
+    auto g = KT.garbageBytes();
+    KT.compact();
+    ok = ok && g && !KT.garbageBytes() && KT.view<double>("hist").size() == 20000 && !KT.has("x");
+
+    // serialize; accumulate
+    BinarySerializer S;
+    S.send(KT);
+    MemBReader R(S.buf().data(), S.buf().size());
+    CompactKeyTable KT2;
+    R.receive(KT2);
+    KT2 += KT;
+    ok = ok && KT2.Get<double>("k10") == 20 && KT2.view<double>("hist")[5] == 2 && KT2.Get<int64_t>("N") == 2*12345;
+
+    // file round-trip, mapped in place
+    string fname = "/tmp/testCompactKeyTable.ckt";
+    KT.writeFile(fname);
+    {
+        MappedKeyTable M(fname);
+        ok = ok && M.size() == KT.size() && M.GetString("name") == KT.GetString("name") && M.Get<double>("k999") == 999;
+        CompactKeyTable KT3(M);
+        ok = ok && KT3.view<double>("hist").size() == 20000;
+    }
+    remove(fname.c_str());
+
+    // lookup speed, by string and by pre-hashed key
+    vector<string> ks;
+    for(int i = 0; i < nkeys; ++i) ks.push_back("k" + std::to_string(i));
+    vector<CKTLookup::key_t> hs;
+    for(auto& k: ks) hs.push_back(CKTLookup::ckey(k).h);
+    double s = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < nlookup/10; ++i) s += KT.Get<double>(ks[i % nkeys]);
+    auto t1 = std::chrono::steady_clock::now();
+    for(int i = 0; i < nlookup; ++i) s += KT.Get<double>(hs[i % nkeys]);
+    auto t2 = std::chrono::steady_clock::now();
+    printf("CompactKeyTable %i keys, %zu arena bytes: string-key lookup %.1f ns; hashed-key lookup %.1f ns (%g)\n",
+           int(KT.size()), KT.arenaSize(),
+           1e9*std::chrono::duration<double>(t1 - t0).count()/(nlookup/10),
+           1e9*std::chrono::duration<double>(t2 - t1).count()/nlookup, s);
+
+    if(!ok) printf("*** ERROR: CompactKeyTable mismatch!\n");
+}
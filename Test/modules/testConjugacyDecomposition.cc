@@ -0,0 +1,83 @@
+/// \file testConjugacyDecomposition.cc Conjugacy classes by all-element and generator orbits, serial and threaded
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "MathieuGroup.hh"
+#include <chrono>
+#include <stdexcept>
+
+/// throw on failed check
+static void check(bool ok, const char* what) { if(!ok) throw std::runtime_error(string("ConjugacyDecomposition check failed: ") + what); }
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// identical class numbering, membership and powerup structure
+template<class CD>
+static bool same(const CD& a, const CD& b) {
+    if(a.M.size() != b.M.size()) return false;
+    for(auto& kv: a.M) {
+        auto it = b.M.find(kv.first);
+        if(it == b.M.end()) return false;
+        auto& x = kv.second;
+        auto& y = it->second;
+        if(x.powerup != y.powerup || x.CCs.size() != y.CCs.size()) return false;
+        for(auto c: x.CCs) if(x.CCs.getClassNum(c) != y.CCs.getClassNum(c)) return false;
+    }
+    return true;
+}
+
+/// classes partition group, with sizes dividing group order; conjugates stay in class
+template<class CD, class G>
+static void check_classes(const CD& D, const G& g, size_t nclasses) {
+    size_t n = 0, nc = 0;
+    for(auto& kv: D.M) {
+        for(auto c: kv.second.CCs) {
+            auto& v = kv.second.CCs.getClassNum(c);
+            check(!(g.getOrder() % v.size()), "class size divides order");
+            for(auto i: v) check(D.cycles[i].size() == kv.first, "class element order");
+            auto x = g.element(v.back() % g.getOrder());
+            auto e = g.element(v.front());
+            auto j = g.idx(g.apply(g.apply(x, e), g.element(D.inverse_idx(g.idx(x)))));
+            check(kv.second.CCs.classidx(j) == c, "conjugate in class");
+            n += v.size();
+            ++nc;
+        }
+    }
+    check(n == g.getOrder(), "classes partition group");
+    check(nc == nclasses, "number of classes");
+}
+
+REGISTER_EXECLET(testConjugacyDecomposition) {
+    typedef ConjugacyDecomposition<SymmetricGroup<5>> S5_conj_t;
+    check_classes(S5_conj_t(), SymmetricGroup<5>(), 7);
+
+    typedef MathieuGroup::M11_conj_t M11_conj_t;
+    auto& M11 = MathieuGroup::M11();
+    M11_conj_t::nthreads = 1;
+    M11_conj_t A(M11), B(M11, {MathieuGroup::M11a, MathieuGroup::M11b});
+    M11_conj_t::nthreads = 3;
+    M11_conj_t C(M11, {MathieuGroup::M11a, MathieuGroup::M11b});
+    check_classes(A, M11, 10);
+    check(same(A, B), "M11 generator orbits");
+    check(same(A, C), "M11 threaded orbits");
+
+    typedef ConjugacyDecomposition<MathieuGroup::M12_genspan_t> M12_conj_t;
+    auto& M12 = MathieuGroup::M12();
+    double dt[2][2];
+    vector<M12_conj_t> vD;
+    for(int nt: {1, 0}) {
+        M12_conj_t::nthreads = nt;
+        for(int m = 0; m < 2; ++m) {
+            auto t0 = std::chrono::steady_clock::now();
+            if(m) vD.emplace_back(M12, vector<MathieuGroup::M12_repr_t>{MathieuGroup::M12a, MathieuGroup::M12b});
+            else vD.emplace_back(M12);
+            dt[!nt][m] = since(t0);
+        }
+    }
+    check_classes(vD[0], M12, 15);
+    for(auto& D: vD) check(same(vD[0], D), "M12 orbits");
+    printf("M12 conjugacy classes: all-element orbits %.3f s (%.3f s threaded), generator orbits %.3f s (%.3f s threaded)\n",
+           dt[0][0], dt[1][0], dt[0][1], dt[1][1]);
+    M12_conj_t::nthreads = M11_conj_t::nthreads = 0;
+}
@@ -0,0 +1,63 @@
+/// \file testContextMap.cc Check ContextMap inheritance, cached lookup invalidation, and per-thread stacks
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ContextMap.hh"
+#include <chrono>
+#include <thread>
+
+/// context singleton test object
+class CtxTestSingleton: public s_context_singleton_ptr<CtxTestSingleton> {
+public:
+    int x = 7;  ///< test value
+};
+
+/// label for test values
+struct CtxTestLabel { };
+
+REGISTER_EXECLET(testContextMap) {
+    int nbad = 0;
+    ContextMap::setCopy<int, CtxTestLabel>(1);
+
+    // inherit, override, and re-expose parent values
+    ContextMap::pushContext();
+    ContextMap::pushContext();
+    if(!ContextMap::get<int, CtxTestLabel>() || *ContextMap::get<int, CtxTestLabel>() != 1) ++nbad;
+    ContextMap::getRootContext()._setCopy<int, CtxTestLabel>(2); // invalidates cached resolution
+    if(*ContextMap::get<int, CtxTestLabel>() != 2) ++nbad;
+    ContextMap::setCopy<int, CtxTestLabel>(3);
+    if(*ContextMap::get<int, CtxTestLabel>() != 3) ++nbad;
+    ContextMap::popContext();
+    if(*ContextMap::get<int, CtxTestLabel>() != 2) ++nbad;
+    ContextMap::setPtr<int, CtxTestLabel>(nullptr); // explicitly-null value hides parent
+    if(ContextMap::get<int, CtxTestLabel>()) ++nbad;
+    if(nbad) printf("*** ERROR: %i incorrect context lookups!\n", nbad);
+
+    // per-thread stacks: thread contexts inherit root, without modifying this thread's stack
+    CtxTestSingleton S;
+    auto nstack = ContextMap::getContextStack().size();
+    std::thread T([&nbad]() {
+        if(CtxTestSingleton::instance()) ++nbad;  // registered in main thread context, not root
+        if(*ContextMap::get<int, CtxTestLabel>() != 2) ++nbad;
+        ContextMap::pushContext();
+        ContextMap::setCopy<int, CtxTestLabel>(4);
+        if(*ContextMap::get<int, CtxTestLabel>() != 4) ++nbad;
+    });
+    T.join();
+    if(nbad || ContextMap::getContextStack().size() != nstack || ContextMap::get<int, CtxTestLabel>()) printf("*** ERROR: context leaked between threads!\n");
+
+    // lookup timing through chain
+    int ntrials = 10000000;
+    Cfg.lookupValue("ntrials", ntrials);
+    ContextMap::pushContext();
+    ContextMap::pushContext();
+    size_t nx = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < ntrials; ++i) nx += CtxTestSingleton::instance()->x;
+    auto t1 = std::chrono::steady_clock::now();
+    printf("instance() lookup through 3 contexts: %.2f ns\n", std::chrono::duration<double, std::nano>(t1 - t0).count()/ntrials);
+    if(nx != 7*size_t(ntrials)) printf("*** ERROR: wrong singleton instance!\n");
+    ContextMap::popContext();
+    ContextMap::popContext();
+    ContextMap::popContext();
+}
@@ -0,0 +1,94 @@
+/// \file testCoordTransform.cc Validate and benchmark batched (fused) coordinate transforms against per-point calls
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "CoordTransform.hh"
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+#include <vector>
+
+/// timing helper: best of several runs of f(m) over L1-resident block of m points, in ns per point
+template<typename F>
+double time_ns(F f, size_t m = 512, int reps = 2000) {
+    double t = 1e9;
+    for(int k = 0; k < 5; ++k) {
+        auto t0 = std::chrono::steady_clock::now();
+        for(int r = 0; r < reps; ++r) {
+            f(m);
+            asm volatile("" ::: "memory"); // keep repetitions from being merged
+        }
+        t = std::min(t, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return t*1e9/(m*reps);
+}
+
+/// random rotation-like transform
+template<unsigned int N>
+CoordTransform<N,double> randomTransform(std::mt19937& R) {
+    std::uniform_real_distribution<double> U(-1, 1);
+    Matrix<N,N,double> M;
+    Vec<N,double> v;
+    for(size_t i = 0; i < M.size(); i++) M[i] = U(R);
+    for(size_t i = 0; i < N; i++) v[i] = U(R);
+    CoordTransform<N,double> C;
+    C *= M;
+    C += v;
+    return C;
+}
+
+/// compare chained per-point application, fused AoS and SoA batches
+template<unsigned int N>
+void ctest(size_t n, std::mt19937& R) {
+    typedef CoordTransform<N,double> CT;
+    std::uniform_real_distribution<double> U(-10, 10);
+    const CT A = randomTransform<N>(R), B = randomTransform<N>(R), C = randomTransform<N>(R);
+    const CT F = C*(B*A); // applies A, then B, then C
+
+    vector< Vec<N,double> > p(n), s(n), b(n);
+    vector< vector<double> > x(N, vector<double>(n)), y = x;
+    typename CT::soa_in_t pin;
+    typename CT::soa_out_t pout;
+    for(size_t j = 0; j < N; j++) {
+        pin[j] = x[j].data();
+        pout[j] = y[j].data();
+    }
+    for(size_t k = 0; k < n; k++) for(size_t j = 0; j < N; j++) x[j][k] = p[k][j] = U(R);
+
+    auto f_s = [&](size_t m) { for(size_t k = 0; k < m; k++) s[k] = C*(B*(A*p[k])); };
+    auto f_f = [&](size_t m) { for(size_t k = 0; k < m; k++) s[k] = F*p[k]; };
+    auto f_a = [&](size_t m) { F.apply(p.data(), b.data(), m); };
+    auto f_b = [&](size_t m) { F.apply(pin, pout, m); };
+    printf("CoordTransform<%u>: chained %.2f ns, fused %.2f ns, AoS batch %.2f ns, SoA batch %.2f ns per point\n",
+           N, time_ns(f_s), time_ns(f_f), time_ns(f_a), time_ns(f_b));
+
+    f_s(n); f_a(n); f_b(n);
+    double d = 0;
+    for(size_t k = 0; k < n; k++)
+        for(size_t j = 0; j < N; j++)
+            d = std::max(d, std::max(fabs(s[k][j] - b[k][j]), fabs(s[k][j] - y[j][k]))/(1 + fabs(s[k][j])));
+
+    // in-place, and rotation-only
+    F.apply(b.data(), b.data(), n);
+    F.apply(pout, n);
+    typename CT::soa_out_t px;
+    for(size_t j = 0; j < N; j++) px[j] = x[j].data();
+    F.rotate(px, n);
+    for(size_t k = 0; k < n; k++) {
+        auto v = F*(F*p[k]);
+        auto r = F.rotate(p[k]);
+        for(size_t j = 0; j < N; j++)
+            d = std::max(d, std::max(fabs(v[j] - b[k][j]) + fabs(v[j] - y[j][k]), fabs(r[j] - x[j][k]))/(1 + fabs(v[j]) + fabs(r[j])));
+    }
+    printf("\tmax relative difference %g\n", d);
+    if(!(d < 1e-12)) throw std::runtime_error("Batch CoordTransform mismatch");
+}
+
+REGISTER_EXECLET(testCoordTransform) {
+    std::mt19937 R(12345);
+    const size_t n = 1000003; // not a multiple of block size
+    ctest<2>(n, R);
+    ctest<3>(n, R);
+    ctest<4>(n, R);
+}
@@ -0,0 +1,75 @@
+/// \file testDecisionTree.cc Compare CompiledDecisionTree batch evaluation against DecisionTree::decide
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "DecisionTree.hh"
+#include <chrono>
+#include <stdlib.h>
+
+/// grid-cell classification tree: cell i = ix + nx*iy on [0,nx)x[0,ny); tests x < 1...nx-1, y < 1...ny-1
+class GridTree: public DecisionTree {
+public:
+    /// Constructor
+    GridTree(size_t nx, size_t ny): DecisionTree(nx*ny, nx + ny - 2, [nx](size_t i, size_t t) { return GridTree::test(nx, cellCenter(nx, i), t); }) {
+        for(size_t t = 0; t < nx + ny - 2; ++t) {
+            feature.push_back(t < nx - 1? 0 : 1);
+            threshold.push_back(t < nx - 1? t + 1 : t - (nx - 1) + 1);
+        }
+    }
+
+    /// cell center coordinates
+    static std::pair<double, double> cellCenter(size_t nx, size_t i) { return {i % nx + 0.5, i / nx + 0.5}; }
+    /// test t on point p
+    static bool test(size_t nx, std::pair<double, double> p, size_t t) { return t < nx - 1? p.first < t + 1 : p.second < t - (nx - 1) + 1; }
+
+    vector<uint32_t> feature;   ///< compiled test features
+    vector<double> threshold;   ///< compiled test thresholds
+};
+
+REGISTER_EXECLET(testDecisionTree) {
+    int n = 1000000;
+    Cfg.lookupValue("n", n);
+    const size_t nx = 16, ny = 16;
+
+    GridTree G(nx, ny);
+    GridTree G2(4, 8);
+    CompiledDecisionTree<> C;
+    C.add(G, G.feature, G.threshold);
+    C.add(G, G.feature, G.threshold, CompiledDecisionTree<>::VAN_EMDE_BOAS);
+    C.add(G2, G2.feature, G2.threshold);
+    printf("%zu trees, %zu nodes; depths %zu, %zu, %zu\n", C.ntrees(), C.nnodes(), C.depth(0), C.depth(1), C.depth(2));
+
+    // random points, SoA
+    srand(999);
+    vector<double> vx(n), vy(n);
+    for(int i = 0; i < n; ++i) {
+        vx[i] = nx*(rand() + 0.5)/(RAND_MAX + 1.);
+        vy[i] = ny*(rand() + 0.5)/(RAND_MAX + 1.);
+    }
+    const double* X[2] = {vx.data(), vy.data()};
+
+    vector<size_t> r0(n), r1(n), r2(n);
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < n; ++i) r0[i] = G.decide(std::make_pair(vx[i], vy[i]), [nx](std::pair<double, double> p, size_t t) { return GridTree::test(nx, p, t); });
+    auto t1 = std::chrono::steady_clock::now();
+    C.decide(X, n, r1.data(), 0);
+    auto t2 = std::chrono::steady_clock::now();
+    C.decide(X, n, r2.data(), 1);
+    auto t3 = std::chrono::steady_clock::now();
+    printf("per item: DecisionTree %.1f ns, compiled breadth-first %.1f ns, van Emde Boas %.1f ns\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count()/n,
+           std::chrono::duration<double, std::nano>(t2 - t1).count()/n,
+           std::chrono::duration<double, std::nano>(t3 - t2).count()/n);
+
+    int nbad = 0;
+    size_t rall[3];
+    for(int i = 0; i < n; ++i) {
+        if(r0[i] != size_t(vx[i]) + nx*size_t(vy[i]) || r1[i] != r0[i] || r2[i] != r0[i]) ++nbad;
+        if(i % 97) continue;
+        double x[2] = {vx[i], vy[i]};
+        C.decideAll(x, rall);
+        size_t c2 = G2.decide(std::make_pair(x[0], x[1]), [](std::pair<double, double> p, size_t t) { return GridTree::test(4, p, t); });
+        if(rall[0] != r0[i] || rall[1] != r0[i] || rall[2] != c2 || C.decide(x, 2) != c2) ++nbad;
+    }
+    if(nbad) printf("*** ERROR: %i mismatched classifications!\n", nbad);
+}
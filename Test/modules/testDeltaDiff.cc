@@ -0,0 +1,66 @@
+/// \file testDeltaDiff.cc Native block comparison versus external diff on large file pairs
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "DeltaDiff.hh"
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <stdio.h>
+
+/// time comparison function; print result
+template<typename F>
+static bool timecomp(const char* nm, size_t nbytes, F f) {
+    auto t0 = std::chrono::steady_clock::now();
+    bool r = f();
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("** %s: %s in %.3f s (%.1f MB/s)\n", nm, r? "same" : "different", dt, nbytes/1e6/dt);
+    return r;
+}
+
+REGISTER_EXECLET(testDeltaDiff) {
+    int nMB = 1024;
+    int nthreads = 0;
+    string dir = "/tmp";
+    Cfg.lookupValue("nMB", nMB);
+    Cfg.lookupValue("nthreads", nthreads);
+    Cfg.lookupValue("dir", dir);
+
+    DeltaDiff D;
+    D.fref = dir + "/testDeltaDiff_a.txt";
+    D.fcomp = dir + "/testDeltaDiff_b.txt";
+    D.nthreads = nthreads;
+    size_t n = size_t(nMB) << 20;
+
+    // numeric text file pair
+    {
+        std::ofstream a(D.fref), b(D.fcomp);
+        std::mt19937 R(1);
+        std::uniform_real_distribution<double> U(0, 100);
+        size_t written = 0;
+        char s[64];
+        while(written < n) {
+            int k = snprintf(s, sizeof(s), "%.9f %.9f %.9f\n", U(R), U(R), U(R));
+            a.write(s, k);
+            b.write(s, k);
+            written += k;
+        }
+    }
+
+    bool ok = timecomp("native, identical", n, [&D] { return D.filecompare(); });
+    ok &= timecomp("diff, identical", n, [&D] { return D.diffcompare(); });
+
+    // perturb last number beyond printed precision
+    {
+        std::fstream b(D.fcomp, std::ios::in | std::ios::out);
+        b.seekp(-2, std::ios::end);
+        b.put('9');
+    }
+    ok &= !timecomp("native, changed at end", n, [&D] { return D.filecompare(); });
+    D.numtol = 1e-6;
+    ok &= timecomp("native, numeric tolerance", n, [&D] { return D.filecompare(); });
+
+    remove(D.fref.c_str());
+    remove(D.fcomp.c_str());
+    if(!ok) printf("*** ERROR: DeltaDiff test failed!\n");
+}
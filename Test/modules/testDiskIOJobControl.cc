@@ -0,0 +1,99 @@
+/// \file testDiskIOJobControl.cc DiskIOJobControl round trips to worker threads through a scratch directory; batching and notification versus polling
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "DiskIOJobControl.hh"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// total job items run by DiskEchoJob
+static std::atomic<size_t> nDiskEchoItems{0};
+
+/// worker returning received payload
+class DiskEchoJob: public JobWorker {
+public:
+    /// run job
+    void run(const JobSpec& J, BinaryIO& B) override {
+        nDiskEchoItems += J.N1 - J.N0;
+        B.receive(v);
+        B.send(v);
+    }
+protected:
+    vector<double> v;   ///< payload
+};
+
+REGISTER_FACTORYOBJECT(DiskEchoJob, JobWorker)
+
+/// controller side of DiskEchoJob
+class DiskEchoComm: public JobComm {
+public:
+    /// send payload
+    void startJob(BinaryIO& B) override { B.send(v); }
+    /// receive and check echoed payload
+    void endJob(BinaryIO& B) override {
+        vector<double> v2;
+        B.receive(v2);
+        if(v2 == v) ++nGood;
+    }
+
+    vector<double> v;   ///< payload
+    size_t nGood = 0;   ///< number of correctly returned payloads
+};
+
+/// run jobs through worker threads; return jobs per second
+double diskJobRate(const string& d, int nw, int batch, bool notify, int njobs) {
+    DiskIOJobControl JC(d, nw, batch);
+    JC.watch.setNotify(notify);
+    vector<std::thread> vt;
+    vector<size_t> nw_commits(nw);
+    for(int k = 1; k <= nw; ++k) vt.emplace_back([&d, k, notify, &nw_commits] {
+        DiskIOJobWorker W(d, k);
+        W.watch.setNotify(notify);
+        W.runWorkerJobs();
+        nw_commits[k-1] = W.nCommits;
+    });
+
+    DiskEchoComm C;
+    C.v.resize(100);
+    for(size_t i = 0; i < C.v.size(); ++i) C.v[i] = i;
+    JobSpec JS;
+    JS.wclass = FactoriesIndex::hash("DiskEchoJob");
+    JS.C = &C;
+    nDiskEchoItems = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < njobs; ++i) {
+        JS.N0 = i;
+        JS.N1 = i + 1;
+        JC.submitJob(JS);
+    }
+    JC.waitComplete();
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    JC.stopWorkers();
+    for(auto& t: vt) t.join();
+
+    size_t nc = 0;
+    for(auto n: nw_commits) nc += n;
+    printf("%i workers, batch %i, %s: %.0f jobs/s; %zu job files, %zu result files, %zu controller waits\n",
+           nw, batch, JC.watch.hasNotify()? "inotify" : "polling", njobs/dt, JC.nCommits, nc, JC.watch.nWaits);
+    if(C.nGood != size_t(njobs) || nDiskEchoItems != size_t(njobs)) printf("*** ERROR: %zu of %i jobs returned correctly!\n", C.nGood, njobs);
+    return njobs/dt;
+}
+
+REGISTER_EXECLET(testDiskIOJobControl) {
+    int njobs = 2000;
+    Cfg.lookupValue("njobs", njobs);
+
+    char dtemplate[] = "/tmp/testDiskIOJC_XXXXXX";
+    if(!mkdtemp(dtemplate)) throw std::runtime_error("Unable to create scratch directory");
+    string d = dtemplate;
+
+    diskJobRate(d, 2, 1, false, njobs);
+    diskJobRate(d, 2, 1, true, njobs);
+    diskJobRate(d, 2, 16, false, njobs);
+    diskJobRate(d, 2, 16, true, njobs);
+
+    if(rmdir(d.c_str())) printf("*** ERROR: exchange files left in '%s'!\n", d.c_str());
+}
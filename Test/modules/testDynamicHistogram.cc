@@ -0,0 +1,64 @@
+/// \file testDynamicHistogram.cc SparseHistogram fill rate versus thread count: locked, per-thread merged, and staged concurrent fill
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ConcurrentHistogram.hh"
+#include <chrono>
+#include <random>
+#include <thread>
+#include <stdio.h>
+
+/// run f(thread number, n fills) in nthreads threads; return fills/s
+template<typename F>
+double fillRate(int nthreads, size_t nfill, F f) {
+    auto t0 = std::chrono::steady_clock::now();
+    vector<std::thread> v;
+    for(int i = 0; i < nthreads; ++i) v.emplace_back(f, i, nfill/nthreads);
+    for(auto& t: v) t.join();
+    return nfill/std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+REGISTER_EXECLET(testDynamicHistogram) {
+    int nfill = 4000000;
+    int maxthreads = 8;
+    Cfg.lookupValue("nfill", nfill);
+    Cfg.lookupValue("maxthreads", maxthreads);
+
+    printf("threads\tlocked [fills/s]\tmerged\tconcurrent\n");
+    for(int nt = 1; nt <= maxthreads; nt *= 2) {
+        SparseHistogram H0(0, 0.1), H1(0, 0.1), H2(0, 0.1);
+
+        std::mutex m;
+        auto r0 = fillRate(nt, nfill, [&](int i, size_t n) {
+            std::mt19937 R(i);
+            std::normal_distribution<double> G(0, 100);
+            while(n--) {
+                auto x = G(R);
+                std::lock_guard<std::mutex> l(m);
+                H0.fill(x);
+            }
+        });
+
+        auto r1 = fillRate(nt, nfill, [&](int i, size_t n) {
+            std::mt19937 R(i);
+            std::normal_distribution<double> G(0, 100);
+            SparseHistogram h(0, 0.1);
+            while(n--) h.fill(G(R));
+            std::lock_guard<std::mutex> l(m);
+            H1.merge(h);
+        });
+
+        ConcurrentHistogramFill CF(H2);
+        auto r2 = fillRate(nt, nfill, [&](int i, size_t n) {
+            std::mt19937 R(i);
+            std::normal_distribution<double> G(0, 100);
+            while(n--) CF.fill(G(R));
+        });
+        CF.flush();
+
+        printf("%i\t%.3g\t%.3g\t%.3g\n", nt, r0, r1, r2);
+        if(H2.getData().size() != H0.getData().size() || fabs(H2.total.w - H0.total.w) > 0.5
+           || H1.getData().size() != H0.getData().size())
+            printf("*** ERROR: mismatched histograms (%zu, %zu, %zu bins)\n", H0.getData().size(), H1.getData().size(), H2.getData().size());
+    }
+}
@@ -0,0 +1,50 @@
+/// \file testEquivalenceClasses.cc Compare union-find DenseEquivalenceClasses against map-based EquivalenceClasses
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "EquivalenceClasses.hh"
+#include <chrono>
+#include <stdlib.h>
+
+REGISTER_EXECLET(testEquivalenceClasses) {
+    int n = 100000;
+    Cfg.lookupValue("n", n);
+    srand(1234);
+    vector<pair<size_t, size_t>> vrel(n);
+    for(auto& p: vrel) p = {rand() % (2*n), rand() % (2*n)};
+
+    auto t0 = std::chrono::steady_clock::now();
+    EquivalenceClasses<size_t> EC;
+    for(auto& p: vrel) EC.add(p.first, p.second);
+    auto t1 = std::chrono::steady_clock::now();
+    DenseEquivalenceClasses<> DC;
+    for(auto& p: vrel) DC.add(p.first, p.second);
+    auto t2 = std::chrono::steady_clock::now();
+    printf("%i relations: %zu classes; map-based %.1f ns, union-find %.1f ns per relation\n", n, DC.size(),
+           std::chrono::duration<double, std::nano>(t1 - t0).count()/n,
+           std::chrono::duration<double, std::nano>(t2 - t1).count()/n);
+
+    // same partitions, with class identifiers in same order
+    int nbad = EC.size() != DC.size();
+    auto it = EC.begin();
+    for(auto c: DC) {
+        if(it == EC.end()) { ++nbad; break; }
+        auto& m = DC.getClassNum(c);
+        if(c != it->first || DC.classSize(c) != m.size() || set<size_t>(m.begin(), m.end()) != it->second) ++nbad;
+        ++it;
+    }
+    for(size_t e = 0; e < size_t(2*n); ++e) {
+        if(DC.has(e) != EC.has(e) || (DC.has(e) && DC.classidx(e) != EC.classidx(e))) ++nbad;
+        if(DC.equiv(e, vrel[e % n].first) != EC.equiv(e, vrel[e % n].first)) ++nbad;
+    }
+    if(nbad) printf("*** ERROR: %i class mismatches!\n", nbad);
+
+    // classification against representatives, and renumeration
+    DenseEquivalenceClasses<> DM;
+    for(size_t e = 0; e < 100; ++e) DM.classify(e, [](size_t a, size_t b) { return a % 7 == b % 7; });
+    renumeration_t<> m;
+    for(size_t e = 0; e < 100; ++e) m[e] = 99 - e;
+    DM.renumerate(m);
+    if(DM.size() != 7 || DM.classSize(0) != 15 || DM.classidx(99) != 0 || DM.classidx(98) != 1 || DM.getClassNum(0).front() != 1)
+        printf("*** ERROR: incorrect classification or renumeration!\n");
+}
@@ -1,6 +1,8 @@
 /// \file testFFTW.cc FFTW3 wrapper tests
 
 #include "FFTW_Convolver.hh"
+#include "FFTW_Batch.hh"
+#include "FFTW_StreamConvolver.hh"
 #include "ConfigFactory.hh"
 
 #include <stdlib.h>
@@ -232,4 +234,42 @@ REGISTER_EXECLET(testFFTW) {
         GDF.convolve(delta2);
         display(delta2);
     }
+
+    printf("\n\n--- Batched convolutions (interleaved rows vs. one-at-a-time) ---\n\n");
+
+    const int nrow = 4, ncol = 10;
+    FFTWBatchLayout L({ncol}, nrow, true);
+    vector<calcs_t> vb(L.total());
+    for(size_t i = 0; i < vb.size(); ++i) vb[i] = (i*7) % 5;
+    auto vb0 = vb;
+    GaussBatchConvolverFactory<calcs_t> GBF(0.5);
+    GBF.convolve(vb, L);
+    double dmax = 0;
+    for(int b = 0; b < nrow; ++b) {
+        vector<calcs_t> r(ncol);
+        for(int i = 0; i < ncol; ++i) r[i] = vb0[L.index(b,i)];
+        GCF.convolve(r);
+        for(int i = 0; i < ncol; ++i) dmax = std::max(dmax, fabs(double(r[i] - vb[L.index(b,i)])));
+        display(r);
+    }
+    printf("max deviation %g\n", dmax);
+
+    printf("\n\n--- Overlap-save stream convolution (vs. direct) ---\n\n");
+
+    auto hs = StreamConvolver<calcs_t>::gaussKernel(1.5);
+    StreamConvolver<calcs_t> SC(hs, hs.size()/2);
+    vector<calcs_t> vs(1000), vso;
+    for(size_t i = 0; i < vs.size(); ++i) vs[i] = (i*13) % 11;
+    for(size_t i = 0; i < vs.size(); i += 37) SC.push(vs.data() + i, std::min(size_t(37), vs.size() - i), vso);
+    SC.finish(vso);
+    dmax = 0;
+    for(int i = 0; i < (int)vs.size(); ++i) {
+        double y = 0;
+        for(int j = 0; j < (int)hs.size(); ++j) {
+            int k = i + int(SC.delay) - j;
+            if(k >= 0 && k < (int)vs.size()) y += hs[j]*vs[k];
+        }
+        dmax = std::max(dmax, fabs(y - vso.at(i)));
+    }
+    printf("kernel %zu, block %zu: %zu -> %zu samples, max deviation %g\n", SC.L, SC.N, vs.size(), vso.size(), dmax);
 }
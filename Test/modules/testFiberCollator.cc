@@ -0,0 +1,86 @@
+/// \file testFiberCollator.cc Collate many fiber-read sources through fiber-buffered output
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ConfigCollator.hh"
+#include "FiberBufferSink.hh"
+#include <chrono>
+#include <stdlib.h>
+
+/// simple time-ordered datapoint
+struct FiberTestItem {
+    /// ordering type
+    typedef double ordering_t;
+    /// ordering parameter
+    explicit operator ordering_t() const { return t; }
+
+    double t;       ///< time
+    size_t src;     ///< source stream
+};
+
+/// in-memory source of time-ordered items
+class FiberTestSource: public DataSource<FiberTestItem> {
+public:
+    /// Constructor, generating n items
+    FiberTestSource(size_t j, size_t n) {
+        double t = drand48();
+        while(n--) v.push_back({t += drand48()*(j % 7 + 1), j});
+    }
+    /// get next item
+    bool next(FiberTestItem& o) override {
+        if(i >= v.size()) return false;
+        o = v[i++];
+        return true;
+    }
+
+    vector<FiberTestItem> v;    ///< items
+    size_t i = 0;               ///< read position
+};
+
+/// count output and check order
+class FiberTestSink: public DataSink<const FiberTestItem> {
+public:
+    /// check received item
+    void push(const FiberTestItem& o) override {
+        if(o.t < t_prev) ++ndisordered;
+        t_prev = o.t;
+        ++n;
+    }
+
+    size_t n = 0;           ///< number received
+    size_t ndisordered = 0; ///< number received out-of-order
+    double t_prev = 0;      ///< previous received time
+};
+
+REGISTER_EXECLET(testFiberCollator) {
+    int nItems = 1000000;
+    Cfg.lookupValue("nItems", nItems);
+
+    printf("FiberCollator timing (ns/item) for %i items:\n", nItems);
+    printf("sources\tns/item\tyields\n");
+    for(size_t nIn: {10, 100, 1000, 10000}) {
+        srand48(nIn);
+        vector<FiberTestSource*> srcs;
+        for(size_t j = 0; j < nIn; ++j) srcs.push_back(new FiberTestSource(j, nItems/nIn));
+
+        FiberTestSink S;
+        FiberBufferSink<const FiberTestItem> FB(&S);
+        FB.setOwnsNext(false);
+        FiberCollator<FiberTestItem> C;
+        C.setEngine(_Collator::COLLATE_TOURNAMENT);
+        C.getNext() = &FB;
+        C.setOwnsNext(false);
+        for(auto s: srcs) C.addSource(*s);
+
+        auto t0 = std::chrono::steady_clock::now();
+        FB.launch();
+        C.run_fibers();
+        FB.finish();
+        auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        size_t n = (nItems/nIn)*nIn;
+        if(S.n != n || S.ndisordered) printf("*** ERROR: %zu/%zu items received, %zu disordered!\n", S.n, n, S.ndisordered);
+        printf("%zu\t%.1f\t%zu\n", nIn, 1e9*dt/n, C.n_yields());
+        for(auto s: srcs) delete s;
+    }
+}
@@ -6,6 +6,7 @@
 #include "NGrid.hh"
 #include "BBox.hh"
 #include <stdlib.h>
+#include <stdexcept>
 using std::cout;
 
 typedef double precision_t;
@@ -77,4 +78,20 @@ REGISTER_EXECLET(testFitters) {
     LMC.solve(vy);
     PF1.load(LMC);
     cout << PF1.P << "\n";
+
+    // multiple right-hand sides against cached factorization
+    vector<double> x0;
+    LMC.getx(x0);
+    LMC.factor();
+    gsl_matrix_wrapper Y(vy.size(), 3), X(px.size(), 3);
+    for(size_t i = 0; i < vy.size(); i++) {
+        Y(i,0) = vy[i];
+        Y(i,1) = 2*vy[i];
+        Y(i,2) = vy[i] + 1;
+    }
+    LMC.solveMulti(Y, X);
+    double dx = 0;
+    for(size_t j = 0; j < x0.size(); j++) dx = std::max(dx, fabs(X(j,0) - x0[j]));
+    cout << "multi-RHS difference " << dx << ", constraints " << X(0,0) + X(1,0) << " " << X(0,1) + X(1,1) << " " << X(0,2) + X(1,2) << "\n";
+    if(!(dx < 1e-9)) throw std::runtime_error("Multiple-RHS solution mismatch");
 }
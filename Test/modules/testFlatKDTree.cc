@@ -0,0 +1,101 @@
+/// \file testFlatKDTree.cc FlatKDTree versus KDBuilder partitioning, range counts versus brute force, and build rates
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "FlatKDTree.hh"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+
+/// leaf bounds and counts, in BoxTreeNode iteration order
+vector<double> leafSummary(const BoxTreeNode* T, const map<const BoxTreeNode*,double>& lc, int ndim) {
+    vector<double> v;
+    for(auto n: *T) {
+        if(!n->isLeaf()) continue;
+        for(int a = 0; a < ndim; ++a) { v.push_back(n->bLo(a)); v.push_back(n->bHi(a)); }
+        auto it = lc.find(n);
+        v.push_back(it == lc.end()? -1 : it->second);
+    }
+    return v;
+}
+
+REGISTER_EXECLET(testFlatKDTree) {
+    int npts = 100000;
+    int ndim = 3;
+    int nq = 1000;
+    int nthreads = 0;
+    Cfg.lookupValue("npts", npts);
+    Cfg.lookupValue("ndim", ndim);
+    Cfg.lookupValue("nq", nq);
+    Cfg.lookupValue("nthreads", nthreads);
+
+    // tie-free coordinates (shuffled distinct values) so partitions are unique
+    std::mt19937 R(12345);
+    vector<float> x(size_t(npts)*ndim);
+    vector<float> u(npts);
+    for(int a = 0; a < ndim; ++a) {
+        for(int i = 0; i < npts; ++i) u[i] = a % 2? float(i)*i/npts : i;
+        std::shuffle(u.begin(), u.end(), R);
+        for(int i = 0; i < npts; ++i) x[size_t(i)*ndim + a] = u[i];
+    }
+    vector<float*> ps(npts);
+    for(int i = 0; i < npts; ++i) ps[i] = &x[size_t(i)*ndim];
+
+    auto t0 = std::chrono::steady_clock::now();
+    KDBuilder K(ndim);
+    K.initData(ps);
+    map<const BoxTreeNode*,double> lc1;
+    auto T1 = K.buildKD(lc1, K.boundData(0.01))->getTop();
+    auto t1 = std::chrono::steady_clock::now();
+    FlatKDTree F(ndim);
+    F.build(ps);
+    auto t2 = std::chrono::steady_clock::now();
+    FlatKDTree Fp(ndim);
+    Fp.nthreads = nthreads;
+    Fp.par_min = 1024;
+    Fp.build(ps);
+    auto t3 = std::chrono::steady_clock::now();
+
+    map<const BoxTreeNode*,double> lc2;
+    auto T2 = F.toBoxTree(lc2, F.boundData(0.01))->getTop();
+    int nbad = leafSummary(T1, lc1, ndim) != leafSummary(T2, lc2, ndim);
+    for(uint32_t i = 0; i < F.nNodes(); ++i)
+        nbad += F.exists(i) != Fp.exists(i) || (F.exists(i) && (F.getAxis(i) != Fp.getAxis(i) || F.getSplit(i) != Fp.getSplit(i)));
+    delete T1;
+    delete T2;
+
+    // range counts and point location
+    std::uniform_real_distribution<float> U(0, npts);
+    vector<float> qlo(size_t(nq)*ndim), qhi(size_t(nq)*ndim);
+    for(size_t j = 0; j < qlo.size(); ++j) {
+        qlo[j] = U(R);
+        qhi[j] = qlo[j] + 0.5*U(R);
+    }
+    vector<size_t> c(nq);
+    F.rangeCount(qlo.data(), qhi.data(), nq, c.data(), nthreads);
+    for(int j = 0; j < nq; ++j) {
+        size_t b = 0;
+        for(int i = 0; i < npts; ++i) {
+            bool in = true;
+            for(int a = 0; a < ndim; ++a) in &= qlo[j*ndim + a] <= ps[i][a] && ps[i][a] < qhi[j*ndim + a];
+            b += in;
+        }
+        nbad += b != c[j];
+    }
+
+    vector<uint32_t> lf(npts);
+    F.locate(x.data(), npts, lf.data(), nthreads);
+    vector<size_t> pos(npts);
+    for(int k = 0; k < npts; ++k) pos[F.order()[k]] = k;
+    for(int i = 0; i < npts; ++i) {
+        size_t i0, i1;
+        F.range(lf[i], i0, i1);
+        nbad += !(F.isLeaf(lf[i]) && i0 <= pos[i] && pos[i] < i1);
+    }
+
+    printf("%i %i-dimensional points, depth %i, %zu leaves: KDBuilder %.3g s; FlatKDTree %.3g s, %.3g s parallel\n", npts, ndim,
+           F.depth(), F.nLeaves(), std::chrono::duration<double>(t1 - t0).count(),
+           std::chrono::duration<double>(t2 - t1).count(), std::chrono::duration<double>(t3 - t2).count());
+    if(nbad) printf("*** ERROR: %i FlatKDTree mismatches!\n", nbad);
+}
@@ -0,0 +1,79 @@
+/// \file testFlatStringmap.cc Compare FlatStringmap against Stringmap parsing and lookups; parse timing
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "FlatStringmap.hh"
+#include <chrono>
+#include <stdexcept>
+
+/// throw on failed check
+static void check(bool ok, const char* what) { if(!ok) throw std::runtime_error(string("FlatStringmap check failed: ") + what); }
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// compare flat and multimap contents
+static void compare(const Stringmap& S, const FlatStringmap& F) {
+    check(S.size() == F.size(), "size");
+    for(auto& kv: S) {
+        check(F.count(kv.first) == S.count(kv.first), "count");
+        check(F.retrieve(kv.first) == S.retrieve(kv.first), "retrieve order");
+        check(F.getDefault(kv.first, "x") == S.getDefault(kv.first, "x"), "string value");
+        check(F.getDefault(kv.first, -1.) == S.getDefault(kv.first, -1.), "double value");
+        check(F.retrieveDouble(kv.first) == S.retrieveDouble(kv.first), "retrieveDouble");
+    }
+    check(F.getDefault("absent_key", 7.) == 7. && F.getDefault("absent_key", "d") == "d" && !F.count("absent_key"), "absent key");
+    check(F.toStringmap() == S, "round trip");
+}
+
+REGISTER_EXECLET(testFlatStringmap) {
+    const string s = " nm = 152.63.3\tE= 344.2785 \tjpi=2+\thl=-1\tCE_K = 0.0408@0.3:0.2\t=empty\tbad\tI=12.5\tI = 3\tx=\ta==b\tn=1=2";
+    Stringmap S(s);
+    FlatStringmap F(s), Z(s.data(), s.size(), true), M(S);
+    compare(S, F);
+    compare(S, Z);
+    compare(S, M);
+
+    StringSymbol kE("E");
+    check(F.getDefault(kE, 0.) == 344.2785, "symbol lookup");
+    F.insert("E", 1.5);
+    F.insert("A", "nope");
+    S.insert("E", 1.5);
+    S.insert("A", "nope");
+    compare(S, F);
+
+    // decay-library-like lines in one buffer
+    string buf;
+    const size_t nlines = 20000;
+    for(size_t i = 0; i < nlines; ++i)
+        buf += "nm = 152.63." + to_str(i) + "\tE = " + to_str(0.37*i) + "\tjpi = 2+\thl = " + to_str(1e-12*i) + "\tI = " + to_str(i % 97) + "\n";
+    vector<std::pair<size_t, size_t>> lines;
+    for(size_t p = 0; p < buf.size();) {
+        auto e = buf.find('\n', p);
+        lines.emplace_back(p, e - p);
+        p = e + 1;
+    }
+
+    double dt[3] = {1e9, 1e9, 1e9};
+    double sum[3] = {0, 0, 0};
+    for(int rep = 0; rep < 5; ++rep) {
+        for(int m = 0; m < 3; ++m) {
+            sum[m] = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for(auto& l: lines) {
+                if(m == 0) {
+                    Stringmap sm(buf.substr(l.first, l.second));
+                    sum[m] += sm.getDefault("E", 0) + sm.getDefault("hl", 0) + sm.getDefault("I", 0) + sm.getDefault("nm", "").size();
+                } else {
+                    FlatStringmap fm(buf.data() + l.first, l.second, m == 2);
+                    sum[m] += fm.getDefault("E", 0) + fm.getDefault("hl", 0) + fm.getDefault("I", 0) + fm.getDefault("nm", "").size();
+                }
+            }
+            dt[m] = std::min(dt[m], since(t0));
+        }
+    }
+    printf("Parse + 4 lookups per line: Stringmap %.0f ns, FlatStringmap %.0f ns, zero-copy %.0f ns (best of 5)\n",
+           1e9*dt[0]/nlines, 1e9*dt[1]/nlines, 1e9*dt[2]/nlines);
+    check(sum[0] == sum[1] && sum[0] == sum[2], "bulk values");
+    printf("%zu interned symbols\n", StringSymbols::size());
+}
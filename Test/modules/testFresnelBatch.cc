@@ -0,0 +1,79 @@
+/// \file testFresnelBatch.cc Validate batched and tabulated FresnelStack evaluation against per-angle calculation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "FresnelEqs.hh"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// maximum difference between batch results and per-angle set_cth0
+static double compare_scalar(FresnelStack& S, const vector<double>& c, const FresnelBatch& B) {
+    double d = 0;
+    for(size_t i = 0; i < c.size(); i++) {
+        S.set_cth0(c[i]);
+        for(auto x: {S.ct - B.ct[i], S.X_s.Rx - B.Rs[i], S.X_s.Tx - B.Ts[i], S.X_p.Rx - B.Rp[i], S.X_p.Tx - B.Tp[i]}) d = std::max(d, fabs(x));
+    }
+    return d;
+}
+
+REGISTER_EXECLET(testFresnelBatch) {
+    const size_t n = 100000;
+    vector<double> c(n);
+    for(size_t i = 0; i < n; i++) c[i] = (i + 0.5)/n;
+
+    // single interface
+    vector<double> Rs(n), Rp(n);
+    Fresnel_R_batch(c.data(), n, 1/1.5, Rs.data(), Rp.data());
+    double d = 0;
+    for(size_t i = 0; i < n; i++) d = std::max(d, std::max(fabs(Rs[i] - Fresnel_R_s(c[i], 1/1.5)), fabs(Rp[i] - Fresnel_R_p(c[i], 1/1.5))));
+    Fresnel_R_batch(c.data(), n, 1.5, Rs.data(), Rp.data());
+    if(!(d < 1e-14) || Rs[0] != 1 || Rp[0] != 1 || Rs[n-1] >= 1) throw std::runtime_error("Fresnel_R_batch mismatch");
+
+    // layered stacks, with TIR inside or at exit, and attenuating layer
+    for(auto rr: {vector<double>{1.5}, vector<double>{1/1.6, 1.2, 1.6/1.2}, vector<double>{1/1.5, 1.5*1.33, 1/1.33}}) {
+        FresnelStack S;
+        for(auto r: rr) S.emplace_back(r);
+        S.back().A0 = rr.size() > 1? 0.9 : 1; // (steep near-grazing attenuation amplifies rounding differences)
+
+        auto t0 = std::chrono::steady_clock::now();
+        for(auto x: c) S.set_cth0(x);
+        const double ts = since(t0);
+        FresnelBatch B, BT;
+        B.resize(n); // (excluding first-touch allocation from timing)
+        BT.resize(n);
+        t0 = std::chrono::steady_clock::now();
+        S.calc_batch(c.data(), n, B);
+        const double tb = since(t0);
+        const double db = compare_scalar(S, c, B);
+
+        // per-entry layer r matching stack
+        vector<vector<double>> rv;
+        vector<const double*> rp;
+        for(auto r: rr) rv.emplace_back(n, r);
+        for(auto& v: rv) rp.push_back(v.data());
+        FresnelBatch B2;
+        S.calc_batch(c.data(), rp.data(), n, B2);
+        if(B2.Rs != B.Rs || B2.Tp != B.Tp) throw std::runtime_error("FresnelStack per-entry r batch mismatch");
+
+        // tabulated, compared including near TIR edge
+        FresnelTable T(S);
+        t0 = std::chrono::steady_clock::now();
+        T.eval_batch(c.data(), n, BT);
+        const double tt = since(t0);
+        double dt = 0;
+        for(size_t i = 0; i < n; i++)
+            for(auto x: {B.Rs[i] - BT.Rs[i], B.Ts[i] - BT.Ts[i], B.Rp[i] - BT.Rp[i], B.Tp[i] - BT.Tp[i]}) dt = std::max(dt, fabs(x));
+        vector<double> ce;
+        for(int j = -100; j <= 100; j++) ce.push_back(std::min(std::max(T.ccrit + j*1e-9, 0.), 1.));
+        S.calc_batch(ce.data(), ce.size(), B);
+        for(size_t i = 0; i < ce.size(); i++) dt = std::max(dt, fabs(B.Rs[i] + B.Rp[i] - 2*T.R(ce[i])));
+
+        printf("%zu-layer stack (TIR at cos %.4f): per-angle %.1f ns, batch %.1f ns, table %.1f ns; batch err %.2g, table err %.2g\n",
+               rr.size(), T.ccrit, ts*1e9/n, tb*1e9/n, tt*1e9/n, db, dt);
+        if(!(db < 1e-9) || !(dt < 1e-4)) throw std::runtime_error("FresnelStack batch or table mismatch");
+    }
+}
@@ -0,0 +1,100 @@
+/// \file testGeomBatch.cc Validate and benchmark batched geometry kernels against scalar calls
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "GeomBatch.hh"
+#include "GeomCalcUtils.hh"
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+#include <vector>
+
+/// timing helper: best of several runs of f(m) repeated over cache-resident block of m points, in ns per point
+template<typename F>
+double time_ns(F f, size_t m = 2048, int reps = 200) {
+    double t = 1e9;
+    for(int k = 0; k < 5; ++k) {
+        auto t0 = std::chrono::steady_clock::now();
+        for(int r = 0; r < reps; ++r) {
+            f(m);
+            asm volatile("" ::: "memory"); // keep repetitions from being merged
+        }
+        t = std::min(t, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return t*1e9/(m*reps);
+}
+
+/// check maximum difference
+void checkdiff(const char* what, const vector<double>& a, const vector<double>& b, double tol) {
+    double dmax = 0;
+    for(size_t i = 0; i < a.size(); ++i) dmax = std::max(dmax, fabs(a[i] - b[i])/(1 + fabs(a[i])));
+    printf("\t%s max relative difference %g\n", what, dmax);
+    if(!(dmax < tol)) throw std::runtime_error("Batch geometry mismatch");
+}
+
+REGISTER_EXECLET(testGeomBatch) {
+    const size_t n = 1000000;
+    std::mt19937 R(12345);
+    std::uniform_real_distribution<double> U(-10, 10);
+
+    vector<double> x(n), y(n), z(n), dx(n), dy(n), dz(n);
+    for(size_t i = 0; i < n; ++i) {
+        x[i] = U(R); y[i] = U(R); z[i] = U(R);
+        geomvec_t d{U(R), U(R), U(R)};
+        makeunit(d);
+        dx[i] = d[0]; dy[i] = d[1]; dz[i] = d[2];
+    }
+    SoA3<> P{x.data(), y.data(), z.data()};
+    SoA3<> D{dx.data(), dy.data(), dz.data()};
+
+    vector<double> s0(n), s1(n), s2(n), b0(n), b1(n), b2(n);
+
+    // rotation
+    Quaternion<double> Q(0.3, -1.2, 0.7, 2.1);
+    auto f_s = [&](size_t m) {
+        for(size_t i = 0; i < m; ++i) {
+            auto v = Q.rotate({x[i], y[i], z[i]});
+            s0[i] = v[0]; s1[i] = v[1]; s2[i] = v[2];
+        }
+    };
+    auto f_b = [&](size_t m) { rotate_batch(Q, P, {b0.data(), b1.data(), b2.data()}, m); };
+    printf("rotate:\t\tscalar %.2f ns, batch %.2f ns per point\n", time_ns(f_s), time_ns(f_b));
+    f_s(n); f_b(n);
+    checkdiff("x", s0, b0, 1e-12);
+    checkdiff("z", s2, b2, 1e-12);
+
+    // projection onto line
+    const geomvec_t c{1, 2, 3}, b{4, -2, 5};
+    auto vn = vdiff(b, c);
+    const double L = sqrt(mag2(vn));
+    makeunit(vn);
+    auto g_s = [&](size_t m) { for(size_t i = 0; i < m; ++i) line_coords(c, vn, geomvec_t{x[i], y[i], z[i]}, s0[i], s1[i]); };
+    auto g_b = [&](size_t m) { line_coords_batch(c, vn, P, b0.data(), b1.data(), m); };
+    printf("project:\tscalar %.2f ns, batch %.2f ns per point\n", time_ns(g_s), time_ns(g_b));
+    g_s(n); g_b(n);
+    checkdiff("z", s0, b0, 1e-12);
+    checkdiff("r2", s1, b1, 1e-12);
+
+    // point-to-segment distance
+    auto h_s = [&](size_t m) { for(size_t i = 0; i < m; ++i) lineseg_coords(c, vn, geomvec_t{x[i], y[i], z[i]}, 0., L, s0[i], s1[i]); };
+    auto h_b = [&](size_t m) { segment_distance2_batch(c, b, P, b1.data(), m); };
+    printf("segment:\tscalar %.2f ns, batch %.2f ns per point\n", time_ns(h_s), time_ns(h_b));
+    h_s(n); h_b(n);
+    checkdiff("d2", s1, b1, 1e-10);
+
+    // closest approach of lines
+    const geomvec_t p1{0.5, -1, 2};
+    auto k_s = [&](size_t m) {
+        for(size_t i = 0; i < m; ++i) {
+            geomvec_t p2{x[i], y[i], z[i]}, d2{dx[i], dy[i], dz[i]};
+            closest_approach_points_normalized(p1, vn, p2, d2, s0[i], s1[i]);
+            s2[i] = line_points_distance2(p1, vn, p2, d2, s0[i], s1[i]);
+        }
+    };
+    auto k_b = [&](size_t m) { closest_approach_batch(p1, vn, P, D, b0.data(), b1.data(), b2.data(), m); };
+    printf("intersect:\tscalar %.2f ns, batch %.2f ns per point\n", time_ns(k_s), time_ns(k_b));
+    k_s(n); k_b(n);
+    checkdiff("c1", s0, b0, 1e-9);
+    checkdiff("d2", s2, b2, 1e-9);
+}
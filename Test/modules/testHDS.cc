@@ -3,6 +3,9 @@
 
 #include "ConfigFactory.hh"
 #include "HalfedgeDS.hh"
+#include "IndexedHalfedgeDS.hh"
+#include <chrono>
+#include <stdio.h>
 #include <stdlib.h>
 
 REGISTER_EXECLET(testHDS) {
@@ -17,4 +20,26 @@ REGISTER_EXECLET(testHDS) {
             H.split_corners(f);
 
     H.display(true);
+
+    // same subdivision in index-based storage
+    IndexedHalfedgeDS IH(3);
+    IH.split_all_edges();
+    const size_t nf0 = IH.nFaces();
+    for(IndexedHalfedgeDS::idx_t f = 0; f < nf0; ++f)
+        if(f != IH.f_outer)
+            IH.split_corners(f);
+    IH.validate();
+    IH.display(true);
+
+    // icosahedron refinement
+    auto t0 = std::chrono::steady_clock::now();
+    auto Ico = IndexedHalfedgeDS::fromPolygons(12, {{0,11,5}, {0,5,1}, {0,1,7}, {0,7,10}, {0,10,11}, {1,5,9}, {5,11,4}, {11,10,2}, {10,7,6}, {7,1,8},
+                                                    {3,9,4}, {3,4,2}, {3,2,6}, {3,6,8}, {3,8,9}, {4,9,5}, {2,4,11}, {6,2,10}, {8,6,7}, {9,8,1}});
+    for(int l = 0; l < 7; ++l) Ico.refine_triangles();
+    auto t1 = std::chrono::steady_clock::now();
+    Ico.validate();
+    Ico.display();
+    printf("refined in %g s\n", std::chrono::duration<double>(t1 - t0).count());
+    if(Ico.nFaces() != 20*(1 << 14) || Ico.nVertices() + Ico.nFaces() != Ico.nHalfedges()/2 + 2)
+        printf("*** ERROR: bad icosahedron refinement!\n");
 }
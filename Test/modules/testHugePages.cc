@@ -0,0 +1,83 @@
+/// \file testHugePages.cc Huge-page backed buffers: policy configuration, mapping, and random-access timing
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "HugePages.hh"
+#include "LocklessCircleBuffer.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/// throw on failed check
+static void check(bool ok, const char* what) { if(!ok) throw std::runtime_error(string("HugePages check failed: ") + what); }
+
+/// process anonymous huge pages [kB]
+static long anonHugeKB() {
+    auto f = fopen("/proc/self/smaps_rollup", "r");
+    if(!f) return -1;
+    char line[256];
+    long kb = 0;
+    while(fgets(line, sizeof(line), f)) if(!strncmp(line, "AnonHugePages:", 14)) kb = atol(line + 14);
+    fclose(f);
+    return kb;
+}
+
+/// random-access pointer chase time [ns/access] over buffer
+template<class V>
+double chase(V& v, size_t nsteps) {
+    const size_t n = v.size();
+    for(size_t i = 0; i < n; ++i) v[i] = (i*2654435761ULL + 12345) % n;
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t j = 0;
+    for(size_t k = 0; k < nsteps; ++k) j = v[j];
+    const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if(j == n) printf("impossible\n");
+    return 1e9*dt/nsteps;
+}
+
+REGISTER_EXECLET(testHugePages) {
+    // configuration parsing: global plus per-component
+    HugePagePolicy::configure("none,testHP=thp:local,testHP2=hugetlb:0");
+    check(HugePagePolicy::global().mode == HugePagePolicy::HP_NONE, "global mode");
+    auto P = HugePagePolicy::get("testHP");
+    check(P.mode == HugePagePolicy::HP_TRANSPARENT && P.numa_node == HugePagePolicy::NUMA_LOCAL, "component policy");
+    check(HugePagePolicy::get("testHP2").mode == HugePagePolicy::HP_EXPLICIT, "explicit component policy");
+    check(HugePagePolicy::get("unset").mode == HugePagePolicy::HP_NONE, "unset component follows global");
+
+    // small allocations and unconfigured components from heap
+    {
+        hugepage_vector<double> v(1000, 0., HugePageAllocator<double>("testHP"));
+        hugepage_vector<double> w(1 << 20, 0., HugePageAllocator<double>("unset"));
+        check(HugePagePolicy::mappedBytes() == 0, "heap allocations");
+    }
+
+    const size_t n = size_t(1) << 25; // 256 MB of uint64_t
+    const size_t nsteps = 20000000;
+    double t_heap;
+    {
+        vector<uint64_t> v(n);
+        t_heap = chase(v, nsteps);
+    }
+
+    const long hp0 = anonHugeKB();
+    for(const char* c: {"testHP", "testHP2"}) {
+        hugepage_vector<uint64_t> v(n, 0, HugePageAllocator<uint64_t>(c));
+        check(HugePagePolicy::mappedBytes() >= n*sizeof(uint64_t), "mapped allocation");
+        check(!(reinterpret_cast<uintptr_t>(v.data()) & ((1 << 21) - 1)), "2 MB alignment");
+        const double t = chase(v, nsteps);
+        printf("%s policy: random access %.1f ns (heap %.1f ns); anonymous huge pages %ld MB\n", c, t, t_heap, (anonHugeKB() - hp0) >> 10);
+    }
+    check(HugePagePolicy::mappedBytes() == 0, "mapped release");
+
+    // component applied to lock-free rings
+    HugePagePolicy::set("SPSCRing", HugePagePolicy::parse("thp"));
+    {
+        SPSCRing<uint64_t> R(1 << 20);
+        check(HugePagePolicy::mappedBytes() == (1 << 23), "SPSCRing mapped");
+        check(R.try_push(1) && R.n_buffered() == 1, "SPSCRing use");
+    }
+    HugePagePolicy::set("SPSCRing", HugePagePolicy());
+    check(HugePagePolicy::mappedBytes() == 0, "SPSCRing release");
+}
@@ -0,0 +1,92 @@
+/// \file testIntervalSet.cc Compare FlatIntervalSet against set-based IntervalSet, and time merging
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "IntervalSet.hh"
+#include <chrono>
+#include <cmath>
+#include <stdlib.h>
+
+/// check flat and set-based intervals match
+template<typename S>
+int compareIntervals(const FlatIntervalSet<>& F, const S& I) {
+    int nbad = F.size() != I.size();
+    auto it = I.begin();
+    for(auto& i: F) {
+        if(it == I.end()) return nbad + 1;
+        if(i.first != it->first || i.second != it->second) ++nbad;
+        ++it;
+    }
+    return nbad;
+}
+
+/// elapsed ns since t0
+double ns_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+}
+
+REGISTER_EXECLET(testIntervalSet) {
+    int n = 1000000;
+    Cfg.lookupValue("n", n);
+    srand(4321);
+
+    // random dead-time intervals, mostly time-ordered with occasional late arrivals
+    vector<Interval<>> v(n);
+    double t = 0;
+    for(auto& i: v) {
+        t += 10.*rand()/RAND_MAX;
+        double t0 = rand() % 16? t : t - 200.*rand()/RAND_MAX;
+        i = {t0, t0 + 5.*rand()/RAND_MAX};
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    IntervalSet<> I;
+    for(auto& i: v) I += i;
+    double dtI = ns_since(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    FlatIntervalSet<> F;
+    for(auto& i: v) F += i;
+    double dtF = ns_since(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    FlatIntervalSet<> B;
+    B.add(v);
+    double dtB = ns_since(t0);
+
+    printf("%i intervals -> %zu disjoint, total %g\n", n, F.size(), F.total());
+    printf("set-based %.1f ns, flat %.1f ns, bulk %.1f ns per interval\n", dtI/n, dtF/n, dtB/n);
+    if(compareIntervals(F, I) || compareIntervals(B, I)) printf("*** ERROR: flat intervals differ from set-based!\n");
+
+    // per-thread sets, combined
+    const size_t nth = 8;
+    vector<FlatIntervalSet<>> vF(nth);
+    vector<IntervalSet<>> vI(nth);
+    for(size_t j = 0; j < v.size(); ++j) {
+        vF[j % nth] += v[j];
+        vI[j % nth] += v[j];
+    }
+    IntervalSet<> IU = vI[0];
+    t0 = std::chrono::steady_clock::now();
+    for(size_t j = 1; j < nth; ++j) IU += vI[j];
+    double dtIU = ns_since(t0);
+    t0 = std::chrono::steady_clock::now();
+    auto FU = parallel_union(vF);
+    double dtFU = ns_since(t0);
+    printf("union of %zu sets: set-based %.2f ms, parallel flat %.2f ms\n", nth, 1e-6*dtIU, 1e-6*dtFU);
+    if(compareIntervals(FU, I) || FU.nIndividual != size_t(n)) printf("*** ERROR: incorrect parallel union!\n");
+
+    // intersection with periodic live windows
+    IntervalSet<> W;
+    FlatIntervalSet<> FW;
+    for(double w = 0; w < t; w += 100) { W += {w, w + 50}; FW += {w, w + 50}; }
+    I &= W;
+    F &= FW;
+    if(fabs(F.total() - I.total()) > 1e-6*I.total()) printf("*** ERROR: intersection total %g differs from %g!\n", F.total(), I.total());
+
+    // summarization of old intervals
+    FlatIntervalSet<> FS;
+    FS.dtMax = 1000;
+    for(auto& i: v) FS += i;
+    if(FS.n() < FS.size() || fabs(FS.total() - FU.total()) > 1e-6*FU.total()) printf("*** ERROR: inconsistent summarized total!\n");
+}
@@ -0,0 +1,52 @@
+/// \file testJobQueue.cc Compare JobQueue controller-thread and direct-dispatch throughput
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "JobQueue.hh"
+#include <chrono>
+
+/// minimal job: count completions
+class CountingJob: public JobQueue::Job {
+public:
+    /// Constructor
+    CountingJob(std::atomic<size_t>& c, int n): Job(n), counter(c) { }
+    /// run job
+    void run() override { ++counter; }
+    std::atomic<size_t>& counter;   ///< completions counter
+};
+
+/// time nJobs small jobs on nThreads workers, spread over nQueues queues; return jobs/s
+double timeJobQueue(bool direct, size_t nThreads, size_t nQueues, size_t nJobs) {
+    std::atomic<size_t> counter{0};
+    vector<CountingJob> jobs;
+    jobs.reserve(nJobs);
+    for(size_t i = 0; i < nJobs; ++i) jobs.emplace_back(counter, i % nQueues);
+
+    JobQueue JQ(direct);
+    for(size_t q = 0; q < nQueues; ++q) JQ.setQueue(q, nThreads, 1024);
+    JQ.launch(nThreads);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(auto& j: jobs) JQ.add(&j);
+    JQ.flush();
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    JQ.shutdown();
+
+    if(counter != nJobs) printf("*** ERROR: %zu/%zu jobs completed!\n", counter.load(), nJobs);
+    return nJobs/dt;
+}
+
+REGISTER_EXECLET(testJobQueue) {
+    int nJobs = 100000;
+    Cfg.lookupValue("nJobs", nJobs);
+    int nThreads = 4;
+    Cfg.lookupValue("nThreads", nThreads);
+
+    printf("JobQueue throughput (jobs/s) for %i jobs on %i workers:\n", nJobs, nThreads);
+    printf("queues\tcontroller\tdirect\n");
+    for(size_t nQ: {1, 4}) {
+        auto tc = timeJobQueue(false, nThreads, nQ, nJobs);
+        auto td = timeJobQueue(true, nThreads, nQ, nJobs);
+        printf("%zu\t%.3g\t\t%.3g\n", nQ, tc, td);
+    }
+}
@@ -0,0 +1,188 @@
+/// \file testJobRedispatch.cc Straggler re-dispatch (ThreadsJobControl, DiskIOJobControl) and job results cache (DiskIOJobControl, including guided chunks)
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ThreadsJobControl.hh"
+#include "DiskIOJobControl.hh"
+#include "PathUtils.hh"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// throw on failed check
+static void check(bool ok, const char* what) { if(!ok) throw std::runtime_error(string("Job re-dispatch check failed: ") + what); }
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+static std::atomic<size_t> nStallRuns{0};   ///< number of StallJob runs
+static std::atomic<int> nStalls{0};         ///< remaining stalls of StallJob for N0 = stallN0
+static size_t stallN0 = 0;                  ///< job to stall
+static const int stall_ms = 800;            ///< stall time [ms]
+
+/// worker returning [N0, N1) and sum of payload; stalls once on job containing stallN0 while nStalls > 0
+class StallJob: public JobWorker {
+public:
+    /// run job
+    void run(const JobSpec& J, BinaryIO& B) override {
+        ++nStallRuns;
+        vector<double> v;
+        B.receive(v);
+        if(J.N0 <= stallN0 && stallN0 < J.N1 && nStalls-- > 0) std::this_thread::sleep_for(std::chrono::milliseconds(stall_ms));
+        double s = 0;
+        for(auto x: v) s += x;
+        MultiJobWorker::JW->signalDone();
+        B.send<uint64_t>(J.N0);
+        B.send<uint64_t>(J.N1);
+        B.send(s);
+    }
+};
+
+REGISTER_FACTORYOBJECT(StallJob, JobWorker)
+
+/// controller side of StallJob
+class StallComm: public JobComm {
+public:
+    /// send payload
+    void startJob(BinaryIO& B) override { B.send(v); }
+    /// receive result
+    void endJob(BinaryIO& B) override {
+        auto i0 = B.receive<uint64_t>();
+        auto i1 = B.receive<uint64_t>();
+        auto s = B.receive<double>();
+        for(auto i = i0; i < i1; ++i) f.at(i) = s*i;
+        nGot += i1 - i0;
+    }
+    /// repeatable jobs
+    bool speculative() const override { return true; }
+    /// receive and drop duplicate result
+    void discardJob(BinaryIO& B) override {
+        B.receive<uint64_t>();
+        B.receive<uint64_t>();
+        B.receive<double>();
+        ++nDropped;
+    }
+
+    /// check all results received once, and correct
+    void checkResults() const {
+        double s = 0;
+        for(auto x: v) s += x;
+        check(nGot == f.size(), "one result per job");
+        for(size_t i = 0; i < f.size(); ++i) check(f[i] == s*i, "job result");
+    }
+
+    vector<double> v;       ///< payload
+    vector<double> f;       ///< results by job
+    size_t nGot = 0;        ///< number of job items received
+    size_t nDropped = 0;    ///< number of duplicate results dropped
+};
+
+/// submit njobs StallJob's, stalling first run of one; return seconds to complete
+static double runStalled(MultiJobControl& JC, StallComm& C, size_t njobs, bool stall) {
+    C.f.assign(njobs, -1);
+    C.nGot = 0;
+    stallN0 = njobs/2;
+    nStalls = stall;
+    JobSpec JS;
+    JS.wclass = FactoriesIndex::hash("StallJob");
+    JS.C = &C;
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < njobs; ++i) {
+        JS.N0 = i;
+        JS.N1 = i + 1;
+        JC.submitJob(JS);
+    }
+    JC.waitComplete();
+    return since(t0);
+}
+
+/// DiskIOJobControl run of StallJob's through worker threads (guided chunks of at least minChunk, if nonzero); return seconds to complete
+static double runDisk(const string& d, const string& cache, StallComm& C, size_t njobs, bool stall, double timeout, size_t& nhits, size_t minChunk = 0) {
+    DiskIOJobControl JC(d, 2);
+    JC.cacheDir = cache;
+    JC.stragglerTimeout = timeout;
+    vector<std::thread> vt;
+    for(int k = 1; k <= 2; ++k) vt.emplace_back([&d, k] {
+        DiskIOJobWorker W(d, k);
+        MultiJobWorker::JW = &W;
+        W.runWorkerJobs();
+    });
+
+    double dt = 0;
+    if(minChunk) {
+        C.f.assign(njobs, -1);
+        C.nGot = 0;
+        nStalls = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        JC.submitGuided(C, njobs, FactoriesIndex::hash("StallJob"), 0, minChunk);
+        JC.waitComplete();
+        dt = since(t0);
+    } else dt = runStalled(JC, C, njobs, stall);
+    JC.stopWorkers();
+    for(auto& t: vt) t.join();
+    C.checkResults();
+    check(!timeout || !stall || (JC.nRedispatched && JC.nDiscarded == JC.nRedispatched), "disk jobs re-dispatch");
+    nhits = JC.nCacheHits;
+    printf("DiskIO %s%s: %.3f s; %zu re-dispatched, %zu cache hits, %zu stored\n", minChunk? "guided, " : "", stall? "with stall" : "unstalled", dt, JC.nRedispatched, JC.nCacheHits, JC.nCacheStores);
+    return dt;
+}
+
+REGISTER_EXECLET(testJobRedispatch) {
+    const size_t njobs = 12;
+    StallComm C;
+    C.v = {1, 2, 3, 4.5};
+
+    {
+        ThreadsJobControl JC(3);
+        runStalled(JC, C, njobs, false); // measure throughput
+        auto t0 = runStalled(JC, C, njobs, true);
+        C.checkResults();
+        check(!JC.nRedispatched, "no duplicates when disabled");
+
+        JC.stragglerTimeout = 0.05;
+        auto t1 = runStalled(JC, C, njobs, true);
+        C.checkResults();
+        check(JC.nRedispatched >= 1, "straggler duplicated");
+        check(t1 < 0.5*t0, "straggler tail latency");
+        JC.waitSuperseded();
+        check(C.nDropped == JC.nRedispatched && JC.nDiscarded == JC.nRedispatched, "superseded results discarded");
+
+        // duplication by throughput-expected time
+        JC.stragglerTimeout = 0;
+        JC.stragglerFactor = 20;
+        auto t2 = runStalled(JC, C, njobs, true);
+        C.checkResults();
+        JC.waitSuperseded();
+        check(t2 < 0.5*t0, "throughput-based straggler");
+        printf("Threads: stalled job %.3f s; timeout re-dispatch %.3f s; throughput re-dispatch %.3f s; %zu duplicates\n", t0, t1, t2, JC.nRedispatched);
+    }
+
+    char dtemplate[] = "/tmp/testJobRedispatch_XXXXXX";
+    if(!mkdtemp(dtemplate)) throw std::runtime_error("Unable to create scratch directory");
+    string d = dtemplate;
+    string cache = d + "/cache";
+
+    size_t nhits = 0;
+    nStallRuns = 0;
+    runDisk(d, cache, C, njobs, true, 0.05, nhits);
+    check(!nhits && nStallRuns > njobs, "first run computed, with duplicate");
+    nStallRuns = 0;
+    runDisk(d, cache, C, njobs, false, 0, nhits);
+    check(nhits == njobs && !nStallRuns, "re-run from cache");
+    C.v.push_back(1);
+    runDisk(d, cache, C, njobs, false, 0, nhits);
+    check(!nhits && nStallRuns == njobs, "changed inputs re-run");
+
+    // guided chunks: single fixed-size chunk (minChunk = njobs) is independent of throughput, so repeats
+    nStallRuns = 0;
+    runDisk(d, cache, C, njobs, false, 0, nhits, njobs);
+    check(!nhits && nStallRuns == 1, "guided chunk computed");
+    runDisk(d, cache, C, njobs, false, 0, nhits, njobs);
+    check(nhits == 1 && nStallRuns == 1, "guided chunk from cache");
+
+    for(auto& f: listdir(cache, true, true)) unlink(f.c_str());
+    rmdir(cache.c_str());
+    if(rmdir(d.c_str())) printf("*** ERROR: exchange files left in '%s'!\n", d.c_str());
+}
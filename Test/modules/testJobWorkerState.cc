@@ -0,0 +1,66 @@
+/// \file testJobWorkerState.cc JobWorker LRU state cache with memory budget and write-behind
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "MultiJobControl.hh"
+#include <chrono>
+#include <stdio.h>
+
+/// JobWorker exposing state cache size
+class StateTestWorker: public JobWorker {
+public:
+    /// number of resident entries
+    size_t nResident() const { return stateData.size(); }
+    /// resident bytes
+    size_t residentBytes() const { return stateBytes; }
+};
+
+REGISTER_EXECLET(testJobWorkerState) {
+    int nstates = 100;
+    int nvals = 100000;
+    string dir = "/tmp/testJobWorkerState";
+    Cfg.lookupValue("nstates", nstates);
+    Cfg.lookupValue("nvals", nvals);
+    Cfg.lookupValue("dir", dir);
+
+    auto budget0 = JobWorker::stateBudget;
+    auto dir0 = JobWorker::stateDir;
+    JobWorker::stateBudget = size_t(nvals) * sizeof(double) * 10; // about 10 entries
+    JobWorker::stateDir = dir;
+
+    bool ok = true;
+    {
+        StateTestWorker W;
+        vector<double> v(nvals);
+        auto t0 = std::chrono::steady_clock::now();
+        for(int i = 0; i < nstates; ++i) {
+            v[0] = i;
+            W.pushState("s" + std::to_string(i), v);
+        }
+        W.waitWrites();
+        auto t1 = std::chrono::steady_clock::now();
+        ok = ok && W.residentBytes() <= JobWorker::stateBudget && W.nResident() < size_t(nstates) && W.nResident() > 1;
+
+        // re-read everything (mostly from disk), then hot entry repeatedly
+        for(int i = 0; i < nstates; ++i) {
+            W.getState("s" + std::to_string(i), v);
+            ok = ok && v[0] == i;
+        }
+        for(int i = 0; i < 100; ++i) W.getState("s0", v);
+        ok = ok && v[0] == 0;
+        auto t2 = std::chrono::steady_clock::now();
+
+        printf("push + write-behind: %.2f ms/entry; reload: %.2f ms/entry\n",
+               1e3*std::chrono::duration<double>(t1 - t0).count()/nstates,
+               1e3*std::chrono::duration<double>(t2 - t1).count()/nstates);
+        W.displayStateStats();
+        ok = ok && W.nHits >= 99 && W.nLoads >= size_t(nstates) - W.nResident();
+
+        for(int i = 0; i < nstates; ++i) W.clearState("s" + std::to_string(i));
+        ok = ok && !W.checkState("s0");
+    }
+
+    JobWorker::stateBudget = budget0;
+    JobWorker::stateDir = dir0;
+    if(!ok) printf("*** ERROR: unexpected state cache behavior!\n");
+}
@@ -2,6 +2,7 @@
 
 #include "ConfigFactory.hh"
 #include "LaplacianSums.hh"
+#include <cmath>
 #include <stdio.h>
 #include <TStopwatch.h>
 
@@ -24,7 +25,38 @@ void test_lapsum(double a, double b, double c) {
     printf(" vs %g in %g ns\n", s, 1e9*sw.CpuTime()/ntest);
 }
 
+void test_lapsum_batch(double c0, double c1, double maxerr) {
+    const size_t n = 1000000;
+    vector<double> c(n), s0(n), s1(n), s2(n);
+    for(size_t i = 0; i < n; ++i) c[i] = c0*pow(c1/c0, (i*0.618034) - floor(i*0.618034));
+
+    TStopwatch sw;
+    sw.Start();
+    for(size_t i = 0; i < n; ++i) s0[i] = sum_laplacian(c[i]);
+    printf("sum_laplacian %g ns", 1e9*sw.CpuTime()/n);
+
+    sw.Start();
+    sum_laplacian(c.data(), s1.data(), n);
+    printf(", batched %g ns", 1e9*sw.CpuTime()/n);
+
+    sw.Start();
+    LaplacianSumTable T(c0, c1, maxerr);
+    printf(", table (%zu knots in %g ms)", T.size(), 1e3*sw.CpuTime());
+    sw.Start();
+    T(c.data(), s2.data(), n);
+    printf(" %g ns\n", 1e9*sw.CpuTime()/n);
+
+    double e1 = 0, e2 = 0;
+    for(size_t i = 0; i < n; ++i) {
+        e1 = std::max(e1, fabs(s1[i] - s0[i])/s0[i]);
+        e2 = std::max(e2, fabs(s2[i] - s0[i]));
+    }
+    printf("\tbatched relative deviation %g, table error %g (bound %g)\n", e1, e2, T.errorBound());
+    if(e2 > maxerr) printf("*** ERROR: LaplacianSumTable exceeds error bound!\n");
+}
+
 REGISTER_EXECLET(testLapsum) {
     test_lapsum(3,.3,2);
     test_lapsum(3,12,2);
+    test_lapsum_batch(1e-3, 1e3, 1e-10);
 }
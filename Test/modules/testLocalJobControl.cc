@@ -0,0 +1,99 @@
+/// \file testLocalJobControl.cc LocalJobControl job round-trip throughput, DequeBIO versus RingBIO channel; guided job splitting
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "MultiJobControl.hh"
+#include <chrono>
+#include <stdio.h>
+
+/// total job items and jobs run by EchoJob
+static size_t nEchoItems = 0, nEchoJobs = 0;
+
+/// worker returning received payload
+class EchoJob: public JobWorker {
+public:
+    /// run job
+    void run(const JobSpec& J, BinaryIO& B) override {
+        nEchoItems += J.N1 - J.N0;
+        ++nEchoJobs;
+        B.receive(v);
+        MultiJobWorker::JW->signalDone();
+        B.send(v);
+    }
+protected:
+    vector<double> v;   ///< payload
+};
+
+REGISTER_FACTORYOBJECT(EchoJob, JobWorker)
+
+/// controller side of EchoJob
+class EchoComm: public JobComm {
+public:
+    /// send payload
+    void startJob(BinaryIO& B) override { B.send(v); }
+    /// receive echoed payload
+    void endJob(BinaryIO& B) override { B.receive(v2); }
+
+    vector<double> v;   ///< payload
+    vector<double> v2;  ///< returned payload
+};
+
+/// LocalJobControl over selectable buffer channel
+template<class BIO>
+class TestLocalJC: public BIO, public MultiJobControl, public MultiJobWorker {
+protected:
+    /// Run job to completion.
+    void dispatchJob(JobSpec& JS) override {
+        if(JS.C) JS.C->startJob(*this);
+        runJob(JS);
+        if(JS.C) JS.C->endJob(*this);
+    }
+    /// Check if a job is running or completed
+    bool _isRunning(int) override { return false; }
+    /// Allocate an available thread, blocking if necessary
+    int _allocWorker() override { return 0; }
+};
+
+/// jobs per second through channel
+template<class BIO>
+double jobRate(EchoComm& C, int njobs) {
+    TestLocalJC<BIO> JC;
+    auto JW0 = MultiJobWorker::JW;
+    MultiJobWorker::JW = &JC;
+    JobSpec JS;
+    JS.wclass = FactoriesIndex::hash("EchoJob");
+    JS.C = &C;
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < njobs; ++i) JC.submitJob(JS);
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    MultiJobWorker::JW = JW0;
+    if(C.v2 != C.v) printf("*** ERROR: payload mismatch!\n");
+    return njobs/dt;
+}
+
+REGISTER_EXECLET(testLocalJobControl) {
+    int njobs = 10000;
+    Cfg.lookupValue("njobs", njobs);
+
+    for(int n: {10, 1000, 100000}) {
+        EchoComm C;
+        C.v.resize(n);
+        for(int i = 0; i < n; ++i) C.v[i] = i;
+        auto nj = std::max(njobs/(1 + n/1000), 10);
+        printf("%i-double payload: DequeBIO %.0f jobs/s; RingBIO %.0f jobs/s\n", n,
+               jobRate<DequeBIO>(C, nj), jobRate<RingBIO>(C, nj));
+    }
+
+    // guided scheduling covers full range in shrinking chunks
+    TestLocalJC<RingBIO> JC;
+    auto JW0 = MultiJobWorker::JW;
+    MultiJobWorker::JW = &JC;
+    EchoComm C;
+    C.v.resize(10);
+    nEchoItems = nEchoJobs = 0;
+    size_t nItms = 1000000;
+    JC.submitGuided(C, nItms, FactoriesIndex::hash("EchoJob"), 0, 100);
+    MultiJobWorker::JW = JW0;
+    printf("Guided scheduling: %zu items in %zu jobs\n", nEchoItems, nEchoJobs);
+    if(nEchoItems != nItms) printf("*** ERROR: expected %zu items!\n", nItms);
+}
@@ -3,11 +3,9 @@
 #include "ConfigFactory.hh"
 #include "MCTAL_File.hh"
 #include "GlobalArgs.hh"
-#include <fstream>
 #include <stdio.h>
 
 REGISTER_EXECLET(testMCTAL) {
-    std::ifstream i(requiredGlobalArg("f", "MCTAL file"));
-    MCTAL_File MF(i);
+    MCTAL_File MF(requiredGlobalArg("f", "MCTAL file"));
     MF.display();
 }
@@ -0,0 +1,69 @@
+/// \file testMCTALIndex.cc Validate indexed on-demand MCTAL tally parsing against full-file parser
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "MCTAL_File.hh"
+#include "MCTAL_Index.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+REGISTER_EXECLET(testMCTALIndex) {
+    // synthetic MCTAL file: many cell-by-energy tallies
+    const string fname = "/tmp/testMCTALIndex.m";
+    auto f = fopen(fname.c_str(), "w");
+    if(!f) throw std::runtime_error("Failed to write " + fname);
+    const int ntal = 400, nf = 4, ne = 200;
+    fprintf(f, "mcnp6     6.2     01/01/21 00:00:00     1           1000000         123456789\n");
+    fprintf(f, " synthetic test problem\n");
+    fprintf(f, "ntal %5i\n", ntal);
+    for(int t = 0; t < ntal; t++) fprintf(f, "%5i%s", 10*t + 4, t % 16 == 15 || t + 1 == ntal? "\n" : "");
+    for(int t = 0; t < ntal; t++) {
+        fprintf(f, "tally %5i    1    0\nf %7i\n", 10*t + 4, nf);
+        for(int i = 0; i < nf; i++) fprintf(f, "%8i", 100 + i);
+        fprintf(f, "\nd          1\nu          0\ns          0\nm          0\nc          0\net %6i\n", ne + 1);
+        for(int i = 0; i < ne; i++) fprintf(f, " %12.5E%s", 0.01*(i+1), i % 6 == 5 || i + 1 == ne? "\n" : "");
+        fprintf(f, "t          0\nvals\n");
+        const int nv = nf*(ne + 1);
+        for(int i = 0; i < nv; i++) fprintf(f, " %11.5E %6.4f%s", 1e-3*(t + 1)*(i + 1), 0.01 + 1e-5*i, i % 4 == 3 || i + 1 == nv? "\n" : "");
+        fprintf(f, "tfc    1   1   1   1   1   1   1   1 %3i\n       1000000  %11.5E  %6.4f  %11.5E\n", ne + 1, 1.*t, 0.01, 1e4);
+    }
+    fclose(f);
+
+    auto t0 = std::chrono::steady_clock::now();
+    MCTAL_File MF(fname);
+    const double tf = since(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    MCTAL_Index MI(fname);
+    const double ti = since(t0);
+    if(int(MI.size()) != ntal || MI.tallyNum(17) != 174 || MI.find(174) != 17) throw std::runtime_error("Wrong MCTAL index");
+
+    t0 = std::chrono::steady_clock::now();
+    auto& t1 = MI.tally(1234);
+    const double t1t = since(t0);
+    if(MI.isLoaded(0) || !MI.isLoaded(123)) throw std::runtime_error("Unexpected tally loading");
+
+    // parallel parse of remainder, and comparison to full parse
+    vector<size_t> ii;
+    for(size_t i = 0; i < MI.size(); i++) ii.push_back(i);
+    t0 = std::chrono::steady_clock::now();
+    MI.load(ii, 4);
+    const double tp = since(t0);
+    for(size_t i = 0; i < MI.size(); i++) {
+        auto& a = MF.at(i);
+        auto& b = MI.at(i);
+        if(a.size() != b.size() || a.probnum != b.probnum || a.axes != b.axes || a.Ebins != b.Ebins || a.tfc.size() != b.tfc.size())
+            throw std::runtime_error("Indexed MCTAL tally mismatch");
+        for(size_t j = 0; j < a.size(); j++)
+            if(a[j].val != b[j].val || a[j].rel_err != b[j].rel_err) throw std::runtime_error("Indexed MCTAL tally value mismatch");
+    }
+    if(&t1 != &MI.at(123) || t1(200, 3).val != 1e-3*124*804) throw std::runtime_error("Indexed MCTAL tally lookup mismatch");
+
+    printf("MCTAL %i tallies: full parse %.1f ms; index %.2f ms, one tally %.3f ms, all tallies (4 threads) %.1f ms\n",
+           ntal, tf*1e3, ti*1e3, t1t*1e3, tp*1e3);
+    remove(fname.c_str());
+}
@@ -149,7 +149,47 @@ void mtest(bool xact = false, bool do_crude = false, size_t nTrial = 5000) {
 
 }
 
+/// check unrolled fixed-size products against explicit loops
+template<typename T, size_t N, size_t K>
+void ptest() {
+    Matrix<N,K,T> A;
+    Matrix<K,N,T> B;
+    Vec<K,T> v;
+    Vec<N,T> u;
+    for(auto& c: A) c = randval<T>();
+    for(auto& c: B) c = randval<T>();
+    for(auto& c: v) c = randval<T>();
+    for(auto& c: u) c = randval<T>();
+
+    auto AB = A*B;
+    auto Av = A*v;
+    auto uA = u*A;
+    auto At = A.transposed();
+    for(size_t i=0; i<N; i++) {
+        T s = T();
+        for(size_t k=0; k<K; k++) s += A(i,k)*v[k];
+        if(!(Av[i] == s)) throw std::runtime_error("Matrix*Vec mismatch");
+        for(size_t j=0; j<N; j++) {
+            T t = T();
+            for(size_t k=0; k<K; k++) t += A(i,k)*B(k,j);
+            if(!(AB(i,j) == t)) throw std::runtime_error("Matrix*Matrix mismatch");
+        }
+        for(size_t k=0; k<K; k++) if(!(At(k,i) == A(i,k) && A.row(i)[k] == A(i,k))) throw std::runtime_error("Matrix row/transpose mismatch");
+    }
+    for(size_t k=0; k<K; k++) {
+        T s = T();
+        for(size_t i=0; i<N; i++) s += u[i]*A(i,k);
+        if(!(uA[k] == s)) throw std::runtime_error("Vec*Matrix mismatch");
+    }
+    if(!((-A + A*T(2) - A) == Matrix<N,K,T>())) throw std::runtime_error("Matrix arithmetic mismatch");
+    if(!((v*T(3) + v - v/T(2)*T(8)) == Vec<K,T>())) throw std::runtime_error("Vec arithmetic mismatch");
+    printf("Fixed-size %zu x %zu products OK\n", N, K);
+}
+
 REGISTER_EXECLET(testMatrix) {
+    ptest<double, 3, 3>();
+    ptest<double, 4, 2>();
+    ptest<Rational, 5, 7>();
     mtest<float,  11>(false, false, 100000);
     mtest<double, 11>(false, false, 100000);
     mtest<Rational, 6>(true);
@@ -0,0 +1,108 @@
+/// \file testMemTag.cc Check tagged memory accounting counters, allocator, framework hooks, and XML report
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "MemTag.hh"
+#include "MemoryBudget.hh"
+#include "OrderingQueue.hh"
+#include "AllocPool.hh"
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <thread>
+
+/// ordered test item
+struct MemTagItem {
+    /// ordering type
+    typedef double ordering_t;
+    /// ordering parameter
+    explicit operator ordering_t() const { return t; }
+    double t;       ///< time
+    double x[7];    ///< some data
+    /// pool re-use reset
+    void clear() { t = 0; }
+};
+
+/// count received items
+class MemTagCounter: public DataSink<const MemTagItem> {
+public:
+    /// receive item
+    void push(const MemTagItem&) override { ++n; }
+    size_t n = 0;   ///< number received
+};
+
+/// throw on failed check
+static void check(bool ok, const char* what) { if(!ok) throw std::runtime_error(string("MemTag check failed: ") + what); }
+
+REGISTER_EXECLET(testMemTag) {
+    // registry and high-water mark
+    auto& A = MemTag::get("testMemTag::A");
+    check(&MemTag::get("testMemTag::A") == &A, "tag registry");
+    A.add(1000);
+    A.add(-600);
+    check(A.current() == 400 && A.peak() == 1000, "current and peak");
+    A.resetPeak();
+    check(A.peak() == 400, "peak reset");
+    A.add(-400);
+
+    // counting allocator
+    auto& V = MemTag::get("testMemTag::vector");
+    {
+        tagged_vector<double> v{TaggedAllocator<double>(V)};
+        for(int i = 0; i < 100000; i++) v.push_back(i);
+        check(V.current() == (long long)(v.capacity()*sizeof(double)), "allocator current bytes");
+        check(V.peak() >= V.current() && V.allocs() > 1, "allocator peak");
+    }
+    check(V.current() == 0 && V.allocs() == V.frees(), "allocator release");
+
+    // MemAccount reporting to tag (only, outside budget), at grain resolution
+    auto B0 = MemoryBudget::global().inFlight();
+    {
+        MemAccount M("testMemTag::account", nullptr);
+        M.grain = 1000;
+        M.set(500);
+        check(MemTag::get("testMemTag::account").current() == 0, "account grain");
+        M.set(5000);
+        check(MemTag::get("testMemTag::account").current() == 5000, "account tag");
+        check(MemoryBudget::global().inFlight() == B0, "tag-only account outside budget");
+    }
+    check(MemTag::get("testMemTag::account").current() == 0, "account release");
+
+    // pooled objects retention
+    auto& P = MemTag::get("testMemTag::pool");
+    {
+        LockfreeAllocPool<MemTagItem> LP(16);
+        LP.setMemTag(&P);
+        LP.prewarm(10);
+        check(P.current() == 10*(long long)sizeof(MemTagItem), "pool retention");
+        auto o = LP.get();
+        check(P.current() == 9*(long long)sizeof(MemTagItem), "pool get");
+        LP.put(o);
+    }
+    check(P.current() == 0, "pool release");
+
+    // periodic sampling report while framework queue fills
+    MemReport R(0.01);
+    {
+        MemTagCounter C;
+        OrderingQueue<const MemTagItem> Q(&C, 1e9);
+        Q.setOwnsNext(false);
+        for(int i = 0; i < 100000; i++) Q.push(MemTagItem{double(i), {}});
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        check(MemTag::get("OrderingQueue").current() > 0, "OrderingQueue tag");
+        Q.signal(DATASTREAM_END);
+        check(C.n == 100000, "OrderingQueue output");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    R.sample();
+    check(MemTag::get("OrderingQueue").peak() >= 100000*(long long)sizeof(MemTagItem) - (1 << 16), "OrderingQueue peak");
+    check(processRSS() > 0 && processRSS(true) >= processRSS(), "process RSS");
+    MemReport::display();
+
+    std::unique_ptr<XMLTag> X(R.makeXML());
+    std::stringstream ss;
+    X->write(ss);
+    auto s = ss.str();
+    check(s.find("name=\"OrderingQueue\"") != string::npos && s.find("<sample ") != string::npos, "XML report");
+    printf("%zu bytes XML report\n", s.size());
+}
@@ -0,0 +1,124 @@
+/// \file testNeutronDecayBatch.cc Validate batched neutron decay kinematics against per-event generation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "UnpolarizedNeutronDecay.hh"
+#include "CounterRNG.hh"
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <stdio.h>
+
+/// random vectors from pre-filled event-major array
+class NKine_Array_Src: public NKine_Rndm_Src {
+public:
+    /// Constructor, from array of nr-element random vectors
+    NKine_Array_Src(const double* _v, size_t _nr): v(_v), nr(_nr) { }
+    /// copy next random vector
+    void next() override { for(size_t j = 0; j < nr; j++) u[j] = *(v++); }
+    /// number of random slots supplied
+    size_t n_random() const override { return nr; }
+    /// restart from array
+    void rewind(const double* _v) { v = _v; }
+protected:
+    const double* v;    ///< next random vector
+    const size_t nr;    ///< random vector size
+};
+
+/// compare per-event and batch generation from the same random vectors; return max difference
+double compare_batch(NeutronDecayKinematics& K, NKine_Array_Src& S, const vector<double>& u, size_t n) {
+    // kinematics-only timing
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < n; i++) K.gen_evt_weighted();
+    const double tk = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    NeutronDecayBatch B;
+    B.resize(n);
+    t0 = std::chrono::steady_clock::now();
+    K.gen_evts_weighted(u.data(), n, B);
+    const double tkb = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    S.rewind(u.data());
+    t0 = std::chrono::steady_clock::now();
+    vector<double> wr(n), ww(n), w(n), E(n), pf(n);
+    for(size_t i = 0; i < n; i++) {
+        K.gen_evt_weighted();
+        w[i] = K.evt_w;
+        E[i] = K.E_2;
+        pf[i] = K.p_f[0] + K.p_f[1] + K.p_f[2];
+        wr[i] = K.Gluck93_radcxn_wt();
+        ww[i] = K.B59_rwm_cxn_wt();
+    }
+    const double ts = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    t0 = std::chrono::steady_clock::now();
+    K.gen_evts_weighted(u.data(), n, B);
+    K.calc_cxn_wts(B, 0, n);
+    const double tb = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    double d = 0;
+    for(size_t i = 0; i < n; i++) {
+        d = std::max(d, fabs(B.evt_w[i] - w[i])/(fabs(w[i]) + 1e-300));
+        d = std::max(d, fabs(B.E_2[i] - E[i]));
+        d = std::max(d, fabs(B.p_f[0][i] + B.p_f[1][i] + B.p_f[2][i] - pf[i]));
+        d = std::max(d, fabs(B.w_rad[i] - wr[i]));
+        d = std::max(d, fabs(B.w_rwm[i] - ww[i]));
+    }
+    printf("\tkinematics: per-event %.1f ns, batch %.1f ns; with correction weights: per-event %.1f ns, batch %.1f ns; max difference %.2g\n",
+           tk*1e9/n, tkb*1e9/n, ts*1e9/n, tb*1e9/n, d);
+    return d;
+}
+
+REGISTER_EXECLET(testNeutronDecayBatch) {
+    const size_t n = 200000;
+    vector<double> u(8*n);
+    CounterRNG R(1);
+    R.fill(u.data(), u.size());
+
+    NKine_Array_Src S3(u.data(), 5);
+    N3BodyUncorrelated N3(&S3);
+    printf("N3BodyUncorrelated:\n");
+    if(!(compare_batch(N3, S3, u, n) < 1e-12)) throw std::runtime_error("N3BodyUncorrelated batch mismatch");
+
+    NKine_Array_Src SG(u.data(), 8);
+    Gluck_beta_MC G(&SG);
+    printf("Gluck_beta_MC:\n");
+    if(!(compare_batch(G, SG, u, n) < 1e-12)) throw std::runtime_error("Gluck_beta_MC batch mismatch");
+
+    // reproducible for any thread count and partition
+    NeutronDecayBatch B1, B4, B2;
+    auto t1 = std::chrono::steady_clock::now();
+    G.gen_evts(B1, n, 7, 0, 1);
+    const double tl1 = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+    G.gen_evts(B4, n, 7, 0, 4);
+    G.gen_evts(B2, n/3, 7, 0, 2);
+    G.gen_evts(B2, n - n/3, 7, n/3, 3);
+    if(B1.evt_w != B4.evt_w || B1.p_f[2] != B4.p_f[2] || B1.w_rad != B2.w_rad || B1.n_gamma[0] != B2.n_gamma[0])
+        throw std::runtime_error("Gluck_beta_MC batch generation not reproducible");
+
+    // lab-frame boost: total 4-momentum transforms as boosted rest-frame total
+    auto Esum = [&G](const NeutronDecayBatch& B, size_t i) {
+        double pf2 = B.p_f[0][i]*B.p_f[0][i] + B.p_f[1][i]*B.p_f[1][i] + B.p_f[2][i]*B.p_f[2][i];
+        return B.E_2[i] + B.E_1[i] + B.K[i] + sqrt(pf2 + (G.m - G.Delta)*(G.m - G.Delta));
+    };
+    auto pzsum = [](const NeutronDecayBatch& B, size_t i) {
+        return B.p_2[i]*B.n_2[2][i] + B.E_1[i]*B.n_1[2][i] + B.K[i]*B.n_gamma[2][i] + B.p_f[2][i];
+    };
+    for(double b: {1e-5, 0.5}) {
+        G.n_lab = Lorentz_boost::from_beta(b);
+        NeutronDecayBatch BL;
+        auto t0 = std::chrono::steady_clock::now();
+        G.gen_evts(BL, n, 7, 0, 1);
+        const double tl = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        double d = 0;
+        for(size_t i = 0; i < n; i++) {
+            double E0 = Esum(B1, i), pz0 = pzsum(B1, i);
+            G.n_lab.unboost(E0, pz0);
+            d = std::max(d, fabs(Esum(BL, i) - E0)/E0);
+            d = std::max(d, fabs(pzsum(BL, i) - pz0)/E0);
+            d = std::max(d, fabs(BL.evt_w[i] - B1.evt_w[i]));
+            d = std::max(d, std::fabs(BL.n_2[0][i]*BL.n_2[0][i] + BL.n_2[1][i]*BL.n_2[1][i] + BL.n_2[2][i]*BL.n_2[2][i] - 1));
+        }
+        printf("lab frame beta = %g: %.1f ns per event (%.1f ns without boost); max 4-momentum error %.2g\n", b, tl*1e9/n, tl1*1e9/n, d);
+        if(!(d < 1e-12)) throw std::runtime_error("Inconsistent lab-frame decay products");
+    }
+}
@@ -0,0 +1,69 @@
+/// \file testNucDecayCache.cc Validate NucDecayLibrary binary preparsed decay data cache
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "NuclEvtGen.hh"
+#include "PathUtils.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+#include <unistd.h>
+
+/// write text file contents
+void write_text(const string& fname, const string& s) {
+    auto f = fopen(fname.c_str(), "w");
+    if(!f) throw std::runtime_error("Failed to write " + fname);
+    fputs(s.c_str(), f);
+    fclose(f);
+}
+
+/// load generator from fresh library; return load time [s]
+double load_time(const string& dir, NucDecayBatch& B) {
+    auto t0 = std::chrono::steady_clock::now();
+    NucDecayLibrary L(dir);
+    auto& S = L.getGenerator("Test137");
+    const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    B = NucDecayBatch();
+    S.genDecays(B, 10000, 1, 0, 1);
+    return t;
+}
+
+REGISTER_EXECLET(testNucDecayCache) {
+    const string dir = "/tmp/testNucDecayCache";
+    makePath(dir);
+    write_text(dir + "/ElectronBindingEnergy.txt", "binding: Z = 56\tname = Ba\tK = 37441\tL = 5989\tL2 = 5624\tL3 = 5247\n");
+    const string fname = dir + "/Test137.txt";
+    const string src = "level: nm = 137.55.0\tE = 1176\thl = -1\n"
+                       "level: nm = 137.56.1\tE = 661.657\thl = 153\n"
+                       "level: nm = 137.56.0\tE = 0\thl = 0\n"
+                       "beta: from = 137.55.0\tto = 137.56.1\tI = 94.7\tforbidden = 1\n"
+                       "beta: from = 137.55.0\tto = 137.56.0\tI = 5.3\tforbidden = 2\n"
+                       "gamma: from = 137.56.1\tto = 137.56.0\tIgamma = 85.1\tCE_K = 0.0915\tCE_L = 0.0165@0.87:0.08:0.05\n";
+    write_text(fname, src);
+    remove((fname + ".bin").c_str());
+
+    // first load writes cache; second reads it
+    NucDecayBatch B0, B1, B2;
+    const double t0 = load_time(dir, B0);
+    if(!fileExists(fname + ".bin")) throw std::runtime_error("NucDecayLibrary cache not written");
+    const double t1 = load_time(dir, B1);
+    if(B0.E != B1.E || B0.d != B1.d) throw std::runtime_error("Cached NucDecaySystem differs");
+    printf("NucDecayLibrary load: from text %.1f ms, from cache %.2f ms\n", t0*1e3, t1*1e3);
+
+    // source change invalidates cache
+    write_text(fname, src + "# comment\n");
+    load_time(dir, B2);
+    if(B0.E != B2.E) throw std::runtime_error("Rebuilt NucDecaySystem differs");
+
+    // truncated cache is ignored
+    {
+        auto f = fopen((fname + ".bin").c_str(), "r+b");
+        if(!f || ftruncate(fileno(f), 100)) throw std::runtime_error("Failed to truncate cache");
+        fclose(f);
+    }
+    load_time(dir, B2);
+    if(B0.E != B2.E) throw std::runtime_error("NucDecaySystem from truncated cache differs");
+
+    for(auto f: {"/ElectronBindingEnergy.txt", "/ElectronBindingEnergy.txt.bin", "/Test137.txt", "/Test137.txt.bin"}) remove((dir + f).c_str());
+    rmdir(dir.c_str());
+}
@@ -0,0 +1,90 @@
+/// \file testObjectFactory.cc Check ObjectFactory class ID lookup tables, and time construction by name and ID
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include <chrono>
+#include <memory>
+
+/// factory test base class
+class FactoryTestBase {
+public:
+    /// Destructor
+    virtual ~FactoryTestBase() { }
+    /// identify subclass
+    virtual int id() const = 0;
+};
+
+/// factory test subclass
+template<int N>
+class FactoryTestItem: public FactoryTestBase {
+public:
+    /// identify subclass
+    int id() const override { return N; }
+};
+
+typedef FactoryTestItem<1> FTItem1;
+typedef FactoryTestItem<2> FTItem2;
+typedef FactoryTestItem<3> FTItem3;
+REGISTER_FACTORYOBJECT(FTItem1, FactoryTestBase)
+REGISTER_FACTORYOBJECT(FTItem2, FactoryTestBase)
+REGISTER_FACTORYOBJECT(FTItem3, FactoryTestBase)
+
+REGISTER_EXECLET(testObjectFactory) {
+    // compile-time and run-time class IDs agree
+    static_assert(CLASS_ID(FTItem2) == FactoriesIndex::hash("FTItem2"), "non-constant class ID");
+    if(CLASS_ID(FTItem2) != FactoriesIndex::hash(string("FTItem2"))) printf("*** ERROR: inconsistent class name hash!\n");
+
+    auto v = FactoriesIndex::namesFor<FactoryTestBase>();
+    if(v.size() != 3) printf("*** ERROR: %zu classes registered, expected 3!\n", v.size());
+
+    // lookup by name and ID; unknown names
+    int nbad = 0;
+    for(int i = 1; i <= 3; ++i) {
+        string nm = "FTItem" + std::to_string(i);
+        std::unique_ptr<FactoryTestBase> a(BaseFactory<FactoryTestBase>::try_construct(nm));
+        std::unique_ptr<FactoryTestBase> b(BaseFactory<FactoryTestBase>::construct(FactoriesIndex::hash(nm)));
+        if(!a || !b || a->id() != i || b->id() != i) ++nbad;
+    }
+    if(BaseFactory<FactoryTestBase>::try_construct("FTItem4")) ++nbad;
+    try {
+        BaseFactory<FactoryTestBase>::construct(CLASS_ID(FTItem4));
+        ++nbad;
+    } catch(std::out_of_range& e) { }
+    if(nbad) printf("*** ERROR: %i incorrect factory lookups!\n", nbad);
+
+    // FlatIDTable consistency over many entries
+    FlatIDTable<const int*> T;
+    vector<int> vals(10000);
+    for(size_t i = 0; i < vals.size(); ++i) {
+        vals[i] = i;
+        if(!T.emplace(FactoriesIndex::hash("item" + std::to_string(i)), &vals[i])) ++nbad;
+    }
+    if(T.emplace(FactoriesIndex::hash("item17"), &vals[0])) ++nbad;
+    for(size_t i = 0; i < vals.size(); ++i) {
+        auto p = T.find(FactoriesIndex::hash("item" + std::to_string(i)));
+        if(!p || *p != int(i)) ++nbad;
+    }
+    if(T.find(FactoriesIndex::hash("item-1")) || T.size() != vals.size()) ++nbad;
+    if(nbad) printf("*** ERROR: %i FlatIDTable inconsistencies!\n", nbad);
+
+    // construction timing
+    int ntrials = 1000000;
+    Cfg.lookupValue("ntrials", ntrials);
+    const string nm = "FTItem3";
+    size_t nid = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < ntrials; ++i) {
+        std::unique_ptr<FactoryTestBase> a(BaseFactory<FactoryTestBase>::try_construct(nm));
+        nid += a->id();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for(int i = 0; i < ntrials; ++i) {
+        std::unique_ptr<FactoryTestBase> a(BaseFactory<FactoryTestBase>::construct(CLASS_ID(FTItem3)));
+        nid += a->id();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    printf("construct by name %.1f ns, by ID %.1f ns\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count()/ntrials,
+           std::chrono::duration<double, std::nano>(t2 - t1).count()/ntrials);
+    if(nid != 6*size_t(ntrials)) printf("*** ERROR: wrong classes constructed!\n");
+}
@@ -0,0 +1,60 @@
+/// \file testPSelector.cc Validate and benchmark PSelector alias-table selection against cumulative binary search
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "NuclEvtGen.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+
+/// select m times from P with uniforms u, by alias or search; return ns per selection
+double time_select(const PSelector& P, const vector<double>& u, vector<unsigned int>& k, bool search) {
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < u.size(); i++) {
+        double x = u[i];
+        k[i] = search? P.select_search(&x) : P.select(&x);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count()*1e9/u.size();
+}
+
+REGISTER_EXECLET(testPSelector) {
+    const size_t m = 4000000;
+    CounterRNG R(2021);
+    vector<double> u(m);
+    vector<unsigned int> ka(m), ks(m);
+
+    for(size_t n: {8, 1000, 100000}) {
+        PSelector P;
+        for(size_t i = 0; i < n; i++) P.addProb(i % 7 == 3? 0 : R()*R()); // broad spread, with zero entries
+        P.select(); // build alias table before timing
+        R.fill(u.data(), m);
+        const double ts = time_select(P, u, ks, true);
+        const double ta = time_select(P, u, ka, false);
+
+        // compare frequencies (in coarse bins for large n) for the two methods
+        const size_t nb = std::min(n, size_t(100));
+        vector<double> ca(nb), cs(nb), pe(nb);
+        for(size_t i = 0; i < m; i++) {
+            if(ka[i] % 7 == 3) throw std::runtime_error("PSelector selected zero-probability item");
+            ca[ka[i]*nb/n]++;
+            cs[ks[i]*nb/n]++;
+        }
+        for(size_t i = 0; i < n; i++) pe[i*nb/n] += P.getProb(i)*m;
+        double chi2a = 0, chi2s = 0;
+        size_t dof = 0;
+        for(size_t b = 0; b < nb; b++) {
+            if(!pe[b]) continue;
+            chi2a += (ca[b] - pe[b])*(ca[b] - pe[b])/pe[b];
+            chi2s += (cs[b] - pe[b])*(cs[b] - pe[b])/pe[b];
+            dof++;
+        }
+        printf("PSelector %zu items: binary search %.2f ns, alias %.2f ns per selection; chi^2/dof = %.2f (search), %.2f (alias) for %zu bins\n",
+               n, ts, ta, chi2s/dof, chi2a/dof, dof);
+        if(!(chi2a < 2*dof + 20)) throw std::runtime_error("PSelector alias selection frequencies mismatch");
+
+        // alias table rebuilt after adding items
+        P.addProb(1e6*P.getCumProb());
+        double x = 0.5;
+        if(P.select(&x) != n) throw std::runtime_error("PSelector alias table not rebuilt after addProb");
+    }
+}
@@ -0,0 +1,76 @@
+/// \file testPersistentCollator.cc Compare persistent-thread ConfigCollator segments against per-segment collators
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigCollator.hh"
+#include "SyntheticDAQ.hh"
+#include <chrono>
+
+/// synthetic input chain head
+typedef SyntheticDAQ<SynthHit> PersistSynthDAQ;
+REGISTER_CONFIGURABLE(PersistSynthDAQ)
+
+/// count output, signals, and check order within each segment
+class PersistTestSink: public DataSink<const SynthHit> {
+public:
+    /// check received item
+    void push(const SynthHit& o) override {
+        if(o.t < t_prev) ++ndisordered;
+        t_prev = o.t;
+        ++n;
+    }
+    /// count signals; new segment on REINIT
+    void signal(datastream_signal_t s) override {
+        if(s == DATASTREAM_FLUSH) ++nflush;
+        if(s == DATASTREAM_REINIT) t_prev = -1e99;
+        if(s == DATASTREAM_END) ++nend;
+    }
+
+    size_t n = 0;           ///< number received
+    size_t ndisordered = 0; ///< number received out-of-order
+    size_t nflush = 0;      ///< number of flush signals
+    size_t nend = 0;        ///< number of end signals
+    double t_prev = -1e99;  ///< previous received time
+};
+
+REGISTER_EXECLET(testPersistentCollator) {
+    int nseg = 20;
+    Cfg.lookupValue("nseg", nseg);
+    int nhits = 5000;
+    Cfg.lookupValue("nhits", nhits);
+    const int nth = 4;
+    Config C;
+    C.readString("nthreads = " + std::to_string(nth) + "; persistent = true;\n"
+                 "prev = { class = \"PersistSynthDAQ\"; n = " + std::to_string(nhits) + "; disorder = 0; };\n");
+    auto& S = C.getRoot();
+
+    // persistent threads and chains across segments
+    PersistTestSink PS;
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        ConfigCollator<const SynthHit> CC(S);
+        CC.getNext() = &PS;
+        CC.setOwnsNext(false);
+        for(int i = 0; i < nseg; ++i) {
+            CC.run();
+            if(PS.n != size_t((i + 1)*nth*nhits)) { printf("*** ERROR: segment %i incomplete (%zu received)!\n", i, PS.n); break; }
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    // new collator, threads, and chains per segment
+    PersistTestSink NS;
+    for(int i = 0; i < nseg; ++i) {
+        ConfigCollator<const SynthHit> CC(S);
+        CC.persistent = false;
+        CC.getNext() = &NS;
+        CC.setOwnsNext(false);
+        CC.run();
+        NS.t_prev = -1e99;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    printf("%i segments x %i chains x %i hits: persistent %.2f ms, per-segment %.2f ms per segment\n", nseg, nth, nhits,
+           1e3*std::chrono::duration<double>(t1 - t0).count()/nseg, 1e3*std::chrono::duration<double>(t2 - t1).count()/nseg);
+    if(PS.n != NS.n || PS.ndisordered || NS.ndisordered) printf("*** ERROR: %zu/%zu hits, %zu/%zu disordered!\n", PS.n, NS.n, PS.ndisordered, NS.ndisordered);
+    if(PS.nflush < size_t(nseg) || PS.nend != 1) printf("*** ERROR: persistent segments signalled %zu flush, %zu end!\n", PS.nflush, PS.nend);
+}
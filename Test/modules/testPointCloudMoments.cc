@@ -0,0 +1,81 @@
+/// \file testPointCloudMoments.cc Streaming/merged point cloud moments and Jacobi PCA versus two-pass calculation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "PointCloudMoments.hh"
+#include <chrono>
+#include <random>
+
+/// largest difference between streamed, merged, and two-pass moments; eigendecomposition residual
+template<size_t N>
+double checkMoments(std::mt19937& R, int npts) {
+    std::normal_distribution<double> G;
+    std::uniform_real_distribution<double> U(0.5, 2);
+    vector<weightedpt<N>> v(npts);
+    for(auto& p: v) {
+        for(size_t j = 0; j < N; ++j) p[j] = 10 + (j + 1)*G(R) + (j? 0.5*p[0] : 0);
+        p.w = U(R);
+    }
+
+    PointCloudMoments<N> P(v);
+    PointCloudMoments<N> P1, P2;
+    for(int i = 0; i < npts; ++i) (i % 3? P1 : P2) += v[i];
+    P1 += P2;
+    P1.calcPrincipalComponents();
+
+    // two-pass reference
+    double sw = 0;
+    array<double,N> mu{{}};
+    for(auto& p: v) { sw += p.w; for(size_t j = 0; j < N; ++j) mu[j] += p.w*p[j]; }
+    for(auto& m: mu) m /= sw;
+    double d = fabs(sw - P.sw)/sw + fabs(sw - P1.sw)/sw;
+    for(size_t i = 0; i < N; ++i) {
+        d = std::max(d, fabs(mu[i] - P.mu[i]) + fabs(mu[i] - P1.mu[i]));
+        for(size_t j = 0; j < N; ++j) {
+            double c = 0;
+            for(auto& p: v) c += p.w*(p[i] - mu[i])*(p[j] - mu[j]);
+            d = std::max(d, (fabs(c - P.Cov[i][j]) + fabs(c - P1.Cov[i][j]))/sw);
+        }
+    }
+
+    // Cov PCA[k] = width2[k] PCA[k], orthonormal
+    for(size_t k = 0; k < N; ++k) {
+        for(size_t i = 0; i < N; ++i) {
+            double c = -P.width2[k]*P.PCA[k][i];
+            for(size_t j = 0; j < N; ++j) c += P.Cov[i][j]*P.PCA[k][j];
+            d = std::max(d, fabs(c)/sw);
+            double o = -(i == k);
+            for(size_t j = 0; j < N; ++j) o += P.PCA[k][j]*P.PCA[i][j];
+            d = std::max(d, fabs(o));
+        }
+        if(k && P.width2[k] > P.width2[k-1]) d = 1;
+    }
+    return d;
+}
+
+REGISTER_EXECLET(testPointCloudMoments) {
+    int npts = 1000;
+    Cfg.lookupValue("npts", npts);
+    int nclust = 100000;
+    Cfg.lookupValue("nclust", nclust);
+
+    std::mt19937 R(2021);
+    double d2 = checkMoments<2>(R, npts);
+    double d3 = checkMoments<3>(R, npts);
+    double d5 = checkMoments<5>(R, npts);
+    printf("Maximum deviations: 2D %g, 3D %g, 5D %g\n", d2, d3, d5);
+    if(!(std::max(d2, std::max(d3, d5)) < 1e-9)) printf("*** ERROR: moments/PCA mismatch!\n");
+
+    // per-cluster rate for small 3D clusters
+    std::normal_distribution<double> G;
+    vector<weightedpt<3>> v(10, weightedpt<3>(1.));
+    double s = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for(int c = 0; c < nclust; ++c) {
+        for(auto& p: v) for(auto& x: p) x = G(R);
+        PointCloudMoments<3> P(v);
+        s += P.width2[0];
+    }
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("%i 10-point 3D clusters in %g s (%g us per cluster; <width^2> = %g)\n", nclust, dt, 1e6*dt/nclust, s/nclust);
+}
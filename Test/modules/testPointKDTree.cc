@@ -0,0 +1,61 @@
+/// \file testPointKDTree.cc PointKDTree nearest-neighbor correctness versus brute force, and batched query rate
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "PointKDTree.hh"
+#include <chrono>
+#include <random>
+#include <stdio.h>
+
+REGISTER_EXECLET(testPointKDTree) {
+    int npts = 10000;
+    int ndim = 3;
+    int nq = 1000000;
+    int nthreads = 0;
+    Cfg.lookupValue("npts", npts);
+    Cfg.lookupValue("ndim", ndim);
+    Cfg.lookupValue("nq", nq);
+    Cfg.lookupValue("nthreads", nthreads);
+
+    std::mt19937 R(12345);
+    std::uniform_real_distribution<float> U(-1, 1);
+    vector<vector<float>> x(ndim, vector<float>(npts));
+    for(auto& v: x) for(auto& c: v) c = U(R);
+    // duplicated points
+    for(int i = 0; i < npts/10; ++i) for(auto& v: x) v[npts - 1 - i] = v[0];
+
+    vector<const float*> px;
+    for(auto& v: x) px.push_back(v.data());
+    PointKDTree T;
+    T.build(px, npts);
+
+    vector<float> q(size_t(nq)*ndim);
+    for(auto& c: q) c = 1.2*U(R);
+
+    // brute-force check on query subset
+    int nbad = 0;
+    for(int i = 0; i < std::min(nq, 2000); ++i) {
+        float bbest = 1e30;
+        for(int j = 0; j < npts; ++j) {
+            float d2 = 0;
+            for(int a = 0; a < ndim; ++a) d2 += (x[a][j] - q[i*ndim + a])*(x[a][j] - q[i*ndim + a]);
+            if(d2 < bbest) bbest = d2;
+        }
+        float d2 = 0;
+        T.nearest(&q[i*ndim], &d2);
+        nbad += d2 != bbest;
+    }
+
+    vector<int> idx(nq);
+    auto t0 = std::chrono::steady_clock::now();
+    T.nearest(q.data(), nq, idx.data(), 1);
+    auto t1 = std::chrono::steady_clock::now();
+    vector<int> idx2(nq);
+    T.nearest(q.data(), nq, idx2.data(), nthreads);
+    auto t2 = std::chrono::steady_clock::now();
+    nbad += idx != idx2;
+
+    printf("%i %i-dimensional points, %zu nodes: %.3g lookups/s single-threaded; %.3g lookups/s batched\n", npts, ndim, T.nNodes(),
+           nq/std::chrono::duration<double>(t1 - t0).count(), nq/std::chrono::duration<double>(t2 - t1).count());
+    if(nbad) printf("*** ERROR: %i mismatched PointKDTree lookups!\n", nbad);
+}
@@ -0,0 +1,107 @@
+/// \file testPointSelector.cc Sobol PointSelector: serial/batched/parallel agreement, scrambling, uniformity
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "PointSelector.hh"
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+/// throw on failed check
+static void check(bool ok, const char* what) { if(!ok) throw std::runtime_error(string("PointSelector check failed: ") + what); }
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// selector with nested partitions
+static PointSelector makeSelector(uint64_t scramble) {
+    PointSelector P;
+    P.setScramble(scramble);
+    P.addPart(3, 7);
+    P.addPart(2, 5);
+    P.addPart(4, 3);
+    return P;
+}
+
+REGISTER_EXECLET(testPointSelector) {
+    // Joe-Kuo polynomial order for tabulated dimensions
+    const unsigned int s0[] = {1,2,3,3,4,4,5,5,5,5,5,5,6,6,6};
+    const uint32_t a0[] = {0,1,1,2,1,4,2,4,7,11,13,14,1,13,16};
+    for(size_t d = 1; d <= 15; ++d) {
+        unsigned int s;
+        uint32_t a;
+        SobolSequence::polynomial(d, s, a);
+        check(s == s0[d-1] && a == a0[d-1], "primitive polynomial order");
+    }
+
+    // standard 2D Sobol start
+    SobolSequence S2(2);
+    const double x2[4][2] = {{0,0}, {0.5,0.5}, {0.75,0.25}, {0.25,0.75}};
+    for(int i = 0; i < 4; ++i) {
+        double x[2];
+        S2.point(i, x);
+        check(x[0] == x2[i][0] && x[1] == x2[i][1], "2D Sobol points");
+    }
+
+    for(uint64_t scramble: {uint64_t(0), uint64_t(12345)}) {
+        auto P = makeSelector(scramble);
+        const size_t Ntot = 9;
+        const size_t n = 3*P.nCycle() + 17;
+
+        // serial reference
+        vector<PointSelector::vec_t> vs;
+        for(size_t i = 0; i < n; ++i) vs.push_back(P.next());
+
+        // batches of uneven size, and direct fills over threads
+        auto Q = makeSelector(scramble);
+        vector<PointSelector::vec_t> vb;
+        for(size_t k = 1; vb.size() < n; ++k) for(auto& v: Q.nextBatch(std::min(k*k, n - vb.size()), 2)) vb.push_back(v);
+        check(vb == vs, "batched sequence");
+        check(Q.next() == P.next(), "next() after batch");
+
+        for(int nt: {1, 3}) {
+            vector<double> X(n*Ntot);
+            Q.fill(0, n, X.data(), nt);
+            for(size_t i = 0; i < n; ++i) check(vector<double>(X.begin() + i*Ntot, X.begin() + (i+1)*Ntot) == vs[i], "threaded fill");
+        }
+
+        // independent slices, and seeking
+        vector<double> x(Ntot);
+        Q.point(n/2, x.data());
+        check(x == vs[n/2], "direct point");
+        auto R = makeSelector(scramble);
+        R.skipTo(n/3);
+        check(R.next() == vs[n/3], "skipTo");
+
+        // uniformity of first coordinate means
+        vector<double> mu(Ntot);
+        for(auto& v: vs) for(size_t d = 0; d < Ntot; ++d) mu[d] += v[d]/n;
+        for(auto m: mu) check(fabs(m - 0.5) < 0.05, "coordinate mean");
+    }
+
+    // scrambled points differ from unscrambled, stay in [0,1)
+    SobolSequence S(20), SS(20, 99);
+    vector<double> x(20), y(20);
+    size_t ndiff = 0;
+    for(size_t i = 0; i < 1000; ++i) {
+        S.point(i, x.data());
+        SS.point(i, y.data());
+        for(size_t d = 0; d < 20; ++d) {
+            check(y[d] >= 0 && y[d] < 1, "scrambled range");
+            ndiff += x[d] != y[d];
+        }
+    }
+    check(ndiff > 19000, "scrambling");
+
+    // bulk generation rate
+    const size_t nbulk = 1 << 20;
+    vector<double> X(nbulk*20);
+    for(int nt: {1, 4}) {
+        auto t0 = std::chrono::steady_clock::now();
+        PointSelector P;
+        P.setScramble(7);
+        P.addPart(20, 1);
+        P.fill(0, nbulk, X.data(), nt);
+        printf("%zu scrambled 20-dimensional points over %i threads: %.1f ns/point\n", nbulk, nt, 1e9*since(t0)/nbulk);
+    }
+}
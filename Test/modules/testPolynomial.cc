@@ -11,6 +11,7 @@
 #include "HermitePolynomials.hh"
 #include "ChebyshevPolynomials.hh"
 #include "LaguerrePolynomials.hh"
+#include "OrthoRecurrence.hh"
 
 #include "Stopwatch.hh"
 
@@ -60,6 +61,14 @@ void addSimple(const P& p, vector<T>& v, const Cvec& c) {
     }
 }
 
+/// numerically evaluate symbolic monovariate polynomial
+template<class P>
+double evalMono(const P& p, double x) {
+    double s = 0;
+    for(auto& kv: p) s += double(kv.second)*pow(x, kv.first.x);
+    return s;
+}
+
 REGISTER_EXECLET(testPolynomial) {
     // array addition Semigroup
     SGArray_t<3> SGa3_a({1,2,3});
@@ -144,6 +153,26 @@ REGISTER_EXECLET(testPolynomial) {
     for(size_t i=0; i<vp.size(); i++) dmax = std::max(dmax, fabs((vp[i]-vp2[i])/vp[i]));
     printf("dmax %g\n", dmax);
 
+    // compiled Horner-form evaluation
+    auto pc = p*P3_b + P3_b*P3_b*P3_t(3.) + P3_t(2.5);
+    PolyProgram<precision_t> PPc(pc);
+    vector<precision_t> vc0, vc1, vc2;
+    PE.setX(vc);
+    {
+        Stopwatch w;
+        for(int i=0; i<ntrials; i++) PE.evalPolynomial(pc, vc0);
+    }
+    {
+        Stopwatch w;
+        for(int i=0; i<ntrials; i++) PE.evalProgram(PPc, vc1);
+    }
+    PPc.thread_chunk = 1000;
+    PE.evalProgram(PPc, vc2, 0);
+    dmax = 0;
+    for(size_t i=0; i<vc0.size(); i++) dmax = std::max(dmax, fabs(vc1[i]-vc0[i]) + fabs(vc2[i]-vc0[i]) + fabs(PPc(vc[i])-vc0[i]));
+    printf("compiled %zu instructions, dmax %g\n", PPc.size(), dmax);
+    if(!(dmax < 1e-9)) printf("*** ERROR: compiled polynomial mismatch!\n");
+
     LegendrePolynomials PP;
     LaguerrePolynomials LP;
     HermitePolynomials HP;
@@ -161,6 +190,44 @@ REGISTER_EXECLET(testPolynomial) {
         }
     }
 
+    // numeric recurrences versus symbolic polynomials
+    {
+        const size_t nc = 11;
+        vector<double> cs(nc), xs(1000), ys(xs.size());
+        for(size_t k = 0; k < nc; ++k) cs[k] = 1./(k + 1);
+        for(size_t j = 0; j < xs.size(); ++j) xs[j] = -1 + 2.*j/(xs.size() - 1);
+
+        dmax = 0;
+        for(auto f: {OrthoRecurrence::LEGENDRE, OrthoRecurrence::CHEBYSHEV_T, OrthoRecurrence::CHEBYSHEV_U,
+                     OrthoRecurrence::HERMITE, OrthoRecurrence::LAGUERRE}) {
+            OrthoRecurrence R(f, nc);
+            R.series(cs.data(), nc, xs.data(), ys.data(), xs.size());
+            for(size_t j = 0; j < xs.size(); ++j) {
+                double s = 0, ss = 0;
+                for(size_t k = 0; k < nc; ++k) {
+                    double pk = f == OrthoRecurrence::LEGENDRE? evalMono(PP(k), xs[j]) :
+                                f == OrthoRecurrence::CHEBYSHEV_T? evalMono(ChT(k), xs[j]) :
+                                f == OrthoRecurrence::CHEBYSHEV_U? evalMono(ChU(k), xs[j]) :
+                                f == OrthoRecurrence::HERMITE? evalMono(HP(k), xs[j]) : evalMono(LP(k), xs[j]);
+                    s += cs[k]*pk;
+                    ss += fabs(cs[k]*pk);
+                    dmax = std::max(dmax, fabs(R(k, xs[j]) - pk)/(1 + fabs(pk)));
+                }
+                dmax = std::max(dmax, (fabs(ys[j] - s) + fabs(R.series(cs.data(), nc, xs[j]) - s))/(1 + ss));
+            }
+        }
+        printf("orthogonal polynomial recurrences dmax %g\n", dmax);
+        if(!(dmax < 1e-12)) printf("*** ERROR: orthogonal polynomial recurrence mismatch!\n");
+
+        OrthoRecurrence R(OrthoRecurrence::CHEBYSHEV_T, 100);
+        vector<double> c100(100, 0.01);
+        xs.resize(1000000);
+        ys.resize(xs.size());
+        for(size_t j = 0; j < xs.size(); ++j) xs[j] = cos(j);
+        Stopwatch w; // 100-term series at 10^6 points
+        R.series(c100.data(), c100.size(), xs.data(), ys.data(), xs.size());
+    }
+
 #if false
     // calculus test
     auto pi2 = p.integral(2);
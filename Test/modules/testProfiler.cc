@@ -0,0 +1,77 @@
+/// \file testProfiler.cc Profiler zone overhead, nesting, and multi-threaded merged reports
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "Profiler.hh"
+#include "JobQueue.hh"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+
+/// busy-wait approximately n ns inside named zone
+static void spin(const char* zone, long n) {
+    ProfileZone Z(zone);
+    auto t0 = std::chrono::steady_clock::now();
+    while(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count() < n) { }
+}
+
+/// job with nested zones
+class ProfJob: public JobQueue::Job {
+public:
+    void run() override {
+        ProfileZone Z("ProfJob");
+        spin("inner_A", 20000);
+        spin("inner_B", 10000);
+    }
+};
+
+REGISTER_EXECLET(testProfiler) {
+    int nzones = 1000000;
+    int njobs = 200;
+    string tracefile;
+    Cfg.lookupValue("nzones", nzones);
+    Cfg.lookupValue("njobs", njobs);
+    Cfg.lookupValue("trace", tracefile);
+
+    // per-zone overhead, disabled and enabled
+    for(bool on: {false, true}) {
+        Profiler::enable(on);
+        auto t0 = std::chrono::steady_clock::now();
+        for(int i = 0; i < nzones; ++i) {
+            ProfileZone Z("overhead");
+            ProfileZone Z2("overhead_inner");
+        }
+        auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("Profiler %s: %.1f ns per zone\n", on? "enabled" : "disabled", 0.5e9*dt/nzones);
+    }
+    Profiler::reset();
+
+    // nested zones in multi-threaded job queue
+    Profiler::enable(true, tracefile.size());
+    {
+        ProfileZone Z("testProfiler");
+        JobQueue JQ;
+        JQ.launch(4);
+        for(int i = 0; i < njobs; ++i) JQ.add(new ProfJob());
+        JQ.shutdown();
+    }
+    Profiler::enable(false);
+
+    auto F = Profiler::flat();
+    if(F["ProfJob"].calls != size_t(njobs) || F["inner_A"].calls != size_t(njobs))
+        printf("*** ERROR: expected %i ProfJob calls, got %zu\n", njobs, F["ProfJob"].calls);
+    if(F["inner_A"].t_self < F["inner_B"].t_self)
+        printf("*** ERROR: inner_A should take longer than inner_B\n");
+
+    ProfileReport PR;
+    auto X = PR.makeXML();
+    X->write(std::cout);
+    std::cout << "\n";
+    delete X;
+
+    if(tracefile.size()) {
+        std::ofstream o(tracefile);
+        Profiler::writeChromeTrace(o);
+    }
+}
@@ -0,0 +1,39 @@
+/// \file testProgressMeter.cc ProgressBar versus multi-threaded ProgressMeter counting overhead
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ProgressBar.hh"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+
+REGISTER_EXECLET(testProgressMeter) {
+    int nitems = 100000000;
+    int nthreads = 4;
+    Cfg.lookupValue("nitems", nitems);
+    Cfg.lookupValue("nthreads", nthreads);
+
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        ProgressBar PB(nitems);
+        while(!++PB) { }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    {
+        std::vector<std::thread> v;
+        for(int i = 0; i < nthreads; ++i) v.emplace_back([nitems, nthreads] {
+            ProgressTask PT(nitems/nthreads);
+            for(int j = 0; j < nitems/nthreads; ++j) ++PT;
+        });
+        for(auto& t: v) t.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    auto& PM = ProgressMeter::global();
+    printf("ProgressBar: %.2f ns/item; ProgressTask (%i threads): %.2f ns/item\n",
+           1e9*std::chrono::duration<double>(t1 - t0).count()/nitems, nthreads,
+           1e9*std::chrono::duration<double>(t2 - t1).count()/nitems);
+    if(PM.done() != PM.total() || PM.total() != uint64_t(nitems/nthreads)*nthreads)
+        printf("*** ERROR: counted %llu of %llu items\n", (unsigned long long)PM.done(), (unsigned long long)PM.total());
+}
@@ -0,0 +1,94 @@
+/// \file testQuadraticBatch.cc Compare batched and per-point quadratic form, term, and gradient evaluation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "Quadratic.hh"
+#include "QuadraticT.hh"
+#include <chrono>
+#include <random>
+#include <stdexcept>
+
+/// throw on mismatch
+static void checkClose(double a, double b, const char* what) {
+    if(!(fabs(a - b) <= 1e-9*(1 + fabs(a) + fabs(b)))) throw std::runtime_error(string("Quadratic batch mismatch: ") + what);
+}
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// compare batched and single-point evaluation of Q at points X
+template<class Quad>
+void checkBatch(const Quad& Q, size_t N, const vector<double>& X, const char* name) {
+    const size_t npts = X.size()/N;
+    const size_t NT = Quadratic::nterms(N);
+
+    vector<double> y(npts), yq(npts), G(npts*N), Tm(npts*NT), H(N*N);
+    double t_pt = 1e9, t_batch = 1e9;
+    for(int rep = 0; rep < 5; ++rep) {
+        auto t0 = std::chrono::steady_clock::now();
+        for(size_t k = 0; k < npts; ++k) y[k] = Q(&X[k*N]);
+        t_pt = std::min(t_pt, since(t0));
+        t0 = std::chrono::steady_clock::now();
+        Q.evalBatch(X.data(), npts, yq.data());
+        t_batch = std::min(t_batch, since(t0));
+    }
+    printf("%s: per-point %.2f ns, batched %.2f ns per evaluation (best of 5)\n", name, 1e9*t_pt/npts, 1e9*t_batch/npts);
+    for(size_t k = 0; k < npts; ++k) checkClose(y[k], yq[k], "value");
+
+    Q.xTAxBatch(X.data(), npts, yq.data());
+    for(size_t k = 0; k < npts; ++k) checkClose(Q.xTAx(&X[k*N]), yq[k], "quadratic form");
+
+    // gradient against difference of quadratic form along each axis (exact for quadratics)
+    Q.gradientBatch(X.data(), npts, G.data());
+    Q.hessian(H.data());
+    vector<double> x(N);
+    for(size_t k = 0; k < npts; k += 97) {
+        for(size_t i = 0; i < N; ++i) {
+            x.assign(&X[k*N], &X[k*N] + N);
+            x[i] += 0.5;
+            const double yp = Q(x.data());
+            x[i] -= 1.;
+            const double ym = Q(x.data());
+            checkClose(G[k*N + i], yp - ym, "gradient");
+            checkClose(H[i*N + i], 4*(yp + ym - 2*y[k]), "Hessian diagonal");
+        }
+    }
+    for(size_t i = 0; i < N; ++i) for(size_t j = 0; j < N; ++j) checkClose(H[i*N + j], H[j*N + i], "Hessian symmetry");
+
+    // fit terms match per-point terms; terms . coefficients reproduce values
+    Quadratic::evalTermsBatch(N, X.data(), npts, Tm.data());
+    vector<double> cf(NT);
+    Q.getCoeffs(cf);
+    Quadratic::terms_t t;
+    for(size_t k = 0; k < npts; k += 31) {
+        Quadratic::evalTerms(vector<double>(&X[k*N], &X[k*N] + N), t);
+        double s = 0;
+        for(size_t n = 0; n < NT; ++n) { checkClose(t[n], Tm[k*NT + n], "terms"); s += t[n]*cf[n]; }
+        checkClose(s, y[k], "terms value");
+    }
+}
+
+REGISTER_EXECLET(testQuadraticBatch) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> u(-1, 1);
+    const size_t npts = 200000;
+
+    QuadraticT<4> Q4;
+    vector<double> c4(QuadraticT<4>::NTERMS);
+    for(auto& c: c4) c = u(rng);
+    Q4 = QuadraticT<4>(c4);
+    vector<double> X4(4*npts);
+    for(auto& x: X4) x = u(rng);
+    checkBatch(Q4, 4, X4, "QuadraticT<4>");
+
+    for(size_t N: {2, 7, 12}) {
+        Quadratic Q(N);
+        vector<double> cf(Quadratic::nterms(N));
+        for(auto& c: cf) c = u(rng);
+        Q.setCoeffs(cf);
+        vector<double> X(N*npts);
+        for(auto& x: X) x = u(rng);
+        string nm = "Quadratic(" + std::to_string(N) + ")";
+        checkBatch(Q, N, X, nm.c_str());
+    }
+}
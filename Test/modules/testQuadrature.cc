@@ -0,0 +1,67 @@
+/// \file testQuadrature.cc Validate cached-node vector quadrature and parallel adaptive integration
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "QuadratureEngine.hh"
+#include "DiskQuadrature.hh"
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <stdio.h>
+
+REGISTER_EXECLET(testQuadrature) {
+    // Gauss-Legendre exactness for x^(2n-1), x^(2n-2)
+    for(size_t n: {1, 2, 5, 16, 40}) {
+        const auto& G = QuadratureEngine::gaussLegendre(n);
+        double s = 0, e = 0;
+        for(size_t i = 0; i < n; ++i) { s += G.w[i]*pow(G.x[i], 2*n - 2); e += G.w[i]*pow(G.x[i], 2*n - 1); }
+        printf("GL%zu: %.16g vs %.16g, odd %g\n", n, s, 2./(2*n - 1), e);
+        if(fabs(s - 2./(2*n - 1)) > 1e-13 || fabs(e) > 1e-14) throw std::runtime_error("Gauss-Legendre rule fail");
+    }
+
+    // many components at shared nodes: f_j(x) = cos(j x) on [0,1]
+    const size_t m = 1000;
+    auto fcos = [m](const double* x, size_t n, double* F) {
+        for(size_t j = 0; j < m; ++j) for(size_t i = 0; i < n; ++i) F[j*n + i] = cos((j + 1)*x[i]);
+    };
+    QuadratureEngine QE(m, 32);
+    vector<double> I(m);
+    auto t0 = std::chrono::steady_clock::now();
+    auto nint = QE.adaptive(fcos, 0, 1, I.data(), 1e-12, 1e-12);
+    auto t1 = std::chrono::steady_clock::now();
+    double emax = 0;
+    for(size_t j = 0; j < m; ++j) emax = std::max(emax, fabs(I[j] - sin(j + 1.)/(j + 1)));
+    printf("%zu cos(jx) integrals in %zu intervals, %g s; max error %g\n", m, nint, std::chrono::duration<double>(t1 - t0).count(), emax);
+    if(emax > 1e-11) throw std::runtime_error("Adaptive vector quadrature fail");
+
+    // sharp peaks
+    const double eps = 1e-3;
+    auto fpk = [eps](const double* x, size_t n, double* F) {
+        for(size_t j = 0; j < 3; ++j) for(size_t i = 0; i < n; ++i) { auto d = x[i] - 0.3*j; F[j*n + i] = 1/(d*d + eps*eps); }
+    };
+    QuadratureEngine QP(3, 16);
+    double Ip[3];
+    nint = QP.adaptive(fpk, -1, 1, Ip, 1e-9, 1e-12);
+    for(size_t j = 0; j < 3; ++j) {
+        auto c = 0.3*j;
+        double ex = (atan((1 - c)/eps) - atan((-1 - c)/eps))/eps;
+        printf("peak at %g: %.12g vs %.12g (%zu intervals)\n", c, Ip[j], ex, nint);
+        if(fabs(Ip[j] - ex) > 1e-8*ex) throw std::runtime_error("Adaptive peak quadrature fail");
+    }
+
+    // disk mean of r^2 = R^2/2, x^4 + y^4 = R^4/4 about center; matches DiskQuadrature.hh 9-point rule for r^2
+    auto fdisk = [](const double* x, const double* y, size_t n, double* F) {
+        for(size_t i = 0; i < n; ++i) {
+            auto u = x[i] - 1, v = y[i] - 2;
+            F[i] = u*u + v*v;
+            F[n + i] = pow(u, 4) + pow(v, 4);
+        }
+    };
+    QuadratureEngine QD(2);
+    double Id[2];
+    QD.diskMean(fdisk, 1, 2, 0.5, Id);
+    double s9 = 0;
+    for(auto& p: diskquad_9) s9 += p[2]*(p[0]*p[0] + p[1]*p[1]);
+    printf("disk mean r^2 %.15g (9-point %.15g), x^4 + y^4 %.15g vs %.15g\n", Id[0], s9, Id[1], 0.25*pow(0.5, 4));
+    if(fabs(Id[0] - s9) > 1e-14 || fabs(Id[1] - 0.25*pow(0.5, 4)) > 1e-14) throw std::runtime_error("Disk quadrature fail");
+}
@@ -9,6 +9,7 @@
 #include "Stopwatch.hh"
 #include "ProgressBar.hh"
 
+#include <algorithm>
 #include <random>
 
 void summary(const PrimeSieve& S) {
@@ -35,6 +36,7 @@ REGISTER_EXECLET(testRational) {
         while(!++PB) {
             auto v = PS.factor(i);
             if(i != PrimeSieve::int_t(PS.prod(v))) throw std::runtime_error("Factoring fail!");
+            if(v != PS._factor(i)) throw std::runtime_error("Segmented sieve factoring mismatch!");
             ++i;
 
             if(rand() > 1e-5*RAND_MAX) continue;
@@ -46,6 +48,29 @@ REGISTER_EXECLET(testRational) {
     }
     summary(PS);
 
+    {
+        // full 32-bit range factoring from segmented sieve
+        auto& SS = theSegmentedSieve();
+        std::mt19937 R(54321);
+        Stopwatch w;
+        for(int j = 0; j < 1000000; ++j) {
+            uint32_t n = R();
+            auto v = SS.factor(n);
+            if(n != PS.prod(v)) throw std::runtime_error("32-bit factoring fail!");
+            for(auto p: v) if(!SS.isPrime(p)) throw std::runtime_error("32-bit factoring non-prime!");
+        }
+        printf("Segmented sieve with %zu primes < %u\n", SS.getPrimes().size(), SS.size());
+
+        // 64-bit factoring: trial division, Miller-Rabin, Pollard rho
+        std::mt19937_64 R64(54321);
+        for(int j = 0; j < 10000; ++j) {
+            PrimeSieve::uint_t n = R64() >> (j % 32);
+            auto v = PS.factor(n);
+            if(n != PS.prod(v) || !std::is_sorted(v.begin(), v.end())) throw std::runtime_error("64-bit factoring fail!");
+            for(auto p: v) if(!PrimeSieve::isPrime64(p)) throw std::runtime_error("64-bit factoring non-prime!");
+        }
+    }
+
     const auto& primes = PS.getPrimes();
     auto& pdivs  = PS.getPDivs();
     size_t nd0 = 0, nd1 = 0;
@@ -90,6 +115,40 @@ REGISTER_EXECLET(testRational) {
     cout << r5 << " . " << r5.inverse() + 1 << " . " << (r5 + r3)*(r5 - r3) << " & " << r35 << "\n";
     //r3 /= 0;
 
+    {
+        // lazily-normalized accumulation vs. Rational sums
+        Rational h;
+        RationalSum H;
+        Stopwatch w;
+        for(int i = 1; i <= 40; ++i) {
+            Rational b(1, i);
+            h += b;
+            H += b;
+        }
+        cout << "H_40 = " << h << " = " << Rational(H) << "\n";
+        if(Rational(H) != h) throw std::runtime_error("RationalSum mismatch!");
+    }
+
+    {
+        // compile-time inverses; wide and Montgomery modular multiplication
+        for(auto x: ModularField<251>::iterator()) if(x && int(x*x.inverse()) != 1) throw std::runtime_error("Mod-251 inverse fail!");
+        typedef ModularField<1000003, uint32_t> M32;
+        typedef ModularField<2305843009213693951, uint64_t> M61;
+        std::mt19937_64 R(12345);
+        M61 p61 = 1;
+        __uint128_t q61 = 1;
+        for(int j = 0; j < 100000; ++j) {
+            auto m = R() % 1000003, n = R() % 1000003;
+            if(int(M32(m)*M32(n)) != int((m*n) % 1000003)) throw std::runtime_error("Mod 10^6+3 multiply fail!");
+            int c = R() >> 33;
+            p61 *= M61(c);
+            q61 = (q61*c) % 2305843009213693951;
+            if(size_t(p61) != uint64_t(q61)) throw std::runtime_error("Mod 2^61-1 multiply fail!");
+            if(p61 && int(p61*p61.inverse()) != 1) throw std::runtime_error("Mod 2^61-1 inverse fail!");
+            if(m && int(M32(m)*M32(m).inverse()) != 1) throw std::runtime_error("Mod 10^6+3 inverse fail!");
+        }
+    }
+
     auto ii = EuclidRelPrime(1027,712);
     std::cout << ii.first << " " << ii.second << "\n";
 
@@ -0,0 +1,76 @@
+/// \file testRecvBuffer.cc Block receipt into re-used aligned buffers by SockDistribClientT over a socket pair
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "SockDistributor.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <thread>
+
+/// client checking received arrays in place
+class RecvCheckClient: public SockDistribClientT<double> {
+public:
+    /// Constructor, with socket file descriptor
+    explicit RecvCheckClient(int fd) { sockfd = fd; }
+    size_t nBlocks = 0;         ///< number of blocks received
+    size_t nBad = 0;            ///< number of bad blocks
+    size_t nMisaligned = 0;     ///< number of misaligned blocks
+    size_t maxCapacity = 0;     ///< largest buffer capacity used
+    using SockDistribClientT<double>::threadjob;
+
+protected:
+    /// check received data
+    bool process(const double* d, size_t n) override {
+        if(!n) return false;
+        if(reinterpret_cast<uintptr_t>(d) % RecvBuffer::align) ++nMisaligned;
+        if(d[0] != nBlocks || d[n-1] != nBlocks + n - 1) ++nBad;
+        maxCapacity = std::max(maxCapacity, theblock->data.capacity());
+        ++nBlocks;
+        return true;
+    }
+};
+
+REGISTER_EXECLET(testRecvBuffer) {
+    int nblocks = 20000;
+    Cfg.lookupValue("nblocks", nblocks);
+
+    int sv[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) throw std::runtime_error("socketpair failed");
+    RecvCheckClient C(sv[1]);
+
+    // sender: blocks of varying size, then end-of-stream zero-size block
+    std::thread tw([sv, nblocks] {
+        SockFD S(sv[0]);
+        vector<double> v;
+        for(int i = 0; i < nblocks; ++i) {
+            v.resize(1000 + (i*7919) % 8000);
+            for(size_t k = 0; k < v.size(); ++k) v[k] = i + k;
+            int32_t bsize = v.size()*sizeof(double);
+            S.sockwrite(reinterpret_cast<const char*>(&bsize), sizeof(bsize));
+            S.sockwrite(reinterpret_cast<const char*>(v.data()), bsize);
+        }
+        int32_t bsize = 0;
+        S.sockwrite(reinterpret_cast<const char*>(&bsize), sizeof(bsize));
+        S.close_socket();
+    });
+
+    auto t0 = std::chrono::steady_clock::now();
+    C.threadjob();
+    tw.join();
+    const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    printf("Received %zu blocks in %.3f s (%.1f us/block); max buffer capacity %zu bytes\n", C.nBlocks, dt, dt*1e6/C.nBlocks, C.maxCapacity);
+    if(C.nBlocks != size_t(nblocks) || C.nBad || C.nMisaligned) throw std::runtime_error("RecvBuffer block receipt failure");
+    if(C.maxCapacity > 2*9000*sizeof(double)) throw std::runtime_error("RecvBuffer capacity not retained");
+
+    // pooled blocks: capacity retained across hand-off and re-use
+    BlockHandler::blockpool_t P;
+    auto b = P.get();
+    auto p = b->data.resize(1 << 16);
+    P.put(b);
+    b = P.get();
+    if(b->data.size() || b->data.capacity() < (1 << 16) || b->data.resize(1000) != p) throw std::runtime_error("Pooled RecvBuffer not re-used");
+    delete b;
+}
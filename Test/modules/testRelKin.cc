@@ -2,7 +2,10 @@
 
 #include "ConfigFactory.hh"
 #include "RelKin.hh"
+#include <chrono>
 #include <stdio.h>
+#include <stdlib.h>
+#include <vector>
 
 REGISTER_EXECLET(testKinematics) {
 
@@ -29,4 +32,41 @@ REGISTER_EXECLET(testKinematics) {
     (L0.inverse() * L0).display();
     (L0 / L0).display();
 
+    printf("\n\nBatch boosts:\n");
+    const size_t n = 1000000;
+    std::vector<double> E(n), pz(n), beta(n);
+    srand(5);
+    for(size_t i = 0; i < n; ++i) {
+        pz[i] = 10.*rand()/RAND_MAX - 5;
+        E[i] = sqrt(pz[i]*pz[i] + 1);
+        beta[i] = 1.8*rand()/RAND_MAX - 0.9;
+    }
+    auto E0 = E, pz0 = pz, E1 = E, pz1 = pz, E2 = E, pz2 = pz, E3 = E, pz3 = pz;
+    Lorentz_boost_batch LBB;
+    LBB.setBeta(beta.data(), n);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < n; ++i) L0.boost(E1[i], pz1[i]);
+    auto t1 = std::chrono::steady_clock::now();
+    L0.boost(E2.data(), pz2.data(), n);
+    auto t2 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < n; ++i) Lorentz_boost::from_beta(beta[i]).boost(E3[i], pz3[i]);
+    auto t3 = std::chrono::steady_clock::now();
+    LBB.boost(E.data(), pz.data(), n);
+    auto t4 = std::chrono::steady_clock::now();
+    printf("fixed boost: %.2f ns per call, %.2f ns batched; per-item boosts: %.2f ns per call, %.2f ns batched\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count()/n, std::chrono::duration<double, std::nano>(t2 - t1).count()/n,
+           std::chrono::duration<double, std::nano>(t3 - t2).count()/n, std::chrono::duration<double, std::nano>(t4 - t3).count()/n);
+
+    double d = 0;
+    for(size_t i = 0; i < n; ++i) {
+        d = std::max(d, std::max(fabs(E2[i] - E1[i]), fabs(pz2[i] - pz1[i]))/E1[i]);
+        d = std::max(d, std::max(fabs(E[i] - E3[i]), fabs(pz[i] - pz3[i]))/E3[i]);
+    }
+    printf("max batch vs. per-call difference %.2g\n", d);
+    LBB.unboost(E.data(), pz.data(), n);
+    for(size_t i = 0; i < n; ++i) d = std::max(d, std::max(fabs(E[i] - E0[i]), fabs(pz[i] - pz0[i]))/E0[i]);
+    d = std::max(d, fabs(LBB[7].beta - beta[7]));
+    if(!(d < 1e-13)) printf("*** ERROR: inconsistent batch boosts!\n");
+
 }
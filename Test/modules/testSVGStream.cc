@@ -0,0 +1,88 @@
+/// \file testSVGStream.cc Compare streamed SVG output to in-memory SVGDoc, and polyline decimation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "SVGBuilder.hh"
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+using namespace SVG;
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// i^th test element
+static XMLTag* element(int i) {
+    if(i % 2) return new circle(0.01*i, sin(0.01*i), 0.1, "fill:blue");
+    return new line(0, 0, 0.01*i, cos(0.01*i), "stroke:black");
+}
+
+/// maximum distance of points from polyline
+static double maxdist(const vector<xypoint>& v, const vector<xypoint>& p) {
+    double dmax = 0;
+    size_t j = 0;
+    for(auto& x: v) {
+        // advance to segment spanning x (curve is monotonic in x)
+        while(j + 2 < p.size() && p[j+1][0] < x[0]) ++j;
+        const double dx = p[j+1][0] - p[j][0], dy = p[j+1][1] - p[j][1];
+        const double t = std::max(0., std::min(1., ((x[0] - p[j][0])*dx + (x[1] - p[j][1])*dy)/(dx*dx + dy*dy)));
+        dmax = std::max(dmax, hypot(x[0] - p[j][0] - t*dx, x[1] - p[j][1] - t*dy));
+    }
+    return dmax;
+}
+
+REGISTER_EXECLET(testSVGStream) {
+    const int n = 100000;
+    BBXML::BBox2 BB;
+    BB.expand({{-1, -2}});
+    BB.expand({{0.01*n, 2}});
+
+    // in-memory document
+    auto t0 = std::chrono::steady_clock::now();
+    std::stringstream s1;
+    {
+        SVGDoc D;
+        D.BB = BB;
+        D.body.addChild(new title("stream test"));
+        auto g = D.body.addChild(new group);
+        g->translation = {{1, 2}};
+        for(int i = 0; i < n; ++i) (i < n/2? (XMLTag*)g : &D.body)->addChild(element(i));
+        D.write(s1);
+    }
+    const double td = since(t0);
+
+    // streamed document
+    t0 = std::chrono::steady_clock::now();
+    std::stringstream s2;
+    size_t ne = 0;
+    {
+        SVGStream S(s2, BB);
+        S.add(new title("stream test"));
+        auto g = new group;
+        g->translation = {{1, 2}};
+        S.openGroup(g);
+        for(int i = 0; i < n; ++i) {
+            if(i == n/2) S.closeGroup();
+            S.add(element(i));
+        }
+        S.close();
+        ne = S.nElements;
+    }
+    const double ts = since(t0);
+    if(s1.str() != s2.str()) throw std::runtime_error("Streamed SVG output mismatch");
+    printf("%zu elements, %zu bytes: SVGDoc %.1f ms, SVGStream %.1f ms\n", ne, s2.str().size(), td*1e3, ts*1e3);
+
+    // decimated polyline
+    polyline P;
+    const int np = 1000000;
+    for(int i = 0; i < np; ++i) P.addpt(10.*i/np, sin(30.*i/np));
+    auto v = P.pts;
+    t0 = std::chrono::steady_clock::now();
+    polyline::decimate(P.pts, 1e-3);
+    const double tp = since(t0);
+    const double d = maxdist(v, P.pts);
+    printf("Decimated %i-point polyline to %zu points in %.1f ms; max deviation %.2g\n", np, P.pts.size(), tp*1e3, d);
+    if(!(d <= 1e-3) || P.pts.size() > 2000 || P.pts.front() != v.front() || P.pts.back() != v.back())
+        throw std::runtime_error("Bad polyline decimation");
+}
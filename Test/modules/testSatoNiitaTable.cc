@@ -0,0 +1,54 @@
+/// \file testSatoNiitaTable.cc Validate tabulated SatoNiitaNeutrons spectrum sampling against direct evaluation
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "SatoNiitaTable.hh"
+#include "CounterRNG.hh"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+REGISTER_EXECLET(testSatoNiitaTable) {
+    SatoNiitaNeutrons S;
+    auto t0 = std::chrono::steady_clock::now();
+    auto T = SatoNiitaTable::get(S);
+    const double tb = since(t0);
+    if(SatoNiitaTable::get(S) != T) throw std::runtime_error("SatoNiitaTable not shared");
+    SatoNiitaNeutrons S2;
+    S2.setParameters(1.0*GeV, 10*GeV, SatoNiitaNeutrons::altitudeToDepth(3*km), 0.1);
+    if(SatoNiitaTable::get(S2) == T) throw std::runtime_error("SatoNiitaTable not updated for new parameters");
+
+    // interpolated spectrum versus direct evaluation
+    const size_t m = 100000;
+    double ds = 0, sd = 0;
+    t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < m; i++) {
+        const double E = 1e-8*MeV*pow(1e12, (i + 0.5)/m);
+        const double f = S.calcGroundSpectrum(E);
+        sd += f;
+        ds = std::max(ds, fabs(T->spectrum(E)/f - 1));
+    }
+    const double td = since(t0);
+
+    // quantile inverts CDF; sampled distribution matches CDF
+    double dq = 0;
+    for(double p: {1e-9, 1e-4, 0.01, 0.2, 0.5, 0.8, 0.99, 1 - 1e-6}) dq = std::max(dq, fabs(T->cdf(T->quantile(p)) - p));
+    CounterRNG R(1);
+    const size_t n = 2000000;
+    vector<double> E(n);
+    t0 = std::chrono::steady_clock::now();
+    T->sample(E.data(), n, R);
+    const double ts = since(t0);
+    double dc = 0, dx = 0;
+    std::sort(E.begin(), E.end());
+    for(size_t i = 0; i < n; i += n/100) dc = std::max(dc, fabs(T->cdf(E[i]) - (i + 0.5)/n));
+    for(size_t i = 1; i < 1000; i++) dx = std::max(dx, fabs(T->sample(i/1000.)/T->quantile(i/1000.) - 1));
+
+    printf("SatoNiitaTable (%.1f ms): flux %g /s/cm^2; direct spectrum %.1f ns, sample %.1f ns (sum %g)\n", tb*1e3, T->getFlux()*cm2*s, td*1e9/m, ts*1e9/n, sd);
+    printf("\tmax spectrum interpolation error %.2g, CDF(quantile) error %.2g, sample/quantile error %.2g, sampled CDF deviation %.2g\n", ds, dq, dx, dc);
+    if(!(ds < 1e-3) || !(dq < 1e-12) || !(dx < 1e-5) || !(dc < 2e-3)) throw std::runtime_error("SatoNiitaTable mismatch");
+}
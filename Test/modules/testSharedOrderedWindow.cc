@@ -0,0 +1,103 @@
+/// \file testSharedOrderedWindow.cc Compare shared-buffer multiple window analyses against separate OrderedWindow copies
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "SharedOrderedWindow.hh"
+#include <chrono>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+
+/// ordered test item
+struct SOWItem {
+    /// ordering type
+    typedef double ordering_t;
+    /// ordering parameter
+    explicit operator ordering_t() const { return t; }
+    double t;       ///< time
+    double E;       ///< some data
+};
+
+/// coincidence analysis results
+struct SOWResults {
+    size_t nNew = 0;        ///< items entering
+    size_t nOld = 0;        ///< items leaving
+    size_t nCoinc = 0;      ///< items in +/- half-width around each mid
+    double sumE = 0;        ///< energy of coincident items
+    size_t nmax = 0;        ///< maximum window size
+    /// comparison
+    bool operator==(const SOWResults& r) const { return nNew == r.nNew && nOld == r.nOld && nCoinc == r.nCoinc && sumE == r.sumE; }
+};
+
+/// coincidence analysis on separate window
+class SOWSeparate: public OrderedWindow<const SOWItem> {
+public:
+    /// Constructor
+    explicit SOWSeparate(double dw): OrderedWindow(dw) { }
+    SOWResults R;   ///< results
+protected:
+    void processNew(const SOWItem&) override { ++R.nNew; R.nmax = std::max(R.nmax, size()); }
+    void processMid(const SOWItem&) override { for(auto& o: rel_range(-hwidth, hwidth)) { ++R.nCoinc; R.sumE += o.E; } }
+    void processOld(const SOWItem&) override { ++R.nOld; }
+};
+
+/// same coincidence analysis on shared window
+class SOWHandler: public WindowHandler<const SOWItem> {
+public:
+    /// Constructor
+    explicit SOWHandler(double dw): WindowHandler(dw) { }
+    SOWResults R;   ///< results
+protected:
+    void processNew(const SOWItem&) override { ++R.nNew; R.nmax = std::max(R.nmax, size()); }
+    void processMid(const SOWItem&) override { for(auto& o: rel_range(-hwidth, hwidth)) { ++R.nCoinc; R.sumE += o.E; } }
+    void processOld(const SOWItem&) override { ++R.nOld; }
+};
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+REGISTER_EXECLET(testSharedOrderedWindow) {
+    const vector<double> widths = {0, 0.5, 2, 5, 20};
+    const size_t nItems = 1000000, nBatch = 1024;
+
+    std::mt19937 rng(17);
+    std::exponential_distribution<double> dt(1.0);
+    vector<SOWItem> v(nItems);
+    double t = 0;
+    for(auto& o: v) { t += dt(rng); o = {t, dt(rng)}; }
+
+    // reference: separate windows
+    vector<std::unique_ptr<SOWSeparate>> S;
+    for(auto w: widths) S.emplace_back(new SOWSeparate(w));
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < nItems; i += nBatch) for(auto& s: S) s->push_batch(v.data() + i, std::min(nBatch, nItems - i));
+    for(auto& s: S) s->signal(DATASTREAM_FLUSH);
+    const double tsep = since(t0);
+    size_t nsep = 0;
+    for(auto& s: S) nsep += s->R.nmax;
+    printf("Separate windows: %.1f ns/item, max %zu items buffered\n", 1e9*tsep/nItems, nsep);
+
+    for(int nthreads: {1, 0}) {
+        SharedOrderedWindow<const SOWItem> W;
+        W.nthreads = nthreads;
+        vector<std::unique_ptr<SOWHandler>> H;
+        for(auto w: widths) {
+            H.emplace_back(new SOWHandler(w));
+            W.addHandler(H.back().get());
+        }
+        t0 = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < nItems; i += nBatch) W.push_batch(v.data() + i, std::min(nBatch, nItems - i));
+        W.signal(DATASTREAM_FLUSH);
+        const double tsh = since(t0);
+        printf("Shared window (%s): %.1f ns/item, max %zu items buffered\n", nthreads == 1? "serial" : "parallel", 1e9*tsh/nItems, W.maxSize());
+
+        if(W.size()) throw std::runtime_error("Shared window not flushed");
+        for(size_t k = 0; k < widths.size(); ++k) {
+            auto& r = H[k]->R;
+            if(!(r == S[k]->R) || r.nmax != S[k]->R.nmax) throw std::runtime_error("Shared window analysis mismatch");
+            printf("\twidth %g: %zu coincidences, max window %zu\n", widths[k], r.nCoinc, r.nmax);
+        }
+        if(W.maxSize() > S.back()->R.nmax + nBatch) throw std::runtime_error("Shared window buffer larger than widest window");
+    }
+}
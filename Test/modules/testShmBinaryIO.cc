@@ -0,0 +1,88 @@
+/// \file testShmBinaryIO.cc Shared-memory ring versus pipe round-trip throughput between processes
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ShmBinaryIO.hh"
+#include "DiskBIO.hh"
+#include <chrono>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// echo received vectors until empty one received
+void echoLoop(BinaryWriter& W, BinaryReader& R) {
+    vector<double> v;
+    do {
+        R.receive(v);
+        W.send(v);
+    } while(v.size());
+}
+
+/// round trips per second through W -> echo -> R
+double echoRate(BinaryWriter& W, BinaryReader& R, const vector<double>& v, int n) {
+    vector<double> v2;
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < n; ++i) {
+        W.send(v);
+        R.receive(v2);
+    }
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if(v2 != v) printf("*** ERROR: payload mismatch!\n");
+    return n/dt;
+}
+
+REGISTER_EXECLET(testShmBinaryIO) {
+    int ntrips = 10000;
+    Cfg.lookupValue("ntrips", ntrips);
+    vector<int> sizes = {10, 1000, 1000000};
+
+    string tag = std::to_string(getpid());
+    string na = "/testShmBIO_a_" + tag, nb = "/testShmBIO_b_" + tag;
+    int p0[2], p1[2];
+    if(pipe(p0) || pipe(p1)) throw std::runtime_error("pipe() failed");
+
+    auto pid = fork();
+    if(!pid) { // child echo process
+        {
+            ShmBinaryIO S(nb, na);
+            echoLoop(S, S);
+        }
+        {
+            FDBinaryWriter W(p1[1], FDBinaryWriter::SYNC_NONE);
+            W.setBufferSize(0);
+            FDBinaryReader R(p0[0]);
+            echoLoop(W, R);
+        }
+        _exit(0);
+    }
+
+    vector<double> rshm, rpipe;
+    {
+        ShmBinaryIO S(na, nb);
+        for(auto n: sizes) {
+            vector<double> v(n);
+            for(int i = 0; i < n; ++i) v[i] = i;
+            rshm.push_back(echoRate(S, S, v, std::max(ntrips/(1 + n/1000), 10)));
+        }
+        S.send(vector<double>());
+        vector<double> v;
+        S.receive(v);
+    }
+    {
+        FDBinaryWriter W(p0[1], FDBinaryWriter::SYNC_NONE);
+        W.setBufferSize(0);
+        FDBinaryReader R(p1[0]);
+        for(auto n: sizes) {
+            vector<double> v(n);
+            for(int i = 0; i < n; ++i) v[i] = i;
+            rpipe.push_back(echoRate(W, R, v, std::max(ntrips/(1 + n/1000), 10)));
+        }
+        W.send(vector<double>());
+        vector<double> v;
+        R.receive(v);
+    }
+    waitpid(pid, nullptr, 0);
+
+    for(size_t i = 0; i < sizes.size(); ++i)
+        printf("%i-double echo: pipe %.0f trips/s; shared memory %.0f trips/s\n", sizes[i], rpipe[i], rshm[i]);
+}
@@ -0,0 +1,99 @@
+/// \file testSketch3D.cc Validate batched, parallel Sketch3D projection and depth sorting
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "Sketch3D.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdlib.h>
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// uniform random number
+static double urand() { return rand()/double(RAND_MAX); }
+
+/// fill layer with n mixed balls and polylines
+static void fillLayer(PrimitivesLayer& L, size_t n) {
+    srand(4321);
+    for(size_t i = 0; i < n; ++i) {
+        xyzpt c{{urand(), urand(), urand()}};
+        if(i % 2) {
+            L.myObjs.emplace_back(new ProjectableBall(c, 0.01));
+            L.myObjs.back()->attrs["fill"] = "red";
+        } else {
+            auto p = new ProjectablePoly;
+            for(int j = 0; j < 4; ++j) p->pts.push_back({{c[0] + 0.01*j, c[1] + 0.01*urand(), c[2] + 0.01*urand()}});
+            p->closed = i % 4;
+            L.myObjs.emplace_back(p);
+        }
+        L.myObjs.back()->sattrs["stroke-width"] = 0.002;
+    }
+}
+
+/// check depth order and z against single-point projection
+static void checkLayer(const PrimitivesLayer& L, const Perspective& P) {
+    double zprev = -HUGE_VAL;
+    for(auto& o: L.myObjs) {
+        if(o->z < zprev) throw std::runtime_error("Sketch3D depth sort mismatch");
+        zprev = o->z;
+
+        size_t n = 0;
+        auto p = o->getPoints(n);
+        double z = 0;
+        xyzspt pp;
+        for(size_t i = 0; i < n; ++i) { P.project(p[i], pp); z += pp[2]; }
+        if(fabs(z/n - o->z) > 1e-12) throw std::runtime_error("Sketch3D batch projection mismatch");
+    }
+}
+
+REGISTER_EXECLET(testSketch3D) {
+    Perspective P;
+    P.isOrtho = false;
+    P.v0[2] = -5;
+    const double th = 0.3;
+    P.M[0][0] = P.M[2][2] = cos(th);
+    P.M[0][2] = sin(th);
+    P.M[2][0] = -sin(th);
+
+    const size_t n = 100000;
+    for(unsigned int nt: {1, 0}) {
+        PrimitivesLayer L;
+        L.nthreads = nt;
+        fillLayer(L, n);
+        XMLTag X("g");
+        auto t0 = std::chrono::steady_clock::now();
+        L.drawInto(X, P);
+        const double t = since(t0);
+        checkLayer(L, P);
+        printf("%zu primitives, %s: %.1f ms\n", n, nt == 1? "1 thread" : "all threads", t*1e3);
+    }
+
+    // vertex projection alone, on cache-resident vertices
+    vector<xyzpt> vx(4096);
+    for(auto& x: vx) x = {{urand(), urand(), urand()}};
+    vector<xyzspt> vp(vx.size()), vp1(vx.size());
+    vector<Vec<3,double>> vv(vx.size());
+    const int nrep = 200;
+    auto t0 = std::chrono::steady_clock::now();
+    for(int r = 0; r < nrep; ++r) for(size_t i = 0; i < vx.size(); ++i) P.project(vx[i], vp1[i]);
+    const double t1 = since(t0);
+    t0 = std::chrono::steady_clock::now();
+    for(int r = 0; r < nrep; ++r) {
+        for(size_t i = 0; i < vx.size(); ++i) vv[i] = Vec<3,double>(vx[i]);
+        P.project(vv, vp.data());
+    }
+    const double tb = since(t0);
+    for(size_t i = 0; i < vx.size(); ++i)
+        for(int j = 0; j < 4; ++j)
+            if(fabs(vp[i][j] - vp1[i][j]) > 1e-12) throw std::runtime_error("Sketch3D batch projection mismatch");
+    printf("Vertex projection: per-point %.2f ns, batch (including gather) %.2f ns\n", t1*1e9/vx.size()/nrep, tb*1e9/vx.size()/nrep);
+
+    // previous per-primitive projection and sort, for comparison
+    PrimitivesLayer L;
+    fillLayer(L, n);
+    t0 = std::chrono::steady_clock::now();
+    for(auto& o: L.myObjs) o->ProjectablePrimitive::setPerspective(P);
+    std::sort(L.myObjs.begin(), L.myObjs.end(), [](const unique_ptr<ProjectablePrimitive>& a, const unique_ptr<ProjectablePrimitive>& b) { return a->z < b->z; });
+    printf("Per-primitive projection and sort: %.1f ms\n", since(t0)*1e3);
+}
@@ -0,0 +1,119 @@
+/// \file testSockEvent.cc Loopback test of epoll SockEventServer distribution and block receipt with many clients
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "SockEventServer.hh"
+#include <chrono>
+#include <stdio.h>
+
+/// server counting received block bytes
+class SockEventCountServer: public SockEventServer {
+public:
+    using SockEventServer::SockEventServer;
+    std::atomic<size_t> nbytes{0};  ///< received bytes
+    std::atomic<size_t> nblocks{0}; ///< received blocks
+
+protected:
+    /// counting block connection
+    class CountConn: public SockEventBlockConn {
+    public:
+        CountConn(int fd, SockEventCountServer& s): SockEventBlockConn(fd), S(s) { }
+    protected:
+        bool process_v(const vector<char>& v) override { S.nbytes += v.size(); S.nblocks++; return true; }
+        SockEventCountServer& S;
+    };
+    SockEventConn* makeConn(int fd) override { return new CountConn(fd, *this); }
+};
+
+/// wait up to 10 s for condition
+template<typename F>
+static bool waitFor(F f) {
+    for(int i = 0; i < 10000 && !f(); ++i) usleep(1000);
+    return f();
+}
+
+REGISTER_EXECLET(testSockEvent) {
+    int port = 50123;
+    int nclients = 200;
+    int nblocks = 100;
+    int nio = 2;
+    Cfg.lookupValue("port", port);
+    Cfg.lookupValue("nclients", nclients);
+    Cfg.lookupValue("nblocks", nblocks);
+    Cfg.lookupValue("nio", nio);
+    bool ok = true;
+
+    // distribution to many clients, using SockDistribClient block protocol
+    {
+        SockEventDistribServer S(nio);
+        S.host = "localhost";
+        S.port = port;
+        S.launch_mythread();
+        ok = waitFor([&S] { return S.listening.load(); });
+
+        vector<std::unique_ptr<SockConnection>> C;
+        for(int i = 0; ok && i < nclients; ++i) {
+            C.emplace_back(new SockConnection("localhost", port));
+            C.back()->read_timeout_ms = 10000;
+            C.back()->connect_to_socket();
+        }
+        ok = ok && waitFor([&S, nclients] { return S.nConnections() == size_t(nclients); });
+
+        auto t0 = std::chrono::steady_clock::now();
+        vector<int32_t> b(257);
+        for(int j = 0; ok && j < nblocks; ++j) {
+            b[0] = (b.size() - 1)*sizeof(int32_t);
+            for(size_t k = 1; k < b.size(); ++k) b[k] = j + k;
+            ok = S.sendvector(b) == size_t(nclients);
+        }
+        for(auto& c: C) {
+            for(int j = 0; ok && j < nblocks; ++j) {
+                int32_t bsize = 0;
+                c->sockread(reinterpret_cast<char*>(&bsize), sizeof(bsize));
+                vector<int32_t> v(bsize/sizeof(int32_t));
+                c->sockread(reinterpret_cast<char*>(v.data()), bsize);
+                ok = bsize == b[0] && v[0] == j + 1 && v.back() == j + int(v.size());
+            }
+        }
+        auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("Distributed %i blocks to %i clients on %i I/O threads in %.3f s\n", nblocks, nclients, nio, dt);
+
+        C.clear();
+        ok = ok && waitFor([&S] { return !S.nConnections(); });
+        S.finish_mythread();
+    }
+
+    // block protocol receipt from many clients
+    {
+        SockEventCountServer S(nio);
+        S.host = "localhost";
+        S.port = port + 1;
+        S.launch_mythread();
+        ok = ok && waitFor([&S] { return S.listening.load(); });
+
+        vector<std::unique_ptr<SockConnection>> C;
+        for(int i = 0; ok && i < nclients; ++i) {
+            C.emplace_back(new SockConnection("localhost", port + 1));
+            C.back()->connect_to_socket();
+        }
+        vector<char> b(1001, 'x');
+        for(int j = 0; ok && j < nblocks; ++j) {
+            for(auto& c: C) {
+                int32_t bsize = b.size();
+                c->sockwrite(reinterpret_cast<char*>(&bsize), sizeof(bsize));
+                c->sockwrite(b.data(), b.size());
+            }
+        }
+        size_t ntot = size_t(nclients)*nblocks;
+        ok = ok && waitFor([&S, ntot] { return S.nblocks == ntot; }) && S.nbytes == ntot*b.size();
+
+        // zero-size block ends communication
+        int32_t z = 0;
+        for(auto& c: C) c->sockwrite(reinterpret_cast<char*>(&z), sizeof(z));
+        ok = ok && waitFor([&S] { return !S.nConnections(); });
+        printf("Received %zu blocks (%zu bytes) from %i clients\n", S.nblocks.load(), S.nbytes.load(), nclients);
+        S.finish_mythread();
+    }
+
+    if(!ok) printf("*** ERROR: SockEventServer test failed!\n");
+}
@@ -0,0 +1,91 @@
+/// \file testStaticChain.cc Compare fused StaticChain against dynamic DataLink chain
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "StaticChain.hh"
+#include <chrono>
+#include <stdlib.h>
+
+/// test datapoint
+struct ChainTestItem {
+    /// ordering type
+    typedef double ordering_t;
+    /// ordering parameter
+    explicit operator ordering_t() const { return x; }
+    double x;   ///< value
+};
+
+/// dynamic-chain scaling stage
+class ScaleLink: public DataLink<ChainTestItem, ChainTestItem> {
+public:
+    /// scale and pass along
+    void push(ChainTestItem& o) override { o.x *= 1.5; nextSink->push(o); }
+};
+
+/// dynamic-chain filtering stage
+class CutLink: public DataLink<ChainTestItem, ChainTestItem> {
+public:
+    /// pass items above threshold
+    void push(ChainTestItem& o) override { if(o.x > 0.3) nextSink->push(o); }
+};
+
+/// static-chain scaling stage
+class ScaleStage: public StaticStage<ChainTestItem> {
+public:
+    /// scale and pass along
+    template<class N>
+    void push(ChainTestItem& o, N& next) { o.x *= 1.5; next.push(o); }
+};
+
+/// static-chain filtering stage
+class CutStage: public StaticStage<ChainTestItem> {
+public:
+    /// pass items above threshold
+    template<class N>
+    void push(ChainTestItem& o, N& next) { if(o.x > 0.3) next.push(o); }
+};
+
+/// sum received values
+class SumSink: public DataSink<ChainTestItem> {
+public:
+    /// accumulate
+    void push(ChainTestItem& o) override { s += o.x; ++n; }
+    double s = 0;   ///< sum
+    size_t n = 0;   ///< count
+};
+
+/// time pushing nItems through chain starting at C; return ns per item
+double timeChain(DataSink<ChainTestItem>& C, size_t nItems) {
+    srand48(1);
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < nItems; ++i) {
+        ChainTestItem o{drand48()};
+        C.push(o);
+    }
+    return 1e9*std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count()/nItems;
+}
+
+REGISTER_EXECLET(testStaticChain) {
+    int nItems = 10000000;
+    Cfg.lookupValue("nItems", nItems);
+
+    SumSink S1, S2;
+
+    ScaleLink L1, L3;
+    CutLink L2;
+    L1.setNext(&L2);
+    L2.setNext(&L3);
+    L3.setNext(&S1);
+    L1.setOwnsNext(false);
+    L2.setOwnsNext(false);
+    L3.setOwnsNext(false);
+    auto td = timeChain(L1, nItems);
+
+    StaticChain<ScaleStage, CutStage, ScaleStage> SC;
+    SC.setNext(&S2);
+    SC.setOwnsNext(false);
+    auto ts = timeChain(SC, nItems);
+
+    printf("dynamic chain: %.2f ns/item; static chain: %.2f ns/item\n", td, ts);
+    if(S1.n != S2.n || S1.s != S2.s) printf("*** ERROR: chain outputs differ (%zu, %g) vs (%zu, %g)!\n", S1.n, S1.s, S2.n, S2.s);
+}
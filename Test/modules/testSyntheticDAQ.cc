@@ -0,0 +1,49 @@
+/// \file testSyntheticDAQ.cc Check SyntheticDAQ stream statistics, and re-ordering and latency probing downstream
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "SyntheticDAQ.hh"
+#include "OrderingQueue.hh"
+#include <cmath>
+
+REGISTER_EXECLET(testSyntheticDAQ) {
+    SyntheticDAQ<SynthHit> G(NullSetting, false);
+    Cfg.lookupValue("n", G.nHits);
+    G.disorder = 2000;
+    G.multiplicity = 3;
+    G.reset();
+
+    // raw stream statistics: disorder bounded by configured maximum emission delay
+    SynthHit h;
+    double tmax = -1e99, dmax = 0;
+    size_t nLate = 0;
+    int64_t evtmax = -1;
+    while(G.next(h)) {
+        if(h.t < tmax) { ++nLate; dmax = std::max(dmax, tmax - h.t); }
+        tmax = std::max(tmax, h.t);
+        evtmax = std::max(evtmax, h.evt);
+    }
+    double mult = double(G.nEmit)/(evtmax + 1);
+    printf("%zu hits in %lli clusters (%.3f per cluster); %zu out-of-order by up to %.1f ns\n", G.nEmit, (long long)evtmax + 1, mult, nLate, dmax);
+    if(G.nEmit != size_t(G.nHits)) printf("*** ERROR: wrong number of hits generated!\n");
+    if(!nLate || dmax > G.disorder + G.cluster_width) printf("*** ERROR: unexpected stream disorder!\n");
+    if(fabs(mult - G.multiplicity) > 0.1) printf("*** ERROR: unexpected cluster multiplicity!\n");
+
+    // re-ordered through queue at least as wide as disorder
+    G.reset();
+    OrderingQueue<const SynthHit> Q(nullptr, G.disorder + G.cluster_width);
+    SynthWorkLink<const SynthHit> W(4);
+    SynthLatencyProbe<const SynthHit> P;
+    Q.setNext(&W);
+    W.setNext(&P);
+    Q.setOwnsNext(false);
+    W.setOwnsNext(false);
+    G.setNext(&Q);
+    G.setOwnsNext(false);
+    G.run();
+
+    printf("latency: mean %.0f ns, p50 %.0f ns, p99 %.0f ns, max %lli ns\n", P.L.mean(), P.L.quantile(0.5), P.L.quantile(0.99), (long long)P.L.max);
+    if(P.L.n != G.nEmit) printf("*** ERROR: %zu hits lost in chain!\n", G.nEmit - P.L.n);
+    if(P.nDisordered) printf("*** ERROR: %zu hits out of order after OrderingQueue!\n", P.nDisordered);
+    if(!(P.L.quantile(0.5) <= P.L.quantile(0.99) && P.L.quantile(0.99) <= P.L.max)) printf("*** ERROR: inconsistent latency percentiles!\n");
+}
@@ -0,0 +1,79 @@
+/// \file testTLS_Solver.cc Validate streaming Total Least Squares line fit against in-memory SVD
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#ifdef WITH_LAPACKE
+#include "TLS_Sink.hh"
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+
+/// compare direction (up to sign) and residuals with reference fit
+void tlscompare(const char* name, const TLS_StreamSolver& S, const TLS_Solver& T0, double ssr0) {
+    double dp = 0, dm = 0, dmu = 0;
+    for(size_t j = 0; j < T0.n; j++) {
+        dp += pow(S.v[j] - T0.v[j], 2);
+        dm += pow(S.v[j] + T0.v[j], 2);
+        dmu = std::max(dmu, fabs(S.mu[j] - T0.mu[j]));
+    }
+    const double dv = sqrt(std::min(dp, dm)), dssr = fabs(S.getSSR() - ssr0)/ssr0;
+    printf("\t%s: %zu rows, direction error %g, center error %g, SSR relative error %g\n", name, S.nRows(), dv, dmu, dssr);
+    if(!(dv < 1e-9 && dmu < 1e-9 && dssr < 1e-9)) throw std::runtime_error("Streaming TLS mismatch");
+}
+
+REGISTER_EXECLET(testTLS_Solver) {
+    const size_t n = 3, m = 200000;
+    std::mt19937 R(12345);
+    std::normal_distribution<double> G;
+
+    // noisy points along offset line
+    vector<double> X(m*n);
+    for(size_t i = 0; i < m; i++) {
+        const double t = 10*G(R);
+        for(size_t j = 0; j < n; j++) X[i*n + j] = 1000 + (j + 1)*t + 0.1*G(R);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    TLS_Solver T0(n, m);
+    for(size_t i = 0; i < m; i++) for(size_t j = 0; j < n; j++) T0.B(i,j) = X[i*n + j];
+    T0.solve();
+    printf("in-memory TLS %zu x %zu: %.3f s\n", m, n, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    // residuals summed directly, for precise comparison
+    double ssr0 = 0;
+    for(size_t i = 0; i < m; i++) {
+        double d = 0, r2 = 0;
+        for(size_t j = 0; j < n; j++) d += (X[i*n + j] - T0.mu[j])*T0.v[j];
+        for(size_t j = 0; j < n; j++) r2 += pow(X[i*n + j] - T0.mu[j] - d*T0.v[j], 2);
+        ssr0 += r2;
+    }
+    printf("\tin-memory SSR relative error %g\n", fabs(T0.getSSR() - ssr0)/ssr0);
+
+    for(int nt: {1, 4}) {
+        t0 = std::chrono::steady_clock::now();
+        TLS_StreamSolver S(n);
+        S.addRows(X.data(), m - 77, nt);
+        for(size_t i = m - 77; i < m; i++) S.addRow(X.data() + i*n);
+        S.solve();
+        printf("streaming TLS (nthreads = %i): %.3f s\n", nt, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+        tlscompare("addRows", S, T0, ssr0);
+    }
+
+    // merge of independent accumulators
+    TLS_StreamSolver S1(n, 500), S2(n, 700);
+    for(size_t i = 0; i < m; i++) (i < m/3? S1 : S2).addRow(X.data() + i*n);
+    S1.merge(S2);
+    S1.solve();
+    tlscompare("merged", S1, T0, ssr0);
+
+    // pushed through DataSink
+    TLS_Sink<> K(n);
+    VarVec<double> x(n);
+    for(size_t i = 0; i < m; i++) {
+        for(size_t j = 0; j < n; j++) x[j] = X[i*n + j];
+        K.push(x);
+    }
+    K.signal(DATASTREAM_END);
+    tlscompare("TLS_Sink", K.TLS, T0, ssr0);
+}
+#endif
@@ -0,0 +1,108 @@
+/// \file testTermScreen.cc Validate incremental TermScreen terminal updates against full frame rendering
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "Terminart.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdlib.h>
+
+using namespace Terminart;
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// minimal terminal emulator for relative cursor moves, tracking displayed characters (ignoring styles)
+class MiniVT {
+public:
+    /// constructor
+    MiniVT(int nr, int nc): screen(nr, string(nc, '.')) { }
+
+    /// process output
+    void write(const string& s) {
+        for(size_t i = 0; i < s.size(); ++i) {
+            const char c = s[i];
+            if(c == '\r') { x.second = 0; continue; }
+            if(c == '\n') { ++x.first; x.second = 0; continue; }
+            if(c != '\033') { put(c); continue; }
+
+            // CSI sequence: numeric parameters and final character
+            if(++i >= s.size() || s[i] != '[') throw std::runtime_error("Unexpected escape sequence");
+            int n = 0;
+            while(++i < s.size() && ((s[i] >= '0' && s[i] <= '9') || s[i] == ';')) n = s[i] == ';'? 0 : 10*n + (s[i] - '0');
+            if(i >= s.size()) throw std::runtime_error("Incomplete CSI sequence");
+            if(s[i] == 'A') x.first -= n;
+            else if(s[i] == 'B') x.first += n;
+            else if(s[i] == 'C') x.second += n;
+            else if(s[i] == 'D') x.second -= n;
+            else if(s[i] == 'J') for(int r = x.first; r < int(screen.size()); ++r) screen.at(r) = string(screen[0].size(), ' ');
+            else if(s[i] != 'm') throw std::runtime_error("Unexpected CSI command");
+        }
+    }
+
+    /// check displayed frame contents at origin
+    bool matches(const pixelarray_t& a, char cnull) const {
+        if(x != rowcol_t{0,0}) return false;
+        for(int r = 0; r < a.dim.first; ++r)
+            for(int c = 0; c < a.dim.second; ++c)
+                if(screen.at(r).at(c) != (a({r,c}).c? a({r,c}).c : cnull)) return false;
+        return true;
+    }
+
+    vector<string> screen;  ///< displayed characters
+    rowcol_t x{0,0};        ///< cursor position
+
+protected:
+    /// place character at cursor
+    void put(char c) { screen.at(x.first).at(x.second++) = c; }
+};
+
+REGISTER_EXECLET(testTermScreen) {
+    const rowcol_t d{40, 120};
+    pixelarray_t a(d);
+    TermScreen TS;
+    MiniVT VT(d.first, d.second + 1);
+    srand(12345);
+
+    // "dashboard" frames: moving marker, updating counter text, occasional colored blocks
+    size_t nfull = 0, ninc = 0;
+    double tfull = 0, tinc = 0;
+    const int nframes = 500;
+    for(int f = 0; f < nframes; ++f) {
+        a.hline({f % d.first, 0}, d.second, pixel_t('-'));
+        a.hline({(f + d.first - 1) % d.first, 0}, d.second, pixel_t(' '));
+        char txt[32];
+        snprintf(txt, sizeof(txt), "frame %6i", f);
+        for(int i = 0; txt[i]; ++i) a({0, 2 + i}) = pixel_t(txt[i]);
+        if(f % 10 == 0) {
+            pixelarray_t b({3, 8});
+            for(int i = 0; i < 24; ++i) { b({i/8, i%8}) = pixel_t('#'); b({i/8, i%8}).set(rand() % 8); }
+            a.composite({rand() % d.first - 1, rand() % d.second - 4}, b);
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        string s = a.render();
+        s += cmove_control({-d.first, 0});
+        tfull += since(t0);
+        nfull += s.size();
+
+        t0 = std::chrono::steady_clock::now();
+        auto& u = TS.update(a);
+        tinc += since(t0);
+        if(f) ninc += u.size();
+        VT.write(u);
+        if(!VT.matches(a, ' ')) throw std::runtime_error("TermScreen display mismatch at frame " + std::to_string(f));
+    }
+
+    // dirty-region hint, and forced redraw
+    a({5,5}) = pixel_t('X');
+    a({30,100}) = pixel_t('Y');
+    VT.write(TS.update(a, {{0,0}, {10,10}}));
+    if(TS.nchanged != 1 || VT.screen[5][5] != 'X' || VT.screen[30][100] == 'Y') throw std::runtime_error("TermScreen dirty hint mismatch");
+    TS.invalidate();
+    VT.write(TS.update(a));
+    if(!VT.matches(a, ' ')) throw std::runtime_error("TermScreen redraw mismatch");
+
+    printf("%i frames %i x %i: full render %.1f kB, %.1f us/frame; incremental %.2f kB, %.1f us/frame\n",
+           nframes, d.first, d.second, 1e-3*nfull/nframes, tfull*1e6/nframes, 1e-3*ninc/(nframes - 1), tinc*1e6/nframes);
+}
@@ -0,0 +1,77 @@
+/// \file testTermStream.cc Validate decimated TermStream summaries, and rendering cost independent of data size
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "TermStreamSink.hh"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+using namespace Terminart;
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// test sample sequence
+static double sample(size_t i) { return sin(i*1e-5) + 0.1*sin(i*0.37) + (i % 1000 == 0? 0.5 : 0); }
+
+/// compare column summaries to direct calculation over column sample ranges
+static void check_columns(const TermStream& S, size_t s0, size_t s1) {
+    double x0, x1;
+    auto c = S.columns(x0, x1);
+    if(x0 != s0 || x1 != s1) throw std::runtime_error("Unexpected TermStream display range");
+    const size_t ncol = c.size();
+    for(size_t j = 0; j < ncol; ++j) {
+        TermStream::bin_t b;
+        for(size_t i = s0 + j*(s1 - s0)/ncol; i < s0 + (j + 1)*(s1 - s0)/ncol; ++i) b.add(sample(i));
+        if(b.n != c[j].n || b.min != c[j].min || b.max != c[j].max || fabs(b.mean() - c[j].mean()) > 1e-9)
+            throw std::runtime_error("TermStream column summary mismatch");
+    }
+}
+
+REGISTER_EXECLET(testTermStream) {
+    TermStreamSink<const double> T;
+    auto& S = T.S;
+
+    vector<double> v(1 << 20);
+    size_t n = 0;
+    double tpush = 0;
+    for(size_t N: {10240, 80 << 17}) {
+        // also through sink batch interface
+        auto t0 = std::chrono::steady_clock::now();
+        while(n < N) {
+            size_t m = std::min(v.size(), N - n);
+            for(size_t i = 0; i < m; ++i) v[i] = sample(n + i);
+            T.push_batch(v.data(), m);
+            n += m;
+        }
+        tpush += since(t0);
+        if(S.getN() != N) throw std::runtime_error("Wrong TermStream sample count");
+
+        // full history, aligned to bins
+        check_columns(S, 0, N);
+        t0 = std::chrono::steady_clock::now();
+        const int nrender = 100;
+        for(int i = 0; i < nrender; ++i) S.toArray();
+        printf("%zu samples: rendered in %.1f us\n", N, since(t0)*1e6/nrender);
+    }
+    printf("Filled at %.1f ns/sample (including sample generation)\n", tpush*1e9/n);
+
+    // recent window, at finer level
+    S.window = 80*64;
+    check_columns(S, n - S.window, n);
+
+    // partial bins at end
+    for(int i = 0; i < 3; ++i) {
+        double y = sample(n++);
+        T.push(y);
+    }
+    S.window = 0;
+    double x0, x1;
+    auto c = S.columns(x0, x1);
+    size_t nc = 0;
+    for(auto& b: c) nc += b.n;
+    if(nc != n || x1 != n) throw std::runtime_error("TermStream partial bins mismatch");
+
+    std::cout << S.toArray().render();
+}
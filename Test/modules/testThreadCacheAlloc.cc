@@ -0,0 +1,73 @@
+/// \file testThreadCacheAlloc.cc Compare ThreadCachePool and global new/delete for cross-thread payload pointers
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ThreadBufferSink.hh"
+#include "ThreadCacheAlloc.hh"
+#include <chrono>
+
+/// example pointer payload, default-allocated
+struct HeapPayload {
+    /// ordering type
+    typedef double ordering_t;
+    /// ordering parameter
+    explicit operator ordering_t() const { return t; }
+
+    double t;       ///< time
+    double E[6];    ///< some data
+};
+
+/// example pointer payload, thread-cache allocated
+struct CachedPayload: public HeapPayload, public ThreadCacheAllocated { };
+
+/// delete received payloads (at end of chain, in buffer reader thread)
+template<class P>
+class PayloadDeleter: public DataSink<P* const> {
+public:
+    /// receive and delete
+    void push(P* const& o) override { ++n; delete o; }
+    size_t n = 0;   ///< number deleted
+};
+
+/// allocate nItems payloads in this thread, delete in buffer thread; return ns/item
+template<class P>
+double timePayloads(size_t nItems) {
+    PayloadDeleter<P> D;
+    ThreadBufferSink<P* const> TB(&D);
+    TB.setOwnsNext(false);
+    TB.launch_mythread();
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < nItems; ++i) {
+        auto p = new P;
+        p->t = i;
+        TB.push(p);
+    }
+    TB.signal(DATASTREAM_FLUSH);
+    TB.finish_mythread();
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if(D.n != nItems) printf("*** ERROR: %zu/%zu items deleted!\n", D.n, nItems);
+    return 1e9*dt/nItems;
+}
+
+REGISTER_EXECLET(testThreadCacheAlloc) {
+    int nItems = 1000000;
+    Cfg.lookupValue("nItems", nItems);
+
+    printf("Cross-thread payload new/delete timing (ns/item) for %i items:\n", nItems);
+    printf("new/delete\t%.1f\n", timePayloads<HeapPayload>(nItems));
+    printf("thread cache\t%.1f\n", timePayloads<CachedPayload>(nItems));
+
+    auto P = ThreadCachePool::forSize(sizeof(CachedPayload));
+    printf("block size %zu: %zu hits, %zu misses, %zu remote frees\n", P->blockSize(), P->n_hits(), P->n_misses(), P->n_remote());
+
+    CachedAllocPool<HeapPayload> CP;
+    vector<HeapPayload*> v;
+    for(int j = 0; j < 3; ++j) {
+        for(int i = 0; i < 1000; ++i) v.push_back(CP.get());
+        for(auto p: v) CP.put(p);
+        v.clear();
+    }
+    if(CP.n_misses() > 1000) printf("*** ERROR: %zu re-used pool misses!\n", CP.n_misses());
+}
@@ -0,0 +1,100 @@
+/// \file testThreadDataSerializer.cc Compare mutex-locked and lock-free ThreadDataSerializer queueing from many producer threads
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ThreadDataSerializer.hh"
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+#include <thread>
+
+/// test item
+struct TDSItem {
+    int src = -1;   ///< producer number
+    int n = 0;      ///< sequence number from producer
+    int lane = 0;   ///< priority lane
+};
+
+/// serializer checking per-producer order
+class TDSCheck: public ThreadDataSerializer<TDSItem> {
+public:
+    /// Constructor, with number of producers
+    explicit TDSCheck(size_t np): last(np, -1) { }
+
+    using ThreadDataSerializer<TDSItem>::flush_queued_to_break;
+
+    vector<int> last;       ///< last sequence number from each producer
+    size_t nProcessed = 0;  ///< number of items processed
+    size_t nDisordered = 0; ///< number of out-of-order items
+    size_t nLaneSwaps = 0;  ///< lower-lane items processed ahead of higher-lane items within a batch
+    int prevLane = 0;       ///< lane of previously processed item
+
+protected:
+    /// check and count item
+    bool process_item(TDSItem& o) override {
+        if(o.n <= last.at(o.src)) ++nDisordered;
+        last[o.src] = o.n;
+        if(o.lane > prevLane) ++nLaneSwaps;
+        prevLane = o.lane;
+        ++nProcessed;
+        return true;
+    }
+    /// reset re-used item
+    void reset_allocated(TDSItem& o) override { o = TDSItem(); }
+};
+
+/// push nper items from each of np threads into serializer with nl lanes; return ns/item
+static double run_producers(size_t nl, size_t np, size_t nper) {
+    TDSCheck S(np);
+    S.setLockfree(nl);
+    S.launch_mythread();
+
+    auto t0 = std::chrono::steady_clock::now();
+    vector<std::thread> vt;
+    for(size_t i = 0; i < np; ++i) vt.emplace_back([&S, i, nper] {
+        for(size_t j = 0; j < nper; ++j) {
+            auto o = S.get_allocated(1);
+            o->src = int(i);
+            o->n = int(j);
+            S.return_allocated(o);
+        }
+    });
+    for(auto& t: vt) t.join();
+    S.return_allocated(nullptr);
+    S.finish_mythread();
+    const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if(S.nProcessed != np*nper) throw std::runtime_error("ThreadDataSerializer lost items");
+    if(S.nDisordered) throw std::runtime_error("ThreadDataSerializer reordered producer items");
+    return dt*1e9/(np*nper);
+}
+
+REGISTER_EXECLET(testThreadDataSerializer) {
+    const size_t nper = 200000;
+    for(size_t np: {1, 4, 16}) {
+        const double tm = run_producers(0, np, nper);
+        const double tl = run_producers(1, np, nper);
+        printf("%zu producers: mutex queue %.1f ns/item, lock-free queue %.1f ns/item\n", np, tm, tl);
+    }
+
+    // lanes ordering within batch, and break handling with held items
+    TDSCheck S(1);
+    S.setLockfree(3);
+    int n = 0;
+    for(int l: {0, 2, 1, 0, 2}) {
+        auto o = S.get_allocated();
+        *o = TDSItem{0, n++, l};
+        S.return_allocated(o, l);
+    }
+    S.return_allocated(nullptr, 1);
+    auto o = S.get_allocated();
+    *o = TDSItem{0, n++, 0};
+    S.return_allocated(o, 1);
+
+    S.prevLane = 2;
+    S.flush_queued_to_break(); // lane 2 (2 items), then lane 1 (1 item) up to break
+    if(S.nProcessed != 3 || S.nLaneSwaps) throw std::runtime_error("Lock-free lanes priority order");
+    S.flush_queued_to_break(); // held lane 1 item after break, then lane 0
+    if(S.nProcessed != 6) throw std::runtime_error("Lock-free held items after break");
+    printf("Lanes and break handling OK\n");
+}
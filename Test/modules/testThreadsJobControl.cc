@@ -0,0 +1,90 @@
+/// \file testThreadsJobControl.cc ThreadsJobControl job round trips, serialized versus ObjectPassing typed transfer
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "ThreadsJobControl.hh"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+
+/// total job items run by ThreadEchoJob
+static std::atomic<size_t> nThreadEchoItems{0};
+
+/// worker returning received payload; by object passing for JS.uid = 1
+class ThreadEchoJob: public JobWorker {
+public:
+    /// run job
+    void run(const JobSpec& J, BinaryIO& B) override {
+        nThreadEchoItems += J.N1 - J.N0;
+        vector<double> v;
+        if(J.uid) ObjectPassing::receiveOrPass(B, v);
+        else B.receive(v);
+        MultiJobWorker::JW->signalDone();
+        if(J.uid) ObjectPassing::sendOrPass(B, std::move(v));
+        else B.send(v);
+    }
+};
+
+REGISTER_FACTORYOBJECT(ThreadEchoJob, JobWorker)
+
+/// controller side of ThreadEchoJob
+class ThreadEchoComm: public JobComm {
+public:
+    /// send payload
+    void startJob(BinaryIO& B) override {
+        if(passing) ObjectPassing::sendOrPass(B, v);
+        else B.send(v);
+    }
+    /// receive and check echoed payload
+    void endJob(BinaryIO& B) override {
+        vector<double> v2;
+        if(passing) ObjectPassing::receiveOrPass(B, v2);
+        else B.receive(v2);
+        if(v2 == v) ++nGood;
+    }
+
+    bool passing = false;   ///< whether to use object passing
+    vector<double> v;       ///< payload
+    size_t nGood = 0;       ///< number of correctly returned payloads
+};
+
+REGISTER_EXECLET(testThreadsJobControl) {
+    int njobs = 2000;
+    Cfg.lookupValue("njobs", njobs);
+
+    ThreadsJobControl JC(4);
+    for(int n: {100, 10000, 1000000}) {
+        double rate[2];
+        for(int passing = 0; passing < 2; ++passing) {
+            ThreadEchoComm C;
+            C.passing = passing;
+            C.v.resize(n);
+            for(int i = 0; i < n; ++i) C.v[i] = i;
+            JobSpec JS;
+            JS.wclass = FactoriesIndex::hash("ThreadEchoJob");
+            JS.uid = passing;
+            JS.C = &C;
+            nThreadEchoItems = 0;
+
+            auto nj = std::max(njobs/(1 + n/10000), 10);
+            auto t0 = std::chrono::steady_clock::now();
+            for(int i = 0; i < nj; ++i) {
+                JS.N0 = i;
+                JS.N1 = i + 1;
+                JC.submitJob(JS);
+            }
+            JC.waitComplete();
+            rate[passing] = nj/std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            if(C.nGood != size_t(nj) || nThreadEchoItems != size_t(nj)) printf("*** ERROR: %zu of %i jobs returned correctly!\n", C.nGood, nj);
+        }
+        printf("%i-double payload: serialized %.0f jobs/s; object passing %.0f jobs/s\n", n, rate[0], rate[1]);
+    }
+
+    // sending wrong type is caught
+    try {
+        ObjectPassing::queue_t q;
+        q.push(std::make_shared<int>(1), typeid(int));
+        q.pop(typeid(double));
+        printf("*** ERROR: mismatched object type not detected!\n");
+    } catch(std::logic_error& e) { }
+}
@@ -0,0 +1,79 @@
+/// \file testVarMat.cc Validate and benchmark VarMat products against reference loops
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "VarMat.hh"
+#include "Rational.hh"
+#include <chrono>
+#include <complex>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+
+/// elapsed seconds since t0
+double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// reference triple-loop product
+template<typename T>
+VarMat<T> refmul(const VarMat<T>& A, const VarMat<T>& B) {
+    VarMat<T> C(A.nRows(), B.nCols());
+    for(size_t r=0; r<A.nRows(); r++) {
+        for(size_t c=0; c<B.nCols(); c++) {
+            T s = A(r,0)*B(0,c);
+            for(size_t i=1; i<A.nCols(); i++) s += A(r,i)*B(i,c);
+            C(r,c) = s;
+        }
+    }
+    return C;
+}
+
+/// |x| for exact type
+double abs(const Rational& r) { return fabs(double(r)); }
+
+/// maximum absolute difference
+template<typename T>
+double maxdiff(const VarVec<T>& a, const VarVec<T>& b) {
+    if(a.size() != b.size()) throw std::runtime_error("VarMat product dimensions mismatch");
+    double d = 0;
+    for(size_t i=0; i<a.size(); i++) { using std::abs; d = std::max(d, (double)abs(a[i] - b[i])); }
+    return d;
+}
+
+/// check products of m x k and k x n matrices
+template<typename T, typename F>
+void ptest(const char* tname, size_t m, size_t k, size_t n, F rnd, double tol) {
+    VarMat<T> A(m,k), B(k,n);
+    VarVec<T> u(m), v(k);
+    for(size_t i=0; i<A.size(); i++) A[i] = rnd();
+    for(size_t i=0; i<B.size(); i++) B[i] = rnd();
+    for(size_t i=0; i<u.size(); i++) u[i] = rnd();
+    for(size_t i=0; i<v.size(); i++) v[i] = rnd();
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto C0 = refmul(A,B);
+    const double t_ref = since(t0);
+    t0 = std::chrono::steady_clock::now();
+    auto C = A*B;
+    const double t_mul = since(t0);
+    printf("%s (%zu x %zu) * (%zu x %zu): reference %.4f s, VarMat %.4f s\n", tname, m, k, k, n, t_ref, t_mul);
+    if(!(maxdiff(C.getData(), C0.getData()) <= tol)) throw std::runtime_error("VarMat product mismatch");
+
+    VarMat<T> V(k,1), U(1,m);
+    V.getData() = v;
+    U.getData() = u;
+    if(!(maxdiff(A*v, refmul(A,V).getData()) <= tol)) throw std::runtime_error("VarMat * VarVec mismatch");
+    if(!(maxdiff(A.template rMultiply<T,T>(u), refmul(U,A).getData()) <= tol)) throw std::runtime_error("VarVec * VarMat mismatch");
+}
+
+REGISTER_EXECLET(testVarMat) {
+    std::mt19937 R(12345);
+    std::uniform_real_distribution<double> U(-1, 1);
+
+    ptest<double>("double", 300, 400, 500, [&]() { return U(R); }, 1e-11);
+    ptest<double>("double", 7, 1, 3, [&]() { return U(R); }, 1e-14);
+    ptest<float>("float", 200, 300, 100, [&]() { return float(U(R)); }, 1e-3);
+    ptest< std::complex<double> >("complex", 100, 150, 200, [&]() { return std::complex<double>(U(R), U(R)); }, 1e-11);
+
+    std::uniform_int_distribution<int> I(-9, 9);
+    ptest<Rational>("Rational", 24, 20, 28, [&]() { return Rational(I(R), 1 + std::abs(I(R))); }, 0);
+}
@@ -0,0 +1,90 @@
+/// \file testVisrBatch.cc Compare batched and per-command VisDriver line drawing
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "Visr.hh"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <stdexcept>
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// driver deferring commands to queue (as GLVisDriver), replayed to collect colored line segments
+class SegmentCollector: public VisDriver {
+public:
+    /// colored segment
+    typedef std::array<float,10> seg_t;
+
+    /// replay queued commands
+    void replay() {
+        for(auto& c: commands) (this->*c.fcn)(c.v);
+        commands.clear();
+    }
+
+    std::deque<VisCmd> commands;    ///< deferred commands
+    size_t ncmds = 0;               ///< number of commands received
+    vector<seg_t> segs;             ///< collected segments, with color
+
+protected:
+    /// queue command
+    void pushCommand(const VisCmd& c) override { ++ncmds; commands.push_back(c); }
+    /// queue command, by move
+    void pushCommand(VisCmd&& c) override { ++ncmds; commands.push_back(std::move(c)); }
+
+    /// set color
+    void _setColor(const vector<float>& v) override { std::copy(v.begin(), v.end(), col); }
+    /// segments from polyline
+    void _lines(const vector<float>& v) override {
+        const size_t n = v.size()/3;
+        for(size_t i = 0; i + 1 < n; ++i) addSeg(&v[3*i], &v[3*i+3]);
+        if(v.back() && n > 2) addSeg(&v[3*n-3], &v[0]);
+    }
+
+    /// add segment
+    void addSeg(const float* a, const float* b) {
+        seg_t s;
+        std::copy(col, col+4, s.begin());
+        std::copy(a, a+3, s.begin()+4);
+        std::copy(b, b+3, s.begin()+7);
+        segs.push_back(s);
+    }
+
+    float col[4] = {0,0,0,1};   ///< current color
+};
+
+/// draw test "tracks" scene
+static double drawTracks(VisDriver& V, int ntracks) {
+    auto t0 = std::chrono::steady_clock::now();
+    V.startRecording(true);
+    for(int i = 0; i < ntracks; ++i) {
+        V.setColor(i % 3 == 0, i % 3 == 1, i % 3 == 2, 1);
+        V.line({{0.01*i, 0, 0}}, {{0, 0.02*i, 1}});
+        if(i % 1000 == 0) {
+            V.ball({{0, 0, 0.001*i}}, 0.1);
+            V.circle({{0, 0, 0}}, {{0, 0, 1}}, 8);
+        }
+    }
+    V.stopRecording();
+    return since(t0);
+}
+
+REGISTER_EXECLET(testVisrBatch) {
+    const int ntracks = 100000;
+    SegmentCollector A, B;
+    B.batched = true;
+    const double ta = drawTracks(A, ntracks);
+    const double tb = drawTracks(B, ntracks);
+    A.replay();
+    B.replay();
+
+    // same segments and colors (batch reorders by color)
+    if(A.segs.size() != B.segs.size()) throw std::runtime_error("Batched segments count mismatch");
+    std::sort(A.segs.begin(), A.segs.end());
+    std::sort(B.segs.begin(), B.segs.end());
+    if(A.segs != B.segs) throw std::runtime_error("Batched segments mismatch");
+
+    printf("%zu segments: per-command %zu commands, %.1f ns/segment; batched %zu commands, %.1f ns/segment\n",
+           A.segs.size(), A.ncmds, ta*1e9/A.segs.size(), B.ncmds, tb*1e9/B.segs.size());
+}
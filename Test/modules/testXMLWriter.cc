@@ -0,0 +1,120 @@
+/// \file testXMLWriter.cc Compare streamed and binary XML metadata output to XMLTag tree output
+// -- Michael P. Mendenhall, LLNL 2021
+
+#include "ConfigFactory.hh"
+#include "XMLWriter.hh"
+#include "Profiler.hh"
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+/// elapsed seconds since t0
+static double since(std::chrono::steady_clock::time_point t0) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+
+/// numeric metadata provider, with both tree and direct streamed output
+class StatsProvider: public XMLProvider {
+public:
+    /// Constructor
+    explicit StatsProvider(int i): XMLProvider("stats"), n(i) { addAttr("id", i); }
+
+    int n;  ///< number of values
+
+protected:
+    /// value name (in sorted order, to match map attribute ordering)
+    static string vname(int i) { char c[16]; snprintf(c, sizeof(c), "v%03i", i); return c; }
+
+    /// XML output to tree
+    void _makeXML(XMLTag& X) override {
+        for(int i = 0; i < n; ++i) X.addAttr(vname(i), 0.1*i*n);
+        auto C = X.addChild(new XMLTag("counts"));
+        C->oneline = true;
+        for(int i = 0; i < 3; ++i) C->addChild(new XMLTag("c"))->addAttr("n", size_t(i)*n - 7);
+        X.addChild(new XMLText("<!-- comment -->"));
+    }
+    /// direct streamed XML output
+    void _writeXML(XMLWriter& W) override {
+        W.attrs(xattrs);
+        for(int i = 0; i < n; ++i) W.attr(vname(i), 0.1*i*n);
+        W.open("counts", true);
+        for(int i = 0; i < 3; ++i) {
+            W.open("c");
+            W.attr("n", size_t(i)*n - 7);
+            W.close();
+        }
+        W.close();
+        W.text("<!-- comment -->");
+    }
+};
+
+/// provider using default (tree-bridged) streamed output
+class BridgedProvider: public XMLProvider {
+public:
+    /// Constructor
+    BridgedProvider(): XMLProvider("bridged") { }
+protected:
+    /// XML output to tree
+    void _makeXML(XMLTag& X) override {
+        X.addAttr("negative", -123456789LL);
+        X.addAttr("e", 2.718281828);
+        X.addChild(new XMLTag("empty"));
+    }
+};
+
+REGISTER_EXECLET(testXMLWriter) {
+    const int nprov = 2000;
+    XMLProvider R("metadata");
+    vector<std::unique_ptr<XMLProvider>> v;
+    for(int i = 0; i < nprov; ++i) {
+        v.emplace_back(new StatsProvider(i % 50));
+        R.addChild(v.back().get());
+        if(i % 100 == 0) {
+            v.emplace_back(new BridgedProvider);
+            v[v.size()-2]->addChild(v.back().get());
+        }
+    }
+    Profiler::enable(true);
+    for(int i = 0; i < 10; ++i) {
+        ProfileZone Z("outer");
+        ProfileZone Z2("inner");
+    }
+    Profiler::enable(false);
+    ProfileReport PR;
+    R.addChild(&PR);
+
+    // tree output
+    auto t0 = std::chrono::steady_clock::now();
+    std::stringstream s1;
+    auto X = R.makeXML();
+    X->write(s1, 1);
+    delete X;
+    const double tt = since(t0);
+
+    // streamed text output
+    t0 = std::chrono::steady_clock::now();
+    std::stringstream s2;
+    {
+        XMLStreamWriter W(s2, 1);
+        R.writeXML(W);
+    }
+    const double ts = since(t0);
+    if(s1.str() != s2.str()) throw std::runtime_error("Streamed XML output mismatch");
+
+    // binary output, replayed to text
+    t0 = std::chrono::steady_clock::now();
+    std::stringstream s3;
+    {
+        BinaryXMLWriter W(s3);
+        R.writeXML(W);
+    }
+    const double tb = since(t0);
+    std::stringstream s4;
+    {
+        XMLStreamWriter W(s4, 1);
+        BinaryXMLWriter::replay(s3, W);
+    }
+    if(s4.str() != s2.str()) throw std::runtime_error("Binary XML replay mismatch");
+
+    printf("%zu bytes XML: tree %.2f ms, streamed %.2f ms; %zu bytes binary: %.2f ms\n",
+           s2.str().size(), tt*1e3, ts*1e3, s3.str().size(), tb*1e3);
+}
@@ -90,6 +90,22 @@ int main(int argc, char **argv) {
     assert(f);
     for(int i=1; i<=f->GetNbinsX(); i++) printf("\t%i\t%g\n", i, f->GetBinContent(i));
 
+    // repeat with worker-side tree reduction; should match
+    MyJobComm KTR;
+    KTR.kt.Set("v", *foo);
+    KTR.kt.Set("Combine","v");
+    KTR.kt.Set("NSamples", 1000);
+    KTR.treeReduce = true;
+    KTR.launchAccumulate(1);
+    MultiJobControl::JC->waitComplete();
+    KTR.gather();
+    auto g = KTR.kt.GetROOT<TH1>("v");
+    assert(g);
+    for(int i=1; i<=f->GetNbinsX(); i++)
+        if(g->GetBinContent(i) != f->GetBinContent(i)) printf("*** Tree reduction mismatch in bin %i: %g\n", i, g->GetBinContent(i));
+    delete g;
+    delete f;
+
     delete MultiJobControl::JC;
     MPIBinaryIO::uninit();
 
@@ -0,0 +1,55 @@
+/// \file AdaptiveInterval.cc
+
+#include "AdaptiveInterval.hh"
+#include <algorithm>
+
+double AdaptiveInterval::observe(double t, double n) {
+    inRate.addCount(t, n);
+    if(enabled() && ++nSince >= nAdjust) {
+        nSince = 0;
+        adjust(t);
+    }
+    return x;
+}
+
+void AdaptiveInterval::adjust(double t) {
+    auto r = rate();
+    if(!(r > 0)) return;
+
+    if(gain && sizes.getCount()) {
+        auto a = modelLevel(avgSize());
+        trim *= pow(std::min(std::max(modelLevel(target)/a, 0.5), 2.), gain);
+        trim = std::min(std::max(trim, 0.1), 10.);
+        sizes.clear();
+    }
+
+    auto x1 = std::min(std::max(trim * modelLevel(target)/r, xmin), xmax);
+    if(std::fabs(x1 - x) <= 0.05*x) return;
+    x = x1;
+    record(t);
+}
+
+void AdaptiveInterval::record(double t) {
+    if(nChanges++ % recStride) return;
+    traj.push_back({t, x});
+    if(traj.size() < maxTrajectory) return;
+    size_t j = 0;
+    for(size_t i = 0; i < traj.size(); i += 2) traj[j++] = traj[i];
+    traj.resize(j);
+    recStride *= 2;
+}
+
+void AdaptiveInterval::addXML(XMLTag& X, const string& tagname) const {
+    auto A = X.addChild(new XMLTag(tagname));
+    A->addAttr("target", target);
+    A->addAttr("min", xmin);
+    A->addAttr("max", xmax);
+    A->addAttr("final", x);
+    A->addAttr("rate", rate());
+    A->addAttr("trim", trim);
+    A->addAttr("changes", nChanges);
+    if(!traj.size()) return;
+    string s;
+    for(auto& p: traj) s += (s.size()? "," : "") + to_str(p.t) + ":" + to_str(p.x);
+    A->addAttr("trajectory", s);
+}
@@ -0,0 +1,74 @@
+/// \file AdaptiveInterval.hh Rate-tracking tuning of clustering/window interval to hold batch sizes near target
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef ADAPTIVEINTERVAL_HH
+#define ADAPTIVEINTERVAL_HH
+
+#include "RollingWindow.hh"
+#include "XMLTag.hh"
+#include <vector>
+using std::vector;
+
+/// Interval (e.g. cluster_dt, queue dt) tuned from rolling-window input rate to give target batch size
+/// feed-forward from rate r:  x = target/r (LINEAR: fixed-length windows), or ln(target)/r (GAP: gap-based clustering of random arrivals)
+/// trimmed by slow feedback from observed batch sizes; clamped to [xmin, xmax]
+class AdaptiveInterval {
+public:
+    /// batch size response model to interval
+    enum model_t {
+        LINEAR, ///< batch size ~ rate * interval
+        GAP     ///< batch size ~ exp(rate * interval)
+    };
+
+    /// Constructor, with initial interval, response model, and rolling window length
+    explicit AdaptiveInterval(double x0 = 1, model_t m = LINEAR, unsigned int navg = 1024):
+    x(x0), model(m), inRate(navg), sizes(navg), nAdjust(navg) { }
+
+    /// whether adaptation is enabled (positive target)
+    bool enabled() const { return target > 0; }
+    /// record arrival of n items up to ordering position t; return (possibly updated) interval
+    double observe(double t, double n = 1);
+    /// record observed batch size (cluster size, queue depth) for feedback trim
+    void feedback(double n) { sizes.addCount(0, n); }
+
+    /// rolling-window input rate per unit ordering parameter (0 if unknown)
+    double rate() const { auto s = inRate.getSpan(); return s > 0? inRate.getSum()/s : 0; }
+    /// rolling-average batch size
+    double avgSize() const { return sizes.getCount()? sizes.getAvg() : 0; }
+
+    /// add settings and trajectory to XML output as child tag
+    void addXML(XMLTag& X, const string& tagname = "adaptive") const;
+
+    double x;                   ///< current interval
+    model_t model;              ///< batch size response model
+    double target = 0;          ///< target batch size (<= 0 to disable)
+    double xmin = 0;            ///< minimum interval
+    double xmax = std::numeric_limits<double>::infinity(); ///< maximum interval
+    double gain = 0.25;         ///< feedback trim exponent per adjustment (0 for pure feed-forward)
+    size_t maxTrajectory = 256; ///< maximum recorded trajectory points (decimated when full)
+
+protected:
+    /// trajectory point
+    struct point_t {
+        double t;   ///< ordering position
+        double x;   ///< interval set
+    };
+
+    /// recalculate interval at position t
+    void adjust(double t);
+    /// "effective rate" for batch size n in response model
+    double modelLevel(double n) const { return model == GAP? log(std::max(n, 1.5)) : n; }
+    /// record trajectory point, decimating history when full
+    void record(double t);
+
+    RollingWindow inRate;       ///< rolling input item counts
+    RollingWindow sizes;        ///< rolling batch sizes
+    unsigned int nAdjust;       ///< observations between adjustments
+    unsigned int nSince = 0;    ///< observations since last adjustment
+    double trim = 1;            ///< feedback correction factor on feed-forward interval
+    size_t nChanges = 0;        ///< number of interval changes
+    size_t recStride = 1;       ///< record every recStride-th change (after decimation)
+    vector<point_t> traj;       ///< recorded (decimated) trajectory
+};
+
+#endif
@@ -6,7 +6,11 @@
 
 #include <vector>
 #include <mutex>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include "MemTag.hh"
 using std::vector;
 
 
@@ -15,24 +19,40 @@ template<class T>
 class AllocPool {
 public:
     /// Detructor
-    virtual ~AllocPool() { for(auto p: pool) delete p; }
+    virtual ~AllocPool() { setMemTag(nullptr); for(auto p: pool) delete p; }
     /// get allocated item
     T* get() {
         if(!pool.size()) { nAlloc++; return new T; }
+        nHit++;
         auto i = pool.back();
         pool.pop_back();
+        if(memTag) memTag->add(-(long long)sizeof(T));
         return i;
     }
     /// Return allocated item
     void put(T* p) {
         p->clear();
-        if(pool.size() < maxPool) pool.push_back(p);
-        else delete p;
+        if(pool.size() < maxPool) {
+            pool.push_back(p);
+            if(memTag) memTag->add(sizeof(T));
+        } else delete p;
+    }
+    /// number of get() requests served from pool
+    size_t n_hits() const { return nHit; }
+    /// number of get() requests requiring new allocation
+    size_t n_misses() const { return nAlloc; }
+    /// account pooled objects (shallow size) to tag, or nullptr to stop
+    void setMemTag(MemTag* t) {
+        if(memTag) memTag->add(-(long long)(pool.size()*sizeof(T)));
+        memTag = t;
+        if(memTag) memTag->add(pool.size()*sizeof(T));
     }
 protected:
     size_t nAlloc = 0;      ///< total number of items allocated
+    size_t nHit = 0;        ///< total number of items re-used from pool
     size_t maxPool = 4096;  ///< maximum pool size before deletion
     vector<T*> pool;        ///< allocated object pool
+    MemTag* memTag = nullptr;   ///< optional accounting of pooled bytes
 };
 
 /// Thread-safe AllocPool
@@ -40,15 +60,17 @@ template<class T>
 class LockedAllocPool {
 public:
     /// Detructor
-    virtual ~LockedAllocPool() { for(auto p: pool) delete p; }
+    virtual ~LockedAllocPool() { setMemTag(nullptr); for(auto p: pool) delete p; }
     /// get allocated item
     T* get() {
         T* i = nullptr;
         {
             std::unique_lock<std::mutex> lk(poolLock);
             if(!pool.size()) { nAlloc++; return new T; }
+            nHit++;
             i = pool.back();
             pool.pop_back();
+            if(memTag) memTag->add(-(long long)sizeof(T));
         }
         return i;
     }
@@ -57,11 +79,155 @@ public:
         p->clear();
         std::unique_lock<std::mutex> lk(poolLock);
         pool.push_back(p);
+        if(memTag) memTag->add(sizeof(T));
+    }
+    /// number of get() requests served from pool
+    size_t n_hits() const { return nHit; }
+    /// number of get() requests requiring new allocation
+    size_t n_misses() const { return nAlloc; }
+    /// account pooled objects (shallow size) to tag, or nullptr to stop
+    void setMemTag(MemTag* t) {
+        std::unique_lock<std::mutex> lk(poolLock);
+        if(memTag) memTag->add(-(long long)(pool.size()*sizeof(T)));
+        memTag = t;
+        if(memTag) memTag->add(pool.size()*sizeof(T));
     }
 protected:
-    size_t nAlloc = 0;      ///< total number of items allocated
+    std::atomic<size_t> nAlloc{0};  ///< total number of items allocated
+    std::atomic<size_t> nHit{0};    ///< total number of items re-used from pool
     vector<T*> pool;        ///< allocated object pool
     std::mutex poolLock;    ///< lock on pool
+    MemTag* memTag = nullptr;   ///< optional accounting of pooled bytes; lock on poolLock
+};
+
+/// Lock-free bounded AllocPool: ABA-tagged Treiber stacks of pooled objects and of free slots
+template<class T>
+class LockfreeAllocPool {
+public:
+    /// Constructor, with maximum number of pooled objects
+    explicit LockfreeAllocPool(size_t nmax = 4096) { setCapacity(nmax); }
+    /// Destructor
+    virtual ~LockfreeAllocPool() { T* p; while((p = try_get())) delete p; }
+
+    /// account pooled objects (shallow size) to tag, or nullptr to stop --- not thread-safe
+    void setMemTag(MemTag* t) {
+        T* p;
+        vector<T*> v;
+        while((p = try_get())) v.push_back(p);
+        memTag = t;
+        for(auto o: v) if(!try_put(o)) { ++nDeleted; delete o; }
+    }
+
+    /// change maximum pooled objects (deleting excess) --- not thread-safe
+    void setCapacity(size_t nmax) {
+        assert(nmax < UINT32_MAX);
+        vector<T*> v;
+        T* p;
+        while((p = try_get())) v.push_back(p);
+        slots.reset(nmax? new slot_t[nmax] : nullptr);
+        nslots = nmax;
+        full.store(0);
+        empty.store(0);
+        for(size_t i = nmax; i > 0; --i) push(empty, i);
+        for(auto o: v) if(!try_put(o)) { ++nDeleted; delete o; }
+    }
+    /// maximum pooled objects
+    size_t capacity() const { return nslots; }
+
+    /// allocate up to n new objects into pool
+    void prewarm(size_t n) {
+        while(n--) {
+            auto p = new T;
+            ++nAlloc;
+            if(!try_put(p)) { delete p; --nAlloc; return; }
+        }
+    }
+
+    /// get allocated item
+    T* get() {
+        auto p = try_get();
+        if(p) ++nHit;
+        else { ++nAlloc; p = new T; }
+        auto n = ++nOut;
+        auto m = peakOut.load(std::memory_order_relaxed);
+        while(n > m && !peakOut.compare_exchange_weak(m, n, std::memory_order_relaxed)) { }
+        return p;
+    }
+    /// Return allocated item
+    void put(T* p) {
+        if(!p) return;
+        p->clear();
+        --nOut;
+        if(!try_put(p)) { ++nDeleted; delete p; }
+    }
+
+    /// get pooled item, or nullptr if pool empty
+    T* try_get() {
+        auto i = pop(full);
+        if(!i) return nullptr;
+        auto p = slots[i-1].obj;
+        push(empty, i);
+        if(memTag) memTag->add(-(long long)sizeof(T));
+        return p;
+    }
+    /// place item in pool; false if pool full
+    bool try_put(T* p) {
+        auto i = pop(empty);
+        if(!i) return false;
+        slots[i-1].obj = p;
+        push(full, i);
+        if(memTag) memTag->add(sizeof(T));
+        return true;
+    }
+
+    /// number of get() requests served from pool
+    size_t n_hits() const { return nHit; }
+    /// number of new allocations (get() misses and prewarm)
+    size_t n_misses() const { return nAlloc; }
+    /// number of put() items deleted for full pool
+    size_t n_deleted() const { return nDeleted; }
+    /// fraction of get() requests served from pool
+    double reuse_ratio() const { size_t h = nHit, n = h + nAlloc; return n? double(h)/n : 0; }
+    /// high-water mark of items out of pool (get() minus put())
+    long n_peak_used() const { return peakOut; }
+
+protected:
+    /// stack slot
+    struct slot_t {
+        std::atomic<uint32_t> next{0};  ///< next slot index + 1 in stack (0 for none)
+        T* obj = nullptr;               ///< pooled object
+    };
+
+    /// push slot index i + 1 onto stack with head h (low 32 bits index, high 32 bits ABA tag)
+    void push(std::atomic<uint64_t>& h, uint32_t i) {
+        auto o = h.load(std::memory_order_relaxed);
+        uint64_t n;
+        do {
+            slots[i-1].next.store(uint32_t(o), std::memory_order_relaxed);
+            n = (((o >> 32) + 1) << 32) | i;
+        } while(!h.compare_exchange_weak(o, n, std::memory_order_release, std::memory_order_relaxed));
+    }
+    /// pop slot index + 1 from stack (0 if empty)
+    uint32_t pop(std::atomic<uint64_t>& h) {
+        auto o = h.load(std::memory_order_acquire);
+        while(true) {
+            uint32_t i = uint32_t(o);
+            if(!i) return 0;
+            uint64_t n = (((o >> 32) + 1) << 32) | slots[i-1].next.load(std::memory_order_relaxed);
+            if(h.compare_exchange_weak(o, n, std::memory_order_acq_rel, std::memory_order_acquire)) return i;
+        }
+    }
+
+    std::unique_ptr<slot_t[]> slots;    ///< storage slots
+    size_t nslots = 0;                  ///< number of slots
+    std::atomic<uint64_t> full{0};      ///< stack of slots holding pooled objects
+    std::atomic<uint64_t> empty{0};     ///< stack of available slots
+    std::atomic<size_t> nAlloc{0};      ///< total number of items allocated
+    std::atomic<size_t> nHit{0};        ///< total number of items re-used from pool
+    std::atomic<size_t> nDeleted{0};    ///< total number of returned items deleted for full pool
+    std::atomic<long> nOut{0};          ///< items currently out of pool
+    std::atomic<long> peakOut{0};       ///< high-water mark of nOut
+    MemTag* memTag = nullptr;           ///< optional accounting of pooled bytes
 };
 
 #endif
@@ -0,0 +1,326 @@
+/// \file BlockCompress.cc
+
+#include "BlockCompress.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <zlib.h>
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef WITH_LZ4
+#include <lz4.h>
+#endif
+
+bool codec_available(BlockCodec c) {
+    switch(c) {
+        case CODEC_NONE: return true;
+        case CODEC_ZLIB: return true;
+#ifdef WITH_ZSTD
+        case CODEC_ZSTD: return true;
+#endif
+#ifdef WITH_LZ4
+        case CODEC_LZ4: return true;
+#endif
+        default: return false;
+    }
+}
+
+BlockCodec codec_named(const std::string& s) {
+    BlockCodec c;
+    if(s == "none") c = CODEC_NONE;
+    else if(s == "zlib" || s == "gz") c = CODEC_ZLIB;
+    else if(s == "zstd") c = CODEC_ZSTD;
+    else if(s == "lz4") c = CODEC_LZ4;
+    else throw std::runtime_error("Unknown compression codec '" + s + "'");
+    if(!codec_available(c)) throw std::runtime_error("Compression codec '" + s + "' not enabled in this build");
+    return c;
+}
+
+void compress_block(const void* in, size_t n, vector<char>& out, BlockCodec c, int level) {
+    if(n > 0x7fffffff) throw std::logic_error("Compression block too large");
+    if(!codec_available(c)) throw std::runtime_error("Unavailable compression codec");
+
+    BlockHeader H;
+    H.codec = c;
+    H.usize = n;
+    H.crc = crc32(0, static_cast<const Bytef*>(in), n);
+
+    auto i0 = out.size();
+    size_t nmax = n;
+    if(c == CODEC_ZLIB) nmax = compressBound(n);
+#ifdef WITH_ZSTD
+    if(c == CODEC_ZSTD) nmax = ZSTD_compressBound(n);
+#endif
+#ifdef WITH_LZ4
+    if(c == CODEC_LZ4) nmax = LZ4_compressBound(n);
+#endif
+    out.resize(i0 + sizeof(H) + nmax);
+    auto dst = out.data() + i0 + sizeof(H);
+
+    size_t nc = n;
+    bool ok = true;
+    if(c == CODEC_ZLIB) {
+        uLongf _nc = nmax;
+        ok = compress2(reinterpret_cast<Bytef*>(dst), &_nc, static_cast<const Bytef*>(in), n, level < 0? Z_DEFAULT_COMPRESSION : level) == Z_OK;
+        nc = _nc;
+    }
+#ifdef WITH_ZSTD
+    if(c == CODEC_ZSTD) {
+        nc = ZSTD_compress(dst, nmax, in, n, level < 0? ZSTD_CLEVEL_DEFAULT : level);
+        ok = !ZSTD_isError(nc);
+    }
+#endif
+#ifdef WITH_LZ4
+    if(c == CODEC_LZ4) {
+        // level > 1 is lz4 "acceleration" (faster, less compression)
+        int r = LZ4_compress_fast(static_cast<const char*>(in), dst, n, nmax, level > 1? level : 1);
+        ok = r > 0;
+        nc = r;
+    }
+#endif
+    if(!ok) throw std::runtime_error("Block compression failed");
+
+    // store incompressible data as-is
+    if(c == CODEC_NONE || nc >= n) {
+        H.codec = CODEC_NONE;
+        nc = n;
+        if(n) memcpy(dst, in, n);
+    }
+    H.csize = nc;
+    memcpy(out.data() + i0, &H, sizeof(H));
+    out.resize(i0 + sizeof(H) + nc);
+}
+
+void decompress_block(const BlockHeader& H, const void* in, void* out) {
+    size_t nu = H.usize;
+    bool ok = true;
+    switch(H.codec) {
+        case CODEC_NONE:
+            ok = H.csize == H.usize;
+            if(ok && nu) memcpy(out, in, nu);
+            break;
+        case CODEC_ZLIB: {
+            uLongf _nu = nu;
+            ok = uncompress(static_cast<Bytef*>(out), &_nu, static_cast<const Bytef*>(in), H.csize) == Z_OK;
+            nu = _nu;
+        } break;
+#ifdef WITH_ZSTD
+        case CODEC_ZSTD:
+            nu = ZSTD_decompress(out, nu, in, H.csize);
+            ok = !ZSTD_isError(nu);
+            break;
+#endif
+#ifdef WITH_LZ4
+        case CODEC_LZ4:
+            nu = LZ4_decompress_safe(static_cast<const char*>(in), static_cast<char*>(out), H.csize, nu);
+            ok = int(nu) >= 0;
+            break;
+#endif
+        default:
+            throw std::runtime_error("Unavailable codec " + std::to_string(H.codec) + " for compressed block");
+    }
+    if(!ok || nu != H.usize) throw std::runtime_error("Corrupted compressed block");
+    if(crc32(0, static_cast<const Bytef*>(out), nu) != H.crc) throw std::runtime_error("Compressed block checksum mismatch");
+}
+
+/// pool for n worker threads (0 = all CPUs); none if single-threaded
+static WorkStealingPool* make_pool(unsigned int& n) {
+    if(!n) n = std::max(std::thread::hardware_concurrency(), 1U);
+    return n > 1? new WorkStealingPool(n) : nullptr;
+}
+
+//////////////////////////////////////////////////
+
+BlockCompressWriter::BlockCompressWriter(const sink_t& s, BlockCodec c, int lvl, size_t bsize, unsigned int nthreads):
+codec(c), level(lvl), blockSize(std::min(std::max(bsize, size_t(1)), size_t(1) << 30)), sink(s) {
+    if(!codec_available(c)) throw std::runtime_error("Unavailable compression codec");
+    pool.reset(make_pool(nthreads));
+    maxPending = 2*nthreads;
+    cur.reset(new job_t);
+}
+
+BlockCompressWriter::~BlockCompressWriter() {
+    if(!closed) try { close(); } catch(...) { }
+    pool.reset(); // complete any tasks referencing this
+}
+
+void BlockCompressWriter::write(const void* d, size_t n) {
+    if(closed) throw std::logic_error("Write to closed compression stream");
+    auto p = static_cast<const char*>(d);
+    nIn += n;
+    while(n) {
+        if(!cur->in.capacity()) cur->in.reserve(blockSize);
+        auto m = std::min(n, blockSize - cur->in.size());
+        cur->in.insert(cur->in.end(), p, p + m);
+        p += m;
+        n -= m;
+        if(cur->in.size() == blockSize) submit();
+    }
+}
+
+void BlockCompressWriter::submit() {
+    std::shared_ptr<job_t> j(cur.release());
+    cur.reset(new job_t);
+    auto f = [this, j] {
+        try { compress_block(j->in.data(), j->in.size(), j->out, codec, level); }
+        catch(...) { j->err = std::current_exception(); }
+        vector<char>().swap(j->in);
+        std::lock_guard<std::mutex> l(jMut);
+        j->done = true;
+        jDone.notify_all();
+    };
+    pending.push_back(j);
+    if(pool) pool->submit(f);
+    else f();
+    while(pending.size() > maxPending) emit();
+}
+
+void BlockCompressWriter::emit() {
+    auto j = pending.front();
+    {
+        std::unique_lock<std::mutex> l(jMut);
+        jDone.wait(l, [&j] { return j->done; });
+    }
+    pending.pop_front();
+    if(j->err) std::rethrow_exception(j->err);
+    sink(j->out.data(), j->out.size());
+    nOut += j->out.size();
+}
+
+void BlockCompressWriter::flush() {
+    if(cur->in.size()) submit();
+    while(pending.size()) emit();
+}
+
+void BlockCompressWriter::close() {
+    if(closed) return;
+    flush();
+    BlockHeader H;
+    sink(reinterpret_cast<const char*>(&H), sizeof(H));
+    nOut += sizeof(H);
+    closed = true;
+}
+
+//////////////////////////////////////////////////
+
+BlockDecompressReader::BlockDecompressReader(const source_t& s, unsigned int nthreads, size_t readahead): source(s) {
+    pool.reset(make_pool(nthreads));
+    maxPending = readahead? readahead : 2*nthreads;
+}
+
+BlockDecompressReader::~BlockDecompressReader() { pool.reset(); }
+
+void BlockDecompressReader::fill() {
+    while(!srcEnd && pending.size() < maxPending) {
+        std::shared_ptr<job_t> j(new job_t);
+        source(reinterpret_cast<char*>(&j->H), sizeof(j->H));
+        if(!j->H.valid()) throw std::runtime_error("Invalid compressed block header");
+        if(j->H.isEnd()) { srcEnd = true; break; }
+        j->in.resize(j->H.csize);
+        source(j->in.data(), j->in.size());
+
+        auto f = [this, j] {
+            try {
+                j->out.resize(j->H.usize);
+                decompress_block(j->H, j->in.data(), j->out.data());
+            } catch(...) { j->err = std::current_exception(); }
+            vector<char>().swap(j->in);
+            std::lock_guard<std::mutex> l(jMut);
+            j->done = true;
+            jDone.notify_all();
+        };
+        pending.push_back(j);
+        if(pool) pool->submit(f);
+        else f();
+    }
+}
+
+bool BlockDecompressReader::next_block() {
+    cur.reset();
+    rpos = 0;
+    fill();
+    if(!pending.size()) return false;
+    auto j = pending.front();
+    {
+        std::unique_lock<std::mutex> l(jMut);
+        jDone.wait(l, [&j] { return j->done; });
+    }
+    pending.pop_front();
+    if(j->err) std::rethrow_exception(j->err);
+    cur = j;
+    fill();
+    return true;
+}
+
+size_t BlockDecompressReader::read(void* d, size_t n) {
+    auto p = static_cast<char*>(d);
+    size_t nr = 0;
+    while(n) {
+        if(!cur || rpos == cur->out.size()) if(!next_block()) break;
+        auto m = std::min(n, cur->out.size() - rpos);
+        memcpy(p, cur->out.data() + rpos, m);
+        rpos += m;
+        p += m;
+        n -= m;
+        nr += m;
+    }
+    nOut += nr;
+    return nr;
+}
+
+bool BlockDecompressReader::atEnd() {
+    if(cur && rpos < cur->out.size()) return false;
+    return !next_block();
+}
+
+//////////////////////////////////////////////////
+
+vector<char> block_compress(const void* in, size_t n, BlockCodec c, int level, size_t bsize, unsigned int nthreads) {
+    vector<char> v;
+    BlockCompressWriter W([&v](const char* d, size_t m) { v.insert(v.end(), d, d + m); }, c, level, bsize, nthreads);
+    W.write(in, n);
+    W.close();
+    return v;
+}
+
+vector<char> block_decompress(const void* in, size_t n, unsigned int nthreads) {
+    // locate blocks, then decompress in place
+    auto p = static_cast<const char*>(in);
+    auto e = p + n;
+    vector<std::pair<const char*, size_t>> blocks;  // (header, output position)
+    size_t nu = 0;
+    while(true) {
+        BlockHeader H;
+        if(p + sizeof(H) > e) throw std::runtime_error("Truncated compressed data");
+        memcpy(&H, p, sizeof(H));
+        if(!H.valid()) throw std::runtime_error("Invalid compressed block header");
+        if(H.isEnd()) break;
+        if(p + sizeof(H) + H.csize > e) throw std::runtime_error("Truncated compressed data");
+        blocks.emplace_back(p, nu);
+        nu += H.usize;
+        p += sizeof(H) + H.csize;
+    }
+
+    vector<char> v(nu);
+    auto f = [&v](const char* b, size_t i) {
+        BlockHeader H;
+        memcpy(&H, b, sizeof(H));
+        decompress_block(H, b + sizeof(H), v.data() + i);
+    };
+    std::unique_ptr<WorkStealingPool> P(make_pool(nthreads));
+    if(!P) for(auto& b: blocks) f(b.first, b.second);
+    else {
+        std::exception_ptr err;
+        std::mutex m;
+        for(auto& b: blocks) P->submit([&f, &err, &m, b] {
+            try { f(b.first, b.second); }
+            catch(...) { std::lock_guard<std::mutex> l(m); err = std::current_exception(); }
+        });
+        P->wait_idle();
+        if(err) std::rethrow_exception(err);
+    }
+    return v;
+}
@@ -0,0 +1,165 @@
+/// \file BlockCompress.hh Chunked streaming compression, with parallel (pigz-style) block compression/decompression
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef BLOCKCOMPRESS_HH
+#define BLOCKCOMPRESS_HH
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+using std::vector;
+
+class WorkStealingPool;
+
+/// compression codec for block streams
+enum BlockCodec: uint8_t {
+    CODEC_NONE = 0, ///< uncompressed (checksummed) blocks
+    CODEC_ZLIB = 1, ///< zlib deflate
+    CODEC_ZSTD = 2, ///< zstd (build option WITH_ZSTD)
+    CODEC_LZ4  = 3  ///< lz4 (build option WITH_LZ4)
+};
+
+/// whether codec is available in this build
+bool codec_available(BlockCodec c);
+/// codec by name "none", "zlib", "zstd", "lz4"; throws std::runtime_error if unknown or unavailable
+BlockCodec codec_named(const std::string& s);
+
+/// Header preceding each compressed block in stream; all-zero sizes mark end of stream
+struct BlockHeader {
+    char magic[3] = {'M', 'P', 'Z'};    ///< block identifier
+    uint8_t codec = CODEC_NONE;         ///< block codec
+    uint32_t usize = 0;                 ///< uncompressed size
+    uint32_t csize = 0;                 ///< compressed size following header
+    uint32_t crc = 0;                   ///< crc32 of uncompressed data
+
+    /// check header identifier
+    bool valid() const { return magic[0] == 'M' && magic[1] == 'P' && magic[2] == 'Z'; }
+    /// check for end-of-stream marker
+    bool isEnd() const { return !usize && !csize; }
+};
+static_assert(sizeof(BlockHeader) == 16, "BlockHeader layout");
+
+/// compress one independent block, appending header and data to out
+void compress_block(const void* in, size_t n, vector<char>& out, BlockCodec c = CODEC_ZLIB, int level = -1);
+/// decompress block data (following header H) into out[H.usize]; throws std::runtime_error on corruption
+void decompress_block(const BlockHeader& H, const void* in, void* out);
+
+/// Streaming writer: buffers input into blocks, compressed in parallel and written in order to sink
+class BlockCompressWriter {
+public:
+    /// output sink for compressed data
+    typedef std::function<void(const char*, size_t)> sink_t;
+
+    /// Constructor, with codec, compression level (-1 for codec default), block size (max. 1 GiB), and compression threads (0 for all CPUs)
+    explicit BlockCompressWriter(const sink_t& s, BlockCodec c = CODEC_ZLIB, int lvl = -1, size_t bsize = 1 << 20, unsigned int nthreads = 0);
+    /// Destructor, finishing stream (if not already closed)
+    ~BlockCompressWriter();
+    /// no copy
+    BlockCompressWriter(const BlockCompressWriter&) = delete;
+    /// no assignment
+    BlockCompressWriter& operator=(const BlockCompressWriter&) = delete;
+
+    /// add data to stream
+    void write(const void* d, size_t n);
+    /// compress partial block and write all pending output
+    void flush();
+    /// flush and write end-of-stream marker
+    void close();
+
+    /// total uncompressed bytes written
+    size_t n_in() const { return nIn; }
+    /// total compressed bytes output
+    size_t n_out() const { return nOut; }
+
+    const BlockCodec codec;     ///< compression codec
+    const int level;            ///< compression level
+    const size_t blockSize;     ///< uncompressed block size
+
+protected:
+    /// block being compressed
+    struct job_t {
+        vector<char> in;            ///< uncompressed data
+        vector<char> out;           ///< compressed block
+        bool done = false;          ///< completion flag, with jMut
+        std::exception_ptr err;     ///< compression failure
+    };
+
+    /// submit current block for compression
+    void submit();
+    /// wait for oldest pending block and write it
+    void emit();
+
+    sink_t sink;                                ///< compressed output
+    std::unique_ptr<WorkStealingPool> pool;     ///< compression threads (none for single-threaded)
+    size_t maxPending;                          ///< maximum blocks in flight
+    std::unique_ptr<job_t> cur;                 ///< block being filled
+    std::deque<std::shared_ptr<job_t>> pending; ///< blocks in compression, in output order
+    std::mutex jMut;                            ///< lock on job completion
+    std::condition_variable jDone;              ///< job completion notification
+    size_t nIn = 0;                             ///< uncompressed bytes
+    size_t nOut = 0;                            ///< compressed bytes
+    bool closed = false;                        ///< whether end-of-stream written
+};
+
+/// Streaming reader: reads ahead and decompresses blocks in parallel, returning data in order
+class BlockDecompressReader {
+public:
+    /// input source for exactly n compressed bytes (throws on failure)
+    typedef std::function<void(char*, size_t)> source_t;
+
+    /// Constructor, with decompression threads (0 for all CPUs) and number of blocks to read ahead (0 for 2 per thread)
+    explicit BlockDecompressReader(const source_t& s, unsigned int nthreads = 0, size_t readahead = 0);
+    /// Destructor
+    ~BlockDecompressReader();
+    /// no copy
+    BlockDecompressReader(const BlockDecompressReader&) = delete;
+    /// no assignment
+    BlockDecompressReader& operator=(const BlockDecompressReader&) = delete;
+
+    /// read up to n bytes; return number read (less than n only at end of stream)
+    size_t read(void* d, size_t n);
+    /// whether end of stream reached
+    bool atEnd();
+
+    /// total uncompressed bytes read
+    size_t n_out() const { return nOut; }
+
+protected:
+    /// block being decompressed
+    struct job_t {
+        BlockHeader H;              ///< block header
+        vector<char> in;            ///< compressed data
+        vector<char> out;           ///< decompressed data
+        bool done = false;          ///< completion flag, with jMut
+        std::exception_ptr err;     ///< decompression failure
+    };
+
+    /// read and submit blocks up to read-ahead limit
+    void fill();
+    /// get next decompressed block into cur; return false at end of stream
+    bool next_block();
+
+    source_t source;                            ///< compressed input
+    std::unique_ptr<WorkStealingPool> pool;     ///< decompression threads
+    size_t maxPending;                          ///< read-ahead limit
+    std::deque<std::shared_ptr<job_t>> pending; ///< blocks in decompression, in stream order
+    std::shared_ptr<job_t> cur;                 ///< current output block
+    size_t rpos = 0;                            ///< read position in cur
+    std::mutex jMut;                            ///< lock on job completion
+    std::condition_variable jDone;              ///< job completion notification
+    size_t nOut = 0;                            ///< uncompressed bytes returned
+    bool srcEnd = false;                        ///< whether end-of-stream marker read
+};
+
+/// parallel compression of in-memory buffer to block stream
+vector<char> block_compress(const void* in, size_t n, BlockCodec c = CODEC_ZLIB, int level = -1, size_t bsize = 1 << 20, unsigned int nthreads = 0);
+/// parallel decompression of in-memory block stream
+vector<char> block_decompress(const void* in, size_t n, unsigned int nthreads = 0);
+
+#endif
@@ -0,0 +1,139 @@
+/// \file BucketQueue.hh "Calendar queue" priority queue for items with bounded ordering spread
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef BUCKETQUEUE_HH
+#define BUCKETQUEUE_HH
+
+#include "deref_if_ptr.hh"
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+/// bucket number floor(t/w) for integer types
+template<typename U>
+typename std::enable_if<std::is_integral<U>::value, long long>::type
+bucket_floordiv(U t, U w) {
+    long long k = t/w;
+    if(t % w && ((t < 0) != (w < 0))) --k;
+    return k;
+}
+
+/// bucket number floor(t/w) for floating-point types
+template<typename U>
+typename std::enable_if<!std::is_integral<U>::value, long long>::type
+bucket_floordiv(U t, U w) {
+    auto q = t/w;
+    long long k = q;
+    if(k > q) --k;
+    return k;
+}
+
+/// "Calendar queue" of items sorted into buckets of fixed ordering-parameter width
+/// amortized O(1) push and pop (earliest first) when item spread is bounded in a few buckets' range
+template<typename T, typename ordering_t = typename std::remove_pointer<T>::type::ordering_t>
+class BucketQueue {
+public:
+    /// Constructor, with bucket width and initial number of buckets
+    explicit BucketQueue(ordering_t w = 1, size_t nb = 1024) { setup(w, nb); }
+
+    /// set bucket width and initial number of buckets (rounded up to power of 2); only when empty
+    void setup(ordering_t w, size_t nb = 1024) {
+        if(n) throw std::logic_error("BucketQueue setup with items in queue");
+        if(!(w > 0)) throw std::runtime_error("BucketQueue requires positive bucket width");
+        width = w;
+        size_t c = 1;
+        while(c < nb) c <<= 1;
+        buckets.clear();
+        buckets.resize(c);
+    }
+
+    /// bucket width
+    ordering_t bucket_width() const { return width; }
+    /// number of buckets
+    size_t n_buckets() const { return buckets.size(); }
+    /// number of items in queue
+    size_t size() const { return n; }
+    /// check if queue is empty
+    bool empty() const { return !n; }
+
+    /// add item to queue
+    void push(const T& o) { bucket_for(o).push_back(o); }
+    /// move item into queue
+    void push(T&& o) { bucket_for(o).push_back(std::move(o)); }
+
+    /// earliest item (requires non-empty queue)
+    T& top() {
+        auto& B = current();
+        if(!B.sorted) {
+            std::sort(B.v.begin(), B.v.end(), reverse_ordering_deref<T, ordering_t>());
+            B.sorted = true;
+        }
+        return B.v.back();
+    }
+
+    /// remove earliest item (requires non-empty queue)
+    void pop() {
+        top();
+        current().v.pop_back();
+        --n;
+    }
+
+    size_t max_buckets = 1 << 22;   ///< limit on bucket array growth
+
+protected:
+    /// contents of one bucket
+    struct bucket_t {
+        vector<T> v;        ///< items in bucket
+        bool sorted = true; ///< whether v is sorted latest to earliest
+    };
+
+    /// locate (expanding range as needed) and count new item's bucket contents
+    vector<T>& bucket_for(const T& o) {
+        auto k = bucket_floordiv(ordering_t(deref_if_ptr(o)), width);
+        if(!n) b0 = b1 = k;
+        else {
+            auto k0 = std::min(k, b0);
+            auto k1 = std::max(k, b1);
+            while(size_t(k1 - k0) >= buckets.size()) grow(k1 - k0 + 1);
+            b0 = k0;
+            b1 = k1;
+        }
+        auto& B = buckets[k & (buckets.size() - 1)];
+        if(B.sorted && B.v.size() && ordering_t(deref_if_ptr(B.v.back())) < ordering_t(deref_if_ptr(o))) B.sorted = false;
+        ++n;
+        return B.v;
+    }
+
+    /// lowest non-empty bucket
+    bucket_t& current() {
+        while(buckets[b0 & (buckets.size() - 1)].v.empty()) ++b0;
+        return buckets[b0 & (buckets.size() - 1)];
+    }
+
+    /// expand buckets array to hold at least nb-bucket range
+    void grow(size_t nb) {
+        size_t c = 2*buckets.size();
+        while(c < nb) c <<= 1;
+        if(c > max_buckets) throw std::runtime_error("BucketQueue range exceeds max_buckets: increase bucket width");
+
+        vector<bucket_t> old(c);
+        std::swap(old, buckets);
+        for(auto& B: old) {
+            for(auto& o: B.v) {
+                auto& B2 = buckets[bucket_floordiv(ordering_t(deref_if_ptr(o)), width) & (c - 1)];
+                B2.v.push_back(std::move(o));
+                B2.sorted = false;
+            }
+        }
+    }
+
+    ordering_t width = 1;       ///< bucket width
+    vector<bucket_t> buckets;   ///< circular array of buckets
+    long long b0 = 0;           ///< lowest possibly-occupied bucket number
+    long long b1 = 0;           ///< highest possibly-occupied bucket number
+    size_t n = 0;               ///< number of items in queue
+};
+
+#endif
@@ -0,0 +1,101 @@
+/// \file ConcurrentHistogram.cc
+
+#include "ConcurrentHistogram.hh"
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+constexpr int64_t SparseBinTable::EMPTY;
+
+SparseBinTable::SparseBinTable(size_t n) {
+    size_t m = 16;
+    while(m < n) m *= 2;
+    keys.assign(m, EMPTY);
+    bins.resize(m);
+}
+
+void SparseBinTable::clear() {
+    if(!nbins) return;
+    std::fill(keys.begin(), keys.end(), EMPTY);
+    std::fill(bins.begin(), bins.end(), DHBinData());
+    nbins = 0;
+}
+
+void SparseBinTable::grow() {
+    SparseBinTable T(2*keys.size());
+    for(size_t j = 0; j < keys.size(); ++j) if(keys[j] != EMPTY) T.add(keys[j], bins[j]);
+    std::swap(keys, T.keys);
+    std::swap(bins, T.bins);
+}
+
+void SparseBinTable::mergeInto(DynamicHistogram& h) const {
+    vector<std::pair<int64_t, size_t>> v;
+    v.reserve(nbins);
+    for(size_t j = 0; j < keys.size(); ++j) if(keys[j] != EMPTY) v.emplace_back(keys[j], j);
+    std::sort(v.begin(), v.end());
+    for(auto& kj: v) h.fill(bins[kj.second]);
+}
+
+//////////////////////////////////////////////////
+
+/// calling thread's staging buffers, by filler id
+static thread_local vector<std::pair<size_t, void*>> myStages;
+
+ConcurrentHistogramFill::ConcurrentHistogramFill(DynamicHistogram& h, size_t nstage):
+target(h), nStage(std::max(nstage, size_t(1))), sparse(dynamic_cast<const SparseHistogram*>(&h)) {
+    static std::atomic<size_t> nextId{0};
+    id = nextId++;
+}
+
+ConcurrentHistogramFill::~ConcurrentHistogramFill() {
+    flush();
+    for(auto s: stages) delete s;
+}
+
+ConcurrentHistogramFill::stage_t& ConcurrentHistogramFill::local() {
+    for(auto& p: myStages) if(p.first == id) return *static_cast<stage_t*>(p.second);
+
+    auto s = new stage_t;
+    if(!sparse) s->pts.reserve(nStage);
+    {
+        std::lock_guard<std::mutex> l(M);
+        stages.push_back(s);
+    }
+    myStages.emplace_back(id, s);
+    return *s;
+}
+
+void ConcurrentHistogramFill::fill(double x, double w) {
+    auto& s = local();
+    if(sparse) {
+        s.bins.add(int64_t(round((x - sparse->x0)/sparse->dx)), DHBinData(x, w));
+        if(s.bins.size() >= nStage) flush_thread();
+    } else {
+        s.pts.emplace_back(x, w);
+        if(s.pts.size() >= nStage) flush_thread();
+    }
+}
+
+void ConcurrentHistogramFill::merge(stage_t& s) {
+    if(sparse) {
+        if(!s.bins.size()) return;
+        s.bins.mergeInto(target);
+        s.bins.clear();
+    } else {
+        if(!s.pts.size()) return;
+        for(auto& d: s.pts) target.fill(d);
+        s.pts.clear();
+    }
+    ++nMerge;
+}
+
+void ConcurrentHistogramFill::flush_thread() {
+    auto& s = local();
+    std::lock_guard<std::mutex> l(M);
+    merge(s);
+}
+
+void ConcurrentHistogramFill::flush() {
+    std::lock_guard<std::mutex> l(M);
+    for(auto s: stages) merge(*s);
+}
@@ -0,0 +1,99 @@
+/// \file ConcurrentHistogram.hh Thread-safe DynamicHistogram filling through per-thread staging buffers
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef CONCURRENTHISTOGRAM_HH
+#define CONCURRENTHISTOGRAM_HH
+
+#include "DynamicHistogram.hh"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+using std::vector;
+
+/// Open-addressing (linear probe) hash table of sparse histogram bins by bin number
+class SparseBinTable {
+public:
+    /// Constructor, with initial capacity (rounded up to power of 2)
+    explicit SparseBinTable(size_t n = 256);
+
+    /// add data to bin i
+    void add(int64_t i, const DHBinData& d) {
+        auto j = slot(i);
+        if(keys[j] == EMPTY) {
+            if(4*(nbins + 1) > 3*keys.size()) { grow(); j = slot(i); }
+            keys[j] = i;
+            ++nbins;
+        }
+        bins[j] += d;
+    }
+    /// number of occupied bins
+    size_t size() const { return nbins; }
+    /// remove all bins
+    void clear();
+    /// add all bins to histogram (in bin order)
+    void mergeInto(DynamicHistogram& h) const;
+
+protected:
+    static constexpr int64_t EMPTY = INT64_MIN; ///< unoccupied key marker
+
+    /// find slot holding i, or empty slot where i belongs
+    size_t slot(int64_t i) const {
+        size_t m = keys.size() - 1;
+        size_t j = (uint64_t(i) * 0x9E3779B97F4A7C15ULL) >> 32 & m;
+        while(keys[j] != EMPTY && keys[j] != i) j = (j + 1) & m;
+        return j;
+    }
+    /// double capacity
+    void grow();
+
+    vector<int64_t> keys;   ///< bin number in each slot
+    vector<DHBinData> bins; ///< bin contents in each slot
+    size_t nbins = 0;       ///< number of occupied slots
+};
+
+/// Thread-safe filling of a DynamicHistogram: points staged per thread, merged into target under lock
+/// (SparseHistogram targets are staged as per-thread hashed bins; others as raw points)
+class ConcurrentHistogramFill {
+public:
+    /// Constructor, with per-thread staging size (points, or bins for SparseHistogram) between merges
+    explicit ConcurrentHistogramFill(DynamicHistogram& h, size_t nstage = 1 << 14);
+    /// Destructor, merging all staged data
+    ~ConcurrentHistogramFill();
+    /// no copy
+    ConcurrentHistogramFill(const ConcurrentHistogramFill&) = delete;
+    /// no assignment
+    ConcurrentHistogramFill& operator=(const ConcurrentHistogramFill&) = delete;
+
+    /// fill data point (thread-safe)
+    void fill(double x, double w = 1);
+    /// merge calling thread's staged data into target
+    void flush_thread();
+    /// merge all threads' staged data into target; call when no fills in progress, before reading target
+    void flush();
+
+    /// number of staging merges into target
+    size_t n_merges() const { return nMerge; }
+
+    DynamicHistogram& target;   ///< histogram being filled
+    const size_t nStage;        ///< staging size before merge
+
+protected:
+    /// one thread's staged data
+    struct stage_t {
+        vector<DHBinData> pts;  ///< staged points (generic histogram)
+        SparseBinTable bins;    ///< staged bins (SparseHistogram)
+    };
+
+    /// get calling thread's staging buffer
+    stage_t& local();
+    /// merge staging into target
+    void merge(stage_t& s);
+
+    const SparseHistogram* sparse;  ///< target as SparseHistogram, if applicable
+    size_t id;                      ///< unique identifier for thread-local lookup
+    std::mutex M;                   ///< lock on target and stages list
+    vector<stage_t*> stages;        ///< all threads' staging
+    size_t nMerge = 0;              ///< number of merges
+};
+
+#endif
@@ -7,7 +7,10 @@
 #include <algorithm>
 #include <stdexcept>
 #include <stdio.h>
+#include <stdint.h>
 #include <cassert>
+#include <vector>
+using std::vector;
 
 /// Binary decision tree construction and application
 class DecisionTree {
@@ -24,6 +27,8 @@ public:
     void display(size_t i=0, size_t d=0) const;
 
 protected:
+    template<typename T>
+    friend class CompiledDecisionTree;
 
     /// decision tree node
     struct decision_t {
@@ -131,4 +136,174 @@ inline void DecisionTree::display(size_t i, size_t d) const {
     } else display(i+1, dcs[d].b);
 }
 
+/// DecisionTree (or several trees) compiled to flat node arrays for threshold tests x[feature] < threshold.
+/// Leaves loop to themselves, so every query takes the same number of branchless steps;
+/// batches advance `lanes` independent queries in lock-step for vectorization/memory-level parallelism.
+template<typename T = double>
+class CompiledDecisionTree {
+public:
+    /// node ordering in memory
+    enum layout_t {
+        BREADTH_FIRST,  ///< level by level
+        VAN_EMDE_BOAS   ///< recursive half-height blocks, cache-oblivious for deep trees
+    };
+    /// number of queries evaluated in lock-step
+    static constexpr size_t lanes = 8;
+
+    /// compile tree, where test t is x[feature[t]] < threshold[t]; return tree number
+    size_t add(const DecisionTree& D, const vector<uint32_t>& feature, const vector<T>& threshold, layout_t L = BREADTH_FIRST);
+
+    /// number of compiled trees
+    size_t ntrees() const { return roots.size(); }
+    /// maximum depth of tree k
+    size_t depth(size_t k = 0) const { return depths.at(k); }
+    /// number of nodes (all trees)
+    size_t nnodes() const { return nodes.size(); }
+
+    /// categorize one feature vector x[] with tree k
+    size_t decide(const T* x, size_t k = 0) const {
+        auto n = roots[k];
+        for(size_t d = depths[k]; d; --d) {
+            auto& N = nodes[n];
+            n = N.child[x[N.feature] < N.threshold];
+        }
+        return nodes[n].value;
+    }
+
+    /// categorize n items in structure-of-arrays features x[feature][i] with tree k, into out[i]
+    void decide(const T* const* x, size_t n, size_t* out, size_t k = 0) const {
+        const auto r = roots[k];
+        const auto dk = depths[k];
+        size_t i = 0;
+        for(; i + lanes <= n; i += lanes) {
+            uint32_t nd[lanes];
+            for(size_t j = 0; j < lanes; ++j) nd[j] = r;
+            for(size_t d = 0; d < dk; ++d) {
+                for(size_t j = 0; j < lanes; ++j) {
+                    auto& N = nodes[nd[j]];
+                    nd[j] = N.child[x[N.feature][i+j] < N.threshold];
+                }
+            }
+            for(size_t j = 0; j < lanes; ++j) out[i+j] = nodes[nd[j]].value;
+        }
+        for(; i < n; ++i) {
+            auto nd = r;
+            for(size_t d = 0; d < dk; ++d) {
+                auto& N = nodes[nd];
+                nd = N.child[x[N.feature][i] < N.threshold];
+            }
+            out[i] = nodes[nd].value;
+        }
+    }
+
+    /// categorize feature vector x[] with all trees in lock-step, into out[tree]
+    void decideAll(const T* x, size_t* out) const {
+        vector<uint32_t> nd(roots);
+        for(size_t d = 0; d < maxdepth; ++d) {
+            for(size_t j = 0; j < nd.size(); ++j) {
+                auto& N = nodes[nd[j]];
+                nd[j] = N.child[x[N.feature] < N.threshold];
+            }
+        }
+        for(size_t j = 0; j < nd.size(); ++j) out[j] = nodes[nd[j]].value;
+    }
+
+protected:
+    /// flattened node
+    struct node_t {
+        T threshold{};          ///< test threshold
+        uint32_t feature = 0;   ///< test feature index
+        uint32_t child[2]{};    ///< next node if test {false, true}; self for leaf
+        uint32_t value = 0;     ///< leaf categorization
+    };
+
+    vector<node_t> nodes;       ///< all trees' nodes
+    vector<uint32_t> roots;     ///< root node of each tree
+    vector<size_t> depths;      ///< maximum depth of each tree
+    size_t maxdepth = 0;        ///< maximum depth of all trees
+
+    /// tree node before layout, with children indices -1 for leaf
+    struct pnode_t {
+        node_t n;               ///< node contents (children in pre-layout numbering)
+        size_t depth = 0;       ///< depth from root
+        bool leaf = false;      ///< whether this is a leaf
+    };
+
+    /// collect nodes at depth d below (pre-layout) node r
+    static void frontier(const vector<pnode_t>& P, uint32_t r, size_t d, vector<uint32_t>& v) {
+        if(!d) { v.push_back(r); return; }
+        if(P[r].leaf) return;
+        frontier(P, P[r].n.child[1], d - 1, v);
+        frontier(P, P[r].n.child[0], d - 1, v);
+    }
+    /// van Emde Boas order of subtree r truncated to height h
+    static void veb(const vector<pnode_t>& P, uint32_t r, size_t h, vector<uint32_t>& order) {
+        if(h <= 1 || P[r].leaf) { order.push_back(r); return; }
+        auto ht = h - h/2;
+        veb(P, r, ht, order);
+        vector<uint32_t> f;
+        frontier(P, r, ht, f);
+        for(auto b: f) veb(P, b, h - ht, order);
+    }
+};
+
+template<typename T>
+constexpr size_t CompiledDecisionTree<T>::lanes;
+
+template<typename T>
+size_t CompiledDecisionTree<T>::add(const DecisionTree& D, const vector<uint32_t>& feature, const vector<T>& threshold, layout_t L) {
+    if(feature.size() != threshold.size()) throw std::logic_error("Mismatched decision tree test features and thresholds");
+
+    // unpack decision structure into explicit nodes, breadth-first
+    vector<pnode_t> P;
+    struct pending_t { size_t d; size_t halt; size_t depth; };  // DecisionTree node d, or leaf halt value if d == -1
+    vector<pending_t> q;
+    auto& dcs = D.dcs;
+    if(dcs.size() < 2) q.push_back({size_t(-1), 0, 0});
+    else q.push_back({dcs[0].a, 0, 0});
+    for(size_t j = 0; j < q.size(); ++j) {
+        auto p = q[j];
+        pnode_t n;
+        n.depth = p.depth;
+        if(p.d == size_t(-1)) {
+            n.leaf = true;
+            n.n.value = p.halt;
+            n.n.child[0] = n.n.child[1] = j;
+        } else {
+            auto& c = dcs[p.d];
+            if(c.t >= feature.size()) throw std::logic_error("Decision tree test without compiled feature");
+            n.n.feature = feature[c.t];
+            n.n.threshold = threshold[c.t];
+            n.n.child[1] = q.size();
+            q.push_back(c.a == p.d? pending_t{size_t(-1), dcs[p.d-1].i, p.depth + 1} : pending_t{c.a, 0, p.depth + 1});
+            n.n.child[0] = q.size();
+            q.push_back(c.b == p.d? pending_t{size_t(-1), c.i, p.depth + 1} : pending_t{c.b, 0, p.depth + 1});
+        }
+        P.push_back(n);
+    }
+    size_t dmax = 0;
+    for(auto& n: P) dmax = std::max(dmax, n.depth);
+
+    // memory order
+    vector<uint32_t> order;
+    if(L == VAN_EMDE_BOAS) veb(P, 0, dmax + 1, order);
+    else for(size_t j = 0; j < P.size(); ++j) order.push_back(j);
+    if(order.size() != P.size()) throw std::logic_error("Incomplete decision tree layout");
+
+    const uint32_t n0 = nodes.size();
+    vector<uint32_t> pos(P.size());
+    for(size_t j = 0; j < order.size(); ++j) pos[order[j]] = n0 + j;
+    for(auto j: order) {
+        auto n = P[j].n;
+        n.child[0] = pos[n.child[0]];
+        n.child[1] = pos[n.child[1]];
+        nodes.push_back(n);
+    }
+
+    roots.push_back(pos[0]);
+    depths.push_back(dmax);
+    maxdepth = std::max(maxdepth, dmax);
+    return roots.size() - 1;
+}
+
 #endif
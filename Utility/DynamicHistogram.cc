@@ -8,8 +8,8 @@ void DHBinData::operator+=(const DHBinData& r) {
     w += r.w;
 }
 
-void DynamicHistogram::fill(double x, double w) {
-    DHBinData d(x,w);
+void DynamicHistogram::fill(const DHBinData& d0) {
+    auto d = d0;
     total += d;
 
     if(!dat.size()) {
@@ -38,7 +38,11 @@ public:
     virtual ~DynamicHistogram() { }
 
     /// fill new data point
-    void fill(double x, double w=1);
+    void fill(double x, double w=1) { fill(DHBinData(x,w)); }
+    /// fill pre-summed data (e.g. staged points in same bin)
+    void fill(const DHBinData& d);
+    /// add contents of another histogram
+    void merge(const DynamicHistogram& h) { for(auto const& kv: h.dat) fill(kv.second); }
     /// get data
     const map<double,DHBinData>& getData() const { return dat; }
     /// get bin with maximum weight
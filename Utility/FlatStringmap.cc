@@ -0,0 +1,171 @@
+/// \file FlatStringmap.cc
+
+#include "FlatStringmap.hh"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+
+/// symbol table lock
+static std::mutex& symbols_mutex() {
+    static std::mutex m;
+    return m;
+}
+/// symbol names by ID (deque: stable references)
+static std::deque<string>& symbols_names() {
+    static std::deque<string> v;
+    return v;
+}
+/// symbol IDs by name
+static std::unordered_map<string, uint32_t>& symbols_ids() {
+    static std::unordered_map<string, uint32_t> m;
+    return m;
+}
+
+uint32_t StringSymbols::intern(const char* s, size_t n) {
+    string k(s, n);
+    std::lock_guard<std::mutex> l(symbols_mutex());
+    auto& M = symbols_ids();
+    auto it = M.find(k);
+    if(it != M.end()) return it->second;
+    auto& v = symbols_names();
+    M.emplace(k, uint32_t(v.size()));
+    v.push_back(k);
+    return v.size() - 1;
+}
+
+uint32_t StringSymbols::find(const string& s) {
+    std::lock_guard<std::mutex> l(symbols_mutex());
+    auto it = symbols_ids().find(s);
+    return it == symbols_ids().end()? NONE : it->second;
+}
+
+const string& StringSymbols::name(uint32_t i) {
+    std::lock_guard<std::mutex> l(symbols_mutex());
+    return symbols_names().at(i);
+}
+
+size_t StringSymbols::size() {
+    std::lock_guard<std::mutex> l(symbols_mutex());
+    return symbols_names().size();
+}
+
+//////////////////////
+
+/// whitespace stripped by Stringmap parsing
+static bool isStripped(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+FlatStringmap::FlatStringmap(const Stringmap& m) {
+    size_t n = 0;
+    for(auto& kv: m) n += kv.second.size();
+    own.reserve(n);
+    entries.reserve(m.size());
+    for(auto& kv: m) append(StringSymbols::intern(kv.first), kv.second.data(), kv.second.size(), false);
+    std::sort(entries.begin(), entries.end());
+}
+
+FlatStringmap::FlatStringmap(const char* s, size_t n, bool zerocopy) {
+    if(zerocopy) extbuf = s;
+    else own.reserve(n);
+
+    // same splitting as Stringmap: tab-separated fields of exactly two non-empty '='-separated words
+    const char* e = s + n;
+    while(s < e) {
+        const char* f1 = static_cast<const char*>(memchr(s, '\t', e - s));
+        if(!f1) f1 = e;
+        const char* w[2][2];
+        int nw = 0;
+        for(auto p = s; p < f1 && nw <= 2;) {
+            while(p < f1 && *p == '=') ++p;
+            if(p == f1) break;
+            auto q = p;
+            while(q < f1 && *q != '=') ++q;
+            if(nw < 2) { w[nw][0] = p; w[nw][1] = q; }
+            ++nw;
+            p = q;
+        }
+        if(nw == 2) {
+            for(auto& x: w) {
+                while(x[0] < x[1] && isStripped(*x[0])) ++x[0];
+                while(x[1] > x[0] && isStripped(x[1][-1])) --x[1];
+            }
+            append(StringSymbols::intern(w[0][0], w[0][1] - w[0][0]), w[1][0], w[1][1] - w[1][0], zerocopy);
+        }
+        s = f1 + 1;
+    }
+    std::sort(entries.begin(), entries.end());
+}
+
+void FlatStringmap::append(uint32_t k, const char* v, size_t n, bool ext) {
+    entry_t E;
+    E.key = k;
+    E.pos = entries.size();
+    E.len = n;
+    E.ext = ext;
+    if(ext) E.off = v - extbuf;
+    else {
+        E.off = own.size();
+        own.append(v, n);
+    }
+
+    // parse once as double, as for stringstream >> d (0 on failure)
+    char b[64];
+    if(n < sizeof(b)) {
+        memcpy(b, v, n);
+        b[n] = 0;
+        E.x = strtod(b, nullptr);
+    } else E.x = strtod(string(v, n).c_str(), nullptr);
+
+    entries.push_back(E);
+}
+
+void FlatStringmap::insert(const string& k, const string& v) {
+    append(StringSymbols::intern(k), v.data(), v.size(), false);
+    // move into sorted position, after existing entries for key
+    auto it = std::upper_bound(entries.begin(), entries.end() - 1, entries.back());
+    std::rotate(it, entries.end() - 1, entries.end());
+}
+
+std::pair<vector<FlatStringmap::entry_t>::const_iterator, vector<FlatStringmap::entry_t>::const_iterator>
+FlatStringmap::range(uint32_t k) const {
+    auto i0 = std::lower_bound(entries.begin(), entries.end(), k, [](const entry_t& e, uint32_t kk) { return e.key < kk; });
+    auto i1 = i0;
+    while(i1 != entries.end() && i1->key == k) ++i1;
+    return {i0, i1};
+}
+
+string FlatStringmap::getDefault(uint32_t k, const string& d) const {
+    auto r = range(k);
+    return r.first == r.second? d : string(vdata(*r.first), r.first->len);
+}
+
+double FlatStringmap::getDefault(uint32_t k, double d) const {
+    auto r = range(k);
+    return r.first == r.second || !r.first->len? d : r.first->x;
+}
+
+vector<string> FlatStringmap::retrieve(const string& k) const {
+    vector<string> v;
+    auto r = range(StringSymbols::find(k));
+    for(auto it = r.first; it != r.second; ++it) v.emplace_back(vdata(*it), it->len);
+    return v;
+}
+
+vector<double> FlatStringmap::retrieveDouble(const string& k) const {
+    vector<double> v;
+    auto r = range(StringSymbols::find(k));
+    for(auto it = r.first; it != r.second; ++it) v.push_back(it->x);
+    return v;
+}
+
+Stringmap FlatStringmap::toStringmap() const {
+    Stringmap m;
+    for(size_t i = 0; i < size(); ++i) m.insert(key(i), value(i));
+    return m;
+}
+
+void FlatStringmap::display(const string& linepfx) const {
+    for(size_t i = 0; i < size(); ++i) std::cout << linepfx << key(i) << ": " << value(i) << "\n";
+}
@@ -0,0 +1,114 @@
+/// \file FlatStringmap.hh Interned-key flat string map with values parsed once on construction
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef FLATSTRINGMAP_HH
+#define FLATSTRINGMAP_HH
+
+#include "Stringmap.hh"
+#include <stdint.h>
+
+/// Global interned string symbol table: small integer IDs for frequently repeated keys
+class StringSymbols {
+public:
+    /// ID for absent (never-interned) symbol
+    static constexpr uint32_t NONE = 0xffffffff;
+    /// get (or assign) ID for string
+    static uint32_t intern(const char* s, size_t n);
+    /// get (or assign) ID for string
+    static uint32_t intern(const string& s) { return intern(s.data(), s.size()); }
+    /// get ID of string if already interned, NONE otherwise (no table growth)
+    static uint32_t find(const string& s);
+    /// name for ID
+    static const string& name(uint32_t i);
+    /// number of interned symbols
+    static size_t size();
+};
+
+/// Pre-interned key for repeated lookups
+struct StringSymbol {
+    /// Constructor, interning name
+    explicit StringSymbol(const string& s): id(StringSymbols::intern(s)) { }
+    const uint32_t id;  ///< interned ID
+};
+
+/// Flat (sorted vector) key/value multimap: interned keys, values parsed once to double
+class FlatStringmap {
+public:
+    /// Default constructor
+    FlatStringmap() { }
+    /// Constructor from Stringmap (implicit, for Stringmap-producing readers)
+    FlatStringmap(const Stringmap& m);
+    /// Constructor parsing Stringmap "key = value\t..." format; zerocopy values reference s, which must outlive this
+    FlatStringmap(const char* s, size_t n, bool zerocopy = false);
+    /// Constructor parsing from string (copied)
+    explicit FlatStringmap(const string& s): FlatStringmap(s.data(), s.size()) { }
+
+    /// number of entries
+    size_t size() const { return entries.size(); }
+    /// number of entries for key
+    size_t count(const string& k) const { return count(StringSymbols::find(k)); }
+    /// number of entries for key
+    size_t count(const StringSymbol& k) const { return count(k.id); }
+
+    /// get first key value (string) or default
+    string getDefault(const string& k, const string& d) const { return getDefault(StringSymbols::find(k), d); }
+    /// get first key value (string) or default
+    string getDefault(const StringSymbol& k, const string& d) const { return getDefault(k.id, d); }
+    /// get first key value (double) or default
+    double getDefault(const string& k, double d) const { return getDefault(StringSymbols::find(k), d); }
+    /// get first key value (double) or default
+    double getDefault(const StringSymbol& k, double d) const { return getDefault(k.id, d); }
+
+    /// retrieve key values
+    vector<string> retrieve(const string& k) const;
+    /// retrieve key values as doubles
+    vector<double> retrieveDouble(const string& k) const;
+
+    /// i^th entry key, in sorted (by ID, then insertion) order
+    const string& key(size_t i) const { return StringSymbols::name(entries[i].key); }
+    /// i^th entry value
+    string value(size_t i) const { return string(vdata(entries[i]), entries[i].len); }
+    /// i^th entry value as double
+    double number(size_t i) const { return entries[i].x; }
+
+    /// insert key/(string)value pair (copied)
+    void insert(const string& k, const string& v);
+    /// insert key/(double)value
+    void insert(const string& k, double d) { insert(k, to_str(d)); }
+
+    /// convert to Stringmap
+    Stringmap toStringmap() const;
+    /// display to stdout
+    void display(const string& linepfx = "") const;
+
+protected:
+    /// key/value entry
+    struct entry_t {
+        uint32_t key;   ///< interned key ID
+        uint32_t pos;   ///< insertion order
+        size_t off;     ///< value offset in buffer
+        uint32_t len;   ///< value length
+        bool ext;       ///< whether value is in external (zero-copy) buffer
+        double x;       ///< value parsed as double
+        /// sort order
+        bool operator<(const entry_t& e) const { return key < e.key || (key == e.key && pos < e.pos); }
+    };
+    vector<entry_t> entries;    ///< entries, sorted by key
+    string own;                 ///< owned value contents
+    const char* extbuf = nullptr;   ///< external zero-copy value buffer
+
+    /// value start
+    const char* vdata(const entry_t& e) const { return (e.ext? extbuf : own.data()) + e.off; }
+    /// range of entries for key ID
+    std::pair<vector<entry_t>::const_iterator, vector<entry_t>::const_iterator> range(uint32_t k) const;
+    /// count entries for key ID
+    size_t count(uint32_t k) const { auto r = range(k); return r.second - r.first; }
+    /// first value or default
+    string getDefault(uint32_t k, const string& d) const;
+    /// first value as double or default
+    double getDefault(uint32_t k, double d) const;
+    /// append entry (unsorted) for value at [v, v + n); copied to own unless ext (in extbuf)
+    void append(uint32_t k, const char* v, size_t n, bool ext);
+};
+
+#endif
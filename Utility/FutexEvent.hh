@@ -0,0 +1,72 @@
+/// \file FutexEvent.hh Lightweight wake-up notification for lock-free buffer waiters
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef FUTEXEVENT_HH
+#define FUTEXEVENT_HH
+
+#include <atomic>
+#include <cstdint>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+/// Wake-up event for threads waiting on lock-free buffer state (futex on Linux; condition variable elsewhere)
+/// waiter:   auto s = E.prepare(); if(ready()) E.cancel(); else E.wait(s, timeout);
+/// notifier: (change state); E.notify();  --- no system call or lock unless a waiter is present
+class FutexEvent {
+public:
+    /// (waiter) register as waiting; return event count to pass to wait() after re-checking condition
+    uint32_t prepare() {
+        nwait.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // registered before condition re-check
+        return seq.load(std::memory_order_acquire);
+    }
+    /// (waiter) de-register without waiting, when condition already satisfied
+    void cancel() { nwait.fetch_sub(1, std::memory_order_relaxed); }
+    /// (waiter) wait for notify() after prepare() returning s, or timeout [s]; de-registers
+    void wait(uint32_t s, double timeout_s) {
+#ifdef __linux__
+        if(seq.load(std::memory_order_acquire) == s) {
+            timespec ts;
+            ts.tv_sec = time_t(timeout_s);
+            ts.tv_nsec = long(1e9*(timeout_s - ts.tv_sec));
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq), FUTEX_WAIT_PRIVATE, s, &ts, nullptr, 0);
+        }
+#else
+        std::unique_lock<std::mutex> lk(mut);
+        cv.wait_for(lk, std::chrono::duration<double>(timeout_s), [this, s] { return seq.load() != s; });
+#endif
+        cancel();
+    }
+    /// wake all waiters
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // state change visible before checking waiters
+        if(!nwait.load(std::memory_order_relaxed)) return;
+        seq.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+        std::lock_guard<std::mutex> lk(mut);
+        cv.notify_all();
+#endif
+    }
+    /// number of notify() calls that woke (possible) waiters
+    uint32_t n_wakes() const { return seq.load(std::memory_order_relaxed); }
+
+protected:
+    std::atomic<uint32_t> seq{0};   ///< event count (futex word)
+    std::atomic<int> nwait{0};      ///< number of registered waiters
+#ifndef __linux__
+    std::mutex mut;                 ///< lock for condition variable
+    std::condition_variable cv;     ///< waiters notifier
+#endif
+};
+
+#endif
@@ -18,3 +18,140 @@ size_t chash64(size_t a, size_t b) {
     size_t ab[2] = {a,b};
     return _hash64(ab, 2*sizeof(size_t));
 }
+
+//////////////////////////////////////
+// batch SipHash-2-4 (zero key, 64-bit output), SIMD lanes over records
+
+#include <string.h>
+
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HASH64_VECTOR_LANES
+
+#define SIP_ROTL(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+#define SIP_ROUND do { \
+    v0 += v1; v1 = SIP_ROTL(v1, 13); v1 ^= v0; v0 = SIP_ROTL(v0, 32); \
+    v2 += v3; v3 = SIP_ROTL(v3, 16); v3 ^= v2; \
+    v0 += v3; v3 = SIP_ROTL(v3, 21); v3 ^= v0; \
+    v2 += v1; v1 = SIP_ROTL(v1, 17); v1 ^= v2; v2 = SIP_ROTL(v2, 32); \
+} while(0)
+
+/// SipHash L records of recsize bytes in parallel vector lanes of V
+template<typename V, size_t L>
+static inline __attribute__((always_inline)) void sip_lanes(const uint8_t* p, size_t recsize, size_t* out) {
+    V v0 = V{} + 0x736f6d6570736575ULL;
+    V v1 = V{} + 0x646f72616e646f6dULL;
+    V v2 = V{} + 0x6c7967656e657261ULL;
+    V v3 = V{} + 0x7465646279746573ULL;
+    V m{};
+
+    const size_t nw = recsize/8;
+    for(size_t w = 0; w < nw; ++w) {
+        for(size_t l = 0; l < L; ++l) { uint64_t x; memcpy(&x, p + l*recsize + 8*w, 8); m[l] = x; }
+        v3 ^= m;
+        SIP_ROUND; SIP_ROUND;
+        v0 ^= m;
+    }
+
+    const size_t left = recsize & 7;
+    for(size_t l = 0; l < L; ++l) {
+        uint64_t x = 0;
+        memcpy(&x, p + l*recsize + 8*nw, left);
+        m[l] = x | (uint64_t(recsize) << 56);
+    }
+    v3 ^= m;
+    SIP_ROUND; SIP_ROUND;
+    v0 ^= m;
+
+    v2 ^= 0xff;
+    SIP_ROUND; SIP_ROUND; SIP_ROUND; SIP_ROUND;
+    m = v0 ^ v1 ^ v2 ^ v3;
+    for(size_t l = 0; l < L; ++l) out[l] = m[l];
+}
+
+/// 2 x 64-bit lanes (SSE2, NEON)
+typedef uint64_t u64x2_t __attribute__((vector_size(16)));
+/// 4 x 64-bit lanes (AVX2)
+typedef uint64_t u64x4_t __attribute__((vector_size(32)));
+
+/// hash records in groups of 2 lanes; return number done
+static size_t sip_batch_x2(const uint8_t* p, size_t recsize, size_t n, size_t* out) {
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2) sip_lanes<u64x2_t, 2>(p + i*recsize, recsize, out + i);
+    return i;
+}
+
+#if defined(__x86_64__) && !defined(__clang__)
+/// hash records in groups of 4 AVX2 lanes; return number done
+__attribute__((target("avx2")))
+static size_t sip_batch_x4(const uint8_t* p, size_t recsize, size_t n, size_t* out) {
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4) sip_lanes<u64x4_t, 4>(p + i*recsize, recsize, out + i);
+    return i;
+}
+#endif
+
+#endif
+
+void _hash64_batch(const void* dat, size_t recsize, size_t n, size_t* out) {
+    auto p = static_cast<const uint8_t*>(dat);
+    size_t i = 0;
+#ifdef HASH64_VECTOR_LANES
+#if defined(__x86_64__) && !defined(__clang__)
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if(has_avx2) i = sip_batch_x4(p, recsize, n, out);
+#endif
+    i += sip_batch_x2(p + i*recsize, recsize, n - i, out + i);
+#endif
+    for(; i < n; ++i) out[i] = _hash64(p + i*recsize, recsize);
+}
+
+//////////////////////////////////////
+// fast hash
+
+/// wyhash constants
+static const uint64_t wyp[4] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+
+/// 64x64 -> 128-bit multiply, folded
+static inline uint64_t wymix(uint64_t a, uint64_t b) {
+    __uint128_t r = __uint128_t(a)*b;
+    return uint64_t(r) ^ uint64_t(r >> 64);
+}
+
+/// little-endian 64-bit read
+static inline uint64_t wyr8(const uint8_t* p) { uint64_t x; memcpy(&x, p, 8); return x; }
+/// little-endian 32-bit read
+static inline uint64_t wyr4(const uint8_t* p) { uint32_t x; memcpy(&x, p, 4); return x; }
+
+/// fast hash, inlined for batch loop
+static inline uint64_t fasthash(const uint8_t* p, size_t n) {
+    uint64_t seed = wyp[0];
+    uint64_t a, b;
+    if(n <= 16) {
+        if(n >= 4) {
+            a = (wyr4(p) << 32) | wyr4(p + ((n >> 3) << 2));
+            b = (wyr4(p + n - 4) << 32) | wyr4(p + n - 4 - ((n >> 3) << 2));
+        } else if(n) {
+            a = (uint64_t(p[0]) << 16) | (uint64_t(p[n >> 1]) << 8) | p[n - 1];
+            b = 0;
+        } else a = b = 0;
+    } else {
+        size_t i = n;
+        while(i > 16) {
+            seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
+    }
+    return wymix(wyp[1] ^ n, wymix(a ^ wyp[1], b ^ seed));
+}
+
+size_t _fasthash64(const void* dat, size_t n) { return dat? fasthash(static_cast<const uint8_t*>(dat), n) : 0; }
+
+size_t fastchash64(size_t a, size_t b) { return wymix(a ^ wyp[0], b ^ wyp[1]); }
+
+void _fasthash64_batch(const void* dat, size_t recsize, size_t n, size_t* out) {
+    auto p = static_cast<const uint8_t*>(dat);
+    for(size_t i = 0; i < n; ++i) out[i] = fasthash(p + i*recsize, recsize);
+}
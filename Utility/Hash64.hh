@@ -1,4 +1,4 @@
-/// \file Hash64.hh Wrapper and convenience functions for 64-bit hashes (SipHash backend)
+/// \file Hash64.hh Wrapper and convenience functions for 64-bit hashes (SipHash backend; fast non-cryptographic option)
 // -- Michael P. Mendenhall, LLNL 2019
 
 #ifndef HASH64_HH
@@ -7,6 +7,8 @@
 #include <cstddef>
 #include <string>
 using std::string;
+#include <type_traits>
+#include <utility>
 
 // workaround for older gcc without std::is_trivially_copyable
 #if __GNUG__ && __GNUC__ < 5
@@ -35,4 +37,65 @@ size_t chash64(size_t a, size_t b);
 template<typename T, typename... Args>
 size_t hash64(const T& o, Args&&... a) { return chash64(hash64(o), hash64(std::forward<Args>(a)...)); }
 
+/// SipHash of n fixed-size records (contiguous, recsize bytes each) into out[n]; equal to _hash64 of each (SIMD lanes where available)
+void _hash64_batch(const void* dat, size_t recsize, size_t n, size_t* out);
+
+/// SipHash of n trivially-copyable objects
+template<typename T>
+void hash64_batch(const T* o, size_t n, size_t* out) {
+    static_assert(IS_TRIVIALLY_COPYABLE(T), "Object needs custom hash64 method");
+    _hash64_batch(o, sizeof(T), n, out);
+}
+
+// --- fast non-cryptographic hashes: deterministic, but not for persisted or adversarial-input data ---
+
+/// fast (wyhash-style multiply-mix) 64-bit hash of binary data
+size_t _fasthash64(const void* dat, size_t n);
+
+/// fast 64-bit hash of string
+inline size_t fasthash64(const string& s) { return _fasthash64(s.data(), s.size()); }
+
+/// fast 64-bit hash of trivially-copyable object
+template<typename T>
+size_t fasthash64(const T& o) {
+    static_assert(IS_TRIVIALLY_COPYABLE(T), "Object needs custom fasthash64 method");
+    return _fasthash64(&o, sizeof(T));
+}
+
+/// fast combine hashes
+size_t fastchash64(size_t a, size_t b);
+
+/// fast 64-bit hash combining multiple arguments
+template<typename T, typename... Args>
+size_t fasthash64(const T& o, Args&&... a) { return fastchash64(fasthash64(o), fasthash64(std::forward<Args>(a)...)); }
+
+/// fast hash of n fixed-size records (contiguous, recsize bytes each) into out[n]
+void _fasthash64_batch(const void* dat, size_t recsize, size_t n, size_t* out);
+
+/// fast hash of n trivially-copyable objects
+template<typename T>
+void fasthash64_batch(const T* o, size_t n, size_t* out) {
+    static_assert(IS_TRIVIALLY_COPYABLE(T), "Object needs custom fasthash64 method");
+    _fasthash64_batch(o, sizeof(T), n, out);
+}
+
+/// hash algorithm selection functors, for templated call sites
+struct SipHash64 {
+    /// hash object
+    template<typename T>
+    size_t operator()(const T& o) const { return hash64(o); }
+    /// hash batch
+    template<typename T>
+    void operator()(const T* o, size_t n, size_t* out) const { hash64_batch(o, n, out); }
+};
+/// fast hash selection functor
+struct FastHash64 {
+    /// hash object
+    template<typename T>
+    size_t operator()(const T& o) const { return fasthash64(o); }
+    /// hash batch
+    template<typename T>
+    void operator()(const T* o, size_t n, size_t* out) const { fasthash64_batch(o, n, out); }
+};
+
 #endif
@@ -0,0 +1,134 @@
+/// \file HugePages.cc
+
+#include "HugePages.hh"
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <linux/mman.h> // for MAP_HUGE_2MB
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <stdexcept>
+#include <stdlib.h>
+
+/// huge page size [bytes]
+static constexpr size_t HUGEPAGE_SIZE = 1 << 21;
+
+/// registry lock
+static std::mutex& hugepages_mutex() {
+    static std::mutex m;
+    return m;
+}
+/// mapped allocations and their lengths
+static std::map<void*, size_t>& hugepages_mapped() {
+    static std::map<void*, size_t> m;
+    return m;
+}
+/// per-component policies
+static std::map<string, HugePagePolicy>& hugepages_components() {
+    static std::map<string, HugePagePolicy> m;
+    return m;
+}
+
+HugePagePolicy& HugePagePolicy::global() {
+    static HugePagePolicy P;
+    return P;
+}
+
+HugePagePolicy HugePagePolicy::get(const char* component) {
+    std::lock_guard<std::mutex> l(hugepages_mutex());
+    if(component) {
+        auto it = hugepages_components().find(component);
+        if(it != hugepages_components().end()) return it->second;
+    }
+    return global();
+}
+
+void HugePagePolicy::set(const string& component, const HugePagePolicy& P) {
+    std::lock_guard<std::mutex> l(hugepages_mutex());
+    hugepages_components()[component] = P;
+}
+
+HugePagePolicy HugePagePolicy::parse(const string& s) {
+    HugePagePolicy P;
+    auto i = s.find(':');
+    auto m = s.substr(0, i);
+    if(m == "thp") P.mode = HP_TRANSPARENT;
+    else if(m == "hugetlb") P.mode = HP_EXPLICIT;
+    else if(m != "none") throw std::runtime_error("Unknown huge pages mode '" + m + "'");
+    if(i == string::npos) return P;
+    auto n = s.substr(i + 1);
+    P.numa_node = n == "local"? NUMA_LOCAL : atoi(n.c_str());
+    if(P.numa_node < NUMA_LOCAL) throw std::runtime_error("Invalid NUMA node '" + n + "'");
+    return P;
+}
+
+void HugePagePolicy::configure(const string& s) {
+    size_t i0 = 0;
+    while(i0 <= s.size()) {
+        auto i1 = s.find(',', i0);
+        if(i1 == string::npos) i1 = s.size();
+        auto c = s.substr(i0, i1 - i0);
+        i0 = i1 + 1;
+        if(c.empty()) continue;
+        auto j = c.find('=');
+        if(j == string::npos) global() = parse(c);
+        else set(c.substr(0, j), parse(c.substr(j + 1)));
+    }
+}
+
+void* HugePagePolicy::map(size_t n) const {
+    if(mode == HP_NONE || n < min_bytes) return nullptr;
+    const size_t len = (n + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+
+    void* p = MAP_FAILED;
+    if(mode == HP_EXPLICIT) p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+    if(p == MAP_FAILED) {
+        // over-map to place transparent huge pages on 2 MB boundaries
+        auto q = mmap(nullptr, len + HUGEPAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(q == MAP_FAILED) return nullptr;
+        auto a = reinterpret_cast<uintptr_t>(q);
+        auto a0 = (a + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+        if(a0 > a) munmap(q, a0 - a);
+        munmap(reinterpret_cast<void*>(a0 + len), a + HUGEPAGE_SIZE - a0);
+        p = reinterpret_cast<void*>(a0);
+        madvise(p, len, MADV_HUGEPAGE);
+    }
+
+    int node = numa_node;
+    if(node == NUMA_LOCAL) {
+        unsigned int cpu = 0, nd = 0;
+        node = syscall(SYS_getcpu, &cpu, &nd, nullptr)? NUMA_DEFAULT : int(nd);
+    }
+    if(node >= 0 && node < 64) {
+        unsigned long mask = 1UL << node;
+        syscall(SYS_mbind, p, len, MPOL_BIND, &mask, 64, 0);  // advisory: ignore failure (e.g. no NUMA support)
+    }
+
+    std::lock_guard<std::mutex> l(hugepages_mutex());
+    hugepages_mapped()[p] = len;
+    return p;
+}
+
+bool HugePagePolicy::unmap(void* p) {
+    if(!p) return false;
+    size_t len = 0;
+    {
+        std::lock_guard<std::mutex> l(hugepages_mutex());
+        auto& M = hugepages_mapped();
+        auto it = M.find(p);
+        if(it == M.end()) return false;
+        len = it->second;
+        M.erase(it);
+    }
+    munmap(p, len);
+    return true;
+}
+
+size_t HugePagePolicy::mappedBytes() {
+    std::lock_guard<std::mutex> l(hugepages_mutex());
+    size_t n = 0;
+    for(auto& kv: hugepages_mapped()) n += kv.second;
+    return n;
+}
@@ -0,0 +1,88 @@
+/// \file HugePages.hh Huge-page and NUMA-node backed allocation for large buffers
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef HUGEPAGES_HH
+#define HUGEPAGES_HH
+
+#include <memory>
+#include <string>
+using std::string;
+#include <type_traits>
+#include <vector>
+using std::vector;
+
+/// Large-buffer page backing policy, set globally or per named component
+struct HugePagePolicy {
+    /// huge page use
+    enum mode_t {
+        HP_NONE,        ///< default heap allocation
+        HP_TRANSPARENT, ///< anonymous mapping with madvise(MADV_HUGEPAGE) transparent huge pages
+        HP_EXPLICIT     ///< MAP_HUGETLB 2 MB pages from reserved pool; transparent if pool exhausted
+    } mode = HP_NONE;   ///< huge page use
+
+    static constexpr int NUMA_DEFAULT = -1; ///< OS default (first-touch) placement
+    static constexpr int NUMA_LOCAL = -2;   ///< bind to node of allocating thread
+    int numa_node = NUMA_DEFAULT;   ///< NUMA node to bind mapped allocations, or NUMA_DEFAULT/NUMA_LOCAL
+    size_t min_bytes = 1 << 21;     ///< smaller allocations from default heap
+
+    /// map n bytes per policy; nullptr if policy leaves allocation to the default heap
+    void* map(size_t n) const;
+    /// release allocation from map(); false if p was not mapped (so should be returned to default heap)
+    static bool unmap(void* p);
+
+    /// global default policy
+    static HugePagePolicy& global();
+    /// policy for component (global unless set)
+    static HugePagePolicy get(const char* component);
+    /// set policy for component
+    static void set(const string& component, const HugePagePolicy& P);
+    /// parse "mode[:node]" (mode none, thp, or hugetlb; node number or local)
+    static HugePagePolicy parse(const string& s);
+    /// configure from comma-separated "[component=]mode[:node]" list (global when no component specified)
+    static void configure(const string& s);
+    /// bytes currently mapped across all policies
+    static size_t mappedBytes();
+};
+
+/// STL allocator for large buffers by component policy; mapped and heap blocks are released by any instance
+template<typename T>
+class HugePageAllocator {
+public:
+    /// allocated type
+    typedef T value_type;
+    /// instances are interchangeable
+    typedef std::true_type is_always_equal;
+    /// keep component with moved containers
+    typedef std::true_type propagate_on_container_move_assignment;
+    /// keep component with swapped containers
+    typedef std::true_type propagate_on_container_swap;
+
+    /// Constructor, with component name for policy (nullptr for global)
+    explicit HugePageAllocator(const char* c = nullptr): component(c) { }
+    /// rebind copy constructor
+    template<typename U>
+    HugePageAllocator(const HugePageAllocator<U>& a): component(a.component) { }
+
+    /// allocate n items
+    T* allocate(size_t n) {
+        if(auto p = HugePagePolicy::get(component).map(n*sizeof(T))) return static_cast<T*>(p);
+        return std::allocator<T>().allocate(n);
+    }
+    /// release n items
+    void deallocate(T* p, size_t n) { if(!HugePagePolicy::unmap(p)) std::allocator<T>().deallocate(p, n); }
+
+    /// interchangeable
+    template<typename U>
+    bool operator==(const HugePageAllocator<U>&) const { return true; }
+    /// interchangeable
+    template<typename U>
+    bool operator!=(const HugePageAllocator<U>&) const { return false; }
+
+    const char* component;  ///< component name for policy lookup
+};
+
+/// vector backed by component huge page policy
+template<typename T>
+using hugepage_vector = vector<T, HugePageAllocator<T>>;
+
+#endif
@@ -4,44 +4,272 @@
 #define LOCKLESSCIRCULARBUFFER_HH
 
 #include "Threadworker.hh"
+#include "FutexEvent.hh"
+#include "HugePages.hh"
 
-#include <unistd.h>     // for usleep
+#include <sched.h>      // for sched_yield
 #include <chrono>       // for timeouts
+#include <atomic>
+#include <limits>
+#include <algorithm>    // for std::min
+#include <memory>       // for std::unique_ptr
 
-/// Circular buffer base class
+/// assumed cache line size, for padding apart independently-modified data
+constexpr size_t CACHELINE_SIZE = 64;
+
+/// Bounded single-producer, single-consumer lock-free ring buffer
+/// producer and consumer positions kept on separate cache lines, each with cached copy of the other's
 template<typename T>
-class LocklessCircleBuffer: public Threadworker {
+class SPSCRing {
 public:
-    /// Constructor
-    LocklessCircleBuffer(size_t n = 1024): buf(n), ready(n) { }
+    /// Constructor, with capacity rounded up to power of 2 (0 for unallocated)
+    explicit SPSCRing(size_t n = 0) { allocate(n); }
+    /// Polymorphic destructor
+    virtual ~SPSCRing() { }
 
-    /// change buffer size
+    /// change buffer size, rounded up to power of 2 --- not thread-safe, discards contents!
     virtual void allocate(size_t n) {
-        buf.clear();
-        ready.clear();
-        buf.resize(n);
-        ready.resize(n);
+        size_t c = n? 1 : 0;
+        while(c < n) c <<= 1;
+        hugepage_vector<T>(c, HugePageAllocator<T>("SPSCRing")).swap(buf); // fresh storage, first-touched by calling thread
+        mask = c? c-1 : 0;
+        wpos.store(0);
+        rpos.store(0);
+        rcache = wcache = 0;
+    }
+
+    /// buffer capacity
+    size_t capacity() const { return buf.size(); }
+    /// number of buffered items (exact from producer or consumer thread; approximate elsewhere)
+    size_t n_buffered() const { return wpos.load(std::memory_order_acquire) - rpos.load(std::memory_order_acquire); }
+    /// check if buffer is empty
+    bool empty() const { return !n_buffered(); }
+
+    /// (producer) claim up to n free slots, accessed as wslot(i); return number available
+    size_t reserve(size_t n) {
+        auto w = wpos.load(std::memory_order_relaxed);
+        if(w - rcache + n > buf.size()) rcache = rpos.load(std::memory_order_acquire);
+        return std::min(n, buf.size() - (w - rcache));
+    }
+    /// (producer) i-th slot claimed by reserve()
+    T& wslot(size_t i) { return buf[(wpos.load(std::memory_order_relaxed) + i) & mask]; }
+    /// (producer) publish first n slots filled in after reserve()
+    void commit(size_t n) { wpos.store(wpos.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+    /// (producer) get pointer to next write space, or nullptr if full
+    T* try_writepoint() { return reserve(1)? &wslot(0) : nullptr; }
+    /// (producer) publish item filled in at try_writepoint()
+    void publish() { commit(1); }
+    /// (producer) copy item into buffer; false if full
+    bool try_push(const T& o) {
+        auto p = try_writepoint();
+        if(!p) return false;
+        *p = o;
+        publish();
+        return true;
+    }
+    /// (producer) move item into buffer; false (and o unchanged) if full
+    bool try_push(T&& o) {
+        auto p = try_writepoint();
+        if(!p) return false;
+        *p = std::move(o);
+        publish();
+        return true;
+    }
+
+    /// (producer) copy as many of n items into buffer as fit; return number written
+    size_t push_batch(const T* o, size_t n) {
+        n = reserve(n);
+        for(size_t i = 0; i < n; ++i) wslot(i) = o[i];
+        commit(n);
+        return n;
+    }
+
+    /// (consumer) claim up to n readable items, accessed as rslot(i); return number available
+    size_t acquire(size_t n) {
+        auto r = rpos.load(std::memory_order_relaxed);
+        if(wcache - r < n) wcache = wpos.load(std::memory_order_acquire);
+        return std::min(n, wcache - r);
+    }
+    /// (consumer) i-th item claimed by acquire()
+    T& rslot(size_t i) { return buf[(rpos.load(std::memory_order_relaxed) + i) & mask]; }
+    /// (consumer) free first n items claimed by acquire()
+    void release(size_t n) { rpos.store(rpos.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+    /// (consumer) get pointer to next readable item, or nullptr if empty
+    T* try_readpoint() { return acquire(1)? &rslot(0) : nullptr; }
+    /// (consumer) release item read at try_readpoint()
+    void release() { release(1); }
+    /// (consumer) move next item out of buffer; false if empty
+    bool try_pop(T& o) {
+        auto p = try_readpoint();
+        if(!p) return false;
+        o = std::move(*p);
+        release();
+        return true;
+    }
+    /// (consumer) move up to nmax available items onto end of v; return number read
+    size_t pop_batch(vector<T>& v, size_t nmax = std::numeric_limits<size_t>::max()) {
+        auto n = acquire(nmax);
+        for(size_t i = 0; i < n; ++i) v.push_back(std::move(rslot(i)));
+        release(n);
+        return n;
+    }
+
+protected:
+    hugepage_vector<T> buf;         ///< data buffer, by "SPSCRing" HugePagePolicy
+    size_t mask = 0;                ///< index mask for power-of-2 buffer
+    char _pad0[CACHELINE_SIZE];     ///< padding from shared read-only data
+    std::atomic<size_t> wpos{0};    ///< total items written; modified only by producer
+    size_t rcache = 0;              ///< producer's last-seen rpos
+    char _pad1[CACHELINE_SIZE];     ///< padding between producer and consumer data
+    std::atomic<size_t> rpos{0};    ///< total items read; modified only by consumer
+    size_t wcache = 0;              ///< consumer's last-seen wpos
+    char _pad2[CACHELINE_SIZE];     ///< padding from following data
+};
+
+/// Bounded multi-producer, multi-consumer lock-free ring buffer (per-cell sequence numbers)
+template<typename T>
+class MPMCRing {
+public:
+    /// Constructor, with capacity rounded up to power of 2 (minimum 2; 0 for unallocated)
+    explicit MPMCRing(size_t n = 0) { allocate(n); }
+
+    /// change buffer size, rounded up to power of 2 --- not thread-safe, discards contents!
+    void allocate(size_t n) {
+        size_t c = n? 2 : 0;
+        while(c < n) c <<= 1;
+        cells.reset(c? new cell_t[c] : nullptr);
+        for(size_t i = 0; i < c; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+        ncells = c;
+        mask = c? c-1 : 0;
+        wpos.store(0);
+        rpos.store(0);
+    }
+
+    /// buffer capacity
+    size_t capacity() const { return ncells; }
+    /// approximate number of buffered items
+    size_t n_buffered() const {
+        auto r = rpos.load(std::memory_order_acquire);
+        auto w = wpos.load(std::memory_order_acquire);
+        return w > r? w - r : 0;
     }
+    /// check if buffer is (approximately) empty
+    bool empty() const { return !n_buffered(); }
+
+    /// copy item into buffer; false if full
+    bool try_push(const T& o) {
+        auto c = claim_write();
+        if(!c) return false;
+        c->dat = o;
+        c->seq.store(c->pos + 1, std::memory_order_release);
+        return true;
+    }
+    /// move item into buffer; false (and o unchanged) if full
+    bool try_push(T&& o) {
+        auto c = claim_write();
+        if(!c) return false;
+        c->dat = std::move(o);
+        c->seq.store(c->pos + 1, std::memory_order_release);
+        return true;
+    }
+    /// move next item out of buffer; false if empty
+    bool try_pop(T& o) {
+        size_t p = rpos.load(std::memory_order_relaxed);
+        while(true) {
+            auto& c = cells[p & mask];
+            auto d = ptrdiff_t(c.seq.load(std::memory_order_acquire)) - ptrdiff_t(p + 1);
+            if(!d) {
+                if(rpos.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+                    o = std::move(c.dat);
+                    c.seq.store(p + ncells, std::memory_order_release);
+                    return true;
+                }
+            } else if(d < 0) return false;
+            else p = rpos.load(std::memory_order_relaxed);
+        }
+    }
+
+protected:
+    /// buffer cell
+    struct cell_t {
+        std::atomic<size_t> seq{0}; ///< sequence number: position p ready to write at p, ready to read at p+1
+        size_t pos = 0;             ///< claimed write position
+        T dat{};                    ///< contents
+    };
+
+    /// claim cell for writing, or nullptr if full
+    cell_t* claim_write() {
+        if(!ncells) return nullptr;
+        size_t p = wpos.load(std::memory_order_relaxed);
+        while(true) {
+            auto& c = cells[p & mask];
+            auto d = ptrdiff_t(c.seq.load(std::memory_order_acquire)) - ptrdiff_t(p);
+            if(!d) {
+                if(wpos.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) { c.pos = p; return &c; }
+            } else if(d < 0) return nullptr;
+            else p = wpos.load(std::memory_order_relaxed);
+        }
+    }
+
+    std::unique_ptr<cell_t[]> cells;    ///< data buffer
+    size_t ncells = 0;                  ///< number of cells
+    size_t mask = 0;                    ///< index mask for power-of-2 buffer
+    char _pad0[CACHELINE_SIZE];         ///< padding from shared read-only data
+    std::atomic<size_t> wpos{0};        ///< next write position
+    char _pad1[CACHELINE_SIZE];         ///< padding between producers and consumers
+    std::atomic<size_t> rpos{0};        ///< next read position
+    char _pad2[CACHELINE_SIZE];         ///< padding from following data
+};
+
+/// Spin-then-park waiting policy for lock-free buffer consumers
+struct SpinParkPolicy {
+    unsigned int nspin = 256;   ///< busy-poll attempts before yielding
+    unsigned int nyield = 16;   ///< sched_yield() attempts before parking
+    double park_s = 1e-3;       ///< maximum parked (blocking wait) time, in seconds
+
+    /// wait action for idle count n (starting from 1); return whether time to park
+    bool idle(unsigned int n) const {
+        if(n <= nspin) return false;
+        if(n <= nspin + nyield) { sched_yield(); return false; }
+        return true;
+    }
+    /// park duration
+    std::chrono::microseconds park_time() const { return std::chrono::microseconds(long(1e6*park_s)); }
+};
+
+/// Circular buffer for passing items from time-sensitive producer to process_item() in reader thread
+/// producer never locks: waits for space and reader wake-ups use FutexEvent
+template<typename T>
+class LocklessCircleBuffer: public SPSCRing<T>, public Threadworker {
+public:
+    /// Constructor
+    explicit LocklessCircleBuffer(size_t n = 1024): SPSCRing<T>(n) { }
 
     /// get pointer to next buffer space; nullptr if unavailable
     T* get_writepoint() {
         if(writept) throw std::logic_error("Unfinished write in progress");
-        if(ready[write_idx]) { ++n_write_fails; return nullptr; }
-        return writept = &buf[write_idx];
+        writept = this->try_writepoint();
+        if(!writept) ++n_write_fails;
+        return writept;
     }
 
-    /// get pointer to next buffer space, with timeout in s; nullptr if unavailable
+    /// get pointer to next buffer space, waiting up to t_s [s] for space; nullptr if unavailable
     T* get_writepoint(double t_s) {
         if(writept) throw std::logic_error("Unfinished write in progress");
 
-        if(!t_s) {
-            if(!ready[write_idx]) writept = &buf[write_idx];
-        } else {
-            auto t = std::chrono::steady_clock::now() + std::chrono::milliseconds(int(1e3*t_s));
-            do {
-                if(ready[write_idx]) { usleep(1000); continue; }
-                writept = &buf[write_idx];
-            } while(!writept && std::chrono::steady_clock::now() < t);
+        writept = this->try_writepoint();
+        if(!writept && t_s > 0) {
+            auto t1 = std::chrono::steady_clock::now() + std::chrono::duration<double>(t_s);
+            while(true) {
+                auto s = spaceReady.prepare();
+                writept = this->try_writepoint();
+                if(writept) { spaceReady.cancel(); break; }
+                auto dt = std::chrono::duration<double>(t1 - std::chrono::steady_clock::now()).count();
+                if(dt <= 0) { spaceReady.cancel(); break; }
+                spaceReady.wait(s, dt);
+            }
         }
 
         if(!writept) ++n_write_fails;
@@ -51,11 +279,9 @@ public:
     /// call after completing access to write point, appending to processing queue
     void finish_write() {
         if(!writept) throw std::logic_error("No write in progress");
-        __sync_synchronize();
-        ready[write_idx] = true;
-        write_idx = (write_idx + 1)%buf.size();
+        this->publish();
         writept = nullptr;
-        inputReady.notify_one();
+        dataReady.notify();
     }
 
     /// write to next buffer space, failing if unavailable
@@ -67,54 +293,87 @@ public:
         return true;
     }
 
+    /// (producer) publish first n slots filled in after reserve(n), waking reader
+    void commit(size_t n) {
+        if(writept) throw std::logic_error("Unfinished write in progress");
+        SPSCRing<T>::commit(n);
+        dataReady.notify();
+    }
+    /// (producer) copy as many of n items into buffer as fit, waking reader; return number written
+    size_t push_batch(const T* o, size_t n) {
+        n = this->reserve(n);
+        for(size_t i = 0; i < n; ++i) this->wslot(i) = o[i];
+        commit(n);
+        if(!n) ++n_write_fails;
+        return n;
+    }
+
     /// consume one next available item
     bool read_one() {
-        if(!ready[read_idx]) return false;
-        current = buf[read_idx];
-        __sync_synchronize();
-        ready[read_idx] = false;
+        auto p = this->try_readpoint();
+        if(!p) return false;
+        current = std::move(*p);
+        this->release();
+        spaceReady.notify();
         process_item();
-        read_idx = (read_idx + 1)%buf.size();
         return true;
     }
 
     /// consume all next available items
     size_t flush() {
-        int nread = 0;
-        while(read_one()) nread++;
+        size_t nread = 0;
+        while(size_t n = this->acquire(maxBatch)) {
+            nread += n;
+            process_batch(n);
+        }
         return nread;
     }
 
-    /// count number of buffered items... not guaranteed correct
-    size_t n_buffered() const {
-        size_t iw = write_idx;
-        size_t ir = read_idx;
-        if(ir > iw) iw += buf.size();
-        return iw==ir? 0 : iw - ir - 1;
+    /// set STOP_REQUESTED and wake parked reader
+    void request_stop() override {
+        Threadworker::request_stop();
+        dataReady.notify();
     }
 
     /// task to be run in thread
     void threadjob() override {
-        while(runstat != STOP_REQUESTED) {
-            flush();
-            unique_lock<mutex> lk(inputMut);
-            inputReady.wait(lk);
+        unsigned int nidle = 0;
+        while(true) {
+            if(flush()) { nidle = 0; continue; }
+            if(!waitPolicy.idle(++nidle)) continue;
+
+            auto s = dataReady.prepare();
+            if(!this->empty()) { dataReady.cancel(); continue; }
+            {
+                lock_guard<mutex> lk(inputMut);
+                if(runstat == STOP_REQUESTED) { dataReady.cancel(); break; }
+            }
+            dataReady.wait(s, waitPolicy.park_s);
         }
         flush();
     }
 
     /// processing on read item --- override me!
     virtual void process_item() = 0;
+    /// process (and release) n items claimed by acquire(n); default moves each to current for process_item()
+    virtual void process_batch(size_t n) {
+        while(n--) {
+            current = std::move(this->rslot(0));
+            this->release();
+            spaceReady.notify();
+            process_item();
+        }
+    }
 
     size_t n_write_fails = 0;   ///< number of buffer-full write failures
+    size_t maxBatch = 64;       ///< maximum items claimed per reader batch
+    SpinParkPolicy waitPolicy;  ///< reader thread waiting policy
 
 protected:
-    vector<T> buf;          ///< data buffer
-    vector<int> ready;      ///< read indicator; int to encourage atomic updating
     T* writept = nullptr;   ///< current item being modified
     T current;              ///< current item to process
-    size_t write_idx = 0;   ///< write point marker
-    size_t read_idx = 0;    ///< read point marker
+    FutexEvent dataReady;   ///< reader wake-up on new data
+    FutexEvent spaceReady;  ///< writer wake-up on freed space
 };
 
 #endif
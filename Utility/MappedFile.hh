@@ -0,0 +1,265 @@
+/// \file MappedFile.hh Memory-mapped read-only file, zero-copy line spans, and fast numeric field parsing
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef MAPPEDFILE_HH
+#define MAPPEDFILE_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+using std::string;
+#include <type_traits>
+#include <vector>
+using std::vector;
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if __cplusplus >= 201703L && __has_include(<charconv>)
+#include <charconv>
+#endif
+
+/// non-owning character range (C++14 stand-in for std::string_view)
+struct charspan {
+    /// Constructor
+    charspan(const char* _p = nullptr, size_t _n = 0): p(_p), n(_n) { }
+    /// Constructor from range
+    charspan(const char* _p, const char* _e): p(_p), n(_e - _p) { }
+
+    /// start
+    const char* begin() const { return p; }
+    /// end
+    const char* end() const { return p + n; }
+    /// length
+    size_t size() const { return n; }
+    /// check if empty
+    bool empty() const { return !n; }
+    /// character access
+    char operator[](size_t i) const { return p[i]; }
+    /// copy to string
+    string str() const { return string(p, n); }
+    /// comparison to string
+    bool operator==(const string& s) const { return s.size() == n && !memcmp(s.data(), p, n); }
+    /// comparison to string
+    bool operator!=(const string& s) const { return !(*this == s); }
+
+    const char* p;  ///< start of range
+    size_t n;       ///< number of characters
+};
+
+/// whitespace test for field parsing, matching istream default (space, \t\n\v\f\r)
+inline bool is_field_space(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+/// parse integer at start of [p,e) after skipping whitespace, as in istream >>; advance p; return success
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value, bool>::type
+parse_field(const char*& p, const char* e, T& x) {
+    auto s = p;
+    while(s < e && is_field_space(*s)) ++s;
+    bool neg = false;
+    if(s < e && (*s == '-' || *s == '+')) neg = (*s++ == '-');
+    if(s == e || unsigned(*s - '0') > 9) return false;
+    typename std::make_unsigned<T>::type u = 0;
+    while(s < e && unsigned(*s - '0') <= 9) u = 10*u + (*s++ - '0');
+    x = neg? T(-u) : T(u);
+    p = s;
+    return true;
+}
+
+/// exactly-representable decimal "[-]ddd[.ddd][E[+-]dd]" fast path (Clinger): mantissa < 2^53, |exponent| <= 22; advance p on success
+template<typename T>
+bool parse_fast_decimal(const char*& p, const char* e, T& x) {
+    static const double p10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    auto s = p;
+    bool neg = (s < e && *s == '-');
+    if(neg) ++s;
+    uint64_t m = 0;
+    int nd = 0, ex = 0;
+    for(; s < e && unsigned(*s - '0') <= 9; ++s, ++nd) m = 10*m + (*s - '0');
+    if(s < e && *s == '.') for(++s; s < e && unsigned(*s - '0') <= 9; ++s, ++nd, --ex) m = 10*m + (*s - '0');
+    if(!nd || nd > 15) return false;
+    if(s < e && (*s == 'e' || *s == 'E')) {
+        auto t = s + 1;
+        bool eneg = (t < e && *t == '-');
+        if(t < e && (*t == '-' || *t == '+')) ++t;
+        if(t == e || unsigned(*t - '0') > 9) return false;
+        int x10 = 0;
+        for(; t < e && unsigned(*t - '0') <= 9 && x10 < 1000; ++t) x10 = 10*x10 + (*t - '0');
+        ex += eneg? -x10 : x10;
+        s = t;
+    }
+    if(s < e && (unsigned(*s - '0') <= 9 || *s == '.' || *s == 'e' || *s == 'E')) return false;
+    if(ex < -22 || ex > 22) return false;
+    double d = double(m);
+    d = ex < 0? d / p10[-ex] : d * p10[ex];
+    x = T(neg? -d : d);
+    p = s;
+    return true;
+}
+
+/// parse floating-point value at start of [p,e) after skipping whitespace; advance p past parsed prefix; return success
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+parse_field(const char*& p, const char* e, T& x) {
+    auto s = p;
+    while(s < e && is_field_space(*s)) ++s;
+    if(s < e && *s == '+') ++s;
+    if(s == e) return false;
+#ifdef __cpp_lib_to_chars
+    auto r = std::from_chars(s, e, x);
+    if(r.ec != std::errc()) return false;
+    p = r.ptr;
+#else
+    if(parse_fast_decimal(s, e, x)) { p = s; return true; }
+    // strtod needs terminated copy (mapped buffers are not null-terminated)
+    char buf[64];
+    size_t n = 0;
+    while(s + n < e && n < sizeof(buf) - 1 && !is_field_space(s[n])) { buf[n] = s[n]; ++n; }
+    buf[n] = 0;
+    char* pe;
+    x = T(strtod(buf, &pe));
+    if(pe == buf) return false;
+    p = s + (pe - buf);
+#endif
+    return true;
+}
+
+/// parse whitespace-delimited word at start of [p,e); advance p; return success
+inline bool parse_field(const char*& p, const char* e, charspan& w) {
+    auto s = p;
+    while(s < e && is_field_space(*s)) ++s;
+    auto t = s;
+    while(t < e && !is_field_space(*t)) ++t;
+    if(t == s) return false;
+    w = charspan(s, t);
+    p = t;
+    return true;
+}
+
+/// Read-only memory-mapped file (read into buffer for non-mappable inputs, e.g. pipes)
+class MappedFile {
+public:
+    /// Default constructor, empty
+    MappedFile() { }
+    /// Constructor, mapping file
+    explicit MappedFile(const string& fname) { open(fname); }
+    /// Destructor
+    ~MappedFile() { close(); }
+    /// no copy
+    MappedFile(const MappedFile&) = delete;
+    /// no assignment
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// map file contents; throw std::runtime_error on failure
+    void open(const string& fname) {
+        close();
+        int fd = ::open(fname.c_str(), O_RDONLY);
+        if(fd < 0) throw std::runtime_error("Unable to open file '" + fname + "'");
+        struct stat st;
+        if(!fstat(fd, &st) && S_ISREG(st.st_mode)) {
+            n = st.st_size;
+            if(n) {
+                auto m = mmap(nullptr, n, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(m != MAP_FAILED) {
+                    madvise(m, n, MADV_SEQUENTIAL);
+                    p = static_cast<const char*>(m);
+                    mapped = true;
+                }
+            }
+        }
+        if(!mapped) {
+            buf.clear();
+            char b[1 << 16];
+            ssize_t r;
+            while((r = ::read(fd, b, sizeof(b))) > 0) buf.insert(buf.end(), b, b + r);
+            p = buf.data();
+            n = buf.size();
+        }
+        ::close(fd);
+    }
+    /// release contents
+    void close() {
+        if(mapped) munmap(const_cast<char*>(p), n);
+        mapped = false;
+        p = nullptr;
+        n = 0;
+        buf.clear();
+    }
+
+    /// file contents
+    const char* data() const { return p; }
+    /// file size
+    size_t size() const { return n; }
+    /// contents as span
+    charspan span() const { return {p, n}; }
+    /// whether contents are memory-mapped (rather than copied)
+    bool is_mapped() const { return mapped; }
+
+protected:
+    const char* p = nullptr;    ///< contents
+    size_t n = 0;               ///< contents size
+    bool mapped = false;        ///< whether p is mmap'd
+    vector<char> buf;           ///< contents copy when not mappable
+};
+
+/// Iterate through lines of memory buffer as spans (memchr newline search)
+class LineSpanner {
+public:
+    /// Constructor
+    explicit LineSpanner(const char* d = nullptr, size_t n = 0): p(d), e(d + n) { }
+    /// Constructor from span
+    explicit LineSpanner(charspan s): LineSpanner(s.p, s.n) { }
+
+    /// get next line (without delimiter); return false at end of buffer
+    bool next(charspan& l, char delim = '\n') {
+        if(p == e) { l = charspan(e, size_t(0)); return false; }
+        auto d = static_cast<const char*>(memchr(p, delim, e - p));
+        l = charspan(p, d? d : e);
+        p = d? d + 1 : e;
+        ++lno;
+        return true;
+    }
+    /// first character of next line, or EOF at end
+    int peek() const { return p == e? EOF : std::char_traits<char>::to_int_type(*p); }
+    /// check whether at end of buffer
+    bool atEnd() const { return p == e; }
+    /// unread remainder
+    charspan remaining() const { return {p, e}; }
+
+    size_t lno = 0;     ///< number of lines read
+
+protected:
+    const char* p;      ///< start of next line
+    const char* e;      ///< end of buffer
+};
+
+/// Whitespace-separated fields scanner on a span, with fast numeric parsing
+class FieldScanner {
+public:
+    /// Constructor
+    explicit FieldScanner(charspan s): p(s.begin()), e(s.end()) { }
+
+    /// read next field; sets fail() on parse error
+    template<typename T>
+    FieldScanner& operator>>(T& x) { if(ok && !parse_field(p, e, x)) ok = false; return *this; }
+    /// read next word into string
+    FieldScanner& operator>>(string& s) { charspan w; *this >> w; if(ok) s.assign(w.p, w.n); return *this; }
+
+    /// whether all reads succeeded
+    explicit operator bool() const { return ok; }
+    /// whether any read failed
+    bool fail() const { return !ok; }
+    /// unread remainder
+    charspan remaining() const { return {p, e}; }
+
+protected:
+    const char* p;      ///< read position
+    const char* e;      ///< end of range
+    bool ok = true;     ///< read status
+};
+
+#endif
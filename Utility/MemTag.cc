@@ -0,0 +1,137 @@
+/// \file MemTag.cc
+
+#include "MemTag.hh"
+#include <algorithm>
+#include <ctype.h>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// tags registry lock
+static std::mutex& memtags_mutex() {
+    static std::mutex m;
+    return m;
+}
+/// tags registry
+static std::map<string, std::unique_ptr<MemTag>>& memtags() {
+    static std::map<string, std::unique_ptr<MemTag>> m;
+    return m;
+}
+
+MemTag& MemTag::get(const string& name) {
+    std::lock_guard<std::mutex> l(memtags_mutex());
+    auto& p = memtags()[name];
+    if(!p) p.reset(new MemTag(name));
+    return *p;
+}
+
+vector<const MemTag*> MemTag::all() {
+    std::lock_guard<std::mutex> l(memtags_mutex());
+    vector<const MemTag*> v;
+    for(auto& kv: memtags()) v.push_back(kv.second.get());
+    return v;
+}
+
+void MemTag::addXML(XMLTag& X) const {
+    auto M = X.addChild(new XMLTag("memtag"));
+    M->oneline = true;
+    M->addAttr("name", name);
+    M->addAttr("current", current());
+    M->addAttr("peak", peak());
+    if(allocs()) M->addAttr("allocs", allocs());
+    if(frees()) M->addAttr("frees", frees());
+}
+
+long long processRSS(bool peak) {
+    auto f = fopen("/proc/self/status", "r");
+    if(!f) return 0;
+    const char* k = peak? "VmHWM:" : "VmRSS:";
+    char line[256];
+    long long kb = 0;
+    while(fgets(line, sizeof(line), f)) {
+        if(strncmp(line, k, strlen(k))) continue;
+        kb = atoll(line + strlen(k));
+        break;
+    }
+    fclose(f);
+    return kb << 10;
+}
+
+////////////////////////////////
+////////////////////////////////
+
+MemReport::MemReport(double _dt): XMLProvider("MemReport"), dt(_dt), tstep(_dt) {
+    if(!(dt > 0)) return;
+    T = std::thread([this] {
+        std::unique_lock<std::mutex> l(M);
+        while(!cv.wait_for(l, std::chrono::duration<double>(dt), [this] { return stop; })) {
+            l.unlock();
+            sample();
+            if(print) display();
+            l.lock();
+        }
+    });
+}
+
+MemReport::~MemReport() {
+    if(!T.joinable()) return;
+    {
+        std::lock_guard<std::mutex> l(M);
+        stop = true;
+    }
+    cv.notify_all();
+    T.join();
+}
+
+void MemReport::sample() {
+    const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    auto v = MemTag::all();
+    std::lock_guard<std::mutex> l(M);
+    if(samples.size() && t - samples.back().t < 0.999*tstep) return;
+
+    // new tags appended to column list
+    for(auto m: v) if(std::find(tags.begin(), tags.end(), m) == tags.end()) tags.push_back(m);
+    sample_t s{t, processRSS(), {}};
+    for(auto m: tags) s.b.push_back(m->current());
+    samples.push_back(s);
+
+    // thin to every other sample at double interval
+    if(samples.size() >= std::max(maxSamples, size_t(2))) {
+        size_t j = 0;
+        for(size_t i = 0; i < samples.size(); i += 2) samples[j++] = std::move(samples[i]);
+        samples.resize(j);
+        tstep *= 2;
+    }
+}
+
+void MemReport::display() {
+    printf("Memory: RSS %.1f MB (peak %.1f MB)", processRSS()/double(1 << 20), processRSS(true)/double(1 << 20));
+    for(auto m: MemTag::all()) printf("; %s %.2f MB (peak %.2f)", m->name.c_str(), m->current()/double(1 << 20), m->peak()/double(1 << 20));
+    printf("\n");
+}
+
+/// XML-attribute-safe version of tag name
+static string attr_name(const string& s) {
+    string a = s;
+    for(auto& c: a) if(!isalnum(c) && c != '_' && c != '-' && c != '.') c = '_';
+    return a;
+}
+
+void MemReport::_makeXML(XMLTag& X) {
+    X.addAttr("rss", processRSS());
+    X.addAttr("rss_peak", processRSS(true));
+    for(auto m: MemTag::all()) m->addXML(X);
+
+    std::lock_guard<std::mutex> l(M);
+    if(!samples.size()) return;
+    auto S = X.addChild(new XMLTag("samples"));
+    S->addAttr("dt", tstep);
+    for(auto& s: samples) {
+        auto St = S->addChild(new XMLTag("sample"));
+        St->oneline = true;
+        St->addAttr("t", s.t);
+        St->addAttr("rss", s.rss);
+        for(size_t i = 0; i < s.b.size(); i++) if(s.b[i]) St->addAttr(attr_name(tags[i]->name), s.b[i]);
+    }
+}
@@ -0,0 +1,144 @@
+/// \file MemTag.hh Per-subsystem tagged memory accounting: counters with high-water marks, counting allocator, periodic XML reports
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef MEMTAG_HH
+#define MEMTAG_HH
+
+#include "XMLTag.hh"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using std::vector;
+
+/// Process-wide named memory usage counter, with high-water mark (thread-safe)
+class MemTag {
+public:
+    /// get (or create) tag by name; references remain valid for process lifetime
+    static MemTag& get(const string& name);
+    /// all tags, in name order
+    static vector<const MemTag*> all();
+
+    /// account change in bytes
+    void add(long long db) {
+        auto n = cur.fetch_add(db, std::memory_order_relaxed) + db;
+        auto p = pk.load(std::memory_order_relaxed);
+        while(n > p && !pk.compare_exchange_weak(p, n, std::memory_order_relaxed)) { }
+    }
+    /// account allocation of b bytes
+    void alloc(size_t b) { nAllocs.fetch_add(1, std::memory_order_relaxed); add(b); }
+    /// account release of b bytes
+    void release(size_t b) { nFrees.fetch_add(1, std::memory_order_relaxed); add(-(long long)b); }
+
+    /// current bytes
+    long long current() const { return cur.load(std::memory_order_relaxed); }
+    /// high-water mark bytes
+    long long peak() const { return pk.load(std::memory_order_relaxed); }
+    /// number of alloc() calls
+    size_t allocs() const { return nAllocs.load(std::memory_order_relaxed); }
+    /// number of release() calls
+    size_t frees() const { return nFrees.load(std::memory_order_relaxed); }
+    /// restart high-water mark from current value
+    void resetPeak() { pk.store(current(), std::memory_order_relaxed); }
+
+    /// add summary as child tag
+    void addXML(XMLTag& X) const;
+
+    const string name;  ///< subsystem name
+
+protected:
+    /// Constructor, via get()
+    explicit MemTag(const string& n): name(n) { }
+
+    std::atomic<long long> cur{0};      ///< current bytes
+    std::atomic<long long> pk{0};       ///< high-water mark bytes
+    std::atomic<size_t> nAllocs{0};     ///< number of allocations
+    std::atomic<size_t> nFrees{0};      ///< number of releases
+};
+
+/// Standard-library allocator adaptor counting container storage to a MemTag
+template<typename T>
+class TaggedAllocator {
+public:
+    typedef T value_type;   ///< allocated type
+
+    /// Constructor, with tag to account to
+    explicit TaggedAllocator(MemTag& t): tag(&t) { }
+    /// Constructor, with tag name
+    explicit TaggedAllocator(const string& name): tag(&MemTag::get(name)) { }
+    /// rebinding copy constructor
+    template<typename U>
+    TaggedAllocator(const TaggedAllocator<U>& a): tag(a.tag) { }
+
+    /// allocate n items
+    T* allocate(size_t n) {
+        auto p = std::allocator<T>().allocate(n);
+        tag->alloc(n*sizeof(T));
+        return p;
+    }
+    /// release n items at p
+    void deallocate(T* p, size_t n) {
+        tag->release(n*sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    /// equality comparison
+    template<typename U>
+    bool operator==(const TaggedAllocator<U>& a) const { return tag == a.tag; }
+    /// inequality comparison
+    template<typename U>
+    bool operator!=(const TaggedAllocator<U>& a) const { return tag != a.tag; }
+
+    MemTag* tag;    ///< accounting tag
+};
+
+/// vector with storage accounted to MemTag
+template<typename T>
+using tagged_vector = std::vector<T, TaggedAllocator<T>>;
+
+/// process resident set size [bytes], current or peak (0 if unavailable)
+long long processRSS(bool peak = false);
+
+/// XML report of all MemTag counters and process memory, with optional periodic sampling thread
+class MemReport: public XMLProvider {
+public:
+    /// Constructor, with sampling period [s] (0 for final summary only)
+    explicit MemReport(double dt = 0);
+    /// Destructor, stopping sampling
+    ~MemReport();
+
+    /// record one sample of all tags now
+    void sample();
+    /// print current tags summary to stdout
+    static void display();
+
+    bool print = false;         ///< whether to display() each periodic sample
+    size_t maxSamples = 10000;  ///< maximum samples kept (thinned by half when reached)
+
+protected:
+    /// XML output
+    void _makeXML(XMLTag& X) override;
+
+    /// one time point
+    struct sample_t {
+        double t;                       ///< time since start [s]
+        long long rss;                  ///< process resident set [bytes]
+        vector<long long> b;            ///< bytes for each tag in tags
+    };
+
+    const double dt;                    ///< sampling period [s]
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();   ///< start time
+    vector<const MemTag*> tags;         ///< sampled tags, in order of first appearance
+    vector<sample_t> samples;           ///< periodic samples
+    double tstep;                       ///< current interval between kept samples [s]
+
+    std::mutex M;                       ///< lock on samples, stop
+    std::condition_variable cv;         ///< stop notification
+    bool stop = false;                  ///< sampling thread stop request
+    std::thread T;                      ///< sampling thread
+};
+
+#endif
@@ -0,0 +1,52 @@
+/// \file MonotonicArena.cc
+
+#include "MonotonicArena.hh"
+#include <algorithm>
+#include <new>
+
+/// global new/delete resource
+class HeapResource: public MemoryResource {
+protected:
+    /// allocate
+    void* do_allocate(size_t bytes, size_t) override { return ::operator new(bytes); }
+    /// deallocate
+    void do_deallocate(void* p, size_t, size_t) override { ::operator delete(p); }
+};
+
+MemoryResource* MemoryResource::heap() {
+    static HeapResource H;
+    return &H;
+}
+
+void* MonotonicArena::alloc_chunk(size_t bytes, size_t align) {
+    if(chunks.size()) used += cur - chunks.back().first;
+    auto n = std::max(nextChunk, bytes + align);
+    auto c = static_cast<char*>(upstream->allocate(n));
+    chunks.emplace_back(c, n);
+    cur = c;
+    end = c + n;
+    nextChunk = 2*n;
+    return alloc(bytes, align);
+}
+
+void MonotonicArena::reset() {
+    auto u = bytes_used();
+    if(u > peak) peak = u;
+    if(chunks.size() > 1) {
+        // replace with single chunk holding all recent use
+        ++nRegrow;
+        auto n = bytes_reserved();
+        release();
+        nextChunk = n;
+        alloc_chunk(0, 1);
+    }
+    used = 0;
+    cur = chunks.size()? chunks.back().first : nullptr;
+}
+
+void MonotonicArena::release() {
+    for(auto& c: chunks) upstream->deallocate(c.first, c.second);
+    chunks.clear();
+    cur = end = nullptr;
+    used = 0;
+}
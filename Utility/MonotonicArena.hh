@@ -0,0 +1,150 @@
+/// \file MonotonicArena.hh Bump-pointer arena for per-event transient allocations, with STL allocator adaptor
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef MONOTONICARENA_HH
+#define MONOTONICARENA_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using std::vector;
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+#include <memory_resource>
+#define MONOTONICARENA_PMR
+#endif
+
+/// Polymorphic memory resource interface (C++14 stand-in for std::pmr::memory_resource)
+class MemoryResource {
+public:
+    /// Polymorphic destructor
+    virtual ~MemoryResource() { }
+
+    /// allocate bytes with alignment
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) { return do_allocate(bytes, align); }
+    /// return allocation
+    void deallocate(void* p, size_t bytes, size_t align = alignof(std::max_align_t)) { do_deallocate(p, bytes, align); }
+    /// whether allocations from one may be freed by the other
+    bool is_equal(const MemoryResource& o) const noexcept { return this == &o || do_is_equal(o); }
+
+    /// global new/delete resource
+    static MemoryResource* heap();
+
+protected:
+    /// allocation implementation
+    virtual void* do_allocate(size_t bytes, size_t align) = 0;
+    /// deallocation implementation
+    virtual void do_deallocate(void* p, size_t bytes, size_t align) = 0;
+    /// equality implementation
+    virtual bool do_is_equal(const MemoryResource& o) const noexcept { return this == &o; }
+};
+
+/// Monotonic (bump-pointer) arena: deallocate() is a no-op; all memory recycled at once by reset(), e.g. once per event
+class MonotonicArena: public MemoryResource {
+public:
+    /// Constructor, with initial chunk size [bytes] and upstream resource for chunks
+    explicit MonotonicArena(size_t chunk0 = 1 << 16, MemoryResource* up = heap()): upstream(up), nextChunk(chunk0) { }
+    /// Destructor
+    ~MonotonicArena() { release(); }
+    /// no copy
+    MonotonicArena(const MonotonicArena&) = delete;
+    /// no assignment
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    /// bump-allocate (fast path inline; new chunk when current exhausted)
+    void* alloc(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        auto p = (uintptr_t(cur) + align - 1) & ~(align - 1);
+        if(p + bytes > uintptr_t(end)) return alloc_chunk(bytes, align);
+        cur = reinterpret_cast<char*>(p + bytes);
+        return reinterpret_cast<void*>(p);
+    }
+    /// invalidate all allocations; keep one chunk sized for everything used since last reset
+    void reset();
+    /// return all chunks to upstream
+    void release();
+
+    /// bytes allocated since reset (including alignment padding)
+    size_t bytes_used() const { return used + (chunks.size()? cur - chunks.back().first : 0); }
+    /// bytes held from upstream
+    size_t bytes_reserved() const { size_t n = 0; for(auto& c: chunks) n += c.second; return n; }
+    /// maximum bytes_used() at any reset()
+    size_t peak_used() const { return peak; }
+    /// number of reset() calls that needed more than one chunk
+    size_t n_regrows() const { return nRegrow; }
+
+protected:
+    /// allocate from arena
+    void* do_allocate(size_t bytes, size_t align) override { return alloc(bytes, align); }
+    /// no-op: memory reclaimed by reset()
+    void do_deallocate(void*, size_t, size_t) override { }
+    /// get new chunk large enough for allocation
+    void* alloc_chunk(size_t bytes, size_t align);
+
+    MemoryResource* upstream;                   ///< source of chunks
+    size_t nextChunk;                           ///< size for next chunk [bytes]
+    vector<std::pair<char*, size_t>> chunks;    ///< chunks (start, size); last is current
+    char* cur = nullptr;                        ///< allocation point in current chunk
+    char* end = nullptr;                        ///< end of current chunk
+    size_t used = 0;                            ///< bytes used in chunks before current
+    size_t peak = 0;                            ///< peak bytes used between resets
+    size_t nRegrow = 0;                         ///< number of multi-chunk resets
+};
+
+/// STL-compatible allocator from MemoryResource (C++14 analog of std::pmr::polymorphic_allocator)
+template<typename T>
+class ArenaAllocator {
+public:
+    /// allocated type
+    typedef T value_type;
+
+    /// Constructor, from resource (default global heap)
+    ArenaAllocator(MemoryResource* r = MemoryResource::heap()) noexcept: R(r) { }
+    /// converting copy constructor
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& o) noexcept: R(o.resource()) { }
+
+    /// allocate n items
+    T* allocate(size_t n) { return static_cast<T*>(R->allocate(n*sizeof(T), alignof(T))); }
+    /// deallocate n items
+    void deallocate(T* p, size_t n) { R->deallocate(p, n*sizeof(T), alignof(T)); }
+    /// copied containers use heap, so copies may outlive arena reset
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    /// underlying resource
+    MemoryResource* resource() const { return R; }
+
+protected:
+    MemoryResource* R;  ///< memory resource
+};
+
+/// allocator equality
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.resource()->is_equal(*b.resource()); }
+/// allocator inequality
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return !(a == b); }
+
+/// vector with (optionally) arena-allocated storage
+template<typename T>
+using arena_vector = vector<T, ArenaAllocator<T>>;
+
+#ifdef MONOTONICARENA_PMR
+/// std::pmr::memory_resource view of MemoryResource, for std::pmr containers
+class PmrResourceAdaptor: public std::pmr::memory_resource {
+public:
+    /// Constructor
+    explicit PmrResourceAdaptor(MemoryResource& r): R(r) { }
+protected:
+    /// allocate
+    void* do_allocate(size_t bytes, size_t align) override { return R.allocate(bytes, align); }
+    /// deallocate
+    void do_deallocate(void* p, size_t bytes, size_t align) override { R.deallocate(p, bytes, align); }
+    /// equality
+    bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override {
+        auto a = dynamic_cast<const PmrResourceAdaptor*>(&o);
+        return a && R.is_equal(a->R);
+    }
+    MemoryResource& R;  ///< wrapped resource
+};
+#endif
+
+#endif
@@ -5,7 +5,11 @@
 //
 // -- Michael P. Mendenhall, 2015
 
+#ifndef NCUBICGRID_HH
+#define NCUBICGRID_HH
+
 #include <stddef.h>
+#include <string.h>
 #include <vector>
 using std::vector;
 #include <iostream>
@@ -13,6 +17,10 @@ using std::istream;
 using std::ostream;
 #include <cassert>
 
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && !defined(__AVX2__)
+#define NCUBICGRID_AVX2 ///< runtime-selected AVX2 batch evaluation
+#endif
+
 /// Cubic interpolation on N-dimensional uniform grid TODO: boundary conditions unimplemented
 template<size_t N, typename T>
 class NCubicGrid {
@@ -37,6 +45,14 @@ public:
 
     /// evaluate at given position
     T operator()(const T x[N]) const;
+    /// batch evaluate n points x[n][N] into y[n] (vectorized; uses coefficient cache if present)
+    void eval(const T* x, T* y, size_t n) const;
+    /// precompute per-cell polynomial coefficients (4^N per cell) for faster eval(); call after set(); cleared by set()
+    void cacheCoefficients();
+    /// discard coefficient cache
+    void clearCoefficients() { vector<T>().swap(coeffs); }
+    /// whether coefficient cache is present
+    bool hasCoefficients() const { return coeffs.size(); }
     /// evaluate at given position: linear interpolation
     inline T eval_linear(const T x[N]) const;
     /// access (user) grid point value
@@ -62,6 +78,23 @@ public:
     size_t idx(const size_t i[N]) const;
     /// interpolate point in grid coordinates
     inline T eval_interpolated(const T x[N]) const;
+
+protected:
+    static constexpr size_t N_ROWS = size_t(1) << 2*(N-1);  ///< number of 4-point rows in interpolation stencil
+
+    /// evaluate batch, from data or cached coefficients (body compiled in both generic and AVX2-targeted instantiations)
+    template<bool CACHED>
+    inline void _eval_batch(const T* x, T* y, size_t n) const __attribute__((always_inline));
+    /// evaluate batch, default instruction set
+    void eval_batch_generic(const T* x, T* y, size_t n) const;
+#ifdef NCUBICGRID_AVX2
+    /// evaluate batch, AVX2/FMA instruction set
+    __attribute__((target("avx2,fma"))) void eval_batch_avx2(const T* x, T* y, size_t n) const;
+#endif
+
+    size_t rowOffset[N_ROWS];   ///< data offsets for stencil rows, axis 1 fastest
+    size_t NCell[N];            ///< cached-coefficient cell stride along each axis
+    vector<T> coeffs;           ///< cached polynomial coefficients, 4^N per cell
 };
 
 ////////////////////////////////////////////
@@ -116,6 +149,12 @@ void NCubicGrid<N,T>::setDimensions(const size_t d[N]) {
         ns *= d[a]+4;
     }
     dat.resize(ns);
+
+    for(size_t r = 0; r < N_ROWS; r++) {
+        rowOffset[r] = 0;
+        for(size_t a = 1, rr = r; a < N; a++, rr /= 4) rowOffset[r] += (rr%4)*NStep[a];
+    }
+    clearCoefficients();
 }
 
 template<size_t N, typename T>
@@ -137,6 +176,7 @@ void NCubicGrid<N,T>::set(const size_t i[N], T v) {
     size_t ii = idx(i);
     dat[ii + g_offset] = v;
     // TODO set guard points for boundary conditions
+    clearCoefficients();
 }
 
 template<size_t N, typename T>
@@ -282,3 +322,135 @@ void NCubicGrid<N,T>::read(istream& is) {
     setDimensions(NX);
     is.read((char*)dat.data(), sizeof(dat[0])*dat.size());
 }
+
+/// SIMD four-element vector for batch interpolation kernel
+#ifdef __GNUC__
+template<typename T>
+struct ncg_v4 { typedef T type __attribute__((vector_size(4*sizeof(T)))); };
+#endif
+
+template<size_t N, typename T>
+template<bool cached>
+inline void NCubicGrid<N,T>::_eval_batch(const T* x, T* y, size_t n) const {
+    for(size_t j = 0; j < n; j++, x += N) {
+        // cell and weights along each axis: Catmull-Rom weights on data, or monomials on cached coefficients
+        const T* i0 = cached? coeffs.data() : dat.data();
+        size_t c = 0;
+        T w[N][4];
+        bool inrange = true;
+        for(size_t a = 0; a < N; a++) {
+            T xx = sx[a]*(x[a]-ox[a]);
+            int ix = int(xx);
+            T f = xx - ix;
+            if(f < 0) { f += 1; ix -= 1; }
+            if(ix < 1 || ix > int(NX[a]+1)) { inrange = false; break; }
+            const T ff = f*f;
+            const T fff = f*ff;
+            if(cached) {
+                c += (ix-1)*NCell[a];
+                w[a][0] = 1; w[a][1] = f; w[a][2] = ff; w[a][3] = fff;
+            } else {
+                i0 += (ix-1)*NStep[a];
+                w[a][0] = -0.5*(f - 2*ff + fff);
+                w[a][1] = 1 - 2.5*ff + 1.5*fff;
+                w[a][2] = 0.5*f + 2*ff - 1.5*fff;
+                w[a][3] = 0.5*(fff-ff);
+            }
+        }
+        if(!inrange) { y[j] = 0; continue; }
+        if(cached) i0 += c*4*N_ROWS;
+
+        // outer products of weights for axes 1...N-1, axis 1 fastest (matching rowOffset)
+        T ow[N_ROWS];
+        ow[0] = 1;
+        for(size_t a = 1, nr = 1; a < N; a++, nr *= 4) {
+            for(size_t k = 1; k < 4; k++) for(size_t r = 0; r < nr; r++) ow[r + k*nr] = ow[r]*w[a][k];
+            for(size_t r = 0; r < nr; r++) ow[r] *= w[a][0];
+        }
+
+        // accumulate rows of 4 contiguous points along axis 0 (independent partial sums to hide FMA latency)
+#ifdef __GNUC__
+        typedef typename ncg_v4<T>::type v4;
+        v4 pacc[4] = {};
+        for(size_t r = 0; r < N_ROWS; r++) {
+            v4 d;
+            memcpy(&d, i0 + (cached? 4*r : rowOffset[r]), sizeof(d));
+            pacc[r%4] += d*ow[r];
+        }
+        const v4 acc = (pacc[0] + pacc[1]) + (pacc[2] + pacc[3]);
+        y[j] = acc[0]*w[0][0] + acc[1]*w[0][1] + acc[2]*w[0][2] + acc[3]*w[0][3];
+#else
+        T acc[4] = {0, 0, 0, 0};
+        for(size_t r = 0; r < N_ROWS; r++) {
+            const T* d = i0 + (cached? 4*r : rowOffset[r]);
+            for(size_t k = 0; k < 4; k++) acc[k] += d[k]*ow[r];
+        }
+        y[j] = acc[0]*w[0][0] + acc[1]*w[0][1] + acc[2]*w[0][2] + acc[3]*w[0][3];
+#endif
+    }
+}
+
+template<size_t N, typename T>
+void NCubicGrid<N,T>::eval_batch_generic(const T* x, T* y, size_t n) const {
+    if(coeffs.size()) _eval_batch<true>(x, y, n);
+    else _eval_batch<false>(x, y, n);
+}
+
+#ifdef NCUBICGRID_AVX2
+template<size_t N, typename T>
+void NCubicGrid<N,T>::eval_batch_avx2(const T* x, T* y, size_t n) const {
+    if(coeffs.size()) _eval_batch<true>(x, y, n);
+    else _eval_batch<false>(x, y, n);
+}
+#endif
+
+template<size_t N, typename T>
+void NCubicGrid<N,T>::eval(const T* x, T* y, size_t n) const {
+#ifdef NCUBICGRID_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if(has_avx2) { eval_batch_avx2(x, y, n); return; }
+#endif
+    eval_batch_generic(x, y, n);
+}
+
+template<size_t N, typename T>
+void NCubicGrid<N,T>::cacheCoefficients() {
+    // Catmull-Rom weight k as polynomial sum_p B[k][p] x^p
+    static const T B[4][4] = { {0, -0.5, 1, -0.5}, {1, 0, -2.5, 1.5}, {0, 0.5, 2, -1.5}, {0, 0, -0.5, 0.5} };
+    static constexpr size_t NB = 4*N_ROWS; // coefficients per cell
+
+    size_t nc = 1;
+    for(size_t a = 0; a < N; a++) { NCell[a] = nc; nc *= NX[a]+1; }
+    vector<T> cf(nc*NB);
+
+    size_t ic[N];
+    for(size_t a = 0; a < N; a++) ic[a] = 0;
+    T blk[NB], tmp[NB];
+    for(size_t c = 0; c < nc; c++) {
+        // gather stencil: cell ic spans data points ic...ic+3 along each axis
+        size_t i0 = 0;
+        for(size_t a = 0; a < N; a++) i0 += ic[a]*NStep[a];
+        for(size_t r = 0; r < N_ROWS; r++) for(size_t k = 0; k < 4; k++) blk[4*r+k] = dat[i0 + rowOffset[r] + k];
+
+        // transform each axis from point values to polynomial coefficients
+        for(size_t a = 0, s = 1; a < N; a++, s *= 4) {
+            for(size_t i = 0; i < NB; i++) {
+                size_t p = (i/s)%4;
+                size_t b = i - p*s;
+                T v = 0;
+                for(size_t k = 0; k < 4; k++) v += B[k][p]*blk[b + k*s];
+                tmp[i] = v;
+            }
+            memcpy(blk, tmp, sizeof(blk));
+        }
+        memcpy(cf.data() + c*NB, blk, sizeof(blk));
+        for(size_t a = 0; a < N; a++) {
+            if(++ic[a] <= NX[a]) break;
+            ic[a] = 0;
+        }
+    }
+    coeffs.swap(cf);
+}
+
+#endif
+
@@ -24,6 +24,7 @@
 
 #include <stdexcept>
 #include <dirent.h>
+#include <glob.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <time.h>
@@ -33,11 +34,12 @@
 using std::set;
 
 bool fileExists(const string& f) {
-    return !system(("test -r '" + f + "'").c_str());
+    return !access(f.c_str(), R_OK);
 }
 
 bool dirExists(const string& d) {
-    return !system(("test -d '" + d + "'").c_str());
+    struct stat s;
+    return !stat(d.c_str(), &s) && S_ISDIR(s.st_mode);
 }
 
 void makePath(const string& p, bool forFile) {
@@ -55,11 +57,8 @@ void makePath(const string& p, bool forFile) {
         static set<string> madepaths;
         if(madepaths.count(thepath)) continue;
         madepaths.insert(thepath);
-        if(!dirExists(thepath)) {
-            string cmd = "mkdir -p '"+thepath+"'";
-            int err = system(cmd.c_str());
-            if(err || !dirExists(thepath)) throw std::runtime_error("Unable to make path '"+thepath+"'");
-        }
+        if(mkdir(thepath.c_str(), 0777) && (errno != EEXIST || !dirExists(thepath)))
+            throw std::runtime_error("Unable to make path '"+thepath+"'");
     }
 }
 
@@ -86,6 +85,15 @@ vector<string> listdir(const string& dir, bool includeHidden, bool fullPath) {
     return dirs;
 }
 
+vector<string> globFiles(const string& pattern) {
+    vector<string> v;
+    glob_t g;
+    if(!glob(pattern.c_str(), 0, nullptr, &g))
+        for(size_t i = 0; i < g.gl_pathc; ++i) v.push_back(g.gl_pathv[i]);
+    globfree(&g);
+    return v;
+}
+
 void combo_pdf(const vector<string>& namelist, const string& outname) {
     if(!namelist.size()) return;
     makePath(outname, true);
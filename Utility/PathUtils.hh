@@ -36,6 +36,8 @@ bool dirExists(const string& d);
 void makePath(const string& p, bool forFile = false);
 /// list directory contents
 vector<string> listdir(const string& dir, bool includeHidden = false, bool fullPath = false);
+/// sorted list of files matching shell wildcard pattern
+vector<string> globFiles(const string& pattern);
 /// get time since last file modification (s)
 double fileAge(const string& fname);
 /// Combine list of PDF files into one multi-page document
@@ -2,6 +2,8 @@
 
 #include "PointSelector.hh"
 #include "DiskBIO.hh"
+#include "WorkStealingPool.hh"
+#include <algorithm>
 
 void PointSelector::display() const {
     printf("PointSelector for %zu dimensions in %zu partitions:\n", Ntot, parts.size());
@@ -11,18 +13,18 @@ void PointSelector::display() const {
 void PointSelector::addPart(size_t N, size_t npts) {
     if(!N || !npts) return;
     for(auto& p: parts) p.Nsub *= npts;
-    parts.emplace_back(N,npts);
+    uint64_t s = scramble? scramble + 0x9e3779b97f4a7c15ULL * parts.size() : 0;
+    parts.emplace_back(N, npts, scramble && !s? 1 : s);
     v0.resize(v0.size() + N);
     Ntot += N;
     if(Ntot != v0.size()) throw std::logic_error("Invalid Ntot");
 }
 
 void PointSelector::skipTo(size_t i) {
-    for(auto it = parts.rbegin(); it != parts.rend(); ++it) {
-        auto j = i / it->Nsub;
-        //assert(j <= it->QRNGn);
-        it->QRNG.Skip(j - it->QRNGn);
-    }
+    // state as after generating point i-1
+    if(i) point(i-1, v0.data());
+    for(auto& p: parts) p.QRNGn = i? (i-1)/p.Nsub + 1 : 0;
+    subgroup = 0;
 }
 
 PointSelector::vec_t PointSelector::next() {
@@ -30,19 +32,62 @@ PointSelector::vec_t PointSelector::next() {
     subgroup = parts.size();
     for(auto it = parts.rbegin(); it != parts.rend(); ++it) {
         i -= it->N;
-        it->QRNG.Next(v0.data()+i);
+        it->QRNG.point(it->QRNGn, v0.data()+i);
         --subgroup;
         if(it->QRNGn++ % it->npts) break;
     }
     return v0;
 }
 
+void PointSelector::point(size_t i, double* x) const {
+    for(auto& p: parts) {
+        p.QRNG.point(i / p.Nsub, x);
+        x += p.N;
+    }
+}
+
+void PointSelector::fill(size_t i0, size_t n, double* X, int nthreads) const {
+    // fixed-size chunks: each point depends only on its index, so results are independent of threading
+    const size_t nchunk = 1024;
+    auto job = [this, i0, n, X](size_t c) {
+        const size_t a = i0 + c*nchunk;
+        const size_t b = std::min(a + nchunk, i0 + n);
+        vector<double> tmp;
+        size_t off = 0;
+        for(auto& p: parts) {
+            const size_t j0 = a / p.Nsub;
+            tmp.resize(((b-1)/p.Nsub - j0 + 1) * p.N);
+            p.QRNG.fill(j0, tmp.size()/p.N, tmp.data());
+            for(size_t k = a; k < b; ++k)
+                std::copy_n(tmp.data() + (k/p.Nsub - j0)*p.N, p.N, X + (k - i0)*Ntot + off);
+            off += p.N;
+        }
+    };
+
+    const size_t nc = (n + nchunk - 1)/nchunk;
+    if(nthreads == 1 || nc < 2) { for(size_t c = 0; c < nc; ++c) job(c); return; }
+    WorkStealingPool P(std::max(nthreads, 0));
+    for(size_t c = 0; c < nc; ++c) P.submit([&job, c] { job(c); });
+    P.wait_idle();
+}
+
+vector<PointSelector::vec_t> PointSelector::nextBatch(size_t n, int nthreads) {
+    const size_t i0 = nGenerated();
+    vec_t X(n*Ntot);
+    fill(i0, n, X.data(), nthreads);
+    vector<vec_t> v(n);
+    for(size_t k = 0; k < n; ++k) v[k].assign(X.begin() + k*Ntot, X.begin() + (k+1)*Ntot);
+    if(n) skipTo(i0 + n);
+    return v;
+}
+
 template<>
 void BinaryWriter::send<PointSelector::axpart>(const PointSelector::axpart& p) {
     send(p.N);
     send(p.npts);
     send(p.Nsub);
     send(p.QRNGn);
+    send(p.QRNG.getSeed());
 }
 
 template<>
@@ -51,8 +96,9 @@ void BinaryReader::receive<PointSelector::axpart>(PointSelector::axpart& p) {
     receive(p.npts);
     receive(p.Nsub);
     receive(p.QRNGn);
-    p.QRNG = ROOT::Math::QuasiRandomNiederreiter(p.N);
-    p.QRNG.Skip(p.QRNGn);
+    uint64_t s = 0;
+    receive(s);
+    p.QRNG = SobolSequence(p.N, s);
 }
 
 std::ostream& operator<<(std::ostream& o, const PointSelector& p) {
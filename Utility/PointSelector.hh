@@ -3,7 +3,7 @@
 #ifndef POINTSELECTOR_HH
 #define POINTSELECTOR_HH
 
-#include <Math/QuasiRandom.h>
+#include "SobolSequence.hh"
 #include <iostream>
 #include <vector>
 using std::vector;
@@ -15,10 +15,21 @@ public:
 
     /// Add partitioned subgroup of N elements, to be sampled npts times
     void addPart(size_t N, size_t npts);
-    /// skip to enumerated coordinate
+    /// set Owen scrambling seed (0 for unscrambled) for subsequently-added partitions
+    void setScramble(uint64_t s) { scramble = s; }
+    /// skip to enumerated coordinate (so next() returns point(i))
     void skipTo(size_t i);
     /// generate next coordinate
     vec_t next();
+    /// number of points generated (index of next point)
+    size_t nGenerated() const { return parts.size()? parts.back().QRNGn : 0; }
+
+    /// calculate enumerated coordinate i into x[Ntot], independent of generator state
+    void point(size_t i, double* x) const;
+    /// calculate n enumerated coordinates from i0 into rows of X[n*Ntot], over nthreads (0 for hardware); identical to serial sequence
+    void fill(size_t i0, size_t n, double* X, int nthreads = 1) const;
+    /// generate next n coordinates (as from n calls to next()), over nthreads
+    vector<vec_t> nextBatch(size_t n, int nthreads = 1);
     /// print debugging info to stdout
     void display() const;
     /// get number of points in full cycle
@@ -30,15 +41,15 @@ public:
     struct axpart {
         /// Default constructor
         axpart(): N(0), npts(0) { }
-        /// Constructor, with number of elements
-        axpart(size_t _N, size_t _npts): N(_N), npts(_npts), QRNG(N) { }
+        /// Constructor, with number of elements and scrambling seed
+        axpart(size_t _N, size_t _npts, uint64_t s = 0): N(_N), npts(_npts), QRNG(N, s) { }
 
         size_t N;           ///< number of items on this axis
         size_t npts;        ///< number of points to generate at this level
         size_t Nsub = 1;    ///< number of points for sub-groupings
 
-        ROOT::Math::QuasiRandomNiederreiter QRNG;   ///< quasirandom distribution generator
-        size_t QRNGn = 0;                           ///< number of points pulled from QRNG
+        SobolSequence QRNG; ///< quasirandom distribution generator
+        size_t QRNGn = 0;   ///< number of points pulled from QRNG
     };
 
 protected:
@@ -46,6 +57,7 @@ protected:
     vector<axpart> parts;   ///< partioning of N for sub-calculations
     size_t Ntot = 0;        ///< total number of dimensions
     vec_t v0;               ///< previously-generated point
+    uint64_t scramble = 0;  ///< scrambling seed for new partitions
 
     friend std::ostream& operator<< (std::ostream &o, const PointSelector& NM);
     friend std::istream& operator>> (std::istream &i, PointSelector& NM);
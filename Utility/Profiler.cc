@@ -0,0 +1,255 @@
+/// \file Profiler.cc
+
+#include "Profiler.hh"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdio.h>
+
+std::atomic<bool> Profiler::enabled{false};
+
+/// one thread's call-tree node
+struct pnode_t {
+    /// Constructor
+    pnode_t(const char* n, int p): name(n), parent(p) { }
+    const char* name;           ///< zone name
+    int parent;                 ///< parent node index
+    int child = -1;             ///< first child node index
+    int sibling = -1;           ///< next sibling node index
+    size_t calls = 0;           ///< number of entries
+    Profiler::tick_t t = 0;     ///< total ticks in zone
+    Profiler::tick_t t_child = 0; ///< total ticks in child zones
+};
+
+/// one recorded zone interval for tracing
+struct pevent_t {
+    const char* name;           ///< zone name
+    Profiler::tick_t t0;        ///< start time
+    Profiler::tick_t t1;        ///< end time
+};
+
+/// one thread's accumulated profile
+struct ThreadProfile {
+    /// Constructor
+    explicit ThreadProfile(size_t i): tid(i) { reset(); }
+    /// clear contents
+    void reset() {
+        nodes.assign(1, pnode_t("", -1));
+        cur = 0;
+        events.clear();
+    }
+
+    const size_t tid;           ///< thread number
+    vector<pnode_t> nodes;      ///< call tree nodes, [0] = root
+    int cur = 0;                ///< current node
+    vector<pevent_t> events;    ///< trace events
+};
+
+/// shared profiler state
+static struct {
+    std::mutex M;                               ///< lock on threads list, intern strings
+    vector<std::unique_ptr<ThreadProfile>> threads; ///< all threads' profiles (kept after threads exit)
+    std::set<string> names;                     ///< interned zone names
+    std::atomic<bool> trace{false};             ///< whether to record trace events
+    std::atomic<size_t> maxTrace{0};            ///< maximum trace events per thread
+    Profiler::tick_t tick0 = 0;                 ///< calibration start ticks
+    std::chrono::steady_clock::time_point clk0; ///< calibration start time
+} PS;
+
+/// calling thread's profile
+static thread_local ThreadProfile* myProfile = nullptr;
+
+void Profiler::enable(bool on, bool trace, size_t maxTrace) {
+    std::lock_guard<std::mutex> l(PS.M);
+    PS.trace = trace;
+    PS.maxTrace = maxTrace;
+    if(on && !PS.tick0) {
+        PS.tick0 = now();
+        PS.clk0 = std::chrono::steady_clock::now();
+    }
+    enabled = on;
+}
+
+const char* Profiler::intern(const string& s) {
+    std::lock_guard<std::mutex> l(PS.M);
+    return PS.names.insert(s).first->c_str();
+}
+
+double Profiler::tick_seconds() {
+#if defined(WITH_RDTSC) && defined(__x86_64__)
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - PS.clk0).count();
+    auto dn = now() - PS.tick0;
+    return dn? dt/dn : 0;
+#else
+    return 1e-9;
+#endif
+}
+
+Profiler::tick_t Profiler::enter(const char* name) {
+    auto P = myProfile;
+    if(!P) {
+        std::lock_guard<std::mutex> l(PS.M);
+        PS.threads.emplace_back(new ThreadProfile(PS.threads.size()));
+        P = myProfile = PS.threads.back().get();
+    }
+
+    int i = P->nodes[P->cur].child;
+    while(i >= 0 && P->nodes[i].name != name) i = P->nodes[i].sibling;
+    if(i < 0) {
+        i = P->nodes.size();
+        P->nodes.emplace_back(name, P->cur);
+        P->nodes[i].sibling = P->nodes[P->cur].child;
+        P->nodes[P->cur].child = i;
+    }
+    P->cur = i;
+    return now();
+}
+
+void Profiler::leave(tick_t t0) {
+    auto t1 = now();
+    auto P = myProfile;
+    if(!P || !P->cur) return;
+    auto& n = P->nodes[P->cur];
+    ++n.calls;
+    n.t += t1 - t0;
+    P->nodes[n.parent].t_child += t1 - t0;
+    if(PS.trace.load(std::memory_order_relaxed) && P->events.size() < PS.maxTrace.load(std::memory_order_relaxed)) P->events.push_back({n.name, t0, t1});
+    P->cur = n.parent;
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> l(PS.M);
+    for(auto& P: PS.threads) P->reset();
+}
+
+/// merge thread node i's children into merged zone Z
+static void mergeChildren(const ThreadProfile& P, int i, Profiler::zone_t& Z, double ts) {
+    for(int c = P.nodes[i].child; c >= 0; c = P.nodes[c].sibling) {
+        auto& n = P.nodes[c];
+        auto it = std::find_if(Z.children.begin(), Z.children.end(), [&n](const Profiler::zone_t& z) { return z.name == n.name; });
+        if(it == Z.children.end()) {
+            Z.children.emplace_back();
+            it = Z.children.end() - 1;
+            it->name = n.name;
+        }
+        it->calls += n.calls;
+        it->t += ts * n.t;
+        it->t_self += ts * (n.t - n.t_child);
+        mergeChildren(P, c, *it, ts);
+    }
+}
+
+/// sort zones by decreasing time
+static void sortZones(Profiler::zone_t& Z) {
+    std::sort(Z.children.begin(), Z.children.end(), [](const Profiler::zone_t& a, const Profiler::zone_t& b) { return a.t > b.t; });
+    for(auto& c: Z.children) sortZones(c);
+}
+
+Profiler::zone_t Profiler::callTree() {
+    zone_t Z;
+    auto ts = tick_seconds();
+    std::lock_guard<std::mutex> l(PS.M);
+    for(auto& P: PS.threads) mergeChildren(*P, 0, Z, ts);
+    for(auto& c: Z.children) Z.t += c.t;
+    sortZones(Z);
+    return Z;
+}
+
+/// accumulate flat summary from zone tree, skipping recursive re-entry totals
+static void flatten(const Profiler::zone_t& Z, std::map<string, Profiler::flat_t>& m, std::multiset<string>& path) {
+    for(auto& c: Z.children) {
+        auto& f = m[c.name];
+        f.calls += c.calls;
+        f.t_self += c.t_self;
+        if(!path.count(c.name)) f.t += c.t;
+        auto it = path.insert(c.name);
+        flatten(c, m, path);
+        path.erase(it);
+    }
+}
+
+std::map<string, Profiler::flat_t> Profiler::flat() {
+    std::map<string, flat_t> m;
+    std::multiset<string> path;
+    flatten(callTree(), m, path);
+    return m;
+}
+
+/// stream zone tree to XML (attributes in sorted order, matching XMLTag output)
+static void zoneXML(const Profiler::zone_t& Z, XMLWriter& W) {
+    for(auto& c: Z.children) {
+        W.open("zone");
+        W.attr("calls", c.calls);
+        W.attr("name", c.name);
+        W.attr("t_s", c.t);
+        W.attr("t_self_s", c.t_self);
+        zoneXML(c, W);
+        W.close();
+    }
+}
+
+void Profiler::addXML(XMLTag& X) {
+    XMLTagBuilder B(X);
+    writeXML(B);
+}
+
+void Profiler::writeXML(XMLWriter& W) {
+    auto Z = callTree();
+    std::map<string, flat_t> m;
+    std::multiset<string> path;
+    flatten(Z, m, path);
+
+    W.attr("t_s", Z.t);
+    W.attr("tick_s", tick_seconds());
+    W.open("calltree");
+    zoneXML(Z, W);
+    W.close();
+
+    vector<std::pair<string, flat_t>> v(m.begin(), m.end());
+    std::sort(v.begin(), v.end(), [](const std::pair<string, flat_t>& a, const std::pair<string, flat_t>& b) { return a.second.t_self > b.second.t_self; });
+    W.open("flat");
+    for(auto& kv: v) {
+        W.open("zone", true);
+        W.attr("calls", kv.second.calls);
+        W.attr("name", kv.first);
+        W.attr("t_s", kv.second.t);
+        W.attr("t_self_s", kv.second.t_self);
+        W.close();
+    }
+    W.close();
+}
+
+/// JSON-escaped string
+static string json_escape(const char* s) {
+    string r;
+    for(; *s; ++s) {
+        if(*s == '"' || *s == '\\') r += '\\';
+        if((unsigned char)*s < 0x20) {
+            char b[8];
+            snprintf(b, sizeof(b), "\\u%04x", *s);
+            r += b;
+        } else r += *s;
+    }
+    return r;
+}
+
+void Profiler::writeChromeTrace(ostream& o) {
+    auto us = 1e6 * tick_seconds();
+    std::lock_guard<std::mutex> l(PS.M);
+    o << "{\"traceEvents\":[";
+    bool first = true;
+    char b[128];
+    for(auto& P: PS.threads) {
+        snprintf(b, sizeof(b), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%zu,\"args\":{\"name\":\"thread %zu\"}}", P->tid, P->tid);
+        o << (first? "\n" : ",\n") << b;
+        first = false;
+        for(auto& e: P->events) {
+            snprintf(b, sizeof(b), "\",\"ph\":\"X\",\"pid\":0,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                     P->tid, us * (e.t0 - PS.tick0), us * (e.t1 - e.t0));
+            o << ",\n{\"name\":\"" << json_escape(e.name) << b;
+        }
+    }
+    o << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
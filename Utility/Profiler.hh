@@ -0,0 +1,114 @@
+/// \file Profiler.hh Hierarchical scoped-zone timing profiler, with per-thread accumulation and merged reports
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef PROFILER_HH
+#define PROFILER_HH
+
+#include "XMLWriter.hh"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+using std::vector;
+using std::string;
+#if defined(WITH_RDTSC) && defined(__x86_64__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+/// Global hierarchical timing profiler: ProfileZone scopes accumulate into per-thread call trees, merged on report
+class Profiler {
+public:
+    /// timestamp counter type
+    typedef uint64_t tick_t;
+
+    /// current timestamp (TSC if compiled WITH_RDTSC; otherwise steady_clock ns)
+    static tick_t now() {
+#if defined(WITH_RDTSC) && defined(__x86_64__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /// turn zone recording on/off; optionally record up to maxTrace per-thread events for Chrome trace output
+    static void enable(bool on = true, bool trace = false, size_t maxTrace = 1 << 20);
+    /// whether zones are being recorded
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    /// stable C string with contents s, for dynamically-named zones
+    static const char* intern(const string& s);
+
+    /// enter named zone on calling thread, returning start time (use ProfileZone instead)
+    static tick_t enter(const char* name);
+    /// leave current zone on calling thread, entered at t0 (use ProfileZone instead)
+    static void leave(tick_t t0);
+
+    /// merged call-tree node
+    struct zone_t {
+        string name;            ///< zone name
+        size_t calls = 0;       ///< number of entries
+        double t = 0;           ///< total time in zone [s]
+        double t_self = 0;      ///< time excluding child zones [s]
+        vector<zone_t> children;///< sub-zones
+    };
+    /// flat per-name summary
+    struct flat_t {
+        size_t calls = 0;       ///< number of entries
+        double t = 0;           ///< total time, not double-counting recursion [s]
+        double t_self = 0;      ///< time excluding child zones [s]
+    };
+
+    /// all threads' zones merged by call path (call when no zones in progress)
+    static zone_t callTree();
+    /// all threads' zones merged by name (call when no zones in progress)
+    static std::map<string, flat_t> flat();
+    /// add call tree and flat summary to XML output (call when no zones in progress)
+    static void addXML(XMLTag& X);
+    /// stream call tree and flat summary to XML output (call when no zones in progress)
+    static void writeXML(XMLWriter& W);
+    /// write recorded trace events in Chrome trace JSON format (chrome://tracing, Perfetto) (call when no zones in progress)
+    static void writeChromeTrace(ostream& o);
+    /// discard all recorded data (call when no zones in progress)
+    static void reset();
+    /// seconds per tick_t count
+    static double tick_seconds();
+
+protected:
+    static std::atomic<bool> enabled;   ///< whether zones are recorded
+};
+
+/// RAII profiler zone: times scope from construction to destruction, nested within enclosing zones
+class ProfileZone {
+public:
+    /// Constructor, entering zone (name must remain valid until reported; see Profiler::intern)
+    explicit ProfileZone(const char* name): active(Profiler::isEnabled()) { if(active) t0 = Profiler::enter(name); }
+    /// Constructor, entering (interned) dynamically-named zone
+    explicit ProfileZone(const string& name): active(Profiler::isEnabled()) { if(active) t0 = Profiler::enter(Profiler::intern(name)); }
+    /// Destructor, leaving zone
+    ~ProfileZone() { if(active) Profiler::leave(t0); }
+    /// no copy
+    ProfileZone(const ProfileZone&) = delete;
+    /// no assignment
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+protected:
+    const bool active;  ///< whether zone was entered
+    Profiler::tick_t t0 = 0;    ///< zone start time
+};
+
+/// XML output wrapper for Profiler results
+class ProfileReport: public XMLProvider {
+public:
+    /// Constructor
+    ProfileReport(): XMLProvider("Profiler") { }
+
+protected:
+    /// XML output
+    void _makeXML(XMLTag& X) override { Profiler::addXML(X); }
+    /// streamed XML output
+    void _writeXML(XMLWriter& W) override { W.attrs(xattrs); Profiler::writeXML(W); }
+};
+
+#endif
@@ -20,8 +20,10 @@
  */
 
 #include "ProgressBar.hh"
+#include <algorithm> // for std::min
 #include <limits> // for std::numeric_limits
 #include <stdexcept> // for std::domain_error
+#include <unistd.h> // for isatty
 
 ProgressBar::ProgressBar(uint64_t nt, unsigned int ns, bool v):
 ntotal(nt), nsteps(ns), nstp_ntot(nt*ns), c_nstp(0), s_ntot(0), verbose(v) {
@@ -50,3 +52,89 @@ void ProgressBar::_update(uint64_t cn) {
         }
     } else s_ntot = c_nstp;
 }
+
+//////////////////////////////////////////////////
+
+ProgressMeter::ProgressMeter(uint64_t nt, unsigned int ms, bool v, const string& lbl):
+ProgressMeter(nt, ms, v, lbl, true) { }
+
+ProgressMeter::ProgressMeter(uint64_t nt, unsigned int ms, bool v, const string& lbl, bool autostart):
+label(lbl), interval_ms(ms? ms : 1), verbose(v), t0(std::chrono::steady_clock::now()), tty(isatty(fileno(stdout))) {
+    if(autostart) acquire();
+    addTotal(nt);
+}
+
+ProgressMeter::~ProgressMeter() {
+    std::unique_lock<std::mutex> l(M);
+    if(!nacquired) return;
+    nacquired = 1;
+    l.unlock();
+    release();
+}
+
+ProgressMeter& ProgressMeter::global() {
+    static ProgressMeter PM(0, 1000, true, "", false);
+    return PM;
+}
+
+double ProgressMeter::eta() const {
+    auto n = done();
+    auto nt = total();
+    auto r = rate();
+    if(!nt || n > nt || !(r > 0)) return -1;
+    return (nt - n)/r;
+}
+
+void ProgressMeter::acquire() {
+    std::lock_guard<std::mutex> l(M);
+    if(nacquired++) return;
+    ndone = 0;
+    ntotal = 0;
+    t0 = std::chrono::steady_clock::now();
+    if(verbose) T = std::thread(&ProgressMeter::displayLoop, this);
+}
+
+void ProgressMeter::release() {
+    {
+        std::lock_guard<std::mutex> l(M);
+        if(!nacquired || --nacquired) return;
+        stopReq.notify_all();
+    }
+    if(T.joinable()) T.join();
+    if(verbose) display(true);
+}
+
+void ProgressMeter::displayLoop() {
+    std::unique_lock<std::mutex> l(M);
+    while(!stopReq.wait_for(l, std::chrono::milliseconds(interval_ms), [this] { return !nacquired; })) {
+        l.unlock();
+        display();
+        l.lock();
+    }
+}
+
+/// format time interval as [h:]mm:ss
+static string hms(double t) {
+    char b[32];
+    auto s = long(t + 0.5);
+    if(s >= 3600) snprintf(b, sizeof(b), "%ld:%02ld:%02ld", s/3600, (s/60)%60, s%60);
+    else snprintf(b, sizeof(b), "%ld:%02ld", s/60, s%60);
+    return b;
+}
+
+void ProgressMeter::display(bool final) {
+    auto n = done();
+    auto nt = total();
+    auto t = elapsed();
+    char b[128];
+    int i = 0;
+    if(label.size()) i += snprintf(b + i, sizeof(b) - i, "%s ", label.c_str());
+    if(nt) i += snprintf(b + i, sizeof(b) - i, "[%5.1f%%] %llu / %llu", std::min(100.*n/nt, 100.), (unsigned long long)n, (unsigned long long)nt);
+    else i += snprintf(b + i, sizeof(b) - i, "%llu", (unsigned long long)n);
+    i += snprintf(b + i, sizeof(b) - i, " items, %.3g/s, %s", t > 0? n/t : 0., hms(t).c_str());
+    auto e = eta();
+    if(!final && e >= 0) snprintf(b + i, sizeof(b) - i, ", ETA %s", hms(e).c_str());
+    if(tty) printf("\r%-79s%s", b, final? "\n" : "");
+    else printf("%s\n", b);
+    fflush(stdout);
+}
@@ -24,6 +24,13 @@
 
 #include <stdio.h>
 #include <cstdint> // for uint64_t
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+using std::string;
 
 /// Print a progress bar to stdout
 class ProgressBar {
@@ -57,4 +64,91 @@ protected:
     const bool verbose;     ///< whether to display the progress bar
 };
 
+/// Thread-safe progress display: atomic item counts, status line with throughput and ETA printed every interval by timer thread
+class ProgressMeter {
+public:
+    /// Constructor, with total expected items, display interval [ms], whether to display, and label
+    explicit ProgressMeter(uint64_t nt = 0, unsigned int ms = 500, bool v = true, const string& lbl = "");
+    /// Destructor, printing final status
+    ~ProgressMeter();
+    /// no copy
+    ProgressMeter(const ProgressMeter&) = delete;
+    /// no assignment
+    ProgressMeter& operator=(const ProgressMeter&) = delete;
+
+    /// shared process-wide meter, aggregating all ProgressTask contributions; displays while any tasks active
+    static ProgressMeter& global();
+
+    /// count n completed items (thread-safe)
+    void increment(uint64_t n = 1) { ndone.fetch_add(n, std::memory_order_relaxed); }
+    /// prefix operator++ to increment
+    ProgressMeter& operator++() { increment(); return *this; }
+    /// add n to total expected items (thread-safe)
+    void addTotal(uint64_t n) { ntotal.fetch_add(n, std::memory_order_relaxed); }
+
+    /// number of completed items
+    uint64_t done() const { return ndone.load(std::memory_order_relaxed); }
+    /// total expected items
+    uint64_t total() const { return ntotal.load(std::memory_order_relaxed); }
+    /// elapsed time since start [s]
+    double elapsed() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+    /// mean completion rate since start [items/s]
+    double rate() const { auto t = elapsed(); return t > 0? done()/t : 0; }
+    /// estimated time to completion at mean rate [s]; negative if unknown
+    double eta() const;
+
+    /// start display thread if not already running (nesting counted); resets counts when starting
+    void acquire();
+    /// stop display thread, printing final status, after matching acquire() calls
+    void release();
+    /// print current status line
+    void display(bool final = false);
+
+    string label;           ///< display label
+    const unsigned int interval_ms; ///< display update interval [ms]
+    const bool verbose;     ///< whether to display progress
+
+protected:
+    /// Constructor, optionally without starting display (for global())
+    ProgressMeter(uint64_t nt, unsigned int ms, bool v, const string& lbl, bool autostart);
+    /// display thread loop
+    void displayLoop();
+
+    std::atomic<uint64_t> ndone{0};     ///< completed items
+    std::atomic<uint64_t> ntotal{0};    ///< total expected items
+    std::chrono::steady_clock::time_point t0;   ///< start time
+    std::mutex M;                       ///< lock on display thread control
+    std::condition_variable stopReq;    ///< display thread stop notification
+    std::thread T;                      ///< display thread
+    int nacquired = 0;                  ///< number of acquire() holders
+    bool tty;                           ///< whether stdout is a terminal (in-place updates)
+};
+
+/// One task's contribution to a (shared) ProgressMeter: counts locally, publishing in batches
+class ProgressTask {
+public:
+    /// Constructor, adding n expected items to meter, publishing every nbatch items
+    explicit ProgressTask(uint64_t n, ProgressMeter& PM = ProgressMeter::global(), uint64_t nbatch = 1024):
+    M(PM), batch(nbatch) { M.acquire(); M.addTotal(n); }
+    /// Destructor, publishing remaining count
+    ~ProgressTask() { flush(); M.release(); }
+    /// no copy
+    ProgressTask(const ProgressTask&) = delete;
+    /// no assignment
+    ProgressTask& operator=(const ProgressTask&) = delete;
+
+    /// count n completed items
+    void increment(uint64_t n = 1) { if((pending += n) >= batch) flush(); }
+    /// prefix operator++ to increment
+    ProgressTask& operator++() { increment(); return *this; }
+    /// publish pending count to meter
+    void flush() { M.increment(pending); pending = 0; }
+
+    ProgressMeter& M;       ///< meter being updated
+    const uint64_t batch;   ///< publishing interval
+
+protected:
+    uint64_t pending = 0;   ///< locally-counted items not yet published
+};
+
 #endif
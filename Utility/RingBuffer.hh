@@ -0,0 +1,189 @@
+/// \file RingBuffer.hh Contiguous-storage power-of-2 ring buffer with deque-like interface
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef RINGBUFFER_HH
+#define RINGBUFFER_HH
+
+#include <vector>
+using std::vector;
+#include <iterator>
+#include <stdexcept>
+#include <utility>      // for std::pair, std::move
+#include <algorithm>    // for std::min
+
+/// Double-ended queue in contiguous power-of-2 circular storage, growing by doubling
+/// unlike std::deque, references are invalidated by growth on push_back
+template<typename T>
+class RingBuffer {
+public:
+    /// stored type
+    typedef T value_type;
+    /// reference type
+    typedef T& reference;
+    /// const reference type
+    typedef const T& const_reference;
+    /// size type
+    typedef size_t size_type;
+
+    /// random-access iterator over buffer contents
+    template<class R, typename V>
+    class _iterator: public std::iterator<std::random_access_iterator_tag, V> {
+    public:
+        /// Constructor
+        _iterator(R* r = nullptr, size_t ii = 0): RB(r), i(ii) { }
+        /// conversion to const_iterator
+        operator _iterator<const R, const V>() const { return {RB, i}; }
+
+        /// dereference
+        V& operator*() const { return (*RB)[i]; }
+        /// member access
+        V* operator->() const { return &(*RB)[i]; }
+        /// offset access
+        V& operator[](ptrdiff_t d) const { return (*RB)[i + d]; }
+
+        /// increment
+        _iterator& operator++() { ++i; return *this; }
+        /// post-increment
+        _iterator operator++(int) { auto o = *this; ++i; return o; }
+        /// decrement
+        _iterator& operator--() { --i; return *this; }
+        /// post-decrement
+        _iterator operator--(int) { auto o = *this; --i; return o; }
+        /// advance
+        _iterator& operator+=(ptrdiff_t d) { i += d; return *this; }
+        /// retreat
+        _iterator& operator-=(ptrdiff_t d) { i -= d; return *this; }
+        /// offset
+        _iterator operator+(ptrdiff_t d) const { return {RB, i + d}; }
+        /// offset
+        friend _iterator operator+(ptrdiff_t d, const _iterator& it) { return it + d; }
+        /// offset
+        _iterator operator-(ptrdiff_t d) const { return {RB, i - d}; }
+        /// difference
+        ptrdiff_t operator-(const _iterator& rhs) const { return ptrdiff_t(i) - ptrdiff_t(rhs.i); }
+
+        /// comparison
+        bool operator==(const _iterator& rhs) const { return i == rhs.i; }
+        /// inequality
+        bool operator!=(const _iterator& rhs) const { return i != rhs.i; }
+        /// ordering
+        bool operator<(const _iterator& rhs) const { return i < rhs.i; }
+        /// ordering
+        bool operator>(const _iterator& rhs) const { return i > rhs.i; }
+        /// ordering
+        bool operator<=(const _iterator& rhs) const { return i <= rhs.i; }
+        /// ordering
+        bool operator>=(const _iterator& rhs) const { return i >= rhs.i; }
+
+    protected:
+        R* RB;      ///< buffer being iterated
+        size_t i;   ///< position relative to buffer front
+    };
+
+    /// iterator type
+    typedef _iterator<RingBuffer, T> iterator;
+    /// const_iterator type
+    typedef _iterator<const RingBuffer, const T> const_iterator;
+
+    /// Constructor, with initial capacity rounded up to power of 2
+    explicit RingBuffer(size_t c = 16) { reserve(c); }
+
+    /// number of items
+    size_t size() const { return nstored; }
+    /// check if empty
+    bool empty() const { return !nstored; }
+    /// allocated capacity
+    size_t capacity() const { return buf.size(); }
+
+    /// access i^th item from front
+    T& operator[](size_t i) { return buf[(i0 + i) & mask]; }
+    /// access i^th item from front
+    const T& operator[](size_t i) const { return buf[(i0 + i) & mask]; }
+    /// bounds-checked access
+    T& at(size_t i) { if(i >= nstored) throw std::out_of_range("RingBuffer::at"); return (*this)[i]; }
+    /// bounds-checked access
+    const T& at(size_t i) const { if(i >= nstored) throw std::out_of_range("RingBuffer::at"); return (*this)[i]; }
+
+    /// first item
+    T& front() { return buf[i0 & mask]; }
+    /// first item
+    const T& front() const { return buf[i0 & mask]; }
+    /// last item
+    T& back() { return (*this)[nstored - 1]; }
+    /// last item
+    const T& back() const { return (*this)[nstored - 1]; }
+
+    /// iterator to start
+    iterator begin() { return {this, 0}; }
+    /// iterator to end
+    iterator end() { return {this, nstored}; }
+    /// const_iterator to start
+    const_iterator begin() const { return {this, 0}; }
+    /// const_iterator to end
+    const_iterator end() const { return {this, nstored}; }
+
+    /// ensure capacity for at least c items, preserving contents
+    void reserve(size_t c) {
+        if(c <= buf.size()) return;
+        size_t c2 = buf.size()? buf.size() : 1;
+        while(c2 < c) c2 <<= 1;
+        vector<T> b2(c2);
+        for(size_t i = 0; i < nstored; ++i) b2[i] = std::move((*this)[i]);
+        std::swap(buf, b2);
+        mask = c2 - 1;
+        i0 = 0;
+    }
+
+    /// add item at end (o may refer to a contained item: copied aside before growth)
+    void push_back(const T& o) {
+        if(nstored < buf.size()) { next_back() = o; return; }
+        T x(o);
+        next_back() = std::move(x);
+    }
+    /// add item at end (o may refer to a contained item: moved aside before growth)
+    void push_back(T&& o) {
+        if(nstored < buf.size()) { next_back() = std::move(o); return; }
+        T x(std::move(o));
+        next_back() = std::move(x);
+    }
+    /// remove first item (storage retained for re-use)
+    void pop_front() { ++i0; --nstored; }
+    /// remove last item (storage retained for re-use)
+    void pop_back() { --nstored; }
+    /// remove all items
+    void clear() { i0 = nstored = 0; }
+
+    /// first contiguous span of contents (pointer, length)
+    std::pair<T*, size_t> array_one() {
+        size_t j = i0 & mask;
+        return {buf.data() + j, std::min(nstored, buf.size() - j)};
+    }
+    /// second contiguous span of contents, following array_one (pointer, length)
+    std::pair<T*, size_t> array_two() { return {buf.data(), nstored - array_one().second}; }
+    /// rotate storage so that contents are in one contiguous span; return pointer to front
+    T* linearize() {
+        if(array_two().second) {
+            vector<T> b2(buf.size());
+            for(size_t i = 0; i < nstored; ++i) b2[i] = std::move((*this)[i]);
+            std::swap(buf, b2);
+        } else if(nstored && (i0 & mask)) {
+            for(size_t i = 0; i < nstored; ++i) buf[i] = std::move((*this)[i]);
+        }
+        i0 = 0;
+        return buf.data();
+    }
+
+protected:
+    /// storage for new item at back, growing if needed
+    T& next_back() {
+        if(nstored == buf.size()) reserve(nstored? 2*nstored : 16);
+        return (*this)[nstored++];
+    }
+
+    vector<T> buf;          ///< circular storage
+    size_t mask = 0;        ///< index mask for power-of-2 storage
+    size_t i0 = 0;          ///< storage position of front item (before masking)
+    size_t nstored = 0;     ///< number of items
+};
+
+#endif
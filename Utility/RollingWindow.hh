@@ -29,6 +29,8 @@ public:
     inline unsigned int getCount() const { return itms.size(); }
     /// get average
     inline double getAvg() const { return sw/itms.size(); }
+    /// get time span from oldest to newest item
+    inline double getSpan() const { return itms.size()? itms.front().first - itms.back().first : 0; }
     /// get RMS deviation
     inline double getRMS() const { return sqrt((sww-sw*sw)/itms.size()); }
     /// get average excluding value
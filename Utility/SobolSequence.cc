@@ -0,0 +1,147 @@
+/// \file SobolSequence.cc
+
+#include "SobolSequence.hh"
+#include <mutex>
+#include <stdexcept>
+
+/// Joe-Kuo (new-joe-kuo-6.21201) initial direction numbers m_1...m_s for dimensions 1-15 (after van der Corput)
+static const uint32_t sobol_m0[][6] = {
+    {1}, {1,3}, {1,3,1}, {1,1,1}, {1,1,3,3}, {1,3,5,13},
+    {1,1,5,5,17}, {1,1,5,5,5}, {1,1,7,11,19}, {1,1,5,1,1}, {1,1,1,3,11}, {1,3,5,5,31},
+    {1,3,3,9,7,49}, {1,1,1,15,21,21}, {1,3,1,13,27,49}
+};
+/// number of tabulated dimensions
+static constexpr size_t sobol_nm0 = sizeof(sobol_m0)/sizeof(sobol_m0[0]);
+
+/// splitmix64 finalizer
+static uint64_t sobol_mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/// multiply polynomials over GF(2) modulo P of degree s
+static uint64_t gf2_mulmod(uint64_t a, uint64_t b, uint64_t P, unsigned int s) {
+    uint64_t r = 0;
+    while(b) {
+        if(b & 1) r ^= a;
+        b >>= 1;
+        a <<= 1;
+        if(a >> s & 1) a ^= P;
+    }
+    return r;
+}
+
+/// x^e modulo P of degree s
+static uint64_t gf2_xpow(uint64_t e, uint64_t P, unsigned int s) {
+    uint64_t r = 1, x = s > 1? 2 : (2 ^ P);
+    for(; e; e >>= 1) {
+        if(e & 1) r = gf2_mulmod(r, x, P, s);
+        x = gf2_mulmod(x, x, P, s);
+    }
+    return r;
+}
+
+/// whether degree-s polynomial P is primitive: x has multiplicative order 2^s - 1
+static bool gf2_primitive(uint64_t P, unsigned int s) {
+    const uint64_t n = (uint64_t(1) << s) - 1;
+    if(gf2_xpow(n, P, s) != 1) return false;
+    uint64_t m = n;
+    for(uint64_t q = 2; q*q <= m; ++q) {
+        if(m % q) continue;
+        if(gf2_xpow(n/q, P, s) == 1) return false;
+        while(!(m % q)) m /= q;
+    }
+    return m == 1 || m == n || gf2_xpow(n/m, P, s) != 1;
+}
+
+void SobolSequence::polynomial(size_t d, unsigned int& s, uint32_t& a) {
+    if(!d) throw std::logic_error("Sobol dimension 0 has no polynomial");
+    static std::mutex m;
+    static vector<std::pair<unsigned int, uint32_t>> polys;
+    std::lock_guard<std::mutex> l(m);
+    while(polys.size() < d) {
+        // continue enumeration in (degree, interior coefficients) order
+        unsigned int ps = polys.size()? polys.back().first : 1;
+        uint32_t pa = polys.size()? polys.back().second + 1 : 0;
+        while(true) {
+            if(pa >= (uint32_t(1) << (ps - 1))) { ++ps; pa = 0; }
+            if(ps > 31) throw std::runtime_error("Sobol dimension out of range");
+            if(gf2_primitive((uint64_t(1) << ps) | (uint64_t(pa) << 1) | 1, ps)) break;
+            ++pa;
+        }
+        polys.emplace_back(ps, pa);
+    }
+    s = polys[d-1].first;
+    a = polys[d-1].second;
+}
+
+SobolSequence::SobolSequence(size_t n, uint64_t sd): N(n), seed(sd), V(N*NBITS), dseed(N) {
+    for(size_t d = 0; d < N; ++d) {
+        uint32_t* v = V.data() + d*NBITS;
+        dseed[d] = uint32_t(sobol_mix(seed ^ sobol_mix(d)));
+        if(!d) {
+            for(int k = 0; k < NBITS; ++k) v[k] = uint32_t(1) << (NBITS - 1 - k);
+            continue;
+        }
+
+        unsigned int s;
+        uint32_t a;
+        polynomial(d, s, a);
+        for(unsigned int k = 0; k < s && k < unsigned(NBITS); ++k) {
+            // tabulated, or pseudorandom odd m_k < 2^k
+            uint32_t mk = d <= sobol_nm0? sobol_m0[d-1][k] : ((uint32_t(sobol_mix(d << 8 | k)) & ((uint32_t(2) << k) - 1)) | 1);
+            v[k] = mk << (NBITS - 1 - k);
+        }
+        for(unsigned int k = s; k < unsigned(NBITS); ++k) {
+            v[k] = v[k-s] ^ (v[k-s] >> s);
+            for(unsigned int j = 1; j < s; ++j) if((a >> (s - 1 - j)) & 1) v[k] ^= v[k-j];
+        }
+    }
+}
+
+uint32_t SobolSequence::scramble(uint32_t x, uint32_t s) {
+    // Burley (2020) hash-based Owen scramble: Laine-Karras permutation on reversed bits
+    auto rev = [](uint32_t y) {
+        y = ((y >> 1) & 0x55555555u) | ((y & 0x55555555u) << 1);
+        y = ((y >> 2) & 0x33333333u) | ((y & 0x33333333u) << 2);
+        y = ((y >> 4) & 0x0f0f0f0fu) | ((y & 0x0f0f0f0fu) << 4);
+        y = ((y >> 8) & 0x00ff00ffu) | ((y & 0x00ff00ffu) << 8);
+        return (y >> 16) | (y << 16);
+    };
+    x = rev(x);
+    x += s;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return rev(x);
+}
+
+void SobolSequence::point(uint64_t i, double* x) const { fill(i, 1, x); }
+
+void SobolSequence::fill(uint64_t i0, size_t n, double* X, size_t ldx) const {
+    if(!ldx) ldx = N;
+    if(n && (i0 + n - 1) >> NBITS) throw std::range_error("Sobol point index out of range");
+    const double u = 1./4294967296.;
+
+    // Antonov-Saleev (Gray code) order: point i = XOR of direction numbers for bits of gray(i)
+    vector<uint32_t> c(N);
+    const uint64_t g = i0 ^ (i0 >> 1);
+    for(size_t d = 0; d < N; ++d) {
+        const uint32_t* v = V.data() + d*NBITS;
+        for(int k = 0; k < NBITS; ++k) if(g >> k & 1) c[d] ^= v[k];
+    }
+
+    for(size_t j = 0; j < n; ++j) {
+        if(j) {
+            // gray(i) = gray(i - 1) ^ 2^ctz(i)
+            const int k = __builtin_ctzll(i0 + j);
+            for(size_t d = 0; d < N; ++d) c[d] ^= V[d*NBITS + k];
+        }
+        double* x = X + j*ldx;
+        if(seed) for(size_t d = 0; d < N; ++d) x[d] = u*scramble(c[d], dseed[d]);
+        else for(size_t d = 0; d < N; ++d) x[d] = u*c[d];
+    }
+}
@@ -0,0 +1,43 @@
+/// \file SobolSequence.hh Random-access Sobol quasi-random sequence, with optional Owen scrambling
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef SOBOLSEQUENCE_HH
+#define SOBOLSEQUENCE_HH
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+using std::vector;
+
+/// Sobol sequence in [0,1)^N: point i computed directly from i (no sequential state), up to 2^32 points
+class SobolSequence {
+public:
+    /// Constructor, with number of dimensions and Owen scrambling seed (0 for unscrambled)
+    explicit SobolSequence(size_t n = 0, uint64_t seed = 0);
+
+    /// number of dimensions
+    size_t nDim() const { return N; }
+    /// scrambling seed (0 for unscrambled)
+    uint64_t getSeed() const { return seed; }
+
+    /// calculate point i into x[N]
+    void point(uint64_t i, double* x) const;
+    /// calculate n points starting at i0 into rows of X (stride ldx >= N, or 0 for N)
+    void fill(uint64_t i0, size_t n, double* X, size_t ldx = 0) const;
+
+    /// primitive polynomial for dimension d >= 1, as (degree, interior coefficient bits)
+    static void polynomial(size_t d, unsigned int& s, uint32_t& a);
+
+protected:
+    static constexpr int NBITS = 32;    ///< bits per coordinate
+
+    size_t N;                   ///< number of dimensions
+    uint64_t seed;              ///< scrambling seed
+    vector<uint32_t> V;         ///< direction numbers V[d*NBITS + bit]
+    vector<uint32_t> dseed;     ///< per-dimension scrambling seeds
+
+    /// Owen (nested uniform) scramble of 32-bit fraction
+    static uint32_t scramble(uint32_t x, uint32_t s);
+};
+
+#endif
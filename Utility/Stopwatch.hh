@@ -8,18 +8,18 @@
 #include <chrono>
 #include <stdio.h>
 
-/// Stopwatch from construction to deletion
+/// Stopwatch from construction to deletion (see Profiler.hh for hierarchical, multi-threaded profiling)
 class Stopwatch {
 public:
-    /// Constructor
-    Stopwatch(bool go = true): running(!go) { if(go) start();  }
+    /// Constructor, optionally starting immediately, and whether to print start/stop messages
+    explicit Stopwatch(bool go = true, bool v = true): verbose(v), running(!go) { if(go) start();  }
     /// Destructor
     ~Stopwatch() { if(running) stop(); }
 
     /// start counting
     void start() {
         if(running) throw;
-        printf("Starting stopwatch...\n");
+        if(verbose) printf("Starting stopwatch...\n");
         running = true;
         t0 = std::chrono::steady_clock::now();
     }
@@ -30,15 +30,27 @@ public:
         running = false;
         auto t1 = std::chrono::steady_clock::now();
         auto dt = std::chrono::duration<double>(t1-t0).count();
+        interval = dt;
         elapsed += dt;
+        if(!verbose) return;
         if(elapsed == dt) printf("Elapsed time: %g seconds\n", elapsed);
         else printf("Interval: %g, total elapsed %g seconds\n", dt, elapsed);
     }
 
+    /// whether currently running
+    bool isRunning() const { return running; }
+    /// total elapsed time over all stopped intervals [s]
+    double getElapsed() const { return elapsed; }
+    /// duration of most recent stopped interval [s]
+    double getInterval() const { return interval; }
+
+    bool verbose;   ///< whether to print start/stop messages
+
 protected:
-    bool running;
+    bool running;   ///< whether currently counting
     std::chrono::time_point<std::chrono::steady_clock> t0;  ///< starting time
     double elapsed = 0;                                     ///< total elapsed time
+    double interval = 0;                                    ///< most recent interval
 };
 
 #endif
@@ -23,6 +23,7 @@
 #define STRINGMAP_HH
 
 #include <map>
+#include <stdlib.h>
 #include "StringManip.hh"
 using std::map;
 using std::multimap;
@@ -67,22 +68,15 @@ public:
 
     /// get first key value (double) or default
     double getDefault(const K& k, double d) const {
-        string str = this->getDefault(k,"");
-        if(!str.size()) return d;
-        std::stringstream ss(str);
-        ss >> d;
-        return d;
+        auto it = this->find(k);
+        if(it == this->end() || !it->second.size()) return d;
+        return strtod(it->second.c_str(), nullptr);
     }
 
     /// retrieve key values as doubles
     vector<double> retrieveDouble(const K& k) const {
         vector<double> v;
-        double d;
-        for(auto const& ss: this->retrieve(k)) {
-            std::stringstream str(ss);
-            str >> d;
-            v.push_back(d);
-        }
+        for(auto it = this->lower_bound(k); it != this->upper_bound(k); ++it) v.push_back(strtod(it->second.c_str(), nullptr));
         return v;
     }
 };
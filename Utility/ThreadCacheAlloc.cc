@@ -0,0 +1,231 @@
+/// \file ThreadCacheAlloc.cc
+
+#include "ThreadCacheAlloc.hh"
+#include <stdexcept>
+
+/// header preceding each block
+struct alignas(16) block_t {
+    struct heap_t* owner;   ///< heap block was handed out by (nullptr for large allocation)
+    block_t* next;          ///< free list link
+};
+
+/// one thread's cached blocks for a pool
+struct heap_t {
+    /// Constructor
+    explicit heap_t(ThreadCachePool::shared_t* s): S(s) { }
+
+    ThreadCachePool::shared_t* S;           ///< pool shared state
+    block_t* local = nullptr;               ///< owner-thread free list
+    size_t nlocal = 0;                      ///< number of blocks in local
+    std::atomic<block_t*> remote{nullptr};  ///< blocks returned by other threads
+    std::atomic<size_t> nAlloc{0};          ///< allocations (written only by owner thread)
+
+    /// push block onto local list
+    void push_local(block_t* b) {
+        b->next = local;
+        local = b;
+        ++nlocal;
+    }
+    /// push block onto remote list (any thread)
+    void push_remote(block_t* b) {
+        b->next = remote.load(std::memory_order_relaxed);
+        while(!remote.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed)) { }
+    }
+    /// move remote list onto local list
+    void collect_remote() {
+        auto b = remote.exchange(nullptr, std::memory_order_acquire);
+        while(b) {
+            auto nx = b->next;
+            push_local(b);
+            b = nx;
+        }
+    }
+};
+
+/// pool state shared by pool and using threads
+struct ThreadCachePool::shared_t {
+    /// Constructor
+    shared_t(size_t bs, size_t nm): bsize(bs), nmag(std::max(nm, size_t(1))) {
+        static std::atomic<size_t> nextId{0};
+        id = nextId++;
+    }
+    /// Destructor, releasing all cached blocks
+    ~shared_t() {
+        for(auto h: heaps) {
+            h->collect_remote();
+            free_list(h->local);
+            delete h;
+        }
+        free_list(depot);
+    }
+
+    /// release blocks in free list
+    static void free_list(block_t* b) {
+        while(b) {
+            auto nx = b->next;
+            ::operator delete(b);
+            b = nx;
+        }
+    }
+
+    /// get heap for new thread; call with lock
+    heap_t* adopt() {
+        if(abandoned.size()) {
+            auto h = abandoned.back();
+            abandoned.pop_back();
+            return h;
+        }
+        heaps.push_back(new heap_t(this));
+        return heaps.back();
+    }
+    /// release heap of exiting thread
+    void abandon(heap_t* h) {
+        std::lock_guard<std::mutex> l(mut);
+        h->collect_remote();
+        give(h, h->nlocal);
+        abandoned.push_back(h);
+    }
+    /// refill heap from depot, or remote returns to abandoned heaps; return whether successful
+    bool refill(heap_t* h) {
+        std::lock_guard<std::mutex> l(mut);
+        if(!depot) for(auto a: abandoned) { a->collect_remote(); give(a, a->nlocal); }
+        for(size_t i = 0; i < nmag && depot; ++i) {
+            auto b = depot;
+            depot = b->next;
+            h->push_local(b);
+        }
+        return h->local;
+    }
+    /// move n blocks from heap to depot; call with lock
+    void give(heap_t* h, size_t n) {
+        while(n-- && h->local) {
+            auto b = h->local;
+            h->local = b->next;
+            --h->nlocal;
+            b->next = depot;
+            depot = b;
+        }
+    }
+
+    const size_t bsize;             ///< usable block size
+    const size_t nmag;              ///< magazine size
+    size_t id;                      ///< unique identifier for thread-local lookup
+    std::mutex mut;                 ///< lock on depot and heaps lists
+    block_t* depot = nullptr;       ///< shared free list
+    vector<heap_t*> heaps;          ///< all heaps
+    vector<heap_t*> abandoned;      ///< heaps of exited threads
+    std::atomic<size_t> nMiss{0};   ///< new block allocations
+    std::atomic<size_t> nRemote{0}; ///< blocks returned by non-owning thread
+};
+
+/// per-thread heaps by pool id
+struct thread_heaps_t {
+    /// Destructor, releasing heaps on thread exit
+    ~thread_heaps_t() {
+        for(auto& p: v) if(p.first) p.first->abandon(p.second);
+        v.clear();
+        dead = true;
+    }
+    /// get heap for pool, or nullptr if exiting
+    heap_t* get(const std::shared_ptr<ThreadCachePool::shared_t>& S) {
+        if(dead) return nullptr;
+        if(v.size() <= S->id) v.resize(S->id + 1);
+        auto& p = v[S->id];
+        if(!p.first) {
+            std::lock_guard<std::mutex> l(S->mut);
+            p.second = S->adopt();
+            p.first = S;
+        }
+        return p.second;
+    }
+    /// current heap for pool if already present
+    heap_t* find(size_t id) const { return id < v.size()? v[id].second : nullptr; }
+
+    vector<std::pair<std::shared_ptr<ThreadCachePool::shared_t>, heap_t*>> v;  ///< heaps by pool id
+    static thread_local bool dead;  ///< set after thread's heaps released
+};
+
+thread_local bool thread_heaps_t::dead = false;
+static thread_local thread_heaps_t myHeaps;
+
+ThreadCachePool::ThreadCachePool(size_t bsize, size_t nmag):
+S(std::make_shared<shared_t>((std::max(bsize, size_t(1)) + 15) & ~size_t(15), nmag)) { }
+
+void* ThreadCachePool::allocate() {
+    auto h = myHeaps.get(S);
+    if(!h) { // thread exiting: not cached, but returnable
+        ++S->nMiss;
+        auto b = static_cast<block_t*>(::operator new(sizeof(block_t) + S->bsize));
+        b->owner = nullptr;
+        return b + 1;
+    }
+
+    if(!h->local) h->collect_remote();
+    if(!h->local) S->refill(h);
+    block_t* b;
+    if(h->local) {
+        b = h->local;
+        h->local = b->next;
+        --h->nlocal;
+    } else {
+        ++S->nMiss;
+        b = static_cast<block_t*>(::operator new(sizeof(block_t) + S->bsize));
+    }
+    h->nAlloc.store(h->nAlloc.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    b->owner = h;
+    return b + 1;
+}
+
+void ThreadCachePool::deallocate(void* p) {
+    if(!p) return;
+    auto b = static_cast<block_t*>(p) - 1;
+    auto h = b->owner;
+    if(!h) { ::operator delete(b); return; }
+
+    auto S = h->S;
+    if(thread_heaps_t::dead || myHeaps.find(S->id) != h) {
+        ++S->nRemote;
+        h->push_remote(b);
+        return;
+    }
+    h->push_local(b);
+    if(h->nlocal > 2*S->nmag) {
+        std::lock_guard<std::mutex> l(S->mut);
+        S->give(h, S->nmag);
+    }
+}
+
+ThreadCachePool* ThreadCachePool::forSize(size_t n) {
+    static vector<std::unique_ptr<ThreadCachePool>> classes = [] {
+        vector<std::unique_ptr<ThreadCachePool>> v;
+        for(size_t s = 16; s <= 256; s += 16) v.emplace_back(new ThreadCachePool(s));
+        for(size_t s = 512; s <= maxSizeClass; s *= 2) v.emplace_back(new ThreadCachePool(s, 16));
+        return v;
+    }();
+
+    if(n <= 256) return classes[n? (n - 1)/16 : 0].get();
+    size_t i = 16;
+    for(size_t s = 512; s <= maxSizeClass; s *= 2, ++i) if(n <= s) return classes[i].get();
+    return nullptr;
+}
+
+void* ThreadCachePool::alloc_size(size_t n) {
+    auto P = forSize(n);
+    if(P) return P->allocate();
+    auto b = static_cast<block_t*>(::operator new(sizeof(block_t) + n));
+    b->owner = nullptr;
+    return b + 1;
+}
+
+size_t ThreadCachePool::blockSize() const { return S->bsize; }
+
+size_t ThreadCachePool::n_misses() const { return S->nMiss; }
+
+size_t ThreadCachePool::n_remote() const { return S->nRemote; }
+
+size_t ThreadCachePool::n_hits() const {
+    std::lock_guard<std::mutex> l(S->mut);
+    size_t n = 0;
+    for(auto h: S->heaps) n += h->nAlloc.load(std::memory_order_relaxed);
+    return n > S->nMiss? n - S->nMiss : 0;
+}
@@ -0,0 +1,106 @@
+/// \file ThreadCacheAlloc.hh Thread-caching fixed-size block allocator, with lock-free cross-thread returns
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef THREADCACHEALLOC_HH
+#define THREADCACHEALLOC_HH
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+using std::vector;
+
+/*
+ * Each thread allocates from its own heap (magazine of free blocks) in each pool, without locking.
+ * Blocks remember the heap they were handed out by:
+ *  - freed in the same thread, they return to the local magazine;
+ *  - freed in another thread (e.g. end of a parallel chain), they are pushed onto the owner heap's
+ *    lock-free remote list, which the owner reclaims in one exchange when its magazine runs dry.
+ * Excess local blocks move to a shared (mutex-locked) depot in whole magazines.
+ * Heaps of exited threads are adopted by new threads; pool memory is freed when both the pool
+ * and all threads that used it are gone. Blocks must not be freed after that.
+ */
+
+/// Pool of fixed-size memory blocks with per-thread caches
+class ThreadCachePool {
+public:
+    /// Constructor, with block size and magazine size (blocks moved to/from depot at a time)
+    explicit ThreadCachePool(size_t bsize, size_t nmag = 64);
+    /// Destructor (memory released once all using threads have also exited)
+    ~ThreadCachePool() { }
+    /// no copy
+    ThreadCachePool(const ThreadCachePool&) = delete;
+    /// no assignment
+    ThreadCachePool& operator=(const ThreadCachePool&) = delete;
+
+    /// allocate one block
+    void* allocate();
+    /// free block from any pool (or alloc_size) in any thread
+    static void deallocate(void* p);
+
+    /// pool for size class holding n bytes (nullptr if larger than maxSizeClass)
+    static ThreadCachePool* forSize(size_t n);
+    /// allocate n bytes from size-class pool, or directly if too large
+    static void* alloc_size(size_t n);
+    /// largest size-class pool block size
+    static constexpr size_t maxSizeClass = 4096;
+
+    /// usable block size
+    size_t blockSize() const;
+    /// number of allocations served from cached blocks
+    size_t n_hits() const;
+    /// number of allocations requiring new memory
+    size_t n_misses() const;
+    /// number of blocks returned by non-owning threads
+    size_t n_remote() const;
+
+    struct shared_t;
+protected:
+    std::shared_ptr<shared_t> S;    ///< shared state, also held by using threads
+};
+
+/// Mix-in allocating derived (payload) class instances from ThreadCachePool size classes
+class ThreadCacheAllocated {
+public:
+    /// class allocation
+    static void* operator new(size_t n) { return ThreadCachePool::alloc_size(n); }
+    /// class deallocation
+    static void operator delete(void* p) { ThreadCachePool::deallocate(p); }
+};
+
+/// Wrapper opting class C into ThreadCachePool allocation, e.g. for ObjectFactory construction
+template<class C>
+class ThreadCached: public C {
+public:
+    /// inherit constructors
+    using C::C;
+    /// class allocation
+    static void* operator new(size_t n) { return ThreadCachePool::alloc_size(n); }
+    /// class deallocation
+    static void operator delete(void* p) { ThreadCachePool::deallocate(p); }
+};
+
+/// Thread-safe object pool interface (as LockedAllocPool) over ThreadCachePool; objects may be put() from any thread
+template<class T>
+class CachedAllocPool {
+public:
+    /// Constructor
+    CachedAllocPool(): P(sizeof(T)) { }
+    /// get newly-constructed item
+    T* get() { return new (P.allocate()) T; }
+    /// destruct and return item
+    void put(T* p) {
+        p->~T();
+        ThreadCachePool::deallocate(p);
+    }
+    /// number of get() requests served from pool
+    size_t n_hits() const { return P.n_hits(); }
+    /// number of get() requests requiring new allocation
+    size_t n_misses() const { return P.n_misses(); }
+protected:
+    ThreadCachePool P;  ///< underlying block pool
+};
+
+#endif
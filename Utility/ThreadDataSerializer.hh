@@ -5,41 +5,84 @@
 #define THREADDATASERIALIZER_HH
 
 #include "Threadworker.hh"
+#include "AllocPool.hh"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <vector>
 using std::vector;
 
 /// FIFO processing queue for collecting/serializing input from multiple threads
+/**
+    Default mode queues returned items in a mutex-locked vector.
+    setLockfree(n) selects multi-producer/single-consumer lock-free queueing on n priority lanes, each a bounded ring:
+    return_allocated() claims a slot with one atomic increment and publishes by the slot sequence number
+    (yielding while the lane is full), and the consumer drains all published slots of each lane per batch,
+    highest lane first. Producers only take the mutex to wake a sleeping consumer.
+*/
 template<typename T>
 class ThreadDataSerializer: public Threadworker {
 public:
     /// Data type being serialized
     typedef T data_t;
 
-    /// Constructor
-    ThreadDataSerializer() { }
+    /// Constructor, with maximum number of pooled re-usable objects
+    explicit ThreadDataSerializer(size_t maxPool = 4096): pool(maxPool) { }
     /// Destructor
     virtual ~ThreadDataSerializer() { clear_pool(); }
 
+    /// select lock-free queueing with nl priority lanes of (power-of-2 rounded) capacity, or 0 for mutex-locked queue;
+    /// call before use (not thread-safe)
+    void setLockfree(size_t nl, size_t capacity = 4096) {
+        vector<T*> v;
+        take_all(v);
+        size_t c = 2;
+        while(c < capacity) c *= 2;
+        nlanes = nl;
+        lanes.reset(nl? new lane_t[nl] : nullptr);
+        for(size_t l = 0; l < nl; ++l) {
+            lanes[l].mask = c - 1;
+            lanes[l].slots.reset(new slot_t[c]);
+            for(size_t i = 0; i < c; ++i) lanes[l].slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+        held.assign(nl, {});
+        if(nl) held[0] = v;
+        else queue = v;
+    }
+    /// number of lock-free priority lanes (0 for mutex-locked queue)
+    size_t getLanes() const { return nlanes; }
+
     /// Thread-safe get allocated object space, or nullptr if priority-0 allocation rejected
     //  likely called from multiple input threads
     virtual T* get_allocated(int priority = 0) {
-        lock_guard<mutex> plk(pmutex);
-        if(!pool.size()) {
-            if(!priority && maxAllocate && nAllocated >= maxAllocate) return nullptr;
-            ++nAllocated;
-            return allocate_new();
-        }
-        auto obj = pool.back();
-        pool.pop_back();
-        return obj;
+        auto obj = pool.try_get();
+        if(obj) return obj;
+        if(!priority && maxAllocate && nAllocated >= maxAllocate) return nullptr;
+        ++nAllocated;
+        return allocate_new();
     }
 
-    /// Thread-safe return object for processing; pass nullptr to end processing
+    /// Thread-safe return object for processing, on priority lane (if lock-free queueing); pass nullptr to end processing
     //  likely called from multiple input threads
-    void return_allocated(T* obj) {
-        lock_guard<mutex> lk(inputMut);
-        queue.push_back(obj);       // add item to queue
-        inputReady.notify_one();    // notify that queue item is ready for processing
+    void return_allocated(T* obj, size_t lane = 0) {
+        if(!nlanes) {
+            lock_guard<mutex> lk(inputMut);
+            queue.push_back(obj);       // add item to queue
+            inputReady.notify_one();    // notify that queue item is ready for processing
+            return;
+        }
+
+        auto& L = lanes[std::min(lane, nlanes - 1)];
+        const size_t t = L.tail.fetch_add(1, std::memory_order_relaxed);
+        auto& S = L.slots[t & L.mask];
+        while(S.seq.load(std::memory_order_acquire) != t) std::this_thread::yield(); // wait for consumer to free slot
+        S.obj = obj;
+        S.seq.store(t + 1); // (seq_cst) publish before sleeping check, paired with consumer's sleeping flag before queue check
+        if(sleeping.load() && sleeping.exchange(false)) { // first to find consumer sleeping wakes it
+            lock_guard<mutex> lk(inputMut);
+            inputReady.notify_one();
+        }
     }
 
     /// Thread-safe toggle of halt flag
@@ -55,7 +98,19 @@ public:
         vector<T*> v;
         bool qbreak = false; // encountered nullptr break in queue?
         while(!halt && !qbreak) {
-            { // scope for queue lock
+            if(nlanes) {
+                qbreak = take_lanes_to_break(v);
+                if(!v.size() && !qbreak) {
+                    unique_lock<mutex> lk(inputMut);
+                    while(true) {
+                        sleeping.store(true);
+                        if(halt || lanes_ready()) break;
+                        inputReady.wait(lk);
+                    }
+                    sleeping.store(false);
+                    continue;
+                }
+            } else { // scope for queue lock
                 unique_lock<mutex> lk(inputMut); // acquire unique_lock on queue in this scope
                 inputReady.wait(lk, [this]{return queue.size() || halt;}); // unlock until notified
                 if(!halt) qbreak = extract_to_break(v);
@@ -82,20 +137,23 @@ protected:
     virtual T* allocate_new() { return new T; }
     /// final deallocation of pool objects, probably in destructor
     virtual void deallocate(T* obj) { delete obj; }
-    /// thread-safe return of one item to pool
+    /// thread-safe return of one item to pool (deallocated if pool full)
     void return_pool(T* obj) {
         reset_allocated(*obj);
-        lock_guard<mutex> plk(pmutex);
-        pool.push_back(obj);
+        if(pool.try_put(obj)) return;
+        deallocate(obj);
+        --nAllocated;
     }
     /// deallocate all pooled objects, probably in destructor
     void clear_pool() {
-        lock_guard<mutex> plk(pmutex);
-        for(auto p: pool) deallocate(p);
-        pool.clear();
+        T* p;
+        while((p = pool.try_get())) {
+            deallocate(p);
+            --nAllocated;
+        }
     }
 
-    /// extract items from queue up to nullptr break
+    /// extract items from (mutex-locked) queue up to nullptr break
     bool extract_to_break(vector<T*>& v) {
         auto itq = queue.begin();
         for(; itq != queue.end(); itq++) {
@@ -115,42 +173,97 @@ protected:
         auto itv = v.begin();
         for(auto p: v) if(process_item(*p)) *(itv++) = p;
 
-        // bulk return to pool
-        if(itv != v.begin()) {
-            lock_guard<mutex> plk(pmutex);
-            for(auto it = v.begin(); it != itv; ++it) {
-                if(!*it) continue;
-                reset_allocated(**it);
-                pool.push_back(*it);
-            }
-        }
+        // return to pool
+        for(auto it = v.begin(); it != itv; ++it) if(*it) return_pool(*it);
         v.clear();
     }
 
-    /// flush queued items up to next break
+    /// flush queued items up to next break (from consumer thread only, if lock-free)
     void flush_queued_to_break() {
         vector<T*> v;
-        { // scope for queue lock
+        if(nlanes) take_lanes_to_break(v);
+        else { // scope for queue lock
             lock_guard<mutex> lk(inputMut);
             extract_to_break(v);
         }
         process_items(v);
     }
 
-    /// discard queued items
+    /// discard queued items (from consumer thread only, if lock-free)
     void discard_queued() {
+        vector<T*> v;
+        take_all(v);
+        for(auto i: v) if(i) return_pool(i);
+    }
+
+    /// lock-free lane ring slot
+    struct slot_t {
+        std::atomic<size_t> seq{0}; ///< ring position + 1 when published; + ring size when free for next pass
+        T* obj = nullptr;           ///< queued item
+    };
+    /// lock-free lane ring
+    struct lane_t {
+        std::atomic<size_t> tail{0};    ///< next position claimed by producers
+        char pad[64];                   ///< separate producer and consumer cache lines
+        size_t head = 0;                ///< next position read by consumer
+        size_t mask = 0;                ///< ring size - 1
+        std::unique_ptr<slot_t[]> slots;///< ring slots
+    };
+
+    /// whether any lock-free lane has new items
+    bool lanes_ready() const {
+        for(size_t l = 0; l < nlanes; ++l) {
+            auto& L = lanes[l];
+            if(L.slots[L.head & L.mask].seq.load() == L.head + 1) return true;
+        }
+        return false;
+    }
+    /// move published lane l items, in FIFO order, to held[l]; free their slots (consumer only)
+    void drain_lane(size_t l) {
+        auto& L = lanes[l];
+        auto& h = held[l];
+        while(true) {
+            auto& S = L.slots[L.head & L.mask];
+            if(S.seq.load(std::memory_order_acquire) != L.head + 1) return;
+            h.push_back(S.obj);
+            S.seq.store(L.head + L.mask + 1, std::memory_order_release);
+            ++L.head;
+        }
+    }
+    /// take held and new items, highest lane first, up to first nullptr break (consumer only); return whether break found
+    bool take_lanes_to_break(vector<T*>& v) {
+        for(size_t l = nlanes; l-- > 0;) {
+            drain_lane(l);
+            auto& h = held[l];
+            auto it = std::find(h.begin(), h.end(), nullptr);
+            v.insert(v.end(), h.begin(), it);
+            const bool qbreak = it != h.end();
+            h.erase(h.begin(), qbreak? it + 1 : it);
+            if(qbreak) return true;
+        }
+        return false;
+    }
+    /// take all queued items, including breaks (consumer only)
+    void take_all(vector<T*>& v) {
+        for(size_t l = nlanes; l-- > 0;) {
+            drain_lane(l);
+            v.insert(v.end(), held[l].begin(), held[l].end());
+            held[l].clear();
+        }
         lock_guard<mutex> lk(inputMut);
-        lock_guard<mutex> plk(pmutex);
-        for(auto i: queue) if(i) { reset_allocated(*i); pool.push_back(i); }
+        v.insert(v.end(), queue.begin(), queue.end());
         queue.clear();
     }
+    LockfreeAllocPool<T> pool;  ///< re-usable allocated objects pool
+    vector<T*> queue;           ///< items received in processing queue --- lock with inputMut
 
-    vector<T*> pool;        ///< re-usable allocated objects pool
-    mutex pmutex;           ///< mutex for pool access
-    vector<T*> queue;       ///< items received in processing queue --- lock with inputMut
+    size_t nlanes = 0;                  ///< number of lock-free lanes (0 for mutex-locked queue)
+    std::unique_ptr<lane_t[]> lanes;    ///< lock-free lanes
+    vector<vector<T*>> held;            ///< items drained from each lane, not yet processed (consumer only)
+    std::atomic<bool> sleeping{false};  ///< whether consumer is (about to be) waiting for input, until cleared by waking producer
 
-    size_t nAllocated = 0;  ///< number of items allocated
-    bool halt = false;      ///< processing halt flag (needs qmutex)
+    std::atomic<size_t> nAllocated{0};  ///< number of items allocated (and not deallocated)
+    std::atomic<bool> halt{false};      ///< processing halt flag
 };
 
 #endif
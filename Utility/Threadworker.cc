@@ -1,13 +1,51 @@
 /// \file Threadworker.cc
 
 #include "Threadworker.hh"
+#include "WorkStealingPool.hh"
 #include "TermColor.hh"
 #include <time.h>
 #include <cmath>
 #include <signal.h>
+#include <cstdlib> // for std::abs
 
 thread_local int _thread_id = -1;
 
+vector<int> ThreadPlacement::select(int slot) const {
+    if(mode == PLACE_CPUS) return cpus;
+    if(mode == PLACE_PARENT && parent && parent->boundCPUs().size()) return parent->boundCPUs();
+    if(mode != PLACE_NUMA && mode != PLACE_PARENT) return {};
+
+    auto nodes = numa_node_cpus();
+    if(mode == PLACE_NUMA) {
+        if(node >= int(nodes.size())) throw std::runtime_error("Thread placement on nonexistent NUMA node " + std::to_string(node));
+        return nodes[node >= 0? node : std::abs(slot) % nodes.size()];
+    }
+    int c = sched_getcpu();
+    for(auto& n: nodes) for(auto i: n) if(i == c) return n;
+    return {};
+}
+
+string ThreadPlacement::describe() const {
+    switch(mode) {
+        case PLACE_CPUS: return "cpus:" + cpulist_str(cpus);
+        case PLACE_NUMA: return node >= 0? "numa:" + std::to_string(node) : "numa";
+        case PLACE_PARENT: return "parent";
+        default: return "none";
+    }
+}
+
+string cpulist_str(const vector<int>& v) {
+    string s;
+    for(size_t i = 0; i < v.size(); ) {
+        size_t j = i;
+        while(j + 1 < v.size() && v[j+1] == v[j] + 1) ++j;
+        s += (s.size()? "," : "") + std::to_string(v[i]);
+        if(j > i) s += "-" + std::to_string(v[j]);
+        i = j + 1;
+    }
+    return s;
+}
+
 int Threadworker::thread_id() { return _thread_id; }
 
 Threadworker::Threadworker(int i, ThreadManager* m):
@@ -49,6 +87,12 @@ void* Threadworker::run_Threadworker_thread(void* p) {
     auto w = static_cast<Threadworker*>(p);
     if(w->verbose) printf(TERMFG_GREEN "Threadworker [%i] threadjob started." TERMSGR_RESET "\n", w->worker_id);
     _thread_id = w->worker_id;
+    if(!w->initDone) {
+        w->thread_init();
+        lock_guard<mutex> lk(w->pauseMut);
+        w->initDone = true;
+        w->pauseReady.notify_all();
+    }
     w->threadjob();
     if(w->verbose) printf(TERMFG_RED "Threadworker [%i] threadjob completed." TERMSGR_RESET "\n", w->worker_id);
     if(w->myManager) w->myManager->notify_thread_completed(w);
@@ -56,10 +100,55 @@ void* Threadworker::run_Threadworker_thread(void* p) {
 }
 
 void Threadworker::launch_mythread() {
+    if(checkRunning()) throw std::logic_error("Double launch attempted");
+    bound = placement.select(worker_id);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if(bound.size()) {
+        cpu_set_t cs;
+        CPU_ZERO(&cs);
+        for(auto c: bound) CPU_SET(c, &cs);
+        pthread_attr_setaffinity_np(&attr, sizeof(cs), &cs);
+    }
+    initDone = !bound.size();
+
+    runstat = RUNNING;
+    auto rc = pthread_create(&mythread, &attr, run_Threadworker_thread, this);
+    pthread_attr_destroy(&attr);
+    if(rc) {
+        runstat = IDLE;
+        throw rc;
+    }
+    if(!initDone) {
+        unique_lock<mutex> lk(pauseMut);
+        pauseReady.wait(lk, [this] { return initDone; });
+    }
+}
+
+void Threadworker::launch_in_pool(WorkStealingPool& P) {
     if(checkRunning()) throw std::logic_error("Double launch attempted");
     runstat = RUNNING;
-    auto rc = pthread_create(&mythread, nullptr, run_Threadworker_thread, this);
-    if(rc) throw rc;
+    inPool = true;
+    P.submit([this] { run_pooled(); }, pool_priority);
+}
+
+void Threadworker::run_pooled() {
+    if(verbose) printf(TERMFG_GREEN "Threadworker [%i] pooled threadjob started." TERMSGR_RESET "\n", worker_id);
+    auto tid = _thread_id;
+    _thread_id = worker_id;
+    threadjob();
+    _thread_id = tid;
+    if(verbose) printf(TERMFG_RED "Threadworker [%i] pooled threadjob completed." TERMSGR_RESET "\n", worker_id);
+
+    auto m = myManager; // may be deleted once IDLE
+    {
+        lock_guard<mutex> lk(pauseMut);
+        runstat = IDLE;
+        inPool = false;
+        pauseReady.notify_all();
+    }
+    if(m) m->notify_thread_completed(this);
 }
 
 void Threadworker::pause() {
@@ -75,11 +164,12 @@ void Threadworker::check_pause() {
     if(runstat == PAUSE_REQUESTED) {
         runstat = PAUSED;
         inputReady.notify_one();      // reciprocate pause request
-        inputReady.wait(lk, [this] { return runstat == RUNNING; }); // unlock and wait until pause lifted
+        inputReady.wait(lk, [this] { return runstat != PAUSED; }); // unlock and wait until pause lifted (or stop requested)
     }
 }
 
 void Threadworker::unpause() {
+    lock_guard<mutex> lk(inputMut);
     if(runstat != PAUSED) throw std::logic_error("Invalid state for unpause");
     runstat = RUNNING;
     inputReady.notify_one();
@@ -94,6 +184,14 @@ void Threadworker::request_stop() {
 
 void Threadworker::finish_mythread() {
     if(verbose > 2) printf(TERMFG_YELLOW "Threadworker [%i] asked to finish..." TERMSGR_RESET "\n", worker_id);
+    if(inPool) {
+        unique_lock<mutex> lk(pauseMut);
+        if(runstat == IDLE) return;
+        request_stop();
+        pauseReady.wait(lk, [this] { return runstat == IDLE; });
+        if(verbose > 2) printf(TERMFG_RED "Threadworker [%i] pooled task is finished." TERMSGR_RESET "\n", worker_id);
+        return;
+    }
     request_stop();
     int rc = pthread_join(mythread, nullptr);
     runstat = IDLE;
@@ -157,7 +255,10 @@ void ThreadManager::await_threads_completion() {
 }
 
 void ThreadManager::threadjob() {
-    for(auto t: mythreads) t->launch_mythread();
+    for(auto t: mythreads) {
+        if(pool) t->launch_in_pool(*pool);
+        else t->launch_mythread();
+    }
     await_threads_completion();
 }
 
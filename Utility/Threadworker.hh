@@ -16,8 +16,34 @@ using std::unique_lock;
 using std::set;
 #include <vector>
 using std::vector;
+#include <string>
+using std::string;
 
 class ThreadManager;
+class WorkStealingPool;
+class Threadworker;
+
+/// CPU affinity placement policy for launched threads
+struct ThreadPlacement {
+    /// placement mode
+    enum mode_t {
+        PLACE_NONE,     ///< no affinity (inherited from launching thread)
+        PLACE_CPUS,     ///< explicit CPU set
+        PLACE_NUMA,     ///< all CPUs of one NUMA node, round-robin by worker_id unless node specified
+        PLACE_PARENT    ///< same CPUs as parent worker, or NUMA node of launching thread
+    } mode = PLACE_NONE;
+    vector<int> cpus;                       ///< CPU set for PLACE_CPUS
+    int node = -1;                          ///< PLACE_NUMA node (-1 for round-robin by worker_id)
+    const Threadworker* parent = nullptr;   ///< PLACE_PARENT worker (nullptr for launching thread)
+
+    /// CPUs selected for worker slot (empty for no affinity)
+    vector<int> select(int slot) const;
+    /// short description for metadata
+    string describe() const;
+};
+
+/// compact CPU list description, e.g. "0-7,16-23"
+string cpulist_str(const vector<int>& v);
 
 /// Utility base class for launching worker thread
 class Threadworker {
@@ -29,18 +55,22 @@ public:
 
     /// launch worker thread (error if already launched)
     void launch_mythread();
+    /// launch threadjob() as task in thread pool, instead of own thread (error if already launched)
+    void launch_in_pool(WorkStealingPool& P);
     /// pause thread (blocks until threadjob() reciprocates)
     void pause();
     /// re-start paused thread (non-blocking)
     void unpause();
     /// set STOP_REQUESTED and notify (but do not wait for join)
-    void request_stop();
+    virtual void request_stop();
     /// request and wait for completion of worker thread (error if not launched)
     void finish_mythread();
     /// force-kill a thread that refuses to finish
     void kill_mythread(double timeout_s = 0.01);
     /// run threadjob() in this thread; return when done
     void run_here();
+    /// CPUs thread was bound to at launch (empty if unbound)
+    const vector<int>& boundCPUs() const { return bound; }
 
     /// worker current status
     enum runstatus_t {
@@ -59,24 +89,34 @@ public:
     int worker_id;              ///< assignable identification number
     ThreadManager* myManager;   ///< link back to manager
     int verbose = 0;            ///< debugging verbosity level
+    int pool_priority = 0;      ///< task priority when launched in thread pool (higher runs first)
+    ThreadPlacement placement;  ///< CPU affinity for launch_mythread()
     static int thread_id();     ///< worker_id that launched current thread
 
 protected:
     /// task to be run in thread; example waiting for halt condition. Override me!
     virtual void threadjob();
 
+    /// called in thread bound by placement, before threadjob(); launch_mythread() waits for completion. Override for first-touch allocation of thread-local buffers.
+    virtual void thread_init() { }
+
     /// check for and respond to pause request
     void check_pause();
 
     /// pthreads function for launching processing loop
     static void* run_Threadworker_thread(void* p);
+    /// thread pool task for running processing loop
+    void run_pooled();
 
     pthread_t mythread;                 ///< identifier for this object's thread
     runstatus_t runstat = IDLE;         ///< current running status
+    bool inPool = false;                ///< whether launched as thread pool task
+    vector<int> bound;                  ///< CPUs bound by placement at launch
+    bool initDone = true;               ///< whether placed thread has completed thread_init()
     mutex inputMut;                     ///< mutex on input operations
     std::condition_variable inputReady; ///< input conditions change notifier
-    mutex pauseMut;                     ///< mutex on pause operations
-    std::condition_variable pauseReady; ///< pause conditions change notifier
+    mutex pauseMut;                     ///< mutex on pause and pooled-completion operations
+    std::condition_variable pauseReady; ///< pause and pooled-completion conditions change notifier
 };
 
 /// Manage multiple worker threads
@@ -93,9 +133,11 @@ public:
 
     /// wait for all threads to complete
     void await_threads_completion();
-    /// launch all threads, await_threads_completion()
+    /// launch all threads (as pool tasks if pool set), await_threads_completion()
     void threadjob() override;
 
+    WorkStealingPool* pool = nullptr;   ///< optional thread pool for running managed threads
+
 protected:
     /// Callback on thread completion --- needs to perform approppriate memory management
     virtual void on_thread_completed(Threadworker* t) { if(t != this) delete t; }
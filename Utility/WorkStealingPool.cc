@@ -0,0 +1,171 @@
+/// \file WorkStealingPool.cc
+
+#include "WorkStealingPool.hh"
+#include <sched.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <thread>
+#include <chrono>
+
+vector<vector<int>> numa_node_cpus() {
+    cpu_set_t cs;
+    CPU_ZERO(&cs);
+    bool hasmask = !sched_getaffinity(0, sizeof(cs), &cs);
+
+    vector<vector<int>> nodes;
+    for(int node = 0; ; ++node) {
+        char fname[128];
+        snprintf(fname, sizeof(fname), "/sys/devices/system/node/node%i/cpulist", node);
+        auto f = fopen(fname, "r");
+        if(!f) break;
+        vector<int> v;
+        int a, b;
+        while(fscanf(f, "%i", &a) == 1) {
+            b = a;
+            int c = fgetc(f);
+            if(c == '-') {
+                if(fscanf(f, "%i", &b) != 1) break;
+                c = fgetc(f);
+            }
+            for(int i = a; i <= b; ++i) if(!hasmask || CPU_ISSET(i, &cs)) v.push_back(i);
+            if(c != ',') break;
+        }
+        fclose(f);
+        if(v.size()) nodes.push_back(v);
+    }
+
+    if(!nodes.size()) {
+        vector<int> v;
+        int n = std::thread::hardware_concurrency();
+        for(int i = 0; i < n; ++i) if(!hasmask || CPU_ISSET(i, &cs)) v.push_back(i);
+        nodes.push_back(v);
+    }
+    return nodes;
+}
+
+vector<int> numa_cpu_order() {
+    vector<int> v;
+    for(auto& n: numa_node_cpus()) v.insert(v.end(), n.begin(), n.end());
+    return v;
+}
+
+bool pin_thread_cpu(int cpu) {
+    if(cpu < 0) return false;
+    cpu_set_t cs;
+    CPU_ZERO(&cs);
+    CPU_SET(cpu, &cs);
+    return !pthread_setaffinity_np(pthread_self(), sizeof(cs), &cs);
+}
+
+/// pool and worker index for current thread
+thread_local std::pair<const WorkStealingPool*, int> _pool_worker{nullptr, -1};
+
+/// argument to pool thread launch
+struct _pool_launch_t {
+    WorkStealingPool* P;
+    size_t i;
+};
+
+WorkStealingPool::WorkStealingPool(unsigned int n, bool pin) {
+    if(!n) n = std::thread::hardware_concurrency();
+    if(!n) n = 1;
+    vector<int> cpus;
+    if(pin) cpus = numa_cpu_order();
+
+    for(size_t i = 0; i < n; ++i) {
+        workers.push_back(new worker_t);
+        if(cpus.size()) workers.back()->cpu = cpus[i % cpus.size()];
+    }
+    for(size_t i = 0; i < n; ++i) {
+        auto rc = pthread_create(&workers[i]->thread, nullptr, run_pool_thread, new _pool_launch_t{this, i});
+        if(rc) throw std::runtime_error("WorkStealingPool failed to launch thread");
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait_idle();
+    {
+        std::lock_guard<std::mutex> lk(poolMut);
+        stopping = true;
+        taskReady.notify_all();
+    }
+    for(auto w: workers) pthread_join(w->thread, nullptr);
+    for(auto w: workers) delete w;
+}
+
+int WorkStealingPool::current_worker() const {
+    return _pool_worker.first == this? _pool_worker.second : -1;
+}
+
+void WorkStealingPool::submit(const task_t& f, int priority) {
+    int i = current_worker();
+    if(i < 0) i = nsubmit++ % workers.size();
+    ++npending;
+    {
+        auto& w = *workers[i];
+        std::lock_guard<std::mutex> lk(w.qMut);
+        w.queues[priority].push_back(f);
+        ++nqueued;
+    }
+    std::lock_guard<std::mutex> lk(poolMut);
+    taskReady.notify_one();
+}
+
+void WorkStealingPool::wait_idle() {
+    if(current_worker() >= 0) throw std::logic_error("wait_idle() called from pool thread");
+    std::unique_lock<std::mutex> lk(poolMut);
+    taskDone.wait(lk, [this] { return !npending; });
+}
+
+void* WorkStealingPool::run_pool_thread(void* p) {
+    auto L = static_cast<_pool_launch_t*>(p);
+    auto P = L->P;
+    auto i = L->i;
+    delete L;
+    _pool_worker = {P, int(i)};
+    pin_thread_cpu(P->workers[i]->cpu);
+    P->work(i);
+    return nullptr;
+}
+
+bool WorkStealingPool::pop_task(worker_t& w, task_t& f, bool front) {
+    std::lock_guard<std::mutex> lk(w.qMut);
+    for(auto it = w.queues.begin(); it != w.queues.end(); ) {
+        auto& q = it->second;
+        if(q.empty()) { it = w.queues.erase(it); continue; }
+        if(front) { f = std::move(q.front()); q.pop_front(); }
+        else { f = std::move(q.back()); q.pop_back(); }
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::get_task(size_t i, task_t& f) {
+    if(pop_task(*workers[i], f, false)) { --nqueued; return true; }
+    for(size_t j = 1; j < workers.size(); ++j) {
+        if(pop_task(*workers[(i + j) % workers.size()], f, true)) {
+            --nqueued;
+            ++nstolen;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::work(size_t i) {
+    while(true) {
+        task_t f;
+        if(get_task(i, f)) {
+            f();
+            if(!--npending) {
+                std::lock_guard<std::mutex> lk(poolMut);
+                taskDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(poolMut);
+        if(stopping) break;
+        taskReady.wait(lk, [this] { return stopping || nqueued > 0; });
+    }
+}
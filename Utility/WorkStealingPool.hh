@@ -0,0 +1,77 @@
+/// \file WorkStealingPool.hh Fixed pool of worker threads with per-thread work-stealing task queues
+// Michael P. Mendenhall, LLNL 2021
+
+#ifndef WORKSTEALINGPOOL_HH
+#define WORKSTEALINGPOOL_HH
+
+#include <pthread.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+using std::vector;
+
+/// usable CPU numbers grouped by NUMA node (from /sys topology; single node 0...n-1 fallback)
+vector<vector<int>> numa_node_cpus();
+/// CPU numbers ordered so consecutive entries share a NUMA node (from /sys topology; 0...n-1 fallback)
+vector<int> numa_cpu_order();
+/// pin calling thread to specified CPU; return whether successful
+bool pin_thread_cpu(int cpu);
+
+/// Fixed pool of worker threads with per-thread work-stealing task queues
+class WorkStealingPool {
+public:
+    /// task function run in pool
+    typedef std::function<void()> task_t;
+
+    /// Constructor, launching n threads (0 for hardware_concurrency), optionally pinned to NUMA-ordered CPUs
+    explicit WorkStealingPool(unsigned int n = 0, bool pin = false);
+    /// Destructor: completes all queued tasks, then stops threads
+    ~WorkStealingPool();
+
+    /// add task with priority (higher runs first); queued locally when called from a pool thread
+    void submit(const task_t& f, int priority = 0);
+    /// wait until all submitted tasks have completed
+    void wait_idle();
+
+    /// number of pool threads
+    size_t size() const { return workers.size(); }
+    /// index of calling pool thread; -1 if not in this pool
+    int current_worker() const;
+
+    /// number of tasks taken from another thread's queue
+    size_t n_stolen() const { return nstolen; }
+
+protected:
+    /// per-thread task queues, by priority
+    struct worker_t {
+        pthread_t thread;                                           ///< pool thread
+        std::mutex qMut;                                            ///< lock on queues
+        std::map<int, std::deque<task_t>, std::greater<int>> queues;///< tasks by descending priority
+        int cpu = -1;                                               ///< pinned CPU, or -1
+    };
+
+    /// pthreads worker thread entry point
+    static void* run_pool_thread(void* p);
+    /// worker thread loop
+    void work(size_t i);
+    /// try to get task: own queue (newest first) or steal from others (oldest first)
+    bool get_task(size_t i, task_t& f);
+    /// pop task from worker queue, optionally from front for stealing
+    static bool pop_task(worker_t& w, task_t& f, bool front);
+
+    vector<worker_t*> workers;          ///< per-thread queues
+    std::mutex poolMut;                 ///< lock for waiting on tasks
+    std::condition_variable taskReady;  ///< notification of new tasks, or stop
+    std::condition_variable taskDone;   ///< notification of task completion
+    std::atomic<size_t> npending{0};    ///< tasks submitted but not completed
+    std::atomic<size_t> nqueued{0};     ///< tasks waiting in queues
+    std::atomic<size_t> nstolen{0};     ///< number of stolen tasks
+    std::atomic<unsigned int> nsubmit{0};   ///< round-robin counter for external submissions
+    bool stopping = false;              ///< stop request flag, with poolMut
+};
+
+#endif
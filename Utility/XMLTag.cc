@@ -1,12 +1,17 @@
 /// \file XMLTag.cc
 
 #include "XMLTag.hh"
+#include "XMLWriter.hh"
 
-void _XMLTag::write(ostream& o, unsigned int ndeep, const string& indent) {
+void _XMLTag::openTag(ostream& o, unsigned int ndeep, const string& indent) {
     prepare();
     for(unsigned int i=0; i<ndeep; i++) o << indent;
     o << "<" << name;
     for(auto const& kv: attrs) o << " " << kv.first << "=\"" << kv.second << "\"";
+}
+
+void _XMLTag::write(ostream& o, unsigned int ndeep, const string& indent) {
+    openTag(o, ndeep, indent);
     closeTag(o,true);
 }
 
@@ -16,10 +21,7 @@ void _XMLTag::closeTag(ostream& o, bool abbrev) {
 }
 
 void XMLTag::write(ostream& o, unsigned int ndeep, const string& indent) {
-    prepare();
-    for(unsigned int i=0; i<ndeep; i++) o << indent;
-    o << "<" << name;
-    for(auto const& kv: attrs) o << " " << kv.first << "=\"" << kv.second << "\"";
+    openTag(o, ndeep, indent);
     if(children.size()) {
         o << ">";
         if(oneline) {
@@ -38,6 +40,23 @@ void XMLTag::write(ostream& o, unsigned int ndeep, const string& indent) {
     }
 }
 
+void _XMLTag::stream(XMLWriter& W) {
+    prepare();
+    W.open(name, oneline);
+    W.attrs(attrs);
+    W.close();
+}
+
+void XMLTag::stream(XMLWriter& W) {
+    prepare();
+    W.open(name, oneline);
+    W.attrs(attrs);
+    streamChildren(W);
+    W.close();
+}
+
+void XMLText::stream(XMLWriter& W) { W.text(contents); }
+
 //////////////////////////////////////////////////
 
 XMLTag* _XMLProvider::makeXML() {
@@ -52,3 +71,24 @@ XMLTag* XMLProvider::makeXML() {
     for(auto c: children) X->addChild(c->makeXML());
     return X;
 }
+
+void _XMLProvider::_writeXML(XMLWriter& W) {
+    XMLTag X(tagname);
+    X.attrs = xattrs;
+    _makeXML(X);
+    W.attrs(X.attrs);
+    X.streamChildren(W);
+}
+
+void _XMLProvider::writeXML(XMLWriter& W) {
+    W.open(tagname);
+    _writeXML(W);
+    W.close();
+}
+
+void XMLProvider::writeXML(XMLWriter& W) {
+    W.open(tagname);
+    _writeXML(W);
+    for(auto c: children) c->writeXML(W);
+    W.close();
+}
@@ -12,6 +12,8 @@ using std::map;
 #include <iostream>
 using std::ostream;
 
+class XMLWriter;
+
 /// XML tag base
 class _XMLTag {
 public:
@@ -27,6 +29,12 @@ public:
     void addAttr(const string& attrnm, const C& val) { addAttr(attrnm, to_str(val)); }
     /// Write output
     virtual void write(ostream& o, unsigned int ndeep = 0, const string& indent = "    ");
+    /// Write opening tag only, for streamed contents
+    void writeStart(ostream& o, unsigned int ndeep = 0, const string& indent = "    ") { openTag(o, ndeep, indent); o << ">"; }
+    /// Write closing tag only, for streamed contents
+    void writeEnd(ostream& o, unsigned int ndeep = 0, const string& indent = "    ") { while(ndeep--) o << indent; closeTag(o); }
+    /// Write output to streamed XMLWriter
+    virtual void stream(XMLWriter& W);
 
     string name;                ///< tag head
     bool oneline = false;       ///< whether to force single-line output
@@ -35,6 +43,8 @@ public:
 protected:
     /// subclass me! setup before write
     virtual void prepare() { }
+    /// prepare() and generate indented opening tag with attributes, "<name a=b ..."
+    void openTag(ostream& o, unsigned int ndeep, const string& indent);
     /// generate closing tag
     void closeTag(ostream& o, bool abbrev = false);
 };
@@ -46,6 +56,10 @@ public:
     explicit XMLTag(const string& _name = "") { name = _name; }
     /// Write output
     void write(ostream& o, unsigned int ndeep = 0, const string& indent = "    ") override;
+    /// Write output to streamed XMLWriter
+    void stream(XMLWriter& W) override;
+    /// Write child tags to streamed XMLWriter
+    void streamChildren(XMLWriter& W) { for(auto c: children) c->stream(W); }
 };
 
 /// "verbatim contents" XML-includable text
@@ -55,6 +69,8 @@ public:
     explicit XMLText(const string& c): contents(c) { }
     /// write output
     void write(ostream& o, unsigned int ndeep = 0, const string& indent = "    ") override { while(ndeep--) o << indent; o << contents; }
+    /// Write output to streamed XMLWriter
+    void stream(XMLWriter& W) override;
     string contents;    ///< text to include between tags
 };
 
@@ -65,6 +81,8 @@ public:
     explicit _XMLProvider(const string& name = "UNKNOWN"): tagname(name) { }
     /// build XML output
     virtual XMLTag* makeXML();
+    /// stream XML output, without building intermediate tag tree
+    virtual void writeXML(XMLWriter& W);
     /// Add a tag attribute
     virtual void addAttr(const string& attrnm, const string& val) { xattrs[attrnm] = val; }
     /// Add a tag attribute
@@ -76,6 +94,9 @@ public:
 protected:
     /// add class-specific XML data; subclass me!
     virtual void _makeXML(XMLTag&) { }
+    /// stream class-specific XML attributes (including xattrs) and child tags; default bridges through _makeXML.
+    /// Override (with matching _makeXML) for direct output of large or frequently-written metadata.
+    virtual void _writeXML(XMLWriter& W);
 
     map<string,string> xattrs;          ///< tag attributes
 };
@@ -89,6 +110,8 @@ public:
     virtual ~XMLProvider() { children.clear(); }
     /// build XML output
     XMLTag* makeXML() override;
+    /// stream XML output, without building intermediate tag tree
+    void writeXML(XMLWriter& W) override;
 };
 
 #endif
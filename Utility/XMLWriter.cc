@@ -0,0 +1,172 @@
+/// \file XMLWriter.cc
+
+#include "XMLWriter.hh"
+#include <stdexcept>
+#include <string.h>
+#include <stdio.h>
+
+size_t XMLWriter::format(char* b, unsigned long long v) {
+    char c[24];
+    char* p = c + sizeof(c);
+    do { *--p = '0' + v % 10; v /= 10; } while(v);
+    size_t n = c + sizeof(c) - p;
+    memcpy(b, p, n);
+    return n;
+}
+
+size_t XMLWriter::format(char* b, long long v) {
+    if(v >= 0) return format(b, static_cast<unsigned long long>(v));
+    *b = '-';
+    return 1 + format(b + 1, 0ULL - static_cast<unsigned long long>(v));
+}
+
+size_t XMLWriter::format(char* b, double v) {
+    int n = snprintf(b, 32, "%g", v);
+    return n > 0? std::min(n, 31) : 0;
+}
+
+//////////////////////////////////////////////////
+
+void XMLStreamWriter::startChild() {
+    if(!stack.size() || stack.back().content) return;
+    stack.back().content = true;
+    buf += '>';
+    if(!stack.back().oneline) buf += '\n';
+}
+
+void XMLStreamWriter::open(const string& name, bool oneline) {
+    startChild();
+    if(stack.size() && stack.back().oneline) oneline = true;
+    else for(size_t i = 0; i < ndeep0 + stack.size(); ++i) buf += indent;
+    buf += '<';
+    buf += name;
+    stack.push_back({name, oneline, false});
+}
+
+void XMLStreamWriter::close() {
+    if(!stack.size()) throw std::logic_error("XMLStreamWriter close() without open tag");
+    auto& t = stack.back();
+    if(t.content) {
+        if(!t.oneline) for(size_t i = 1; i < ndeep0 + stack.size(); ++i) buf += indent;
+        buf += "</";
+        buf += t.name;
+        buf += '>';
+    } else buf += "/>";
+    stack.pop_back();
+    endChild();
+}
+
+void XMLStreamWriter::text(const string& s) {
+    startChild();
+    if(!stack.size() || !stack.back().oneline) for(size_t i = 0; i < ndeep0 + stack.size(); ++i) buf += indent;
+    buf += s;
+    endChild();
+}
+
+//////////////////////////////////////////////////
+
+void XMLTagBuilder::close() {
+    if(stack.size() < 2) throw std::logic_error("XMLTagBuilder close() without open tag");
+    stack.pop_back();
+}
+
+//////////////////////////////////////////////////
+
+/// binary stream identifier and format version
+static const char binxml_magic[] = {'M', 'X', 'B', 1};
+
+BinaryXMLWriter::BinaryXMLWriter(ostream& _o): o(_o) { buf.append(binxml_magic, sizeof(binxml_magic)); }
+
+void BinaryXMLWriter::close() {
+    if(!depth) throw std::logic_error("BinaryXMLWriter close() without open tag");
+    put(T_CLOSE);
+    if(!--depth) {
+        put(T_END);
+        flush();
+    } else if(buf.size() > (1 << 16)) flush();
+}
+
+void BinaryXMLWriter::putName(const string& s) {
+    auto it = names.find(s);
+    if(it != names.end()) { putVarint(it->second); return; }
+    putVarint(0);
+    putStr(s);
+    names.emplace(s, names.size() + 1);
+}
+
+void BinaryXMLWriter::_attrD(const string& k, double v) {
+    put(T_DBL);
+    putName(k);
+    unsigned long long u;
+    memcpy(&u, &v, sizeof(u));
+    for(int i = 0; i < 8; ++i) { buf += char(u & 0xff); u >>= 8; }
+}
+
+/// binary stream reader
+class BinaryXMLReader {
+public:
+    /// Constructor
+    explicit BinaryXMLReader(istream& _i): i(_i) { }
+
+    /// read one byte
+    unsigned char byte() {
+        auto c = i.get();
+        if(c == std::char_traits<char>::eof()) throw std::runtime_error("Truncated binary XML stream");
+        return c;
+    }
+    /// read varint
+    unsigned long long varint() {
+        unsigned long long v = 0;
+        for(int s = 0; s < 64; s += 7) {
+            auto c = byte();
+            v |= (unsigned long long)(c & 0x7f) << s;
+            if(!(c & 0x80)) return v;
+        }
+        throw std::runtime_error("Malformed binary XML varint");
+    }
+    /// read length-prefixed string
+    string str() {
+        string s(varint(), '\0');
+        if(s.size() && !i.read(&s[0], s.size())) throw std::runtime_error("Truncated binary XML stream");
+        return s;
+    }
+    /// read interned name
+    const string& name() {
+        auto n = varint();
+        if(!n) { names.push_back(str()); return names.back(); }
+        if(n > names.size()) throw std::runtime_error("Invalid binary XML name reference");
+        return names[n-1];
+    }
+
+    istream& i;                 ///< input stream
+    vector<string> names;       ///< interned names
+};
+
+void BinaryXMLWriter::replay(istream& i, XMLWriter& W) {
+    char m[sizeof(binxml_magic)];
+    if(!i.read(m, sizeof(m)) || memcmp(m, binxml_magic, sizeof(m))) throw std::runtime_error("Not a binary XML stream");
+
+    BinaryXMLReader R(i);
+    while(true) {
+        auto t = R.byte();
+        switch(t) {
+            case T_END: return;
+            case T_OPEN:
+            case T_OPEN1: W.open(R.name(), t == T_OPEN1); break;
+            case T_CLOSE: W.close(); break;
+            case T_STR: { auto& k = R.name(); W.attr(k, R.str()); } break;
+            case T_INT: { auto& k = R.name(); auto u = R.varint(); W.attr(k, static_cast<long long>(u >> 1) ^ -static_cast<long long>(u & 1)); } break;
+            case T_UINT: { auto& k = R.name(); W.attr(k, R.varint()); } break;
+            case T_DBL: {
+                auto& k = R.name();
+                unsigned long long u = 0;
+                for(int j = 0; j < 8; ++j) u |= (unsigned long long)R.byte() << (8*j);
+                double v;
+                memcpy(&v, &u, sizeof(v));
+                W.attr(k, v);
+            } break;
+            case T_TEXT: W.text(R.str()); break;
+            default: throw std::runtime_error("Invalid binary XML token");
+        }
+    }
+}
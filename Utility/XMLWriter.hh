@@ -0,0 +1,196 @@
+/// \file XMLWriter.hh Streamed XML (and compact binary) metadata output, without intermediate XMLTag trees
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef XMLWRITER_HH
+#define XMLWRITER_HH
+
+#include "XMLTag.hh"
+#include <istream>
+using std::istream;
+
+/// Base interface for streamed tag-by-tag XML output
+class XMLWriter {
+public:
+    /// Destructor
+    virtual ~XMLWriter() { }
+
+    /// open new (child) tag; attributes follow until first child or close()
+    virtual void open(const string& name, bool oneline = false) = 0;
+    /// close most recently opened tag
+    virtual void close() = 0;
+    /// add verbatim text contents in current tag
+    virtual void text(const string& s) = 0;
+    /// write XMLTag (sub)tree
+    void tag(_XMLTag& X) { X.stream(*this); }
+
+    /// add string attribute to open tag
+    void attr(const string& k, const string& v) { _attr(k, v); }
+    /// add string attribute to open tag
+    void attr(const string& k, const char* v) { _attr(k, string(v)); }
+    /// add floating-point attribute to open tag
+    void attr(const string& k, double v) { _attrD(k, v); }
+    /// add integer attribute to open tag
+    void attr(const string& k, int v) { _attrI(k, v); }
+    /// add integer attribute to open tag
+    void attr(const string& k, long v) { _attrI(k, v); }
+    /// add integer attribute to open tag
+    void attr(const string& k, long long v) { _attrI(k, v); }
+    /// add integer attribute to open tag
+    void attr(const string& k, unsigned int v) { _attrU(k, v); }
+    /// add integer attribute to open tag
+    void attr(const string& k, unsigned long v) { _attrU(k, v); }
+    /// add integer attribute to open tag
+    void attr(const string& k, unsigned long long v) { _attrU(k, v); }
+    /// add all attributes in map
+    void attrs(const map<string,string>& m) { for(auto& kv: m) _attr(kv.first, kv.second); }
+
+    /// format integer to buffer (at least 24 chars); return length. Same output as to_str.
+    static size_t format(char* b, long long v);
+    /// format unsigned integer to buffer (at least 24 chars); return length
+    static size_t format(char* b, unsigned long long v);
+    /// format floating-point to buffer (at least 32 chars); return length. Same output as to_str.
+    static size_t format(char* b, double v);
+
+protected:
+    /// add string attribute
+    virtual void _attr(const string& k, const string& v) = 0;
+    /// add floating-point attribute; default formatted as string
+    virtual void _attrD(const string& k, double v) { char b[32]; _attr(k, string(b, format(b, v))); }
+    /// add integer attribute; default formatted as string
+    virtual void _attrI(const string& k, long long v) { char b[24]; _attr(k, string(b, format(b, v))); }
+    /// add unsigned integer attribute; default formatted as string
+    virtual void _attrU(const string& k, unsigned long long v) { char b[24]; _attr(k, string(b, format(b, v))); }
+};
+
+/// Streamed text XML output, formatted identically to XMLTag::write
+class XMLStreamWriter: public XMLWriter {
+public:
+    /// Constructor, writing to ostream at indentation depth ndeep
+    explicit XMLStreamWriter(ostream& _o, unsigned int ndeep = 0, const string& _indent = "    "):
+    o(_o), ndeep0(ndeep), indent(_indent) { }
+    /// Destructor, closing any open tags
+    ~XMLStreamWriter() { while(stack.size()) close(); flush(); }
+
+    /// open new (child) tag
+    void open(const string& name, bool oneline = false) override;
+    /// close most recently opened tag
+    void close() override;
+    /// add verbatim text contents in current tag
+    void text(const string& s) override;
+    /// flush buffered output to stream
+    void flush() { o.write(buf.data(), buf.size()); buf.clear(); }
+
+protected:
+    /// add string attribute
+    void _attr(const string& k, const string& v) override { attrStart(k); buf += v; buf += '"'; }
+    /// add floating-point attribute
+    void _attrD(const string& k, double v) override { char b[32]; attrStart(k); buf.append(b, format(b, v)); buf += '"'; }
+    /// add integer attribute
+    void _attrI(const string& k, long long v) override { char b[24]; attrStart(k); buf.append(b, format(b, v)); buf += '"'; }
+    /// add unsigned integer attribute
+    void _attrU(const string& k, unsigned long long v) override { char b[24]; attrStart(k); buf.append(b, format(b, v)); buf += '"'; }
+
+    /// start attribute ` k="`
+    void attrStart(const string& k) { buf += ' '; buf += k; buf += "=\""; }
+    /// start contents of current tag, before new child
+    void startChild();
+    /// end child contents
+    void endChild() { if(stack.size() && !stack.back().oneline) buf += '\n'; if(buf.size() > (1 << 16)) flush(); }
+
+    /// open tag information
+    struct open_t {
+        string name;        ///< tag name
+        bool oneline;       ///< single-line output
+        bool content;       ///< whether tag has contents
+    };
+
+    ostream& o;                 ///< output stream
+    unsigned int ndeep0;        ///< initial indentation depth
+    string indent;              ///< indentation per level
+    vector<open_t> stack;       ///< currently open tags
+    string buf;                 ///< output buffer
+};
+
+/// XMLWriter building XMLTag tree, for makeXML() from streamed output
+class XMLTagBuilder: public XMLWriter {
+public:
+    /// Constructor, adding attributes and children to X
+    explicit XMLTagBuilder(XMLTag& X): stack(1, &X) { }
+
+    /// open new child tag
+    void open(const string& name, bool oneline = false) override {
+        auto X = stack.back()->addChild(new XMLTag(name));
+        X->oneline = oneline;
+        stack.push_back(X);
+    }
+    /// close most recently opened tag
+    void close() override;
+    /// add verbatim text contents in current tag
+    void text(const string& s) override { stack.back()->addChild(new XMLText(s)); }
+
+protected:
+    /// add string attribute
+    void _attr(const string& k, const string& v) override { stack.back()->attrs[k] = v; }
+
+    vector<XMLTag*> stack;  ///< currently open tags
+};
+
+/// Compact binary XML metadata stream: tag and attribute names interned on first use; numbers stored unformatted
+class BinaryXMLWriter: public XMLWriter {
+public:
+    /// Constructor, writing to ostream
+    explicit BinaryXMLWriter(ostream& _o);
+    /// Destructor, closing any open tags
+    ~BinaryXMLWriter() { while(depth) close(); flush(); }
+
+    /// open new (child) tag
+    void open(const string& name, bool oneline = false) override { put(oneline? T_OPEN1 : T_OPEN); putName(name); ++depth; }
+    /// close most recently opened tag
+    void close() override;
+    /// add verbatim text contents in current tag
+    void text(const string& s) override { put(T_TEXT); putStr(s); }
+    /// flush buffered output to stream
+    void flush() { o.write(buf.data(), buf.size()); buf.clear(); }
+
+    /// replay binary stream (as produced by BinaryXMLWriter) into another XMLWriter
+    static void replay(istream& i, XMLWriter& W);
+
+    /// stream tokens
+    enum token_t {
+        T_END = 0,      ///< end of stream
+        T_OPEN = 1,     ///< open tag (name)
+        T_OPEN1 = 2,    ///< open single-line tag (name)
+        T_CLOSE = 3,    ///< close tag
+        T_STR = 4,      ///< string attribute (name, string)
+        T_INT = 5,      ///< signed integer attribute (name, zig-zag varint)
+        T_UINT = 6,     ///< unsigned integer attribute (name, varint)
+        T_DBL = 7,      ///< double attribute (name, 8-byte little-endian)
+        T_TEXT = 8      ///< text contents (string)
+    };
+
+protected:
+    /// add string attribute
+    void _attr(const string& k, const string& v) override { put(T_STR); putName(k); putStr(v); }
+    /// add floating-point attribute
+    void _attrD(const string& k, double v) override;
+    /// add integer attribute
+    void _attrI(const string& k, long long v) override { put(T_INT); putName(k); putVarint((static_cast<unsigned long long>(v) << 1) ^ (v < 0? ~0ULL : 0ULL)); }
+    /// add unsigned integer attribute
+    void _attrU(const string& k, unsigned long long v) override { put(T_UINT); putName(k); putVarint(v); }
+
+    /// write token byte
+    void put(token_t t) { buf += char(t); }
+    /// write variable-length unsigned integer
+    void putVarint(unsigned long long v) { while(v >= 0x80) { buf += char(v | 0x80); v >>= 7; } buf += char(v); }
+    /// write length-prefixed string
+    void putStr(const string& s) { putVarint(s.size()); buf += s; }
+    /// write interned name: index+1 of previously-seen name, or 0 followed by new name
+    void putName(const string& s);
+
+    ostream& o;                 ///< output stream
+    map<string,size_t> names;   ///< interned names
+    size_t depth = 0;           ///< number of open tags
+    string buf;                 ///< output buffer
+};
+
+#endif
@@ -25,14 +25,14 @@ struct char_membuf: std::basic_streambuf<char> {
 };
 
 /// istream over char buffer
-class char_istream: private char_membuf, public std::basic_istream<char> {
+class char_istream: protected char_membuf, public std::basic_istream<char> {
 public:
     /// Constructor
     explicit char_istream(const char* s = nullptr, size_t n = 0):
     char_membuf(s,n), basic_istream(this) { }
 
     /// Set contents
-    void set_str(const char* s, size_t n) { set(s,n); init(this); }
+    void set_str(const char* s, size_t n) { set(s,n); clear(); }
     /// Set contents
     void set_str(const string& s) { set_str(s.c_str(), s.size()); }
 };
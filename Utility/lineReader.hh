@@ -1,35 +1,62 @@
-/// \file lineReader.hh load istream line-by-line
+/// \file lineReader.hh load istream (or memory buffer) line-by-line
 // Michael P. Mendenhall, LLNL 2021
 
 #ifndef LINEREADER_HH
 #define LINEREADER_HH
 
 #include "char_istream.hh"
+#include "MappedFile.hh"
 using std::istream;
 
-/// load istream line-by-line
+/// load istream line-by-line; or zero-copy from memory buffer (e.g. MappedFile)
 class lineReader: public char_istream {
 public:
-    /// Constructor
-    explicit lineReader(istream& _i): lineSrc(_i) { }
+    /// Constructor, reading from istream
+    explicit lineReader(istream& _i): lineSrc(&_i) { }
+    /// Constructor, reading lines in-place from buffer (must outlive lineReader)
+    lineReader(const char* d, size_t n): spans(d, n) { }
+    /// Constructor, reading lines in-place from mapped file
+    explicit lineReader(const MappedFile& f): lineReader(f.data(), f.size()) { }
 
     /// load next line
     lineReader& next(char delim = '\n') {
-        std::getline(lineSrc, lstr, delim);
-        set_str(lstr);
+        if(lineSrc) {
+            std::getline(*lineSrc, lstr, delim);
+            ln = charspan(lstr.data(), lstr.size());
+        } else spans.next(ln, delim);
+        set_str(ln.p, ln.n);
         ++lno;
         return *this;
     }
 
+    /// current line
+    charspan line() const { return ln; }
+    /// first character of next line, or EOF
+    int peekLine() { return lineSrc? lineSrc->peek() : spans.peek(); }
+
     /// load next if only whitespace to end of line
     void checkEnd() {
         while(peek() == ' ') get();
         if(peek() == EOF) next();
     }
 
-    string lstr;        ///< line string
+    /// fast (iostream-free) parse of next whitespace-delimited number (or charspan word); sets failbit on error
+    template<typename T>
+    lineReader& scan(T& x) {
+        if(fail()) return *this;
+        const char* p = gptr();
+        if(parse_field(p, egptr(), x)) gbump(int(p - gptr()));
+        else setstate(std::ios_base::failbit);
+        return *this;
+    }
+
+    string lstr;        ///< line string buffer (istream input)
     int lno = 0;        ///< line number (starting from 1)
-    istream& lineSrc;   ///< input
+    istream* lineSrc = nullptr; ///< input stream (or nullptr for buffer input)
+
+protected:
+    LineSpanner spans;  ///< buffer line iterator
+    charspan ln;        ///< current line
 };
 
 #endif
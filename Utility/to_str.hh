@@ -5,6 +5,7 @@
 
 #include <sstream>
 #include <string>
+#include <stdio.h>
 using std::string;
 
 /// utility function for converting to string
@@ -15,4 +16,11 @@ inline string to_str(const T& x) {
     return ss.str();
 }
 
+/// faster double to string, same format as default stream output
+inline string to_str(double x) {
+    char c[32];
+    snprintf(c, sizeof(c), "%g", x);
+    return c;
+}
+
 #endif
@@ -34,18 +34,18 @@ void SGRFont::diff(const SGRFont& F, vector<int>& v) const {
     if(stricken != F.stricken)   v.push_back(stricken?  9 : 29);
 }
 
-string TermSGR::diff(const TermSGR& S) const {
-    vector<int> v;
+void TermSGR::diff(const TermSGR& S, string& s) const {
+    if(*this == S) return;
 
+    vector<int> v;
     bool isReset = FG.diff(S.FG, v);
     isReset |= BG.diff(isReset? SGRColor(false) : S.BG, v);
     Font.diff(isReset? SGRFont() : S.Font, v);
 
-    if(!v.size()) return "";
+    if(!v.size()) return;
 
     char c[32];
-    string s = "\x1b[";
+    s += "\x1b[";
     for(auto i: v) { snprintf(c, 32, "%i;", i); s += c; }
     s.back() = 'm';
-    return s;
 }
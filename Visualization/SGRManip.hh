@@ -40,6 +40,11 @@ public:
 
     /// SGR commands necessary to transform C to this state; returns whether reset issued
     bool diff(const SGRColor& C, vector<int>& v) const;
+
+    /// equality comparison
+    bool operator==(const SGRColor& C) const { return fg == C.fg && mode == C.mode && color == C.color; }
+    /// inequality comparison
+    bool operator!=(const SGRColor& C) const { return !(*this == C); }
 };
 
 /// Terminal font specifications
@@ -82,6 +87,14 @@ public:
 
     /// SGR commands necessary to transform F to this state
     void diff(const SGRFont& F, vector<int>& v) const;
+
+    /// equality comparison
+    bool operator==(const SGRFont& F) const {
+        return weight == F.weight && family == F.family && underline == F.underline && blinky == F.blinky
+            && concealed == F.concealed && inverted == F.inverted && stricken == F.stricken;
+    }
+    /// inequality comparison
+    bool operator!=(const SGRFont& F) const { return !(*this == F); }
 };
 
 /// Select Graphic Rendition state and manipulation
@@ -95,7 +108,14 @@ public:
     SGRFont  Font;  ///< font
 
     /// SGR commands necessary to transform S to this state
-    string diff(const TermSGR& S) const;
+    string diff(const TermSGR& S) const { string s; diff(S, s); return s; }
+    /// append SGR commands necessary to transform S to this state onto string s
+    void diff(const TermSGR& S, string& s) const;
+
+    /// equality comparison
+    bool operator==(const TermSGR& S) const { return FG == S.FG && BG == S.BG && Font == S.Font; }
+    /// inequality comparison
+    bool operator!=(const TermSGR& S) const { return !(*this == S); }
 };
 
 #endif
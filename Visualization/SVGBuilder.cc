@@ -0,0 +1,98 @@
+/// \file SVGBuilder.cc
+
+#include "SVGBuilder.hh"
+#include <stdio.h>
+
+using namespace SVG;
+
+void polyline::decimate(vector<xypoint>& v, double tol) {
+    const size_t n = v.size();
+    if(n < 3 || !(tol > 0)) return;
+
+    // iteratively split ranges at farthest point from end-to-end segment
+    vector<char> keep(n);
+    keep[0] = keep[n-1] = true;
+    vector<std::pair<size_t,size_t>> ranges{{0, n-1}};
+    const double tol2 = tol*tol;
+    while(ranges.size()) {
+        auto r = ranges.back();
+        ranges.pop_back();
+        const auto& a = v[r.first];
+        const double dx = v[r.second][0] - a[0], dy = v[r.second][1] - a[1];
+        const double l2 = dx*dx + dy*dy;
+
+        double dmax = 0;
+        size_t imax = 0;
+        for(size_t i = r.first + 1; i < r.second; ++i) {
+            double px = v[i][0] - a[0], py = v[i][1] - a[1];
+            const double t = l2? std::max(0., std::min(1., (px*dx + py*dy)/l2)) : 0;
+            px -= t*dx;
+            py -= t*dy;
+            const double d = px*px + py*py;
+            if(d > dmax) { dmax = d; imax = i; }
+        }
+        if(!(dmax > tol2)) continue;
+        keep[imax] = true;
+        if(imax - r.first > 1) ranges.emplace_back(r.first, imax);
+        if(r.second - imax > 1) ranges.emplace_back(imax, r.second);
+    }
+
+    size_t j = 0;
+    for(size_t i = 0; i < n; ++i) if(keep[i]) v[j++] = v[i];
+    v.resize(j);
+}
+
+void polyline::prepare() {
+    if(decimate_tol > 0) decimate(pts, decimate_tol);
+    string s;
+    s.reserve(16*pts.size());
+    char c[64];
+    for(auto const& pt: pts) {
+        snprintf(c, sizeof(c), "%g,%g ", pt[0], pt[1]);
+        s += c;
+    }
+    attrs["points"] = s;
+}
+
+//////////////////////////////////////////
+
+SVGStream::SVGStream(ostream& _o, const BBXML::BBox2& BB, double x2cm): o(_o) {
+    svg::make_standalone_header(o);
+    auto b = new svg();
+    b->setView(BB, x2cm);
+    openGroup(b);
+}
+
+void SVGStream::add(XMLTag* X) {
+    if(!X) return;
+    if(!opened.size()) throw std::logic_error("SVGStream already closed");
+    auto B = dynamic_cast<BBXML*>(X);
+    if(B) contentsBB += B->getBB();
+    X->write(o, opened.size(), indent);
+    o << "\n";
+    ++nElements;
+    delete X;
+}
+
+void SVGStream::openGroup(XMLTag* X) {
+    if(!X) throw std::logic_error("SVGStream null group");
+    if(nElements && !opened.size()) throw std::logic_error("SVGStream already closed");
+    X->writeStart(o, opened.size(), indent);
+    o << "\n";
+    opened.push_back(X);
+}
+
+void SVGStream::closeGroup() {
+    if(!opened.size()) throw std::logic_error("SVGStream no group to close");
+    auto X = opened.back();
+    opened.pop_back();
+    X->writeEnd(o, opened.size(), indent);
+    if(opened.size()) o << "\n";
+    delete X;
+    ++nElements;
+}
+
+void SVGStream::close() {
+    while(opened.size()) closeGroup();
+    o.flush();
+}
@@ -171,18 +171,17 @@ namespace SVG {
         explicit polyline(const string& style = ""): BBXML("polyline") { if(style.size()) attrs["style"] = style; }
         void addpt(double x, double y) { pts.push_back({{x,y}}); }
         vector<xypoint> pts;
+        double decimate_tol = 0;    ///< if > 0, remove points within this distance of simplified curve on output
         /// Calculate bounding box from contents
         BBox2 getBB() override {
             BB = BBox2();
             for(auto p: pts) BB.expand(p);
             return BB;
         }
+        /// Ramer-Douglas-Peucker simplification, removing points within distance tol of simplified curve
+        static void decimate(vector<xypoint>& v, double tol);
     protected:
-        void prepare() override {
-            string s = "";
-            for(auto const& pt: pts) s += to_str(pt[0]) + "," +  to_str(pt[1]) + " ";
-            attrs["points"] = s;
-        }
+        void prepare() override;
     };
 
     class polygon: public polyline {
@@ -263,6 +262,32 @@ namespace SVG {
             o.close();
         }
     };
+
+    /// Streaming SVG document writer: elements are written and deleted as they are completed, rather than held in memory
+    class SVGStream {
+    public:
+        /// Constructor, writing header and svg start tag with view bounding box BB to o
+        SVGStream(ostream& _o, const BBXML::BBox2& BB, double x2cm = 1.);
+        /// Destructor, closing document
+        ~SVGStream() { close(); }
+
+        /// write and delete finished element (including subtree) at current nesting level
+        void add(XMLTag* X);
+        /// write start tag for element (typically group) containing following elements, until closeGroup()
+        void openGroup(XMLTag* X);
+        /// end innermost open group
+        void closeGroup();
+        /// close any open groups, and document
+        void close();
+
+        BBXML::BBox2 contentsBB;    ///< accumulated (un-transformed) bounding box of added elements
+        size_t nElements = 0;       ///< number of elements written
+
+    protected:
+        ostream& o;                 ///< output stream
+        vector<XMLTag*> opened;     ///< open nesting levels, starting with svg body
+        string indent = "\t";       ///< indentation
+    };
 }
 
 #endif
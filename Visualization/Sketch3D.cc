@@ -3,6 +3,9 @@
 
 #include "Sketch3D.hh"
 #include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 void Perspective::project(const double xyz[3], double xyzs[4]) const {
     // position relative to viewer
@@ -18,6 +21,37 @@ void Perspective::project(const double xyz[3], double xyzs[4]) const {
     }
 }
 
+CoordTransform<3,double> Perspective::getTransform() const {
+    Matrix<3,3,double> R;
+    Vec<3,double> d;
+    for(auto i: {0,1,2}) {
+        const double f = flipY && i == 1? -1 : 1;
+        for(auto j: {0,1,2}) R(i,j) = f*M[i][j];
+        d[i] = -f*v0[i];
+    }
+    CoordTransform<3,double> T;
+    T *= R;
+    T += d;
+    return T;
+}
+
+void Perspective::project(vector<Vec<3,double>>& in, xyzspt* out) const {
+    const auto T = getTransform();
+    const double vz = -v0[2];
+    const size_t nblock = 256; // cache-resident blocks for transform and perspective passes
+    for(size_t k0 = 0; k0 < in.size(); k0 += nblock) {
+        const size_t n = std::min(nblock, in.size() - k0);
+        auto p = in.data() + k0;
+        auto o = out + k0;
+        T.apply(p, p, n);
+        if(isOrtho) for(size_t k = 0; k < n; ++k) o[k] = {{p[k][0], p[k][1], p[k][2], 1.}};
+        else for(size_t k = 0; k < n; ++k) {
+            const double s = vz/p[k][2];
+            o[k] = {{s*p[k][0], s*p[k][1], p[k][2], s}};
+        }
+    }
+}
+
 void Perspective::clearRotation() {
     for(auto i: {0,1,2})
         for(auto j: {0,1,2})
@@ -41,9 +75,19 @@ void Perspective::projectPoly(const vector<xyzpt>& vIn, vector<SVG::xypoint>& vO
 ////////////////////////////////
 ////////////////////////////////
 
-void ProjectableBall::setPerspective(const Perspective& P) {
-    xyzspt cp;
-    P.project(c,cp);
+void ProjectablePrimitive::setPerspective(const Perspective& P) {
+    size_t n = 0;
+    auto p = getPoints(n);
+    if(!n) throw std::logic_error("ProjectablePrimitive requires getPoints or setPerspective");
+    vector<Vec<3,double>> v;
+    for(size_t i = 0; i < n; ++i) v.emplace_back(p[i]);
+    vector<xyzspt> vp(n);
+    P.project(v, vp.data());
+    setProjected(vp.data());
+}
+
+void ProjectableBall::setProjected(const xyzspt* p) {
+    auto& cp = *p;
     z = cp[2];
     s = cp[3];
     delete myXML;
@@ -51,9 +95,16 @@ void ProjectableBall::setPerspective(const Perspective& P) {
     setAttrs();
 }
 
-void ProjectablePoly::setPerspective(const Perspective& P) {
+void ProjectablePoly::setProjected(const xyzspt* p) {
     auto pg = new SVG::polyline;
-    P.projectPoly(pts, pg->pts, s, z);
+    s = z = 0;
+    for(size_t i = 0; i < pts.size(); ++i) {
+        pg->pts.push_back({{p[i][0], p[i][1]}});
+        z += p[i][2];
+        s += p[i][3];
+    }
+    s /= pts.size();
+    z /= pts.size();
     if(closed) pg->name = "polygon";
     delete myXML;
     myXML = pg;
@@ -109,12 +160,67 @@ void MultiLayer::drawInto(XMLTag& X, const Perspective& P) {
 
 //////////////////////////////////////
 
-bool compare_projectables(const unique_ptr<ProjectablePrimitive>& lhs,
-                          const unique_ptr<ProjectablePrimitive>& rhs) { return lhs->z + lhs->z0 < rhs->z + rhs->z0; }
+void PrimitivesLayer::projectRange(const Perspective& P, size_t i0, size_t i1, vector<Vec<3,double>>& v, vector<xyzspt>& vp) {
+    // gather vertices
+    v.clear();
+    for(size_t i = i0; i < i1; ++i) {
+        size_t n = 0;
+        auto p = myObjs[i]->getPoints(n);
+        for(size_t j = 0; j < n; ++j) v.emplace_back(p[j]);
+        if(!n) myObjs[i]->setPerspective(P);
+    }
+
+    // one projection batch
+    vp.resize(v.size());
+    P.project(v, vp.data());
+
+    size_t k = 0;
+    for(size_t i = i0; i < i1; ++i) {
+        size_t n = 0;
+        myObjs[i]->getPoints(n);
+        if(n) myObjs[i]->setProjected(vp.data() + k);
+        k += n;
+    }
+}
 
 void PrimitivesLayer::drawInto(XMLTag& X, const Perspective& P) {
-    for(auto& o: myObjs) o->setPerspective(P);
-    std::sort(myObjs.begin(), myObjs.end(), &compare_projectables);
+    // projection and depth sort, in chunks per thread
+    const size_t n = myObjs.size();
+    size_t nt = nthreads? nthreads : std::thread::hardware_concurrency();
+    nt = std::max(size_t(1), std::min(nt, n/1024));
+    vector<std::pair<double,size_t>> zi(n);
+
+    std::exception_ptr err;
+    std::mutex errMut;
+    auto work = [&](size_t t) {
+        try {
+            const size_t i0 = n*t/nt, i1 = n*(t+1)/nt;
+            vector<Vec<3,double>> v;
+            vector<xyzspt> vp;
+            projectRange(P, i0, i1, v, vp);
+            for(size_t i = i0; i < i1; ++i) zi[i] = {myObjs[i]->z + myObjs[i]->z0, i};
+            std::sort(zi.begin() + i0, zi.begin() + i1);
+        } catch(...) {
+            std::lock_guard<std::mutex> l(errMut);
+            if(!err) err = std::current_exception();
+        }
+    };
+    vector<std::thread> v;
+    for(size_t t = 1; t < nt; ++t) v.emplace_back(work, t);
+    work(0);
+    for(auto& t: v) t.join();
+    if(err) std::rethrow_exception(err);
+
+    // merge sorted chunks
+    for(size_t w = 1; w < nt; w *= 2)
+        for(size_t t = 0; t + w < nt; t += 2*w)
+            std::inplace_merge(zi.begin() + n*t/nt, zi.begin() + n*(t+w)/nt, zi.begin() + n*std::min(t+2*w, nt)/nt);
+
+    vector<unique_ptr<ProjectablePrimitive>> sorted;
+    sorted.reserve(n);
+    for(auto& p: zi) sorted.push_back(std::move(myObjs[p.second]));
+    myObjs.swap(sorted);
+
     for(auto& o: myObjs) {
         X.addChild(o->myXML);
         o->myXML = nullptr;
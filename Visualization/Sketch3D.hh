@@ -5,6 +5,7 @@
 #define SKETCH3D_HH
 
 #include "SVGBuilder.hh"
+#include "CoordTransform.hh"
 #include <memory>
 using std::unique_ptr;
 
@@ -29,6 +30,10 @@ public:
     void project(const double xyz[3], double xyzs[4]) const;
     /// project point from 3D x,y,z to 2D x,y,z + perspective scale factor
     void project(const xyzpt& xyz, xyzspt& xyzs) const { project(xyz.data(), xyzs.data()); }
+    /// project n points; in may be re-used as (transformed-to-viewer) workspace
+    void project(vector<Vec<3,double>>& in, xyzspt* out) const;
+    /// rotation, viewer offset, and y flip as fused coordinate transform
+    CoordTransform<3,double> getTransform() const;
     /// set identity rotation
     void clearRotation();
 
@@ -47,8 +52,12 @@ public:
     /// Destructor
     virtual ~ProjectablePrimitive() { delete myXML; }
 
-    /// Generate XML and calculate z for perspective
-    virtual void setPerspective(const Perspective& P) = 0;
+    /// Generate XML and calculate z for perspective; default by setProjected() from projected getPoints()
+    virtual void setPerspective(const Perspective& P);
+    /// vertices to project, for batched projection; n = 0 if only custom setPerspective available
+    virtual const xyzpt* getPoints(size_t& n) const { n = 0; return nullptr; }
+    /// Generate XML and calculate z from projected getPoints() vertices
+    virtual void setProjected(const xyzspt*) { }
 
     XMLTag* myXML = nullptr;        ///< generated XML
     double z0 = 0;                  ///< depth-sorting shift for all projections
@@ -70,8 +79,10 @@ public:
     /// Constructor
     ProjectableBall(xyzpt cc, double rr): c(cc), r(rr) { }
 
-    /// Generate XML and calculate z for perspective
-    void setPerspective(const Perspective& P) override;
+    /// vertices to project: center
+    const xyzpt* getPoints(size_t& n) const override { n = 1; return &c; }
+    /// Generate XML and calculate z from projected center
+    void setProjected(const xyzspt* p) override;
 
     xyzpt c;    ///< center
     double r;   ///< radius
@@ -80,8 +91,10 @@ public:
 /// 3D-projectable polyline/polygon
 class ProjectablePoly: public ProjectablePrimitive {
 public:
-    /// Generate XML and calculate z for perspective
-    void setPerspective(const Perspective& P) override;
+    /// vertices to project
+    const xyzpt* getPoints(size_t& n) const override { n = pts.size(); return pts.data(); }
+    /// Generate XML and calculate z from projected points
+    void setProjected(const xyzspt* p) override;
 
     bool closed = false;    ///< closed (polygon) or open (polyline) curve
     vector<xyzpt> pts;      ///< points on line
@@ -111,10 +124,15 @@ public:
 /// Layer with z-sortable list of primitives
 class PrimitivesLayer: public SketchLayer {
 public:
-    /// "Draw" contents into provided parent using projection
+    /// "Draw" contents into provided parent using projection; batched projection, and parallel over nthreads
     void drawInto(XMLTag& X, const Perspective& P) override;
 
     vector<unique_ptr<ProjectablePrimitive>> myObjs; ///< drawable objects
+    unsigned int nthreads = 0;  ///< projection and sorting threads; 0 for hardware concurrency
+
+protected:
+    /// project objects [i0, i1) as one vertex batch, using workspaces v, vp
+    void projectRange(const Perspective& P, size_t i0, size_t i1, vector<Vec<3,double>>& v, vector<xyzspt>& vp);
 };
 
 /*
@@ -0,0 +1,48 @@
+/// \file TermStreamSink.hh DataSink stage feeding live TermStream terminal plot
+// -- Michael P. Mendenhall, LLNL 2021
+
+#ifndef TERMSTREAMSINK_HH
+#define TERMSTREAMSINK_HH
+
+#include "Terminplot.hh"
+#include "DataSink.hh"
+#include <functional>
+#include <stdio.h>
+
+/// Plot value extracted from each pushed object; optionally redrawn (incrementally) to stdout every nredraw objects and at flush/end
+template<typename T = const double>
+class TermStreamSink: public DataSink<T> {
+public:
+    typedef T sink_t;
+    /// plotted value extraction
+    typedef std::function<double(sink_t&)> valuef_t;
+
+    /// Constructor, with value extraction function
+    explicit TermStreamSink(valuef_t f = [](sink_t& o) { return double(o); }, Terminart::rowcol_t d = {15, 80}):
+    S(d), val(f) { }
+
+    /// take one object
+    void push(sink_t& o) override {
+        S.push(val(o));
+        if(nredraw && !(S.getN() % nredraw)) redraw();
+    }
+
+    /// redraw on flush or end of data
+    void signal(datastream_signal_t s) override { if(nredraw && (s == DATASTREAM_FLUSH || s == DATASTREAM_END)) redraw(); }
+
+    /// (incrementally) redraw plot to stdout
+    void redraw() {
+        auto a = S.toArray();
+        fputs(TS.update(a).c_str(), stdout);
+        fflush(stdout);
+    }
+
+    Terminart::TermStream S;    ///< streaming plot
+    size_t nredraw = 0;         ///< redraw interval; 0 to disable display
+
+protected:
+    valuef_t val;               ///< value extraction
+    Terminart::TermScreen TS;   ///< terminal display state
+};
+
+#endif
@@ -38,7 +38,9 @@ void pixel_t::set256(const color::rgb& crgb, bool fg) {
 //----------------------------------
 //----------------------------------
 
-const Compositor Compositor::Cdefault;
+/// default compositor instance
+static const OverCompositor C_over;
+const Compositor& Compositor::Cdefault = C_over;
 
 void VPixelBuffer::hline(rowcol_t x0, int dx, pixel_t p, const Compositor& C) {
     if(dx < 0) {
@@ -89,32 +91,99 @@ void VPixelBuffer::drawFrame(rectangle_t r,
 //----------------------------------
 
 void pixelarray_t::composite(rowcol_t x0, const pixelarray_t& o, const Compositor& C) {
-    int rmax = std::min(dim.first, o.dim.first - x0.first);
-    int cmax = std::min(dim.second, o.dim.second - x0.second);
-    rowcol_t x;
-    for(x.first = x0.first; x.first < rmax; ++x.first) {
-        for(x.second = x0.second; x.second < cmax; ++x.second) {
-            cput(x, o(x-x0), C);
-        }
-    }
+    const int r0 = std::max(0, x0.first), r1 = std::min(dim.first, x0.first + o.dim.first);
+    const int c0 = std::max(0, x0.second), c1 = std::min(dim.second, x0.second + o.dim.second);
+    if(c1 <= c0) return;
+    for(int r = r0; r < r1; ++r) C.row(row(r) + c0, o.row(r - x0.first) + (c0 - x0.second), c1 - c0, {r, c0});
 }
 
-string pixelarray_t::render(const string& newline, char cnull) const {
-    string s;
+void pixelarray_t::hline(rowcol_t x0, int dx, pixel_t p, const Compositor& C) {
+    if(dx < 0) {
+        x0.second += dx;
+        dx = -dx;
+    }
+    if(x0.first < 0 || x0.first >= dim.first) return;
+    const int c0 = std::max(0, x0.second), c1 = std::min(dim.second, x0.second + dx);
+    if(c1 <= c0) return;
+    const vector<pixel_t> v(c1 - c0, p);
+    C.row(row(x0.first) + c0, v.data(), c1 - c0, {x0.first, c0});
+}
 
-    TermSGR tprev;
+void pixelarray_t::render(string& s, const string& newline, char cnull) const {
+    const TermSGR t0;
+    const TermSGR* tprev = &t0;
     auto it = begin();
     for(int r = 0; r < dim.first; ++r) {
         for(int c = 0; c < dim.second; ++c) {
-            s += it->s.diff(tprev);
+            it->s.diff(*tprev, s);
             s += it->c? it->c : cnull;
-            tprev = (it++)->s;
+            tprev = &(it++)->s;
+        }
+        t0.diff(*tprev, s);
+        s += newline;
+        tprev = &t0;
+    }
+}
+
+//----------------------------------
+//----------------------------------
+
+const string& TermScreen::update(const pixelarray_t& a, rectangle_t dirty, char cnull) {
+    out.clear();
+    damage = null_rectangle;
+    nchanged = 0;
+
+    if(shown.empty() || sdim != a.dim) {
+        // full redraw, clearing any previous larger frame
+        if(!shown.empty()) out += "\033[J";
+        a.render(out, "\n", cnull);
+        if(a.dim.first) out += cmove_control({-a.dim.first, 0});
+        shown.assign(a.begin(), a.end());
+        sdim = a.dim;
+        if(a.size()) damage = {{0,0}, a.dim - rowcol_t{1,1}};
+        nchanged = a.size();
+        return out;
+    }
+
+    const int r0 = std::max(0, dirty.first.first), r1 = std::min(sdim.first, dirty.second.first);
+    const int c0 = std::max(0, dirty.first.second), c1 = std::min(sdim.second, dirty.second.second);
+
+    const TermSGR t0;
+    const TermSGR* tcur = &t0;  // current terminal style
+    rowcol_t cur{0,0};          // current cursor position
+    auto emit = [&](const pixel_t& p) {
+        p.s.diff(*tcur, out);
+        out += p.c? p.c : cnull;
+        tcur = &p.s;
+        ++cur.second;
+    };
+
+    for(int r = r0; r < r1; ++r) {
+        const pixel_t* pa = a.row(r);
+        pixel_t* ps = shown.data() + r*sdim.second;
+        for(int c = c0; c < c1; ++c) {
+            if(pa[c] == ps[c]) continue;
+
+            if(r == cur.first && c >= cur.second && c - cur.second <= maxgap) {
+                // re-draw short unchanged gap
+                while(cur.second < c) emit(ps[cur.second]);
+            } else {
+                if(c == 0 && cur.second) out += '\r';
+                else out += cmove_control({0, c - cur.second});
+                out += cmove_control({r - cur.first, 0});
+                cur = {r, c};
+            }
+            ps[c] = pa[c];
+            emit(ps[c]);
+            damage.include(rowcol_t{r, c});
+            ++nchanged;
         }
-        s += TermSGR().diff(tprev) + newline;
-        tprev = TermSGR();
     }
 
-    return s;
+    t0.diff(*tcur, out);
+    if(cur.second) out += '\r';
+    out += cmove_control({-cur.first, 0});
+    return out;
 }
 
 //----------------------------------
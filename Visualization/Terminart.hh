@@ -25,6 +25,11 @@ namespace Terminart {
         /// set 8-bit (256 color) approximant
         void set256(const color::rgb& crgb, bool fg = true);
 
+        /// equality comparison
+        bool operator==(const pixel_t& p) const { return c == p.c && s == p.s; }
+        /// inequality comparison
+        bool operator!=(const pixel_t& p) const { return !(*this == p); }
+
         char c;     ///< character to display (0 for "blank" default)
         TermSGR s;  ///< display style
     };
@@ -70,8 +75,21 @@ namespace Terminart {
         virtual ~Compositor() { }
         /// Return b layered over a at position x
         virtual pixel_t operator()(const pixel_t& a, const pixel_t& b, rowcol_t) const { return b.c? b : a; }
+        /// composite row of n pixels b over a (in place), starting at position x; override for bulk operation without per-pixel virtual calls
+        virtual void row(pixel_t* a, const pixel_t* b, int n, rowcol_t x) const {
+            for(int i = 0; i < n; ++i, ++x.second) a[i] = (*this)(a[i], b[i], x);
+        }
 
-        static const Compositor Cdefault;   ///< default compositor
+        static const Compositor& Cdefault;  ///< default compositor
+    };
+
+    /// default non-blank-over compositor, with bulk row operation
+    class OverCompositor final: public Compositor {
+    public:
+        /// Return b layered over a at position x
+        pixel_t operator()(const pixel_t& a, const pixel_t& b, rowcol_t) const override { return b.c? b : a; }
+        /// composite row of n pixels b over a (in place)
+        void row(pixel_t* a, const pixel_t* b, int n, rowcol_t) const override { for(int i = 0; i < n; ++i) if(b[i].c) a[i] = b[i]; }
     };
 
     /// pixel buffer virtual base interface, with drawing primitives
@@ -94,7 +112,7 @@ namespace Terminart {
         pixel_t p_xtra;     ///< extra pixel returned for out-of-bounds element access
 
         /// draw horizontal line
-        void hline(rowcol_t x0, int dx, pixel_t p, const Compositor& C = Compositor::Cdefault);
+        virtual void hline(rowcol_t x0, int dx, pixel_t p, const Compositor& C = Compositor::Cdefault);
         /// draw vertical line
         void vline(rowcol_t x0, int dy, pixel_t p, const Compositor& C = Compositor::Cdefault);
         /// framed rectangle
@@ -114,8 +132,15 @@ namespace Terminart {
         pixel_t& operator()(rowcol_t x) override { return inbounds(x)? (*this)[x.second + x.first*dim.second] : p_xtra; }
         /// element access
         pixel_t operator()(rowcol_t x) const override { return inbounds(x)? (*this)[x.second + x.first*dim.second] : p_xtra; }
-        /// composite other array over this, starting at position x0 (in this array)
+        /// composite other array over this, starting at position x0 (in this array), row-by-row
         void composite(rowcol_t x0, const pixelarray_t& o, const Compositor& C = Compositor::Cdefault);
+        /// draw horizontal line, composited as one row
+        void hline(rowcol_t x0, int dx, pixel_t p, const Compositor& C = Compositor::Cdefault) override;
+
+        /// start of row r pixels
+        pixel_t* row(int r) { return data() + r*dim.second; }
+        /// start of row r pixels
+        const pixel_t* row(int r) const { return data() + r*dim.second; }
 
         using vector::size;
         using vector::begin;
@@ -124,7 +149,34 @@ namespace Terminart {
         const rowcol_t dim; ///< array dimensions, nRows x nCols
 
         /// render with terminal control codes
-        string render(const string& newline = "\n", char cnull = ' ') const;
+        string render(const string& newline = "\n", char cnull = ' ') const { string s; render(s, newline, cnull); return s; }
+        /// render with terminal control codes, appending to s
+        void render(string& s, const string& newline = "\n", char cnull = ' ') const;
+    };
+
+    /// Incrementally-updated terminal display of pixel array frames, emitting only cursor moves and cells changed from the previous frame
+    /**
+     * The frame is drawn starting at the cursor position, which must be at the start (column 0) of a terminal line
+     * and is returned there after each update. The first update draws the full frame, with newlines (scrolling as needed);
+     * later updates compare each cell against the displayed frame, and skip unchanged runs by cursor movement.
+     */
+    class TermScreen {
+    public:
+        /// terminal output to update display to frame a; output buffer reused between calls
+        const string& update(const pixelarray_t& a, char cnull = ' ') { return update(a, {{0,0}, a.dim}, cnull); }
+        /// update, comparing only cells within dirty range [dirty.first, dirty.second) (caller-tracked changes)
+        const string& update(const pixelarray_t& a, rectangle_t dirty, char cnull = ' ');
+        /// force full redraw on next update (e.g. after terminal cleared)
+        void invalidate() { shown.clear(); }
+
+        rectangle_t damage = null_rectangle;    ///< bounding box (inclusive corners) of cells changed in last update
+        size_t nchanged = 0;                    ///< number of cells changed in last update
+        int maxgap = 4;                         ///< unchanged cells re-drawn, rather than skipped by cursor movement
+
+    protected:
+        vector<pixel_t> shown;  ///< currently displayed cells
+        rowcol_t sdim;          ///< displayed frame dimensions
+        string out;             ///< output buffer
     };
 
     /// sparse collection of display pixels
@@ -91,3 +91,86 @@ void TermGraph::getView(rowcol_t p0, pixelarray_t& v, const Compositor& C) const
         v.cput(p0 + kv.first, s, C);
     }
 }
+
+//---------------------------------
+
+TermStream::TermStream(rowcol_t d, size_t b, size_t nbins): plotdim(d), base(b), maxbins(nbins? nbins : 4*d.second) {
+    if(!isValidDim(d) || !d.first || !d.second) throw std::logic_error("Invalid TermStream plot dimensions");
+    if(!base || maxbins < 2) throw std::logic_error("Invalid TermStream binning");
+}
+
+void TermStream::clear() {
+    N = 0;
+    L0cur = bin_t();
+    L.clear();
+}
+
+void TermStream::complete() {
+    N += L0cur.n;
+    bin_t b = L0cur;
+    L0cur = bin_t();
+    for(size_t k = 0; ; ++k) {
+        if(k == L.size()) L.emplace_back();
+        auto& l = L[k];
+        l.bins.push_back(b);
+        if(l.bins.size() > maxbins) { l.bins.pop_front(); ++l.i0; }
+        if(k + 1 == L.size()) L.emplace_back();
+        auto& u = L[k+1];
+        u.cur += b;
+        if(++u.ncur < 2) return;
+        b = u.cur;
+        u.cur = bin_t();
+        u.ncur = 0;
+    }
+}
+
+vector<TermStream::bin_t> TermStream::columns(double& x0, double& x1) const {
+    const size_t ncol = plotdim.second;
+    vector<bin_t> c(ncol);
+    const size_t n = getN();
+    const size_t s0 = window && window < n? n - window : 0;
+    x0 = s0;
+    x1 = n;
+    if(!n) return c;
+
+    // finest level retaining start of range
+    size_t k = 0, w = base;
+    while(k + 1 < L.size() && L[k].i0 * w > s0) { ++k; w *= 2; }
+
+    auto put = [&](size_t i, const bin_t& b) {
+        if(!b.n) return;
+        c[std::min((i - std::min(i, s0)) * ncol / (n - s0), ncol - 1)] += b;
+    };
+
+    bin_t tail = L0cur; // samples after last completed bin in level k
+    if(L.size()) {
+        auto& l = L[k];
+        for(size_t j = std::max(l.i0, s0/w); j < l.i0 + l.bins.size(); ++j) put(j*w, l.bins[j - l.i0]);
+        for(size_t m = 1; m <= k; ++m) tail += L[m].cur;
+        put((l.i0 + l.bins.size())*w, tail);
+    } else put(0, tail);
+    return c;
+}
+
+void TermStream::getView(rowcol_t p0, pixelarray_t& v, const Compositor& C) const {
+    double x0, x1;
+    auto c = columns(x0, x1);
+    bin_t r;
+    for(auto& b: c) r += b;
+
+    LinAxis Ay(false, r.n? r.min : 0, r.n? r.max : 1, plotdim.first);
+    if(!(Ay.x1 > Ay.x0)) { Ay.x0 -= 0.5; Ay.x1 += 0.5; }
+    LinAxis Ax(true, x0, x1, plotdim.second);
+    Ay.getView(p0, v, C);
+    p0 = p0 + Ay.getBounds().second;
+    Ax.getView(p0, v, C);
+    v.cput(p0 - rowcol_t(0,1), {'+'}, C);
+
+    auto row = [&](double y) { return int(round(-Ay.x2i(y) - 1)); };
+    for(int i = 0; i < plotdim.second; ++i) {
+        if(!c[i].n) continue;
+        const int r0 = row(c[i].max), r1 = row(c[i].min);
+        if(r1 > r0) v.vline(p0 + rowcol_t{r0, i}, r1 - r0 + 1, {crange}, C);
+        v.cput(p0 + rowcol_t{row(c[i].mean()), i}, {cmean}, C);
+    }
+}
@@ -5,6 +5,8 @@
 #define TERMINPLOT_HH
 
 #include "Terminart.hh"
+#include <cmath>
+#include <deque>
 
 namespace Terminart {
 
@@ -111,7 +113,72 @@ namespace Terminart {
         vector<double> binconts;    ///< bin contents
     };
 
+    /// Streaming data series plot, with multi-resolution summaries for constant rendering cost
+    /**
+     * Samples y_i are plotted against index i. Each pyramid level k keeps (up to maxbins most recent)
+     * min/max/mean summaries of consecutive blocks of base*2^k samples; rendering uses the finest level
+     * covering the displayed range, so costs O(maxbins) regardless of the number of samples pushed.
+     */
+    class TermStream: public TermViewport {
+    public:
+        /// summary of consecutive samples
+        struct bin_t {
+            size_t n = 0;               ///< number of samples
+            double sum = 0;             ///< sum of samples
+            double min = HUGE_VAL;      ///< minimum sample
+            double max = -HUGE_VAL;     ///< maximum sample
+
+            /// add sample
+            void add(double y) { ++n; sum += y; min = std::min(min, y); max = std::max(max, y); }
+            /// combine summaries
+            void operator+=(const bin_t& b) { n += b.n; sum += b.sum; min = std::min(min, b.min); max = std::max(max, b.max); }
+            /// samples mean
+            double mean() const { return n? sum/n : 0; }
+        };
+
+        /// Constructor, with plot area dimensions, finest bin samples, and bins kept per level (0 for 4 per column)
+        explicit TermStream(rowcol_t d = {15, 80}, size_t b = 1, size_t nbins = 0);
+
+        /// add sample
+        void push(double y) { L0cur.add(y); if(L0cur.n == base) complete(); }
+        /// add n samples
+        void push(const double* y, size_t n) { while(n--) push(*y++); }
+        /// total number of samples pushed
+        size_t getN() const { return N + L0cur.n; }
+        /// clear all data
+        void clear();
+
+        /// summaries of displayed samples (window of most recent, or full history) in each column, and x range displayed
+        vector<bin_t> columns(double& x0, double& x1) const;
+
+        rowcol_t plotdim;   ///< plot area dimensions
+        size_t window = 0;  ///< number of most recent samples to display; 0 for full history
+        char cmean = '*';   ///< column mean symbol
+        char crange = ':';  ///< column min-max range symbol
 
+        /// get bounding box
+        rectangle_t getBounds() const override { return {{0,0}, plotdim + rowcol_t{2, 5}}; }
+        /// fill viewport vector starting at p0 with given dimensions
+        void getView(rowcol_t p0, pixelarray_t& v, const Compositor& C = Compositor::Cdefault) const override;
+
+    protected:
+        /// one resolution level
+        struct level_t {
+            std::deque<bin_t> bins; ///< completed summaries, oldest first
+            size_t i0 = 0;          ///< index of first kept bin
+            bin_t cur;              ///< partial summary of completed finer-level bins
+            int ncur = 0;           ///< number of finer-level bins in cur
+        };
+
+        /// complete finest-level bin, cascading to coarser levels
+        void complete();
+
+        size_t base;            ///< samples per finest-level bin
+        size_t maxbins;         ///< bins kept per level
+        size_t N = 0;           ///< total completed-bin samples
+        bin_t L0cur;            ///< partial finest-level bin
+        vector<level_t> L;      ///< multi-resolution levels
+    };
 }
 
 #endif
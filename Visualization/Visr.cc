@@ -12,36 +12,100 @@ void appendv(std::vector<float>& v, VisDriver::vec3 a) {
     v.push_back(a[2]);
 }
 
+/// maximum batch floats before automatic flush (keeping vertex counts exact in float)
+static constexpr size_t max_batch = 3 << 22;
+
+void VisDriver::flushBatch() {
+    if(nBatched) {
+        vector<float> v;
+        v.reserve(nBatched + 5*batch.size());
+        for(auto& kv: batch) {
+            v.insert(v.end(), kv.first.begin(), kv.first.end());
+            v.push_back(kv.second.size()/3);
+            v.insert(v.end(), kv.second.begin(), kv.second.end());
+        }
+        batch.clear();
+        nBatched = 0;
+        pushCommand(VisCmd(&VisDriver::_batch, std::move(v)));
+        colorPending = true;
+    }
+    if(colorPending) pushCommand(VisCmd(&VisDriver::_setColor, {cColor[0], cColor[1], cColor[2], cColor[3]}));
+    colorPending = false;
+}
+
+void VisDriver::_batch(const vector<float>& v) {
+    for(size_t i = 0; i + 5 <= v.size();) {
+        _setColor({v[i], v[i+1], v[i+2], v[i+3]});
+        const size_t n = v[i+4];
+        i += 5;
+        for(size_t j = 0; j + 1 < n; j += 2, i += 6) _lines({v[i], v[i+1], v[i+2], v[i+3], v[i+4], v[i+5], 0});
+    }
+}
+
 void VisDriver::teapot(double s) {
+    flushBatch();
     VisCmd c(&VisDriver::_teapot, {float(s)});
     pushCommand(c);
 }
 
 void VisDriver::setColor(float r, float g, float b, float a) {
-    pushCommand(VisCmd(&VisDriver::_setColor, {r,g,b,a}));
+    if(!batched) flushBatch();
+    cColor = {{r,g,b,a}};
+    if(batched) colorPending = true;
+    else pushCommand(VisCmd(&VisDriver::_setColor, {r,g,b,a}));
 }
 
 void VisDriver::clearWindow(float r, float g, float b, float a) {
+    flushBatch();
     pushCommand(VisCmd(&VisDriver::_clearWindow, {r,g,b,a}));
 }
 
 void VisDriver::startRecording(bool newseg) {
+    flushBatch();
     VisCmd c(&VisDriver::_startRecording);
     if(newseg) c.v.push_back(1); // mark as addition to previous segment
     pushCommand(c);
 }
 
 void VisDriver::stopRecording() {
+    flushBatch();
     pushCommand(VisCmd(&VisDriver::_stopRecording));
 }
 
 void VisDriver::lines(const vector<vec3>& v, bool closed) {
+    if(batched) {
+        // polyline as separate segments
+        auto& b = batch[cColor];
+        const size_t n0 = b.size();
+        for(size_t i = 0; i + 1 < v.size(); ++i) {
+            appendv(b, v[i]*scale);
+            appendv(b, v[i+1]*scale);
+        }
+        if(closed && v.size() > 2) {
+            appendv(b, v.back()*scale);
+            appendv(b, v[0]*scale);
+        }
+        nBatched += b.size() - n0;
+        if(nBatched >= max_batch) flushBatch();
+        return;
+    }
+
+    flushBatch();
     VisCmd c(&VisDriver::_lines);
     for(auto& p: v) appendv(c.v, p*scale);
     c.v.push_back(closed);
     pushCommand(c);
 }
 
+void VisDriver::line(vec3 s, vec3 e) {
+    if(!batched) { lines({s,e}); return; }
+    auto& b = batch[cColor];
+    appendv(b, s*scale);
+    appendv(b, e*scale);
+    nBatched += 6;
+    if(nBatched >= max_batch) flushBatch();
+}
+
 void VisDriver::circle(vec3 o, vec3 n, int i, double th0) {
     int j0 = 0;
     for(auto j: {1,2}) if(fabs(n[j]) > fabs(n[j0])) j0 = j;
@@ -65,6 +129,7 @@ void VisDriver::circle(vec3 o, vec3 n, int i, double th0) {
 }
 
 void VisDriver::ball(vec3 p, double r, int nx, int ny) {
+    flushBatch();
     VisCmd c(&VisDriver::_ball);
     appendv(c.v, p*scale);
     c.v.push_back(r*scale);
@@ -7,6 +7,7 @@
 #include <vector>
 using std::vector;
 #include <array>
+#include <map>
 #include <stdexcept>
 
 /// Generic minimalist 3D visualization driver interface
@@ -34,13 +35,18 @@ public:
     /// lines or polygon
     void lines(const vector<vec3>& v, bool closed = false);
     /// draw specified line
-    void line(vec3 s, vec3 e) { lines({s,e}); }
+    void line(vec3 s, vec3 e);
     /// draw ball at location
     void ball(vec3 p, double r, int nx = 8, int ny = 8);
     /// draw circle (polygon) with center o, normal/radius n; i line segments
     void circle(vec3 o, vec3 n, int i = 36, double th0 = 0);
     /// draw teapot (OpenGL only!)
     void teapot(double s = 1.0);
+    /// submit accumulated batched lines (automatic before other commands)
+    void flushBatch();
+
+    /// accumulate lines into per-color segment batches, submitted as one command by flushBatch()
+    bool batched = false;
 
     /// Global drawing re-scale
     float scale = 1.0;
@@ -54,6 +60,8 @@ protected:
     struct VisCmd {
         /// Constructor
         explicit VisCmd(void (VisDriver::*f)(const vector<float>&), const vector<float>& _v = {}): fcn(f), v(_v) { }
+        /// Constructor, taking arguments by move
+        VisCmd(void (VisDriver::*f)(const vector<float>&), vector<float>&& _v): fcn(f), v(std::move(_v)) { }
 
         void (VisDriver::*fcn)(const vector<float>&);   ///< function to call
         vector<float> v;                                ///< function arguments
@@ -64,6 +72,8 @@ protected:
 
     /// add/process (possibly deferred) command
     virtual void pushCommand(const VisCmd& c) { (this->*c.fcn)(c.v); }
+    /// add/process (possibly deferred) command, by move
+    virtual void pushCommand(VisCmd&& c) { pushCommand(static_cast<const VisCmd&>(c)); }
 
     /// start a group of related drawing commands
     virtual void _startRecording(const vector<float>& v) { if(v.size()) _clearWindow(v); }
@@ -79,6 +89,14 @@ protected:
     virtual void _ball(const vector<float>&) { }
     /// OpenGL teapot
     virtual void _teapot(const vector<float>&) { }
+    /// draw batched line segments: per color, {r, g, b, a, number of vertices, x0, y0, z0, x1, ...}
+    virtual void _batch(const vector<float>& v);
+
+    /// batched line segment vertices, per color
+    std::map<std::array<float,4>, vector<float>> batch;
+    std::array<float,4> cColor{{0,0,0,1}}; ///< current user color
+    bool colorPending = false;              ///< whether cColor needs to be sent after batching
+    size_t nBatched = 0;                    ///< number of floats in batch
 };
 
 /// Convenience helper for setting visualization vectors
@@ -22,6 +22,7 @@ const string GLVisDriver::_pause_info =
 
 #else
 
+#define GL_GLEXT_PROTOTYPES // for vertex buffer objects
 #include <GL/glut.h>
 
 #endif
@@ -115,10 +116,44 @@ void GLVisDriver::_teapot(const vector<float>& v) {
     else glutWireTeapot(v[0]);
 }
 
+void GLVisDriver::_batch(const vector<float>& v) {
+    for(size_t i = 0; i + 5 <= v.size();) {
+        lineBuffer b;
+        for(auto j: {0,1,2,3}) b.c[j] = v[i+j];
+        b.n = v[i+4];
+        i += 5;
+        glGenBuffers(1, &b.buf);
+        glBindBuffer(GL_ARRAY_BUFFER, b.buf);
+        glBufferData(GL_ARRAY_BUFFER, 3*b.n*sizeof(float), v.data() + i, GL_STATIC_DRAW);
+        lineBuffers.push_back(b);
+        i += 3*b.n;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GLVisDriver::drawBatches() {
+    if(!lineBuffers.size()) return;
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    for(auto& b: lineBuffers) {
+        glColor4fv(b.c);
+        glBindBuffer(GL_ARRAY_BUFFER, b.buf);
+        glVertexPointer(3, GL_FLOAT, 0, nullptr);
+        glDrawArrays(GL_LINES, 0, b.n);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
 void GLVisDriver::_startRecording(const vector<float>& v) {
     glFlush();
     glFinish();
 
+    if(v.size()) {
+        for(auto& b: lineBuffers) glDeleteBuffers(1, &b.buf);
+        lineBuffers.clear();
+    }
+
     while(v.size() && displaySegs.size()) {
         if(glIsList(displaySegs.back()))
             glDeleteLists(displaySegs.back(), 1);   // delete this one old display list
@@ -145,6 +180,12 @@ void GLVisDriver::pushCommand(const VisCmd& c) {
     pthread_mutex_unlock(&commandLock);
 }
 
+void GLVisDriver::pushCommand(VisCmd&& c) {
+    pthread_mutex_lock(&commandLock);
+    commands.push_back(std::move(c));
+    pthread_mutex_unlock(&commandLock);
+}
+
 void GLVisDriver::tryFlush() {
     // cancel redraw if commands being updated
     if(pthread_mutex_trylock(&commandLock)) return;
@@ -174,6 +215,7 @@ void GLVisDriver::redrawDisplay() {
     if(!displaySegs.size()) return;
 
     glCallLists(displaySegs.size(), GL_UNSIGNED_INT, displaySegs.data());
+    drawBatches();
     glutSwapBuffers();
     glFlush();
     glFinish();
@@ -84,6 +84,8 @@ protected:
 
     /// add to backend commands execution queue
     void pushCommand(const VisCmd& c) override;
+    /// add to backend commands execution queue, by move
+    void pushCommand(VisCmd&& c) override;
 
     /// start a group of related drawing commands
     void _startRecording(const vector<float>&) override;
@@ -99,6 +101,10 @@ protected:
     void _ball(const vector<float>&) override;
     /// OpenGL teapot
     void _teapot(const vector<float>&) override;
+    /// upload batched line segments to vertex buffers
+    void _batch(const vector<float>&) override;
+    /// draw uploaded vertex buffers
+    void drawBatches();
 
     /// get current transformation matrix
     void getMatrix();
@@ -113,6 +119,14 @@ protected:
     std::deque<VisCmd> commands;    ///< to-be-processed commands
     pthread_mutex_t commandLock;    ///< commands queue lock
     std::vector<unsigned int> displaySegs;  ///< OpenGL display segment identifiers
+
+    /// retained vertex buffer of line segments in one color
+    struct lineBuffer {
+        unsigned int buf;   ///< OpenGL buffer identifier
+        int n;              ///< number of vertices
+        float c[4];         ///< color
+    };
+    std::vector<lineBuffer> lineBuffers;    ///< batched line segments, drawn after display segments
 #else
     static constexpr bool hasGL = false;
 #endif
@@ -17,4 +17,20 @@ inline string svgzOut(SVG::SVGDoc& D, const string& outbase, bool gzipIt = true)
     return ext;
 }
 
+/// Streaming SVG output to .svg or compressed .svgz file, compressed as elements are written
+class svgzStream {
+public:
+    /// Constructor, with output file base name, view bounding box, and scale
+    svgzStream(const string& outbase, const SVG::BBXML::BBox2& BB, double x2cm = 1., bool gzipIt = true):
+    ext(gzipIt && gzOutWrapper::canZip? ".svgz" : ".svg"), o(mkfile(outbase + ext), gzipIt && gzOutWrapper::canZip), S(o.f, BB, x2cm) { }
+
+    const string ext;   ///< selected file extension
+protected:
+    /// create path to file
+    static const string& mkfile(const string& f) { makePath(f, true); return f; }
+    gzOutWrapper o;     ///< (compressed) output
+public:
+    SVG::SVGStream S;   ///< SVG document stream
+};
+
 #endif
@@ -0,0 +1,38 @@
+#! /bin/env python3
+## @file BenchCompare.py compare mpmbench JSON results between releases, flagging regressions
+# Michael P. Mendenhall, LLNL 2021
+
+import json
+import argparse
+
+def load(fname):
+    """map benchmark name to result entry"""
+    with open(fname) as f: d = json.load(f)
+    return d["context"], {b["name"]: b for b in d["benchmarks"]}
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Compare mpmbench --json results")
+    parser.add_argument("baseline", help="baseline results .json")
+    parser.add_argument("current", help="current results .json")
+    parser.add_argument("--threshold", type=float, default=0.1, help="fractional slowdown flagged as regression")
+    options = parser.parse_args()
+
+    c0, b0 = load(options.baseline)
+    c1, b1 = load(options.current)
+    print("baseline %s (%s) -> current %s (%s)" % (c0["repo_version"], c0["date"], c1["repo_version"], c1["date"]))
+
+    nreg = 0
+    for nm in sorted(set(b0) & set(b1)):
+        t0, t1 = b0[nm]["median_ns"], b1[nm]["median_ns"]
+        # uncertainty from run-to-run scatter of both measurements
+        sig = ((b0[nm]["stddev_ns"]/t0)**2 + (b1[nm]["stddev_ns"]/t1)**2)**0.5
+        r = t1/t0
+        flag = ""
+        if r > 1 + max(options.threshold, 2*sig):
+            flag = "  *** REGRESSION"
+            nreg += 1
+        elif r < 1 - max(options.threshold, 2*sig): flag = "  (improved)"
+        print("%-40s %12.1f -> %12.1f ns  x%.3f%s" % (nm, t0, t1, r, flag))
+    for nm in sorted(set(b0) - set(b1)): print("%-40s missing from current" % nm)
+    for nm in sorted(set(b1) - set(b0)): print("%-40s new" % nm)
+    exit(1 if nreg else 0)